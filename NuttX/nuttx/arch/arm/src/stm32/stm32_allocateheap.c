@@ -389,6 +389,14 @@
  * Private Data
  ****************************************************************************/
 
+#if defined(CONFIG_MM_REGIONS) && CONFIG_MM_REGIONS > 1 && !defined(CONFIG_STM32_CCMEXCLUDE)
+/* End of the static data in CCM SRAM, defined by linker scripts that
+ * place a .ccm section there.
+ */
+
+extern uint8_t _eccm[] __attribute__((weak));
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -531,17 +539,26 @@ void up_allocate_kheap(FAR void **heap_start, size_t *heap_size)
 void up_addregion(void)
 {
 #ifndef CONFIG_STM32_CCMEXCLUDE
+  /* Static data the linker script placed at the start of the CCM SRAM
+   * (up to _eccm, if the script defines it) is not part of the heap.
+   */
+
+  uintptr_t ccm_start = (_eccm != NULL) ? (uintptr_t)_eccm : SRAM2_START;
+
 #if defined(CONFIG_NUTTX_KERNEL) && defined(CONFIG_MM_KERNEL_HEAP)
 
   /* Allow user-mode access to the STM32F20xxx/STM32F40xxx CCM SRAM heap */
 
-  stm32_mpu_uheap((uintptr_t)SRAM2_START, SRAM2_END-SRAM2_START);
+  stm32_mpu_uheap(ccm_start, SRAM2_END-ccm_start);
 
 #endif
 
   /* Add the STM32F20xxx/STM32F40xxx CCM SRAM user heap region. */
 
-  kumm_addregion((FAR void*)SRAM2_START, SRAM2_END-SRAM2_START);
+  if (ccm_start < SRAM2_END)
+    {
+      kumm_addregion((FAR void*)ccm_start, SRAM2_END-ccm_start);
+    }
 #endif
 
 #ifdef CONFIG_STM32_FSMC_SRAM
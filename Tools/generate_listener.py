@@ -96,26 +96,161 @@ print("""
 for m in messages:
 	print("#include <uORB/topics/%s.h>" % m)
 
-
 print("""
+#include <px4_posix.h>
+#include <drivers/drv_hrt.h>
+
 extern "C" __EXPORT int listener_main(int argc, char *argv[]);
 
+/* upper bounds of the publish interval histogram in us, the last bin takes the rest */
+static const unsigned interval_bins[] = {1000, 2000, 5000, 10000, 20000, 50000, 100000, 1000000};
+static const unsigned num_interval_bins = sizeof(interval_bins) / sizeof(interval_bins[0]);
+
+/**
+ * Sample num_msgs publications of a topic at full rate into RAM, then print
+ * them and the rate and latency summary. The buffer is allocated before
+ * sampling starts, the sampling loop only polls and copies.
+ */
+template <typename T>
+static int listener_stream(orb_id_t ID, uint32_t num_msgs, void (*print_msg)(const T &),
+			   uint64_t (*msg_timestamp)(const T &))
+{
+	struct sample_s {
+		hrt_abstime received;
+		T data;
+	};
+
+	sample_s *samples = new sample_s[num_msgs];
+
+	if (samples == nullptr) {
+		printf("no memory for %u samples\\n", (unsigned)num_msgs);
+		return 1;
+	}
+
+	int sub = orb_subscribe(ID);
+	px4_pollfd_struct_t fds = {};
+	fds.fd = sub;
+	fds.events = POLLIN;
+	uint32_t count = 0;
+
+	while (count < num_msgs) {
+		/* stop when the topic is not published for a second */
+		if (px4_poll(&fds, 1, 1000) <= 0) {
+			break;
+		}
+
+		samples[count].received = hrt_absolute_time();
+		orb_copy(ID, sub, &samples[count].data);
+		count++;
+	}
+
+	orb_unsubscribe(sub);
+
+	unsigned histogram[num_interval_bins + 1] = {};
+	uint64_t latency_sum = 0;
+	uint64_t latency_max = 0;
+	uint32_t latency_count = 0;
+
+	for (uint32_t i = 0; i < count; i++) {
+		printf("[%u] received: %" PRIu64 "\\n", (unsigned)i, samples[i].received);
+		print_msg(samples[i].data);
+
+		if (i > 0) {
+			hrt_abstime interval = samples[i].received - samples[i - 1].received;
+			unsigned bin = 0;
+
+			while (bin < num_interval_bins && interval >= interval_bins[bin]) {
+				bin++;
+			}
+
+			histogram[bin]++;
+		}
+
+		if (msg_timestamp != nullptr) {
+			uint64_t stamp = msg_timestamp(samples[i].data);
+
+			if (stamp > 0 && stamp <= samples[i].received) {
+				uint64_t latency = samples[i].received - stamp;
+				latency_sum += latency;
+				latency_max = (latency > latency_max) ? latency : latency_max;
+				latency_count++;
+			}
+		}
+	}
+
+	printf("\\n%u samples of %u bytes", (unsigned)count, (unsigned)sizeof(T));
+
+	if (count > 1) {
+		hrt_abstime span = samples[count - 1].received - samples[0].received;
+		printf(" in %" PRIu64 " us, %.1f Hz", span, (span > 0) ? (double)(count - 1) * 1e6 / span : 0.0);
+	}
+
+	printf("\\n");
+
+	if (latency_count > 0) {
+		printf("latency: mean %" PRIu64 " us, max %" PRIu64 " us\\n", latency_sum / latency_count, latency_max);
+	}
+
+	printf("publish interval histogram:\\n");
+
+	for (unsigned bin = 0; bin <= num_interval_bins; bin++) {
+		if (bin < num_interval_bins) {
+			printf("  < %7u us: %u\\n", interval_bins[bin], histogram[bin]);
+
+		} else {
+			printf(" >= %7u us: %u\\n", interval_bins[num_interval_bins - 1], histogram[bin]);
+		}
+	}
+
+	delete[] samples;
+	return 0;
+}
+""")
+
+for index,m in enumerate(messages):
+	print("static void print_%s(const struct %s_s &container) {" % (m, m))
+	for item in message_elements[index]:
+		if item[0] == "float":
+			print("\tprintf(\"%s: %%f\\n \",(double)container.%s);" % (item[1], item[1]))
+		elif item[0] == "float_array":
+			print("\tprintf(\"%s:\");" % item[1])
+			print("\tfor (int j=0;j<%d;j++) {" % item[2])
+			print("\t\tprintf(\"%%f \",(double)container.%s[j]);" % item[1])
+			print("\t}")
+			print("\tprintf(\"\\n\");")
+		elif item[0] == "uint64":
+			print("\tprintf(\"%s: %%\" PRIu64 \"\\n \",container.%s);" % (item[1], item[1]))
+		elif item[0] == "uint8":
+			print("\tprintf(\"%s: %%u\\n \",container.%s);" % (item[1], item[1]))
+		elif item[0] == "bool":
+			print("\tprintf(\"%s: %%s\\n \",container.%s ? \"True\" : \"False\");" % (item[1], item[1]))
+	print("}")
+	if ("uint64", "timestamp") in message_elements[index]:
+		print("static uint64_t timestamp_%s(const struct %s_s &container) {" % (m, m))
+		print("\treturn container.timestamp;")
+		print("}")
+	print("")
+
+print("""
 int listener_main(int argc, char *argv[]) {
 	int sub = -1;
 	orb_id_t ID;
 	if(argc < 3) {
-		printf("need at least two arguments: topic name, number of messages to print\\n");
+		printf("need at least two arguments: topic name, number of messages to print [-s to sample at full rate]\\n");
 		return 1;
 	}
 """)
 print("\tuint32_t num_msgs = (uint32_t)std::stoi(argv[2],NULL,10);")
-print("\tif(strncmp(argv[1],\"%s\",50)== 0) {" % messages[0])
-print("\t\tsub = orb_subscribe(ORB_ID(%s));" % messages[0])
-print("\t\tID = ORB_ID(%s);" % messages[0])
-print("\t\tstruct %s_s container;" % messages[0])
-print("\t\tmemset(&container, 0, sizeof(container));")
-for index,m in enumerate(messages[1:]):
-	print("\t} else if(strncmp(argv[1],\"%s\",50) == 0) {" % m)
+print("\tbool stream = (argc > 3 && strcmp(argv[3], \"-s\") == 0);")
+for index,m in enumerate(messages):
+	if index == 0:
+		print("\tif(strncmp(argv[1],\"%s\",50) == 0) {" % m)
+	else:
+		print("\t} else if(strncmp(argv[1],\"%s\",50) == 0) {" % m)
+	timestamp = ("timestamp_%s" % m) if ("uint64", "timestamp") in message_elements[index] else "nullptr"
+	print("\t\tif(stream) {")
+	print("\t\t\treturn listener_stream<struct %s_s>(ORB_ID(%s), num_msgs, print_%s, %s);" % (m, m, m, timestamp))
+	print("\t\t}")
 	print("\t\tsub = orb_subscribe(ORB_ID(%s));" % m)
 	print("\t\tID = ORB_ID(%s);" % m)
 	print("\t\tstruct %s_s container;" % m)
@@ -126,21 +261,7 @@ for index,m in enumerate(messages[1:]):
 	print("\t\t\tupdated = true;")
 	print("\t\t\tif(updated) {")
 	print("\t\t\torb_copy(ID,sub,&container);")
-	for item in message_elements[index+1]:
-		if item[0] == "float":
-			print("\t\t\tprintf(\"%s: %%f\\n \",(double)container.%s);" % (item[1], item[1]))
-		elif item[0] == "float_array":
-			print("\t\t\tprintf(\"%s:\");" % item[1])
-			print("\t\t\tfor (int j=0;j<%d;j++) {" % item[2])
-			print("\t\t\t\tprintf(\"%%f \",(double)container.%s[j]);" % item[1])
-			print("\t\t\t}")
-			print("\t\t\tprintf(\"\\n\");")
-		elif item[0] == "uint64":
-			print("\t\t\tprintf(\"%s: %%\" PRIu64 \"\\n \",container.%s);" % (item[1], item[1]))
-		elif item[0] == "uint8":
-			print("\t\t\tprintf(\"%s: %%u\\n \",container.%s);" % (item[1], item[1]))
-		elif item[0] == "bool":
-			print("\t\t\tprintf(\"%s: %%s\\n \",container.%s ? \"True\" : \"False\");" % (item[1], item[1]))
+	print("\t\t\tprint_%s(container);" % m)
 	print("\t\t\t}")
 	print("\t\t}")
 print("\t} else {")
@@ -65,6 +65,7 @@ static int list_files_main(int argc, char *argv[]);
 static int list_devices_main(int argc, char *argv[]);
 static int list_topics_main(int argc, char *argv[]);
 static int sleep_main(int argc, char *argv[]);
+static int affinity_main(int argc, char *argv[]);
 }
 
 
@@ -83,6 +84,7 @@ print('\tapps["list_files"] = list_files_main;')
 print('\tapps["list_devices"] = list_devices_main;')
 print('\tapps["list_topics"] = list_topics_main;')
 print('\tapps["sleep"] = sleep_main;')
+print('\tapps["affinity"] = affinity_main;')
 print("""
 	return apps;
 }
@@ -133,5 +135,19 @@ static int sleep_main(int argc, char *argv[])
 	sleep(atoi(argv[1]));
 	return 0;
 }
+static int affinity_main(int argc, char *argv[])
+{
+	if (argc != 3) {
+		cout << "Usage: affinity <task> <cpu|none>" << endl;
+		return 1;
+	}
+	int cpu = (string(argv[2]) == "none") ? -1 : atoi(argv[2]);
+	int ret = px4_task_set_affinity(argv[1], cpu);
+	if (ret != 0) {
+		cout << "affinity: failed to pin " << argv[1] << " (" << ret << ")" << endl;
+		return 1;
+	}
+	return 0;
+}
 """)
 
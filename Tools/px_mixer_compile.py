@@ -0,0 +1,142 @@
+#!/usr/bin/env python
+############################################################################
+#
+#   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name PX4 nor the names of its contributors may be
+#    used to endorse or promote products derived from this software
+#    without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+############################################################################
+
+"""
+px_mixer_compile.py:
+Precompile the mixer files in ROMFS to the binary format read by
+MixerGroup::load_from_binary(). For every <name>.mix a <name>.mixb is
+written next to it, which `mixer load` prefers on devices that support it.
+"""
+
+from __future__ import print_function
+import argparse
+import os
+import struct
+
+
+class MixerError(Exception):
+        pass
+
+
+def scales(values):
+        out = b""
+        for v in values:
+                v = int(v)
+                if v < -32768 or v > 32767:
+                        raise MixerError("scale %d out of range" % v)
+                out += struct.pack("<h", v)
+        return out
+
+
+def compile_mixer(text):
+        out = b""
+        scalers_left = 0
+        output_next = False
+
+        for line in text.splitlines():
+                line = line.strip()
+
+                # only mixer definition lines, like the text loader
+                if len(line) < 2 or not line[0].isupper() or line[1] != ":":
+                        continue
+
+                tag = line[0]
+                fields = line[2:].split()
+
+                if scalers_left > 0 and tag not in ("O", "S"):
+                        raise MixerError("simple mixer ended early: " + line)
+
+                if tag == "Z":
+                        out += b"Z"
+
+                elif tag == "M":
+                        count = int(fields[0])
+                        out += b"M" + struct.pack("<B", count)
+                        scalers_left = count + 1
+                        output_next = True
+
+                elif tag in ("O", "S"):
+                        if scalers_left == 0 or output_next != (tag == "O"):
+                                raise MixerError("unexpected scaler: " + line)
+
+                        if tag == "S":
+                                out += struct.pack("<BB", int(fields[0]), int(fields[1]))
+                                fields = fields[2:]
+
+                        out += scales(fields[:5])
+                        scalers_left -= 1
+                        output_next = False
+
+                elif tag == "R":
+                        if len(fields[0]) > 7:
+                                raise MixerError("geometry name too long: " + line)
+
+                        out += b"R" + fields[0].encode("ascii") + b"\0" + scales(fields[1:5])
+
+        if scalers_left > 0:
+                raise MixerError("simple mixer incomplete")
+
+        return out
+
+
+def main():
+
+        # Parse commandline arguments
+        parser = argparse.ArgumentParser(description="Mixer precompiler.")
+        parser.add_argument('--folder', action="store", help="ROMFS scratch folder.")
+        args = parser.parse_args()
+
+        print("Precompiling mixer files.")
+
+        for (root, dirs, files) in os.walk(args.folder):
+                for file in files:
+                        if not file.endswith(".mix"):
+                                continue
+
+                        file_path = os.path.join(root, file)
+
+                        with open(file_path, "r") as f:
+                                try:
+                                        binary = compile_mixer(f.read())
+                                except (MixerError, ValueError, IndexError) as e:
+                                        # keep the text mixer only, it is rejected at load as before
+                                        print("%s: %s" % (file_path, e))
+                                        continue
+
+                        with open(file_path + "b", "wb") as f:
+                                f.write(binary)
+
+
+if __name__ == '__main__':
+        main()
@@ -0,0 +1,173 @@
+#!/usr/bin/env python
+
+"""Report the task stacks the firmware asks for
+
+Usage: python px_stack_report.py [-c <config.mk>] [<src dir>]
+
+Lists the stack size of every task spawned with px4_task_spawn_cmd() and
+of every shell command (MODULE_STACKSIZE, only allocated while the command
+runs), with the total of the daemon stacks, which all live on the heap at
+the same time. With -c only the modules of the given build configs are listed.
+Compare with the high-water marks reported by 'top stack' on the target."""
+
+from __future__ import print_function
+
+import argparse
+import os
+import re
+import sys
+
+SPAWN = re.compile(r'\bpx4_task_spawn_cmd\s*\(')
+MODULE_LINE = re.compile(r'^\s*MODULES\s*\+=\s*(\S+)', re.MULTILINE)
+STACKSIZE = re.compile(r'^\s*MODULE_STACKSIZE\s*=\s*(\S+)', re.MULTILINE)
+COMMAND = re.compile(r'^\s*MODULE_COMMAND\s*=\s*(\S+)', re.MULTILINE)
+
+# CONFIG_PTHREAD_STACK_DEFAULT of the NuttX configs, the stack of commands without MODULE_STACKSIZE
+DEFAULT_COMMAND_STACK = 2048
+
+
+def split_args(text, start):
+    """Split the argument list of the call whose '(' precedes start."""
+    args = []
+    depth = 0
+    current = ''
+
+    for i in range(start, len(text)):
+        c = text[i]
+
+        if c == '(':
+            depth += 1
+
+        elif c == ')':
+            if depth == 0:
+                args.append(current.strip())
+                return args
+
+            depth -= 1
+
+        elif c == ',' and depth == 0:
+            args.append(current.strip())
+            current = ''
+            continue
+
+        current += c
+
+    return None
+
+
+def evaluate(expr):
+    """Evaluate a stack size made of integer literals, else None."""
+    expr = re.sub(r'\s+', ' ', expr)
+
+    if not re.match(r'^[0-9 +\-*/()]+$', expr):
+        return None
+
+    try:
+        return int(eval(expr))
+
+    except Exception:
+        return None
+
+
+def module_dirs(config):
+    with open(config) as f:
+        return set(m.rstrip('/') for m in MODULE_LINE.findall(f.read()))
+
+
+def in_modules(path, src, modules):
+    if modules is None:
+        return True
+
+    rel = os.path.relpath(path, src)
+    return any(rel == m or rel.startswith(m + os.sep) for m in modules)
+
+
+def scan(src, modules):
+    tasks = []
+    commands = []
+
+    for root, dirs, files in os.walk(src):
+        for name in files:
+            path = os.path.join(root, name)
+
+            if name == 'module.mk':
+                if not in_modules(root, src, modules):
+                    continue
+
+                with open(path) as f:
+                    text = f.read()
+
+                command = COMMAND.search(text)
+
+                if command:
+                    stack = STACKSIZE.search(text)
+                    commands.append((command.group(1),
+                                     int(stack.group(1)) if stack else DEFAULT_COMMAND_STACK,
+                                     os.path.relpath(root, src)))
+
+            elif name.endswith(('.c', '.cpp')):
+                if not in_modules(path, src, modules):
+                    continue
+
+                with open(path) as f:
+                    text = f.read()
+
+                for match in SPAWN.finditer(text):
+                    args = split_args(text, match.end())
+
+                    # skips the definitions and declarations
+                    if args is None or len(args) != 6 or args[0].startswith('const char'):
+                        continue
+
+                    line = text.count('\n', 0, match.start()) + 1
+                    tasks.append((args[0].strip('"'), args[3], evaluate(args[3]),
+                                  '%s:%d' % (os.path.relpath(path, src), line)))
+
+    return tasks, commands
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Report the task stacks of the firmware')
+    parser.add_argument('-c', '--config', action='append',
+                        help='build config (makefiles/nuttx/config_*.mk) to restrict to, can be repeated')
+    parser.add_argument('src', nargs='?',
+                        default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src'))
+    args = parser.parse_args()
+
+    src = os.path.normpath(args.src)
+    modules = None
+
+    if args.config:
+        modules = set()
+
+        for config in args.config:
+            modules |= module_dirs(config)
+    tasks, commands = scan(src, modules)
+
+    total = 0
+    unknown = 0
+
+    print('%-24s %8s  %s' % ('TASK', 'STACK', 'SPAWNED AT'))
+
+    for name, expr, size, where in sorted(tasks, key=lambda t: -(t[2] or 0)):
+        if size is None:
+            unknown += 1
+            print('%-24s %8s  %s (%s)' % (name, '?', where, expr))
+
+        else:
+            total += size
+            print('%-24s %8d  %s' % (name, size, where))
+
+    print('%-24s %8d  in %d tasks%s' % ('total', total, len(tasks) - unknown,
+                                          ', %d not computed' % unknown if unknown else ''))
+    print()
+    print('%-24s %8s  %s' % ('COMMAND', 'STACK', 'MODULE'))
+
+    for name, size, where in sorted(commands, key=lambda c: -c[1]):
+        print('%-24s %8d  %s' % (name, size, where))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -16,12 +16,26 @@ Usage: python sdlog2_dump.py <log.bin> [-v] [-e] [-d delimiter] [-n null] [-m MS
     
     -m MSG[.field1,field2,...]
         Dump only messages of specified type, and only specified fields.
-        Multiple -m options allowed."""
+        Multiple -m options allowed.
+
+    -c DIR
+        Columnar export: write one CSV file per message type (DIR/MSG.csv),
+        decoded in one indexing pass and unpacked per type, with numpy
+        if available. -m selects the message types.
+
+    -z FILE
+        Like -c, but save the columns as numpy arrays named MSG_label
+        in FILE.npz."""
 
 __author__  = "Anton Babushkin"
-__version__ = "1.2"
+__version__ = "1.4"
 
-import struct, sys
+import os, struct, sys
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
 
 if sys.hexversion >= 0x030000F0:
     runningPython3 = True
@@ -32,6 +46,52 @@ else:
     def _parseCString(cstr):
         return str(cstr).split('\0')[0]
 
+def _lz4Decompress(src, raw_len):
+    """Decompress one LZ4 block as written in ZBLK messages"""
+    dst = bytearray()
+    i = 0
+    n = len(src)
+    while i < n:
+        token = src[i]
+        i += 1
+        lit_len = token >> 4
+        if lit_len == 15:
+            while True:
+                b = src[i]
+                i += 1
+                lit_len += b
+                if b != 255:
+                    break
+        dst += src[i:i + lit_len]
+        i += lit_len
+        if i >= n:
+            break   # last sequence has no match
+        offset = src[i] | (src[i + 1] << 8)
+        i += 2
+        match_len = token & 0x0F
+        if match_len == 15:
+            while True:
+                b = src[i]
+                i += 1
+                match_len += b
+                if b != 255:
+                    break
+        match_len += 4
+        start = len(dst) - offset
+        if offset == 0 or start < 0:
+            raise Exception("Invalid LZ4 match offset %i" % offset)
+        for k in range(match_len):
+            dst.append(dst[start + k])   # byte-wise, the match may overlap its output
+    if len(dst) != raw_len:
+        raise Exception("Invalid compressed block: %i bytes decoded, %i expected" % (len(dst), raw_len))
+    return dst
+
+# numpy dtypes of the struct format chars used in FORMAT_TO_STRUCT
+_STRUCT_TO_DTYPE = {
+    "b": "i1", "B": "u1", "h": "<i2", "H": "<u2", "i": "<i4", "I": "<u4",
+    "f": "<f4", "q": "<i8", "Q": "<u8", "4s": "S4", "16s": "S16", "64s": "S64",
+}
+
 class SDLog2Parser:
     BLOCK_SIZE = 8192
     MSG_HEADER_LEN = 3
@@ -40,6 +100,9 @@ class SDLog2Parser:
     MSG_FORMAT_PACKET_LEN = 89
     MSG_FORMAT_STRUCT = "BB4s16s64s"
     MSG_TYPE_FORMAT = 0x80
+    MSG_NAME_ZBLK = "ZBLK"
+    MSG_ZBLK_STRUCT = "<BBBHH"
+    MSG_ZBLK_LEN = 7
     FORMAT_TO_STRUCT = {
         "b": ("b", None),
         "B": ("B", None),
@@ -82,6 +145,9 @@ class SDLog2Parser:
         self.__csv_data = {}        # current values for all columns
         self.__csv_updated = False
         self.__msg_filter_map = {}  # filter in form of map, with '*" expanded to full list of fields
+        self.__zblk_type = None     # message type of compressed blocks, if the log has them
+        self.__compressed = False   # set once the first compressed block is reached
+        self.__zbuffer = bytearray() # compressed input not yet decoded
     
     def setCSVDelimiter(self, csv_delim):
         self.__csv_delim = csv_delim
@@ -119,7 +185,7 @@ class SDLog2Parser:
         f = open(fn, "rb")
         bytes_read = 0
         while True:
-            chunk = f.read(self.BLOCK_SIZE)
+            chunk = self.__readChunk(f)
             if len(chunk) == 0:
                 break
             self.__buffer = self.__buffer[self.__ptr:] + chunk
@@ -134,6 +200,12 @@ class SDLog2Parser:
                     else:
                         raise Exception("Invalid header at %i (0x%X): %02X %02X, must be %02X %02X" % (bytes_read + self.__ptr, bytes_read + self.__ptr, head1, head2, self.MSG_HEAD1, self.MSG_HEAD2))
                 msg_type = self.__buffer[self.__ptr+2]
+                if msg_type == self.__zblk_type and not self.__compressed:
+                    # everything from here on is compressed, decode it while reading
+                    self.__zbuffer = self.__buffer[self.__ptr:]
+                    self.__buffer = self.__buffer[:self.__ptr]
+                    self.__compressed = True
+                    break
                 if msg_type == self.MSG_TYPE_FORMAT:
                     # parse FORMAT message
                     if self.__bytesLeft() < self.MSG_FORMAT_PACKET_LEN:
@@ -158,6 +230,169 @@ class SDLog2Parser:
                 self.__printCSVRow()
         f.close()
     
+    def processColumns(self, fn):
+        """Decode the whole log into columns per message type
+
+        Returns a list of (msg_name, labels, columns) in FORMAT order, with one
+        numpy array (or list without numpy) per label. Message types without
+        data are left out."""
+        self.reset()
+        f = open(fn, "rb")
+        data = bytearray(f.read())
+        f.close()
+        index = self.__indexMessages(data)
+        selected = [msg_name for msg_name, show_fields in self.__msg_filter]
+        result = []
+        for msg_type in sorted(index.keys(), key=lambda t: self.__msg_names.index(self.__msg_descrs[t][1])):
+            msg_descr = self.__msg_descrs[msg_type]
+            if len(selected) > 0 and msg_descr[1] not in selected:
+                continue
+            result.append((msg_descr[1], msg_descr[3], self.__unpackColumns(self.__buffer, msg_descr, index[msg_type])))
+        return result
+
+    def writeColumnsCSV(self, columns, out_dir):
+        """Write the result of processColumns() as one CSV file per message type"""
+        if not os.path.isdir(out_dir):
+            os.makedirs(out_dir)
+        for msg_name, labels, cols in columns:
+            out = open(os.path.join(out_dir, msg_name + ".csv"), "w")
+            print(self.__csv_delim.join(labels[:len(cols)]), file=out)
+            values = [c.tolist() if numpy != None else c for c in cols]
+            for row in zip(*values):
+                print(self.__csv_delim.join(_parseCString(v) if isinstance(v, bytes) else str(v) for v in row), file=out)
+            out.close()
+
+    def writeColumnsNPZ(self, columns, fn):
+        """Write the result of processColumns() as a numpy archive of MSG_label arrays"""
+        arrays = {}
+        for msg_name, labels, cols in columns:
+            for label, col in zip(labels, cols):
+                arrays[msg_name + "_" + label] = col
+        numpy.savez(fn, **arrays)
+
+    def __indexMessages(self, data):
+        """Offsets of all data messages by type, in one pass over the headers
+
+        Compressed blocks are decoded in place when the first one is reached,
+        self.__buffer holds the uncompressed log afterwards."""
+        index = {}
+        self.__buffer = data
+        self.__ptr = 0
+        n = len(data)
+        while self.__ptr + self.MSG_HEADER_LEN <= n:
+            ptr = self.__ptr
+            if data[ptr] != self.MSG_HEAD1 or data[ptr + 1] != self.MSG_HEAD2:
+                if self.__correct_errors:
+                    self.__ptr += 1
+                    continue
+                raise Exception("Invalid header at %i (0x%X): %02X %02X, must be %02X %02X" % (ptr, ptr, data[ptr], data[ptr + 1], self.MSG_HEAD1, self.MSG_HEAD2))
+            msg_type = data[ptr + 2]
+            if msg_type == self.__zblk_type and not self.__compressed:
+                # decode everything after the header at once
+                self.__compressed = True
+                self.__zbuffer = data[ptr:]
+                data = data[:ptr] + bytearray(self.__decodeBlocks())
+                self.__buffer = data
+                n = len(data)
+                continue
+            if msg_type == self.MSG_TYPE_FORMAT:
+                if n - ptr < self.MSG_FORMAT_PACKET_LEN:
+                    break
+                self.__parseMsgDescr()
+                continue
+            msg_descr = self.__msg_descrs.get(msg_type)
+            if msg_descr == None:
+                if self.__correct_errors:
+                    self.__ptr += 1
+                    continue
+                raise Exception("Unknown msg type: %i" % msg_type)
+            if n - ptr < msg_descr[0]:
+                break
+            index.setdefault(msg_type, []).append(ptr)
+            self.__ptr += msg_descr[0]
+        return index
+
+    def __decodeBlocks(self):
+        """Decode all complete ZBLK messages in self.__zbuffer"""
+        data = bytearray()
+        zbuffer = self.__zbuffer
+        i = 0
+        while len(zbuffer) - i >= self.MSG_ZBLK_LEN:
+            if runningPython3:
+                head1, head2, msg_type, comp_len, raw_len = struct.unpack_from(self.MSG_ZBLK_STRUCT, zbuffer, i)
+            else:
+                head1, head2, msg_type, comp_len, raw_len = struct.unpack_from(self.MSG_ZBLK_STRUCT, str(zbuffer[i:i + self.MSG_ZBLK_LEN]))
+            if head1 != self.MSG_HEAD1 or head2 != self.MSG_HEAD2 or msg_type != self.__zblk_type:
+                raise Exception("Invalid compressed block header: %02X %02X %02X" % (head1, head2, msg_type))
+            end = i + self.MSG_ZBLK_LEN + comp_len
+            if end > len(zbuffer):
+                break
+            payload = zbuffer[i + self.MSG_ZBLK_LEN:end]
+            if comp_len == raw_len:
+                data += payload
+            else:
+                data += _lz4Decompress(payload, raw_len)
+            i = end
+        self.__zbuffer = bytearray()
+        return data
+
+    def __unpackColumns(self, data, msg_descr, offsets):
+        """Unpack all messages of one type at the given offsets into columns"""
+        msg_length, msg_name, msg_format, msg_labels, msg_struct, msg_mults = msg_descr
+        fields = [self.FORMAT_TO_STRUCT[c][0] for c in msg_format]
+        if numpy != None:
+            dtype = numpy.dtype([("f%i" % i, _STRUCT_TO_DTYPE[c]) for i, c in enumerate(fields)])
+            if dtype.itemsize > msg_length - self.MSG_HEADER_LEN:
+                raise Exception("Message %s shorter than its format" % msg_name)
+            # gather the payloads of all messages into one contiguous record array
+            buf = numpy.frombuffer(bytes(data), dtype=numpy.uint8)
+            rows = buf[numpy.array(offsets)[:, None] + self.MSG_HEADER_LEN + numpy.arange(dtype.itemsize)]
+            records = numpy.ascontiguousarray(rows).view(dtype).reshape(len(offsets))
+            cols = []
+            for i in range(len(fields)):
+                col = records["f%i" % i]
+                if msg_mults[i] != None:
+                    col = col * msg_mults[i]
+                cols.append(col)
+            return cols
+        # without numpy, unpack with a precompiled struct per type
+        unpacker = struct.Struct(msg_struct)
+        if not runningPython3:
+            data = str(data)
+        rows = [unpacker.unpack_from(data, ptr + self.MSG_HEADER_LEN) for ptr in offsets]
+        cols = [list(c) for c in zip(*rows)]
+        for i in range(len(cols)):
+            if msg_mults[i] != None:
+                cols[i] = [v * msg_mults[i] for v in cols[i]]
+        return cols
+
+    def __readChunk(self, f):
+        chunk = f.read(self.BLOCK_SIZE)
+        if not self.__compressed:
+            return chunk
+        # return the decoded data of all complete ZBLK messages
+        data = bytearray()
+        while True:
+            self.__zbuffer += chunk
+            while len(self.__zbuffer) >= self.MSG_ZBLK_LEN:
+                if runningPython3:
+                    head1, head2, msg_type, comp_len, raw_len = struct.unpack(self.MSG_ZBLK_STRUCT, self.__zbuffer[:self.MSG_ZBLK_LEN])
+                else:
+                    head1, head2, msg_type, comp_len, raw_len = struct.unpack(self.MSG_ZBLK_STRUCT, str(self.__zbuffer[:self.MSG_ZBLK_LEN]))
+                if head1 != self.MSG_HEAD1 or head2 != self.MSG_HEAD2 or msg_type != self.__zblk_type:
+                    raise Exception("Invalid compressed block header: %02X %02X %02X" % (head1, head2, msg_type))
+                if len(self.__zbuffer) < self.MSG_ZBLK_LEN + comp_len:
+                    break
+                payload = self.__zbuffer[self.MSG_ZBLK_LEN:self.MSG_ZBLK_LEN + comp_len]
+                if comp_len == raw_len:
+                    data += payload
+                else:
+                    data += _lz4Decompress(payload, raw_len)
+                self.__zbuffer = self.__zbuffer[self.MSG_ZBLK_LEN + comp_len:]
+            if len(data) > 0 or len(chunk) == 0:
+                return bytes(data)
+            chunk = f.read(self.BLOCK_SIZE)
+
     def __bytesLeft(self):
         return len(self.__buffer) - self.__ptr
     
@@ -222,6 +457,8 @@ class SDLog2Parser:
                     raise Exception("Unsupported format char: %s in message %s (%i)" % (c, msg_name, msg_type))
             msg_struct = "<" + msg_struct   # force little-endian
             self.__msg_descrs[msg_type] = (msg_length, msg_name, msg_format, msg_labels, msg_struct, msg_mults)
+            if msg_name == self.MSG_NAME_ZBLK:
+                self.__zblk_type = msg_type
             self.__msg_labels[msg_name] = msg_labels
             self.__msg_names.append(msg_name)
             if self.__debug_out:
@@ -276,6 +513,8 @@ def _main():
         print("\t-m MSG[.field1,field2,...]\n\t\tDump only messages of specified type, and only specified fields.\n\t\tMultiple -m options allowed.")
         print("\t-t\tSpecify TIME message name to group data messages by time and significantly reduce duplicate output.\n")
         print("\t-fPrint to file instead of stdout")
+        print("\t-c DIR\tColumnar export, one CSV file per message type in DIR.\n")
+        print("\t-z FILE\tLike -c, but save the columns as numpy arrays in FILE.npz.\n")
         return
     fn = sys.argv[1]
     debug_out = False
@@ -285,6 +524,8 @@ def _main():
     csv_delim = ","
     time_msg = "TIME"
     file_name = None
+    columns_dir = None
+    npz_name = None
     opt = None
     for arg in sys.argv[2:]:
         if opt != None:
@@ -296,6 +537,10 @@ def _main():
                 time_msg = arg
             elif opt == "f":
             	file_name = arg
+            elif opt == "c":
+                columns_dir = arg
+            elif opt == "z":
+                npz_name = arg
             elif opt == "m":
                 show_fields = "*"
                 a = arg.split("_")
@@ -318,13 +563,28 @@ def _main():
                 opt = "t"
             elif arg == "-f":
                 opt = "f"
+            elif arg == "-c":
+                opt = "c"
+            elif arg == "-z":
+                opt = "z"
 
     if csv_delim == "\\t":
         csv_delim = "\t"
     parser = SDLog2Parser()
     parser.setCSVDelimiter(csv_delim)
     parser.setCSVNull(csv_null)
+    parser.setCorrectErrors(correct_errors)
     parser.setMsgFilter(msg_filter)
+    if columns_dir != None or npz_name != None:
+        columns = parser.processColumns(fn)
+        if npz_name != None:
+            if numpy == None:
+                print("numpy is required for -z")
+                return
+            parser.writeColumnsNPZ(columns, npz_name)
+        else:
+            parser.writeColumnsCSV(columns, columns_dir)
+        return
     parser.setTimeMsg(time_msg)
     parser.setFileName(file_name)
     parser.setDebugOut(debug_out)
@@ -1,5 +1,54 @@
 #!/bin/bash
 
-mkdir -p Build/posix_sitl.build/rootfs/fs/microsd
-mkdir -p Build/posix_sitl.build/rootfs/eeprom
-cd Build/posix_sitl.build && ./mainapp ../../$1
+# Usage: sitl_run.sh <startup file>
+#
+# With SITL_INSTANCE set to a number, the app runs as that instance: its UDP
+# ports are offset by 10 per instance and it keeps its parameters, dataman
+# store and logs in its own directory, so several instances can run at once.
+#
+# With SITL_SNAPSHOT set to a directory, the first run saves the parameters,
+# the dataman store and the position estimator initialization there, and the
+# following runs restore them and skip the parameter setup of the startup file.
+
+workdir=Build/posix_sitl.build
+mainapp=./mainapp
+args=
+
+if [ -n "$SITL_INSTANCE" ]; then
+	# at the depth of the build directory, so the ../../ paths of the startup files still resolve
+	workdir=Build/posix_sitl_instance_$SITL_INSTANCE
+	mainapp=../posix_sitl.build/mainapp
+	args="-i $SITL_INSTANCE"
+fi
+
+mkdir -p $workdir/rootfs/fs/microsd
+mkdir -p $workdir/rootfs/eeprom
+
+startup=../../$1
+
+if [ -n "$SITL_SNAPSHOT" ]; then
+	mkdir -p "$SITL_SNAPSHOT"
+	snapshot=$(cd "$SITL_SNAPSHOT" && pwd)
+	startup=rootfs/startup_snapshot
+
+	if [ -f "$snapshot/parameters" ]; then
+		echo "restoring snapshot $snapshot"
+		cp "$snapshot/parameters" $workdir/rootfs/eeprom/parameters
+		[ -f "$snapshot/dataman" ] && cp "$snapshot/dataman" $workdir/rootfs/fs/microsd/dataman
+		sed -e '/^param set /d' \
+			-e "s|^position_estimator_inav start.*|& -s $snapshot/inav|" \
+			"$1" > $workdir/$startup
+	else
+		echo "saving snapshot to $snapshot"
+		rm -f "$snapshot/inav"
+		sed -e "s|^position_estimator_inav start.*|& -s $snapshot/inav|" \
+			"$1" > $workdir/$startup
+		echo "param save $snapshot/parameters" >> $workdir/$startup
+	fi
+fi
+
+cd $workdir && $mainapp $args $startup
+
+if [ -n "$SITL_SNAPSHOT" ] && [ ! -f "$snapshot/dataman" ] && [ -f rootfs/fs/microsd/dataman ]; then
+	cp rootfs/fs/microsd/dataman "$snapshot/dataman"
+fi
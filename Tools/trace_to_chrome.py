@@ -0,0 +1,112 @@
+#!/usr/bin/env python
+
+"""Convert a dump of the PX4 trace command to the Chrome trace event format
+
+Usage: python trace_to_chrome.py <trace.bin> [<trace.json>]
+
+Open the result in chrome://tracing. Task switches become slices on the
+track of each task, uORB publications and poll notifications instant
+events and HRT callouts slices on the track of the context they ran in.
+See src/modules/systemlib/trace.h for the dump format."""
+
+from __future__ import print_function
+
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x54345850
+TRACE_VERSION = 1
+TRACE_NAME_NONE = 0xffff
+
+TRACE_SWITCH = 1
+TRACE_PUBLISH = 2
+TRACE_NOTIFY = 3
+TRACE_CALLOUT_BEGIN = 4
+TRACE_CALLOUT_END = 5
+
+HEADER = struct.Struct('<IHHII')
+NAME = struct.Struct('<Q16s')
+EVENT = struct.Struct('<QHHB3x')
+
+
+def read_trace(data):
+    magic, version, event_size, event_count, name_count = HEADER.unpack_from(data, 0)
+
+    if magic != TRACE_MAGIC or version != TRACE_VERSION:
+        raise ValueError('not a trace dump of version %d' % TRACE_VERSION)
+
+    if event_size != EVENT.size:
+        raise ValueError('unexpected event size %d' % event_size)
+
+    offset = HEADER.size
+    names = []
+
+    for i in range(name_count):
+        key, name = NAME.unpack_from(data, offset)
+        name = name.split(b'\0')[0].decode('ascii', 'replace')
+        names.append(name if name else '0x%x' % key)
+        offset += NAME.size
+
+    events = []
+
+    for i in range(event_count):
+        events.append(EVENT.unpack_from(data, offset))
+        offset += EVENT.size
+
+    return names, events
+
+
+def convert(names, events):
+    def name_of(index):
+        if index == TRACE_NAME_NONE or index >= len(names):
+            return 'unknown'
+        return names[index]
+
+    out = []
+    tasks = set()
+    running = None
+
+    for time, task, name, type in events:
+        if type == TRACE_SWITCH:
+            if running is not None:
+                out.append({'name': name_of(running[0]), 'ph': 'X', 'pid': 0, 'tid': running[0],
+                            'ts': running[1], 'dur': time - running[1], 'cat': 'sched'})
+            running = (task, time)
+
+        elif type in (TRACE_PUBLISH, TRACE_NOTIFY):
+            prefix = 'publish ' if type == TRACE_PUBLISH else 'notify '
+            out.append({'name': prefix + name_of(name), 'ph': 'i', 's': 't', 'pid': 0, 'tid': task,
+                        'ts': time, 'cat': 'uorb'})
+
+        elif type in (TRACE_CALLOUT_BEGIN, TRACE_CALLOUT_END):
+            out.append({'name': name_of(name), 'ph': 'B' if type == TRACE_CALLOUT_BEGIN else 'E', 'pid': 0,
+                        'tid': task, 'ts': time, 'cat': 'hrt'})
+
+        tasks.add(task)
+
+    for task in tasks:
+        out.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': task, 'args': {'name': name_of(task)}})
+
+    return {'traceEvents': out, 'displayTimeUnit': 'ms'}
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    with open(sys.argv[1], 'rb') as f:
+        names, events = read_trace(f.read())
+
+    trace = convert(names, events)
+
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], 'w') as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
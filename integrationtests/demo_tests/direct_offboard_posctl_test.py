@@ -49,9 +49,12 @@ from px4.msg import vehicle_control_mode
 from px4.msg import position_setpoint_triplet
 from px4.msg import position_setpoint
 from px4.msg import vehicle_local_position_setpoint
+from px4.msg import vehicle_attitude
+from px4.msg import actuator_controls_0
 
 from manual_input import ManualInput
 from flight_path_assertion import FlightPathAssertion
+from perf_assertion import PerfAssertion
 from px4_test_helper import PX4TestHelper
 
 #
@@ -152,6 +155,14 @@ class DirectOffboardPosctlTest(unittest.TestCase):
         self.fpa = FlightPathAssertion(positions, 1, 0)
         self.fpa.start()
 
+        # performance while flying the path
+        perf = PerfAssertion()
+        perf.expect_rate("vehicle_attitude", vehicle_attitude, 50)
+        perf.expect_rate("vehicle_local_position", vehicle_local_position, 20)
+        perf.expect_rate("actuator_controls_0", actuator_controls_0, 50)
+        perf.expect_latency("actuator_controls_0", actuator_controls_0, 20000)
+        perf.start()
+
         for i in range(0, len(positions)):
             self.reach_position(positions[i][0], positions[i][1], positions[i][2], 120)
             self.assertFalse(self.fpa.failed, "breached flight path tunnel (%d)" % i)
@@ -167,6 +178,7 @@ class DirectOffboardPosctlTest(unittest.TestCase):
 
         self.assertTrue(count == timeout, "position could not be held")
         self.fpa.stop()
+        perf.check(self)
     
 
 if __name__ == '__main__':
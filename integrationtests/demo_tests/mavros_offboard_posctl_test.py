@@ -48,10 +48,13 @@ import numpy as np
 from px4.msg import vehicle_control_mode
 from px4.msg import vehicle_local_position
 from px4.msg import vehicle_local_position_setpoint
+from px4.msg import vehicle_attitude
+from px4.msg import actuator_controls_0
 from std_msgs.msg import Header
 from geometry_msgs.msg import PoseStamped, Quaternion
 from tf.transformations import quaternion_from_euler
 from px4_test_helper import PX4TestHelper
+from perf_assertion import PerfAssertion
 
 #
 # Tests flying a path in offboard control by sending position setpoints
@@ -149,6 +152,14 @@ class MavrosOffboardPosctlTest(unittest.TestCase):
             (-2, -2, 2),
             (2, 2, 2))
 
+        # performance while flying the path, the telemetry of MAVROS included
+        perf = PerfAssertion()
+        perf.expect_rate("vehicle_attitude", vehicle_attitude, 50)
+        perf.expect_rate("actuator_controls_0", actuator_controls_0, 50)
+        perf.expect_latency("actuator_controls_0", actuator_controls_0, 20000)
+        perf.expect_rate("mavros/local_position/local", PoseStamped, 10)
+        perf.start()
+
         for i in range(0, len(positions)):
             self.reach_position(positions[i][0], positions[i][1], positions[i][2], 120)
 
@@ -164,6 +175,7 @@ class MavrosOffboardPosctlTest(unittest.TestCase):
         self.assertTrue(self.control_mode.flag_control_position_enabled, "flag_control_position_enabled is not set")
         self.assertTrue(self.control_mode.flag_control_offboard_enabled, "flag_control_offboard_enabled is not set")
         self.assertTrue(count == timeout, "position could not be held")
+        perf.check(self)
 
 
 if __name__ == '__main__':
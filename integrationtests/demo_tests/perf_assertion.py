@@ -0,0 +1,172 @@
+#!/usr/bin/env python
+#***************************************************************************
+#
+#   Copyright (c) 2015 PX4 Development Team. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name PX4 nor the names of its contributors may be
+#    used to endorse or promote products derived from this software
+#    without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+#***************************************************************************/
+
+import rospy
+import threading
+
+#
+# Helper to assert performance properties while a test flies.
+#
+# Every expectation subscribes to a topic when it is declared and is only
+# measured between start() and stop(). check() then fails the test case on any
+# expectation that is not met and logs all measurements, so a regression of a
+# rate, a latency or a load shows up as a failed run instead of a slower one.
+#
+class PerfAssertion(object):
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.expectations = []
+        self.subscribers = []
+        self.running = False
+        self.start_time = None
+        self.stop_time = None
+
+    #
+    # The topic is published at min_hz at least
+    #
+    def expect_rate(self, topic, msg_type, min_hz):
+        exp = {'kind': 'rate', 'topic': topic, 'limit': min_hz, 'count': 0}
+        self.add(exp, topic, msg_type, lambda data: self.count(exp))
+
+    #
+    # The 99th percentile of end_field - start_field of the messages is below
+    # max_us, e.g. the time from the attitude sample to the actuator output
+    #
+    def expect_latency(self, topic, msg_type, max_us, start_field='timestamp_sample', end_field='timestamp'):
+        exp = {'kind': 'latency', 'topic': topic, 'limit': max_us, 'samples': []}
+
+        def callback(data):
+            start = getattr(data, start_field)
+
+            # messages without a sample time are not a measurement
+            if start > 0:
+                self.sample(exp, getattr(data, end_field) - start)
+
+        self.add(exp, topic, msg_type, callback)
+
+    #
+    # A field of a statistics topic (e.g. the load of cpuload) stays below
+    # max_value. Topics only published by some setups pass when they are not
+    # required and never received.
+    #
+    def expect_max(self, topic, msg_type, field, max_value, required=True):
+        exp = {'kind': 'max', 'topic': topic + '/' + field, 'limit': max_value, 'samples': [],
+               'required': required}
+        self.add(exp, topic, msg_type, lambda data: self.sample(exp, getattr(data, field)))
+
+    def start(self):
+        with self.lock:
+            self.running = True
+            self.start_time = rospy.get_time()
+
+    def stop(self):
+        with self.lock:
+            self.running = False
+            self.stop_time = rospy.get_time()
+
+        for sub in self.subscribers:
+            sub.unregister()
+
+    #
+    # Fails test_case on the first expectation not met, after logging all of them
+    #
+    def check(self, test_case):
+        if self.running:
+            self.stop()
+
+        duration = max(self.stop_time - self.start_time, 1e-3)
+        failures = []
+
+        with self.lock:
+            for exp in self.expectations:
+                message = self.evaluate(exp, duration)
+
+                if message is not None:
+                    failures.append(message)
+
+        for message in failures:
+            rospy.logerr("perf: %s" % message)
+
+        test_case.assertTrue(len(failures) == 0, "performance: " + "; ".join(failures))
+
+    def evaluate(self, exp, duration):
+        if exp['kind'] == 'rate':
+            rate = exp['count'] / duration
+            rospy.loginfo("perf: %s %.1f Hz (min %.1f Hz)" % (exp['topic'], rate, exp['limit']))
+
+            if rate < exp['limit']:
+                return "%s at %.1f Hz, expected %.1f Hz" % (exp['topic'], rate, exp['limit'])
+
+            return None
+
+        samples = sorted(exp['samples'])
+
+        if len(samples) == 0:
+            if exp.get('required', True):
+                return "%s never received" % exp['topic']
+
+            rospy.logwarn("perf: %s not published, skipped" % exp['topic'])
+            return None
+
+        if exp['kind'] == 'latency':
+            value = samples[min(len(samples) - 1, int(len(samples) * 0.99))]
+            rospy.loginfo("perf: %s latency p99 %d us, max %d us (limit %d us)" %
+                          (exp['topic'], value, samples[-1], exp['limit']))
+
+            if value > exp['limit']:
+                return "%s latency p99 %d us, expected %d us" % (exp['topic'], value, exp['limit'])
+
+        else:
+            value = samples[-1]
+            rospy.loginfo("perf: %s max %s (limit %s)" % (exp['topic'], value, exp['limit']))
+
+            if value > exp['limit']:
+                return "%s reached %s, expected %s" % (exp['topic'], value, exp['limit'])
+
+        return None
+
+    def add(self, exp, topic, msg_type, callback):
+        self.expectations.append(exp)
+        self.subscribers.append(rospy.Subscriber(topic, msg_type, callback))
+
+    def count(self, exp):
+        with self.lock:
+            if self.running:
+                exp['count'] += 1
+
+    def sample(self, exp, value):
+        with self.lock:
+            if self.running:
+                exp['samples'].append(value)
@@ -28,6 +28,8 @@ MODULES		+= modules/sensors
 # System commands
 #
 MODULES		+= systemcmds/ver
+MODULES		+= systemcmds/parallel_start
+MODULES		+= systemcmds/boot_timing
 MODULES		+= systemcmds/mixer
 MODULES		+= systemcmds/param
 MODULES		+= systemcmds/perf
@@ -30,6 +30,8 @@ MODULES		+= systemcmds/tests
 MODULES		+= systemcmds/config
 MODULES		+= systemcmds/nshterm
 MODULES		+= systemcmds/ver
+MODULES		+= systemcmds/parallel_start
+MODULES		+= systemcmds/boot_timing
 
 #
 # Library modules
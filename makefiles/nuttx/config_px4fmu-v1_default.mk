@@ -54,6 +54,8 @@ MODULES		+= systemcmds/config
 MODULES		+= systemcmds/nshterm
 MODULES		+= systemcmds/dumpfile
 MODULES		+= systemcmds/ver
+MODULES		+= systemcmds/parallel_start
+MODULES		+= systemcmds/boot_timing
 
 #
 # General system control
@@ -56,6 +56,7 @@ MODULES		+= systemcmds/bl_update
 MODULES		+= systemcmds/mixer
 MODULES		+= systemcmds/param
 MODULES		+= systemcmds/perf
+MODULES		+= systemcmds/trace
 MODULES		+= systemcmds/pwm
 MODULES		+= systemcmds/esc_calib
 MODULES		+= systemcmds/reboot
@@ -65,6 +66,8 @@ MODULES		+= systemcmds/nshterm
 MODULES		+= systemcmds/mtd
 MODULES		+= systemcmds/dumpfile
 MODULES		+= systemcmds/ver
+MODULES		+= systemcmds/parallel_start
+MODULES		+= systemcmds/boot_timing
 
 #
 # General system control
@@ -99,6 +102,7 @@ MODULES 	+= modules/vtol_att_control
 # Logging
 #
 MODULES		+= modules/sdlog2
+MODULES		+= modules/load_mon
 
 #
 # Library modules
@@ -60,6 +60,8 @@ MODULES		+= systemcmds/nshterm
 MODULES		+= systemcmds/mtd
 MODULES		+= systemcmds/dumpfile
 MODULES		+= systemcmds/ver
+MODULES		+= systemcmds/parallel_start
+MODULES		+= systemcmds/boot_timing
 
 #
 # General system control
@@ -32,6 +32,7 @@ MODULES		+= drivers/meas_airspeed
 MODULES		+= systemcmds/perf
 MODULES		+= systemcmds/reboot
 MODULES		+= systemcmds/tests
+MODULES		+= systemcmds/platform_bench
 MODULES		+= systemcmds/nshterm
 MODULES		+= systemcmds/mtd
 MODULES		+= systemcmds/ver
@@ -74,6 +74,9 @@ ROMFS_AUTOSTART = $(PX4_BASE)/Tools/px_process_airframes.py
 # Remove all comments from startup and mixer files
 ROMFS_PRUNER	 = $(PX4_BASE)/Tools/px_romfs_pruner.py
 
+# Precompile mixer files to the binary format
+ROMFS_MIXER_COMPILER = $(PX4_BASE)/Tools/px_mixer_compile.py
+
 # Turn the ROMFS image into an object file
 $(ROMFS_OBJ): $(ROMFS_IMG) $(GLOBAL_DEPS)
 	$(call BIN_TO_OBJ,$<,$@,romfs_img)
@@ -98,6 +101,7 @@ endif
 	# so developers notice the generated file
 	$(Q) $(PYTHON) -u $(ROMFS_AUTOSTART)  -a $(ROMFS_ROOT)/init.d/ -s $(ROMFS_ROOT)/init.d/rc.autostart
 	$(Q) $(PYTHON) -u $(ROMFS_PRUNER) --folder $(ROMFS_SCRATCH)
+	$(Q) $(PYTHON) -u $(ROMFS_MIXER_COMPILER) --folder $(ROMFS_SCRATCH)
 
 EXTRA_CLEANS		+= $(ROMGS_OBJ) $(ROMFS_IMG)
 
@@ -47,6 +47,7 @@ MODULES		+= modules/systemlib/mixer
 MODULES		+= modules/uORB
 MODULES		+= modules/dataman
 MODULES		+= modules/sdlog2
+MODULES		+= modules/load_mon
 MODULES		+= modules/simulator
 MODULES		+= modules/commander
 MODULES 	+= modules/controllib
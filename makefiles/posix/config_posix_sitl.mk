@@ -21,9 +21,12 @@ MODULES		+= systemcmds/param
 MODULES		+= systemcmds/mixer
 #MODULES 	+= systemcmds/esc_calib
 MODULES		+= systemcmds/tests
+MODULES		+= systemcmds/platform_bench
 #MODULES 	+= systemcmds/reboot
 MODULES 	+= systemcmds/topic_listener
 MODULES		+= systemcmds/ver
+MODULES		+= systemcmds/trace
+MODULES		+= systemcmds/boot_timing
 MODULES		+= systemcmds/esc_calib
 MODULES		+= systemcmds/reboot
 
@@ -63,6 +66,7 @@ MODULES		+= modules/systemlib/mixer
 MODULES		+= modules/uORB
 MODULES		+= modules/dataman
 MODULES		+= modules/sdlog2
+MODULES		+= modules/load_mon
 MODULES		+= modules/simulator
 MODULES		+= modules/commander
 MODULES 	+= modules/controllib
@@ -105,3 +109,9 @@ MODULES	+= platforms/posix/tests/vcdev_test
 # muorb fastrpc changes.
 #
 #MODULES	+= $(PX4_BASE)../muorb_krait
+
+#
+# uORB between PX4 processes on the same host
+#
+MODULES	+= modules/muorb/shm
+MODULES	+= modules/muorb/udp
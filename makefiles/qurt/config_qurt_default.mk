@@ -22,6 +22,7 @@ MODULES		+= modules/sensors
 # System commands
 #
 MODULES	+= systemcmds/param
+MODULES	+= systemcmds/platform_bench
 
 #
 # General system control
@@ -92,6 +92,7 @@
 #define BATT_SMBUS_MANUFACTURE_NAME		0x20	///< manufacturer name
 #define BATT_SMBUS_MANUFACTURE_INFO		0x25	///< cell voltage register
 #define BATT_SMBUS_CURRENT			0x2a	///< current register
+#define BATT_SMBUS_MANUFACTURER_NAME_LEN	20	///< longest manufacturer name read from the battery
 #define BATT_SMBUS_MEASUREMENT_INTERVAL_MS	(1000000 / 10)	///< time in microseconds, measure at 10hz
 #define BATT_SMBUS_TIMEOUT_MS		10000000	///< timeout looking for battery 10seconds after startup
 
@@ -161,17 +162,52 @@ private:
 	 */
 	void			cycle();
 
+	/**
+	 * Read the pack data that does not change while the battery is connected
+	 * @return OK if the battery answered
+	 */
+	int			read_static();
+
+	/**
+	 * Completion callback of the queued voltage and current reads
+	 * @param arg points to the result of the read
+	 */
+	static void		result_callback(void *arg, int result);
+
+	/**
+	 * Completion callback of the last queued read, publishes the report
+	 */
+	static void		collect_callback(void *arg, int result);
+
+	/**
+	 * Publish a report from the buffers of the queued reads
+	 * @param remaining the remaining capacity in mAh, UINT16_MAX if unknown
+	 */
+	void			collect(uint16_t remaining);
+
 	/**
 	 * Read a word from specified register
 	 */
 	int			read_reg(uint8_t reg, uint16_t &val);
 
+	/**
+	 * Check the PEC of a word read into buff
+	 */
+	int			parse_word(uint8_t reg, const uint8_t buff[3], uint16_t &val) const;
+
 	/**
 	 * Read block from bus
 	 * @return returns number of characters read if successful, zero if unsuccessful
 	 */
 	uint8_t			read_block(uint8_t reg, uint8_t *data, uint8_t max_len, bool append_zero);
 
+	/**
+	 * Check the length and the PEC of a block read into buff
+	 * @return returns number of characters copied to data if valid, zero if not
+	 */
+	uint8_t			parse_block(uint8_t reg, const uint8_t *buff, uint8_t *data, uint8_t max_len,
+					    bool append_zero) const;
+
 	/**
 	 * Calculate PEC for a read or write from the battery
 	 * @param buff is the data that was read or will be written
@@ -187,6 +223,25 @@ private:
 	orb_id_t		_batt_orb_id;	///< uORB battery topic ID
 	uint64_t		_start_time;	///< system time we first attempt to communicate with battery
 	uint16_t		_batt_capacity;	///< battery's design capacity in mAh (0 means unknown)
+
+	// pack data read once by read_static()
+	bool			_static_valid;	///< true once the pack data below has been read
+	uint16_t		_design_capacity;	///< design capacity in mAh
+	uint16_t		_design_voltage;	///< design voltage in mV
+	uint16_t		_serial_number;	///< serial number of the pack
+	char			_manufacturer_name[BATT_SMBUS_MANUFACTURER_NAME_LEN + 1];
+
+	// dynamic values, read through the I2C bus worker
+	const uint8_t		_dynamic_regs[3];	///< voltage, current and remaining capacity registers
+	async_transfer		_voltage_xfer;
+	async_transfer		_current_xfer;
+	async_transfer		_remaining_xfer;
+	uint8_t			_voltage_buf[3];	///< word and PEC
+	uint8_t			_current_buf[4 + 2];	///< length, 4 bytes and PEC
+	uint8_t			_remaining_buf[3];	///< word and PEC
+	int			_voltage_result;
+	int			_current_result;
+	perf_counter_t		_comms_errors;
 };
 
 namespace
@@ -206,8 +261,21 @@ BATT_SMBUS::BATT_SMBUS(int bus, uint16_t batt_smbus_addr) :
 	_batt_topic(nullptr),
 	_batt_orb_id(nullptr),
 	_start_time(0),
-	_batt_capacity(0)
+	_batt_capacity(0),
+	_static_valid(false),
+	_design_capacity(0),
+	_design_voltage(0),
+	_serial_number(0),
+	_dynamic_regs{BATT_SMBUS_VOLTAGE, BATT_SMBUS_CURRENT, BATT_SMBUS_REMAINING_CAPACITY},
+	_voltage_xfer{},
+	_current_xfer{},
+	_remaining_xfer{},
+	_voltage_result(-EIO),
+	_current_result(-EIO),
+	_comms_errors(perf_alloc(PC_COUNT, "batt_smbus_comms_errors"))
 {
+	_manufacturer_name[0] = '\0';
+
 	// work_cancel in the dtor will explode if we don't do this...
 	memset(&_work, 0, sizeof(_work));
 
@@ -223,6 +291,8 @@ BATT_SMBUS::~BATT_SMBUS()
 	if (_reports != nullptr) {
 		delete _reports;
 	}
+
+	perf_free(_comms_errors);
 }
 
 int
@@ -297,6 +367,11 @@ BATT_SMBUS::test()
 
 		if (updated) {
 			if (orb_copy(ORB_ID(battery_status), sub, &status) == OK) {
+				if (_static_valid) {
+					warnx("%s SN:%u design %umAh %umV", _manufacturer_name, (unsigned)_serial_number,
+					      (unsigned)_design_capacity, (unsigned)_design_voltage);
+				}
+
 				warnx("V=%4.2f C=%4.2f DismAh=%4.2f Cap:%d", (float)status.voltage_v, (float)status.current_a,
 				      (float)status.discharged_mah, (int)_batt_capacity);
 			}
@@ -364,6 +439,11 @@ void
 BATT_SMBUS::stop()
 {
 	work_cancel(HPWORK, &_work);
+
+	// wait for queued reads, their callbacks use this instance
+	cancel_async(&_voltage_xfer);
+	cancel_async(&_current_xfer);
+	cancel_async(&_remaining_xfer);
 }
 
 void
@@ -386,44 +466,127 @@ BATT_SMBUS::cycle()
 		return;
 	}
 
+	// the pack data is read once, synchronously, when the battery first answers
+	if (!_static_valid && read_static() != OK) {
+		work_queue(HPWORK, &_work, (worker_t)&BATT_SMBUS::cycle_trampoline, this,
+			   USEC2TICK(BATT_SMBUS_MEASUREMENT_INTERVAL_MS));
+		return;
+	}
+
+	/*
+	 * Queue the reads of the dynamic values. SBS has no command returning
+	 * several of them at once, but the bus worker runs them back to back and
+	 * the callback of the last one publishes, so this work item doesn't wait
+	 * for the bus shared with the external sensors.
+	 */
+	if (_voltage_xfer.pending || _current_xfer.pending || _remaining_xfer.pending) {
+		// the previous reads are still queued behind other devices
+		perf_count(_comms_errors);
+
+	} else if (transfer_async(&_voltage_xfer, &_dynamic_regs[0], 1, _voltage_buf, sizeof(_voltage_buf),
+				  &BATT_SMBUS::result_callback, &_voltage_result) != OK
+		   || transfer_async(&_current_xfer, &_dynamic_regs[1], 1, _current_buf, sizeof(_current_buf),
+				     &BATT_SMBUS::result_callback, &_current_result) != OK
+		   || transfer_async(&_remaining_xfer, &_dynamic_regs[2], 1, _remaining_buf, sizeof(_remaining_buf),
+				     &BATT_SMBUS::collect_callback, this) != OK) {
+		perf_count(_comms_errors);
+	}
+
+	// schedule a fresh cycle call when the measurement is done
+	work_queue(HPWORK, &_work, (worker_t)&BATT_SMBUS::cycle_trampoline, this,
+		   USEC2TICK(BATT_SMBUS_MEASUREMENT_INTERVAL_MS));
+}
+
+int
+BATT_SMBUS::read_static()
+{
+	uint16_t tmp;
+
+	// the battery capacity when fully charged, used for the discharged capacity
+	if (read_reg(BATT_SMBUS_FULL_CHARGE_CAPACITY, tmp) != OK) {
+		return -EIO;
+	}
+
+	_batt_capacity = tmp;
+
+	// the rest is informational only
+	if (read_reg(BATT_SMBUS_DESIGN_CAPACITY, tmp) == OK) {
+		_design_capacity = tmp;
+	}
+
+	if (read_reg(BATT_SMBUS_DESIGN_VOLTAGE, tmp) == OK) {
+		_design_voltage = tmp;
+	}
+
+	if (read_reg(BATT_SMBUS_SERIALNUM, tmp) == OK) {
+		_serial_number = tmp;
+	}
+
+	if (read_block(BATT_SMBUS_MANUFACTURE_NAME, (uint8_t *)_manufacturer_name, BATT_SMBUS_MANUFACTURER_NAME_LEN,
+		       true) == 0) {
+		_manufacturer_name[0] = '\0';
+	}
+
+	_static_valid = true;
+
+	return OK;
+}
+
+void
+BATT_SMBUS::result_callback(void *arg, int result)
+{
+	*(int *)arg = result;
+}
+
+void
+BATT_SMBUS::collect_callback(void *arg, int result)
+{
+	BATT_SMBUS *dev = (BATT_SMBUS *)arg;
+
+	// the voltage and current reads were queued before and have completed
+	if (result != OK || dev->_voltage_result != OK) {
+		perf_count(dev->_comms_errors);
+	}
+
+	uint16_t remaining;
+
+	if (result != OK || dev->parse_word(BATT_SMBUS_REMAINING_CAPACITY, dev->_remaining_buf, remaining) != OK) {
+		remaining = UINT16_MAX;
+	}
+
+	dev->collect(remaining);
+}
+
+void
+BATT_SMBUS::collect(uint16_t remaining)
+{
 	// read data from sensor
 	struct battery_status_s new_report;
 
-	// set time of reading
-	new_report.timestamp = now;
-
 	// read voltage
 	uint16_t tmp;
 
-	if (read_reg(BATT_SMBUS_VOLTAGE, tmp) == OK) {
+	if (_voltage_result == OK && parse_word(BATT_SMBUS_VOLTAGE, _voltage_buf, tmp) == OK) {
 		// initialise new_report
 		memset(&new_report, 0, sizeof(new_report));
 
+		// set time of reading
+		new_report.timestamp = hrt_absolute_time();
+
 		// convert millivolts to volts
 		new_report.voltage_v = ((float)tmp) / 1000.0f;
 
 		// read current
 		uint8_t buff[4];
 
-		if (read_block(BATT_SMBUS_CURRENT, buff, 4, false) == 4) {
+		if (_current_result == OK && parse_block(BATT_SMBUS_CURRENT, _current_buf, buff, 4, false) == 4) {
 			new_report.current_a = -(float)((int32_t)((uint32_t)buff[3] << 24 | (uint32_t)buff[2] << 16 | (uint32_t)buff[1] << 8 |
 							(uint32_t)buff[0])) / 1000.0f;
 		}
 
-		// read battery design capacity
-		if (_batt_capacity == 0) {
-			if (read_reg(BATT_SMBUS_FULL_CHARGE_CAPACITY, tmp) == OK) {
-				_batt_capacity = tmp;
-			}
-		}
-
 		// read remaining capacity
-		if (_batt_capacity > 0) {
-			if (read_reg(BATT_SMBUS_REMAINING_CAPACITY, tmp) == OK) {
-				if (tmp < _batt_capacity) {
-					new_report.discharged_mah = _batt_capacity - tmp;
-				}
-			}
+		if (_batt_capacity > 0 && remaining < _batt_capacity) {
+			new_report.discharged_mah = _batt_capacity - remaining;
 		}
 
 		// publish to orb
@@ -434,7 +597,8 @@ BATT_SMBUS::cycle()
 			_batt_topic = orb_advertise(_batt_orb_id, &new_report);
 
 			if (_batt_topic == nullptr) {
-				errx(1, "ADVERT FAIL");
+				warnx("ADVERT FAIL");
+				return;
 			}
 		}
 
@@ -450,10 +614,6 @@ BATT_SMBUS::cycle()
 		// record we are working
 		_enabled = true;
 	}
-
-	// schedule a fresh cycle call when the measurement is done
-	work_queue(HPWORK, &_work, (worker_t)&BATT_SMBUS::cycle_trampoline, this,
-		   USEC2TICK(BATT_SMBUS_MEASUREMENT_INTERVAL_MS));
 }
 
 int
@@ -465,21 +625,28 @@ BATT_SMBUS::read_reg(uint8_t reg, uint16_t &val)
 	int ret = transfer(&reg, 1, buff, 3);
 
 	if (ret == OK) {
-		// check PEC
-		uint8_t pec = get_PEC(reg, true, buff, 2);
-
-		if (pec == buff[2]) {
-			val = (uint16_t)buff[1] << 8 | (uint16_t)buff[0];
-
-		} else {
-			ret = ENOTTY;
-		}
+		ret = parse_word(reg, buff, val);
 	}
 
 	// return success or failure
 	return ret;
 }
 
+int
+BATT_SMBUS::parse_word(uint8_t reg, const uint8_t buff[3], uint16_t &val) const
+{
+	// check PEC
+	uint8_t pec = get_PEC(reg, true, buff, 2);
+
+	if (pec != buff[2]) {
+		return ENOTTY;
+	}
+
+	val = (uint16_t)buff[1] << 8 | (uint16_t)buff[0];
+
+	return OK;
+}
+
 uint8_t
 BATT_SMBUS::read_block(uint8_t reg, uint8_t *data, uint8_t max_len, bool append_zero)
 {
@@ -493,6 +660,12 @@ BATT_SMBUS::read_block(uint8_t reg, uint8_t *data, uint8_t max_len, bool append_
 		return 0;
 	}
 
+	return parse_block(reg, buff, data, max_len, append_zero);
+}
+
+uint8_t
+BATT_SMBUS::parse_block(uint8_t reg, const uint8_t *buff, uint8_t *data, uint8_t max_len, bool append_zero) const
+{
 	// get length
 	uint8_t bufflen = buff[0];
 
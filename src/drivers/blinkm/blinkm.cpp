@@ -214,7 +214,10 @@ private:
 
 	int num_of_used_sats;
 
+	int shown_color;	/* colour the BlinkM is showing, -1 if unknown */
+
 	void 			setLEDColor(int ledcolor);
+	int			stepColor(int step, int color);
 	static void		led_trampoline(void *arg);
 	void			led();
 
@@ -304,7 +307,8 @@ BlinkM::BlinkM(int bus, int blinkm) :
 	topic_initialized(false),
 	detected_cells_blinked(false),
 	led_thread_ready(true),
-	num_of_used_sats(0)
+	num_of_used_sats(0),
+	shown_color(-1)
 {
 	memset(&_work, 0, sizeof(_work));
 }
@@ -337,6 +341,7 @@ BlinkM::setMode(int mode)
 		if (systemstate_run == false) {
 			stop_script();
 			set_rgb(0, 0, 0);
+			shown_color = LED_OFF;
 			systemstate_run = true;
 			work_queue(LPWORK, &_work, (worker_t)&BlinkM::led_trampoline, this, 1);
 		}
@@ -495,18 +500,8 @@ BlinkM::led()
 		led_thread_ready = false;
 	}
 
-	if (led_thread_runcount & 1) {
-		if (t_led_blink) {
-			setLEDColor(LED_OFF);
-		}
-
-		led_interval = LED_OFFTIME;
-
-	} else {
-		setLEDColor(t_led_color[(led_thread_runcount / 2) % 8]);
-		//led_interval = (led_thread_runcount & 1) : LED_ONTIME;
-		led_interval = LED_ONTIME;
-	}
+	setLEDColor(stepColor(led_thread_runcount, shown_color));
+	led_interval = (led_thread_runcount & 1) ? LED_OFFTIME : LED_ONTIME;
 
 	if (led_thread_runcount == 15) {
 		/* obtained data for the first file descriptor */
@@ -774,6 +769,15 @@ BlinkM::led()
 		}
 
 	} else {
+		/*
+		 * Sleep over the steps that would show the same colour again, but
+		 * not over step 15, which reads the vehicle state.
+		 */
+		while (led_thread_runcount < 14 && stepColor(led_thread_runcount + 1, shown_color) == shown_color) {
+			led_thread_runcount++;
+			led_interval += (led_thread_runcount & 1) ? LED_OFFTIME : LED_ONTIME;
+		}
+
 		led_thread_runcount++;
 	}
 
@@ -784,52 +788,76 @@ BlinkM::led()
 	} else {
 		stop_script();
 		set_rgb(0, 0, 0);
+		shown_color = -1;
+	}
+}
+
+/*
+ * Colour of a step of the pattern: the even steps show the colours in turn,
+ * the odd ones switch off when blinking and keep the colour otherwise.
+ */
+int BlinkM::stepColor(int step, int color)
+{
+	if (step & 1) {
+		return t_led_blink ? LED_OFF : color;
 	}
+
+	return t_led_color[(step / 2) % 8];
 }
 
 void BlinkM::setLEDColor(int ledcolor)
 {
+	/* the BlinkM keeps the colour, writing it again only loads the bus */
+	if (ledcolor == shown_color) {
+		return;
+	}
+
+	int ret = -1;
+
 	switch (ledcolor) {
 	case LED_OFF:	// off
-		set_rgb(0, 0, 0);
+		ret = set_rgb(0, 0, 0);
 		break;
 
 	case LED_RED:	// red
-		set_rgb(255, 0, 0);
+		ret = set_rgb(255, 0, 0);
 		break;
 
 	case LED_ORANGE:	// orange
-		set_rgb(255, 150, 0);
+		ret = set_rgb(255, 150, 0);
 		break;
 
 	case LED_YELLOW:	// yellow
-		set_rgb(200, 200, 0);
+		ret = set_rgb(200, 200, 0);
 		break;
 
 	case LED_PURPLE:	// purple
-		set_rgb(255, 0, 255);
+		ret = set_rgb(255, 0, 255);
 		break;
 
 	case LED_GREEN:	// green
-		set_rgb(0, 255, 0);
+		ret = set_rgb(0, 255, 0);
 		break;
 
 	case LED_BLUE:	// blue
-		set_rgb(0, 0, 255);
+		ret = set_rgb(0, 0, 255);
 		break;
 
 	case LED_CYAN:	// cyan
-		set_rgb(0, 128, 128);
+		ret = set_rgb(0, 128, 128);
 		break;
 
 	case LED_WHITE:	// white
-		set_rgb(255, 255, 255);
+		ret = set_rgb(255, 255, 255);
 		break;
 
 	case LED_AMBER:	// amber
-		set_rgb(255, 65, 0);
+		ret = set_rgb(255, 65, 0);
 		break;
 	}
+
+	/* after a failure the colour is unknown and written again on the next step */
+	shown_color = (ret == OK) ? ledcolor : -1;
 }
 
 int
@@ -845,6 +873,9 @@ BlinkM::fade_rgb(uint8_t r, uint8_t g, uint8_t b)
 {
 	const uint8_t msg[4] = { 'c', r, g, b };
 
+	/* the colour changes without setLEDColor() */
+	shown_color = -1;
+
 	return transfer(msg, sizeof(msg), nullptr, 0);
 }
 
@@ -853,6 +884,8 @@ BlinkM::fade_hsb(uint8_t h, uint8_t s, uint8_t b)
 {
 	const uint8_t msg[4] = { 'h', h, s, b };
 
+	shown_color = -1;
+
 	return transfer(msg, sizeof(msg), nullptr, 0);
 }
 
@@ -861,6 +894,8 @@ BlinkM::fade_rgb_random(uint8_t r, uint8_t g, uint8_t b)
 {
 	const uint8_t msg[4] = { 'C', r, g, b };
 
+	shown_color = -1;
+
 	return transfer(msg, sizeof(msg), nullptr, 0);
 }
 
@@ -869,6 +904,8 @@ BlinkM::fade_hsb_random(uint8_t h, uint8_t s, uint8_t b)
 {
 	const uint8_t msg[4] = { 'H', h, s, b };
 
+	shown_color = -1;
+
 	return transfer(msg, sizeof(msg), nullptr, 0);
 }
 
@@ -885,6 +922,8 @@ BlinkM::play_script(uint8_t script_id)
 {
 	const uint8_t msg[4] = { 'p', script_id, 0, 0 };
 
+	shown_color = -1;
+
 	return transfer(msg, sizeof(msg), nullptr, 0);
 }
 
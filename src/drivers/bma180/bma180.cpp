@@ -254,6 +254,8 @@ BMA180::BMA180(int bus, spi_dev_e device) :
 	_accel_scale.y_scale  = 1.0f;
 	_accel_scale.z_offset = 0;
 	_accel_scale.z_scale  = 1.0f;
+
+	memset(&_call, 0, sizeof(_call));
 }
 
 BMA180::~BMA180()
@@ -119,6 +119,9 @@ __BEGIN_DECLS
  */
 #define ADC_CHANNELS (1 << 10) | (1 << 11) | (1 << 12) | (1 << 13)
 
+/* DMA stream the adc driver uses to scan the channels */
+#define ADC_DMAMAP	DMAMAP_ADC1_1
+
 // ADC defines to be used in sensors.cpp to read from a particular channel
 #define ADC_BATTERY_VOLTAGE_CHANNEL	10
 #define ADC_BATTERY_CURRENT_CHANNEL	((uint8_t)(-1))
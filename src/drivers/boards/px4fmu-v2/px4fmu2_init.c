@@ -51,6 +51,7 @@
 #include <stdio.h>
 #include <debug.h>
 #include <errno.h>
+#include <string.h>
 
 #include <nuttx/arch.h>
 #include <nuttx/spi.h>
@@ -105,6 +106,10 @@ __BEGIN_DECLS
 extern void led_init(void);
 extern void led_on(int led);
 extern void led_off(int led);
+
+/* bounds of the __CCM data, from the linker script */
+extern uint8_t _sccm[];
+extern uint8_t _eccm[];
 __END_DECLS
 
 /****************************************************************************
@@ -188,6 +193,9 @@ fat_dma_free(FAR void *memory, size_t size)
 __EXPORT void
 stm32_boardinitialize(void)
 {
+	/* the __CCM data is not loaded, zero it before anything uses it */
+	memset(_sccm, 0, _eccm - _sccm);
+
 	/* configure SPI interfaces */
 	stm32_spiinitialize();
 
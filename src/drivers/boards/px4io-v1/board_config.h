@@ -86,6 +86,14 @@
 #define GPIO_ADC_VBATT	(GPIO_INPUT|GPIO_CNF_ANALOGIN|GPIO_MODE_INPUT|GPIO_PORTA|GPIO_PIN4)
 #define GPIO_ADC_IN5	(GPIO_INPUT|GPIO_CNF_ANALOGIN|GPIO_MODE_INPUT|GPIO_PORTA|GPIO_PIN5)
 
+/* S.Bus serial port ****************************************************************/
+
+#define PX4IO_SBUS_SERIAL_BASE		STM32_USART3_BASE
+#define PX4IO_SBUS_SERIAL_VECTOR	STM32_IRQ_USART3
+#define PX4IO_SBUS_SERIAL_TX_GPIO	GPIO_USART3_TX
+#define PX4IO_SBUS_SERIAL_RX_GPIO	GPIO_USART3_RX
+#define PX4IO_SBUS_SERIAL_CLOCK		STM32_PCLK1_FREQUENCY
+
 /* 
  * High-resolution timer
  */
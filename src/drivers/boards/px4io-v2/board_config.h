@@ -68,6 +68,12 @@
 #define PX4FMU_SERIAL_CLOCK	STM32_PCLK1_FREQUENCY
 #define PX4FMU_SERIAL_BITRATE	1500000
 
+#define PX4IO_SBUS_SERIAL_BASE		STM32_USART3_BASE
+#define PX4IO_SBUS_SERIAL_VECTOR	STM32_IRQ_USART3
+#define PX4IO_SBUS_SERIAL_TX_GPIO	GPIO_USART3_TX
+#define PX4IO_SBUS_SERIAL_RX_GPIO	GPIO_USART3_RX
+#define PX4IO_SBUS_SERIAL_CLOCK		STM32_PCLK1_FREQUENCY
+
 /******************************************************************************
  * GPIOS
  ******************************************************************************/
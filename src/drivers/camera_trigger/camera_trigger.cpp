@@ -62,6 +62,9 @@
 
 #define TRIGGER_PIN_DEFAULT 1
 
+/* queued trigger events, covers the shortest TRIG_INTERVAL (4 ms) at a 50 Hz reader */
+#define TRIGGER_ORB_QUEUE_SIZE	5
+
 extern "C" __EXPORT int camera_trigger_main(int argc, char *argv[]);
 
 class CameraTrigger
@@ -100,6 +103,15 @@ public:
 	int			_pins[6];
 
 private:
+	/**
+	 * Capture input interrupt, see TRIG_FEEDBACK
+	 */
+	static int	capture_isr(int irq, void *context);
+
+	/**
+	 * Publish a trigger event
+	 */
+	void		publish(hrt_abstime timestamp, uint32_t seq);
 
 	struct hrt_call		_engagecall;
 	struct hrt_call		_disengagecall;
@@ -114,6 +126,11 @@ private:
 	uint32_t 		_trigger_seq;
 	bool	 		_trigger_enabled;
 
+	int			_feedback_pin;		/**< capture input, -1 if the trigger time is published */
+	volatile bool		_capture_pending;	/**< a trigger is waiting for its capture */
+	hrt_abstime		_pending_time;
+	uint32_t		_pending_seq;
+
 	int			_vcommand_sub;
 
 	orb_advert_t		_trigger_pub;
@@ -123,6 +140,7 @@ private:
 	param_t _p_activation_time;
 	param_t _p_interval;
 	param_t _p_pin;
+	param_t _p_feedback;
 
 	static constexpr uint32_t _gpios[6] = {
 		GPIO_GPIO0_OUTPUT,
@@ -133,6 +151,15 @@ private:
 		GPIO_GPIO5_OUTPUT
 	};
 
+	static constexpr uint32_t _gpios_in[6] = {
+		GPIO_GPIO0_INPUT,
+		GPIO_GPIO1_INPUT,
+		GPIO_GPIO2_INPUT,
+		GPIO_GPIO3_INPUT,
+		GPIO_GPIO4_INPUT,
+		GPIO_GPIO5_INPUT
+	};
+
 	/**
 	 * Vehicle command handler
 	 */
@@ -150,6 +177,7 @@ private:
 
 struct work_s CameraTrigger::_work;
 constexpr uint32_t CameraTrigger::_gpios[6];
+constexpr uint32_t CameraTrigger::_gpios_in[6];
 
 namespace camera_trigger
 {
@@ -168,6 +196,10 @@ CameraTrigger::CameraTrigger() :
 	_interval(100.0f /* ms */),
 	_trigger_seq(0),
 	_trigger_enabled(false),
+	_feedback_pin(-1),
+	_capture_pending(false),
+	_pending_time(0),
+	_pending_seq(0),
 	_vcommand_sub(-1),
 	_trigger_pub(nullptr)
 {
@@ -179,6 +211,7 @@ CameraTrigger::CameraTrigger() :
 	_p_activation_time = param_find("TRIG_ACT_TIME");
 	_p_mode = param_find("TRIG_MODE");
 	_p_pin = param_find("TRIG_PINS");
+	_p_feedback = param_find("TRIG_FEEDBACK");
 
 	param_get(_p_polarity, &_polarity);
 	param_get(_p_activation_time, &_activation_time);
@@ -186,6 +219,10 @@ CameraTrigger::CameraTrigger() :
 	param_get(_p_mode, &_mode);
 	int pin_list;
 	param_get(_p_pin, &pin_list);
+	param_get(_p_feedback, &_feedback_pin);
+
+	// 1-6 to the pin index, anything else disables the capture
+	_feedback_pin = (_feedback_pin >= 1 && _feedback_pin <= 6) ? _feedback_pin - 1 : -1;
 
 	// Set all pins as invalid
 	for (unsigned i = 0; i < sizeof(_pins) / sizeof(_pins[0]); i++) {
@@ -203,13 +240,19 @@ CameraTrigger::CameraTrigger() :
 			_pins[i] = -1;
 		}
 
+		// the capture input can not drive the trigger at the same time
+		if (_pins[i] == _feedback_pin) {
+			_pins[i] = -1;
+		}
+
 		pin_list /= 10;
 		i++;
 	}
 
 	struct camera_trigger_s	trigger = {};
 
-	_trigger_pub = orb_advertise(ORB_ID(camera_trigger), &trigger);
+	// queued, at short intervals several events may be published between two reads
+	_trigger_pub = orb_advertise_queue(ORB_ID(camera_trigger), &trigger, TRIGGER_ORB_QUEUE_SIZE);
 }
 
 CameraTrigger::~CameraTrigger()
@@ -248,8 +291,15 @@ CameraTrigger::start()
 {
 
 	for (unsigned i = 0; i < sizeof(_pins) / sizeof(_pins[0]); i++) {
-		stm32_configgpio(_gpios[_pins[i]]);
-		stm32_gpiowrite(_gpios[_pins[i]], !_polarity);	
+		if (_pins[i] >= 0) {
+			stm32_configgpio(_gpios[_pins[i]]);
+			stm32_gpiowrite(_gpios[_pins[i]], !_polarity);
+		}
+	}
+
+	// timestamp the exposure on the falling edge of the camera's feedback (hot shoe) signal
+	if (_feedback_pin >= 0) {
+		stm32_gpiosetevent(_gpios_in[_feedback_pin], false, true, false, &CameraTrigger::capture_isr);
 	}
 
 	// enable immediate if configured that way
@@ -257,17 +307,22 @@ CameraTrigger::start()
 		control(true);
 	}
 
-	// start to monitor at high rate for trigger enable command
-	work_queue(LPWORK, &_work, (worker_t)&CameraTrigger::cycle_trampoline, this, USEC2TICK(1));
+	// handle the trigger enable command as soon as it is published
+	_vcommand_sub = orb_subscribe(ORB_ID(vehicle_command));
+	orb_register_work_callback(_vcommand_sub, LPWORK, &_work, &CameraTrigger::cycle_trampoline, this);
 }
 
 void
 CameraTrigger::stop()
 {
-	work_cancel(LPWORK, &_work);
+	orb_unsubscribe(_vcommand_sub);
 	hrt_cancel(&_engagecall);
 	hrt_cancel(&_disengagecall);
 
+	if (_feedback_pin >= 0) {
+		stm32_gpiosetevent(_gpios_in[_feedback_pin], false, false, false, nullptr);
+	}
+
 	if (camera_trigger::g_camera_trigger != nullptr) {
 		delete(camera_trigger::g_camera_trigger);
 	}
@@ -279,18 +334,10 @@ CameraTrigger::cycle_trampoline(void *arg)
 
 	CameraTrigger *trig = reinterpret_cast<CameraTrigger *>(arg);
 
-	if (trig->_vcommand_sub < 0) {
-		trig->_vcommand_sub = orb_subscribe(ORB_ID(vehicle_command));
-	}
-
 	bool updated;
-	orb_check(trig->_vcommand_sub, &updated);
-
-	// while the trigger is inactive it has to be ready
-	// to become active instantaneously
-	int poll_interval_usec = 5000;
 
-	if (updated) {
+	// runs on each vehicle_command publication, see start()
+	while (orb_check(trig->_vcommand_sub, &updated) == OK && updated) {
 
 		struct vehicle_command_s cmd;
 
@@ -308,15 +355,9 @@ CameraTrigger::cycle_trampoline(void *arg)
 
 			} else if (cmd.param1 >= 1.0f) {
 				trig->control(true);
-				// while the trigger is active there is no
-				// need to poll at a very high rate
-				poll_interval_usec = 100000;
 			}
 		}
 	}
-
-	work_queue(LPWORK, &_work, (worker_t)&CameraTrigger::cycle_trampoline,
-		camera_trigger::g_camera_trigger, USEC2TICK(poll_interval_usec));
 }
 
 void
@@ -325,10 +366,14 @@ CameraTrigger::engage(void *arg)
 
 	CameraTrigger *trig = reinterpret_cast<CameraTrigger *>(arg);
 
-	struct camera_trigger_s	trigger;
-
 	/* set timestamp the instant before the trigger goes off */
-	trigger.timestamp = hrt_absolute_time();
+	hrt_abstime now = hrt_absolute_time();
+
+	/* the previous trigger got no capture, publish it with its trigger time */
+	if (trig->_capture_pending) {
+		trig->_capture_pending = false;
+		trig->publish(trig->_pending_time, trig->_pending_seq);
+	}
 
 	for (unsigned i = 0; i < sizeof(trig->_pins) / sizeof(trig->_pins[0]); i++) {
 		if (trig->_pins[i] >= 0) {
@@ -337,9 +382,43 @@ CameraTrigger::engage(void *arg)
 		}
 	}
 
-	trigger.seq = trig->_trigger_seq++;
+	if (trig->_feedback_pin >= 0) {
+		/* published by the capture */
+		trig->_pending_time = now;
+		trig->_pending_seq = trig->_trigger_seq++;
+		trig->_capture_pending = true;
+
+	} else {
+		trig->publish(now, trig->_trigger_seq++);
+	}
+}
+
+int
+CameraTrigger::capture_isr(int irq, void *context)
+{
+	/* the hrt is read first, the exposure happened at this edge */
+	hrt_abstime now = hrt_absolute_time();
+
+	CameraTrigger *trig = camera_trigger::g_camera_trigger;
+
+	/* one capture per trigger, the hot shoe contact may bounce */
+	if (trig != nullptr && trig->_capture_pending) {
+		trig->_capture_pending = false;
+		trig->publish(now, trig->_pending_seq);
+	}
+
+	return OK;
+}
+
+void
+CameraTrigger::publish(hrt_abstime timestamp, uint32_t seq)
+{
+	struct camera_trigger_s	trigger;
+
+	trigger.timestamp = timestamp;
+	trigger.seq = seq;
 
-	orb_publish(ORB_ID(camera_trigger), trig->_trigger_pub, &trigger);
+	orb_publish(ORB_ID(camera_trigger), _trigger_pub, &trigger);
 }
 
 void
@@ -363,6 +442,7 @@ CameraTrigger::info()
 	warnx("pins 1-3 : %d,%d,%d polarity : %s", _pins[0], _pins[1], _pins[2],
 		_polarity ? "ACTIVE_HIGH" : "ACTIVE_LOW");
 	warnx("interval : %.2f", (double)_interval);
+	warnx("feedback : %d", _feedback_pin + 1);
 }
 
 static void usage()
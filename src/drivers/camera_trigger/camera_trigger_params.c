@@ -95,3 +95,18 @@ PARAM_DEFINE_INT32(TRIG_MODE, 0);
  * @group Camera trigger
  */
 PARAM_DEFINE_INT32(TRIG_PINS, 12);
+
+/**
+ * Camera capture feedback pin
+ *
+ * Pin (1 to 6, AUX1-AUX6) connected to the camera's hot shoe or
+ * flash sync output. The falling edge is timestamped in its interrupt
+ * and published as the time of the image instead of the trigger time.
+ * A trigger without capture is published with its trigger time when
+ * the next one fires. 0 disables the capture.
+ *
+ * @min 0
+ * @max 6
+ * @group Camera trigger
+ */
+PARAM_DEFINE_INT32(TRIG_FEEDBACK, 0);
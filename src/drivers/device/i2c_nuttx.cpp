@@ -42,11 +42,22 @@
 
 #include "i2c.h"
 
+#include <px4_tasks.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 namespace device
 {
 
 unsigned int I2C::_bus_clocks[3] = { 100000, 100000, 100000 };
 
+I2C::async_queue I2C::_async_queues[3] = {};
+
+#define ASYNC_QUEUE_COUNT	(int)(sizeof(I2C::_async_queues) / sizeof(I2C::_async_queues[0]))
+
 I2C::I2C(const char *name,
 	 const char *devname,
 	 int bus,
@@ -181,6 +192,12 @@ I2C::probe()
 
 int
 I2C::transfer(const uint8_t *send, unsigned send_len, uint8_t *recv, unsigned recv_len)
+{
+	return _transfer(_address, send, send_len, recv, recv_len);
+}
+
+int
+I2C::_transfer(uint16_t address, const uint8_t *send, unsigned send_len, uint8_t *recv, unsigned recv_len)
 {
 	struct i2c_msg_s msgv[2];
 	unsigned msgs;
@@ -193,7 +210,7 @@ I2C::transfer(const uint8_t *send, unsigned send_len, uint8_t *recv, unsigned re
 		msgs = 0;
 
 		if (send_len > 0) {
-			msgv[msgs].addr = _address;
+			msgv[msgs].addr = address;
 			msgv[msgs].flags = 0;
 			msgv[msgs].buffer = const_cast<uint8_t *>(send);
 			msgv[msgs].length = send_len;
@@ -201,7 +218,7 @@ I2C::transfer(const uint8_t *send, unsigned send_len, uint8_t *recv, unsigned re
 		}
 
 		if (recv_len > 0) {
-			msgv[msgs].addr = _address;
+			msgv[msgs].addr = address;
 			msgv[msgs].flags = I2C_M_READ;
 			msgv[msgs].buffer = recv;
 			msgv[msgs].length = recv_len;
@@ -254,4 +271,180 @@ I2C::transfer(i2c_msg_s *msgv, unsigned msgs)
 	return ret;
 }
 
+int
+I2C::transfer_async(struct async_transfer *xfer, const uint8_t *send, unsigned send_len,
+		    uint8_t *recv, unsigned recv_len, async_callback_t callback, void *arg)
+{
+	if ((send_len == 0) && (recv_len == 0))
+		return -EINVAL;
+
+	if (_bus < 1 || _bus > ASYNC_QUEUE_COUNT)
+		return -EINVAL;
+
+	async_queue *q = &_async_queues[_bus - 1];
+
+	// start the worker of this bus on first use
+	if (q->task <= 0) {
+		int ret = OK;
+
+		sched_lock();
+
+		if (q->task <= 0) {
+			char bus_arg[4];
+			char *argv[] = { bus_arg, nullptr };
+			char name[8];
+
+			snprintf(bus_arg, sizeof(bus_arg), "%d", _bus);
+			snprintf(name, sizeof(name), "i2c%d", _bus);
+
+			sem_init(&q->pending, 0, 0);
+
+			q->task = px4_task_spawn_cmd(name,
+						     SCHED_DEFAULT,
+						     SCHED_PRIORITY_MAX - 15,
+						     1200,
+						     (main_t)&I2C::async_task_main,
+						     argv);
+
+			if (q->task < 0) {
+				DEVICE_DEBUG("failed to start i2c%d worker", _bus);
+				ret = -errno;
+			}
+		}
+
+		sched_unlock();
+
+		if (ret != OK)
+			return ret;
+	}
+
+	irqstate_t flags = irqsave();
+
+	if (xfer->pending) {
+		irqrestore(flags);
+		return -EBUSY;
+	}
+
+	xfer->next = nullptr;
+	xfer->dev = this;
+	xfer->address = _address;
+	xfer->send = send;
+	xfer->send_len = send_len;
+	xfer->recv = recv;
+	xfer->recv_len = recv_len;
+	xfer->callback = callback;
+	xfer->arg = arg;
+	xfer->pending = true;
+
+	if (q->tail == nullptr) {
+		q->head = xfer;
+
+	} else {
+		q->tail->next = xfer;
+	}
+
+	q->tail = xfer;
+
+	irqrestore(flags);
+
+	sem_post(&q->pending);
+
+	return OK;
+}
+
+void
+I2C::cancel_async(struct async_transfer *xfer)
+{
+	if (_bus < 1 || _bus > ASYNC_QUEUE_COUNT)
+		return;
+
+	async_queue *q = &_async_queues[_bus - 1];
+	bool busy;
+
+	do {
+		irqstate_t flags = irqsave();
+
+		if (xfer->pending && (q->active != xfer)) {
+			// not started yet, take it out of the queue
+			async_transfer *prev = nullptr;
+
+			for (async_transfer *t = q->head; t != nullptr; prev = t, t = t->next) {
+				if (t == xfer) {
+					if (prev == nullptr) {
+						q->head = t->next;
+
+					} else {
+						prev->next = t->next;
+					}
+
+					if (q->tail == t) {
+						q->tail = prev;
+					}
+
+					break;
+				}
+			}
+
+			// the worker skips the semaphore count of the removed entry
+			xfer->pending = false;
+		}
+
+		// running, or its callback is, wait for it to finish
+		busy = xfer->pending || (q->active == xfer);
+
+		irqrestore(flags);
+
+		if (busy) {
+			usleep(1000);
+		}
+
+	} while (busy);
+}
+
+int
+I2C::async_task_main(int argc, char *argv[])
+{
+	async_queue *q = &_async_queues[atoi(argv[1]) - 1];
+
+	for (;;) {
+		sem_wait(&q->pending);
+
+		irqstate_t flags = irqsave();
+		async_transfer *xfer = q->head;
+
+		if (xfer != nullptr) {
+			q->head = xfer->next;
+
+			if (q->head == nullptr) {
+				q->tail = nullptr;
+			}
+
+			q->active = xfer;
+		}
+
+		irqrestore(flags);
+
+		if (xfer == nullptr) {
+			// cancelled before it started
+			continue;
+		}
+
+		int ret = xfer->dev->_transfer(xfer->address, xfer->send, xfer->send_len,
+					       xfer->recv, xfer->recv_len);
+
+		// the callback may queue the entry again
+		xfer->pending = false;
+
+		if (xfer->callback != nullptr) {
+			xfer->callback(xfer->arg, ret);
+		}
+
+		flags = irqsave();
+		q->active = nullptr;
+		irqrestore(flags);
+	}
+
+	return 0;
+}
+
 } // namespace device
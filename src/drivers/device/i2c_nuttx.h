@@ -126,6 +126,73 @@ protected:
 	 */
 	int		transfer(px4_i2c_msg_t *msgv, unsigned msgs);
 
+	/**
+	 * Completion callback of an asynchronous transfer.
+	 *
+	 * Called from the bus worker task once the transaction has
+	 * finished, successfully or not.
+	 *
+	 * @param arg		The argument passed to transfer_async.
+	 * @param result	OK if the transfer was successful, -errno
+	 *			otherwise.
+	 */
+	typedef void (*async_callback_t)(void *arg, int result);
+
+	/**
+	 * State of a queued transfer, owned by the caller.
+	 *
+	 * The buffers must stay valid and the entry must not be reused
+	 * until the transfer has completed.
+	 */
+	struct async_transfer {
+		struct async_transfer	*next;
+		I2C			*dev;
+		uint16_t		address;
+		const uint8_t		*send;
+		unsigned		send_len;
+		uint8_t			*recv;
+		unsigned		recv_len;
+		async_callback_t	callback;
+		void			*arg;
+		volatile bool		pending;
+	};
+
+	/**
+	 * Queue an I2C transaction to the device.
+	 *
+	 * The transaction is run by a worker task of the bus, so the caller
+	 * (typically a work queue item) does not block for the duration of
+	 * the transfer, including retries of a device that does not answer.
+	 * Transactions on one bus run in the order they were queued.
+	 *
+	 * The current bus address is captured when the transfer is queued.
+	 *
+	 * @param xfer		Transfer state, must not be pending.
+	 * @param send		Pointer to bytes to send.
+	 * @param send_len	Number of bytes to send.
+	 * @param recv		Pointer to buffer for bytes received.
+	 * @param recv_len	Number of bytes to receive.
+	 * @param callback	Called on completion, may be nullptr.
+	 * @param arg		Argument passed to the callback.
+	 * @return		OK if the transfer was queued, -EBUSY if xfer is
+	 *			still pending, -errno otherwise.
+	 */
+	int		transfer_async(struct async_transfer *xfer,
+				       const uint8_t *send, unsigned send_len,
+				       uint8_t *recv, unsigned recv_len,
+				       async_callback_t callback, void *arg);
+
+	/**
+	 * Cancel a queued transfer.
+	 *
+	 * A transfer that has not started yet is removed without calling its
+	 * callback. One that is running is waited for. On return the entry
+	 * and its buffers may be released.
+	 *
+	 * @param xfer		Transfer state passed to transfer_async.
+	 */
+	void		cancel_async(struct async_transfer *xfer);
+
 	/**
 	 * Change the bus address.
 	 *
@@ -144,6 +211,24 @@ private:
 	uint32_t		_frequency;
 	px4_i2c_dev_t		*_dev;
 
+	/**
+	 * Per-bus queue of asynchronous transfers and its worker task.
+	 */
+	struct async_queue {
+		struct async_transfer	*head;
+		struct async_transfer	*tail;
+		struct async_transfer	*active;
+		sem_t			pending;
+		int			task;
+	};
+
+	static struct async_queue	_async_queues[];
+
+	int		_transfer(uint16_t address, const uint8_t *send, unsigned send_len,
+				  uint8_t *recv, unsigned recv_len);
+
+	static int	async_task_main(int argc, char *argv[]);
+
 	I2C(const device::I2C &);
 	I2C operator=(const device::I2C &);
 };
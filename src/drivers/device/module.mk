@@ -42,7 +42,8 @@ SRCS =		  \
 		  i2c_nuttx.cpp \
 		  pio.cpp \
 		  spi.cpp \
-		  ringbuffer.cpp
+		  ringbuffer.cpp \
+		  rangefinder_rate.cpp
 else
 SRCS =		  \
 		  device_posix.cpp \
@@ -51,5 +52,6 @@ SRCS =		  \
 		  vdev_posix.cpp \
 		  i2c_posix.cpp  \
 		  sim.cpp \
-		  ringbuffer.cpp
+		  ringbuffer.cpp \
+		  rangefinder_rate.cpp
 endif
@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file rangefinder_rate.cpp
+ *
+ * Measurement rate control shared by the rangefinder drivers.
+ */
+
+#include "rangefinder_rate.h"
+
+#include <uORB/uORB.h>
+#include <uORB/topics/actuator_armed.h>
+
+namespace device
+{
+
+RangefinderRate::RangefinderRate(unsigned idle_ticks) :
+	_idle_ticks(idle_ticks),
+	_armed_sub(-1),
+	_armed(false),
+	_idle(false)
+{
+}
+
+RangefinderRate::~RangefinderRate()
+{
+	/*
+	 * The subscription belongs to the work queue task of the driver and
+	 * can not be closed from the task destroying the driver. It stays
+	 * open until the work queue exits.
+	 */
+}
+
+unsigned
+RangefinderRate::interval(unsigned requested_ticks, bool device_open)
+{
+	if (_armed_sub < 0) {
+		_armed_sub = orb_subscribe(ORB_ID(actuator_armed));
+	}
+
+	bool updated = false;
+
+	if (_armed_sub >= 0 && orb_check(_armed_sub, &updated) == 0 && updated) {
+		struct actuator_armed_s armed;
+
+		if (orb_copy(ORB_ID(actuator_armed), _armed_sub, &armed) == 0) {
+			_armed = armed.armed;
+		}
+	}
+
+	_idle = !_armed && !device_open && requested_ticks < _idle_ticks;
+
+	return _idle ? _idle_ticks : requested_ticks;
+}
+
+} // namespace device
@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file rangefinder_rate.h
+ *
+ * Measurement rate control shared by the rangefinder drivers.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* measurement interval of idle rangefinders, 5 Hz */
+#define RANGEFINDER_IDLE_INTERVAL	200000
+
+namespace device __EXPORT
+{
+
+/**
+ * Picks the interval between two measurements of a rangefinder.
+ *
+ * Rangefinders are used in flight (landing, terrain following), but the
+ * drivers measure from boot. While the vehicle is disarmed and no client
+ * has the device node open, the driver measures at the idle interval
+ * instead of the requested one, which saves bus transfers and work queue
+ * time. Arming, or opening the device, boosts it back at the next cycle.
+ */
+class RangefinderRate
+{
+public:
+	/**
+	 * @param idle_ticks	Interval in ticks while idle
+	 */
+	RangefinderRate(unsigned idle_ticks);
+	~RangefinderRate();
+
+	/**
+	 * Get the interval until the next measurement.
+	 *
+	 * Polls the arming state, so call it from the driver's cycle: the
+	 * subscription is opened on first use and belongs to that task.
+	 *
+	 * @param requested_ticks	Interval set with SENSORIOCSPOLLRATE
+	 * @param device_open		True if a client has the device open
+	 * @return			The requested interval, or the idle one if that is longer and the sensor is idle
+	 */
+	unsigned		interval(unsigned requested_ticks, bool device_open);
+
+	/**
+	 * @return		True if the last interval() returned the idle interval
+	 */
+	bool			idle() const { return _idle; }
+
+private:
+	unsigned		_idle_ticks;
+	int			_armed_sub;
+	bool			_armed;
+	bool			_idle;
+
+	/* do not allow to copy due to the subscription */
+	RangefinderRate(const RangefinderRate &);
+	RangefinderRate &operator=(const RangefinderRate &);
+};
+
+} // namespace device
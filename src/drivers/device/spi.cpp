@@ -46,6 +46,7 @@
  */
 
 #include <nuttx/arch.h>
+#include <stdio.h>
 
 #include "spi.h"
 
@@ -53,9 +54,21 @@
 # error This driver requires CONFIG_SPI_EXCHANGE
 #endif
 
+/*
+ * Number of SPI buses with a scheduler; bus numbers start at 1.
+ */
+#define SPI_BUS_SCHEDULE_MAX		6
+
+/*
+ * Calls due within this time of the earliest one run in the same slot.
+ */
+#define SPI_BUS_SCHEDULE_WINDOW		200
+
 namespace device
 {
 
+SPI::bus_schedule	SPI::_bus_schedules[SPI_BUS_SCHEDULE_MAX];
+
 SPI::SPI(const char *name,
 	 const char *devname,
 	 int bus,
@@ -73,6 +86,8 @@ SPI::SPI(const char *name,
 	_mode(mode),
 	_frequency(frequency),
 	_dev(nullptr),
+	_bus_perf_name{},
+	_bus_perf(nullptr),
 	_bus(bus)
 {
 	// fill in _device_id fields for a SPI device
@@ -81,11 +96,16 @@ SPI::SPI(const char *name,
 	_device_id.devid_s.address = (uint8_t)device;
 	// devtype needs to be filled in by the driver
 	_device_id.devid_s.devtype = 0; 
+
+	snprintf(_bus_perf_name, sizeof(_bus_perf_name), "%s_spi%d", name, bus);
+	_bus_perf = perf_alloc(PC_ELAPSED, _bus_perf_name);
 }
 
 SPI::~SPI()
 {
 	// XXX no way to let go of the bus...
+
+	perf_free(_bus_perf);
 }
 
 int
@@ -152,17 +172,23 @@ SPI::transfer(uint8_t *send, uint8_t *recv, unsigned len)
 	case LOCK_PREEMPTION:
 		{
 			irqstate_t state = irqsave();
+			perf_begin(_bus_perf);
 			result = _transfer(send, recv, len);
+			perf_end(_bus_perf);
 			irqrestore(state);
 		}
 		break;
 	case LOCK_THREADS:
 		SPI_LOCK(_dev, true);
+		perf_begin(_bus_perf);
 		result = _transfer(send, recv, len);
+		perf_end(_bus_perf);
 		SPI_LOCK(_dev, false);
 		break;
 	case LOCK_NONE:
+		perf_begin(_bus_perf);
 		result = _transfer(send, recv, len);
+		perf_end(_bus_perf);
 		break;
 	}
 	return result;
@@ -174,6 +200,112 @@ SPI::set_frequency(uint32_t frequency)
 	_frequency = frequency;
 }
 
+SPI::bus_schedule *
+SPI::bus_schedule_for(int bus)
+{
+	if (bus < 1 || bus > SPI_BUS_SCHEDULE_MAX)
+		return nullptr;
+
+	return &_bus_schedules[bus - 1];
+}
+
+void
+SPI::bus_call_every(struct bus_call *entry, hrt_abstime delay, hrt_abstime interval,
+		    hrt_callout callout, void *arg)
+{
+	bus_schedule *sched = bus_schedule_for(_bus);
+
+	if (sched == nullptr || interval == 0) {
+		DEVICE_DEBUG("cannot schedule on bus %d", _bus);
+		return;
+	}
+
+	irqstate_t flags = irqsave();
+
+	/* make sure the call is not in the list twice */
+	bus_cancel(entry);
+
+	entry->deadline = hrt_absolute_time() + delay;
+	entry->period = interval;
+	entry->callout = callout;
+	entry->arg = arg;
+	entry->next = sched->calls;
+	sched->calls = entry;
+
+	bus_schedule_arm(sched);
+
+	irqrestore(flags);
+}
+
+void
+SPI::bus_cancel(struct bus_call *entry)
+{
+	bus_schedule *sched = bus_schedule_for(_bus);
+
+	if (sched == nullptr)
+		return;
+
+	irqstate_t flags = irqsave();
+
+	for (bus_call **c = &sched->calls; *c != nullptr; c = &(*c)->next) {
+		if (*c == entry) {
+			/* leave entry->next alone, a running scheduler may still walk it */
+			*c = entry->next;
+			break;
+		}
+	}
+
+	bus_schedule_arm(sched);
+
+	irqrestore(flags);
+}
+
+void
+SPI::bus_schedule_arm(struct bus_schedule *sched)
+{
+	if (sched->calls == nullptr) {
+		hrt_cancel(&sched->timer);
+		return;
+	}
+
+	hrt_abstime next = sched->calls->deadline;
+
+	for (bus_call *c = sched->calls->next; c != nullptr; c = c->next) {
+		if (c->deadline < next)
+			next = c->deadline;
+	}
+
+	hrt_call_at(&sched->timer, next, (hrt_callout)&SPI::bus_schedule_run, sched);
+}
+
+void
+SPI::bus_schedule_run(void *arg)
+{
+	bus_schedule *sched = reinterpret_cast<bus_schedule *>(arg);
+	hrt_abstime now = hrt_absolute_time();
+
+	/*
+	 * Run everything that is due now or within the window back to
+	 * back, the transfers of one slot then occupy the bus as a single
+	 * burst. Calls are not reordered, the devices see their deadline
+	 * at most one window early.
+	 */
+	for (bus_call *c = sched->calls; c != nullptr; c = c->next) {
+		if (c->deadline > now + SPI_BUS_SCHEDULE_WINDOW)
+			continue;
+
+		c->callout(c->arg);
+
+		/* keep the phase, but do not try to catch up on missed calls */
+		c->deadline += c->period;
+
+		if (c->deadline <= now)
+			c->deadline = now + c->period;
+	}
+
+	bus_schedule_arm(sched);
+}
+
 int
 SPI::_transfer(uint8_t *send, uint8_t *recv, unsigned len)
 {
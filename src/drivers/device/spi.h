@@ -43,6 +43,8 @@
 #include "device.h"
 
 #include <px4_spi.h>
+#include <drivers/drv_hrt.h>
+#include <systemlib/perf_counter.h>
 
 namespace device __EXPORT
 {
@@ -127,12 +129,69 @@ protected:
 
 	LockMode	locking_mode;	/**< selected locking mode */
 
+	/**
+	 * Periodic call run by the bus scheduler.
+	 *
+	 * The period may be changed while the call is active, the new
+	 * value is used from the next deadline on.
+	 */
+	struct bus_call {
+		struct bus_call		*next;
+		hrt_abstime		deadline;
+		hrt_abstime		period;
+		hrt_callout		callout;
+		void			*arg;
+	};
+
+	/**
+	 * Call a function periodically from the scheduler of this bus.
+	 *
+	 * All devices on one bus share a single timer. Calls that are due
+	 * within a short window run back to back from the same timer
+	 * interrupt, so the drivers on a bus no longer fire independent
+	 * timers that preempt and delay each other.
+	 *
+	 * Like a hrt_call, the callout runs in interrupt context.
+	 *
+	 * @param entry		Call state, owned by the caller.
+	 * @param delay		Time to the first call.
+	 * @param interval	Time between calls.
+	 * @param callout	Function to call.
+	 * @param arg		Argument passed to the callout.
+	 */
+	void		bus_call_every(struct bus_call *entry, hrt_abstime delay, hrt_abstime interval,
+				       hrt_callout callout, void *arg);
+
+	/**
+	 * Remove a call from the scheduler of this bus.
+	 *
+	 * @param entry		Call state passed to bus_call_every.
+	 */
+	void		bus_cancel(struct bus_call *entry);
+
 private:
 	enum spi_dev_e		_device;
 	enum spi_mode_e		_mode;
 	uint32_t		_frequency;
 	struct spi_dev_s	*_dev;
 
+	char			_bus_perf_name[32];
+	perf_counter_t		_bus_perf;	/**< time this device holds the bus */
+
+	/**
+	 * Per-bus scheduler state, shared by all devices on the bus.
+	 */
+	struct bus_schedule {
+		struct hrt_call		timer;
+		struct bus_call		*calls;
+	};
+
+	static struct bus_schedule	_bus_schedules[];
+
+	static struct bus_schedule	*bus_schedule_for(int bus);
+	static void		bus_schedule_arm(struct bus_schedule *sched);
+	static void		bus_schedule_run(void *arg);
+
 	/* this class does not allow copying */
 	SPI(const SPI&);
 	SPI operator=(const SPI&);
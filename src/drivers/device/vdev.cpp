@@ -41,9 +41,17 @@
 #include "vdev.h"
 #include "drivers/drv_device.h"
 
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+
+#ifdef __PX4_LINUX
+#include <sys/eventfd.h>
+#endif
 
 namespace device
 {
@@ -53,8 +61,11 @@ int px4_errno;
 struct px4_dev_t {
 	char *name;
 	void *cdev;
+	uint32_t hash;
+	int slot;
+	px4_dev_t *next;	// next device in the same hash bucket
 
-	px4_dev_t(const char *n, void *c) : cdev(c) {
+	px4_dev_t(const char *n, void *c, uint32_t h, int s) : cdev(c), hash(h), slot(s), next(nullptr) {
 		name = strdup(n); 
 	}
 
@@ -64,9 +75,112 @@ private:
 	px4_dev_t() {}
 };
 
-#define PX4_MAX_DEV 200
+#define PX4_MAX_DEV 500
 static px4_dev_t *devmap[PX4_MAX_DEV];
 
+/*
+ * Every open and register looks a device up by name, and there is one
+ * device per uORB topic instance, so the devices are also chained into a
+ * hash table on their name. devmap keeps the slots for the listings, a
+ * bitmap of the used ones finds the lowest free slot a word at a time.
+ */
+#define PX4_DEV_HASH_SIZE 256
+static px4_dev_t *devhash[PX4_DEV_HASH_SIZE];
+static uint32_t devmap_used[(PX4_MAX_DEV + 31) / 32];
+static pthread_mutex_t devmutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t dev_hash(const char *name)
+{
+	// FNV-1a
+	uint32_t h = 2166136261u;
+
+	while (*name) {
+		h = (h ^ (uint8_t)*name++) * 16777619u;
+	}
+
+	return h;
+}
+
+static int devmap_alloc(void)
+{
+	for (unsigned w = 0; w < sizeof(devmap_used) / sizeof(devmap_used[0]); ++w) {
+		if (~devmap_used[w] != 0) {
+			int slot = w * 32 + __builtin_ctz(~devmap_used[w]);
+
+			if (slot >= PX4_MAX_DEV) {
+				break;
+			}
+
+			devmap_used[w] |= 1u << (slot % 32);
+			return slot;
+		}
+	}
+
+	return -1;
+}
+
+static px4_dev_t *dev_find(const char *name, uint32_t hash)
+{
+	for (px4_dev_t *d = devhash[hash % PX4_DEV_HASH_SIZE]; d != nullptr; d = d->next) {
+		if (d->hash == hash && strcmp(d->name, name) == 0) {
+			return d;
+		}
+	}
+
+	return nullptr;
+}
+
+static int dev_add(const char *name, void *data)
+{
+	uint32_t hash = dev_hash(name);
+	int ret = -ENOSPC;
+
+	pthread_mutex_lock(&devmutex);
+
+	int slot;
+
+	// Make sure the device does not already exist
+	if (dev_find(name, hash) != nullptr) {
+		ret = -EEXIST;
+
+	} else if ((slot = devmap_alloc()) >= 0) {
+		px4_dev_t *d = new px4_dev_t(name, data, hash, slot);
+		d->next = devhash[hash % PX4_DEV_HASH_SIZE];
+		devhash[hash % PX4_DEV_HASH_SIZE] = d;
+		devmap[slot] = d;
+		ret = PX4_OK;
+	}
+
+	pthread_mutex_unlock(&devmutex);
+
+	return ret;
+}
+
+static int dev_remove(const char *name)
+{
+	uint32_t hash = dev_hash(name);
+	int ret = -EINVAL;
+
+	pthread_mutex_lock(&devmutex);
+
+	for (px4_dev_t **p = &devhash[hash % PX4_DEV_HASH_SIZE]; *p != nullptr; p = &(*p)->next) {
+		px4_dev_t *d = *p;
+
+		if (d->hash == hash && strcmp(d->name, name) == 0) {
+			*p = d->next;
+			devmap[d->slot] = nullptr;
+			devmap_used[d->slot / 32] &= ~(1u << (d->slot % 32));
+			delete d;
+			ret = PX4_OK;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&devmutex);
+
+	return ret;
+}
+
 /*
  * The standard NuttX operation dispatch table can't call C++ member functions
  * directly, so we have to bounce them through this dispatch table.
@@ -85,8 +199,10 @@ VDev::VDev(const char *name,
 	_open_count(0)
 {
 	PX4_DEBUG("VDev::VDev");
-	for (unsigned i = 0; i < _max_pollwaiters; i++)
+	for (unsigned i = 0; i < _max_pollwaiters; i++) {
 		_pollset[i] = nullptr;
+		_eventset[i] = nullptr;
+	}
 }
 
 VDev::~VDev()
@@ -125,27 +241,16 @@ int
 VDev::register_driver(const char *name, void *data)
 {
 	PX4_DEBUG("VDev::register_driver %s", name);
-	int ret = -ENOSPC;
 
 	if (name == NULL || data == NULL)
 		return -EINVAL;
 
-	// Make sure the device does not already exist
-	// FIXME - convert this to a map for efficiency
-	for (int i=0;i<PX4_MAX_DEV; ++i) {
-		if (devmap[i] && (strcmp(devmap[i]->name,name) == 0)) {
-			return -EEXIST;
-		}
-	}
-	for (int i=0;i<PX4_MAX_DEV; ++i) {
-		if (devmap[i] == NULL) {
-			devmap[i] = new px4_dev_t(name, (void *)data);
-			PX4_DEBUG("Registered DEV %s", name);
-			ret = PX4_OK;
-			break;
-		}
+	int ret = dev_add(name, data);
+
+	if (ret == PX4_OK) {
+		PX4_DEBUG("Registered DEV %s", name);
 	}
-	if (ret != PX4_OK) {
+	else if (ret == -ENOSPC) {
 		PX4_ERR("No free devmap entries - increase PX4_MAX_DEV");
 	}
 	return ret;
@@ -155,19 +260,14 @@ int
 VDev::unregister_driver(const char *name)
 {
 	PX4_DEBUG("VDev::unregister_driver %s", name);
-	int ret = -EINVAL;
 
 	if (name == NULL)
 		return -EINVAL;
 
-	for (int i=0;i<PX4_MAX_DEV; ++i) {
-		if (devmap[i] && (strcmp(name, devmap[i]->name) == 0)) {
-			delete devmap[i];
-			devmap[i] = NULL;
-			PX4_DEBUG("Unregistered DEV %s", name);
-			ret = PX4_OK;
-			break;
-		}
+	int ret = dev_remove(name);
+
+	if (ret == PX4_OK) {
+		PX4_DEBUG("Unregistered DEV %s", name);
 	}
 	return ret;
 }
@@ -178,15 +278,12 @@ VDev::unregister_class_devname(const char *class_devname, unsigned class_instanc
 	PX4_DEBUG("VDev::unregister_class_devname");
 	char name[32];
 	snprintf(name, sizeof(name), "%s%u", class_devname, class_instance);
-	for (int i=0;i<PX4_MAX_DEV; ++i) {
-		if (devmap[i] && strcmp(devmap[i]->name,name) == 0) {
-			delete devmap[i];
-			PX4_DEBUG("Unregistered class DEV %s", name);
-			devmap[i] = NULL;
-			return PX4_OK;
-		}
+	int ret = dev_remove(name);
+
+	if (ret == PX4_OK) {
+		PX4_DEBUG("Unregistered class DEV %s", name);
 	}
-	return -EINVAL;
+	return ret;
 }
 
 int
@@ -256,6 +353,17 @@ VDev::close(file_t *filep)
 
 	lock();
 
+	if (filep->eventfd >= 0) {
+		for (unsigned i = 0; i < _max_pollwaiters; i++) {
+			if (_eventset[i] == filep) {
+				_eventset[i] = nullptr;
+			}
+		}
+
+		::close(filep->eventfd);
+		filep->eventfd = -1;
+	}
+
 	if (_open_count > 0) {
 		/* decrement the open count */
 		_open_count--;
@@ -395,9 +503,67 @@ VDev::poll_notify(pollevent_t events)
 		if (nullptr != _pollset[i])
 			poll_notify_one(_pollset[i], events);
 
+	if (events & POLLIN) {
+		for (unsigned i = 0; i < _max_pollwaiters; i++)
+			if (nullptr != _eventset[i])
+				event_notify(_eventset[i]);
+	}
+
 	unlock();
 }
 
+int
+VDev::event_fd(file_t *filep)
+{
+	PX4_DEBUG("VDev::event_fd");
+#ifdef __PX4_LINUX
+	int ret = -ENOMEM;
+
+	lock();
+
+	if (filep->eventfd >= 0) {
+		ret = filep->eventfd;
+
+	} else {
+		for (unsigned i = 0; i < _max_pollwaiters; i++) {
+			if (nullptr == _eventset[i]) {
+				filep->eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+				if (filep->eventfd < 0) {
+					ret = -errno;
+					break;
+				}
+
+				_eventset[i] = filep;
+				ret = filep->eventfd;
+
+				/* there may be data already */
+				event_notify(filep);
+				break;
+			}
+		}
+	}
+
+	unlock();
+
+	return ret;
+#else
+	return -ENOSYS;
+#endif
+}
+
+void
+VDev::event_notify(file_t *filep)
+{
+#ifdef __PX4_LINUX
+	/* the counter just has to become non-zero, a full one can be ignored */
+	if (poll_state(filep) & POLLIN) {
+		uint64_t one = 1;
+		(void)::write(filep->eventfd, &one, sizeof(one));
+	}
+#endif
+}
+
 void
 VDev::poll_notify_one(px4_pollfd_struct_t *fds, pollevent_t events)
 {
@@ -464,16 +630,11 @@ VDev::remove_poll_waiter(px4_pollfd_struct_t *fds)
 VDev *VDev::getDev(const char *path)
 {
 	PX4_DEBUG("VDev::getDev");
-	int i=0;
-	for (; i<PX4_MAX_DEV; ++i) {
-		//if (devmap[i]) {
-		//	printf("%s %s\n", devmap[i]->name, path);
-		//}
-		if (devmap[i] && (strcmp(devmap[i]->name, path) == 0)) {
-			return (VDev *)(devmap[i]->cdev);
-		}
-	}
-	return NULL;
+	pthread_mutex_lock(&devmutex);
+	px4_dev_t *d = dev_find(path, dev_hash(path));
+	VDev *dev = (d != nullptr) ? (VDev *)(d->cdev) : NULL;
+	pthread_mutex_unlock(&devmutex);
+	return dev;
 }
 
 void VDev::showDevices()
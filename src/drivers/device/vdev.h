@@ -66,9 +66,10 @@ struct file_t {
 	mode_t mode;
 	void *priv;
 	void *vdev;
+	int eventfd;	/**< signalled on new data once requested by px4_event_fd(), or -1 */
 
-	file_t() : fd(-1), flags(0), priv(NULL), vdev(NULL) {}
-	file_t(int f, void *c, int d) : fd(d), flags(f), priv(NULL), vdev(c) {}
+	file_t() : fd(-1), flags(0), priv(NULL), vdev(NULL), eventfd(-1) {}
+	file_t(int f, void *c, int d) : fd(d), flags(f), priv(NULL), vdev(c), eventfd(-1) {}
 };
 
 /**
@@ -130,6 +131,13 @@ public:
          */
         virtual int     dev_ioctl(unsigned operation, unsigned &arg);
 
+	/**
+	 * Return the instance of the bus the device is on.
+	 *
+	 * @return		The bus number from the device ID.
+	 */
+	uint8_t		get_device_bus() { return _device_id.devid_s.bus; }
+
 	/*
 	  device bus types for DEVID
 	 */
@@ -235,6 +243,18 @@ public:
 	 */
 	virtual int	poll(file_t *filep, px4_pollfd_struct_t *fds, bool setup);
 
+	/**
+	 * Get an eventfd for the file that is signalled whenever the file
+	 * has new data, so that it can be waited for with ::poll() or epoll
+	 * together with sockets and serial ports.
+	 *
+	 * The eventfd has to be read to clear it, and is closed with the file.
+	 *
+	 * @param filep		Pointer to the internal file structure.
+	 * @return		The eventfd, or -errno on error.
+	 */
+	int		event_fd(file_t *filep);
+
 	/**
 	 * Test whether the device is currently open.
 	 *
@@ -423,6 +443,9 @@ private:
 	unsigned	_open_count;		/**< number of successful opens */
 
 	px4_pollfd_struct_t	*_pollset[_max_pollwaiters];
+	file_t			*_eventset[_max_pollwaiters];	/**< files with an eventfd */
+
+	void		event_notify(file_t *filep);
 
 	/**
 	 * Store a pollwaiter in a slot where we can find it later.
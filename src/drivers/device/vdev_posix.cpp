@@ -44,10 +44,15 @@
 #include "vfile.h"
 
 #include <hrt_work.h>
+#include <drivers/drv_hrt.h>
+#include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
 #include <unistd.h>
 
 using namespace device;
@@ -61,9 +66,84 @@ static void timer_cb(void *data)
 	PX4_DEBUG("timer_handler: Timer expired");
 }
 
+/*
+ * Wait for a poll event or the timeout in ms, whichever comes first.
+ */
+static void poll_wait(sem_t *sem, int timeout)
+{
+#if defined(__PX4_LINUX) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+	// Wait against an absolute deadline, so that no timer has to be
+	// queued and cancelled on the HRT work queue per call. The deadline
+	// is monotonic like the HRT, wall clock steps do not move it. In
+	// lockstep the timeout is in simulated time, which only the HRT follows.
+	if (!hrt_lockstep_active()) {
+		struct timespec deadline;
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec  += timeout / 1000;
+		deadline.tv_nsec += (timeout % 1000) * 1000000;
+
+		if (deadline.tv_nsec >= 1000000000) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
+		}
+
+		while (sem_clockwait(sem, CLOCK_MONOTONIC, &deadline) != 0 && errno == EINTR) {
+		}
+
+		return;
+	}
+#endif
+
+	// Use a work queue task, its timer runs on HRT time
+	work_s _hpwork;
+
+	hrt_work_queue(&_hpwork, (worker_t)&timer_cb, (void *)sem, 1000 * timeout);
+	sem_wait(sem);
+
+	// Make sure timer thread is killed before sem goes
+	// out of scope
+	hrt_work_cancel(&_hpwork);
+}
+
 #define PX4_MAX_FD 200
 static device::file_t *filemap[PX4_MAX_FD] = {};
 
+// Bitmap of the used fds, so open finds the lowest free one without scanning filemap
+static uint32_t fd_used[(PX4_MAX_FD + 31) / 32];
+static pthread_mutex_t fd_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int fd_alloc(void)
+{
+	int fd = -1;
+
+	pthread_mutex_lock(&fd_mutex);
+
+	for (unsigned w = 0; w < sizeof(fd_used) / sizeof(fd_used[0]); ++w) {
+		if (~fd_used[w] != 0) {
+			int i = w * 32 + __builtin_ctz(~fd_used[w]);
+
+			if (i < PX4_MAX_FD) {
+				fd_used[w] |= 1u << (i % 32);
+				fd = i;
+			}
+
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&fd_mutex);
+
+	return fd;
+}
+
+static void fd_release(int fd)
+{
+	pthread_mutex_lock(&fd_mutex);
+	filemap[fd] = NULL;
+	fd_used[fd / 32] &= ~(1u << (fd % 32));
+	pthread_mutex_unlock(&fd_mutex);
+}
+
 int px4_errno;
 
 inline bool valid_fd(int fd)
@@ -93,14 +173,15 @@ int px4_open(const char *path, int flags, ...)
 		dev = VFile::createFile(path, mode);
 	}
 	if (dev) {
-		for (i=0; i<PX4_MAX_FD; ++i) {
-			if (filemap[i] == 0) {
-				filemap[i] = new device::file_t(flags,dev,i);
-				break;
-			}
-		}
-		if (i < PX4_MAX_FD) {
+		i = fd_alloc();
+		if (i >= 0) {
+			filemap[i] = new device::file_t(flags,dev,i);
 			ret = dev->open(filemap[i]);
+
+			if (ret < 0) {
+				delete filemap[i];
+				fd_release(i);
+			}
 		}
 		else {
 			PX4_WARN("exceeded maximum number of file descriptors!");
@@ -125,7 +206,7 @@ int px4_close(int fd)
 		VDev *dev = (VDev *)(filemap[fd]->vdev);
 		PX4_DEBUG("px4_close fd = %d", fd);
 		ret = dev->close(filemap[fd]);
-		filemap[fd] = NULL;
+		fd_release(fd);
 	}
 	else { 
                 ret = -EINVAL;
@@ -224,15 +305,7 @@ int px4_poll(px4_pollfd_struct_t *fds, nfds_t nfds, int timeout)
 	{
 		if (timeout > 0)
 		{
-			// Use a work queue task
-			work_s _hpwork;
-
-			hrt_work_queue(&_hpwork, (worker_t)&timer_cb, (void *)&sem, 1000*timeout);
-			sem_wait(&sem);
-
-			// Make sure timer thread is killed before sem goes
-			// out of scope
-			hrt_work_cancel(&_hpwork);
+			poll_wait(&sem, timeout);
         	}
 		else if (timeout < 0) 
 		{
@@ -263,6 +336,24 @@ int px4_poll(px4_pollfd_struct_t *fds, nfds_t nfds, int timeout)
 	return count;
 }
 
+int px4_event_fd(int fd)
+{
+	int ret;
+	if (valid_fd(fd)) {
+		VDev *dev = (VDev *)(filemap[fd]->vdev);
+		PX4_DEBUG("px4_event_fd fd = %d", fd);
+		ret = dev->event_fd(filemap[fd]);
+	}
+	else {
+		ret = -EINVAL;
+	}
+	if (ret < 0) {
+		px4_errno = -ret;
+		ret = PX4_ERROR;
+	}
+	return ret;
+}
+
 int px4_fsync(int fd)
 {
 	return 0;
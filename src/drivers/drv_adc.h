@@ -43,6 +43,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <px4_defines.h>
 #include <sys/ioctl.h>
 
 #define ADC0_DEVICE_PATH	"/dev/adc0"
@@ -50,3 +51,21 @@
 /*
  * ioctl definitions
  */
+
+#define _ADCIOCBASE		(0x2f00)
+#define _ADCIOC(_n)		(_PX4_IOC(_ADCIOCBASE, _n))
+
+/**
+ * Integral of the samples of one channel, for coulomb counting.
+ */
+struct adc_integral_s {
+	uint8_t		channel;	/**< channel to query, set by the caller */
+	uint64_t	integral;	/**< sum of every raw sample times its sample period since the driver started, in counts * us */
+	uint64_t	timestamp;	/**< time of the last sample included in the integral */
+};
+
+/**
+ * Get the integral of the channel in (arg)->channel, arg is a pointer to
+ * a struct adc_integral_s.
+ */
+#define ADCIOCGINTEGRAL		_ADCIOC(1)
@@ -68,9 +68,14 @@ typedef void	(* hrt_callout)(void *arg);
 
 /*
  * Callout record.
+ *
+ * The child, sibling and prev links are owned by the callout queue, a record
+ * must be zeroed or passed to hrt_call_init() before it is used the first time.
  */
 typedef struct hrt_call {
-	struct sq_entry_s	link;
+	struct hrt_call		*child;
+	struct hrt_call		*sibling;
+	struct hrt_call		*prev;
 
 	hrt_abstime		deadline;
 	hrt_abstime		period;
@@ -163,4 +168,41 @@ __EXPORT extern void	hrt_call_delay(struct hrt_call *entry, hrt_abstime delay);
  */
 __EXPORT extern void	hrt_init(void);
 
+#ifdef __PX4_POSIX
+
+/*
+ * Switch the HRT to lockstep mode.
+ *
+ * The time stops at its current value and only advances with
+ * hrt_lockstep_set_time(), so callouts, work queues and poll timeouts run
+ * on the time of the caller, usually a simulator.
+ */
+__EXPORT extern void	hrt_lockstep_enable(void);
+
+/*
+ * Advance the time in lockstep mode, earlier times are ignored.
+ */
+__EXPORT extern void	hrt_lockstep_set_time(hrt_abstime time);
+
+/*
+ * True once hrt_lockstep_enable() was called.
+ */
+__EXPORT extern bool	hrt_lockstep_active(void);
+
+/*
+ * Sleep until the HRT time reaches deadline or *wakeups differs from seen,
+ * a deadline of 0 only ends with the wakeup.
+ *
+ * Read *wakeups before looking for work, so that a hrt_wakeup() in between
+ * is not lost.
+ */
+__EXPORT extern void	hrt_sleep_until(hrt_abstime deadline, volatile unsigned *wakeups, unsigned seen);
+
+/*
+ * Increment *wakeups and wake up the threads sleeping on it.
+ */
+__EXPORT extern void	hrt_wakeup(volatile unsigned *wakeups);
+
+#endif
+
 __END_DECLS
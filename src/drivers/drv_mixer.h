@@ -109,6 +109,17 @@ struct mixer_simple_s {
  */
 #define MIXERIOCLOADBUF		_MIXERIOC(5)
 
+/** precompiled mixers, see MixerGroup::load_from_binary() */
+struct mixer_binary_s {
+	const uint8_t		*data;
+	unsigned		length;
+};
+
+/**
+ * Add mixer(s) from the precompiled buffer in (const struct mixer_binary_s *)arg
+ */
+#define MIXERIOCLOADBIN		_MIXERIOC(6)
+
 /*
  * XXX Thoughts for additional operations:
  *
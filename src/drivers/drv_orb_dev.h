@@ -90,4 +90,29 @@
 /** Get the priority for the topic */
 #define ORBIOCGPRIORITY		_ORBIOC(14)
 
+/** Set the queue size of the topic */
+#define ORBIOCSETQUEUESIZE	_ORBIOC(15)
+
+/** Borrow a read-only pointer to the current topic data into *(const void **)arg */
+#define ORBIOCBORROW		_ORBIOC(16)
+
+/** Return borrowed topic data, fails with EAGAIN if the data was overwritten meanwhile */
+#define ORBIOCRELEASE		_ORBIOC(17)
+
+/** Queue work on each publication, arg is a const struct orb_work_callback * */
+#define ORBIOCREGCALLBACK	_ORBIOC(18)
+
+/** Stop queueing the work registered with ORBIOCREGCALLBACK */
+#define ORBIOCUNREGCALLBACK	_ORBIOC(19)
+
+struct work_s;
+
+/** Work queued by a topic node for a subscriber, see orb_register_work_callback() */
+struct orb_work_callback {
+	int		qid;
+	struct work_s	*work;
+	void		(*worker)(void *arg);
+	void		*arg;
+};
+
 #endif /* _DRV_UORB_H */
@@ -103,6 +103,21 @@ __BEGIN_DECLS
  */
 #define PWM_LOWEST_MAX 950
 
+/**
+ * Update rate selecting oneshot output
+ *
+ * Pulses are only started by up_pwm_update(), their width follows the
+ * driver's oneshot protocol.
+ */
+#define PWM_RATE_ONESHOT 0
+
+/**
+ * Oneshot protocols, mapping 1000..2000 us to the given pulse widths
+ */
+#define PWM_ONESHOT_PROTOCOL_125	0	/**< Oneshot125, 125..250 us (default) */
+#define PWM_ONESHOT_PROTOCOL_42		1	/**< Oneshot42, 42..83 us */
+#define PWM_ONESHOT_PROTOCOL_MULTISHOT	2	/**< Multishot, 5..25 us */
+
 /**
  * Do not output a channel with this value
  */
@@ -236,6 +251,9 @@ struct pwm_output_rc_config {
 /** setup OVERRIDE_IMMEDIATE behaviour on FMU fail */
 #define PWM_SERVO_SET_OVERRIDE_IMMEDIATE	_PX4_IOC(_PWM_SERVO_BASE, 30)
 
+/** set the protocol of the oneshot rate groups, one of PWM_ONESHOT_PROTOCOL_* */
+#define PWM_SERVO_SET_ONESHOT_PROTOCOL		_PX4_IOC(_PWM_SERVO_BASE, 31)
+
 /*
  *
  *
@@ -255,6 +273,9 @@ struct pwm_output_rc_config {
  */
 #define PWM_SERVO_GET_RATEGROUP(_n) _PX4_IOC(_PWM_SERVO_BASE, 0x60 + _n)
 
+/** get the protocol of the oneshot rate groups; *(uint32_t *)arg returns one of PWM_ONESHOT_PROTOCOL_* */
+#define PWM_SERVO_GET_ONESHOT_PROTOCOL	_PX4_IOC(_PWM_SERVO_BASE, 0x80)
+
 /*
  * Low-level PWM output interface.
  *
@@ -311,11 +332,27 @@ __EXPORT extern uint32_t up_pwm_servo_get_rate_group(unsigned group);
  * Set the update rate for a given rate group.
  *
  * @param group		The rate group whose update rate will be changed.
- * @param rate		The update rate in Hz.
+ * @param rate		The update rate in Hz, or PWM_RATE_ONESHOT.
  * @return		OK if the group was adjusted, -ERANGE if an unsupported update rate is set.
  */
 __EXPORT extern int	up_pwm_servo_set_rate_group_update(unsigned group, unsigned rate);
 
+/**
+ * Set the protocol used by all oneshot rate groups.
+ *
+ * @param protocol	One of PWM_ONESHOT_PROTOCOL_*.
+ * @return		OK on success, -EINVAL for an unknown protocol.
+ */
+__EXPORT extern int	up_pwm_servo_set_oneshot_protocol(unsigned protocol);
+
+/**
+ * Start a pulse on all channels of the oneshot rate groups.
+ *
+ * Values set with up_pwm_servo_set() since the last call take effect now.
+ * Rate groups with a regular update rate are not affected.
+ */
+__EXPORT extern void	up_pwm_update(void);
+
 /**
  * Set the current output value for a channel.
  *
@@ -68,6 +68,15 @@
 #define DRV_RNG_DEVTYPE_MB12XX   0x31
 #define DRV_RNG_DEVTYPE_LL40LS   0x32
 
+/**
+ * Number of reports queued on the sensor_accel and sensor_gyro topics.
+ *
+ * The reports carry the integrated deltas since the previous one, so
+ * queueing them lets a subscriber that runs slower than the sensor
+ * (e.g. a MAVLink link batching them) still see every delta.
+ */
+#define SENSOR_ORB_QUEUE_SIZE	8
+
 /*
  * ioctl() definitions
  *
@@ -90,11 +90,26 @@
 
 #define frac(f) (f - (int)f)
 
+/* worst case frame: 15 values, each fully byte-stuffed, plus the final stop byte */
+#define FRSKY_FRAME_MAX		(15 * 7 + 1)
+
+/* a frame is assembled completely and written at once */
+struct frsky_frame {
+	uint8_t data[FRSKY_FRAME_MAX];
+	size_t len;
+};
+
 static int battery_sub = -1;
 static int sensor_sub = -1;
 static int global_position_sub = -1;
 static int vehicle_status_sub = -1;
 
+/* last copies of the topics, only refreshed when they change */
+static struct battery_status_s battery;
+static struct sensor_combined_s raw;
+static struct vehicle_global_position_s global_pos;
+static struct vehicle_status_s vehicle_status;
+
 /**
  * Initializes the uORB subscriptions.
  */
@@ -104,53 +119,78 @@ void frsky_init()
 	global_position_sub = orb_subscribe(ORB_ID(vehicle_global_position));
 	sensor_sub = orb_subscribe(ORB_ID(sensor_combined));
 	vehicle_status_sub = orb_subscribe(ORB_ID(vehicle_status));
+
+	memset(&battery, 0, sizeof(battery));
+	memset(&raw, 0, sizeof(raw));
+	memset(&global_pos, 0, sizeof(global_pos));
+	memset(&vehicle_status, 0, sizeof(vehicle_status));
 }
 
 /**
- * Sends a 0x5E start/stop byte.
+ * Copies a topic if it was updated since the last copy.
  */
-static void frsky_send_startstop(int uart)
+static void frsky_update_topic(const struct orb_metadata *meta, int handle, void *buffer)
 {
-	static const uint8_t c = 0x5E;
-	write(uart, &c, sizeof(c));
+	bool updated = false;
+	orb_check(handle, &updated);
+
+	if (updated) {
+		orb_copy(meta, handle, buffer);
+	}
 }
 
 /**
- * Sends one byte, performing byte-stuffing if necessary.
+ * Appends a 0x5E start/stop byte.
  */
-static void frsky_send_byte(int uart, uint8_t value)
+static void frsky_put_startstop(struct frsky_frame *frame)
 {
-	const uint8_t x5E[] = { 0x5D, 0x3E };
-	const uint8_t x5D[] = { 0x5D, 0x3D };
+	frame->data[frame->len++] = 0x5E;
+}
 
+/**
+ * Appends one byte, performing byte-stuffing if necessary.
+ */
+static void frsky_put_byte(struct frsky_frame *frame, uint8_t value)
+{
 	switch (value) {
 	case 0x5E:
-		write(uart, x5E, sizeof(x5E));
+		frame->data[frame->len++] = 0x5D;
+		frame->data[frame->len++] = 0x3E;
 		break;
 
 	case 0x5D:
-		write(uart, x5D, sizeof(x5D));
+		frame->data[frame->len++] = 0x5D;
+		frame->data[frame->len++] = 0x3D;
 		break;
 
 	default:
-		write(uart, &value, sizeof(value));
+		frame->data[frame->len++] = value;
 		break;
 	}
 }
 
 /**
- * Sends one data id/value pair.
+ * Appends one data id/value pair.
  */
-static void frsky_send_data(int uart, uint8_t id, int16_t data)
+static void frsky_put_data(struct frsky_frame *frame, uint8_t id, int16_t data)
 {
 	/* Cast data to unsigned, because signed shift might behave incorrectly */
 	uint16_t udata = data;
 
-	frsky_send_startstop(uart);
+	frsky_put_startstop(frame);
+
+	frsky_put_byte(frame, id);
+	frsky_put_byte(frame, udata);      /* LSB */
+	frsky_put_byte(frame, udata >> 8); /* MSB */
+}
 
-	frsky_send_byte(uart, id);
-	frsky_send_byte(uart, udata);      /* LSB */
-	frsky_send_byte(uart, udata >> 8); /* MSB */
+/**
+ * Terminates a frame and sends it with a single write.
+ */
+static void frsky_send_frame(int uart, struct frsky_frame *frame)
+{
+	frsky_put_startstop(frame);
+	write(uart, frame->data, frame->len);
 }
 
 /**
@@ -159,38 +199,34 @@ static void frsky_send_data(int uart, uint8_t id, int16_t data)
  */
 void frsky_send_frame1(int uart)
 {
-	/* get a local copy of the current sensor values */
-	struct sensor_combined_s raw;
-	memset(&raw, 0, sizeof(raw));
-	orb_copy(ORB_ID(sensor_combined), sensor_sub, &raw);
+	struct frsky_frame frame = { .len = 0 };
 
-	/* get a local copy of the battery data */
-	struct battery_status_s battery;
-	memset(&battery, 0, sizeof(battery));
-	orb_copy(ORB_ID(battery_status), battery_sub, &battery);
+	/* refresh the sensor values and battery data */
+	frsky_update_topic(ORB_ID(sensor_combined), sensor_sub, &raw);
+	frsky_update_topic(ORB_ID(battery_status), battery_sub, &battery);
 
 	/* send formatted frame */
-	frsky_send_data(uart, FRSKY_ID_ACCEL_X,
+	frsky_put_data(&frame, FRSKY_ID_ACCEL_X,
 			roundf(raw.accelerometer_m_s2[0] * 1000.0f));
-	frsky_send_data(uart, FRSKY_ID_ACCEL_Y,
+	frsky_put_data(&frame, FRSKY_ID_ACCEL_Y,
 			roundf(raw.accelerometer_m_s2[1] * 1000.0f));
-	frsky_send_data(uart, FRSKY_ID_ACCEL_Z,
+	frsky_put_data(&frame, FRSKY_ID_ACCEL_Z,
 			roundf(raw.accelerometer_m_s2[2] * 1000.0f));
 
-	frsky_send_data(uart, FRSKY_ID_BARO_ALT_BP,
+	frsky_put_data(&frame, FRSKY_ID_BARO_ALT_BP,
 			raw.baro_alt_meter[0]);
-	frsky_send_data(uart, FRSKY_ID_BARO_ALT_AP,
+	frsky_put_data(&frame, FRSKY_ID_BARO_ALT_AP,
 			roundf(frac(raw.baro_alt_meter[0]) * 100.0f));
 
-	frsky_send_data(uart, FRSKY_ID_TEMP1,
+	frsky_put_data(&frame, FRSKY_ID_TEMP1,
 			roundf(raw.baro_temp_celcius[0]));
 
-	frsky_send_data(uart, FRSKY_ID_VFAS,
+	frsky_put_data(&frame, FRSKY_ID_VFAS,
 			roundf(battery.voltage_v * 10.0f));
-	frsky_send_data(uart, FRSKY_ID_CURRENT,
+	frsky_put_data(&frame, FRSKY_ID_CURRENT,
 			(battery.current_a < 0) ? 0 : roundf(battery.current_a * 10.0f));
 
-	frsky_send_startstop(uart);
+	frsky_send_frame(uart, &frame);
 }
 
 /**
@@ -208,15 +244,11 @@ static float frsky_format_gps(float dec)
  */
 void frsky_send_frame2(int uart)
 {
-	/* get a local copy of the global position data */
-	struct vehicle_global_position_s global_pos;
-	memset(&global_pos, 0, sizeof(global_pos));
-	orb_copy(ORB_ID(vehicle_global_position), global_position_sub, &global_pos);
+	struct frsky_frame frame = { .len = 0 };
 
-	/* get a local copy of the vehicle status data */
-	struct vehicle_status_s vehicle_status;
-	memset(&vehicle_status, 0, sizeof(vehicle_status));
-	orb_copy(ORB_ID(vehicle_status), vehicle_status_sub, &vehicle_status);
+	/* refresh the global position and vehicle status data */
+	frsky_update_topic(ORB_ID(vehicle_global_position), global_position_sub, &global_pos);
+	frsky_update_topic(ORB_ID(vehicle_status), vehicle_status_sub, &vehicle_status);
 
 	/* send formatted frame */
 	float course = 0, lat = 0, lon = 0, speed = 0, alt = 0;
@@ -238,29 +270,29 @@ void frsky_send_frame2(int uart)
 		sec    = tm_gps->tm_sec;
 	}
 
-	frsky_send_data(uart, FRSKY_ID_GPS_COURS_BP, course);
-	frsky_send_data(uart, FRSKY_ID_GPS_COURS_AP, frac(course) * 1000.0f);
+	frsky_put_data(&frame, FRSKY_ID_GPS_COURS_BP, course);
+	frsky_put_data(&frame, FRSKY_ID_GPS_COURS_AP, frac(course) * 1000.0f);
 
-	frsky_send_data(uart, FRSKY_ID_GPS_LAT_BP, lat);
-	frsky_send_data(uart, FRSKY_ID_GPS_LAT_AP, frac(lat) * 10000.0f);
-	frsky_send_data(uart, FRSKY_ID_GPS_LAT_NS, lat_ns);
+	frsky_put_data(&frame, FRSKY_ID_GPS_LAT_BP, lat);
+	frsky_put_data(&frame, FRSKY_ID_GPS_LAT_AP, frac(lat) * 10000.0f);
+	frsky_put_data(&frame, FRSKY_ID_GPS_LAT_NS, lat_ns);
 
-	frsky_send_data(uart, FRSKY_ID_GPS_LONG_BP, lon);
-	frsky_send_data(uart, FRSKY_ID_GPS_LONG_AP, frac(lon) * 10000.0f);
-	frsky_send_data(uart, FRSKY_ID_GPS_LONG_EW, lon_ew);
+	frsky_put_data(&frame, FRSKY_ID_GPS_LONG_BP, lon);
+	frsky_put_data(&frame, FRSKY_ID_GPS_LONG_AP, frac(lon) * 10000.0f);
+	frsky_put_data(&frame, FRSKY_ID_GPS_LONG_EW, lon_ew);
 
-	frsky_send_data(uart, FRSKY_ID_GPS_SPEED_BP, speed);
-	frsky_send_data(uart, FRSKY_ID_GPS_SPEED_AP, frac(speed) * 100.0f);
+	frsky_put_data(&frame, FRSKY_ID_GPS_SPEED_BP, speed);
+	frsky_put_data(&frame, FRSKY_ID_GPS_SPEED_AP, frac(speed) * 100.0f);
 
-	frsky_send_data(uart, FRSKY_ID_GPS_ALT_BP, alt);
-	frsky_send_data(uart, FRSKY_ID_GPS_ALT_AP, frac(alt) * 100.0f);
+	frsky_put_data(&frame, FRSKY_ID_GPS_ALT_BP, alt);
+	frsky_put_data(&frame, FRSKY_ID_GPS_ALT_AP, frac(alt) * 100.0f);
 
-	frsky_send_data(uart, FRSKY_ID_FUEL,
+	frsky_put_data(&frame, FRSKY_ID_FUEL,
 			roundf(vehicle_status.battery_remaining * 100.0f));
 
-	frsky_send_data(uart, FRSKY_ID_GPS_SEC, sec);
+	frsky_put_data(&frame, FRSKY_ID_GPS_SEC, sec);
 
-	frsky_send_startstop(uart);
+	frsky_send_frame(uart, &frame);
 }
 
 /**
@@ -269,19 +301,19 @@ void frsky_send_frame2(int uart)
  */
 void frsky_send_frame3(int uart)
 {
-	/* get a local copy of the battery data */
-	struct vehicle_global_position_s global_pos;
-	memset(&global_pos, 0, sizeof(global_pos));
-	orb_copy(ORB_ID(vehicle_global_position), global_position_sub, &global_pos);
+	struct frsky_frame frame = { .len = 0 };
+
+	/* refresh the global position data */
+	frsky_update_topic(ORB_ID(vehicle_global_position), global_position_sub, &global_pos);
 
 	/* send formatted frame */
 	time_t time_gps = global_pos.time_utc_usec / 1000000ULL;
 	struct tm *tm_gps = gmtime(&time_gps);
 	uint16_t hour_min = (tm_gps->tm_min << 8) | (tm_gps->tm_hour & 0xff);
-	frsky_send_data(uart, FRSKY_ID_GPS_DAY_MONTH, tm_gps->tm_mday);
-	frsky_send_data(uart, FRSKY_ID_GPS_YEAR, tm_gps->tm_year);
-	frsky_send_data(uart, FRSKY_ID_GPS_HOUR_MIN, hour_min);
-	frsky_send_data(uart, FRSKY_ID_GPS_SEC, tm_gps->tm_sec);
+	frsky_put_data(&frame, FRSKY_ID_GPS_DAY_MONTH, tm_gps->tm_mday);
+	frsky_put_data(&frame, FRSKY_ID_GPS_YEAR, tm_gps->tm_year);
+	frsky_put_data(&frame, FRSKY_ID_GPS_HOUR_MIN, hour_min);
+	frsky_put_data(&frame, FRSKY_ID_GPS_SEC, tm_gps->tm_sec);
 
-	frsky_send_startstop(uart);
+	frsky_send_frame(uart, &frame);
 }
@@ -115,9 +115,25 @@ protected:
 	virtual int			probe();
 
 private:
+	/**
+	 * What the mount is told by the commands, written by cycle() and read
+	 * by attitude_update() on another work queue. The two copies are
+	 * swapped so the attitude path never sees a half written target.
+	 */
+	struct Target {
+		float			roll;
+		float			pitch;
+		float			yaw;
+		bool			compensation_roll;
+		bool			compensation_pitch;
+		bool			compensation_yaw;
+		bool			set;
+	};
+
 	float				_min_distance;
 	float				_max_distance;
 	work_s				_work;
+	work_s				_att_work;
 	int				_vehicle_command_sub;
 	int				_att_sub;
 
@@ -125,12 +141,20 @@ private:
 	bool				_attitude_compensation_pitch;
 	bool				_attitude_compensation_yaw;
 	bool				_initialized;
+	bool				_att_valid;
+
+	Target				_target[2];
+	volatile unsigned		_target_index;
+
+	math::Vector<3>			_att_euler;
+	hrt_abstime			_att_timestamp;
 	bool				_control_cmd_set;
 	bool				_config_cmd_set;
 
 	orb_advert_t			_actuator_controls_2_topic;
 
 	perf_counter_t			_sample_perf;
+	perf_counter_t			_att_perf;
 	perf_counter_t			_comms_errors;
 	perf_counter_t			_buffer_overflows;
 
@@ -164,6 +188,18 @@ private:
 	*/
 	static void			cycle_trampoline(void *arg);
 
+	/**
+	* Make the commands of the last cycle visible to attitude_update().
+	*/
+	void				update_target(float roll, float pitch, float yaw, bool set);
+
+	/**
+	* Compensate the newest attitude and publish the mount output, runs on
+	* the high priority queue for every vehicle_attitude publication.
+	*/
+	void				attitude_update();
+
+	static void			attitude_trampoline(void *arg);
 
 };
 
@@ -180,8 +216,13 @@ Gimbal::Gimbal() :
 	_attitude_compensation_pitch(true),
 	_attitude_compensation_yaw(true),
 	_initialized(false),
+	_att_valid(false),
+	_target_index(0),
+	_att_euler(0.0f, 0.0f, 0.0f),
+	_att_timestamp(0),
 	_actuator_controls_2_topic(nullptr),
 	_sample_perf(perf_alloc(PC_ELAPSED, "gimbal_read")),
+	_att_perf(perf_alloc(PC_ELAPSED, "gimbal_att")),
 	_comms_errors(perf_alloc(PC_COUNT, "gimbal_comms_errors")),
 	_buffer_overflows(perf_alloc(PC_COUNT, "gimbal_buffer_overflows"))
 {
@@ -190,6 +231,8 @@ Gimbal::Gimbal() :
 
 	// work_cancel in the dtor will explode if we don't do this...
 	memset(&_work, 0, sizeof(_work));
+	memset(&_att_work, 0, sizeof(_att_work));
+	memset(&_target, 0, sizeof(_target));
 }
 
 Gimbal::~Gimbal()
@@ -197,7 +240,18 @@ Gimbal::~Gimbal()
 	/* make sure we are truly inactive */
 	stop();
 
-	::close(_vehicle_command_sub);
+	if (_vehicle_command_sub >= 0) {
+		orb_unsubscribe(_vehicle_command_sub);
+	}
+
+	if (_att_sub >= 0) {
+		orb_unsubscribe(_att_sub);
+	}
+
+	perf_free(_sample_perf);
+	perf_free(_att_perf);
+	perf_free(_comms_errors);
+	perf_free(_buffer_overflows);
 }
 
 int
@@ -257,6 +311,12 @@ void
 Gimbal::stop()
 {
 	work_cancel(LPWORK, &_work);
+
+	if (_att_sub >= 0) {
+		orb_unregister_work_callback(_att_sub);
+	}
+
+	work_cancel(HPWORK, &_att_work);
 }
 
 void
@@ -267,6 +327,108 @@ Gimbal::cycle_trampoline(void *arg)
 	dev->cycle();
 }
 
+void
+Gimbal::attitude_trampoline(void *arg)
+{
+	Gimbal *dev = static_cast<Gimbal *>(arg);
+
+	dev->attitude_update();
+}
+
+void
+Gimbal::update_target(float roll, float pitch, float yaw, bool set)
+{
+	Target &next = _target[_target_index ^ 1];
+
+	next.roll = roll;
+	next.pitch = pitch;
+	next.yaw = yaw;
+	next.compensation_roll = _attitude_compensation_roll;
+	next.compensation_pitch = _attitude_compensation_pitch;
+	next.compensation_yaw = _attitude_compensation_yaw;
+	next.set = set;
+
+	/* the copy has to be complete before the attitude path can pick it */
+	__sync_synchronize();
+	_target_index ^= 1;
+
+	/* output the change right away, even without a new attitude */
+	if (_att_work.worker == nullptr) {
+		work_queue(HPWORK, &_att_work, (worker_t)&Gimbal::attitude_trampoline, this, 0);
+	}
+}
+
+void
+Gimbal::attitude_update()
+{
+	perf_begin(_att_perf);
+
+	bool att_updated = false;
+
+	if (orb_check(_att_sub, &att_updated) == OK && att_updated) {
+		vehicle_attitude_s att;
+		orb_copy(ORB_ID(vehicle_attitude), _att_sub, &att);
+
+		/* the quaternion is the estimator state, the Euler fields are derived from it
+		 * when the topic is published and are only used for estimators without one */
+		if (att.q_valid) {
+			_att_euler = math::Quaternion(att.q).to_euler();
+
+		} else {
+			_att_euler = math::Vector<3>(att.roll, att.pitch, att.yaw);
+		}
+
+		_att_timestamp = att.timestamp;
+		_att_valid = true;
+	}
+
+	const Target &target = _target[_target_index];
+
+	bool updated = target.set;
+
+	float roll = target.roll;
+	float pitch = target.pitch;
+	float yaw = target.yaw;
+
+	if (_att_valid) {
+		if (target.compensation_roll) {
+			roll += 1.0f / M_PI_F * -_att_euler(0);
+			updated = true;
+		}
+
+		if (target.compensation_pitch) {
+			pitch += 1.0f / M_PI_F * -_att_euler(1);
+			updated = true;
+		}
+
+		if (target.compensation_yaw) {
+			yaw += 1.0f / M_PI_F * _att_euler(2);
+			updated = true;
+		}
+	}
+
+	if (updated && _actuator_controls_2_topic != nullptr) {
+
+		struct actuator_controls_s controls;
+		memset(&controls, 0, sizeof(controls));
+
+		/* fill in the final control values */
+		controls.timestamp = hrt_absolute_time();
+		controls.timestamp_sample = _att_timestamp;
+		controls.control[0] = roll;
+		controls.control[1] = pitch;
+		controls.control[2] = yaw;
+
+		/* publish it */
+		orb_publish(ORB_ID(actuator_controls_2), _actuator_controls_2_topic, &controls);
+
+		/* notify anyone waiting for data */
+		poll_notify(POLLIN);
+	}
+
+	perf_end(_att_perf);
+}
+
 void
 Gimbal::cycle()
 {
@@ -284,41 +446,21 @@ Gimbal::cycle()
 			warnx("advert err");
 		}
 
+		/* the output follows every attitude update instead of this cycle */
+		_att_sub = orb_subscribe(ORB_ID(vehicle_attitude));
+		orb_register_work_callback(_att_sub, HPWORK, &_att_work, &Gimbal::attitude_trampoline, this);
+
+		update_target(0.0f, 0.0f, 0.0f, false);
+
 		_initialized = true;
 	}
 
-	bool	updated = false;
-
 	perf_begin(_sample_perf);
 
 	float roll = 0.0f;
 	float pitch = 0.0f;
 	float yaw = 0.0f;
-
-
-	if (_att_sub < 0) {
-		_att_sub = orb_subscribe(ORB_ID(vehicle_attitude));
-	}
-
-	vehicle_attitude_s att;
-
-	orb_copy(ORB_ID(vehicle_attitude), _att_sub, &att);
-
-	if (_attitude_compensation_roll) {
-		roll = 1.0f / M_PI_F * -att.roll;
-		updated = true;
-	}
-
-	if (_attitude_compensation_pitch) {
-		pitch = 1.0f / M_PI_F * -att.pitch;
-		updated = true;
-	}
-
-	if (_attitude_compensation_yaw) {
-		yaw = 1.0f / M_PI_F * att.yaw;
-		updated = true;
-	}
-
+	bool updated = false;
 
 	struct vehicle_command_s cmd;
 
@@ -384,26 +526,16 @@ Gimbal::cycle()
 
 	}
 
-	if (updated) {
-
-		struct actuator_controls_s controls;
-
-		// DEVICE_DEBUG("publishing | roll: %8.4f pitch: %8.4f yaw: %8.4f", (double)roll, (double)pitch, (double)yaw);
-
-		/* fill in the final control values */
-		controls.timestamp = hrt_absolute_time();
-		controls.control[0] = roll;
-		controls.control[1] = pitch;
-		controls.control[2] = yaw;
-
-		/* publish it */
-		orb_publish(ORB_ID(actuator_controls_2), _actuator_controls_2_topic, &controls);
+	/* the compensation can also be switched by ioctl() */
+	const Target &current = _target[_target_index];
 
+	if (cmd_updated
+	    || current.compensation_roll != _attitude_compensation_roll
+	    || current.compensation_pitch != _attitude_compensation_pitch
+	    || current.compensation_yaw != _attitude_compensation_yaw) {
+		update_target(roll, pitch, yaw, updated);
 	}
 
-	/* notify anyone waiting for data */
-	poll_notify(POLLIN);
-
 	perf_end(_sample_perf);
 
 	/* schedule a fresh cycle call when the measurement is done */
@@ -418,6 +550,7 @@ void
 Gimbal::print_info()
 {
 	perf_print_counter(_sample_perf);
+	perf_print_counter(_att_perf);
 	perf_print_counter(_comms_errors);
 	perf_print_counter(_buffer_overflows);
 }
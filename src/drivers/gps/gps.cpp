@@ -92,7 +92,7 @@ public:
 class GPS : public device::CDev
 {
 public:
-	GPS(const char *uart_path, bool fake_gps, bool enable_sat_info);
+	GPS(const char *uart_path, bool fake_gps, bool enable_sat_info, bool enable_dump);
 	virtual ~GPS();
 
 	virtual int			init();
@@ -123,6 +123,8 @@ private:
 	orb_advert_t			_report_sat_info_pub;				///< uORB pub for satellite info
 	float				_rate;						///< position update rate
 	bool				_fake_gps;					///< fake gps output
+	bool				_enable_dump;					///< forward raw receiver data to gps_dump
+	orb_advert_t			_dump_pub;					///< uORB pub for raw receiver data
 
 
 	/**
@@ -167,7 +169,7 @@ GPS	*g_dev = nullptr;
 }
 
 
-GPS::GPS(const char *uart_path, bool fake_gps, bool enable_sat_info) :
+GPS::GPS(const char *uart_path, bool fake_gps, bool enable_sat_info, bool enable_dump) :
 	CDev("gps", GPS0_DEVICE_PATH),
 	_task_should_exit(false),
 	_healthy(false),
@@ -179,7 +181,9 @@ GPS::GPS(const char *uart_path, bool fake_gps, bool enable_sat_info) :
 	_p_report_sat_info(nullptr),
 	_report_sat_info_pub(nullptr),
 	_rate(0.0f),
-	_fake_gps(fake_gps)
+	_fake_gps(fake_gps),
+	_enable_dump(enable_dump),
+	_dump_pub(nullptr)
 {
 	/* store port name */
 	strncpy(_port, uart_path, sizeof(_port));
@@ -334,7 +338,8 @@ GPS::task_main()
 
 			switch (_mode) {
 			case GPS_DRIVER_MODE_UBX:
-				_Helper = new UBX(_serial_fd, &_report_gps_pos, _p_report_sat_info);
+				_Helper = new UBX(_serial_fd, &_report_gps_pos, _p_report_sat_info,
+						  _enable_dump ? &_dump_pub : nullptr);
 				break;
 
 			case GPS_DRIVER_MODE_MTK:
@@ -562,7 +567,7 @@ namespace gps
 
 GPS	*g_dev = nullptr;
 
-void	start(const char *uart_path, bool fake_gps, bool enable_sat_info);
+void	start(const char *uart_path, bool fake_gps, bool enable_sat_info, bool enable_dump);
 void	stop();
 void	test();
 void	reset();
@@ -572,7 +577,7 @@ void	info();
  * Start the driver.
  */
 void
-start(const char *uart_path, bool fake_gps, bool enable_sat_info)
+start(const char *uart_path, bool fake_gps, bool enable_sat_info, bool enable_dump)
 {
 	int fd;
 
@@ -580,7 +585,7 @@ start(const char *uart_path, bool fake_gps, bool enable_sat_info)
 		errx(1, "already started");
 
 	/* create the driver */
-	g_dev = new GPS(uart_path, fake_gps, enable_sat_info);
+	g_dev = new GPS(uart_path, fake_gps, enable_sat_info, enable_dump);
 
 	if (g_dev == nullptr)
 		goto fail;
@@ -674,6 +679,7 @@ gps_main(int argc, char *argv[])
 	const char *device_name = GPS_DEFAULT_UART_PORT;
 	bool fake_gps = false;
 	bool enable_sat_info = false;
+	bool enable_dump = false;
 
 	/*
 	 * Start/load the driver.
@@ -701,7 +707,13 @@ gps_main(int argc, char *argv[])
 				enable_sat_info = true;
 		}
 
-		gps::start(device_name, fake_gps, enable_sat_info);
+		/* Detect raw data dump option */
+		for (int i = 2; i < argc; i++) {
+			if (!strcmp(argv[i], "-r"))
+				enable_dump = true;
+		}
+
+		gps::start(device_name, fake_gps, enable_sat_info, enable_dump);
 	}
 
 	if (!strcmp(argv[1], "stop"))
@@ -726,5 +738,5 @@ gps_main(int argc, char *argv[])
 		gps::info();
 
 out:
-	errx(1, "unrecognized command, try 'start', 'stop', 'test', 'reset' or 'status'\n [-d /dev/ttyS0-n][-f (for enabling fake)][-s (to enable sat info)]");
+	errx(1, "unrecognized command, try 'start', 'stop', 'test', 'reset' or 'status'\n [-d /dev/ttyS0-n][-f (for enabling fake)][-s (to enable sat info)][-r (to log raw ubx data)]");
 }
@@ -67,6 +67,7 @@
 #define UBX_CONFIG_TIMEOUT	200		// ms, timeout for waiting ACK
 #define UBX_PACKET_TIMEOUT	2		// ms, if now data during this delay assume that full update received
 #define UBX_WAIT_BEFORE_READ	20		// ms, wait before reading to save read() calls
+#define UBX_DUMP_QUEUE_SIZE	32		// gps_dump messages buffered for the logger, a RAWX epoch takes ~16
 #define DISABLE_MSG_INTERVAL	1000000		// us, try to disable message with this interval
 
 #define MIN(X,Y)	((X) < (Y) ? (X) : (Y))
@@ -85,7 +86,8 @@
 #define UBX_WARN(s, ...)		{warnx(s, ## __VA_ARGS__);}
 #define UBX_DEBUG(s, ...)		{/*warnx(s, ## __VA_ARGS__);*/}
 
-UBX::UBX(const int &fd, struct vehicle_gps_position_s *gps_position, struct satellite_info_s *satellite_info) :
+UBX::UBX(const int &fd, struct vehicle_gps_position_s *gps_position, struct satellite_info_s *satellite_info,
+	 orb_advert_t *dump_pub) :
 	_fd(fd),
 	_gps_position(gps_position),
 	_satellite_info(satellite_info),
@@ -96,7 +98,10 @@ UBX::UBX(const int &fd, struct vehicle_gps_position_s *gps_position, struct sate
 	_disable_cmd_last(0),
 	_ack_waiting_msg(0),
 	_ubx_version(0),
-	_use_nav_pvt(false)
+	_use_nav_pvt(false),
+	_dump_pub(dump_pub),
+	_dump_active(false),
+	_dump{}
 {
 	decode_init();
 }
@@ -246,6 +251,19 @@ UBX::configure(unsigned &baudrate)
 		return 1;
 	}
 
+	if (_dump_pub != nullptr) {
+		/* raw measurements are only output by receivers with raw data firmware (e.g. M8T) */
+		configure_message_rate(UBX_MSG_RXM_RAWX, 1);
+		if (wait_for_ack(UBX_MSG_CFG_MSG, UBX_CONFIG_TIMEOUT, true) < 0) {
+			UBX_WARN("ubx RXM-RAWX not supported");
+		}
+
+		configure_message_rate(UBX_MSG_RXM_SFRBX, 1);
+		if (wait_for_ack(UBX_MSG_CFG_MSG, UBX_CONFIG_TIMEOUT, true) < 0) {
+			UBX_WARN("ubx RXM-SFRBX not supported");
+		}
+	}
+
 	/* request module version information by sending an empty MON-VER message */
 	send_message(UBX_MSG_MON_VER, nullptr, 0);
 
@@ -333,8 +351,8 @@ UBX::receive(const unsigned timeout)
 				count = read(_fd, buf, sizeof(buf));
 
 				/* pass received bytes to the packet decoder */
-				for (int i = 0; i < count; i++) {
-					handled |= parse_char(buf[i]);
+				if (count > 0) {
+					handled |= parse_buffer(buf, count);
 				}
 			}
 		}
@@ -405,6 +423,14 @@ UBX::parse_char(const uint8_t b)
 			// payload will not be handled, discard message
 			decode_init();
 		} else {
+			if (_rx_state == UBX_RXMSG_DUMP) {
+				// forward the whole frame, starting with the header bytes already consumed
+				const uint8_t header[6] = {UBX_SYNC1, UBX_SYNC2, (uint8_t)(_rx_msg & 0xFF), (uint8_t)(_rx_msg >> 8),
+							   (uint8_t)(_rx_payload_length & 0xFF), (uint8_t)(_rx_payload_length >> 8)};
+				_dump_active = true;
+				dump_add(header, sizeof(header));
+			}
+
 			_decode_state = (_rx_payload_length > 0) ? UBX_DECODE_PAYLOAD : UBX_DECODE_CHKSUM1;
 		}
 		break;
@@ -420,6 +446,10 @@ UBX::parse_char(const uint8_t b)
 		case UBX_MSG_MON_VER:
 			ret = payload_rx_add_mon_ver(b);	// add a MON-VER payload byte
 			break;
+		case UBX_MSG_RXM_RAWX:
+		case UBX_MSG_RXM_SFRBX:
+			ret = payload_rx_add_dump(b);		// forward a raw payload byte
+			break;
 		default:
 			ret = payload_rx_add(b);		// add a payload byte
 			break;
@@ -438,6 +468,9 @@ UBX::parse_char(const uint8_t b)
 
 	/* Expecting first checksum byte */
 	case UBX_DECODE_CHKSUM1:
+		if (_dump_active) {
+			dump_add(&b, 1);
+		}
 		if (_rx_ck_a != b) {
 			UBX_WARN("ubx checksum err");
 			decode_init();
@@ -448,6 +481,9 @@ UBX::parse_char(const uint8_t b)
 
 	/* Expecting second checksum byte */
 	case UBX_DECODE_CHKSUM2:
+		if (_dump_active) {
+			dump_add(&b, 1);
+		}
 		if (_rx_ck_b != b) {
 			UBX_WARN("ubx checksum err");
 		} else {
@@ -463,6 +499,53 @@ UBX::parse_char(const uint8_t b)
 	return ret;
 }
 
+int	// 0 = decoding, 1 = message handled, 2 = sat info message handled
+UBX::parse_buffer(const uint8_t *buf, const unsigned len)
+{
+	int handled = 0;
+	unsigned i = 0;
+
+	while (i < len) {
+		if (_decode_state == UBX_DECODE_SYNC1) {
+			/* skip everything up to the next sync byte (NMEA, garbage) in one scan */
+			const uint8_t *sync = (const uint8_t *)memchr(&buf[i], UBX_SYNC1, len - i);
+
+			if (sync == nullptr) {
+				break;
+			}
+
+			i = sync - buf;
+
+		} else if (_decode_state == UBX_DECODE_PAYLOAD
+			   && _rx_msg != UBX_MSG_NAV_SVINFO && _rx_msg != UBX_MSG_MON_VER) {
+			/* plain payloads are copied and checksummed as a whole, see payload_rx_add() */
+			unsigned n = MIN(len - i, (unsigned)(_rx_payload_length - _rx_payload_index));
+
+			if (_rx_state == UBX_RXMSG_DUMP) {
+				dump_add(&buf[i], n);
+
+			} else {
+				memcpy(&_buf.raw[_rx_payload_index], &buf[i], n);
+			}
+
+			add_bytes_to_checksum(&buf[i], n);
+			_rx_payload_index += n;
+			i += n;
+
+			if (_rx_payload_index >= _rx_payload_length) {
+				// payload complete, expecting checksum
+				_decode_state = UBX_DECODE_CHKSUM1;
+			}
+
+			continue;
+		}
+
+		handled |= parse_char(buf[i++]);
+	}
+
+	return handled;
+}
+
 /**
  * Start payload rx
  */
@@ -554,6 +637,14 @@ UBX::payload_rx_init()
 			_rx_state = UBX_RXMSG_IGNORE;	// ignore if _configured
 		break;
 
+	case UBX_MSG_RXM_RAWX:
+	case UBX_MSG_RXM_SFRBX:
+		if (_dump_pub == nullptr)
+			_rx_state = UBX_RXMSG_DISABLE;	// disable if raw data not requested
+		else
+			_rx_state = UBX_RXMSG_DUMP;	// forward unparsed, the payload does not fit _buf
+		break;
+
 	default:
 		_rx_state = UBX_RXMSG_DISABLE;	// disable all other messages
 		break;
@@ -562,6 +653,7 @@ UBX::payload_rx_init()
 	switch (_rx_state) {
 	case UBX_RXMSG_HANDLE:	// handle message
 	case UBX_RXMSG_IGNORE:	// ignore message but don't report error
+	case UBX_RXMSG_DUMP:	// forward message
 		ret = 0;
 		break;
 
@@ -613,6 +705,23 @@ UBX::payload_rx_add(const uint8_t b)
 	return ret;
 }
 
+/**
+ * Add raw payload rx byte
+ */
+int	// -1 = error, 0 = ok, 1 = payload completed
+UBX::payload_rx_add_dump(const uint8_t b)
+{
+	int ret = 0;
+
+	dump_add(&b, 1);
+
+	if (++_rx_payload_index >= _rx_payload_length) {
+		ret = 1;	// payload received completely
+	}
+
+	return ret;
+}
+
 /**
  * Add NAV-SVINFO payload rx byte
  */
@@ -954,6 +1063,12 @@ UBX::payload_rx_done(void)
 void
 UBX::decode_init(void)
 {
+	if (_dump_active) {
+		/* frame forwarded completely or aborted */
+		dump_flush();
+		_dump_active = false;
+	}
+
 	_decode_state = UBX_DECODE_SYNC1;
 	_rx_ck_a = 0;
 	_rx_ck_b = 0;
@@ -968,6 +1083,58 @@ UBX::add_byte_to_checksum(const uint8_t b)
 	_rx_ck_b = _rx_ck_b + _rx_ck_a;
 }
 
+void
+UBX::dump_add(const uint8_t *buf, const unsigned len)
+{
+	unsigned i = 0;
+
+	while (i < len) {
+		unsigned n = MIN(len - i, sizeof(_dump.data) - _dump.len);
+
+		memcpy(&_dump.data[_dump.len], &buf[i], n);
+		_dump.len += n;
+		i += n;
+
+		if (_dump.len >= sizeof(_dump.data)) {
+			dump_flush();
+		}
+	}
+}
+
+void
+UBX::dump_flush(void)
+{
+	if (_dump.len == 0) {
+		return;
+	}
+
+	_dump.timestamp = hrt_absolute_time();
+
+	if (*_dump_pub != nullptr) {
+		orb_publish(ORB_ID(gps_dump), *_dump_pub, &_dump);
+
+	} else {
+		*_dump_pub = orb_advertise_queue(ORB_ID(gps_dump), &_dump, UBX_DUMP_QUEUE_SIZE);
+	}
+
+	_dump.len = 0;
+}
+
+void
+UBX::add_bytes_to_checksum(const uint8_t *buf, const unsigned len)
+{
+	uint8_t ck_a = _rx_ck_a;
+	uint8_t ck_b = _rx_ck_b;
+
+	for (unsigned i = 0; i < len; i++) {
+		ck_a = ck_a + buf[i];
+		ck_b = ck_b + ck_a;
+	}
+
+	_rx_ck_a = ck_a;
+	_rx_ck_b = ck_b;
+}
+
 void
 UBX::calc_checksum(const uint8_t *buffer, const uint16_t length, ubx_checksum_t *checksum)
 {
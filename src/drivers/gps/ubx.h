@@ -49,6 +49,9 @@
 #ifndef UBX_H_
 #define UBX_H_
 
+#include <uORB/uORB.h>
+#include <uORB/topics/gps_dump.h>
+
 #include "gps_helper.h"
 
 #define UBX_SYNC1 0xB5
@@ -56,6 +59,7 @@
 
 /* Message Classes */
 #define UBX_CLASS_NAV		0x01
+#define UBX_CLASS_RXM		0x02
 #define UBX_CLASS_ACK		0x05
 #define UBX_CLASS_CFG		0x06
 #define UBX_CLASS_MON		0x0A
@@ -67,6 +71,8 @@
 #define UBX_ID_NAV_VELNED	0x12
 #define UBX_ID_NAV_TIMEUTC	0x21
 #define UBX_ID_NAV_SVINFO	0x30
+#define UBX_ID_RXM_SFRBX	0x13
+#define UBX_ID_RXM_RAWX		0x15
 #define UBX_ID_ACK_NAK		0x00
 #define UBX_ID_ACK_ACK		0x01
 #define UBX_ID_CFG_PRT		0x00
@@ -84,6 +90,8 @@
 #define UBX_MSG_NAV_VELNED	((UBX_CLASS_NAV) | UBX_ID_NAV_VELNED << 8)
 #define UBX_MSG_NAV_TIMEUTC	((UBX_CLASS_NAV) | UBX_ID_NAV_TIMEUTC << 8)
 #define UBX_MSG_NAV_SVINFO	((UBX_CLASS_NAV) | UBX_ID_NAV_SVINFO << 8)
+#define UBX_MSG_RXM_SFRBX	((UBX_CLASS_RXM) | UBX_ID_RXM_SFRBX << 8)
+#define UBX_MSG_RXM_RAWX	((UBX_CLASS_RXM) | UBX_ID_RXM_RAWX << 8)
 #define UBX_MSG_ACK_NAK		((UBX_CLASS_ACK) | UBX_ID_ACK_NAK << 8)
 #define UBX_MSG_ACK_ACK		((UBX_CLASS_ACK) | UBX_ID_ACK_ACK << 8)
 #define UBX_MSG_CFG_PRT		((UBX_CLASS_CFG) | UBX_ID_CFG_PRT << 8)
@@ -455,7 +463,8 @@ typedef enum {
 	UBX_RXMSG_IGNORE = 0,
 	UBX_RXMSG_HANDLE,
 	UBX_RXMSG_DISABLE,
-	UBX_RXMSG_ERROR_LENGTH
+	UBX_RXMSG_ERROR_LENGTH,
+	UBX_RXMSG_DUMP
 } ubx_rxmsg_state_t;
 
 /* ACK state */
@@ -470,7 +479,8 @@ typedef enum {
 class UBX : public GPS_Helper
 {
 public:
-	UBX(const int &fd, struct vehicle_gps_position_s *gps_position, struct satellite_info_s *satellite_info);
+	UBX(const int &fd, struct vehicle_gps_position_s *gps_position, struct satellite_info_s *satellite_info,
+	    orb_advert_t *dump_pub = nullptr);
 	~UBX();
 	int			receive(const unsigned timeout);
 	int			configure(unsigned &baudrate);
@@ -482,6 +492,12 @@ private:
 	 */
 	int			parse_char(const uint8_t b);
 
+	/**
+	 * Parse a block of received bytes, skips to sync bytes and adds
+	 * payload runs at once instead of passing every byte to parse_char()
+	 */
+	int			parse_buffer(const uint8_t *buf, const unsigned len);
+
 	/**
 	 * Start payload rx
 	 */
@@ -493,6 +509,7 @@ private:
 	int			payload_rx_add(const uint8_t b);
 	int			payload_rx_add_nav_svinfo(const uint8_t b);
 	int			payload_rx_add_mon_ver(const uint8_t b);
+	int			payload_rx_add_dump(const uint8_t b);
 
 	/**
 	 * Finish payload rx
@@ -508,6 +525,17 @@ private:
 	 * While parsing add every byte (except the sync bytes) to the checksum
 	 */
 	void			add_byte_to_checksum(const uint8_t);
+	void			add_bytes_to_checksum(const uint8_t *buf, const unsigned len);
+
+	/**
+	 * Forward raw frame bytes to the gps_dump topic, full messages are published right away
+	 */
+	void			dump_add(const uint8_t *buf, const unsigned len);
+
+	/**
+	 * Publish the buffered raw frame bytes
+	 */
+	void			dump_flush(void);
 
 	/**
 	 * Send a message
@@ -554,6 +582,9 @@ private:
 	ubx_buf_t		_buf;
 	uint32_t		_ubx_version;
 	bool			_use_nav_pvt;
+	orb_advert_t		*_dump_pub;		///< forward RXM-RAWX and RXM-SFRBX frames to gps_dump if set
+	bool			_dump_active;		///< the frame being received is forwarded
+	struct gps_dump_s	_dump;
 };
 
 #endif /* UBX_H_ */
@@ -73,6 +73,7 @@
 #include <float.h>
 #include <getopt.h>
 #include <lib/conversion/rotation.h>
+#include <lib/conversion/sensor_correction.h>
 
 #include "hmc5883.h"
 
@@ -178,6 +179,8 @@ private:
 
 	enum Rotation		_rotation;
 
+	SensorCorrection	_correction;
+
 	struct mag_report	_last_report;           /**< used for info() */
 
 	uint8_t			_range_bits;
@@ -238,6 +241,11 @@ private:
 	 */
 	int 			set_range(unsigned range);
 
+	/**
+	 * Fold rotation, range scale and calibration into the correction, after any of them changed.
+	 */
+	void			update_correction();
+
 	/**
 	 * check the sensor range.
 	 *
@@ -482,6 +490,8 @@ int HMC5883::set_range(unsigned range)
 		_range_ga = 8.1f;
 	}
 
+	update_correction();
+
 	int ret;
 
 	/*
@@ -501,6 +511,11 @@ int HMC5883::set_range(unsigned range)
 	return !(range_bits_in == (_range_bits << 5));
 }
 
+void HMC5883::update_correction()
+{
+	_correction.set(_rotation, _range_scale, _scale);
+}
+
 /**
    check that the range register has the right value. This is done
    periodically to cope with I2C bus noise causing the range of the
@@ -715,6 +730,7 @@ HMC5883::ioctl(struct file *filp, int cmd, unsigned long arg)
 	case MAGIOCSSCALE:
 		/* set new scale factors */
 		memcpy(&_scale, (mag_scale *)arg, sizeof(_scale));
+		update_correction();
 		/* check calibration, but not actually return an error */
 		(void)check_calibration();
 		return 0;
@@ -866,9 +882,6 @@ HMC5883::collect()
 	struct mag_report new_report;
 	bool sensor_is_onboard = false;
 
-	float xraw_f;
-	float yraw_f;
-	float zraw_f;
 
 	/* this should be fairly close to the end of the measurement, so the best approximation of the time */
 	new_report.timestamp = hrt_absolute_time();
@@ -971,18 +984,13 @@ HMC5883::collect()
         /* the standard external mag by 3DR has x pointing to the
 	 * right, y pointing backwards, and z down, therefore switch x
 	 * and y and invert y */
-        xraw_f = -report.y;
-	yraw_f = report.x;
-	zraw_f = report.z;
+	/* apply user specified rotation, range scale and calibration in one step */
+	float mag_in[3];
+	_correction.apply(-report.y, report.x, report.z, mag_in);
 
-	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
-
-	new_report.x = ((xraw_f * _range_scale) - _scale.x_offset) * _scale.x_scale;
-	/* flip axes and negate value for y */
-	new_report.y = ((yraw_f * _range_scale) - _scale.y_offset) * _scale.y_scale;
-	/* z remains z */
-	new_report.z = ((zraw_f * _range_scale) - _scale.z_offset) * _scale.z_scale;
+	new_report.x = mag_in[0];
+	new_report.y = mag_in[1];
+	new_report.z = mag_in[2];
 
 	if (!(_pub_blocked)) {
 
@@ -119,16 +119,8 @@ send_data(int uart, uint8_t *buffer, size_t size)
 {
 	usleep(POST_READ_DELAY_IN_USECS);
 
-	uint16_t checksum = 0;
+	/* the response comes complete with its checksum, only the pacing is left */
 	for (size_t i = 0; i < size; i++) {
-		if (i == size - 1) {
-			/* Set the checksum: the first uint8_t is taken as the checksum. */
-			buffer[i] = checksum & 0xff;
-
-		} else {
-			checksum += buffer[i];
-		}
-
 		write(uart, &buffer[i], sizeof(buffer[i]));
 
 		/* Sleep before sending the next byte. */
@@ -69,6 +69,36 @@ static bool _home_position_set = false;
 static double _home_lat = 0.0d;
 static double _home_lon = 0.0d;
 
+/*
+ * The responses are kept serialized, and only the parts whose source
+ * topics changed are updated when the receiver polls.
+ */
+static struct eam_module_msg _eam_msg;
+static struct gam_module_msg _gam_msg;
+static struct gps_module_msg _gps_msg;
+static struct vehicle_gps_position_s _gps;
+
+static bool
+topic_updated(int handle)
+{
+	bool updated = false;
+	orb_check(handle, &updated);
+	return updated;
+}
+
+/* The last uint8_t is the lower 8 bits of the sum of all others. */
+static void
+set_checksum(uint8_t *buffer, size_t size)
+{
+	uint16_t checksum = 0;
+
+	for (size_t i = 0; i < size - 1; i++) {
+		checksum += buffer[i];
+	}
+
+	buffer[size - 1] = checksum & 0xff;
+}
+
 void 
 init_sub_messages(void)
 {
@@ -78,6 +108,36 @@ init_sub_messages(void)
 	_sensor_sub = orb_subscribe(ORB_ID(sensor_combined));
 	_airspeed_sub = orb_subscribe(ORB_ID(airspeed));
 	_esc_sub = orb_subscribe(ORB_ID(esc_status));
+
+	memset(&_eam_msg, 0, sizeof(_eam_msg));
+	_eam_msg.start = START_BYTE;
+	_eam_msg.eam_sensor_id = EAM_SENSOR_ID;
+	_eam_msg.sensor_text_id = EAM_SENSOR_TEXT_ID;
+	_eam_msg.temperature1 = 20;
+	_eam_msg.temperature2 = _eam_msg.temperature1 - BOARD_TEMP_OFFSET_DEG;
+	_eam_msg.altitude_L = 500 & 0xff;
+	_eam_msg.altitude_H = (500 >> 8) & 0xff;
+	_eam_msg.stop = STOP_BYTE;
+	set_checksum((uint8_t *)&_eam_msg, sizeof(_eam_msg));
+
+	memset(&_gam_msg, 0, sizeof(_gam_msg));
+	_gam_msg.start = START_BYTE;
+	_gam_msg.gam_sensor_id = GAM_SENSOR_ID;
+	_gam_msg.sensor_text_id = GAM_SENSOR_TEXT_ID;
+	_gam_msg.temperature1 = 20;
+	_gam_msg.temperature2 = 20;  // 0 deg. C.
+	_gam_msg.stop = STOP_BYTE;
+	set_checksum((uint8_t *)&_gam_msg, sizeof(_gam_msg));
+
+	memset(&_gps, 0, sizeof(_gps));
+	memset(&_gps_msg, 0, sizeof(_gps_msg));
+	_gps_msg.start = START_BYTE;
+	_gps_msg.sensor_id = GPS_SENSOR_ID;
+	_gps_msg.sensor_text_id = GPS_SENSOR_TEXT_ID;
+	_gps_msg.gps_fix_char = '0';
+	_gps_msg.gps_fix = '0';
+	_gps_msg.stop = STOP_BYTE;
+	set_checksum((uint8_t *)&_gps_msg, sizeof(_gps_msg));
 }
 
 void 
@@ -130,96 +190,114 @@ publish_gam_message(const uint8_t *buffer)
 void 
 build_eam_response(uint8_t *buffer, size_t *size)
 {
-	/* get a local copy of the current sensor values */
-	struct sensor_combined_s raw;
-	memset(&raw, 0, sizeof(raw));
-	orb_copy(ORB_ID(sensor_combined), _sensor_sub, &raw);
+	struct eam_module_msg &msg = _eam_msg;
+	bool changed = false;
 
-	/* get a local copy of the battery data */
-	struct battery_status_s battery;
-	memset(&battery, 0, sizeof(battery));
-	orb_copy(ORB_ID(battery_status), _battery_sub, &battery);
+	if (topic_updated(_sensor_sub)) {
+		/* get a local copy of the current sensor values */
+		struct sensor_combined_s raw;
+		orb_copy(ORB_ID(sensor_combined), _sensor_sub, &raw);
 
-	struct eam_module_msg msg;
-	*size = sizeof(msg);
-	memset(&msg, 0, *size);
+		msg.temperature1 = (uint8_t)(raw.baro_temp_celcius[0] + 20);
+		msg.temperature2 = msg.temperature1 - BOARD_TEMP_OFFSET_DEG;
 
-	msg.start = START_BYTE;
-	msg.eam_sensor_id = EAM_SENSOR_ID;
-	msg.sensor_text_id = EAM_SENSOR_TEXT_ID;
-	
-	msg.temperature1 = (uint8_t)(raw.baro_temp_celcius[0] + 20);
-	msg.temperature2 = msg.temperature1 - BOARD_TEMP_OFFSET_DEG;
+		uint16_t alt = (uint16_t)(raw.baro_alt_meter[0] + 500);
+		msg.altitude_L = (uint8_t)alt & 0xff;
+		msg.altitude_H = (uint8_t)(alt >> 8) & 0xff;
+		changed = true;
+	}
 
-	msg.main_voltage_L = (uint8_t)(battery.voltage_v * 10);
+	if (topic_updated(_battery_sub)) {
+		/* get a local copy of the battery data */
+		struct battery_status_s battery;
+		orb_copy(ORB_ID(battery_status), _battery_sub, &battery);
 
-	uint16_t alt = (uint16_t)(raw.baro_alt_meter[0] + 500);
-	msg.altitude_L = (uint8_t)alt & 0xff;
-	msg.altitude_H = (uint8_t)(alt >> 8) & 0xff;
+		msg.main_voltage_L = (uint8_t)(battery.voltage_v * 10);
+		changed = true;
+	}
 
-	/* get a local copy of the airspeed data */
-	struct airspeed_s airspeed;
-	memset(&airspeed, 0, sizeof(airspeed));
-	orb_copy(ORB_ID(airspeed), _airspeed_sub, &airspeed);
+	if (topic_updated(_airspeed_sub)) {
+		/* get a local copy of the airspeed data */
+		struct airspeed_s airspeed;
+		orb_copy(ORB_ID(airspeed), _airspeed_sub, &airspeed);
 
-	uint16_t speed = (uint16_t)(airspeed.indicated_airspeed_m_s * 3.6f);
-	msg.speed_L = (uint8_t)speed & 0xff;
-	msg.speed_H = (uint8_t)(speed >> 8) & 0xff;
+		uint16_t speed = (uint16_t)(airspeed.indicated_airspeed_m_s * 3.6f);
+		msg.speed_L = (uint8_t)speed & 0xff;
+		msg.speed_H = (uint8_t)(speed >> 8) & 0xff;
+		changed = true;
+	}
+
+	*size = sizeof(msg);
+
+	if (changed) {
+		set_checksum((uint8_t *)&msg, *size);
+	}
 
-	msg.stop = STOP_BYTE;
 	memcpy(buffer, &msg, *size);
 }
 
 void 
 build_gam_response(uint8_t *buffer, size_t *size)
 {
-	/* get a local copy of the ESC Status values */
-	struct esc_status_s esc;
-	memset(&esc, 0, sizeof(esc));
-	orb_copy(ORB_ID(esc_status), _esc_sub, &esc);
+	struct gam_module_msg &msg = _gam_msg;
 
-	struct gam_module_msg msg;
-	*size = sizeof(msg);
-	memset(&msg, 0, *size);
+	if (topic_updated(_esc_sub)) {
+		/* get a local copy of the ESC Status values */
+		struct esc_status_s esc;
+		orb_copy(ORB_ID(esc_status), _esc_sub, &esc);
 
-	msg.start = START_BYTE;
-	msg.gam_sensor_id = GAM_SENSOR_ID;
-	msg.sensor_text_id = GAM_SENSOR_TEXT_ID;
-	
-	msg.temperature1 = (uint8_t)(esc.esc[0].esc_temperature + 20.0F);
-	msg.temperature2 = 20;  // 0 deg. C.
+		msg.temperature1 = (uint8_t)(esc.esc[0].esc_temperature + 20.0F);
 
-	const uint16_t voltage = (uint16_t)(esc.esc[0].esc_voltage * 10.0F);
-	msg.main_voltage_L = (uint8_t)voltage & 0xff;
-	msg.main_voltage_H = (uint8_t)(voltage >> 8) & 0xff;
+		const uint16_t voltage = (uint16_t)(esc.esc[0].esc_voltage * 10.0F);
+		msg.main_voltage_L = (uint8_t)voltage & 0xff;
+		msg.main_voltage_H = (uint8_t)(voltage >> 8) & 0xff;
 
-	const uint16_t current = (uint16_t)(esc.esc[0].esc_current * 10.0F);
-	msg.current_L = (uint8_t)current & 0xff;
-	msg.current_H = (uint8_t)(current >> 8) & 0xff;
+		const uint16_t current = (uint16_t)(esc.esc[0].esc_current * 10.0F);
+		msg.current_L = (uint8_t)current & 0xff;
+		msg.current_H = (uint8_t)(current >> 8) & 0xff;
 
-	const uint16_t rpm = (uint16_t)(esc.esc[0].esc_rpm * 0.1f);
-	msg.rpm_L = (uint8_t)rpm & 0xff;
-	msg.rpm_H = (uint8_t)(rpm >> 8) & 0xff;
+		const uint16_t rpm = (uint16_t)(esc.esc[0].esc_rpm * 0.1f);
+		msg.rpm_L = (uint8_t)rpm & 0xff;
+		msg.rpm_H = (uint8_t)(rpm >> 8) & 0xff;
 
-	msg.stop = STOP_BYTE;
+		set_checksum((uint8_t *)&msg, sizeof(msg));
+	}
+
+	*size = sizeof(msg);
 	memcpy(buffer, &msg, *size);
 }
 
 void 
 build_gps_response(uint8_t *buffer, size_t *size)
 {
-	/* get a local copy of the current sensor values */
-	struct sensor_combined_s raw;
-	memset(&raw, 0, sizeof(raw));
-	orb_copy(ORB_ID(sensor_combined), _sensor_sub, &raw);
+	struct gps_module_msg &msg = _gps_msg;
+	struct vehicle_gps_position_s &gps = _gps;
+	*size = sizeof(msg);
 
- 	/* get a local copy of the battery data */
-	struct vehicle_gps_position_s gps;
-	memset(&gps, 0, sizeof(gps));
-	orb_copy(ORB_ID(vehicle_gps_position), _gps_sub, &gps);
+	/* Get any (and probably only ever one) _home_sub postion report */
+	bool updated = topic_updated(_home_sub);
+	if (updated) {
+		/* get a local copy of the home position data */
+		struct home_position_s home;
+		orb_copy(ORB_ID(home_position), _home_sub, &home);
+
+		_home_lat = home.lat;
+		_home_lon = home.lon;
+		_home_position_set = true;
+	}
+
+	if (topic_updated(_gps_sub)) {
+		/* get a local copy of the gps data */
+		orb_copy(ORB_ID(vehicle_gps_position), _gps_sub, &gps);
+		updated = true;
+	}
+
+	/* nothing changed, resend the last response */
+	if (!updated) {
+		memcpy(buffer, &msg, *size);
+		return;
+	}
 
-	struct gps_module_msg msg;
-	*size = sizeof(msg);
 	memset(&msg, 0, *size);
 
 	msg.start = START_BYTE;
@@ -288,20 +366,6 @@ build_gps_response(uint8_t *buffer, size_t *size)
 		msg.altitude_L = (uint8_t)alt & 0xff;
 		msg.altitude_H = (uint8_t)(alt >> 8) & 0xff;
 
-		/* Get any (and probably only ever one) _home_sub postion report */
-		bool updated;
-		orb_check(_home_sub, &updated);
-		if (updated) {
-			/* get a local copy of the home position data */
-			struct home_position_s home;
-			memset(&home, 0, sizeof(home));
-			orb_copy(ORB_ID(home_position), _home_sub, &home);
-
-			_home_lat = home.lat;
-			_home_lon = home.lon;
-			_home_position_set = true;
-		}
-
 		/* Distance from home */
 		if (_home_position_set) {
 			uint16_t dist = (uint16_t)get_distance_to_next_waypoint(_home_lat, _home_lon, lat, lon);
@@ -316,6 +380,7 @@ build_gps_response(uint8_t *buffer, size_t *size)
 	}
 
 	msg.stop = STOP_BYTE;
+	set_checksum((uint8_t *)&msg, *size);
 	memcpy(buffer, &msg, *size);
 }
 
@@ -0,0 +1,208 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file hrt_callout_heap.h
+ *
+ * Deadline ordered callout queue shared by the HRT drivers.
+ *
+ * The queue is a pairing heap threaded through the hrt_call records, so
+ * entering a callout is O(1) and removing one is O(log n) amortised, without
+ * any allocation and regardless of the number of callouts. The old sorted
+ * list needed a linear walk for every (re-)entered callout.
+ *
+ * Records with equal deadlines are not guaranteed to run in the order they
+ * were entered. None of the functions lock, the caller has to serialise all
+ * accesses with the timer interrupt.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <drivers/drv_hrt.h>
+
+struct hrt_callout_heap {
+	struct hrt_call	*root;
+};
+
+static inline void
+hrt_callout_heap_init(struct hrt_callout_heap *heap)
+{
+	heap->root = NULL;
+}
+
+/*
+ * The callout with the earliest deadline, or NULL if the queue is empty.
+ */
+static inline struct hrt_call *
+hrt_callout_heap_peek(struct hrt_callout_heap *heap)
+{
+	return heap->root;
+}
+
+/*
+ * True if the record is in the queue.
+ *
+ * Only the root has no prev link while queued, removed records get it cleared.
+ */
+static inline bool
+hrt_callout_heap_contains(struct hrt_callout_heap *heap, struct hrt_call *entry)
+{
+	return (entry == heap->root) || (entry->prev != NULL);
+}
+
+/*
+ * Merge two heaps, the root with the later deadline becomes the first
+ * child of the other one. On a tie a stays the root.
+ */
+static inline struct hrt_call *
+hrt_callout_heap_meld(struct hrt_call *a, struct hrt_call *b)
+{
+	if (a == NULL) {
+		return b;
+	}
+
+	if (b == NULL) {
+		return a;
+	}
+
+	if (b->deadline < a->deadline) {
+		struct hrt_call *t = a;
+		a = b;
+		b = t;
+	}
+
+	b->prev = a;
+	b->sibling = a->child;
+
+	if (a->child != NULL) {
+		a->child->prev = b;
+	}
+
+	a->child = b;
+	a->sibling = NULL;
+	a->prev = NULL;
+	return a;
+}
+
+/*
+ * Combine a list of siblings into one heap, the standard two pass scheme:
+ * meld neighbours pairwise left to right, then the pairs right to left.
+ */
+static inline struct hrt_call *
+hrt_callout_heap_meld_siblings(struct hrt_call *first)
+{
+	struct hrt_call *pairs = NULL;
+
+	while (first != NULL) {
+		struct hrt_call *a = first;
+		struct hrt_call *b = a->sibling;
+		struct hrt_call *pair;
+
+		if (b != NULL) {
+			first = b->sibling;
+			b->sibling = NULL;
+			b->prev = NULL;
+
+		} else {
+			first = NULL;
+		}
+
+		a->sibling = NULL;
+		a->prev = NULL;
+
+		pair = hrt_callout_heap_meld(a, b);
+		pair->sibling = pairs;
+		pairs = pair;
+	}
+
+	struct hrt_call *result = NULL;
+
+	while (pairs != NULL) {
+		struct hrt_call *next = pairs->sibling;
+		pairs->sibling = NULL;
+		result = hrt_callout_heap_meld(result, pairs);
+		pairs = next;
+	}
+
+	return result;
+}
+
+/*
+ * Enter a record that is not queued.
+ */
+static inline void
+hrt_callout_heap_insert(struct hrt_callout_heap *heap, struct hrt_call *entry)
+{
+	entry->child = NULL;
+	entry->sibling = NULL;
+	entry->prev = NULL;
+	heap->root = hrt_callout_heap_meld(heap->root, entry);
+}
+
+/*
+ * Remove a record, does nothing if it is not queued.
+ */
+static inline void
+hrt_callout_heap_remove(struct hrt_callout_heap *heap, struct hrt_call *entry)
+{
+	if (!hrt_callout_heap_contains(heap, entry)) {
+		return;
+	}
+
+	struct hrt_call *children = hrt_callout_heap_meld_siblings(entry->child);
+
+	if (entry == heap->root) {
+		heap->root = children;
+
+	} else {
+		/* unlink from the parent or the left sibling */
+		if (entry->prev->child == entry) {
+			entry->prev->child = entry->sibling;
+
+		} else {
+			entry->prev->sibling = entry->sibling;
+		}
+
+		if (entry->sibling != NULL) {
+			entry->sibling->prev = entry->prev;
+		}
+
+		heap->root = hrt_callout_heap_meld(heap->root, children);
+	}
+
+	entry->child = NULL;
+	entry->sibling = NULL;
+	entry->prev = NULL;
+}
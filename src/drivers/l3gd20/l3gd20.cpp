@@ -69,8 +69,9 @@
 #include <drivers/device/integrator.h>
 
 #include <board_config.h>
-#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/BiquadFilterBank.hpp>
 #include <lib/conversion/rotation.h>
+#include <lib/conversion/sensor_correction.h>
 
 #define L3GD20_DEVICE_PATH "/dev/l3gd20"
 
@@ -230,7 +231,7 @@ protected:
 
 private:
 
-	struct hrt_call		_call;
+	struct bus_call		_call;
 	unsigned		_call_interval;
 
 	ringbuffer::RingBuffer	*_reports;
@@ -254,9 +255,7 @@ private:
 
 	uint8_t			_register_wait;
 
-	math::LowPassFilter2p	_gyro_filter_x;
-	math::LowPassFilter2p	_gyro_filter_y;
-	math::LowPassFilter2p	_gyro_filter_z;
+	math::BiquadFilterBank<3>	_gyro_filter;
 
 	Integrator		_gyro_int;
 
@@ -265,6 +264,8 @@ private:
 
 	enum Rotation		_rotation;
 
+	SensorCorrection	_gyro_correction;
+
 	// this is used to support runtime checking of key
 	// configuration registers to detect SPI bus errors and sensor
 	// reset
@@ -366,6 +367,11 @@ private:
 	 */
 	int			set_range(unsigned max_dps);
 
+	/**
+	 * Fold rotation, range scale and calibration into the correction, after any of them changed.
+	 */
+	void			update_correction();
+
 	/**
 	 * Set the L3GD20 internal sampling frequency.
 	 *
@@ -428,9 +434,7 @@ L3GD20::L3GD20(int bus, const char* path, spi_dev_e device, enum Rotation rotati
 	_bad_registers(perf_alloc(PC_COUNT, "l3gd20_bad_registers")),
 	_duplicates(perf_alloc(PC_COUNT, "l3gd20_duplicates")),
 	_register_wait(0),
-	_gyro_filter_x(L3GD20_DEFAULT_RATE, L3GD20_DEFAULT_FILTER_FREQ),
-	_gyro_filter_y(L3GD20_DEFAULT_RATE, L3GD20_DEFAULT_FILTER_FREQ),
-	_gyro_filter_z(L3GD20_DEFAULT_RATE, L3GD20_DEFAULT_FILTER_FREQ),
+	_gyro_filter(L3GD20_DEFAULT_RATE, L3GD20_DEFAULT_FILTER_FREQ),
 	_gyro_int(1000000 / L3GD20_MAX_OUTPUT_RATE, true),
 	_is_l3g4200d(false),
 	_rotation(rotation),
@@ -494,8 +498,8 @@ L3GD20::init()
 	struct gyro_report grp;
 	_reports->get(&grp);
 
-	_gyro_topic = orb_advertise_multi(ORB_ID(sensor_gyro), &grp,
-		&_orb_class_instance, (is_external()) ? ORB_PRIO_VERY_HIGH : ORB_PRIO_DEFAULT);
+	_gyro_topic = orb_advertise_multi_queue(ORB_ID(sensor_gyro), &grp,
+		&_orb_class_instance, (is_external()) ? ORB_PRIO_VERY_HIGH : ORB_PRIO_DEFAULT, SENSOR_ORB_QUEUE_SIZE);
 
 	if (_gyro_topic == nullptr) {
 		DEVICE_DEBUG("failed to create sensor_gyro publication");
@@ -628,7 +632,7 @@ L3GD20::ioctl(struct file *filp, int cmd, unsigned long arg)
                                         _call.period = _call_interval - L3GD20_TIMER_REDUCTION;
 
 					/* adjust filters */
-					float cutoff_freq_hz = _gyro_filter_x.get_cutoff_freq();
+					float cutoff_freq_hz = _gyro_filter.get_cutoff_freq();
 					float sample_rate = 1.0e6f/ticks;
 					set_driver_lowpass_filter(sample_rate, cutoff_freq_hz);
 
@@ -684,11 +688,12 @@ L3GD20::ioctl(struct file *filp, int cmd, unsigned long arg)
 	}
 
 	case GYROIOCGLOWPASS:
-		return static_cast<int>(_gyro_filter_x.get_cutoff_freq());
+		return static_cast<int>(_gyro_filter.get_cutoff_freq());
 
 	case GYROIOCSSCALE:
 		/* copy scale in */
 		memcpy(&_gyro_scale, (struct gyro_scale *) arg, sizeof(_gyro_scale));
+		update_correction();
 		return OK;
 
 	case GYROIOCGSCALE:
@@ -791,11 +796,18 @@ L3GD20::set_range(unsigned max_dps)
 
 	_gyro_range_rad_s = new_range / 180.0f * M_PI_F;
 	_gyro_range_scale = new_range_scale_dps_digit / 180.0f * M_PI_F;
+	update_correction();
 	write_checked_reg(ADDR_CTRL_REG4, bits);
 
 	return OK;
 }
 
+void
+L3GD20::update_correction()
+{
+	_gyro_correction.set(_rotation, _gyro_range_scale, _gyro_scale);
+}
+
 int
 L3GD20::set_samplerate(unsigned frequency)
 {
@@ -836,9 +848,7 @@ L3GD20::set_samplerate(unsigned frequency)
 void
 L3GD20::set_driver_lowpass_filter(float samplerate, float bandwidth)
 {
-	_gyro_filter_x.set_cutoff_frequency(samplerate, bandwidth);
-	_gyro_filter_y.set_cutoff_frequency(samplerate, bandwidth);
-	_gyro_filter_z.set_cutoff_frequency(samplerate, bandwidth);
+	_gyro_filter.set_cutoff_frequency(samplerate, bandwidth);
 }
 
 void
@@ -851,7 +861,7 @@ L3GD20::start()
 	_reports->flush();
 
 	/* start polling at the specified rate */
-	hrt_call_every(&_call,
+	bus_call_every(&_call,
                        1000,
                        _call_interval - L3GD20_TIMER_REDUCTION,
                        (hrt_callout)&L3GD20::measure_trampoline, this);
@@ -860,7 +870,7 @@ L3GD20::start()
 void
 L3GD20::stop()
 {
-	hrt_cancel(&_call);
+	bus_cancel(&_call);
 }
 
 void
@@ -1027,24 +1037,18 @@ L3GD20::measure()
 
 	report.temperature_raw = raw_report.temp;
 
-	float xraw_f = report.x_raw;
-	float yraw_f = report.y_raw;
-	float zraw_f = report.z_raw;
-
-	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	// apply user specified rotation, range scale and calibration in one step
+	float gyro_in[3];
+	_gyro_correction.apply(report.x_raw, report.y_raw, report.z_raw, gyro_in);
 
-	float xin = ((xraw_f * _gyro_range_scale) - _gyro_scale.x_offset) * _gyro_scale.x_scale;
-	float yin = ((yraw_f * _gyro_range_scale) - _gyro_scale.y_offset) * _gyro_scale.y_scale;
-	float zin = ((zraw_f * _gyro_range_scale) - _gyro_scale.z_offset) * _gyro_scale.z_scale;
-
-	report.x = _gyro_filter_x.apply(xin);
-	report.y = _gyro_filter_y.apply(yin);
-	report.z = _gyro_filter_z.apply(zin);
-
-	math::Vector<3> gval(xin, yin, zin);
+	math::Vector<3> gval(gyro_in[0], gyro_in[1], gyro_in[2]);
 	math::Vector<3> gval_integrated;
 
+	_gyro_filter.apply(gyro_in);
+	report.x = gyro_in[0];
+	report.y = gyro_in[1];
+	report.z = gyro_in[2];
+
 	bool gyro_notify = _gyro_int.put(report.timestamp, gval, gval_integrated, report.integral_dt);
 	report.x_integral = gval_integrated(0);
 	report.y_integral = gval_integrated(1);
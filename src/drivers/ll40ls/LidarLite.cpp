@@ -45,7 +45,8 @@
 LidarLite::LidarLite() :
 	_min_distance(LL40LS_MIN_DISTANCE),
 	_max_distance(LL40LS_MAX_DISTANCE),
-	_measure_ticks(0)
+	_measure_ticks(0),
+	_rate(USEC2TICK(RANGEFINDER_IDLE_INTERVAL))
 {
 }
 
@@ -78,6 +79,16 @@ uint32_t LidarLite::getMeasureTicks() const
 	return _measure_ticks;
 }
 
+uint32_t LidarLite::getCycleTicks(bool device_open)
+{
+	return _rate.interval(_measure_ticks, device_open);
+}
+
+bool LidarLite::isIdle() const
+{
+	return _rate.idle();
+}
+
 int LidarLite::ioctl(struct file *filp, int cmd, unsigned long arg)
 {
 	switch (cmd) {
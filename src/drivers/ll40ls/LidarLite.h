@@ -41,6 +41,7 @@
 #pragma once
 
 #include <drivers/device/device.h>
+#include <drivers/device/rangefinder_rate.h>
 #include <drivers/drv_range_finder.h>
 
 /* Device limits */
@@ -93,6 +94,14 @@ protected:
 
 	uint32_t            getMeasureTicks() const;
 
+	/**
+	 * @brief
+	 *   Ticks until the next measurement, longer than getMeasureTicks() while idle.
+	 *   Call it from the measurement cycle only.
+	 */
+	uint32_t            getCycleTicks(bool device_open);
+	bool                isIdle() const;
+
 	virtual int         measure() = 0;
 	virtual int         collect() = 0;
 
@@ -102,4 +111,5 @@ private:
 	float               _min_distance;
 	float               _max_distance;
 	uint32_t            _measure_ticks;
+	device::RangefinderRate _rate;
 };
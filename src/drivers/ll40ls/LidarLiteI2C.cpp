@@ -520,17 +520,20 @@ void LidarLiteI2C::cycle()
 			/* next phase is measurement */
 			_collect_phase = false;
 
+			/* slower while idle */
+			uint32_t ticks = getCycleTicks(is_open());
+
 			/*
 			 * Is there a collect->measure gap?
 			 */
-			if (getMeasureTicks() > USEC2TICK(LL40LS_CONVERSION_INTERVAL)) {
+			if (ticks > USEC2TICK(LL40LS_CONVERSION_INTERVAL)) {
 
 				/* schedule a fresh cycle call when we are ready to measure again */
 				work_queue(HPWORK,
 					   &_work,
 					   (worker_t)&LidarLiteI2C::cycle_trampoline,
 					   this,
-					   getMeasureTicks() - USEC2TICK(LL40LS_CONVERSION_INTERVAL));
+					   ticks - USEC2TICK(LL40LS_CONVERSION_INTERVAL));
 
 				return;
 			}
@@ -565,7 +568,7 @@ void LidarLiteI2C::print_info()
 	perf_print_counter(_buffer_overflows);
 	perf_print_counter(_sensor_resets);
 	perf_print_counter(_sensor_zero_resets);
-	printf("poll interval:  %u ticks\n", getMeasureTicks());
+	printf("poll interval:  %u ticks%s\n", getMeasureTicks(), isIdle() ? " (idle)" : "");
 	_reports->print_info("report queue");
 	printf("distance: %ucm (0x%04x)\n",
 	       (unsigned)_last_distance, (unsigned)_last_distance);
@@ -166,7 +166,7 @@ void LidarLitePWM::cycle()
 		   &_work,
 		   (worker_t)&LidarLitePWM::cycle_trampoline,
 		   this,
-		   getMeasureTicks());
+		   getCycleTicks(is_open()));
 	return;
 }
 
@@ -69,8 +69,9 @@
 #include <drivers/drv_tone_alarm.h>
 
 #include <board_config.h>
-#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/BiquadFilterBank.hpp>
 #include <lib/conversion/rotation.h>
+#include <lib/conversion/sensor_correction.h>
 
 /* oddly, ERROR is not defined for c++ */
 #ifdef ERROR
@@ -271,8 +272,8 @@ private:
 
 	LSM303D_mag		*_mag;
 
-	struct hrt_call		_accel_call;
-	struct hrt_call		_mag_call;
+	struct bus_call		_accel_call;
+	struct bus_call		_mag_call;
 
 	unsigned		_call_accel_interval;
 	unsigned		_call_mag_interval;
@@ -306,14 +307,15 @@ private:
 
 	uint8_t			_register_wait;
 
-	math::LowPassFilter2p	_accel_filter_x;
-	math::LowPassFilter2p	_accel_filter_y;
-	math::LowPassFilter2p	_accel_filter_z;
+	math::BiquadFilterBank<3>	_accel_filter;
 
 	Integrator		_accel_int;
 
 	enum Rotation		_rotation;
 
+	SensorCorrection	_accel_correction;
+	SensorCorrection	_mag_correction;
+
 	// values used to
 	float			_last_accel[3];
 	uint8_t			_constant_accel_count;
@@ -458,6 +460,11 @@ private:
 	 */
 	int			mag_set_range(unsigned max_g);
 
+	/**
+	 * Fold rotation, range scale and calibration into the corrections, after any of them changed.
+	 */
+	void			update_correction();
+
 	/**
 	 * Set the LSM303D on-chip anti-alias filter bandwith.
 	 *
@@ -578,9 +585,7 @@ LSM303D::LSM303D(int bus, const char* path, spi_dev_e device, enum Rotation rota
 	_bad_values(perf_alloc(PC_COUNT, "lsm303d_bad_values")),
 	_accel_duplicates(perf_alloc(PC_COUNT, "lsm303d_accel_duplicates")),
 	_register_wait(0),
-	_accel_filter_x(LSM303D_ACCEL_DEFAULT_RATE, LSM303D_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_y(LSM303D_ACCEL_DEFAULT_RATE, LSM303D_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_z(LSM303D_ACCEL_DEFAULT_RATE, LSM303D_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
+	_accel_filter(LSM303D_ACCEL_DEFAULT_RATE, LSM303D_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
 	_accel_int(1000000 / LSM303D_ACCEL_MAX_OUTPUT_RATE, true),
 	_rotation(rotation),
 	_constant_accel_count(0),
@@ -693,8 +698,8 @@ LSM303D::init()
 	_accel_reports->get(&arp);
 
 	/* measurement will have generated a report, publish */
-	_accel_topic = orb_advertise_multi(ORB_ID(sensor_accel), &arp,
-		&_accel_orb_class_instance, (is_external()) ? ORB_PRIO_VERY_HIGH : ORB_PRIO_DEFAULT);
+	_accel_topic = orb_advertise_multi_queue(ORB_ID(sensor_accel), &arp,
+		&_accel_orb_class_instance, (is_external()) ? ORB_PRIO_VERY_HIGH : ORB_PRIO_DEFAULT, SENSOR_ORB_QUEUE_SIZE);
 
 	if (_accel_topic == nullptr) {
 		warnx("ADVERT ERR");
@@ -884,7 +889,7 @@ LSM303D::ioctl(struct file *filp, int cmd, unsigned long arg)
 					return -EINVAL;
 
 				/* adjust filters */
-				accel_set_driver_lowpass_filter((float)arg, _accel_filter_x.get_cutoff_freq());
+				accel_set_driver_lowpass_filter((float)arg, _accel_filter.get_cutoff_freq());
 
 				/* update interval for next measurement */
 				/* XXX this is a bit shady, but no other way to adjust... */
@@ -940,7 +945,7 @@ LSM303D::ioctl(struct file *filp, int cmd, unsigned long arg)
 	}
 
 	case ACCELIOCGLOWPASS:
-		return static_cast<int>(_accel_filter_x.get_cutoff_freq());
+		return static_cast<int>(_accel_filter.get_cutoff_freq());
 
 	case ACCELIOCSSCALE: {
 		/* copy scale, but only if off by a few percent */
@@ -948,6 +953,7 @@ LSM303D::ioctl(struct file *filp, int cmd, unsigned long arg)
 		float sum = s->x_scale + s->y_scale + s->z_scale;
 		if (sum > 2.0f && sum < 4.0f) {
 			memcpy(&_accel_scale, s, sizeof(_accel_scale));
+			update_correction();
 			return OK;
 		} else {
 			return -EINVAL;
@@ -1070,6 +1076,7 @@ LSM303D::mag_ioctl(struct file *filp, int cmd, unsigned long arg)
 	case MAGIOCSSCALE:
 		/* copy scale in */
 		memcpy(&_mag_scale, (struct mag_scale *) arg, sizeof(_mag_scale));
+		update_correction();
 		return OK;
 
 	case MAGIOCGSCALE:
@@ -1232,7 +1239,7 @@ LSM303D::accel_set_range(unsigned max_g)
 	}
 
 	_accel_range_scale = new_scale_g_digit * LSM303D_ONE_G;
-
+	update_correction();
 
 	modify_reg(ADDR_CTRL_REG2, clearbits, setbits);
 
@@ -1274,12 +1281,20 @@ LSM303D::mag_set_range(unsigned max_ga)
 	}
 
 	_mag_range_scale = new_scale_ga_digit;
+	update_correction();
 
 	modify_reg(ADDR_CTRL_REG6, clearbits, setbits);
 
 	return OK;
 }
 
+void
+LSM303D::update_correction()
+{
+	_accel_correction.set(_rotation, _accel_range_scale, _accel_scale);
+	_mag_correction.set(_rotation, _mag_range_scale, _mag_scale);
+}
+
 int
 LSM303D::accel_set_onchip_lowpass_filter_bandwidth(unsigned bandwidth)
 {
@@ -1317,9 +1332,7 @@ LSM303D::accel_set_onchip_lowpass_filter_bandwidth(unsigned bandwidth)
 int
 LSM303D::accel_set_driver_lowpass_filter(float samplerate, float bandwidth)
 {
-	_accel_filter_x.set_cutoff_frequency(samplerate, bandwidth);
-	_accel_filter_y.set_cutoff_frequency(samplerate, bandwidth);
-	_accel_filter_z.set_cutoff_frequency(samplerate, bandwidth);
+	_accel_filter.set_cutoff_frequency(samplerate, bandwidth);
 
 	return OK;
 }
@@ -1404,18 +1417,18 @@ LSM303D::start()
 	_mag_reports->flush();
 
 	/* start polling at the specified rate */
-	hrt_call_every(&_accel_call,
+	bus_call_every(&_accel_call,
                        1000,
                        _call_accel_interval - LSM303D_TIMER_REDUCTION,
                        (hrt_callout)&LSM303D::measure_trampoline, this);
-	hrt_call_every(&_mag_call, 1000, _call_mag_interval, (hrt_callout)&LSM303D::mag_measure_trampoline, this);
+	bus_call_every(&_mag_call, 1000, _call_mag_interval, (hrt_callout)&LSM303D::mag_measure_trampoline, this);
 }
 
 void
 LSM303D::stop()
 {
-	hrt_cancel(&_accel_call);
-	hrt_cancel(&_mag_call);
+	bus_cancel(&_accel_call);
+	bus_cancel(&_mag_call);
 
 	/* reset internal states */
 	memset(_last_accel, 0, sizeof(_last_accel));
@@ -1542,16 +1555,13 @@ LSM303D::measure()
 	accel_report.y_raw = raw_accel_report.y;
 	accel_report.z_raw = raw_accel_report.z;
 
-	float xraw_f = raw_accel_report.x;
-	float yraw_f = raw_accel_report.y;
-	float zraw_f = raw_accel_report.z;
+	// apply user specified rotation, range scale and calibration in one step
+	float accel_in[3];
+	_accel_correction.apply(raw_accel_report.x, raw_accel_report.y, raw_accel_report.z, accel_in);
 
-	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
-
-	float x_in_new = ((xraw_f * _accel_range_scale) - _accel_scale.x_offset) * _accel_scale.x_scale;
-	float y_in_new = ((yraw_f * _accel_range_scale) - _accel_scale.y_offset) * _accel_scale.y_scale;
-	float z_in_new = ((zraw_f * _accel_range_scale) - _accel_scale.z_offset) * _accel_scale.z_scale;
+	float x_in_new = accel_in[0];
+	float y_in_new = accel_in[1];
+	float z_in_new = accel_in[2];
 
 	/*
 	  we have logs where the accelerometers get stuck at a fixed
@@ -1583,9 +1593,11 @@ LSM303D::measure()
 	_last_accel[1] = y_in_new;
 	_last_accel[2] = z_in_new;
 
-	accel_report.x = _accel_filter_x.apply(x_in_new);
-	accel_report.y = _accel_filter_y.apply(y_in_new);
-	accel_report.z = _accel_filter_z.apply(z_in_new);
+	float accel_filtered[3] = {x_in_new, y_in_new, z_in_new};
+	_accel_filter.apply(accel_filtered);
+	accel_report.x = accel_filtered[0];
+	accel_report.y = accel_filtered[1];
+	accel_report.z = accel_filtered[2];
 
 	math::Vector<3> aval(x_in_new, y_in_new, z_in_new);
 	math::Vector<3> aval_integrated;
@@ -1664,16 +1676,13 @@ LSM303D::mag_measure()
 	mag_report.y_raw = raw_mag_report.y;
 	mag_report.z_raw = raw_mag_report.z;
 
-	float xraw_f = mag_report.x_raw;
-	float yraw_f = mag_report.y_raw;
-	float zraw_f = mag_report.z_raw;
-
-	/* apply user specified rotation */
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	/* apply user specified rotation, range scale and calibration in one step */
+	float mag_in[3];
+	_mag_correction.apply(mag_report.x_raw, mag_report.y_raw, mag_report.z_raw, mag_in);
 
-	mag_report.x = ((xraw_f * _mag_range_scale) - _mag_scale.x_offset) * _mag_scale.x_scale;
-	mag_report.y = ((yraw_f * _mag_range_scale) - _mag_scale.y_offset) * _mag_scale.y_scale;
-	mag_report.z = ((zraw_f * _mag_range_scale) - _mag_scale.z_offset) * _mag_scale.z_scale;
+	mag_report.x = mag_in[0];
+	mag_report.y = mag_in[1];
+	mag_report.z = mag_in[2];
 	mag_report.scaling = _mag_range_scale;
 	mag_report.range_ga = (float)_mag_range_ga;
 	mag_report.error_count = perf_event_count(_bad_registers) + perf_event_count(_bad_values);
@@ -67,6 +67,7 @@
 #include <drivers/drv_hrt.h>
 #include <drivers/drv_range_finder.h>
 #include <drivers/device/ringbuffer.h>
+#include <drivers/device/rangefinder_rate.h>
 
 #include <uORB/uORB.h>
 #include <uORB/topics/subsystem_info.h>
@@ -129,6 +130,7 @@ private:
 	ringbuffer::RingBuffer	*_reports;
 	bool				_sensor_ok;
 	int					_measure_ticks;
+	device::RangefinderRate		_rate;
 	bool				_collect_phase;
 	int				_class_instance;
 	int				_orb_class_instance;
@@ -145,6 +147,12 @@ private:
 	std::vector<uint8_t>	addr_ind; 	/* temp sonar i2c address vector */
 	std::vector<float>	_latest_sonar_measurements; /* vector to store latest sonar measurements in before writing to report */
 
+	/* queued transfers of the automatic measurement cycle */
+	async_transfer		_measure_xfer;
+	async_transfer		_collect_xfer;
+	uint8_t			_measure_cmd;
+	uint8_t			_collect_buf[2];
+
 
 	/**
 	* Test whether the device supported by the driver is present at a
@@ -185,6 +193,20 @@ private:
 	void				cycle();
 	int					measure();
 	int					collect();
+
+	/**
+	* Publish a range read from the sensor.
+	*
+	* @param val		Raw range register contents.
+	*/
+	void				report_distance(const uint8_t val[2]);
+
+	/**
+	* Completion callbacks of the queued measure and collect transfers,
+	* called from the I2C bus worker.
+	*/
+	static void			measure_callback(void *arg, int result);
+	static void			collect_callback(void *arg, int result);
 	/**
 	* Static trampoline from the workq context; because we don't have a
 	* generic workq wrapper yet.
@@ -208,6 +230,7 @@ MB12XX::MB12XX(int bus, int address) :
 	_reports(nullptr),
 	_sensor_ok(false),
 	_measure_ticks(0),
+	_rate(USEC2TICK(RANGEFINDER_IDLE_INTERVAL)),
 	_collect_phase(false),
 	_class_instance(-1),
 	_orb_class_instance(-1),
@@ -217,7 +240,11 @@ MB12XX::MB12XX(int bus, int address) :
 	_buffer_overflows(perf_alloc(PC_COUNT, "mb12xx_buffer_overflows")),
 	_cycle_counter(0),	/* initialising counter for cycling function to zero */
 	_cycling_rate(0),	/* initialising cycling rate (which can differ depending on one sonar or multiple) */
-	_index_counter(0) 	/* initialising temp sonar i2c address to zero */
+	_index_counter(0), 	/* initialising temp sonar i2c address to zero */
+	_measure_xfer{},
+	_collect_xfer{},
+	_measure_cmd(MB12XX_TAKE_RANGE_REG),
+	_collect_buf{}
 
 {
 	/* enable debug() calls */
@@ -573,6 +600,15 @@ MB12XX::collect()
 		return ret;
 	}
 
+	report_distance(val);
+
+	perf_end(_sample_perf);
+	return OK;
+}
+
+void
+MB12XX::report_distance(const uint8_t val[2])
+{
 	uint16_t distance_cm = val[0] << 8 | val[1];
 	float distance_m = float(distance_cm) * 1e-2f;
 
@@ -598,11 +634,29 @@ MB12XX::collect()
 
 	/* notify anyone waiting for data */
 	poll_notify(POLLIN);
+}
 
-	ret = OK;
+void
+MB12XX::measure_callback(void *arg, int result)
+{
+	MB12XX *dev = (MB12XX *)arg;
 
-	perf_end(_sample_perf);
-	return ret;
+	if (result != OK) {
+		perf_count(dev->_comms_errors);
+	}
+}
+
+void
+MB12XX::collect_callback(void *arg, int result)
+{
+	MB12XX *dev = (MB12XX *)arg;
+
+	if (result != OK) {
+		perf_count(dev->_comms_errors);
+		return;
+	}
+
+	dev->report_distance(dev->_collect_buf);
 }
 
 void
@@ -617,12 +671,11 @@ MB12XX::start()
 	work_queue(HPWORK, &_work, (worker_t)&MB12XX::cycle_trampoline, this, 5);
 
 	/* notify about state change */
-	struct subsystem_info_s info = {
-		true,
-		true,
-		true,
-		subsystem_info_s::SUBSYSTEM_TYPE_RANGEFINDER
-	};
+	struct subsystem_info_s info = {};
+	info.present = true;
+	info.enabled = true;
+	info.ok = true;
+	info.subsystem_type = subsystem_info_s::SUBSYSTEM_TYPE_RANGEFINDER;
 	static orb_advert_t pub = nullptr;
 
 	if (pub != nullptr) {
@@ -639,6 +692,10 @@ void
 MB12XX::stop()
 {
 	work_cancel(HPWORK, &_work);
+
+	/* wait for queued transfers, their callbacks use this instance */
+	cancel_async(&_measure_xfer);
+	cancel_async(&_collect_xfer);
 }
 
 void
@@ -658,12 +715,15 @@ MB12XX::cycle()
 		_index_counter = addr_ind[_cycle_counter]; /*sonar from previous iteration collect is now read out */
 		set_address(_index_counter);
 
-		/* perform collection */
-		if (OK != collect()) {
-			DEVICE_DEBUG("collection error");
-			/* if error restart the measurement state machine */
-			start();
-			return;
+		/*
+		 * Queue the collection, the bus worker publishes the range.
+		 * A sensor that does not answer now only holds up the bus
+		 * worker, not the work queue.
+		 */
+		if (OK != transfer_async(&_collect_xfer, nullptr, 0, &_collect_buf[0], 2,
+					 &MB12XX::collect_callback, this)) {
+			/* the previous collection is still running */
+			perf_count(_comms_errors);
 		}
 
 		/* next phase is measurement */
@@ -679,14 +739,17 @@ MB12XX::cycle()
 		/* Is there a collect->measure gap? Yes, and the timing is set equal to the cycling_rate
 		   Otherwise the next sonar would fire without the first one having received its reflected sonar pulse */
 
-		if (_measure_ticks > USEC2TICK(_cycling_rate)) {
+		/* slower while idle */
+		unsigned ticks = _rate.interval(_measure_ticks, is_open());
+
+		if (ticks > USEC2TICK(_cycling_rate)) {
 
 			/* schedule a fresh cycle call when we are ready to measure again */
 			work_queue(HPWORK,
 				   &_work,
 				   (worker_t)&MB12XX::cycle_trampoline,
 				   this,
-				   _measure_ticks - USEC2TICK(_cycling_rate));
+				   ticks - USEC2TICK(_cycling_rate));
 			return;
 		}
 	}
@@ -698,8 +761,10 @@ MB12XX::cycle()
 	set_address(_index_counter);
 
 	/* Perform measurement */
-	if (OK != measure()) {
+	if (OK != transfer_async(&_measure_xfer, &_measure_cmd, 1, nullptr, 0,
+				 &MB12XX::measure_callback, this)) {
 		DEVICE_DEBUG("measure error sonar adress %d", _index_counter);
+		perf_count(_comms_errors);
 	}
 
 	/* next phase is collection */
@@ -720,7 +785,7 @@ MB12XX::print_info()
 	perf_print_counter(_sample_perf);
 	perf_print_counter(_comms_errors);
 	perf_print_counter(_buffer_overflows);
-	printf("poll interval:  %u ticks\n", _measure_ticks);
+	printf("poll interval:  %u ticks%s\n", _measure_ticks, _rate.idle() ? " (idle)" : "");
 	_reports->print_info("report queue");
 }
 
@@ -97,7 +97,9 @@ MD25::MD25(const char *deviceName, int bus,
 	_motor2Current(0),
 	_motorAccel(0),
 	_mode(MODE_UNSIGNED_SPEED),
-	_command(CMD_RESET_ENCODERS)
+	_command(CMD_RESET_ENCODERS),
+	_readInterval(0),
+	_lastRead(0)
 {
 	// setup control polling
 	_controlPoll.fd = _actuators.getHandle();
@@ -112,8 +114,7 @@ MD25::MD25(const char *deviceName, int bus,
 	}
 
 	// setup default settings, reset encoders
-	setMotor1Speed(0);
-	setMotor2Speed(0);
+	setMotorSpeeds(0, 0);
 	resetEncoders();
 	_setMode(MD25::MODE_UNSIGNED_SPEED);
 	setSpeedRegulation(false);
@@ -327,6 +328,23 @@ int MD25::setMotor2Speed(float value)
 			   _normToUint8(value));
 }
 
+int MD25::setMotorSpeeds(float value1, float value2)
+{
+	// the speed registers are adjacent, the
+	// register address increments after each byte
+	uint8_t sendBuf[3];
+	sendBuf[0] = REG_SPEED1_RW;
+	sendBuf[1] = _normToUint8(value1);
+	sendBuf[2] = _normToUint8(value2);
+	return transfer(sendBuf, sizeof(sendBuf),
+			nullptr, 0);
+}
+
+void MD25::setReadInterval(unsigned interval_ms)
+{
+	_readInterval = interval_ms * 1000ULL;
+}
+
 void MD25::update()
 {
 	// wait for an actuator publication,
@@ -338,8 +356,17 @@ void MD25::update()
 	// if new data, send to motors
 	if (_actuators.updated()) {
 		_actuators.update();
-		setMotor1Speed(_actuators.control[CH_SPEED_LEFT]);
-		setMotor2Speed(_actuators.control[CH_SPEED_RIGHT]);
+		setMotorSpeeds(_actuators.control[CH_SPEED_LEFT],
+			       _actuators.control[CH_SPEED_RIGHT]);
+	}
+
+	// refresh the readings at the read interval instead of every cycle,
+	// readData() gets all registers in one transfer
+	hrt_abstime now = hrt_absolute_time();
+
+	if (_readInterval > 0 && now - _lastRead >= _readInterval) {
+		_lastRead = now;
+		readData();
 	}
 }
 
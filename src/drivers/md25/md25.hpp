@@ -239,9 +239,25 @@ public:
 	 */
 	int setMotor2Speed(float normSpeed);
 
+	/**
+	 * set the speed of both motors in one transfer
+	 * @param normSpeed1 normalize speed of motor 1 between -1 and 1
+	 * @param normSpeed2 normalize speed of motor 2 between -1 and 1
+	 * @return non-zero -> error
+	 */
+	int setMotorSpeeds(float normSpeed1, float normSpeed2);
+
+	/**
+	 * set the interval at which update() refreshes
+	 * the encoder and status readings, 0 disables it
+	 * @param interval_ms interval, ms
+	 */
+	void setReadInterval(unsigned interval_ms);
+
 	/**
 	 * main update loop that updates MD25 motor
-	 * speeds based on actuator publication
+	 * speeds based on actuator publication,
+	 * and the readings at the read interval
 	 */
 	void update();
 
@@ -285,6 +301,10 @@ private:
 	e_mode _mode;
 	e_cmd _command;
 
+	// readings cache
+	uint64_t _readInterval;
+	uint64_t _lastRead;
+
 	// private methods
 	int _writeUint8(uint8_t reg, uint8_t value);
 	int _writeInt8(uint8_t reg, int8_t value);
@@ -282,7 +282,7 @@ int md25_thread_main(int argc, char *argv[])
 
 	if (argc < 5) {
 		// extra md25 in arg list since this is a thread
-		printf("usage: md25 start bus address\n");
+		printf("usage: md25 start bus address [read_interval_ms]\n");
 		exit(0);
 	}
 
@@ -292,8 +292,15 @@ int md25_thread_main(int argc, char *argv[])
 
 	uint8_t address = strtoul(argv[4], nullptr, 0);
 
+	unsigned readInterval = 100;
+
+	if (argc > 5) {
+		readInterval = strtoul(argv[5], nullptr, 0);
+	}
+
 	// start
 	MD25 md25(deviceName, bus, address);
+	md25.setReadInterval(readInterval);
 
 	thread_running = true;
 
@@ -94,6 +94,7 @@
 #define MOTOR_SPINUP_COUNTER			30
 #define MOTOR_LOCATE_DELAY				10000000
 #define ESC_UORB_PUBLISH_DELAY			500000
+#define MOTOR_TELEMETRY_INTERVAL		2
 
 #define CONTROL_INPUT_DROP_LIMIT_MS		20
 #define RC_MIN_VALUE					1010
@@ -176,6 +177,22 @@ private:
 	actuator_controls_s 	_controls;
 	MotorData_t 			Motor[MAX_MOTORS];
 
+	/* the queued command of a motor, with the buffers the bus worker uses */
+	struct MotorTransfer_t {
+		async_transfer		xfer;
+		MK			*mk;
+		unsigned		chan;
+		bool			telemetry;
+		uint8_t			msg[2];
+		uint8_t			result[3];
+	};
+
+	MotorTransfer_t			_motor_xfer[MAX_MOTORS];
+	unsigned				_telemetry_motor;
+	unsigned				_telemetry_next;
+	unsigned				_telemetry_cycle;
+	unsigned				_xfer_skipped;
+
 	static void				task_main_trampoline(int argc, char *argv[]);
 	void					task_main();
 
@@ -187,6 +204,8 @@ private:
 	int						pwm_ioctl(file *filp, int cmd, unsigned long arg);
 	int						mk_servo_arm(bool status);
 	int 					mk_servo_set(unsigned int chan, short val);
+	static void				mk_servo_callback(void *arg, int result);
+	void					mk_servo_telemetry_next();
 	int 					mk_servo_test(unsigned int chan);
 	int 					mk_servo_locate();
 	short					scaling(float val, float inMin, float inMax, float outMin, float outMax);
@@ -236,7 +255,12 @@ MK::MK(int bus, const char *_device_path) :
 	_mixers(nullptr),
 	_indicate_esc(false),
 	_rc_min_value(RC_MIN_VALUE),
-	_rc_max_value(RC_MAX_VALUE)
+	_rc_max_value(RC_MAX_VALUE),
+	_motor_xfer{},
+	_telemetry_motor(MAX_MOTORS),
+	_telemetry_next(0),
+	_telemetry_cycle(0),
+	_xfer_skipped(0)
 {
 	strncpy(_device, _device_path, sizeof(_device));
 	/* enforce null termination */
@@ -535,6 +559,8 @@ MK::task_main()
 				/* can we mix? */
 				if (_mixers != nullptr) {
 
+					mk_servo_telemetry_next();
+
 					/* do mixing */
 					outputs.noutputs = _mixers->mix(&outputs.output[0], _num_outputs, NULL);
 					outputs.timestamp = hrt_absolute_time();
@@ -641,6 +667,11 @@ MK::task_main()
 
 	}
 
+	/* the bus worker must be done with the buffers of the queued commands */
+	for (unsigned i = 0; i < MAX_MOTORS; i++) {
+		cancel_async(&_motor_xfer[i].xfer);
+	}
+
 	::close(_t_actuators);
 	::close(_t_actuator_armed);
 
@@ -738,9 +769,7 @@ MK::mk_servo_set(unsigned int chan, short val)
 {
 	short tmpVal = 0;
 	_retries = 0;
-	uint8_t result[3] = { 0, 0, 0 };
-	uint8_t msg[2] = { 0, 0 };
-	uint8_t bytesToSendBL2 = 2;
+	MotorTransfer_t *t = &_motor_xfer[chan];
 
 	tmpVal = val;
 
@@ -759,67 +788,60 @@ MK::mk_servo_set(unsigned int chan, short val)
 		Motor[chan].SetPointLowerBits = 0;
 	}
 
-	//if(Motor[chan].State & MOTOR_STATE_PRESENT_MASK) {
-	set_address(BLCTRL_BASE_ADDR + (chan + addrTranslator[chan]));
+	if (t->xfer.pending) {
+		/*
+		 * The previous command of this motor is still queued, the
+		 * bus is saturated. Its buffers are in use, so skip this one,
+		 * the next cycle sends the then current setpoint.
+		 */
+		_xfer_skipped++;
+		return 0;
+	}
+
+	t->mk = this;
+	t->chan = chan;
+	t->msg[0] = Motor[chan].SetPoint;
+	t->msg[1] = Motor[chan].SetPointLowerBits;
+	t->telemetry = (chan == _telemetry_motor);
+
+	unsigned bytesToSend = 1;
+	unsigned bytesToRead = 0;
 
 	if (Motor[chan].Version == BLCTRL_OLD) {
 		/*
 		*	Old BL-Ctrl 8Bit served. Version < 2.0
 		*/
-		msg[0] = Motor[chan].SetPoint;
-
-		if (Motor[chan].RoundCount >= 16) {
-			// on each 16th cyle we read out the status messages from the blctrl
-			if (OK == transfer(&msg[0], 1, &result[0], 2)) {
-				Motor[chan].Current = result[0];
-				Motor[chan].MaxPWM = result[1];
-				Motor[chan].Temperature = 255;;
-
-			} else {
-				if ((Motor[chan].State & MOTOR_STATE_ERROR_MASK) < MOTOR_STATE_ERROR_MASK) Motor[chan].State++;	// error
-			}
-
-			Motor[chan].RoundCount = 0;
-
-		} else {
-			if (OK != transfer(&msg[0], 1, nullptr, 0)) {
-				if ((Motor[chan].State & MOTOR_STATE_ERROR_MASK) < MOTOR_STATE_ERROR_MASK) Motor[chan].State++;	// error
-			}
+		if (t->telemetry) {
+			bytesToRead = 2;
 		}
 
 	} else {
 		/*
 		*	New BL-Ctrl 11Bit served. Version >= 2.0
+		*	if setpoint lower bits are zero, we send only the higher bits - this saves time
 		*/
-		msg[0] = Motor[chan].SetPoint;
-		msg[1] = Motor[chan].SetPointLowerBits;
-
-		if (Motor[chan].SetPointLowerBits == 0) {
-			bytesToSendBL2 = 1;	// if setpoint lower bits are zero, we send only the higher bits - this saves time
+		if (Motor[chan].SetPointLowerBits != 0) {
+			bytesToSend = 2;
 		}
 
-		if (Motor[chan].RoundCount >= 16) {
-			// on each 16th cyle we read out the status messages from the blctrl
-			if (OK == transfer(&msg[0], bytesToSendBL2, &result[0], 3)) {
-				Motor[chan].Current = result[0];
-				Motor[chan].MaxPWM = result[1];
-				Motor[chan].Temperature = result[2];
-
-			} else {
-				if ((Motor[chan].State & MOTOR_STATE_ERROR_MASK) < MOTOR_STATE_ERROR_MASK) Motor[chan].State++;	// error
-			}
-
-			Motor[chan].RoundCount = 0;
-
-		} else {
-			if (OK != transfer(&msg[0], bytesToSendBL2, nullptr, 0)) {
-				if ((Motor[chan].State & MOTOR_STATE_ERROR_MASK) < MOTOR_STATE_ERROR_MASK) Motor[chan].State++;	// error
-			}
+		if (t->telemetry) {
+			bytesToRead = 3;
 		}
+	}
 
+	//if(Motor[chan].State & MOTOR_STATE_PRESENT_MASK) {
+	set_address(BLCTRL_BASE_ADDR + (chan + addrTranslator[chan]));
+
+	/*
+	 * Queue the command behind the ones of the other motors, the bus
+	 * worker sends them back to back while this task mixes the next
+	 * cycle, and the callback collects the telemetry.
+	 */
+	if (OK != transfer_async(&t->xfer, &t->msg[0], bytesToSend, &t->result[0], bytesToRead,
+				 &MK::mk_servo_callback, t)) {
+		_xfer_skipped++;
 	}
 
-	Motor[chan].RoundCount++;
 	//}
 
 	if (showDebug == true) {
@@ -834,6 +856,7 @@ MK::mk_servo_set(unsigned int chan, short val)
 				}
 			}
 
+			fprintf(stderr, "[mkblctrl] skipped commands: %u\n", _xfer_skipped);
 			fprintf(stderr, "\n");
 		}
 	}
@@ -842,6 +865,47 @@ MK::mk_servo_set(unsigned int chan, short val)
 }
 
 
+void
+MK::mk_servo_callback(void *arg, int result)
+{
+	MotorTransfer_t *t = (MotorTransfer_t *)arg;
+	MotorData_t *m = &t->mk->Motor[t->chan];
+
+	if (result != OK) {
+		if ((m->State & MOTOR_STATE_ERROR_MASK) < MOTOR_STATE_ERROR_MASK) m->State++;	// error
+
+		return;
+	}
+
+	if (t->telemetry) {
+		m->Current = t->result[0];
+		m->MaxPWM = t->result[1];
+		m->Temperature = (m->Version == BLCTRL_OLD) ? 255 : t->result[2];
+	}
+}
+
+void
+MK::mk_servo_telemetry_next()
+{
+	/*
+	 * Read the status of one motor every MOTOR_TELEMETRY_INTERVAL cycles, in turn,
+	 * so no cycle carries the reads of all motors.
+	 */
+	if (++_telemetry_cycle < MOTOR_TELEMETRY_INTERVAL) {
+		_telemetry_motor = MAX_MOTORS;
+		return;
+	}
+
+	_telemetry_cycle = 0;
+
+	if (++_telemetry_next >= _num_outputs) {
+		_telemetry_next = 0;
+	}
+
+	_telemetry_motor = _telemetry_next;
+}
+
+
 int
 MK::mk_servo_test(unsigned int chan)
 {
@@ -70,10 +70,12 @@
 
 #include <drivers/device/spi.h>
 #include <drivers/device/ringbuffer.h>
+#include <drivers/device/integrator.h>
 #include <drivers/drv_accel.h>
 #include <drivers/drv_gyro.h>
-#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/BiquadFilterBank.hpp>
 #include <lib/conversion/rotation.h>
+#include <lib/conversion/sensor_correction.h>
 
 #define DIR_READ			0x80
 #define DIR_WRITE			0x00
@@ -170,14 +172,22 @@
 
 #define BIT_RAW_RDY_EN			0x01
 #define BIT_INT_ANYRD_2CLEAR		0x10
+#define BIT_FIFO_EN			0x40
+#define BIT_FIFO_RESET			0x04
+#define BITS_FIFO_ENABLE_TEMP		0x80
+#define BITS_FIFO_ENABLE_GYRO		0x70
+#define BITS_FIFO_ENABLE_ACCEL		0x08
 
 #define MPU_WHOAMI_9250			0x71
 
 #define MPU9250_DEFAULT_ONCHIP_FILTER_FREQ	41
 #define MPU9250_ACCEL_DEFAULT_RATE	1000
 #define MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ 30
+#define MPU9250_ACCEL_MAX_OUTPUT_RATE	280
 #define MPU9250_GYRO_DEFAULT_RATE	1000
 #define MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ 30
+/* rates need to be the same between accel and gyro */
+#define MPU9250_GYRO_MAX_OUTPUT_RATE	MPU9250_ACCEL_MAX_OUTPUT_RATE
 
 #define MPU9250_ONE_G					9.80665f
 
@@ -196,12 +206,19 @@
 #define MPU9250_HIGH_BUS_SPEED				11*1000*1000
 
 /*
-  we set the timer interrupt to run a bit faster than the desired
-  sample rate and then throw away duplicates by comparing
-  accelerometer values. This time reduction is enough to cope with
-  worst case timing jitter due to other timers
+  when polling automatically the samples are collected in the sensor
+  FIFO and drained in one burst per timer call. Each FIFO entry holds
+  accel, temperature and gyro in the register order, 14 bytes. The
+  burst buffer holds enough samples for a few late timer calls at the
+  maximum sample rate, the FIFO itself holds 512 bytes.
  */
-#define MPU9250_TIMER_REDUCTION				200
+#define MPU9250_FIFO_DRAIN_INTERVAL			4000
+#define MPU9250_FIFO_SAMPLE_SIZE			14
+#define MPU9250_FIFO_MAX_SAMPLES			16
+#define MPU9250_FIFO_SIZE				512
+
+/* deep enough to hold all samples of one FIFO burst */
+#define MPU9250_REPORT_QUEUE_DEPTH			8
 
 class MPU9250_gyro;
 
@@ -238,7 +255,7 @@ private:
 	MPU9250_gyro		*_gyro;
 	uint8_t			_whoami;	/** whoami result */
 
-	struct hrt_call		_call;
+	struct bus_call		_call;
 	unsigned		_call_interval;
 
 	ringbuffer::RingBuffer	*_accel_reports;
@@ -273,19 +290,21 @@ private:
 	uint8_t			_register_wait;
 	uint64_t		_reset_wait;
 
-	math::LowPassFilter2p	_accel_filter_x;
-	math::LowPassFilter2p	_accel_filter_y;
-	math::LowPassFilter2p	_accel_filter_z;
-	math::LowPassFilter2p	_gyro_filter_x;
-	math::LowPassFilter2p	_gyro_filter_y;
-	math::LowPassFilter2p	_gyro_filter_z;
+	math::BiquadFilterBank<3>	_accel_filter;
+	math::BiquadFilterBank<3>	_gyro_filter;
+
+	Integrator		_accel_int;
+	Integrator		_gyro_int;
 
 	enum Rotation		_rotation;
 
+	SensorCorrection	_accel_correction;
+	SensorCorrection	_gyro_correction;
+
 	// this is used to support runtime checking of key
 	// configuration registers to detect SPI bus errors and sensor
 	// reset
-#define MPU9250_NUM_CHECKED_REGISTERS 11
+#define MPU9250_NUM_CHECKED_REGISTERS 12
 	static const uint8_t	_checked_registers[MPU9250_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_values[MPU9250_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_bad[MPU9250_NUM_CHECKED_REGISTERS];
@@ -298,6 +317,10 @@ private:
 	uint16_t		_last_accel[3];
 	bool			_got_duplicate;
 
+	// command byte followed by one burst of FIFO samples
+	uint8_t			_fifo_buffer[1 + MPU9250_FIFO_MAX_SAMPLES * MPU9250_FIFO_SAMPLE_SIZE];
+	perf_counter_t		_fifo_resets;
+
 	/**
 	 * Start automatic measurement.
 	 */
@@ -331,6 +354,16 @@ private:
 	 */
 	void			measure();
 
+	/**
+	 * Drain the sensor FIFO in one burst and process every sample in it.
+	 */
+	void			measure_fifo();
+
+	/**
+	 * Discard the FIFO contents and restart collecting samples.
+	 */
+	void			reset_fifo();
+
 	/**
 	 * Read a register from the MPU9250
 	 *
@@ -338,7 +371,7 @@ private:
 	 * @return		The value that was read.
 	 */
 	uint8_t			read_reg(unsigned reg, uint32_t speed=MPU9250_LOW_BUS_SPEED);
-	uint16_t		read_reg16(unsigned reg);
+	uint16_t		read_reg16(unsigned reg, uint32_t speed=MPU9250_LOW_BUS_SPEED);
 
 	/**
 	 * Write a register in the MPU9250
@@ -375,6 +408,11 @@ private:
 	 */
 	int			set_accel_range(unsigned max_g);
 
+	/**
+	 * Fold rotation, range scale and calibration into the corrections, after any of them changed.
+	 */
+	void			update_correction();
+
 	/**
 	 * Swap a 16-bit value read from the MPU9250 to native byte order.
 	 */
@@ -444,6 +482,35 @@ private:
 		uint8_t		gyro_z[2];
 	};
 #pragma pack(pop)
+
+	/**
+	 * One sample converted to native byte order.
+	 */
+	struct Report {
+		int16_t		accel_x;
+		int16_t		accel_y;
+		int16_t		accel_z;
+		int16_t		temp;
+		int16_t		gyro_x;
+		int16_t		gyro_y;
+		int16_t		gyro_z;
+	};
+
+	/**
+	 * Convert one raw sample in sensor register order.
+	 *
+	 * @return		false if the sample is all zero, which points to a bus error
+	 */
+	bool			convert_sample(uint8_t *data, struct Report &report);
+
+	/**
+	 * Scale, filter and integrate one sample, queue the reports and
+	 * publish them when the integrators complete an interval.
+	 *
+	 * @param report	The converted sample.
+	 * @param timestamp	The time the sample was taken.
+	 */
+	void			process_sample(struct Report &report, hrt_abstime timestamp);
 };
 
 /*
@@ -460,7 +527,8 @@ const uint8_t MPU9250::_checked_registers[MPU9250_NUM_CHECKED_REGISTERS] = { MPU
 									     MPUREG_ACCEL_CONFIG,
 									     MPUREG_ACCEL_CONFIG2,
 									     MPUREG_INT_ENABLE,
-									     MPUREG_INT_PIN_CFG };
+									     MPUREG_INT_PIN_CFG,
+									     MPUREG_FIFO_EN };
 
 
 
@@ -525,20 +593,20 @@ MPU9250::MPU9250(int bus, const char *path_accel, const char *path_gyro, spi_dev
 	_reset_retries(perf_alloc(PC_COUNT, "mpu9250_reset_retries")),
 	_duplicates(perf_alloc(PC_COUNT, "mpu9250_duplicates")),
 	_system_latency_perf(perf_alloc_once(PC_ELAPSED, "sys_latency")),
-	_controller_latency_perf(perf_alloc_once(PC_ELAPSED, "ctrl_latency")),
+	_controller_latency_perf(perf_alloc_once(PC_HISTOGRAM, "ctrl_latency")),
 	_register_wait(0),
 	_reset_wait(0),
-	_accel_filter_x(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_y(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_z(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_x(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_y(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_z(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
+	_accel_filter(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
+	_gyro_filter(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
+	_accel_int(1000000 / MPU9250_ACCEL_MAX_OUTPUT_RATE),
+	_gyro_int(1000000 / MPU9250_GYRO_MAX_OUTPUT_RATE, true),
 	_rotation(rotation),
 	_checked_next(0),
 	_last_temperature(0),
 	_last_accel{},
-	_got_duplicate(false)
+	_got_duplicate(false),
+	_fifo_buffer{},
+	_fifo_resets(perf_alloc(PC_COUNT, "mpu9250_fifo_resets"))
 {
 	// disable debug() calls
 	_debug_enabled = false;
@@ -594,6 +662,7 @@ MPU9250::~MPU9250()
 	perf_free(_good_transfers);
 	perf_free(_reset_retries);
 	perf_free(_duplicates);
+	perf_free(_fifo_resets);
 }
 
 int
@@ -611,11 +680,11 @@ MPU9250::init()
 	}
 
 	/* allocate basic report buffers */
-	_accel_reports = new ringbuffer::RingBuffer(2, sizeof(accel_report));
+	_accel_reports = new ringbuffer::RingBuffer(MPU9250_REPORT_QUEUE_DEPTH, sizeof(accel_report));
 	if (_accel_reports == nullptr)
 		goto out;
 
-	_gyro_reports = new ringbuffer::RingBuffer(2, sizeof(gyro_report));
+	_gyro_reports = new ringbuffer::RingBuffer(MPU9250_REPORT_QUEUE_DEPTH, sizeof(gyro_report));
 	if (_gyro_reports == nullptr)
 		goto out;
 
@@ -637,6 +706,7 @@ MPU9250::init()
 	_gyro_scale.z_offset = 0;
 	_gyro_scale.z_scale  = 1.0f;
 
+	update_correction();
 
 	/* do CDev init for the gyro device node, keep it optional */
 	ret = _gyro->init();
@@ -655,8 +725,8 @@ MPU9250::init()
 	_accel_reports->get(&arp);
 
 	/* measurement will have generated a report, publish */
-	_accel_topic = orb_advertise_multi(ORB_ID(sensor_accel), &arp,
-		&_accel_orb_class_instance, (is_external()) ? ORB_PRIO_MAX : ORB_PRIO_HIGH);
+	_accel_topic = orb_advertise_multi_queue(ORB_ID(sensor_accel), &arp,
+		&_accel_orb_class_instance, (is_external()) ? ORB_PRIO_MAX : ORB_PRIO_HIGH, SENSOR_ORB_QUEUE_SIZE);
 
 	if (_accel_topic == nullptr) {
 		warnx("ADVERT FAIL");
@@ -667,8 +737,8 @@ MPU9250::init()
 	struct gyro_report grp;
 	_gyro_reports->get(&grp);
 
-	_gyro->_gyro_topic = orb_advertise_multi(ORB_ID(sensor_gyro), &grp,
-		&_gyro->_gyro_orb_class_instance, (is_external()) ? ORB_PRIO_MAX : ORB_PRIO_HIGH);
+	_gyro->_gyro_topic = orb_advertise_multi_queue(ORB_ID(sensor_gyro), &grp,
+		&_gyro->_gyro_orb_class_instance, (is_external()) ? ORB_PRIO_MAX : ORB_PRIO_HIGH, SENSOR_ORB_QUEUE_SIZE);
 
 	if (_gyro->_gyro_topic == nullptr) {
 		warnx("ADVERT FAIL");
@@ -721,6 +791,11 @@ int MPU9250::reset()
 	write_checked_reg(MPUREG_INT_PIN_CFG, BIT_INT_ANYRD_2CLEAR); // INT: Clear on any read
 	usleep(1000);
 
+	// FIFO => accel, temperature and gyro of every sample
+	write_checked_reg(MPUREG_FIFO_EN, BITS_FIFO_ENABLE_ACCEL | BITS_FIFO_ENABLE_TEMP | BITS_FIFO_ENABLE_GYRO);
+	write_checked_reg(MPUREG_USER_CTRL, BIT_FIFO_EN);
+	usleep(1000);
+
 	uint8_t retries = 10;
 	while (retries--) {
 		bool all_ok = true;
@@ -1032,32 +1107,28 @@ MPU9250::ioctl(struct file *filp, int cmd, unsigned long arg)
 					if (ticks < 1000)
 						return -EINVAL;
 
-					// adjust filters
-					float cutoff_freq_hz = _accel_filter_x.get_cutoff_freq();
-					float sample_rate = 1.0e6f/ticks;
+					// adjust filters, they see every sample of the FIFO
+					float cutoff_freq_hz = _accel_filter.get_cutoff_freq();
+					float sample_rate = _sample_rate;
 					_set_dlpf_filter(cutoff_freq_hz);
-					_accel_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
-					_accel_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
-					_accel_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
+					_accel_filter.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
 
 
-					float cutoff_freq_hz_gyro = _gyro_filter_x.get_cutoff_freq();
+					float cutoff_freq_hz_gyro = _gyro_filter.get_cutoff_freq();
 					_set_dlpf_filter(cutoff_freq_hz_gyro);
-					_gyro_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
-					_gyro_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
-					_gyro_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
+					_gyro_filter.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
 
 					/* update interval for next measurement */
 					/* XXX this is a bit shady, but no other way to adjust... */
 					_call_interval = ticks;
 
-                                        /*
-                                          set call interval faster then the sample time. We
-                                          then detect when we have duplicate samples and reject
-                                          them. This prevents aliasing due to a beat between the
-                                          stm32 clock and the mpu9250 clock
-                                         */
-                                        _call.period = _call_interval - MPU9250_TIMER_REDUCTION;
+					/*
+					  the sensor samples into its FIFO at the sample
+					  rate, the timer only drains it. Reading the
+					  FIFO never returns duplicates, so no beat
+					  between the stm32 and the mpu9250 clock
+					 */
+					_call.period = MPU9250_FIFO_DRAIN_INTERVAL;
 
 					/* if we need to start the poll state machine, do it */
 					if (want_start)
@@ -1100,13 +1171,11 @@ MPU9250::ioctl(struct file *filp, int cmd, unsigned long arg)
 		return OK;
 
 	case ACCELIOCGLOWPASS:
-		return _accel_filter_x.get_cutoff_freq();
+		return _accel_filter.get_cutoff_freq();
 
 	case ACCELIOCSLOWPASS:
 		// set software filtering
-		_accel_filter_x.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_accel_filter_y.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_accel_filter_z.set_cutoff_frequency(1.0e6f / _call_interval, arg);
+		_accel_filter.set_cutoff_frequency(_sample_rate, arg);
 		return OK;
 
 	case ACCELIOCSSCALE:
@@ -1116,6 +1185,7 @@ MPU9250::ioctl(struct file *filp, int cmd, unsigned long arg)
 			float sum = s->x_scale + s->y_scale + s->z_scale;
 			if (sum > 2.0f && sum < 4.0f) {
 				memcpy(&_accel_scale, s, sizeof(_accel_scale));
+				update_correction();
 				return OK;
 			} else {
 				return -EINVAL;
@@ -1191,18 +1261,17 @@ MPU9250::gyro_ioctl(struct file *filp, int cmd, unsigned long arg)
 		return OK;
 
 	case GYROIOCGLOWPASS:
-		return _gyro_filter_x.get_cutoff_freq();
+		return _gyro_filter.get_cutoff_freq();
 
 	case GYROIOCSLOWPASS:
 		// set software filtering
-		_gyro_filter_x.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_gyro_filter_y.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_gyro_filter_z.set_cutoff_frequency(1.0e6f / _call_interval, arg);
+		_gyro_filter.set_cutoff_frequency(_sample_rate, arg);
 		return OK;
 
 	case GYROIOCSSCALE:
 		/* copy scale in */
 		memcpy(&_gyro_scale, (struct gyro_scale *) arg, sizeof(_gyro_scale));
+		update_correction();
 		return OK;
 
 	case GYROIOCGSCALE:
@@ -1253,12 +1322,12 @@ MPU9250::read_reg(unsigned reg, uint32_t speed)
 }
 
 uint16_t
-MPU9250::read_reg16(unsigned reg)
+MPU9250::read_reg16(unsigned reg, uint32_t speed)
 {
 	uint8_t cmd[3] = { (uint8_t)(reg | DIR_READ), 0, 0 };
 
         // general register transfer at low clock speed
-        set_frequency(MPU9250_LOW_BUS_SPEED);
+        set_frequency(speed);
 
 	transfer(cmd, cmd, sizeof(cmd));
 
@@ -1331,9 +1400,18 @@ MPU9250::set_accel_range(unsigned max_g_in)
 	_accel_range_scale = (MPU9250_ONE_G / lsb_per_g);
 	_accel_range_m_s2 = max_accel_g * MPU9250_ONE_G;
 
+	update_correction();
+
 	return OK;
 }
 
+void
+MPU9250::update_correction()
+{
+	_accel_correction.set(_rotation, _accel_range_scale, _accel_scale);
+	_gyro_correction.set(_rotation, _gyro_range_scale, _gyro_scale);
+}
+
 void
 MPU9250::start()
 {
@@ -1344,17 +1422,20 @@ MPU9250::start()
 	_accel_reports->flush();
 	_gyro_reports->flush();
 
-	/* start polling at the specified rate */
-	hrt_call_every(&_call,
+	/* drop samples collected while not polling */
+	reset_fifo();
+
+	/* start draining the FIFO */
+	bus_call_every(&_call,
                        1000,
-                       _call_interval-MPU9250_TIMER_REDUCTION,
+                       MPU9250_FIFO_DRAIN_INTERVAL,
                        (hrt_callout)&MPU9250::measure_trampoline, this);
 }
 
 void
 MPU9250::stop()
 {
-	hrt_cancel(&_call);
+	bus_cancel(&_call);
 }
 
 void
@@ -1362,8 +1443,8 @@ MPU9250::measure_trampoline(void *arg)
 {
 	MPU9250 *dev = reinterpret_cast<MPU9250 *>(arg);
 
-	/* make another measurement */
-	dev->measure();
+	/* collect the samples since the last call */
+	dev->measure_fifo();
 }
 
 void
@@ -1430,15 +1511,7 @@ MPU9250::measure()
 	}
 
 	struct MPUReport mpu_report;
-	struct Report {
-		int16_t		accel_x;
-		int16_t		accel_y;
-		int16_t		accel_z;
-		int16_t		temp;
-		int16_t		gyro_x;
-		int16_t		gyro_y;
-		int16_t		gyro_z;
-	} report;
+	struct Report report;
 
 	/* start measuring */
 	perf_begin(_sample_perf);
@@ -1474,27 +1547,7 @@ MPU9250::measure()
 	memcpy(&_last_accel[0], &mpu_report.accel_x[0], 6);
 	_got_duplicate = false;
 
-	/*
-	 * Convert from big to little endian
-	 */
-
-	report.accel_x = int16_t_from_bytes(mpu_report.accel_x);
-	report.accel_y = int16_t_from_bytes(mpu_report.accel_y);
-	report.accel_z = int16_t_from_bytes(mpu_report.accel_z);
-
-	report.temp = int16_t_from_bytes(mpu_report.temp);
-
-	report.gyro_x = int16_t_from_bytes(mpu_report.gyro_x);
-	report.gyro_y = int16_t_from_bytes(mpu_report.gyro_y);
-	report.gyro_z = int16_t_from_bytes(mpu_report.gyro_z);
-
-	if (report.accel_x == 0 &&
-	    report.accel_y == 0 &&
-	    report.accel_z == 0 &&
-	    report.temp == 0 &&
-	    report.gyro_x == 0 &&
-	    report.gyro_y == 0 &&
-	    report.gyro_z == 0) {
+	if (!convert_sample(&mpu_report.accel_x[0], report)) {
 		// all zero data - probably a SPI bus error
 		perf_count(_bad_transfers);
 		perf_end(_sample_perf);
@@ -1515,7 +1568,133 @@ MPU9250::measure()
 		return;
 	}
 
+	process_sample(report, hrt_absolute_time());
+
+	/* stop measuring */
+	perf_end(_sample_perf);
+}
+
+void
+MPU9250::reset_fifo()
+{
+	write_reg(MPUREG_USER_CTRL, BIT_FIFO_RESET);
+	write_reg(MPUREG_USER_CTRL, BIT_FIFO_EN);
+}
+
+void
+MPU9250::measure_fifo()
+{
+	if (hrt_absolute_time() < _reset_wait) {
+		// we're waiting for a reset to complete
+		return;
+	}
+
+	/* start measuring */
+	perf_begin(_sample_perf);
 
+	/*
+	 * Two transfers per call, however many samples arrived: the
+	 * FIFO count and then all complete samples in one burst.
+	 */
+	uint16_t fifo_count = read_reg16(MPUREG_FIFO_COUNTH, MPU9250_HIGH_BUS_SPEED);
+
+	check_registers();
+
+	if (fifo_count == 0) {
+		// no new sample yet - wait for next timer
+		perf_end(_sample_perf);
+		return;
+	}
+
+	if (fifo_count % MPU9250_FIFO_SAMPLE_SIZE != 0 ||
+	    fifo_count > MPU9250_FIFO_SIZE - MPU9250_FIFO_SAMPLE_SIZE) {
+		// the FIFO overflowed or lost alignment after a
+		// register fix, the sample boundaries are unknown
+		perf_count(_fifo_resets);
+		reset_fifo();
+		perf_end(_sample_perf);
+		return;
+	}
+
+	const unsigned pending = fifo_count / MPU9250_FIFO_SAMPLE_SIZE;
+	unsigned samples = pending;
+
+	if (samples > MPU9250_FIFO_MAX_SAMPLES) {
+		// late call, the rest is drained on the next one
+		samples = MPU9250_FIFO_MAX_SAMPLES;
+	}
+
+	_fifo_buffer[0] = DIR_READ | MPUREG_FIFO_R_W;
+
+	set_frequency(MPU9250_HIGH_BUS_SPEED);
+
+	if (OK != transfer(_fifo_buffer, _fifo_buffer, 1 + samples * MPU9250_FIFO_SAMPLE_SIZE)) {
+		perf_end(_sample_perf);
+		return;
+	}
+
+	/*
+	 * The newest pending sample was taken just now, the older ones
+	 * one sample period apart. Samples left for the next call are
+	 * newer than the ones read here.
+	 */
+	hrt_abstime now = hrt_absolute_time();
+	unsigned sample_interval = 1000000 / _sample_rate;
+
+	for (unsigned i = 0; i < samples; i++) {
+		struct Report report;
+
+		if (!convert_sample(&_fifo_buffer[1 + i * MPU9250_FIFO_SAMPLE_SIZE], report)) {
+			// all zero data - probably a SPI bus error
+			perf_count(_bad_transfers);
+			continue;
+		}
+
+		perf_count(_good_transfers);
+
+		if (_register_wait != 0) {
+			// we are waiting for some good samples before
+			// using the sensor again
+			_register_wait--;
+			continue;
+		}
+
+		process_sample(report, now - (pending - 1 - i) * sample_interval);
+	}
+
+	/* stop measuring */
+	perf_end(_sample_perf);
+}
+
+bool
+MPU9250::convert_sample(uint8_t *data, struct Report &report)
+{
+	/*
+	 * Convert from big to little endian
+	 */
+
+	report.accel_x = int16_t_from_bytes(&data[0]);
+	report.accel_y = int16_t_from_bytes(&data[2]);
+	report.accel_z = int16_t_from_bytes(&data[4]);
+
+	report.temp = int16_t_from_bytes(&data[6]);
+
+	report.gyro_x = int16_t_from_bytes(&data[8]);
+	report.gyro_y = int16_t_from_bytes(&data[10]);
+	report.gyro_z = int16_t_from_bytes(&data[12]);
+
+	return !(report.accel_x == 0 &&
+		 report.accel_y == 0 &&
+		 report.accel_z == 0 &&
+		 report.temp == 0 &&
+		 report.gyro_x == 0 &&
+		 report.gyro_y == 0 &&
+		 report.gyro_z == 0);
+}
+
+void
+MPU9250::process_sample(struct Report &report, hrt_abstime timestamp)
+{
 	/*
 	 * Swap axes and negate y
 	 */
@@ -1542,7 +1721,7 @@ MPU9250::measure()
 	/*
 	 * Adjust and scale results to m/s^2.
 	 */
-	grb.timestamp = arb.timestamp = hrt_absolute_time();
+	grb.timestamp = arb.timestamp = timestamp;
 
 	// report the error count as the sum of the number of bad
 	// transfers and bad register reads. This allows the higher
@@ -1572,20 +1751,22 @@ MPU9250::measure()
 	arb.y_raw = report.accel_y;
 	arb.z_raw = report.accel_z;
 
-	float xraw_f = report.accel_x;
-	float yraw_f = report.accel_y;
-	float zraw_f = report.accel_z;
+	// apply user specified rotation, range scale and calibration in one step
+	float accel_in[3];
+	_accel_correction.apply(report.accel_x, report.accel_y, report.accel_z, accel_in);
 
-	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	math::Vector<3> aval(accel_in[0], accel_in[1], accel_in[2]);
+	math::Vector<3> aval_integrated;
 
-	float x_in_new = ((xraw_f * _accel_range_scale) - _accel_scale.x_offset) * _accel_scale.x_scale;
-	float y_in_new = ((yraw_f * _accel_range_scale) - _accel_scale.y_offset) * _accel_scale.y_scale;
-	float z_in_new = ((zraw_f * _accel_range_scale) - _accel_scale.z_offset) * _accel_scale.z_scale;
+	_accel_filter.apply(accel_in);
+	arb.x = accel_in[0];
+	arb.y = accel_in[1];
+	arb.z = accel_in[2];
 
-	arb.x = _accel_filter_x.apply(x_in_new);
-	arb.y = _accel_filter_y.apply(y_in_new);
-	arb.z = _accel_filter_z.apply(z_in_new);
+	bool accel_notify = _accel_int.put(arb.timestamp, aval, aval_integrated, arb.integral_dt);
+	arb.x_integral = aval_integrated(0);
+	arb.y_integral = aval_integrated(1);
+	arb.z_integral = aval_integrated(2);
 
 	arb.scaling = _accel_range_scale;
 	arb.range_m_s2 = _accel_range_m_s2;
@@ -1599,20 +1780,22 @@ MPU9250::measure()
 	grb.y_raw = report.gyro_y;
 	grb.z_raw = report.gyro_z;
 
-	xraw_f = report.gyro_x;
-	yraw_f = report.gyro_y;
-	zraw_f = report.gyro_z;
+	// apply user specified rotation, range scale and calibration in one step
+	float gyro_in[3];
+	_gyro_correction.apply(report.gyro_x, report.gyro_y, report.gyro_z, gyro_in);
 
-	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	math::Vector<3> gval(gyro_in[0], gyro_in[1], gyro_in[2]);
+	math::Vector<3> gval_integrated;
 
-	float x_gyro_in_new = ((xraw_f * _gyro_range_scale) - _gyro_scale.x_offset) * _gyro_scale.x_scale;
-	float y_gyro_in_new = ((yraw_f * _gyro_range_scale) - _gyro_scale.y_offset) * _gyro_scale.y_scale;
-	float z_gyro_in_new = ((zraw_f * _gyro_range_scale) - _gyro_scale.z_offset) * _gyro_scale.z_scale;
+	_gyro_filter.apply(gyro_in);
+	grb.x = gyro_in[0];
+	grb.y = gyro_in[1];
+	grb.z = gyro_in[2];
 
-	grb.x = _gyro_filter_x.apply(x_gyro_in_new);
-	grb.y = _gyro_filter_y.apply(y_gyro_in_new);
-	grb.z = _gyro_filter_z.apply(z_gyro_in_new);
+	bool gyro_notify = _gyro_int.put(arb.timestamp, gval, gval_integrated, grb.integral_dt);
+	grb.x_integral = gval_integrated(0);
+	grb.y_integral = gval_integrated(1);
+	grb.z_integral = gval_integrated(2);
 
 	grb.scaling = _gyro_range_scale;
 	grb.range_rad_s = _gyro_range_rad_s;
@@ -1624,10 +1807,15 @@ MPU9250::measure()
 	_gyro_reports->force(&grb);
 
 	/* notify anyone waiting for data */
-	poll_notify(POLLIN);
-	_gyro->parent_poll_notify();
+	if (accel_notify) {
+		poll_notify(POLLIN);
+	}
+
+	if (gyro_notify) {
+		_gyro->parent_poll_notify();
+	}
 
-	if (!(_pub_blocked)) {
+	if (accel_notify && !(_pub_blocked)) {
 		/* log the time of this report */
 		perf_begin(_controller_latency_perf);
 		perf_begin(_system_latency_perf);
@@ -1635,13 +1823,10 @@ MPU9250::measure()
 		orb_publish(ORB_ID(sensor_accel), _accel_topic, &arb);
 	}
 
-	if (!(_pub_blocked)) {
+	if (gyro_notify && !(_pub_blocked)) {
 		/* publish it */
 		orb_publish(ORB_ID(sensor_gyro), _gyro->_gyro_topic, &grb);
 	}
-
-	/* stop measuring */
-	perf_end(_sample_perf);
 }
 
 void
@@ -1655,6 +1840,7 @@ MPU9250::print_info()
 	perf_print_counter(_good_transfers);
 	perf_print_counter(_reset_retries);
 	perf_print_counter(_duplicates);
+	perf_print_counter(_fifo_resets);
 	_accel_reports->print_info("accel queue");
 	_gyro_reports->print_info("gyro queue");
         ::printf("checked_next: %u\n", _checked_next);
@@ -38,8 +38,13 @@
  */
 
 #define ADDR_RESET_CMD				0x1E	/* write to this address to reset chip */
-#define ADDR_CMD_CONVERT_D1		0x48	/* write to this address to start pressure conversion */
-#define ADDR_CMD_CONVERT_D2		0x58	/* write to this address to start temperature conversion */
+#define ADDR_CMD_CONVERT_D1		0x40	/* write to this address plus the OSR to start pressure conversion */
+#define ADDR_CMD_CONVERT_D2		0x50	/* write to this address plus the OSR to start temperature conversion */
+#define ADDR_CMD_CONVERT_OSR256		0x00	/* oversampling ratios of the conversions */
+#define ADDR_CMD_CONVERT_OSR512		0x02
+#define ADDR_CMD_CONVERT_OSR1024	0x04
+#define ADDR_CMD_CONVERT_OSR2048	0x06
+#define ADDR_CMD_CONVERT_OSR4096	0x08
 #define ADDR_DATA							0x00	/* address of 3 bytes / 32bit pressure data */
 #define ADDR_PROM_SETUP				0xA0	/* address of 8x 2 bytes factory and calibration data */
 #define ADDR_PROM_C1					0xA2	/* address of 6x 2 bytes calibration data */
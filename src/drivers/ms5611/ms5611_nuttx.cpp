@@ -98,7 +98,16 @@ static const int ERROR = -1;
  */
 
 /* internal conversion time: 9.17 ms, so should not be read at rates higher than 100 Hz */
+#define MS5611_PRESSURE_OSR		ADDR_CMD_CONVERT_OSR4096
 #define MS5611_CONVERSION_INTERVAL	10000	/* microseconds */
+
+/*
+ * The temperature only feeds the compensation terms kept for the following
+ * pressure conversions and changes slowly, OSR 1024 (2.28 ms, 0.005 C)
+ * leaves more of the time to the pressure conversions.
+ */
+#define MS5611_TEMPERATURE_OSR		ADDR_CMD_CONVERT_OSR1024
+#define MS5611_TEMPERATURE_CONVERSION_INTERVAL	2500	/* microseconds */
 #define MS5611_MEASUREMENT_RATIO	3	/* pressure measurements per temperature measurement */
 #define MS5611_BARO_DEVICE_PATH_EXT	"/dev/ms5611_ext"
 #define MS5611_BARO_DEVICE_PATH_INT	"/dev/ms5611_int"
@@ -298,7 +307,7 @@ MS5611::init()
 			break;
 		}
 
-		usleep(MS5611_CONVERSION_INTERVAL);
+		usleep(MS5611_TEMPERATURE_CONVERSION_INTERVAL);
 
 		if (OK != collect()) {
 			ret = -EIO;
@@ -379,7 +388,7 @@ MS5611::read(struct file *filp, char *buffer, size_t buflen)
 			break;
 		}
 
-		usleep(MS5611_CONVERSION_INTERVAL);
+		usleep(MS5611_TEMPERATURE_CONVERSION_INTERVAL);
 
 		if (OK != collect()) {
 			ret = -EIO;
@@ -630,7 +639,7 @@ MS5611::cycle()
 		   &_work,
 		   (worker_t)&MS5611::cycle_trampoline,
 		   this,
-		   USEC2TICK(MS5611_CONVERSION_INTERVAL));
+		   USEC2TICK((_measure_phase == 0) ? MS5611_TEMPERATURE_CONVERSION_INTERVAL : MS5611_CONVERSION_INTERVAL));
 }
 
 int
@@ -643,7 +652,8 @@ MS5611::measure()
 	/*
 	 * In phase zero, request temperature; in other phases, request pressure.
 	 */
-	unsigned addr = (_measure_phase == 0) ? ADDR_CMD_CONVERT_D2 : ADDR_CMD_CONVERT_D1;
+	unsigned addr = (_measure_phase == 0) ? ADDR_CMD_CONVERT_D2 + MS5611_TEMPERATURE_OSR :
+			ADDR_CMD_CONVERT_D1 + MS5611_PRESSURE_OSR;
 
 	/*
 	 * Send the command to begin measuring.
@@ -97,7 +97,16 @@ static const int ERROR = -1;
  */
 
 /* internal conversion time: 9.17 ms, so should not be read at rates higher than 100 Hz */
+#define MS5611_PRESSURE_OSR		ADDR_CMD_CONVERT_OSR4096
 #define MS5611_CONVERSION_INTERVAL	10000	/* microseconds */
+
+/*
+ * The temperature only feeds the compensation terms kept for the following
+ * pressure conversions and changes slowly, OSR 1024 (2.28 ms, 0.005 C)
+ * leaves more of the time to the pressure conversions.
+ */
+#define MS5611_TEMPERATURE_OSR		ADDR_CMD_CONVERT_OSR1024
+#define MS5611_TEMPERATURE_CONVERSION_INTERVAL	2500	/* microseconds */
 #define MS5611_MEASUREMENT_RATIO	3	/* pressure measurements per temperature measurement */
 #define MS5611_BARO_DEVICE_PATH_EXT	"/dev/ms5611_ext"
 #define MS5611_BARO_DEVICE_PATH_INT	"/dev/ms5611_int"
@@ -120,6 +129,7 @@ public:
 
 protected:
 	Device			*_interface;
+	int			_work_queue;
 
 	ms5611::prom_s		_prom;
 
@@ -214,6 +224,7 @@ extern "C" __EXPORT int ms5611_main(int argc, char *argv[]);
 MS5611::MS5611(device::Device *interface, ms5611::prom_u &prom_buf, const char *path) :
 	VDev("MS5611", path),
 	_interface(interface),
+	_work_queue(BUSWORK(interface->get_device_bus())),
 	_prom(prom_buf.s),
 	_measure_ticks(0),
 	_reports(nullptr),
@@ -297,7 +308,7 @@ MS5611::init()
 			break;
 		}
 
-		usleep(MS5611_CONVERSION_INTERVAL);
+		usleep(MS5611_TEMPERATURE_CONVERSION_INTERVAL);
 
 		if (OK != collect()) {
 			ret = -EIO;
@@ -382,7 +393,7 @@ MS5611::read(device::file_t *handlep, char *buffer, size_t buflen)
 			break;
 		}
 
-		usleep(MS5611_CONVERSION_INTERVAL);
+		usleep(MS5611_TEMPERATURE_CONVERSION_INTERVAL);
 
 		if (OK != collect()) {
 			ret = -EIO;
@@ -538,13 +549,13 @@ MS5611::start_cycle()
 	_reports->flush();
 
 	/* schedule a cycle to start things */
-	work_queue(HPWORK, &_work, (worker_t)&MS5611::cycle_trampoline, this, 1);
+	work_queue(_work_queue, &_work, (worker_t)&MS5611::cycle_trampoline, this, 1);
 }
 
 void
 MS5611::stop_cycle()
 {
-	work_cancel(HPWORK, &_work);
+	work_cancel(_work_queue, &_work);
 }
 
 void
@@ -597,7 +608,7 @@ MS5611::cycle()
 		    ((unsigned long)_measure_ticks > USEC2TICK(MS5611_CONVERSION_INTERVAL))) {
 
 			/* schedule a fresh cycle call when we are ready to measure again */
-			work_queue(HPWORK,
+			work_queue(_work_queue,
 				   &_work,
 				   (worker_t)&MS5611::cycle_trampoline,
 				   this,
@@ -623,11 +634,11 @@ MS5611::cycle()
 	_collect_phase = true;
 
 	/* schedule a fresh cycle call when the measurement is done */
-	work_queue(HPWORK,
+	work_queue(_work_queue,
 		   &_work,
 		   (worker_t)&MS5611::cycle_trampoline,
 		   this,
-		   USEC2TICK(MS5611_CONVERSION_INTERVAL));
+		   USEC2TICK((_measure_phase == 0) ? MS5611_TEMPERATURE_CONVERSION_INTERVAL : MS5611_CONVERSION_INTERVAL));
 }
 
 int
@@ -640,7 +651,8 @@ MS5611::measure()
 	/*
 	 * In phase zero, request temperature; in other phases, request pressure.
 	 */
-	unsigned addr = (_measure_phase == 0) ? ADDR_CMD_CONVERT_D2 : ADDR_CMD_CONVERT_D1;
+	unsigned addr = (_measure_phase == 0) ? ADDR_CMD_CONVERT_D2 + MS5611_TEMPERATURE_OSR :
+			ADDR_CMD_CONVERT_D1 + MS5611_PRESSURE_OSR;
 
 	/*
 	 * Send the command to begin measuring.
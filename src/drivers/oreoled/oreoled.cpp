@@ -74,7 +74,6 @@
 #define OREOLED_GENERALCALL_CMD	0x00		///< general call command sent at regular intervals
 
 #define OREOLED_STARTUP_INTERVAL_US		(1000000U / 10U)	///< time in microseconds, measure at 10hz
-#define OREOLED_UPDATE_INTERVAL_US		(1000000U / 50U)	///< time in microseconds, measure at 10hz
 
 #define OREOLED_CMD_QUEUE_SIZE	10		///< up to 10 messages can be queued up to send to the LEDs
 
@@ -113,12 +112,29 @@ private:
 	static void		cycle_trampoline(void *arg);
 
 	/**
-	 * update the colours displayed by the LEDs
+	 * look for the LEDs and send the general calls
 	 */
 	void			cycle();
 
+	/**
+	 * have the queued commands sent as soon as possible
+	 */
+	void			queue_send();
+
+	/**
+	 * static function that is called by worker queue for queued commands
+	 */
+	static void		send_trampoline(void *arg);
+
+	/**
+	 * update the colours displayed by the LEDs
+	 */
+	void			send_queued();
+
 	/* internal variables */
 	work_s			_work;							///< work queue for scheduling reads
+	work_s			_send_work;						///< work queue for sending the queued commands
+	oreoled_cmd_t		_last_cmd[OREOLED_NUM_LEDS];	///< pattern last sent to each LED, num_bytes 0 if unknown
 	bool			_healthy[OREOLED_NUM_LEDS];		///< health of each LED
 	uint8_t			_num_healthy;					///< number of healthy LEDs
 	ringbuffer::RingBuffer	*_cmd_queue;					///< buffer of commands to send to LEDs
@@ -140,12 +156,14 @@ extern "C" __EXPORT int oreoled_main(int argc, char *argv[]);
 OREOLED::OREOLED(int bus, int i2c_addr) :
 	I2C("oreoled", OREOLED0_DEVICE_PATH, bus, i2c_addr, 100000),
 	_work{},
+	_send_work{},
 	_num_healthy(0),
 	_cmd_queue(nullptr),
 	_last_gencall(0)
 {
 	/* initialise to unhealthy */
 	memset(_healthy, 0, sizeof(_healthy));
+	memset(_last_cmd, 0, sizeof(_last_cmd));
 
 	/* capture startup time */
 	_start_time = hrt_absolute_time();
@@ -223,6 +241,7 @@ void
 OREOLED::stop()
 {
 	work_cancel(HPWORK, &_work);
+	work_cancel(HPWORK, &_send_work);
 }
 
 void
@@ -275,6 +294,46 @@ OREOLED::cycle()
 		return;
 	}
 
+	/* commands are sent when they are queued, see queue_send() */
+	send_queued();
+
+	/* send general call every 4 seconds*/
+	if ((now - _last_gencall) > OREOLED_GENERALCALL_US) {
+		send_general_call();
+	}
+
+	/* nothing else to do until the next general call is due */
+	work_queue(HPWORK, &_work, (worker_t)&OREOLED::cycle_trampoline, this,
+		   USEC2TICK(OREOLED_GENERALCALL_US - (hrt_absolute_time() - _last_gencall)));
+}
+
+void
+OREOLED::queue_send()
+{
+	irqstate_t flags = irqsave();
+
+	/* work that is still pending sends this command as well */
+	if (_send_work.worker == nullptr) {
+		work_queue(HPWORK, &_send_work, (worker_t)&OREOLED::send_trampoline, this, 0);
+	}
+
+	irqrestore(flags);
+}
+
+void
+OREOLED::send_trampoline(void *arg)
+{
+	OREOLED *dev = (OREOLED *)arg;
+
+	/* check global oreoled and send */
+	if (g_oreoled != nullptr) {
+		dev->send_queued();
+	}
+}
+
+void
+OREOLED::send_queued()
+{
 	/* get next command from queue */
 	oreoled_cmd_t next_cmd;
 
@@ -282,21 +341,31 @@ OREOLED::cycle()
 		/* send valid messages to healthy LEDs */
 		if ((next_cmd.led_num < OREOLED_NUM_LEDS) && _healthy[next_cmd.led_num]
 		    && (next_cmd.num_bytes <= OREOLED_CMD_LENGTH_MAX)) {
+
+			oreoled_cmd_t &last = _last_cmd[next_cmd.led_num];
+
+			/* the LED keeps showing a pattern, so don't send it again. Parameter
+			 * updates such as macros have an effect every time and always go out */
+			if (next_cmd.num_bytes > 0 && next_cmd.buff[0] != OREOLED_PATTERN_PARAMUPDATE
+			    && next_cmd.num_bytes == last.num_bytes
+			    && memcmp(next_cmd.buff, last.buff, next_cmd.num_bytes) == 0) {
+				continue;
+			}
+
 			/* set I2C address */
 			set_address(OREOLED_BASE_I2C_ADDR + next_cmd.led_num);
+
 			/* send I2C command */
-			transfer(next_cmd.buff, next_cmd.num_bytes, nullptr, 0);
-		}
-	}
+			if (transfer(next_cmd.buff, next_cmd.num_bytes, nullptr, 0) == OK
+			    && next_cmd.num_bytes > 0 && next_cmd.buff[0] != OREOLED_PATTERN_PARAMUPDATE) {
+				last = next_cmd;
 
-	/* send general call every 4 seconds*/
-	if ((now - _last_gencall) > OREOLED_GENERALCALL_US) {
-		send_general_call();
+			} else {
+				/* a macro or a failed transfer leaves the LED in an unknown state */
+				last.num_bytes = 0;
+			}
+		}
 	}
-
-	/* schedule a fresh cycle call when the measurement is done */
-	work_queue(HPWORK, &_work, (worker_t)&OREOLED::cycle_trampoline, this,
-		   USEC2TICK(OREOLED_UPDATE_INTERVAL_US));
 }
 
 int
@@ -337,6 +406,10 @@ OREOLED::ioctl(struct file *filp, int cmd, unsigned long arg)
 			}
 		}
 
+		if (ret == OK) {
+			queue_send();
+		}
+
 		return ret;
 
 	case OREOLED_RUN_MACRO:
@@ -366,6 +439,10 @@ OREOLED::ioctl(struct file *filp, int cmd, unsigned long arg)
 			}
 		}
 
+		if (ret == OK) {
+			queue_send();
+		}
+
 		return ret;
 
 	case OREOLED_SEND_BYTES:
@@ -391,6 +468,10 @@ OREOLED::ioctl(struct file *filp, int cmd, unsigned long arg)
 			}
 		}
 
+		if (ret == OK) {
+			queue_send();
+		}
+
 		return ret;
 
 	default:
@@ -438,6 +519,7 @@ OREOLED::send_cmd(oreoled_cmd_t new_cmd)
 
 		/* add to queue */
 		_cmd_queue->force(&new_cmd);
+		queue_send();
 		ret = OK;
 	}
 
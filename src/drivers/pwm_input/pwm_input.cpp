@@ -279,6 +279,8 @@ PWMIN::PWMIN() :
 	_reports(nullptr),
 	_timer_started(false)
 {
+	memset(&_hard_reset_call, 0, sizeof(_hard_reset_call));
+	memset(&_freeze_test_call, 0, sizeof(_freeze_test_call));
 }
 
 PWMIN::~PWMIN()
@@ -84,6 +84,7 @@
 #define PX4FLOW_REG			0x16	///< Measure Register 22
 
 #define PX4FLOW_CONVERSION_INTERVAL	100000	///< in microseconds! 20000 = 50 Hz 100000 = 10Hz
+#define PX4FLOW_MIN_INTERVAL		10000	///< shortest interval of an explicitly set rate, 100 Hz
 #define PX4FLOW_I2C_MAX_BUS_SPEED	400000	///< 400 KHz maximum speed
 
 #define PX4FLOW_MAX_DISTANCE 5.0f
@@ -320,7 +321,7 @@ PX4FLOW::ioctl(struct file *filp, int cmd, unsigned long arg)
 					unsigned ticks = USEC2TICK(1000000 / arg);
 
 					/* check against maximum rate */
-					if (ticks < USEC2TICK(PX4FLOW_CONVERSION_INTERVAL)) {
+					if (ticks < USEC2TICK(PX4FLOW_MIN_INTERVAL)) {
 						return -EINVAL;
 					}
 
@@ -417,13 +418,7 @@ PX4FLOW::read(struct file *filp, char *buffer, size_t buflen)
 	do {
 		_reports->flush();
 
-		/* trigger a measurement */
-		if (OK != measure()) {
-			ret = -EIO;
-			break;
-		}
-
-		/* run the collection phase */
+		/* select the register and read the frame */
 		if (OK != collect()) {
 			ret = -EIO;
 			break;
@@ -468,15 +463,23 @@ PX4FLOW::collect()
 
 	/* read from the sensor */
 	uint8_t val[I2C_FRAME_SIZE + I2C_INTEGRAL_FRAME_SIZE] = { 0 };
+	uint8_t cmd = PX4FLOW_REG;
 
 	perf_begin(_sample_perf);
 
+	/*
+	 * The sensor closes the integration interval when it is read, so the
+	 * sample time is the start of the read, not the end of the transfer.
+	 */
+	hrt_abstime read_start = hrt_absolute_time();
+
+	/* select the register and read the frame in one transaction */
 	if (PX4FLOW_REG == 0x00) {
-		ret = transfer(nullptr, 0, &val[0], I2C_FRAME_SIZE + I2C_INTEGRAL_FRAME_SIZE);
+		ret = transfer(&cmd, 1, &val[0], I2C_FRAME_SIZE + I2C_INTEGRAL_FRAME_SIZE);
 	}
 
 	if (PX4FLOW_REG == 0x16) {
-		ret = transfer(nullptr, 0, &val[0], I2C_INTEGRAL_FRAME_SIZE);
+		ret = transfer(&cmd, 1, &val[0], I2C_INTEGRAL_FRAME_SIZE);
 	}
 
 	if (ret < 0) {
@@ -498,7 +501,7 @@ PX4FLOW::collect()
 
 	struct optical_flow_s report;
 
-	report.timestamp = hrt_absolute_time();
+	report.timestamp = read_start;
 	report.pixel_flow_x_integral = static_cast<float>(f_integral.pixel_flow_x_integral) / 10000.0f;//convert to radians
 	report.pixel_flow_y_integral = static_cast<float>(f_integral.pixel_flow_y_integral) / 10000.0f;//convert to radians
 	report.frame_count_since_last_readout = f_integral.frame_count_since_last_readout;
@@ -564,12 +567,11 @@ PX4FLOW::start()
 	work_queue(HPWORK, &_work, (worker_t)&PX4FLOW::cycle_trampoline, this, 1);
 
 	/* notify about state change */
-	struct subsystem_info_s info = {
-		true,
-		true,
-		true,
-		subsystem_info_s::SUBSYSTEM_TYPE_OPTICALFLOW
-	};
+	struct subsystem_info_s info = {};
+	info.present = true;
+	info.enabled = true;
+	info.ok = true;
+	info.subsystem_type = subsystem_info_s::SUBSYSTEM_TYPE_OPTICALFLOW;
 	static orb_advert_t pub = nullptr;
 
 	if (pub != nullptr) {
@@ -597,11 +599,7 @@ PX4FLOW::cycle_trampoline(void *arg)
 void
 PX4FLOW::cycle()
 {
-	if (OK != measure()) {
-		DEVICE_DEBUG("measure error");
-	}
-
-	/* perform collection */
+	/* perform collection, the register is selected in the same transfer */
 	if (OK != collect()) {
 		DEVICE_DEBUG("collection error");
 		/* restart the measurement state machine */
@@ -642,7 +640,7 @@ bool start_in_progress = false;
 const int START_RETRY_COUNT = 5;
 const int START_RETRY_TIMEOUT = 1000;
 
-int	start();
+int	start(int rate);
 void	stop();
 void	test();
 void	reset();
@@ -650,9 +648,11 @@ void	info();
 
 /**
  * Start the driver.
+ *
+ * @param rate		Readout rate in Hz, 0 for the default rate
  */
 int
-start()
+start(int rate)
 {
 	int fd;
 	
@@ -722,7 +722,7 @@ start()
 				break;
 			}
 
-			if (ioctl(fd, SENSORIOCSPOLLRATE, SENSOR_POLLRATE_MAX) < 0) {
+			if (ioctl(fd, SENSORIOCSPOLLRATE, (rate > 0) ? rate : SENSOR_POLLRATE_MAX) < 0) {
 				break;
 			}
 
@@ -897,7 +897,14 @@ px4flow_main(int argc, char *argv[])
 	 * Start/load the driver.
 	 */
 	if (!strcmp(argv[1], "start")) {
-		return px4flow::start();
+		/* optional readout rate, higher than the default lowers the latency of the flow */
+		int rate = 0;
+
+		if (argc > 3 && !strcmp(argv[2], "-r")) {
+			rate = atoi(argv[3]);
+		}
+
+		return px4flow::start(rate);
 	}
 
 	/*
@@ -928,5 +935,5 @@ px4flow_main(int argc, char *argv[])
 		px4flow::info();
 	}
 
-	errx(1, "unrecognized command, try 'start', 'test', 'reset' or 'info'");
+	errx(1, "unrecognized command, try 'start [-r rate]', 'test', 'reset' or 'info'");
 }
@@ -68,6 +68,7 @@
 #include <systemlib/pwm_limit/pwm_limit.h>
 #include <systemlib/board_serial.h>
 #include <systemlib/param/param.h>
+#include <systemlib/perf_counter.h>
 #include <drivers/drv_mixer.h>
 #include <drivers/drv_rc_input.h>
 
@@ -90,6 +91,12 @@
  */
 
 #define CONTROL_INPUT_DROP_LIMIT_MS		20
+
+/*
+ * Topic update rate marker for oneshot outputs, which follow the
+ * controller without any rate limit
+ */
+#define CONTROL_INPUT_RATE_UNLIMITED		UINT32_MAX
 #define NAN_VALUE	(0.0f/0.0f)
 
 class PX4FMU : public device::CDev
@@ -133,12 +140,15 @@ private:
 	unsigned	_pwm_alt_rate;
 	uint32_t	_pwm_alt_rate_channels;
 	unsigned	_current_update_rate;
+	bool		_oneshot_mode;
+	unsigned	_oneshot_protocol;
 	int		_task;
 	int		_armed_sub;
 	int		_param_sub;
 	orb_advert_t	_outputs_pub;
 	unsigned	_num_outputs;
 	int		_class_instance;
+	perf_counter_t	_perf_control_latency;
 
 	volatile bool	_task_should_exit;
 	bool		_servo_armed;
@@ -177,7 +187,7 @@ private:
 	int		set_pwm_rate(unsigned rate_map, unsigned default_rate, unsigned alt_rate);
 	int		pwm_ioctl(file *filp, int cmd, unsigned long arg);
 	void		update_pwm_rev_mask();
-	void	publish_pwm_outputs(uint16_t *values, size_t numvalues);
+	void	publish_pwm_outputs(uint16_t *values, size_t numvalues, hrt_abstime timestamp_sample);
 
 	struct GPIOConfig {
 		uint32_t	input;
@@ -261,12 +271,15 @@ PX4FMU::PX4FMU() :
 	_pwm_alt_rate(50),
 	_pwm_alt_rate_channels(0),
 	_current_update_rate(0),
+	_oneshot_mode(false),
+	_oneshot_protocol(PWM_ONESHOT_PROTOCOL_125),
 	_task(-1),
 	_armed_sub(-1),
 	_param_sub(-1),
 	_outputs_pub(nullptr),
 	_num_outputs(0),
 	_class_instance(0),
+	_perf_control_latency(perf_alloc(PC_LATENCY, "fmu control latency")),
 	_task_should_exit(false),
 	_servo_armed(false),
 	_pwm_on(false),
@@ -322,6 +335,8 @@ PX4FMU::~PX4FMU()
 	/* clean up the alternate device node */
 	unregister_class_devname(PWM_OUTPUT_BASE_DEVICE_PATH, _class_instance);
 
+	perf_free(_perf_control_latency);
+
 	g_fmu = nullptr;
 }
 
@@ -490,13 +505,13 @@ PX4FMU::set_pwm_rate(uint32_t rate_map, unsigned default_rate, unsigned alt_rate
 			} else {
 				// set it - errors here are unexpected
 				if (alt != 0) {
-					if (up_pwm_servo_set_rate_group_update(group, _pwm_alt_rate) != OK) {
+					if (up_pwm_servo_set_rate_group_update(group, alt_rate) != OK) {
 						warn("rate group set alt failed");
 						return -EINVAL;
 					}
 
 				} else {
-					if (up_pwm_servo_set_rate_group_update(group, _pwm_default_rate) != OK) {
+					if (up_pwm_servo_set_rate_group_update(group, default_rate) != OK) {
 						warn("rate group set default failed");
 						return -EINVAL;
 					}
@@ -509,6 +524,10 @@ PX4FMU::set_pwm_rate(uint32_t rate_map, unsigned default_rate, unsigned alt_rate
 	_pwm_default_rate = default_rate;
 	_pwm_alt_rate = alt_rate;
 
+	/* if any group is oneshot, output synchronously with the attitude controls */
+	_oneshot_mode = (default_rate == PWM_RATE_ONESHOT) ||
+			(alt_rate == PWM_RATE_ONESHOT && rate_map != 0);
+
 	return OK;
 }
 
@@ -579,11 +598,12 @@ PX4FMU::update_pwm_rev_mask()
 }
 
 void
-PX4FMU::publish_pwm_outputs(uint16_t *values, size_t numvalues)
+PX4FMU::publish_pwm_outputs(uint16_t *values, size_t numvalues, hrt_abstime timestamp_sample)
 {
 	actuator_outputs_s outputs;
 	outputs.noutputs = numvalues;
 	outputs.timestamp = hrt_absolute_time();
+	outputs.timestamp_sample = timestamp_sample;
 
 	for (size_t i = 0; i < _max_actuators; ++i) {
 		outputs.output[i] = i < numvalues ? (float)values[i] : 0;
@@ -639,12 +659,16 @@ PX4FMU::task_main()
 		 */
 		unsigned max_rate = (_pwm_default_rate > _pwm_alt_rate) ? _pwm_default_rate : _pwm_alt_rate;
 
+		if (_oneshot_mode) {
+			max_rate = CONTROL_INPUT_RATE_UNLIMITED;
+		}
+
 		if (_current_update_rate != max_rate) {
 			_current_update_rate = max_rate;
 			int update_rate_in_ms = int(1000 / _current_update_rate);
 
-			/* reject faster than 500 Hz updates */
-			if (update_rate_in_ms < 2) {
+			/* reject faster than 500 Hz updates, unless the outputs are oneshot */
+			if (update_rate_in_ms < 2 && !_oneshot_mode) {
 				update_rate_in_ms = 2;
 			}
 
@@ -682,19 +706,32 @@ PX4FMU::task_main()
 
 			/* get controls for required topics */
 			unsigned poll_id = 0;
+			bool attitude_updated = false;
+			hrt_abstime timestamp_sample = 0;
 
 			for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
 				if (_control_subs[i] > 0) {
 					if (_poll_fds[poll_id].revents & POLLIN) {
 						orb_copy(_control_topics[i], _control_subs[i], &_controls[i]);
+						attitude_updated |= (i == actuator_controls_s::GROUP_INDEX_ATTITUDE);
+
+						/* trace the newest sample that went into this output */
+						if (_controls[i].timestamp_sample > timestamp_sample) {
+							timestamp_sample = _controls[i].timestamp_sample;
+						}
 					}
 
 					poll_id++;
 				}
 			}
 
-			/* can we mix? */
-			if (_mixers != nullptr) {
+			/*
+			 * can we mix? In oneshot mode each pulse is triggered by the
+			 * attitude controls, other groups are picked up on the next one.
+			 */
+			if (_mixers != nullptr &&
+			    (!_oneshot_mode || attitude_updated ||
+			     !(_groups_subscribed & (1 << actuator_controls_s::GROUP_INDEX_ATTITUDE)))) {
 
 				size_t num_outputs;
 
@@ -742,7 +779,15 @@ PX4FMU::task_main()
 					up_pwm_servo_set(i, pwm_limited[i]);
 				}
 
-				publish_pwm_outputs(pwm_limited, num_outputs);
+				if (_oneshot_mode) {
+					up_pwm_update();
+				}
+
+				if (timestamp_sample != 0) {
+					perf_set(_perf_control_latency, hrt_elapsed_time(&timestamp_sample));
+				}
+
+				publish_pwm_outputs(pwm_limited, num_outputs, timestamp_sample);
 			}
 		}
 
@@ -958,6 +1003,19 @@ PX4FMU::pwm_ioctl(file *filp, int cmd, unsigned long arg)
 		*(uint32_t *)arg = _pwm_alt_rate_channels;
 		break;
 
+	case PWM_SERVO_SET_ONESHOT_PROTOCOL:
+		ret = up_pwm_servo_set_oneshot_protocol(arg);
+
+		if (ret == OK) {
+			_oneshot_protocol = arg;
+		}
+
+		break;
+
+	case PWM_SERVO_GET_ONESHOT_PROTOCOL:
+		*(uint32_t *)arg = _oneshot_protocol;
+		break;
+
 	case PWM_SERVO_SET_FAILSAFE_PWM: {
 			struct pwm_output_values *pwm = (struct pwm_output_values *)arg;
 
@@ -1350,6 +1408,38 @@ PX4FMU::pwm_ioctl(file *filp, int cmd, unsigned long arg)
 			break;
 		}
 
+	case MIXERIOCLOADBIN: {
+			const mixer_binary_s *bin = (const mixer_binary_s *)arg;
+			unsigned buflen = bin->length;
+
+			if (_mixers == nullptr) {
+				_mixers = new MixerGroup(control_callback, (uintptr_t)_controls);
+			}
+
+			if (_mixers == nullptr) {
+				_groups_required = 0;
+				ret = -ENOMEM;
+
+			} else {
+
+				ret = _mixers->load_from_binary(bin->data, buflen);
+
+				if (ret != 0 || buflen != 0) {
+					DEVICE_DEBUG("binary mixer load failed with %d", ret);
+					delete _mixers;
+					_mixers = nullptr;
+					_groups_required = 0;
+					ret = -EINVAL;
+
+				} else {
+
+					_mixers->groups_required(_groups_required);
+				}
+			}
+
+			break;
+		}
+
 	default:
 		ret = -ENOTTY;
 		break;
@@ -270,6 +270,7 @@ private:
 	perf_counter_t		_perf_update;		///< local performance counter for status updates
 	perf_counter_t		_perf_write;		///< local performance counter for PWM control writes
 	perf_counter_t		_perf_sample_latency;	///< total system latency (based on passed-through timestamp)
+	uint64_t		_last_sample_time;	///< sample timestamp of the last attitude controls sent to IO
 
 	/* cached IO state */
 	uint16_t		_status;		///< Various IO status flags
@@ -349,8 +350,17 @@ private:
 	 * Fetch status and alarms from IO
 	 *
 	 * Also publishes battery voltage/current.
+	 *
+	 * @param prefetched	Status registers from PX4IO_P_STATUS_FLAGS on, already read
+	 *			from IO, or nullptr to read them.
+	 */
+	int			io_get_status(const uint16_t *prefetched = nullptr);
+
+	/**
+	 * Fetch status, R/C input and servo outputs from IO in a single
+	 * transfer and publish them.
 	 */
-	int			io_get_status();
+	int			io_poll();
 
 	/**
 	 * Disable RC input handling
@@ -361,19 +371,26 @@ private:
 	 * Fetch RC inputs from IO.
 	 *
 	 * @param input_rc	Input structure to populate.
+	 * @param prefetched	The raw R/C page from PX4IO_P_RAW_RC_COUNT up to the
+	 *			first 9 channels, already read from IO, or nullptr.
 	 * @return		OK if data was returned.
 	 */
-	int			io_get_raw_rc_input(rc_input_values &input_rc);
+	int			io_get_raw_rc_input(rc_input_values &input_rc, const uint16_t *prefetched = nullptr);
 
 	/**
 	 * Fetch and publish raw RC input data.
+	 *
+	 * @param prefetched	See io_get_raw_rc_input().
 	 */
-	int			io_publish_raw_rc();
+	int			io_publish_raw_rc(const uint16_t *prefetched = nullptr);
 
 	/**
 	 * Fetch and publish the PWM servo outputs.
+	 *
+	 * @param servos	Servo outputs already read from IO, or nullptr.
+	 * @param mixer_status	Mixer limit flags already read from IO, or nullptr.
 	 */
-	int			io_publish_pwm_outputs();
+	int			io_publish_pwm_outputs(const uint16_t *servos = nullptr, const uint16_t *mixer_status = nullptr);
 
 	/**
 	 * write register(s)
@@ -428,9 +445,9 @@ private:
 	int			io_reg_modify(uint8_t page, uint8_t offset, uint16_t clearbits, uint16_t setbits);
 
 	/**
-	 * Send mixer definition text to IO
+	 * Send precompiled mixers to IO
 	 */
-	int			mixer_send(const char *buf, unsigned buflen, unsigned retries = 3);
+	int			mixer_send(const uint8_t *buf, unsigned buflen, unsigned retries = 3);
 
 	/**
 	 * Handle a status update from IO.
@@ -507,7 +524,8 @@ PX4IO::PX4IO(device::Device *interface) :
 	_mavlink_fd(-1),
 	_perf_update(perf_alloc(PC_ELAPSED, "io update")),
 	_perf_write(perf_alloc(PC_ELAPSED, "io write")),
-	_perf_sample_latency(perf_alloc(PC_ELAPSED, "io latency")),
+	_perf_sample_latency(perf_alloc(PC_LATENCY, "io latency")),
+	_last_sample_time(0),
 	_status(0),
 	_alarms(0),
 	_t_actuator_controls_0(-1),
@@ -981,14 +999,8 @@ PX4IO::task_main()
 			/* run at 50Hz */
 			poll_last = now;
 
-			/* pull status and alarms from IO */
-			io_get_status();
-
-			/* get raw R/C input from IO */
-			io_publish_raw_rc();
-
-			/* fetch PWM outputs from IO */
-			io_publish_pwm_outputs();
+			/* pull status, alarms, raw R/C input and PWM outputs from IO */
+			io_poll();
 		}
 
 		if (now >= orb_check_last + ORB_CHECK_INTERVAL) {
@@ -1224,7 +1236,6 @@ PX4IO::io_set_control_state(unsigned group)
 
 			if (changed) {
 				orb_copy(ORB_ID(actuator_controls_0), _t_actuator_controls_0, &controls);
-				perf_set(_perf_sample_latency, hrt_elapsed_time(&controls.timestamp_sample));
 			}
 		}
 		break;
@@ -1284,7 +1295,15 @@ PX4IO::io_set_control_state(unsigned group)
 	}
 
 	/* copy values to registers in IO */
-	return io_reg_set(PX4IO_PAGE_CONTROLS, group * PX4IO_PROTOCOL_MAX_CONTROL_COUNT, regs, _max_controls);
+	int ret = io_reg_set(PX4IO_PAGE_CONTROLS, group * PX4IO_PROTOCOL_MAX_CONTROL_COUNT, regs, _max_controls);
+
+	/* IO mixes and updates its outputs as soon as the controls arrive */
+	if (ret == OK && changed && group == 0 && controls.timestamp_sample != 0) {
+		_last_sample_time = controls.timestamp_sample;
+		perf_set(_perf_sample_latency, hrt_elapsed_time(&controls.timestamp_sample));
+	}
+
+	return ret;
 }
 
 
@@ -1681,19 +1700,24 @@ PX4IO::io_handle_vservo(uint16_t vservo, uint16_t vrssi)
 }
 
 int
-PX4IO::io_get_status()
+PX4IO::io_get_status(const uint16_t *prefetched)
 {
-	uint16_t	regs[6];
-	int		ret;
+	uint16_t	buf[6];
+	const uint16_t	*regs = prefetched;
+	int		ret = OK;
 
-	/* get
-	 * STATUS_FLAGS, STATUS_ALARMS, STATUS_VBATT, STATUS_IBATT,
-	 * STATUS_VSERVO, STATUS_VRSSI, STATUS_PRSSI
-	 * in that order */
-	ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_FLAGS, &regs[0], sizeof(regs) / sizeof(regs[0]));
+	if (regs == nullptr) {
+		/* get
+		 * STATUS_FLAGS, STATUS_ALARMS, STATUS_VBATT, STATUS_IBATT,
+		 * STATUS_VSERVO, STATUS_VRSSI, STATUS_PRSSI
+		 * in that order */
+		ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_FLAGS, &buf[0], sizeof(buf) / sizeof(buf[0]));
 
-	if (ret != OK) {
-		return ret;
+		if (ret != OK) {
+			return ret;
+		}
+
+		regs = &buf[0];
 	}
 
 	io_handle_status(regs[0]);
@@ -1711,7 +1735,36 @@ PX4IO::io_get_status()
 }
 
 int
-PX4IO::io_get_raw_rc_input(rc_input_values &input_rc)
+PX4IO::io_poll()
+{
+	uint16_t regs[PX4IO_P_POLL_COUNT];
+
+	/* one transfer for what used to take three or four */
+	int ret = io_reg_get(PX4IO_PAGE_POLL, 0, regs, PX4IO_P_POLL_COUNT);
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	io_get_status(&regs[PX4IO_P_POLL_STATUS]);
+
+	/* uses the R/C source flags io_get_status() just stored */
+	io_publish_raw_rc(&regs[PX4IO_P_POLL_RAW_RC]);
+
+	/* the servo slots hold up to PX4IO_P_POLL_SERVO_COUNT outputs */
+	if (_max_actuators <= PX4IO_P_POLL_SERVO_COUNT) {
+		io_publish_pwm_outputs(&regs[PX4IO_P_POLL_SERVOS],
+				       &regs[PX4IO_P_POLL_STATUS + PX4IO_P_STATUS_MIXER - PX4IO_P_STATUS_FLAGS]);
+
+	} else {
+		io_publish_pwm_outputs();
+	}
+
+	return OK;
+}
+
+int
+PX4IO::io_get_raw_rc_input(rc_input_values &input_rc, const uint16_t *prefetched)
 {
 	uint32_t channel_count;
 	int	ret;
@@ -1727,10 +1780,16 @@ PX4IO::io_get_raw_rc_input(rc_input_values &input_rc)
 	 *
 	 * This should be the common case (9 channel R/C control being a reasonable upper bound).
 	 */
-	ret = io_reg_get(PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_COUNT, &regs[0], prolog + 9);
+	if (prefetched != nullptr) {
+		memcpy(&regs[0], prefetched, (prolog + 9) * sizeof(regs[0]));
+		ret = OK;
 
-	if (ret != OK) {
-		return ret;
+	} else {
+		ret = io_reg_get(PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_COUNT, &regs[0], prolog + 9);
+
+		if (ret != OK) {
+			return ret;
+		}
 	}
 
 	/*
@@ -1792,7 +1851,7 @@ PX4IO::io_get_raw_rc_input(rc_input_values &input_rc)
 }
 
 int
-PX4IO::io_publish_raw_rc()
+PX4IO::io_publish_raw_rc(const uint16_t *prefetched)
 {
 
 	/* fetch values from IO */
@@ -1801,7 +1860,7 @@ PX4IO::io_publish_raw_rc()
 	/* set the RC status flag ORDER MATTERS! */
 	rc_val.rc_lost = !(_status & PX4IO_P_STATUS_FLAGS_RC_OK);
 
-	int ret = io_get_raw_rc_input(rc_val);
+	int ret = io_get_raw_rc_input(rc_val, prefetched);
 
 	if (ret != OK) {
 		return ret;
@@ -1842,25 +1901,32 @@ PX4IO::io_publish_raw_rc()
 }
 
 int
-PX4IO::io_publish_pwm_outputs()
+PX4IO::io_publish_pwm_outputs(const uint16_t *servos, const uint16_t *mixer_status)
 {
 	/* data we are going to fetch */
 	actuator_outputs_s outputs;
 	multirotor_motor_limits_s motor_limits;
 
 	outputs.timestamp = hrt_absolute_time();
+	outputs.timestamp_sample = _last_sample_time;
 
 	/* get servo values from IO */
 	uint16_t ctl[_max_actuators];
-	int ret = io_reg_get(PX4IO_PAGE_SERVOS, 0, ctl, _max_actuators);
+	int ret = OK;
 
-	if (ret != OK) {
-		return ret;
+	if (servos == nullptr) {
+		ret = io_reg_get(PX4IO_PAGE_SERVOS, 0, ctl, _max_actuators);
+
+		if (ret != OK) {
+			return ret;
+		}
+
+		servos = &ctl[0];
 	}
 
 	/* convert from register format to float */
 	for (unsigned i = 0; i < _max_actuators; i++) {
-		outputs.output[i] = ctl[i];
+		outputs.output[i] = servos[i];
 	}
 
 	outputs.noutputs = _max_actuators;
@@ -1876,14 +1942,20 @@ PX4IO::io_publish_pwm_outputs()
 	}
 
 	/* get mixer status flags from IO */
-	uint16_t mixer_status;
-	ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &mixer_status, sizeof(mixer_status) / sizeof(uint16_t));
-	memcpy(&motor_limits, &mixer_status, sizeof(motor_limits));
+	uint16_t status;
 
-	if (ret != OK) {
-		return ret;
+	if (mixer_status == nullptr) {
+		ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &status, sizeof(status) / sizeof(uint16_t));
+
+		if (ret != OK) {
+			return ret;
+		}
+
+		mixer_status = &status;
 	}
 
+	memcpy(&motor_limits, mixer_status, sizeof(motor_limits));
+
 	/* publish mixer status */
 	if (_to_mixer_status == nullptr) {
 		_to_mixer_status = orb_advertise(ORB_ID(multirotor_motor_limits), &motor_limits);
@@ -2014,7 +2086,7 @@ PX4IO::print_debug()
 }
 
 int
-PX4IO::mixer_send(const char *buf, unsigned buflen, unsigned retries)
+PX4IO::mixer_send(const uint8_t *buf, unsigned buflen, unsigned retries)
 {
 	/* get debug level */
 	int debuglevel = io_reg_get(PX4IO_PAGE_SETUP, PX4IO_P_SETUP_SET_DEBUG);
@@ -2029,33 +2101,32 @@ PX4IO::mixer_send(const char *buf, unsigned buflen, unsigned retries)
 		msg->f2i_mixer_magic = F2I_MIXER_MAGIC;
 		msg->action = F2I_MIXER_ACTION_RESET;
 
+		/* start over from the beginning on every retry */
+		const uint8_t *data = buf;
+		unsigned remaining = buflen;
+
 		do {
-			unsigned count = buflen;
+			unsigned count = remaining;
 
 			if (count > max_len) {
 				count = max_len;
 			}
 
-			if (count > 0) {
-				memcpy(&msg->text[0], buf, count);
-				buf += count;
-				buflen -= count;
-
-			} else {
-				continue;
-			}
+			memcpy(&msg->data[0], data, count);
+			data += count;
+			remaining -= count;
 
 			/*
 			 * We have to send an even number of bytes.  This
 			 * will only happen on the very last transfer of a
 			 * mixer, and we are guaranteed that there will be
 			 * space left to round up as _max_transfer will be
-			 * even.
+			 * even. IO skips the zero padding.
 			 */
 			unsigned total_len = sizeof(px4io_mixdata) + count;
 
 			if (total_len % 2) {
-				msg->text[count] = '\0';
+				msg->data[count] = '\0';
 				total_len++;
 			}
 
@@ -2076,7 +2147,7 @@ PX4IO::mixer_send(const char *buf, unsigned buflen, unsigned retries)
 			/* print mixer chunk */
 			if (debuglevel > 5 || ret) {
 
-				warnx("fmu sent: \"%s\"", msg->text);
+				warnx("fmu sent %u mixer bytes", count);
 
 				/* read IO's output */
 				print_debug();
@@ -2089,29 +2160,7 @@ PX4IO::mixer_send(const char *buf, unsigned buflen, unsigned retries)
 
 			msg->action = F2I_MIXER_ACTION_APPEND;
 
-		} while (buflen > 0);
-
-		/* ensure a closing newline */
-		msg->text[0] = '\n';
-		msg->text[1] = '\0';
-
-		int ret;
-
-		for (int i = 0; i < 30; i++) {
-			/* failed, but give it a 2nd shot */
-			ret = io_reg_set(PX4IO_PAGE_MIXERLOAD, 0, (uint16_t *)frame, (sizeof(px4io_mixdata) + 2) / 2);
-
-			if (ret) {
-				usleep(333);
-
-			} else {
-				break;
-			}
-		}
-
-		if (ret) {
-			return ret;
-		}
+		} while (remaining > 0);
 
 		retries--;
 
@@ -2424,6 +2473,19 @@ PX4IO::ioctl(file *filep, int cmd, unsigned long arg)
 		*(unsigned *)arg = io_reg_get(PX4IO_PAGE_SETUP, PX4IO_P_SETUP_PWM_RATES);
 		break;
 
+	case PWM_SERVO_SET_ONESHOT_PROTOCOL:
+		if (arg > PWM_ONESHOT_PROTOCOL_MULTISHOT) {
+			ret = -EINVAL;
+			break;
+		}
+
+		ret = io_reg_set(PX4IO_PAGE_SETUP, PX4IO_P_SETUP_PWM_ONESHOT_PROTOCOL, arg);
+		break;
+
+	case PWM_SERVO_GET_ONESHOT_PROTOCOL:
+		*(uint32_t *)arg = io_reg_get(PX4IO_PAGE_SETUP, PX4IO_P_SETUP_PWM_ONESHOT_PROTOCOL);
+		break;
+
 	case PWM_SERVO_SET_FAILSAFE_PWM: {
 			struct pwm_output_values *pwm = (struct pwm_output_values *)arg;
 
@@ -2738,8 +2800,33 @@ PX4IO::ioctl(file *filep, int cmd, unsigned long arg)
 		break;
 
 	case MIXERIOCLOADBUF: {
+			/* IO only loads precompiled mixers, the text never gets longer when compiled */
 			const char *buf = (const char *)arg;
-			ret = mixer_send(buf, strnlen(buf, 2048));
+			unsigned buflen = strnlen(buf, 2048);
+			uint8_t *bin = (uint8_t *)malloc(buflen + 1);
+
+			if (bin == nullptr) {
+				ret = -ENOMEM;
+				break;
+			}
+
+			int binlen = mixer_text_to_binary(buf, buflen, bin, buflen);
+
+			if (binlen < 0) {
+				DEVICE_LOG("mixer text rejected");
+				ret = -EINVAL;
+
+			} else {
+				ret = mixer_send(bin, binlen);
+			}
+
+			free(bin);
+			break;
+		}
+
+	case MIXERIOCLOADBIN: {
+			const mixer_binary_s *bin = (const mixer_binary_s *)arg;
+			ret = mixer_send(bin->data, bin->length);
 			break;
 		}
 
@@ -97,10 +97,11 @@ private:
 	/*
 	 * XXX tune this value
 	 *
-	 * At 1.5Mbps each register takes 13.3µs, and we always transfer a full packet.
-	 * Packet overhead is 26µs for the four-byte header.
+	 * At 1.5Mbps each register takes 13.3µs, and the registers are only
+	 * transferred in one direction: write requests and read replies.
+	 * Packet overhead is 26µs for the four-byte header each way.
 	 *
-	 * 32 registers = 451µs
+	 * 32 registers = 478µs per transaction
 	 *
 	 * Maybe we can just send smaller packets (e.g. 8 regs) and loop for larger (less common)
 	 * transfers? Could cause issues with any regs expecting to be written atomically...
@@ -518,12 +519,12 @@ PX4IO_serial::_wait_complete()
 	/* start TX DMA - no callback if we also expect a reply */
 	/* DMA setup time ~3µs */
 	_dma_buffer.crc = 0;
-	_dma_buffer.crc = crc_packet(&_dma_buffer);
+	_dma_buffer.crc = crc_request(&_dma_buffer);
 	stm32_dmasetup(
 		_tx_dma,
 		PX4IO_SERIAL_BASE + STM32_USART_DR_OFFSET,
 		reinterpret_cast<uint32_t>(&_dma_buffer),
-		PKT_SIZE(_dma_buffer),
+		PKT_REQUEST_SIZE(_dma_buffer),
 		DMA_SCR_DIR_M2P		|
 		DMA_SCR_MINC		|
 		DMA_SCR_PSIZE_8BITS	|
@@ -547,7 +548,7 @@ PX4IO_serial::_wait_complete()
 		abstime.tv_nsec -= 1000 * 1000 * 1000;
 	}
 
-	/* wait for the transaction to complete - 64 bytes @ 1.5Mbps ~426µs */
+	/* wait for the transaction to complete - 72 bytes @ 1.5Mbps ~478µs */
 	int ret;
 
 	for (;;) {
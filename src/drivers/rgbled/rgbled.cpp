@@ -109,6 +109,9 @@ private:
 	int			_counter;
 	int			_param_sub;
 
+	int			_settings_sent;		/**< settings byte in the LED driver, -1 if unknown */
+	int			_pwm_sent[3];		/**< PWM values in the LED driver, -1 if unknown */
+
 	void 			set_color(rgbled_color_t ledcolor);
 	void			set_mode(rgbled_mode_t mode);
 	void			set_pattern(rgbled_pattern_t *pattern);
@@ -116,8 +119,12 @@ private:
 	static void		led_trampoline(void *arg);
 	void			led();
 
+	static float		breathe_brightness(int step);
+
 	int			send_led_enable(bool enable);
 	int			send_led_rgb();
+	int			write_settings(uint8_t settings);
+	void			get_pwm(float brightness, int pwm[3]);
 	int			get(bool &on, bool &powersave, uint8_t &r, uint8_t &g, uint8_t &b);
 	void		update_params();
 };
@@ -148,7 +155,9 @@ RGBLED::RGBLED(int bus, int rgbled) :
 	_led_interval(0),
 	_should_run(false),
 	_counter(0),
-	_param_sub(-1)
+	_param_sub(-1),
+	_settings_sent(-1),
+	_pwm_sent{-1, -1, -1}
 {
 	memset(&_work, 0, sizeof(_work));
 	memset(&_pattern, 0, sizeof(_pattern));
@@ -196,8 +205,8 @@ RGBLED::probe()
 	_retries = 4;
 
 	if ((ret=get(on, powersave, r, g, b)) != OK ||
-	    (ret=send_led_enable(false) != OK) ||
-	    (ret=send_led_enable(false) != OK)) {
+	    (ret=write_settings(SETTING_NOT_POWERSAVE) != OK) ||
+	    (ret=write_settings(SETTING_NOT_POWERSAVE) != OK)) {
 		return ret;
 	}
 
@@ -317,23 +326,36 @@ RGBLED::led()
 
 		break;
 
-	case RGBLED_MODE_BREATHE:
+	case RGBLED_MODE_BREATHE: {
 
 		if (_counter >= 62)
 			_counter = 0;
 
-		int n;
+		_brightness = breathe_brightness(_counter);
+		send_led_rgb();
+
+		/*
+		 * The LED driver only has 16 PWM steps, so most of the 25 ms steps of the
+		 * curve end up at the same output. Sleep until the first one that differs.
+		 */
+		int pwm[3];
+		int next[3];
+		get_pwm(_brightness, pwm);
+		_led_interval = 25;
+
+		while (_led_interval < 62 * 25) {
+			get_pwm(breathe_brightness((_counter + 1) % 62), next);
 
-		if (_counter < 32) {
-			n = _counter;
+			if (next[0] != pwm[0] || next[1] != pwm[1] || next[2] != pwm[2]) {
+				break;
+			}
 
-		} else {
-			n = 62 - _counter;
+			_counter = (_counter + 1) % 62;
+			_led_interval += 25;
 		}
 
-		_brightness = n * n / (31.0f * 31.0f);
-		send_led_rgb();
 		break;
+	}
 
 	case RGBLED_MODE_PATTERN:
 
@@ -344,6 +366,14 @@ RGBLED::led()
 		set_color(_pattern.color[_counter]);
 		send_led_rgb();
 		_led_interval = _pattern.duration[_counter];
+
+		/* frames of the same colour are shown as one */
+		while (_counter + 1 < RGBLED_PATTERN_LENGTH && _pattern.duration[_counter + 1] > 0
+		       && _pattern.color[_counter + 1] == _pattern.color[_counter]) {
+			_counter++;
+			_led_interval += _pattern.duration[_counter];
+		}
+
 		break;
 
 	default:
@@ -356,6 +386,17 @@ RGBLED::led()
 	work_queue(LPWORK, &_work, (worker_t)&RGBLED::led_trampoline, this, _led_interval);
 }
 
+/**
+ * Brightness of a step of the 62 step breathe curve
+ */
+float
+RGBLED::breathe_brightness(int step)
+{
+	int n = (step < 32) ? step : 62 - step;
+
+	return n * n / (31.0f * 31.0f);
+}
+
 /**
  * Parse color constant and set _r _g _b values
  */
@@ -542,7 +583,7 @@ RGBLED::set_pattern(rgbled_pattern_t *pattern)
 }
 
 /**
- * Sent ENABLE flag to LED driver
+ * Sent ENABLE flag to LED driver, if it changed
  */
 int
 RGBLED::send_led_enable(bool enable)
@@ -554,24 +595,67 @@ RGBLED::send_led_enable(bool enable)
 
 	settings_byte |= SETTING_NOT_POWERSAVE;
 
-	const uint8_t msg[2] = { SUB_ADDR_SETTINGS, settings_byte};
+	if (settings_byte == _settings_sent) {
+		return OK;
+	}
 
-	return transfer(msg, sizeof(msg), nullptr, 0);
+	return write_settings(settings_byte);
 }
 
 /**
- * Send RGB PWM settings to LED driver according to current color and brightness
+ * Write the settings byte to the LED driver
  */
 int
-RGBLED::send_led_rgb()
+RGBLED::write_settings(uint8_t settings)
+{
+	const uint8_t msg[2] = { SUB_ADDR_SETTINGS, settings};
+
+	int ret = transfer(msg, sizeof(msg), nullptr, 0);
+
+	/* after a failure the state of the LED driver is unknown */
+	_settings_sent = (ret == OK) ? settings : -1;
+
+	return ret;
+}
+
+/**
+ * PWM values for the current color at the given brightness
+ */
+void
+RGBLED::get_pwm(float brightness, int pwm[3])
 {
 	/* To scale from 0..255 -> 0..15 shift right by 4 bits */
+	pwm[0] = static_cast<uint8_t>((_b >> 4) * brightness * _max_brightness + 0.5f);
+	pwm[1] = static_cast<uint8_t>((_g >> 4) * brightness * _max_brightness + 0.5f);
+	pwm[2] = static_cast<uint8_t>((_r >> 4) * brightness * _max_brightness + 0.5f);
+}
+
+/**
+ * Send RGB PWM settings to LED driver according to current color and brightness, if they changed
+ */
+int
+RGBLED::send_led_rgb()
+{
+	int pwm[3];
+	get_pwm(_brightness, pwm);
+
+	if (pwm[0] == _pwm_sent[0] && pwm[1] == _pwm_sent[1] && pwm[2] == _pwm_sent[2]) {
+		return OK;
+	}
+
 	const uint8_t msg[6] = {
-		SUB_ADDR_PWM0, static_cast<uint8_t>((_b >> 4) * _brightness * _max_brightness + 0.5f),
-		SUB_ADDR_PWM1, static_cast<uint8_t>((_g >> 4) * _brightness * _max_brightness + 0.5f),
-		SUB_ADDR_PWM2, static_cast<uint8_t>((_r >> 4) * _brightness * _max_brightness + 0.5f)
+		SUB_ADDR_PWM0, static_cast<uint8_t>(pwm[0]),
+		SUB_ADDR_PWM1, static_cast<uint8_t>(pwm[1]),
+		SUB_ADDR_PWM2, static_cast<uint8_t>(pwm[2])
 	};
-	return transfer(msg, sizeof(msg), nullptr, 0);
+
+	int ret = transfer(msg, sizeof(msg), nullptr, 0);
+
+	for (unsigned i = 0; i < 3; i++) {
+		_pwm_sent[i] = (ret == OK) ? pwm[i] : -1;
+	}
+
+	return ret;
 }
 
 int
@@ -72,7 +72,10 @@ RoboClaw::RoboClaw(const char *deviceName, uint16_t address,
 	_motor1Overflow(0),
 	_motor2Position(0),
 	_motor2Speed(0),
-	_motor2Overflow(0)
+	_motor2Overflow(0),
+	_readInterval(0),
+	_lastRead(0),
+	_lastPosition(0)
 {
 	// setup control polling
 	_controlPoll.fd = _actuators.getHandle();
@@ -112,10 +115,8 @@ int RoboClaw::readEncoder(e_motor motor)
 	} else if (motor == MOTOR_2) {
 		_sendCommand(CMD_READ_ENCODER_2, nullptr, 0, sum);
 	}
-	uint8_t rbuf[50];
-	usleep(5000);
-	int nread = read(_uart, rbuf, 50);
-	if (nread < 6) {
+	uint8_t rbuf[6];
+	if (_readReply(rbuf, sizeof(rbuf)) < 0) {
 		printf("failed to read\n");
 		return -1;
 	}
@@ -243,6 +244,26 @@ int RoboClaw::setMotorDutyCycle(e_motor motor, float value)
 	return -1;
 }
 
+int RoboClaw::setMotorDutyCycles(float value1, float value2)
+{
+	uint16_t sum = 0;
+	// bound
+	if (value1 > 1) value1 = 1;
+	if (value1 < -1) value1 = -1;
+	if (value2 > 1) value2 = 1;
+	if (value2 < -1) value2 = -1;
+	// _sendCommand sends the data bytes in reverse,
+	// so motor 2 goes first to put motor 1 first on the wire
+	int16_t duty[2] = {int16_t(1500*value2), int16_t(1500*value1)};
+	return _sendCommand(CMD_SIGNED_DUTYCYCLE_12,
+			(uint8_t *)(&duty[0]), sizeof(duty), sum);
+}
+
+void RoboClaw::setReadInterval(unsigned interval_ms)
+{
+	_readInterval = interval_ms * 1000ULL;
+}
+
 int RoboClaw::resetEncoders()
 {
 	uint16_t sum = 0;
@@ -261,8 +282,29 @@ int RoboClaw::update()
 	// if new data, send to motors
 	if (_actuators.updated()) {
 		_actuators.update();
-		setMotorDutyCycle(MOTOR_1,_actuators.control[CH_VOLTAGE_LEFT]);
-		setMotorDutyCycle(MOTOR_2,_actuators.control[CH_VOLTAGE_RIGHT]);
+		setMotorDutyCycles(_actuators.control[CH_VOLTAGE_LEFT],
+				_actuators.control[CH_VOLTAGE_RIGHT]);
+	}
+
+	// refresh the encoder readings at the read interval
+	// instead of every cycle, the speed is the rate
+	// of the position between two refreshes
+	hrt_abstime now = hrt_absolute_time();
+	if (_readInterval > 0 && now - _lastRead >= _readInterval) {
+		float position1 = _motor1Position;
+		float position2 = _motor2Position;
+		_lastRead = now;
+		if (readEncoder(MOTOR_1) == 0 && readEncoder(MOTOR_2) == 0) {
+			if (_lastPosition > 0) {
+				float dt = (now - _lastPosition) / 1e6f;
+				_motor1Speed = (_motor1Position - position1) / dt;
+				_motor2Speed = (_motor2Position - position2) / dt;
+			}
+			_lastPosition = now;
+		} else {
+			// the speed needs two readings in a row
+			_lastPosition = 0;
+		}
 	}
 	return 0;
 }
@@ -282,7 +324,9 @@ uint16_t RoboClaw::_sumBytes(uint8_t * buf, size_t n)
 int RoboClaw::_sendCommand(e_command cmd, uint8_t * data,
 		size_t n_data, uint16_t & prev_sum)
 {
-	tcflush(_uart, TCIOFLUSH); // flush  buffers
+	// drop stale replies, but keep the commands
+	// still in the output buffer
+	tcflush(_uart, TCIFLUSH);
 	uint8_t buf[n_data + 3];
 	buf[0] = _address;
 	buf[1] = cmd;
@@ -300,6 +344,26 @@ int RoboClaw::_sendCommand(e_command cmd, uint8_t * data,
 	return write(_uart, buf, n_data + 3);
 }
 
+int RoboClaw::_readReply(uint8_t * buf, size_t n)
+{
+	// wait for the bytes as they come in rather than
+	// sleeping for the worst case reply time
+	struct pollfd fds;
+	fds.fd = _uart;
+	fds.events = POLLIN;
+	hrt_abstime start = hrt_absolute_time();
+	size_t nread = 0;
+	while (nread < n) {
+		int elapsed = hrt_absolute_time() - start;
+		if (elapsed >= reply_timeout) return -1;
+		if (::poll(&fds, 1, (reply_timeout - elapsed) / 1000 + 1) <= 0) return -1;
+		int ret = read(_uart, buf + nread, n - nread);
+		if (ret <= 0) return -1;
+		nread += ret;
+	}
+	return nread;
+}
+
 int roboclawTest(const char *deviceName, uint8_t address,
 		uint16_t pulsesPerRev)
 {
@@ -105,6 +105,18 @@ public:
 	 */
 	int setMotorDutyCycle(e_motor motor, float value);
 
+	/**
+	 * set the duty cycle of both motors in one packet
+	 */
+	int setMotorDutyCycles(float value1, float value2);
+
+	/**
+	 * set the interval at which update() refreshes
+	 * the encoder readings, 0 disables it
+	 * @param interval_ms interval, ms
+	 */
+	void setReadInterval(unsigned interval_ms);
+
 	/**
 	 * reset the encoders
 	 * @return status
@@ -113,7 +125,8 @@ public:
 
 	/**
 	 * main update loop that updates RoboClaw motor
-	 * dutycycle based on actuator publication
+	 * dutycycle based on actuator publication,
+	 * and the encoder readings at the read interval
 	 */
 	int update();
 
@@ -156,8 +169,12 @@ private:
 		CMD_READ_SPEED_HIRES_2 = 31, 
 		CMD_SIGNED_DUTYCYCLE_1 = 32,
 		CMD_SIGNED_DUTYCYCLE_2 = 33,
+		CMD_SIGNED_DUTYCYCLE_12 = 34,
 	};
 
+	/** time the reply to a read command may take, us */
+	static const int reply_timeout = 10000;
+
 	static uint8_t checksum_mask;
 
 	uint16_t _address;
@@ -180,9 +197,15 @@ private:
 	float _motor2Speed;
 	int16_t _motor2Overflow;
 
+	// encoder readings cache
+	uint64_t _readInterval;
+	uint64_t _lastRead;
+	uint64_t _lastPosition;
+
 	// private methods
 	uint16_t _sumBytes(uint8_t * buf, size_t n);
 	int _sendCommand(e_command cmd, uint8_t * data, size_t n_data, uint16_t & prev_sum);
+	int _readReply(uint8_t * buf, size_t n);
 };
 
 // unit testing
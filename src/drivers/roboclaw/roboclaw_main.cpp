@@ -166,19 +166,25 @@ int roboclaw_thread_main(int argc, char *argv[])
 	argv +=2;
 
 	if (argc < 3) {
-		printf("usage: roboclaw start device address\n");
+		printf("usage: roboclaw start device address pulses_per_rev [read_interval_ms]\n");
 		return -1;
 	}
 
 	const char *deviceName = argv[1];
 	uint8_t address = strtoul(argv[2], nullptr, 0);
 	uint16_t pulsesPerRev = strtoul(argv[3], nullptr, 0);
+	unsigned readInterval = 100;
 
-	printf("device:\t%s\taddress:\t%d\tpulses per rev:\t%ld\n",
-			deviceName, address, pulsesPerRev);
+	if (argc > 4) {
+		readInterval = strtoul(argv[4], nullptr, 0);
+	}
+
+	printf("device:\t%s\taddress:\t%d\tpulses per rev:\t%ld\tread interval:\t%u ms\n",
+			deviceName, address, pulsesPerRev, readInterval);
 
 	// start
 	RoboClaw roboclaw(deviceName, address, pulsesPerRev);
+	roboclaw.setReadInterval(readInterval);
 
 	thread_running = true;
 
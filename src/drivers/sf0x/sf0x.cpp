@@ -66,6 +66,7 @@
 #include <drivers/drv_range_finder.h>
 #include <drivers/device/device.h>
 #include <drivers/device/ringbuffer.h>
+#include <drivers/device/rangefinder_rate.h>
 
 #include <uORB/uORB.h>
 #include <uORB/topics/subsystem_info.h>
@@ -122,6 +123,7 @@ private:
 	ringbuffer::RingBuffer		*_reports;
 	bool				_sensor_ok;
 	int				_measure_ticks;
+	device::RangefinderRate		_rate;
 	bool				_collect_phase;
 	int				_fd;
 	char				_linebuf[10];
@@ -193,6 +195,7 @@ SF0X::SF0X(const char *port) :
 	_reports(nullptr),
 	_sensor_ok(false),
 	_measure_ticks(0),
+	_rate(USEC2TICK(RANGEFINDER_IDLE_INTERVAL)),
 	_collect_phase(false),
 	_fd(-1),
 	_linebuf_index(0),
@@ -704,17 +707,20 @@ SF0X::cycle()
 		/* next phase is measurement */
 		_collect_phase = false;
 
+		/* slower while idle */
+		unsigned ticks = _rate.interval(_measure_ticks, is_open());
+
 		/*
 		 * Is there a collect->measure gap?
 		 */
-		if (_measure_ticks > USEC2TICK(SF0X_CONVERSION_INTERVAL)) {
+		if (ticks > USEC2TICK(SF0X_CONVERSION_INTERVAL)) {
 
 			/* schedule a fresh cycle call when we are ready to measure again */
 			work_queue(HPWORK,
 				   &_work,
 				   (worker_t)&SF0X::cycle_trampoline,
 				   this,
-				   _measure_ticks - USEC2TICK(SF0X_CONVERSION_INTERVAL));
+				   ticks - USEC2TICK(SF0X_CONVERSION_INTERVAL));
 
 			return;
 		}
@@ -742,7 +748,7 @@ SF0X::print_info()
 	perf_print_counter(_sample_perf);
 	perf_print_counter(_comms_errors);
 	perf_print_counter(_buffer_overflows);
-	printf("poll interval:  %d ticks\n", _measure_ticks);
+	printf("poll interval:  %d ticks%s\n", _measure_ticks, _rate.idle() ? " (idle)" : "");
 	_reports->print_info("report queue");
 }
 
@@ -38,6 +38,11 @@
  *
  * This is a low-rate driver, designed for sampling things like voltages
  * and so forth. It avoids the gross complexity of the NuttX ADC driver.
+ *
+ * The channel set is scanned continuously into a circular DMA buffer. The
+ * readings are the average of every sample since the previous 100Hz tick,
+ * and the integral of each channel over time (for coulomb counting) is
+ * available through ADCIOCGINTEGRAL.
  */
 
 #include <px4_config.h>
@@ -61,6 +66,7 @@
 #include <arch/stm32/chip.h>
 #include <stm32.h>
 #include <stm32_gpio.h>
+#include <stm32_dma.h>
 
 #include <systemlib/err.h>
 #include <systemlib/perf_counter.h>
@@ -109,18 +115,25 @@ public:
 	virtual int		ioctl(file *filp, int cmd, unsigned long arg);
 	virtual ssize_t		read(file *filp, char *buffer, size_t len);
 
-protected:
-	virtual int		open_first(struct file *filp);
-	virtual int		close_last(struct file *filp);
-
 private:
 	static const hrt_abstime _tickrate = 10000;	/**< 100Hz base rate */
+	static const unsigned	_max_channels = 16;	/**< length limit of the regular sequence */
+	static const unsigned	_scans_per_half = 16;	/**< scans of the channel set per DMA half transfer */
 
 	hrt_call		_call;
 	perf_counter_t		_sample_perf;
+	perf_counter_t		_dma_errors;
 
 	unsigned		_channel_count;
-	adc_msg_s		*_samples;		/**< sample buffer */
+	adc_msg_s		*_samples;		/**< sample buffer, averaged over the last tick */
+
+	DMA_HANDLE		_dma;
+	static uint16_t		_dma_buffer[2 * _scans_per_half * _max_channels];	/**< static to ensure DMA-able memory */
+
+	uint32_t		_sum[_max_channels];	/**< sum of the samples since the last tick */
+	volatile uint32_t	_scans;			/**< number of scans in _sum */
+	uint64_t		_integral[_max_channels];	/**< samples times their period since start, counts * us */
+	hrt_abstime		_last_tick;		/**< time the samples in _integral run up to */
 
 	orb_advert_t		_to_system_power;
 
@@ -130,26 +143,37 @@ private:
 	/** worker function */
 	void			_tick();
 
+	/** DMA half and full transfer handler */
+	static void		_dma_callback(DMA_HANDLE handle, uint8_t status, void *arg);
+
 	/**
-	 * Sample a single channel and return the measured value.
+	 * Add one half of the DMA buffer to the sums.
 	 *
-	 * @param channel		The channel to sample.
-	 * @return			The sampled value, or 0xffff if
-	 *				sampling failed.
+	 * @param scans			The first sample of the half.
 	 */
-	uint16_t		_sample(unsigned channel);
+	void			_accumulate(const uint16_t *scans);
 
 	// update system_power ORB topic, only on FMUv2
 	void update_system_power(void);
 };
 
+uint16_t ADC::_dma_buffer[2 * _scans_per_half * _max_channels];
+
 ADC::ADC(uint32_t channels) :
 	CDev("adc", ADC0_DEVICE_PATH),
 	_sample_perf(perf_alloc(PC_ELAPSED, "adc_samples")),
+	_dma_errors(perf_alloc(PC_COUNT, "adc_dma_errors")),
 	_channel_count(0),
 	_samples(nullptr),
+	_dma(nullptr),
+	_sum{},
+	_scans(0),
+	_integral{},
+	_last_tick(0),
 	_to_system_power(nullptr)
 {
+	memset(&_call, 0, sizeof(_call));
+
 	_debug_enabled = true;
 
 	/* always enable the temperature sensor */
@@ -157,7 +181,7 @@ ADC::ADC(uint32_t channels) :
 
 	/* allocate the sample array */
 	for (unsigned i = 0; i < 32; i++) {
-		if (channels & (1 << i)) {
+		if ((channels & (1 << i)) && _channel_count < _max_channels) {
 			_channel_count++;
 		}
 	}
@@ -168,7 +192,7 @@ ADC::ADC(uint32_t channels) :
 	if (_samples != nullptr) {
 		unsigned index = 0;
 
-		for (unsigned i = 0; i < 32; i++) {
+		for (unsigned i = 0; i < 32 && index < _channel_count; i++) {
 			if (channels & (1 << i)) {
 				_samples[index].am_channel = i;
 				_samples[index].am_data = 0;
@@ -180,14 +204,29 @@ ADC::ADC(uint32_t channels) :
 
 ADC::~ADC()
 {
+	hrt_cancel(&_call);
+
+	if (_dma != nullptr) {
+		rCR2 &= ~(ADC_CR2_ADON | ADC_CR2_DMA);
+		stm32_dmastop(_dma);
+		stm32_dmafree(_dma);
+	}
+
 	if (_samples != nullptr) {
 		delete _samples;
 	}
+
+	perf_free(_sample_perf);
+	perf_free(_dma_errors);
 }
 
 int
 ADC::init()
 {
+	if (_samples == nullptr) {
+		return -ENOMEM;
+	}
+
 	/* do calibration if supported */
 #ifdef ADC_CR2_CAL
 	rCR2 |= ADC_CR2_CAL;
@@ -199,30 +238,62 @@ ADC::init()
 
 #endif
 
-	/* arbitrarily configure all channels for 55 cycle sample time */
-	rSMPR1 = 0b00000011011011011011011011011011;
-	rSMPR2 = 0b00011011011011011011011011011011;
+	/*
+	 * Configure all channels for the longest sample time, 480 cycles. This
+	 * suits the high impedance dividers of the battery monitors and keeps
+	 * a scan of the channel set in the 100us range, so the DMA interrupt
+	 * runs at a few hundred Hz.
+	 */
+	rSMPR1 = 0b00000111111111111111111111111111;
+	rSMPR2 = 0b00111111111111111111111111111111;
 
 	/* XXX for F2/4, might want to select 12-bit mode? */
-	rCR1 = 0;
+	rCR1 = ADC_CR1_SCAN;
 
-	/* enable the temperature sensor / Vrefint channel if supported*/
+	/* convert the channel set continuously, and have every result transferred by DMA */
 	rCR2 =
 #ifdef ADC_CR2_TSVREFE
 		/* enable the temperature sensor in CR2 */
 		ADC_CR2_TSVREFE |
 #endif
-		0;
+		ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_DDS;
 
 #ifdef ADC_CCR_TSVREFE
 	/* enable temperature sensor in CCR */
 	rCCR = ADC_CCR_TSVREFE;
 #endif
 
-	/* configure for a single-channel sequence */
-	rSQR1 = 0;
-	rSQR2 = 0;
-	rSQR3 = 0;	/* will be updated with the channel each tick */
+	/* configure the regular sequence for the channel set, six channels per SQR register */
+	uint32_t sqr[3] = {0, 0, 0};
+
+	for (unsigned i = 0; i < _channel_count; i++) {
+		sqr[i / 6] |= _samples[i].am_channel << ((i % 6) * 5);
+	}
+
+	rSQR1 = sqr[2] | ((_channel_count - 1) << ADC_SQR1_L_SHIFT);
+	rSQR2 = sqr[1];
+	rSQR3 = sqr[0];
+
+	/* the DMA fills the two halves of the buffer in turn, interrupting at each */
+	_dma = stm32_dmachannel(ADC_DMAMAP);
+
+	if (_dma == nullptr) {
+		DEVICE_LOG("no DMA stream");
+		return -1;
+	}
+
+	stm32_dmasetup(
+		_dma,
+		STM32_ADC1_BASE + STM32_ADC_DR_OFFSET,
+		reinterpret_cast<uint32_t>(&_dma_buffer[0]),
+		2 * _scans_per_half * _channel_count,
+		DMA_SCR_DIR_P2M		|
+		DMA_SCR_MINC		|
+		DMA_SCR_PSIZE_16BITS	|
+		DMA_SCR_MSIZE_16BITS	|
+		DMA_SCR_CIRC		|
+		DMA_SCR_PRIMED);
+	stm32_dmastart(_dma, _dma_callback, this, true);
 
 	/* power-cycle the ADC and turn it on */
 	rCR2 &= ~ADC_CR2_ADON;
@@ -232,19 +303,24 @@ ADC::init()
 	rCR2 |= ADC_CR2_ADON;
 	usleep(10);
 
-	/* kick off a sample and wait for it to complete */
-	hrt_abstime now = hrt_absolute_time();
+	/* kick off the conversions and wait for the first half of the buffer */
+	_last_tick = hrt_absolute_time();
 	rCR2 |= ADC_CR2_SWSTART;
 
-	while (!(rSR & ADC_SR_EOC)) {
+	while (_scans == 0) {
 
-		/* don't wait for more than 500us, since that means something broke - should reset here if we see this */
-		if ((hrt_absolute_time() - now) > 500) {
+		/* a half takes a few ms, don't wait for more than 20ms, since that means something broke */
+		if ((hrt_absolute_time() - _last_tick) > 20000) {
 			DEVICE_LOG("sample timeout");
 			return -1;
 		}
+
+		usleep(1000);
 	}
 
+	/* get fresh data, and schedule regular updates */
+	_tick();
+	hrt_call_every(&_call, _tickrate, _tickrate, _tick_trampoline, this);
 
 	DEVICE_DEBUG("init done");
 
@@ -255,7 +331,27 @@ ADC::init()
 int
 ADC::ioctl(file *filp, int cmd, unsigned long arg)
 {
-	return -ENOTTY;
+	switch (cmd) {
+	case ADCIOCGINTEGRAL: {
+			struct adc_integral_s *integral = (struct adc_integral_s *)arg;
+
+			for (unsigned i = 0; i < _channel_count; i++) {
+				if (_samples[i].am_channel == integral->channel) {
+					/* block interrupts while copying, the integral is 64 bits */
+					irqstate_t flags = irqsave();
+					integral->integral = _integral[i];
+					integral->timestamp = _last_tick;
+					irqrestore(flags);
+					return OK;
+				}
+			}
+
+			return -EINVAL;
+		}
+
+	default:
+		return -ENOTTY;
+	}
 }
 
 ssize_t
@@ -275,40 +371,81 @@ ADC::read(file *filp, char *buffer, size_t len)
 	return len;
 }
 
-int
-ADC::open_first(struct file *filp)
+void
+ADC::_tick_trampoline(void *arg)
 {
-	/* get fresh data */
-	_tick();
-
-	/* and schedule regular updates */
-	hrt_call_every(&_call, _tickrate, _tickrate, _tick_trampoline, this);
-
-	return 0;
+	(reinterpret_cast<ADC *>(arg))->_tick();
 }
 
-int
-ADC::close_last(struct file *filp)
+void
+ADC::_tick()
 {
-	hrt_cancel(&_call);
-	return 0;
+	hrt_abstime now = hrt_absolute_time();
+
+	/* block the DMA interrupt while taking the sums */
+	irqstate_t flags = irqsave();
+
+	/*
+	 * Publish the average of every sample since the last tick, and add it
+	 * to the integrals for the time it covers. If no half completed since
+	 * the last tick the next one covers both intervals.
+	 */
+	if (_scans > 0) {
+		hrt_abstime dt = now - _last_tick;
+
+		for (unsigned i = 0; i < _channel_count; i++) {
+			_samples[i].am_data = (_sum[i] + _scans / 2) / _scans;
+			_integral[i] += (uint64_t)_sum[i] * dt / _scans;
+			_sum[i] = 0;
+		}
+
+		_scans = 0;
+		_last_tick = now;
+	}
+
+	irqrestore(flags);
+
+	update_system_power();
 }
 
 void
-ADC::_tick_trampoline(void *arg)
+ADC::_dma_callback(DMA_HANDLE handle, uint8_t status, void *arg)
 {
-	(reinterpret_cast<ADC *>(arg))->_tick();
+	ADC *adc = reinterpret_cast<ADC *>(arg);
+
+	if (status & DMA_STATUS_ERROR) {
+		perf_count(adc->_dma_errors);
+		return;
+	}
+
+	/* the half transfer is the first half of the buffer, the transfer complete the second one */
+	if (status & DMA_STATUS_HTIF) {
+		adc->_accumulate(&_dma_buffer[0]);
+	}
+
+	if (status & DMA_STATUS_TCIF) {
+		adc->_accumulate(&_dma_buffer[_scans_per_half * adc->_channel_count]);
+	}
 }
 
 void
-ADC::_tick()
+ADC::_accumulate(const uint16_t *scans)
 {
-	/* scan the channel set and sample each */
-	for (unsigned i = 0; i < _channel_count; i++) {
-		_samples[i].am_data = _sample(_samples[i].am_channel);
+	perf_begin(_sample_perf);
+
+	irqstate_t flags = irqsave();
+
+	for (unsigned s = 0; s < _scans_per_half; s++) {
+		for (unsigned i = 0; i < _channel_count; i++) {
+			_sum[i] += *scans++;
+		}
 	}
 
-	update_system_power();
+	_scans += _scans_per_half;
+
+	irqrestore(flags);
+
+	perf_end(_sample_perf);
 }
 
 void
@@ -350,39 +487,6 @@ ADC::update_system_power(void)
 #endif // CONFIG_ARCH_BOARD_PX4FMU_V2
 }
 
-uint16_t
-ADC::_sample(unsigned channel)
-{
-	perf_begin(_sample_perf);
-
-	/* clear any previous EOC */
-	if (rSR & ADC_SR_EOC) {
-		rSR &= ~ADC_SR_EOC;
-	}
-
-	/* run a single conversion right now - should take about 60 cycles (a few microseconds) max */
-	rSQR3 = channel;
-	rCR2 |= ADC_CR2_SWSTART;
-
-	/* wait for the conversion to complete */
-	hrt_abstime now = hrt_absolute_time();
-
-	while (!(rSR & ADC_SR_EOC)) {
-
-		/* don't wait for more than 50us, since that means something broke - should reset here if we see this */
-		if ((hrt_absolute_time() - now) > 50) {
-			DEVICE_LOG("sample timeout");
-			return 0xffff;
-		}
-	}
-
-	/* read the result and clear EOC */
-	uint16_t result = rDR;
-
-	perf_end(_sample_perf);
-	return result;
-}
-
 /*
  * Driver 'main' command.
  */
@@ -61,6 +61,8 @@
 
 #include <board_config.h>
 #include <drivers/drv_hrt.h>
+#include <drivers/hrt_callout_heap.h>
+#include <systemlib/trace.h>
 
 #include "chip.h"
 #include "up_internal.h"
@@ -244,7 +246,7 @@
 /*
  * Queue of callout entries.
  */
-static struct sq_queue_s	callout_queue;
+static struct hrt_callout_heap	callout_queue;
 
 /* latency baseline (last compare value applied) */
 static uint16_t			latency_baseline;
@@ -754,7 +756,7 @@ hrt_store_absolute_time(volatile hrt_abstime *now)
 void
 hrt_init(void)
 {
-	sq_init(&callout_queue);
+	hrt_callout_heap_init(&callout_queue);
 	hrt_tim_init();
 
 #ifdef HRT_PPM_CHANNEL
@@ -804,15 +806,8 @@ hrt_call_internal(struct hrt_call *entry, hrt_abstime deadline, hrt_abstime inte
 	irqstate_t flags = irqsave();
 
 	/* if the entry is currently queued, remove it */
-	/* note that we are using a potentially uninitialised
-	   entry->link here, but it is safe as sq_rem() doesn't
-	   dereference the passed node unless it is found in the
-	   list. So we potentially waste a bit of time searching the
-	   queue for the uninitialised entry->link but we don't do
-	   anything actually unsafe.
-	*/
 	if (entry->deadline != 0) {
-		sq_rem(&entry->link, &callout_queue);
+		hrt_callout_heap_remove(&callout_queue, entry);
 	}
 
 	entry->deadline = deadline;
@@ -844,7 +839,7 @@ hrt_cancel(struct hrt_call *entry)
 {
 	irqstate_t flags = irqsave();
 
-	sq_rem(&entry->link, &callout_queue);
+	hrt_callout_heap_remove(&callout_queue, entry);
 	entry->deadline = 0;
 
 	/* if this is a periodic call being removed by the callout, prevent it from
@@ -858,29 +853,14 @@ hrt_cancel(struct hrt_call *entry)
 static void
 hrt_call_enter(struct hrt_call *entry)
 {
-	struct hrt_call	*call, *next;
+	struct hrt_call	*call = hrt_callout_heap_peek(&callout_queue);
 
-	call = (struct hrt_call *)sq_peek(&callout_queue);
+	hrt_callout_heap_insert(&callout_queue, entry);
 
 	if ((call == NULL) || (entry->deadline < call->deadline)) {
-		sq_addfirst(&entry->link, &callout_queue);
-		//lldbg("call enter at head, reschedule\n");
 		/* we changed the next deadline, reschedule the timer event */
 		hrt_call_reschedule();
-
-	} else {
-		do {
-			next = (struct hrt_call *)sq_next(&call->link);
-
-			if ((next == NULL) || (entry->deadline < next->deadline)) {
-				//lldbg("call enter after head\n");
-				sq_addafter(&call->link, &entry->link, &callout_queue);
-				break;
-			}
-		} while ((call = next) != NULL);
 	}
-
-	//lldbg("scheduled\n");
 }
 
 static void
@@ -893,7 +873,7 @@ hrt_call_invoke(void)
 		/* get the current time */
 		hrt_abstime now = hrt_absolute_time();
 
-		call = (struct hrt_call *)sq_peek(&callout_queue);
+		call = hrt_callout_heap_peek(&callout_queue);
 
 		if (call == NULL) {
 			break;
@@ -903,7 +883,7 @@ hrt_call_invoke(void)
 			break;
 		}
 
-		sq_rem(&call->link, &callout_queue);
+		hrt_callout_heap_remove(&callout_queue, call);
 		//lldbg("call pop\n");
 
 		/* save the intended deadline for periodic calls */
@@ -915,7 +895,9 @@ hrt_call_invoke(void)
 		/* invoke the callout (if there is one) */
 		if (call->callout) {
 			//lldbg("call %p: %p(%p)\n", call, call->callout, call->arg);
+			TRACE_CALLOUT_BEGIN(call->callout);
 			call->callout(call->arg);
+			TRACE_CALLOUT_END(call->callout);
 		}
 
 		/* if the callout has a non-zero period, it has to be re-entered */
@@ -941,7 +923,7 @@ static void
 hrt_call_reschedule()
 {
 	hrt_abstime	now = hrt_absolute_time();
-	struct hrt_call	*next = (struct hrt_call *)sq_peek(&callout_queue);
+	struct hrt_call	*next = hrt_callout_heap_peek(&callout_queue);
 	hrt_abstime	deadline = now + HRT_INTERVAL_MAX;
 
 	/*
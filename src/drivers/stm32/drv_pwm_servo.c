@@ -94,6 +94,23 @@ static void		pwm_timer_init(unsigned timer);
 static void		pwm_timer_set_rate(unsigned timer, unsigned rate);
 static void		pwm_channel_init(unsigned channel);
 
+static uint32_t		pwm_oneshot_ticks(servo_position_t value);
+
+/*
+ * Oneshot timers count at 12MHz, which divides the timer clocks of all
+ * supported chips and gives enough resolution for the short protocols.
+ */
+#define PWM_ONESHOT_CLOCK	12000000
+
+/* timers running in oneshot mode, restarted by up_pwm_update() */
+static uint32_t		pwm_oneshot_timers;
+
+/* protocol of all oneshot timers */
+static unsigned		pwm_oneshot_protocol = PWM_ONESHOT_PROTOCOL_125;
+
+/* last pulse width in microseconds set on the channels of oneshot timers */
+static servo_position_t	pwm_oneshot_values[PWM_SERVO_MAX_CHANNELS];
+
 static void
 pwm_timer_init(unsigned timer)
 {
@@ -116,9 +133,6 @@ pwm_timer_init(unsigned timer)
 		rBDTR(timer) = ATIM_BDTR_MOE;
 	}
 
-	/* configure the timer to free-run at 1MHz */
-	rPSC(timer) = (pwm_timers[timer].clock_freq / 1000000) - 1;
-
 	/* default to updating at 50Hz */
 	pwm_timer_set_rate(timer, 50);
 
@@ -128,8 +142,21 @@ pwm_timer_init(unsigned timer)
 static void
 pwm_timer_set_rate(unsigned timer, unsigned rate)
 {
-	/* configure the timer to update at the desired rate */
-	rARR(timer) = 1000000 / rate;
+	if (rate == PWM_RATE_ONESHOT) {
+		/*
+		 * The period is only a fallback for missing triggers, each
+		 * up_pwm_update() restarts the counter.
+		 */
+		rPSC(timer) = (pwm_timers[timer].clock_freq / PWM_ONESHOT_CLOCK) - 1;
+		rARR(timer) = 0xffff;
+		pwm_oneshot_timers |= (1 << timer);
+
+	} else {
+		/* configure the timer to free-run at 1MHz and update at the desired rate */
+		rPSC(timer) = (pwm_timers[timer].clock_freq / 1000000) - 1;
+		rARR(timer) = 1000000 / rate;
+		pwm_oneshot_timers &= ~(1 << timer);
+	}
 
 	/* generate an update event; reloads the counter and all registers */
 	rEGR(timer) = GTIM_EGR_UG;
@@ -171,6 +198,27 @@ pwm_channel_init(unsigned channel)
 	}
 }
 
+static uint32_t
+pwm_oneshot_ticks(servo_position_t value)
+{
+	switch (pwm_oneshot_protocol) {
+	case PWM_ONESHOT_PROTOCOL_42:
+		/* 1000..2000us become 42..83us */
+		return (uint32_t)value * (PWM_ONESHOT_CLOCK / 1000000) / 24;
+
+	case PWM_ONESHOT_PROTOCOL_MULTISHOT: {
+			/* 1000..2000us become 5..25us */
+			int32_t ticks = (5 * (PWM_ONESHOT_CLOCK / 1000000)) +
+					((int32_t)value - 1000) * (PWM_ONESHOT_CLOCK / 1000000) / 50;
+			return (ticks > 0) ? ticks : 0;
+		}
+
+	default:
+		/* 1000..2000us become 125..250us */
+		return (uint32_t)value * (PWM_ONESHOT_CLOCK / 1000000) / 8;
+	}
+}
+
 int
 up_pwm_servo_set(unsigned channel, servo_position_t value)
 {
@@ -186,26 +234,33 @@ up_pwm_servo_set(unsigned channel, servo_position_t value)
 		return -1;
 	}
 
+	uint32_t ccr = value;
+
+	if (pwm_oneshot_timers & (1 << timer)) {
+		pwm_oneshot_values[channel] = value;
+		ccr = pwm_oneshot_ticks(value);
+	}
+
 	/* configure the channel */
-	if (value > 0) {
-		value--;
+	if (ccr > 0) {
+		ccr--;
 	}
 
 	switch (pwm_channels[channel].timer_channel) {
 	case 1:
-		rCCR1(timer) = value;
+		rCCR1(timer) = ccr;
 		break;
 
 	case 2:
-		rCCR2(timer) = value;
+		rCCR2(timer) = ccr;
 		break;
 
 	case 3:
-		rCCR3(timer) = value;
+		rCCR3(timer) = ccr;
 		break;
 
 	case 4:
-		rCCR4(timer) = value;
+		rCCR4(timer) = ccr;
 		break;
 
 	default:
@@ -231,6 +286,11 @@ up_pwm_servo_get(unsigned channel)
 		return 0;
 	}
 
+	/* the compare registers hold timer ticks, not microseconds */
+	if (pwm_oneshot_timers & (1 << timer)) {
+		return pwm_oneshot_values[channel];
+	}
+
 	/* configure the channel */
 	switch (pwm_channels[channel].timer_channel) {
 	case 1:
@@ -284,11 +344,7 @@ up_pwm_servo_deinit(void)
 int
 up_pwm_servo_set_rate_group_update(unsigned group, unsigned rate)
 {
-	/* limit update rate to 1..10000Hz; somewhat arbitrary but safe */
-	if (rate < 1) {
-		return -ERANGE;
-	}
-
+	/* limit update rate to 1..10000Hz; somewhat arbitrary but safe (0 is PWM_RATE_ONESHOT) */
 	if (rate > 10000) {
 		return -ERANGE;
 	}
@@ -302,6 +358,29 @@ up_pwm_servo_set_rate_group_update(unsigned group, unsigned rate)
 	return OK;
 }
 
+int
+up_pwm_servo_set_oneshot_protocol(unsigned protocol)
+{
+	if (protocol > PWM_ONESHOT_PROTOCOL_MULTISHOT) {
+		return -EINVAL;
+	}
+
+	pwm_oneshot_protocol = protocol;
+
+	return OK;
+}
+
+void
+up_pwm_update(void)
+{
+	for (unsigned i = 0; i < PWM_SERVO_MAX_TIMERS; i++) {
+		if (pwm_oneshot_timers & (1 << i)) {
+			/* restart the counter, this also loads the new pulse widths */
+			rEGR(i) = GTIM_EGR_UG;
+		}
+	}
+}
+
 int
 up_pwm_servo_set_rate(unsigned rate)
 {
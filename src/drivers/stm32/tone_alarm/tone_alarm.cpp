@@ -293,6 +293,7 @@ private:
 	const char		 *_default_tunes[TONE_NUMBER_OF_TUNES];
 	const char		 *_tune_names[TONE_NUMBER_OF_TUNES];
 	static const uint8_t	_note_tab[];
+	static const unsigned	_note_max = 84;	// B7, notes are numbered from 1 (C1)
 
 	unsigned		_default_tune_number; // number of currently playing default tune (0 for none)
 
@@ -310,6 +311,11 @@ private:
 
 	hrt_call		_note_call;	// HRT callout for note completion
 
+	// timer prescaler and period of every note, computed once by init()
+	// so the callouts don't evaluate the exponential per note
+	uint16_t		_note_prescale[_note_max];
+	uint16_t		_note_period[_note_max];
+
 	// Convert a note value in the range C1 to B7 into a divisor for
 	// the configured timer's clock.
 	//
@@ -377,6 +383,8 @@ ToneAlarm::ToneAlarm() :
 	_tune(nullptr),
 	_next(nullptr)
 {
+	memset(&_note_call, 0, sizeof(_note_call));
+
 	// enable debug() calls
 	//_debug_enabled = true;
 	_default_tunes[TONE_STARTUP_TUNE] = "MFT240L8 O4aO5dc O4aO5dc O4aO5dc L16dcdcdcdc";		// startup tune
@@ -451,6 +459,19 @@ ToneAlarm::init()
 	/* toggle the CC output each time the count passes 1 */
 	TONE_rCCR = 1;
 
+	for (unsigned note = 1; note <= _note_max; note++) {
+		// compute the divisor
+		unsigned divisor = note_to_divisor(note);
+
+		// pick the lowest prescaler value that we can use
+		// (note that the effective prescale value is 1 greater)
+		unsigned prescale = divisor / 65536;
+
+		// calculate the timer period for the selected prescaler value
+		_note_prescale[note - 1] = prescale;
+		_note_period[note - 1] = (divisor / (prescale + 1)) - 1;
+	}
+
 	/* default the timer to a prescale value of 1; playing notes will change this */
 	rPSC = 0;
 
@@ -537,18 +558,9 @@ ToneAlarm::rest_duration(unsigned rest_length, unsigned dots)
 void
 ToneAlarm::start_note(unsigned note)
 {
-	// compute the divisor
-	unsigned divisor = note_to_divisor(note);
-
-	// pick the lowest prescaler value that we can use
-	// (note that the effective prescale value is 1 greater)
-	unsigned prescale = divisor / 65536;
-
-	// calculate the timer period for the selected prescaler value
-	unsigned period = (divisor / (prescale + 1)) - 1;
-
-	rPSC = prescale;	// load new prescaler
-	rARR = period;		// load new toggle period
+	// the parser only produces notes in the range of the table
+	rPSC = _note_prescale[note - 1];	// load new prescaler
+	rARR = _note_period[note - 1];		// load new toggle period
 	rEGR = GTIM_EGR_UG;	// force a reload of the period
 	rCCER |= TONE_CCER;	// enable the output
 
@@ -715,7 +727,7 @@ ToneAlarm::next_note()
 		case 'N':	// play an arbitrary note
 			note = next_number();
 
-			if (note > 84) {
+			if (note > _note_max) {
 				goto tune_error;
 			}
 
@@ -737,7 +749,7 @@ ToneAlarm::next_note()
 			switch (c) {
 			case '#':	// up a semitone
 			case '+':
-				if (note < 84) {
+				if (note < _note_max) {
 					note++;
 				}
 
@@ -65,6 +65,7 @@
 #include <drivers/drv_hrt.h>
 #include <drivers/drv_range_finder.h>
 #include <drivers/device/ringbuffer.h>
+#include <drivers/device/rangefinder_rate.h>
 
 #include <uORB/uORB.h>
 #include <uORB/topics/subsystem_info.h>
@@ -127,6 +128,7 @@ private:
 	bool				_sensor_ok;
 	uint8_t				_valid;
 	int					_measure_ticks;
+	device::RangefinderRate		_rate;
 	bool				_collect_phase;
 	int				_class_instance;
 	int				_orb_class_instance;
@@ -237,6 +239,7 @@ TRONE::TRONE(int bus, int address) :
 	_sensor_ok(false),
 	_valid(0),
 	_measure_ticks(0),
+	_rate(USEC2TICK(RANGEFINDER_IDLE_INTERVAL)),
 	_collect_phase(false),
 	_class_instance(-1),
 	_orb_class_instance(-1),
@@ -627,12 +630,11 @@ TRONE::start()
 	work_queue(HPWORK, &_work, (worker_t)&TRONE::cycle_trampoline, this, 1);
 
 	/* notify about state change */
-	struct subsystem_info_s info = {
-		true,
-		true,
-		true,
-		subsystem_info_s::SUBSYSTEM_TYPE_RANGEFINDER
-	};
+	struct subsystem_info_s info = {};
+	info.present = true;
+	info.enabled = true;
+	info.ok = true;
+	info.subsystem_type = subsystem_info_s::SUBSYSTEM_TYPE_RANGEFINDER;
 	static orb_advert_t pub = nullptr;
 
 	if (pub != nullptr) {
@@ -674,16 +676,19 @@ TRONE::cycle()
 		/* next phase is measurement */
 		_collect_phase = false;
 
+		/* slower while idle */
+		unsigned ticks = _rate.interval(_measure_ticks, is_open());
+
 		/*
 		 * Is there a collect->measure gap?
 		 */
-		if (_measure_ticks > USEC2TICK(TRONE_CONVERSION_INTERVAL)) {
+		if (ticks > USEC2TICK(TRONE_CONVERSION_INTERVAL)) {
 			/* schedule a fresh cycle call when we are ready to measure again */
 			work_queue(HPWORK,
 				&_work,
 				(worker_t)&TRONE::cycle_trampoline,
 				this,
-				_measure_ticks - USEC2TICK(TRONE_CONVERSION_INTERVAL));
+				ticks - USEC2TICK(TRONE_CONVERSION_INTERVAL));
 
 			return;
 		}
@@ -711,7 +716,7 @@ TRONE::print_info()
 	perf_print_counter(_sample_perf);
 	perf_print_counter(_comms_errors);
 	perf_print_counter(_buffer_overflows);
-	printf("poll interval:  %u ticks\n", _measure_ticks);
+	printf("poll interval:  %u ticks%s\n", _measure_ticks, _rate.idle() ? " (idle)" : "");
 	_reports->print_info("report queue");
 }
 
@@ -45,6 +45,7 @@
  * IOCTL interface for sending log messages.
  */
 #include <px4_defines.h>
+#include <stdint.h>
 #include <sys/ioctl.h>
 
 /**
@@ -145,6 +146,40 @@ struct mavlink_logbuffer {
 	struct mavlink_logmessage *elems;
 };
 
+/**
+ * Number of messages kept by a log ring, a power of two.
+ */
+#define MAVLINK_LOGRING_SIZE			16
+
+/**
+ * A repeated message is dropped if the last copy is more recent than this (us).
+ */
+#define MAVLINK_LOGRING_REPEAT_INTERVAL		1000000
+
+/**
+ * Severity classes with their own rate limit: emergency to critical,
+ * error and warning, notice to debug.
+ */
+#define MAVLINK_LOGRING_CLASSES			3
+
+/**
+ * Log ring read by any number of readers, each with its own cursor.
+ *
+ * Readers do not lock, a reader overtaken by the writer skips to the
+ * oldest message still stored. Writers have to be serialized by the
+ * caller. A zeroed ring is empty and ready to use.
+ */
+struct mavlink_logring {
+	volatile unsigned head;				/**< number of messages ever written */
+	struct mavlink_logmessage elems[MAVLINK_LOGRING_SIZE];
+	struct mavlink_logmessage last;			/**< last message written */
+	uint64_t last_time;				/**< time the last message was written */
+	unsigned repeats;				/**< copies of the last message dropped since */
+	unsigned used[MAVLINK_LOGRING_CLASSES];		/**< rate limit tokens taken per class */
+	uint64_t refill_time[MAVLINK_LOGRING_CLASSES];	/**< time of the last token refill per class */
+	unsigned dropped;				/**< messages dropped by the rate limits */
+};
+
 __BEGIN_DECLS
 void mavlink_logbuffer_init(struct mavlink_logbuffer *lb, int size);
 
@@ -159,6 +194,31 @@ void mavlink_logbuffer_write(struct mavlink_logbuffer *lb, const struct mavlink_
 int mavlink_logbuffer_read(struct mavlink_logbuffer *lb, struct mavlink_logmessage *elem);
 
 void mavlink_logbuffer_vasprintf(struct mavlink_logbuffer *lb, int severity, const char *fmt, ...);
+
+/**
+ * Add a message to a log ring.
+ *
+ * Repeats of the last message within MAVLINK_LOGRING_REPEAT_INTERVAL are
+ * only counted, the next copy let through tells how many were dropped.
+ * Each severity class passes a burst of messages, then one per interval.
+ *
+ * @param now		current time in us
+ * @return 0 if the message was stored, 1 if it was dropped
+ */
+int mavlink_logring_write(struct mavlink_logring *lr, const struct mavlink_logmessage *elem, uint64_t now);
+
+/**
+ * Read the next message of a reader.
+ *
+ * @param seq		the cursor of the reader, zero to start at the oldest message stored
+ * @return 0 if a message was copied to elem, 1 if the reader is up to date
+ */
+int mavlink_logring_read(struct mavlink_logring *lr, unsigned *seq, struct mavlink_logmessage *elem);
+
+/**
+ * @return nonzero if the reader at seq is up to date
+ */
+int mavlink_logring_is_empty(struct mavlink_logring *lr, unsigned seq);
 __END_DECLS
 
 #endif
@@ -35,6 +35,7 @@
 # Conversion library
 #
 
-SRCS		 = rotation.cpp
+SRCS		 = rotation.cpp \
+		   sensor_correction.cpp
 
 MAXOPTIMIZATION	 = -Os
@@ -0,0 +1,70 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file sensor_correction.cpp
+ */
+
+#include "sensor_correction.h"
+
+SensorCorrection::SensorCorrection()
+{
+	const float offset[3] = {0.0f, 0.0f, 0.0f};
+	const float scale[3] = {1.0f, 1.0f, 1.0f};
+	set(ROTATION_NONE, 1.0f, offset, scale);
+}
+
+void
+SensorCorrection::set(enum Rotation rot, float range_scale, const float offset[3], const float scale[3])
+{
+	/* the columns are the rotated unit vectors, so the result is exactly what rotate_3f() does */
+	float R[3][3];
+
+	for (unsigned j = 0; j < 3; j++) {
+		float v[3] = {0.0f, 0.0f, 0.0f};
+		v[j] = 1.0f;
+		rotate_3f(rot, v[0], v[1], v[2]);
+
+		for (unsigned i = 0; i < 3; i++) {
+			R[i][j] = v[i];
+		}
+	}
+
+	for (unsigned i = 0; i < 3; i++) {
+		for (unsigned j = 0; j < 3; j++) {
+			_m[i][j] = R[i][j] * range_scale * scale[i];
+		}
+
+		_offset[i] = offset[i] * scale[i];
+	}
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file sensor_correction.h
+ *
+ * Board rotation, range scale and calibration of a 3 axis sensor in one step.
+ */
+
+#ifndef SENSOR_CORRECTION_H_
+#define SENSOR_CORRECTION_H_
+
+#include "rotation.h"
+
+/**
+ * The correction ((R * raw) * range_scale - offset) * scale of the drivers,
+ * folded into one matrix and offset when any of its inputs changes, so a
+ * sample takes 9 multiply-adds instead of the rotation switch and a second
+ * pass for the calibration.
+ */
+class __EXPORT SensorCorrection
+{
+public:
+	SensorCorrection();
+
+	/**
+	 * Recompute the correction, the calibration is given per axis.
+	 */
+	void set(enum Rotation rot, float range_scale, const float offset[3], const float scale[3]);
+
+	/**
+	 * Recompute the correction from a calibration struct (accel_scale, gyro_scale or mag_scale).
+	 */
+	template<typename S>
+	void set(enum Rotation rot, float range_scale, const S &cal)
+	{
+		const float offset[3] = {cal.x_offset, cal.y_offset, cal.z_offset};
+		const float scale[3] = {cal.x_scale, cal.y_scale, cal.z_scale};
+		set(rot, range_scale, offset, scale);
+	}
+
+	/**
+	 * Correct one raw sample.
+	 */
+	void apply(float x, float y, float z, float out[3]) const
+	{
+		out[0] = _m[0][0] * x + _m[0][1] * y + _m[0][2] * z - _offset[0];
+		out[1] = _m[1][0] * x + _m[1][1] * y + _m[1][2] * z - _offset[1];
+		out[2] = _m[2][0] * x + _m[2][1] * y + _m[2][2] * z - _offset[2];
+	}
+
+private:
+	float _m[3][3];
+	float _offset[3];
+};
+
+#endif /* SENSOR_CORRECTION_H_ */
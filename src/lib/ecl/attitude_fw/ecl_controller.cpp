@@ -51,6 +51,14 @@
 #include <stdio.h>
 #include <mathlib/mathlib.h>
 
+void ecl_control_data_update_trig(struct ECL_ControlData &ctl_data)
+{
+	ctl_data.sin_roll = sinf(ctl_data.roll);
+	ctl_data.cos_roll = cosf(ctl_data.roll);
+	ctl_data.sin_pitch = sinf(ctl_data.pitch);
+	ctl_data.cos_pitch = cosf(ctl_data.pitch);
+}
+
 ECL_Controller::ECL_Controller(const char *name) :
 	_last_run(0),
 	_tc(0.1f),
@@ -76,8 +76,19 @@ struct ECL_ControlData {
 	float airspeed;
 	float scaler;
 	bool lock_integrator;
+	/* trigonometric terms of roll and pitch, shared by all controllers */
+	float sin_roll;
+	float cos_roll;
+	float sin_pitch;
+	float cos_pitch;
 };
 
+/**
+ * Compute the trigonometric terms of the attitude, call once per cycle
+ * after setting roll and pitch and before running the controllers.
+ */
+__EXPORT void ecl_control_data_update_trig(struct ECL_ControlData &ctl_data);
+
 class __EXPORT ECL_Controller
 {
 public:
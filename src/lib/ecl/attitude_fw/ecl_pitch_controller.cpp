@@ -119,8 +119,8 @@ float ECL_PitchController::control_bodyrate(const struct ECL_ControlData &ctl_da
 	}
 
 	/* Transform setpoint to body angular rates (jacobian) */
-	_bodyrate_setpoint = cosf(ctl_data.roll) * _rate_setpoint +
-			     cosf(ctl_data.pitch) * sinf(ctl_data.roll) * ctl_data.yaw_rate_setpoint;
+	_bodyrate_setpoint = ctl_data.cos_roll * _rate_setpoint +
+			     ctl_data.cos_pitch * ctl_data.sin_roll * ctl_data.yaw_rate_setpoint;
 
 	/* apply turning offset to desired bodyrate setpoint*/
 	/* flying inverted (wings upside down)*/
@@ -152,8 +152,17 @@ float ECL_PitchController::control_bodyrate(const struct ECL_ControlData &ctl_da
 	   For reference see Automatic Control of Aircraft and Missiles by John H. Blakelock, pg. 175
 	   Availible on google books 8/11/2015: 
 	   https://books.google.com/books?id=ubcczZUDCsMC&pg=PA175#v=onepage&q&f=false*/
+	float sin_roll = ctl_data.sin_roll;
+	float cos_roll = ctl_data.cos_roll;
+
+	if (constrained_roll != ctl_data.roll) {
+		sin_roll = sinf(constrained_roll);
+		cos_roll = cosf(constrained_roll);
+	}
+
+	/* tan(roll) * sin(roll) */
 	float body_fixed_turn_offset = (fabsf((CONSTANTS_ONE_G / airspeed) *
-				  		tanf(constrained_roll) * sinf(constrained_roll)));
+				  		sin_roll * sin_roll / cos_roll));
 
 	if (inverted) {
 		body_fixed_turn_offset = -body_fixed_turn_offset;
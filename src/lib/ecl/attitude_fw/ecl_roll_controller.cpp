@@ -107,7 +107,7 @@ float ECL_RollController::control_bodyrate(const struct ECL_ControlData &ctl_dat
 	}
 
 	/* Transform setpoint to body angular rates (jacobian) */
-	_bodyrate_setpoint = _rate_setpoint - sinf(ctl_data.pitch) * ctl_data.yaw_rate_setpoint;
+	_bodyrate_setpoint = _rate_setpoint - ctl_data.sin_pitch * ctl_data.yaw_rate_setpoint;
 
 	/* Calculate body angular rate error */
 	_rate_error = _bodyrate_setpoint - ctl_data.roll_rate; //body angular rate error
@@ -118,13 +118,13 @@ float ECL_YawController::control_attitude_impl_openloop(const struct ECL_Control
 
 	if (sqrtf(ctl_data.speed_body_u * ctl_data.speed_body_u + ctl_data.speed_body_v * ctl_data.speed_body_v +
 		  ctl_data.speed_body_w * ctl_data.speed_body_w) > _coordinated_min_speed) {
-		float denumerator = (ctl_data.speed_body_u * cosf(ctl_data.roll) * cosf(ctl_data.pitch) +
-				     ctl_data.speed_body_w * sinf(ctl_data.pitch));
+		float denumerator = (ctl_data.speed_body_u * ctl_data.cos_roll * ctl_data.cos_pitch +
+				     ctl_data.speed_body_w * ctl_data.sin_pitch);
 
 		if (fabsf(denumerator) > FLT_EPSILON) {
 			_rate_setpoint = (ctl_data.speed_body_w * ctl_data.roll_rate_setpoint +
-					  9.81f * sinf(ctl_data.roll) * cosf(ctl_data.pitch) +
-					  ctl_data.speed_body_u * ctl_data.pitch_rate_setpoint * sinf(ctl_data.roll)) /
+					  9.81f * ctl_data.sin_roll * ctl_data.cos_pitch +
+					  ctl_data.speed_body_u * ctl_data.pitch_rate_setpoint * ctl_data.sin_roll) /
 					 denumerator;
 
 //			warnx("yaw: speed_body_u %.f speed_body_w %1.f roll %.1f pitch %.1f denumerator %.1f _rate_setpoint %.1f", speed_body_u, speed_body_w, denumerator, _rate_setpoint);
@@ -189,13 +189,13 @@ float ECL_YawController::control_bodyrate_impl(const struct ECL_ControlData &ctl
 
 
 	/* Transform setpoint to body angular rates (jacobian) */
-	_bodyrate_setpoint = -sinf(ctl_data.roll) * ctl_data.pitch_rate_setpoint +
-			     cosf(ctl_data.roll) * cosf(ctl_data.pitch) * _rate_setpoint;
+	_bodyrate_setpoint = -ctl_data.sin_roll * ctl_data.pitch_rate_setpoint +
+			     ctl_data.cos_roll * ctl_data.cos_pitch * _rate_setpoint;
 
 	/* Close the acceleration loop if _coordinated_method wants this: change body_rate setpoint */
 	if (_coordinated_method == COORD_METHOD_CLOSEACC) {
 		//XXX: filtering of acceleration?
-		_bodyrate_setpoint -= (ctl_data.acc_body_y / (airspeed * cosf(ctl_data.pitch)));
+		_bodyrate_setpoint -= (ctl_data.acc_body_y / (airspeed * ctl_data.cos_pitch));
 	}
 
 	/* Calculate body angular rate error */
@@ -43,19 +43,24 @@
 #include <ecl/ecl.h>
 
 DataValidatorGroup::DataValidatorGroup(unsigned siblings) :
-	_first(nullptr),
+	_siblings((siblings < _max_siblings) ? siblings : _max_siblings),
+	_timeout_interval(70000),
+	_time_last{0},
+	_event_count{0},
+	_error_count{0},
+	_priority{0},
+	_value_equal_count{0},
+	_mean{0.0f},
+	_lp{0.0f},
+	_M2{0.0f},
+	_rms{0.0f},
+	_value{0.0f},
 	_curr_best(-1),
 	_prev_best(-1),
 	_first_failover_time(0),
 	_toggle_count(0)
 {
-	DataValidator *next = _first;
 
-	for (unsigned i = 0; i < siblings; i++) {
-		next = new DataValidator(next);
-	}
-
-	_first = next;
 }
 
 DataValidatorGroup::~DataValidatorGroup()
@@ -66,60 +71,133 @@ DataValidatorGroup::~DataValidatorGroup()
 void
 DataValidatorGroup::set_timeout(uint64_t timeout_interval_us)
 {
-	DataValidator *next = _first;
+	_timeout_interval = timeout_interval_us;
+}
+
+void
+DataValidatorGroup::update(unsigned index, uint64_t timestamp, const float val[3], uint64_t error_count, int priority)
+{
+	_event_count[index]++;
+	_error_count[index] = error_count;
+	_priority[index] = priority;
+
+	float *mean = &_mean[index * _dimensions];
+	float *lp = &_lp[index * _dimensions];
+	float *M2 = &_M2[index * _dimensions];
+	float *rms = &_rms[index * _dimensions];
+	float *value = &_value[index * _dimensions];
+
+	if (_time_last[index] == 0) {
+		for (unsigned i = 0; i < _dimensions; i++) {
+			mean[i] = 0;
+			lp[i] = val[i];
+			M2[i] = 0;
+		}
+
+	} else {
+		/* the same divisors apply to all axes */
+		const float event_scale = 1.0f / _event_count[index];
+		const float variance_scale = 1.0f / (_event_count[index] - 1);
+
+		for (unsigned i = 0; i < _dimensions; i++) {
+			float lp_val = val[i] - lp[i];
 
-	while (next != nullptr) {
-		next->set_timeout(timeout_interval_us);
-		next = next->sibling();
+			float delta_val = lp_val - mean[i];
+			mean[i] += delta_val * event_scale;
+			M2[i] += delta_val * (lp_val - mean[i]);
+			rms[i] = sqrtf(M2[i] * variance_scale);
+
+			if (fabsf(value[i] - val[i]) < 0.000001f) {
+				_value_equal_count[index]++;
+			} else {
+				_value_equal_count[index] = 0;
+			}
+		}
 	}
+
+	for (unsigned i = 0; i < _dimensions; i++) {
+		// XXX replace with better filter, make it auto-tune to update rate
+		lp[i] = lp[i] * 0.5f + val[i] * 0.5f;
+
+		value[i] = val[i];
+	}
+
+	_time_last[index] = timestamp;
 }
 
 void
 DataValidatorGroup::put(unsigned index, uint64_t timestamp, float val[3], uint64_t error_count, int priority)
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
+	if (index < _siblings) {
+		update(index, timestamp, val, error_count, priority);
+	}
+}
 
-	while (next != nullptr) {
-		if (i == index) {
-			next->put(timestamp, val, error_count, priority);
-			break;
+void
+DataValidatorGroup::put_all(unsigned count, const uint64_t timestamp[], const float val[],
+				const uint32_t error_count[], const uint32_t priority[])
+{
+	if (count > _siblings) {
+		count = _siblings;
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		/* no new data since the last item */
+		if (timestamp[i] == _time_last[i]) {
+			continue;
 		}
-		next = next->sibling();
-		i++;
+
+		update(i, timestamp[i], &val[i * _dimensions], error_count[i], priority[i]);
 	}
 }
 
+float
+DataValidatorGroup::confidence(unsigned index, uint64_t timestamp)
+{
+	/* check if we have any data */
+	if (_time_last[index] == 0) {
+		return 0.0f;
+	}
+
+	/* check error count limit */
+	if (_error_count[index] > NORETURN_ERRCOUNT) {
+		return 0.0f;
+	}
+
+	/* we got the exact same sensor value N times in a row */
+	if (_value_equal_count[index] > VALUE_EQUAL_COUNT_MAX) {
+		return 0.0f;
+	}
+
+	/* timed out - that's it */
+	if (timestamp - _time_last[index] > _timeout_interval) {
+		return 0.0f;
+	}
+
+	return 1.0f;
+}
+
 float*
 DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 {
-	DataValidator *next = _first;
-
 	// XXX This should eventually also include voting
 	int pre_check_best = _curr_best;
 	float max_confidence = -1.0f;
 	int max_priority = -1000;
 	int max_index = -1;
 	uint64_t min_error_count = 30000;
-	DataValidator *best = nullptr;
-
-	unsigned i = 0;
 
-	while (next != nullptr) {
-		float confidence = next->confidence(timestamp);
+	for (unsigned i = 0; i < _siblings; i++) {
+		float confidence = this->confidence(i, timestamp);
 		if (confidence > max_confidence ||
 			(fabsf(confidence - max_confidence) < 0.01f &&
-				((next->error_count() < min_error_count) &&
-				(next->priority() >= max_priority)))) {
+				((_error_count[i] < min_error_count) &&
+				(_priority[i] >= max_priority)))) {
 			max_index = i;
 			max_confidence = confidence;
-			max_priority = next->priority();
-			min_error_count = next->error_count();
-			best = next;
+			max_priority = _priority[i];
+			min_error_count = _error_count[i];
 		}
-
-		next = next->sibling();
-		i++;
 	}
 
 	/* the current best sensor is not matching the previous best sensor */
@@ -143,30 +221,24 @@ DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 		_curr_best = max_index;
 	}
 	*index = max_index;
-	return (best) ? best->value() : nullptr;
+	return (max_index >= 0) ? &_value[max_index * _dimensions] : nullptr;
 }
 
 float
 DataValidatorGroup::get_vibration_factor(uint64_t timestamp)
 {
-	DataValidator *next = _first;
-
 	float vibe = 0.0f;
 
 	/* find the best RMS value of a non-timed out sensor */
-	while (next != nullptr) {
-
-		if (next->confidence(timestamp) > 0.5f) {
-			float* rms = next->rms();
+	for (unsigned i = 0; i < _siblings; i++) {
 
-			for (unsigned j = 0; j < 3; j++) {
-				if (rms[j] > vibe) {
-					vibe = rms[j];
+		if (confidence(i, timestamp) > 0.5f) {
+			for (unsigned j = 0; j < _dimensions; j++) {
+				if (_rms[i * _dimensions + j] > vibe) {
+					vibe = _rms[i * _dimensions + j];
 				}
 			}
 		}
-
-		next = next->sibling();
 	}
 
 	return vibe;
@@ -180,15 +252,19 @@ DataValidatorGroup::print()
 		_curr_best, _prev_best, (_toggle_count > 0) ? "YES" : "NO",
 		_toggle_count);
 
+	for (unsigned i = 0; i < _siblings; i++) {
+		ECL_INFO("sensor #%u:\n", i);
 
-	DataValidator *next = _first;
-	unsigned i = 0;
+		if (_time_last[i] == 0) {
+			ECL_INFO("\tno data\n");
+			continue;
+		}
 
-	while (next != nullptr) {
-		ECL_INFO("sensor #%u:\n", i);
-		next->print();
-		next = next->sibling();
-		i++;
+		for (unsigned j = 0; j < _dimensions; j++) {
+			unsigned k = i * _dimensions + j;
+			ECL_INFO("\tval: %8.4f, lp: %8.4f mean dev: %8.4f RMS: %8.4f\n",
+				(double)_value[k], (double)_lp[k], (double)_mean[k], (double)_rms[k]);
+		}
 	}
 }
 
@@ -60,6 +60,20 @@ public:
 	void			put(unsigned index, uint64_t timestamp,
 					float val[3], uint64_t error_count, int priority);
 
+	/**
+	 * Put the latest item of every sensor into the validator group
+	 * in a single pass. Sensors whose timestamp did not change since
+	 * their last item carry no new data and are skipped.
+	 *
+	 * @param count		Number of sensors in the arrays
+	 * @param timestamp	The measurement timestamps, one per sensor
+	 * @param val		The 3D vectors, three consecutive values per sensor
+	 * @param error_count	The current error counts, one per sensor
+	 * @param priority	The priorities, one per sensor
+	 */
+	void			put_all(unsigned count, const uint64_t timestamp[],
+					const float val[], const uint32_t error_count[], const uint32_t priority[]);
+
 	/**
 	 * Get the best data triplet of the group
 	 *
@@ -95,11 +109,43 @@ public:
 	void			set_timeout(uint64_t timeout_interval_us);
 
 private:
-	DataValidator *_first;		/**< sibling in the group */
+	static const unsigned _dimensions = 3;
+	static const unsigned _max_siblings = 4;
+
+	/**
+	 * Update the statistics of one sensor with a new item
+	 */
+	void			update(unsigned index, uint64_t timestamp,
+					const float val[3], uint64_t error_count, int priority);
+
+	/**
+	 * Get the confidence of one sensor
+	 * @return		the confidence between 0 and 1
+	 */
+	float			confidence(unsigned index, uint64_t timestamp);
+
+	/*
+	 * The state of all sensors is kept in one array per field, indexed by
+	 * sensor and, for the vector fields, by index * _dimensions + axis.
+	 */
+	unsigned _siblings;			/**< number of sensors in the group */
+	uint64_t _timeout_interval;		/**< interval in which a datastream times out in us */
+	uint64_t _time_last[_max_siblings];	/**< last timestamp */
+	uint64_t _event_count[_max_siblings];	/**< total data counter */
+	uint64_t _error_count[_max_siblings];	/**< error count */
+	int _priority[_max_siblings];		/**< sensor nominal priority */
+	unsigned _value_equal_count[_max_siblings];	/**< equal values in a row */
+	float _mean[_max_siblings * _dimensions];	/**< mean of value */
+	float _lp[_max_siblings * _dimensions];		/**< low pass value */
+	float _M2[_max_siblings * _dimensions];		/**< RMS component value */
+	float _rms[_max_siblings * _dimensions];	/**< root mean square error */
+	float _value[_max_siblings * _dimensions];	/**< last value */
 	int _curr_best;		/**< currently best index */
 	int _prev_best;		/**< the previous best index */
 	uint64_t _first_failover_time;	/**< timestamp where the first failover occured or zero if none occured */
 	unsigned _toggle_count;		/**< number of back and forth switches between two sensors */
+	const unsigned NORETURN_ERRCOUNT = 100;	/**< if the error count reaches this value, return sensor as invalid */
+	const unsigned VALUE_EQUAL_COUNT_MAX = 100;	/**< if the sensor value is the same (accumulated also between axes) this many times, flag it */
 
 	/* we don't want this class to be copied */
 	DataValidatorGroup(const DataValidatorGroup&);
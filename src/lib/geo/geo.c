@@ -60,7 +60,7 @@
  * formulas according to: http://mathworld.wolfram.com/AzimuthalEquidistantProjection.html
  */
 
-static struct map_projection_reference_s mp_ref = {0.0, 0.0, 0.0, 0.0, false, 0};
+static struct map_projection_reference_s mp_ref = {0.0, 0.0, 0.0, 0.0, false, 0, 0.0f, 0.0f};
 static struct globallocal_converter_reference_s gl_ref = {0.0f, false};
 
 __EXPORT bool map_projection_global_initialized()
@@ -99,6 +99,8 @@ __EXPORT int map_projection_init_timestamped(struct map_projection_reference_s *
 	ref->lon_rad = lon_0 * M_DEG_TO_RAD;
 	ref->sin_lat = sin(ref->lat_rad);
 	ref->cos_lat = cos(ref->lat_rad);
+	ref->sin_lat_f = (float)ref->sin_lat;
+	ref->cos_lat_f = (float)ref->cos_lat;
 
 	ref->timestamp = timestamp;
 	ref->init_done = true;
@@ -156,6 +158,68 @@ __EXPORT int map_projection_project(const struct map_projection_reference_s *ref
 	return 0;
 }
 
+/*
+ * Second order expansion of the projection around the reference, with dlat
+ * and dlon the offsets from the reference in radians:
+ *   x = R * (dlat + 1/2 * sin_lat * cos_lat * dlon^2)
+ *   y = R * (cos_lat - sin_lat * dlat) * dlon
+ * The terms left out are of third order in the distance, which bounds the
+ * error to below 1 cm within MAP_PROJECTION_FAST_RANGE.
+ */
+static bool map_projection_fast_valid(const struct map_projection_reference_s *ref, float north_rad, float east_rad)
+{
+	const float max_rad = MAP_PROJECTION_FAST_RANGE / CONSTANTS_RADIUS_OF_EARTH;
+
+	return fabsf(north_rad) < max_rad && fabsf(east_rad) < max_rad
+	       && ref->cos_lat_f > cosf(MAP_PROJECTION_FAST_MAX_LAT * M_DEG_TO_RAD_F);
+}
+
+__EXPORT int map_projection_project_fast(const struct map_projection_reference_s *ref, double lat, double lon, float *x,
+		float *y)
+{
+	if (!map_projection_initialized(ref)) {
+		return -1;
+	}
+
+	/* the offsets need double precision, everything after them is float */
+	float dlat = (float)(lat * M_DEG_TO_RAD - ref->lat_rad);
+	float dlon = (float)(lon * M_DEG_TO_RAD - ref->lon_rad);
+
+	if (!map_projection_fast_valid(ref, dlat, dlon * ref->cos_lat_f)) {
+		return map_projection_project(ref, lat, lon, x, y);
+	}
+
+	*x = (dlat + 0.5f * ref->sin_lat_f * ref->cos_lat_f * dlon * dlon) * CONSTANTS_RADIUS_OF_EARTH;
+	*y = (ref->cos_lat_f - ref->sin_lat_f * dlat) * dlon * CONSTANTS_RADIUS_OF_EARTH;
+
+	return 0;
+}
+
+__EXPORT int map_projection_reproject_fast(const struct map_projection_reference_s *ref, float x, float y, double *lat,
+		double *lon)
+{
+	if (!map_projection_initialized(ref)) {
+		return -1;
+	}
+
+	float x_rad = x / CONSTANTS_RADIUS_OF_EARTH;
+	float y_rad = y / CONSTANTS_RADIUS_OF_EARTH;
+
+	if (!map_projection_fast_valid(ref, x_rad, y_rad)) {
+		return map_projection_reproject(ref, x, y, lat, lon);
+	}
+
+	/* one fixed point step on the longitude is enough for second order */
+	float dlon = y_rad / (ref->cos_lat_f - ref->sin_lat_f * x_rad);
+	float dlat = x_rad - 0.5f * ref->sin_lat_f * ref->cos_lat_f * dlon * dlon;
+	dlon = y_rad / (ref->cos_lat_f - ref->sin_lat_f * dlat);
+
+	*lat = (ref->lat_rad + (double)dlat) * M_RAD_TO_DEG;
+	*lon = (ref->lon_rad + (double)dlon) * M_RAD_TO_DEG;
+
+	return 0;
+}
+
 __EXPORT int map_projection_global_reproject(float x, float y, double *lat, double *lon)
 {
 	return map_projection_reproject(&mp_ref, x, y, lat, lon);
@@ -272,8 +336,44 @@ __EXPORT int globallocalconverter_getref(double *lat_0, double *lon_0, float *al
 	return 0;
 }
 
+/*
+ * Offset to the next waypoint in radians on the unit sphere, from the same
+ * second order expansion as map_projection_project_fast but around the
+ * current position. Returns false if the waypoint is beyond
+ * MAP_PROJECTION_FAST_RANGE or too close to the poles for the expansion,
+ * leaving the exact double precision formulas to the caller.
+ */
+static bool get_vector_to_next_waypoint_local(double lat_now, double lon_now, double lat_next, double lon_next,
+		float *north_rad, float *east_rad)
+{
+	const float max_rad = MAP_PROJECTION_FAST_RANGE / CONSTANTS_RADIUS_OF_EARTH;
+
+	float lat_now_rad = (float)lat_now * M_DEG_TO_RAD_F;
+	float d_lat = (float)(lat_next - lat_now) * M_DEG_TO_RAD_F;
+	float d_lon = (float)(lon_next - lon_now) * M_DEG_TO_RAD_F;
+
+	float sin_lat = sinf(lat_now_rad);
+	float cos_lat = cosf(lat_now_rad);
+
+	if (!(fabsf(d_lat) < max_rad && fabsf(d_lon * cos_lat) < max_rad
+	      && cos_lat > cosf(MAP_PROJECTION_FAST_MAX_LAT * M_DEG_TO_RAD_F))) {
+		return false;
+	}
+
+	*north_rad = d_lat + 0.5f * sin_lat * cos_lat * d_lon * d_lon;
+	*east_rad = (cos_lat - sin_lat * d_lat) * d_lon;
+
+	return true;
+}
+
 __EXPORT float get_distance_to_next_waypoint(double lat_now, double lon_now, double lat_next, double lon_next)
 {
+	float north_rad, east_rad;
+
+	if (get_vector_to_next_waypoint_local(lat_now, lon_now, lat_next, lon_next, &north_rad, &east_rad)) {
+		return CONSTANTS_RADIUS_OF_EARTH * sqrtf(north_rad * north_rad + east_rad * east_rad);
+	}
+
 	double lat_now_rad = lat_now / (double)180.0 * M_PI;
 	double lon_now_rad = lon_now / (double)180.0 * M_PI;
 	double lat_next_rad = lat_next / (double)180.0 * M_PI;
@@ -291,6 +391,12 @@ __EXPORT float get_distance_to_next_waypoint(double lat_now, double lon_now, dou
 
 __EXPORT float get_bearing_to_next_waypoint(double lat_now, double lon_now, double lat_next, double lon_next)
 {
+	float north_rad, east_rad;
+
+	if (get_vector_to_next_waypoint_local(lat_now, lon_now, lat_next, lon_next, &north_rad, &east_rad)) {
+		return _wrap_pi(atan2f(east_rad, north_rad));
+	}
+
 	double lat_now_rad = lat_now * M_DEG_TO_RAD;
 	double lon_now_rad = lon_now * M_DEG_TO_RAD;
 	double lat_next_rad = lat_next * M_DEG_TO_RAD;
@@ -72,6 +72,8 @@ struct map_projection_reference_s {
 	double cos_lat;
 	bool init_done;
 	uint64_t timestamp;
+	float sin_lat_f;	// sin_lat and cos_lat for the float only projection
+	float cos_lat_f;
 };
 
 struct globallocal_converter_reference_s {
@@ -168,6 +170,45 @@ __EXPORT int map_projection_global_project(double lat, double lon, float *x, flo
  */
 __EXPORT int map_projection_project(const struct map_projection_reference_s *ref, double lat, double lon, float *x, float *y);
 
+/**
+ * Maximum distance from the reference in meters for which the fast projection
+ * functions and the waypoint distance and bearing use their small-angle
+ * approximation. The error against the exact formulas is below 1 cm within
+ * this range for references below MAP_PROJECTION_FAST_MAX_LAT degrees of
+ * latitude, further out or closer to the poles they fall back to the exact
+ * double precision formulas.
+ */
+#define MAP_PROJECTION_FAST_RANGE	5000.0f
+#define MAP_PROJECTION_FAST_MAX_LAT	75.0f
+
+/**
+ * Same as map_projection_project, but for points close to the reference it
+ * uses a second order expansion of the projection around the reference in
+ * float instead of the double precision trigonometry. Meant for the high rate
+ * conversions of estimators and controllers.
+ *
+ * @param x north
+ * @param y east
+ * @param lat in degrees (47.1234567°, not 471234567°)
+ * @param lon in degrees (8.1234567°, not 81234567°)
+ * @return 0 if map_projection_init was called before, -1 else
+ */
+__EXPORT int map_projection_project_fast(const struct map_projection_reference_s *ref, double lat, double lon, float *x,
+		float *y);
+
+/**
+ * Same as map_projection_reproject, but for points close to the reference it
+ * inverts the expansion of map_projection_project_fast in float.
+ *
+ * @param x north
+ * @param y east
+ * @param lat in degrees (47.1234567°, not 471234567°)
+ * @param lon in degrees (8.1234567°, not 81234567°)
+ * @return 0 if map_projection_init was called before, -1 else
+ */
+__EXPORT int map_projection_reproject_fast(const struct map_projection_reference_s *ref, float x, float y, double *lat,
+		double *lon);
+
 /**
  * Transforms a point in the local azimuthal equidistant plane to the
  * geographic coordinate system using the global projection
@@ -226,6 +267,8 @@ __EXPORT int globallocalconverter_getref(double *lat_0, double *lon_0, float *al
 /**
  * Returns the distance to the next waypoint in meters.
  *
+ * Waypoints within MAP_PROJECTION_FAST_RANGE are handled in float only.
+ *
  * @param lat_now current position in degrees (47.1234567°, not 471234567°)
  * @param lon_now current position in degrees (8.1234567°, not 81234567°)
  * @param lat_next next waypoint position in degrees (47.1234567°, not 471234567°)
@@ -236,6 +279,8 @@ __EXPORT float get_distance_to_next_waypoint(double lat_now, double lon_now, dou
 /**
  * Returns the bearing to the next waypoint in radians.
  *
+ * Waypoints within MAP_PROJECTION_FAST_RANGE are handled in float only.
+ *
  * @param lat_now current position in degrees (47.1234567°, not 471234567°)
  * @param lon_now current position in degrees (8.1234567°, not 81234567°)
  * @param lat_next next waypoint position in degrees (47.1234567°, not 471234567°)
@@ -45,6 +45,16 @@
 
 #include <geo/geo.h>
 
+/*
+ * A different table can be selected at build time by defining
+ * GEO_MAG_DECLINATION_TABLE to a header that provides the SAMPLING_*
+ * defines and declination_table[][] in the same layout as below, e.g.
+ * a higher resolution one. The lookup cost does not depend on the
+ * resolution.
+ */
+#ifdef GEO_MAG_DECLINATION_TABLE
+#include GEO_MAG_DECLINATION_TABLE
+#else
 /** set this always to the sampling in degrees for the table below */
 #define SAMPLING_RES		10.0f
 #define SAMPLING_MIN_LAT	-60.0f
@@ -68,9 +78,65 @@ static const int8_t declination_table[13][37] = \
     { 4, 8, 12, 15, 17, 18, 16, 12, 5, -3, -12, -18, -20, -19, -16, -13, -8, -4, -1, 1, 4, 6, 8, 9, 9, 9, 7, 3, -1, -6, -10, -12, -11, -9, -5, 0, 4 },
     { 3, 9, 14, 17, 20, 21, 19, 14, 4, -8, -19, -25, -26, -25, -21, -17, -12, -7, -2, 1, 5, 9, 13, 15, 16, 16, 13, 7, 0, -7, -12, -15, -14, -11, -6, -1, 3 },
 };
+#endif
+
+/** scale of the table entries to degrees */
+#ifndef SAMPLING_SCALE
+#define SAMPLING_SCALE		1.0f
+#endif
+
+#define SAMPLING_LAT_COUNT	((int)((SAMPLING_MAX_LAT - SAMPLING_MIN_LAT) / SAMPLING_RES) + 1)
+#define SAMPLING_LON_COUNT	((int)((SAMPLING_MAX_LON - SAMPLING_MIN_LON) / SAMPLING_RES) + 1)
+
+/*
+ * Bilinear coefficients of the last grid cell looked up. Consecutive calls
+ * mostly fall into the same cell, as the vehicle does not move far between
+ * them, so they only evaluate the polynomial. The cell is shared by all
+ * callers and guarded by a sequence count that is odd while it is written,
+ * a reader that sees it change falls back to the table.
+ */
+struct declination_cell_s {
+	unsigned key;		/**< lat_index * SAMPLING_LON_COUNT + lon_index + 1, 0 if empty */
+	float sw;		/**< value at the south west corner */
+	float d_lon;		/**< change towards east */
+	float d_lat;		/**< change towards north */
+	float d_lat_lon;	/**< twist */
+};
+
+static struct declination_cell_s declination_cell;
+static volatile unsigned declination_cell_seq;
 
 static float get_lookup_table_val(unsigned lat, unsigned lon);
 
+static bool get_cached_cell(unsigned key, struct declination_cell_s *cell)
+{
+	unsigned seq = declination_cell_seq;
+
+	if (seq & 1) {
+		return false;
+	}
+
+	__sync_synchronize();
+	*cell = declination_cell;
+	__sync_synchronize();
+
+	return cell->key == key && declination_cell_seq == seq;
+}
+
+static void set_cached_cell(const struct declination_cell_s *cell)
+{
+	unsigned seq = declination_cell_seq;
+
+	/* leave it to the other caller if two update at once */
+	if ((seq & 1) || !__sync_bool_compare_and_swap(&declination_cell_seq, seq, seq + 1)) {
+		return;
+	}
+
+	declination_cell = *cell;
+	__sync_synchronize();
+	declination_cell_seq = seq + 2;
+}
+
 __EXPORT float get_mag_declination(float lat, float lon)
 {
 	/*
@@ -83,49 +149,56 @@ __EXPORT float get_mag_declination(float lat, float lon)
 		return 0.0f;
 	}
 
-	/* round down to nearest sampling resolution */
-	int min_lat = (int)(lat / SAMPLING_RES) * SAMPLING_RES;
-	int min_lon = (int)(lon / SAMPLING_RES) * SAMPLING_RES;
-
-	/* for the rare case of hitting the bounds exactly
-	 * the rounding logic wouldn't fit, so enforce it.
-	 */
-
-	/* limit to table bounds - required for maxima even when table spans full globe range */
-	if (lat <= SAMPLING_MIN_LAT) {
-		min_lat = SAMPLING_MIN_LAT;
+	/* limit to table bounds, beyond them the edge of the table is used */
+	if (lat < SAMPLING_MIN_LAT) {
+		lat = SAMPLING_MIN_LAT;
 	}
 
-	if (lat >= SAMPLING_MAX_LAT) {
-		min_lat = (int)(lat / SAMPLING_RES) * SAMPLING_RES - SAMPLING_RES;
+	if (lat > SAMPLING_MAX_LAT) {
+		lat = SAMPLING_MAX_LAT;
 	}
 
-	if (lon <= SAMPLING_MIN_LON) {
-		min_lon = SAMPLING_MIN_LON;
+	if (lon < SAMPLING_MIN_LON) {
+		lon = SAMPLING_MIN_LON;
 	}
 
-	if (lon >= SAMPLING_MAX_LON) {
-		min_lon = (int)(lon / SAMPLING_RES) * SAMPLING_RES - SAMPLING_RES;
+	if (lon > SAMPLING_MAX_LON) {
+		lon = SAMPLING_MAX_LON;
 	}
 
-	/* find index of nearest low sampling point */
-	unsigned min_lat_index = (-(SAMPLING_MIN_LAT) + min_lat)  / SAMPLING_RES;
-	unsigned min_lon_index = (-(SAMPLING_MIN_LON) + min_lon) / SAMPLING_RES;
-
-	float declination_sw = get_lookup_table_val(min_lat_index, min_lon_index);
-	float declination_se = get_lookup_table_val(min_lat_index, min_lon_index + 1);
-	float declination_ne = get_lookup_table_val(min_lat_index + 1, min_lon_index + 1);
-	float declination_nw = get_lookup_table_val(min_lat_index + 1, min_lon_index);
+	/* position in the table in samples, the cell is its integer part */
+	float lat_pos = (lat - SAMPLING_MIN_LAT) * (1.0f / SAMPLING_RES);
+	float lon_pos = (lon - SAMPLING_MIN_LON) * (1.0f / SAMPLING_RES);
+
+	/* the upper bounds belong to the last cell */
+	unsigned lat_index = (lat_pos < SAMPLING_LAT_COUNT - 1) ? (unsigned)lat_pos : SAMPLING_LAT_COUNT - 2;
+	unsigned lon_index = (lon_pos < SAMPLING_LON_COUNT - 1) ? (unsigned)lon_pos : SAMPLING_LON_COUNT - 2;
+	unsigned key = lat_index * SAMPLING_LON_COUNT + lon_index + 1;
+
+	struct declination_cell_s cell;
+
+	if (!get_cached_cell(key, &cell)) {
+		float declination_sw = get_lookup_table_val(lat_index, lon_index);
+		float declination_se = get_lookup_table_val(lat_index, lon_index + 1);
+		float declination_ne = get_lookup_table_val(lat_index + 1, lon_index + 1);
+		float declination_nw = get_lookup_table_val(lat_index + 1, lon_index);
+
+		cell.key = key;
+		cell.sw = declination_sw;
+		cell.d_lon = declination_se - declination_sw;
+		cell.d_lat = declination_nw - declination_sw;
+		cell.d_lat_lon = declination_ne - declination_nw - declination_se + declination_sw;
+		set_cached_cell(&cell);
+	}
 
 	/* perform bilinear interpolation on the four grid corners */
+	float u = lon_pos - lon_index;
+	float v = lat_pos - lat_index;
 
-	float declination_min = ((lon - min_lon) / SAMPLING_RES) * (declination_se - declination_sw) + declination_sw;
-	float declination_max = ((lon - min_lon) / SAMPLING_RES) * (declination_ne - declination_nw) + declination_nw;
-
-	return ((lat - min_lat) / SAMPLING_RES) * (declination_max - declination_min) + declination_min;
+	return cell.sw + u * cell.d_lon + v * (cell.d_lat + u * cell.d_lat_lon);
 }
 
 float get_lookup_table_val(unsigned lat_index, unsigned lon_index)
 {
-	return declination_table[lat_index][lon_index];
-}
\ No newline at end of file
+	return declination_table[lat_index][lon_index] * SAMPLING_SCALE;
+}
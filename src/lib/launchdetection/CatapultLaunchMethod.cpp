@@ -47,8 +47,8 @@ namespace launchdetection
 
 CatapultLaunchMethod::CatapultLaunchMethod(SuperBlock *parent) :
 	SuperBlock(parent, "CAT"),
-	last_timestamp(hrt_absolute_time()),
 	integrator(0.0f),
+	motorDelayCounter(0.0f),
 	state(LAUNCHDETECTION_RES_NONE),
 	thresholdAccel(this, "A"),
 	thresholdTime(this, "T"),
@@ -63,11 +63,8 @@ CatapultLaunchMethod::~CatapultLaunchMethod()
 
 }
 
-void CatapultLaunchMethod::update(float accel_x)
+void CatapultLaunchMethod::update(float dt, float accel_x)
 {
-	float dt = (float)hrt_elapsed_time(&last_timestamp) * 1e-6f;
-	last_timestamp = hrt_absolute_time();
-
 	switch (state) {
 	case LAUNCHDETECTION_RES_NONE:
 
@@ -56,13 +56,12 @@ public:
 	CatapultLaunchMethod(SuperBlock *parent);
 	~CatapultLaunchMethod();
 
-	void update(float accel_x);
+	void update(float dt, float accel_x);
 	LaunchDetectionResult getLaunchDetected() const;
 	void reset();
 	float getPitchMax(float pitchMaxDefault);
 
 private:
-	hrt_abstime last_timestamp;
 	float integrator;
 	float motorDelayCounter;
 
@@ -40,6 +40,9 @@
 #include "LaunchDetector.h"
 #include "CatapultLaunchMethod.h"
 #include <systemlib/err.h>
+#include <conversion/rotation.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/sensor_accel.h>
 
 namespace launchdetection
 {
@@ -48,7 +51,12 @@ LaunchDetector::LaunchDetector() :
 	SuperBlock(NULL, "LAUN"),
 	activeLaunchDetectionMethodIndex(-1),
 	launchdetection_on(this, "ALL_ON"),
-	throttlePreTakeoff(this, "THR_PRE")
+	throttlePreTakeoff(this, "THR_PRE"),
+	accelSub(-1),
+	lastAccelTimestamp(0),
+	boardRotation(),
+	boardRotationParam(param_find("SENS_BOARD_ROT")),
+	boardOffsetParams{param_find("SENS_BOARD_X_OFF"), param_find("SENS_BOARD_Y_OFF"), param_find("SENS_BOARD_Z_OFF")}
 {
 	/* init all detectors */
 	launchMethods[0] = new CatapultLaunchMethod(this);
@@ -63,6 +71,26 @@ LaunchDetector::~LaunchDetector()
 
 }
 
+void LaunchDetector::updateParams()
+{
+	SuperBlock::updateParams();
+
+	/* the accel reports are not rotated to the body frame yet, do it like the sensors app */
+	int32_t rotation = 0;
+	float offset[3] = {};
+	param_get(boardRotationParam, &rotation);
+
+	for (unsigned i = 0; i < 3; i++) {
+		param_get(boardOffsetParams[i], &offset[i]);
+	}
+
+	get_rot_matrix((enum Rotation)rotation, &boardRotation);
+
+	math::Matrix<3, 3> boardRotationOffset;
+	boardRotationOffset.from_euler(M_DEG_TO_RAD_F * offset[0], M_DEG_TO_RAD_F * offset[1], M_DEG_TO_RAD_F * offset[2]);
+	boardRotation = boardRotationOffset * boardRotation;
+}
+
 void LaunchDetector::reset()
 {
 	/* Reset all detectors */
@@ -76,11 +104,48 @@ void LaunchDetector::reset()
 
 }
 
-void LaunchDetector::update(float accel_x)
+void LaunchDetector::update()
 {
-	if (launchdetection_on.get() == 1) {
-		for (unsigned i = 0; i < (sizeof(launchMethods) / sizeof(launchMethods[0])); i++) {
-			launchMethods[i]->update(accel_x);
+	/* subscribed here and not in the constructor, on the task of the caller */
+	if (accelSub < 0) {
+		accelSub = orb_subscribe_multi(ORB_ID(sensor_accel), 0);
+	}
+
+	bool updated = false;
+
+	/* the drivers queue their reports, so this sees all of them whatever the rate of the caller */
+	while (orb_check(accelSub, &updated) == OK && updated) {
+		struct sensor_accel_s accel;
+		orb_copy(ORB_ID(sensor_accel), accelSub, &accel);
+
+		/* left in the queue while the detector was not running */
+		if (hrt_elapsed_time(&accel.timestamp) > 500000) {
+			lastAccelTimestamp = 0;
+			continue;
+		}
+
+		float dt;
+		math::Vector<3> a;
+
+		if (accel.integral_dt > 0) {
+			/* the mean over the whole interval, peaks between the reports count as well */
+			dt = accel.integral_dt * 1e-6f;
+			a = math::Vector<3>(accel.x_integral, accel.y_integral, accel.z_integral) / dt;
+
+		} else {
+			dt = (lastAccelTimestamp > 0 && accel.timestamp > lastAccelTimestamp) ?
+			     (accel.timestamp - lastAccelTimestamp) * 1e-6f : 0.0f;
+			a = math::Vector<3>(accel.x, accel.y, accel.z);
+		}
+
+		lastAccelTimestamp = accel.timestamp;
+
+		if (launchdetection_on.get() == 1) {
+			float accel_x = (boardRotation * a)(0);
+
+			for (unsigned i = 0; i < (sizeof(launchMethods) / sizeof(launchMethods[0])); i++) {
+				launchMethods[i]->update(dt, accel_x);
+			}
 		}
 	}
 }
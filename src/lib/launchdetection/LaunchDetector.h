@@ -47,6 +47,9 @@
 #include "LaunchMethod.h"
 #include <controllib/blocks.hpp>
 #include <controllib/block/BlockParam.hpp>
+#include <drivers/drv_hrt.h>
+#include <mathlib/mathlib.h>
+#include <systemlib/param/param.h>
 
 namespace launchdetection
 {
@@ -58,7 +61,9 @@ public:
 	~LaunchDetector();
 	void reset();
 
-	void update(float accel_x);
+	/* Feed every accelerometer sample published since the last call to the launch methods */
+	void update();
+	void updateParams();
 	LaunchDetectionResult getLaunchDetected();
 	bool launchDetectionEnabled() { return (bool)launchdetection_on.get(); };
 
@@ -80,6 +85,12 @@ private:
 	control::BlockParamInt launchdetection_on;
 	control::BlockParamFloat throttlePreTakeoff;
 
+	int accelSub; /**< queued reports of the primary accelerometer, in sensor frame */
+	hrt_abstime lastAccelTimestamp;
+	math::Matrix<3, 3> boardRotation; /**< sensor to body frame, as applied by the sensors app */
+	param_t boardRotationParam;
+	param_t boardOffsetParams[3];
+
 
 };
 
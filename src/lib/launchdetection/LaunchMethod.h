@@ -58,7 +58,8 @@ enum LaunchDetectionResult {
 class LaunchMethod
 {
 public:
-	virtual void update(float accel_x) = 0;
+	/* Feed one acceleration sample in body x direction, dt is the time it covers */
+	virtual void update(float dt, float accel_x) = 0;
 	virtual LaunchDetectionResult getLaunchDetected() const = 0;
 	virtual void reset() = 0;
 
@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file GaussNoise.cpp
+ */
+
+#include "GaussNoise.hpp"
+
+#include <math.h>
+
+namespace math
+{
+
+namespace
+{
+
+/* splitmix64, spreads a seed over the whole xorshift state */
+uint64_t splitmix64(uint64_t &x)
+{
+	uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+uint64_t seed_counter = 0;
+
+/* the pairs of uniforms of one pass of fill() */
+const unsigned kPairs = 32;
+
+}
+
+GaussNoise::GaussNoise() :
+	_index(kBlockSize)
+{
+	seed(++seed_counter);
+}
+
+GaussNoise::GaussNoise(uint64_t seed_value) :
+	_index(kBlockSize)
+{
+	seed(seed_value);
+}
+
+void GaussNoise::seed(uint64_t seed_value)
+{
+	_state[0] = splitmix64(seed_value);
+	_state[1] = splitmix64(seed_value);
+	_index = kBlockSize;
+}
+
+void GaussNoise::fill(float *out, unsigned n, float mean, float std_dev)
+{
+	/* 24 bit uniforms, the radius one in (0, 1] so its log is finite */
+	const float scale = 1.0f / 16777216.0f;
+	float radius[kPairs];
+	float angle[kPairs];
+
+	while (n > 0) {
+		unsigned pairs = (n + 1) / 2;
+
+		if (pairs > kPairs) {
+			pairs = kPairs;
+		}
+
+		for (unsigned i = 0; i < pairs; i++) {
+			uint64_t r = next_u64();
+			radius[i] = ((uint32_t)(r >> 40) + 1) * scale;
+			angle[i] = ((uint32_t)(r >> 16) & 0xFFFFFF) * scale;
+		}
+
+		for (unsigned i = 0; i < pairs; i++) {
+			radius[i] = std_dev * sqrtf(-2.0f * logf(radius[i]));
+			angle[i] *= 2.0f * M_PI_F;
+		}
+
+		unsigned count = (2 * pairs < n) ? 2 * pairs : n;
+
+		for (unsigned i = 0; i < count / 2; i++) {
+			out[2 * i] = mean + radius[i] * cosf(angle[i]);
+			out[2 * i + 1] = mean + radius[i] * sinf(angle[i]);
+		}
+
+		/* an odd count drops the sine of the last pair */
+		if (count & 1) {
+			out[count - 1] = mean + radius[count / 2] * cosf(angle[count / 2]);
+		}
+
+		out += count;
+		n -= count;
+	}
+}
+
+} // namespace math
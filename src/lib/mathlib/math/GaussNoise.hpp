@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file GaussNoise.hpp
+ *
+ * Gaussian noise generator producing blocks of samples, for the sensor
+ * simulation and controllib's BlockRandGauss.
+ */
+
+#pragma once
+
+#include <px4_defines.h>
+#include <stdint.h>
+
+namespace math
+{
+
+/**
+ * Normal distributed samples from a xorshift128+ generator and the
+ * Box-Muller transform.
+ *
+ * A block is made in two loops: the integer generator first fills the
+ * uniforms, then the transform runs over all pairs without a dependency
+ * between iterations or a rejection loop, so the compiler can unroll or
+ * vectorize it. Every generator has its own state, there is no lock and
+ * no shared rand() state.
+ */
+class __EXPORT GaussNoise
+{
+public:
+	static const unsigned kBlockSize = 16;	/**< samples made at once by next() */
+
+	/**
+	 * Seed from a counter, so every generator of a run gets its own
+	 * sequence and every run gets the same ones
+	 */
+	GaussNoise();
+
+	explicit GaussNoise(uint64_t seed);
+
+	void seed(uint64_t seed);
+
+	/**
+	 * Fill out with n samples of mean and standard deviation std_dev
+	 */
+	void fill(float *out, unsigned n, float mean = 0.0f, float std_dev = 1.0f);
+
+	/**
+	 * One sample of the standard normal distribution
+	 */
+	float next()
+	{
+		if (_index >= kBlockSize) {
+			fill(_block, kBlockSize);
+			_index = 0;
+		}
+
+		return _block[_index++];
+	}
+
+private:
+	uint64_t _state[2];
+	float _block[kBlockSize];
+	unsigned _index;
+
+	uint64_t next_u64()
+	{
+		uint64_t s1 = _state[0];
+		const uint64_t s0 = _state[1];
+		_state[0] = s0;
+		s1 ^= s1 << 23;
+		_state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+		return _state[1] + s0;
+	}
+};
+
+} // namespace math
@@ -60,6 +60,109 @@ namespace math
 template<unsigned int M, unsigned int N>
 class __EXPORT Matrix;
 
+template<unsigned int M, unsigned int N>
+class __EXPORT MatrixBase;
+
+/**
+ * MxN transpose of a NxM matrix, evaluated lazily
+ *
+ * Returned by transposed(), so that products like R.transposed() * R_sp
+ * read the operand in transposed order in a single loop instead of
+ * building the transposed matrix first. Converts to a Matrix where one
+ * is needed. It only refers to the operand, so it must not outlive the
+ * statement it was created in.
+ */
+template <unsigned int M, unsigned int N>
+class __EXPORT MatrixTransposed
+{
+public:
+	explicit MatrixTransposed(const MatrixBase<N, M> &m) :
+		_m(m)
+	{
+	}
+
+	/**
+	 * access by index
+	 */
+	float operator()(const unsigned int row, const unsigned int col) const {
+		return _m.data[col][row];
+	}
+
+	/**
+	 * evaluate the transpose
+	 */
+	operator Matrix<M, N>() const {
+		Matrix<M, N> res;
+
+		for (unsigned int i = 0; i < M; i++)
+			for (unsigned int j = 0; j < N; j++)
+				res.data[i][j] = _m.data[j][i];
+
+		return res;
+	}
+
+	/**
+	 * multiplication by a matrix
+	 */
+	template <unsigned int P>
+	Matrix<M, P> operator *(const MatrixBase<N, P> &m) const {
+		Matrix<M, P> res;
+
+		for (unsigned int i = 0; i < M; i++)
+			for (unsigned int k = 0; k < P; k++) {
+				float sum = 0.0f;
+
+				for (unsigned int j = 0; j < N; j++)
+					sum += _m.data[j][i] * m.data[j][k];
+
+				res.data[i][k] = sum;
+			}
+
+		return res;
+	}
+
+	/**
+	 * multiplication by a transposed matrix
+	 */
+	template <unsigned int P>
+	Matrix<M, P> operator *(const MatrixTransposed<N, P> &m) const {
+		Matrix<M, P> res;
+
+		for (unsigned int i = 0; i < M; i++)
+			for (unsigned int k = 0; k < P; k++) {
+				float sum = 0.0f;
+
+				for (unsigned int j = 0; j < N; j++)
+					sum += _m.data[j][i] * m(j, k);
+
+				res.data[i][k] = sum;
+			}
+
+		return res;
+	}
+
+	/**
+	 * multiplication by a vector
+	 */
+	Vector<M> operator *(const Vector<N> &v) const {
+		Vector<M> res;
+
+		for (unsigned int i = 0; i < M; i++) {
+			float sum = 0.0f;
+
+			for (unsigned int j = 0; j < N; j++)
+				sum += _m.data[j][i] * v.data[j];
+
+			res.data[i] = sum;
+		}
+
+		return res;
+	}
+
+private:
+	const MatrixBase<N, M> &_m;
+};
+
 // MxN matrix with float elements
 template <unsigned int M, unsigned int N>
 class __EXPORT MatrixBase
@@ -300,39 +403,52 @@ public:
 
 	/**
 	 * multiplication by another matrix
+	 *
+	 * The loops have constant bounds, so for the small sizes used in the
+	 * controllers the compiler unrolls them completely.
 	 */
 	template <unsigned int P>
-	Matrix<M, P> operator *(const Matrix<N, P> &m) const {
-#ifdef CONFIG_ARCH_ARM
+	Matrix<M, P> operator *(const MatrixBase<N, P> &m) const {
 		Matrix<M, P> res;
-		arm_mat_mult_f32(&arm_mat, &m.arm_mat, &res.arm_mat);
+
+		for (unsigned int i = 0; i < M; i++)
+			for (unsigned int k = 0; k < P; k++) {
+				float sum = 0.0f;
+
+				for (unsigned int j = 0; j < N; j++)
+					sum += data[i][j] * m.data[j][k];
+
+				res.data[i][k] = sum;
+			}
+
 		return res;
-#else
-		Eigen::Matrix<float, M, N, Eigen::RowMajor> Me = Eigen::Map<Eigen::Matrix<float, M, N, Eigen::RowMajor> >
-				(this->arm_mat.pData);
-		Eigen::Matrix<float, N, P, Eigen::RowMajor> Him = Eigen::Map<Eigen::Matrix<float, N, P, Eigen::RowMajor> >
-				(m.arm_mat.pData);
-		Eigen::Matrix<float, M, P, Eigen::RowMajor> Product = Me * Him;
-		Matrix<M, P> res(Product.data());
+	}
+
+	/**
+	 * multiplication by a transposed matrix
+	 */
+	template <unsigned int P>
+	Matrix<M, P> operator *(const MatrixTransposed<N, P> &m) const {
+		Matrix<M, P> res;
+
+		for (unsigned int i = 0; i < M; i++)
+			for (unsigned int k = 0; k < P; k++) {
+				float sum = 0.0f;
+
+				for (unsigned int j = 0; j < N; j++)
+					sum += data[i][j] * m(j, k);
+
+				res.data[i][k] = sum;
+			}
+
 		return res;
-#endif
 	}
 
 	/**
 	 * transpose the matrix
 	 */
-	Matrix<N, M> transposed(void) const {
-#ifdef CONFIG_ARCH_ARM
-		Matrix<N, M> res;
-		arm_mat_trans_f32(&this->arm_mat, &res.arm_mat);
-		return res;
-#else
-		Eigen::Matrix<float, N, M, Eigen::RowMajor> Me = Eigen::Map<Eigen::Matrix<float, N, M, Eigen::RowMajor> >
-				(this->arm_mat.pData);
-		Me.transposeInPlace();
-		Matrix<N, M> res(Me.data());
-		return res;
-#endif
+	MatrixTransposed<N, M> transposed(void) const {
+		return MatrixTransposed<N, M>(*this);
 	}
 
 	/**
@@ -408,17 +524,17 @@ public:
 	 * multiplication by a vector
 	 */
 	Vector<M> operator *(const Vector<N> &v) const {
-#ifdef CONFIG_ARCH_ARM
 		Vector<M> res;
-		arm_mat_mult_f32(&this->arm_mat, &v.arm_col, &res.arm_col);
-#else
-		//probably nicer if this could go into a function like "eigen_mat_mult" or so
-		Eigen::Matrix<float, M, N, Eigen::RowMajor> Me = Eigen::Map<Eigen::Matrix<float, M, N, Eigen::RowMajor> >
-				(this->arm_mat.pData);
-		Eigen::VectorXf Vec = Eigen::Map<Eigen::VectorXf>(v.arm_col.pData, N);
-		Eigen::VectorXf Product = Me * Vec;
-		Vector<M> res(Product.data());
-#endif
+
+		for (unsigned int i = 0; i < M; i++) {
+			float sum = 0.0f;
+
+			for (unsigned int j = 0; j < N; j++)
+				sum += this->data[i][j] * v.data[j];
+
+			res.data[i] = sum;
+		}
+
 		return res;
 	}
 };
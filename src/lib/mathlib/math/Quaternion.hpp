@@ -121,6 +121,47 @@ public:
 		return Q * v * 0.5f;
 	}
 
+	/**
+	 * integrate the angular rate w over dt in place, same as
+	 * *this += derivative(w) * dt without the temporaries
+	 */
+	void integrate(const Vector<3> &w, float dt) {
+		float hx = 0.5f * dt * w.data[0];
+		float hy = 0.5f * dt * w.data[1];
+		float hz = 0.5f * dt * w.data[2];
+		float q0 = data[0];
+		float q1 = data[1];
+		float q2 = data[2];
+		float q3 = data[3];
+
+		data[0] += -q1 * hx - q2 * hy - q3 * hz;
+		data[1] +=  q0 * hx - q3 * hy + q2 * hz;
+		data[2] +=  q3 * hx + q0 * hy - q1 * hz;
+		data[3] += -q2 * hx + q1 * hy + q0 * hz;
+	}
+
+	/**
+	 * normalize a quaternion which is already close to unit length,
+	 * e.g. after one integration step
+	 *
+	 * Close to 1 a Newton step of 1 / sqrt(n) from 1 is accurate to
+	 * (n - 1)^2, further away this falls back to normalize().
+	 */
+	void normalize_fast() {
+		float n = length_squared();
+
+		if (fabsf(n - 1.0f) < 1.0e-2f) {
+			float s = 0.5f * (3.0f - n);
+			data[0] *= s;
+			data[1] *= s;
+			data[2] *= s;
+			data[3] *= s;
+
+		} else {
+			normalize();
+		}
+	}
+
 	/**
 	 * conjugate
 	 */
@@ -261,6 +302,14 @@ public:
 	 */
 	Matrix<3, 3> to_dcm(void) const {
 		Matrix<3, 3> R;
+		to_dcm(R);
+		return R;
+	}
+
+	/**
+	 * fill a rotation matrix for the quaternion in place
+	 */
+	void to_dcm(Matrix<3, 3> &R) const {
 		float aSq = data[0] * data[0];
 		float bSq = data[1] * data[1];
 		float cSq = data[2] * data[2];
@@ -274,7 +323,6 @@ public:
 		R.data[2][0] = 2.0f * (data[1] * data[3] - data[0] * data[2]);
 		R.data[2][1] = 2.0f * (data[0] * data[1] + data[2] * data[3]);
 		R.data[2][2] = aSq - bSq - cSq + dSq;
-		return R;
 	}
 };
 
@@ -0,0 +1,70 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file BiquadFilterBank.cpp
+ *
+ * Coefficients of the second order filter stages.
+ */
+
+#include <px4_defines.h>
+#include "BiquadFilterBank.hpp"
+
+namespace math
+{
+
+void BiquadCoefficients::set_lowpass(float sample_freq, float cutoff_freq)
+{
+	float fr = sample_freq / cutoff_freq;
+	float ohm = tanf(M_PI_F / fr);
+	float c = 1.0f + 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm;
+	b0 = ohm * ohm / c;
+	b1 = 2.0f * b0;
+	b2 = b0;
+	a1 = 2.0f * (ohm * ohm - 1.0f) / c;
+	a2 = (1.0f - 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm) / c;
+}
+
+void BiquadCoefficients::set_notch(float sample_freq, float notch_freq, float bandwidth)
+{
+	float omega = 2.0f * M_PI_F * notch_freq / sample_freq;
+	float alpha = sinf(omega) * bandwidth / (2.0f * notch_freq);
+	float c = 1.0f + alpha;
+	b0 = 1.0f / c;
+	b1 = -2.0f * cosf(omega) / c;
+	b2 = b0;
+	a1 = b1;
+	a2 = (1.0f - alpha) / c;
+}
+
+} // namespace math
@@ -0,0 +1,206 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file BiquadFilterBank.hpp
+ *
+ * Second order low pass and notch filters for a fixed number of channels
+ * sharing their coefficients, e.g. the three axes of an IMU sensor.
+ */
+
+#pragma once
+
+#include <px4_defines.h>
+#include <math.h>
+
+namespace math
+{
+
+/**
+ * Coefficients of one direct form II biquad stage,
+ * y = b0 * w0 + b1 * w1 + b2 * w2 with w0 = x - a1 * w1 - a2 * w2.
+ */
+struct __EXPORT BiquadCoefficients {
+	float a1;
+	float a2;
+	float b0;
+	float b1;
+	float b2;
+
+	/**
+	 * Second order Butterworth low pass, as used by LowPassFilter2p.
+	 */
+	void set_lowpass(float sample_freq, float cutoff_freq);
+
+	/**
+	 * Second order notch rejecting notch_freq, bandwidth wide at -3 dB.
+	 */
+	void set_notch(float sample_freq, float notch_freq, float bandwidth);
+};
+
+/**
+ * Bank of N second order filter channels, each an optional low pass
+ * followed by an optional notch.
+ *
+ * The state is stored per stage and channel, so one apply() runs the
+ * same coefficients over all channels in a loop with constant bounds
+ * instead of one call and one coefficient set per axis.
+ */
+template <unsigned N>
+class __EXPORT BiquadFilterBank
+{
+public:
+	BiquadFilterBank(float sample_freq, float cutoff_freq) :
+		_sample_freq(sample_freq),
+		_cutoff_freq(0.0f),
+		_notch_freq(0.0f),
+		_notch_bandwidth(0.0f)
+	{
+		set_cutoff_frequency(sample_freq, cutoff_freq);
+		reset_state(0.0f);
+	}
+
+	/**
+	 * Change the low pass, a cutoff of 0 disables it
+	 */
+	void set_cutoff_frequency(float sample_freq, float cutoff_freq) {
+		_sample_freq = sample_freq;
+		_cutoff_freq = cutoff_freq;
+
+		if (cutoff_freq > 0.0f) {
+			_coef[LOWPASS].set_lowpass(sample_freq, cutoff_freq);
+		}
+
+		if (_notch_freq > 0.0f) {
+			_coef[NOTCH].set_notch(sample_freq, _notch_freq, _notch_bandwidth);
+		}
+	}
+
+	/**
+	 * Change the notch, a notch frequency of 0 disables it
+	 */
+	void set_notch_frequency(float notch_freq, float bandwidth) {
+		_notch_freq = notch_freq;
+		_notch_bandwidth = bandwidth;
+
+		if (notch_freq > 0.0f) {
+			_coef[NOTCH].set_notch(_sample_freq, notch_freq, bandwidth);
+		}
+	}
+
+	float get_cutoff_freq() const {
+		return _cutoff_freq;
+	}
+
+	float get_notch_freq() const {
+		return _notch_freq;
+	}
+
+	/**
+	 * Filter one sample per channel in place
+	 */
+	void apply(float sample[N]) {
+		if (_cutoff_freq > 0.0f) {
+			apply_stage(LOWPASS, sample);
+		}
+
+		if (_notch_freq > 0.0f) {
+			apply_stage(NOTCH, sample);
+		}
+	}
+
+	/**
+	 * Reset the state of all channels to their steady state for this
+	 * sample, and filter it
+	 */
+	void reset(float sample[N]) {
+		for (unsigned s = 0; s < STAGES; s++) {
+			if (stage_enabled(s)) {
+				// both stages have unity gain at DC, so each sees the sample
+				float scale = 1.0f / (1.0f + _coef[s].a1 + _coef[s].a2);
+
+				for (unsigned i = 0; i < N; i++) {
+					_delay_1[s][i] = sample[i] * scale;
+					_delay_2[s][i] = sample[i] * scale;
+				}
+			}
+		}
+
+		apply(sample);
+	}
+
+private:
+	enum { LOWPASS = 0, NOTCH, STAGES };
+
+	bool stage_enabled(unsigned stage) const {
+		return (stage == LOWPASS) ? (_cutoff_freq > 0.0f) : (_notch_freq > 0.0f);
+	}
+
+	void reset_state(float value) {
+		for (unsigned s = 0; s < STAGES; s++) {
+			for (unsigned i = 0; i < N; i++) {
+				_delay_1[s][i] = value;
+				_delay_2[s][i] = value;
+			}
+		}
+	}
+
+	void apply_stage(unsigned stage, float sample[N]) {
+		const BiquadCoefficients &c = _coef[stage];
+		float *d1 = _delay_1[stage];
+		float *d2 = _delay_2[stage];
+
+		for (unsigned i = 0; i < N; i++) {
+			float delay_element_0 = sample[i] - d1[i] * c.a1 - d2[i] * c.a2;
+
+			if (!PX4_ISFINITE(delay_element_0)) {
+				// don't allow bad values to propagate via the filter
+				delay_element_0 = sample[i];
+			}
+
+			sample[i] = delay_element_0 * c.b0 + d1[i] * c.b1 + d2[i] * c.b2;
+			d2[i] = d1[i];
+			d1[i] = delay_element_0;
+		}
+	}
+
+	float _sample_freq;
+	float _cutoff_freq;
+	float _notch_freq;
+	float _notch_bandwidth;
+	BiquadCoefficients _coef[STAGES];
+	float _delay_1[STAGES][N];	// buffered sample -1 per channel
+	float _delay_2[STAGES][N];	// buffered sample -2 per channel
+};
+
+} // namespace math
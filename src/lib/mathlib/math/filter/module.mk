@@ -34,7 +34,8 @@
 #
 # filter library
 #
-SRCS		 = LowPassFilter2p.cpp
+SRCS		 = LowPassFilter2p.cpp \
+		   BiquadFilterBank.cpp
 
 #
 # In order to include .config we first have to save off the
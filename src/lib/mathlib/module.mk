@@ -35,6 +35,7 @@
 # Math library
 #
 SRCS		 = math/test/test.cpp \
+		   math/GaussNoise.cpp \
 		   math/Limits.cpp
 
 #
@@ -0,0 +1,504 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file attitude_ekf.cpp
+ *
+ * The generated code multiplies the full 12x12 Jacobian and 0/1 observation
+ * matrices and solves with temporaries sized per measurement combination.
+ * Here the block structure is spelt out: the covariance prediction only
+ * visits the non-zero blocks of the Jacobian, the observation selects rows
+ * and columns of the covariance, and all loops have compile time bounds.
+ * The accumulations are plain a * b + c chains, which GCC contracts to
+ * vfma.f32 on the Cortex-M4F (gnu99 / gnu++0x default to -ffp-contract=fast).
+ */
+
+#include "attitude_ekf.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace attitude_ekf
+{
+
+namespace
+{
+
+constexpr unsigned N = 12;		///< states: rates, angular accelerations, gravity and mag vector
+constexpr unsigned M_MAX = 9;		///< measurements: gyro, accel and mag
+
+/* column major, as the generated code */
+inline unsigned idx(unsigned row, unsigned col) { return row + N * col; }
+
+/* the filter state */
+float x_apo[N];
+float P_apo[N * N];
+float Q[N];			///< process noise, the diagonal of Q
+bool Q_set;
+float Ji[9];
+bool Ji_set;
+
+/* scratch, off the task stack as the static temporaries of the generated code */
+float FP[N * N];
+float P_apr[N * N];
+float K[N * M_MAX];
+float LU[M_MAX * M_MAX];
+
+/**
+ * The blocks of the Jacobian F = I + A_lin * dt that are not 0 or I:
+ * rows 0-2 add dt times the angular accelerations to the rates, rows 6-8
+ * and 9-11 take dEZ / dMA * dt of the rates and F_vec of the vector itself.
+ */
+struct Jacobian {
+	float dt;
+	float dEZ[9];		///< row major
+	float dMA[9];
+	float F_vec[9];		///< I + O * dt
+};
+
+/**
+ * out = F * in for one column (stride 1) or one row (stride N) of a matrix.
+ */
+template<unsigned STRIDE>
+inline void apply_jacobian(const Jacobian &F, const float *in, float *out)
+{
+	for (unsigned i = 0; i < 3; i++) {
+		out[i * STRIDE] = in[i * STRIDE] + F.dt * in[(i + 3) * STRIDE];
+		out[(i + 3) * STRIDE] = in[(i + 3) * STRIDE];
+	}
+
+	for (unsigned i = 0; i < 3; i++) {
+		float ez = 0.0f;
+		float ma = 0.0f;
+
+		for (unsigned k = 0; k < 3; k++) {
+			ez += F.dEZ[3 * i + k] * in[k * STRIDE];
+			ma += F.dMA[3 * i + k] * in[k * STRIDE];
+		}
+
+		for (unsigned k = 0; k < 3; k++) {
+			ez += F.F_vec[3 * i + k] * in[(k + 6) * STRIDE];
+			ma += F.F_vec[3 * i + k] * in[(k + 9) * STRIDE];
+		}
+
+		out[(i + 6) * STRIDE] = ez;
+		out[(i + 9) * STRIDE] = ma;
+	}
+}
+
+inline void mul3(const float A[9], const float v[3], float out[3])
+{
+	for (unsigned i = 0; i < 3; i++) {
+		out[i] = A[3 * i + 0] * v[0] + A[3 * i + 1] * v[1] + A[3 * i + 2] * v[2];
+	}
+}
+
+inline float norm3(const float v[3])
+{
+	return sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+inline void cross3(const float a[3], const float b[3], float out[3])
+{
+	out[0] = a[1] * b[2] - a[2] * b[1];
+	out[1] = a[2] * b[0] - a[0] * b[2];
+	out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/**
+ * Inverse of a column major 3x3 matrix by its cofactors.
+ */
+void inv3(const float A[9], float out[9])
+{
+	const float a = A[0], b = A[3], c = A[6];
+	const float d = A[1], e = A[4], f = A[7];
+	const float g = A[2], h = A[5], k = A[8];
+
+	const float c00 = e * k - f * h;
+	const float c01 = f * g - d * k;
+	const float c02 = d * h - e * g;
+	const float det_inv = 1.0f / (a * c00 + b * c01 + c * c02);
+
+	out[0] = c00 * det_inv;
+	out[1] = c01 * det_inv;
+	out[2] = c02 * det_inv;
+	out[3] = (c * h - b * k) * det_inv;
+	out[4] = (a * k - c * g) * det_inv;
+	out[5] = (b * g - a * h) * det_inv;
+	out[6] = (b * f - c * e) * det_inv;
+	out[7] = (c * d - a * f) * det_inv;
+	out[8] = (a * e - b * d) * det_inv;
+}
+
+/**
+ * Measurement update with M of the measurements, the state sensed by
+ * measurement j is state[j] and directly observed (H is a row selection).
+ *
+ * K = P H' / (H P H' + R) is solved as in MATLAB's mrdivide, by an LU
+ * decomposition with partial pivoting of S', then x and P are corrected
+ * from the selected rows of P_apr only.
+ */
+template<unsigned M>
+void fuse(const unsigned (&state)[M], const unsigned (&meas)[M], const float (&r)[M],
+	  const float z[9], const float x_apr[N])
+{
+	/* LU = S' = (H P H' + R)', row major */
+	for (unsigned i = 0; i < M; i++) {
+		for (unsigned j = 0; j < M; j++) {
+			LU[i * M + j] = P_apr[idx(state[j], state[i])];
+		}
+
+		LU[i * M + i] += r[i];
+	}
+
+	unsigned pivot[M];
+
+	for (unsigned k = 0; k < M; k++) {
+		unsigned p = k;
+		float largest = fabsf(LU[k * M + k]);
+
+		for (unsigned i = k + 1; i < M; i++) {
+			if (fabsf(LU[i * M + k]) > largest) {
+				largest = fabsf(LU[i * M + k]);
+				p = i;
+			}
+		}
+
+		pivot[k] = p;
+
+		if (p != k) {
+			for (unsigned j = 0; j < M; j++) {
+				float tmp = LU[k * M + j];
+				LU[k * M + j] = LU[p * M + j];
+				LU[p * M + j] = tmp;
+			}
+		}
+
+		if (fabsf(LU[k * M + k]) > 0.0f) {
+			const float diag_inv = 1.0f / LU[k * M + k];
+
+			for (unsigned i = k + 1; i < M; i++) {
+				LU[i * M + k] *= diag_inv;
+			}
+		}
+
+		for (unsigned i = k + 1; i < M; i++) {
+			const float l = LU[i * M + k];
+
+			for (unsigned j = k + 1; j < M; j++) {
+				LU[i * M + j] -= l * LU[k * M + j];
+			}
+		}
+	}
+
+	/* row n of K solves S' K(n, :)' = (P H')(n, :)' */
+	for (unsigned n = 0; n < N; n++) {
+		float y[M];
+
+		for (unsigned j = 0; j < M; j++) {
+			y[j] = P_apr[idx(n, state[j])];
+		}
+
+		for (unsigned k = 0; k < M; k++) {
+			if (pivot[k] != k) {
+				float tmp = y[k];
+				y[k] = y[pivot[k]];
+				y[pivot[k]] = tmp;
+			}
+		}
+
+		for (unsigned k = 0; k < M; k++) {
+			for (unsigned i = k + 1; i < M; i++) {
+				y[i] -= y[k] * LU[i * M + k];
+			}
+		}
+
+		for (int k = M - 1; k >= 0; k--) {
+			y[k] /= LU[k * M + k];
+
+			for (int i = 0; i < k; i++) {
+				y[i] -= y[k] * LU[i * M + k];
+			}
+		}
+
+		for (unsigned j = 0; j < M; j++) {
+			K[n * M + j] = y[j];
+		}
+	}
+
+	float innov[M];
+
+	for (unsigned j = 0; j < M; j++) {
+		innov[j] = z[meas[j]] - x_apr[state[j]];
+	}
+
+	for (unsigned n = 0; n < N; n++) {
+		float corr = x_apr[n];
+
+		for (unsigned j = 0; j < M; j++) {
+			corr += K[n * M + j] * innov[j];
+		}
+
+		x_apo[n] = corr;
+	}
+
+	/* P_apo = (I - K H) P_apr, H P_apr are just the rows state[] of P_apr */
+	for (unsigned c = 0; c < N; c++) {
+		for (unsigned n = 0; n < N; n++) {
+			float p = P_apr[idx(n, c)];
+
+			for (unsigned j = 0; j < M; j++) {
+				p -= K[n * M + j] * P_apr[idx(state[j], c)];
+			}
+
+			P_apo[idx(n, c)] = p;
+		}
+	}
+}
+
+} // anonymous namespace
+
+void initialize()
+{
+	memset(x_apo, 0, sizeof(x_apo));
+	x_apo[8] = -9.81f;
+	x_apo[9] = 1.0f;
+
+	for (unsigned i = 0; i < N * N; i++) {
+		P_apo[i] = 200.0f;
+	}
+
+	Q_set = false;
+	Ji_set = false;
+}
+
+void update(uint8_t approx_prediction, uint8_t use_inertia_matrix, const uint8_t zFlag[3], float dt,
+	    const float z[9], float q_rotSpeed, float q_rotAcc, float q_acc, float q_mag,
+	    float r_gyro, float r_accel, float r_mag, const float J[9],
+	    float xa_apo[12], float Pa_apo[144], float Rot_matrix[9], float eulerAngles[3], float debugOutput[4])
+{
+	if (!Ji_set) {
+		inv3(J, Ji);
+		Ji_set = true;
+	}
+
+	if (!Q_set) {
+		for (unsigned i = 0; i < 3; i++) {
+			Q[i] = q_rotSpeed;
+			Q[i + 3] = q_rotAcc;
+			Q[i + 6] = q_acc;
+			Q[i + 9] = q_mag;
+		}
+
+		Q_set = true;
+	}
+
+	for (unsigned i = 0; i < 4; i++) {
+		debugOutput[i] = 0.0f;
+	}
+
+	const float *w = &x_apo[0];
+	const float *wa = &x_apo[3];
+	const float *ze = &x_apo[6];
+	const float *mu = &x_apo[9];
+
+	/* state prediction */
+	float x_apr[N];
+	float *wak = &x_apr[3];
+
+	if (use_inertia_matrix == 1) {
+		/* wak = wa + Ji * (-cross(wa, J * wa)) * dt, J and Ji are column major */
+		float Jw[3];
+		float c[3];
+
+		for (unsigned i = 0; i < 3; i++) {
+			Jw[i] = J[i] * wa[0] + J[i + 3] * wa[1] + J[i + 6] * wa[2];
+		}
+
+		cross3(wa, Jw, c);
+
+		for (unsigned i = 0; i < 3; i++) {
+			wak[i] = wa[i] - (Ji[i] * c[0] + Ji[i + 3] * c[1] + Ji[i + 6] * c[2]) * dt;
+		}
+
+	} else {
+		for (unsigned i = 0; i < 3; i++) {
+			wak[i] = wa[i];
+		}
+	}
+
+	for (unsigned i = 0; i < 3; i++) {
+		x_apr[i] = w[i] + dt * wak[i];
+	}
+
+	/* O = [0, -wz, wy; wz, 0, -wx; -wy, wx, 0]', row major */
+	const float O[9] = {
+		0.0f,  w[2], -w[1],
+		-w[2], 0.0f,  w[0],
+		w[1], -w[0],  0.0f
+	};
+
+	Jacobian F;
+	F.dt = dt;
+
+	for (unsigned i = 0; i < 9; i++) {
+		F.F_vec[i] = ((i % 4 == 0) ? 1.0f : 0.0f) + O[i] * dt;
+	}
+
+	/* exponential map of the rotation over dt, applied to both vectors */
+	float expO[9];
+
+	if (approx_prediction == 1) {
+		memcpy(expO, F.F_vec, sizeof(expO));
+
+	} else {
+		const float half_dt2 = dt * dt / 2.0f;
+
+		for (unsigned i = 0; i < 3; i++) {
+			for (unsigned j = 0; j < 3; j++) {
+				float O2 = O[3 * i + 0] * O[j] + O[3 * i + 1] * O[3 + j] + O[3 * i + 2] * O[6 + j];
+				expO[3 * i + j] = F.F_vec[3 * i + j] + half_dt2 * O2;
+			}
+		}
+	}
+
+	mul3(expO, ze, &x_apr[6]);
+	mul3(expO, mu, &x_apr[9]);
+
+	/* dEZ = [0, zez, -zey; -zez, 0, zex; zey, -zex, 0]' * dt, dMA alike */
+	F.dEZ[0] = 0.0f;
+	F.dEZ[1] = -ze[2] * dt;
+	F.dEZ[2] = ze[1] * dt;
+	F.dEZ[3] = ze[2] * dt;
+	F.dEZ[4] = 0.0f;
+	F.dEZ[5] = -ze[0] * dt;
+	F.dEZ[6] = -ze[1] * dt;
+	F.dEZ[7] = ze[0] * dt;
+	F.dEZ[8] = 0.0f;
+
+	F.dMA[0] = 0.0f;
+	F.dMA[1] = -mu[2] * dt;
+	F.dMA[2] = mu[1] * dt;
+	F.dMA[3] = mu[2] * dt;
+	F.dMA[4] = 0.0f;
+	F.dMA[5] = -mu[0] * dt;
+	F.dMA[6] = -mu[1] * dt;
+	F.dMA[7] = mu[0] * dt;
+	F.dMA[8] = 0.0f;
+
+	/* P_apr = F P_apo F' + Q: F on the columns of P_apo, then on the rows of F P_apo */
+	for (unsigned c = 0; c < N; c++) {
+		apply_jacobian<1>(F, &P_apo[idx(0, c)], &FP[idx(0, c)]);
+	}
+
+	for (unsigned r = 0; r < N; r++) {
+		apply_jacobian<N>(F, &FP[idx(r, 0)], &P_apr[idx(r, 0)]);
+	}
+
+	for (unsigned i = 0; i < N; i++) {
+		P_apr[idx(i, i)] += Q[i];
+	}
+
+	/* measurement update, gyro is always required */
+	if (zFlag[0] == 1 && zFlag[1] == 1 && zFlag[2] == 1) {
+		static const unsigned state[9] = {0, 1, 2, 6, 7, 8, 9, 10, 11};
+		static const unsigned meas[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+		const float r[9] = {r_gyro, r_gyro, r_gyro, r_accel, r_accel, r_accel, r_mag, r_mag, r_mag};
+		fuse(state, meas, r, z, x_apr);
+
+	} else if (zFlag[0] == 1 && zFlag[1] == 0 && zFlag[2] == 0) {
+		static const unsigned state[3] = {0, 1, 2};
+		static const unsigned meas[3] = {0, 1, 2};
+		const float r[3] = {r_gyro, r_gyro, r_gyro};
+		fuse(state, meas, r, z, x_apr);
+
+	} else if (zFlag[0] == 1 && zFlag[1] == 1 && zFlag[2] == 0) {
+		static const unsigned state[6] = {0, 1, 2, 6, 7, 8};
+		static const unsigned meas[6] = {0, 1, 2, 3, 4, 5};
+		const float r[6] = {r_gyro, r_gyro, r_gyro, r_accel, r_accel, r_accel};
+		fuse(state, meas, r, z, x_apr);
+
+	} else if (zFlag[0] == 1 && zFlag[1] == 0 && zFlag[2] == 1) {
+		static const unsigned state[6] = {0, 1, 2, 9, 10, 11};
+		static const unsigned meas[6] = {0, 1, 2, 6, 7, 8};
+		const float r[6] = {r_gyro, r_gyro, r_gyro, r_mag, r_mag, r_mag};
+		fuse(state, meas, r, z, x_apr);
+
+	} else {
+		memcpy(x_apo, x_apr, sizeof(x_apo));
+		memcpy(P_apo, P_apr, sizeof(P_apo));
+	}
+
+	/* rotation from earth to body frame: z down against gravity, y normal to z and mag */
+	float z_n_b[3];
+	float m_n_b[3];
+	float y_n_b[3];
+	float x_n_b[3];
+
+	const float ze_norm = norm3(&x_apo[6]);
+	const float mu_norm = norm3(&x_apo[9]);
+
+	for (unsigned i = 0; i < 3; i++) {
+		z_n_b[i] = -x_apo[i + 6] / ze_norm;
+		m_n_b[i] = x_apo[i + 9] / mu_norm;
+	}
+
+	cross3(z_n_b, m_n_b, y_n_b);
+	const float y_norm = norm3(y_n_b);
+
+	for (unsigned i = 0; i < 3; i++) {
+		y_n_b[i] /= y_norm;
+	}
+
+	cross3(y_n_b, z_n_b, x_n_b);
+	const float x_norm = norm3(x_n_b);
+
+	for (unsigned i = 0; i < 3; i++) {
+		x_n_b[i] /= x_norm;
+	}
+
+	memcpy(xa_apo, x_apo, sizeof(x_apo));
+	memcpy(Pa_apo, P_apo, sizeof(P_apo));
+
+	for (unsigned i = 0; i < 3; i++) {
+		Rot_matrix[i] = x_n_b[i];
+		Rot_matrix[3 + i] = y_n_b[i];
+		Rot_matrix[6 + i] = z_n_b[i];
+	}
+
+	eulerAngles[0] = atan2f(Rot_matrix[7], Rot_matrix[8]);
+	eulerAngles[1] = -asinf(Rot_matrix[6]);
+	eulerAngles[2] = atan2f(Rot_matrix[3], Rot_matrix[0]);
+}
+
+}
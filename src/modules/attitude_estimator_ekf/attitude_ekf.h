@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file attitude_ekf.h
+ *
+ * Hand written single precision kernels of the attitude EKF of AttitudeEKF.m,
+ * a drop-in replacement for the MATLAB generated codegen/AttitudeEKF.c.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace attitude_ekf
+{
+
+/**
+ * Reset the filter state, as AttitudeEKF_initialize() of the generated code.
+ */
+void initialize();
+
+/**
+ * Run one prediction and update step, as AttitudeEKF() of the generated code.
+ *
+ * As there, the process noise and the inverse of the inertia are latched on
+ * the first call after initialize() and the matrices are column major.
+ *
+ * @param approx_prediction	first instead of second order exponential map of the vectors
+ * @param use_inertia_matrix	propagate the angular accelerations with the inertia J
+ * @param zFlag		gyro, accel and mag measurement available
+ * @param dt		time step (s)
+ * @param z		measurements [gyro, accel, mag]
+ * @param J		moment of inertia matrix
+ * @param xa_apo	a posteriori state
+ * @param Pa_apo	a posteriori covariance
+ * @param Rot_matrix	rotation matrix from earth to body frame
+ * @param eulerAngles	roll, pitch and yaw
+ * @param debugOutput	zeroed, not used
+ */
+void update(uint8_t approx_prediction, uint8_t use_inertia_matrix, const uint8_t zFlag[3], float dt,
+	    const float z[9], float q_rotSpeed, float q_rotAcc, float q_acc, float q_mag,
+	    float r_gyro, float r_accel, float r_mag, const float J[9],
+	    float xa_apo[12], float Pa_apo[144], float Rot_matrix[9], float eulerAngles[3], float debugOutput[4]);
+
+}
@@ -54,6 +54,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <math.h>
+#include <string.h>
 #include <uORB/uORB.h>
 #include <uORB/topics/debug_key_value.h>
 #include <uORB/topics/sensor_combined.h>
@@ -76,7 +77,7 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-#include "codegen/AttitudeEKF.h"
+#include "attitude_ekf.h"
 #include "attitude_estimator_ekf_params.h"
 #ifdef __cplusplus
 }
@@ -210,7 +211,7 @@ int attitude_estimator_ekf_thread_main(int argc, char *argv[])
 	float debugOutput[4] = { 0.0f };
 
 	/* Initialize filter */
-	AttitudeEKF_initialize();
+	attitude_ekf::initialize();
 
 	struct sensor_combined_s raw;
 	memset(&raw, 0, sizeof(raw));
@@ -529,7 +530,7 @@ int attitude_estimator_ekf_thread_main(int argc, char *argv[])
 					}
 
 					/* Call the estimator */
-					AttitudeEKF(false, // approx_prediction
+					attitude_ekf::update(false, // approx_prediction
 							(unsigned char)ekf_params.use_moment_inertia,
 							update_vect,
 							dt,
@@ -408,7 +408,9 @@ void AttitudeEstimatorQ::task_main()
 			continue;
 		}
 
-		Vector<3> euler = _q.to_euler();
+		Matrix<3, 3> R;
+		_q.to_dcm(R);
+		Vector<3> euler = R.to_euler();
 
 		struct vehicle_attitude_s att = {};
 		att.timestamp = sensors.timestamp;
@@ -431,8 +433,6 @@ void AttitudeEstimatorQ::task_main()
 		/* copy offsets */
 		memcpy(&att.rate_offsets, _gyro_bias.data, sizeof(att.rate_offsets));
 
-		Matrix<3, 3> R = _q.to_dcm();
-
 		/* copy rotation matrix */
 		memcpy(&att.R[0], R.data, sizeof(att.R));
 		att.R_valid = true;
@@ -521,26 +521,25 @@ bool AttitudeEstimatorQ::update(float dt) {
 
 	Quaternion q_last = _q;
 
-	// Angular rate of correction
-	Vector<3> corr;
+	// One rotation matrix for all projections of this step, the rows are
+	// the earth axes in body frame
+	Matrix<3, 3> R;
+	_q.to_dcm(R);
+
+	// 'k' unit vector of earth frame (down) in body frame
+	Vector<3> k(R.data[2][0], R.data[2][1], R.data[2][2]);
 
 	// Magnetometer correction
 	// Project mag field vector to global frame and extract XY component
-	Vector<3> mag_earth = _q.conjugate(_mag);
-	float mag_err = _wrap_pi(atan2f(mag_earth(1), mag_earth(0)) - _mag_decl);
-	// Project magnetometer correction to body frame
-	corr += _q.conjugate_inversed(Vector<3>(0.0f, 0.0f, -mag_err)) * _w_mag;
+	float mag_earth_x = R.data[0][0] * _mag(0) + R.data[0][1] * _mag(1) + R.data[0][2] * _mag(2);
+	float mag_earth_y = R.data[1][0] * _mag(0) + R.data[1][1] * _mag(1) + R.data[1][2] * _mag(2);
+	float mag_err = _wrap_pi(atan2f(mag_earth_y, mag_earth_x) - _mag_decl);
 
-	// Accelerometer correction
-	// Project 'k' unit vector of earth frame to body frame
-	// Vector<3> k = _q.conjugate_inversed(Vector<3>(0.0f, 0.0f, 1.0f));
-	// Optimized version with dropped zeros
-	Vector<3> k(
-			2.0f * (_q(1) * _q(3) - _q(0) * _q(2)),
-			2.0f * (_q(2) * _q(3) + _q(0) * _q(1)),
-			(_q(0) * _q(0) - _q(1) * _q(1) - _q(2) * _q(2) + _q(3) * _q(3))
-	);
+	// Angular rate of correction, the magnetometer correction
+	// rotates about 'k', projected to body frame
+	Vector<3> corr = k * (-mag_err * _w_mag);
 
+	// Accelerometer correction
 	corr += (k % (_accel - _pos_acc).normalized()) * _w_accel;
 
 	// Gyro bias estimation
@@ -554,10 +553,10 @@ bool AttitudeEstimatorQ::update(float dt) {
 	corr += _rates;
 
 	// Apply correction to state
-	_q += _q.derivative(corr) * dt;
+	_q.integrate(corr, dt);
 
-	// Normalize quaternion
-	_q.normalize();
+	// Normalize quaternion, a single step keeps it close to unit length
+	_q.normalize_fast();
 
 	if (!(PX4_ISFINITE(_q(0)) && PX4_ISFINITE(_q(1)) &&
 		PX4_ISFINITE(_q(2)) && PX4_ISFINITE(_q(3)))) {
@@ -148,8 +148,39 @@ private:
 	struct mission_s	_onboard_mission;
 	orb_advert_t		_onboard_mission_pub;
 
+	/*
+	 * The distance the payload travels after the release, over a grid of
+	 * ground speed and height over the target. The fall with drag is only
+	 * integrated when the parameters or the wind change, the drop point
+	 * is then interpolated on every run of the loop.
+	 */
+	static constexpr unsigned	DROP_TABLE_SPEEDS = 13;
+	static constexpr float		DROP_TABLE_SPEED_STEP = 2.5f;	///< m/s
+	static constexpr unsigned	DROP_TABLE_HEIGHTS = 16;
+	static constexpr float		DROP_TABLE_HEIGHT_STEP = 10.0f;	///< m
+
+	float		_drop_table[DROP_TABLE_HEIGHTS][DROP_TABLE_SPEEDS];
+	float		_drop_table_wind;		///< wind speed the table was computed for, NAN if none
+
 	void		task_main();
 
+	/**
+	 * Integrate the fall of the payload released at the given ground speed and height.
+	 *
+	 * @return		the distance travelled along the wind direction [m]
+	 */
+	static float	drop_simulate(float groundspeed, float h_0, float windspeed, float z_0, float cd, float m, float A);
+
+	/**
+	 * Recompute the drop table for the current wind and payload parameters.
+	 */
+	void		drop_table_update(float windspeed, float z_0, float cd, float m, float A);
+
+	/**
+	 * Interpolate the drop table, inputs outside the table are clamped.
+	 */
+	float		drop_table_distance(float groundspeed, float height) const;
+
 	void		handle_command(struct vehicle_command_s *cmd);
 
 	void		answer_command(struct vehicle_command_s *cmd, unsigned result);
@@ -190,7 +221,9 @@ BottleDrop::BottleDrop() :
 	_drop_position {},
 	_drop_state(DROP_STATE_INIT),
 	_onboard_mission {},
-	_onboard_mission_pub(nullptr)
+	_onboard_mission_pub(nullptr),
+	_drop_table {},
+	_drop_table_wind(NAN)
 {
 }
 
@@ -337,6 +370,80 @@ BottleDrop::actuators_publish()
 	}
 }
 
+float
+BottleDrop::drop_simulate(float groundspeed, float h_0, float windspeed, float z_0, float cd, float m, float A)
+{
+	const float g = CONSTANTS_ONE_G;	// constant of gravity [m/s^2]
+	const float rho = 1.2f;			// air density [kg/m^3]
+	const float dt_freefall_prediction = 0.01f;	// step size of the free fall prediction [s]
+
+	float az = g;				// acceleration in z direction[m/s^2]
+	float vz = 0;				// velocity in z direction [m/s]
+	float z = 0;				// fallen distance [m]
+	float h = h_0;				// height over target [m]
+	float ax = 0;				// acceleration in x direction [m/s^2]
+	float vx = groundspeed;			// ground speed in x direction [m/s]
+	float x = 0;				// traveled distance in x direction [m]
+
+	// the wind profile scales with the logarithm of the height
+	const float log_h_0 = logf(h_0 / z_0);
+
+	while (h > 0.05f) {
+		// z-direction
+		vz = vz + az * dt_freefall_prediction;
+		z = z + vz * dt_freefall_prediction;
+		h = h_0 - z;
+
+		// x-direction
+		float vw = windspeed * logf(h / z_0) / log_h_0;	// wind speed [m/s]
+		vx = vx + ax * dt_freefall_prediction;
+		x = x + vx * dt_freefall_prediction;
+		float vrx = vx + vw;				// relative velocity in x direction [m/s]
+
+		// drag force
+		float v = sqrtf(vz * vz + vrx * vrx);
+		float Fd = 0.5f * rho * A * cd * (v * v);
+		float Fdx = Fd * vrx / v;
+		float Fdz = Fd * vz / v;
+
+		// acceleration
+		az = g - Fdz / m;
+		ax = -Fdx / m;
+	}
+
+	return x;
+}
+
+void
+BottleDrop::drop_table_update(float windspeed, float z_0, float cd, float m, float A)
+{
+	for (unsigned i = 0; i < DROP_TABLE_HEIGHTS; i++) {
+		for (unsigned j = 0; j < DROP_TABLE_SPEEDS; j++) {
+			// nothing falls from the height of the target
+			_drop_table[i][j] = (i == 0) ? 0.0f : drop_simulate(j * DROP_TABLE_SPEED_STEP, i * DROP_TABLE_HEIGHT_STEP,
+					    windspeed, z_0, cd, m, A);
+		}
+	}
+
+	_drop_table_wind = windspeed;
+}
+
+float
+BottleDrop::drop_table_distance(float groundspeed, float height) const
+{
+	float fi = math::constrain(height / DROP_TABLE_HEIGHT_STEP, 0.0f, (float)(DROP_TABLE_HEIGHTS - 1));
+	float fj = math::constrain(groundspeed / DROP_TABLE_SPEED_STEP, 0.0f, (float)(DROP_TABLE_SPEEDS - 1));
+
+	unsigned i = math::min((unsigned)fi, DROP_TABLE_HEIGHTS - 2);
+	unsigned j = math::min((unsigned)fj, DROP_TABLE_SPEEDS - 2);
+	float di = fi - i;
+	float dj = fj - j;
+
+	// bilinear interpolation between the four surrounding solutions
+	return (1.0f - di) * ((1.0f - dj) * _drop_table[i][j] + dj * _drop_table[i][j + 1])
+	       + di * ((1.0f - dj) * _drop_table[i + 1][j] + dj * _drop_table[i + 1][j + 1]);
+}
+
 void
 BottleDrop::task_main()
 {
@@ -356,11 +463,8 @@ BottleDrop::task_main()
 	float ground_distance = _alt_clearance;		// Replace by closer estimate in loop
 
 	// constant
-	float g = CONSTANTS_ONE_G;               		// constant of gravity [m/s^2]
 	float m = 0.5f;                		// mass of bottle [kg]
-	float rho = 1.2f;              		// air density [kg/m^3]
 	float A = ((0.063f * 0.063f) / 4.0f * M_PI_F); // Bottle cross section [m^2]
-	float dt_freefall_prediction = 0.01f;   // step size of the free fall prediction [s]
 
 	// Has to be estimated by experiment
 	float cd = 0.86f;              	// Drag coefficient for a cylinder with a d/l ratio of 1/3 []
@@ -371,20 +475,8 @@ BottleDrop::task_main()
 
 
 	// Definition
-	float h_0;						// height over target
-	float az;                 				// acceleration in z direction[m/s^2]
-	float vz; 						// velocity in z direction [m/s]
-	float z; 						// fallen distance [m]
-	float h; 						// height over target [m]
-	float ax;						// acceleration in x direction [m/s^2]
-	float vx;						// ground speed in x direction [m/s]
 	float x;					        // traveled distance in x direction [m]
-	float vw;                 				// wind speed [m/s]
-	float vrx;						// relative velocity in x direction [m/s]
-	float v;						// relative speed vector [m/s]
-	float Fd;						// Drag force [N]
-	float Fdx;						// Drag force in x direction [N]
-	float Fdz;						// Drag force in z direction [N]
+	float wind_direction_n = 1.0f, wind_direction_e = 0.0f;	// direction of the drop vector
 	float x_drop, y_drop;					// coordinates of the drop point in reference to the target (projection of NED)
 	float x_t, y_t;						// coordinates of the target in reference to the target x_t = 0, y_t = 0 (projection of NED)
 	float x_l, y_l;						// local position in projected coordinates
@@ -431,7 +523,7 @@ BottleDrop::task_main()
 	flight_vector_e.autocontinue = true;
 	flight_vector_s.altitude_is_relative = false;
 
-	struct wind_estimate_s wind;
+	struct wind_estimate_s wind {};
 
 	// wakeup source(s)
 	struct pollfd fds[1];
@@ -444,6 +536,8 @@ BottleDrop::task_main()
 	lock_release();
 	close_bay();
 
+	drop_table_update(0.0f, z_0, cd, m, A);
+
 	while (!_task_should_exit) {
 
 		/* wait for up to 100ms for data */
@@ -506,6 +600,11 @@ BottleDrop::task_main()
 				param_get(param_gproperties, &z_0);
 				param_get(param_turn_radius, &turn_radius);
 				param_get(param_precision, &precision);
+				param_get(param_cd, &cd);
+				param_get(param_mass, &m);
+				param_get(param_surface, &A);
+
+				_drop_table_wind = NAN;
 			}
 
 			orb_check(_command_sub, &updated);
@@ -520,9 +619,23 @@ BottleDrop::task_main()
 			float groundspeed_body = sqrtf(_global_pos.vel_n * _global_pos.vel_n + _global_pos.vel_e * _global_pos.vel_e);
 			ground_distance = _global_pos.alt - _target_position.alt;
 
+			/*
+			 * Follow the parameters and the wind before the bay opens. Updating the
+			 * table takes a few ms, which must not delay the release itself.
+			 */
+			if (_drop_state < DROP_STATE_BAY_OPEN
+			    && !(fabsf(windspeed_norm - _drop_table_wind) < 1.0f)) {
+				drop_table_update(windspeed_norm, z_0, cd, m, A);
+			}
+
 			// Distance to drop position and angle error to approach vector
 			// are relevant in all states greater than target valid (which calculates these positions)
 			if (_drop_state > DROP_STATE_TARGET_VALID) {
+				// the release point follows the current ground speed and height
+				x = groundspeed_body * t_signal + drop_table_distance(groundspeed_body, ground_distance);
+				map_projection_reproject(&ref, x * wind_direction_n, x * wind_direction_e, &_drop_position.lat,
+							 &_drop_position.lon);
+
 				distance_real = fabsf(get_distance_to_next_waypoint(_global_pos.lat, _global_pos.lon, _drop_position.lat,
 						      _drop_position.lon));
 
@@ -545,45 +658,8 @@ BottleDrop::task_main()
 
 			case DROP_STATE_TARGET_VALID: {
 
-					az = g;							// acceleration in z direction[m/s^2]
-					vz = 0; 						// velocity in z direction [m/s]
-					z = 0; 							// fallen distance [m]
-					h_0 = _global_pos.alt - _target_position.alt; 		// height over target at start[m]
-					h = h_0;						// height over target [m]
-					ax = 0;							// acceleration in x direction [m/s^2]
-					vx = groundspeed_body;// XXX project					// ground speed in x direction [m/s]
-					x = 0;							// traveled distance in x direction [m]
-					vw = 0;							// wind speed [m/s]
-					vrx = 0;						// relative velocity in x direction [m/s]
-					v = groundspeed_body;					// relative speed vector [m/s]
-					Fd = 0;							// Drag force [N]
-					Fdx = 0;						// Drag force in x direction [N]
-					Fdz = 0;						// Drag force in z direction [N]
-
-
 					// Compute the distance the bottle will travel after it is dropped in body frame coordinates --> x
-					while (h > 0.05f) {
-						// z-direction
-						vz = vz + az * dt_freefall_prediction;
-						z = z + vz * dt_freefall_prediction;
-						h = h_0 - z;
-
-						// x-direction
-						vw = windspeed_norm * logf(h / z_0) / logf(ground_distance / z_0);
-						vx = vx + ax * dt_freefall_prediction;
-						x = x + vx * dt_freefall_prediction;
-						vrx = vx + vw;
-
-						// drag force
-						v = sqrtf(vz * vz + vrx * vrx);
-						Fd = 0.5f * rho * A * cd * (v * v);
-						Fdx = Fd * vrx / v;
-						Fdz = Fd * vz / v;
-
-						// acceleration
-						az = g - Fdz / m;
-						ax = -Fdx / m;
-					}
+					x = drop_table_distance(groundspeed_body, ground_distance);
 
 					// compute drop vector
 					x = groundspeed_body * t_signal + x;
@@ -591,8 +667,6 @@ BottleDrop::task_main()
 					x_t = 0.0f;
 					y_t = 0.0f;
 
-					float wind_direction_n, wind_direction_e;
-
 					if (windspeed_norm < 0.5f) {	// If there is no wind, an arbitrarily direction is chosen
 						wind_direction_n = 1.0f;
 						wind_direction_e = 0.0f;
@@ -63,6 +63,9 @@
 #include <drivers/drv_airspeed.h>
 
 #include <uORB/topics/airspeed.h>
+#include <uORB/topics/sensor_mag.h>
+#include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_gyro.h>
 #include <uORB/topics/vehicle_gps_position.h>
 
 #include <mavlink/mavlink_log.h>
@@ -71,6 +74,57 @@
 
 namespace Commander
 {
+/**
+ * A passed self-test is not repeated as long as the same device is present,
+ * no parameter changed and the driver did not count new errors since.
+ */
+struct SelftestCache {
+	bool		passed;
+	int		devid;
+	uint32_t	param_seq;
+	uint64_t	error_count;
+};
+
+static SelftestCache mag_selftest[max_optional_mag_count];
+static SelftestCache accel_selftest[max_optional_accel_count];
+static SelftestCache gyro_selftest[max_optional_gyro_count];
+
+template <typename R>
+static bool sensorErrorCount(const struct orb_metadata *meta, unsigned instance, uint64_t *error_count)
+{
+	int sub = orb_subscribe_multi(meta, instance);
+
+	if (sub < 0) {
+		return false;
+	}
+
+	R report;
+	bool success = (orb_copy(meta, sub, &report) == OK);
+
+	if (success) {
+		*error_count = report.error_count;
+	}
+
+	orb_unsubscribe(sub);
+	return success;
+}
+
+static bool selftestCached(const SelftestCache &cache, int devid, bool have_error_count, uint64_t error_count)
+{
+	return cache.passed && have_error_count &&
+	       cache.devid == devid &&
+	       cache.param_seq == param_get_change_seq() &&
+	       cache.error_count == error_count;
+}
+
+static void selftestUpdate(SelftestCache &cache, bool passed, int devid, uint32_t param_seq, uint64_t error_count)
+{
+	cache.passed = passed;
+	cache.devid = devid;
+	cache.param_seq = param_seq;
+	cache.error_count = error_count;
+}
+
 static bool magnometerCheck(int mavlink_fd, unsigned instance, bool optional)
 {
 	bool success = true;
@@ -90,6 +144,9 @@ static bool magnometerCheck(int mavlink_fd, unsigned instance, bool optional)
 
 	int calibration_devid;
 	int ret;
+	uint32_t param_seq = param_get_change_seq();
+	uint64_t error_count = 0;
+	bool have_error_count;
 	int devid = px4_ioctl(fd, DEVIOCGDEVICEID, 0);
 	sprintf(s, "CAL_MAG%u_ID", instance);
 	param_get(param_find(s), &(calibration_devid));
@@ -101,13 +158,18 @@ static bool magnometerCheck(int mavlink_fd, unsigned instance, bool optional)
 		goto out;
 	}
 
-	ret = px4_ioctl(fd, MAGIOCSELFTEST, 0);
+	have_error_count = sensorErrorCount<mag_report>(ORB_ID(sensor_mag), instance, &error_count);
 
-	if (ret != OK) {
-		mavlink_and_console_log_critical(mavlink_fd,
-						 "PREFLIGHT FAIL: MAG #%u SELFTEST FAILED", instance);
-		success = false;
-		goto out;
+	if (!selftestCached(mag_selftest[instance], devid, have_error_count, error_count)) {
+		ret = px4_ioctl(fd, MAGIOCSELFTEST, 0);
+		selftestUpdate(mag_selftest[instance], ret == OK, devid, param_seq, error_count);
+
+		if (ret != OK) {
+			mavlink_and_console_log_critical(mavlink_fd,
+							 "PREFLIGHT FAIL: MAG #%u SELFTEST FAILED", instance);
+			success = false;
+			goto out;
+		}
 	}
 
 out:
@@ -134,6 +196,9 @@ static bool accelerometerCheck(int mavlink_fd, unsigned instance, bool optional,
 
 	int calibration_devid;
 	int ret;
+	uint32_t param_seq = param_get_change_seq();
+	uint64_t error_count = 0;
+	bool have_error_count;
 	int devid = px4_ioctl(fd, DEVIOCGDEVICEID, 0);
 	sprintf(s, "CAL_ACC%u_ID", instance);
 	param_get(param_find(s), &(calibration_devid));
@@ -145,13 +210,18 @@ static bool accelerometerCheck(int mavlink_fd, unsigned instance, bool optional,
 		goto out;
 	}
 
-	ret = px4_ioctl(fd, ACCELIOCSELFTEST, 0);
+	have_error_count = sensorErrorCount<accel_report>(ORB_ID(sensor_accel), instance, &error_count);
 
-	if (ret != OK) {
-		mavlink_and_console_log_critical(mavlink_fd,
-						 "PREFLIGHT FAIL: ACCEL #%u SELFTEST FAILED", instance);
-		success = false;
-		goto out;
+	if (!selftestCached(accel_selftest[instance], devid, have_error_count, error_count)) {
+		ret = px4_ioctl(fd, ACCELIOCSELFTEST, 0);
+		selftestUpdate(accel_selftest[instance], ret == OK, devid, param_seq, error_count);
+
+		if (ret != OK) {
+			mavlink_and_console_log_critical(mavlink_fd,
+							 "PREFLIGHT FAIL: ACCEL #%u SELFTEST FAILED", instance);
+			success = false;
+			goto out;
+		}
 	}
 
 #ifdef __PX4_NUTTX
@@ -203,6 +273,9 @@ static bool gyroCheck(int mavlink_fd, unsigned instance, bool optional)
 
 	int calibration_devid;
 	int ret;
+	uint32_t param_seq = param_get_change_seq();
+	uint64_t error_count = 0;
+	bool have_error_count;
 	int devid = px4_ioctl(fd, DEVIOCGDEVICEID, 0);
 	sprintf(s, "CAL_GYRO%u_ID", instance);
 	param_get(param_find(s), &(calibration_devid));
@@ -214,13 +287,18 @@ static bool gyroCheck(int mavlink_fd, unsigned instance, bool optional)
 		goto out;
 	}
 
-	ret = px4_ioctl(fd, GYROIOCSELFTEST, 0);
+	have_error_count = sensorErrorCount<gyro_report>(ORB_ID(sensor_gyro), instance, &error_count);
 
-	if (ret != OK) {
-		mavlink_and_console_log_critical(mavlink_fd,
-						 "PREFLIGHT FAIL: GYRO #%u SELFTEST FAILED", instance);
-		success = false;
-		goto out;
+	if (!selftestCached(gyro_selftest[instance], devid, have_error_count, error_count)) {
+		ret = px4_ioctl(fd, GYROIOCSELFTEST, 0);
+		selftestUpdate(gyro_selftest[instance], ret == OK, devid, param_seq, error_count);
+
+		if (ret != OK) {
+			mavlink_and_console_log_critical(mavlink_fd,
+							 "PREFLIGHT FAIL: GYRO #%u SELFTEST FAILED", instance);
+			success = false;
+			goto out;
+		}
 	}
 
 out:
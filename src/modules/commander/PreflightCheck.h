@@ -49,6 +49,9 @@ namespace Commander
 * The function won't fail the test if optional sensors are not found, however,
 * it will fail the test if optional sensors are found but not in working condition.
 *
+* Passed mag, accel and gyro self-tests are not repeated until a parameter changes,
+* the device changes or its driver reports new errors.
+*
 * @param mavlink_fd
 *   Mavlink output file descriptor for feedback when a sensor fails
 * @param checkMag
@@ -56,6 +56,45 @@ int sphere_fit_least_squares(const float x[], const float y[], const float z[],
 			     unsigned int size, unsigned int max_iterations, float delta, float *sphere_x, float *sphere_y, float *sphere_z,
 			     float *sphere_radius);
 
+/**
+ * Running sums of the points of a sphere fit, so the points can be fitted
+ * as they arrive instead of being stored.
+ */
+typedef struct {
+	unsigned int	count;
+	float		x_sum, y_sum, z_sum;
+	float		x2_sum, y2_sum, z2_sum;
+	float		x3_sum, y3_sum, z3_sum;
+	float		xy_sum, xz_sum, yz_sum;
+	float		x2y_sum, x2z_sum, y2x_sum, y2z_sum, z2x_sum, z2y_sum;
+} sphere_fit_sums_t;
+
+/**
+ * Clear the running sums of a sphere fit.
+ */
+void sphere_fit_sums_reset(sphere_fit_sums_t *sums);
+
+/**
+ * Add one point on the sphere surface to the running sums.
+ */
+void sphere_fit_sums_add(sphere_fit_sums_t *sums, float x, float y, float z);
+
+/**
+ * Least-squares fit of a sphere to the points accumulated in the running sums.
+ *
+ * @param sums running sums of the points
+ * @param max_iterations abort if maximum number of iterations have been reached. If unsure, set to 100.
+ * @param delta abort if error is below delta. If unsure, set to 0 to run max_iterations times.
+ * @param sphere_x coordinate of the sphere center on the X axis
+ * @param sphere_y coordinate of the sphere center on the Y axis
+ * @param sphere_z coordinate of the sphere center on the Z axis
+ * @param sphere_radius sphere radius
+ *
+ * @return 0 on success, 1 on failure
+ */
+int sphere_fit_least_squares_sums(const sphere_fit_sums_t *sums, unsigned int max_iterations, float delta,
+				  float *sphere_x, float *sphere_y, float *sphere_z, float *sphere_radius);
+
 // FIXME: Change the name
 static const unsigned max_accel_sens = 3;
 
@@ -77,6 +77,7 @@
 #include <uORB/topics/position_setpoint_triplet.h>
 #include <uORB/topics/vehicle_gps_position.h>
 #include <uORB/topics/vehicle_command.h>
+#include <uORB/topics/vehicle_command_ack.h>
 #include <uORB/topics/subsystem_info.h>
 #include <uORB/topics/actuator_controls.h>
 #include <uORB/topics/actuator_controls_0.h>
@@ -105,6 +106,7 @@
 #include <systemlib/err.h>
 #include <systemlib/cpuload.h>
 #include <systemlib/rc_check.h>
+#include <systemlib/boot_timing.h>
 #include <geo/geo.h>
 #include <systemlib/state_table.h>
 #include <dataman/dataman.h>
@@ -171,6 +173,9 @@ enum MAV_MODE_FLAG {
 /* Mavlink file descriptors */
 static int mavlink_fd = 0;
 
+/* results of the handled commands, mavlink turns them into COMMAND_ACK */
+static orb_advert_t command_ack_pub = nullptr;
+
 /* System autostart ID */
 static int autostart_id;
 
@@ -813,12 +818,6 @@ bool handle_command(struct vehicle_status_s *status_local, const struct safety_s
 		answer_command(*cmd, cmd_result);
 	}
 
-	/* send any requested ACKs */
-	if (cmd->confirmation > 0 && cmd_result != vehicle_command_s::VEHICLE_CMD_RESULT_UNSUPPORTED) {
-		/* send acknowledge command */
-		// XXX TODO
-	}
-
 	return true;
 }
 
@@ -1275,9 +1274,32 @@ int commander_thread_main(int argc, char *argv[])
 	pthread_create(&commander_low_prio_thread, &commander_low_prio_attr, commander_low_prio_loop, NULL);
 	pthread_attr_destroy(&commander_low_prio_attr);
 
+	/*
+	 * Commands, geofence violations and landing are handled as soon as they
+	 * are published, everything else is monitored once per interval.
+	 */
+	px4_pollfd_struct_t fds[3];
+	fds[0].fd = cmd_sub;
+	fds[0].events = POLLIN;
+	fds[1].fd = geofence_result_sub;
+	fds[1].events = POLLIN;
+	fds[2].fd = land_detector_sub;
+	fds[2].events = POLLIN;
+
+	hrt_abstime next_monitoring_tick = 0;
+
+	boot_timing_mark("commander ready");
+
 	while (!thread_should_exit) {
 
-		if (mavlink_fd < 0 && counter % (1000000 / MAVLINK_OPEN_INTERVAL) == 0) {
+		/* counters and hysteresis only advance on the monitoring tick, not on early wakeups */
+		const bool monitoring_tick = (hrt_absolute_time() >= next_monitoring_tick);
+
+		if (monitoring_tick) {
+			next_monitoring_tick = hrt_absolute_time() + COMMANDER_MONITORING_INTERVAL;
+		}
+
+		if (mavlink_fd < 0 && monitoring_tick && counter % (1000000 / MAVLINK_OPEN_INTERVAL) == 0) {
 			/* try to open the mavlink log device every once in a while */
 			mavlink_fd = px4_open(MAVLINK_LOG_DEVICE, 0);
 		}
@@ -1691,7 +1713,7 @@ int commander_thread_main(int argc, char *argv[])
 			orb_copy(ORB_ID(position_setpoint_triplet), pos_sp_triplet_sub, &pos_sp_triplet);
 		}
 
-		if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+		if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 			/* compute system load */
 			uint64_t interval_runtime = system_load.tasks[0].total_runtime - last_idle_time;
 
@@ -1834,7 +1856,7 @@ int commander_thread_main(int argc, char *argv[])
 				flight_termination_printed = true;
 			}
 
-			if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+			if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 				mavlink_log_critical(mavlink_fd, "Flight termination active");
 			}
 		} // no reset is done here on purpose, on geofence violation we want to stay in flighttermination
@@ -1906,7 +1928,7 @@ int commander_thread_main(int argc, char *argv[])
 
 					stick_off_counter = 0;
 
-				} else {
+				} else if (monitoring_tick) {
 					stick_off_counter++;
 				}
 
@@ -1939,7 +1961,7 @@ int commander_thread_main(int argc, char *argv[])
 
 					stick_on_counter = 0;
 
-				} else {
+				} else if (monitoring_tick) {
 					stick_on_counter++;
 				}
 
@@ -2111,7 +2133,7 @@ int commander_thread_main(int argc, char *argv[])
 					flight_termination_printed = true;
 				}
 
-				if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+				if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 					mavlink_log_critical(mavlink_fd, "DL and GPS lost: flight termination");
 				}
 			}
@@ -2135,7 +2157,7 @@ int commander_thread_main(int argc, char *argv[])
 					flight_termination_printed = true;
 				}
 
-				if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+				if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 					mavlink_log_critical(mavlink_fd, "RC and GPS lost: flight termination");
 				}
 			}
@@ -2190,7 +2212,7 @@ int commander_thread_main(int argc, char *argv[])
 		}
 
 		/* publish states (armed, control mode, vehicle status) at least with 5 Hz */
-		if (counter % (200000 / COMMANDER_MONITORING_INTERVAL) == 0 || status_changed) {
+		if ((monitoring_tick && counter % (200000 / COMMANDER_MONITORING_INTERVAL) == 0) || status_changed) {
 			set_control_mode();
 			control_mode.timestamp = now;
 			orb_publish(ORB_ID(vehicle_control_mode), control_mode_pub, &control_mode);
@@ -2247,25 +2269,32 @@ int commander_thread_main(int argc, char *argv[])
 			arm_tune_played = false;
 		}
 
-		counter++;
+		if (monitoring_tick) {
+			counter++;
 
-		int blink_state = blink_msg_state();
+			int blink_state = blink_msg_state();
 
-		if (blink_state > 0) {
-			/* blinking LED message, don't touch LEDs */
-			if (blink_state == 2) {
-				/* blinking LED message completed, restore normal state */
-				control_status_leds(&status, &armed, true);
-			}
+			if (blink_state > 0) {
+				/* blinking LED message, don't touch LEDs */
+				if (blink_state == 2) {
+					/* blinking LED message completed, restore normal state */
+					control_status_leds(&status, &armed, true);
+				}
 
-		} else {
-			/* normal state */
-			control_status_leds(&status, &armed, status_changed);
+			} else {
+				/* normal state */
+				control_status_leds(&status, &armed, status_changed);
+			}
 		}
 
 		status_changed = false;
 
-		usleep(COMMANDER_MONITORING_INTERVAL);
+		/* sleep until the next monitoring tick unless one of the event topics is published first */
+		hrt_abstime t_wait = hrt_absolute_time();
+
+		if (t_wait < next_monitoring_tick) {
+			(void)px4_poll(fds, sizeof(fds) / sizeof(fds[0]), (next_monitoring_tick - t_wait) / 1000 + 1);
+		}
 	}
 
 	/* wait for threads to complete */
@@ -2771,6 +2800,20 @@ print_reject_arm(const char *msg)
 
 void answer_command(struct vehicle_command_s &cmd, unsigned result)
 {
+	struct vehicle_command_ack_s ack;
+	ack.command = cmd.command;
+	ack.result = result;
+	ack.target_system = cmd.source_system;
+	ack.target_component = cmd.source_component;
+
+	if (command_ack_pub == nullptr) {
+		/* queued, several commands can be answered before mavlink reads the results */
+		command_ack_pub = orb_advertise_queue(ORB_ID(vehicle_command_ack), &ack, 4);
+
+	} else {
+		orb_publish(ORB_ID(vehicle_command_ack), command_ack_pub, &ack);
+	}
+
 	switch (result) {
 	case vehicle_command_s::VEHICLE_CMD_RESULT_ACCEPTED:
 			tune_positive(true);
@@ -112,7 +112,8 @@ static calibrate_return gyro_calibration_worker(int cancel_sub, void* data)
 					orb_copy(ORB_ID(sensor_gyro), worker_data->gyro_sensor_sub[s], &gyro_report);
 					
 					if (s == 0) {
-						orb_copy(ORB_ID(sensor_gyro), worker_data->gyro_sensor_sub[s], &worker_data->gyro_report_0);
+						/* a second copy would take the next queued report */
+						worker_data->gyro_report_0 = gyro_report;
 					}
 					
 					worker_data->gyro_scale[s].x_offset += gyro_report.x;
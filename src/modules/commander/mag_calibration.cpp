@@ -72,6 +72,7 @@ static constexpr float mag_sphere_radius = 0.2f;
 static constexpr unsigned int calibration_sides = 6;			///< The total number of sides
 static constexpr unsigned int calibration_total_points = 240;		///< The total points per magnetometer
 static constexpr unsigned int calibraton_duration_seconds = 42; 	///< The total duration the routine is allowed to take
+static constexpr unsigned int reject_history_count = calibration_total_points / calibration_sides;	///< Recent points new points are spaced from
 
 calibrate_return mag_calibrate_all(int mavlink_fd, int32_t (&device_ids)[max_mags]);
 
@@ -85,9 +86,8 @@ typedef struct  {
 	uint64_t	calibration_interval_perside_useconds;
 	unsigned int	calibration_counter_total[max_mags];
 	bool		side_data_collected[detect_orientation_side_count];
-	float*		x[max_mags];
-	float*		y[max_mags];
-	float*		z[max_mags];
+	sphere_fit_sums_t	sums[max_mags];		///< Sphere fit of the points accepted so far
+	float		(*recent)[reject_history_count][3];	///< Ring of the latest accepted points per mag
 } mag_worker_data_t;
 
 
@@ -191,14 +191,18 @@ int do_mag_calibration(int mavlink_fd)
 	return result;
 }
 
-static bool reject_sample(float sx, float sy, float sz, float x[], float y[], float z[], unsigned count, unsigned max_count)
+static bool reject_sample(float sx, float sy, float sz, const float (&recent)[reject_history_count][3], unsigned count, unsigned max_count)
 {
 	float min_sample_dist = fabsf(5.4f * mag_sphere_radius / sqrtf(max_count)) / 3.0f;
 
+	if (count > reject_history_count) {
+		count = reject_history_count;
+	}
+
 	for (size_t i = 0; i < count; i++) {
-		float dx = sx - x[i];
-		float dy = sy - y[i];
-		float dz = sz - z[i];
+		float dx = sx - recent[i][0];
+		float dy = sy - recent[i][1];
+		float dz = sz - recent[i][2];
 		float dist = sqrtf(dx * dx + dy * dy + dz * dz);
 
 		if (dist < min_sample_dist) {
@@ -316,38 +320,37 @@ static calibrate_return mag_calibration_worker(detect_orientation_return orienta
 		
 		if (poll_ret > 0) {
 
-			int prev_count[max_mags];
+			struct mag_report mag[max_mags];
 			bool rejected = false;
 
 			for (size_t cur_mag=0; cur_mag<max_mags; cur_mag++) {
 
-				prev_count[cur_mag] = worker_data->calibration_counter_total[cur_mag];
-
 				if (worker_data->sub_mag[cur_mag] >= 0) {
-					struct mag_report mag;
-
-					orb_copy(ORB_ID(sensor_mag), worker_data->sub_mag[cur_mag], &mag);
+					orb_copy(ORB_ID(sensor_mag), worker_data->sub_mag[cur_mag], &mag[cur_mag]);
 
 					// Check if this measurement is good to go in
-					rejected = rejected || reject_sample(mag.x, mag.y, mag.z,
-						worker_data->x[cur_mag], worker_data->y[cur_mag], worker_data->z[cur_mag],
+					rejected = rejected || reject_sample(mag[cur_mag].x, mag[cur_mag].y, mag[cur_mag].z,
+						worker_data->recent[cur_mag],
 						worker_data->calibration_counter_total[cur_mag],
 						calibration_sides * worker_data->calibration_points_perside);
-					
-					worker_data->x[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.x;
-					worker_data->y[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.y;
-					worker_data->z[cur_mag][worker_data->calibration_counter_total[cur_mag]] = mag.z;
-					worker_data->calibration_counter_total[cur_mag]++;
 				}
 			}
 
-			// Keep calibration of all mags in lockstep
-			if (rejected) {
-				// Reset counts, since one of the mags rejected the measurement
-				for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
-					worker_data->calibration_counter_total[cur_mag] = prev_count[cur_mag];
+			// Keep calibration of all mags in lockstep, only add the measurement if no mag rejected it
+			if (!rejected) {
+				for (size_t cur_mag=0; cur_mag<max_mags; cur_mag++) {
+
+					if (worker_data->sub_mag[cur_mag] >= 0) {
+						float *point = worker_data->recent[cur_mag][worker_data->calibration_counter_total[cur_mag] % reject_history_count];
+						point[0] = mag[cur_mag].x;
+						point[1] = mag[cur_mag].y;
+						point[2] = mag[cur_mag].z;
+
+						sphere_fit_sums_add(&worker_data->sums[cur_mag], mag[cur_mag].x, mag[cur_mag].y, mag[cur_mag].z);
+						worker_data->calibration_counter_total[cur_mag]++;
+					}
 				}
-			} else {
+
 				calibration_counter_side++;
 
 				// Progress indicator for side
@@ -401,25 +404,18 @@ calibrate_return mag_calibrate_all(int mavlink_fd, int32_t (&device_ids)[max_mag
 		// Initialize to no subscription
 		worker_data.sub_mag[cur_mag] = -1;
 		
-		// Initialize to no memory allocated
-		worker_data.x[cur_mag] = NULL;
-		worker_data.y[cur_mag] = NULL;
-		worker_data.z[cur_mag] = NULL;
+		sphere_fit_sums_reset(&worker_data.sums[cur_mag]);
 		worker_data.calibration_counter_total[cur_mag] = 0;
 	}
 
-	const unsigned int calibration_points_maxcount = calibration_sides * worker_data.calibration_points_perside;
-	
 	char str[30];
-	
-	for (size_t cur_mag=0; cur_mag<max_mags; cur_mag++) {
-		worker_data.x[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-		worker_data.y[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-		worker_data.z[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-		if (worker_data.x[cur_mag] == NULL || worker_data.y[cur_mag] == NULL || worker_data.z[cur_mag] == NULL) {
-			mavlink_and_console_log_critical(mavlink_fd, "[cal] ERROR: out of memory");
-			result = calibrate_return_error;
-		}
+
+	// Only the recent points are kept for the spacing check, the fit is accumulated as the points arrive
+	worker_data.recent = reinterpret_cast<float (*)[reject_history_count][3]>(malloc(sizeof(worker_data.recent[0]) * max_mags));
+
+	if (worker_data.recent == NULL) {
+		mavlink_and_console_log_critical(mavlink_fd, "[cal] ERROR: out of memory");
+		result = calibrate_return_error;
 	}
 
 	
@@ -485,13 +481,12 @@ calibrate_return mag_calibrate_all(int mavlink_fd, int32_t (&device_ids)[max_mag
 			if (device_ids[cur_mag] != 0) {
 				// Mag in this slot is available and we should have values for it to calibrate
 				
-				sphere_fit_least_squares(worker_data.x[cur_mag], worker_data.y[cur_mag], worker_data.z[cur_mag],
-							 worker_data.calibration_counter_total[cur_mag],
-							 100, 0.0f,
-							 &sphere_x[cur_mag], &sphere_y[cur_mag], &sphere_z[cur_mag],
-							 &sphere_radius[cur_mag]);
-				
-				if (!PX4_ISFINITE(sphere_x[cur_mag]) || !PX4_ISFINITE(sphere_y[cur_mag]) || !PX4_ISFINITE(sphere_z[cur_mag])) {
+				int fit_ret = sphere_fit_least_squares_sums(&worker_data.sums[cur_mag], 100, 0.0f,
+									    &sphere_x[cur_mag], &sphere_y[cur_mag], &sphere_z[cur_mag],
+									    &sphere_radius[cur_mag]);
+
+				if (fit_ret != 0 ||
+				    !PX4_ISFINITE(sphere_x[cur_mag]) || !PX4_ISFINITE(sphere_y[cur_mag]) || !PX4_ISFINITE(sphere_z[cur_mag])) {
 					mavlink_and_console_log_critical(mavlink_fd, "[cal] ERROR: NaN in sphere fit for mag #%u", cur_mag);
 					result = calibrate_return_error;
 				}
@@ -499,56 +494,22 @@ calibrate_return mag_calibrate_all(int mavlink_fd, int32_t (&device_ids)[max_mag
 		}
 	}
 
-	// Print uncalibrated data points
+	// Report the fit, the data points are not stored
 	if (result == calibrate_return_ok) {
-
-		printf("RAW DATA:\n--------------------\n");
 		for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
 
 			if (worker_data.calibration_counter_total[cur_mag] == 0) {
 				continue;
 			}
 
-			printf("RAW: MAG %u with %u samples:\n", (unsigned)cur_mag, (unsigned)worker_data.calibration_counter_total[cur_mag]);
-
-			for (size_t i = 0; i < worker_data.calibration_counter_total[cur_mag]; i++) {
-				float x = worker_data.x[cur_mag][i];
-				float y = worker_data.y[cur_mag][i];
-				float z = worker_data.z[cur_mag][i];
-				printf("%8.4f, %8.4f, %8.4f\n", (double)x, (double)y, (double)z);
-			}
-
-			printf(">>>>>>>\n");
+			mavlink_and_console_log_info(mavlink_fd, "[cal] mag #%u: %u samples, radius %.3f",
+						     (unsigned)cur_mag, (unsigned)worker_data.calibration_counter_total[cur_mag],
+						     (double)sphere_radius[cur_mag]);
 		}
+	}
 
-		printf("CALIBRATED DATA:\n--------------------\n");
-		for (size_t cur_mag = 0; cur_mag < max_mags; cur_mag++) {
-
-			if (worker_data.calibration_counter_total[cur_mag] == 0) {
-				continue;
-			}
-
-			printf("Calibrated: MAG %u with %u samples:\n", (unsigned)cur_mag, (unsigned)worker_data.calibration_counter_total[cur_mag]);
-
-			for (size_t i = 0; i < worker_data.calibration_counter_total[cur_mag]; i++) {
-				float x = worker_data.x[cur_mag][i] - sphere_x[cur_mag];
-				float y = worker_data.y[cur_mag][i] - sphere_y[cur_mag];
-				float z = worker_data.z[cur_mag][i] - sphere_z[cur_mag];
-				printf("%8.4f, %8.4f, %8.4f\n", (double)x, (double)y, (double)z);
-			}
+	free(worker_data.recent);
 
-			printf("SPHERE RADIUS: %8.4f\n", (double)sphere_radius[cur_mag]);
-			printf(">>>>>>>\n");
-		}
-	}
-	
-	// Data points are no longer needed
-	for (size_t cur_mag=0; cur_mag<max_mags; cur_mag++) {
-		free(worker_data.x[cur_mag]);
-		free(worker_data.y[cur_mag]);
-		free(worker_data.z[cur_mag]);
-	}
-	
 	if (result == calibrate_return_ok) {
 		for (unsigned cur_mag=0; cur_mag<max_mags; cur_mag++) {
 			if (device_ids[cur_mag] != 0) {
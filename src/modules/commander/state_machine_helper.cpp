@@ -70,21 +70,83 @@
 #endif
 static const int ERROR = -1;
 
-// This array defines the arming state transitions. The rows are the new state, and the columns
-// are the current state. Using new state and current  state you can index into the array which
-// will be true for a valid transition or false for a invalid transition. In some cases even
-// though the transition is marked as true additional checks must be made. See arming_state_transition
-// code for those checks.
-static const bool arming_transitions[vehicle_status_s::ARMING_STATE_MAX][vehicle_status_s::ARMING_STATE_MAX] = {
-	//                                                    INIT,  STANDBY, ARMED, ARMED_ERROR, STANDBY_ERROR, REBOOT, IN_AIR_RESTORE
-	{ /* vehicle_status_s::ARMING_STATE_INIT */           true,  true,    false, false,       true,          false,  false },
-	{ /* vehicle_status_s::ARMING_STATE_STANDBY */        true,  true,    true,  true,        false,         false,  false },
-	{ /* vehicle_status_s::ARMING_STATE_ARMED */          false, true,    true,  false,       false,         false,  true },
-	{ /* vehicle_status_s::ARMING_STATE_ARMED_ERROR */    false, false,   true,  true,        false,         false,  false },
-	{ /* vehicle_status_s::ARMING_STATE_STANDBY_ERROR */  true,  true,    true,  true,        true,          false,  false },
-	{ /* vehicle_status_s::ARMING_STATE_REBOOT */         true,  true,    false, false,       true,          true,   true },
-	{ /* vehicle_status_s::ARMING_STATE_IN_AIR_RESTORE */ false, false,   false, false,       false,         false,  false }, // NYI
+// This array defines the arming state transitions. The rows are the new state, and every row has a
+// bit set for each current state the transition is valid from, so a check is a single bit test. In
+// some cases even though the transition is marked as valid additional checks must be made. See
+// arming_state_transition code for those checks.
+#define ARMING_BIT(_state) (1 << vehicle_status_s::ARMING_STATE_##_state)
+static const uint8_t arming_transitions[vehicle_status_s::ARMING_STATE_MAX] = {
+	/* vehicle_status_s::ARMING_STATE_INIT */           ARMING_BIT(INIT) | ARMING_BIT(STANDBY) | ARMING_BIT(STANDBY_ERROR),
+	/* vehicle_status_s::ARMING_STATE_STANDBY */        ARMING_BIT(INIT) | ARMING_BIT(STANDBY) | ARMING_BIT(ARMED) | ARMING_BIT(ARMED_ERROR),
+	/* vehicle_status_s::ARMING_STATE_ARMED */          ARMING_BIT(STANDBY) | ARMING_BIT(ARMED) | ARMING_BIT(IN_AIR_RESTORE),
+	/* vehicle_status_s::ARMING_STATE_ARMED_ERROR */    ARMING_BIT(ARMED) | ARMING_BIT(ARMED_ERROR),
+	/* vehicle_status_s::ARMING_STATE_STANDBY_ERROR */  ARMING_BIT(INIT) | ARMING_BIT(STANDBY) | ARMING_BIT(ARMED) | ARMING_BIT(ARMED_ERROR) |
+							    ARMING_BIT(STANDBY_ERROR),
+	/* vehicle_status_s::ARMING_STATE_REBOOT */         ARMING_BIT(INIT) | ARMING_BIT(STANDBY) | ARMING_BIT(STANDBY_ERROR) | ARMING_BIT(REBOOT) |
+							    ARMING_BIT(IN_AIR_RESTORE),
+	/* vehicle_status_s::ARMING_STATE_IN_AIR_RESTORE */ 0, // NYI
 };
+#undef ARMING_BIT
+
+/* the conditions the main and navigation states depend on, see condition_flags() */
+enum {
+	COND_GLOBAL_POSITION	= 1 << 0,
+	COND_HOME_POSITION	= 1 << 1,
+	COND_LOCAL_POSITION	= 1 << 2,
+	COND_LOCAL_ALTITUDE	= 1 << 3,
+	COND_NOT_ROTARY_WING	= 1 << 4,
+	COND_OFFBOARD_SIGNAL	= 1 << 5,
+};
+
+// The conditions a main state needs. Every entry is a list of groups that all need to be
+// satisfied, a group is satisfied by any one of its conditions, an empty group by none.
+static const uint8_t main_state_requirements[vehicle_status_s::MAIN_STATE_MAX][2] = {
+	/* vehicle_status_s::MAIN_STATE_MANUAL */       { 0, 0 },
+	/* vehicle_status_s::MAIN_STATE_ALTCTL */       { COND_NOT_ROTARY_WING | COND_LOCAL_ALTITUDE | COND_GLOBAL_POSITION, 0 }, // TODO: check fixedwing as well
+	/* vehicle_status_s::MAIN_STATE_POSCTL */       { COND_LOCAL_POSITION | COND_GLOBAL_POSITION, 0 },
+	/* vehicle_status_s::MAIN_STATE_AUTO_MISSION */ { COND_GLOBAL_POSITION, COND_HOME_POSITION },
+	/* vehicle_status_s::MAIN_STATE_AUTO_LOITER */  { COND_GLOBAL_POSITION, 0 },
+	/* vehicle_status_s::MAIN_STATE_AUTO_RTL */     { COND_GLOBAL_POSITION, COND_HOME_POSITION },
+	/* vehicle_status_s::MAIN_STATE_ACRO */         { 0, 0 },
+	/* vehicle_status_s::MAIN_STATE_OFFBOARD */     { COND_OFFBOARD_SIGNAL, 0 },
+	/* vehicle_status_s::MAIN_STATE_STAB */         { 0, 0 },
+};
+
+static unsigned condition_flags(const struct vehicle_status_s *status)
+{
+	return (status->condition_global_position_valid ? COND_GLOBAL_POSITION : 0) |
+	       (status->condition_home_position_valid ? COND_HOME_POSITION : 0) |
+	       (status->condition_local_position_valid ? COND_LOCAL_POSITION : 0) |
+	       (status->condition_local_altitude_valid ? COND_LOCAL_ALTITUDE : 0) |
+	       (!status->is_rotary_wing ? COND_NOT_ROTARY_WING : 0) |
+	       (!status->offboard_control_signal_lost ? COND_OFFBOARD_SIGNAL : 0);
+}
+
+/**
+ * Land with the best estimate there is, or terminate without any.
+ */
+static navigation_state_t landing_nav_state(unsigned conditions)
+{
+	if (conditions & COND_LOCAL_POSITION) {
+		return vehicle_status_s::NAVIGATION_STATE_LAND;
+
+	} else if (conditions & COND_LOCAL_ALTITUDE) {
+		return vehicle_status_s::NAVIGATION_STATE_DESCEND;
+
+	} else {
+		return vehicle_status_s::NAVIGATION_STATE_TERMINATION;
+	}
+}
+
+/**
+ * Return with the given state if the way home is known, land otherwise.
+ */
+static navigation_state_t failsafe_nav_state(unsigned conditions, navigation_state_t return_state)
+{
+	const unsigned way_home = COND_GLOBAL_POSITION | COND_HOME_POSITION;
+
+	return ((conditions & way_home) == way_home) ? return_state : landing_nav_state(conditions);
+}
 
 // You can index into the array with an arming_state_t in order to get it's textual representation
 static const char * const state_names[vehicle_status_s::ARMING_STATE_MAX] = {
@@ -153,7 +215,7 @@ arming_state_transition(struct vehicle_status_s *status,		///< current vehicle s
 		}
 
 		// Check that we have a valid state transition
-		bool valid_transition = arming_transitions[new_arming_state][status->arming_state];
+		bool valid_transition = arming_transitions[new_arming_state] & (1 << status->arming_state);
 
 		if (valid_transition) {
 			// We have a good transition. Now perform any secondary validation.
@@ -300,59 +362,16 @@ main_state_transition(struct vehicle_status_s *status, main_state_t new_main_sta
 	transition_result_t ret = TRANSITION_DENIED;
 
 	/* transition may be denied even if the same state is requested because conditions may have changed */
-	switch (new_main_state) {
-	case vehicle_status_s::MAIN_STATE_MANUAL:
-	case vehicle_status_s::MAIN_STATE_ACRO:
-	case vehicle_status_s::MAIN_STATE_STAB:
-		ret = TRANSITION_CHANGED;
-		break;
+	if (new_main_state < vehicle_status_s::MAIN_STATE_MAX) {
+		const unsigned conditions = condition_flags(status);
+		const uint8_t *required = main_state_requirements[new_main_state];
 
-	case vehicle_status_s::MAIN_STATE_ALTCTL:
-		/* need at minimum altitude estimate */
-		/* TODO: add this for fixedwing as well */
-		if (!status->is_rotary_wing ||
-		    (status->condition_local_altitude_valid ||
-		     status->condition_global_position_valid)) {
+		if ((required[0] == 0 || (conditions & required[0])) &&
+		    (required[1] == 0 || (conditions & required[1]))) {
 			ret = TRANSITION_CHANGED;
 		}
-		break;
-
-	case vehicle_status_s::MAIN_STATE_POSCTL:
-		/* need at minimum local position estimate */
-		if (status->condition_local_position_valid ||
-		    status->condition_global_position_valid) {
-			ret = TRANSITION_CHANGED;
-		}
-		break;
-
-	case vehicle_status_s::MAIN_STATE_AUTO_LOITER:
-		/* need global position estimate */
-		if (status->condition_global_position_valid) {
-			ret = TRANSITION_CHANGED;
-		}
-		break;
-
-	case vehicle_status_s::MAIN_STATE_AUTO_MISSION:
-	case vehicle_status_s::MAIN_STATE_AUTO_RTL:
-		/* need global position and home position */
-		if (status->condition_global_position_valid && status->condition_home_position_valid) {
-			ret = TRANSITION_CHANGED;
-		}
-		break;
-
-	case vehicle_status_s::MAIN_STATE_OFFBOARD:
-
-		/* need offboard signal */
-		if (!status->offboard_control_signal_lost) {
-			ret = TRANSITION_CHANGED;
-		}
-
-		break;
-
-	case vehicle_status_s::MAIN_STATE_MAX:
-	default:
-		break;
 	}
+
 	if (ret == TRANSITION_CHANGED) {
 		if (status->main_state != new_main_state) {
 			status->main_state = new_main_state;
@@ -521,6 +540,7 @@ bool set_nav_state(struct vehicle_status_s *status, const bool data_link_loss_en
 	navigation_state_t nav_state_old = status->nav_state;
 
 	bool armed = (status->arming_state == vehicle_status_s::ARMING_STATE_ARMED || status->arming_state == vehicle_status_s::ARMING_STATE_ARMED_ERROR);
+	const unsigned conditions = condition_flags(status);
 	status->failsafe = false;
 
 	/* evaluate main state to decide in normal (non-failsafe) mode */
@@ -533,16 +553,7 @@ bool set_nav_state(struct vehicle_status_s *status, const bool data_link_loss_en
 		/* require RC for all manual modes */
 		if ((status->rc_signal_lost || status->rc_signal_lost_cmd) && armed && !status->condition_landed) {
 			status->failsafe = true;
-
-			if (status->condition_global_position_valid && status->condition_home_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_AUTO_RCRECOVER;
-			} else if (status->condition_local_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_LAND;
-			} else if (status->condition_local_altitude_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_DESCEND;
-			} else {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_TERMINATION;
-			}
+			status->nav_state = failsafe_nav_state(conditions, vehicle_status_s::NAVIGATION_STATE_AUTO_RCRECOVER);
 
 		} else {
 			switch (status->main_state) {
@@ -600,16 +611,7 @@ bool set_nav_state(struct vehicle_status_s *status, const bool data_link_loss_en
 		 * check for datalink lost: this should always trigger RTGS */
 		} else if (data_link_loss_enabled && status->data_link_lost) {
 			status->failsafe = true;
-
-			if (status->condition_global_position_valid && status->condition_home_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_AUTO_RTGS;
-			} else if (status->condition_local_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_LAND;
-			} else if (status->condition_local_altitude_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_DESCEND;
-			} else {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_TERMINATION;
-			}
+			status->nav_state = failsafe_nav_state(conditions, vehicle_status_s::NAVIGATION_STATE_AUTO_RTGS);
 
 		/* datalink loss disabled:
 		 * check if both, RC and datalink are lost during the mission
@@ -617,16 +619,7 @@ bool set_nav_state(struct vehicle_status_s *status, const bool data_link_loss_en
 		} else if (!data_link_loss_enabled && ((status->rc_signal_lost && status->data_link_lost) ||
 						       (status->rc_signal_lost && mission_finished))) {
 			status->failsafe = true;
-
-			if (status->condition_global_position_valid && status->condition_home_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_AUTO_RCRECOVER;
-			} else if (status->condition_local_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_LAND;
-			} else if (status->condition_local_altitude_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_DESCEND;
-			} else {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_TERMINATION;
-			}
+			status->nav_state = failsafe_nav_state(conditions, vehicle_status_s::NAVIGATION_STATE_AUTO_RCRECOVER);
 
 		/* stay where you are if you should stay in failsafe, otherwise everything is perfect */
 		} else if (!stay_in_failsafe){
@@ -641,30 +634,12 @@ bool set_nav_state(struct vehicle_status_s *status, const bool data_link_loss_en
 		/* also go into failsafe if just datalink is lost */
 		} else if (status->data_link_lost && data_link_loss_enabled) {
 			status->failsafe = true;
-
-			if (status->condition_global_position_valid && status->condition_home_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_AUTO_RTGS;
-			} else if (status->condition_local_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_LAND;
-			} else if (status->condition_local_altitude_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_DESCEND;
-			} else {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_TERMINATION;
-			}
+			status->nav_state = failsafe_nav_state(conditions, vehicle_status_s::NAVIGATION_STATE_AUTO_RTGS);
 
 		/* go into failsafe if RC is lost and datalink loss is not set up */
 		} else if (status->rc_signal_lost && !data_link_loss_enabled) {
 			status->failsafe = true;
-
-			if (status->condition_global_position_valid && status->condition_home_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_AUTO_RTGS;
-			} else if (status->condition_local_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_LAND;
-			} else if (status->condition_local_altitude_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_DESCEND;
-			} else {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_TERMINATION;
-			}
+			status->nav_state = failsafe_nav_state(conditions, vehicle_status_s::NAVIGATION_STATE_AUTO_RTGS);
 
 		/* don't bother if RC is lost if datalink is connected */
 		} else if (status->rc_signal_lost) {
@@ -682,17 +657,10 @@ bool set_nav_state(struct vehicle_status_s *status, const bool data_link_loss_en
 
 		if (status->engine_failure) {
 			status->nav_state = vehicle_status_s::NAVIGATION_STATE_AUTO_LANDENGFAIL;
-		} else if ((!status->condition_global_position_valid ||
-					!status->condition_home_position_valid)) {
+		} else if ((conditions & (COND_GLOBAL_POSITION | COND_HOME_POSITION)) !=
+			   (COND_GLOBAL_POSITION | COND_HOME_POSITION)) {
 			status->failsafe = true;
-
-			if (status->condition_local_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_LAND;
-			} else if (status->condition_local_altitude_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_DESCEND;
-			} else {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_TERMINATION;
-			}
+			status->nav_state = landing_nav_state(conditions);
 		} else {
 			status->nav_state = vehicle_status_s::NAVIGATION_STATE_AUTO_RTL;
 		}
@@ -706,14 +674,7 @@ bool set_nav_state(struct vehicle_status_s *status, const bool data_link_loss_en
 			status->nav_state = vehicle_status_s::NAVIGATION_STATE_POSCTL;
 		} else if (status->offboard_control_signal_lost && status->rc_signal_lost) {
 			status->failsafe = true;
-
-			if (status->condition_local_position_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_LAND;
-			} else if (status->condition_local_altitude_valid) {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_DESCEND;
-			} else {
-				status->nav_state = vehicle_status_s::NAVIGATION_STATE_TERMINATION;
-			}
+			status->nav_state = landing_nav_state(conditions);
 		} else {
 			status->nav_state = vehicle_status_s::NAVIGATION_STATE_OFFBOARD;
 		}
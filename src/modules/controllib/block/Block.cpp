@@ -135,8 +135,66 @@ void Block::updatePublications()
 	}
 }
 
+int Block::flattenInto(Block **blocks, uint16_t size, uint16_t count)
+{
+	if (count >= size) {
+		return -1;
+	}
+
+	blocks[count++] = this;
+	return count;
+}
+
+int SuperBlock::flattenInto(Block **blocks, uint16_t size, uint16_t count)
+{
+	int ret = Block::flattenInto(blocks, size, count);
+	Block *child = getChildren().getHead();
+	int children = 0;
+
+	while (child != NULL && ret >= 0) {
+		if (children++ > maxChildrenPerBlock) {
+			char name[40];
+			getName(name, 40);
+			printf("exceeded max children for block: %s\n", name);
+			return -1;
+		}
+
+		ret = child->flattenInto(blocks, size, ret);
+		child = child->getSibling();
+	}
+
+	return ret;
+}
+
+int SuperBlock::flatten(Block **blocks, uint16_t size)
+{
+	_flat = NULL;
+	_flatCount = 0;
+
+	int ret = flattenInto(blocks, size, 0);
+
+	if (ret < 0) {
+		char name[blockNameLengthMax];
+		getName(name, blockNameLengthMax);
+		printf("too many blocks to flatten: %s\n", name);
+		return -1;
+	}
+
+	_flat = blocks;
+	_flatCount = ret;
+	return 0;
+}
+
 void SuperBlock::setDt(float dt)
 {
+	if (_flat != NULL) {
+		for (uint16_t i = 0; i < _flatCount; i++) {
+			_flat[i]->Block::setDt(dt);
+		}
+
+		return;
+	}
+
 	Block::setDt(dt);
 	Block *child = getChildren().getHead();
 	int count = 0;
@@ -75,6 +75,12 @@ public:
 	virtual void updateSubscriptions();
 	virtual void updatePublications();
 	virtual void setDt(float dt) { _dt = dt; }
+	/**
+	 * Append this block and all blocks below it to blocks
+	 *
+	 * @return the new number of blocks, or -1 if size is exceeded
+	 */
+	virtual int flattenInto(Block **blocks, uint16_t size, uint16_t count);
 // accessors
 	float getDt() { return _dt; }
 protected:
@@ -105,25 +111,56 @@ public:
 // methods
 	SuperBlock(SuperBlock *parent, const char *name) :
 		Block(parent, name),
-		_children() {
+		_children(),
+		_flat(NULL),
+		_flatCount(0) {
 	}
 	virtual ~SuperBlock() {};
 	virtual void setDt(float dt);
 	virtual void updateParams() {
+		if (_flat != NULL) {
+			for (uint16_t i = 0; i < _flatCount; i++) _flat[i]->Block::updateParams();
+
+			return;
+		}
+
 		Block::updateParams();
 
 		if (getChildren().getHead() != NULL) updateChildParams();
 	}
 	virtual void updateSubscriptions() {
+		if (_flat != NULL) {
+			for (uint16_t i = 0; i < _flatCount; i++) _flat[i]->Block::updateSubscriptions();
+
+			return;
+		}
+
 		Block::updateSubscriptions();
 
 		if (getChildren().getHead() != NULL) updateChildSubscriptions();
 	}
 	virtual void updatePublications() {
+		if (_flat != NULL) {
+			for (uint16_t i = 0; i < _flatCount; i++) _flat[i]->Block::updatePublications();
+
+			return;
+		}
+
 		Block::updatePublications();
 
 		if (getChildren().getHead() != NULL) updateChildPublications();
 	}
+	virtual int flattenInto(Block **blocks, uint16_t size, uint16_t count);
+	/**
+	 * Update the whole tree from a flat array instead of walking the
+	 * child lists. Call once all children are constructed, blocks is
+	 * storage owned by the caller, typically a member array of the
+	 * top level block.
+	 *
+	 * @return 0, or -1 if the tree does not fit, then the child
+	 * lists are used as before
+	 */
+	int flatten(Block **blocks, uint16_t size);
 protected:
 // methods
 	List<Block *> & getChildren() { return _children; }
@@ -132,6 +169,8 @@ protected:
 	void updateChildPublications();
 // attributes
 	List<Block *> _children;
+	Block **_flat;
+	uint16_t _flatCount;
 };
 
 
@@ -49,7 +49,8 @@ namespace control
 {
 
 BlockParamBase::BlockParamBase(Block *parent, const char *name, bool parent_prefix) :
-	_handle(PARAM_INVALID)
+	_handle(PARAM_INVALID),
+	_change_seq(0)
 {
 	char fullname[blockNameLengthMax];
 
@@ -90,11 +91,19 @@ template <class T>
 T BlockParam<T>::get() { return _val; }
 
 template <class T>
-void BlockParam<T>::set(T val) { _val = val; }
+void BlockParam<T>::set(T val) {
+	_val = val;
+	/* the local value is not committed, the next update reads the parameter again */
+	_change_seq = 0;
+}
 
 template <class T>
 void BlockParam<T>::update() {
-	if (_handle != PARAM_INVALID) param_get(_handle, &_val);
+	if (_handle != PARAM_INVALID && param_changed_since(_handle, _change_seq)) {
+		/* sample the sequence first, so a change racing with param_get is seen next time */
+		_change_seq = param_get_change_seq();
+		param_get(_handle, &_val);
+	}
 }
 
 template <class T>
@@ -66,6 +66,7 @@ public:
 	const char *getName() { return param_name(_handle); }
 protected:
 	param_t _handle;
+	uint32_t _change_seq;	/**< parameter change sequence at the last update, 0 if never read */
 };
 
 /**
@@ -81,6 +82,10 @@ public:
 	T get();
 	void commit();
 	void set(T val);
+
+	/**
+	 * Read the parameter again, if it changed since the last update.
+	 */
 	void update();
 	virtual ~BlockParam();
 protected:
@@ -58,6 +58,7 @@ int basicBlocksTest()
 	blockPITest();
 	blockPDTest();
 	blockPIDTest();
+	blockFlattenTest();
 	blockOutputTest();
 	blockRandUniformTest();
 	blockRandGaussTest();
@@ -419,6 +420,28 @@ int blockPIDTest()
 	return 0;
 }
 
+int blockFlattenTest()
+{
+	printf("Test flatten\t\t\t: ");
+	BlockPID blockPID(NULL, "TEST");
+	Block *blocks[16];
+	// the tree does not fit, updates walk the children
+	ASSERT(blockPID.flatten(blocks, 2) < 0);
+	blockPID.setDt(0.2f);
+	ASSERT(equal(0.2f, blockPID.getDerivative().getDt()));
+	// flat updates reach the whole tree
+	ASSERT(blockPID.flatten(blocks, 16) == 0);
+	ASSERT(blocks[0] == &blockPID);
+	blockPID.setDt(0.1f);
+	ASSERT(equal(0.1f, blockPID.getDt()));
+	ASSERT(equal(0.1f, blockPID.getIntegral().getDt()));
+	ASSERT(equal(0.1f, blockPID.getDerivative().getDt()));
+	blockPID.updateParams();
+	ASSERT(equal(0.2f, blockPID.getKP()));
+	printf("PASS\n");
+	return 0;
+}
+
 int blockOutputTest()
 {
 	printf("Test BlockOutput\t\t: ");
@@ -470,9 +493,9 @@ int blockRandUniformTest()
 
 int blockRandGaussTest()
 {
-	srand(1234);
 	printf("Test BlockRandGauss\t\t: ");
 	BlockRandGauss blockRandGauss(NULL, "TEST");
+	blockRandGauss.seed(1234);
 	// test initial state
 	ASSERT(equal(0.0f, blockRandGauss.getDt()));
 	ASSERT(equal(1.0f, blockRandGauss.getMean()));
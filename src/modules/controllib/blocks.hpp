@@ -45,6 +45,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <mathlib/math/test/test.hpp>
+#include <mathlib/math/GaussNoise.hpp>
 
 #include "block/Block.hpp"
 #include "block/BlockParam.hpp"
@@ -397,6 +398,8 @@ private:
 
 int __EXPORT blockPIDTest();
 
+int __EXPORT blockFlattenTest();
+
 /**
  * An output trim/ saturation block
  */
@@ -471,35 +474,16 @@ public:
 		       const char *name) :
 		Block(parent, name),
 		_mean(this, "MEAN"),
-		_stdDev(this, "DEV") {
-		// seed should be initialized somewhere
-		// in main program for all calls to rand
-		// XXX currently in nuttx if you seed to 0, rand breaks
+		_stdDev(this, "DEV"),
+		_noise() {
+		// every block has its own generator,
+		// seeded by the order of construction
 	};
 	virtual ~BlockRandGauss() {};
 	float update() {
-		static float V1, V2, S;
-		static int phase = 0;
-		float X;
-
-		if (phase == 0) {
-			do {
-				float U1 = (float)rand() / MAX_RAND;
-				float U2 = (float)rand() / MAX_RAND;
-				V1 = 2 * U1 - 1;
-				V2 = 2 * U2 - 1;
-				S = V1 * V1 + V2 * V2;
-			} while (S >= 1 || fabsf(S) < 1e-8f);
-
-			X = V1 * float(sqrt(-2 * float(log(S)) / S));
-
-		} else {
-			X = V2 * float(sqrt(-2 * float(log(S)) / S));
-		}
-
-		phase = 1 - phase;
-		return X * getStdDev() + getMean();
+		return _noise.next() * getStdDev() + getMean();
 	}
+	void seed(uint64_t seed) { _noise.seed(seed); }
 // accessors
 	float getMean() { return _mean.get(); }
 	float getStdDev() { return _stdDev.get(); }
@@ -507,6 +491,7 @@ private:
 // attributes
 	control::BlockParamFloat _mean;
 	control::BlockParamFloat _stdDev;
+	math::GaussNoise _noise;
 };
 
 int __EXPORT blockRandGaussTest();
@@ -51,6 +51,12 @@
 #include <string.h>
 #include <semaphore.h>
 #include <unistd.h>
+#include <crc32.h>
+#include <limits.h>
+
+#ifdef __PX4_POSIX
+#include <sys/mman.h>
+#endif
 
 #include "dataman.h"
 #include <systemlib/param/param.h>
@@ -63,6 +69,9 @@
 
 __EXPORT int dataman_main(int argc, char *argv[]);
 __EXPORT ssize_t dm_read(dm_item_t item, unsigned char index, void *buffer, size_t buflen);
+__EXPORT ssize_t dm_read_many(dm_item_t item, unsigned char index, unsigned count, void *buffer, size_t buflen);
+__EXPORT int dm_read_async(dm_request_t *request);
+__EXPORT ssize_t dm_wait(dm_request_t *request);
 __EXPORT ssize_t dm_write(dm_item_t  item, unsigned char index, dm_persitence_t persistence, const void *buffer,
 			  size_t buflen);
 __EXPORT int dm_clear(dm_item_t item);
@@ -76,6 +85,7 @@ typedef enum {
 	dm_read_func,
 	dm_clear_func,
 	dm_restart_func,
+	dm_read_many_func,
 	dm_number_of_funcs
 } dm_function_t;
 
@@ -106,6 +116,9 @@ typedef struct {
 		struct {
 			dm_reset_reason reason;
 		} restart_params;
+		struct {
+			dm_request_t *request;
+		} read_many_params;
 	};
 } work_q_item_t;
 
@@ -132,10 +145,29 @@ static sem_t *g_item_locks[DM_KEY_NUM_KEYS];
 static sem_t g_sys_state_mutex;
 
 /* The data manager store file handle and file name */
-static int g_fd = -1, g_task_fd = -1;
+static int g_task_fd = -1;
 static const char *default_device_path = PX4_ROOTFSDIR"/fs/microsd/dataman";
 static char *k_data_manager_device_path = NULL;
 
+/* True while the data manager accepts requests from callers */
+static volatile bool g_accepting = false;
+
+/* Storage backend, offsets are relative to the start of the store */
+typedef struct {
+	const char *name;
+	int (*open)(unsigned size);		/* Make size bytes of storage available, 0 on success */
+	void (*close)(void);
+	ssize_t (*read)(unsigned offset, void *buf, size_t count);
+	ssize_t (*write)(unsigned offset, const void *buf, size_t count);
+	void (*sync)(void);			/* Make sure written data reached the medium */
+	bool direct;				/* Served in the caller context instead of the worker thread */
+} dm_backend_t;
+
+static const dm_backend_t *g_backend = NULL;
+
+/* Serializes requests served in the caller context by direct backends */
+static sem_t g_direct_mutex;
+
 /* The data manager work queues */
 
 typedef struct {
@@ -156,6 +188,30 @@ static bool g_task_should_exit;	/**< if true, dataman task should exit */
 #define DM_SECTOR_HDR_SIZE 4	/* data manager per item header overhead */
 static const unsigned k_sector_size = DM_MAX_DATA_SIZE + DM_SECTOR_HDR_SIZE; /* total item sorage space */
 
+/* Items read with one read() call by dm_read_many(), the buffer is only used by the worker thread
+ * or under g_direct_mutex */
+#define DM_READ_CHUNK_ITEMS 4
+static unsigned char g_read_chunk[DM_READ_CHUNK_ITEMS * (DM_MAX_DATA_SIZE + DM_SECTOR_HDR_SIZE)];
+
+/* Write-back cache of the file backend: dm_write() returns once the item is in RAM, the worker
+ * thread writes the dirty items to the file in the order they were written, so that e.g. the
+ * mission state never reaches the file before the mission items it refers to */
+#define DM_CACHE_ITEMS 8
+
+typedef struct {
+	int offset;		/* Offset of the cached sector in the store, -1 if the entry is unused */
+	unsigned seq;		/* Write sequence number while dirty, 0 once written to the store */
+	unsigned char sector[DM_MAX_DATA_SIZE + DM_SECTOR_HDR_SIZE];
+} dm_cache_entry_t;
+
+static dm_cache_entry_t *g_cache = NULL;
+static sem_t g_cache_mutex;		/* Callers fill the cache while the worker thread flushes it */
+static unsigned g_cache_seq = 0;
+static unsigned g_cache_hits = 0;
+static unsigned g_cache_full = 0;	/* Writes which had to wait for the store */
+static unsigned g_cache_errors = 0;	/* Cached writes which failed to reach the store */
+static unsigned g_crc_errors = 0;
+
 static void init_q(work_q_t *q)
 {
 	sq_init(&(q->q));		/* Initialize the NuttX queue structure */
@@ -262,9 +318,39 @@ dequeue_work_item(void)
 	return work;
 }
 
-static int
-enqueue_work_item_and_wait_for_result(work_q_item_t *item)
+static void handle_work_item(work_q_item_t *work);
+
+static void
+enqueue_work_item(work_q_item_t *item)
 {
+	/* memory backends are fast enough to serve the caller right away */
+	if (g_backend->direct) {
+		sem_wait(&g_direct_mutex);
+
+		if (g_accepting) {
+			handle_work_item(item);
+
+		} else {
+			/* the store is being closed */
+			item->result = -1;
+
+			if (item->func == dm_read_many_func) {
+				dm_request_t *request = item->read_many_params.request;
+
+				destroy_work_item(item);
+				request->result = -1;
+				request->done = true;
+				sem_post(&request->done_sem);
+
+			} else {
+				sem_post(&item->wait_sem);
+			}
+		}
+
+		sem_post(&g_direct_mutex);
+		return;
+	}
+
 	/* put the work item at the end of the work queue */
 	lock_queue(&g_work_q);
 	sq_addlast(&item->link, &(g_work_q.q));
@@ -278,6 +364,12 @@ enqueue_work_item_and_wait_for_result(work_q_item_t *item)
 
 	/* tell the work thread that work is available */
 	sem_post(&g_work_queued_sema);
+}
+
+static int
+enqueue_work_item_and_wait_for_result(work_q_item_t *item)
+{
+	enqueue_work_item(item);
 
 	/* wait for the result */
 	sem_wait(&item->wait_sem);
@@ -289,6 +381,215 @@ enqueue_work_item_and_wait_for_result(work_q_item_t *item)
 	return result;
 }
 
+/* File backend: the store lives in a file, normally on the SD card */
+
+static int
+file_open(unsigned size)
+{
+	/* See if the data manage file exists and is a multiple of the sector size */
+	g_task_fd = open(k_data_manager_device_path, O_RDONLY | O_BINARY);
+
+	if (g_task_fd >= 0) {
+		/* File exists, check its size */
+		int file_size = lseek(g_task_fd, 0, SEEK_END);
+
+		if ((file_size % k_sector_size) != 0) {
+			warnx("Incompatible data manager file %s, resetting it", k_data_manager_device_path);
+			warnx("Size: %u, sector size: %d", file_size, k_sector_size);
+			close(g_task_fd);
+			unlink(k_data_manager_device_path);
+
+		} else {
+			close(g_task_fd);
+		}
+	}
+
+	/* Open or create the data manager file */
+	g_task_fd = open(k_data_manager_device_path, O_RDWR | O_CREAT | O_BINARY, PX4_O_MODE_666);
+
+	if (g_task_fd < 0) {
+		warnx("Could not open data manager file %s", k_data_manager_device_path);
+		return -1;
+	}
+
+	if ((unsigned)lseek(g_task_fd, size, SEEK_SET) != size) {
+		close(g_task_fd);
+		g_task_fd = -1;
+		warnx("Could not seek data manager file %s", k_data_manager_device_path);
+		return -1;
+	}
+
+	fsync(g_task_fd);
+	return 0;
+}
+
+static void
+file_close(void)
+{
+	close(g_task_fd);
+	g_task_fd = -1;
+}
+
+static ssize_t
+file_read(unsigned offset, void *buf, size_t count)
+{
+	if ((unsigned)lseek(g_task_fd, offset, SEEK_SET) != offset) {
+		return -1;
+	}
+
+	return read(g_task_fd, buf, count);
+}
+
+static ssize_t
+file_write(unsigned offset, const void *buf, size_t count)
+{
+	if ((unsigned)lseek(g_task_fd, offset, SEEK_SET) != offset) {
+		return -1;
+	}
+
+	return write(g_task_fd, buf, count);
+}
+
+static void
+file_sync(void)
+{
+	fsync(g_task_fd);
+}
+
+static const dm_backend_t g_file_backend = {
+	.name = "file",
+	.open = file_open,
+	.close = file_close,
+	.read = file_read,
+	.write = file_write,
+	.sync = file_sync,
+	.direct = false
+};
+
+/* Memory backends: RAM, which loses everything on reset, and on POSIX a memory mapped file */
+
+static unsigned char *g_store = NULL;
+static unsigned g_store_size = 0;
+
+static int
+ram_open(unsigned size)
+{
+	g_store = (unsigned char *)calloc(size, 1);
+
+	if (g_store == NULL) {
+		warnx("Could not allocate %u bytes of data manager RAM", size);
+		return -1;
+	}
+
+	g_store_size = size;
+	return 0;
+}
+
+static void
+ram_close(void)
+{
+	free(g_store);
+	g_store = NULL;
+	g_store_size = 0;
+}
+
+static ssize_t
+ram_read(unsigned offset, void *buf, size_t count)
+{
+	if (offset >= g_store_size) {
+		return 0;
+	}
+
+	if (count > g_store_size - offset) {
+		count = g_store_size - offset;
+	}
+
+	memcpy(buf, g_store + offset, count);
+	return count;
+}
+
+static ssize_t
+ram_write(unsigned offset, const void *buf, size_t count)
+{
+	if (offset >= g_store_size || count > g_store_size - offset) {
+		return -1;
+	}
+
+	memcpy(g_store + offset, buf, count);
+	return count;
+}
+
+static void
+ram_sync(void)
+{
+}
+
+static const dm_backend_t g_ram_backend = {
+	.name = "RAM",
+	.open = ram_open,
+	.close = ram_close,
+	.read = ram_read,
+	.write = ram_write,
+	.sync = ram_sync,
+	.direct = true
+};
+
+#ifdef __PX4_POSIX
+static int
+mmap_open(unsigned size)
+{
+	/* start from a valid file, then map it as a whole */
+	if (file_open(size) != 0) {
+		return -1;
+	}
+
+	if (ftruncate(g_task_fd, size) != 0) {
+		warnx("Could not resize data manager file %s", k_data_manager_device_path);
+		file_close();
+		return -1;
+	}
+
+	void *store = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, g_task_fd, 0);
+
+	if (store == MAP_FAILED) {
+		warnx("Could not map data manager file %s", k_data_manager_device_path);
+		file_close();
+		return -1;
+	}
+
+	g_store = (unsigned char *)store;
+	g_store_size = size;
+	return 0;
+}
+
+static void
+mmap_close(void)
+{
+	msync(g_store, g_store_size, MS_SYNC);
+	munmap(g_store, g_store_size);
+	g_store = NULL;
+	g_store_size = 0;
+	file_close();
+}
+
+static void
+mmap_sync(void)
+{
+	/* let the kernel write back in the background, mmap_close() waits for it */
+	msync(g_store, g_store_size, MS_ASYNC);
+}
+
+static const dm_backend_t g_mmap_backend = {
+	.name = "mapped file",
+	.open = mmap_open,
+	.close = mmap_close,
+	.read = ram_read,
+	.write = ram_write,
+	.sync = mmap_sync,
+	.direct = true
+};
+#endif
+
 /* Calculate the offset in file of specific item */
 static int
 calculate_offset(dm_item_t item, unsigned char index)
@@ -312,13 +613,212 @@ calculate_offset(dm_item_t item, unsigned char index)
  *
  * byte 0: Length of user data item
  * byte 1: Persistence of this data item
- * byte 2: Unused (for future use)
- * byte 3: Unused (for future use)
+ * byte 2: Checksum of bytes 0, 1 and the data item value, low byte
+ * byte 3: Checksum, high byte. 0 for items written before the checksums
  * byte DM_SECTOR_HDR_SIZE... : data item value
  *
  * The total size must not exceed k_sector_size
  */
 
+static uint16_t
+sector_crc(const unsigned char *sector)
+{
+	uint32_t crc = crc32part(sector, 2, 0);
+	crc = crc32part(sector + DM_SECTOR_HDR_SIZE, sector[0], crc);
+
+	/* 0 marks the items written before the checksums */
+	return ((crc & 0xffff) != 0) ? (crc & 0xffff) : 0xffff;
+}
+
+/* Fill in the header of a sector */
+static void
+sector_encode(unsigned char *sector, dm_persitence_t persistence, const void *buf, size_t count)
+{
+	sector[0] = count;
+	sector[1] = persistence;
+
+	if (count > 0) {
+		memcpy(sector + DM_SECTOR_HDR_SIZE, buf, count);
+	}
+
+	uint16_t crc = sector_crc(sector);
+	sector[2] = crc & 0xff;
+	sector[3] = crc >> 8;
+}
+
+/* Check the data of a sector against its checksum, the data must be complete */
+static bool
+sector_valid(const unsigned char *sector)
+{
+	uint16_t crc = sector[2] | (sector[3] << 8);
+
+	if (crc == 0 || crc == sector_crc(sector)) {
+		return true;
+	}
+
+	g_crc_errors++;
+	return false;
+}
+
+/* Copy a cached sector, true if the store offset is cached */
+static bool
+cache_read(int offset, unsigned char *sector)
+{
+	bool found = false;
+
+	if (g_cache == NULL) {
+		return false;
+	}
+
+	sem_wait(&g_cache_mutex);
+
+	for (unsigned i = 0; i < DM_CACHE_ITEMS; i++) {
+		if (g_cache[i].offset == offset) {
+			memcpy(sector, g_cache[i].sector, k_sector_size);
+			g_cache_hits++;
+			found = true;
+			break;
+		}
+	}
+
+	sem_post(&g_cache_mutex);
+	return found;
+}
+
+/* Put an item in the cache, in the caller context. -1 on error, -2 if the cache is full of dirty items */
+static ssize_t
+cache_write(dm_item_t item, unsigned char index, dm_persitence_t persistence, const void *buf, size_t count)
+{
+	int offset = calculate_offset(item, index);
+
+	if (offset < 0 || count > DM_MAX_DATA_SIZE) {
+		return -1;
+	}
+
+	dm_cache_entry_t *entry = NULL;
+
+	sem_wait(&g_cache_mutex);
+
+	/* the entry of the same item, else an unused one, else one already in the store */
+	for (unsigned i = 0; i < DM_CACHE_ITEMS; i++) {
+		if (g_cache[i].offset == offset) {
+			entry = &g_cache[i];
+			break;
+
+		} else if (g_cache[i].offset < 0) {
+			entry = &g_cache[i];
+
+		} else if (g_cache[i].seq == 0 && (entry == NULL || entry->offset >= 0)) {
+			entry = &g_cache[i];
+		}
+	}
+
+	if (entry == NULL) {
+		g_cache_full++;
+		sem_post(&g_cache_mutex);
+		return -2;
+	}
+
+	g_func_counts[dm_write_func]++;
+
+	entry->offset = offset;
+	sector_encode(entry->sector, persistence, buf, count);
+
+	if (++g_cache_seq == 0) {
+		g_cache_seq = 1;
+	}
+
+	entry->seq = g_cache_seq;
+
+	sem_post(&g_cache_mutex);
+
+	/* have the worker thread write it */
+	sem_post(&g_work_queued_sema);
+
+	return count;
+}
+
+/* Write the dirty items to the store in the order they were written, in the worker thread */
+static void
+cache_flush(void)
+{
+	unsigned char sector[k_sector_size];
+	bool written = false;
+
+	if (g_cache == NULL) {
+		return;
+	}
+
+	for (;;) {
+		dm_cache_entry_t *oldest = NULL;
+
+		sem_wait(&g_cache_mutex);
+
+		for (unsigned i = 0; i < DM_CACHE_ITEMS; i++) {
+			/* sequence numbers may wrap, compare their distance */
+			if (g_cache[i].seq != 0 && (oldest == NULL || (int)(g_cache[i].seq - oldest->seq) < 0)) {
+				oldest = &g_cache[i];
+			}
+		}
+
+		if (oldest == NULL) {
+			sem_post(&g_cache_mutex);
+			break;
+		}
+
+		/* write a copy, callers may update the entry meanwhile */
+		int offset = oldest->offset;
+		unsigned seq = oldest->seq;
+		memcpy(sector, oldest->sector, k_sector_size);
+
+		sem_post(&g_cache_mutex);
+
+		size_t len = sector[0] + DM_SECTOR_HDR_SIZE;
+
+		if ((size_t)g_backend->write(offset, sector, len) != len) {
+			/* the caller was told it succeeded, the item is lost */
+			if (g_cache_errors++ == 0) {
+				warnx("Could not write cached item at offset %d", offset);
+			}
+		}
+
+		written = true;
+
+		sem_wait(&g_cache_mutex);
+
+		/* unless it was written again meanwhile the entry is clean */
+		if (oldest->seq == seq) {
+			oldest->seq = 0;
+		}
+
+		sem_post(&g_cache_mutex);
+	}
+
+	if (written) {
+		g_backend->sync();        /* Make sure data is written to physical media */
+	}
+}
+
+/* Drop the cached items in a range of the store, after it was changed underneath the cache */
+static void
+cache_invalidate(int start, int end)
+{
+	if (g_cache == NULL) {
+		return;
+	}
+
+	sem_wait(&g_cache_mutex);
+
+	for (unsigned i = 0; i < DM_CACHE_ITEMS; i++) {
+		if (g_cache[i].offset >= start && g_cache[i].offset < end) {
+			g_cache[i].offset = -1;
+			g_cache[i].seq = 0;
+		}
+	}
+
+	sem_post(&g_cache_mutex);
+}
+
 /* write to the data manager file */
 static ssize_t
 _write(dm_item_t item, unsigned char index, dm_persitence_t persistence, const void *buf, size_t count)
@@ -340,25 +840,21 @@ _write(dm_item_t item, unsigned char index, dm_persitence_t persistence, const v
 		return -1;
 	}
 
-	/* Write out the data, prefixed with length and persistence level */
-	buffer[0] = count;
-	buffer[1] = persistence;
-	buffer[2] = 0;
-	buffer[3] = 0;
-
-	if (count > 0) {
-		memcpy(buffer + DM_SECTOR_HDR_SIZE, buf, count);
-	}
+	/* Write out the data, prefixed with length, persistence level and checksum */
+	sector_encode(buffer, persistence, buf, count);
 
 	count += DM_SECTOR_HDR_SIZE;
 
+	/* Keep the order of the writes still in the cache, and drop its copy of this item */
+	cache_flush();
+	cache_invalidate(offset, offset + 1);
+
 	len = -1;
 
-	/* Seek to the right spot in the data manager file and write the data item */
-	if (lseek(g_task_fd, offset, SEEK_SET) == offset)
-		if ((len = write(g_task_fd, buffer, count)) == count) {
-			fsync(g_task_fd);        /* Make sure data is written to physical media */
-		}
+	/* Write the data item to the right spot in the store */
+	if ((len = g_backend->write(offset, buffer, count)) == count) {
+		g_backend->sync();        /* Make sure data is written to physical media */
+	}
 
 	/* Make sure the write succeeded */
 	if (len != count) {
@@ -389,11 +885,14 @@ _read(dm_item_t item, unsigned char index, void *buf, size_t count)
 		return -1;
 	}
 
-	/* Read the prefix and data */
+	/* Read the prefix and data, the latest version may still be in the cache */
 	len = -1;
 
-	if (lseek(g_task_fd, offset, SEEK_SET) == offset) {
-		len = read(g_task_fd, buffer, count + DM_SECTOR_HDR_SIZE);
+	if (cache_read(offset, buffer)) {
+		len = k_sector_size;
+
+	} else {
+		len = g_backend->read(offset, buffer, count + DM_SECTOR_HDR_SIZE);
 	}
 
 	/* Check for read error */
@@ -413,6 +912,11 @@ _read(dm_item_t item, unsigned char index, void *buf, size_t count)
 			return -1;
 		}
 
+		/* A short or damaged item, e.g. a write interrupted by a power loss */
+		if (len < buffer[0] + DM_SECTOR_HDR_SIZE || !sector_valid(buffer)) {
+			return -1;
+		}
+
 		/* Looks good, copy it to the caller's buffer */
 		memcpy(buf, buffer + DM_SECTOR_HDR_SIZE, buffer[0]);
 	}
@@ -421,6 +925,66 @@ _read(dm_item_t item, unsigned char index, void *buf, size_t count)
 	return buffer[0];
 }
 
+/* Retrieve consecutive items from the data manager file with a single seek */
+static ssize_t
+_read_many(dm_item_t item, unsigned char index, unsigned count, void *buf, size_t buflen)
+{
+	int offset;
+	unsigned done = 0;
+
+	/* Get the offset for the first item */
+	offset = calculate_offset(item, index);
+
+	/* If item type or index out of range, return error */
+	if (offset < 0 || index + count > g_per_item_max_index[item]) {
+		return -1;
+	}
+
+	/* Make sure the caller hasn't asked for more data than we can handle */
+	if (buflen > DM_MAX_DATA_SIZE) {
+		return -1;
+	}
+
+	/* Read the latest versions from the store */
+	cache_flush();
+
+	while (done < count) {
+		unsigned chunk = count - done;
+
+		if (chunk > DM_READ_CHUNK_ITEMS) {
+			chunk = DM_READ_CHUNK_ITEMS;
+		}
+
+		int len = g_backend->read(offset, g_read_chunk, chunk * k_sector_size);
+
+		if (len < 0) {
+			return -1;
+		}
+
+		offset += chunk * k_sector_size;
+
+		for (unsigned i = 0; i < chunk; i++) {
+			const unsigned char *sector = g_read_chunk + i * k_sector_size;
+
+			/* A short read ends at the end of the file, the last item may not fill its sector */
+			if ((unsigned)len < i * k_sector_size + DM_SECTOR_HDR_SIZE + buflen) {
+				return done;
+			}
+
+			/* Stop at the first item which is empty, has the wrong size or is damaged */
+			if (sector[0] != buflen || !sector_valid(sector)) {
+				return done;
+			}
+
+			memcpy((unsigned char *)buf + done * buflen, sector + DM_SECTOR_HDR_SIZE, buflen);
+			done++;
+		}
+	}
+
+	/* Return the number of items read */
+	return done;
+}
+
 static int
 _clear(dm_item_t item)
 {
@@ -434,30 +998,23 @@ _clear(dm_item_t item)
 		return -1;
 	}
 
+	/* The cached items of this type are cleared as well, clearing is ordered after the writes before it */
+	cache_invalidate(offset, offset + g_per_item_max_index[item] * k_sector_size);
+
 	/* Clear all items of this type */
 	for (i = 0; (unsigned)i < g_per_item_max_index[item]; i++) {
 		char buf[1];
 
-		if (lseek(g_task_fd, offset, SEEK_SET) != offset) {
-			result = -1;
-			break;
-		}
-
 		/* Avoid SD flash wear by only doing writes where necessary */
-		if (read(g_task_fd, buf, 1) < 1) {
+		if (g_backend->read(offset, buf, 1) < 1) {
 			break;
 		}
 
 		/* If item has length greater than 0 it needs to be overwritten */
 		if (buf[0]) {
-			if (lseek(g_task_fd, offset, SEEK_SET) != offset) {
-				result = -1;
-				break;
-			}
-
 			buf[0] = 0;
 
-			if (write(g_task_fd, buf, 1) != 1) {
+			if (g_backend->write(offset, buf, 1) != 1) {
 				result = -1;
 				break;
 			}
@@ -467,7 +1024,7 @@ _clear(dm_item_t item)
 	}
 
 	/* Make sure data is actually written to physical media */
-	fsync(g_task_fd);
+	g_backend->sync();
 	return result;
 }
 
@@ -475,8 +1032,13 @@ _clear(dm_item_t item)
 static int
 _restart(dm_reset_reason reason)
 {
-	unsigned char buffer[2];
+	unsigned char buffer[k_sector_size];
 	int offset = 0, result = 0;
+	unsigned damaged = 0;
+
+	/* Scan the store, not the cache, and start over with an empty cache */
+	cache_flush();
+	cache_invalidate(0, INT_MAX);
 
 	/* We need to scan the entire file and invalidate and data that should not persist after the last reset */
 
@@ -484,15 +1046,10 @@ _restart(dm_reset_reason reason)
 	while (1) {
 		size_t len;
 
-		/* Get data segment at current offset */
-		if (lseek(g_task_fd, offset, SEEK_SET) != offset) {
-			/* must be at eof */
-			break;
-		}
-
-		len = read(g_task_fd, buffer, sizeof(buffer));
+		/* Get data segment header at current offset */
+		len = g_backend->read(offset, buffer, DM_SECTOR_HDR_SIZE);
 
-		if (len != sizeof(buffer)) {
+		if (len != DM_SECTOR_HDR_SIZE) {
 			/* must be at eof */
 			break;
 		}
@@ -501,8 +1058,14 @@ _restart(dm_reset_reason reason)
 		if (buffer[0]) {
 			int clear_entry = 0;
 
-			/* Whether data gets deleted depends on reset type and data segment's persistence setting */
-			if (reason == DM_INIT_REASON_POWER_ON) {
+			/* Damaged data, e.g. a write interrupted by a power loss, is deleted */
+			len = g_backend->read(offset + DM_SECTOR_HDR_SIZE, buffer + DM_SECTOR_HDR_SIZE, buffer[0]);
+
+			if (len != buffer[0] || !sector_valid(buffer)) {
+				clear_entry = 1;
+				damaged++;
+
+			} else if (reason == DM_INIT_REASON_POWER_ON) {
 				if (buffer[1] > DM_PERSIST_POWER_ON_RESET) {
 					clear_entry = 1;
 				}
@@ -515,14 +1078,9 @@ _restart(dm_reset_reason reason)
 
 			/* Set segment to unused if data does not persist */
 			if (clear_entry) {
-				if (lseek(g_task_fd, offset, SEEK_SET) != offset) {
-					result = -1;
-					break;
-				}
-
 				buffer[0] = 0;
 
-				len = write(g_task_fd, buffer, 1);
+				len = g_backend->write(offset, buffer, 1);
 
 				if (len != 1) {
 					result = -1;
@@ -534,12 +1092,77 @@ _restart(dm_reset_reason reason)
 		offset += k_sector_size;
 	}
 
-	fsync(g_task_fd);
+	g_backend->sync();
+
+	if (damaged > 0) {
+		warnx("Cleared %u damaged items", damaged);
+	}
 
 	/* tell the caller how it went */
 	return result;
 }
 
+/* Process a work item, in the worker thread or for direct backends in the caller context */
+static void
+handle_work_item(work_q_item_t *work)
+{
+	/* handle each work item with the appropriate handler */
+	switch (work->func) {
+	case dm_write_func:
+		g_func_counts[dm_write_func]++;
+		work->result =
+			_write(work->write_params.item, work->write_params.index, work->write_params.persistence, work->write_params.buf,
+			       work->write_params.count);
+		break;
+
+	case dm_read_func:
+		g_func_counts[dm_read_func]++;
+		work->result =
+			_read(work->read_params.item, work->read_params.index, work->read_params.buf, work->read_params.count);
+		break;
+
+	case dm_clear_func:
+		g_func_counts[dm_clear_func]++;
+		work->result = _clear(work->clear_params.item);
+		break;
+
+	case dm_restart_func:
+		g_func_counts[dm_restart_func]++;
+		work->result = _restart(work->restart_params.reason);
+		break;
+
+	case dm_read_many_func: {
+			dm_request_t *request = work->read_many_params.request;
+
+			g_func_counts[dm_read_many_func]++;
+			request->result = _read_many(request->item, request->index, request->count, request->buffer,
+						     request->buflen);
+
+			/* Nobody waits on the work item of an asynchronous request */
+			destroy_work_item(work);
+			work = NULL;
+
+			request->done = true;
+
+			if (request->callback) {
+				request->callback(request);
+			}
+
+			sem_post(&request->done_sem);
+			break;
+		}
+
+	default: /* should never happen */
+		work->result = -1;
+		break;
+	}
+
+	/* Inform the caller that work is done */
+	if (work) {
+		sem_post(&work->wait_sem);
+	}
+}
+
 /** Write to the data manager file */
 __EXPORT ssize_t
 dm_write(dm_item_t item, unsigned char index, dm_persitence_t persistence, const void *buf, size_t count)
@@ -547,10 +1170,19 @@ dm_write(dm_item_t item, unsigned char index, dm_persitence_t persistence, const
 	work_q_item_t *work;
 
 	/* Make sure data manager has been started and is not shutting down */
-	if ((g_fd < 0) || g_task_should_exit) {
+	if (!g_accepting || g_task_should_exit) {
 		return -1;
 	}
 
+	/* Don't wait for the store unless the cache is full */
+	if (g_cache != NULL) {
+		ssize_t result = cache_write(item, index, persistence, buf, count);
+
+		if (result != -2) {
+			return result;
+		}
+	}
+
 	/* get a work item and queue up a write request */
 	if ((work = create_work_item()) == NULL) {
 		return -1;
@@ -574,7 +1206,7 @@ dm_read(dm_item_t item, unsigned char index, void *buf, size_t count)
 	work_q_item_t *work;
 
 	/* Make sure data manager has been started and is not shutting down */
-	if ((g_fd < 0) || g_task_should_exit) {
+	if (!g_accepting || g_task_should_exit) {
 		return -1;
 	}
 
@@ -593,13 +1225,74 @@ dm_read(dm_item_t item, unsigned char index, void *buf, size_t count)
 	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
 }
 
+/** Retrieve consecutive items from the data manager file */
+__EXPORT ssize_t
+dm_read_many(dm_item_t item, unsigned char index, unsigned count, void *buf, size_t buflen)
+{
+	dm_request_t request;
+
+	request.item = item;
+	request.index = index;
+	request.count = count;
+	request.buffer = buf;
+	request.buflen = buflen;
+	request.callback = NULL;
+	request.arg = NULL;
+
+	if (dm_read_async(&request) != 0) {
+		return -1;
+	}
+
+	return dm_wait(&request);
+}
+
+/** Queue a read of consecutive items without waiting for it */
+__EXPORT int
+dm_read_async(dm_request_t *request)
+{
+	work_q_item_t *work;
+
+	request->done = false;
+	request->result = -1;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!g_accepting || g_task_should_exit) {
+		return -1;
+	}
+
+	/* get a work item and queue up a read request */
+	if ((work = create_work_item()) == NULL) {
+		return -1;
+	}
+
+	sem_init(&request->done_sem, 1, 0);
+
+	work->func = dm_read_many_func;
+	work->read_many_params.request = request;
+
+	/* The worker thread completes the request and releases the work item */
+	enqueue_work_item(work);
+
+	return 0;
+}
+
+/** Wait for an asynchronous request to complete */
+__EXPORT ssize_t
+dm_wait(dm_request_t *request)
+{
+	sem_wait(&request->done_sem);
+	sem_destroy(&request->done_sem);
+
+	return request->result;
+}
+
 __EXPORT int
 dm_clear(dm_item_t item)
 {
 	work_q_item_t *work;
 
 	/* Make sure data manager has been started and is not shutting down */
-	if ((g_fd < 0) || g_task_should_exit) {
+	if (!g_accepting || g_task_should_exit) {
 		return -1;
 	}
 
@@ -619,7 +1312,7 @@ __EXPORT void
 dm_lock(dm_item_t item)
 {
 	/* Make sure data manager has been started and is not shutting down */
-	if ((g_fd < 0) || g_task_should_exit) {
+	if (!g_accepting || g_task_should_exit) {
 		return;
 	}
 
@@ -636,7 +1329,7 @@ __EXPORT void
 dm_unlock(dm_item_t item)
 {
 	/* Make sure data manager has been started and is not shutting down */
-	if ((g_fd < 0) || g_task_should_exit) {
+	if (!g_accepting || g_task_should_exit) {
 		return;
 	}
 
@@ -656,7 +1349,7 @@ dm_restart(dm_reset_reason reason)
 	work_q_item_t *work;
 
 	/* Make sure data manager has been started and is not shutting down */
-	if ((g_fd < 0) || g_task_should_exit) {
+	if (!g_accepting || g_task_should_exit) {
 		return -1;
 	}
 
@@ -706,41 +1399,28 @@ task_main(int argc, char *argv[])
 
 	sem_init(&g_work_queued_sema, 1, 0);
 
-	/* See if the data manage file exists and is a multiple of the sector size */
-	g_task_fd = open(k_data_manager_device_path, O_RDONLY | O_BINARY);
+	sem_init(&g_direct_mutex, 1, 1);
 
-	if (g_task_fd >= 0) {
-		/* File exists, check its size */
-		int file_size = lseek(g_task_fd, 0, SEEK_END);
-
-		if ((file_size % k_sector_size) != 0) {
-			warnx("Incompatible data manager file %s, resetting it", k_data_manager_device_path);
-			warnx("Size: %u, sector size: %d", file_size, k_sector_size);
-			close(g_task_fd);
-			unlink(k_data_manager_device_path);
-
-		} else {
-			close(g_task_fd);
-		}
-	}
-
-	/* Open or create the data manager file */
-	g_task_fd = open(k_data_manager_device_path, O_RDWR | O_CREAT | O_BINARY, PX4_O_MODE_666);
-
-	if (g_task_fd < 0) {
-		warnx("Could not open data manager file %s", k_data_manager_device_path);
+	if (g_backend->open(max_offset) != 0) {
 		sem_post(&g_init_sema); /* Don't want to hang startup */
 		return -1;
 	}
 
-	if ((unsigned)lseek(g_task_fd, max_offset, SEEK_SET) != max_offset) {
-		close(g_task_fd);
-		warnx("Could not seek data manager file %s", k_data_manager_device_path);
-		sem_post(&g_init_sema); /* Don't want to hang startup */
-		return -1;
-	}
+	/* Memory backends are fast enough without a cache */
+	if (!g_backend->direct) {
+		sem_init(&g_cache_mutex, 1, 1);
+		g_cache = (dm_cache_entry_t *)malloc(DM_CACHE_ITEMS * sizeof(dm_cache_entry_t));
 
-	fsync(g_task_fd);
+		if (g_cache != NULL) {
+			for (unsigned i = 0; i < DM_CACHE_ITEMS; i++) {
+				g_cache[i].offset = -1;
+				g_cache[i].seq = 0;
+			}
+
+		} else {
+			warnx("no memory for the write cache");
+		}
+	}
 
 	printf("dataman: ");
 	/* see if we need to erase any items based on restart type */
@@ -763,12 +1443,16 @@ task_main(int argc, char *argv[])
 		printf("Unknown restart");
 	}
 
-	/* We use two file descriptors, one for the caller context and one for the worker thread */
-	/* They are actually the same but we need to some way to reject caller request while the */
-	/* worker thread is shutting down but still processing requests */
-	g_fd = g_task_fd;
+	/* Callers are rejected separately from the worker thread's access to the store, */
+	/* so that the worker thread can still process queued requests while shutting down */
+	g_accepting = true;
 
-	printf(", data manager file '%s' size is %d bytes\n", k_data_manager_device_path, max_offset);
+	if (g_backend == &g_ram_backend) {
+		printf(", data manager RAM size is %d bytes\n", max_offset);
+
+	} else {
+		printf(", data manager %s '%s' size is %d bytes\n", g_backend->name, k_data_manager_device_path, max_offset);
+	}
 
 	/* Tell startup that the worker thread has completed its initialization */
 	sem_post(&g_init_sema);
@@ -777,9 +1461,11 @@ task_main(int argc, char *argv[])
 	while (true) {
 
 		/* do we need to exit ??? */
-		if ((g_task_should_exit) && (g_fd >= 0)) {
-			/* Close the file handle to stop further queuing */
-			g_fd = -1;
+		if ((g_task_should_exit) && g_accepting) {
+			/* Stop further queuing, wait for callers served by a direct backend */
+			sem_wait(&g_direct_mutex);
+			g_accepting = false;
+			sem_post(&g_direct_mutex);
 		}
 
 		if (!g_task_should_exit) {
@@ -790,48 +1476,28 @@ task_main(int argc, char *argv[])
 		/* Empty the work queue */
 		while ((work = dequeue_work_item())) {
 
-			/* handle each work item with the appropriate handler */
-			switch (work->func) {
-			case dm_write_func:
-				g_func_counts[dm_write_func]++;
-				work->result =
-					_write(work->write_params.item, work->write_params.index, work->write_params.persistence, work->write_params.buf,
-					       work->write_params.count);
-				break;
-
-			case dm_read_func:
-				g_func_counts[dm_read_func]++;
-				work->result =
-					_read(work->read_params.item, work->read_params.index, work->read_params.buf, work->read_params.count);
-				break;
-
-			case dm_clear_func:
-				g_func_counts[dm_clear_func]++;
-				work->result = _clear(work->clear_params.item);
-				break;
-
-			case dm_restart_func:
-				g_func_counts[dm_restart_func]++;
-				work->result = _restart(work->restart_params.reason);
-				break;
-
-			default: /* should never happen */
-				work->result = -1;
-				break;
-			}
-
-			/* Inform the caller that work is done */
-			sem_post(&work->wait_sem);
+			handle_work_item(work);
 		}
 
+		/* Then write the items cached meanwhile */
+		cache_flush();
+
 		/* time to go???? */
-		if ((g_task_should_exit) && (g_fd < 0)) {
+		if ((g_task_should_exit) && !g_accepting) {
 			break;
 		}
 	}
 
-	close(g_task_fd);
-	g_task_fd = -1;
+	/* The callers are gone, write what they left in the cache */
+	cache_flush();
+
+	if (g_cache != NULL) {
+		free(g_cache);
+		g_cache = NULL;
+		sem_destroy(&g_cache_mutex);
+	}
+
+	g_backend->close();
 
 	/* The work queue is now empty, empty the free queue */
 	for (;;) {
@@ -848,6 +1514,7 @@ task_main(int argc, char *argv[])
 	destroy_q(&g_free_q);
 	sem_destroy(&g_work_queued_sema);
 	sem_destroy(&g_sys_state_mutex);
+	sem_destroy(&g_direct_mutex);
 
 	return 0;
 }
@@ -878,9 +1545,17 @@ status(void)
 	/* display usage statistics */
 	warnx("Writes   %d", g_func_counts[dm_write_func]);
 	warnx("Reads    %d", g_func_counts[dm_read_func]);
+	warnx("Batches  %d", g_func_counts[dm_read_many_func]);
 	warnx("Clears   %d", g_func_counts[dm_clear_func]);
 	warnx("Restarts %d", g_func_counts[dm_restart_func]);
 	warnx("Max Q lengths work %d, free %d", g_work_q.max_size, g_free_q.max_size);
+	warnx("Backend  %s", g_backend->name);
+
+	if (g_cache != NULL) {
+		warnx("Cache    hits %u, full %u, write errors %u", g_cache_hits, g_cache_full, g_cache_errors);
+	}
+
+	warnx("Checksum errors %u", g_crc_errors);
 }
 
 static void
@@ -894,7 +1569,13 @@ stop(void)
 static void
 usage(void)
 {
-	warnx("usage: dataman {start [-f datafile]|stop|status|poweronrestart|inflightrestart}");
+#ifdef __PX4_POSIX
+	warnx("usage: dataman {start [-f datafile] [-r|-m]|stop|status|poweronrestart|inflightrestart}");
+	warnx("  -r  keep the data in RAM only, -m  memory map the data file");
+#else
+	warnx("usage: dataman {start [-f datafile] [-r]|stop|status|poweronrestart|inflightrestart}");
+	warnx("  -r  keep the data in RAM only");
+#endif
 }
 
 int
@@ -907,22 +1588,38 @@ dataman_main(int argc, char *argv[])
 
 	if (!strcmp(argv[1], "start")) {
 
-		if (g_fd >= 0) {
+		if (g_accepting) {
 			warnx("dataman already running");
 			return -1;
 		}
 
-		if (argc == 4 && strcmp(argv[2], "-f") == 0) {
-			k_data_manager_device_path = strdup(argv[3]);
-			warnx("dataman file set to: %s\n", k_data_manager_device_path);
+		const char *path = default_device_path;
+		g_backend = &g_file_backend;
 
-		} else {
-			k_data_manager_device_path = strdup(default_device_path);
+		for (int i = 2; i < argc; i++) {
+			if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+				path = argv[++i];
+				warnx("dataman file set to: %s\n", path);
+
+			} else if (strcmp(argv[i], "-r") == 0) {
+				g_backend = &g_ram_backend;
+#ifdef __PX4_POSIX
+
+			} else if (strcmp(argv[i], "-m") == 0) {
+				g_backend = &g_mmap_backend;
+#endif
+
+			} else {
+				usage();
+				return -1;
+			}
 		}
 
+		k_data_manager_device_path = strdup(path);
+
 		start();
 
-		if (g_fd < 0) {
+		if (!g_accepting) {
 			warnx("dataman start failed");
 			free(k_data_manager_device_path);
 			k_data_manager_device_path = NULL;
@@ -933,7 +1630,7 @@ dataman_main(int argc, char *argv[])
 	}
 
 	/* Worker thread should be running for all other commands */
-	if (g_fd < 0) {
+	if (!g_accepting) {
 		warnx("dataman worker thread not running");
 		usage();
 		return -1;
@@ -39,6 +39,8 @@
 #ifndef _DATAMANAGER_H
 #define _DATAMANAGER_H
 
+#include <semaphore.h>
+#include <stdbool.h>
 #include <navigator/navigation.h>
 #include <uORB/topics/mission.h>
 #include <uORB/topics/fence.h>
@@ -110,6 +112,57 @@ dm_write(
 	size_t buflen			/* Length in bytes of data to retrieve */
 );
 
+/** Retrieve consecutive items from the data manager store in one access */
+__EXPORT ssize_t
+dm_read_many(
+	dm_item_t item,			/* The item type to retrieve */
+	unsigned char index,		/* The index of the first item */
+	unsigned count,			/* The number of items to retrieve */
+	void *buffer,			/* Pointer to caller data buffer, count items of buflen bytes */
+	size_t buflen			/* Length in bytes of each item */
+);
+
+struct dm_request_s;
+
+/** Completion callback of an asynchronous request, runs in the data manager task or, for the
+ * RAM and memory mapped stores, in the caller context before dm_read_async() returns */
+typedef void (*dm_callback_t)(struct dm_request_s *request);
+
+/** Asynchronous read of consecutive items, see dm_read_async() */
+typedef struct dm_request_s {
+	/* Filled in by the caller */
+	dm_item_t item;			/* The item type to retrieve */
+	unsigned char index;		/* The index of the first item */
+	unsigned count;			/* The number of items to retrieve */
+	void *buffer;			/* Pointer to caller data buffer, count items of buflen bytes */
+	size_t buflen;			/* Length in bytes of each item */
+	dm_callback_t callback;		/* Called on completion, may be NULL */
+	void *arg;			/* For use by the callback */
+
+	/* Filled in by the data manager */
+	volatile bool done;		/* The request has completed */
+	ssize_t result;			/* Number of leading items read with buflen bytes, -1 on error */
+	sem_t done_sem;
+} dm_request_t;
+
+/**
+ * Queue a read of consecutive items and return without waiting.
+ *
+ * The items are read with a single seek, a request stays owned by the caller
+ * until dm_wait() returned. Every successfully queued request must be passed
+ * to dm_wait() once, also when it completes through the callback.
+ */
+__EXPORT int
+dm_read_async(
+	dm_request_t *request		/* The request to queue */
+);
+
+/** Wait for an asynchronous request to complete and return its result */
+__EXPORT ssize_t
+dm_wait(
+	dm_request_t *request		/* A request queued with dm_read_async() */
+);
+
 /** Lock all items of this type */
 __EXPORT void
 dm_lock(
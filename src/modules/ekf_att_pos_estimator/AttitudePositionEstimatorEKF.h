@@ -78,6 +78,9 @@
 //Forward declaration
 class AttPosEKF;
 
+/** maximum number of filter instances, one per IMU of sensor_combined */
+static constexpr unsigned EKF_MAX_INSTANCES = 3;
+
 class AttitudePositionEstimatorEKF : public control::SuperBlock
 {
 public:
@@ -172,7 +175,6 @@ private:
     struct vehicle_land_detected_s      _landDetector;
     struct actuator_armed_s             _armed;
 
-    hrt_abstime _last_accel;
     hrt_abstime _last_mag;
 
     struct sensor_combined_s            _sensor_combined;
@@ -193,10 +195,11 @@ private:
     perf_counter_t  _perf_baro;         ///<local performance counter for baro updates
     perf_counter_t  _perf_airspeed;     ///<local performance counter for airspeed updates
     perf_counter_t  _perf_reset;        ///<local performance counter for filter resets
+    perf_counter_t  _perf_fusion;       ///<fusion step of all instances in one IMU cycle, its max bounds the attitude latency
+    perf_counter_t  _perf_deferred;     ///<local performance counter for fusions put off to a later IMU cycle
 
     float           _gps_alt_filt;
     float           _baro_alt_filt;
-    float           _covariancePredictionDt;  ///< time lapsed since last covariance prediction
     bool            _gpsIsGood;               ///< True if the current GPS fix is good enough for us to use
     uint64_t        _previousGPSTimestamp;    ///< Timestamp of last good GPS fix we have received
     bool            _baro_init;
@@ -269,7 +272,51 @@ private:
         param_t pos_stddev_threshold;
     }       _parameter_handles;     /**< handles for interesting parameters */
 
-    AttPosEKF                   *_ekf;
+    AttPosEKF                   *_ekf;      ///< filter of the instance being run, the selected one outside of the shadow steps
+
+    /**
+     * Measurement fusions the scheduler may move to a later IMU cycle
+     */
+    enum FusionStep {
+        FUSION_VELPOS = 0,              ///< GPS velocity and position, or the zero ones of the static mode
+        FUSION_HGT,                     ///< baro height
+        FUSION_MAG,                     ///< the three mag axes
+        FUSION_TAS,                     ///< true airspeed
+        FUSION_COUNT
+    };
+
+    /**
+     * Fusions waiting for an IMU cycle with time left. A measurement is
+     * fused against the states stored at the time it came in, however late.
+     */
+    struct FusionSchedule {
+        uint8_t pending;                ///< bitmask of the waiting fusions
+        uint8_t deferred[FUSION_COUNT]; ///< IMU cycles each waiting fusion was put off
+        uint32_t measured_ms[FUSION_COUNT]; ///< filter time of the waiting measurements
+    };
+
+    /**
+     * One filter of the pool. All instances fuse the same aiding data, which is
+     * only copied, each one integrates its own IMU.
+     */
+    struct EkfInstance {
+        AttPosEKF *ekf;
+        hrt_abstime last_accel;         ///< timestamp of the last accel sample integrated
+        float cov_prediction_dt;        ///< time lapsed since last covariance prediction
+        float test_ratio;               ///< filtered normalised innovation squared, 1 when consistent
+        bool running;                   ///< follows the selected instance, else cloned before the next step
+        perf_counter_t perf;            ///< CPU time of one filter step
+        uint64_t elapsed;               ///< total CPU time of the filter steps (us)
+        FusionSchedule schedule;        ///< fusions put off to the next IMU cycles
+    };
+
+    EkfInstance     _instances[EKF_MAX_INSTANCES];
+    unsigned        _ekf_count;         ///< number of instances in the pool
+    unsigned        _ekf_current;       ///< instance _ekf points to
+    unsigned        _ekf_selected;      ///< instance being published
+    bool            _clone_shadows;     ///< the selected instance was reset, restart the others from it
+    hrt_abstime     _last_switch;       ///< last selection change or clone of the shadows
+    hrt_abstime     _budget_start;      ///< start of the CPU time accounting
 
     /* Low pass filter for attitude rates */
     math::LowPassFilter2p _LP_att_P;
@@ -339,6 +386,10 @@ private:
     * @brief
     *   Runs the sensor fusion step of the filter. The parameters determine which of the sensors
     *   are fused with each other
+    *
+    *   The measurement fusions which do not fit the work budget of the IMU cycle
+    *   left by the covariance prediction are put off to the next cycles, up to
+    *   EKF_FUSION_MAX_DEFER of them, so they do not all run when they coincide.
     **/
     void updateSensorFusion(const bool fuseGPS, const bool fuseMag, const bool fuseRangeSensor, 
             const bool fuseBaro, const bool fuseAirSpeed);
@@ -362,4 +413,28 @@ private:
     *   flags to true (e.g newDataGps)
     **/
     void pollData();
+
+    /**
+     * Integrate one IMU sample into a filter instance
+     *
+     * @param inst      instance to feed
+     * @param gyro      index of the gyro in sensor_combined, negative for none
+     * @param accel     index of the accel in sensor_combined, negative for none
+     */
+    void putIMU(EkfInstance &inst, int gyro, int accel);
+
+    /**
+     * Point _ekf to a filter instance
+     */
+    void setInstance(unsigned index);
+
+    /**
+     * Run the fusion step of all filter instances and select the one to publish
+     *
+     * The instances not selected run on their own IMU and the aiding data
+     * of the selected one, and are restarted from it after its resets. The
+     * selection changes to the instance with the most consistent innovations.
+     */
+    void updateInstances(const bool fuseGPS, const bool fuseMag, const bool fuseRangeSensor,
+            const bool fuseBaro, const bool fuseAirSpeed);
 };
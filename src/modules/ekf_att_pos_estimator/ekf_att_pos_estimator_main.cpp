@@ -42,6 +42,7 @@
 
 #include "AttitudePositionEstimatorEKF.h"
 #include "estimator_22states.h"
+#include "ekf_replay.h"
 
 #include <px4_config.h>
 #include <px4_defines.h>
@@ -58,6 +59,7 @@
 #include <poll.h>
 #include <time.h>
 #include <float.h>
+#include <new>
 
 #include <arch/board/board.h>
 #include <systemlib/param/param.h>
@@ -79,6 +81,32 @@ static constexpr unsigned GYRO_SWITCH_HYSTERESIS = 5;	///< Ignore the first few
 static constexpr unsigned ACCEL_SWITCH_HYSTERESIS = 5;	///< Ignore the first few accel failures (which amounts to a few milliseconds)
 static constexpr float EPH_LARGE_VALUE = 1000.0f;
 static constexpr float EPV_LARGE_VALUE = 1000.0f;
+static constexpr uint64_t EKF_IMU_TIMEOUT = 20 * 1000;	///< IMU silence before its filter instance stops (us)
+static constexpr float EKF_TEST_RATIO_ALPHA = 0.005f;	///< innovation test ratio filter weight, about 1 s at 250 Hz
+static constexpr float EKF_SWITCH_RATIO = 0.5f;	///< an instance must be this much more consistent to be selected
+static constexpr uint64_t EKF_SWITCH_HOLDOFF = 5 * 1000 * 1000;	///< minimum time between selection changes (us)
+
+/*
+ * Work of the filter steps in units of about 0.5 us of host time (the ekf_*
+ * benchmarks of unittests/bench.cpp), only their ratio matters. A cycle with
+ * all of them due costs 19, the budget spreads the rest of the fusions over
+ * the next cycles.
+ */
+static constexpr unsigned EKF_COV_PREDICTION_COST = 2;
+static constexpr unsigned ekf_fusion_cost[] = {
+	5,	// FUSION_VELPOS
+	1,	// FUSION_HGT
+	10,	// FUSION_MAG
+	1	// FUSION_TAS
+};
+static constexpr unsigned EKF_CYCLE_COST = 16;	///< work budget of one IMU cycle, fits the GPS, height and mag fusions
+static constexpr unsigned EKF_FUSION_MAX_DEFER = 2;	///< IMU cycles a fusion may be put off, about 8 ms at 250 Hz
+
+static const char *const ekf_instance_perf[EKF_MAX_INSTANCES] = {
+	"ekf_att_pos_inst0",
+	"ekf_att_pos_inst1",
+	"ekf_att_pos_inst2"
+};
 
 /**
  * estimator app start / stop handling function
@@ -106,6 +134,11 @@ uint64_t getMicros()
 	return IMUusec;
 }
 
+void setMicros(uint64_t usec)
+{
+	IMUusec = usec;
+}
+
 namespace estimator
 {
 
@@ -116,6 +149,11 @@ namespace estimator
 static const int ERROR = -1;
 
 AttitudePositionEstimatorEKF	*g_estimator = nullptr;
+
+#ifdef PX4_HAVE_CCM
+/* the filter state is only touched by the CPU, keep it in the core coupled memory */
+static uint8_t ekf_storage[sizeof(AttPosEKF)] __CCM __attribute__((aligned(8)));
+#endif
 }
 
 AttitudePositionEstimatorEKF::AttitudePositionEstimatorEKF() :
@@ -160,7 +198,6 @@ AttitudePositionEstimatorEKF::AttitudePositionEstimatorEKF() :
 	_landDetector{},
 	_armed{},
 
-	_last_accel(0),
 	_last_mag(0),
 
 	_sensor_combined{},
@@ -178,11 +215,12 @@ AttitudePositionEstimatorEKF::AttitudePositionEstimatorEKF() :
 	_perf_baro(perf_alloc(PC_INTERVAL, "ekf_att_pos_baro_upd")),
 	_perf_airspeed(perf_alloc(PC_INTERVAL, "ekf_att_pos_aspd_upd")),
 	_perf_reset(perf_alloc(PC_COUNT, "ekf_att_pos_reset")),
+	_perf_fusion(perf_alloc(PC_ELAPSED, "ekf_att_pos_fusion")),
+	_perf_deferred(perf_alloc(PC_COUNT, "ekf_att_pos_deferred")),
 
 	      /* states */
 	_gps_alt_filt(0.0f),
 	_baro_alt_filt(0.0f),
-	_covariancePredictionDt(0.0f),
 	_gpsIsGood(false),
 	_previousGPSTimestamp(0),
 	_baro_init(false),
@@ -214,6 +252,13 @@ AttitudePositionEstimatorEKF::AttitudePositionEstimatorEKF() :
 	_parameters{},
 	_parameter_handles{},
 	_ekf(nullptr),
+	_instances{},
+	_ekf_count(1),
+	_ekf_current(0),
+	_ekf_selected(0),
+	_clone_shadows(false),
+	_last_switch(0),
+	_budget_start(0),
 
 	_LP_att_P(250.0f, 20.0f),
 	_LP_att_Q(250.0f, 20.0f),
@@ -270,7 +315,19 @@ AttitudePositionEstimatorEKF::~AttitudePositionEstimatorEKF()
 		} while (_estimator_task != -1);
 	}
 
-	delete _ekf;
+#ifdef PX4_HAVE_CCM
+
+	if (_instances[0].ekf != nullptr) {
+		_instances[0].ekf->~AttPosEKF();
+	}
+
+#else
+	delete _instances[0].ekf;
+#endif
+
+	for (unsigned i = 1; i < _ekf_count; i++) {
+		delete _instances[i].ekf;
+	}
 
 	estimator::g_estimator = nullptr;
 }
@@ -306,29 +363,35 @@ int AttitudePositionEstimatorEKF::parameters_update()
 	param_get(_parameter_handles.eas_noise, &(_parameters.eas_noise));
 	param_get(_parameter_handles.pos_stddev_threshold, &(_parameters.pos_stddev_threshold));
 
-	if (_ekf) {
-		// _ekf->yawVarScale = 1.0f;
-		// _ekf->windVelSigma = 0.1f;
-		_ekf->dAngBiasSigma = _parameters.gbias_pnoise;
-		_ekf->dVelBiasSigma = _parameters.abias_pnoise;
-		_ekf->magEarthSigma = _parameters.mage_pnoise;
-		_ekf->magBodySigma  = _parameters.magb_pnoise;
-		// _ekf->gndHgtSigma  = 0.02f;
-		_ekf->vneSigma = _parameters.velne_noise;
-		_ekf->vdSigma = _parameters.veld_noise;
-		_ekf->posNeSigma = _parameters.posne_noise;
-		_ekf->posDSigma = _parameters.posd_noise;
-		_ekf->magMeasurementSigma = _parameters.mag_noise;
-		_ekf->gyroProcessNoise = _parameters.gyro_pnoise;
-		_ekf->accelProcessNoise = _parameters.acc_pnoise;
-		_ekf->airspeedMeasurementSigma = _parameters.eas_noise;
-		_ekf->rngFinderPitch = 0.0f; // XXX base on SENS_BOARD_Y_OFF
+	for (unsigned i = 0; i < _ekf_count; i++) {
+		AttPosEKF *ekf = _instances[i].ekf;
+
+		if (ekf == nullptr) {
+			continue;
+		}
+
+		// ekf->yawVarScale = 1.0f;
+		// ekf->windVelSigma = 0.1f;
+		ekf->dAngBiasSigma = _parameters.gbias_pnoise;
+		ekf->dVelBiasSigma = _parameters.abias_pnoise;
+		ekf->magEarthSigma = _parameters.mage_pnoise;
+		ekf->magBodySigma  = _parameters.magb_pnoise;
+		// ekf->gndHgtSigma  = 0.02f;
+		ekf->vneSigma = _parameters.velne_noise;
+		ekf->vdSigma = _parameters.veld_noise;
+		ekf->posNeSigma = _parameters.posne_noise;
+		ekf->posDSigma = _parameters.posd_noise;
+		ekf->magMeasurementSigma = _parameters.mag_noise;
+		ekf->gyroProcessNoise = _parameters.gyro_pnoise;
+		ekf->accelProcessNoise = _parameters.acc_pnoise;
+		ekf->airspeedMeasurementSigma = _parameters.eas_noise;
+		ekf->rngFinderPitch = 0.0f; // XXX base on SENS_BOARD_Y_OFF
 		#if 0
 		// Initially disable loading until
 		// convergence is flight-test proven
-		_ekf->magBias.x = _mag_offset_x.get();
-		_ekf->magBias.y = _mag_offset_y.get();
-		_ekf->magBias.z = _mag_offset_z.get();
+		ekf->magBias.x = _mag_offset_x.get();
+		ekf->magBias.y = _mag_offset_y.get();
+		ekf->magBias.z = _mag_offset_z.get();
 		#endif
 	}
 
@@ -349,7 +412,9 @@ void AttitudePositionEstimatorEKF::vehicle_status_poll()
 		orb_copy(ORB_ID(vehicle_status), _vstatus_sub, &_vstatus);
 
 		// Tell EKF that the vehicle is a fixed wing or multi-rotor
-		_ekf->setIsFixedWing(!_vstatus.is_rotary_wing);
+		for (unsigned i = 0; i < _ekf_count; i++) {
+			_instances[i].ekf->setIsFixedWing(!_vstatus.is_rotary_wing);
+		}
 
 		// Save params on landed
 		if (!landed && _vstatus.condition_landed) {
@@ -503,13 +568,39 @@ void AttitudePositionEstimatorEKF::task_main()
 {
 	_mavlink_fd = px4_open(MAVLINK_LOG_DEVICE, 0);
 
-	_ekf = new AttPosEKF();
+#ifdef PX4_HAVE_CCM
+	_instances[0].ekf = new (estimator::ekf_storage) AttPosEKF();
+#else
+	_instances[0].ekf = new AttPosEKF();
+#endif
 
-	if (!_ekf) {
+	if (!_instances[0].ekf) {
 		PX4_ERR("OUT OF MEM!");
 		return;
 	}
 
+	int32_t ekf_count = 1;
+	param_get(param_find("PE_EKF_INST"), &ekf_count);
+	_ekf_count = math::constrain(ekf_count, (int32_t)1, (int32_t)EKF_MAX_INSTANCES);
+
+	/* the other instances do not fit the core coupled memory */
+	for (unsigned i = 1; i < _ekf_count; i++) {
+		_instances[i].ekf = new AttPosEKF();
+
+		if (!_instances[i].ekf) {
+			PX4_WARN("no memory for filter instance %u", i);
+			_ekf_count = i;
+			break;
+		}
+	}
+
+	for (unsigned i = 0; i < _ekf_count; i++) {
+		_instances[i].perf = perf_alloc(PC_ELAPSED, ekf_instance_perf[i]);
+	}
+
+	setInstance(0);
+	_budget_start = hrt_absolute_time();
+
 	_filter_start_time = hrt_absolute_time();
 
 	/*
@@ -607,6 +698,7 @@ void AttitudePositionEstimatorEKF::task_main()
 
 				_ekf->ZeroVariables();
 				_ekf->dtIMU = 0.01f;
+				_clone_shadows = true;
 				_filter_start_time = _last_sensor_timestamp;
 
 				/* now skip this loop and get data on the next one, which will also re-init the filter */
@@ -667,6 +759,7 @@ void AttitudePositionEstimatorEKF::task_main()
 					_baro_alt_filt = _baro.altitude;
 
 					_ekf->InitialiseFilter(initVelNED, 0.0, 0.0, 0.0f, 0.0f);
+					_clone_shadows = true;
 
 					_filter_ref_offset = -_baro.altitude;
 
@@ -688,11 +781,14 @@ void AttitudePositionEstimatorEKF::task_main()
 
 					if (check) {
 						// Let the system re-initialize itself
+						_clone_shadows = true;
 						continue;
 					}
 
-					// Run EKF data fusion steps
-					updateSensorFusion(_gpsIsGood, _newDataMag, _newRangeData, _newHgtData, _newAdsData);
+					// Run EKF data fusion steps on all instances
+					perf_begin(_perf_fusion);
+					updateInstances(_gpsIsGood, _newDataMag, _newRangeData, _newHgtData, _newAdsData);
+					perf_end(_perf_fusion);
 
 					// Publish attitude estimations
 					publishAttitude();
@@ -782,6 +878,7 @@ void AttitudePositionEstimatorEKF::initializeGPS()
 	_ekf->InitialiseFilter(initVelNED, math::radians(lat), math::radians(lon) - M_PI, gps_alt, declination);
 
 	initReferencePosition(_gps.timestamp_position, _gpsIsGood, lat, lon, gps_alt, _baro.altitude);
+	_clone_shadows = true;
 
 #if 0
 	PX4_INFO("HOME/REF: LA %8.4f,LO %8.4f,ALT %8.2f V: %8.4f %8.4f %8.4f", lat, lon, (double)gps_alt,
@@ -999,82 +1096,122 @@ void AttitudePositionEstimatorEKF::updateSensorFusion(const bool fuseGPS, const
 	// sum delta angles and time used by covariance prediction
 	_ekf->summedDelAng = _ekf->summedDelAng + _ekf->correctedDelAng;
 	_ekf->summedDelVel = _ekf->summedDelVel + _ekf->dVelIMU;
-	_covariancePredictionDt += _ekf->dtIMU;
+	float &covariancePredictionDt = _instances[_ekf_current].cov_prediction_dt;
+	covariancePredictionDt += _ekf->dtIMU;
+
+	const uint32_t now_ms = getMillis();
+	FusionSchedule &schedule = _instances[_ekf_current].schedule;
+
+	// queue the new measurements, one still waiting is replaced by the newer one
+	const bool fuse[FUSION_COUNT] = {
+		fuseGPS || !_gps_initialized,
+		fuseBaro,
+		fuseMag,
+		fuseAirSpeed && _airspeed.true_airspeed_m_s > 5.0f
+	};
+
+	for (unsigned i = 0; i < FUSION_COUNT; i++) {
+		if (fuse[i]) {
+			if (!(schedule.pending & (1 << i))) {
+				schedule.deferred[i] = 0;
+			}
+
+			schedule.pending |= (1 << i);
+			schedule.measured_ms[i] = now_ms;
+		}
+	}
+
+	unsigned budget = EKF_CYCLE_COST;
 
 	// perform a covariance prediction if the total delta angle has exceeded the limit
 	// or the time limit will be exceeded at the next IMU update
-	if ((_covariancePredictionDt >= (_ekf->covTimeStepMax - _ekf->dtIMU))
+	if ((covariancePredictionDt >= (_ekf->covTimeStepMax - _ekf->dtIMU))
 	    || (_ekf->summedDelAng.length() > _ekf->covDelAngMax)) {
-		_ekf->CovariancePrediction(_covariancePredictionDt);
+		_ekf->CovariancePrediction(covariancePredictionDt);
 		_ekf->summedDelAng.zero();
 		_ekf->summedDelVel.zero();
-		_covariancePredictionDt = 0.0f;
+		covariancePredictionDt = 0.0f;
+		budget -= EKF_COV_PREDICTION_COST;
 	}
 
-	// Fuse GPS Measurements
-	if (fuseGPS && _gps_initialized) {
-		// Convert GPS measurements to Pos NE, hgt and Vel NED
+	// pick the fusions of this cycle in the order they are run, the ones put
+	// off for too long run whatever the budget left
+	uint8_t run = 0;
 
-		// set fusion flags
-		_ekf->fuseVelData = _gps.vel_ned_valid;
-		_ekf->fusePosData = true;
+	for (unsigned i = 0; i < FUSION_COUNT; i++) {
+		if (!(schedule.pending & (1 << i))) {
+			continue;
+		}
 
-		// recall states stored at time of measurement after adjusting for delays
-		_ekf->RecallStates(_ekf->statesAtVelTime, (getMillis() - _parameters.vel_delay_ms));
-		_ekf->RecallStates(_ekf->statesAtPosTime, (getMillis() - _parameters.pos_delay_ms));
+		if (ekf_fusion_cost[i] <= budget || schedule.deferred[i] >= EKF_FUSION_MAX_DEFER) {
+			run |= (1 << i);
+			budget -= math::min(ekf_fusion_cost[i], budget);
 
-		// run the fusion step
-		_ekf->FuseVelposNED();
+		} else {
+			schedule.deferred[i]++;
+			perf_count(_perf_deferred);
+		}
+	}
 
-	} else if (!_gps_initialized) {
+	schedule.pending &= ~run;
 
+	if (!_gps_initialized) {
 		// force static mode
 		_ekf->staticMode = true;
+	}
+
+	// Fuse GPS Measurements
+	if (run & (1 << FUSION_VELPOS)) {
+		if (!_gps_initialized) {
+			// Convert GPS measurements to Pos NE, hgt and Vel NED
+			_ekf->velNED[0] = 0.0f;
+			_ekf->velNED[1] = 0.0f;
+			_ekf->velNED[2] = 0.0f;
 
-		// Convert GPS measurements to Pos NE, hgt and Vel NED
-		_ekf->velNED[0] = 0.0f;
-		_ekf->velNED[1] = 0.0f;
-		_ekf->velNED[2] = 0.0f;
+			_ekf->posNE[0] = 0.0f;
+			_ekf->posNE[1] = 0.0f;
 
-		_ekf->posNE[0] = 0.0f;
-		_ekf->posNE[1] = 0.0f;
+			_ekf->fuseVelData = true;
+
+		} else {
+			_ekf->fuseVelData = _gps.vel_ned_valid;
+		}
 
 		// set fusion flags
-		_ekf->fuseVelData = true;
 		_ekf->fusePosData = true;
 
 		// recall states stored at time of measurement after adjusting for delays
-		_ekf->RecallStates(_ekf->statesAtVelTime, (getMillis() - _parameters.vel_delay_ms));
-		_ekf->RecallStates(_ekf->statesAtPosTime, (getMillis() - _parameters.pos_delay_ms));
-
-		// run the fusion step
-		_ekf->FuseVelposNED();
+		const uint32_t measured_ms = schedule.measured_ms[FUSION_VELPOS];
+		_ekf->RecallStates(_ekf->statesAtVelTime, (measured_ms - _parameters.vel_delay_ms));
+		_ekf->RecallStates(_ekf->statesAtPosTime, (measured_ms - _parameters.pos_delay_ms));
 
 	} else {
 		_ekf->fuseVelData = false;
 		_ekf->fusePosData = false;
 	}
 
-	if (fuseBaro) {
+	if (run & (1 << FUSION_HGT)) {
 		// Could use a blend of GPS and baro alt data if desired
 		_ekf->hgtMea = _ekf->baroHgt;
 		_ekf->fuseHgtData = true;
 
 		// recall states stored at time of measurement after adjusting for delays
-		_ekf->RecallStates(_ekf->statesAtHgtTime, (getMillis() - _parameters.height_delay_ms));
-
-		// run the fusion step
-		_ekf->FuseVelposNED();
+		_ekf->RecallStates(_ekf->statesAtHgtTime, (schedule.measured_ms[FUSION_HGT] - _parameters.height_delay_ms));
 
 	} else {
 		_ekf->fuseHgtData = false;
 	}
 
+	// the GPS and the height are fused in one step
+	if (run & ((1 << FUSION_VELPOS) | (1 << FUSION_HGT))) {
+		_ekf->FuseVelposNED();
+	}
+
 	// Fuse Magnetometer Measurements
-	if (fuseMag) {
+	if (run & (1 << FUSION_MAG)) {
 		_ekf->fuseMagData = true;
 		_ekf->RecallStates(_ekf->statesAtMagMeasTime,
-				   (getMillis() - _parameters.mag_delay_ms)); // Assume 50 msec avg delay for magnetometer data
+				   (schedule.measured_ms[FUSION_MAG] - _parameters.mag_delay_ms)); // Assume 50 msec avg delay for magnetometer data
 
 		_ekf->magstate.obsIndex = 0;
 		_ekf->FuseMagnetometer();
@@ -1086,10 +1223,10 @@ void AttitudePositionEstimatorEKF::updateSensorFusion(const bool fuseGPS, const
 	}
 
 	// Fuse Airspeed Measurements
-	if (fuseAirSpeed && _airspeed.true_airspeed_m_s > 5.0f) {
+	if (run & (1 << FUSION_TAS)) {
 		_ekf->fuseVtasData = true;
 		_ekf->RecallStates(_ekf->statesAtVtasMeasTime,
-				   (getMillis() - _parameters.tas_delay_ms)); // assume 100 msec avg delay for airspeed data
+				   (schedule.measured_ms[FUSION_TAS] - _parameters.tas_delay_ms)); // assume 100 msec avg delay for airspeed data
 		_ekf->FuseAirspeed();
 
 	} else {
@@ -1109,6 +1246,178 @@ void AttitudePositionEstimatorEKF::updateSensorFusion(const bool fuseGPS, const
 	}
 }
 
+void AttitudePositionEstimatorEKF::putIMU(EkfInstance &inst, int gyro, int accel)
+{
+	AttPosEKF *ekf = inst.ekf;
+
+	if (gyro >= 0) {
+
+		// Use pre-integrated values if possible
+		if (_sensor_combined.gyro_integral_dt[gyro] > 0) {
+			ekf->dAngIMU.x = _sensor_combined.gyro_integral_rad[gyro * 3 + 0];
+			ekf->dAngIMU.y = _sensor_combined.gyro_integral_rad[gyro * 3 + 1];
+			ekf->dAngIMU.z = _sensor_combined.gyro_integral_rad[gyro * 3 + 2];
+		} else {
+			ekf->dAngIMU.x = 0.5f * (ekf->angRate.x + _sensor_combined.gyro_rad_s[gyro * 3 + 0]);
+			ekf->dAngIMU.y = 0.5f * (ekf->angRate.y + _sensor_combined.gyro_rad_s[gyro * 3 + 1]);
+			ekf->dAngIMU.z = 0.5f * (ekf->angRate.z + _sensor_combined.gyro_rad_s[gyro * 3 + 2]);
+		}
+
+		ekf->angRate.x = _sensor_combined.gyro_rad_s[gyro * 3 + 0];
+		ekf->angRate.y = _sensor_combined.gyro_rad_s[gyro * 3 + 1];
+		ekf->angRate.z = _sensor_combined.gyro_rad_s[gyro * 3 + 2];
+	}
+
+	if (accel >= 0 && (inst.last_accel != _sensor_combined.accelerometer_timestamp[accel])) {
+
+		// Use pre-integrated values if possible
+		if (_sensor_combined.accelerometer_integral_dt[accel] > 0) {
+			ekf->dVelIMU.x = _sensor_combined.accelerometer_integral_m_s[accel * 3 + 0];
+			ekf->dVelIMU.y = _sensor_combined.accelerometer_integral_m_s[accel * 3 + 1];
+			ekf->dVelIMU.z = _sensor_combined.accelerometer_integral_m_s[accel * 3 + 2];
+		} else {
+			ekf->dVelIMU.x = 0.5f * (ekf->accel.x + _sensor_combined.accelerometer_m_s2[accel * 3 + 0]);
+			ekf->dVelIMU.y = 0.5f * (ekf->accel.y + _sensor_combined.accelerometer_m_s2[accel * 3 + 1]);
+			ekf->dVelIMU.z = 0.5f * (ekf->accel.z + _sensor_combined.accelerometer_m_s2[accel * 3 + 2]);
+		}
+
+		ekf->accel.x = _sensor_combined.accelerometer_m_s2[accel * 3 + 0];
+		ekf->accel.y = _sensor_combined.accelerometer_m_s2[accel * 3 + 1];
+		ekf->accel.z = _sensor_combined.accelerometer_m_s2[accel * 3 + 2];
+		inst.last_accel = _sensor_combined.accelerometer_timestamp[accel];
+	}
+}
+
+void AttitudePositionEstimatorEKF::setInstance(unsigned index)
+{
+	_ekf_current = index;
+	_ekf = _instances[index].ekf;
+}
+
+/**
+ * Mean normalised innovation squared of the last velocity, position, height
+ * and mag fusions, about 1 for a filter consistent with its measurements.
+ */
+static float innovation_test_ratio(const AttPosEKF &ekf)
+{
+	float sum = 0.0f;
+	unsigned count = 0;
+
+	for (unsigned i = 0; i < 6; i++) {
+		if (ekf.varInnovVelPos[i] > 0.0f) {
+			sum += ekf.innovVelPos[i] * ekf.innovVelPos[i] / ekf.varInnovVelPos[i];
+			count++;
+		}
+	}
+
+	for (unsigned i = 0; i < 3; i++) {
+		if (ekf.varInnovMag[i] > 0.0f) {
+			sum += ekf.innovMag[i] * ekf.innovMag[i] / ekf.varInnovMag[i];
+			count++;
+		}
+	}
+
+	return (count > 0) ? sum / count : 0.0f;
+}
+
+void AttitudePositionEstimatorEKF::updateInstances(const bool fuseGPS, const bool fuseMag,
+		const bool fuseRangeSensor, const bool fuseBaro, const bool fuseAirSpeed)
+{
+	const unsigned selected = _ekf_selected;
+	const AttPosEKF &ref = *_instances[selected].ekf;
+	const hrt_abstime now = hrt_absolute_time();
+
+	_instances[selected].running = true;
+
+	for (unsigned i = 0; i < _ekf_count; i++) {
+		EkfInstance &inst = _instances[i];
+
+		if (i != selected) {
+			// an instance whose IMU went silent stops until it is back
+			if (now - _sensor_combined.gyro_timestamp[i] > EKF_IMU_TIMEOUT
+			    || now - _sensor_combined.accelerometer_timestamp[i] > EKF_IMU_TIMEOUT) {
+				inst.running = false;
+				continue;
+			}
+
+			if (!inst.running || _clone_shadows) {
+				*inst.ekf = ref;
+				inst.cov_prediction_dt = _instances[selected].cov_prediction_dt;
+				inst.test_ratio = _instances[selected].test_ratio;
+				inst.schedule = _instances[selected].schedule;
+				inst.running = true;
+				_last_switch = now;
+			}
+
+			// the aiding data is shared, only the IMU differs
+			inst.ekf->dtIMU = ref.dtIMU;
+			inst.ekf->magData = ref.magData;
+			inst.ekf->VtasMeas = ref.VtasMeas;
+			memcpy(inst.ekf->velNED, ref.velNED, sizeof(ref.velNED));
+			memcpy(inst.ekf->posNE, ref.posNE, sizeof(ref.posNE));
+			inst.ekf->hgtMea = ref.hgtMea;
+			inst.ekf->baroHgt = ref.baroHgt;
+			inst.ekf->rngMea = ref.rngMea;
+			inst.ekf->gpsLat = ref.gpsLat;
+			inst.ekf->gpsLon = ref.gpsLon;
+			inst.ekf->gpsHgt = ref.gpsHgt;
+			inst.ekf->GPSstatus = ref.GPSstatus;
+			inst.ekf->dtGpsFilt = ref.dtGpsFilt;
+			inst.ekf->dtHgtFilt = ref.dtHgtFilt;
+			inst.ekf->setOnGround(_landDetector.landed);
+
+			putIMU(inst, i, i);
+		}
+
+		setInstance(i);
+
+		hrt_abstime step_start = hrt_absolute_time();
+		perf_begin(inst.perf);
+
+		updateSensorFusion(fuseGPS, fuseMag, fuseRangeSensor, fuseBaro, fuseAirSpeed);
+
+		perf_end(inst.perf);
+		inst.elapsed += hrt_elapsed_time(&step_start);
+
+		if (i != selected) {
+			struct ekf_status_report ekf_report;
+
+			// a diverged instance is restarted from the selected one on the next step
+			if (_ekf->CheckAndBound(&ekf_report)) {
+				inst.running = false;
+			}
+		}
+
+		inst.test_ratio += EKF_TEST_RATIO_ALPHA * (innovation_test_ratio(*_ekf) - inst.test_ratio);
+	}
+
+	_clone_shadows = false;
+
+	if (_ekf_count > 1) {
+		const bool imu_lost = (now - _sensor_combined.gyro_timestamp[selected] > EKF_IMU_TIMEOUT)
+				      || (now - _sensor_combined.accelerometer_timestamp[selected] > EKF_IMU_TIMEOUT);
+		unsigned best = selected;
+
+		for (unsigned i = 0; i < _ekf_count; i++) {
+			if (i != selected && _instances[i].running
+			    && (best == selected || _instances[i].test_ratio < _instances[best].test_ratio)) {
+				best = i;
+			}
+		}
+
+		if (best != selected && (imu_lost || (now - _last_switch > EKF_SWITCH_HOLDOFF
+				&& _instances[best].test_ratio < EKF_SWITCH_RATIO * _instances[selected].test_ratio))) {
+
+			mavlink_and_console_log_info(_mavlink_fd, "[ekf] switched to IMU %u, test ratio %.2f vs %.2f",
+						     best, (double)_instances[best].test_ratio, (double)_instances[selected].test_ratio);
+			_ekf_selected = best;
+			_last_switch = now;
+		}
+	}
+
+	setInstance(_ekf_selected);
+}
+
 int AttitudePositionEstimatorEKF::start()
 {
 	ASSERT(_estimator_task == -1);
@@ -1196,6 +1505,20 @@ void AttitudePositionEstimatorEKF::print_status()
 	       (_ekf->useCompass) ? "USE_COMPASS" : "IGN_COMPASS",
 	       (_ekf->staticMode) ? "STATIC_MODE" : "DYNAMIC_MODE");
 
+	hrt_abstime budget_time = hrt_elapsed_time(&_budget_start);
+
+	perf_print_counter(_perf_fusion);
+	perf_print_counter(_perf_deferred);
+
+	for (unsigned i = 0; i < _ekf_count; i++) {
+		PX4_INFO("instance %u: %s%s test ratio: %6.3f CPU: %5.2f%%", i,
+			 (i == _ekf_selected) ? "SELECTED " : "",
+			 _instances[i].running ? "RUNNING" : "STOPPED",
+			 (double)_instances[i].test_ratio,
+			 (budget_time > 0) ? (double)(100.0f * _instances[i].elapsed / budget_time) : 0.0);
+		perf_print_counter(_instances[i].perf);
+	}
+
 	PX4_INFO("gyro status:");
 	_voter_gyro.print();
 	PX4_INFO("accel status:");
@@ -1217,56 +1540,30 @@ void AttitudePositionEstimatorEKF::pollData()
 	orb_copy(ORB_ID(sensor_combined), _sensor_combined_sub, &_sensor_combined);
 
 	// Feed validator with recent sensor data
+	const unsigned instances = sizeof(_sensor_combined.gyro_timestamp) / sizeof(_sensor_combined.gyro_timestamp[0]);
 
-	for (unsigned i = 0; i < (sizeof(_sensor_combined.gyro_timestamp) / sizeof(_sensor_combined.gyro_timestamp[0])); i++) {
-		_voter_gyro.put(i, _sensor_combined.gyro_timestamp[i], &_sensor_combined.gyro_rad_s[i * 3],
-			_sensor_combined.gyro_errcount[i], _sensor_combined.gyro_priority[i]);
-		_voter_accel.put(i, _sensor_combined.accelerometer_timestamp[i], &_sensor_combined.accelerometer_m_s2[i * 3],
-			_sensor_combined.accelerometer_errcount[i], _sensor_combined.accelerometer_priority[i]);
-		_voter_mag.put(i, _sensor_combined.magnetometer_timestamp[i], &_sensor_combined.magnetometer_ga[i * 3],
-			_sensor_combined.magnetometer_errcount[i], _sensor_combined.magnetometer_priority[i]);
-	}
+	_voter_gyro.put_all(instances, _sensor_combined.gyro_timestamp, _sensor_combined.gyro_rad_s,
+		_sensor_combined.gyro_errcount, _sensor_combined.gyro_priority);
+	_voter_accel.put_all(instances, _sensor_combined.accelerometer_timestamp, _sensor_combined.accelerometer_m_s2,
+		_sensor_combined.accelerometer_errcount, _sensor_combined.accelerometer_priority);
+	_voter_mag.put_all(instances, _sensor_combined.magnetometer_timestamp, _sensor_combined.magnetometer_ga,
+		_sensor_combined.magnetometer_errcount, _sensor_combined.magnetometer_priority);
 
 	// Get best measurement values
 	hrt_abstime curr_time = hrt_absolute_time();
 	(void)_voter_gyro.get_best(curr_time, &_gyro_main);
-	if (_gyro_main >= 0) {
+	(void)_voter_accel.get_best(curr_time, &_accel_main);
 
-		// Use pre-integrated values if possible
-		if (_sensor_combined.gyro_integral_dt[_gyro_main] > 0) {
-			_ekf->dAngIMU.x = _sensor_combined.gyro_integral_rad[_gyro_main * 3 + 0];
-			_ekf->dAngIMU.y = _sensor_combined.gyro_integral_rad[_gyro_main * 3 + 1];
-			_ekf->dAngIMU.z = _sensor_combined.gyro_integral_rad[_gyro_main * 3 + 2];
-		} else {
-			_ekf->dAngIMU.x = 0.5f * (_ekf->angRate.x + _sensor_combined.gyro_rad_s[_gyro_main * 3 + 0]);
-			_ekf->dAngIMU.y = 0.5f * (_ekf->angRate.y + _sensor_combined.gyro_rad_s[_gyro_main * 3 + 1]);
-			_ekf->dAngIMU.z = 0.5f * (_ekf->angRate.z + _sensor_combined.gyro_rad_s[_gyro_main * 3 + 2]);
-		}
+	if (_ekf_count > 1) {
+		// each instance integrates its own IMU, whatever the voter prefers
+		putIMU(_instances[_ekf_selected], _ekf_selected, _ekf_selected);
 
-		_ekf->angRate.x = _sensor_combined.gyro_rad_s[_gyro_main * 3 + 0];
-		_ekf->angRate.y = _sensor_combined.gyro_rad_s[_gyro_main * 3 + 1];
-		_ekf->angRate.z = _sensor_combined.gyro_rad_s[_gyro_main * 3 + 2];
-		perf_count(_perf_gyro);
+	} else {
+		putIMU(_instances[0], _gyro_main, _accel_main);
 	}
 
-	(void)_voter_accel.get_best(curr_time, &_accel_main);
-	if (_accel_main >= 0 && (_last_accel != _sensor_combined.accelerometer_timestamp[_accel_main])) {
-
-		// Use pre-integrated values if possible
-		if (_sensor_combined.accelerometer_integral_dt[_accel_main] > 0) {
-			_ekf->dVelIMU.x = _sensor_combined.accelerometer_integral_m_s[_accel_main * 3 + 0];
-			_ekf->dVelIMU.y = _sensor_combined.accelerometer_integral_m_s[_accel_main * 3 + 1];
-			_ekf->dVelIMU.z = _sensor_combined.accelerometer_integral_m_s[_accel_main * 3 + 2];
-		} else {
-			_ekf->dVelIMU.x = 0.5f * (_ekf->accel.x + _sensor_combined.accelerometer_m_s2[_accel_main * 3 + 0]);
-			_ekf->dVelIMU.y = 0.5f * (_ekf->accel.y + _sensor_combined.accelerometer_m_s2[_accel_main * 3 + 1]);
-			_ekf->dVelIMU.z = 0.5f * (_ekf->accel.z + _sensor_combined.accelerometer_m_s2[_accel_main * 3 + 2]);
-		}
-
-		_ekf->accel.x = _sensor_combined.accelerometer_m_s2[_accel_main * 3 + 0];
-		_ekf->accel.y = _sensor_combined.accelerometer_m_s2[_accel_main * 3 + 1];
-		_ekf->accel.z = _sensor_combined.accelerometer_m_s2[_accel_main * 3 + 2];
-		_last_accel = _sensor_combined.accelerometer_timestamp[_accel_main];
+	if (_gyro_main >= 0) {
+		perf_count(_perf_gyro);
 	}
 
 	(void)_voter_mag.get_best(curr_time, &_mag_main);
@@ -1447,6 +1744,7 @@ void AttitudePositionEstimatorEKF::pollData()
 				if (dtLastGoodGPS > POS_RESET_THRESHOLD) {
 					_ekf->ResetPosition();
 					_ekf->ResetVelocity();
+					_clone_shadows = true;
 				}
 			}
 
@@ -1570,14 +1868,10 @@ int AttitudePositionEstimatorEKF::trip_nan()
 		usleep(100000);
 
 		PX4_INFO("tripping covariance #1 with NaN");
-		_ekf->KH[2][2] = nan_val; //  intermediate result used for covariance updates
+		_ekf->HP[5] = nan_val; // intermediate result used for covariance updates
 		usleep(100000);
 
 		PX4_INFO("tripping covariance #2 with NaN");
-		_ekf->KHP[5][5] = nan_val; // intermediate result used for covariance updates
-		usleep(100000);
-
-		PX4_INFO("tripping covariance #3 with NaN");
 		_ekf->P[3][3] = nan_val; // covariance matrix
 		usleep(100000);
 
@@ -1603,10 +1897,30 @@ int AttitudePositionEstimatorEKF::trip_nan()
 int ekf_att_pos_estimator_main(int argc, char *argv[])
 {
 	if (argc < 2) {
-		PX4_ERR("usage: ekf_att_pos_estimator {start|stop|status|logging}");
+		PX4_ERR("usage: ekf_att_pos_estimator {start|stop|status|logging|replay}");
 		return 1;
 	}
 
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+
+	if (!strcmp(argv[1], "replay")) {
+
+		if (argc < 3) {
+			PX4_ERR("usage: ekf_att_pos_estimator replay <log.px4log> [output.csv]");
+			return 1;
+		}
+
+		/* the replay drives the time base of the estimator */
+		if (estimator::g_estimator != nullptr) {
+			PX4_ERR("stop the estimator first");
+			return 1;
+		}
+
+		return ekf_replay(argv[2], (argc > 3) ? argv[3] : nullptr);
+	}
+
+#endif
+
 	if (!strcmp(argv[1], "start")) {
 
 		if (estimator::g_estimator != nullptr) {
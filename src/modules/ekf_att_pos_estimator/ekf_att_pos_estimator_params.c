@@ -305,3 +305,17 @@ PARAM_DEFINE_FLOAT(PE_MAGB_Z, 0.0f);
  * @group Position Estimator
  */
 PARAM_DEFINE_FLOAT(PE_POSDEV_INIT, 5.0f);
+
+/**
+ * Number of filter instances
+ *
+ * With more than one instance every IMU of sensor_combined runs its own filter
+ * on the same GPS, baro, mag and airspeed data, and the instance with the most
+ * consistent innovations is published. Each extra instance costs about 10 KB
+ * of RAM and the CPU time of one filter. Only read at startup.
+ *
+ * @min 1
+ * @max 3
+ * @group Position Estimator
+ */
+PARAM_DEFINE_INT32(PE_EKF_INST, 1);
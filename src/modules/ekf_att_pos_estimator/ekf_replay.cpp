@@ -0,0 +1,791 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file ekf_replay.cpp
+ * Offline replay of sdlog2 logs through the 22 state EKF.
+ *
+ * The log is read in file order. Every TIME message sets the replay clock,
+ * every primary IMU message runs one filter step with the sensor data
+ * received so far, following the sequence of the estimator app.
+ */
+
+#include "ekf_replay.h"
+#include "estimator_22states.h"
+
+#include <px4_defines.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <drivers/drv_hrt.h>
+#include <geo/geo.h>
+#include <geo_lookup/geo_mag_declination.h>
+#include <mathlib/mathlib.h>
+#include <systemlib/param/param.h>
+#include <systemlib/err.h>
+#include <modules/sdlog2/sdlog2_format.h>
+
+namespace
+{
+
+static constexpr uint64_t FILTER_INIT_DELAY = 1 * 1000 * 1000;	///< units: microseconds
+static constexpr float POS_RESET_THRESHOLD = 5.0f;		///< Seconds before we signal a total GPS failure
+static constexpr float rc = 10.0f;				///< RC time constant of 1st order LPF in seconds
+
+/*
+ * The message definitions in sdlog2_messages.h don't build as C++, these are
+ * copies of the ones replayed. The packet lengths are checked against the
+ * FMT messages of the log.
+ */
+#pragma pack(push, 1)
+#define LOG_IMU_MSG 4
+struct log_IMU_s {
+	float acc_x;
+	float acc_y;
+	float acc_z;
+	float gyro_x;
+	float gyro_y;
+	float gyro_z;
+	float mag_x;
+	float mag_y;
+	float mag_z;
+	float temp_acc;
+	float temp_gyro;
+	float temp_mag;
+};
+
+#define LOG_SENS_MSG 5
+struct log_SENS_s {
+	float baro_pres;
+	float baro_alt;
+	float baro_temp;
+	float diff_pres;
+	float diff_pres_filtered;
+};
+
+#define LOG_GPS_MSG 8
+struct log_GPS_s {
+	uint64_t gps_time;
+	uint8_t fix_type;
+	float eph;
+	float epv;
+	int32_t lat;
+	int32_t lon;
+	float alt;
+	float vel_n;
+	float vel_e;
+	float vel_d;
+	float cog;
+	uint8_t sats;
+	uint16_t snr_mean;
+	uint16_t noise_per_ms;
+	uint16_t jamming_indicator;
+};
+
+#define LOG_STAT_MSG 10
+struct log_STAT_s {
+	uint8_t main_state;
+	uint8_t arming_state;
+	uint8_t failsafe;
+	float battery_remaining;
+	uint8_t battery_warning;
+	uint8_t landed;
+	float load;
+};
+
+#define LOG_AIRS_MSG 13
+struct log_AIRS_s {
+	float indicated_airspeed;
+	float true_airspeed;
+	float air_temperature_celsius;
+};
+
+#define LOG_TIME_MSG 129
+struct log_TIME_s {
+	uint64_t t;
+};
+#pragma pack(pop)
+
+struct replay_params {
+	int32_t vel_delay_ms;
+	int32_t pos_delay_ms;
+	int32_t height_delay_ms;
+	int32_t mag_delay_ms;
+	int32_t tas_delay_ms;
+	float pos_stddev_threshold;
+};
+
+class EKFReplay
+{
+public:
+	EKFReplay(FILE *out);
+	~EKFReplay();
+
+	/**
+	 * Replay all messages of a log.
+	 */
+	void		run(FILE *log);
+
+	void		print_summary() const;
+
+private:
+	EKFReplay(const EKFReplay &) = delete;
+	EKFReplay &operator=(const EKFReplay &) = delete;
+
+	void		load_params();
+	bool		format_valid(uint8_t type, unsigned length) const;
+	void		handle_message(uint8_t type, const uint8_t *payload);
+	void		handle_gps(const struct log_GPS_s &gps);
+	void		handle_baro(const struct log_SENS_s &sens);
+	void		step(const struct log_IMU_s &imu);
+	void		initialize_gps();
+	void		update_fusion();
+	void		write_output(hrt_abstime step_us);
+
+	AttPosEKF	*_ekf;
+	FILE		*_out;
+	replay_params	_params;
+
+	uint8_t		_msg_length[256];	///< packet lengths from the FMT messages, 0 if unused
+
+	uint64_t	_time;			///< log time of the current message
+	uint64_t	_start_time;
+	uint64_t	_last_imu_time;
+
+	struct log_GPS_s _gps;
+	uint64_t	_gps_time;
+	uint64_t	_previous_gps_time;
+	bool		_gps_good;
+	bool		_gps_initialized;
+	struct map_projection_reference_s _pos_ref;
+	float		_gps_alt_filt;
+
+	float		_baro_alt;
+	float		_baro_alt_filt;
+	uint64_t	_baro_time;
+	bool		_baro_init;
+
+	float		_mag_last[3];
+	bool		_landed;
+
+	bool		_new_gps;
+	bool		_new_mag;
+	bool		_new_hgt;
+	bool		_new_ads;
+
+	float		_covariance_dt;
+
+	unsigned	_steps;
+	unsigned	_filter_steps;
+	unsigned	_resets;
+	uint64_t	_step_time_sum;
+	hrt_abstime	_step_time_max;
+};
+
+EKFReplay::EKFReplay(FILE *out) :
+	_ekf(new AttPosEKF()),
+	_out(out),
+	_params{},
+	_msg_length{},
+	_time(0),
+	_start_time(0),
+	_last_imu_time(0),
+	_gps{},
+	_gps_time(0),
+	_previous_gps_time(0),
+	_gps_good(false),
+	_gps_initialized(false),
+	_pos_ref{},
+	_gps_alt_filt(0.0f),
+	_baro_alt(0.0f),
+	_baro_alt_filt(0.0f),
+	_baro_time(0),
+	_baro_init(false),
+	_mag_last{},
+	_landed(true),
+	_new_gps(false),
+	_new_mag(false),
+	_new_hgt(false),
+	_new_ads(false),
+	_covariance_dt(0.0f),
+	_steps(0),
+	_filter_steps(0),
+	_resets(0),
+	_step_time_sum(0),
+	_step_time_max(0)
+{
+	load_params();
+
+	if (_out != nullptr) {
+		fprintf(_out, "t_us");
+
+		for (unsigned i = 0; i < EKF_STATE_ESTIMATES; i++) {
+			fprintf(_out, ",s%u", i);
+		}
+
+		fprintf(_out, ",innov_vn,innov_ve,innov_vd,innov_pn,innov_pe,innov_pd"
+			",innov_magx,innov_magy,innov_magz,innov_tas,step_us\n");
+	}
+}
+
+EKFReplay::~EKFReplay()
+{
+	delete _ekf;
+}
+
+void EKFReplay::load_params()
+{
+	float f;
+
+	param_get(param_find("PE_VEL_DELAY_MS"), &_params.vel_delay_ms);
+	param_get(param_find("PE_POS_DELAY_MS"), &_params.pos_delay_ms);
+	param_get(param_find("PE_HGT_DELAY_MS"), &_params.height_delay_ms);
+	param_get(param_find("PE_MAG_DELAY_MS"), &_params.mag_delay_ms);
+	param_get(param_find("PE_TAS_DELAY_MS"), &_params.tas_delay_ms);
+	param_get(param_find("PE_POSDEV_INIT"), &_params.pos_stddev_threshold);
+
+	/* same noise setup as the estimator app */
+	if (param_get(param_find("PE_GBIAS_PNOISE"), &f) == OK) { _ekf->dAngBiasSigma = f; }
+
+	if (param_get(param_find("PE_ABIAS_PNOISE"), &f) == OK) { _ekf->dVelBiasSigma = f; }
+
+	if (param_get(param_find("PE_MAGE_PNOISE"), &f) == OK) { _ekf->magEarthSigma = f; }
+
+	if (param_get(param_find("PE_MAGB_PNOISE"), &f) == OK) { _ekf->magBodySigma = f; }
+
+	if (param_get(param_find("PE_VELNE_NOISE"), &f) == OK) { _ekf->vneSigma = f; }
+
+	if (param_get(param_find("PE_VELD_NOISE"), &f) == OK) { _ekf->vdSigma = f; }
+
+	if (param_get(param_find("PE_POSNE_NOISE"), &f) == OK) { _ekf->posNeSigma = f; }
+
+	if (param_get(param_find("PE_POSD_NOISE"), &f) == OK) { _ekf->posDSigma = f; }
+
+	if (param_get(param_find("PE_MAG_NOISE"), &f) == OK) { _ekf->magMeasurementSigma = f; }
+
+	if (param_get(param_find("PE_GYRO_PNOISE"), &f) == OK) { _ekf->gyroProcessNoise = f; }
+
+	if (param_get(param_find("PE_ACC_PNOISE"), &f) == OK) { _ekf->accelProcessNoise = f; }
+
+	if (param_get(param_find("PE_EAS_NOISE"), &f) == OK) { _ekf->airspeedMeasurementSigma = f; }
+
+	_ekf->rngFinderPitch = 0.0f;
+}
+
+bool EKFReplay::format_valid(uint8_t type, unsigned length) const
+{
+	/* only decode messages whose layout matches the structs compiled in */
+	switch (type) {
+	case LOG_TIME_MSG:
+		return length == LOG_PACKET_SIZE(TIME);
+
+	case LOG_IMU_MSG:
+		return length == LOG_PACKET_SIZE(IMU);
+
+	case LOG_SENS_MSG:
+		return length == LOG_PACKET_SIZE(SENS);
+
+	case LOG_GPS_MSG:
+		return length == LOG_PACKET_SIZE(GPS);
+
+	case LOG_AIRS_MSG:
+		return length == LOG_PACKET_SIZE(AIRS);
+
+	case LOG_STAT_MSG:
+		return length == LOG_PACKET_SIZE(STAT);
+
+	default:
+		return true;
+	}
+}
+
+void EKFReplay::run(FILE *log)
+{
+	uint8_t payload[256];
+	unsigned sync = 0;
+	int c;
+
+	while ((c = getc(log)) != EOF) {
+		/* look for the two header bytes first */
+		if (sync == 0) {
+			sync = (c == HEAD_BYTE1) ? 1 : 0;
+			continue;
+		}
+
+		if (sync == 1) {
+			sync = (c == HEAD_BYTE2) ? 2 : ((c == HEAD_BYTE1) ? 1 : 0);
+			continue;
+		}
+
+		sync = 0;
+
+		const uint8_t type = c;
+		const unsigned length = (type == LOG_FORMAT_MSG) ? sizeof(struct log_format_s) + LOG_PACKET_HEADER_LEN :
+					_msg_length[type];
+
+		if (length <= LOG_PACKET_HEADER_LEN) {
+			/* unknown message, resync on the next header */
+			continue;
+		}
+
+		if (fread(payload, 1, length - LOG_PACKET_HEADER_LEN, log) != length - LOG_PACKET_HEADER_LEN) {
+			break;
+		}
+
+		if (type == LOG_FORMAT_MSG) {
+			struct log_format_s format;
+			memcpy(&format, payload, sizeof(format));
+
+			if (format_valid(format.type, format.length)) {
+				_msg_length[format.type] = format.length;
+
+			} else {
+				warnx("ignoring %.4s messages, unexpected length %u", format.name, format.length);
+			}
+
+		} else {
+			handle_message(type, payload);
+		}
+	}
+}
+
+void EKFReplay::handle_message(uint8_t type, const uint8_t *payload)
+{
+	switch (type) {
+	case LOG_TIME_MSG: {
+			struct log_TIME_s time;
+			memcpy(&time, payload, sizeof(time));
+			_time = time.t;
+
+			if (_start_time == 0) {
+				_start_time = _time;
+			}
+
+			break;
+		}
+
+	case LOG_STAT_MSG: {
+			struct log_STAT_s stat;
+			memcpy(&stat, payload, sizeof(stat));
+			_landed = stat.landed;
+			break;
+		}
+
+	case LOG_GPS_MSG: {
+			struct log_GPS_s gps;
+			memcpy(&gps, payload, sizeof(gps));
+			handle_gps(gps);
+			break;
+		}
+
+	case LOG_SENS_MSG: {
+			struct log_SENS_s sens;
+			memcpy(&sens, payload, sizeof(sens));
+			handle_baro(sens);
+			break;
+		}
+
+	case LOG_AIRS_MSG: {
+			struct log_AIRS_s airs;
+			memcpy(&airs, payload, sizeof(airs));
+			_ekf->VtasMeas = airs.true_airspeed;
+			_new_ads = true;
+			break;
+		}
+
+	case LOG_IMU_MSG: {
+			struct log_IMU_s imu;
+			memcpy(&imu, payload, sizeof(imu));
+			step(imu);
+			break;
+		}
+
+	default:
+		break;
+	}
+}
+
+void EKFReplay::handle_gps(const struct log_GPS_s &gps)
+{
+	_gps = gps;
+	_gps_time = _time;
+
+	// We are more strict for our first fix
+	float required_accuracy = _gps_good ? _params.pos_stddev_threshold * 2.0f : _params.pos_stddev_threshold;
+
+	_gps_good = (gps.fix_type >= 3) && (gps.eph < required_accuracy) && (gps.epv < required_accuracy);
+
+	if (!_gps_good) {
+		return;
+	}
+
+	const float dt_last_good_gps = static_cast<float>(_gps_time - _previous_gps_time) / 1e6f;
+
+	_ekf->GPSstatus = gps.fix_type;
+	_ekf->velNED[0] = gps.vel_n;
+	_ekf->velNED[1] = gps.vel_e;
+	_ekf->velNED[2] = gps.vel_d;
+
+	_ekf->gpsLat = math::radians(gps.lat / (double)1e7);
+	_ekf->gpsLon = math::radians(gps.lon / (double)1e7) - M_PI;
+	_ekf->gpsHgt = gps.alt;
+
+	if (_previous_gps_time != 0) {
+		_ekf->updateDtGpsFilt(math::constrain(dt_last_good_gps, 0.01f, POS_RESET_THRESHOLD));
+
+		float filter_step = (dt_last_good_gps / (rc + dt_last_good_gps)) * (_ekf->gpsHgt - _gps_alt_filt);
+
+		if (PX4_ISFINITE(filter_step)) {
+			_gps_alt_filt += filter_step;
+		}
+	}
+
+	if (_gps_initialized) {
+		map_projection_project(&_pos_ref, gps.lat / 1.0e7, gps.lon / 1.0e7, &_ekf->posNE[0], &_ekf->posNE[1]);
+
+		if (dt_last_good_gps > POS_RESET_THRESHOLD) {
+			_ekf->ResetPosition();
+			_ekf->ResetVelocity();
+		}
+	}
+
+	_previous_gps_time = _gps_time;
+	_new_gps = true;
+}
+
+void EKFReplay::handle_baro(const struct log_SENS_s &sens)
+{
+	float baro_elapsed = (_baro_time == 0) ? 0.0f : (_time - _baro_time) / 1e6f;
+	_baro_time = _time;
+	_baro_alt = sens.baro_alt;
+
+	if (!_baro_init) {
+		_baro_init = true;
+		_baro_alt_filt = _baro_alt;
+	}
+
+	_ekf->updateDtHgtFilt(math::constrain(baro_elapsed, 0.001f, 0.1f));
+	_ekf->baroHgt = _baro_alt;
+
+	float filter_step = (baro_elapsed / (rc + baro_elapsed)) * (_baro_alt - _baro_alt_filt);
+
+	if (PX4_ISFINITE(filter_step)) {
+		_baro_alt_filt += filter_step;
+	}
+
+	_new_hgt = true;
+}
+
+void EKFReplay::step(const struct log_IMU_s &imu)
+{
+	setMicros(_time);
+
+	float dt = (_time - _last_imu_time) / 1e6f;
+	_last_imu_time = _time;
+
+	/* guard against too large deltaT's */
+	if (!PX4_ISFINITE(dt) || dt > 1.0f || dt < 0.000001f) {
+		dt = 0.01f;
+	}
+
+	/* the log only holds rates, integrate them with the trapezoidal rule */
+	_ekf->dtIMU = dt;
+	_ekf->dAngIMU.x = 0.5f * (_ekf->angRate.x + imu.gyro_x) * dt;
+	_ekf->dAngIMU.y = 0.5f * (_ekf->angRate.y + imu.gyro_y) * dt;
+	_ekf->dAngIMU.z = 0.5f * (_ekf->angRate.z + imu.gyro_z) * dt;
+	_ekf->angRate.x = imu.gyro_x;
+	_ekf->angRate.y = imu.gyro_y;
+	_ekf->angRate.z = imu.gyro_z;
+
+	_ekf->dVelIMU.x = 0.5f * (_ekf->accel.x + imu.acc_x) * dt;
+	_ekf->dVelIMU.y = 0.5f * (_ekf->accel.y + imu.acc_y) * dt;
+	_ekf->dVelIMU.z = 0.5f * (_ekf->accel.z + imu.acc_z) * dt;
+	_ekf->accel.x = imu.acc_x;
+	_ekf->accel.y = imu.acc_y;
+	_ekf->accel.z = imu.acc_z;
+
+	/* the mag is logged with every IMU sample, only fuse changed values */
+	if (imu.mag_x != _mag_last[0] || imu.mag_y != _mag_last[1] || imu.mag_z != _mag_last[2]) {
+		_mag_last[0] = imu.mag_x;
+		_mag_last[1] = imu.mag_y;
+		_mag_last[2] = imu.mag_z;
+
+		if (Vector3f(imu.mag_x, imu.mag_y, imu.mag_z).length() > 0.1f) {
+			_ekf->magData.x = imu.mag_x;
+			_ekf->magData.y = imu.mag_y;
+			_ekf->magData.z = imu.mag_z;
+			_new_mag = true;
+		}
+	}
+
+	_steps++;
+
+	// If it has gone more than POS_RESET_THRESHOLD since the last good fix the GPS is lost
+	if (_gps_good && static_cast<float>(_time - _previous_gps_time) / 1e6f >= POS_RESET_THRESHOLD) {
+		_gps_good = false;
+	}
+
+	if (_time - _start_time < FILTER_INIT_DELAY || !_baro_init) {
+		return;
+	}
+
+	hrt_abstime t0 = hrt_absolute_time();
+
+	if (!_ekf->statesInitialised) {
+		float init_vel_ned[3] = {0.0f, 0.0f, 0.0f};
+
+		_ekf->posNE[0] = 0.0f;
+		_ekf->posNE[1] = 0.0f;
+		_baro_alt_filt = _baro_alt;
+
+		_ekf->InitialiseFilter(init_vel_ned, 0.0, 0.0, 0.0f, 0.0f);
+
+	} else if (!_gps_initialized && _gps_good) {
+		initialize_gps();
+
+	} else {
+		_ekf->setOnGround(_landed);
+
+		struct ekf_status_report ekf_report;
+
+		if (_ekf->CheckAndBound(&ekf_report)) {
+			_resets++;
+
+		} else {
+			update_fusion();
+
+			hrt_abstime step_us = hrt_absolute_time() - t0;
+			_step_time_sum += step_us;
+			_filter_steps++;
+
+			if (step_us > _step_time_max) {
+				_step_time_max = step_us;
+			}
+
+			write_output(step_us);
+		}
+	}
+
+	_new_gps = false;
+	_new_mag = false;
+	_new_hgt = false;
+	_new_ads = false;
+}
+
+void EKFReplay::initialize_gps()
+{
+	double lat = _gps.lat / 1.0e7;
+	double lon = _gps.lon / 1.0e7;
+
+	_ekf->baroHgt = _baro_alt;
+	_ekf->hgtMea = _ekf->baroHgt;
+
+	_ekf->GPSstatus = _gps.fix_type;
+	_ekf->gpsLat = math::radians(lat);
+	_ekf->gpsLon = math::radians(lon) - M_PI;
+	_ekf->gpsHgt = _gps.alt;
+
+	float declination = math::radians(get_mag_declination(lat, lon));
+
+	float init_vel_ned[3] = {_gps.vel_n, _gps.vel_e, _gps.vel_d};
+
+	_ekf->InitialiseFilter(init_vel_ned, math::radians(lat), math::radians(lon) - M_PI, _gps.alt, declination);
+
+	_baro_alt_filt = _baro_alt;
+	_gps_alt_filt = _gps.alt;
+	map_projection_init(&_pos_ref, lat, lon);
+
+	_gps_initialized = true;
+}
+
+void EKFReplay::update_fusion()
+{
+	const uint32_t now_ms = millis();
+
+	// Run the strapdown INS equations every IMU update
+	_ekf->UpdateStrapdownEquationsNED();
+
+	// store the predicted states for subsequent use by measurement fusion
+	_ekf->StoreStates(now_ms);
+
+	// sum delta angles and time used by covariance prediction
+	_ekf->summedDelAng = _ekf->summedDelAng + _ekf->correctedDelAng;
+	_ekf->summedDelVel = _ekf->summedDelVel + _ekf->dVelIMU;
+	_covariance_dt += _ekf->dtIMU;
+
+	if ((_covariance_dt >= (_ekf->covTimeStepMax - _ekf->dtIMU))
+	    || (_ekf->summedDelAng.length() > _ekf->covDelAngMax)) {
+		_ekf->CovariancePrediction(_covariance_dt);
+		_ekf->summedDelAng.zero();
+		_ekf->summedDelVel.zero();
+		_covariance_dt = 0.0f;
+	}
+
+	if (_gps_good && _gps_initialized) {
+		/* position and velocity are fused at the IMU rate like in the app */
+		_ekf->fuseVelData = true;
+		_ekf->fusePosData = true;
+		_ekf->RecallStates(_ekf->statesAtVelTime, now_ms - _params.vel_delay_ms);
+		_ekf->RecallStates(_ekf->statesAtPosTime, now_ms - _params.pos_delay_ms);
+		_ekf->FuseVelposNED();
+
+	} else if (!_gps_initialized) {
+		// force static mode
+		_ekf->staticMode = true;
+
+		_ekf->velNED[0] = 0.0f;
+		_ekf->velNED[1] = 0.0f;
+		_ekf->velNED[2] = 0.0f;
+		_ekf->posNE[0] = 0.0f;
+		_ekf->posNE[1] = 0.0f;
+
+		_ekf->fuseVelData = true;
+		_ekf->fusePosData = true;
+		_ekf->RecallStates(_ekf->statesAtVelTime, now_ms - _params.vel_delay_ms);
+		_ekf->RecallStates(_ekf->statesAtPosTime, now_ms - _params.pos_delay_ms);
+		_ekf->FuseVelposNED();
+
+	} else {
+		_ekf->fuseVelData = false;
+		_ekf->fusePosData = false;
+	}
+
+	if (_new_hgt) {
+		_ekf->hgtMea = _ekf->baroHgt;
+		_ekf->fuseHgtData = true;
+		_ekf->RecallStates(_ekf->statesAtHgtTime, now_ms - _params.height_delay_ms);
+		_ekf->FuseVelposNED();
+
+	} else {
+		_ekf->fuseHgtData = false;
+	}
+
+	if (_new_mag) {
+		_ekf->fuseMagData = true;
+		_ekf->RecallStates(_ekf->statesAtMagMeasTime, now_ms - _params.mag_delay_ms);
+
+		_ekf->magstate.obsIndex = 0;
+		_ekf->FuseMagnetometer();
+		_ekf->FuseMagnetometer();
+		_ekf->FuseMagnetometer();
+
+	} else {
+		_ekf->fuseMagData = false;
+	}
+
+	if (_new_ads && _ekf->VtasMeas > 5.0f) {
+		_ekf->fuseVtasData = true;
+		_ekf->RecallStates(_ekf->statesAtVtasMeasTime, now_ms - _params.tas_delay_ms);
+		_ekf->FuseAirspeed();
+
+	} else {
+		_ekf->fuseVtasData = false;
+	}
+}
+
+void EKFReplay::write_output(hrt_abstime step_us)
+{
+	if (_out == nullptr) {
+		return;
+	}
+
+	fprintf(_out, "%llu", (unsigned long long)_time);
+
+	for (unsigned i = 0; i < EKF_STATE_ESTIMATES; i++) {
+		fprintf(_out, ",%.6g", (double)_ekf->states[i]);
+	}
+
+	for (unsigned i = 0; i < 6; i++) {
+		fprintf(_out, ",%.6g", (double)_ekf->innovVelPos[i]);
+	}
+
+	for (unsigned i = 0; i < 3; i++) {
+		fprintf(_out, ",%.6g", (double)_ekf->innovMag[i]);
+	}
+
+	fprintf(_out, ",%.6g,%llu\n", (double)_ekf->innovVtas, (unsigned long long)step_us);
+}
+
+void EKFReplay::print_summary() const
+{
+	const double log_s = (_last_imu_time - _start_time) / 1e6;
+
+	PX4_INFO("IMU samples: %u, filter steps: %u, resets: %u, log duration: %.1f s",
+		 _steps, _filter_steps, _resets, log_s);
+
+	if (_filter_steps > 0) {
+		PX4_INFO("filter step: %.2f us mean, %llu us max, %.0f x real-time",
+			 (double)_step_time_sum / _filter_steps, (unsigned long long)_step_time_max,
+			 (_step_time_sum > 0) ? log_s * 1e6 / _step_time_sum : 0.0);
+	}
+}
+
+} // namespace
+
+int ekf_replay(const char *log_path, const char *out_path)
+{
+	FILE *log = fopen(log_path, "rb");
+
+	if (log == nullptr) {
+		PX4_ERR("can't open %s", log_path);
+		return 1;
+	}
+
+	FILE *out = nullptr;
+
+	if (out_path != nullptr) {
+		out = fopen(out_path, "w");
+
+		if (out == nullptr) {
+			PX4_ERR("can't open %s", out_path);
+			fclose(log);
+			return 1;
+		}
+	}
+
+	EKFReplay *replay = new EKFReplay(out);
+
+	hrt_abstime start = hrt_absolute_time();
+	replay->run(log);
+	PX4_INFO("replayed %s in %.2f s", log_path, (hrt_absolute_time() - start) / 1e6);
+	replay->print_summary();
+
+	delete replay;
+
+	if (out != nullptr) {
+		fclose(out);
+	}
+
+	fclose(log);
+	return 0;
+}
@@ -114,13 +114,12 @@ public:
 
 
     // Global variables
-    float KH[EKF_STATE_ESTIMATES][EKF_STATE_ESTIMATES]; //  intermediate result used for covariance updates
-    float KHP[EKF_STATE_ESTIMATES][EKF_STATE_ESTIMATES]; // intermediate result used for covariance updates
+    float HP[EKF_STATE_ESTIMATES]; // intermediate result H*P used for covariance updates
     float P[EKF_STATE_ESTIMATES][EKF_STATE_ESTIMATES]; // covariance matrix
     float Kfusion[EKF_STATE_ESTIMATES]; // Kalman gains
     float states[EKF_STATE_ESTIMATES]; // state matrix
     float resetStates[EKF_STATE_ESTIMATES];
-    float storedStates[EKF_STATE_ESTIMATES][EKF_DATA_BUFFER_SIZE]; // state vectors stored for the last 50 time steps
+    float storedStates[EKF_DATA_BUFFER_SIZE][EKF_STATE_ESTIMATES]; // state vectors stored for the last 50 time steps, oldest first from storeIndex
     uint32_t statetimeStamp[EKF_DATA_BUFFER_SIZE]; // time stamp for each state vector stored
 
     // Times
@@ -230,9 +229,10 @@ public:
     bool numericalProtection;
 
     unsigned storeIndex;
+    unsigned storeCount; // number of valid entries in the state history
 
     // Optical Flow error estimation
-    float storedOmega[3][EKF_DATA_BUFFER_SIZE]; // angular rate vector stored for the last 50 time steps used by optical flow eror estimators
+    float storedOmega[EKF_DATA_BUFFER_SIZE][3]; // angular rate vector stored for the last 50 time steps used by optical flow eror estimators
 
     // Two state EKF used to estimate focal length scale factor and terrain position
     float Popt[2][2];                       // state covariance matrix
@@ -297,6 +297,13 @@ public:
      */
     int RecallStates(float *statesForFusion, uint64_t msec);
 
+    /**
+     * Get the storage index of an entry of the state history.
+     *
+     * @param age number of entries stored after the requested one, zero for the newest
+     */
+    size_t StoredStateIndex(unsigned age);
+
     void RecallOmega(float *omegaForFusion, uint64_t msec);
 
     void quat2Tbn(Mat3f &TBodyNed, const float (&quat)[4]);
@@ -329,6 +336,23 @@ public:
 
     void ForceSymmetry();
 
+    /**
+    * @brief
+    *   Covariance update P = P - K * (H * P) of a scalar observation
+    *
+    *   Only the non-zero entries of the observation jacobian H are
+    *   passed in, so the update is a rank one correction that never
+    *   forms the KH and KHP matrices.
+    *
+    * @param gain Kalman gains K
+    * @param hIndex state indices of the non-zero entries of H
+    * @param hValue values of the non-zero entries of H
+    * @param hCount number of non-zero entries of H
+    * @param lastIndex last state index to update
+    **/
+    void UpdateCovarianceSparse(const float *gain, const uint8_t *hIndex, const float *hValue,
+                                uint8_t hCount, uint8_t lastIndex);
+
     /**
     * @brief
     *   Check the filter inputs and bound its operational state
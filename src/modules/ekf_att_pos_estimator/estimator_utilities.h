@@ -115,7 +115,7 @@ struct ekf_status_report {
     unsigned n_states;
     bool angNaN;
     bool summedDelVelNaN;
-    bool KHNaN;
+    bool KHNaN;     // no longer set, KH is not formed by the sparse covariance update
     bool KHPNaN;
     bool PNaN;
     bool covarianceNaN;
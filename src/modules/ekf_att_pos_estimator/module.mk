@@ -42,5 +42,12 @@ SRCS		= ekf_att_pos_estimator_main.cpp \
 		  estimator_22states.cpp \
 		  estimator_utilities.cpp
 
+ifeq ($(PX4_TARGET_OS),posix)
+SRCS		+= ekf_replay.cpp
+endif
+ifeq ($(PX4_TARGET_OS),posix-arm)
+SRCS		+= ekf_replay.cpp
+endif
+
 EXTRACXXFLAGS	= -Weffc++ -Wframe-larger-than=3400
 
@@ -118,10 +118,12 @@ BlockMultiModeBacksideAutopilot::BlockMultiModeBacksideAutopilot(SuperBlock *par
 	_crMax(this, "CR_MAX"),
 	_attPoll(),
 	_lastMissionCmd(),
-	_timeStamp(0)
+	_timeStamp(0),
+	_blocks()
 {
 	_attPoll.fd = _att.getHandle();
 	_attPoll.events = POLLIN;
+	flatten(_blocks, sizeof(_blocks) / sizeof(_blocks[0]));
 }
 
 void BlockMultiModeBacksideAutopilot::update()
@@ -267,6 +267,9 @@ private:
 	position_setpoint_triplet_s _lastMissionCmd;
 	enum {CH_AIL, CH_ELV, CH_RDR, CH_THR};
 	uint64_t _timeStamp;
+
+	// flat update schedule of the block tree
+	Block *_blocks[64];
 public:
 	BlockMultiModeBacksideAutopilot(SuperBlock *parent, const char *name);
 	void update();
@@ -72,6 +72,7 @@
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/vehicle_global_position.h>
 #include <uORB/topics/vehicle_status.h>
+#include <uORB/topics/vtol_vehicle_status.h>
 #include <systemlib/param/param.h>
 #include <systemlib/err.h>
 #include <systemlib/pid/pid.h>
@@ -135,6 +136,7 @@ private:
 	int 		_manual_sub;			/**< notification of manual control updates */
 	int		_global_pos_sub;		/**< global position subscription */
 	int		_vehicle_status_sub;		/**< vehicle status subscription */
+	int		_vtol_status_sub;		/**< vtol vehicle status subscription */
 
 	orb_advert_t	_rate_sp_pub;			/**< rate setpoint publication */
 	orb_advert_t	_attitude_sp_pub;		/**< attitude setpoint point */
@@ -155,6 +157,7 @@ private:
 	struct actuator_controls_s			_actuators_airframe;	/**< actuator control inputs */
 	struct vehicle_global_position_s		_global_pos;		/**< global position */
 	struct vehicle_status_s				_vehicle_status;	/**< vehicle status */
+	struct vtol_vehicle_status_s			_vtol_status;		/**< vtol vehicle status */
 
 	perf_counter_t	_loop_perf;			/**< loop performance counter */
 	perf_counter_t	_nonfinite_input_perf;		/**< performance counter for non finite input */
@@ -295,6 +298,11 @@ private:
 	 */
 	void		vehicle_status_poll();
 
+	/**
+	 * Check for vtol vehicle status updates.
+	 */
+	void		vtol_status_poll();
+
 	/**
 	 * Shim for calling task_main from task_create.
 	 */
@@ -334,6 +342,7 @@ FixedwingAttitudeControl::FixedwingAttitudeControl() :
 	_manual_sub(-1),
 	_global_pos_sub(-1),
 	_vehicle_status_sub(-1),
+	_vtol_status_sub(-1),
 
 /* publications */
 	_rate_sp_pub(nullptr),
@@ -364,6 +373,7 @@ FixedwingAttitudeControl::FixedwingAttitudeControl() :
 	_actuators_airframe = {};
 	_global_pos = {};
 	_vehicle_status = {};
+	_vtol_status = {};
 
 
 	_parameter_handles.tconst = param_find("FW_ATT_TC");
@@ -558,8 +568,10 @@ FixedwingAttitudeControl::vehicle_accel_poll()
 	bool accel_updated;
 	orb_check(_accel_sub, &accel_updated);
 
-	if (accel_updated) {
+	/* the driver queues its reports, skip to the latest one */
+	while (accel_updated) {
 		orb_copy(ORB_ID(sensor_accel), _accel_sub, &_accel);
+		orb_check(_accel_sub, &accel_updated);
 	}
 }
 
@@ -610,6 +622,18 @@ FixedwingAttitudeControl::vehicle_status_poll()
 	}
 }
 
+void
+FixedwingAttitudeControl::vtol_status_poll()
+{
+	/* check if there is new vtol status information */
+	bool vtol_status_updated;
+	orb_check(_vtol_status_sub, &vtol_status_updated);
+
+	if (vtol_status_updated) {
+		orb_copy(ORB_ID(vtol_vehicle_status), _vtol_status_sub, &_vtol_status);
+	}
+}
+
 void
 FixedwingAttitudeControl::task_main_trampoline(int argc, char *argv[])
 {
@@ -631,6 +655,7 @@ FixedwingAttitudeControl::task_main()
 	_manual_sub = orb_subscribe(ORB_ID(manual_control_setpoint));
 	_global_pos_sub = orb_subscribe(ORB_ID(vehicle_global_position));
 	_vehicle_status_sub = orb_subscribe(ORB_ID(vehicle_status));
+	_vtol_status_sub = orb_subscribe(ORB_ID(vtol_vehicle_status));
 
 	/* rate limit vehicle status updates to 5Hz */
 	orb_set_interval(_vcontrol_mode_sub, 200);
@@ -662,6 +687,13 @@ FixedwingAttitudeControl::task_main()
 	while (!_task_should_exit) {
 		static int loop_counter = 0;
 
+		/* a VTOL in multicopter flight may suspend this controller until the next transition */
+		vtol_status_poll();
+
+		bool suspended = _vehicle_status.is_vtol && _vtol_status.fw_ctrl_suspended;
+
+		fds[1].fd = suspended ? _vtol_status_sub : _att_sub;
+
 		/* wait for up to 500ms for data */
 		int pret = px4_poll(&fds[0], (sizeof(fds) / sizeof(fds[0])), 100);
 
@@ -689,7 +721,7 @@ FixedwingAttitudeControl::task_main()
 		}
 
 		/* only run controller if attitude changed */
-		if (fds[1].revents & POLLIN) {
+		if (!suspended && (fds[1].revents & POLLIN)) {
 			static uint64_t last_run = 0;
 			float deltaT = (hrt_absolute_time() - last_run) / 1000000.0f;
 			last_run = hrt_absolute_time();
@@ -991,6 +1023,7 @@ FixedwingAttitudeControl::task_main()
 				control_input.airspeed = airspeed;
 				control_input.scaler = airspeed_scaling;
 				control_input.lock_integrator = lock_integrator;
+				ecl_control_data_update_trig(control_input);
 
 				/* Run attitude controllers */
 				if (PX4_ISFINITE(roll_sp) && PX4_ISFINITE(pitch_sp)) {
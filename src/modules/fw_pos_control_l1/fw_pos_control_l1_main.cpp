@@ -219,6 +219,12 @@ private:
 	bool _airspeed_valid;				///< flag if a valid airspeed estimate exists
 	uint64_t _airspeed_last_valid;			///< last time airspeed was valid. Used to detect sensor failures
 	float _groundspeed_undershoot;			///< ground speed error to min. speed in m/s
+
+	/* geometry of the current leg, recomputed only when the setpoint triplet or the parameters change */
+	struct {
+		float bearing;				///< bearing from the previous to the current waypoint
+		float ground_speed_desired;		///< min. ground speed along the leg, only valid with a previous waypoint
+	} _leg;
 	bool _global_pos_valid;				///< global position is valid
 	math::Matrix<3, 3> _R_nb;			///< current attitude
 
@@ -422,6 +428,11 @@ private:
 					 const struct position_setpoint_triplet_s &_pos_sp_triplet);
 
 	float		calculate_target_airspeed(float airspeed_demand);
+
+	/**
+	 * Update the geometry of the leg between the previous and the current waypoint.
+	 */
+	void		update_leg();
 	void		calculate_gndspeed_undershoot(const math::Vector<2> &current_position, const math::Vector<2> &ground_speed_2d, const struct position_setpoint_triplet_s &pos_sp_triplet);
 
 	/**
@@ -537,6 +548,7 @@ FixedwingPositionControl::FixedwingPositionControl() :
 	_airspeed_valid(false),
 	_airspeed_last_valid(0),
 	_groundspeed_undershoot(0.0f),
+	_leg{},
 	_global_pos_valid(false),
 	_l1_control(),
 	_mTecs(),
@@ -715,6 +727,9 @@ FixedwingPositionControl::parameters_update()
 	_nav_capabilities.landing_flare_length = landingslope.flare_length();
 	navigation_capabilities_publish();
 
+	/* the leg geometry depends on the minimum airspeed */
+	update_leg();
+
 	/* Update Launch Detector Parameters */
 	launchDetector.updateParams();
 
@@ -827,6 +842,27 @@ FixedwingPositionControl::vehicle_setpoint_poll()
 
 	if (pos_sp_triplet_updated) {
 		orb_copy(ORB_ID(position_setpoint_triplet), _pos_sp_triplet_sub, &_pos_sp_triplet);
+		update_leg();
+	}
+}
+
+void
+FixedwingPositionControl::update_leg()
+{
+	const position_setpoint_s &prev = _pos_sp_triplet.previous;
+	const position_setpoint_s &curr = _pos_sp_triplet.current;
+
+	/* single precision like the waypoint vectors of the controller */
+	if (prev.valid) {
+		_leg.bearing = get_bearing_to_next_waypoint((float)prev.lat, (float)prev.lon, (float)curr.lat, (float)curr.lon);
+
+		float distance = get_distance_to_next_waypoint(prev.lat, prev.lon, curr.lat, curr.lon);
+		_leg.ground_speed_desired = _parameters.airspeed_min * cosf(atan2f(curr.alt - prev.alt, distance));
+
+	} else {
+		/* the previous waypoint falls back to the current one */
+		_leg.bearing = get_bearing_to_next_waypoint((float)curr.lat, (float)curr.lon, (float)curr.lat, (float)curr.lon);
+		_leg.ground_speed_desired = 0.0f;
 	}
 }
 
@@ -889,18 +925,16 @@ FixedwingPositionControl::calculate_gndspeed_undershoot(const math::Vector<2> &c
 		float ground_speed_body = yaw_vector * ground_speed_2d;
 
 		/* The minimum desired ground speed is the minimum airspeed projected on to the ground using the altitude and horizontal difference between the waypoints if available*/
-		float distance = 0.0f;
-		float delta_altitude = 0.0f;
+		float ground_speed_desired;
 		if (pos_sp_triplet.previous.valid) {
-			distance = get_distance_to_next_waypoint(pos_sp_triplet.previous.lat, pos_sp_triplet.previous.lon, pos_sp_triplet.current.lat, pos_sp_triplet.current.lon);
-			delta_altitude = pos_sp_triplet.current.alt - pos_sp_triplet.previous.alt;
+			/* fixed for the leg, see update_leg() */
+			ground_speed_desired = _leg.ground_speed_desired;
 		} else {
-			distance = get_distance_to_next_waypoint(current_position(0), current_position(1), pos_sp_triplet.current.lat, pos_sp_triplet.current.lon);
-			delta_altitude = pos_sp_triplet.current.alt -  _global_pos.alt;
+			float distance = get_distance_to_next_waypoint(current_position(0), current_position(1), pos_sp_triplet.current.lat, pos_sp_triplet.current.lon);
+			float delta_altitude = pos_sp_triplet.current.alt -  _global_pos.alt;
+			ground_speed_desired = _parameters.airspeed_min * cosf(atan2f(delta_altitude, distance));
 		}
 
-		float ground_speed_desired = _parameters.airspeed_min * cosf(atan2f(delta_altitude, distance));
-
 
 		/*
 		 * Ground speed undershoot is the amount of ground velocity not reached
@@ -1197,7 +1231,7 @@ FixedwingPositionControl::control_position(const math::Vector<2> &current_positi
 
 		} else if (pos_sp_triplet.current.type == position_setpoint_s::SETPOINT_TYPE_LAND) {
 
-			float bearing_lastwp_currwp = get_bearing_to_next_waypoint(prev_wp(0), prev_wp(1), curr_wp(0), curr_wp(1));
+			float bearing_lastwp_currwp = _leg.bearing;
 			float bearing_airplane_currwp = get_bearing_to_next_waypoint(current_position(0), current_position(1), curr_wp(0), curr_wp(1));
 
 			/* Horizontal landing control */
@@ -1362,7 +1396,7 @@ FixedwingPositionControl::control_position(const math::Vector<2> &current_positi
 				}
 
 				/* Detect launch */
-				launchDetector.update(_sensor_combined.accelerometer_m_s2[0]);
+				launchDetector.update();
 
 				/* update our copy of the launch detection state */
 				launch_detection_state = launchDetector.getLaunchDetected();
@@ -40,13 +40,17 @@
  */
 
 #include "LandDetector.h"
-#include <unistd.h>                 //usleep
 #include <drivers/drv_hrt.h>
+#include <uORB/topics/actuator_armed.h>
 
 LandDetector::LandDetector() :
 	_landDetectedPub(0),
 	_landDetected({0, false}),
 	_arming_time(0),
+	_work{},
+	_armingSub(-1),
+	_armed(false),
+	_initialized(false),
 	_taskShouldExit(false),
 	_taskIsRunning(false)
 {
@@ -75,32 +79,57 @@ void LandDetector::start()
 	_landDetected.landed = false;
 	_landDetectedPub = (uintptr_t)orb_advertise(ORB_ID(vehicle_land_detected), &_landDetected);
 
-	// initialize land detection algorithm
-	initialize();
-
-	// task is now running, keep doing so until shutdown() has been called
+	// keep cycling on the work queue until shutdown() has been called
 	_taskIsRunning = true;
 	_taskShouldExit = false;
 
-	while (isRunning()) {
+	work_queue(LPWORK, &_work, (worker_t)&LandDetector::cycle_trampoline, this, 0);
+}
+
+void LandDetector::cycle_trampoline(void *arg)
+{
+	LandDetector *dev = reinterpret_cast<LandDetector *>(arg);
+
+	dev->cycle();
+}
+
+void LandDetector::cycle()
+{
+	if (!_initialized) {
+		// the subscriptions belong to the work queue, so they are created from here
+		initialize();
+		_armingSub = orb_subscribe(ORB_ID(actuator_armed));
+		_initialized = true;
+	}
 
-		bool landDetected = update();
+	if (_taskShouldExit) {
+		orb_unsubscribe(_armingSub);
+		_taskIsRunning = false;
+		return;
+	}
 
-		// publish if land detection state has changed
-		if (_landDetected.landed != landDetected) {
-			_landDetected.timestamp = hrt_absolute_time();
-			_landDetected.landed = landDetected;
+	bool landDetected = update();
+
+	// an arming state change that arrived meanwhile is evaluated right away instead of a period later
+	struct actuator_armed_s arming;
+
+	if (orb_update(ORB_ID(actuator_armed), _armingSub, &arming) && arming.armed != _armed) {
+		_armed = arming.armed;
+		landDetected = update();
+	}
 
-			// publish the land detected broadcast
-			orb_publish(ORB_ID(vehicle_land_detected), (orb_advert_t)_landDetectedPub, &_landDetected);
-		}
+	// publish if land detection state has changed
+	if (_landDetected.landed != landDetected) {
+		_landDetected.timestamp = hrt_absolute_time();
+		_landDetected.landed = landDetected;
 
-		// limit loop rate
-		usleep(1000000 / LAND_DETECTOR_UPDATE_RATE);
+		// publish the land detected broadcast
+		orb_publish(ORB_ID(vehicle_land_detected), (orb_advert_t)_landDetectedPub, &_landDetected);
 	}
 
-	_taskIsRunning = false;
-	_exit(0);
+	// limit loop rate
+	work_queue(LPWORK, &_work, (worker_t)&LandDetector::cycle_trampoline, this,
+		   USEC2TICK(1000000 / LAND_DETECTOR_UPDATE_RATE));
 }
 
 bool LandDetector::orb_update(const struct orb_metadata *meta, int handle, void *buffer)
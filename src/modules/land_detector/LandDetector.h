@@ -41,6 +41,7 @@
 #ifndef __LAND_DETECTOR_H__
 #define __LAND_DETECTOR_H__
 
+#include <px4_workqueue.h>
 #include <uORB/uORB.h>
 #include <uORB/topics/vehicle_land_detected.h>
 
@@ -67,8 +68,8 @@ public:
 	void shutdown();
 
 	/**
-	 * @brief Blocking function that should be called from it's own task thread. This method will
-	 *        run the underlying algorithm at the desired update rate and publish if the landing state changes.
+	 * @brief Schedules the land detector on the low priority work queue and returns. The underlying
+	 *        algorithm then runs at the desired update rate and publishes if the landing state changes.
 	 **/
 	void start();
 
@@ -104,8 +105,22 @@ protected:
 	uint64_t				_arming_time;			/**< timestamp of arming time */
 
 private:
+	/**
+	* @brief Runs one iteration of the algorithm and schedules the next one
+	**/
+	void cycle();
+
+	/**
+	* @brief Static trampoline from the work queue context
+	**/
+	static void cycle_trampoline(void *arg);
+
+	struct work_s _work;                                                /**< work queue entry of the cycle */
+	int _armingSub;                                                     /**< re-evaluates on arming state changes */
+	bool _armed;                                                        /**< last arming state seen on _armingSub */
+	bool _initialized;                                                  /**< subscriptions created in the work queue context */
 	bool _taskShouldExit;                                               /**< true if it is requested that this task should exit */
-	bool _taskIsRunning;                                                /**< task has reached main loop and is currently running */
+	bool _taskIsRunning;                                                /**< cycle is scheduled on the work queue */
 };
 
 #endif //__LAND_DETECTOR_H__
@@ -40,15 +40,11 @@
 
 #include <px4_config.h>
 #include <px4_defines.h>
-#include <px4_tasks.h>
 #include <px4_posix.h>
 #include <unistd.h>					//usleep
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <errno.h>
-#include <drivers/drv_hrt.h>
-#include <systemlib/systemlib.h>	//Scheduler
 #include <systemlib/err.h>			//print to console
 
 #include "FixedwingLandDetector.h"
@@ -67,56 +63,46 @@ extern "C" __EXPORT int land_detector_main(int argc, char *argv[]);
 
 //Private variables
 static LandDetector *land_detector_task = nullptr;
-static int _landDetectorTaskID = -1;
 static char _currentMode[12];
 
 /**
-* Deamon thread function
-**/
-static void land_detector_deamon_thread(int argc, char *argv[])
-{
-	land_detector_task->start();
-}
-
-/**
-* Stop the task, force killing it if it doesn't stop by itself
+* Stop the work queue cycle, give up if it doesn't stop by itself
 **/
 static void land_detector_stop()
 {
-	if (land_detector_task == nullptr || _landDetectorTaskID == -1) {
+	if (land_detector_task == nullptr) {
 		warnx("not running");
 		return;
 	}
 
 	land_detector_task->shutdown();
 
-	//Wait for task to die
+	//Wait for the cycle to finish
 	int i = 0;
 
 	do {
 		/* wait 20ms */
 		usleep(20000);
 
-		/* if we have given up, kill it */
+		/* if we have given up, leave it allocated as it may still be scheduled */
 		if (++i > 50) {
-			px4_task_delete(_landDetectorTaskID);
-			break;
+			warnx("stop failed - timeout");
+			return;
 		}
 	} while (land_detector_task->isRunning());
 
 
 	delete land_detector_task;
 	land_detector_task = nullptr;
-	_landDetectorTaskID = -1;
 	warnx("land_detector has been stopped");
 }
 
 /**
-* Start new task, fails if it is already running. Returns OK if successful
+* Schedule the land detector, fails if it is already running. Returns OK if successful
 **/
 static int land_detector_start(const char *mode)
 {
-	if (land_detector_task != nullptr || _landDetectorTaskID != -1) {
+	if (land_detector_task != nullptr) {
 		warnx("already running");
 		return -1;
 	}
@@ -139,41 +125,8 @@ static int land_detector_start(const char *mode)
 		return -1;
 	}
 
-	//Start new thread task
-	_landDetectorTaskID = px4_task_spawn_cmd("land_detector",
-					     SCHED_DEFAULT,
-					     SCHED_PRIORITY_DEFAULT,
-					     1000,
-					     (px4_main_t)&land_detector_deamon_thread,
-					     nullptr);
-
-	if (_landDetectorTaskID < 0) {
-		warnx("task start failed: %d", -errno);
-		return -1;
-	}
-
-	/* avoid memory fragmentation by not exiting start handler until the task has fully started */
-	const uint32_t timeout = hrt_absolute_time() + 5000000; //5 second timeout
-
-	/* avoid printing dots just yet and do one sleep before the first check */
-	usleep(10000);
-
-	/* check if the waiting involving dots and a newline are still needed */
-	if (!land_detector_task->isRunning()) {
-		while (!land_detector_task->isRunning()) {
-
-			printf(".");
-			fflush(stdout);
-			usleep(50000);
-
-			if (hrt_absolute_time() > timeout) {
-				warnx("start failed - timeout");
-				land_detector_stop();
-				return 1;
-			}
-		}
-		printf("\n");
-	}
+	//Schedule the cycle on the low priority work queue
+	land_detector_task->start();
 
 	//Remember current active mode
 	strncpy(_currentMode, mode, 12);
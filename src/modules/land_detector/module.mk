@@ -12,6 +12,6 @@ SRCS		= land_detector_main.cpp \
 
 EXTRACXXFLAGS   = -Weffc++ -Os
 
-# Startup handler, the actual app stack size is
-# in the task_spawn command
+# Startup handler, the algorithm runs on the
+# low priority work queue
 MODULE_STACKSIZE = 1200
@@ -0,0 +1,358 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file load_mon.c
+ *
+ * Periodically publishes the CPU load, the CPU and stack use of each task
+ * and the perf counters that spent the most time, so that they can be logged
+ * and streamed next to the control data.
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+#include <px4_tasks.h>
+#include <px4_workqueue.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <drivers/drv_hrt.h>
+#include <systemlib/err.h>
+#include <systemlib/cpuload.h>
+#include <systemlib/perf_counter.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/cpuload.h>
+#include <uORB/topics/task_stats.h>
+#include <uORB/topics/perf_stats.h>
+
+#ifdef __PX4_NUTTX
+#include <nuttx/sched.h>
+#endif
+
+/* time between two measurements */
+#define LOAD_MON_INTERVAL		1000000
+/* time between two task_stats and perf_stats publications */
+#define LOAD_MON_PUBLISH_INTERVAL	25000
+/* tasks reported, and task slots tracked */
+#define LOAD_MON_MAX_TASKS		32
+#define LOAD_MON_MAX_SLOTS		64
+/* perf counters reported */
+#define LOAD_MON_TOP_PERF		5
+
+struct load_mon_s {
+	struct work_s		work;
+	bool			running;
+
+	hrt_abstime		last_measure;
+	int32_t			slot_pid[LOAD_MON_MAX_SLOTS];
+	uint64_t		slot_runtime[LOAD_MON_MAX_SLOTS];
+
+	struct cpuload_s	cpuload;
+	struct task_stats_s	tasks[LOAD_MON_MAX_TASKS];
+	unsigned		task_count;
+	unsigned		task_next;
+	struct perf_top_s	perf_top[LOAD_MON_TOP_PERF];
+	unsigned		perf_count;
+	unsigned		perf_next;
+
+	orb_advert_t		cpuload_pub;
+	orb_advert_t		task_stats_pub;
+	orb_advert_t		perf_stats_pub;
+};
+
+static struct load_mon_s *load_mon;
+
+__EXPORT int load_mon_main(int argc, char *argv[]);
+
+static void load_mon_cycle(void *arg);
+
+#ifdef __PX4_NUTTX
+extern struct system_load_s system_load;
+#endif
+
+/*
+ * CPU time a task used since the previous measurement, all of it if the
+ * slot holds a task that was not there before.
+ */
+static uint64_t
+load_mon_runtime_delta(struct load_mon_s *lm, unsigned slot, int32_t pid, uint64_t runtime)
+{
+	if (slot >= LOAD_MON_MAX_SLOTS) {
+		return 0;
+	}
+
+	uint64_t delta = runtime;
+
+	if (lm->slot_pid[slot] == pid && runtime >= lm->slot_runtime[slot]) {
+		delta = runtime - lm->slot_runtime[slot];
+	}
+
+	lm->slot_pid[slot] = pid;
+	lm->slot_runtime[slot] = runtime;
+
+	return delta;
+}
+
+static void
+load_mon_measure(struct load_mon_s *lm, hrt_abstime now)
+{
+	float interval = (float)(now - lm->last_measure);
+	unsigned count = 0;
+
+#ifdef __PX4_NUTTX
+	uint64_t idle = 0;
+
+	for (int i = 0; i < CONFIG_MAX_TASKS; i++) {
+		if (!system_load.tasks[i].valid) {
+			continue;
+		}
+
+		struct tcb_s *tcb = system_load.tasks[i].tcb;
+		uint64_t delta = load_mon_runtime_delta(lm, i, tcb->pid, system_load.tasks[i].total_runtime);
+
+		if (i == 0) {
+			idle = delta;
+		}
+
+		if (count >= LOAD_MON_MAX_TASKS) {
+			continue;
+		}
+
+		struct task_stats_s *ts = &lm->tasks[count++];
+
+		/* unused stack is still filled with 0xff */
+		unsigned stack_size = (uintptr_t)tcb->adj_stack_ptr - (uintptr_t)tcb->stack_alloc_ptr;
+		unsigned stack_free = 0;
+		uint8_t *stack_sweeper = (uint8_t *)tcb->stack_alloc_ptr;
+
+		while (stack_free < stack_size && *stack_sweeper++ == 0xff) {
+			stack_free++;
+		}
+
+		memset(ts, 0, sizeof(*ts));
+		strncpy(ts->name, tcb->name, sizeof(ts->name));
+		ts->pid = tcb->pid;
+		ts->load = delta / interval;
+		ts->stack_used = stack_size - stack_free;
+		ts->stack_size = stack_size;
+		ts->priority = tcb->sched_priority;
+	}
+
+	lm->cpuload.load = 1.0f - idle / interval;
+#else
+	uint64_t busy = 0;
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+	for (int i = 0;; i++) {
+		char name[sizeof(lm->tasks[0].name)];
+		uint64_t runtime;
+		int ret = px4_task_runtime(i, name, sizeof(name), &runtime);
+
+		if (ret == -EINVAL) {
+			break;
+
+		} else if (ret != 0) {
+			continue;
+		}
+
+		uint64_t delta = load_mon_runtime_delta(lm, i, i, runtime);
+		busy += delta;
+
+		if (count >= LOAD_MON_MAX_TASKS) {
+			continue;
+		}
+
+		struct task_stats_s *ts = &lm->tasks[count++];
+
+		memset(ts, 0, sizeof(*ts));
+		memcpy(ts->name, name, sizeof(ts->name));
+		ts->pid = i;
+		ts->load = delta / interval;
+	}
+
+	lm->cpuload.load = busy / (interval * ((cpus > 0) ? cpus : 1));
+#endif
+
+	for (unsigned i = 0; i < count; i++) {
+		lm->tasks[i].timestamp = now;
+	}
+
+	lm->task_count = count;
+	lm->task_next = 0;
+	lm->cpuload.timestamp = now;
+	lm->cpuload.task_count = count;
+
+	lm->perf_count = perf_top_elapsed(lm->perf_top, LOAD_MON_TOP_PERF);
+	lm->perf_next = 0;
+}
+
+static void
+load_mon_cycle(void *arg)
+{
+	struct load_mon_s *lm = (struct load_mon_s *)arg;
+	hrt_abstime now = hrt_absolute_time();
+
+	if (lm->last_measure == 0) {
+		/* baseline of the runtimes and perf counters, nothing to report yet */
+		load_mon_measure(lm, now);
+		lm->task_count = 0;
+		lm->perf_count = 0;
+		lm->last_measure = now;
+
+	} else if (now - lm->last_measure >= LOAD_MON_INTERVAL) {
+		load_mon_measure(lm, now);
+		lm->last_measure = now;
+
+		if (lm->cpuload_pub == NULL) {
+			lm->cpuload_pub = orb_advertise(ORB_ID(cpuload), &lm->cpuload);
+
+		} else {
+			orb_publish(ORB_ID(cpuload), lm->cpuload_pub, &lm->cpuload);
+		}
+
+	} else {
+		/* one task and one counter at a time, so that a logger polling the topics sees all of them */
+		if (lm->task_next < lm->task_count) {
+			struct task_stats_s *ts = &lm->tasks[lm->task_next++];
+
+			if (lm->task_stats_pub == NULL) {
+				lm->task_stats_pub = orb_advertise(ORB_ID(task_stats), ts);
+
+			} else {
+				orb_publish(ORB_ID(task_stats), lm->task_stats_pub, ts);
+			}
+		}
+
+		if (lm->perf_next < lm->perf_count) {
+			struct perf_top_s *top = &lm->perf_top[lm->perf_next];
+			struct perf_stats_s ps;
+
+			memset(&ps, 0, sizeof(ps));
+			ps.timestamp = lm->last_measure;
+			strncpy(ps.name, top->name, sizeof(ps.name));
+			ps.rank = lm->perf_next++;
+			ps.event_count = top->event_count;
+			ps.elapsed = top->elapsed;
+
+			if (lm->perf_stats_pub == NULL) {
+				lm->perf_stats_pub = orb_advertise(ORB_ID(perf_stats), &ps);
+
+			} else {
+				orb_publish(ORB_ID(perf_stats), lm->perf_stats_pub, &ps);
+			}
+		}
+	}
+
+	if (lm->running) {
+		work_queue(LPWORK, &lm->work, load_mon_cycle, lm, USEC2TICK(LOAD_MON_PUBLISH_INTERVAL));
+	}
+}
+
+static void
+load_mon_status(struct load_mon_s *lm)
+{
+	warnx("cpu load: %.1f%%, %u tasks", (double)(lm->cpuload.load * 100.0f), (unsigned)lm->cpuload.task_count);
+
+	for (unsigned i = 0; i < lm->task_count; i++) {
+		struct task_stats_s *ts = &lm->tasks[i];
+
+		printf("  %4d %-16.16s %5.1f%% stack %5u/%5u\n", (int)ts->pid, ts->name, (double)(ts->load * 100.0f),
+		       (unsigned)ts->stack_used, (unsigned)ts->stack_size);
+	}
+
+	for (unsigned i = 0; i < lm->perf_count; i++) {
+		printf("  %-24s %8lluus %6llu events\n", lm->perf_top[i].name,
+		       (unsigned long long)lm->perf_top[i].elapsed, (unsigned long long)lm->perf_top[i].event_count);
+	}
+}
+
+int
+load_mon_main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		goto usage;
+	}
+
+	if (!strcmp(argv[1], "start")) {
+		if (load_mon != NULL) {
+			warnx("already running");
+			return 1;
+		}
+
+		load_mon = (struct load_mon_s *)calloc(1, sizeof(struct load_mon_s));
+
+		if (load_mon == NULL) {
+			warnx("alloc failed");
+			return 1;
+		}
+
+		load_mon->running = true;
+		work_queue(LPWORK, &load_mon->work, load_mon_cycle, load_mon, 0);
+		return 0;
+	}
+
+	if (!strcmp(argv[1], "stop")) {
+		if (load_mon == NULL) {
+			warnx("not running");
+			return 1;
+		}
+
+		load_mon->running = false;
+		work_cancel(LPWORK, &load_mon->work);
+
+		/* a cycle that was already running does not queue itself again, let it finish */
+		usleep(LOAD_MON_PUBLISH_INTERVAL);
+
+		free(load_mon);
+		load_mon = NULL;
+		return 0;
+	}
+
+	if (!strcmp(argv[1], "status")) {
+		if (load_mon == NULL) {
+			warnx("not running");
+			return 1;
+		}
+
+		load_mon_status(load_mon);
+		return 0;
+	}
+
+usage:
+	warnx("usage: load_mon {start|stop|status}");
+	return 1;
+}
@@ -54,16 +54,37 @@ int buf_size_2 = 0;
 MavlinkFTP::MavlinkFTP(Mavlink* mavlink) :
 	MavlinkStream(mavlink),
 	_session_info{},
+	_read_ahead_buffer(nullptr),
+	_write_buffer(nullptr),
+	_crc_info{},
+	_list_cache(nullptr),
+	_list_cache_path{},
+	_list_cache_hidden(false),
+	_list_cache_complete(false),
+	_list_cache_length(0),
+	_list_cache_count(0),
 	_utRcvMsgFunc{},
 	_worker_data{}
 {
 	// initialize session
 	_session_info.fd = -1;
+	_crc_info.fd = -1;
 }
 
 MavlinkFTP::~MavlinkFTP()
 {
-	
+	if (_session_info.fd >= 0) {
+		// do not lose acknowledged upload data
+		_flushWriteBuffer();
+	}
+
+	if (_crc_info.fd >= 0) {
+		::close(_crc_info.fd);
+	}
+
+	delete[] _read_ahead_buffer;
+	delete[] _write_buffer;
+	delete[] _list_cache;
 }
 
 const char*
@@ -89,6 +110,12 @@ MavlinkFTP::get_size(void)
 	}
 }
 
+MavlinkStream::Priority
+MavlinkFTP::get_priority(void)
+{
+	return PRIORITY_DEBUG;
+}
+
 MavlinkStream*
 MavlinkFTP::new_instance(Mavlink *mavlink)
 {
@@ -179,6 +206,17 @@ MavlinkFTP::_process_request(mavlink_file_transfer_protocol_t* ftp_req, uint8_t
 	printf("ftp: channel %u opc %u size %u offset %u\n", _getServerChannel(), payload->opcode, payload->size, payload->offset);
 #endif
 
+	// Buffered upload data has to be in the file before any other command looks at it,
+	// a failure is reported by the terminate of the session
+	if (payload->opcode != kCmdWriteFile && _session_info.write_range_count > 0) {
+		_flushWriteBuffer();
+	}
+
+	// Any other command may change the directory being listed
+	if (payload->opcode != kCmdListDirectory) {
+		_list_cache_path[0] = '\0';
+	}
+
 	switch (payload->opcode) {
 	case kCmdNone:
 		break;
@@ -241,7 +279,8 @@ MavlinkFTP::_process_request(mavlink_file_transfer_protocol_t* ftp_req, uint8_t
 		break;
 			
 	case kCmdCalcFileCRC32:
-		errorCode = _workCalcFileCRC32(payload);
+		errorCode = _workCalcFileCRC32(payload, target_system_id);
+		stream_send = true;
 		break;
 
 	default:
@@ -268,7 +307,7 @@ out:
 		}
 	}
 
-	// Stream download replies are sent through mavlink stream mechanism. Unless we need to Nak.
+	// Stream download and CRC replies are sent through mavlink stream mechanism. Unless we need to Nak.
 	if (!stream_send || errorCode != kErrNone) {
 		// respond to the request
 		ftp_req->target_system = target_system_id;
@@ -297,7 +336,8 @@ MavlinkFTP::_reply(mavlink_file_transfer_protocol_t* ftp_req)
 
 }
 
-/// @brief Responds to a List command
+/// @brief Responds to a List command. The entries of a directory are read into the list cache with
+/// the first page, so the following pages do not open and scan the directory and stat every file again.
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workList(PayloadHeader* payload, bool list_hidden)
 {
@@ -306,6 +346,57 @@ MavlinkFTP::_workList(PayloadHeader* payload, bool list_hidden)
 
 	ErrorCode errorCode = kErrNone;
 	unsigned offset = 0;
+	unsigned entry_index = payload->offset;
+
+#ifdef MAVLINK_FTP_DEBUG
+	warnx("FTP: list %s offset %d", dirPath, payload->offset);
+#endif
+
+	bool cached = payload->offset != 0 && _list_cache_path[0] != '\0' &&
+		      strcmp(dirPath, _list_cache_path) == 0 && list_hidden == _list_cache_hidden;
+
+	if (!cached) {
+		cached = _fillListCache(dirPath, list_hidden);
+	}
+
+	if (cached) {
+		// Skip the entries the client already has
+		const char *entry = _list_cache;
+		unsigned i = 0;
+
+		for (; i < entry_index && i < _list_cache_count; i++) {
+			entry += strlen(entry + 1) + 2;
+		}
+
+		for (; i < _list_cache_count; i++) {
+			size_t entryLen = strlen(entry + 1) + 2;
+
+			if ((offset + entryLen) > kMaxDataLength) {
+				payload->size = offset;
+				return kErrNone;
+			}
+
+			memcpy(&payload->data[offset], entry, entryLen);
+			offset += entryLen;
+			entry += entryLen;
+		}
+
+		if (_list_cache_complete) {
+			if (payload->offset != 0 && offset == 0) {
+				// User is requesting subsequent dir entries but there were none. This means the user asked
+				// to seek past EOF.
+				errorCode = kErrEOF;
+			}
+
+			payload->size = offset;
+			return errorCode;
+		}
+
+		// Continue with the entries which did not fit into the cache
+		if (entry_index < i) {
+			entry_index = i;
+		}
+	}
 
 	DIR *dp = opendir(dirPath);
 
@@ -320,18 +411,14 @@ MavlinkFTP::_workList(PayloadHeader* payload, bool list_hidden)
 		return kErrEOF;
 	}
 
-#ifdef MAVLINK_FTP_DEBUG
-	warnx("FTP: list %s offset %d", dirPath, payload->offset);
-#endif
-
-	struct dirent entry, *result = nullptr;
-
 	// move to the requested offset
-	seekdir(dp, payload->offset);
+	seekdir(dp, entry_index);
 
 	for (;;) {
-		// read the directory entry
-		if (readdir_r(dp, &entry, &result)) {
+		char entry[kMaxDataLength];
+		int entryLen = _readListEntry(dp, dirPath, list_hidden, entry, sizeof(entry));
+
+		if (entryLen < 0) {
 #ifdef MAVLINK_FTP_UNIT_TEST
 		warnx("readdir_r failed");
 #else
@@ -349,7 +436,7 @@ MavlinkFTP::_workList(PayloadHeader* payload, bool list_hidden)
 		}
 
 		// no more entries?
-		if (result == nullptr) {
+		if (entryLen == 0) {
 			if (payload->offset != 0 && offset == 0) {
 				// User is requesting subsequent dir entries but there were none. This means the user asked
 				// to seek past EOF.
@@ -359,74 +446,152 @@ MavlinkFTP::_workList(PayloadHeader* payload, bool list_hidden)
 			break;
 		}
 
-		uint32_t fileSize = 0;
-		char buf[256];
-		char direntType;
+		// Do we have room for the name, the one char directory identifier and the null terminator?
+		if ((offset + entryLen) > kMaxDataLength) {
+			break;
+		}
+		
+		// Move the data into the buffer
+		memcpy(&payload->data[offset], entry, entryLen);
+#ifdef MAVLINK_FTP_DEBUG
+		printf("FTP: list %s %s\n", dirPath, (char *)&payload->data[offset]);
+#endif
+		offset += entryLen;
+	}
+
+	closedir(dp);
+	payload->size = offset;
+
+	return errorCode;
+}
+
+/// @brief Reads the next directory entry in the List reply format: the entry type, then for files the
+/// name and the length, for directories the name and nothing for skipped entries, null terminated.
+/// @return length of the entry, 0 past the last entry, -1 on error
+int
+MavlinkFTP::_readListEntry(DIR *dp, const char *dirPath, bool list_hidden, char *entry_buf, unsigned buf_len)
+{
+	struct dirent entry, *result = nullptr;
+
+	// read the directory entry
+	if (readdir_r(dp, &entry, &result)) {
+		return -1;
+	}
+
+	if (result == nullptr) {
+		return 0;
+	}
 
-		// Determine the directory entry type
-		switch (entry.d_type) {
+	uint32_t fileSize = 0;
+	char buf[256];
+	char direntType;
+
+	// Determine the directory entry type
+	switch (entry.d_type) {
 #ifdef __PX4_NUTTX
-		case DTYPE_FILE:
+	case DTYPE_FILE:
 #else
-		case DT_REG:
+	case DT_REG:
 #endif
-			// For files we get the file size as well
-			direntType = kDirentFile;
-			snprintf(buf, sizeof(buf), "%s/%s", dirPath, entry.d_name);
-			struct stat st;
-			if (stat(buf, &st) == 0) {
-				fileSize = st.st_size;
-			}
-			break;
+		// For files we get the file size as well
+		direntType = kDirentFile;
+		snprintf(buf, sizeof(buf), "%s/%s", dirPath, entry.d_name);
+		struct stat st;
+		if (stat(buf, &st) == 0) {
+			fileSize = st.st_size;
+		}
+		break;
 #ifdef __PX4_NUTTX
-		case DTYPE_DIRECTORY:
+	case DTYPE_DIRECTORY:
 #else
-		case DT_DIR:
+	case DT_DIR:
 #endif
-			if ((!list_hidden && (strncmp(entry.d_name, ".", 1) == 0)) ||
-				strcmp(entry.d_name, ".") == 0 || strcmp(entry.d_name, "..") == 0) {
-				// Don't bother sending these back
-				direntType = kDirentSkip;
-			} else {
-				direntType = kDirentDir;
-			}
-			break;
-		default:
-			// We only send back file and diretory entries, skip everything else
+		if ((!list_hidden && (strncmp(entry.d_name, ".", 1) == 0)) ||
+			strcmp(entry.d_name, ".") == 0 || strcmp(entry.d_name, "..") == 0) {
+			// Don't bother sending these back
 			direntType = kDirentSkip;
-		}
-		
-		if (direntType == kDirentSkip) {
-			// Skip send only dirent identifier
-			buf[0] = '\0';
-		} else if (direntType == kDirentFile) {
-			// Files send filename and file length
-			snprintf(buf, sizeof(buf), "%s\t%d", entry.d_name, fileSize);
 		} else {
-			// Everything else just sends name
-			strncpy(buf, entry.d_name, sizeof(buf));
-			buf[sizeof(buf)-1] = 0;
+			direntType = kDirentDir;
+		}
+		break;
+	default:
+		// We only send back file and diretory entries, skip everything else
+		direntType = kDirentSkip;
+	}
+	
+	if (direntType == kDirentSkip) {
+		// Skip send only dirent identifier
+		buf[0] = '\0';
+	} else if (direntType == kDirentFile) {
+		// Files send filename and file length
+		snprintf(buf, sizeof(buf), "%s\t%d", entry.d_name, fileSize);
+	} else {
+		// Everything else just sends name
+		strncpy(buf, entry.d_name, sizeof(buf));
+		buf[sizeof(buf)-1] = 0;
+	}
+
+	// Cut a name too long for a reply, it could never be sent
+	unsigned nameLen = strnlen(buf, buf_len - 2);
+
+	entry_buf[0] = direntType;
+	memcpy(&entry_buf[1], buf, nameLen);
+	entry_buf[nameLen + 1] = '\0';
+
+	return nameLen + 2;
+}
+
+/// @brief Reads the entries of a directory into the list cache, as many as fit.
+/// @return false if the directory could not be opened or there is no memory for the cache
+bool
+MavlinkFTP::_fillListCache(const char *dirPath, bool list_hidden)
+{
+	_list_cache_path[0] = '\0';
+
+	if (_list_cache == nullptr) {
+		_list_cache = new char[kListCacheSize];
+
+		if (_list_cache == nullptr) {
+			return false;
 		}
-		size_t nameLen = strlen(buf);
+	}
 
-		// Do we have room for the name, the one char directory identifier and the null terminator?
-		if ((offset + nameLen + 2) > kMaxDataLength) {
+	DIR *dp = opendir(dirPath);
+
+	if (dp == nullptr) {
+		return false;
+	}
+
+	_list_cache_length = 0;
+	_list_cache_count = 0;
+	_list_cache_complete = false;
+
+	for (;;) {
+		char entry[kMaxDataLength];
+		int entryLen = _readListEntry(dp, dirPath, list_hidden, entry, sizeof(entry));
+
+		if (entryLen == 0) {
+			_list_cache_complete = true;
 			break;
 		}
-		
-		// Move the data into the buffer
-		payload->data[offset++] = direntType;
-		strcpy((char *)&payload->data[offset], buf);
-#ifdef MAVLINK_FTP_DEBUG
-		printf("FTP: list %s %s\n", dirPath, (char *)&payload->data[offset-1]);
-#endif
-		offset += nameLen + 1;
+
+		// On an error the rest is read from the directory, which reports it
+		if (entryLen < 0 || _list_cache_length + entryLen > kListCacheSize) {
+			break;
+		}
+
+		memcpy(&_list_cache[_list_cache_length], entry, entryLen);
+		_list_cache_length += entryLen;
+		_list_cache_count++;
 	}
 
 	closedir(dp);
-	payload->size = offset;
 
-	return errorCode;
+	strncpy(_list_cache_path, dirPath, sizeof(_list_cache_path));
+	_list_cache_path[sizeof(_list_cache_path) - 1] = '\0';
+	_list_cache_hidden = list_hidden;
+
+	return true;
 }
 
 /// @brief Responds to an Open command
@@ -463,6 +628,10 @@ MavlinkFTP::_workOpen(PayloadHeader* payload, int oflag)
 	_session_info.fd = fd;
 	_session_info.file_size = fileSize;
 	_session_info.stream_download = false;
+	_session_info.read_ahead_length = 0;
+	_session_info.writable = (oflag & O_WRONLY) != 0;
+	_session_info.write_range_count = 0;
+	_session_info.write_errno = 0;
 
 	payload->session = 0;
 	payload->size = sizeof(uint32_t);
@@ -488,12 +657,7 @@ MavlinkFTP::_workRead(PayloadHeader* payload)
 		return kErrEOF;
 	}
 		
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-		warnx("seek fail");
-		return kErrFailErrno;
-	}
-
-	int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+	int bytes_read = _readFileData(payload->offset, &payload->data[0], kMaxDataLength);
 	if (bytes_read < 0) {
 		// Negative return indicates error other than eof
 		warnx("read fail %d", bytes_read);
@@ -505,6 +669,59 @@ MavlinkFTP::_workRead(PayloadHeader* payload)
 	return kErrNone;
 }
 
+/// @brief Reads session file data through the read ahead buffer, so a burst or re-requested
+/// packets near the current download position do not cost a seek and a read each.
+/// @return bytes copied to data, 0 at EOF, -1 on error with errno set
+int
+MavlinkFTP::_readFileData(uint32_t offset, uint8_t *data, unsigned len)
+{
+	if (_read_ahead_buffer == nullptr) {
+		_read_ahead_buffer = new uint8_t[kReadAheadSize];
+
+		if (_read_ahead_buffer == nullptr) {
+			// Read directly if we are out of memory
+			if (lseek(_session_info.fd, offset, SEEK_SET) < 0) {
+				return -1;
+			}
+
+			return ::read(_session_info.fd, data, len);
+		}
+	}
+
+	uint32_t buffer_end = _session_info.read_ahead_offset + _session_info.read_ahead_length;
+	bool buffer_at_eof = _session_info.read_ahead_length < kReadAheadSize;
+
+	if (offset < _session_info.read_ahead_offset || offset > buffer_end || _session_info.read_ahead_length == 0 ||
+	    (offset + len > buffer_end && !buffer_at_eof)) {
+		// Refill the buffer starting at the requested offset
+		_session_info.read_ahead_length = 0;
+
+		if (lseek(_session_info.fd, offset, SEEK_SET) < 0) {
+			return -1;
+		}
+
+		int bytes_read = ::read(_session_info.fd, _read_ahead_buffer, kReadAheadSize);
+
+		if (bytes_read < 0) {
+			return -1;
+		}
+
+		_session_info.read_ahead_offset = offset;
+		_session_info.read_ahead_length = bytes_read;
+		buffer_end = offset + bytes_read;
+	}
+
+	unsigned available = buffer_end - offset;
+
+	if (len > available) {
+		len = available;
+	}
+
+	memcpy(data, &_read_ahead_buffer[offset - _session_info.read_ahead_offset], len);
+
+	return len;
+}
+
 /// @brief Responds to a Stream command
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workBurst(PayloadHeader* payload, uint8_t target_system_id)
@@ -534,25 +751,177 @@ MavlinkFTP::_workWrite(PayloadHeader* payload)
 		return kErrInvalidSession;
 	}
 
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-		// Unable to see to the specified location
-		warnx("seek fail");
+	if (!_session_info.writable) {
+		errno = EBADF;
 		return kErrFailErrno;
 	}
 
-	int bytes_written = ::write(_session_info.fd, &payload->data[0], payload->size);
-	if (bytes_written < 0) {
-		// Negative return indicates error other than eof
-		warnx("write fail %d", bytes_written);
+	// Report a failure of earlier buffered data, the client has to restart or resume the upload
+	if (_session_info.write_errno != 0) {
+		errno = _session_info.write_errno;
+		_session_info.write_errno = 0;
+		return kErrFailErrno;
+	}
+
+	if (_writeFileData(payload->offset, &payload->data[0], payload->size) < 0) {
+		warnx("write fail");
 		return kErrFailErrno;
 	}
 
+	uint32_t bytes_written = payload->size;
 	payload->size = sizeof(uint32_t);
 	*((uint32_t*)payload->data) = bytes_written;
 
 	return kErrNone;
 }
 
+/// @brief Collects upload data in the write buffer, which covers one aligned kWriteBufferSize chunk
+/// of the file. It is written out once the chunk is complete or a write falls outside of it, so
+/// the SD sees whole sectors instead of a seek and a write per packet. Packets arriving out of
+/// order or re-sent within the chunk are merged in place.
+/// @return 0, -1 on error with errno set
+int
+MavlinkFTP::_writeFileData(uint32_t offset, const uint8_t *data, unsigned len)
+{
+	if (_write_buffer == nullptr) {
+		_write_buffer = new uint8_t[kWriteBufferSize];
+
+		if (_write_buffer == nullptr) {
+			// Write directly if we are out of memory
+			if (lseek(_session_info.fd, offset, SEEK_SET) < 0) {
+				return -1;
+			}
+
+			return (::write(_session_info.fd, data, len) == (ssize_t)len) ? 0 : -1;
+		}
+	}
+
+	while (len > 0) {
+		uint32_t chunk_offset = offset - offset % kWriteBufferSize;
+
+		if (chunk_offset != _session_info.write_buffer_offset && _session_info.write_range_count > 0) {
+			if (_flushWriteBuffer() < 0) {
+				return -1;
+			}
+		}
+
+		_session_info.write_buffer_offset = chunk_offset;
+
+		unsigned start = offset - chunk_offset;
+		unsigned count = kWriteBufferSize - start;
+
+		if (count > len) {
+			count = len;
+		}
+
+		if (!_addWriteRange(start, start + count)) {
+			// Too many gaps, write out what we have and start over
+			if (_flushWriteBuffer() < 0) {
+				return -1;
+			}
+
+			_addWriteRange(start, start + count);
+		}
+
+		memcpy(&_write_buffer[start], data, count);
+
+		if (_session_info.write_range_count == 1 && _session_info.write_ranges[0].start == 0 &&
+		    _session_info.write_ranges[0].end == kWriteBufferSize) {
+			if (_flushWriteBuffer() < 0) {
+				return -1;
+			}
+		}
+
+		offset += count;
+		data += count;
+		len -= count;
+	}
+
+	return 0;
+}
+
+/// @brief Adds [start, end) to the ranges of the write buffer, merging it with any range it overlaps or touches
+/// @return false if the range would need a slot and all are taken
+bool
+MavlinkFTP::_addWriteRange(unsigned start, unsigned end)
+{
+	WriteRange *ranges = _session_info.write_ranges;
+	unsigned count = _session_info.write_range_count;
+
+	// Skip the ranges ending before the new one
+	unsigned first = 0;
+
+	while (first < count && ranges[first].end < start) {
+		first++;
+	}
+
+	// Find the ranges the new one overlaps or touches
+	unsigned last = first;
+
+	while (last < count && ranges[last].start <= end) {
+		if (ranges[last].start < start) {
+			start = ranges[last].start;
+		}
+
+		if (ranges[last].end > end) {
+			end = ranges[last].end;
+		}
+
+		last++;
+	}
+
+	if (last == first) {
+		if (count == kWriteRanges) {
+			return false;
+		}
+
+		memmove(&ranges[first + 1], &ranges[first], (count - first) * sizeof(ranges[0]));
+		count++;
+
+	} else {
+		memmove(&ranges[first + 1], &ranges[last], (count - last) * sizeof(ranges[0]));
+		count -= last - first - 1;
+	}
+
+	ranges[first].start = start;
+	ranges[first].end = end;
+	_session_info.write_range_count = count;
+
+	return true;
+}
+
+/// @brief Writes the data in the write buffer to the session file. On a failure the data
+/// is dropped and the error kept in write_errno.
+/// @return 0, -1 on error with errno set
+int
+MavlinkFTP::_flushWriteBuffer(void)
+{
+	int ret = 0;
+
+	for (unsigned i = 0; i < _session_info.write_range_count; i++) {
+		const WriteRange &range = _session_info.write_ranges[i];
+		ssize_t len = range.end - range.start;
+
+		errno = 0;
+
+		if (lseek(_session_info.fd, _session_info.write_buffer_offset + range.start, SEEK_SET) < 0 ||
+		    ::write(_session_info.fd, &_write_buffer[range.start], len) != len) {
+			if (errno == 0) {
+				// short write
+				errno = ENOSPC;
+			}
+
+			_session_info.write_errno = errno;
+			ret = -1;
+			break;
+		}
+	}
+
+	_session_info.write_range_count = 0;
+
+	return ret;
+}
+
 /// @brief Responds to a RemoveFile command
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workRemoveFile(PayloadHeader* payload)
@@ -650,6 +1019,9 @@ MavlinkFTP::_workTerminate(PayloadHeader* payload)
 	if (payload->session != 0 || _session_info.fd < 0) {
 		return kErrInvalidSession;
 	}
+
+	_flushWriteBuffer();
+	int write_errno = _session_info.write_errno;
 	
 	::close(_session_info.fd);
 	_session_info.fd = -1;
@@ -657,6 +1029,12 @@ MavlinkFTP::_workTerminate(PayloadHeader* payload)
 	
 	payload->size = 0;
 
+	if (write_errno != 0) {
+		// part of the upload did not make it to the file
+		errno = write_errno;
+		return kErrFailErrno;
+	}
+
 	return kErrNone;
 }
 
@@ -664,7 +1042,13 @@ MavlinkFTP::_workTerminate(PayloadHeader* payload)
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workReset(PayloadHeader* payload)
 {
+	if (_crc_info.fd >= 0) {
+		::close(_crc_info.fd);
+		_crc_info.fd = -1;
+	}
+
 	if (_session_info.fd != -1) {
+		_flushWriteBuffer();
 		::close(_session_info.fd);
 		_session_info.fd = -1;
 		_session_info.stream_download = false;
@@ -732,37 +1116,99 @@ MavlinkFTP::_workCreateDirectory(PayloadHeader* payload)
 	}
 }
 
-/// @brief Responds to a CalcFileCRC32 command
+/// @brief Responds to a CalcFileCRC32 command. The file is checksummed in steps from send(), which
+/// also sends the reply, a new request replaces one still in progress.
 MavlinkFTP::ErrorCode
-MavlinkFTP::_workCalcFileCRC32(PayloadHeader* payload)
+MavlinkFTP::_workCalcFileCRC32(PayloadHeader* payload, uint8_t target_system_id)
 {
-	char file_buf[256];
-	uint32_t checksum = 0;
-	ssize_t bytes_read;
-	strncpy(file_buf, _data_as_cstring(payload), kMaxDataLength);
+	char file[kMaxDataLength];
+	strncpy(file, _data_as_cstring(payload), kMaxDataLength);
+
+	if (_crc_info.fd >= 0) {
+		::close(_crc_info.fd);
+		_crc_info.fd = -1;
+	}
 
-	int fd = ::open(file_buf, O_RDONLY);
+	int fd = ::open(file, O_RDONLY);
 	if (fd < 0) {
 		return kErrFailErrno;
 	}
 
-	do {
-		bytes_read = ::read(fd, file_buf, sizeof(file_buf));
+	_crc_info.fd = fd;
+	_crc_info.checksum = 0;
+	// a length lets a client compare the part of an interrupted upload that made it, to resume after it
+	_crc_info.remaining = (payload->offset != 0) ? payload->offset : UINT32_MAX;
+	_crc_info.seq_number = payload->seq_number + 1;
+	_crc_info.target_system_id = target_system_id;
+
+	return kErrNone;
+}
+
+/// @brief Checksums the next part of the CalcFileCRC32 file, sends the reply once done
+void
+MavlinkFTP::_stepCalcFileCRC32(void)
+{
+	uint8_t file_buf[256];
+#ifndef MAVLINK_FTP_UNIT_TEST
+	unsigned budget = kCrcBytesPerSend;
+#endif
+	ErrorCode error_code = kErrNone;
+	bool done = false;
+
+	while (!done) {
+		size_t to_read = (_crc_info.remaining < sizeof(file_buf)) ? _crc_info.remaining : sizeof(file_buf);
+		ssize_t bytes_read = ::read(_crc_info.fd, file_buf, to_read);
+
 		if (bytes_read < 0) {
-			int r_errno = errno;
-			::close(fd);
-			errno = r_errno;
-			return kErrFailErrno;
+			error_code = kErrFailErrno;
+			break;
 		}
 
-		checksum = crc32part((uint8_t*)file_buf, bytes_read, checksum);
-	} while (bytes_read == sizeof(file_buf));
+		_crc_info.checksum = crc32part(file_buf, bytes_read, _crc_info.checksum);
+		_crc_info.remaining -= bytes_read;
+		done = bytes_read < (ssize_t)sizeof(file_buf) || _crc_info.remaining == 0;
 
-	::close(fd);
+#ifndef MAVLINK_FTP_UNIT_TEST
+		// Leave the rest to the next iteration of the mavlink task
+		if (budget <= sizeof(file_buf)) {
+			break;
+		}
 
-	payload->size = sizeof(uint32_t);
-	*((uint32_t*)payload->data) = checksum;
-	return kErrNone;
+		budget -= sizeof(file_buf);
+#endif
+	}
+
+	if (!done && error_code == kErrNone) {
+		return;
+	}
+
+	mavlink_file_transfer_protocol_t ftp_msg;
+	PayloadHeader* payload = reinterpret_cast<PayloadHeader *>(&ftp_msg.payload[0]);
+
+	payload->seq_number = _crc_info.seq_number;
+	payload->session = 0;
+	payload->req_opcode = kCmdCalcFileCRC32;
+	payload->burst_complete = 0;
+	payload->padding = 0;
+	payload->offset = 0;
+
+	if (error_code == kErrNone) {
+		payload->opcode = kRspAck;
+		payload->size = sizeof(uint32_t);
+		*((uint32_t*)payload->data) = _crc_info.checksum;
+	} else {
+		int r_errno = errno;
+		payload->opcode = kRspNak;
+		payload->size = 2;
+		payload->data[0] = error_code;
+		payload->data[1] = r_errno;
+	}
+
+	::close(_crc_info.fd);
+	_crc_info.fd = -1;
+
+	ftp_msg.target_system = _crc_info.target_system_id;
+	_reply(&ftp_msg);
 }
 
 /// @brief Guarantees that the payload data is null terminated.
@@ -841,14 +1287,24 @@ MavlinkFTP::_copy_file(const char *src_path, const char *dst_path, size_t length
 
 void MavlinkFTP::send(const hrt_abstime t)
 {
+	if (_crc_info.fd >= 0) {
+		_stepCalcFileCRC32();
+	}
+
 	// Anything to stream?
 	if (!_session_info.stream_download) {
 		return;
 	}
 	
 #ifndef MAVLINK_FTP_UNIT_TEST
-	// Skip send if not enough room
+	// Skip send if not enough room, either in the buffer or in the link budget
 	unsigned max_bytes_to_send = _mavlink->get_free_tx_buf();
+	unsigned tx_budget = _mavlink->get_tx_budget();
+
+	if (tx_budget < max_bytes_to_send) {
+		max_bytes_to_send = tx_budget;
+	}
+
 #ifdef MAVLINK_FTP_DEBUG
     warnx("MavlinkFTP::send max_bytes_to_send(%d) get_free_tx_buf(%d)", max_bytes_to_send, _mavlink->get_free_tx_buf());
 #endif
@@ -887,16 +1343,7 @@ void MavlinkFTP::send(const hrt_abstime t)
 		}
 		
 		if (error_code == kErrNone) {
-			if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-				error_code = kErrFailErrno;
-#ifdef MAVLINK_FTP_DEBUG
-				warnx("stream download: seek fail");
-#endif
-			}
-		}
-		
-		if (error_code == kErrNone) {
-			int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+			int bytes_read = _readFileData(payload->offset, &payload->data[0], kMaxDataLength);
 			if (bytes_read < 0) {
 				// Negative return indicates error other than eof
 				error_code = kErrFailErrno;
@@ -925,8 +1372,8 @@ void MavlinkFTP::send(const hrt_abstime t)
 #ifndef MAVLINK_FTP_UNIT_TEST
 			if (max_bytes_to_send < (get_size()*2)) {
 				more_data = false;
-				/* perform transfers in 35K chunks - this is determined empirical */
-				if (_session_info.stream_chunk_transmitted > 35000) {
+				/* perform transfers in chunks, the client requests the next one (or missing offsets) after completion */
+				if (_session_info.stream_chunk_transmitted > kBurstWindowSize) {
 					payload->burst_complete = true;
 					_session_info.stream_download = false;
 					_session_info.stream_chunk_transmitted = 0;
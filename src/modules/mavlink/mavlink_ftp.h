@@ -98,7 +98,7 @@ public:
 		kCmdOpenFileWO,		///< Opens file at <path> for writing, returns <session>
 		kCmdTruncateFile,	///< Truncate file at <path> to <offset> length
 		kCmdRename,		///< Rename <path1> to <path2>
-		kCmdCalcFileCRC32,	///< Calculate CRC32 for file at <path>
+		kCmdCalcFileCRC32,	///< Calculate CRC32 for file at <path>, of its first <offset> bytes if not zero
 		kCmdBurstReadFile,	///< Burst download session file
 		
 		kRspAck = 128,		///< Ack response
@@ -122,6 +122,7 @@ public:
 	virtual const char *get_name(void) const;
 	virtual uint8_t get_id(void);
 	virtual unsigned get_size(void);
+	virtual Priority get_priority(void);
 	
 private:
 	char		*_data_as_cstring(PayloadHeader* payload);
@@ -142,7 +143,14 @@ private:
 	ErrorCode	_workRemoveFile(PayloadHeader *payload);
 	ErrorCode	_workTruncateFile(PayloadHeader *payload);
 	ErrorCode	_workRename(PayloadHeader *payload);
-	ErrorCode	_workCalcFileCRC32(PayloadHeader *payload);
+	ErrorCode	_workCalcFileCRC32(PayloadHeader *payload, uint8_t target_system_id);
+	void		_stepCalcFileCRC32(void);
+	int		_readListEntry(DIR *dp, const char *dirPath, bool list_hidden, char *entry_buf, unsigned buf_len);
+	bool		_fillListCache(const char *dirPath, bool list_hidden);
+	int		_readFileData(uint32_t offset, uint8_t *data, unsigned len);
+	int		_writeFileData(uint32_t offset, const uint8_t *data, unsigned len);
+	bool		_addWriteRange(unsigned start, unsigned end);
+	int		_flushWriteBuffer(void);
 	
 	uint8_t _getServerSystemId(void);
 	uint8_t _getServerComponentId(void);
@@ -157,6 +165,30 @@ private:
 	
 	/// @brief Maximum data size in RequestHeader::data
 	static const uint8_t	kMaxDataLength = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(PayloadHeader);
+
+	/// @brief Bytes read from the session file at once while downloading
+	static const unsigned	kReadAheadSize = 2048;
+
+	/// @brief Bytes sent before a burst is completed and the client has to request the next one
+	static const unsigned	kBurstWindowSize = 35000;
+
+	/// @brief Bytes of an upload collected before they are written to the session file, a multiple of the SD sector size
+	static const unsigned	kWriteBufferSize = 2048;
+
+	/// @brief Separate ranges of out of order upload data the write buffer can hold
+	static const unsigned	kWriteRanges = 4;
+
+	/// @brief Bytes checksummed per send() while answering a CalcFileCRC32, so a large log does not stall the mavlink task
+	static const unsigned	kCrcBytesPerSend = 4096;
+
+	/// @brief Bytes of directory entries kept to answer the following pages of a List without a rescan
+	static const unsigned	kListCacheSize = 2048;
+
+	/// @brief Range of valid data in the write buffer, relative to write_buffer_offset
+	struct WriteRange {
+		uint16_t	start;
+		uint16_t	end;
+	};
 	
 	struct SessionInfo {
 		int		fd;
@@ -166,8 +198,33 @@ private:
 		uint16_t	stream_seq_number;
 		uint8_t		stream_target_system_id;
 		unsigned	stream_chunk_transmitted;
+		uint32_t	read_ahead_offset;	///< file offset of _read_ahead_buffer
+		unsigned	read_ahead_length;	///< valid bytes in _read_ahead_buffer
+		bool		writable;		///< session was opened for writing
+		uint32_t	write_buffer_offset;	///< file offset of _write_buffer, a multiple of kWriteBufferSize
+		unsigned	write_range_count;	///< ranges of data in _write_buffer not yet written to the file
+		WriteRange	write_ranges[kWriteRanges];	///< sorted and not touching each other
+		int		write_errno;		///< errno of a failed buffered write, reported with the next write or terminate
 	};
 	struct SessionInfo _session_info;	///< Session info, fd=-1 for no active session
+	uint8_t			*_read_ahead_buffer;	///< Allocated with the first download
+	uint8_t			*_write_buffer;		///< Allocated with the first upload
+
+	struct CrcInfo {
+		int		fd;			///< file being checksummed, -1 if none
+		uint32_t	checksum;
+		uint32_t	remaining;		///< bytes left to checksum
+		uint16_t	seq_number;		///< sequence number of the request
+		uint8_t		target_system_id;	///< system to reply to
+	};
+	struct CrcInfo		_crc_info;		///< CalcFileCRC32 in progress, answered from send()
+
+	char			*_list_cache;		///< Entries of the last listed directory in the List reply format, allocated with the first List
+	char			_list_cache_path[kMaxDataLength];	///< directory in _list_cache, empty if none
+	bool			_list_cache_hidden;	///< _list_cache includes the hidden directories
+	bool			_list_cache_complete;	///< _list_cache holds all entries of the directory
+	unsigned		_list_cache_length;	///< bytes used in _list_cache
+	unsigned		_list_cache_count;	///< entries in _list_cache
 	
 	ReceiveMessageFunc_t	_utRcvMsgFunc;	///< Unit test override for mavlink message sending
 	void			*_worker_data;	///< Additional parameter to _utRcvMsgFunc;
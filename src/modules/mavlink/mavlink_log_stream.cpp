@@ -0,0 +1,227 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_log_stream.cpp
+ * Live log streaming, see mavlink_log_stream.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mavlink_log_stream.h"
+#include "mavlink_main.h"
+
+MavlinkLogStream::MavlinkLogStream(Mavlink *mavlink) : MavlinkStream(mavlink),
+	_sub(-1),
+	_streaming(false),
+	_repeat_pending(false),
+	_repeat_offset(0),
+	_repeat_count(0),
+	_history(nullptr),
+	_history_start(0),
+	_history_end(0),
+	_log_id(0),
+	_chunk{},
+	_chunk_sent(0)
+{
+}
+
+MavlinkLogStream::~MavlinkLogStream()
+{
+	if (_sub >= 0) {
+		orb_unsubscribe(_sub);
+	}
+
+	free(_history);
+}
+
+unsigned
+MavlinkLogStream::get_size()
+{
+	return _streaming ? MAVLINK_MSG_ID_LOG_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
+}
+
+void
+MavlinkLogStream::handle_message(const mavlink_message_t *msg)
+{
+	switch (msg->msgid) {
+	case MAVLINK_MSG_ID_LOG_REQUEST_DATA: {
+			mavlink_log_request_data_t req;
+			mavlink_msg_log_request_data_decode(msg, &req);
+
+			if (req.target_system != _mavlink->get_system_id()) {
+				break;
+			}
+
+			if (req.id == kLiveLogId) {
+				_streaming = true;
+
+			} else if (_streaming && req.id == _log_id) {
+				/* a newer request replaces one that is still pending */
+				_repeat_pending = false;
+				_repeat_offset = req.ofs;
+				_repeat_count = req.count;
+				_repeat_pending = true;
+			}
+
+			break;
+		}
+
+	case MAVLINK_MSG_ID_LOG_REQUEST_END: {
+			mavlink_log_request_end_t req;
+			mavlink_msg_log_request_end_decode(msg, &req);
+
+			if (req.target_system == _mavlink->get_system_id()) {
+				_streaming = false;
+				_repeat_pending = false;
+			}
+
+			break;
+		}
+
+	default:
+		break;
+	}
+}
+
+unsigned
+MavlinkLogStream::send_from_history(uint32_t offset, uint32_t count)
+{
+	uint32_t first = (_history_end - _history_start > kHistorySize) ? _history_end - kHistorySize : _history_start;
+
+	if (offset < first || offset >= _history_end) {
+		return 0;
+	}
+
+	mavlink_log_data_t msg;
+
+	msg.id = _log_id;
+	msg.ofs = offset;
+	msg.count = sizeof(msg.data);
+
+	if (msg.count > count) {
+		msg.count = count;
+	}
+
+	if (msg.count > _history_end - offset) {
+		msg.count = _history_end - offset;
+	}
+
+	for (unsigned i = 0; i < msg.count; i++) {
+		msg.data[i] = _history[(offset + i) & (kHistorySize - 1)];
+	}
+
+	_mavlink->send_message(MAVLINK_MSG_ID_LOG_DATA, &msg);
+
+	return msg.count;
+}
+
+void
+MavlinkLogStream::send(const hrt_abstime t)
+{
+	if (!_streaming) {
+		return;
+	}
+
+	if (_sub < 0) {
+		_history = (uint8_t *)malloc(kHistorySize);
+
+		if (_history == nullptr) {
+			_streaming = false;
+			return;
+		}
+
+		_sub = orb_subscribe(ORB_ID(log_stream));
+	}
+
+	const unsigned size = get_size();
+
+	/* send until the link budget or the buffer is used up, like an FTP burst */
+	while (_mavlink->get_tx_budget() >= size && _mavlink->get_free_tx_buf() >= size) {
+
+		/* repeats first, they are the oldest data */
+		if (_repeat_pending) {
+			uint32_t offset = _repeat_offset;
+			uint32_t count = _repeat_count;
+			unsigned sent = (count > 0) ? send_from_history(offset, count) : 0;
+
+			if (sent == 0 || sent == count) {
+				_repeat_pending = false;
+
+			} else {
+				_repeat_offset = offset + sent;
+				_repeat_count = count - sent;
+			}
+
+			if (sent > 0) {
+				continue;
+			}
+		}
+
+		if (_chunk_sent >= _chunk.len) {
+			bool updated = false;
+			orb_check(_sub, &updated);
+
+			if (!updated) {
+				break;
+			}
+
+			orb_copy(ORB_ID(log_stream), _sub, &_chunk);
+			_chunk_sent = 0;
+
+			/* a new file or data dropped from the queue starts a new history */
+			if (_chunk.log_id != _log_id || _chunk.offset != _history_end) {
+				_log_id = _chunk.log_id;
+				_history_start = _chunk.offset;
+				_history_end = _chunk.offset;
+			}
+
+			for (unsigned i = 0; i < _chunk.len; i++) {
+				_history[(_history_end + i) & (kHistorySize - 1)] = _chunk.data[i];
+			}
+
+			_history_end += _chunk.len;
+		}
+
+		unsigned n = send_from_history(_chunk.offset + _chunk_sent, _chunk.len - _chunk_sent);
+
+		if (n == 0) {
+			/* the chunk is longer than the history, drop what is not kept */
+			_chunk_sent = _chunk.len;
+
+		} else {
+			_chunk_sent += n;
+		}
+	}
+}
@@ -0,0 +1,129 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_log_stream.h
+ * Live log streaming: sends the data sdlog2 writes to its log file as LOG_DATA.
+ *
+ * A LOG_REQUEST_DATA with id kLiveLogId starts the stream, LOG_REQUEST_END
+ * stops it. LOG_DATA carries the number of the log file since boot as id
+ * and the file offset, so the receiver can detect lost data and request it
+ * again with a LOG_REQUEST_DATA for that id, offset and count. Only the
+ * last kHistorySize bytes sent can be repeated. The log header is not
+ * streamed, it can be read from the log file with MAVLink FTP.
+ *
+ * sdlog2 has to be started with -s to publish the log data.
+ */
+
+#pragma once
+
+#include <uORB/uORB.h>
+#include <uORB/topics/log_stream.h>
+
+#include "mavlink_bridge_header.h"
+#include "mavlink_stream.h"
+
+class MavlinkLogStream : public MavlinkStream
+{
+public:
+	const char *get_name() const
+	{
+		return MavlinkLogStream::get_name_static();
+	}
+
+	static const char *get_name_static()
+	{
+		return "LOG_DATA";
+	}
+
+	uint8_t get_id()
+	{
+		return MAVLINK_MSG_ID_LOG_DATA;
+	}
+
+	static MavlinkStream *new_instance(Mavlink *mavlink)
+	{
+		return new MavlinkLogStream(mavlink);
+	}
+
+	~MavlinkLogStream();
+
+	unsigned get_size();
+
+	Priority get_priority()
+	{
+		return PRIORITY_DEBUG;
+	}
+
+	/**
+	 * Handle LOG_REQUEST_DATA and LOG_REQUEST_END, called from the receiver thread
+	 */
+	void handle_message(const mavlink_message_t *msg);
+
+	/** id of LOG_REQUEST_DATA to start streaming the current log file */
+	static const uint16_t kLiveLogId = 0xffff;
+
+protected:
+	explicit MavlinkLogStream(Mavlink *mavlink);
+
+	void send(const hrt_abstime t);
+
+private:
+	/**
+	 * Send one LOG_DATA from the history.
+	 *
+	 * @return number of bytes sent, 0 if offset is not in the history
+	 */
+	unsigned send_from_history(uint32_t offset, uint32_t count);
+
+	/** sent stream data kept for repeat requests, a power of two */
+	static const unsigned kHistorySize = 2048;
+
+	int			_sub;			///< log_stream subscription, -1 until streaming starts
+	volatile bool		_streaming;		///< requested by the receiver
+	volatile bool		_repeat_pending;	///< a repeat request is waiting for send()
+	volatile uint32_t	_repeat_offset;
+	volatile uint32_t	_repeat_count;
+
+	uint8_t			*_history;		///< ring of the last bytes sent, indexed by file offset
+	uint32_t		_history_start;		///< first offset in the history after a gap
+	uint32_t		_history_end;		///< offset after the last byte in the history
+	uint16_t		_log_id;		///< log file the history belongs to
+
+	struct log_stream_s	_chunk;			///< message being sent
+	unsigned		_chunk_sent;		///< bytes of _chunk already sent
+
+	/* do not allow copying this class */
+	MavlinkLogStream(const MavlinkLogStream &);
+	MavlinkLogStream operator=(const MavlinkLogStream &);
+};
@@ -41,6 +41,7 @@
 
 #include <px4_config.h>
 #include <px4_getopt.h>
+#include <px4_middleware.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -99,9 +100,85 @@ static const int ERROR = -1;
 #define MAX_DATA_RATE				10000000	///< max data rate in bytes/s
 #define MAIN_LOOP_DELAY 			10000	///< 100 Hz @ 1000 bytes/s data rate
 #define FLOW_CONTROL_DISABLE_THRESHOLD		40	///< picked so that some messages still would fit it.
+#define TX_BUDGET_BURST				100000	///< link budget may accumulate for this long (us)
 
 static Mavlink *_mavlink_instances = nullptr;
 
+/*
+ * Messages of mavlink_log_*(), stored once for all instances. Each
+ * instance reads them with its own cursor.
+ */
+static struct mavlink_logring _log_ring = {};
+static pthread_mutex_t _log_ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * The link each other system and component was last heard on, learned from
+ * their heartbeats, so the messages forwarded to them do not flood all links.
+ */
+#define MAVLINK_MAX_ROUTES			16
+#define MAVLINK_ROUTE_TIMEOUT			10000000	///< a route without heartbeat is dropped after this time (us)
+
+struct MavlinkRoute {
+	Mavlink *inst;			///< link the system was heard on, nullptr if the entry is free
+	hrt_abstime last_seen;
+	uint8_t sysid;
+	uint8_t compid;
+};
+
+static MavlinkRoute _routes[MAVLINK_MAX_ROUTES] = {};
+static pthread_mutex_t _routes_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Payload offsets of the target system and component of the messages
+ * addressed to a system, sorted by message ID.
+ */
+#define MAVLINK_NO_TARGET			0xff
+
+struct MavlinkTargetOffsets {
+	uint8_t msgid;
+	uint8_t system;
+	uint8_t component;		///< MAVLINK_NO_TARGET if the message has no target component
+};
+
+static const MavlinkTargetOffsets mavlink_target_offsets[] = {
+	{MAVLINK_MSG_ID_PING, 12, 13},
+	{MAVLINK_MSG_ID_CHANGE_OPERATOR_CONTROL, 0, MAVLINK_NO_TARGET},
+	{MAVLINK_MSG_ID_SET_MODE, 4, MAVLINK_NO_TARGET},
+	{MAVLINK_MSG_ID_PARAM_REQUEST_READ, 2, 3},
+	{MAVLINK_MSG_ID_PARAM_REQUEST_LIST, 0, 1},
+	{MAVLINK_MSG_ID_PARAM_SET, 4, 5},
+	{MAVLINK_MSG_ID_MISSION_REQUEST_PARTIAL_LIST, 4, 5},
+	{MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST, 4, 5},
+	{MAVLINK_MSG_ID_MISSION_ITEM, 32, 33},
+	{MAVLINK_MSG_ID_MISSION_REQUEST, 2, 3},
+	{MAVLINK_MSG_ID_MISSION_SET_CURRENT, 2, 3},
+	{MAVLINK_MSG_ID_MISSION_REQUEST_LIST, 0, 1},
+	{MAVLINK_MSG_ID_MISSION_COUNT, 2, 3},
+	{MAVLINK_MSG_ID_MISSION_CLEAR_ALL, 0, 1},
+	{MAVLINK_MSG_ID_MISSION_ACK, 0, 1},
+	{MAVLINK_MSG_ID_SET_GPS_GLOBAL_ORIGIN, 12, MAVLINK_NO_TARGET},
+	{MAVLINK_MSG_ID_PARAM_MAP_RC, 18, 19},
+	{MAVLINK_MSG_ID_SAFETY_SET_ALLOWED_AREA, 24, 25},
+	{MAVLINK_MSG_ID_REQUEST_DATA_STREAM, 2, 3},
+	{MAVLINK_MSG_ID_MANUAL_CONTROL, 10, MAVLINK_NO_TARGET},
+	{MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE, 16, 17},
+	{MAVLINK_MSG_ID_MISSION_ITEM_INT, 32, 33},
+	{MAVLINK_MSG_ID_COMMAND_INT, 30, 31},
+	{MAVLINK_MSG_ID_COMMAND_LONG, 30, 31},
+	{MAVLINK_MSG_ID_SET_ATTITUDE_TARGET, 36, 37},
+	{MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, 50, 51},
+	{MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT, 50, 51},
+	{MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, 1, 2},
+	{MAVLINK_MSG_ID_LOG_REQUEST_LIST, 4, 5},
+	{MAVLINK_MSG_ID_LOG_REQUEST_DATA, 10, 11},
+	{MAVLINK_MSG_ID_LOG_ERASE, 0, 1},
+	{MAVLINK_MSG_ID_LOG_REQUEST_END, 0, 1},
+	{MAVLINK_MSG_ID_GPS_INJECT_DATA, 0, 1},
+	{MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET, 41, 42},
+	{MAVLINK_MSG_ID_SET_HOME_POSITION, 52, MAVLINK_NO_TARGET},
+	{MAVLINK_MSG_ID_V2_EXTENSION, 3, 4},
+};
+
 #ifdef __PX4_NUTTX
 /* TODO: if this is a class member it crashes */
 static struct file_operations fops;
@@ -146,12 +223,14 @@ Mavlink::Mavlink() :
 	_mission_manager(nullptr),
 	_parameters_manager(nullptr),
 	_mavlink_ftp(nullptr),
+	_log_stream(nullptr),
 	_mode(MAVLINK_MODE_NORMAL),
 	_channel(MAVLINK_COMM_0),
 	_radio_id(0),
 	_logbuffer {},
-	_total_counter(0),
+	_log_seq(0),
 	_receive_thread {},
+	_receiver(nullptr),
 	_verbose(false),
 	_forwarding_on(false),
 	_ftp_on(false),
@@ -163,6 +242,12 @@ Mavlink::Mavlink() :
 	_datarate_events(500),
 	_rate_mult(1.0f),
 	_last_hw_rate_timestamp(0),
+	_last_radio_rxerrors(0),
+	_radio_ceiling(1.0f),
+	_tx_budget(0.0f),
+	_tx_budget_time(0),
+	_tx_budget_ready(0),
+	_tx_budget_mark(0),
 	_mavlink_param_queue_index(0),
 	mavlink_link_termination_allowed(false),
 	_subscribe_to_stream(nullptr),
@@ -172,6 +257,7 @@ Mavlink::Mavlink() :
 	_last_write_success_time(0),
 	_last_write_try_time(0),
 	_bytes_tx(0),
+	_bytes_tx_total(0),
 	_bytes_txerr(0),
 	_bytes_rx(0),
 	_bytes_timestamp(0),
@@ -185,6 +271,20 @@ Mavlink::Mavlink() :
 	_message_buffer {},
 	_message_buffer_mutex {},
 	_send_mutex {},
+	_tx_buf {},
+	_tx_buf_used(0),
+	_tx_pending(0),
+	_tx_msg(nullptr),
+	_tx_msg_len(0),
+	_tx_coalesce(false),
+#ifdef __PX4_POSIX
+	_tx_iov {},
+	_tx_iov_count(0),
+	_tx_dgram_first {},
+	_tx_dgram_count(0),
+	_tx_dgram_len(0),
+#endif
+	_batch_io(false),
 	_param_initialized(false),
 	_param_system_id(0),
 	_param_component_id(0),
@@ -401,6 +501,11 @@ Mavlink::get_status_all_instances()
 		iterations++;
 	}
 
+	if (iterations > 0) {
+		printf("\n");
+		MavlinkReceiver::print_timesync_status();
+	}
+
 	/* return an error if there are no instances */
 	return (iterations == 0);
 }
@@ -423,21 +528,143 @@ Mavlink::instance_exists(const char *device_name, Mavlink *self)
 	return false;
 }
 
+static const MavlinkTargetOffsets *
+find_target_offsets(uint8_t msgid)
+{
+	unsigned low = 0;
+	unsigned high = sizeof(mavlink_target_offsets) / sizeof(mavlink_target_offsets[0]);
+
+	while (low < high) {
+		unsigned mid = (low + high) / 2;
+
+		if (mavlink_target_offsets[mid].msgid < msgid) {
+			low = mid + 1;
+
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low < sizeof(mavlink_target_offsets) / sizeof(mavlink_target_offsets[0]) &&
+	    mavlink_target_offsets[low].msgid == msgid) {
+		return &mavlink_target_offsets[low];
+	}
+
+	return nullptr;
+}
+
+static void
+route_learn(const mavlink_message_t *msg, Mavlink *self)
+{
+	hrt_abstime now = hrt_absolute_time();
+	MavlinkRoute *route = nullptr;
+
+	pthread_mutex_lock(&_routes_mutex);
+
+	for (unsigned i = 0; i < MAVLINK_MAX_ROUTES; i++) {
+		MavlinkRoute *r = &_routes[i];
+
+		if (r->inst != nullptr && r->sysid == msg->sysid && r->compid == msg->compid) {
+			route = r;
+			break;
+		}
+
+		/* otherwise take a free entry or the one not heard of for the longest time */
+		if (route == nullptr || (route->inst != nullptr && (r->inst == nullptr || r->last_seen < route->last_seen))) {
+			route = r;
+		}
+	}
+
+	route->inst = self;
+	route->sysid = msg->sysid;
+	route->compid = msg->compid;
+	route->last_seen = now;
+
+	pthread_mutex_unlock(&_routes_mutex);
+}
+
+static void
+route_forget(Mavlink *self)
+{
+	pthread_mutex_lock(&_routes_mutex);
+
+	for (unsigned i = 0; i < MAVLINK_MAX_ROUTES; i++) {
+		if (_routes[i].inst == self) {
+			_routes[i].inst = nullptr;
+		}
+	}
+
+	pthread_mutex_unlock(&_routes_mutex);
+}
+
+/**
+ * Check if a target was heard of lately, on the given link or on any if inst is nullptr. The routes lock has to be held.
+ */
+static bool
+route_exists(const Mavlink *inst, uint8_t sysid, uint8_t compid, hrt_abstime now)
+{
+	for (unsigned i = 0; i < MAVLINK_MAX_ROUTES; i++) {
+		const MavlinkRoute *r = &_routes[i];
+
+		if (r->inst != nullptr && (inst == nullptr || r->inst == inst) && r->sysid == sysid &&
+		    (compid == 0 || r->compid == compid) && now - r->last_seen < MAVLINK_ROUTE_TIMEOUT) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void
 Mavlink::forward_message(const mavlink_message_t *msg, Mavlink *self)
 {
+	/* if not in normal mode, we are an onboard link
+	 * onboard links should only pass on messages from the same system ID */
+	if (self->_mode != MAVLINK_MODE_NORMAL && msg->sysid != mavlink_system.sysid) {
+		return;
+	}
+
+	/* a target system of 0 is a broadcast, as are messages without a target */
+	const MavlinkTargetOffsets *offsets = find_target_offsets(msg->msgid);
+	uint8_t target_system = 0;
+	uint8_t target_component = 0;
+
+	if (offsets != nullptr && offsets->system < msg->len) {
+		target_system = _MAV_PAYLOAD(msg)[offsets->system];
+
+		if (offsets->component != MAVLINK_NO_TARGET && offsets->component < msg->len) {
+			target_component = _MAV_PAYLOAD(msg)[offsets->component];
+		}
+	}
+
+	/* addressed to this component alone, nothing to pass on */
+	if (target_system == mavlink_system.sysid && target_component == mavlink_system.compid) {
+		return;
+	}
+
+	/* a targeted message only goes to the links its target was heard on, to all as long as it wasn't */
+	hrt_abstime now = hrt_absolute_time();
+
+	pthread_mutex_lock(&_routes_mutex);
+
+	bool known = target_system != 0 && route_exists(nullptr, target_system, target_component, now);
+
+	/* pack the frame once for all links, the buffers of the links take it as is */
+	uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+	unsigned len = 0;
 
 	Mavlink *inst;
 	LL_FOREACH(_mavlink_instances, inst) {
-		if (inst != self) {
-
-			/* if not in normal mode, we are an onboard link
-			 * onboard links should only pass on messages from the same system ID */
-			if (!(self->_mode != MAVLINK_MODE_NORMAL && msg->sysid != mavlink_system.sysid)) {
-				inst->pass_message(msg);
+		if (inst != self && (!known || route_exists(inst, target_system, target_component, now))) {
+			if (len == 0) {
+				len = mavlink_msg_to_send_buffer(frame, msg);
 			}
+
+			inst->pass_message(frame, len);
 		}
 	}
+
+	pthread_mutex_unlock(&_routes_mutex);
 }
 
 int
@@ -508,13 +735,9 @@ Mavlink::ioctl(device::file_t *filp, int cmd, unsigned long arg)
 				break;
 			}
 
-			Mavlink *inst;
-			LL_FOREACH(_mavlink_instances, inst) {
-				if (!inst->_task_should_exit) {
-					mavlink_logbuffer_write(&inst->_logbuffer, &msg);
-					inst->_total_counter++;
-				}
-			}
+			pthread_mutex_lock(&_log_ring_mutex);
+			mavlink_logring_write(&_log_ring, &msg, hrt_absolute_time());
+			pthread_mutex_unlock(&_log_ring_mutex);
 
 			return OK;
 		}
@@ -825,133 +1048,212 @@ Mavlink::get_free_tx_buf()
 
 void
 Mavlink::send_message(const uint8_t msgid, const void *msg, uint8_t component_ID)
+{
+	void *payload = tx_begin(msgid, component_ID);
+
+	if (payload != nullptr) {
+		memcpy(payload, msg, mavlink_message_lengths[msgid]);
+		tx_commit();
+	}
+}
+
+uint8_t *
+Mavlink::tx_reserve(unsigned len)
 {
 	/* If the wait until transmit flag is on, only transmit after we've received messages.
 	   Otherwise, transmit all the time. */
 	if (!should_transmit()) {
-		return;
+		return nullptr;
 	}
 
 	pthread_mutex_lock(&_send_mutex);
 
-	uint8_t payload_len = mavlink_message_lengths[msgid];
-	unsigned packet_len = payload_len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
-
 	_last_write_try_time = hrt_absolute_time();
 
 	if (get_protocol() == SERIAL) {
 		/* check if there is space in the buffer, let it overflow else */
 		unsigned buf_free = get_free_tx_buf();
-		if (buf_free < packet_len) {
+		if (buf_free < len) {
 			 /* no enough space in buffer to send */
 			count_txerr();
-			count_txerrbytes(packet_len);
+			count_txerrbytes(len);
 			pthread_mutex_unlock(&_send_mutex);
-			return;
+			return nullptr;
 		}
 	}
 
-	uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+#ifdef __PX4_POSIX
+	/* start a new datagram if the message doesn't fit the current one, flush if there is no room for one */
+	bool new_dgram = _tx_dgram_count == 0 || _tx_dgram_len + len > MAVLINK_TX_DATAGRAM_SIZE ||
+			 _tx_iov_count - _tx_dgram_first[_tx_dgram_count - 1] == MAVLINK_TX_MAX_MESSAGES;
+
+	if (new_dgram && _tx_dgram_count == (_batch_io ? MAVLINK_TX_MAX_DATAGRAMS : 1)) {
+		flush_tx();
+	}
+#endif
+
+	/* place the header so that the payload following it is 8 byte aligned */
+	unsigned start = ((_tx_buf_used + 5) & ~7u) + 2;
+
+	if (start + len > sizeof(_tx_buf)) {
+		flush_tx();
+		start = 2;
+	}
+
+#ifdef __PX4_POSIX
+	if (_tx_dgram_count == 0 || new_dgram) {
+		_tx_dgram_first[_tx_dgram_count++] = _tx_iov_count;
+		_tx_dgram_len = 0;
+	}
+#endif
+
+	_tx_msg = &_tx_buf[start];
+	_tx_msg_len = len;
+
+	return _tx_msg;
+}
+
+void
+Mavlink::tx_finish()
+{
+	_tx_buf_used = (_tx_msg - _tx_buf) + _tx_msg_len;
+	_tx_pending += _tx_msg_len;
+
+#ifdef __PX4_POSIX
+	_tx_iov[_tx_iov_count].iov_base = _tx_msg;
+	_tx_iov[_tx_iov_count].iov_len = _tx_msg_len;
+	_tx_iov_count++;
+	_tx_dgram_len += _tx_msg_len;
+#endif
+
+	if (!_tx_coalesce || get_protocol() != UDP) {
+		flush_tx();
+	}
+
+	pthread_mutex_unlock(&_send_mutex);
+}
+
+void *
+Mavlink::tx_begin(const uint8_t msgid, uint8_t component_ID)
+{
+	uint8_t payload_len = mavlink_message_lengths[msgid];
+
+	if (tx_reserve(payload_len + MAVLINK_NUM_NON_PAYLOAD_BYTES) == nullptr) {
+		return nullptr;
+	}
 
 	/* header */
-	buf[0] = MAVLINK_STX;
-	buf[1] = payload_len;
+	_tx_msg[0] = MAVLINK_STX;
+	_tx_msg[1] = payload_len;
 	/* use mavlink's internal counter for the TX seq */
-	buf[2] = mavlink_get_channel_status(_channel)->current_tx_seq++;
-	buf[3] = mavlink_system.sysid;
-	buf[4] = (component_ID == 0) ? mavlink_system.compid : component_ID;
-	buf[5] = msgid;
+	_tx_msg[2] = mavlink_get_channel_status(_channel)->current_tx_seq++;
+	_tx_msg[3] = mavlink_system.sysid;
+	_tx_msg[4] = (component_ID == 0) ? mavlink_system.compid : component_ID;
+	_tx_msg[5] = msgid;
+
+	return &_tx_msg[MAVLINK_NUM_HEADER_BYTES];
+}
 
-	/* payload */
-	memcpy(&buf[MAVLINK_NUM_HEADER_BYTES], msg, payload_len);
+void
+Mavlink::tx_commit()
+{
+	uint8_t payload_len = _tx_msg[1];
+	uint8_t msgid = _tx_msg[5];
 
 	/* checksum */
 	uint16_t checksum;
 	crc_init(&checksum);
-	crc_accumulate_buffer(&checksum, (const char *) &buf[1], MAVLINK_CORE_HEADER_LEN + payload_len);
+	crc_accumulate_buffer(&checksum, (const char *) &_tx_msg[1], MAVLINK_CORE_HEADER_LEN + payload_len);
 	crc_accumulate(mavlink_message_crcs[msgid], &checksum);
 
-	buf[MAVLINK_NUM_HEADER_BYTES + payload_len] = (uint8_t)(checksum & 0xFF);
-	buf[MAVLINK_NUM_HEADER_BYTES + payload_len + 1] = (uint8_t)(checksum >> 8);
+	_tx_msg[MAVLINK_NUM_HEADER_BYTES + payload_len] = (uint8_t)(checksum & 0xFF);
+	_tx_msg[MAVLINK_NUM_HEADER_BYTES + payload_len + 1] = (uint8_t)(checksum >> 8);
 
-	size_t ret = -1;
-#ifndef __PX4_POSIX
-	/* send message to UART */
-	if (get_protocol() == SERIAL) {
-		ret = ::write(_uart_fd, buf, packet_len);
-	}
-#else
-	if (get_protocol() == UDP) {
-		ret = sendto(_socket_fd, buf, packet_len, 0, (struct sockaddr *)&_src_addr, sizeof(_src_addr));
-	} else if (get_protocol() == TCP) {
-		// not implemented, but possible to do so
-		warnx("TCP transport pending implementation");
-	}
-#endif
+	tx_finish();
+}
 
-	if (ret != (size_t) packet_len) {
-		count_txerr();
-		count_txerrbytes(packet_len);
+void
+Mavlink::send_frame(const uint8_t *frame, unsigned len)
+{
+	uint8_t *buf = tx_reserve(len);
 
-	} else {
-		_last_write_success_time = _last_write_try_time;
-		count_txbytes(packet_len);
+	if (buf != nullptr) {
+		memcpy(buf, frame, len);
+		tx_finish();
 	}
-
-	pthread_mutex_unlock(&_send_mutex);
 }
 
 void
-Mavlink::resend_message(mavlink_message_t *msg)
+Mavlink::flush_tx()
 {
-	/* If the wait until transmit flag is on, only transmit after we've received messages.
-	   Otherwise, transmit all the time. */
-	if (!should_transmit()) {
+	if (_tx_pending == 0) {
 		return;
 	}
 
-	pthread_mutex_lock(&_send_mutex);
+	ssize_t ret = -1;
+#ifndef __PX4_POSIX
+	/* send message to UART, there is never more than the last message pending */
+	if (get_protocol() == SERIAL) {
+		ret = ::write(_uart_fd, _tx_msg, _tx_pending);
+	}
+#else
+	if (get_protocol() == UDP && _tx_dgram_count == 1) {
+		/* gather all pending messages into one datagram */
+		struct msghdr msg = {};
+		msg.msg_name = &_src_addr;
+		msg.msg_namelen = sizeof(_src_addr);
+		msg.msg_iov = _tx_iov;
+		msg.msg_iovlen = _tx_iov_count;
 
-	unsigned buf_free = get_free_tx_buf();
+		ret = sendmsg(_socket_fd, &msg, 0);
 
-	_last_write_try_time = hrt_absolute_time();
-
-	unsigned packet_len = msg->len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+#ifdef MAVLINK_UDP_MMSG
+	} else if (get_protocol() == UDP) {
+		/* batched mode, all pending datagrams with one call */
+		struct mmsghdr msgs[MAVLINK_TX_MAX_DATAGRAMS] = {};
+
+		for (unsigned i = 0; i < _tx_dgram_count; i++) {
+			unsigned end = (i + 1 < _tx_dgram_count) ? _tx_dgram_first[i + 1] : _tx_iov_count;
+			msgs[i].msg_hdr.msg_name = &_src_addr;
+			msgs[i].msg_hdr.msg_namelen = sizeof(_src_addr);
+			msgs[i].msg_hdr.msg_iov = &_tx_iov[_tx_dgram_first[i]];
+			msgs[i].msg_hdr.msg_iovlen = end - _tx_dgram_first[i];
+		}
 
-	/* check if there is space in the buffer, let it overflow else */
-	if (buf_free < packet_len) {
-		/* no enough space in buffer to send */
-		count_txerr();
-		count_txerrbytes(packet_len);
-		pthread_mutex_unlock(&_send_mutex);
-		return;
-	}
+		int sent = sendmmsg(_socket_fd, msgs, _tx_dgram_count, 0);
 
-	uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+		if (sent >= 0) {
+			ret = 0;
 
-	/* header and payload */
-	memcpy(&buf[0], &msg->magic, MAVLINK_NUM_HEADER_BYTES + msg->len);
+			for (int i = 0; i < sent; i++) {
+				ret += msgs[i].msg_len;
+			}
+		}
+#endif
 
-	/* checksum */
-	buf[MAVLINK_NUM_HEADER_BYTES + msg->len] = (uint8_t)(msg->checksum & 0xFF);
-	buf[MAVLINK_NUM_HEADER_BYTES + msg->len + 1] = (uint8_t)(msg->checksum >> 8);
+	} else if (get_protocol() == TCP) {
+		// not implemented, but possible to do so
+		warnx("TCP transport pending implementation");
+	}
 
-#ifndef __PX4_POSIX
-	/* send message to UART */
-	ssize_t ret = ::write(_uart_fd, buf, packet_len);
+	_tx_iov_count = 0;
+	_tx_dgram_count = 0;
+	_tx_dgram_len = 0;
+#endif
 
-	if (ret != (int) packet_len) {
+	if (ret != (ssize_t) _tx_pending) {
 		count_txerr();
-		count_txerrbytes(packet_len);
+		count_txerrbytes(_tx_pending);
+		/* the link budget is charged for the attempt as well */
+		_bytes_tx_total += _tx_pending;
 
 	} else {
 		_last_write_success_time = _last_write_try_time;
-		count_txbytes(packet_len);
+		count_txbytes(_tx_pending);
 	}
 
-#endif
-
-	pthread_mutex_unlock(&_send_mutex);
+	_tx_buf_used = 0;
+	_tx_pending = 0;
 }
 
 void
@@ -996,6 +1298,16 @@ Mavlink::handle_message(const mavlink_message_t *msg)
 	/* handle packet with ftp component */
 	_mavlink_ftp->handle_message(msg);
 
+	/* handle packet with live log stream, the receiver starts before the streams are created */
+	if (_log_stream != nullptr) {
+		_log_stream->handle_message(msg);
+	}
+
+	/* remember the link the other systems are on, forwarded messages for them only go there */
+	if (msg->msgid == MAVLINK_MSG_ID_HEARTBEAT && msg->sysid != mavlink_system.sysid) {
+		route_learn(msg, this);
+	}
+
 	if (get_forwarding_on()) {
 		/* forward any messages to other mavlink instances */
 		Mavlink::forward_message(msg, this);
@@ -1030,11 +1342,28 @@ Mavlink::send_statustext(unsigned char severity, const char *string)
 	mavlink_logbuffer_write(&_logbuffer, &logmsg);
 }
 
+bool
+Mavlink::log_message_pending()
+{
+	return !mavlink_logbuffer_is_empty(&_logbuffer) || !mavlink_logring_is_empty(&_log_ring, _log_seq);
+}
+
+bool
+Mavlink::read_log_message(struct mavlink_logmessage *msg)
+{
+	/* the replies to this link first */
+	if (mavlink_logbuffer_read(&_logbuffer, msg) == 0) {
+		return true;
+	}
+
+	return mavlink_logring_read(&_log_ring, &_log_seq, msg) == 0;
+}
+
 void Mavlink::send_autopilot_capabilites()
 {
 	struct vehicle_status_s status;
 
-	MavlinkOrbSubscription *status_sub = this->add_orb_subscription(ORB_ID(vehicle_status));
+	MavlinkOrbSubscription *status_sub = this->add_orb_subscription(ORB_ID(vehicle_status), 0, false);
 
 	if (status_sub->update(&status)) {
 		mavlink_autopilot_version_t msg = {};
@@ -1072,24 +1401,41 @@ void Mavlink::send_autopilot_capabilites()
 	}
 }
 
-MavlinkOrbSubscription *Mavlink::add_orb_subscription(const orb_id_t topic, int instance)
+MavlinkOrbSubscription *Mavlink::add_orb_subscription(const orb_id_t topic, int instance, bool shared)
 {
-	/* check if already subscribed to this topic */
+#ifdef __PX4_NUTTX
+	/* every instance is a task with its own file descriptors, nothing can be shared */
+	shared = false;
+#endif
+
 	MavlinkOrbSubscription *sub;
 
+	/* check if already subscribed to this topic */
 	LL_FOREACH(_subscriptions, sub) {
-		if (sub->get_topic() == topic && sub->get_instance() == instance) {
+		if (sub->get_topic() == topic && sub->get_instance() == instance && sub->is_shared() == shared) {
 			/* already subscribed */
-			return sub;
+			break;
 		}
 	}
 
-	/* add new subscription */
-	MavlinkOrbSubscription *sub_new = new MavlinkOrbSubscription(topic, instance);
+	if (sub == nullptr) {
+		/* add new subscription */
+		sub = new MavlinkOrbSubscription(topic, instance, shared);
+
+		LL_APPEND(_subscriptions, sub);
+	}
 
-	LL_APPEND(_subscriptions, sub_new);
+	sub->add_user();
 
-	return sub_new;
+	return sub;
+}
+
+void Mavlink::remove_orb_subscription(MavlinkOrbSubscription *sub)
+{
+	if (sub->remove_user() == 0) {
+		LL_DELETE(_subscriptions, sub);
+		delete sub;
+	}
 }
 
 unsigned int
@@ -1128,11 +1474,11 @@ Mavlink::configure_stream(const char *stream_name, const float rate)
 	}
 
 	/* search for stream with specified name in supported streams list */
-	for (unsigned int i = 0; streams_list[i] != nullptr; i++) {
+	for (unsigned int i = 0; streams_list[i].new_instance != nullptr; i++) {
 
-		if (strcmp(stream_name, streams_list[i]->get_name()) == 0) {
+		if (strcmp(stream_name, streams_list[i].get_name()) == 0) {
 			/* create new instance */
-			stream = streams_list[i]->new_instance(this);
+			stream = streams_list[i].new_instance(this);
 			stream->set_interval(interval);
 			LL_APPEND(_streams, stream);
 
@@ -1318,14 +1664,49 @@ Mavlink::message_buffer_mark_read(int n)
 	_message_buffer.read_ptr = (_message_buffer.read_ptr + n) % _message_buffer.size;
 }
 
+unsigned
+Mavlink::message_buffer_read_frame(uint8_t *frame)
+{
+	pthread_mutex_lock(&_message_buffer_mutex);
+
+	if (message_buffer_is_empty()) {
+		pthread_mutex_unlock(&_message_buffer_mutex);
+		return 0;
+	}
+
+	/* the frames are written whole, the length follows from the payload length after the STX */
+	unsigned len = (uint8_t)_message_buffer.data[(_message_buffer.read_ptr + 1) % _message_buffer.size] +
+		       MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+	bool is_part;
+	uint8_t *read_ptr;
+	unsigned n = message_buffer_get_ptr((void **)&read_ptr, &is_part);
+
+	if (n > len) {
+		n = len;
+	}
+
+	memcpy(frame, read_ptr, n);
+	message_buffer_mark_read(n);
+
+	if (n < len) {
+		/* the frame wraps around the end of the buffer */
+		message_buffer_get_ptr((void **)&read_ptr, &is_part);
+		memcpy(&frame[n], read_ptr, len - n);
+		message_buffer_mark_read(len - n);
+	}
+
+	pthread_mutex_unlock(&_message_buffer_mutex);
+
+	return len;
+}
+
 void
-Mavlink::pass_message(const mavlink_message_t *msg)
+Mavlink::pass_message(const uint8_t *frame, unsigned len)
 {
 	if (_forwarding_on) {
-		/* size is 8 bytes plus variable payload */
-		int size = MAVLINK_NUM_NON_PAYLOAD_BYTES + msg->len;
 		pthread_mutex_lock(&_message_buffer_mutex);
-		message_buffer_write(msg, size);
+		message_buffer_write(frame, len);
 		pthread_mutex_unlock(&_message_buffer_mutex);
 	}
 }
@@ -1339,22 +1720,7 @@ Mavlink::get_rate_mult()
 void
 Mavlink::update_rate_mult()
 {
-	float const_rate = 0.0f;
-	float rate = 0.0f;
-
-	/* scale down rates if their theoretical bandwidth is exceeding the link bandwidth */
-	MavlinkStream *stream;
-	LL_FOREACH(_streams, stream) {
-		if (stream->const_rate()) {
-			const_rate += stream->get_size() * 1000000.0f / stream->get_interval();
-
-		} else {
-			rate += stream->get_size() * 1000000.0f / stream->get_interval();
-		}
-	}
-
-	/* don't scale up rates, only scale down if needed */
-	float bandwidth_mult = fminf(1.0f, ((float)_datarate - const_rate) / rate);
+	/* the stream scheduler keeps the total below _datarate, only check hardware limits here */
 
 	/* check if we have radio feedback */
 	struct telemetry_status_s &tstatus = get_rx_status();
@@ -1362,7 +1728,6 @@ Mavlink::update_rate_mult()
 	bool radio_critical = false;
 	bool radio_found = false;
 
-	/* 2nd pass: Now check hardware limits */
 	if (tstatus.type == telemetry_status_s::TELEMETRY_STATUS_RADIO_TYPE_3DR_RADIO) {
 
 		radio_found = true;
@@ -1378,33 +1743,141 @@ Mavlink::update_rate_mult()
 	if (_rate_txerr > 0.0f && !radio_critical) {
 		hardware_mult = (_rate_tx) / (_rate_tx + _rate_txerr);
 	} else if (radio_found && tstatus.timestamp != _last_hw_rate_timestamp) {
+		/*
+		 * Steer the free radio buffer to half, proportional to the distance, so the
+		 * rate settles at what the air link carries instead of stepping around the
+		 * thresholds. Only back off while the radio reports new receive errors.
+		 */
+		float error = ((float)tstatus.txbuf - RADIO_BUFFER_HALF_PERCENTAGE) / RADIO_BUFFER_HALF_PERCENTAGE;
+
+		if (_last_hw_rate_timestamp != 0 && tstatus.rxerrors != _last_radio_rxerrors) {
+			error = fminf(error, 0.0f);
+		}
+
+		hardware_mult *= 1.0f + RADIO_RATE_GAIN * error;
 
 		if (tstatus.txbuf < RADIO_BUFFER_CRITICAL_LOW_PERCENTAGE) {
-			/* this indicates link congestion, reduce rate by 20% */
+			/* the radio is about to drop packets, reduce rate by 20% on top */
 			hardware_mult *= 0.80f;
-		} else if (tstatus.txbuf < RADIO_BUFFER_LOW_PERCENTAGE) {
-			/* this indicates link congestion, reduce rate by 2.5% */
-			hardware_mult *= 0.975f;
-		} else if (tstatus.txbuf > RADIO_BUFFER_HALF_PERCENTAGE) {
-			/* this indicates spare bandwidth, increase by 2.5% */
-			hardware_mult *= 1.025f;
-			/* limit to a max multiplier of 1 */
-			hardware_mult = fminf(1.0f, hardware_mult);
 		}
-	} else {
+
+		/* the weaker direction of the link limits the rate, a fading link loses more of what is sent */
+		if (tstatus.rssi != 0 && tstatus.remote_rssi != 0) {
+			float margin = fminf((int)tstatus.rssi - (int)tstatus.noise,
+					     (int)tstatus.remote_rssi - (int)tstatus.remote_noise);
+			_radio_ceiling = fmaxf(RADIO_CEILING_MIN, fminf(1.0f, margin / RADIO_FADE_MARGIN_GOOD));
+
+		} else {
+			_radio_ceiling = 1.0f;
+		}
+
+		hardware_mult = fminf(_radio_ceiling, hardware_mult);
+		_last_radio_rxerrors = tstatus.rxerrors;
+
+	} else if (!radio_found) {
 		/* no limitation, set hardware to 1 */
 		hardware_mult = 1.0f;
 	}
 
 	_last_hw_rate_timestamp = tstatus.timestamp;
 
-	/* pick the minimum from bandwidth mult and hardware mult as limit */
-	_rate_mult = fminf(bandwidth_mult, hardware_mult);
+	_rate_mult = hardware_mult;
 
 	/* ensure the rate multiplier never drops below 5% so that something is always sent */
 	_rate_mult = fmaxf(0.05f, _rate_mult);
 }
 
+unsigned
+Mavlink::get_tx_budget()
+{
+	int charge = (_bytes_tx_total + _tx_pending) - _tx_budget_mark;
+	float budget = _tx_budget - ((charge > 0) ? charge : 0);
+
+	return (budget > 0.0f) ? budget : 0;
+}
+
+void
+Mavlink::charge_tx_budget()
+{
+	/* queued messages count as sent, a flush on another thread may make the sum appear to go back once */
+	unsigned total = _bytes_tx_total + _tx_pending;
+	int charge = total - _tx_budget_mark;
+
+	if (charge > 0) {
+		_tx_budget -= charge;
+		_tx_budget_mark = total;
+	}
+}
+
+void
+Mavlink::update_streams(const hrt_abstime t)
+{
+	/* refill the link budget, scaled down if the radio reports congestion */
+	float budget_max = fmaxf(_datarate * (TX_BUDGET_BURST / 1e6f), MAVLINK_MAX_PACKET_LEN);
+
+	/* on slow links the largest stream (e.g. IMU_BATCH) must still fit, else it and all lower classes starve */
+	MavlinkStream *stream;
+	LL_FOREACH(_streams, stream) {
+		budget_max = fmaxf(budget_max, stream->get_size());
+	}
+
+	if (_tx_budget_time == 0) {
+		_tx_budget = budget_max;
+
+	} else {
+		_tx_budget = fminf(budget_max, _tx_budget + (t - _tx_budget_time) * _datarate * _rate_mult / 1e6f);
+	}
+
+	_tx_budget_time = t;
+	_tx_budget_ready = 0;
+
+	/* other senders (receiver replies, forwarding) share the same link */
+	charge_tx_budget();
+
+	/* fill the budget class by class, once a stream does not fit lower classes have to wait */
+	bool deferred = false;
+
+	/* send everything the streams produce in this pass with as few datagrams as possible,
+	 * send_bytes() reads the flag under the send lock on the other threads as well */
+	pthread_mutex_lock(&_send_mutex);
+	_tx_coalesce = true;
+	pthread_mutex_unlock(&_send_mutex);
+
+	for (int prio = 0; prio < MavlinkStream::PRIORITY_COUNT && !deferred; prio++) {
+		LL_FOREACH(_streams, stream) {
+			if (stream->get_priority() != prio || stream->get_next_due() > t) {
+				continue;
+			}
+
+			float size = stream->get_size();
+
+			if (_tx_budget < size) {
+				if (!deferred) {
+					_tx_budget_ready = t + (size - _tx_budget) * 1e6f / (_datarate * _rate_mult);
+				}
+
+				stream->count_deferred();
+				deferred = true;
+				continue;
+			}
+
+			unsigned sent = _bytes_tx_total + _tx_pending;
+			stream->update(t);
+
+			if (_bytes_tx_total + _tx_pending != sent) {
+				stream->count_sent();
+			}
+
+			charge_tx_budget();
+		}
+	}
+
+	pthread_mutex_lock(&_send_mutex);
+	_tx_coalesce = false;
+	flush_tx();
+	pthread_mutex_unlock(&_send_mutex);
+}
+
 int
 Mavlink::task_main(int argc, char *argv[])
 {
@@ -1432,7 +1905,7 @@ Mavlink::task_main(int argc, char *argv[])
 	char* eptr;
 	int temp_int_arg;
 
-	while ((ch = px4_getopt(argc, argv, "b:r:d:u:m:fpvwx", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "b:r:d:u:m:fpvwxB", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'b':
 			_baudrate = strtoul(myoptarg, NULL, 10);
@@ -1463,6 +1936,9 @@ Mavlink::task_main(int argc, char *argv[])
 			temp_int_arg = strtoul(myoptarg, &eptr, 10);
 			if ( *eptr == '\0' ) {
 				_network_port = temp_int_arg;
+#ifdef __PX4_LINUX
+				_network_port = px4::instance_port(_network_port);
+#endif
 				set_protocol(UDP);
 			} else {
 				warnx("invalid data udp_port '%s'", myoptarg);
@@ -1508,6 +1984,14 @@ Mavlink::task_main(int argc, char *argv[])
 			_ftp_on = true;
 			break;
 
+		case 'B':
+#ifdef MAVLINK_UDP_MMSG
+			_batch_io = true;
+#else
+			warnx("batched I/O not supported, using coalesced datagrams");
+#endif
+			break;
+
 		default:
 			err_flag = true;
 			break;
@@ -1595,9 +2079,10 @@ Mavlink::task_main(int argc, char *argv[])
 	/* start the MAVLink receiver */
 	_receive_thread = MavlinkReceiver::receive_start(this);
 
-	MavlinkOrbSubscription *param_sub = add_orb_subscription(ORB_ID(parameter_update));
+	/* polled below, they need their own handles */
+	MavlinkOrbSubscription *param_sub = add_orb_subscription(ORB_ID(parameter_update), 0, false);
 	uint64_t param_time = 0;
-	MavlinkOrbSubscription *status_sub = add_orb_subscription(ORB_ID(vehicle_status));
+	MavlinkOrbSubscription *status_sub = add_orb_subscription(ORB_ID(vehicle_status), 0, false);
 	uint64_t status_time = 0;
 
 	struct vehicle_status_s status;
@@ -1624,6 +2109,11 @@ Mavlink::task_main(int argc, char *argv[])
 	_mavlink_ftp->set_interval(interval_from_rate(80.0f));
 	LL_APPEND(_streams, _mavlink_ftp);
 
+	/* LOG_DATA stream, idle until the remote requests the live log */
+	_log_stream = (MavlinkLogStream *) MavlinkLogStream::new_instance(this);
+	_log_stream->set_interval(interval_from_rate(80.0f));
+	LL_APPEND(_streams, _log_stream);
+
 	/* MISSION_STREAM stream, actually sends all MISSION_XXX messages at some rate depending on
 	 * remote requests rate. Rate specified here controls how much bandwidth we will reserve for
 	 * mission messages. */
@@ -1730,9 +2220,49 @@ Mavlink::task_main(int argc, char *argv[])
 		send_autopilot_capabilites();
 	}
 
+	/* wake up early on parameter and vehicle status changes, both are consumed every iteration */
+	px4_pollfd_struct_t fds[2];
+	fds[0].fd = param_sub->get_fd();
+	fds[0].events = POLLIN;
+	fds[1].fd = status_sub->get_fd();
+	fds[1].events = POLLIN;
+
 	while (!_task_should_exit) {
-		/* main loop */
-		usleep(_main_loop_delay);
+		/* main loop: sleep until the nearest stream is due, at most one loop delay */
+		hrt_abstime now = hrt_absolute_time();
+		hrt_abstime next_due = now + _main_loop_delay;
+
+		hrt_abstime stream_due = next_due;
+
+		MavlinkStream *stream;
+		LL_FOREACH(_streams, stream) {
+			hrt_abstime due = stream->get_next_due();
+
+			if (due < stream_due) {
+				stream_due = due;
+			}
+		}
+
+		/* streams waiting for link budget are not due before it is refilled */
+		if (stream_due < _tx_budget_ready) {
+			stream_due = _tx_budget_ready;
+		}
+
+		if (stream_due < next_due) {
+			next_due = stream_due;
+		}
+
+		if (next_due > now) {
+			unsigned timeout = next_due - now;
+
+			if (timeout < 1000) {
+				/* poll resolution is 1 ms */
+				usleep(timeout);
+
+			} else {
+				px4_poll(&fds[0], sizeof(fds) / sizeof(fds[0]), timeout / 1000);
+			}
+		}
 
 		perf_begin(_loop_perf);
 
@@ -1830,56 +2360,15 @@ Mavlink::task_main(int argc, char *argv[])
 		}
 
 		/* update streams */
-		MavlinkStream *stream;
-		LL_FOREACH(_streams, stream) {
-			stream->update(t);
-		}
+		update_streams(t);
 
 		/* pass messages from other UARTs or FTP worker */
 		if (_forwarding_on || _ftp_on) {
+			uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+			unsigned len;
 
-			bool is_part;
-			uint8_t *read_ptr;
-			uint8_t *write_ptr;
-
-			pthread_mutex_lock(&_message_buffer_mutex);
-			int available = message_buffer_get_ptr((void **)&read_ptr, &is_part);
-			pthread_mutex_unlock(&_message_buffer_mutex);
-
-			if (available > 0) {
-				// Reconstruct message from buffer
-
-				mavlink_message_t msg;
-				write_ptr = (uint8_t *)&msg;
-
-				// Pull a single message from the buffer
-				size_t read_count = available;
-
-				if (read_count > sizeof(mavlink_message_t)) {
-					read_count = sizeof(mavlink_message_t);
-				}
-
-				memcpy(write_ptr, read_ptr, read_count);
-
-				// We hold the mutex until after we complete the second part of the buffer. If we don't
-				// we may end up breaking the empty slot overflow detection semantics when we mark the
-				// possibly partial read below.
-				pthread_mutex_lock(&_message_buffer_mutex);
-
-				message_buffer_mark_read(read_count);
-
-				/* write second part of buffer if there is some */
-				if (is_part && read_count < sizeof(mavlink_message_t)) {
-					write_ptr += read_count;
-					available = message_buffer_get_ptr((void **)&read_ptr, &is_part);
-					read_count = sizeof(mavlink_message_t) - read_count;
-					memcpy(write_ptr, read_ptr, read_count);
-					message_buffer_mark_read(available);
-				}
-
-				pthread_mutex_unlock(&_message_buffer_mutex);
-
-				resend_message(&msg);
+			while ((len = message_buffer_read_frame(frame)) > 0) {
+				send_frame(frame, len);
 			}
 		}
 
@@ -1893,6 +2382,10 @@ Mavlink::task_main(int argc, char *argv[])
 				_bytes_tx = 0;
 				_bytes_txerr = 0;
 				_bytes_rx = 0;
+
+				LL_FOREACH(_streams, stream) {
+					stream->update_rate_stats(dt / 1000.0f);
+				}
 			}
 
 			_bytes_timestamp = t;
@@ -1919,9 +2412,14 @@ Mavlink::task_main(int argc, char *argv[])
 
 	_streams = nullptr;
 
+	/* wait for threads to complete */
+	pthread_join(_receive_thread, NULL);
+
 	/* delete subscriptions */
-	MavlinkOrbSubscription *sub_to_del = nullptr;
 	MavlinkOrbSubscription *sub_next = _subscriptions;
+	_subscriptions = nullptr;
+
+	MavlinkOrbSubscription *sub_to_del = nullptr;
 
 	while (sub_next != nullptr) {
 		sub_to_del = sub_next;
@@ -1929,11 +2427,6 @@ Mavlink::task_main(int argc, char *argv[])
 		delete sub_to_del;
 	}
 
-	_subscriptions = nullptr;
-
-	/* wait for threads to complete */
-	pthread_join(_receive_thread, NULL);
-
 #ifndef __PX4_POSIX
 	/* reset the UART flags to original state */
 	tcsetattr(_uart_fd, TCSANOW, &uart_config_original);
@@ -1945,6 +2438,8 @@ Mavlink::task_main(int argc, char *argv[])
 	/* close mavlink logging device */
 	px4_close(_mavlink_fd);
 
+	route_forget(this);
+
 	if (_forwarding_on || _ftp_on) {
 		message_buffer_destroy();
 		pthread_mutex_destroy(&_message_buffer_mutex);
@@ -2065,6 +2560,7 @@ Mavlink::display_status()
 		printf("\tremote noise:\t%u\n", _rstatus.remote_noise);
 		printf("\trx errors:\t%u\n", _rstatus.rxerrors);
 		printf("\tfixed:\t\t%u\n", _rstatus.fixed);
+		printf("\tlink ceiling:\t%.2f\n", (double)_radio_ceiling);
 
 	} else {
 		printf("\tno telem status.\n");
@@ -2075,6 +2571,20 @@ Mavlink::display_status()
 	printf("\ttxerr: %.3f kB/s\n", (double)_rate_txerr);
 	printf("\trx: %.3f kB/s\n", (double)_rate_rx);
 	printf("\trate mult: %.3f\n", (double)_rate_mult);
+	printf("\tstatus texts: %u queued, %u rate limited\n", _log_ring.head, _log_ring.dropped);
+
+	printf("\tstreams:\t\t\t  class    rate  achieved  deferred\n");
+
+	MavlinkStream *stream;
+	LL_FOREACH(_streams, stream) {
+		printf("\t%-28s %u %7.1f %9.1f %9.1f\n", stream->get_name(), (unsigned)stream->get_priority(),
+		       (double)(1000000.0f / stream->get_interval()), (double)stream->get_rate_achieved(),
+		       (double)stream->get_rate_deferred());
+	}
+
+	if (_receiver != nullptr) {
+		_receiver->print_status();
+	}
 }
 
 int
@@ -2128,6 +2638,9 @@ Mavlink::stream_command(int argc, char *argv[])
 			temp_int_arg = strtoul(argv[i + 1], &eptr, 10);
 			if ( *eptr == '\0' ) {
 				network_port = temp_int_arg;
+#ifdef __PX4_LINUX
+				network_port = px4::instance_port(network_port);
+#endif
 			} else {
 				err_flag = true;
 			}
@@ -2177,7 +2690,7 @@ Mavlink::stream_command(int argc, char *argv[])
 
 static void usage()
 {
-	warnx("usage: mavlink {start|stop-all|stream} [-d device] [-u udp_port] [-b baudrate]\n\t[-r rate][-m mode] [-s stream] [-f] [-p] [-v] [-w] [-x]");
+	warnx("usage: mavlink {start|stop-all|stream} [-d device] [-u udp_port] [-b baudrate]\n\t[-r rate][-m mode] [-s stream] [-f] [-p] [-v] [-w] [-x] [-B]");
 }
 
 int mavlink_main(int argc, char *argv[])
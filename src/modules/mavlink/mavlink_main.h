@@ -67,6 +67,25 @@
 #include "mavlink_mission.h"
 #include "mavlink_parameters.h"
 #include "mavlink_ftp.h"
+#include "mavlink_log_stream.h"
+
+#ifdef __PX4_POSIX
+#include <sys/uio.h>
+
+#ifdef __PX4_LINUX
+#define MAVLINK_UDP_MMSG			///< sendmmsg() and recvmmsg() are available
+#endif
+
+#define MAVLINK_TX_DATAGRAM_SIZE	1472	///< coalesced UDP datagrams fit one Ethernet frame
+#define MAVLINK_TX_MAX_MESSAGES		64	///< messages per datagram
+#define MAVLINK_TX_MAX_DATAGRAMS	8	///< datagrams sent with one sendmmsg() in batched mode
+#define MAVLINK_TX_BUFFER_SIZE		(2048 * MAVLINK_TX_MAX_DATAGRAMS)	///< datagrams plus payload alignment padding
+#define MAVLINK_RX_MAX_DATAGRAMS	8	///< datagrams received with one recvmmsg() in batched mode
+#else
+#define MAVLINK_TX_BUFFER_SIZE		(MAVLINK_MAX_PACKET_LEN + 8)
+#endif
+
+class MavlinkReceiver;
 
 enum Protocol {
 	SERIAL = 0,
@@ -165,6 +184,16 @@ public:
 
 	bool			get_forwarding_on() { return _forwarding_on; }
 
+	/**
+	 * @return true if UDP datagrams are sent and received in batches (sendmmsg / recvmmsg)
+	 */
+	bool			get_batch_io() { return _batch_io; }
+
+	/**
+	 * Set by the receive thread so its statistics show up in the status output
+	 */
+	void			set_receiver(MavlinkReceiver *receiver) { _receiver = receiver; }
+
 	/**
 	 * Set the boot complete flag on all instances
 	 *
@@ -180,6 +209,13 @@ public:
 	 */
 	unsigned		get_free_tx_buf();
 
+	/**
+	 * Get the bytes the streams may still send in this main loop iteration
+	 *
+	 * @return remaining link budget after the bytes sent since it was last charged
+	 */
+	unsigned		get_tx_budget();
+
 	static int		start_helper(int argc, char *argv[]);
 
 	/**
@@ -224,13 +260,42 @@ public:
 	void			send_message(const uint8_t msgid, const void *msg, uint8_t component_ID = 0);
 
 	/**
-	 * Resend message as is, don't change sequence number and CRC.
+	 * Start a message directly in the transmit buffer.
+	 *
+	 * On success the send lock is held until tx_commit(), the caller fills
+	 * in the payload (e.g. a mavlink_attitude_t) in place and must not
+	 * send anything else in between.
+	 *
+	 * @return pointer to the payload, nullptr if the message can't be sent now
+	 */
+	void			*tx_begin(const uint8_t msgid, uint8_t component_ID = 0);
+
+	/**
+	 * Finish the message started with tx_begin() and send it or queue it for the next flush.
+	 */
+	void			tx_commit();
+
+	/**
+	 * Send a packed frame of another system as is, keeping its sequence number and CRC.
 	 */
-	void			resend_message(mavlink_message_t *msg);
+	void			send_frame(const uint8_t *frame, unsigned len);
 
 	void			handle_message(const mavlink_message_t *msg);
 
-	MavlinkOrbSubscription *add_orb_subscription(const orb_id_t topic, int instance=0);
+	/**
+	 * Get a subscription of this instance, created on first use.
+	 *
+	 * @param shared	read the topic through a copy shared by all instances of
+	 *			the process; use false to poll or orb_check() the handle or
+	 *			to read every element of a queued topic
+	 */
+	MavlinkOrbSubscription *add_orb_subscription(const orb_id_t topic, int instance=0, bool shared=true);
+
+	/**
+	 * Release a subscription obtained by add_orb_subscription(), it is closed
+	 * once no user is left.
+	 */
+	void			remove_orb_subscription(MavlinkOrbSubscription *sub);
 
 	int			get_instance_id();
 
@@ -282,6 +347,19 @@ public:
 	 * @param severity the log level
 	 */
 	void			send_statustext(unsigned char severity, const char *string);
+
+	/**
+	 * @return true if a status text for this link is queued
+	 */
+	bool			log_message_pending();
+
+	/**
+	 * Take the next status text for this link, the ones queued by
+	 * send_statustext() before the system wide mavlink_log_xxx() ones.
+	 *
+	 * @return true if a message was copied to msg
+	 */
+	bool			read_log_message(struct mavlink_logmessage *msg);
 	void 			send_autopilot_capabilites();
 
 	MavlinkStream *		get_streams() const { return _streams; }
@@ -308,7 +386,7 @@ public:
 	/**
 	 * Count transmitted bytes
 	 */
-	void			count_txbytes(unsigned n) { _bytes_tx += n; };
+	void			count_txbytes(unsigned n) { _bytes_tx += n; _bytes_tx_total += n; };
 
 	/**
 	 * Count bytes not transmitted because of errors
@@ -325,8 +403,6 @@ public:
 	 */
 	struct telemetry_status_s&	get_rx_status() { return _rstatus; }
 
-	struct mavlink_logbuffer	*get_logbuffer() { return &_logbuffer; }
-
 	unsigned		get_system_type() { return _system_type; }
 
 	Protocol 		get_protocol() { return _protocol; };
@@ -366,16 +442,18 @@ private:
 	MavlinkMissionManager		*_mission_manager;
 	MavlinkParametersManager	*_parameters_manager;
 	MavlinkFTP			*_mavlink_ftp;
+	MavlinkLogStream		*_log_stream;
 
 	MAVLINK_MODE 		_mode;
 
 	mavlink_channel_t	_channel;
 	int32_t			_radio_id;
 
-	struct mavlink_logbuffer _logbuffer;
-	unsigned int		_total_counter;
+	struct mavlink_logbuffer _logbuffer;	///< messages for this link only
+	unsigned		_log_seq;	///< read cursor in the shared log ring
 
 	pthread_t		_receive_thread;
+	MavlinkReceiver		*_receiver;
 
 	bool			_verbose;
 	bool			_forwarding_on;
@@ -388,6 +466,13 @@ private:
 	int			_datarate_events;	///< data rate for params, waypoints, text messages
 	float			_rate_mult;
 	hrt_abstime		_last_hw_rate_timestamp;
+	uint16_t		_last_radio_rxerrors;	///< rxerrors of the previous radio status
+	float			_radio_ceiling;		///< highest rate mult the radio link quality allows
+
+	float			_tx_budget;		///< bytes the streams may still send
+	hrt_abstime		_tx_budget_time;	///< last budget refill
+	hrt_abstime		_tx_budget_ready;	///< time a deferred stream fits the budget again, 0 if none
+	unsigned		_tx_budget_mark;	///< _bytes_tx_total already charged to the budget
 
 	/**
 	 * If the queue index is not at 0, the queue sending
@@ -407,6 +492,7 @@ private:
 	uint64_t		_last_write_try_time;
 
 	unsigned		_bytes_tx;
+	unsigned		_bytes_tx_total;	///< transmitted bytes, never reset
 	unsigned		_bytes_txerr;
 	unsigned		_bytes_rx;
 	uint64_t		_bytes_timestamp;
@@ -437,6 +523,22 @@ private:
 	pthread_mutex_t		_message_buffer_mutex;
 	pthread_mutex_t		_send_mutex;
 
+	/* serialized messages not written yet, each payload starts 8 byte aligned so it can be filled in place */
+	uint8_t			_tx_buf[MAVLINK_TX_BUFFER_SIZE] __attribute__((aligned(8)));
+	unsigned		_tx_buf_used;		///< bytes of _tx_buf in use including padding
+	unsigned		_tx_pending;		///< message bytes waiting for flush_tx()
+	uint8_t			*_tx_msg;		///< message started with tx_begin()
+	unsigned		_tx_msg_len;		///< length of the message started with tx_begin()
+	bool			_tx_coalesce;		///< queue UDP messages until flush_tx() instead of sending each, guarded by _send_mutex
+#ifdef __PX4_POSIX
+	struct iovec		_tx_iov[MAVLINK_TX_MAX_DATAGRAMS * MAVLINK_TX_MAX_MESSAGES];	///< pending messages
+	unsigned		_tx_iov_count;
+	unsigned		_tx_dgram_first[MAVLINK_TX_MAX_DATAGRAMS];	///< first _tx_iov entry of each datagram
+	unsigned		_tx_dgram_count;	///< pending datagrams, the last one is still filled
+	unsigned		_tx_dgram_len;		///< bytes in the last datagram
+#endif
+	bool			_batch_io;		///< send and receive several UDP datagrams per system call
+
 	bool			_param_initialized;
 	param_t			_param_system_id;
 	param_t			_param_component_id;
@@ -461,6 +563,9 @@ private:
 	static constexpr unsigned RADIO_BUFFER_CRITICAL_LOW_PERCENTAGE = 25;
 	static constexpr unsigned RADIO_BUFFER_LOW_PERCENTAGE = 35;
 	static constexpr unsigned RADIO_BUFFER_HALF_PERCENTAGE = 50;
+	static constexpr float RADIO_RATE_GAIN = 0.1f;		///< rate change per radio status at an empty or full buffer
+	static constexpr int RADIO_FADE_MARGIN_GOOD = 40;	///< rssi above noise (about 20 dB) that carries the full rate
+	static constexpr float RADIO_CEILING_MIN = 0.3f;
 
 	int configure_stream(const char *stream_name, const float rate);
 
@@ -483,13 +588,47 @@ private:
 
 	void message_buffer_mark_read(int n);
 
-	void pass_message(const mavlink_message_t *msg);
+	/**
+	 * Pull the next whole frame out of the message buffer.
+	 *
+	 * @return length of the frame, 0 if the buffer is empty
+	 */
+	unsigned message_buffer_read_frame(uint8_t *frame);
+
+	void pass_message(const uint8_t *frame, unsigned len);
 
 	/**
-	 * Update rate mult so total bitrate will be equal to _datarate.
+	 * Reserve room for a packet of len bytes in the transmit buffer and take the send lock.
+	 *
+	 * @return start of the packet, nullptr (and the lock released) if it can't be sent now
+	 */
+	uint8_t			*tx_reserve(unsigned len);
+
+	/**
+	 * Account the packet placed with tx_reserve(), send or queue it and release the send lock.
+	 */
+	void			tx_finish();
+
+	/**
+	 * Write out everything in the transmit buffer, the send lock has to be held.
+	 */
+	void			flush_tx();
+
+	/**
+	 * Update rate mult from the radio feedback and TX error rate.
 	 */
 	void update_rate_mult();
 
+	/**
+	 * Update all due streams in priority order as long as they fit the link budget.
+	 */
+	void update_streams(const hrt_abstime t);
+
+	/**
+	 * Subtract everything transmitted since the last call from the link budget.
+	 */
+	void charge_tx_budget();
+
 	void init_udp();
 
 #ifdef __PX4_NUTTX
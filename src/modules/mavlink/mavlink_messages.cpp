@@ -47,6 +47,8 @@
 #include <lib/geo/geo.h>
 #include <uORB/uORB.h>
 #include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_accel.h>
 #include <uORB/topics/vehicle_attitude.h>
 #include <uORB/topics/vehicle_gps_position.h>
 #include <uORB/topics/vehicle_global_position.h>
@@ -72,6 +74,7 @@
 #include <uORB/topics/navigation_capabilities.h>
 #include <uORB/topics/distance_sensor.h>
 #include <uORB/topics/camera_trigger.h>
+#include <uORB/topics/task_stats.h>
 #include <drivers/drv_rc_input.h>
 #include <drivers/drv_pwm_output.h>
 #include <systemlib/err.h>
@@ -271,6 +274,11 @@ public:
 		return MAVLINK_MSG_ID_HEARTBEAT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_STATUS;
+	}
+
 	bool const_rate() {
 		return true;
 	}
@@ -285,8 +293,8 @@ private:
 
 protected:
 	explicit MavlinkStreamHeartbeat(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_status_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_status))),
-		_pos_sp_triplet_sub(_mavlink->add_orb_subscription(ORB_ID(position_setpoint_triplet)))
+		_status_sub(subscribe(ORB_ID(vehicle_status))),
+		_pos_sp_triplet_sub(subscribe(ORB_ID(position_setpoint_triplet)))
 	{}
 
 	void send(const hrt_abstime t)
@@ -342,7 +350,12 @@ public:
 	}
 
 	unsigned get_size() {
-		return mavlink_logbuffer_is_empty(_mavlink->get_logbuffer()) ? 0 : (MAVLINK_MSG_ID_STATUSTEXT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES);
+		return _mavlink->log_message_pending() ? (MAVLINK_MSG_ID_STATUSTEXT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) : 0;
+	}
+
+	Priority get_priority()
+	{
+		return PRIORITY_STATUS;
 	}
 
 private:
@@ -366,11 +379,10 @@ protected:
 #ifndef __PX4_QURT
 	void send(const hrt_abstime t)
 	{
-		if (!mavlink_logbuffer_is_empty(_mavlink->get_logbuffer())) {
+		if (_mavlink->log_message_pending()) {
 			struct mavlink_logmessage logmsg;
-			int lb_ret = mavlink_logbuffer_read(_mavlink->get_logbuffer(), &logmsg);
 
-			if (lb_ret == OK) {
+			if (_mavlink->read_log_message(&logmsg)) {
 				mavlink_statustext_t msg;
 
 				msg.severity = logmsg.severity;
@@ -455,6 +467,11 @@ public:
 		return 0;	// commands stream is not regular and not predictable
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_STATUS;
+	}
+
 private:
 	MavlinkOrbSubscription *_cmd_sub;
 	uint64_t _cmd_time;
@@ -465,7 +482,7 @@ private:
 
 protected:
 	explicit MavlinkStreamCommandLong(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_cmd_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_command))),
+		_cmd_sub(subscribe(ORB_ID(vehicle_command))),
 		_cmd_time(0)
 	{}
 
@@ -524,6 +541,11 @@ public:
 		return MAVLINK_MSG_ID_SYS_STATUS_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_STATUS;
+	}
+
 private:
 	MavlinkOrbSubscription *_status_sub;
 
@@ -533,7 +555,7 @@ private:
 
 protected:
 	explicit MavlinkStreamSysStatus(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_status_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_status)))
+		_status_sub(subscribe(ORB_ID(vehicle_status)))
 	{}
 
 	void send(const hrt_abstime t)
@@ -613,6 +635,11 @@ public:
 		return MAVLINK_MSG_ID_HIGHRES_IMU_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_DEBUG;
+	}
+
 private:
 	MavlinkOrbSubscription *_sensor_sub;
 	uint64_t _sensor_time;
@@ -628,7 +655,7 @@ private:
 
 protected:
 	explicit MavlinkStreamHighresIMU(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_sensor_sub(_mavlink->add_orb_subscription(ORB_ID(sensor_combined))),
+		_sensor_sub(subscribe(ORB_ID(sensor_combined))),
 		_sensor_time(0),
 		_accel_timestamp(0),
 		_gyro_timestamp(0),
@@ -667,26 +694,208 @@ protected:
 				_baro_timestamp = sensor.baro_timestamp[0];
 			}
 
-			mavlink_highres_imu_t msg;
-
-			msg.time_usec = sensor.timestamp;
-			msg.xacc = sensor.accelerometer_m_s2[0];
-			msg.yacc = sensor.accelerometer_m_s2[1];
-			msg.zacc = sensor.accelerometer_m_s2[2];
-			msg.xgyro = sensor.gyro_rad_s[0];
-			msg.ygyro = sensor.gyro_rad_s[1];
-			msg.zgyro = sensor.gyro_rad_s[2];
-			msg.xmag = sensor.magnetometer_ga[0];
-			msg.ymag = sensor.magnetometer_ga[1];
-			msg.zmag = sensor.magnetometer_ga[2];
-			msg.abs_pressure = sensor.baro_pres_mbar[0];
-			msg.diff_pressure = sensor.differential_pressure_pa[0];
-			msg.pressure_alt = sensor.baro_alt_meter[0];
-			msg.temperature = sensor.baro_temp_celcius[0];
-			msg.fields_updated = fields_updated;
-
-			_mavlink->send_message(MAVLINK_MSG_ID_HIGHRES_IMU, &msg);
+			/* pack directly into the transmit buffer */
+			mavlink_highres_imu_t *msg = (mavlink_highres_imu_t *)_mavlink->tx_begin(MAVLINK_MSG_ID_HIGHRES_IMU);
+
+			if (msg != nullptr) {
+				msg->time_usec = sensor.timestamp;
+				msg->xacc = sensor.accelerometer_m_s2[0];
+				msg->yacc = sensor.accelerometer_m_s2[1];
+				msg->zacc = sensor.accelerometer_m_s2[2];
+				msg->xgyro = sensor.gyro_rad_s[0];
+				msg->ygyro = sensor.gyro_rad_s[1];
+				msg->zgyro = sensor.gyro_rad_s[2];
+				msg->xmag = sensor.magnetometer_ga[0];
+				msg->ymag = sensor.magnetometer_ga[1];
+				msg->zmag = sensor.magnetometer_ga[2];
+				msg->abs_pressure = sensor.baro_pres_mbar[0];
+				msg->diff_pressure = sensor.differential_pressure_pa[0];
+				msg->pressure_alt = sensor.baro_alt_meter[0];
+				msg->temperature = sensor.baro_temp_celcius[0];
+				msg->fields_updated = fields_updated;
+
+				_mavlink->tx_commit();
+			}
+		}
+	}
+};
+
+
+/**
+ * Batches of the integrated gyro and accel deltas of the primary IMU,
+ * for external estimators that need every sample instead of the latest.
+ *
+ * The drivers queue their reports (SENSOR_ORB_QUEUE_SIZE), each one
+ * covering its integral_dt since the previous report, and this stream
+ * packs all of them into V2_EXTENSION messages of type
+ * IMU_BATCH_MESSAGE_TYPE. The little endian payload is
+ *
+ *   uint64 timestamp of the first sample [us]
+ *   uint8  sensor, 0 gyro or 1 accel
+ *   uint8  number of samples
+ *   per sample:
+ *   uint16 time since the previous sample [us], 0 for the first
+ *   uint16 integral_dt [us]
+ *   int16  x, y, z delta angle [1e-5 rad] or delta velocity [1e-4 m/s]
+ */
+class MavlinkStreamIMUBatch : public MavlinkStream
+{
+public:
+	const char *get_name() const
+	{
+		return MavlinkStreamIMUBatch::get_name_static();
+	}
+
+	static const char *get_name_static()
+	{
+		return "IMU_BATCH";
+	}
+
+	uint8_t get_id()
+	{
+		return MAVLINK_MSG_ID_V2_EXTENSION;
+	}
+
+	static MavlinkStream *new_instance(Mavlink *mavlink)
+	{
+		return new MavlinkStreamIMUBatch(mavlink);
+	}
+
+	unsigned get_size()
+	{
+		/* one batch per sensor */
+		return 2 * (MAVLINK_MSG_ID_V2_EXTENSION_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES);
+	}
+
+	Priority get_priority()
+	{
+		return PRIORITY_DEBUG;
+	}
+
+	/* local experiment range, see the V2_EXTENSION definition */
+	static const uint16_t IMU_BATCH_MESSAGE_TYPE = 32768 + 1;
+
+private:
+	enum {
+		SENSOR_GYRO = 0,
+		SENSOR_ACCEL = 1,
+		HEADER_SIZE = 10,
+		SAMPLE_SIZE = 10,
+		MAX_SAMPLES = (sizeof(((mavlink_v2_extension_t *)0)->payload) - HEADER_SIZE) / SAMPLE_SIZE
+	};
+
+	MavlinkOrbSubscription *_gyro_sub;
+	MavlinkOrbSubscription *_accel_sub;
+
+	/* report that did not fit into the previous batch */
+	struct sensor_gyro_s _gyro_pending;
+	struct sensor_accel_s _accel_pending;
+	bool _gyro_has_pending;
+	bool _accel_has_pending;
+
+	/* do not allow top copying this class */
+	MavlinkStreamIMUBatch(MavlinkStreamIMUBatch &);
+	MavlinkStreamIMUBatch& operator = (const MavlinkStreamIMUBatch &);
+
+	static void put_uint16(uint8_t *buf, unsigned value)
+	{
+		buf[0] = value & 0xff;
+		buf[1] = (value >> 8) & 0xff;
+	}
+
+	static void put_scaled(uint8_t *buf, float value, float scale)
+	{
+		float scaled = roundf(value * scale);
+
+		if (scaled > INT16_MAX) {
+			scaled = INT16_MAX;
+
+		} else if (scaled < INT16_MIN) {
+			scaled = INT16_MIN;
+		}
+
+		put_uint16(buf, (uint16_t)(int16_t)scaled);
+	}
+
+	/**
+	 * Drain the queued reports of one sensor into a single message.
+	 */
+	template <typename R>
+	void send_batch(MavlinkOrbSubscription *sub, R &pending, bool &has_pending, uint8_t sensor, float scale)
+	{
+		mavlink_v2_extension_t msg;
+		uint8_t *sample = &msg.payload[HEADER_SIZE];
+		uint64_t first = 0;
+		uint64_t last = 0;
+		unsigned count = 0;
+
+		while (count < MAX_SAMPLES) {
+			if (!has_pending) {
+				bool updated = false;
+				orb_check(sub->get_fd(), &updated);
+
+				if (!updated || !sub->update(&pending)) {
+					break;
+				}
+
+				has_pending = true;
+			}
+
+			if (count == 0) {
+				first = pending.timestamp;
+				last = first;
+
+			} else if (pending.timestamp < last || pending.timestamp - last > UINT16_MAX) {
+				/* gap too large for the delta encoding, start the next batch with it */
+				break;
+			}
+
+			put_uint16(&sample[0], pending.timestamp - last);
+			put_uint16(&sample[2], (pending.integral_dt < UINT16_MAX) ? pending.integral_dt : UINT16_MAX);
+			put_scaled(&sample[4], pending.x_integral, scale);
+			put_scaled(&sample[6], pending.y_integral, scale);
+			put_scaled(&sample[8], pending.z_integral, scale);
+
+			last = pending.timestamp;
+			has_pending = false;
+			sample += SAMPLE_SIZE;
+			count++;
+		}
+
+		if (count == 0) {
+			return;
+		}
+
+		msg.message_type = IMU_BATCH_MESSAGE_TYPE;
+		msg.target_network = 0;
+		msg.target_system = 0;
+		msg.target_component = 0;
+
+		for (unsigned i = 0; i < 8; i++) {
+			msg.payload[i] = (first >> (8 * i)) & 0xff;
 		}
+
+		msg.payload[8] = sensor;
+		msg.payload[9] = count;
+		memset(sample, 0, &msg.payload[sizeof(msg.payload)] - sample);
+
+		_mavlink->send_message(MAVLINK_MSG_ID_V2_EXTENSION, &msg);
+	}
+
+protected:
+	explicit MavlinkStreamIMUBatch(Mavlink *mavlink) : MavlinkStream(mavlink),
+		_gyro_sub(subscribe(ORB_ID(sensor_gyro), 0, false)),
+		_accel_sub(subscribe(ORB_ID(sensor_accel), 0, false)),
+		_gyro_pending(),
+		_accel_pending(),
+		_gyro_has_pending(false),
+		_accel_has_pending(false)
+	{}
+
+	void send(const hrt_abstime t)
+	{
+		send_batch(_gyro_sub, _gyro_pending, _gyro_has_pending, SENSOR_GYRO, 1e5f);
+		send_batch(_accel_sub, _accel_pending, _accel_has_pending, SENSOR_ACCEL, 1e4f);
 	}
 };
 
@@ -719,6 +928,11 @@ public:
 		return MAVLINK_MSG_ID_ATTITUDE_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_ATTITUDE;
+	}
+
 private:
 	MavlinkOrbSubscription *_att_sub;
 	uint64_t _att_time;
@@ -730,7 +944,7 @@ private:
 
 protected:
 	explicit MavlinkStreamAttitude(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_att_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_attitude))),
+		_att_sub(subscribe(ORB_ID(vehicle_attitude))),
 		_att_time(0)
 	{}
 
@@ -739,17 +953,20 @@ protected:
 		struct vehicle_attitude_s att;
 
 		if (_att_sub->update(&_att_time, &att)) {
-			mavlink_attitude_t msg;
-
-			msg.time_boot_ms = att.timestamp / 1000;
-			msg.roll = att.roll;
-			msg.pitch = att.pitch;
-			msg.yaw = att.yaw;
-			msg.rollspeed = att.rollspeed;
-			msg.pitchspeed = att.pitchspeed;
-			msg.yawspeed = att.yawspeed;
-
-			_mavlink->send_message(MAVLINK_MSG_ID_ATTITUDE, &msg);
+			/* pack directly into the transmit buffer */
+			mavlink_attitude_t *msg = (mavlink_attitude_t *)_mavlink->tx_begin(MAVLINK_MSG_ID_ATTITUDE);
+
+			if (msg != nullptr) {
+				msg->time_boot_ms = att.timestamp / 1000;
+				msg->roll = att.roll;
+				msg->pitch = att.pitch;
+				msg->yaw = att.yaw;
+				msg->rollspeed = att.rollspeed;
+				msg->pitchspeed = att.pitchspeed;
+				msg->yawspeed = att.yawspeed;
+
+				_mavlink->tx_commit();
+			}
 		}
 	}
 };
@@ -783,6 +1000,11 @@ public:
 		return MAVLINK_MSG_ID_ATTITUDE_QUATERNION_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_ATTITUDE;
+	}
+
 private:
 	MavlinkOrbSubscription *_att_sub;
 	uint64_t _att_time;
@@ -793,7 +1015,7 @@ private:
 
 protected:
 	explicit MavlinkStreamAttitudeQuaternion(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_att_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_attitude))),
+		_att_sub(subscribe(ORB_ID(vehicle_attitude))),
 		_att_time(0)
 	{}
 
@@ -848,6 +1070,11 @@ public:
 		return MAVLINK_MSG_ID_VFR_HUD_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_ATTITUDE;
+	}
+
 private:
 	MavlinkOrbSubscription *_att_sub;
 	uint64_t _att_time;
@@ -870,15 +1097,15 @@ private:
 
 protected:
 	explicit MavlinkStreamVFRHUD(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_att_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_attitude))),
+		_att_sub(subscribe(ORB_ID(vehicle_attitude))),
 		_att_time(0),
-		_pos_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_global_position))),
+		_pos_sub(subscribe(ORB_ID(vehicle_global_position))),
 		_pos_time(0),
-		_armed_sub(_mavlink->add_orb_subscription(ORB_ID(actuator_armed))),
+		_armed_sub(subscribe(ORB_ID(actuator_armed))),
 		_armed_time(0),
-		_act_sub(_mavlink->add_orb_subscription(ORB_ID(actuator_controls_0))),
+		_act_sub(subscribe(ORB_ID(actuator_controls_0))),
 		_act_time(0),
-		_airspeed_sub(_mavlink->add_orb_subscription(ORB_ID(airspeed))),
+		_airspeed_sub(subscribe(ORB_ID(airspeed))),
 		_airspeed_time(0)
 	{}
 
@@ -950,7 +1177,7 @@ private:
 
 protected:
 	explicit MavlinkStreamGPSRawInt(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_gps_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_gps_position))),
+		_gps_sub(subscribe(ORB_ID(vehicle_gps_position))),
 		_gps_time(0)
 	{}
 
@@ -1000,6 +1227,11 @@ public:
 		return MAVLINK_MSG_ID_SYSTEM_TIME_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_STATUS;
+	}
+
 private:
 	/* do not allow top copying this class */
 	MavlinkStreamSystemTime(MavlinkStreamSystemTime &);
@@ -1045,6 +1277,11 @@ public:
 		return MAVLINK_MSG_ID_TIMESYNC_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_STATUS;
+	}
+
 private:
 	/* do not allow top copying this class */
 	MavlinkStreamTimesync(MavlinkStreamTimesync &);
@@ -1095,7 +1332,6 @@ public:
 
 private:
 	MavlinkOrbSubscription *_trigger_sub;
-	uint64_t _trigger_time;
 
 	/* do not allow top copying this class */
 	MavlinkStreamCameraTrigger(MavlinkStreamCameraTrigger &);
@@ -1103,15 +1339,16 @@ private:
 
 protected:
 	explicit MavlinkStreamCameraTrigger(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_trigger_sub(_mavlink->add_orb_subscription(ORB_ID(camera_trigger))),
-		_trigger_time(0)
+		_trigger_sub(subscribe(ORB_ID(camera_trigger), 0, false))
 	{}
 
 	void send(const hrt_abstime t)
 	{
 		struct camera_trigger_s trigger;
+		bool updated = false;
 
-		if (_trigger_sub->update(&_trigger_time, &trigger)) {
+		/* the topic is queued, send all events published since the last call */
+		while (orb_check(_trigger_sub->get_fd(), &updated) == OK && updated && _trigger_sub->update(&trigger)) {
 			mavlink_camera_trigger_t msg;
 
 			msg.time_usec = trigger.timestamp;
@@ -1166,9 +1403,9 @@ private:
 
 protected:
 	explicit MavlinkStreamGlobalPositionInt(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_pos_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_global_position))),
+		_pos_sub(subscribe(ORB_ID(vehicle_global_position))),
 		_pos_time(0),
-		_home_sub(_mavlink->add_orb_subscription(ORB_ID(home_position))),
+		_home_sub(subscribe(ORB_ID(home_position))),
 		_home_time(0)
 	{}
 
@@ -1237,7 +1474,7 @@ private:
 
 protected:
 	explicit MavlinkStreamLocalPositionNED(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_pos_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_local_position))),
+		_pos_sub(subscribe(ORB_ID(vehicle_local_position))),
 		_pos_time(0)
 	{}
 
@@ -1300,7 +1537,7 @@ private:
 
 protected:
 	explicit MavlinkStreamAttPosMocap(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_mocap_sub(_mavlink->add_orb_subscription(ORB_ID(att_pos_mocap))),
+		_mocap_sub(subscribe(ORB_ID(att_pos_mocap))),
 		_mocap_time(0)
 	{}
 
@@ -1363,7 +1600,7 @@ private:
 
 protected:
 	explicit MavlinkStreamGPSGlobalOrigin(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_home_sub(_mavlink->add_orb_subscription(ORB_ID(home_position)))
+		_home_sub(subscribe(ORB_ID(home_position)))
 	{}
 
 	void send(const hrt_abstime t)
@@ -1428,6 +1665,11 @@ public:
 		return MAVLINK_MSG_ID_SERVO_OUTPUT_RAW_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_DEBUG;
+	}
+
 private:
 	MavlinkOrbSubscription *_act_sub;
 	uint64_t _act_time;
@@ -1441,7 +1683,7 @@ protected:
 		_act_sub(nullptr),
 		_act_time(0)
 	{
-		_act_sub = _mavlink->add_orb_subscription(ORB_ID(actuator_outputs), N);
+		_act_sub = subscribe(ORB_ID(actuator_outputs), N);
 	}
 
 	void send(const hrt_abstime t)
@@ -1508,6 +1750,11 @@ public:
 		return _att_ctrl_sub->is_published() ? (MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_DEBUG;
+	}
+
 private:
 	MavlinkOrbSubscription *_att_ctrl_sub;
 	uint64_t _att_ctrl_time;
@@ -1524,19 +1771,19 @@ protected:
 		// XXX this can be removed once the multiplatform system remaps topics
 		switch (N) {
 			case 0:
-			_att_ctrl_sub = _mavlink->add_orb_subscription(ORB_ID(actuator_controls_0));
+			_att_ctrl_sub = subscribe(ORB_ID(actuator_controls_0));
 			break;
 
 			case 1:
-			_att_ctrl_sub = _mavlink->add_orb_subscription(ORB_ID(actuator_controls_1));
+			_att_ctrl_sub = subscribe(ORB_ID(actuator_controls_1));
 			break;
 
 			case 2:
-			_att_ctrl_sub = _mavlink->add_orb_subscription(ORB_ID(actuator_controls_2));
+			_att_ctrl_sub = subscribe(ORB_ID(actuator_controls_2));
 			break;
 
 			case 3:
-			_att_ctrl_sub = _mavlink->add_orb_subscription(ORB_ID(actuator_controls_3));
+			_att_ctrl_sub = subscribe(ORB_ID(actuator_controls_3));
 			break;
 		}
 	}
@@ -1589,6 +1836,11 @@ public:
 		return MAVLINK_MSG_ID_HIL_CONTROLS_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_ATTITUDE;
+	}
+
 private:
 	MavlinkOrbSubscription *_status_sub;
 	uint64_t _status_time;
@@ -1605,11 +1857,11 @@ private:
 
 protected:
 	explicit MavlinkStreamHILControls(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_status_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_status))),
+		_status_sub(subscribe(ORB_ID(vehicle_status))),
 		_status_time(0),
-		_pos_sp_triplet_sub(_mavlink->add_orb_subscription(ORB_ID(position_setpoint_triplet))),
+		_pos_sp_triplet_sub(subscribe(ORB_ID(position_setpoint_triplet))),
 		_pos_sp_triplet_time(0),
-		_act_sub(_mavlink->add_orb_subscription(ORB_ID(actuator_outputs))),
+		_act_sub(subscribe(ORB_ID(actuator_outputs))),
 		_act_time(0)
 	{}
 
@@ -1764,7 +2016,7 @@ private:
 
 protected:
 	explicit MavlinkStreamPositionTargetGlobalInt(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_pos_sp_triplet_sub(_mavlink->add_orb_subscription(ORB_ID(position_setpoint_triplet)))
+		_pos_sp_triplet_sub(subscribe(ORB_ID(position_setpoint_triplet)))
 	{}
 
 	void send(const hrt_abstime t)
@@ -1824,7 +2076,7 @@ private:
 
 protected:
 	explicit MavlinkStreamLocalPositionSetpoint(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_pos_sp_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_local_position_setpoint))),
+		_pos_sp_sub(subscribe(ORB_ID(vehicle_local_position_setpoint))),
 		_pos_sp_time(0)
 	{}
 
@@ -1879,6 +2131,11 @@ public:
 		return MAVLINK_MSG_ID_ATTITUDE_TARGET_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_ATTITUDE;
+	}
+
 private:
 	MavlinkOrbSubscription *_att_sp_sub;
 	MavlinkOrbSubscription *_att_rates_sp_sub;
@@ -1891,8 +2148,8 @@ private:
 
 protected:
 	explicit MavlinkStreamAttitudeTarget(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_att_sp_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_attitude_setpoint))),
-		_att_rates_sp_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_rates_setpoint))),
+		_att_sp_sub(subscribe(ORB_ID(vehicle_attitude_setpoint))),
+		_att_rates_sp_sub(subscribe(ORB_ID(vehicle_rates_setpoint))),
 		_att_sp_time(0),
 		_att_rates_sp_time(0)
 	{}
@@ -1961,7 +2218,7 @@ private:
 
 protected:
 	explicit MavlinkStreamRCChannels(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_rc_sub(_mavlink->add_orb_subscription(ORB_ID(input_rc))),
+		_rc_sub(subscribe(ORB_ID(input_rc))),
 		_rc_time(0)
 	{}
 
@@ -2041,7 +2298,7 @@ private:
 
 protected:
 	explicit MavlinkStreamManualControl(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_manual_sub(_mavlink->add_orb_subscription(ORB_ID(manual_control_setpoint))),
+		_manual_sub(subscribe(ORB_ID(manual_control_setpoint))),
 		_manual_time(0)
 	{}
 
@@ -2099,6 +2356,11 @@ public:
 		return _flow_sub->is_published() ? (MAVLINK_MSG_ID_OPTICAL_FLOW_RAD_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_DEBUG;
+	}
+
 private:
 	MavlinkOrbSubscription *_flow_sub;
 	uint64_t _flow_time;
@@ -2109,7 +2371,7 @@ private:
 
 protected:
 	explicit MavlinkStreamOpticalFlowRad(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_flow_sub(_mavlink->add_orb_subscription(ORB_ID(optical_flow))),
+		_flow_sub(subscribe(ORB_ID(optical_flow))),
 		_flow_time(0)
 	{}
 
@@ -2167,6 +2429,11 @@ public:
 		return MAVLINK_MSG_ID_NAMED_VALUE_FLOAT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_DEBUG;
+	}
+
 private:
 	MavlinkOrbSubscription *_debug_sub;
 	uint64_t _debug_time;
@@ -2177,7 +2444,7 @@ private:
 
 protected:
 	explicit MavlinkStreamNamedValueFloat(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_debug_sub(_mavlink->add_orb_subscription(ORB_ID(debug_key_value))),
+		_debug_sub(subscribe(ORB_ID(debug_key_value))),
 		_debug_time(0)
 	{}
 
@@ -2200,6 +2467,73 @@ protected:
 };
 
 
+class MavlinkStreamTaskStats : public MavlinkStream
+{
+public:
+	const char *get_name() const
+	{
+		return MavlinkStreamTaskStats::get_name_static();
+	}
+
+	static const char *get_name_static()
+	{
+		return "TASK_STATS";
+	}
+
+	uint8_t get_id()
+	{
+		return MAVLINK_MSG_ID_NAMED_VALUE_FLOAT;
+	}
+
+	static MavlinkStream *new_instance(Mavlink *mavlink)
+	{
+		return new MavlinkStreamTaskStats(mavlink);
+	}
+
+	unsigned get_size()
+	{
+		return MAVLINK_MSG_ID_NAMED_VALUE_FLOAT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+	}
+
+	Priority get_priority()
+	{
+		return PRIORITY_DEBUG;
+	}
+
+private:
+	MavlinkOrbSubscription *_task_stats_sub;
+	uint64_t _task_stats_time;
+
+	/* do not allow top copying this class */
+	MavlinkStreamTaskStats(MavlinkStreamTaskStats &);
+	MavlinkStreamTaskStats& operator = (const MavlinkStreamTaskStats &);
+
+protected:
+	explicit MavlinkStreamTaskStats(Mavlink *mavlink) : MavlinkStream(mavlink),
+		_task_stats_sub(subscribe(ORB_ID(task_stats))),
+		_task_stats_time(0)
+	{}
+
+	void send(const hrt_abstime t)
+	{
+		struct task_stats_s stats;
+
+		/* load_mon publishes the tasks round robin, one per update */
+		if (_task_stats_sub->update(&_task_stats_time, &stats)) {
+			mavlink_named_value_float_t msg;
+
+			msg.time_boot_ms = stats.timestamp / 1000;
+			memcpy(msg.name, stats.name, sizeof(msg.name));
+			/* enforce null termination */
+			msg.name[sizeof(msg.name) - 1] = '\0';
+			msg.value = stats.load * 100.0f;
+
+			_mavlink->send_message(MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, &msg);
+		}
+	}
+};
+
+
 class MavlinkStreamCameraCapture : public MavlinkStream
 {
 public:
@@ -2237,7 +2571,7 @@ private:
 
 protected:
 	explicit MavlinkStreamCameraCapture(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_status_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_status)))
+		_status_sub(subscribe(ORB_ID(vehicle_status)))
 	{}
 
 	void send(const hrt_abstime t)
@@ -2302,7 +2636,7 @@ private:
 
 protected:
 	explicit MavlinkStreamDistanceSensor(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_distance_sensor_sub(_mavlink->add_orb_subscription(ORB_ID(distance_sensor))),
+		_distance_sensor_sub(subscribe(ORB_ID(distance_sensor))),
 		_dist_sensor_time(0)
 	{}
 
@@ -2385,7 +2719,7 @@ private:
 
 protected:
 	explicit MavlinkStreamVtolState(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_status_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_status)))
+		_status_sub(subscribe(ORB_ID(vehicle_status)))
 	{}
 
 	void send(const hrt_abstime t)
@@ -2422,41 +2756,43 @@ protected:
 	}
 };
 
-const StreamListItem *streams_list[] = {
-	new StreamListItem(&MavlinkStreamHeartbeat::new_instance, &MavlinkStreamHeartbeat::get_name_static),
-	new StreamListItem(&MavlinkStreamStatustext::new_instance, &MavlinkStreamStatustext::get_name_static),
-	new StreamListItem(&MavlinkStreamCommandLong::new_instance, &MavlinkStreamCommandLong::get_name_static),
-	new StreamListItem(&MavlinkStreamSysStatus::new_instance, &MavlinkStreamSysStatus::get_name_static),
-	new StreamListItem(&MavlinkStreamHighresIMU::new_instance, &MavlinkStreamHighresIMU::get_name_static),
-	new StreamListItem(&MavlinkStreamAttitude::new_instance, &MavlinkStreamAttitude::get_name_static),
-	new StreamListItem(&MavlinkStreamAttitudeQuaternion::new_instance, &MavlinkStreamAttitudeQuaternion::get_name_static),
-	new StreamListItem(&MavlinkStreamVFRHUD::new_instance, &MavlinkStreamVFRHUD::get_name_static),
-	new StreamListItem(&MavlinkStreamGPSRawInt::new_instance, &MavlinkStreamGPSRawInt::get_name_static),
-	new StreamListItem(&MavlinkStreamSystemTime::new_instance, &MavlinkStreamSystemTime::get_name_static),
-	new StreamListItem(&MavlinkStreamTimesync::new_instance, &MavlinkStreamTimesync::get_name_static),
-	new StreamListItem(&MavlinkStreamGlobalPositionInt::new_instance, &MavlinkStreamGlobalPositionInt::get_name_static),
-	new StreamListItem(&MavlinkStreamLocalPositionNED::new_instance, &MavlinkStreamLocalPositionNED::get_name_static),
-	new StreamListItem(&MavlinkStreamAttPosMocap::new_instance, &MavlinkStreamAttPosMocap::get_name_static),
-	new StreamListItem(&MavlinkStreamGPSGlobalOrigin::new_instance, &MavlinkStreamGPSGlobalOrigin::get_name_static),
-	new StreamListItem(&MavlinkStreamServoOutputRaw<0>::new_instance, &MavlinkStreamServoOutputRaw<0>::get_name_static),
-	new StreamListItem(&MavlinkStreamServoOutputRaw<1>::new_instance, &MavlinkStreamServoOutputRaw<1>::get_name_static),
-	new StreamListItem(&MavlinkStreamServoOutputRaw<2>::new_instance, &MavlinkStreamServoOutputRaw<2>::get_name_static),
-	new StreamListItem(&MavlinkStreamServoOutputRaw<3>::new_instance, &MavlinkStreamServoOutputRaw<3>::get_name_static),
-	new StreamListItem(&MavlinkStreamHILControls::new_instance, &MavlinkStreamHILControls::get_name_static),
-	new StreamListItem(&MavlinkStreamPositionTargetGlobalInt::new_instance, &MavlinkStreamPositionTargetGlobalInt::get_name_static),
-	new StreamListItem(&MavlinkStreamLocalPositionSetpoint::new_instance, &MavlinkStreamLocalPositionSetpoint::get_name_static),
-	new StreamListItem(&MavlinkStreamAttitudeTarget::new_instance, &MavlinkStreamAttitudeTarget::get_name_static),
-	new StreamListItem(&MavlinkStreamRCChannels::new_instance, &MavlinkStreamRCChannels::get_name_static),
-	new StreamListItem(&MavlinkStreamManualControl::new_instance, &MavlinkStreamManualControl::get_name_static),
-	new StreamListItem(&MavlinkStreamOpticalFlowRad::new_instance, &MavlinkStreamOpticalFlowRad::get_name_static),
-	new StreamListItem(&MavlinkStreamActuatorControlTarget<0>::new_instance, &MavlinkStreamActuatorControlTarget<0>::get_name_static),
-	new StreamListItem(&MavlinkStreamActuatorControlTarget<1>::new_instance, &MavlinkStreamActuatorControlTarget<1>::get_name_static),
-	new StreamListItem(&MavlinkStreamActuatorControlTarget<2>::new_instance, &MavlinkStreamActuatorControlTarget<2>::get_name_static),
-	new StreamListItem(&MavlinkStreamActuatorControlTarget<3>::new_instance, &MavlinkStreamActuatorControlTarget<3>::get_name_static),
-	new StreamListItem(&MavlinkStreamNamedValueFloat::new_instance, &MavlinkStreamNamedValueFloat::get_name_static),
-	new StreamListItem(&MavlinkStreamCameraCapture::new_instance, &MavlinkStreamCameraCapture::get_name_static),
-	new StreamListItem(&MavlinkStreamCameraTrigger::new_instance, &MavlinkStreamCameraTrigger::get_name_static),
-	new StreamListItem(&MavlinkStreamDistanceSensor::new_instance, &MavlinkStreamDistanceSensor::get_name_static),
-	new StreamListItem(&MavlinkStreamVtolState::new_instance, &MavlinkStreamVtolState::get_name_static),
-	nullptr
+const StreamListItem streams_list[] = {
+	{&MavlinkStreamHeartbeat::new_instance, &MavlinkStreamHeartbeat::get_name_static, MAVLINK_MSG_ID_HEARTBEAT},
+	{&MavlinkStreamStatustext::new_instance, &MavlinkStreamStatustext::get_name_static, MAVLINK_MSG_ID_STATUSTEXT},
+	{&MavlinkStreamCommandLong::new_instance, &MavlinkStreamCommandLong::get_name_static, MAVLINK_MSG_ID_COMMAND_LONG},
+	{&MavlinkStreamSysStatus::new_instance, &MavlinkStreamSysStatus::get_name_static, MAVLINK_MSG_ID_SYS_STATUS},
+	{&MavlinkStreamHighresIMU::new_instance, &MavlinkStreamHighresIMU::get_name_static, MAVLINK_MSG_ID_HIGHRES_IMU},
+	{&MavlinkStreamIMUBatch::new_instance, &MavlinkStreamIMUBatch::get_name_static, MAVLINK_MSG_ID_V2_EXTENSION},
+	{&MavlinkStreamAttitude::new_instance, &MavlinkStreamAttitude::get_name_static, MAVLINK_MSG_ID_ATTITUDE},
+	{&MavlinkStreamAttitudeQuaternion::new_instance, &MavlinkStreamAttitudeQuaternion::get_name_static, MAVLINK_MSG_ID_ATTITUDE_QUATERNION},
+	{&MavlinkStreamVFRHUD::new_instance, &MavlinkStreamVFRHUD::get_name_static, MAVLINK_MSG_ID_VFR_HUD},
+	{&MavlinkStreamGPSRawInt::new_instance, &MavlinkStreamGPSRawInt::get_name_static, MAVLINK_MSG_ID_GPS_RAW_INT},
+	{&MavlinkStreamSystemTime::new_instance, &MavlinkStreamSystemTime::get_name_static, MAVLINK_MSG_ID_SYSTEM_TIME},
+	{&MavlinkStreamTimesync::new_instance, &MavlinkStreamTimesync::get_name_static, MAVLINK_MSG_ID_TIMESYNC},
+	{&MavlinkStreamGlobalPositionInt::new_instance, &MavlinkStreamGlobalPositionInt::get_name_static, MAVLINK_MSG_ID_GLOBAL_POSITION_INT},
+	{&MavlinkStreamLocalPositionNED::new_instance, &MavlinkStreamLocalPositionNED::get_name_static, MAVLINK_MSG_ID_LOCAL_POSITION_NED},
+	{&MavlinkStreamAttPosMocap::new_instance, &MavlinkStreamAttPosMocap::get_name_static, MAVLINK_MSG_ID_ATT_POS_MOCAP},
+	{&MavlinkStreamGPSGlobalOrigin::new_instance, &MavlinkStreamGPSGlobalOrigin::get_name_static, MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN},
+	{&MavlinkStreamServoOutputRaw<0>::new_instance, &MavlinkStreamServoOutputRaw<0>::get_name_static, MAVLINK_MSG_ID_SERVO_OUTPUT_RAW},
+	{&MavlinkStreamServoOutputRaw<1>::new_instance, &MavlinkStreamServoOutputRaw<1>::get_name_static, MAVLINK_MSG_ID_SERVO_OUTPUT_RAW},
+	{&MavlinkStreamServoOutputRaw<2>::new_instance, &MavlinkStreamServoOutputRaw<2>::get_name_static, MAVLINK_MSG_ID_SERVO_OUTPUT_RAW},
+	{&MavlinkStreamServoOutputRaw<3>::new_instance, &MavlinkStreamServoOutputRaw<3>::get_name_static, MAVLINK_MSG_ID_SERVO_OUTPUT_RAW},
+	{&MavlinkStreamHILControls::new_instance, &MavlinkStreamHILControls::get_name_static, MAVLINK_MSG_ID_HIL_CONTROLS},
+	{&MavlinkStreamPositionTargetGlobalInt::new_instance, &MavlinkStreamPositionTargetGlobalInt::get_name_static, MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT},
+	{&MavlinkStreamLocalPositionSetpoint::new_instance, &MavlinkStreamLocalPositionSetpoint::get_name_static, MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED},
+	{&MavlinkStreamAttitudeTarget::new_instance, &MavlinkStreamAttitudeTarget::get_name_static, MAVLINK_MSG_ID_ATTITUDE_TARGET},
+	{&MavlinkStreamRCChannels::new_instance, &MavlinkStreamRCChannels::get_name_static, MAVLINK_MSG_ID_RC_CHANNELS},
+	{&MavlinkStreamManualControl::new_instance, &MavlinkStreamManualControl::get_name_static, MAVLINK_MSG_ID_MANUAL_CONTROL},
+	{&MavlinkStreamOpticalFlowRad::new_instance, &MavlinkStreamOpticalFlowRad::get_name_static, MAVLINK_MSG_ID_OPTICAL_FLOW_RAD},
+	{&MavlinkStreamActuatorControlTarget<0>::new_instance, &MavlinkStreamActuatorControlTarget<0>::get_name_static, MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET},
+	{&MavlinkStreamActuatorControlTarget<1>::new_instance, &MavlinkStreamActuatorControlTarget<1>::get_name_static, MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET},
+	{&MavlinkStreamActuatorControlTarget<2>::new_instance, &MavlinkStreamActuatorControlTarget<2>::get_name_static, MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET},
+	{&MavlinkStreamActuatorControlTarget<3>::new_instance, &MavlinkStreamActuatorControlTarget<3>::get_name_static, MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET},
+	{&MavlinkStreamNamedValueFloat::new_instance, &MavlinkStreamNamedValueFloat::get_name_static, MAVLINK_MSG_ID_NAMED_VALUE_FLOAT},
+	{&MavlinkStreamTaskStats::new_instance, &MavlinkStreamTaskStats::get_name_static, MAVLINK_MSG_ID_NAMED_VALUE_FLOAT},
+	{&MavlinkStreamCameraCapture::new_instance, &MavlinkStreamCameraCapture::get_name_static, 0},
+	{&MavlinkStreamCameraTrigger::new_instance, &MavlinkStreamCameraTrigger::get_name_static, MAVLINK_MSG_ID_CAMERA_TRIGGER},
+	{&MavlinkStreamDistanceSensor::new_instance, &MavlinkStreamDistanceSensor::get_name_static, MAVLINK_MSG_ID_DISTANCE_SENSOR},
+	{&MavlinkStreamVtolState::new_instance, &MavlinkStreamVtolState::get_name_static, MAVLINK_MSG_ID_VTOL_STATE},
+	{nullptr, nullptr, 0}
 };
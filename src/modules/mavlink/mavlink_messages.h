@@ -43,19 +43,20 @@
 
 #include "mavlink_stream.h"
 
-class StreamListItem {
-
-public:
-	MavlinkStream* (*new_instance)(Mavlink *mavlink);
-	const char* (*get_name)();
-
-	StreamListItem(MavlinkStream* (*inst)(Mavlink *mavlink), const char* (*name)()) :
-		new_instance(inst),
-		get_name(name) {};
-
-	~StreamListItem() {};
+/**
+ * Constructor, name and message ID of a stream type.
+ *
+ * A plain aggregate, so the list of streams is initialized at compile
+ * time and stays in flash, only the streams configured on a link are
+ * instantiated.
+ */
+struct StreamListItem {
+	MavlinkStream *(*new_instance)(Mavlink *mavlink);
+	const char *(*get_name)();
+	uint8_t id;
 };
 
-extern const StreamListItem *streams_list[];
+/** supported streams, terminated by an entry without constructor */
+extern const StreamListItem streams_list[];
 
 #endif /* MAVLINK_MESSAGES_H_ */
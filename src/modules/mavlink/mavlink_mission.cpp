@@ -64,6 +64,7 @@ bool MavlinkMissionManager::_dataman_init = false;
 unsigned MavlinkMissionManager::_count = 0;
 int MavlinkMissionManager::_current_seq = 0;
 bool MavlinkMissionManager::_transfer_in_progress = false;
+unsigned MavlinkMissionManager::_mission_generation = 1;
 
 #define CHECK_SYSID_COMPID_MISSION(_msg)		(_msg.target_system == mavlink_system.sysid && \
 						((_msg.target_component == mavlink_system.compid) || \
@@ -85,6 +86,11 @@ MavlinkMissionManager::MavlinkMissionManager(Mavlink *mavlink) : MavlinkStream(m
 	_transfer_current_seq(0),
 	_transfer_partner_sysid(0),
 	_transfer_partner_compid(0),
+	_transfer_requested(0),
+	_transfer_received(0),
+	_cache_generation(0),
+	_cache(nullptr),
+	_cache_valid{},
 	_offboard_mission_sub(-1),
 	_mission_result_sub(-1),
 	_offboard_mission_pub(nullptr),
@@ -100,6 +106,8 @@ MavlinkMissionManager::MavlinkMissionManager(Mavlink *mavlink) : MavlinkStream(m
 MavlinkMissionManager::~MavlinkMissionManager()
 {
 	close(_mission_result_sub);
+
+	delete[] _cache;
 }
 
 unsigned
@@ -153,6 +161,11 @@ MavlinkMissionManager::update_active_mission(int dataman_id, unsigned count, int
 	int res = dm_write(DM_KEY_MISSION_STATE, 0, DM_PERSIST_POWER_ON_RESET, &mission, sizeof(mission_s));
 
 	if (res == sizeof(mission_s)) {
+		/* changing the current item only leaves cached items valid */
+		if (dataman_id != _dataman_id || count != _count) {
+			_mission_generation++;
+		}
+
 		/* update active mission state */
 		_dataman_id = dataman_id;
 		_count = count;
@@ -235,10 +248,9 @@ MavlinkMissionManager::send_mission_count(uint8_t sysid, uint8_t compid, uint16_
 void
 MavlinkMissionManager::send_mission_item(uint8_t sysid, uint8_t compid, uint16_t seq)
 {
-	dm_item_t dm_item = DM_KEY_WAYPOINTS_OFFBOARD(_dataman_id);
 	struct mission_item_s mission_item;
 
-	if (dm_read(dm_item, seq, &mission_item, sizeof(struct mission_item_s)) == sizeof(struct mission_item_s)) {
+	if (read_mission_item(seq, &mission_item) == OK) {
 		_time_last_sent = hrt_absolute_time();
 
 		/* create mission_item_s from mavlink_mission_item_t */
@@ -288,6 +300,85 @@ MavlinkMissionManager::send_mission_request(uint8_t sysid, uint8_t compid, uint1
 }
 
 
+void
+MavlinkMissionManager::request_mission_items(bool resend)
+{
+	if (resend) {
+		for (unsigned seq = _transfer_seq; seq < _transfer_requested; seq++) {
+			if (!(_transfer_received & (1u << (seq - _transfer_seq)))) {
+				send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, seq);
+			}
+		}
+	}
+
+	/* keep the window of outstanding requests full */
+	while (_transfer_requested < _transfer_count &&
+	       _transfer_requested < _transfer_seq + MAVLINK_MISSION_TRANSFER_WINDOW) {
+		send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_requested);
+		_transfer_requested++;
+	}
+}
+
+
+int
+MavlinkMissionManager::read_mission_item(unsigned seq, struct mission_item_s *mission_item)
+{
+	/* while receiving, the cache holds the new mission */
+	bool use_cache = (_state != MAVLINK_WPM_STATE_GETLIST) && (seq < MAVLINK_MISSION_CACHE_SIZE);
+
+	if (use_cache) {
+		if (_cache_generation != _mission_generation) {
+			invalidate_cache(_mission_generation);
+		}
+
+		if (_cache != nullptr && (_cache_valid[seq / 32] & (1u << (seq % 32)))) {
+			memcpy(mission_item, &_cache[seq], sizeof(struct mission_item_s));
+			return OK;
+		}
+	}
+
+	dm_item_t dm_item = DM_KEY_WAYPOINTS_OFFBOARD(_dataman_id);
+
+	if (dm_read(dm_item, seq, mission_item, sizeof(struct mission_item_s)) != sizeof(struct mission_item_s)) {
+		return ERROR;
+	}
+
+	if (use_cache) {
+		cache_mission_item(seq, mission_item);
+	}
+
+	return OK;
+}
+
+
+void
+MavlinkMissionManager::cache_mission_item(unsigned seq, const struct mission_item_s *mission_item)
+{
+	if (seq >= MAVLINK_MISSION_CACHE_SIZE) {
+		return;
+	}
+
+	if (_cache == nullptr) {
+		_cache = new struct mission_item_s[MAVLINK_MISSION_CACHE_SIZE];
+
+		if (_cache == nullptr) {
+			return;
+		}
+	}
+
+	memcpy(&_cache[seq], mission_item, sizeof(struct mission_item_s));
+	_cache_valid[seq / 32] |= (1u << (seq % 32));
+}
+
+
+void
+MavlinkMissionManager::invalidate_cache(unsigned generation)
+{
+	memset(_cache_valid, 0, sizeof(_cache_valid));
+	_cache_generation = generation;
+}
+
+
 void
 MavlinkMissionManager::send_mission_item_reached(uint16_t seq)
 {
@@ -322,6 +413,13 @@ MavlinkMissionManager::send(const hrt_abstime now)
 		send_mission_current(_current_seq);
 
 		if (mission_result.item_do_jump_changed) {
+			unsigned changed = mission_result.item_changed_index;
+
+			/* navigator updated the item in dataman, drop the cached copy */
+			if (changed < MAVLINK_MISSION_CACHE_SIZE) {
+				_cache_valid[changed / 32] &= ~(1u << (changed % 32));
+			}
+
 			/* send a mission item again if the remaining DO_JUMPs has changed */
 			send_mission_item(_transfer_partner_sysid, _transfer_partner_compid,
 					  (uint16_t)mission_result.item_changed_index);
@@ -342,8 +440,8 @@ MavlinkMissionManager::send(const hrt_abstime now)
 		_state = MAVLINK_WPM_STATE_IDLE;
 
 	} else if (_state == MAVLINK_WPM_STATE_GETLIST && hrt_elapsed_time(&_time_last_sent) > _retry_timeout) {
-		/* try to request item again after timeout */
-		send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+		/* try to request missing items again after timeout */
+		request_mission_items(true);
 
 	} else if (_state == MAVLINK_WPM_STATE_SENDLIST && hrt_elapsed_time(&_time_last_sent) > _retry_timeout) {
 		if (_transfer_seq == 0) {
@@ -614,6 +712,11 @@ MavlinkMissionManager::handle_mission_count(const mavlink_message_t *msg)
 			_transfer_count = wpc.count;
 			_transfer_dataman_id = _dataman_id == 0 ? 1 : 0;	// use inactive storage for transmission
 			_transfer_current_seq = -1;
+			_transfer_requested = 0;
+			_transfer_received = 0;
+
+			/* collect the new mission in the cache while it is written to dataman */
+			invalidate_cache(0);
 
 		} else if (_state == MAVLINK_WPM_STATE_GETLIST) {
 			_time_last_recv = hrt_absolute_time();
@@ -638,7 +741,7 @@ MavlinkMissionManager::handle_mission_count(const mavlink_message_t *msg)
 			return;
 		}
 
-		send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+		request_mission_items(true);
 	}
 }
 
@@ -653,8 +756,9 @@ MavlinkMissionManager::handle_mission_item(const mavlink_message_t *msg)
 		if (_state == MAVLINK_WPM_STATE_GETLIST) {
 			_time_last_recv = hrt_absolute_time();
 
-			if (wp.seq != _transfer_seq) {
-				if (_verbose) { warnx("WPM: MISSION_ITEM ERROR: seq %u was not the expected %u", wp.seq, _transfer_seq); }
+			if (wp.seq < _transfer_seq || wp.seq >= _transfer_requested ||
+			    (_transfer_received & (1u << (wp.seq - _transfer_seq)))) {
+				if (_verbose) { warnx("WPM: MISSION_ITEM ERROR: seq %u was not expected, window %u..%u", wp.seq, _transfer_seq, _transfer_requested); }
 
 				/* don't send request here, it will be performed in eventloop after timeout */
 				return;
@@ -699,6 +803,8 @@ MavlinkMissionManager::handle_mission_item(const mavlink_message_t *msg)
 			return;
 		}
 
+		cache_mission_item(wp.seq, &mission_item);
+
 		/* waypoint marked as current */
 		if (wp.current) {
 			_transfer_current_seq = wp.seq;
@@ -706,7 +812,13 @@ MavlinkMissionManager::handle_mission_item(const mavlink_message_t *msg)
 
 		if (_verbose) { warnx("WPM: MISSION_ITEM seq %u received", wp.seq); }
 
-		_transfer_seq = wp.seq + 1;
+		/* advance past all items received in sequence */
+		_transfer_received |= (1u << (wp.seq - _transfer_seq));
+
+		while (_transfer_received & 1) {
+			_transfer_received >>= 1;
+			_transfer_seq++;
+		}
 
 		if (_transfer_seq == _transfer_count) {
 			/* got all new mission items successfully */
@@ -717,6 +829,8 @@ MavlinkMissionManager::handle_mission_item(const mavlink_message_t *msg)
 			_state = MAVLINK_WPM_STATE_IDLE;
 
 			if (update_active_mission(_transfer_dataman_id, _transfer_count, _transfer_current_seq) == OK) {
+				/* the cache now holds the active mission */
+				_cache_generation = _mission_generation;
 				send_mission_ack(_transfer_partner_sysid, _transfer_partner_compid, MAV_MISSION_ACCEPTED);
 
 			} else {
@@ -725,8 +839,8 @@ MavlinkMissionManager::handle_mission_item(const mavlink_message_t *msg)
 			_transfer_in_progress = false;
 
 		} else {
-			/* request next item */
-			send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+			/* request next items */
+			request_mission_items(false);
 		}
 	}
 }
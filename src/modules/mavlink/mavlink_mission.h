@@ -66,6 +66,13 @@ enum MAVLINK_WPM_CODES {
 
 #define MAVLINK_MISSION_PROTOCOL_TIMEOUT_DEFAULT 5000000    ///< Protocol communication action timeout in useconds
 #define MAVLINK_MISSION_RETRY_TIMEOUT_DEFAULT 500000        ///< Protocol communication retry timeout in useconds
+#define MAVLINK_MISSION_TRANSFER_WINDOW 8                   ///< Mission items requested ahead during an upload (at most 32)
+
+#ifdef __PX4_NUTTX
+#define MAVLINK_MISSION_CACHE_SIZE 64                       ///< Mission items kept in RAM per instance
+#else
+#define MAVLINK_MISSION_CACHE_SIZE 256
+#endif
 
 class MavlinkMissionManager : public MavlinkStream {
 public:
@@ -93,6 +100,11 @@ public:
 
 	unsigned get_size();
 
+	Priority get_priority()
+	{
+		return PRIORITY_STATUS;
+	}
+
 	void handle_message(const mavlink_message_t *msg);
 
 	void set_verbose(bool v) { _verbose = v; }
@@ -124,6 +136,13 @@ private:
 	unsigned		_transfer_partner_sysid;		///< Partner system ID for current transmission
 	unsigned		_transfer_partner_compid;		///< Partner component ID for current transmission
 	static bool		_transfer_in_progress;			///< Global variable checking for current transmission
+	unsigned		_transfer_requested;			///< Items up to this sequence have been requested in current transmission
+	uint32_t		_transfer_received;			///< Items received ahead of _transfer_seq, bit 0 is _transfer_seq
+
+	static unsigned		_mission_generation;			///< Incremented whenever the active mission items change
+	unsigned		_cache_generation;			///< Mission generation of the cache, 0 while it holds a transfer
+	struct mission_item_s	*_cache;				///< Items of the active mission, allocated on first use
+	uint32_t		_cache_valid[(MAVLINK_MISSION_CACHE_SIZE + 31) / 32];	///< Valid cache entries
 
 	int			_offboard_mission_sub;
 	int			_mission_result_sub;
@@ -165,6 +184,32 @@ private:
 
 	void send_mission_request(uint8_t sysid, uint8_t compid, uint16_t seq);
 
+	/**
+	 *  @brief Requests the items of the upload window
+	 *
+	 *  Fills the window of outstanding requests past the first missing item.
+	 *
+	 *  @param resend Request again the items of the window which did not arrive.
+	 */
+	void request_mission_items(bool resend);
+
+	/**
+	 *  @brief Reads an item of the active mission, from the cache if possible
+	 *
+	 *  @return OK on success, ERROR if dataman could not be read.
+	 */
+	int read_mission_item(unsigned seq, struct mission_item_s *mission_item);
+
+	/**
+	 *  @brief Stores an item in the cache, unless it does not fit
+	 */
+	void cache_mission_item(unsigned seq, const struct mission_item_s *mission_item);
+
+	/**
+	 *  @brief Drops all items from the cache
+	 */
+	void invalidate_cache(unsigned generation);
+
 	/**
 	 *  @brief emits a message that a waypoint reached
 	 *
@@ -44,21 +44,176 @@
 #include <string.h>
 #include <uORB/uORB.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #include "mavlink_orb_subscription.h"
 
-MavlinkOrbSubscription::MavlinkOrbSubscription(const orb_id_t topic, int instance) :
+/**
+ * One uORB subscription of a topic instance and a copy of its latest data,
+ * read by the shared subscriptions of all instances of the process.
+ */
+class MavlinkOrbCache
+{
+public:
+	/**
+	 * Get the copy of a topic instance, created on first use.
+	 */
+	static MavlinkOrbCache *get(const orb_id_t topic, int instance);
+
+	/**
+	 * Drop a reader of the copy, it is deleted once no reader is left.
+	 */
+	static void release(MavlinkOrbCache *cache);
+
+	/**
+	 * Copy the latest data, taken from uORB once per publication.
+	 *
+	 * @return true if the topic has data
+	 */
+	bool read(void *data, uint64_t *time);
+
+private:
+	MavlinkOrbCache *next;			///< next copy in the list of the process
+	const orb_id_t _topic;
+	const int _instance;
+	int _fd;
+	uint8_t *_data;
+	uint64_t _time;			///< publication time of _data
+	bool _valid;			///< _data holds a publication
+	unsigned _users;
+	pthread_mutex_t _mutex;
+
+	static MavlinkOrbCache *_caches;
+	static pthread_mutex_t _caches_mutex;
+
+	MavlinkOrbCache(const orb_id_t topic, int instance);
+	~MavlinkOrbCache();
+
+	/* do not allow copying this class */
+	MavlinkOrbCache(const MavlinkOrbCache &);
+	MavlinkOrbCache operator=(const MavlinkOrbCache &);
+};
+
+MavlinkOrbCache *MavlinkOrbCache::_caches = nullptr;
+pthread_mutex_t MavlinkOrbCache::_caches_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+MavlinkOrbCache::MavlinkOrbCache(const orb_id_t topic, int instance) :
 	next(nullptr),
 	_topic(topic),
 	_instance(instance),
-	_fd(orb_subscribe_multi(_topic, instance)),
-	_published(false)
+	_fd(orb_subscribe_multi(topic, instance)),
+	_data(new uint8_t[topic->o_size]),
+	_time(0),
+	_valid(false),
+	_users(0)
 {
+	pthread_mutex_init(&_mutex, nullptr);
 }
 
-MavlinkOrbSubscription::~MavlinkOrbSubscription()
+MavlinkOrbCache::~MavlinkOrbCache()
 {
 	close(_fd);
+	delete[] _data;
+	pthread_mutex_destroy(&_mutex);
+}
+
+MavlinkOrbCache *
+MavlinkOrbCache::get(const orb_id_t topic, int instance)
+{
+	pthread_mutex_lock(&_caches_mutex);
+
+	MavlinkOrbCache *cache;
+
+	LL_FOREACH(_caches, cache) {
+		if (cache->_topic == topic && cache->_instance == instance) {
+			break;
+		}
+	}
+
+	if (cache == nullptr) {
+		cache = new MavlinkOrbCache(topic, instance);
+		LL_APPEND(_caches, cache);
+	}
+
+	cache->_users++;
+
+	pthread_mutex_unlock(&_caches_mutex);
+
+	return cache;
+}
+
+void
+MavlinkOrbCache::release(MavlinkOrbCache *cache)
+{
+	pthread_mutex_lock(&_caches_mutex);
+
+	if (--cache->_users == 0) {
+		LL_DELETE(_caches, cache);
+		delete cache;
+	}
+
+	pthread_mutex_unlock(&_caches_mutex);
+}
+
+bool
+MavlinkOrbCache::read(void *data, uint64_t *time)
+{
+	pthread_mutex_lock(&_mutex);
+
+	bool updated = !_valid;
+
+	if (_valid) {
+		orb_check(_fd, &updated);
+	}
+
+	/* until the first copy succeeds every read tries, as orb_check() would not report data published before subscribing */
+	if (updated) {
+		uint64_t time_topic;
+
+		if (orb_stat(_fd, &time_topic)) {
+			time_topic = 0;
+		}
+
+		if (orb_copy(_topic, _fd, _data) == OK) {
+			_time = time_topic;
+			_valid = true;
+		}
+	}
+
+	if (_valid) {
+		if (data) {
+			memcpy(data, _data, _topic->o_size);
+		}
+
+		*time = _time;
+	}
+
+	bool valid = _valid;
+
+	pthread_mutex_unlock(&_mutex);
+
+	return valid;
+}
+
+MavlinkOrbSubscription::MavlinkOrbSubscription(const orb_id_t topic, int instance, bool shared) :
+	next(nullptr),
+	_topic(topic),
+	_instance(instance),
+	_fd(shared ? -1 : orb_subscribe_multi(_topic, instance)),
+	_cache(shared ? MavlinkOrbCache::get(_topic, instance) : nullptr),
+	_published(false),
+	_users(0)
+{
+}
+
+MavlinkOrbSubscription::~MavlinkOrbSubscription()
+{
+	if (_cache != nullptr) {
+		MavlinkOrbCache::release(_cache);
+
+	} else {
+		close(_fd);
+	}
 }
 
 orb_id_t
@@ -73,19 +228,36 @@ MavlinkOrbSubscription::get_instance() const
 	return _instance;
 }
 
+int
+MavlinkOrbSubscription::get_fd() const
+{
+	return _fd;
+}
+
 bool
-MavlinkOrbSubscription::update(uint64_t *time, void* data)
+MavlinkOrbSubscription::copy(void *data, uint64_t *time)
 {
+	if (_cache != nullptr) {
+		return _cache->read(data, time);
+	}
+
 	// TODO this is NOT atomic operation, we can get data newer than time
 	// if topic was published between orb_stat and orb_copy calls.
 
-	uint64_t time_topic;
-	if (orb_stat(_fd, &time_topic)) {
+	if (orb_stat(_fd, time)) {
 		/* error getting last topic publication time */
-		time_topic = 0;
+		*time = 0;
 	}
 
-	if (orb_copy(_topic, _fd, data)) {
+	return orb_copy(_topic, _fd, data) == OK;
+}
+
+bool
+MavlinkOrbSubscription::update(uint64_t *time, void* data)
+{
+	uint64_t time_topic;
+
+	if (!copy(data, &time_topic)) {
 		if (data) {
 			/* error copying topic data */
 			memset(data, 0, _topic->o_size);
@@ -108,7 +280,9 @@ MavlinkOrbSubscription::update(uint64_t *time, void* data)
 bool
 MavlinkOrbSubscription::update(void* data)
 {
-	return !orb_copy(_topic, _fd, data);
+	uint64_t time_topic;
+
+	return copy(data, &time_topic);
 }
 
 bool
@@ -119,7 +293,14 @@ MavlinkOrbSubscription::is_published()
 	}
 
 	bool updated;
-	orb_check(_fd, &updated);
+
+	if (_cache != nullptr) {
+		uint64_t time_topic;
+		updated = _cache->read(nullptr, &time_topic);
+
+	} else {
+		orb_check(_fd, &updated);
+	}
 
 	if (updated) {
 		_published = true;
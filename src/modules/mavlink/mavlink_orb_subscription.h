@@ -45,12 +45,18 @@
 #include <drivers/drv_hrt.h>
 
 
+class MavlinkOrbCache;
+
 class MavlinkOrbSubscription
 {
 public:
 	MavlinkOrbSubscription *next;	///< pointer to next subscription in list
 
-	MavlinkOrbSubscription(const orb_id_t topic, int instance);
+	/**
+	 * @param shared	read the topic through the copy shared by all instances
+	 *			of the process instead of an own uORB subscription
+	 */
+	MavlinkOrbSubscription(const orb_id_t topic, int instance, bool shared);
 	~MavlinkOrbSubscription();
 
 	/**
@@ -78,16 +84,45 @@ public:
 	bool is_published();
 	orb_id_t get_topic() const;
 	int get_instance() const;
+	bool is_shared() const { return _cache != nullptr; }
+
+	/**
+	 * Get the subscription handle, e.g. to poll on it.
+	 *
+	 * @return the handle, -1 for a shared subscription
+	 */
+	int get_fd() const;
+
+	/**
+	 * Count a user of the subscription.
+	 */
+	void add_user() { _users++; }
+
+	/**
+	 * Drop a user of the subscription.
+	 *
+	 * @return the number of users left
+	 */
+	unsigned remove_user() { return --_users; }
 
 private:
 	const orb_id_t _topic;		///< topic metadata
 	const int _instance;		///< get topic instance
-	int _fd;			///< subscription handle
+	int _fd;			///< subscription handle, -1 if shared
+	MavlinkOrbCache *_cache;	///< copy shared by the instances, nullptr if not shared
 	bool _published;		///< topic was ever published
+	unsigned _users;		///< number of streams and modules using the subscription
 
 	/* do not allow copying this class */
 	MavlinkOrbSubscription(const MavlinkOrbSubscription&);
 	MavlinkOrbSubscription operator=(const MavlinkOrbSubscription&);
+
+	/**
+	 * Copy the latest data and its publication time.
+	 *
+	 * @return true if the topic has data
+	 */
+	bool copy(void *data, uint64_t *time);
 };
 
 
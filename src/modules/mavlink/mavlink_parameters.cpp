@@ -40,12 +40,25 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "mavlink_parameters.h"
 #include "mavlink_main.h"
 
+/* pseudo parameter carrying the hash of the parameter set */
+static const char hash_check_name[] = "_HASH_CHECK";
+
+MavlinkParametersManager::CacheSlot *MavlinkParametersManager::_cache = nullptr;
+unsigned MavlinkParametersManager::_cache_count = 0;
+uint32_t MavlinkParametersManager::_cache_seq = 0;
+pthread_mutex_t MavlinkParametersManager::_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 MavlinkParametersManager::MavlinkParametersManager(Mavlink *mavlink) : MavlinkStream(mavlink),
 	_send_all_index(-1),
+	_send_changed_since(0),
+	_send_non_default(false),
+	_hash_history{},
+	_hash_history_next(0),
 	_rc_param_map_pub(nullptr),
 	_rc_param_map()
 {
@@ -74,6 +87,8 @@ MavlinkParametersManager::handle_message(const mavlink_message_t *msg)
 			if (req_list.target_system == mavlink_system.sysid &&
 			    (req_list.target_component == mavlink_system.compid || req_list.target_component == MAV_COMP_ID_ALL)) {
 
+				_send_changed_since = 0;
+				_send_non_default = false;
 				_send_all_index = 0;
 			}
 			break;
@@ -93,6 +108,15 @@ MavlinkParametersManager::handle_message(const mavlink_message_t *msg)
 					strncpy(name, set.param_id, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
 					/* enforce null termination */
 					name[MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN] = '\0';
+
+					/* setting the hash check requests a delta against a cached list */
+					if (strcmp(name, hash_check_name) == 0) {
+						uint32_t hash;
+						memcpy(&hash, &set.param_value, sizeof(hash));
+						start_send_delta(hash);
+						break;
+					}
+
 					/* attempt to find parameter, set and send it */
 					param_t param = param_find_no_notification(name);
 
@@ -126,8 +150,14 @@ MavlinkParametersManager::handle_message(const mavlink_message_t *msg)
 					strncpy(name, req_read.param_id, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
 					/* enforce null termination */
 					name[MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN] = '\0';
-					/* attempt to find parameter and send it */
-					send_param(param_find_no_notification(name));
+
+					if (strcmp(name, hash_check_name) == 0) {
+						send_hash_check();
+
+					} else {
+						/* attempt to find parameter and send it */
+						send_param(param_find_no_notification(name));
+					}
 
 				} else {
 					/* when index is >= 0, send this parameter again */
@@ -190,31 +220,167 @@ MavlinkParametersManager::handle_message(const mavlink_message_t *msg)
 }
 
 void
-MavlinkParametersManager::send(const hrt_abstime t)
+MavlinkParametersManager::start_send_delta(uint32_t hash)
 {
-	/* send all parameters if requested, but only after the system has booted */
-	if (_send_all_index >= 0 && _mavlink->boot_complete()) {
+	uint32_t seq = param_get_change_seq();
+
+	if (hash == param_hash_check()) {
+		/* the cached list is current, confirm and skip the transfer */
+		send_hash_check();
+		return;
+	}
+
+	_send_changed_since = 0;
+	_send_non_default = (hash == 0);
+
+	/* look for the hash among the ones reported earlier, newest first */
+	for (unsigned i = 1; i <= HASH_HISTORY_LEN && !_send_non_default; i++) {
+		const HashRecord &r = _hash_history[(_hash_history_next + HASH_HISTORY_LEN - i) % HASH_HISTORY_LEN];
+
+		if (r.change_seq != 0 && r.change_seq <= seq && r.hash == hash) {
+			_send_changed_since = r.change_seq;
+			break;
+		}
+	}
+
+	_send_all_index = 0;
+}
+
+bool
+MavlinkParametersManager::fill_slot(CacheSlot &slot, param_t param, int index, unsigned count)
+{
+	mavlink_param_value_t &msg = slot.msg;
+
+	slot.param = param;
+
+	/* query parameter type */
+	param_type_t type = param_type(param);
+
+	/*
+	 * Map onboard parameter type to MAVLink type,
+	 * endianess matches (both little endian)
+	 */
+	if (type == PARAM_TYPE_INT32) {
+		msg.param_type = MAVLINK_TYPE_INT32_T;
+
+	} else {
+		msg.param_type = MAVLINK_TYPE_FLOAT;
+	}
+
+	msg.param_count = count;
+	msg.param_index = index;
+
+	/* copy parameter name */
+	strncpy(msg.param_id, param_name(param), MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
+
+	/* MAVLink encodes float and int params in the same space */
+	if ((type != PARAM_TYPE_INT32 && type != PARAM_TYPE_FLOAT) ||
+	    param_get(param, &msg.param_value) != OK) {
+		msg.param_value = 0.0f;
+		return false;
+	}
 
-		/* skip if no space is available */
-		if (_mavlink->get_free_tx_buf() < get_size()) {
+	return true;
+}
+
+void
+MavlinkParametersManager::refresh_cache()
+{
+	pthread_mutex_lock(&_cache_mutex);
+
+	/* take the sequence first, a change while filling then shows up in the next refresh */
+	uint32_t seq = param_get_change_seq();
+	unsigned count = param_count_used();
+	bool rebuild = (_cache == nullptr || count != _cache_count);
+
+	if (!rebuild && seq == _cache_seq) {
+		pthread_mutex_unlock(&_cache_mutex);
+		return;
+	}
+
+	if (rebuild && count > 0) {
+		/* a parameter was marked used, all used indices after it move */
+		CacheSlot *cache = (CacheSlot *)realloc(_cache, count * sizeof(CacheSlot));
+
+		if (cache == nullptr) {
+			/* keep sending the old list */
+			pthread_mutex_unlock(&_cache_mutex);
 			return;
 		}
 
-		/* look for the first parameter which is used */
-		param_t p;
-		do {
-			/* walk through all parameters, including unused ones */
-			p = param_for_index(_send_all_index);
-			_send_all_index++;
-		} while (p != PARAM_INVALID && !param_used(p));
+		_cache = cache;
+		_cache_count = count;
+	}
+
+	unsigned slot = 0;
+
+	for (unsigned i = 0; i < param_count() && slot < _cache_count; i++) {
+		param_t p = param_for_index(i);
+
+		if (!param_used(p)) {
+			continue;
+		}
+
+		if (rebuild || param_changed_since(p, _cache_seq)) {
+			fill_slot(_cache[slot], p, slot, _cache_count);
+		}
+
+		slot++;
+	}
+
+	_cache_seq = seq;
+
+	pthread_mutex_unlock(&_cache_mutex);
+}
+
+bool
+MavlinkParametersManager::next_param(mavlink_param_value_t *msg)
+{
+	pthread_mutex_lock(&_cache_mutex);
 
-		if (p != PARAM_INVALID) {
-			send_param(p);
+	while (_send_all_index >= 0 && _send_all_index < (int)_cache_count) {
+		const CacheSlot &slot = _cache[_send_all_index];
+		_send_all_index++;
+
+		if ((_send_non_default && param_value_is_default(slot.param)) ||
+		    (_send_changed_since != 0 && !param_changed_since(slot.param, _send_changed_since))) {
+			continue;
 		}
 
-		if ((p == PARAM_INVALID) || (_send_all_index >= (int) param_count())) {
-			_send_all_index = -1;
+		memcpy(msg, &slot.msg, sizeof(*msg));
+		pthread_mutex_unlock(&_cache_mutex);
+		return true;
+	}
+
+	pthread_mutex_unlock(&_cache_mutex);
+	return false;
+}
+
+void
+MavlinkParametersManager::send(const hrt_abstime t)
+{
+	/* send all parameters if requested, but only after the system has booted */
+	if (_send_all_index >= 0 && _mavlink->boot_complete()) {
+
+		refresh_cache();
+
+		/* send as many parameters as the tx buffer and the link budget allow */
+		while (_send_all_index >= 0 &&
+		       _mavlink->get_free_tx_buf() >= get_size() &&
+		       _mavlink->get_tx_budget() >= get_size()) {
+
+			mavlink_param_value_t msg;
+
+			if (next_param(&msg)) {
+				_mavlink->send_message(MAVLINK_MSG_ID_PARAM_VALUE, &msg);
+
+			} else {
+				/* end of the transfer, let the GCS cache the list */
+				send_hash_check();
+				_send_all_index = -1;
+			}
 		}
+
 	} else if (_send_all_index == 0 && hrt_absolute_time() > 20 * 1000 * 1000) {
 		/* the boot did not seem to ever complete, warn user and set boot complete */
 		_mavlink->send_statustext_critical("WARNING: SYSTEM BOOT INCOMPLETE. CHECK CONFIG.");
@@ -222,47 +388,46 @@ MavlinkParametersManager::send(const hrt_abstime t)
 	}
 }
 
-int
-MavlinkParametersManager::send_param(param_t param)
+void
+MavlinkParametersManager::send_hash_check()
 {
-	if (param == PARAM_INVALID) {
-		return 1;
-	}
+	/* take the sequence first, a change while hashing then shows up in a later delta */
+	uint32_t seq = param_get_change_seq();
+	uint32_t hash = param_hash_check();
 
-	mavlink_param_value_t msg;
+	const HashRecord &last = _hash_history[(_hash_history_next + HASH_HISTORY_LEN - 1) % HASH_HISTORY_LEN];
 
-	/*
-	 * get param value, since MAVLink encodes float and int params in the same
-	 * space during transmission, copy param onto float val_buf
-	 */
-	if (param_get(param, &msg.param_value) != OK) {
-		return 2;
+	if (last.change_seq == 0 || last.hash != hash) {
+		_hash_history[_hash_history_next].hash = hash;
+		_hash_history[_hash_history_next].change_seq = seq;
+		_hash_history_next = (_hash_history_next + 1) % HASH_HISTORY_LEN;
 	}
 
+	mavlink_param_value_t msg;
+	memcpy(&msg.param_value, &hash, sizeof(hash));
 	msg.param_count = param_count_used();
-	msg.param_index = param_get_used_index(param);
+	/* not a real parameter, GCSs without hash support ignore it */
+	msg.param_index = -1;
+	strncpy(msg.param_id, hash_check_name, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
+	msg.param_type = MAVLINK_TYPE_UINT32_T;
 
-	/* copy parameter name */
-	strncpy(msg.param_id, param_name(param), MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
-
-	/* query parameter type */
-	param_type_t type = param_type(param);
+	_mavlink->send_message(MAVLINK_MSG_ID_PARAM_VALUE, &msg);
+}
 
-	/*
-	 * Map onboard parameter type to MAVLink type,
-	 * endianess matches (both little endian)
-	 */
-	if (type == PARAM_TYPE_INT32) {
-		msg.param_type = MAVLINK_TYPE_INT32_T;
+int
+MavlinkParametersManager::send_param(param_t param)
+{
+	if (param == PARAM_INVALID) {
+		return 1;
+	}
 
-	} else if (type == PARAM_TYPE_FLOAT) {
-		msg.param_type = MAVLINK_TYPE_FLOAT;
+	CacheSlot slot;
 
-	} else {
-		msg.param_type = MAVLINK_TYPE_FLOAT;
+	if (!fill_slot(slot, param, param_get_used_index(param), param_count_used())) {
+		return 2;
 	}
 
-	_mavlink->send_message(MAVLINK_MSG_ID_PARAM_VALUE, &msg);
+	_mavlink->send_message(MAVLINK_MSG_ID_PARAM_VALUE, &slot.msg);
 
 	return 0;
 }
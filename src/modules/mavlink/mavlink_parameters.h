@@ -41,6 +41,7 @@
 
 #pragma once
 
+#include <pthread.h>
 #include <systemlib/param/param.h>
 
 #include "mavlink_bridge_header.h"
@@ -73,6 +74,11 @@ public:
 
 	unsigned get_size();
 
+	Priority get_priority()
+	{
+		return PRIORITY_STATUS;
+	}
+
 	void handle_message(const mavlink_message_t *msg);
 
 	/**
@@ -96,14 +102,43 @@ public:
 	 * Start sending the parameter queue.
 	 *
 	 * This function will not directly send parameters, but instead
-	 * activate the sending of one parameter on each call of
-	 * mavlink_pm_queued_send().
+	 * activate the sending of as many parameters as the link allows on
+	 * each call of mavlink_pm_queued_send().
 	 * @see 		mavlink_pm_queued_send()
 	 */
 	void		start_send_all();
 
 private:
-	int		_send_all_index;
+	/* number of reported hashes a delta transfer can start from */
+	static const unsigned HASH_HISTORY_LEN = 4;
+
+	struct HashRecord {
+		uint32_t	hash;
+		uint32_t	change_seq;	///< param_get_change_seq() before computing the hash
+	};
+
+	/*
+	 * PARAM_VALUE messages of all used parameters in used index order, shared
+	 * by all instances so a list transfer only copies them out. It is
+	 * allocated on the first list request and kept up to date with the
+	 * parameter change sequence, only reading the values that changed.
+	 */
+	struct CacheSlot {
+		param_t			param;
+		mavlink_param_value_t	msg;
+	};
+
+	static CacheSlot	*_cache;
+	static unsigned		_cache_count;
+	static uint32_t		_cache_seq;	///< param_get_change_seq() the cache is current for
+	static pthread_mutex_t	_cache_mutex;
+
+	int		_send_all_index;	///< next cache slot of the list transfer, -1 if none
+	uint32_t	_send_changed_since;	///< only send parameters changed after this sequence, 0 for all
+	bool		_send_non_default;	///< only send parameters which differ from their default
+
+	HashRecord	_hash_history[HASH_HISTORY_LEN];
+	unsigned	_hash_history_next;
 
 	/* do not allow top copying this class */
 	MavlinkParametersManager(MavlinkParametersManager &);
@@ -116,6 +151,41 @@ protected:
 
 	int send_param(param_t param);
 
+	/**
+	 * Send the hash of the current parameter set and remember it as a
+	 * starting point for later delta transfers.
+	 */
+	void send_hash_check();
+
+	/**
+	 * Start a delta transfer against the hash of a cached parameter list.
+	 *
+	 * Nothing but the hash is sent if it matches, only the parameters changed
+	 * since if it is a hash reported earlier, only non-default parameters if
+	 * it is zero and the full list otherwise.
+	 */
+	void start_send_delta(uint32_t hash);
+
+	/**
+	 * Bring the cache up to date with the used parameters and their values.
+	 */
+	void refresh_cache();
+
+	/**
+	 * Fill one cache slot from the current value of its parameter.
+	 *
+	 * @return		false if the value could not be read, it is sent as 0 then.
+	 */
+	static bool fill_slot(CacheSlot &slot, param_t param, int index, unsigned count);
+
+	/**
+	 * Advance the list transfer to the next parameter to send.
+	 *
+	 * @param msg		Filled with the cached message of the parameter.
+	 * @return		false when the transfer is complete.
+	 */
+	bool next_param(mavlink_param_value_t *msg);
+
 	orb_advert_t _rc_param_map_pub;
 	struct rc_parameter_map_s _rc_param_map;
 };
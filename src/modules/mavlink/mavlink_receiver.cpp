@@ -86,6 +86,7 @@ __BEGIN_DECLS
 #include "mavlink_bridge_header.h"
 #include "mavlink_receiver.h"
 #include "mavlink_main.h"
+#include "mavlink_messages.h"
 
 __END_DECLS
 
@@ -126,6 +127,7 @@ MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_land_detector_pub(nullptr),
 	_time_offset_pub(nullptr),
 	_control_mode_sub(orb_subscribe(ORB_ID(vehicle_control_mode))),
+	_command_ack_sub(orb_subscribe(ORB_ID(vehicle_command_ack))),
 	_hil_frames(0),
 	_old_timestamp(0),
 	_hil_local_proj_inited(0),
@@ -134,139 +136,162 @@ MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_offboard_control_mode{},
 	_att_sp{},
 	_rates_sp{},
-	_time_offset_avg_alpha(0.6),
-	_time_offset(0),
 	_orb_class_instance(-1),
 	_mom_switch_pos{},
-	_mom_switch_state(0)
+	_mom_switch_state(0),
+	_command_track{},
+	_msg_count{},
+	_handler_perf{}
 {
-
+	init_handler_slots();
 }
 
 MavlinkReceiver::~MavlinkReceiver()
 {
-}
-
-void
-MavlinkReceiver::handle_message(mavlink_message_t *msg)
-{
-	switch (msg->msgid) {
-	case MAVLINK_MSG_ID_COMMAND_LONG:
-		handle_message_command_long(msg);
-		break;
+	orb_unsubscribe(_command_ack_sub);
 
-	case MAVLINK_MSG_ID_COMMAND_INT:
-		handle_message_command_int(msg);
-		break;
+	for (unsigned i = 0; i < sizeof(_handler_perf) / sizeof(_handler_perf[0]); i++) {
+		if (_handler_perf[i] != nullptr) {
+			perf_free(_handler_perf[i]);
+		}
+	}
+}
 
-	case MAVLINK_MSG_ID_OPTICAL_FLOW_RAD:
-		handle_message_optical_flow_rad(msg);
-		break;
+const MavlinkReceiver::InternalHandler MavlinkReceiver::_internal_handlers[] = {
+	{ MAVLINK_MSG_ID_COMMAND_LONG, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_command_long, "mavlink rx COMMAND_LONG" },
+	{ MAVLINK_MSG_ID_COMMAND_INT, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_command_int, "mavlink rx COMMAND_INT" },
+	{ MAVLINK_MSG_ID_OPTICAL_FLOW_RAD, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_optical_flow_rad, "mavlink rx OPTICAL_FLOW_RAD" },
+	{ MAVLINK_MSG_ID_PING, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_ping, "mavlink rx PING" },
+	{ MAVLINK_MSG_ID_SET_MODE, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_set_mode, "mavlink rx SET_MODE" },
+	{ MAVLINK_MSG_ID_ATT_POS_MOCAP, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_att_pos_mocap, "mavlink rx ATT_POS_MOCAP" },
+	{ MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_set_position_target_local_ned, "mavlink rx SET_POSITION_TARGET_LOCAL_NED" },
+	{ MAVLINK_MSG_ID_SET_ATTITUDE_TARGET, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_set_attitude_target, "mavlink rx SET_ATTITUDE_TARGET" },
+	{ MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_set_actuator_control_target, "mavlink rx SET_ACTUATOR_CONTROL_TARGET" },
+	{ MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_vision_position_estimate, "mavlink rx VISION_POSITION_ESTIMATE" },
+	{ MAVLINK_MSG_ID_RADIO_STATUS, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_radio_status, "mavlink rx RADIO_STATUS" },
+	{ MAVLINK_MSG_ID_MANUAL_CONTROL, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_manual_control, "mavlink rx MANUAL_CONTROL" },
+	{ MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_rc_channels_override, "mavlink rx RC_CHANNELS_OVERRIDE" },
+	{ MAVLINK_MSG_ID_HEARTBEAT, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_heartbeat, "mavlink rx HEARTBEAT" },
+	{ MAVLINK_MSG_ID_REQUEST_DATA_STREAM, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_request_data_stream, "mavlink rx REQUEST_DATA_STREAM" },
+	{ MAVLINK_MSG_ID_SYSTEM_TIME, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_system_time, "mavlink rx SYSTEM_TIME" },
+	{ MAVLINK_MSG_ID_TIMESYNC, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_timesync, "mavlink rx TIMESYNC" },
+	{ MAVLINK_MSG_ID_DISTANCE_SENSOR, HANDLER_ALWAYS, &MavlinkReceiver::handle_message_distance_sensor, "mavlink rx DISTANCE_SENSOR" },
 
-	case MAVLINK_MSG_ID_PING:
-		handle_message_ping(msg);
-		break;
+	/*
+	 * Only decode hil messages in HIL mode.
+	 *
+	 * The HIL mode is enabled by the HIL bit flag
+	 * in the system mode. Either send a set mode
+	 * COMMAND_LONG message or a SET_MODE message
+	 *
+	 * Accept HIL GPS messages if use_hil_gps flag is true.
+	 * This allows to provide fake gps measurements to the system.
+	 */
+	{ MAVLINK_MSG_ID_HIL_SENSOR, HANDLER_HIL, &MavlinkReceiver::handle_message_hil_sensor, "mavlink rx HIL_SENSOR" },
+	{ MAVLINK_MSG_ID_HIL_STATE_QUATERNION, HANDLER_HIL, &MavlinkReceiver::handle_message_hil_state_quaternion, "mavlink rx HIL_STATE_QUATERNION" },
+	{ MAVLINK_MSG_ID_HIL_OPTICAL_FLOW, HANDLER_HIL, &MavlinkReceiver::handle_message_hil_optical_flow, "mavlink rx HIL_OPTICAL_FLOW" },
+	{ MAVLINK_MSG_ID_HIL_GPS, HANDLER_HIL_GPS, &MavlinkReceiver::handle_message_hil_gps, "mavlink rx HIL_GPS" },
+};
+
+MavlinkReceiver::ExternalHandlerSlot MavlinkReceiver::_external_handlers[MAX_EXTERNAL_HANDLERS] = {};
+unsigned MavlinkReceiver::_external_handler_count = 0;
+volatile uint8_t MavlinkReceiver::_handler_slot[256] = {};
+bool MavlinkReceiver::_handler_slots_initialized = false;
+pthread_mutex_t MavlinkReceiver::_handler_mutex = PTHREAD_MUTEX_INITIALIZER;
+MavlinkTimesync MavlinkReceiver::_timesync;
+
+unsigned
+MavlinkReceiver::internal_handler_count()
+{
+	return sizeof(_internal_handlers) / sizeof(_internal_handlers[0]);
+}
 
-	case MAVLINK_MSG_ID_SET_MODE:
-		handle_message_set_mode(msg);
-		break;
+void
+MavlinkReceiver::init_handler_slots()
+{
+	pthread_mutex_lock(&_handler_mutex);
 
-	case MAVLINK_MSG_ID_ATT_POS_MOCAP:
-		handle_message_att_pos_mocap(msg);
-		break;
+	if (!_handler_slots_initialized) {
+		for (unsigned i = 0; i < internal_handler_count() && i < MAX_INTERNAL_HANDLERS; i++) {
+			_handler_slot[_internal_handlers[i].msgid] = i + 1;
+		}
 
-	case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
-		handle_message_set_position_target_local_ned(msg);
-		break;
+		_handler_slots_initialized = true;
+	}
 
-	case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
-		handle_message_set_attitude_target(msg);
-		break;
+	pthread_mutex_unlock(&_handler_mutex);
+}
 
-	case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
-		handle_message_set_actuator_control_target(msg);
-		break;
+int
+MavlinkReceiver::register_handler(uint8_t msgid, ExternalHandler handler, void *arg, const char *name)
+{
+	init_handler_slots();
 
-	case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE:
-		handle_message_vision_position_estimate(msg);
-		break;
+	pthread_mutex_lock(&_handler_mutex);
 
-	case MAVLINK_MSG_ID_RADIO_STATUS:
-		handle_message_radio_status(msg);
-		break;
+	int ret = OK;
 
-	case MAVLINK_MSG_ID_MANUAL_CONTROL:
-		handle_message_manual_control(msg);
-		break;
+	if (_handler_slot[msgid] != 0) {
+		ret = -EBUSY;
 
-	case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
-		handle_message_rc_channels_override(msg);
-		break;
+	} else if (_external_handler_count >= MAX_EXTERNAL_HANDLERS) {
+		ret = -ENOMEM;
 
-	case MAVLINK_MSG_ID_HEARTBEAT:
-		handle_message_heartbeat(msg);
-		break;
+	} else {
+		unsigned index = _external_handler_count++;
+		_external_handlers[index].handler = handler;
+		_external_handlers[index].arg = arg;
+		_external_handlers[index].name = name;
+
+		/* the receive threads read the slot without locking, publish it last */
+		__sync_synchronize();
+		_handler_slot[msgid] = MAX_INTERNAL_HANDLERS + index + 1;
+	}
 
-	case MAVLINK_MSG_ID_REQUEST_DATA_STREAM:
-		handle_message_request_data_stream(msg);
-		break;
+	pthread_mutex_unlock(&_handler_mutex);
 
-	case MAVLINK_MSG_ID_SYSTEM_TIME:
-		handle_message_system_time(msg);
-		break;
+	return ret;
+}
 
-	case MAVLINK_MSG_ID_TIMESYNC:
-		handle_message_timesync(msg);
-		break;
+void
+MavlinkReceiver::handle_message(mavlink_message_t *msg)
+{
+	_msg_count[msg->msgid]++;
 
-	case MAVLINK_MSG_ID_DISTANCE_SENSOR:
-		handle_message_distance_sensor(msg);
-		break;
+	unsigned slot = _handler_slot[msg->msgid];
 
-	default:
-		break;
-	}
+	if (slot != 0) {
+		unsigned index = slot - 1;
 
-	/*
-	 * Only decode hil messages in HIL mode.
-	 *
-	 * The HIL mode is enabled by the HIL bit flag
-	 * in the system mode. Either send a set mode
-	 * COMMAND_LONG message or a SET_MODE message
-	 *
-	 * Accept HIL GPS messages if use_hil_gps flag is true.
-	 * This allows to provide fake gps measurements to the system.
-	 */
-	if (_mavlink->get_hil_enabled()) {
-		switch (msg->msgid) {
-		case MAVLINK_MSG_ID_HIL_SENSOR:
-			handle_message_hil_sensor(msg);
-			break;
+		if (index < MAX_INTERNAL_HANDLERS) {
+			const InternalHandler &entry = _internal_handlers[index];
 
-		case MAVLINK_MSG_ID_HIL_STATE_QUATERNION:
-			handle_message_hil_state_quaternion(msg);
-			break;
+			bool enabled = entry.mode == HANDLER_ALWAYS ||
+				       (entry.mode == HANDLER_HIL && _mavlink->get_hil_enabled()) ||
+				       (entry.mode == HANDLER_HIL_GPS && (_mavlink->get_hil_enabled() ||
+						       (_mavlink->get_use_hil_gps() && msg->sysid == mavlink_system.sysid)));
 
-		case MAVLINK_MSG_ID_HIL_OPTICAL_FLOW:
-			handle_message_hil_optical_flow(msg);
-			break;
+			if (enabled) {
+				if (_handler_perf[index] == nullptr) {
+					_handler_perf[index] = perf_alloc(PC_ELAPSED, entry.name);
+				}
 
-		default:
-			break;
-		}
-	}
+				perf_begin(_handler_perf[index]);
+				(this->*entry.handler)(msg);
+				perf_end(_handler_perf[index]);
+			}
 
+		} else {
+			const ExternalHandlerSlot &entry = _external_handlers[index - MAX_INTERNAL_HANDLERS];
 
-   	if (_mavlink->get_hil_enabled() || (_mavlink->get_use_hil_gps() && msg->sysid == mavlink_system.sysid)) {
-		switch (msg->msgid) {
-		case MAVLINK_MSG_ID_HIL_GPS:
-			handle_message_hil_gps(msg);
-			break;
+			if (_handler_perf[index] == nullptr) {
+				_handler_perf[index] = perf_alloc(PC_ELAPSED, entry.name);
+			}
 
-		default:
-			break;
+			perf_begin(_handler_perf[index]);
+			entry.handler(_mavlink, msg, entry.arg);
+			perf_end(_handler_perf[index]);
 		}
-
 	}
 
     /* If we've received a valid message, mark the flag indicating so.
@@ -309,6 +334,8 @@ MavlinkReceiver::handle_message_command_long(mavlink_message_t *msg)
 		} else if (cmd_mavlink.command == MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES) {
 			/* send autopilot version message */
 			_mavlink->send_autopilot_capabilites();
+		} else if (cmd_mavlink.command == MAV_CMD_SET_MESSAGE_INTERVAL) {
+			set_message_interval((int)cmd_mavlink.param1, cmd_mavlink.param2);
 		} else {
 
 			if (msg->sysid == mavlink_system.sysid && msg->compid == mavlink_system.compid) {
@@ -317,6 +344,11 @@ MavlinkReceiver::handle_message_command_long(mavlink_message_t *msg)
 				return;
 			}
 
+			if (!command_track(msg, cmd_mavlink)) {
+				/* a retry of a command still running or already answered */
+				return;
+			}
+
 			struct vehicle_command_s vcmd;
 			memset(&vcmd, 0, sizeof(vcmd));
 
@@ -346,6 +378,115 @@ MavlinkReceiver::handle_message_command_long(mavlink_message_t *msg)
 	}
 }
 
+bool
+MavlinkReceiver::command_track(const mavlink_message_t *msg, const mavlink_command_long_t &cmd)
+{
+	hrt_abstime now = hrt_absolute_time();
+	CommandTrack *oldest = &_command_track[0];
+
+	for (unsigned i = 0; i < COMMAND_TRACK_SIZE; i++) {
+		CommandTrack &track = _command_track[i];
+
+		/*
+		 * A retry repeats the command with a higher confirmation counter,
+		 * the same command sent again with no or the same counter is new.
+		 */
+		if (track.time != 0 && now - track.time < COMMAND_TRACK_TIMEOUT &&
+		    cmd.confirmation > 0 && cmd.confirmation > track.cmd.confirmation &&
+		    track.sysid == msg->sysid && track.compid == msg->compid &&
+		    track.cmd.command == cmd.command &&
+		    track.cmd.target_system == cmd.target_system &&
+		    track.cmd.target_component == cmd.target_component &&
+		    track.cmd.param1 == cmd.param1 && track.cmd.param2 == cmd.param2 &&
+		    track.cmd.param3 == cmd.param3 && track.cmd.param4 == cmd.param4 &&
+		    track.cmd.param5 == cmd.param5 && track.cmd.param6 == cmd.param6 &&
+		    track.cmd.param7 == cmd.param7) {
+
+			track.cmd.confirmation = cmd.confirmation;
+
+			if (track.result != COMMAND_PENDING) {
+				/* the ack got lost */
+				send_command_ack(track.cmd.command, track.result);
+			}
+
+			return false;
+		}
+
+		if (track.time < oldest->time) {
+			oldest = &track;
+		}
+	}
+
+	oldest->time = now;
+	oldest->cmd = cmd;
+	oldest->sysid = msg->sysid;
+	oldest->compid = msg->compid;
+	oldest->result = COMMAND_PENDING;
+
+	return true;
+}
+
+void
+MavlinkReceiver::command_ack_update()
+{
+	bool updated;
+	orb_check(_command_ack_sub, &updated);
+
+	/* the topic is queued, take every result published since the last call */
+	while (updated) {
+		struct vehicle_command_ack_s ack;
+		orb_copy(ORB_ID(vehicle_command_ack), _command_ack_sub, &ack);
+
+		/* the oldest matching command waiting for a result, the answer is for another link otherwise */
+		CommandTrack *match = nullptr;
+
+		for (unsigned i = 0; i < COMMAND_TRACK_SIZE; i++) {
+			CommandTrack &track = _command_track[i];
+
+			if (track.time != 0 && track.result == COMMAND_PENDING &&
+			    track.cmd.command == ack.command &&
+			    track.sysid == ack.target_system && track.compid == ack.target_component &&
+			    (match == nullptr || track.time < match->time)) {
+				match = &track;
+			}
+		}
+
+		if (match != nullptr) {
+			/* VEHICLE_CMD_RESULT_* are the MAV_RESULT values */
+			match->result = ack.result;
+			match->time = hrt_absolute_time();
+			send_command_ack(ack.command, ack.result);
+		}
+
+		orb_check(_command_ack_sub, &updated);
+	}
+}
+
+bool
+MavlinkReceiver::command_pending()
+{
+	hrt_abstime now = hrt_absolute_time();
+
+	for (unsigned i = 0; i < COMMAND_TRACK_SIZE; i++) {
+		if (_command_track[i].time != 0 && _command_track[i].result == COMMAND_PENDING &&
+		    now - _command_track[i].time < COMMAND_TRACK_TIMEOUT) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void
+MavlinkReceiver::send_command_ack(uint16_t command, uint8_t result)
+{
+	mavlink_command_ack_t msg;
+	msg.command = command;
+	msg.result = result;
+
+	_mavlink->send_message(MAVLINK_MSG_ID_COMMAND_ACK, &msg);
+}
+
 void
 MavlinkReceiver::handle_message_command_int(mavlink_message_t *msg)
 {
@@ -1212,6 +1353,38 @@ MavlinkReceiver::handle_message_request_data_stream(mavlink_message_t *msg)
 	}
 }
 
+void
+MavlinkReceiver::set_message_interval(int msg_id, float interval)
+{
+	/* 0 asks for the default rate, which only the mode of the link defines: keep the current one */
+	if (interval == 0.0f) {
+		return;
+	}
+
+	float rate = (interval > 0.0f) ? (1e6f / interval) : 0.0f;
+	const char *stream_name = nullptr;
+
+	/* prefer a running stream, several streams may send the same message */
+	MavlinkStream *stream;
+	LL_FOREACH(_mavlink->get_streams(), stream) {
+		if (msg_id == stream->get_id()) {
+			stream_name = stream->get_name();
+			break;
+		}
+	}
+
+	/* otherwise instantiate it now, it is deleted again when stopped */
+	for (unsigned i = 0; stream_name == nullptr && streams_list[i].new_instance != nullptr; i++) {
+		if (msg_id == streams_list[i].id) {
+			stream_name = streams_list[i].get_name();
+		}
+	}
+
+	if (stream_name != nullptr) {
+		_mavlink->configure_stream_threadsafe(stream_name, rate);
+	}
+}
+
 void
 MavlinkReceiver::handle_message_system_time(mavlink_message_t *msg)
 {
@@ -1262,18 +1435,19 @@ MavlinkReceiver::handle_message_timesync(mavlink_message_t *msg)
 
 	} else if (tsync.tc1 > 0) {
 
-		int64_t offset_ns = (tsync.ts1 + now_ns - tsync.tc1*2)/2 ;
-		int64_t dt = _time_offset - offset_ns;
-
-		if (dt > 10000000LL || dt < -10000000LL) { // 10 millisecond skew
-			_time_offset = offset_ns;
-			warnx("[timesync] Hard setting offset.");
-		} else {
-			smooth_time_offset(offset_ns);
+		/* reply to our own request, see MavlinkStreamTimesync */
+		if (!_timesync.add_sample(tsync.ts1, tsync.tc1, now_ns)) {
+			return;
 		}
 	}
 
-	tsync_offset.offset_ns = _time_offset ;
+	int64_t offset_ns;
+
+	if (!_timesync.get_estimate(&offset_ns, &tsync_offset.skew, &tsync_offset.rtt_us)) {
+		return;
+	}
+
+	tsync_offset.offset_ns = offset_ns;
 
 	if (_time_offset_pub == nullptr) {
 		_time_offset_pub = orb_advertise(ORB_ID(time_offset), &tsync_offset);
@@ -1718,6 +1892,8 @@ MavlinkReceiver::receive_thread(void *arg)
 {
 
 	const int timeout = 500;
+	/* poll more often while a command waits for its result, the ack is sent from this thread */
+	const int ack_timeout = 20;
 #ifdef __PX4_POSIX
 	/* 1500 is the Wifi MTU, so we make sure to fit a full packet */
 	uint8_t buf[1600];
@@ -1757,11 +1933,19 @@ MavlinkReceiver::receive_thread(void *arg)
 		fds[0].events = POLLIN;
 	}
 
+#ifdef MAVLINK_UDP_MMSG
+	/* datagram buffers for batched receive, too large for the stack */
+	uint8_t *batch_bufs = nullptr;
+
+	if (_mavlink->get_protocol() == UDP && _mavlink->get_batch_io()) {
+		batch_bufs = new uint8_t[MAVLINK_RX_MAX_DATAGRAMS * sizeof(buf)];
+	}
+#endif
 #endif
 	ssize_t nread = 0;
 
 	while (!_mavlink->_task_should_exit) {
-		if (poll(&fds[0], 1, timeout) > 0) {
+		if (poll(&fds[0], 1, command_pending() ? ack_timeout : timeout) > 0) {
 			if (_mavlink->get_protocol() == SERIAL) {
 				/* non-blocking read. read may return negative values */
 				if ((nread = ::read(uart_fd, buf, sizeof(buf))) < (ssize_t)sizeof(buf)) {
@@ -1771,6 +1955,37 @@ MavlinkReceiver::receive_thread(void *arg)
 			}
 #ifdef __PX4_POSIX
 			if (_mavlink->get_protocol() == UDP) {
+#ifdef MAVLINK_UDP_MMSG
+				if ((fds[0].revents & POLLIN) && batch_bufs != nullptr) {
+					/* take everything that queued up since the last poll with one call */
+					struct mmsghdr msgs[MAVLINK_RX_MAX_DATAGRAMS] = {};
+					struct iovec iovs[MAVLINK_RX_MAX_DATAGRAMS];
+					struct sockaddr_in addrs[MAVLINK_RX_MAX_DATAGRAMS];
+
+					for (unsigned i = 0; i < MAVLINK_RX_MAX_DATAGRAMS; i++) {
+						iovs[i].iov_base = &batch_bufs[i * sizeof(buf)];
+						iovs[i].iov_len = sizeof(buf);
+						msgs[i].msg_hdr.msg_iov = &iovs[i];
+						msgs[i].msg_hdr.msg_iovlen = 1;
+						msgs[i].msg_hdr.msg_name = &addrs[i];
+						msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+					}
+
+					int received = recvmmsg(_mavlink->get_socket_fd(), msgs, MAVLINK_RX_MAX_DATAGRAMS, MSG_DONTWAIT, nullptr);
+
+					for (int i = 0; i < received; i++) {
+						parse_buffer(&batch_bufs[i * sizeof(buf)], msgs[i].msg_len, &msg);
+					}
+
+					if (received > 0) {
+						memcpy(&srcaddr, &addrs[received - 1], sizeof(srcaddr));
+					}
+
+					/* all datagrams are parsed already */
+					nread = 0;
+
+				} else
+#endif
 				if (fds[0].revents & POLLIN) {
 					nread = recvfrom(_mavlink->get_socket_fd(), buf, sizeof(buf), 0, (struct sockaddr *)&srcaddr, &addrlen);
 				}
@@ -1785,47 +2000,73 @@ MavlinkReceiver::receive_thread(void *arg)
 				memcpy(srcaddr_last, &srcaddr, sizeof(srcaddr));
 			}
 #endif
-			/* if read failed, this loop won't execute */
-			for (ssize_t i = 0; i < nread; i++) {
-				if (mavlink_parse_char(_mavlink->get_channel(), buf[i], &msg, &status)) {
-					/* handle generic messages and commands */
-					handle_message(&msg);
-
-					/* handle packet with parent object */
-					_mavlink->handle_message(&msg);
-				}
-			}
-
-			/* count received bytes */
-			_mavlink->count_rxbytes(nread);
+			/* if read failed, nothing is parsed */
+			parse_buffer(buf, nread, &msg);
 		}
+
+		command_ack_update();
 	}
 
+#ifdef MAVLINK_UDP_MMSG
+	delete[] batch_bufs;
+#endif
+
 	return NULL;
 }
 
+void
+MavlinkReceiver::parse_buffer(const uint8_t *buf, ssize_t len, mavlink_message_t *msg)
+{
+	for (ssize_t i = 0; i < len; i++) {
+		if (mavlink_parse_char(_mavlink->get_channel(), buf[i], msg, &status)) {
+			/* handle generic messages and commands */
+			handle_message(msg);
+
+			/* handle packet with parent object */
+			_mavlink->handle_message(msg);
+		}
+	}
+
+	if (len > 0) {
+		/* count received bytes */
+		_mavlink->count_rxbytes(len);
+	}
+}
+
 void MavlinkReceiver::print_status()
 {
+	printf("\treceived messages:\n");
 
+	for (unsigned msgid = 0; msgid < sizeof(_msg_count) / sizeof(_msg_count[0]); msgid++) {
+		if (_msg_count[msgid] == 0) {
+			continue;
+		}
+
+		printf("\t%3u: %u\n", msgid, (unsigned)_msg_count[msgid]);
+
+		unsigned slot = _handler_slot[msgid];
+
+		if (slot != 0 && _handler_perf[slot - 1] != nullptr) {
+			perf_print_counter(_handler_perf[slot - 1]);
+		}
+	}
 }
 
 uint64_t MavlinkReceiver::sync_stamp(uint64_t usec)
 {
-	if(_time_offset > 0)
-		return usec - (_time_offset / 1000) ;
-	else
+	uint64_t local_usec = _timesync.sync_stamp(usec);
+
+	if (local_usec != 0) {
+		return local_usec;
+
+	} else {
 		return hrt_absolute_time();
+	}
 }
 
-
-void MavlinkReceiver::smooth_time_offset(uint64_t offset_ns)
+void MavlinkReceiver::print_timesync_status()
 {
-	/* alpha = 0.6 fixed for now. The closer alpha is to 1.0,
-         * the faster the moving average updates in response to
-	 * new offset samples.
-	 */
-
- 	_time_offset = (_time_offset_avg_alpha * offset_ns) + (1.0 - _time_offset_avg_alpha) * _time_offset;
+	_timesync.print_status();
 }
 
 
@@ -1833,8 +2074,12 @@ void *MavlinkReceiver::start_helper(void *context)
 {
 	MavlinkReceiver *rcv = new MavlinkReceiver((Mavlink *)context);
 
+	((Mavlink *)context)->set_receiver(rcv);
+
 	rcv->receive_thread(NULL);
 
+	((Mavlink *)context)->set_receiver(nullptr);
+
 	delete rcv;
 
 	return nullptr;
@@ -41,6 +41,7 @@
 
 #pragma once
 
+#include <pthread.h>
 #include <systemlib/perf_counter.h>
 #include <uORB/uORB.h>
 #include <uORB/topics/sensor_combined.h>
@@ -55,6 +56,7 @@
 #include <uORB/topics/vehicle_status.h>
 #include <uORB/topics/offboard_control_mode.h>
 #include <uORB/topics/vehicle_command.h>
+#include <uORB/topics/vehicle_command_ack.h>
 #include <uORB/topics/vehicle_local_position_setpoint.h>
 #include <uORB/topics/vehicle_global_velocity_setpoint.h>
 #include <uORB/topics/position_setpoint_triplet.h>
@@ -76,6 +78,7 @@
 #include <uORB/topics/distance_sensor.h>
 
 #include "mavlink_ftp.h"
+#include "mavlink_timesync.h"
 
 #define PX4_EPOCH_SECS 1234567890ULL
 
@@ -110,9 +113,71 @@ public:
 
 	static void *start_helper(void *context);
 
+	/**
+	 * Handler for a message ID the receiver does not handle itself, called on the receive thread
+	 */
+	typedef void (*ExternalHandler)(Mavlink *mavlink, const mavlink_message_t *msg, void *arg);
+
+	/**
+	 * Register a handler for a message ID on all mavlink instances.
+	 *
+	 * @param msgid		message ID to handle
+	 * @param handler	function to call for each received message
+	 * @param arg		passed to the handler
+	 * @param name		name of the handling time perf counter, has to stay valid
+	 * @return		OK on success, -EBUSY if the message ID is already handled,
+	 *			-ENOMEM if all handler slots are in use
+	 */
+	static int register_handler(uint8_t msgid, ExternalHandler handler, void *arg, const char *name);
+
+	/**
+	 * Display the state of the time synchronization with the companion.
+	 */
+	static void print_timesync_status();
+
 private:
 	Mavlink	*_mavlink;
 
+	typedef void (MavlinkReceiver::*MessageHandler)(mavlink_message_t *msg);
+
+	/** when an internal handler is called */
+	enum HandlerMode {
+		HANDLER_ALWAYS = 0,
+		HANDLER_HIL,		///< only in HIL mode
+		HANDLER_HIL_GPS		///< in HIL mode or from our own system ID with MAV_USEHILGPS set
+	};
+
+	struct InternalHandler {
+		uint8_t msgid;
+		uint8_t mode;
+		MessageHandler handler;
+		const char *name;
+	};
+
+	struct ExternalHandlerSlot {
+		ExternalHandler handler;
+		void *arg;
+		const char *name;
+	};
+
+	static constexpr unsigned MAX_INTERNAL_HANDLERS = 32;
+	static constexpr unsigned MAX_EXTERNAL_HANDLERS = 16;
+
+	static const InternalHandler _internal_handlers[];
+	static ExternalHandlerSlot _external_handlers[MAX_EXTERNAL_HANDLERS];
+	static unsigned _external_handler_count;
+
+	/** handler of each message ID, 0: none, else 1 + index into internal handlers followed by external ones */
+	static volatile uint8_t _handler_slot[256];
+	static bool _handler_slots_initialized;
+	static pthread_mutex_t _handler_mutex;
+
+	/** clock offset to the companion, shared by all instances */
+	static MavlinkTimesync _timesync;
+
+	static unsigned internal_handler_count();
+	static void init_handler_slots();
+
 	void handle_message(mavlink_message_t *msg);
 	void handle_message_command_long(mavlink_message_t *msg);
 	void handle_message_command_int(mavlink_message_t *msg);
@@ -138,18 +203,47 @@ private:
 	void handle_message_hil_state_quaternion(mavlink_message_t *msg);
 	void handle_message_distance_sensor(mavlink_message_t *msg);
 
+	/**
+	 * Start, change or stop the stream sending a message
+	 *
+	 * @param msg_id MAVLink message ID
+	 * @param interval interval between messages in us, negative stops the stream
+	 */
+	void set_message_interval(int msg_id, float interval);
+
+	/**
+	 * Record a command before it is published
+	 *
+	 * @return false if it is a retry, i.e. repeats a command received before
+	 * with a higher confirmation counter. The retry is not run again, but
+	 * answered again if the result is known.
+	 */
+	bool command_track(const mavlink_message_t *msg, const mavlink_command_long_t &cmd);
+
+	/**
+	 * Send the COMMAND_ACK of the tracked commands answered since the last call
+	 */
+	void command_ack_update();
+
+	/**
+	 * @return true if a tracked command waits for its result
+	 */
+	bool command_pending();
+
+	void send_command_ack(uint16_t command, uint8_t result);
+
 	void *receive_thread(void *arg);
 
 	/**
-	 * Convert remote timestamp to local hrt time (usec)
-	 * Use timesync if available, monotonic boot time otherwise
+	 * Parse received bytes and handle all complete messages
 	 */
-	uint64_t sync_stamp(uint64_t usec);
+	void parse_buffer(const uint8_t *buf, ssize_t len, mavlink_message_t *msg);
 
 	/**
-	 * Exponential moving average filter to smooth time offset
+	 * Convert remote timestamp to local hrt time (usec)
+	 * Use timesync if available, monotonic boot time otherwise
 	 */
-	void smooth_time_offset(uint64_t offset_ns);
+	uint64_t sync_stamp(uint64_t usec);
 
 	/**
 	 * Decode a switch position from a bitfield
@@ -194,6 +288,7 @@ private:
 	orb_advert_t _land_detector_pub;
 	orb_advert_t _time_offset_pub;
 	int _control_mode_sub;
+	int _command_ack_sub;
 	int _hil_frames;
 	uint64_t _old_timestamp;
 	bool _hil_local_proj_inited;
@@ -202,8 +297,6 @@ private:
 	struct offboard_control_mode_s _offboard_control_mode;
 	struct vehicle_attitude_setpoint_s _att_sp;
 	struct vehicle_rates_setpoint_s _rates_sp;
-	double _time_offset_avg_alpha;
-	uint64_t _time_offset;
 	int	_orb_class_instance;
 
 	static constexpr unsigned MOM_SWITCH_COUNT = 8;
@@ -211,6 +304,26 @@ private:
 	uint8_t _mom_switch_pos[MOM_SWITCH_COUNT];
 	uint16_t _mom_switch_state;
 
+	/**
+	 * A COMMAND_LONG passed on as vehicle_command
+	 */
+	struct CommandTrack {
+		hrt_abstime time;		///< time received or answered, 0 if the entry is free
+		mavlink_command_long_t cmd;
+		uint8_t sysid;			///< sender of the command
+		uint8_t compid;
+		uint8_t result;			///< MAV_RESULT, COMMAND_PENDING until answered
+	};
+
+	static constexpr unsigned COMMAND_TRACK_SIZE = 4;
+	static constexpr unsigned COMMAND_TRACK_TIMEOUT = 3000000;	///< us a command and its result are remembered
+	static constexpr uint8_t COMMAND_PENDING = 0xff;
+
+	CommandTrack _command_track[COMMAND_TRACK_SIZE];
+
+	uint32_t _msg_count[256];	///< received messages per message ID
+	perf_counter_t _handler_perf[MAX_INTERNAL_HANDLERS + MAX_EXTERNAL_HANDLERS];
+
 	/* do not allow copying this class */
 	MavlinkReceiver(const MavlinkReceiver &);
 	MavlinkReceiver operator=(const MavlinkReceiver &);
@@ -47,12 +47,36 @@ MavlinkStream::MavlinkStream(Mavlink *mavlink) :
 	next(nullptr),
 	_mavlink(mavlink),
 	_interval(1000000),
-	_last_sent(0)
+	_subscription_count(0),
+	_last_sent(0),
+	_sent_count(0),
+	_deferred_count(0),
+	_rate_achieved(0.0f),
+	_rate_deferred(0.0f)
 {
 }
 
 MavlinkStream::~MavlinkStream()
 {
+	for (unsigned i = 0; i < _subscription_count; i++) {
+		_mavlink->remove_orb_subscription(_subscriptions[i]);
+	}
+}
+
+MavlinkOrbSubscription *
+MavlinkStream::subscribe(const orb_id_t topic, int instance, bool shared)
+{
+	MavlinkOrbSubscription *sub = _mavlink->add_orb_subscription(topic, instance, shared);
+
+	/* a stream with more subscriptions keeps the extra ones until the instance exits */
+	if (_subscription_count < MAX_SUBSCRIPTIONS) {
+		_subscriptions[_subscription_count++] = sub;
+
+	} else {
+		warnx("%s: subscription not released", get_name());
+	}
+
+	return sub;
 }
 
 /**
@@ -71,13 +95,8 @@ int
 MavlinkStream::update(const hrt_abstime t)
 {
 	uint64_t dt = t - _last_sent;
-	unsigned int interval = _interval;
 
-	if (!const_rate()) {
-		interval /= _mavlink->get_rate_mult();
-	}
-
-	if (dt > 0 && dt >= interval) {
+	if (dt > 0 && dt >= _interval) {
 		/* interval expired, send message */
 #ifndef __PX4_QURT
 		send(t);
@@ -95,3 +114,18 @@ MavlinkStream::update(const hrt_abstime t)
 
 	return -1;
 }
+
+hrt_abstime
+MavlinkStream::get_next_due()
+{
+	return _last_sent + _interval;
+}
+
+void
+MavlinkStream::update_rate_stats(float dt)
+{
+	_rate_achieved = _sent_count / dt;
+	_rate_deferred = _deferred_count / dt;
+	_sent_count = 0;
+	_deferred_count = 0;
+}
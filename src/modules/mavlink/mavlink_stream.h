@@ -42,9 +42,11 @@
 #define MAVLINK_STREAM_H_
 
 #include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
 
 class Mavlink;
 class MavlinkStream;
+class MavlinkOrbSubscription;
 
 class MavlinkStream
 {
@@ -52,6 +54,17 @@ class MavlinkStream
 public:
 	MavlinkStream *next;
 
+	/**
+	 * Scheduling classes, the link budget is handed out in this order
+	 */
+	enum Priority {
+		PRIORITY_STATUS = 0,	///< heartbeat, system status, protocol replies
+		PRIORITY_ATTITUDE,	///< attitude and fast flight data
+		PRIORITY_POSITION,	///< position, navigation and radio control
+		PRIORITY_DEBUG,		///< raw sensors, outputs and debug values
+		PRIORITY_COUNT
+	};
+
 	MavlinkStream(Mavlink *mavlink);
 	virtual ~MavlinkStream();
 
@@ -73,6 +86,13 @@ public:
 	 * @return 0 if updated / sent, -1 if unchanged
 	 */
 	int update(const hrt_abstime t);
+
+	/**
+	 * Get the time the next message of this stream is due
+	 *
+	 * @return absolute time (us) at which update() will send the next message
+	 */
+	hrt_abstime get_next_due();
 	virtual const char *get_name() const = 0;
 	virtual uint8_t get_id() = 0;
 
@@ -86,16 +106,64 @@ public:
 	 */
 	virtual unsigned get_size() = 0;
 
+	/**
+	 * @return scheduling class of the stream
+	 */
+	virtual Priority get_priority() { return PRIORITY_POSITION; }
+
+	/**
+	 * Count an update which put bytes on the link
+	 */
+	void count_sent() { _sent_count++; }
+
+	/**
+	 * Count an update postponed because the link budget was exhausted
+	 */
+	void count_deferred() { _deferred_count++; }
+
+	/**
+	 * Update the achieved rate from the counters since the last call
+	 *
+	 * @param dt time since the last call in seconds
+	 */
+	void update_rate_stats(float dt);
+
+	/**
+	 * @return achieved message rate in Hz
+	 */
+	float get_rate_achieved() const { return _rate_achieved; }
+
+	/**
+	 * @return rate of updates postponed by the scheduler in Hz
+	 */
+	float get_rate_deferred() const { return _rate_deferred; }
+
 protected:
 	Mavlink     *_mavlink;
 	unsigned int _interval;
 
+	/**
+	 * Subscribe to a topic for this stream, the subscription is released
+	 * when the stream is deleted.
+	 *
+	 * @see Mavlink::add_orb_subscription()
+	 */
+	MavlinkOrbSubscription *subscribe(const orb_id_t topic, int instance = 0, bool shared = true);
+
 #ifndef __PX4_QURT
 	virtual void send(const hrt_abstime t) = 0;
 #endif
 
 private:
+	static const unsigned MAX_SUBSCRIPTIONS = 6;
+
+	MavlinkOrbSubscription *_subscriptions[MAX_SUBSCRIPTIONS];
+	unsigned _subscription_count;
 	hrt_abstime _last_sent;
+	unsigned _sent_count;
+	unsigned _deferred_count;
+	float _rate_achieved;
+	float _rate_deferred;
 
 	/* do not allow top copying this class */
 	MavlinkStream(const MavlinkStream &);
@@ -554,6 +554,106 @@ bool MavlinkFtpTest::_burst_test(void)
 	return true;
 }
 
+/// @brief Tests that offsets re-requested after a burst return the right data, in any order.
+bool MavlinkFtpTest::_read_rerequest_test(void)
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+	BurstInfo				burst_info;
+	
+	// Use the two packet file
+	const DownloadTestCase *test = &_rgDownloadTestCases[2];
+	struct stat st;
+	
+	ut_compare("stat failed", stat(test->file, &st), 0);
+	uint8_t *bytes = new uint8_t[st.st_size];
+	ut_assert("new failed", bytes != nullptr);
+	int fd = ::open(test->file, O_RDONLY);
+	ut_assert("open failed", fd != -1);
+	int bytes_read = ::read(fd, bytes, st.st_size);
+	ut_compare("read failed", bytes_read, st.st_size);
+	::close(fd);
+	
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+	
+	bool success = _send_receive_msg(&payload,		// FTP payload header
+					 strlen(test->file)+1,	// size in bytes of data
+					 (uint8_t*)test->file,	// Data to start into FTP message payload
+					 &reply);		// Payload inside FTP message response
+	if (!success) {
+		return false;
+	}
+	
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	uint8_t session = reply->session;
+	
+	// Burst the whole file first so the server has read ahead
+	burst_info.burst_state = burst_state_first_ack;
+	burst_info.single_packet_file = test->singlePacketRead;
+	burst_info.file_size = st.st_size;
+	burst_info.file_bytes = bytes;
+	burst_info.ftp_test_class = this;
+	_ftp_server->set_unittest_worker(MavlinkFtpTest::receive_message_handler_burst, &burst_info);
+	
+	payload.opcode = MavlinkFTP::kCmdBurstReadFile;
+	payload.session = session;
+	payload.offset = 0;
+	
+	mavlink_message_t msg;
+	_setup_ftp_msg(&payload, 0, nullptr, &msg);
+	_ftp_server->handle_message(&msg);
+	
+	hrt_abstime t = 0;
+	_ftp_server->send(t);
+	
+	ut_compare("Incorrect sequence of messages", burst_info.burst_state, burst_state_complete);
+	
+	_ftp_server->set_unittest_worker(MavlinkFtpTest::receive_message_handler_generic, this);
+	
+	// Re-request the second packet, then the first one
+	uint32_t full_packet_bytes = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(MavlinkFTP::PayloadHeader);
+	const uint32_t offsets[] = { full_packet_bytes, 0 };
+	
+	for (size_t i=0; i<sizeof(offsets)/sizeof(offsets[0]); i++) {
+		payload.opcode = MavlinkFTP::kCmdReadFile;
+		payload.session = session;
+		payload.offset = offsets[i];
+		
+		success = _send_receive_msg(&payload,	// FTP payload header
+					    0,		// size in bytes of data
+					    nullptr,	// Data to start into FTP message payload
+					    &reply);	// Payload inside FTP message response
+		if (!success) {
+			return false;
+		}
+		
+		uint32_t expected_bytes = offsets[i] == 0 ? full_packet_bytes : (uint32_t)st.st_size - full_packet_bytes;
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		ut_compare("Offset incorrect", reply->offset, offsets[i]);
+		ut_compare("Payload size incorrect", reply->size, expected_bytes);
+		ut_compare("File contents differ", memcmp(reply->data, &bytes[offsets[i]], expected_bytes), 0);
+	}
+	
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = session;
+	payload.size = 0;
+	
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+	if (!success) {
+		return false;
+	}
+	
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	
+	delete[] bytes;
+	
+	return true;
+}
+
 /// @brief Tests for correct reponse to a Read command on an invalid session.
 bool MavlinkFtpTest::_read_badsession_test(void)
 {
@@ -739,6 +839,101 @@ bool MavlinkFtpTest::_removefile_test(void)
 	return true;
 }
 
+/// @brief Tests an out of order upload, including a re-sent packet, through the write buffer.
+bool MavlinkFtpTest::_write_test(void)
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+	const uint8_t				packet_bytes = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(MavlinkFTP::PayloadHeader);
+	const unsigned				packet_count = 3;
+	uint8_t					bytes[packet_bytes * packet_count];
+	
+	for (size_t i=0; i<sizeof(bytes); i++) {
+		bytes[i] = i * 7;
+	}
+	
+	ut_compare("mkdir failed", ::mkdir(_unittest_microsd_dir, S_IRWXU | S_IRWXG | S_IRWXO), 0);
+	
+	payload.opcode = MavlinkFTP::kCmdCreateFile;
+	payload.offset = 0;
+	
+	bool success = _send_receive_msg(&payload,				// FTP payload header
+					 strlen(_unittest_microsd_file)+1,	// size in bytes of data
+					 (uint8_t*)_unittest_microsd_file,	// Data to start into FTP message payload
+					 &reply);				// Payload inside FTP message response
+	if (!success) {
+		return false;
+	}
+	
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	uint8_t session = reply->session;
+	
+	const unsigned packets[] = { 1, 0, 0, 2 };
+	
+	for (size_t i=0; i<sizeof(packets)/sizeof(packets[0]); i++) {
+		payload.opcode = MavlinkFTP::kCmdWriteFile;
+		payload.session = session;
+		payload.offset = packets[i] * packet_bytes;
+		
+		success = _send_receive_msg(&payload,				// FTP payload header
+					    packet_bytes,			// size in bytes of data
+					    &bytes[packets[i] * packet_bytes],	// Data to start into FTP message payload
+					    &reply);				// Payload inside FTP message response
+		if (!success) {
+			return false;
+		}
+		
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		ut_compare("Incorrect payload size", reply->size, sizeof(uint32_t));
+		ut_compare("Bytes written incorrect", *((uint32_t*)&reply->data[0]), packet_bytes);
+	}
+	
+	// The CRC of the first two packets, as a client resuming the upload would ask for,
+	// it is answered from send()
+	payload.opcode = MavlinkFTP::kCmdCalcFileCRC32;
+	payload.offset = 2 * packet_bytes;
+	
+	mavlink_message_t msg;
+	_setup_ftp_msg(&payload, strlen(_unittest_microsd_file)+1, (uint8_t*)_unittest_microsd_file, &msg);
+	_ftp_server->handle_message(&msg);
+	
+	hrt_abstime t = 0;
+	_ftp_server->send(t);
+	
+	success = _decode_message(&_reply_msg, &reply);
+	if (!success) {
+		return false;
+	}
+	
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	ut_compare("CRC incorrect", *((uint32_t*)&reply->data[0]), crc32part(bytes, 2 * packet_bytes, 0));
+	
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = session;
+	payload.size = 0;
+	
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+	if (!success) {
+		return false;
+	}
+	
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	
+	uint8_t file_bytes[sizeof(bytes) + 1];
+	int fd = ::open(_unittest_microsd_file, O_RDONLY);
+	ut_assert("open failed", fd != -1);
+	int bytes_read = ::read(fd, file_bytes, sizeof(file_bytes));
+	::close(fd);
+	
+	ut_compare("File size incorrect", bytes_read, (int)sizeof(bytes));
+	ut_compare("File contents differ", memcmp(file_bytes, bytes, sizeof(bytes)), 0);
+	
+	return true;
+}
+
 /// Static method used as callback from MavlinkFTP for generic use. This method will be called by MavlinkFTP when
 /// it needs to send a message out on Mavlink.
 void MavlinkFtpTest::receive_message_handler_generic(const mavlink_file_transfer_protocol_t* ftp_req, void *worker_data)
@@ -897,9 +1092,11 @@ bool MavlinkFtpTest::run_tests(void)
 	ut_run_test(_read_test);
 	ut_run_test(_read_badsession_test);
 	ut_run_test(_burst_test);
+	ut_run_test(_read_rerequest_test);
 	ut_run_test(_removedirectory_test);
 	ut_run_test(_createdirectory_test);
 	ut_run_test(_removefile_test);
+	ut_run_test(_write_test);
 	
 	return (_tests_failed == 0);
 
@@ -87,9 +87,11 @@ private:
 	bool _read_test(void);
 	bool _read_badsession_test(void);
 	bool _burst_test(void);
+	bool _read_rerequest_test(void);
 	bool _removedirectory_test(void);
 	bool _createdirectory_test(void);
 	bool _removefile_test(void);
+	bool _write_test(void);
 	
 	void _receive_message_handler_generic(const mavlink_file_transfer_protocol_t* ftp_req);
 	void _setup_ftp_msg(const MavlinkFTP::PayloadHeader *payload_header, uint8_t size, const uint8_t *data, mavlink_message_t *msg);
@@ -0,0 +1,230 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_timesync.cpp
+ * Clock offset and skew estimation from TIMESYNC round trips.
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "mavlink_timesync.h"
+
+/* round trips longer than this carry no useful timing */
+static constexpr uint64_t MAX_RTT_NS = 100000000ULL;
+
+/* a sample is an outlier if its round trip takes longer than this times the usual */
+static constexpr double RTT_OUTLIER_FACTOR = 3.0;
+
+/* residuals below this are never rejected, covering scheduling jitter */
+static constexpr double RESIDUAL_MIN_NS = 500000.0;
+
+/* filter gains once converged, the skew gain is per sample */
+static constexpr double OFFSET_GAIN = 0.05;
+static constexpr double SKEW_GAIN = 0.005;
+static constexpr double RTT_GAIN = 0.05;
+
+/* give up on skews beyond any crystal tolerance */
+static constexpr double MAX_SKEW = 0.001;
+
+MavlinkTimesync::MavlinkTimesync() :
+	_mutex(),
+	_offset_ns(0),
+	_ref_ns(0),
+	_skew(0.0),
+	_rtt_ns(0.0),
+	_rtt_min_ns(0),
+	_residual_ns(0),
+	_samples(0),
+	_rejected(0),
+	_rejected_row(0),
+	_resets(0)
+{
+	pthread_mutex_init(&_mutex, nullptr);
+}
+
+MavlinkTimesync::~MavlinkTimesync()
+{
+	pthread_mutex_destroy(&_mutex);
+}
+
+void
+MavlinkTimesync::reset_locked()
+{
+	_offset_ns = 0;
+	_ref_ns = 0;
+	_skew = 0.0;
+	_rtt_ns = 0.0;
+	_residual_ns = 0;
+	_samples = 0;
+	_rejected_row = 0;
+}
+
+void
+MavlinkTimesync::reset()
+{
+	pthread_mutex_lock(&_mutex);
+	reset_locked();
+	pthread_mutex_unlock(&_mutex);
+}
+
+bool
+MavlinkTimesync::add_sample(uint64_t local_send_ns, uint64_t remote_ns, uint64_t local_recv_ns)
+{
+	if (local_recv_ns < local_send_ns || local_recv_ns - local_send_ns > MAX_RTT_NS) {
+		/* not a reply to a recent request of ours */
+		return false;
+	}
+
+	uint64_t rtt_ns = local_recv_ns - local_send_ns;
+	uint64_t mid_ns = local_send_ns + rtt_ns / 2;
+	int64_t measured_ns = (int64_t)(mid_ns - remote_ns);
+
+	pthread_mutex_lock(&_mutex);
+
+	if (_rtt_min_ns == 0 || rtt_ns < _rtt_min_ns) {
+		_rtt_min_ns = rtt_ns;
+	}
+
+	if (_samples > 0 && _rejected_row >= RESET_COUNT) {
+		/* the remote clock jumped or the link changed, start over */
+		reset_locked();
+		_resets++;
+	}
+
+	if (_samples == 0) {
+		_offset_ns = measured_ns;
+		_ref_ns = mid_ns;
+		_rtt_ns = rtt_ns;
+		_samples = 1;
+		pthread_mutex_unlock(&_mutex);
+		return true;
+	}
+
+	double dt_ns = (double)(int64_t)(mid_ns - _ref_ns);
+	double predicted_ns = _offset_ns + _skew * dt_ns;
+	double residual_ns = measured_ns - predicted_ns;
+
+	/* the asymmetry of a round trip bounds the error of its offset */
+	double residual_max_ns = fmax(RESIDUAL_MIN_NS, RTT_OUTLIER_FACTOR * _rtt_ns);
+	bool converged = (_samples >= CONVERGE_COUNT);
+	bool outlier = (fabs(residual_ns) > residual_max_ns) ||
+		       (converged && rtt_ns > RTT_OUTLIER_FACTOR * _rtt_ns && rtt_ns > _rtt_min_ns * 2);
+
+	/* follow a slowly growing latency, or every sample ends up an outlier */
+	_rtt_ns += RTT_GAIN * (rtt_ns - _rtt_ns);
+	_residual_ns = (int64_t)residual_ns;
+
+	if (outlier || dt_ns <= 0.0) {
+		_rejected++;
+		_rejected_row++;
+		pthread_mutex_unlock(&_mutex);
+		return false;
+	}
+
+	/* average the first samples evenly, then filter */
+	double offset_gain = converged ? OFFSET_GAIN : 1.0 / (_samples + 1);
+
+	_offset_ns = (int64_t)(predicted_ns + offset_gain * residual_ns);
+	_skew += SKEW_GAIN * residual_ns / dt_ns;
+
+	if (_skew > MAX_SKEW) {
+		_skew = MAX_SKEW;
+
+	} else if (_skew < -MAX_SKEW) {
+		_skew = -MAX_SKEW;
+	}
+
+	_ref_ns = mid_ns;
+	_rejected_row = 0;
+
+	if (_samples < CONVERGE_COUNT) {
+		_samples++;
+	}
+
+	pthread_mutex_unlock(&_mutex);
+	return true;
+}
+
+uint64_t
+MavlinkTimesync::sync_stamp(uint64_t remote_usec)
+{
+	uint64_t local_usec = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	if (_samples >= CONVERGE_COUNT) {
+		int64_t local_ns = (int64_t)(remote_usec * 1000ULL) + _offset_ns;
+		double offset_ns = _offset_ns + _skew * (double)(local_ns - (int64_t)_ref_ns);
+		local_ns = (int64_t)(remote_usec * 1000ULL) + (int64_t)offset_ns;
+
+		if (local_ns > 0) {
+			local_usec = local_ns / 1000;
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return local_usec;
+}
+
+bool
+MavlinkTimesync::get_estimate(int64_t *offset_ns, float *skew, uint32_t *rtt_us)
+{
+	pthread_mutex_lock(&_mutex);
+
+	*offset_ns = _offset_ns;
+	*skew = _skew;
+	*rtt_us = _rtt_ns / 1000.0;
+	bool converged = (_samples >= CONVERGE_COUNT);
+
+	pthread_mutex_unlock(&_mutex);
+
+	return converged;
+}
+
+void
+MavlinkTimesync::print_status()
+{
+	pthread_mutex_lock(&_mutex);
+
+	printf("\ttimesync:\t%s\n", (_samples >= CONVERGE_COUNT) ? "synchronized" : "not synchronized");
+	printf("\toffset:\t\t%lld ns\n", (long long)_offset_ns);
+	printf("\tskew:\t\t%.3f ppm\n", _skew * 1e6);
+	printf("\trtt:\t\t%.1f us (min %llu us)\n", _rtt_ns / 1000.0, (unsigned long long)(_rtt_min_ns / 1000));
+	printf("\tresidual:\t%lld ns\n", (long long)_residual_ns);
+	printf("\trejected:\t%u, resets: %u\n", _rejected, _resets);
+
+	pthread_mutex_unlock(&_mutex);
+}
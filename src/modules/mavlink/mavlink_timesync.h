@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_timesync.h
+ * Clock offset and skew estimation from TIMESYNC round trips.
+ *
+ * Every round trip gives the remote time at the midpoint of our request
+ * and its reply, uncertain by half the round trip time. The estimator
+ * tracks the offset (local minus remote) and its drift with an
+ * alpha-beta filter, rejects samples whose round trip time or residual
+ * is far above the usual, and starts over if too many in a row are
+ * rejected, e.g. after the companion clock jumped.
+ *
+ * There is one estimator for all mavlink instances, as the companion
+ * can answer on any of them.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+
+class MavlinkTimesync
+{
+public:
+	MavlinkTimesync();
+	~MavlinkTimesync();
+
+	/**
+	 * Add the result of one round trip.
+	 *
+	 * @param local_send_ns		local time our request was sent
+	 * @param remote_ns		remote time the request was answered
+	 * @param local_recv_ns		local time the reply was received
+	 * @return			true if the sample was used, false if it was rejected
+	 */
+	bool add_sample(uint64_t local_send_ns, uint64_t remote_ns, uint64_t local_recv_ns);
+
+	/**
+	 * Convert a remote timestamp to local time.
+	 *
+	 * @param remote_usec		remote time in microseconds
+	 * @return			local time in microseconds, 0 if not synchronized yet
+	 */
+	uint64_t sync_stamp(uint64_t remote_usec);
+
+	/**
+	 * Get the current estimate.
+	 *
+	 * @param offset_ns		local minus remote time
+	 * @param skew			drift of the offset in ns per ns
+	 * @param rtt_us		filtered round trip time
+	 * @return			true if synchronized
+	 */
+	bool get_estimate(int64_t *offset_ns, float *skew, uint32_t *rtt_us);
+
+	/**
+	 * Drop the current estimate.
+	 */
+	void reset();
+
+	void print_status();
+
+	static constexpr unsigned CONVERGE_COUNT = 5;	///< samples before the estimate is used
+	static constexpr unsigned RESET_COUNT = 8;	///< rejected samples in a row to start over
+
+private:
+	pthread_mutex_t _mutex;
+
+	int64_t _offset_ns;		///< local minus remote time at _ref_ns
+	uint64_t _ref_ns;		///< local time of the last update
+	double _skew;			///< drift of the offset in ns per ns
+	double _rtt_ns;			///< filtered round trip time
+	uint64_t _rtt_min_ns;		///< smallest round trip time seen
+	int64_t _residual_ns;		///< residual of the last sample
+
+	unsigned _samples;		///< samples used since the last reset
+	unsigned _rejected;		///< samples rejected in total
+	unsigned _rejected_row;		///< samples rejected in a row
+	unsigned _resets;		///< number of resets
+
+	void reset_locked();
+
+	/* do not allow copying this class */
+	MavlinkTimesync(const MavlinkTimesync &);
+	MavlinkTimesync operator=(const MavlinkTimesync &);
+};
@@ -46,7 +46,9 @@ SRCS 		 +=	mavlink.c \
 			mavlink_stream.cpp \
 			mavlink_rate_limiter.cpp \
 			mavlink_receiver.cpp \
-			mavlink_ftp.cpp 
+			mavlink_ftp.cpp \
+			mavlink_log_stream.cpp \
+			mavlink_timesync.cpp
 
 INCLUDE_DIRS	 += $(MAVLINK_SRC)/include/mavlink
 
@@ -76,11 +76,13 @@
 #include <uORB/topics/fw_virtual_rates_setpoint.h>
 #include <uORB/topics/mc_virtual_rates_setpoint.h>
 #include <uORB/topics/vehicle_attitude.h>
+#include <uORB/topics/sensor_combined.h>
 #include <uORB/topics/vehicle_control_mode.h>
 #include <uORB/topics/vehicle_status.h>
 #include <uORB/topics/actuator_armed.h>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/multirotor_motor_limits.h>
+#include <uORB/topics/vtol_vehicle_status.h>
 #include <uORB/topics/mc_att_ctrl_status.h>
 #include <systemlib/param/param.h>
 #include <systemlib/err.h>
@@ -101,6 +103,7 @@ extern "C" __EXPORT int mc_att_control_main(int argc, char *argv[]);
 #define MIN_TAKEOFF_THRUST    0.2f
 #define RATES_I_LIMIT	0.3f
 #define MANUAL_THROTTLE_MAX_MULTICOPTER	0.9f
+#define GYRO_OFFSET_GAIN	0.005f	/**< gain per attitude update of the gyro offset low pass */
 
 class MulticopterAttitudeControl
 {
@@ -136,6 +139,8 @@ private:
 	int		_armed_sub;				/**< arming status subscription */
 	int		_vehicle_status_sub;	/**< vehicle status subscription */
 	int 	_motor_limits_sub;		/**< motor limits subscription */
+	int		_sensor_combined_sub;	/**< raw sensor data subscription */
+	int		_vtol_status_sub;		/**< vtol vehicle status subscription */
 
 	orb_advert_t	_v_rates_sp_pub;		/**< rate setpoint publication */
 	orb_advert_t	_actuators_0_pub;		/**< attitude actuator controls publication */
@@ -155,7 +160,9 @@ private:
 	struct actuator_armed_s				_armed;				/**< actuator arming status */
 	struct vehicle_status_s				_vehicle_status;	/**< vehicle status */
 	struct multirotor_motor_limits_s	_motor_limits;		/**< motor limits */
+	struct vtol_vehicle_status_s		_vtol_status;		/**< vtol vehicle status */
 	struct mc_att_ctrl_status_s 		_controller_status; /**< controller status */
+	struct sensor_combined_s			_sensor_combined;	/**< raw sensor data, for the gyro */
 
 	perf_counter_t	_loop_perf;			/**< loop performance counter */
 	perf_counter_t	_controller_latency_perf;
@@ -166,6 +173,10 @@ private:
 	math::Vector<3>		_rates_int;		/**< angular rates integral error */
 	float				_thrust_sp;		/**< thrust setpoint */
 	math::Vector<3>		_att_control;	/**< attitude control vector */
+	math::Vector<3>		_gyro_offset;	/**< attitude rates minus gyro rates, low passed */
+	bool				_gyro_offset_valid;	/**< true once _gyro_offset was initialised */
+	hrt_abstime			_last_att_run;	/**< time of the last attitude loop */
+	hrt_abstime			_last_rate_run;	/**< time of the last rate loop */
 
 	math::Matrix<3, 3>  _I;				/**< identity matrix */
 
@@ -197,6 +208,8 @@ private:
 		param_t acro_pitch_max;
 		param_t acro_yaw_max;
 
+		param_t rate_gyro;
+
 	}		_params_handles;		/**< handles for interesting parameters */
 
 	struct {
@@ -217,6 +230,8 @@ private:
 		float man_yaw_max;
 		math::Vector<3> acro_rate_max;		/**< max attitude rates in acro mode */
 
+		int rate_gyro;						/**< run the rate loop on gyro samples */
+
 	}		_params;
 
 	/**
@@ -262,7 +277,17 @@ private:
 	/**
 	 * Attitude rates controller.
 	 */
-	void		control_attitude_rates(float dt);
+	void		control_attitude_rates(float dt, const math::Vector<3> &rates);
+
+	/**
+	 * Attitude loop: poll the slow topics and set the rates setpoint.
+	 */
+	void		run_attitude_loop();
+
+	/**
+	 * Rates loop: run the rates controller and publish the actuator controls.
+	 */
+	void		run_rates_loop(const math::Vector<3> &rates, uint64_t timestamp_sample);
 
 	/**
 	 * Check for vehicle status updates.
@@ -274,6 +299,11 @@ private:
 	 */
 	void		vehicle_motor_limits_poll();
 
+	/**
+	 * Check for vtol vehicle status updates.
+	 */
+	void		vtol_status_poll();
+
 	/**
 	 * Shim for calling task_main from task_create.
 	 */
@@ -310,6 +340,8 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	_manual_control_sp_sub(-1),
 	_armed_sub(-1),
 	_vehicle_status_sub(-1),
+	_sensor_combined_sub(-1),
+	_vtol_status_sub(-1),
 
 /* publications */
 	_v_rates_sp_pub(nullptr),
@@ -322,7 +354,7 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 
 /* performance counters */
 	_loop_perf(perf_alloc(PC_ELAPSED, "mc_att_control")),
-	_controller_latency_perf(perf_alloc_once(PC_ELAPSED, "ctrl_latency"))
+	_controller_latency_perf(perf_alloc_once(PC_HISTOGRAM, "ctrl_latency"))
 
 {
 	memset(&_v_att, 0, sizeof(_v_att));
@@ -335,6 +367,8 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	memset(&_vehicle_status, 0, sizeof(_vehicle_status));
 	memset(&_motor_limits, 0, sizeof(_motor_limits));
 	memset(&_controller_status,0,sizeof(_controller_status));
+	memset(&_sensor_combined, 0, sizeof(_sensor_combined));
+	memset(&_vtol_status, 0, sizeof(_vtol_status));
 	_vehicle_status.is_rotary_wing = true;
 
 	_params.att_p.zero();
@@ -351,6 +385,7 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	_params.man_yaw_max = 0.0f;
 	_params.mc_rate_max.zero();
 	_params.acro_rate_max.zero();
+	_params.rate_gyro = 0;
 
 	_rates_prev.zero();
 	_rates_sp.zero();
@@ -358,6 +393,10 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	_rates_int.zero();
 	_thrust_sp = 0.0f;
 	_att_control.zero();
+	_gyro_offset.zero();
+	_gyro_offset_valid = false;
+	_last_att_run = 0;
+	_last_rate_run = 0;
 
 	_I.identity();
 
@@ -386,6 +425,7 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	_params_handles.acro_roll_max	= 	param_find("MC_ACRO_R_MAX");
 	_params_handles.acro_pitch_max	= 	param_find("MC_ACRO_P_MAX");
 	_params_handles.acro_yaw_max		= 	param_find("MC_ACRO_Y_MAX");
+	_params_handles.rate_gyro		=	param_find("MC_RATE_GYRO");
 
 	/* fetch initial parameter values */
 	parameters_update();
@@ -482,6 +522,8 @@ MulticopterAttitudeControl::parameters_update()
 	param_get(_params_handles.acro_yaw_max, &v);
 	_params.acro_rate_max(2) = math::radians(v);
 
+	param_get(_params_handles.rate_gyro, &_params.rate_gyro);
+
 	_actuators_0_circuit_breaker_enabled = circuit_breaker_enabled("CBRK_RATE_CTRL", CBRK_RATE_CTRL_KEY);
 
 	return OK;
@@ -598,6 +640,18 @@ MulticopterAttitudeControl::vehicle_motor_limits_poll()
 	}
 }
 
+void
+MulticopterAttitudeControl::vtol_status_poll()
+{
+	/* check if there is a new message */
+	bool updated;
+	orb_check(_vtol_status_sub, &updated);
+
+	if (updated) {
+		orb_copy(ORB_ID(vtol_vehicle_status), _vtol_status_sub, &_vtol_status);
+	}
+}
+
 /**
  * Attitude controller.
  * Input: 'vehicle_attitude_setpoint' topics (depending on mode)
@@ -699,19 +753,13 @@ MulticopterAttitudeControl::control_attitude(float dt)
  * Output: '_att_control' vector
  */
 void
-MulticopterAttitudeControl::control_attitude_rates(float dt)
+MulticopterAttitudeControl::control_attitude_rates(float dt, const math::Vector<3> &rates)
 {
 	/* reset integral if disarmed */
 	if (!_armed.armed || !_vehicle_status.is_rotary_wing) {
 		_rates_int.zero();
 	}
 
-	/* current body angular rates */
-	math::Vector<3> rates;
-	rates(0) = _v_att.rollspeed;
-	rates(1) = _v_att.pitchspeed;
-	rates(2) = _v_att.yawspeed;
-
 	/* angular rates error */
 	math::Vector<3> rates_err = _rates_sp - rates;
 	_att_control = _params.rate_p.emult(rates_err) + _params.rate_d.emult(_rates_prev - rates) / dt + _rates_int + _params.rate_ff.emult(_rates_sp - _rates_sp_prev) / dt;
@@ -733,6 +781,131 @@ MulticopterAttitudeControl::control_attitude_rates(float dt)
 	}
 }
 
+void
+MulticopterAttitudeControl::run_attitude_loop()
+{
+	float dt = (hrt_absolute_time() - _last_att_run) / 1000000.0f;
+	_last_att_run = hrt_absolute_time();
+
+	/* guard against too small (< 2ms) and too large (> 20ms) dt's */
+	if (dt < 0.002f) {
+		dt = 0.002f;
+
+	} else if (dt > 0.02f) {
+		dt = 0.02f;
+	}
+
+	/* check for updates in other topics */
+	parameter_update_poll();
+	vehicle_control_mode_poll();
+	arming_status_poll();
+	vehicle_manual_poll();
+	vehicle_status_poll();
+	vehicle_motor_limits_poll();
+
+	if (_v_control_mode.flag_control_attitude_enabled) {
+		control_attitude(dt);
+
+		/* publish attitude rates setpoint */
+		_v_rates_sp.roll = _rates_sp(0);
+		_v_rates_sp.pitch = _rates_sp(1);
+		_v_rates_sp.yaw = _rates_sp(2);
+		_v_rates_sp.thrust = _thrust_sp;
+		_v_rates_sp.timestamp = hrt_absolute_time();
+
+		if (_v_rates_sp_pub != nullptr) {
+			orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
+
+		} else if (_rates_sp_id) {
+			_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
+		}
+
+	} else {
+		/* attitude controller disabled, poll rates setpoint topic */
+		if (_v_control_mode.flag_control_manual_enabled) {
+			/* manual rates control - ACRO mode */
+			_rates_sp = math::Vector<3>(_manual_control_sp.y, -_manual_control_sp.x, _manual_control_sp.r).emult(_params.acro_rate_max);
+			_thrust_sp = math::min(_manual_control_sp.z, MANUAL_THROTTLE_MAX_MULTICOPTER);
+
+			/* publish attitude rates setpoint */
+			_v_rates_sp.roll = _rates_sp(0);
+			_v_rates_sp.pitch = _rates_sp(1);
+			_v_rates_sp.yaw = _rates_sp(2);
+			_v_rates_sp.thrust = _thrust_sp;
+			_v_rates_sp.timestamp = hrt_absolute_time();
+
+			if (_v_rates_sp_pub != nullptr) {
+				orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
+
+			} else if (_rates_sp_id) {
+				_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
+			}
+
+		} else {
+			/* attitude controller disabled, poll rates setpoint topic */
+			vehicle_rates_setpoint_poll();
+			_rates_sp(0) = _v_rates_sp.roll;
+			_rates_sp(1) = _v_rates_sp.pitch;
+			_rates_sp(2) = _v_rates_sp.yaw;
+			_thrust_sp = _v_rates_sp.thrust;
+		}
+	}
+}
+
+void
+MulticopterAttitudeControl::run_rates_loop(const math::Vector<3> &rates, uint64_t timestamp_sample)
+{
+	float dt = (hrt_absolute_time() - _last_rate_run) / 1000000.0f;
+	_last_rate_run = hrt_absolute_time();
+
+	/* guard against too small and too large (> 20ms) dt's, gyro samples may come at up to 1 kHz */
+	float dt_min = _params.rate_gyro ? 0.0005f : 0.002f;
+
+	if (dt < dt_min) {
+		dt = dt_min;
+
+	} else if (dt > 0.02f) {
+		dt = 0.02f;
+	}
+
+	if (!_v_control_mode.flag_control_rates_enabled) {
+		return;
+	}
+
+	control_attitude_rates(dt, rates);
+
+	/* publish actuator controls */
+	_actuators.control[0] = (PX4_ISFINITE(_att_control(0))) ? _att_control(0) : 0.0f;
+	_actuators.control[1] = (PX4_ISFINITE(_att_control(1))) ? _att_control(1) : 0.0f;
+	_actuators.control[2] = (PX4_ISFINITE(_att_control(2))) ? _att_control(2) : 0.0f;
+	_actuators.control[3] = (PX4_ISFINITE(_thrust_sp)) ? _thrust_sp : 0.0f;
+	_actuators.timestamp = hrt_absolute_time();
+	_actuators.timestamp_sample = timestamp_sample;
+
+	_controller_status.roll_rate_integ = _rates_int(0);
+	_controller_status.pitch_rate_integ = _rates_int(1);
+	_controller_status.yaw_rate_integ = _rates_int(2);
+	_controller_status.timestamp = hrt_absolute_time();
+
+	if (!_actuators_0_circuit_breaker_enabled) {
+		if (_actuators_0_pub != nullptr) {
+			orb_publish(_actuators_id, _actuators_0_pub, &_actuators);
+			perf_end(_controller_latency_perf);
+
+		} else if (_actuators_id) {
+			_actuators_0_pub = orb_advertise(_actuators_id, &_actuators);
+		}
+
+	}
+
+	/* publish controller status */
+	if(_controller_status_pub != nullptr) {
+		orb_publish(ORB_ID(mc_att_ctrl_status),_controller_status_pub, &_controller_status);
+	} else {
+		_controller_status_pub = orb_advertise(ORB_ID(mc_att_ctrl_status), &_controller_status);
+	}
+}
+
 void
 MulticopterAttitudeControl::task_main_trampoline(int argc, char *argv[])
 {
@@ -755,18 +928,35 @@ MulticopterAttitudeControl::task_main()
 	_armed_sub = orb_subscribe(ORB_ID(actuator_armed));
 	_vehicle_status_sub = orb_subscribe(ORB_ID(vehicle_status));
 	_motor_limits_sub = orb_subscribe(ORB_ID(multirotor_motor_limits));
+	_sensor_combined_sub = orb_subscribe(ORB_ID(sensor_combined));
+	_vtol_status_sub = orb_subscribe(ORB_ID(vtol_vehicle_status));
 
 	/* initialize parameters cache */
 	parameters_update();
 
-	/* wakeup source: vehicle attitude */
+	/*
+	 * wakeup source: vehicle attitude, or the gyro if the rates loop runs
+	 * on gyro samples and the attitude loop on the attitude updates in between.
+	 * A VTOL in fixed wing flight may suspend this controller, then only
+	 * the vtol status is watched for the next transition.
+	 */
 	px4_pollfd_struct_t fds[1];
 
-	fds[0].fd = _v_att_sub;
 	fds[0].events = POLLIN;
 
 	while (!_task_should_exit) {
 
+		vtol_status_poll();
+
+		bool suspended = _vehicle_status.is_vtol && _vtol_status.mc_ctrl_suspended;
+
+		if (suspended) {
+			fds[0].fd = _vtol_status_sub;
+
+		} else {
+			fds[0].fd = _params.rate_gyro ? _sensor_combined_sub : _v_att_sub;
+		}
+
 		/* wait for up to 100ms for data */
 		int pret = px4_poll(&fds[0], (sizeof(fds) / sizeof(fds[0])), 100);
 
@@ -782,114 +972,48 @@ MulticopterAttitudeControl::task_main()
 			continue;
 		}
 
+		/* suspended - the vtol status is copied at the top of the loop */
+		if (suspended) {
+			continue;
+		}
+
 		perf_begin(_loop_perf);
 
-		/* run controller on attitude changes */
 		if (fds[0].revents & POLLIN) {
-			static uint64_t last_run = 0;
-			float dt = (hrt_absolute_time() - last_run) / 1000000.0f;
-			last_run = hrt_absolute_time();
-
-			/* guard against too small (< 2ms) and too large (> 20ms) dt's */
-			if (dt < 0.002f) {
-				dt = 0.002f;
-
-			} else if (dt > 0.02f) {
-				dt = 0.02f;
-			}
+			if (fds[0].fd == _v_att_sub) {
+				/* run both controllers on attitude changes */
+				orb_copy(ORB_ID(vehicle_attitude), _v_att_sub, &_v_att);
+				run_attitude_loop();
 
-			/* copy attitude topic */
-			orb_copy(ORB_ID(vehicle_attitude), _v_att_sub, &_v_att);
+				math::Vector<3> rates(_v_att.rollspeed, _v_att.pitchspeed, _v_att.yawspeed);
+				run_rates_loop(rates, _v_att.timestamp);
 
-			/* check for updates in other topics */
-			parameter_update_poll();
-			vehicle_control_mode_poll();
-			arming_status_poll();
-			vehicle_manual_poll();
-			vehicle_status_poll();
-			vehicle_motor_limits_poll();
-
-			if (_v_control_mode.flag_control_attitude_enabled) {
-				control_attitude(dt);
+			} else {
+				/* run the rates controller on every gyro sample */
+				orb_copy(ORB_ID(sensor_combined), _sensor_combined_sub, &_sensor_combined);
+				math::Vector<3> gyro(_sensor_combined.gyro_rad_s[0], _sensor_combined.gyro_rad_s[1],
+						     _sensor_combined.gyro_rad_s[2]);
 
-				/* publish attitude rates setpoint */
-				_v_rates_sp.roll = _rates_sp(0);
-				_v_rates_sp.pitch = _rates_sp(1);
-				_v_rates_sp.yaw = _rates_sp(2);
-				_v_rates_sp.thrust = _thrust_sp;
-				_v_rates_sp.timestamp = hrt_absolute_time();
+				bool att_updated;
+				orb_check(_v_att_sub, &att_updated);
 
-				if (_v_rates_sp_pub != nullptr) {
-					orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
+				if (att_updated) {
+					orb_copy(ORB_ID(vehicle_attitude), _v_att_sub, &_v_att);
+					run_attitude_loop();
 
-				} else if (_rates_sp_id) {
-					_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
-				}
-
-			} else {
-				/* attitude controller disabled, poll rates setpoint topic */
-				if (_v_control_mode.flag_control_manual_enabled) {
-					/* manual rates control - ACRO mode */
-					_rates_sp = math::Vector<3>(_manual_control_sp.y, -_manual_control_sp.x, _manual_control_sp.r).emult(_params.acro_rate_max);
-					_thrust_sp = math::min(_manual_control_sp.z, MANUAL_THROTTLE_MAX_MULTICOPTER);
-
-					/* publish attitude rates setpoint */
-					_v_rates_sp.roll = _rates_sp(0);
-					_v_rates_sp.pitch = _rates_sp(1);
-					_v_rates_sp.yaw = _rates_sp(2);
-					_v_rates_sp.thrust = _thrust_sp;
-					_v_rates_sp.timestamp = hrt_absolute_time();
-
-					if (_v_rates_sp_pub != nullptr) {
-						orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
-
-					} else if (_rates_sp_id) {
-						_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
-					}
+					/* track the bias the estimator removes from the gyro */
+					math::Vector<3> offset = math::Vector<3>(_v_att.rollspeed, _v_att.pitchspeed, _v_att.yawspeed) - gyro;
 
-				} else {
-					/* attitude controller disabled, poll rates setpoint topic */
-					vehicle_rates_setpoint_poll();
-					_rates_sp(0) = _v_rates_sp.roll;
-					_rates_sp(1) = _v_rates_sp.pitch;
-					_rates_sp(2) = _v_rates_sp.yaw;
-					_thrust_sp = _v_rates_sp.thrust;
-				}
-			}
+					if (_gyro_offset_valid) {
+						_gyro_offset += (offset - _gyro_offset) * GYRO_OFFSET_GAIN;
 
-			if (_v_control_mode.flag_control_rates_enabled) {
-				control_attitude_rates(dt);
-
-				/* publish actuator controls */
-				_actuators.control[0] = (PX4_ISFINITE(_att_control(0))) ? _att_control(0) : 0.0f;
-				_actuators.control[1] = (PX4_ISFINITE(_att_control(1))) ? _att_control(1) : 0.0f;
-				_actuators.control[2] = (PX4_ISFINITE(_att_control(2))) ? _att_control(2) : 0.0f;
-				_actuators.control[3] = (PX4_ISFINITE(_thrust_sp)) ? _thrust_sp : 0.0f;
-				_actuators.timestamp = hrt_absolute_time();
-				_actuators.timestamp_sample = _v_att.timestamp;
-
-				_controller_status.roll_rate_integ = _rates_int(0);
-				_controller_status.pitch_rate_integ = _rates_int(1);
-				_controller_status.yaw_rate_integ = _rates_int(2);
-				_controller_status.timestamp = hrt_absolute_time();
-
-				if (!_actuators_0_circuit_breaker_enabled) {
-					if (_actuators_0_pub != nullptr) {
-						orb_publish(_actuators_id, _actuators_0_pub, &_actuators);
-						perf_end(_controller_latency_perf);
-
-					} else if (_actuators_id) {
-						_actuators_0_pub = orb_advertise(_actuators_id, &_actuators);
+					} else {
+						_gyro_offset = offset;
+						_gyro_offset_valid = true;
 					}
-
 				}
 
-				/* publish controller status */
-				if(_controller_status_pub != nullptr) {
-					orb_publish(ORB_ID(mc_att_ctrl_status),_controller_status_pub, &_controller_status);
-				} else {
-					_controller_status_pub = orb_advertise(ORB_ID(mc_att_ctrl_status), &_controller_status);
-				}
+				run_rates_loop(gyro + _gyro_offset, _sensor_combined.timestamp);
 			}
 		}
 
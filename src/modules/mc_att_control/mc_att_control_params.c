@@ -271,3 +271,17 @@ PARAM_DEFINE_FLOAT(MC_ACRO_P_MAX, 90.0f);
  * @group Multicopter Attitude Control
  */
 PARAM_DEFINE_FLOAT(MC_ACRO_Y_MAX, 120.0f);
+
+/**
+ * Run the rate controller on gyro samples
+ *
+ * If set to 1, the rate controller runs on every sensor_combined gyro
+ * sample, up to the gyro rate, instead of on attitude updates. The attitude
+ * controller keeps running on attitude updates and feeds the rate setpoint
+ * of the faster loop. The gyro bias is taken from the attitude estimate.
+ *
+ * @min 0
+ * @max 1
+ * @group Multicopter Attitude Control
+ */
+PARAM_DEFINE_INT32(MC_RATE_GYRO, 0);
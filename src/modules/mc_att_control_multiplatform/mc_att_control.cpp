@@ -241,6 +241,7 @@ void  MulticopterAttitudeControlMultiplatform::handle_vehicle_attitude(const px4
 		_actuators.data().control[2] = (PX4_ISFINITE(_att_control(2))) ? _att_control(2) : 0.0f;
 		_actuators.data().control[3] = (PX4_ISFINITE(_thrust_sp)) ? _thrust_sp : 0.0f;
 		_actuators.data().timestamp = px4::get_time_micros();
+		_actuators.data().timestamp_sample = _v_att->data().timestamp;
 
 		if (!_actuators_0_circuit_breaker_enabled) {
 			if (_actuators_0_pub != nullptr) {
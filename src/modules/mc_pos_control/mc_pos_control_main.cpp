@@ -207,6 +207,20 @@ private:
 	bool _reset_alt_sp;
 	bool _mode_auto;
 
+	/* setpoint triplet in the local frame and in scaled space, depends only on
+	 * the triplet, the projection reference and the parameters */
+	struct {
+		bool valid;				/**< false if the triplet has to be projected again */
+		bool follow_line;			/**< follow the previous - current line */
+		bool next_valid;			/**< next setpoint usable to pass the current one */
+		math::Vector<3> scale;			/**< scaled space, 1 == position error resulting max allowed speed */
+		math::Vector<3> curr_sp_s;		/**< current setpoint */
+		math::Vector<3> prev_sp_s;		/**< previous setpoint */
+		math::Vector<3> prev_curr_s;		/**< previous to current setpoint */
+		math::Vector<3> prev_curr_s_norm;	/**< normalized previous to current setpoint */
+		math::Vector<3> curr_next_s;		/**< current to next setpoint */
+	} _leg;
+
 	math::Vector<3> _pos;
 	math::Vector<3> _pos_sp;
 	math::Vector<3> _vel;
@@ -269,6 +283,11 @@ private:
 	 */
 	void		control_auto(float dt);
 
+	/**
+	 * Project the setpoint triplet to the local frame and scaled space
+	 */
+	void		update_leg();
+
 	/**
 	 * Select between barometric and global (AMSL) altitudes
 	 */
@@ -339,6 +358,7 @@ MulticopterPositionControl::MulticopterPositionControl() :
 	memset(&_global_vel_sp, 0, sizeof(_global_vel_sp));
 
 	memset(&_ref_pos, 0, sizeof(_ref_pos));
+	_leg.valid = false;
 
 	_params.pos_p.zero();
 	_params.vel_p.zero();
@@ -419,6 +439,9 @@ MulticopterPositionControl::parameters_update(bool force)
 	}
 
 	if (updated || force) {
+		/* the scaled space depends on the gains */
+		_leg.valid = false;
+
 		/* update C++ param system */
 		updateParams();
 
@@ -574,6 +597,7 @@ MulticopterPositionControl::update_ref()
 		}
 
 		_ref_timestamp = _local_pos.ref_timestamp;
+		_leg.valid = false;
 	}
 }
 
@@ -697,6 +721,7 @@ MulticopterPositionControl::control_offboard(float dt)
 
 	if (updated) {
 		orb_copy(ORB_ID(position_setpoint_triplet), _pos_sp_triplet_sub, &_pos_sp_triplet);
+		_leg.valid = false;
 	}
 
 	if (_pos_sp_triplet.current.valid) {
@@ -768,6 +793,54 @@ MulticopterPositionControl::cross_sphere_line(const math::Vector<3>& sphere_c, f
 	}
 }
 
+void MulticopterPositionControl::update_leg()
+{
+	/* project setpoint to local frame */
+	math::Vector<3> curr_sp;
+	map_projection_project_fast(&_ref_pos,
+			       _pos_sp_triplet.current.lat, _pos_sp_triplet.current.lon,
+			       &curr_sp.data[0], &curr_sp.data[1]);
+	curr_sp(2) = -(_pos_sp_triplet.current.alt - _ref_alt);
+
+	/* scaled space: 1 == position error resulting max allowed speed, L1 = 1 in this space */
+	_leg.scale = _params.pos_p.edivide(_params.vel_max);	// TODO add mult param here
+
+	/* convert current setpoint to scaled space */
+	_leg.curr_sp_s = curr_sp.emult(_leg.scale);
+	_leg.follow_line = false;
+	_leg.next_valid = false;
+
+	if (_pos_sp_triplet.current.type == position_setpoint_s::SETPOINT_TYPE_POSITION && _pos_sp_triplet.previous.valid) {
+		math::Vector<3> prev_sp;
+		map_projection_project_fast(&_ref_pos,
+					   _pos_sp_triplet.previous.lat, _pos_sp_triplet.previous.lon,
+					   &prev_sp.data[0], &prev_sp.data[1]);
+		prev_sp(2) = -(_pos_sp_triplet.previous.alt - _ref_alt);
+
+		if ((curr_sp - prev_sp).length() > MIN_DIST) {
+			_leg.follow_line = true;
+			_leg.prev_sp_s = prev_sp.emult(_leg.scale);
+			_leg.prev_curr_s = _leg.curr_sp_s - _leg.prev_sp_s;
+			_leg.prev_curr_s_norm = _leg.prev_curr_s.normalized();
+
+			if (_pos_sp_triplet.next.valid) {
+				math::Vector<3> next_sp;
+				map_projection_project_fast(&_ref_pos,
+							   _pos_sp_triplet.next.lat, _pos_sp_triplet.next.lon,
+							   &next_sp.data[0], &next_sp.data[1]);
+				next_sp(2) = -(_pos_sp_triplet.next.alt - _ref_alt);
+
+				if ((next_sp - curr_sp).length() > MIN_DIST) {
+					_leg.next_valid = true;
+					_leg.curr_next_s = next_sp.emult(_leg.scale) - _leg.curr_sp_s;
+				}
+			}
+		}
+	}
+
+	_leg.valid = true;
+}
+
 void MulticopterPositionControl::control_auto(float dt)
 {
 	if (!_mode_auto) {
@@ -789,6 +862,8 @@ void MulticopterPositionControl::control_auto(float dt)
 			!PX4_ISFINITE(_pos_sp_triplet.current.alt)) {
 			_pos_sp_triplet.current.valid = false;
 		}
+
+		_leg.valid = false;
 	}
 
 	if (_pos_sp_triplet.current.valid) {
@@ -796,96 +871,70 @@ void MulticopterPositionControl::control_auto(float dt)
 		_reset_pos_sp = true;
 		_reset_alt_sp = true;
 
-		/* project setpoint to local frame */
-		math::Vector<3> curr_sp;
-		map_projection_project(&_ref_pos,
-				       _pos_sp_triplet.current.lat, _pos_sp_triplet.current.lon,
-				       &curr_sp.data[0], &curr_sp.data[1]);
-		curr_sp(2) = -(_pos_sp_triplet.current.alt - _ref_alt);
-
-		/* scaled space: 1 == position error resulting max allowed speed, L1 = 1 in this space */
-		math::Vector<3> scale = _params.pos_p.edivide(_params.vel_max);	// TODO add mult param here
+		if (!_leg.valid) {
+			update_leg();
+		}
 
-		/* convert current setpoint to scaled space */
-		math::Vector<3> curr_sp_s = curr_sp.emult(scale);
+		const math::Vector<3> &scale = _leg.scale;
+		const math::Vector<3> &curr_sp_s = _leg.curr_sp_s;
+		const math::Vector<3> &prev_sp_s = _leg.prev_sp_s;
+		const math::Vector<3> &prev_curr_s = _leg.prev_curr_s;
 
 		/* by default use current setpoint as is */
 		math::Vector<3> pos_sp_s = curr_sp_s;
 
-		if (_pos_sp_triplet.current.type == position_setpoint_s::SETPOINT_TYPE_POSITION && _pos_sp_triplet.previous.valid) {
+		if (_leg.follow_line) {
 			/* follow "previous - current" line */
-			math::Vector<3> prev_sp;
-			map_projection_project(&_ref_pos,
-						   _pos_sp_triplet.previous.lat, _pos_sp_triplet.previous.lon,
-						   &prev_sp.data[0], &prev_sp.data[1]);
-			prev_sp(2) = -(_pos_sp_triplet.previous.alt - _ref_alt);
-
-			if ((curr_sp - prev_sp).length() > MIN_DIST) {
-
-				/* find X - cross point of L1 sphere and trajectory */
-				math::Vector<3> pos_s = _pos.emult(scale);
-				math::Vector<3> prev_sp_s = prev_sp.emult(scale);
-				math::Vector<3> prev_curr_s = curr_sp_s - prev_sp_s;
-				math::Vector<3> curr_pos_s = pos_s - curr_sp_s;
-				float curr_pos_s_len = curr_pos_s.length();
-				if (curr_pos_s_len < 1.0f) {
-					/* copter is closer to waypoint than L1 radius */
-					/* check next waypoint and use it to avoid slowing down when passing via waypoint */
-					if (_pos_sp_triplet.next.valid) {
-						math::Vector<3> next_sp;
-						map_projection_project(&_ref_pos,
-									   _pos_sp_triplet.next.lat, _pos_sp_triplet.next.lon,
-									   &next_sp.data[0], &next_sp.data[1]);
-						next_sp(2) = -(_pos_sp_triplet.next.alt - _ref_alt);
-
-						if ((next_sp - curr_sp).length() > MIN_DIST) {
-							math::Vector<3> next_sp_s = next_sp.emult(scale);
-
-							/* calculate angle prev - curr - next */
-							math::Vector<3> curr_next_s = next_sp_s - curr_sp_s;
-							math::Vector<3> prev_curr_s_norm = prev_curr_s.normalized();
-
-							/* cos(a) * curr_next, a = angle between current and next trajectory segments */
-							float cos_a_curr_next = prev_curr_s_norm * curr_next_s;
-
-							/* cos(b), b = angle pos - curr_sp - prev_sp */
-							float cos_b = -curr_pos_s * prev_curr_s_norm / curr_pos_s_len;
-
-							if (cos_a_curr_next > 0.0f && cos_b > 0.0f) {
-								float curr_next_s_len = curr_next_s.length();
-								/* if curr - next distance is larger than L1 radius, limit it */
-								if (curr_next_s_len > 1.0f) {
-									cos_a_curr_next /= curr_next_s_len;
-								}
 
-								/* feed forward position setpoint offset */
-								math::Vector<3> pos_ff = prev_curr_s_norm *
-										cos_a_curr_next * cos_b * cos_b * (1.0f - curr_pos_s_len) *
-										(1.0f - expf(-curr_pos_s_len * curr_pos_s_len * 20.0f));
-								pos_sp_s += pos_ff;
-							}
+			/* find X - cross point of L1 sphere and trajectory */
+			math::Vector<3> pos_s = _pos.emult(scale);
+			math::Vector<3> curr_pos_s = pos_s - curr_sp_s;
+			float curr_pos_s_len = curr_pos_s.length();
+			if (curr_pos_s_len < 1.0f) {
+				/* copter is closer to waypoint than L1 radius */
+				/* check next waypoint and use it to avoid slowing down when passing via waypoint */
+				if (_leg.next_valid) {
+					const math::Vector<3> &prev_curr_s_norm = _leg.prev_curr_s_norm;
+
+					/* cos(a) * curr_next, a = angle between current and next trajectory segments */
+					float cos_a_curr_next = prev_curr_s_norm * _leg.curr_next_s;
+
+					/* cos(b), b = angle pos - curr_sp - prev_sp */
+					float cos_b = -curr_pos_s * prev_curr_s_norm / curr_pos_s_len;
+
+					if (cos_a_curr_next > 0.0f && cos_b > 0.0f) {
+						float curr_next_s_len = _leg.curr_next_s.length();
+						/* if curr - next distance is larger than L1 radius, limit it */
+						if (curr_next_s_len > 1.0f) {
+							cos_a_curr_next /= curr_next_s_len;
 						}
-					}
 
-				} else {
-					bool near = cross_sphere_line(pos_s, 1.0f, prev_sp_s, curr_sp_s, pos_sp_s);
-					if (near) {
-						/* L1 sphere crosses trajectory */
+						/* feed forward position setpoint offset */
+						math::Vector<3> pos_ff = prev_curr_s_norm *
+								cos_a_curr_next * cos_b * cos_b * (1.0f - curr_pos_s_len) *
+								(1.0f - expf(-curr_pos_s_len * curr_pos_s_len * 20.0f));
+						pos_sp_s += pos_ff;
+					}
+				}
 
-					} else {
-						/* copter is too far from trajectory */
-						/* if copter is behind prev waypoint, go directly to prev waypoint */
-						if ((pos_sp_s - prev_sp_s) * prev_curr_s < 0.0f) {
-							pos_sp_s = prev_sp_s;
-						}
+			} else {
+				bool near = cross_sphere_line(pos_s, 1.0f, prev_sp_s, curr_sp_s, pos_sp_s);
+				if (near) {
+					/* L1 sphere crosses trajectory */
 
-						/* if copter is in front of curr waypoint, go directly to curr waypoint */
-						if ((pos_sp_s - curr_sp_s) * prev_curr_s > 0.0f) {
-							pos_sp_s = curr_sp_s;
-						}
+				} else {
+					/* copter is too far from trajectory */
+					/* if copter is behind prev waypoint, go directly to prev waypoint */
+					if ((pos_sp_s - prev_sp_s) * prev_curr_s < 0.0f) {
+						pos_sp_s = prev_sp_s;
+					}
 
-						pos_sp_s = pos_s + (pos_sp_s - pos_s).normalized();
+					/* if copter is in front of curr waypoint, go directly to curr waypoint */
+					if ((pos_sp_s - curr_sp_s) * prev_curr_s > 0.0f) {
+						pos_sp_s = curr_sp_s;
 					}
+
+					pos_sp_s = pos_s + (pos_sp_s - pos_s).normalized();
 				}
 			}
 		}
@@ -108,18 +108,8 @@ int px4muorb_remove_subscriber(const char *name)
 
 int px4muorb_send_topic_data(const char *name, const uint8_t *data, int data_len_in_bytes)
 {
-	int rc = 0;
 	uORB::FastRpcChannel *channel = uORB::FastRpcChannel::GetInstance();
-	uORBCommunicator::IChannelRxHandler *rxHandler = channel->GetRxHandler();
-
-	if (rxHandler != nullptr) {
-		rc = rxHandler->process_received_message(name, data_len_in_bytes, (uint8_t *)data);
-
-	} else {
-		rc = -1;
-	}
-
-	return rc;
+	return channel->receive_message(name, data_len_in_bytes, data);
 }
 
 int px4muorb_is_subscriber_present(const char *topic_name, int *status)
@@ -33,7 +33,7 @@
 #include "uORBFastRpcChannel.hpp"
 #include "px4_log.h"
 #include <algorithm>
-#include <drivers/drv_hrt.h>
+#include <unistd.h>
 
 // static intialization.
 uORB::FastRpcChannel uORB::FastRpcChannel::_Instance;
@@ -64,6 +64,7 @@ uORB::FastRpcChannel::FastRpcChannel()
 		_DataMsgQueue[i]._MaxBufferSize = 0;
 		_DataMsgQueue[i]._Length = 0;
 		_DataMsgQueue[i]._Buffer = 0;
+		_DataMsgQueue[i]._Timestamp = 0;
 	}
 
 	_RemoteSubscribers.clear();
@@ -75,6 +76,17 @@ int16_t uORB::FastRpcChannel::add_subscription(const char *messageName, int32_t
 {
 	int16_t rc = 0;
 	_Subscribers.push_back(messageName);
+
+	// keep the highest rate requested for the topic, 0 being unlimited.
+	std::map<std::string, int32_t>::iterator it = _SubscriberRates.find(messageName);
+
+	if (it == _SubscriberRates.end()) {
+		_SubscriberRates[messageName] = msgRateInHz;
+
+	} else if (it->second != 0 && (msgRateInHz == 0 || msgRateInHz > it->second)) {
+		it->second = msgRateInHz;
+	}
+
 	PX4_DEBUG("Adding message[%s] to subscriber queue...", messageName);
 	return rc;
 }
@@ -85,6 +97,7 @@ int16_t uORB::FastRpcChannel::remove_subscription(const char *messageName)
 {
 	int16_t rc = 0;
 	_Subscribers.remove(messageName);
+	_SubscriberRates.erase(messageName);
 
 	return rc;
 }
@@ -94,7 +107,7 @@ int16_t uORB::FastRpcChannel::is_subscriber_present(const char *messageName, int
 	int16_t rc = 0;
 
 	if (std::find(_Subscribers.begin(), _Subscribers.end(), messageName) != _Subscribers.end()) {
-		*status = 1;
+		*status = 1 + _SubscriberRates[messageName];
 		//PX4_DEBUG("******* Found subscriber for message[%s]....", messageName);
 
 	} else {
@@ -163,12 +176,19 @@ int16_t uORB::FastRpcChannel::send_message(const char *messageName, int32_t leng
 
 	// now check to see if the data queue's buffer size if large enough to memcpy the data.
 	// if not, delete the old buffer and re-create a new buffer of larger size.
-	check_and_expand_data_buffer(_DataQInIndex, length);
+	check_and_expand_data_buffer(_DataQInIndex, DeltaEncoder::max_encoded_size(length));
 
-	// now memcpy the data to the buffer.
-	memcpy(_DataMsgQueue[ _DataQInIndex ]._Buffer, data, length);
-	_DataMsgQueue[ _DataQInIndex ]._Length = length;
+	if (_DataMsgQueue[ _DataQInIndex ]._Buffer == 0) {
+		_QueueMutex.unlock();
+		return -1;
+	}
+
+	// now encode the data into the buffer. an overwritten entry above only
+	// loses that update, the deltas are relative to the topic's last keyframe.
+	_DataMsgQueue[ _DataQInIndex ]._Length =
+		_Encoders[messageName].encode(data, length, _DataMsgQueue[ _DataQInIndex ]._Buffer);
 	_DataMsgQueue[ _DataQInIndex ]._MsgName = messageName;
+	_DataMsgQueue[ _DataQInIndex ]._Timestamp = t1;
 
 	_DataQInIndex++;
 
@@ -204,6 +224,26 @@ int16_t uORB::FastRpcChannel::send_message(const char *messageName, int32_t leng
 	return rc;
 }
 
+//==============================================================================
+//==============================================================================
+int16_t uORB::FastRpcChannel::receive_message(const char *messageName, int32_t length, const uint8_t *data)
+{
+	int16_t rc = -1;
+
+	// the decoded data lives in the decoder until its next update.
+	_DecoderMutex.lock();
+
+	const uint8_t *decoded = nullptr;
+	int32_t decoded_len = _Decoders[messageName].decode(data, length, &decoded);
+
+	if (_RxHandler != nullptr && decoded_len >= 0) {
+		rc = _RxHandler->process_received_message(messageName, decoded_len, (uint8_t *)decoded);
+	}
+
+	_DecoderMutex.unlock();
+	return rc;
+}
+
 //==============================================================================
 //==============================================================================
 void uORB::FastRpcChannel::check_and_expand_data_buffer(int32_t index, int32_t length)
@@ -234,6 +274,17 @@ int32_t uORB::FastRpcChannel::DataQSize()
 	return rc;
 }
 
+int32_t uORB::FastRpcChannel::DataQBytes()
+{
+	int32_t rc = 0;
+
+	for (int32_t i = _DataQOutIndex; i != _DataQInIndex; i = (i + 1) % _MAX_MSG_QUEUE_SIZE) {
+		rc += get_data_msg_size_at(i);
+	}
+
+	return rc;
+}
+
 int32_t uORB::FastRpcChannel::ControlQSize()
 {
 	int32_t rc;
@@ -393,6 +444,7 @@ int16_t uORB::FastRpcChannel::get_bulk_data
 	static hrt_abstime check_time = 0;
 	hrt_abstime t1 = hrt_absolute_time();
 	_DataAvailableSemaphore.wait();
+	wait_for_batch(max_buffer_in_bytes);
 	hrt_abstime t2 = hrt_absolute_time();
 
 	_QueueMutex.lock();
@@ -458,6 +510,12 @@ int16_t uORB::FastRpcChannel::get_bulk_data
 
 	if (topic_count_to_return != *topic_count) {
 		PX4_WARN("Not sending all topics: topics_to_return:[%ld] topics_returning:[%ld]", topic_count_to_return, *topic_count);
+
+		// send_message only posts when the queue was empty, so wake the
+		// next call for the topics left behind.
+		if (rc == 0 && DataQSize() != 0) {
+			_DataAvailableSemaphore.post();
+		}
 	}
 
 	_QueueMutex.unlock();
@@ -485,6 +543,32 @@ int16_t uORB::FastRpcChannel::get_bulk_data
 }
 
 
+void uORB::FastRpcChannel::wait_for_batch(int32_t max_size_in_bytes)
+{
+	// hold the transfer back for topics published shortly after the first one,
+	// bounded by the batch size and the latency of the oldest queued message.
+	int32_t batch_size = (max_size_in_bytes < _BATCH_SIZE_IN_BYTES) ? max_size_in_bytes : _BATCH_SIZE_IN_BYTES;
+
+	while (true) {
+		_QueueMutex.lock();
+		bool send_now = IsDataQEmpty() || IsDataQFull() || DataQBytes() >= batch_size;
+		hrt_abstime age = 0;
+
+		if (!send_now) {
+			age = hrt_elapsed_time(&_DataMsgQueue[ _DataQOutIndex ]._Timestamp);
+			send_now = (age >= _BATCH_LATENCY_IN_US);
+		}
+
+		_QueueMutex.unlock();
+
+		if (send_now) {
+			break;
+		}
+
+		usleep(_BATCH_LATENCY_IN_US - age);
+	}
+}
+
 int32_t uORB::FastRpcChannel::get_data_msg_size_at(int32_t index)
 {
 	// the assumption here is that this is called within the context of semaphore,
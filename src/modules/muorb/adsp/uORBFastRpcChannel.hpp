@@ -37,8 +37,11 @@
 #include <string>
 #include <list>
 #include "uORB/uORBCommunicator.hpp"
+#include "uORB/uORBDelta.hpp"
 #include <semaphore.h>
+#include <drivers/drv_hrt.h>
 #include <set>
+#include <map>
 
 namespace uORB
 {
@@ -126,6 +129,9 @@ public:
 	int16_t get_bulk_data(uint8_t *buffer, int32_t max_size_in_bytes, int32_t *returned_bytes, int32_t *topic_count);
 
 	// function to check if there are subscribers for a topic on adsp.
+	// status is 0 if there are none, otherwise 1 + the max rate in Hz the
+	// subscribers accept (1 meaning no limit), so that krait can rate limit
+	// the topic before it crosses the fastrpc boundary.
 	int16_t is_subscriber_present(const char *messageName, int32_t *status);
 
 	// function to release the blocking semaphore for get_data method.
@@ -136,6 +142,15 @@ public:
 		return _RxHandler;
 	}
 
+	/**
+	 * @brief Decodes a topic update sent by krait and hands it to the rx handler.
+	 *
+	 * @return
+	 *  0 = success, -1 if there is no handler or the update cannot be decoded
+	 *  (e.g. its keyframe was lost).
+	 */
+	int16_t receive_message(const char *messageName, int32_t length, const uint8_t *data);
+
 	void AddRemoteSubscriber(const std::string &messageName)
 	{
 		_RemoteSubscribers.insert(messageName);
@@ -160,11 +175,18 @@ private: // data members
 	static const int32_t _PACKET_HEADER_SIZE =
 		_PACKET_FIELD_TOPIC_NAME_LEN_SIZE_IN_BYTES + _PACKET_FIELD_DATA_LEN_IN_BYTES;
 
+	/// a bulk transfer is held back until this many bytes are queued or
+	/// the oldest queued message is _BATCH_LATENCY_IN_US old, so that high
+	/// rate topics share one FastRPC call instead of one call each.
+	static const int32_t _BATCH_SIZE_IN_BYTES = 2048;
+	static const hrt_abstime _BATCH_LATENCY_IN_US = 1000;
+
 	struct FastRpcDataMsg {
 		int32_t     _MaxBufferSize;
 		int32_t     _Length;
 		uint8_t    *_Buffer;
 		std::string _MsgName;
+		hrt_abstime _Timestamp;
 	};
 
 	struct FastRpcControlMsg {
@@ -187,6 +209,7 @@ private: // data members
 	int32_t _ControlQOutIndex;
 
 	std::list<std::string> _Subscribers;
+	std::map<std::string, int32_t> _SubscriberRates;
 
 	//utility classes
 	class Mutex
@@ -245,6 +268,12 @@ private: // data members
 	Mutex _QueueMutex;
 	Semaphore _DataAvailableSemaphore;
 
+	// the topic data crosses the link delta encoded against the last
+	// keyframe of the topic, see uORBDelta.hpp.
+	std::map<std::string, uORB::DeltaEncoder> _Encoders; // guarded by _QueueMutex
+	std::map<std::string, uORB::DeltaDecoder> _Decoders;
+	Mutex _DecoderMutex;
+
 private://class members.
 	/// constructor.
 	FastRpcChannel();
@@ -256,10 +285,12 @@ private://class members.
 	bool IsDataQFull();
 	bool IsDataQEmpty();
 	int32_t DataQSize();
+	int32_t DataQBytes();
 	int32_t ControlQSize();
 
 	int32_t get_data_msg_size_at(int32_t index);
 	int32_t copy_data_to_buffer(int32_t src_index, uint8_t *dst_buffer, int32_t offset, int32_t dst_buffer_len);
+	void wait_for_batch(int32_t max_size_in_bytes);
 
 	std::set<std::string> _RemoteSubscribers;
 };
@@ -61,8 +61,11 @@ static hrt_abstime   _log_check_interval = 10000000;
 uORB::KraitFastRpcChannel::KraitFastRpcChannel() :
 	_RxHandler(nullptr),
 	_ThreadStarted(false),
-	_ThreadShouldExit(false)
+	_ThreadShouldExit(false),
+	_EncodeBuffer(nullptr),
+	_EncodeBufferSize(0)
 {
+	pthread_mutex_init(&_EncoderMutex, nullptr);
 	_KraitWrapper.Initialize();
 }
 
@@ -115,10 +118,40 @@ int16_t uORB::KraitFastRpcChannel::send_message(const char *messageName, int32_t
 		}
 	}
 
+	if (_AdspSubscriberCache[messageName] > 1) {
+		// the adsp subscribers accept at most (status - 1) Hz, drop the
+		// updates in between instead of sending them across.
+		hrt_abstime interval = 1000000 / (_AdspSubscriberCache[messageName] - 1);
+
+		if (hrt_elapsed_time(&_AdspSubscriberSendTimestamp[messageName]) < interval) {
+			return rc;
+		}
+
+		_AdspSubscriberSendTimestamp[messageName] = t1;
+	}
+
 	if (_AdspSubscriberCache[messageName] > 0) {// there are remote subscribers
+		pthread_mutex_lock(&_EncoderMutex);
+
+		int32_t needed = uORB::DeltaEncoder::max_encoded_size(length);
+
+		if (_EncodeBufferSize < needed) {
+			delete[] _EncodeBuffer;
+			_EncodeBuffer = new uint8_t[needed];
+			_EncodeBufferSize = (_EncodeBuffer != nullptr) ? needed : 0;
+		}
+
+		if (_EncodeBuffer == nullptr) {
+			pthread_mutex_unlock(&_EncoderMutex);
+			return -1;
+		}
+
+		int32_t encoded = _Encoders[messageName].encode(data, length, _EncodeBuffer);
+
 		t2 = hrt_absolute_time();
-		rc = _KraitWrapper.SendData(messageName, length, data);
+		rc = _KraitWrapper.SendData(messageName, encoded, _EncodeBuffer);
 		t3 = hrt_absolute_time();
+		pthread_mutex_unlock(&_EncoderMutex);
 		_snd_msg_count++;
 		//PX4_DEBUG( "***** SENDING[%s] topic to remote....\n", messageName.c_str() );
 
@@ -252,9 +285,12 @@ void uORB::KraitFastRpcChannel::fastrpc_recv_thread()
 
 				uint8_t *topic_data = (uint8_t *)(messageName + strlen(messageName) + 1);
 
-				if (_RxHandler != nullptr) {
+				const uint8_t *decoded = nullptr;
+				int32_t decoded_len = _Decoders[messageName].decode(topic_data, header->_DataLen, &decoded);
+
+				if (_RxHandler != nullptr && decoded_len >= 0) {
 					_RxHandler->process_received_message(messageName,
-									     header->_DataLen, topic_data);
+									     decoded_len, (uint8_t *)decoded);
 					//PX4_DEBUG( "Received topic data for control message for: [%s] len[%d]\n", name, data_length );
 				}
 
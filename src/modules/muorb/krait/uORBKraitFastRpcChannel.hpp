@@ -38,6 +38,7 @@
 #include <string>
 #include <pthread.h>
 #include "uORB/uORBCommunicator.hpp"
+#include "uORB/uORBDelta.hpp"
 #include <px4muorb_KraitRpcWrapper.hpp>
 #include <map>
 #include "drivers/drv_hrt.h"
@@ -138,9 +139,18 @@ private: // data members
 
 	std::map<std::string, int32_t> _AdspSubscriberCache;
 	std::map<std::string, hrt_abstime> _AdspSubscriberSampleTimestamp;
+	std::map<std::string, hrt_abstime> _AdspSubscriberSendTimestamp;
 	//hrt_abstime  _SubCacheSampleTimestamp;
 	static const hrt_abstime _SubCacheRefreshRate = 1000000; // 1 second;
 
+	// the topic data crosses the link delta encoded against the last
+	// keyframe of the topic, see uORBDelta.hpp.
+	pthread_mutex_t _EncoderMutex;
+	std::map<std::string, uORB::DeltaEncoder> _Encoders;
+	uint8_t *_EncodeBuffer;
+	int32_t _EncodeBufferSize;
+	std::map<std::string, uORB::DeltaDecoder> _Decoders; // receive thread only
+
 private://class members.
 	/// constructor.
 	KraitFastRpcChannel();
@@ -0,0 +1,438 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uORBShmChannel.cpp
+ *
+ * uORB channel between two PX4 processes through shared memory.
+ */
+
+#include "uORBShmChannel.hpp"
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <px4_tasks.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __PX4_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define SHM_ORB_MAGIC	0x4f524231	// "ORB1", changes with the segment layout
+
+uORB::ShmChannel uORB::ShmChannel::_Instance;
+
+static void futex_wait(volatile int32_t *word, int32_t value, long timeout_ns)
+{
+#ifdef __PX4_LINUX
+	struct timespec ts = { 0, timeout_ns };
+	syscall(SYS_futex, (int32_t *)word, FUTEX_WAIT, value, &ts, NULL, 0);
+#else
+	/* no futex, poll the doorbell */
+	if (*word == value) {
+		usleep(1000);
+	}
+
+#endif
+}
+
+static void futex_wake(volatile int32_t *word)
+{
+#ifdef __PX4_LINUX
+	syscall(SYS_futex, (int32_t *)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+uORB::ShmChannel::ShmChannel() :
+	_RxHandler(nullptr),
+	_segment(nullptr),
+	_endpoint(0),
+	_ThreadShouldExit(false),
+	_sent(0),
+	_received(0),
+	_dropped(0)
+{
+	_segment_name[0] = '\0';
+	pthread_mutex_init(&_send_mutex, nullptr);
+}
+
+int uORB::ShmChannel::topic_index(const char *messageName, bool create)
+{
+	/* called with _send_mutex held */
+	std::map<std::string, unsigned>::iterator it = _topic_index.find(messageName);
+
+	if (it != _topic_index.end()) {
+		return it->second;
+	}
+
+	if (strlen(messageName) >= MAX_NAME_LEN) {
+		return -ENAMETOOLONG;
+	}
+
+	/* the topic can only have shown up if the peer has added one since the last search */
+	it = _topic_miss.find(messageName);
+
+	if (!create && it != _topic_miss.end() && it->second == _segment->topic_count) {
+		return -ENOENT;
+	}
+
+	while (__sync_lock_test_and_set(&_segment->alloc_lock, 1)) {
+		usleep(10);
+	}
+
+	/* the peer may have added the topic already */
+	unsigned count = _segment->topic_count;
+	int index = -ENOSPC;
+
+	for (unsigned i = 0; i < count; i++) {
+		if (strcmp(_segment->topics[i].name, messageName) == 0) {
+			index = i;
+			break;
+		}
+	}
+
+	if (index < 0 && !create) {
+		index = -ENOENT;
+
+	} else if (index < 0 && count < MAX_TOPICS) {
+		strcpy(_segment->topics[count].name, messageName);
+		__sync_synchronize();
+		_segment->topic_count = count + 1;
+		index = count;
+	}
+
+	__sync_lock_release(&_segment->alloc_lock);
+
+	if (index >= 0) {
+		_topic_index[messageName] = index;
+		_topic_miss.erase(messageName);
+
+	} else {
+		_topic_miss[messageName] = count;
+	}
+
+	return index;
+}
+
+void uORB::ShmChannel::ring(unsigned index)
+{
+	unsigned peer = 1 - _endpoint;
+
+	__sync_fetch_and_or(&_segment->dirty[peer][index / 32], 1u << (index % 32));
+	__sync_fetch_and_add(&_segment->doorbell[peer], 1);
+	futex_wake(&_segment->doorbell[peer]);
+}
+
+int16_t uORB::ShmChannel::set_subscribed(const char *messageName, uint32_t subscribed)
+{
+	if (_segment == nullptr) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&_send_mutex);
+	int index = topic_index(messageName, true);
+
+	if (index >= 0) {
+		_segment->topics[index].subscribed[_endpoint] = subscribed;
+		ring(index);
+	}
+
+	pthread_mutex_unlock(&_send_mutex);
+
+	return (index >= 0) ? 0 : -1;
+}
+
+int16_t uORB::ShmChannel::add_subscription(const char *messageName, int32_t msgRateInHz)
+{
+	return set_subscribed(messageName, 1);
+}
+
+int16_t uORB::ShmChannel::remove_subscription(const char *messageName)
+{
+	return set_subscribed(messageName, 0);
+}
+
+int16_t uORB::ShmChannel::register_handler(uORBCommunicator::IChannelRxHandler *handler)
+{
+	_RxHandler = handler;
+	return 0;
+}
+
+int16_t uORB::ShmChannel::send_message(const char *messageName, int32_t length, uint8_t *data)
+{
+	if (_segment == nullptr || length < 0 || length > (int32_t)MAX_MSG_SIZE) {
+		_dropped++;
+		return -1;
+	}
+
+	pthread_mutex_lock(&_send_mutex);
+
+	/* only topics the peer subscribed to cross, everything else stays local */
+	int index = topic_index(messageName, false);
+
+	if (index < 0 || !_segment->topics[index].subscribed[1 - _endpoint]) {
+		pthread_mutex_unlock(&_send_mutex);
+		return 0;
+	}
+
+	Slot &slot = _segment->topics[index].slot[_endpoint];
+
+	/* sequence lock, the receiver retries when it sees an odd or changed count */
+	slot.seq++;
+	__sync_synchronize();
+	slot.len = length;
+	memcpy(slot.data, data, length);
+	__sync_synchronize();
+	slot.seq++;
+
+	ring(index);
+	_sent++;
+
+	pthread_mutex_unlock(&_send_mutex);
+
+	return 0;
+}
+
+void uORB::ShmChannel::process_topic(unsigned index)
+{
+	Topic &topic = _segment->topics[index];
+	unsigned peer = 1 - _endpoint;
+
+	if (_RxHandler == nullptr) {
+		return;
+	}
+
+	uint32_t subscribed = topic.subscribed[peer];
+
+	if (subscribed != _seen_subscribed[index]) {
+		_seen_subscribed[index] = subscribed;
+
+		if (subscribed) {
+			_RxHandler->process_add_subscription(topic.name, 0);
+
+		} else {
+			_RxHandler->process_remove_subscription(topic.name);
+		}
+	}
+
+	Slot &slot = topic.slot[peer];
+	uint32_t seq;
+	uint32_t len;
+
+	for (;;) {
+		seq = slot.seq;
+
+		if (seq == _seen_seq[index]) {
+			return;
+		}
+
+		if (seq & 1) {
+			/* the writer is in the middle of the copy */
+			sched_yield();
+			continue;
+		}
+
+		__sync_synchronize();
+		len = slot.len;
+
+		if (len > MAX_MSG_SIZE) {
+			len = MAX_MSG_SIZE;
+		}
+
+		memcpy(_rx_buf, slot.data, len);
+		__sync_synchronize();
+
+		if (slot.seq == seq) {
+			break;
+		}
+	}
+
+	_seen_seq[index] = seq;
+	_received++;
+	_RxHandler->process_received_message(topic.name, len, _rx_buf);
+}
+
+void uORB::ShmChannel::recv_thread()
+{
+	volatile uint32_t *dirty = _segment->dirty[_endpoint];
+	volatile int32_t *doorbell = &_segment->doorbell[_endpoint];
+
+	/* pick up the subscriptions and data the peer has published before we started */
+	unsigned count = _segment->topic_count;
+
+	for (unsigned i = 0; i < count; i++) {
+		process_topic(i);
+	}
+
+	while (!_ThreadShouldExit) {
+		int32_t ring_count = *doorbell;
+
+		for (unsigned w = 0; w < MAX_TOPICS / 32; w++) {
+			uint32_t bits = __sync_fetch_and_and(&dirty[w], 0);
+
+			while (bits != 0) {
+				unsigned bit = __builtin_ctz(bits);
+				bits &= bits - 1;
+				process_topic(w * 32 + bit);
+			}
+		}
+
+		/* sleeps only if nothing was rung since ring_count was read */
+		futex_wait(doorbell, ring_count, 100 * 1000 * 1000);
+	}
+}
+
+void *uORB::ShmChannel::thread_start(void *handler)
+{
+	if (handler != nullptr) {
+		((uORB::ShmChannel *)handler)->recv_thread();
+	}
+
+	return 0;
+}
+
+int uORB::ShmChannel::Start(const char *name, unsigned endpoint)
+{
+	if (_segment != nullptr) {
+		PX4_WARN("already started");
+		return -EBUSY;
+	}
+
+	if (endpoint > 1) {
+		return -EINVAL;
+	}
+
+	snprintf(_segment_name, sizeof(_segment_name), "/px4_uorb_%s", name);
+	_endpoint = endpoint;
+
+	/* endpoint 0 starts over, a segment left by a previous run would confuse the sequence counts */
+	if (endpoint == 0) {
+		shm_unlink(_segment_name);
+	}
+
+	int fd = shm_open(_segment_name, O_RDWR | O_CREAT, 0666);
+
+	if (fd < 0) {
+		PX4_ERR("shm_open %s failed: %d", _segment_name, errno);
+		return -errno;
+	}
+
+	struct stat st;
+
+	/* whoever comes first sizes it, the new pages read as zero, which is the empty segment */
+	if (fstat(fd, &st) != 0 || (st.st_size < (off_t)sizeof(Segment) && ftruncate(fd, sizeof(Segment)) != 0)) {
+		PX4_ERR("sizing %s failed: %d", _segment_name, errno);
+		close(fd);
+		return -errno;
+	}
+
+	void *p = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (p == MAP_FAILED) {
+		PX4_ERR("mmap %s failed: %d", _segment_name, errno);
+		return -errno;
+	}
+
+	Segment *segment = (Segment *)p;
+
+	if (!__sync_bool_compare_and_swap(&segment->magic, 0, SHM_ORB_MAGIC) && segment->magic != SHM_ORB_MAGIC) {
+		PX4_ERR("%s has an incompatible layout", _segment_name);
+		munmap(p, sizeof(Segment));
+		return -EINVAL;
+	}
+
+	memset(_seen_seq, 0, sizeof(_seen_seq));
+	memset(_seen_subscribed, 0, sizeof(_seen_subscribed));
+	_topic_index.clear();
+	_topic_miss.clear();
+	_segment = segment;
+	_ThreadShouldExit = false;
+
+	pthread_attr_t recv_thread_attr;
+	pthread_attr_init(&recv_thread_attr);
+
+	struct sched_param param;
+	(void)pthread_attr_getschedparam(&recv_thread_attr, &param);
+	param.sched_priority = SCHED_PRIORITY_MAX - 80;
+	(void)pthread_attr_setschedparam(&recv_thread_attr, &param);
+
+	pthread_attr_setstacksize(&recv_thread_attr, 4096);
+
+	int ret = pthread_create(&_RecvThread, &recv_thread_attr, thread_start, (void *)this);
+	pthread_attr_destroy(&recv_thread_attr);
+
+	if (ret != 0) {
+		PX4_ERR("Error creating the receive thread for muorb_shm");
+		munmap(p, sizeof(Segment));
+		_segment = nullptr;
+		return -ret;
+	}
+
+	return 0;
+}
+
+void uORB::ShmChannel::Stop()
+{
+	if (_segment == nullptr) {
+		return;
+	}
+
+	_ThreadShouldExit = true;
+	__sync_fetch_and_add(&_segment->doorbell[_endpoint], 1);
+	futex_wake(&_segment->doorbell[_endpoint]);
+	pthread_join(_RecvThread, NULL);
+
+	munmap(_segment, sizeof(Segment));
+	_segment = nullptr;
+}
+
+void uORB::ShmChannel::Status()
+{
+	if (_segment == nullptr) {
+		PX4_INFO("not running");
+		return;
+	}
+
+	PX4_INFO("%s endpoint %u: %u topics, %u sent, %u received, %u dropped", _segment_name, _endpoint,
+		 (unsigned)_segment->topic_count, _sent, _received, _dropped);
+}
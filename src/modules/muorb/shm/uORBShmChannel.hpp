@@ -0,0 +1,149 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uORBShmChannel.hpp
+ *
+ * uORB channel between two PX4 processes on the same host, through a
+ * shared memory segment.
+ */
+
+#ifndef _uORBShmChannel_hpp_
+#define _uORBShmChannel_hpp_
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <pthread.h>
+#include "uORB/uORBCommunicator.hpp"
+
+namespace uORB
+{
+class ShmChannel;
+}
+
+/**
+ * Connects the uORB of two processes, endpoint 0 and endpoint 1, through
+ * the segment /px4_uorb_<name>.
+ *
+ * Every topic crossing the channel has an entry in the segment holding
+ * the subscription state of both endpoints and one data slot per sending
+ * endpoint. A topic is published by copying it into the slot under a
+ * sequence lock, marking the entry in the peer's dirty bitmap and waking
+ * the peer's receive thread through a futex. The receiver copies the
+ * dirty entries out and hands them to the uORB manager, so the data is
+ * never serialized.
+ */
+class uORB::ShmChannel : public uORBCommunicator::IChannel
+{
+public:
+	static uORB::ShmChannel *GetInstance()
+	{
+		return &(_Instance);
+	}
+
+	virtual int16_t add_subscription(const char *messageName, int32_t msgRateInHz);
+	virtual int16_t remove_subscription(const char *messageName);
+	virtual int16_t register_handler(uORBCommunicator::IChannelRxHandler *handler);
+	virtual int16_t send_message(const char *messageName, int32_t length, uint8_t *data);
+
+	/**
+	 * Map the segment and start the receive thread.
+	 *
+	 * @param name		Name of the segment, the same in both processes.
+	 * @param endpoint	0 or 1. Endpoint 0 creates a fresh segment, so it
+	 *			has to be started first.
+	 * @return		0 on success, -errno otherwise.
+	 */
+	int Start(const char *name, unsigned endpoint);
+	void Stop();
+	void Status();
+
+	static const unsigned MAX_TOPICS = 256;
+	static const unsigned MAX_NAME_LEN = 64;
+	static const unsigned MAX_MSG_SIZE = 1024;
+
+private:
+	struct Slot {
+		volatile uint32_t seq;		///< odd while the slot is written
+		uint32_t len;
+		uint8_t data[MAX_MSG_SIZE];
+	};
+
+	struct Topic {
+		char name[MAX_NAME_LEN];
+		volatile uint32_t subscribed[2];	///< per endpoint, set while it has subscribers
+		Slot slot[2];				///< written by endpoint 0 and 1
+	};
+
+	struct Segment {
+		volatile uint32_t magic;
+		volatile uint32_t alloc_lock;
+		volatile uint32_t topic_count;
+		volatile int32_t doorbell[2];		///< futex words of the receivers
+		volatile uint32_t dirty[2][MAX_TOPICS / 32];
+		Topic topics[MAX_TOPICS];
+	};
+
+	static uORB::ShmChannel _Instance;
+
+	uORBCommunicator::IChannelRxHandler *_RxHandler;
+	Segment *_segment;
+	char _segment_name[MAX_NAME_LEN];
+	unsigned _endpoint;
+	pthread_t _RecvThread;
+	volatile bool _ThreadShouldExit;
+	pthread_mutex_t _send_mutex;	///< one writer per slot, and the topic index
+
+	std::map<std::string, unsigned> _topic_index;
+	std::map<std::string, unsigned> _topic_miss;	///< topic_count when a topic was last not found
+	uint32_t _seen_seq[MAX_TOPICS];
+	uint32_t _seen_subscribed[MAX_TOPICS];
+	uint8_t _rx_buf[MAX_MSG_SIZE];
+
+	unsigned _sent;
+	unsigned _received;
+	unsigned _dropped;
+
+	ShmChannel();
+
+	int topic_index(const char *messageName, bool create);
+	int16_t set_subscribed(const char *messageName, uint32_t subscribed);
+	void ring(unsigned index);
+
+	static void *thread_start(void *handler);
+	void recv_thread();
+	void process_topic(unsigned index);
+};
+
+#endif /* _uORBShmChannel_hpp_ */
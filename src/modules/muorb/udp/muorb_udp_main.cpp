@@ -0,0 +1,122 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file muorb_udp_main.cpp
+ *
+ * Bridges uORB topics to a companion computer over UDP.
+ */
+
+#include <px4_config.h>
+#include <px4_getopt.h>
+#include <px4_log.h>
+#include <stdlib.h>
+#include <string.h>
+#include "uORBManager.hpp"
+#include "uORBUdpChannel.hpp"
+
+extern "C" { __EXPORT int muorb_udp_main(int argc, char *argv[]); }
+
+static void usage()
+{
+	warnx("Usage: muorb_udp 'start [-p <local port>] [-r <remote ip> -o <remote port>] [-b <batch ms>] [-d]', 'stop', 'status'");
+	warnx("Without -r the first host sending to the local port becomes the peer, whoever it is;");
+	warnx("datagrams from any other address or port are dropped.");
+}
+
+int
+muorb_udp_main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		usage();
+		return -EINVAL;
+	}
+
+	if (!strcmp(argv[1], "start")) {
+		uint16_t local_port = 14600;
+		const char *remote = nullptr;
+		uint16_t remote_port = 14601;
+		unsigned batch_ms = 5;
+		bool delta = false;
+
+		int myoptind = 1;
+		int ch;
+		const char *myoptarg = nullptr;
+
+		while ((ch = px4_getopt(argc, argv, "p:r:o:b:d", &myoptind, &myoptarg)) != EOF) {
+			switch (ch) {
+			case 'p':
+				local_port = strtoul(myoptarg, nullptr, 10);
+				break;
+
+			case 'r':
+				remote = myoptarg;
+				break;
+
+			case 'o':
+				remote_port = strtoul(myoptarg, nullptr, 10);
+				break;
+
+			case 'b':
+				batch_ms = strtoul(myoptarg, nullptr, 10);
+				break;
+
+			case 'd':
+				delta = true;
+				break;
+
+			default:
+				usage();
+				return -EINVAL;
+			}
+		}
+
+		// register the UDP channel with uORB before anything can arrive.
+		uORB::Manager::get_instance()->set_uorb_communicator(uORB::UdpChannel::GetInstance());
+
+		return uORB::UdpChannel::GetInstance()->Start(local_port, remote, remote_port, batch_ms, delta);
+	}
+
+	if (!strcmp(argv[1], "stop")) {
+		uORB::UdpChannel::GetInstance()->Stop();
+		return OK;
+	}
+
+	if (!strcmp(argv[1], "status")) {
+		uORB::UdpChannel::GetInstance()->Status();
+		return OK;
+	}
+
+	usage();
+	return -EINVAL;
+}
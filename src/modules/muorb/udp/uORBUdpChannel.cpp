@@ -0,0 +1,556 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uORBUdpChannel.cpp
+ *
+ * uORB channel to a companion computer over UDP.
+ */
+
+#include "uORBUdpChannel.hpp"
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <px4_tasks.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+uORB::UdpChannel uORB::UdpChannel::_Instance;
+
+static void put_uint16(uint8_t *p, uint16_t v)
+{
+	p[0] = v & 0xff;
+	p[1] = v >> 8;
+}
+
+static uint16_t get_uint16(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static void put_rate(uint8_t *p, int32_t rate)
+{
+	put_uint16(&p[0], rate & 0xffff);
+	put_uint16(&p[2], (uint32_t)rate >> 16);
+}
+
+/* topic names are generated from the msg file names */
+static bool valid_topic_name(const char *name)
+{
+	if (*name == '\0') {
+		return false;
+	}
+
+	for (const char *c = name; *c != '\0'; c++) {
+		if (!((*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9') || *c == '_')) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uORB::UdpChannel::UdpChannel() :
+	_RxHandler(nullptr),
+	_fd(-1),
+	_remote_known(false),
+	_batch_interval(0),
+	_delta(false),
+	_ThreadShouldExit(false),
+	_batch_len(HEADER_LEN),
+	_batch_records(0),
+	_batch_start(0),
+	_topic_bytes(0),
+	_encoded_bytes(0),
+	_datagrams_sent(0),
+	_records_sent(0),
+	_records_merged(0),
+	_records_received(0),
+	_dropped(0)
+{
+	memset(&_remote_addr, 0, sizeof(_remote_addr));
+	pthread_mutex_init(&_mutex, nullptr);
+}
+
+void uORB::UdpChannel::flush()
+{
+	/* called with _mutex held */
+	if (_batch_records == 0) {
+		return;
+	}
+
+	_batch[0] = MAGIC;
+	_batch[1] = VERSION;
+	put_uint16(&_batch[2], _batch_records);
+
+	if (_remote_known) {
+		if (sendto(_fd, _batch, _batch_len, 0, (struct sockaddr *)&_remote_addr, sizeof(_remote_addr)) == (ssize_t)_batch_len) {
+			_datagrams_sent++;
+			_records_sent += _batch_records;
+
+		} else {
+			_dropped += _batch_records;
+		}
+	}
+
+	_batch_len = HEADER_LEN;
+	_batch_records = 0;
+	_batch_offsets.clear();
+}
+
+int16_t uORB::UdpChannel::append(uint8_t type, const char *messageName, int32_t length, const uint8_t *data)
+{
+	/* called with _mutex held */
+	size_t name_len = strlen(messageName);
+	unsigned record_len = RECORD_HEADER_LEN + name_len + length;
+
+	if (name_len > 255 || length < 0 || HEADER_LEN + record_len > MAX_DATAGRAM) {
+		_dropped++;
+		return -1;
+	}
+
+	if (_batch_len + record_len > MAX_DATAGRAM) {
+		flush();
+	}
+
+	if (_batch_records == 0) {
+		_batch_start = hrt_absolute_time();
+	}
+
+	uint8_t *p = &_batch[_batch_len];
+	p[0] = type;
+	p[1] = name_len;
+	put_uint16(&p[2], length);
+	memcpy(&p[RECORD_HEADER_LEN], messageName, name_len);
+	memcpy(&p[RECORD_HEADER_LEN + name_len], data, length);
+
+	if (type == RECORD_DATA) {
+		_batch_offsets[messageName] = _batch_len + RECORD_HEADER_LEN + name_len;
+	}
+
+	_batch_len += record_len;
+	_batch_records++;
+
+	return 0;
+}
+
+int16_t uORB::UdpChannel::add_subscription(const char *messageName, int32_t msgRateInHz)
+{
+	uint8_t rate[4];
+	put_rate(rate, msgRateInHz);
+
+	/* control records go out right away */
+	pthread_mutex_lock(&_mutex);
+	_local_subscriptions[messageName] = msgRateInHz;
+	int16_t ret = append(RECORD_ADD_SUBSCRIPTION, messageName, sizeof(rate), rate);
+	flush();
+	pthread_mutex_unlock(&_mutex);
+
+	return ret;
+}
+
+int16_t uORB::UdpChannel::remove_subscription(const char *messageName)
+{
+	pthread_mutex_lock(&_mutex);
+	_local_subscriptions.erase(messageName);
+	int16_t ret = append(RECORD_REMOVE_SUBSCRIPTION, messageName, 0, nullptr);
+	flush();
+	pthread_mutex_unlock(&_mutex);
+
+	return ret;
+}
+
+int16_t uORB::UdpChannel::register_handler(uORBCommunicator::IChannelRxHandler *handler)
+{
+	_RxHandler = handler;
+	return 0;
+}
+
+int16_t uORB::UdpChannel::send_message(const char *messageName, int32_t length, uint8_t *data)
+{
+	int16_t ret = 0;
+
+	if (_fd < 0) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&_mutex);
+
+	/* only what the peer subscribed to is sent, at most at the rate it asked for */
+	std::map<std::string, RemoteSubscription>::iterator sub = _remote_subscriptions.find(messageName);
+
+	if (sub == _remote_subscriptions.end()) {
+		pthread_mutex_unlock(&_mutex);
+		return 0;
+	}
+
+	hrt_abstime now = hrt_absolute_time();
+
+	if (sub->second.interval != 0 && sub->second.last_sent != 0 &&
+	    now - sub->second.last_sent < sub->second.interval) {
+		pthread_mutex_unlock(&_mutex);
+		return 0;
+	}
+
+	sub->second.last_sent = now;
+
+	if (_delta) {
+		if (uORB::DeltaEncoder::max_encoded_size(length) > (int32_t)sizeof(_encoded)) {
+			_dropped++;
+			pthread_mutex_unlock(&_mutex);
+			return -1;
+		}
+
+		int32_t encoded_len = _encoders[messageName].encode(data, length, _encoded);
+
+		if (encoded_len < 0) {
+			_dropped++;
+			ret = -1;
+
+		} else {
+			_topic_bytes += length;
+			_encoded_bytes += encoded_len;
+			ret = append(RECORD_DELTA, messageName, encoded_len, _encoded);
+		}
+
+		if (now - _batch_start >= _batch_interval) {
+			flush();
+		}
+
+		pthread_mutex_unlock(&_mutex);
+		return ret;
+	}
+
+	/* a topic already waiting in the batch is updated in place */
+	std::map<std::string, unsigned>::iterator pending = _batch_offsets.find(messageName);
+
+	if (pending != _batch_offsets.end() && get_uint16(&_batch[pending->second - strlen(messageName) - 2]) == length) {
+		memcpy(&_batch[pending->second], data, length);
+		_records_merged++;
+
+	} else {
+		ret = append(RECORD_DATA, messageName, length, data);
+	}
+
+	if (now - _batch_start >= _batch_interval) {
+		flush();
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return ret;
+}
+
+void uORB::UdpChannel::process_datagram(const uint8_t *buf, int len)
+{
+	if (len < (int)HEADER_LEN || buf[0] != MAGIC || buf[1] != VERSION) {
+		_dropped++;
+		return;
+	}
+
+	unsigned records = get_uint16(&buf[2]);
+	int offset = HEADER_LEN;
+	char name[256];
+
+	for (unsigned i = 0; i < records && offset + (int)RECORD_HEADER_LEN <= len; i++) {
+		const uint8_t *p = &buf[offset];
+		uint8_t type = p[0];
+		unsigned name_len = p[1];
+		unsigned data_len = get_uint16(&p[2]);
+
+		if (offset + (int)(RECORD_HEADER_LEN + name_len + data_len) > len) {
+			_dropped++;
+			break;
+		}
+
+		memcpy(name, &p[RECORD_HEADER_LEN], name_len);
+		name[name_len] = '\0';
+		uint8_t *data = (uint8_t *)&p[RECORD_HEADER_LEN + name_len];
+		offset += RECORD_HEADER_LEN + name_len + data_len;
+		_records_received++;
+
+		if (!valid_topic_name(name)) {
+			_dropped++;
+			continue;
+		}
+
+		if (type == RECORD_ADD_SUBSCRIPTION && data_len == 4) {
+			int32_t rate = get_uint16(&data[0]) | (get_uint16(&data[2]) << 16);
+
+			pthread_mutex_lock(&_mutex);
+			std::map<std::string, RemoteSubscription>::iterator sub = _remote_subscriptions.find(name);
+
+			/* the peer cannot make the table grow beyond the topics a build has */
+			if (sub == _remote_subscriptions.end() && _remote_subscriptions.size() >= MAX_TOPICS) {
+				_dropped++;
+				pthread_mutex_unlock(&_mutex);
+				continue;
+			}
+
+			RemoteSubscription &entry = _remote_subscriptions[name];
+			entry.interval = (rate > 0) ? 1000000 / rate : 0;
+			entry.last_sent = 0;
+			pthread_mutex_unlock(&_mutex);
+
+			if (_RxHandler != nullptr) {
+				_RxHandler->process_add_subscription(name, rate);
+			}
+
+		} else if (type == RECORD_REMOVE_SUBSCRIPTION) {
+			pthread_mutex_lock(&_mutex);
+			_remote_subscriptions.erase(name);
+			pthread_mutex_unlock(&_mutex);
+
+			if (_RxHandler != nullptr) {
+				_RxHandler->process_remove_subscription(name);
+			}
+
+		} else if (type == RECORD_DATA) {
+			if (_RxHandler != nullptr) {
+				_RxHandler->process_received_message(name, data_len, data);
+			}
+
+		} else if (type == RECORD_DELTA) {
+			if (_decoders.find(name) == _decoders.end() && _decoders.size() >= MAX_TOPICS) {
+				_dropped++;
+				continue;
+			}
+
+			const uint8_t *topic;
+			int32_t topic_len = _decoders[name].decode(data, data_len, &topic);
+
+			if (topic_len < 0) {
+				/* malformed, or waiting for the keyframe */
+				_dropped++;
+
+			} else if (_RxHandler != nullptr) {
+				_RxHandler->process_received_message(name, topic_len, (uint8_t *)topic);
+			}
+
+		} else {
+			_dropped++;
+		}
+	}
+}
+
+void uORB::UdpChannel::recv_thread()
+{
+	uint8_t buf[MAX_DATAGRAM];
+	struct pollfd fds[1];
+	fds[0].fd = _fd;
+	fds[0].events = POLLIN;
+
+	/* wake up at least once per batch interval to send what is pending */
+	int timeout = (_batch_interval + 999) / 1000;
+
+	while (!_ThreadShouldExit) {
+		int pret = ::poll(&fds[0], 1, timeout);
+
+		if (pret > 0 && (fds[0].revents & POLLIN)) {
+			struct sockaddr_in src;
+			socklen_t src_len = sizeof(src);
+			int len = recvfrom(_fd, buf, sizeof(buf), 0, (struct sockaddr *)&src, &src_len);
+
+			if (len > 0) {
+				if (_remote_known && (src.sin_addr.s_addr != _remote_addr.sin_addr.s_addr ||
+						      src.sin_port != _remote_addr.sin_port)) {
+					/* only the peer may subscribe or publish */
+					_dropped++;
+					continue;
+				}
+
+				if (!_remote_known) {
+					pthread_mutex_lock(&_mutex);
+					_remote_addr = src;
+					_remote_known = true;
+
+					/* tell the new peer what we subscribed to while waiting for it */
+					for (std::map<std::string, int32_t>::iterator it = _local_subscriptions.begin();
+					     it != _local_subscriptions.end(); ++it) {
+						uint8_t rate[4];
+						put_rate(rate, it->second);
+						append(RECORD_ADD_SUBSCRIPTION, it->first.c_str(), sizeof(rate), rate);
+					}
+
+					flush();
+					pthread_mutex_unlock(&_mutex);
+					PX4_INFO("muorb_udp peer %s:%u", inet_ntoa(src.sin_addr), ntohs(src.sin_port));
+				}
+
+				process_datagram(buf, len);
+			}
+		}
+
+		pthread_mutex_lock(&_mutex);
+
+		if (_batch_records > 0 && hrt_elapsed_time(&_batch_start) >= _batch_interval) {
+			flush();
+		}
+
+		pthread_mutex_unlock(&_mutex);
+	}
+}
+
+void *uORB::UdpChannel::thread_start(void *handler)
+{
+	if (handler != nullptr) {
+		((uORB::UdpChannel *)handler)->recv_thread();
+	}
+
+	return 0;
+}
+
+int uORB::UdpChannel::Start(uint16_t local_port, const char *remote, uint16_t remote_port, unsigned batch_ms,
+			    bool delta)
+{
+	if (_fd >= 0) {
+		PX4_WARN("already started");
+		return -EBUSY;
+	}
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(local_port);
+
+	_remote_known = false;
+
+	if (remote != nullptr) {
+		memset(&_remote_addr, 0, sizeof(_remote_addr));
+		_remote_addr.sin_family = AF_INET;
+		_remote_addr.sin_port = htons(remote_port);
+
+		if (inet_aton(remote, &_remote_addr.sin_addr) == 0) {
+			PX4_ERR("invalid address %s", remote);
+			return -EINVAL;
+		}
+
+		_remote_known = true;
+	}
+
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if (fd < 0) {
+		PX4_ERR("create socket failed: %d", errno);
+		return -errno;
+	}
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		PX4_ERR("bind to port %u failed: %d", local_port, errno);
+		close(fd);
+		return -errno;
+	}
+
+	_batch_interval = ((batch_ms > 0) ? batch_ms : 1) * 1000;
+	_batch_len = HEADER_LEN;
+	_batch_records = 0;
+	_batch_offsets.clear();
+	_remote_subscriptions.clear();
+	_delta = delta;
+	_encoders.clear();
+	_decoders.clear();
+	_ThreadShouldExit = false;
+	_fd = fd;
+
+	pthread_attr_t recv_thread_attr;
+	pthread_attr_init(&recv_thread_attr);
+
+	struct sched_param param;
+	(void)pthread_attr_getschedparam(&recv_thread_attr, &param);
+	param.sched_priority = SCHED_PRIORITY_MAX - 80;
+	(void)pthread_attr_setschedparam(&recv_thread_attr, &param);
+
+	pthread_attr_setstacksize(&recv_thread_attr, 4096);
+
+	int ret = pthread_create(&_RecvThread, &recv_thread_attr, thread_start, (void *)this);
+	pthread_attr_destroy(&recv_thread_attr);
+
+	if (ret != 0) {
+		PX4_ERR("Error creating the receive thread for muorb_udp");
+		close(fd);
+		_fd = -1;
+		return -ret;
+	}
+
+	return 0;
+}
+
+void uORB::UdpChannel::Stop()
+{
+	if (_fd < 0) {
+		return;
+	}
+
+	_ThreadShouldExit = true;
+	pthread_join(_RecvThread, NULL);
+
+	pthread_mutex_lock(&_mutex);
+	close(_fd);
+	_fd = -1;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void uORB::UdpChannel::Status()
+{
+	if (_fd < 0) {
+		PX4_INFO("not running");
+		return;
+	}
+
+	pthread_mutex_lock(&_mutex);
+
+	if (_remote_known) {
+		PX4_INFO("peer %s:%u", inet_ntoa(_remote_addr.sin_addr), ntohs(_remote_addr.sin_port));
+
+	} else {
+		PX4_INFO("waiting for a peer");
+	}
+
+	PX4_INFO("%u topics subscribed by the peer, batch interval %u ms", (unsigned)_remote_subscriptions.size(),
+		 (unsigned)(_batch_interval / 1000));
+	PX4_INFO("%u datagrams with %u records sent, %u merged, %u received, %u dropped",
+		 _datagrams_sent, _records_sent, _records_merged, _records_received, _dropped);
+
+	if (_delta && _topic_bytes > 0) {
+		PX4_INFO("delta encoding sent %u bytes for %u bytes of topic updates (%u%%)",
+			 _encoded_bytes, _topic_bytes, (unsigned)(100ull * _encoded_bytes / _topic_bytes));
+	}
+
+	pthread_mutex_unlock(&_mutex);
+}
@@ -0,0 +1,173 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uORBUdpChannel.hpp
+ *
+ * uORB channel to a companion computer over UDP.
+ */
+
+#ifndef _uORBUdpChannel_hpp_
+#define _uORBUdpChannel_hpp_
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <pthread.h>
+#include <netinet/in.h>
+#include "uORB/uORBCommunicator.hpp"
+#include "uORB/uORBDelta.hpp"
+#include "drivers/drv_hrt.h"
+
+namespace uORB
+{
+class UdpChannel;
+}
+
+/**
+ * Exchanges uORB subscriptions and topic data with a peer over UDP.
+ *
+ * A datagram carries a header followed by any number of records:
+ *
+ *   header: uint8 magic 'U', uint8 version, uint16 record count
+ *   record: uint8 type, uint8 name length, uint16 data length, name, data
+ *
+ * with the add subscription record carrying the requested rate as its
+ * int32 data and the data record the raw topic struct, o_size bytes long.
+ * The delta record carries a uORB::DeltaEncoder message instead, which only
+ * holds the bytes that changed since the last keyframe of the topic.
+ * All fields are little endian.
+ *
+ * Updates are collected in a batch that is sent when it is full or has
+ * been pending for the batch interval, and a topic updated twice within
+ * a batch is only sent once with its latest value (unless delta encoded,
+ * as a delta must not replace the keyframe before it). The rate a peer
+ * asked for in its add subscription is honored by dropping updates in
+ * between.
+ */
+class uORB::UdpChannel : public uORBCommunicator::IChannel
+{
+public:
+	static uORB::UdpChannel *GetInstance()
+	{
+		return &(_Instance);
+	}
+
+	virtual int16_t add_subscription(const char *messageName, int32_t msgRateInHz);
+	virtual int16_t remove_subscription(const char *messageName);
+	virtual int16_t register_handler(uORBCommunicator::IChannelRxHandler *handler);
+	virtual int16_t send_message(const char *messageName, int32_t length, uint8_t *data);
+
+	/**
+	 * Open the socket and start the receive thread.
+	 *
+	 * @param local_port	UDP port to listen on.
+	 * @param remote	Peer address, or nullptr to take whoever sends
+	 *			to local_port first as the peer. Datagrams from
+	 *			other senders are dropped.
+	 * @param remote_port	UDP port of the peer.
+	 * @param batch_ms	Longest time an update may wait for a batch.
+	 * @param delta		Send delta records instead of data records. Delta
+	 *			records are always accepted from the peer.
+	 * @return		0 on success, -errno otherwise.
+	 */
+	int Start(uint16_t local_port, const char *remote, uint16_t remote_port, unsigned batch_ms, bool delta);
+	void Stop();
+	void Status();
+
+	static const uint8_t MAGIC = 'U';
+	static const uint8_t VERSION = 1;
+
+	enum RecordType {
+		RECORD_ADD_SUBSCRIPTION = 1,
+		RECORD_REMOVE_SUBSCRIPTION = 2,
+		RECORD_DATA = 3,
+		RECORD_DELTA = 4
+	};
+
+private:
+	static const unsigned MAX_DATAGRAM = 1472;	///< fits an Ethernet MTU
+	static const unsigned HEADER_LEN = 4;
+	static const unsigned RECORD_HEADER_LEN = 4;
+	static const unsigned MAX_TOPICS = 128;		///< per topic state kept for the peer, above the topic count of a build
+
+	struct RemoteSubscription {
+		hrt_abstime interval;	///< 0 sends every update
+		hrt_abstime last_sent;
+	};
+
+	static uORB::UdpChannel _Instance;
+
+	uORBCommunicator::IChannelRxHandler *_RxHandler;
+	int _fd;
+	struct sockaddr_in _remote_addr;
+	bool _remote_known;
+	hrt_abstime _batch_interval;
+	bool _delta;
+
+	pthread_t _RecvThread;
+	volatile bool _ThreadShouldExit;
+	pthread_mutex_t _mutex;		///< guards the batch and the subscriptions
+
+	std::map<std::string, RemoteSubscription> _remote_subscriptions;
+	std::map<std::string, int32_t> _local_subscriptions;	///< requested rate of our subscriptions
+
+	uint8_t _batch[MAX_DATAGRAM];
+	unsigned _batch_len;
+	unsigned _batch_records;
+	hrt_abstime _batch_start;
+	std::map<std::string, unsigned> _batch_offsets;	///< data offset of the topics in the batch
+
+	std::map<std::string, uORB::DeltaEncoder> _encoders;	///< guarded by _mutex
+	std::map<std::string, uORB::DeltaDecoder> _decoders;	///< only used by the receive thread
+	uint8_t _encoded[MAX_DATAGRAM];
+	unsigned _topic_bytes;		///< size of the topic updates delta encoded
+	unsigned _encoded_bytes;	///< size of their encoding
+
+	unsigned _datagrams_sent;
+	unsigned _records_sent;
+	unsigned _records_merged;
+	unsigned _records_received;
+	unsigned _dropped;
+
+	UdpChannel();
+
+	int16_t append(uint8_t type, const char *messageName, int32_t length, const uint8_t *data);
+	void flush();
+
+	static void *thread_start(void *handler);
+	void recv_thread();
+	void process_datagram(const uint8_t *buf, int len);
+};
+
+#endif /* _uORBUdpChannel_hpp_ */
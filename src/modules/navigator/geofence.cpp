@@ -77,6 +77,12 @@ Geofence::Geofence() :
 	_altitude_min(0),
 	_altitude_max(0),
 	_verticesCount(0),
+	_vertices{},
+	_projection_ref{},
+	_edges{},
+	_polygons{},
+	_polygonCount(0),
+	_polygon_loaded(false),
 	_param_geofence_mode(this, "MODE"),
 	_param_altitude_mode(this, "ALTMODE"),
 	_param_source(this, "SOURCE"),
@@ -213,31 +219,38 @@ bool Geofence::inside_polygon(double lat, double lon, float altitude)
 			 * PNPOLY - Point Inclusion in Polygon Test
 			 * W. Randolph Franklin (WRF) */
 
-			bool c = false;
+			if (!_polygon_loaded) {
+				return false;
+			}
 
-			struct fence_vertex_s temp_vertex_i;
-			struct fence_vertex_s temp_vertex_j;
+			float x;
+			float y;
+			map_projection_project(&_projection_ref, lat, lon, &x, &y);
 
-			/* Red until fence is finished */
-			for (unsigned i = 0, j = _verticesCount - 1; i < _verticesCount; j = i++) {
-				if (dm_read(DM_KEY_FENCE_POINTS, i, &temp_vertex_i, sizeof(struct fence_vertex_s)) != sizeof(struct fence_vertex_s)) {
-					break;
-				}
+			/* without inclusion polygons everything outside the exclusion polygons is allowed */
+			bool included = true;
 
-				if (dm_read(DM_KEY_FENCE_POINTS, j, &temp_vertex_j, sizeof(struct fence_vertex_s)) != sizeof(struct fence_vertex_s)) {
+			for (unsigned p = 0; p < _polygonCount; p++) {
+				if (_polygons[p].type == fence_s::POLYGON_INCLUSION) {
+					included = false;
 					break;
 				}
+			}
 
-				// skip vertex 0 (return point)
-				if (((double)temp_vertex_i.lon >= lon) != ((double)temp_vertex_j.lon >= lon) &&
-				    (lat <= (double)(temp_vertex_j.lat - temp_vertex_i.lat) * (lon - (double)temp_vertex_i.lon) /
-				     (double)(temp_vertex_j.lon - temp_vertex_i.lon) + (double)temp_vertex_i.lat)) {
-					c = !c;
-				}
+			for (unsigned p = 0; p < _polygonCount; p++) {
+				const FencePolygon &polygon = _polygons[p];
 
+				if (polygon.type == fence_s::POLYGON_EXCLUSION) {
+					if (insidePolygon(polygon, x, y)) {
+						return false;
+					}
+
+				} else if (!included && insidePolygon(polygon, x, y)) {
+					included = true;
+				}
 			}
 
-			return c;
+			return included;
 
 		} else {
 			/* Empty fence --> accept all points */
@@ -250,6 +263,124 @@ bool Geofence::inside_polygon(double lat, double lon, float altitude)
 	}
 }
 
+bool
+Geofence::insidePolygon(const FencePolygon &polygon, float x, float y)
+{
+	/* points outside the bounding box are outside the polygon */
+	if (x < polygon.min_x || x > polygon.max_x || y < polygon.min_y || y > polygon.max_y) {
+		return false;
+	}
+
+	unsigned row = (polygon.row_width > 0.0f) ? (unsigned)((y - polygon.min_y) / polygon.row_width) : 0;
+
+	if (row >= GRID_ROWS) {
+		row = GRID_ROWS - 1;
+	}
+
+	bool c = false;
+
+	/* count the crossings of the edges spanning the row of the point only */
+	for (unsigned i = polygon.first; i < (unsigned)polygon.first + polygon.count; i++) {
+		const FenceEdge &edge = _edges[i];
+
+		if ((polygon.row_edges[row] & (1u << i)) &&
+		    ((edge.y0 >= y) != (edge.y1 >= y)) &&
+		    (x <= edge.slope * (y - edge.y0) + edge.x0)) {
+			c = !c;
+		}
+	}
+
+	return c;
+}
+
+void
+Geofence::updatePolygon()
+{
+	_polygon_loaded = false;
+
+	if (_verticesCount == 0 || _verticesCount > fence_s::GEOFENCE_MAX_VERTICES) {
+		return;
+	}
+
+	if (dm_read_many(DM_KEY_FENCE_POINTS, 0, _verticesCount, _vertices, sizeof(struct fence_vertex_s)) != (ssize_t)_verticesCount) {
+		return;
+	}
+
+	/* vertices without a polygon layout form a single inclusion polygon */
+	if (_polygonCount == 0) {
+		_polygons[0].type = fence_s::POLYGON_INCLUSION;
+		_polygons[0].first = 0;
+		_polygons[0].count = _verticesCount;
+		_polygonCount = 1;
+	}
+
+	/* project all polygons around the center of their vertices */
+	double lat_0 = 0.0;
+	double lon_0 = 0.0;
+
+	for (unsigned i = 0; i < _verticesCount; i++) {
+		lat_0 += (double)_vertices[i].lat / _verticesCount;
+		lon_0 += (double)_vertices[i].lon / _verticesCount;
+	}
+
+	map_projection_init(&_projection_ref, lat_0, lon_0);
+
+	float x[fence_s::GEOFENCE_MAX_VERTICES];
+	float y[fence_s::GEOFENCE_MAX_VERTICES];
+
+	for (unsigned i = 0; i < _verticesCount; i++) {
+		map_projection_project(&_projection_ref, _vertices[i].lat, _vertices[i].lon, &x[i], &y[i]);
+	}
+
+	for (unsigned p = 0; p < _polygonCount; p++) {
+		FencePolygon &polygon = _polygons[p];
+		unsigned first = polygon.first;
+		unsigned end = first + polygon.count;
+
+		if (polygon.count == 0 || end > _verticesCount) {
+			return;
+		}
+
+		polygon.min_x = polygon.max_x = x[first];
+		polygon.min_y = polygon.max_y = y[first];
+
+		for (unsigned i = first + 1; i < end; i++) {
+			polygon.min_x = (x[i] < polygon.min_x) ? x[i] : polygon.min_x;
+			polygon.max_x = (x[i] > polygon.max_x) ? x[i] : polygon.max_x;
+			polygon.min_y = (y[i] < polygon.min_y) ? y[i] : polygon.min_y;
+			polygon.max_y = (y[i] > polygon.max_y) ? y[i] : polygon.max_y;
+		}
+
+		polygon.row_width = (polygon.max_y - polygon.min_y) / GRID_ROWS;
+		memset(polygon.row_edges, 0, sizeof(polygon.row_edges));
+
+		/* edge i runs from the previous vertex of the polygon to vertex i */
+		for (unsigned i = first, j = end - 1; i < end; j = i++) {
+			FenceEdge &edge = _edges[i];
+			edge.x0 = x[i];
+			edge.y0 = y[i];
+			edge.y1 = y[j];
+			/* only evaluated for edges crossing the east coordinate of a point, so never horizontal */
+			edge.slope = (fabsf(y[j] - y[i]) > 0.0f) ? (x[j] - x[i]) / (y[j] - y[i]) : 0.0f;
+
+			float edge_min = (y[i] < y[j]) ? y[i] : y[j];
+			float edge_max = (y[i] < y[j]) ? y[j] : y[i];
+
+			for (unsigned row = 0; row < GRID_ROWS; row++) {
+				/* widen the rows a little so that rounding cannot miss an edge */
+				float row_min = polygon.min_y + row * polygon.row_width - 0.01f;
+				float row_max = row_min + polygon.row_width + 0.02f;
+
+				if (edge_max >= row_min && edge_min <= row_max) {
+					polygon.row_edges[row] |= (1u << i);
+				}
+			}
+		}
+	}
+
+	_polygon_loaded = true;
+}
+
 bool
 Geofence::valid()
 {
@@ -264,6 +395,14 @@ Geofence::valid()
 		return false;
 	}
 
+	/* each polygon needs at least 3 sides of its own */
+	for (unsigned p = 0; p < _polygonCount; p++) {
+		if (_polygons[p].count < 3) {
+			warnx("Fence polygon %u must have at least 3 sides", p);
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -277,6 +416,8 @@ Geofence::addPoint(int argc, char *argv[])
 
 	if ((argc == 1) && (strcmp("-clear", argv[0]) == 0)) {
 		dm_clear(DM_KEY_FENCE_POINTS);
+		_polygonCount = 0;
+		updatePolygon();
 		publishFence(0);
 		return;
 	}
@@ -304,6 +445,10 @@ Geofence::addPoint(int argc, char *argv[])
 	vertex.lon = (float)lon;
 
 	if (dm_write(DM_KEY_FENCE_POINTS, ix, DM_PERSIST_POWER_ON_RESET, &vertex, sizeof(vertex)) == sizeof(vertex)) {
+		/* points added one by one form a single inclusion polygon */
+		_polygonCount = 0;
+		updatePolygon();
+
 		if (last) {
 			publishFence((unsigned)ix + 1);
 		}
@@ -317,11 +462,35 @@ Geofence::addPoint(int argc, char *argv[])
 void
 Geofence::publishFence(unsigned vertices)
 {
+	struct fence_s fence;
+	memset(&fence, 0, sizeof(fence));
+
+	fence.count = (vertices < fence_s::GEOFENCE_MAX_VERTICES) ? vertices : fence_s::GEOFENCE_MAX_VERTICES;
+
+	if (dm_read_many(DM_KEY_FENCE_POINTS, 0, fence.count, fence.vertices, sizeof(struct fence_vertex_s)) != (ssize_t)fence.count) {
+		fence.count = 0;
+	}
+
+	/* the polygon layout is only known for the vertices in use */
+	if (fence.count == _verticesCount) {
+		fence.polygon_count = _polygonCount;
+
+		for (unsigned p = 0; p < _polygonCount; p++) {
+			fence.polygon_vertex_count[p] = _polygons[p].count;
+			fence.polygon_type[p] = _polygons[p].type;
+		}
+
+	} else if (fence.count > 0) {
+		fence.polygon_count = 1;
+		fence.polygon_vertex_count[0] = fence.count;
+		fence.polygon_type[0] = fence_s::POLYGON_INCLUSION;
+	}
+
 	if (_fence_pub == nullptr) {
-		_fence_pub = orb_advertise(ORB_ID(fence), &vertices);
+		_fence_pub = orb_advertise(ORB_ID(fence), &fence);
 
 	} else {
-		orb_publish(ORB_ID(fence), _fence_pub, &vertices);
+		orb_publish(ORB_ID(fence), _fence_pub, &fence);
 	}
 }
 
@@ -331,12 +500,18 @@ Geofence::loadFromFile(const char *filename)
 	FILE		*fp;
 	char		line[120];
 	int			pointCounter = 0;
+	unsigned		polygonCounter = 0;
 	bool		gotVertical = false;
 	const char commentChar = '#';
 	int rc = ERROR;
 
-	/* Make sure no data is left in the datamanager */
-	clearDm();
+	/* parsed into locals, the current fence only changes once the whole file is good */
+	float		altitude_min = 0.0f;
+	float		altitude_max = 0.0f;
+	uint8_t		polygonType[fence_s::GEOFENCE_MAX_POLYGONS];
+	uint8_t		polygonFirst[fence_s::GEOFENCE_MAX_POLYGONS];
+	uint8_t		polygonVertices[fence_s::GEOFENCE_MAX_POLYGONS] = {};
+	struct fence_vertex_s vertices[fence_s::GEOFENCE_MAX_VERTICES];
 
 	/* open the mixer definition file */
 	fp = fopen(GEOFENCE_FILENAME, "r");
@@ -367,7 +542,28 @@ Geofence::loadFromFile(const char *filename)
 			continue;
 		}
 
-		if (gotVertical) {
+		/* a line starting with INCLUSION or EXCLUSION starts a new polygon */
+		bool inclusion = (strncmp(&line[textStart], "INCLUSION", 9) == 0);
+
+		if (gotVertical && (inclusion || strncmp(&line[textStart], "EXCLUSION", 9) == 0)) {
+			if (polygonCounter > 0 && polygonVertices[polygonCounter - 1] < 3) {
+				warnx("Geofence: polygon %u has less than 3 points", polygonCounter - 1);
+				goto error;
+			}
+
+			if (polygonCounter >= fence_s::GEOFENCE_MAX_POLYGONS) {
+				warnx("Geofence: more than %d polygons", fence_s::GEOFENCE_MAX_POLYGONS);
+				goto error;
+			}
+
+			polygonType[polygonCounter] = inclusion ? fence_s::POLYGON_INCLUSION : fence_s::POLYGON_EXCLUSION;
+			polygonFirst[polygonCounter] = pointCounter;
+			polygonVertices[polygonCounter] = 0;
+			polygonCounter++;
+
+			warnx("Geofence: polygon %u, %s", polygonCounter - 1, inclusion ? "inclusion" : "exclusion");
+
+		} else if (gotVertical) {
 			/* Parse the line as a geofence point */
 			struct fence_vertex_s vertex;
 
@@ -394,28 +590,66 @@ Geofence::loadFromFile(const char *filename)
 				}
 			}
 
-			if (dm_write(DM_KEY_FENCE_POINTS, pointCounter, DM_PERSIST_POWER_ON_RESET, &vertex, sizeof(vertex)) != sizeof(vertex)) {
+			if (pointCounter >= fence_s::GEOFENCE_MAX_VERTICES) {
+				warnx("Geofence: more than %d points", fence_s::GEOFENCE_MAX_VERTICES);
 				goto error;
 			}
 
+			vertices[pointCounter] = vertex;
+
 			warnx("Geofence: point: %d, lat %.5f: lon: %.5f", pointCounter, (double)vertex.lat, (double)vertex.lon);
 
+			/* vertices before the first keyword form an inclusion polygon */
+			if (polygonCounter == 0) {
+				polygonType[0] = fence_s::POLYGON_INCLUSION;
+				polygonFirst[0] = 0;
+				polygonVertices[0] = 0;
+				polygonCounter = 1;
+			}
+
+			polygonVertices[polygonCounter - 1]++;
 			pointCounter++;
 
 		} else {
 			/* Parse the line as the vertical limits */
-			if (sscanf(line, "%f %f", &_altitude_min, &_altitude_max) != 2) {
+			if (sscanf(line, "%f %f", &altitude_min, &altitude_max) != 2) {
 				goto error;
 			}
 
-			warnx("Geofence: alt min: %.4f, alt_max: %.4f", (double)_altitude_min, (double)_altitude_max);
+			warnx("Geofence: alt min: %.4f, alt_max: %.4f", (double)altitude_min, (double)altitude_max);
 			gotVertical = true;
 		}
 	}
 
+	/* a trailing header without points leaves the last polygon short as well */
+	if (polygonCounter > 0 && polygonVertices[polygonCounter - 1] < 3) {
+		warnx("Geofence: polygon %u has less than 3 points", polygonCounter - 1);
+		pointCounter = 0;
+	}
+
 	/* Check if import was successful */
 	if (gotVertical && pointCounter > 0) {
+		/* Make sure no data is left in the datamanager */
+		clearDm();
+
+		for (int i = 0; i < pointCounter; i++) {
+			if (dm_write(DM_KEY_FENCE_POINTS, i, DM_PERSIST_POWER_ON_RESET, &vertices[i], sizeof(vertices[i])) != sizeof(vertices[i])) {
+				goto error;
+			}
+		}
+
+		_altitude_min = altitude_min;
+		_altitude_max = altitude_max;
 		_verticesCount = pointCounter;
+		_polygonCount = polygonCounter;
+
+		for (unsigned p = 0; p < polygonCounter; p++) {
+			_polygons[p].type = polygonType[p];
+			_polygons[p].first = polygonFirst[p];
+			_polygons[p].count = polygonVertices[p];
+		}
+
+		updatePolygon();
 		warnx("Geofence: imported successfully");
 		mavlink_log_info(_mavlinkFd, "Geofence imported");
 		rc = OK;
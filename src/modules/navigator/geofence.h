@@ -50,6 +50,7 @@
 #include <controllib/block/BlockParam.hpp>
 #include <drivers/drv_hrt.h>
 #include <px4_defines.h>
+#include <geo/geo.h>
 
 #define GEOFENCE_FILENAME PX4_ROOTFSDIR"/fs/microsd/etc/geofence.txt"
 
@@ -84,6 +85,14 @@ public:
 
 	bool inside_polygon(double lat, double lon, float altitude);
 
+	/**
+	 * Load the fence polygons from the data manager and index them.
+	 *
+	 * Keeps the vertices projected to a local frame in RAM, so that
+	 * inside_polygon() does not need to access the data manager.
+	 */
+	void updatePolygon();
+
 	int clearDm();
 
 	bool valid();
@@ -95,6 +104,13 @@ public:
 
 	void publishFence(unsigned vertices);
 
+	/**
+	 * Load the fence from a text file.
+	 *
+	 * The first line holds the vertical limits, then one vertex per line.
+	 * A line reading INCLUSION or EXCLUSION starts a new polygon, vertices
+	 * before the first of these form an inclusion polygon.
+	 */
 	int loadFromFile(const char *filename);
 
 	bool isEmpty() {return _verticesCount == 0;}
@@ -119,6 +135,32 @@ private:
 
 	unsigned 			_verticesCount;
 
+	/* rows of the polygon index, each lists the edges spanning it */
+	static constexpr unsigned GRID_ROWS = 8;
+
+	struct FenceEdge {
+		float x0;			/**< start vertex north [m] */
+		float y0;			/**< start vertex east [m] */
+		float y1;			/**< end vertex east [m] */
+		float slope;			/**< north change per east change [m/m] */
+	};
+
+	struct FencePolygon {
+		uint8_t type;			/**< fence_s::POLYGON_INCLUSION or POLYGON_EXCLUSION */
+		uint8_t first;			/**< index of the first vertex */
+		uint8_t count;			/**< number of vertices */
+		float min_x, max_x, min_y, max_y;	/**< bounding box [m] */
+		float row_width;		/**< east extent of an index row [m] */
+		uint32_t row_edges[GRID_ROWS];	/**< bit i set if edge i spans the row */
+	};
+
+	struct fence_vertex_s _vertices[fence_s::GEOFENCE_MAX_VERTICES];
+	struct map_projection_reference_s _projection_ref;	/**< local frame of the polygons */
+	FenceEdge	_edges[fence_s::GEOFENCE_MAX_VERTICES];	/**< edge i ends at vertex i */
+	FencePolygon	_polygons[fence_s::GEOFENCE_MAX_POLYGONS];
+	unsigned	_polygonCount;
+	bool		_polygon_loaded;	/**< the polygons could be read from the data manager */
+
 	/* Params */
 	control::BlockParamInt _param_geofence_mode;
 	control::BlockParamInt _param_altitude_mode;
@@ -134,6 +176,11 @@ private:
 	bool inside(double lat, double lon, float altitude);
 	bool inside(const struct vehicle_global_position_s &global_position);
 	bool inside(const struct vehicle_global_position_s &global_position, float baro_altitude_amsl);
+
+	/**
+	 * Point in polygon test in the local frame, using the row index of the polygon.
+	 */
+	bool insidePolygon(const FencePolygon &polygon, float x, float y);
 };
 
 
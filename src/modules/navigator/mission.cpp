@@ -81,6 +81,13 @@ Mission::Mission(Navigator *navigator, const char *name) :
 	_inited(false),
 	_home_inited(false),
 	_missionFeasiblityChecker(),
+	_item_cache{},
+	_item_cache_active(0),
+	_item_cache_dm_item(DM_KEY_WAYPOINTS_ONBOARD),
+	_item_cache_start(0),
+	_item_cache_count(0),
+	_item_prefetch{},
+	_item_prefetch_queued(false),
 	_min_current_sp_distance_xy(FLT_MAX),
 	_mission_item_previous_alt(NAN),
   	_on_arrival_yaw(NAN),
@@ -92,6 +99,8 @@ Mission::Mission(Navigator *navigator, const char *name) :
 
 Mission::~Mission()
 {
+	/* the dataman must not complete a prefetch into freed memory */
+	wait_mission_prefetch();
 }
 
 void
@@ -123,6 +132,8 @@ Mission::on_inactive()
 
 		dm_unlock(DM_KEY_MISSION_STATE);
 
+		invalidate_mission_item_cache();
+
 		if (read_res == sizeof(mission_s)) {
 			_offboard_mission.dataman_id = mission_state.dataman_id;
 			_offboard_mission.count = mission_state.count;
@@ -200,6 +211,8 @@ Mission::on_active()
 void
 Mission::update_onboard_mission()
 {
+	invalidate_mission_item_cache();
+
 	if (orb_copy(ORB_ID(onboard_mission), _navigator->get_onboard_mission_sub(), &_onboard_mission) == OK) {
 		/* accept the current index set by the onboard mission if it is within bounds */
 		if (_onboard_mission.current_seq >=0
@@ -233,6 +246,8 @@ Mission::update_offboard_mission()
 {
 	bool failed = true;
 
+	invalidate_mission_item_cache();
+
 	if (orb_copy(ORB_ID(offboard_mission), _navigator->get_offboard_mission_sub(), &_offboard_mission) == OK) {
 		warnx("offboard mission updated: dataman_id=%d, count=%d, current_seq=%d", _offboard_mission.dataman_id, _offboard_mission.count, _offboard_mission.current_seq);
 		/* determine current index */
@@ -258,7 +273,8 @@ Mission::update_offboard_mission()
 				dm_current, (size_t) _offboard_mission.count, _navigator->get_geofence(),
 				_navigator->get_home_position()->alt, _navigator->home_position_valid(),
 				_navigator->get_global_position()->lat, _navigator->get_global_position()->lon,
-				_param_dist_1wp.get(), _navigator->get_mission_result()->warning);
+				_param_dist_1wp.get(), _navigator->get_mission_result()->warning,
+				_navigator->get_terrain(), _navigator->get_terrain_clearance());
 
 		_navigator->get_mission_result()->valid = !failed;
 		_navigator->increment_mission_instance_count();
@@ -661,13 +677,11 @@ Mission::read_mission_item(bool onboard, bool is_current, struct mission_item_s
 			return false;
 		}
 
-		const ssize_t len = sizeof(struct mission_item_s);
-
 		/* read mission item to temp storage first to not overwrite current mission item if data damaged */
 		struct mission_item_s mission_item_tmp;
 
 		/* read mission item from datamanager */
-		if (dm_read(dm_item, *mission_index_ptr, &mission_item_tmp, len) != len) {
+		if (!read_cached_mission_item(dm_item, *mission_index_ptr, (int)mission->count, &mission_item_tmp)) {
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 			mavlink_and_console_log_critical(_navigator->get_mavlink_fd(),
 			                     "ERROR waypoint could not be read");
@@ -685,8 +699,7 @@ Mission::read_mission_item(bool onboard, bool is_current, struct mission_item_s
 				if (is_current) {
 					(mission_item_tmp.do_jump_current_count)++;
 					/* save repeat count */
-					if (dm_write(dm_item, *mission_index_ptr, DM_PERSIST_POWER_ON_RESET,
-					    &mission_item_tmp, len) != len) {
+					if (!write_cached_mission_item(dm_item, *mission_index_ptr, &mission_item_tmp)) {
 						/* not supposed to happen unless the datamanager can't access the
 						 * dataman */
 						mavlink_log_critical(_navigator->get_mavlink_fd(),
@@ -722,6 +735,106 @@ Mission::read_mission_item(bool onboard, bool is_current, struct mission_item_s
 	return false;
 }
 
+bool
+Mission::read_cached_mission_item(dm_item_t dm_item, int index, int count, struct mission_item_s *mission_item)
+{
+	if (dm_item != _item_cache_dm_item) {
+		invalidate_mission_item_cache();
+		_item_cache_dm_item = dm_item;
+	}
+
+	if (index < _item_cache_start || index >= _item_cache_start + _item_cache_count) {
+		/* the prefetched items follow the cached ones, switch over if they hold this item */
+		int prefetched = wait_mission_prefetch();
+
+		if (prefetched > 0 && index >= (int)_item_prefetch.index && index < (int)_item_prefetch.index + prefetched) {
+			_item_cache_active = 1 - _item_cache_active;
+			_item_cache_start = _item_prefetch.index;
+			_item_cache_count = prefetched;
+
+		} else {
+			/* read the item and the ones following it, advancing and looking ahead will need them */
+			ssize_t res = dm_read_many(dm_item, index, math::min(count - index, MISSION_ITEM_CACHE_SIZE),
+						   _item_cache[_item_cache_active], sizeof(struct mission_item_s));
+
+			if (res <= 0) {
+				_item_cache_count = 0;
+				return false;
+			}
+
+			_item_cache_start = index;
+			_item_cache_count = res;
+		}
+	}
+
+	memcpy(mission_item, &_item_cache[_item_cache_active][index - _item_cache_start], sizeof(struct mission_item_s));
+
+	if (!_item_prefetch_queued) {
+		prefetch_mission_items(count);
+	}
+
+	return true;
+}
+
+bool
+Mission::write_cached_mission_item(dm_item_t dm_item, int index, const struct mission_item_s *mission_item)
+{
+	/* a prefetch still in flight could return the old item */
+	wait_mission_prefetch();
+
+	const ssize_t len = sizeof(struct mission_item_s);
+
+	if (dm_write(dm_item, index, DM_PERSIST_POWER_ON_RESET, mission_item, len) != len) {
+		return false;
+	}
+
+	if (dm_item == _item_cache_dm_item && index >= _item_cache_start && index < _item_cache_start + _item_cache_count) {
+		memcpy(&_item_cache[_item_cache_active][index - _item_cache_start], mission_item, len);
+	}
+
+	return true;
+}
+
+void
+Mission::prefetch_mission_items(int count)
+{
+	int start = _item_cache_start + _item_cache_count;
+
+	if (_item_cache_count == 0 || start >= count) {
+		return;
+	}
+
+	_item_prefetch.item = _item_cache_dm_item;
+	_item_prefetch.index = start;
+	_item_prefetch.count = math::min(count - start, MISSION_ITEM_CACHE_SIZE);
+	_item_prefetch.buffer = _item_cache[1 - _item_cache_active];
+	_item_prefetch.buflen = sizeof(struct mission_item_s);
+	_item_prefetch.callback = NULL;
+	_item_prefetch.arg = NULL;
+
+	_item_prefetch_queued = (dm_read_async(&_item_prefetch) == 0);
+}
+
+int
+Mission::wait_mission_prefetch()
+{
+	if (!_item_prefetch_queued) {
+		return 0;
+	}
+
+	_item_prefetch_queued = false;
+
+	return dm_wait(&_item_prefetch);
+}
+
+void
+Mission::invalidate_mission_item_cache()
+{
+	wait_mission_prefetch();
+	_item_cache_start = 0;
+	_item_cache_count = 0;
+}
+
 void
 Mission::save_offboard_mission_state()
 {
@@ -814,7 +927,8 @@ Mission::check_mission_valid()
 				dm_current, (size_t) _offboard_mission.count, _navigator->get_geofence(),
 				_navigator->get_home_position()->alt, _navigator->home_position_valid(),
 				_navigator->get_global_position()->lat, _navigator->get_global_position()->lon,
-				_param_dist_1wp.get(), _navigator->get_mission_result()->warning);
+				_param_dist_1wp.get(), _navigator->get_mission_result()->warning,
+				_navigator->get_terrain(), _navigator->get_terrain_clearance());
 
 		_navigator->increment_mission_instance_count();
 		_navigator->set_mission_result_updated();
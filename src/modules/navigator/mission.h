@@ -141,6 +141,35 @@ private:
 	 */
 	bool read_mission_item(bool onboard, bool is_current, struct mission_item_s *mission_item);
 
+	/**
+	 * Read a mission item through the item cache, on a miss the next items are
+	 * read in one access and the items after them are prefetched asynchronously
+	 * @return true if successful
+	 */
+	bool read_cached_mission_item(dm_item_t dm_item, int index, int count, struct mission_item_s *mission_item);
+
+	/**
+	 * Write a mission item to the dataman and update its cached copy
+	 * @return true if successful
+	 */
+	bool write_cached_mission_item(dm_item_t dm_item, int index, const struct mission_item_s *mission_item);
+
+	/**
+	 * Queue an asynchronous read of the items following the cached ones
+	 */
+	void prefetch_mission_items(int count);
+
+	/**
+	 * Wait for a queued prefetch to complete
+	 * @return number of items read by the prefetch, 0 or less if none was queued or it failed
+	 */
+	int wait_mission_prefetch();
+
+	/**
+	 * Drop all cached mission items, needs to be called when a mission changes
+	 */
+	void invalidate_mission_item_cache();
+
 	/**
 	 * Save current offboard mission state to dataman
 	 */
@@ -196,6 +225,15 @@ private:
 
 	MissionFeasibilityChecker _missionFeasiblityChecker; /**< class that checks if a mission is feasible */
 
+	static const int MISSION_ITEM_CACHE_SIZE = 4;
+	struct mission_item_s _item_cache[2][MISSION_ITEM_CACHE_SIZE]; /**< cached and prefetched consecutive mission items */
+	unsigned _item_cache_active;	/**< index of the cache buffer holding the cached items */
+	dm_item_t _item_cache_dm_item;	/**< dataman item the cached items belong to */
+	int _item_cache_start;		/**< mission index of the first cached item */
+	int _item_cache_count;		/**< number of cached items, 0 if the cache is empty */
+	dm_request_t _item_prefetch;	/**< asynchronous read into the other cache buffer */
+	bool _item_prefetch_queued;	/**< _item_prefetch needs to be waited for */
+
 	float _min_current_sp_distance_xy; /**< minimum distance which was achieved to the current waypoint  */
 	float _mission_item_previous_alt; /**< holds the altitude of the previous mission item,
 					    can be replaced by a full copy of the previous mission item if needed */
@@ -46,6 +46,7 @@
 #include <uORB/topics/navigation_capabilities.h>
 #include <dataman/dataman.h>
 #include "geofence.h"
+#include "terrain_cache.h"
 
 
 class MissionFeasibilityChecker
@@ -60,19 +61,40 @@ private:
 	bool _dist_1wp_ok;
 	void init();
 
-	/* Checks for all airframes */
-	bool checkGeofence(dm_item_t dm_current, size_t nMissionItems, Geofence &geofence);
-	bool checkHomePositionAltitude(dm_item_t dm_current, size_t nMissionItems, float home_alt, bool home_valid, bool &warning_issued, bool throw_error = false);
-	bool checkMissionItemValidity(dm_item_t dm_current, size_t nMissionItems);
-	bool check_dist_1wp(dm_item_t dm_current, size_t nMissionItems, double curr_lat, double curr_lon, float dist_first_wp, bool &warning_issued);
+	/* result of a check, checks stop at the first item they can decide on */
+	enum CheckResult {
+		CHECK_PENDING = 0,
+		CHECK_PASSED,
+		CHECK_FAILED
+	};
+
+	/* the checks in the order they are reported */
+	enum {
+		CHECK_DIST_1WP = 0,
+		CHECK_ITEM_VALIDITY,
+		CHECK_GEOFENCE,
+		CHECK_HOME_ALT,
+		CHECK_TERRAIN_ALT,
+		CHECK_FW_LANDING,
+		CHECK_COUNT
+	};
+
+	/* mission items read from the data manager at once */
+	static const unsigned ITEMS_PER_READ = 8;
+	struct mission_item_s _items[ITEMS_PER_READ];
+
+	/* Checks for all airframes, called for each mission item in order */
+	CheckResult checkGeofence(const struct mission_item_s &missionitem, size_t index, Geofence &geofence);
+	CheckResult checkHomePositionAltitude(const struct mission_item_s &missionitem, size_t index, float home_alt, bool home_valid, bool &warning_issued, bool throw_error = false);
+	CheckResult checkTerrainAltitude(const struct mission_item_s &missionitem, size_t index, float home_alt,
+		TerrainCache &terrain, float terrain_clearance);
+	CheckResult checkMissionItemValidity(const struct mission_item_s &missionitem, size_t index);
+	CheckResult check_dist_1wp(const struct mission_item_s &mission_item, double curr_lat, double curr_lon, float dist_first_wp, bool &warning_issued);
 
 	/* Checks specific to fixedwing airframes */
-	bool checkMissionFeasibleFixedwing(dm_item_t dm_current, size_t nMissionItems, Geofence &geofence, float home_alt, bool home_valid);
-	bool checkFixedWingLanding(dm_item_t dm_current, size_t nMissionItems);
+	CheckResult checkFixedWingLanding(const struct mission_item_s &missionitem, const struct mission_item_s *missionitem_previous);
 	void updateNavigationCapabilities();
 
-	/* Checks specific to rotarywing airframes */
-	bool checkMissionFeasibleRotarywing(dm_item_t dm_current, size_t nMissionItems, Geofence &geofence, float home_alt, bool home_valid);
 public:
 
 	MissionFeasibilityChecker();
@@ -80,10 +102,14 @@ public:
 
 	/*
 	 * Returns true if mission is feasible and false otherwise
+	 *
+	 * The mission is read once and every item is passed to all checks.
+	 * The waypoints are checked against the terrain if terrain_clearance is positive.
 	 */
 	bool checkMissionFeasible(int mavlink_fd, bool isRotarywing, dm_item_t dm_current,
 		size_t nMissionItems, Geofence &geofence, float home_alt, bool home_valid,
-		double curr_lat, double curr_lon, float max_waypoint_distance, bool &warning_issued);
+		double curr_lat, double curr_lon, float max_waypoint_distance, bool &warning_issued,
+		TerrainCache &terrain, float terrain_clearance);
 
 };
 
@@ -49,6 +49,7 @@ SRCS		= navigator_main.cpp \
 		  mission_feasibility_checker.cpp \
 		  geofence.cpp \
 		  geofence_params.c \
+		  terrain_cache.cpp \
 		  datalinkloss.cpp \
 		  datalinkloss_params.c \
 		  rcloss.cpp \
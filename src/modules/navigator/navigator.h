@@ -67,6 +67,7 @@
 #include "gpsfailure.h"
 #include "rcloss.h"
 #include "geofence.h"
+#include "terrain_cache.h"
 
 /**
  * Number of navigation modes that need on_active/on_inactive calls
@@ -122,7 +123,13 @@ public:
 	/**
 	 * Setters
 	 */
-	void		set_can_loiter_at_sp(bool can_loiter) { _can_loiter_at_sp = can_loiter; }
+	void		set_can_loiter_at_sp(bool can_loiter)
+	{
+		if (can_loiter != _can_loiter_at_sp) {
+			_can_loiter_at_sp = can_loiter;
+			_mode_inputs_pending = true;
+		}
+	}
 	void		set_position_setpoint_triplet_updated() { _pos_sp_triplet_updated = true; }
 	void		set_mission_result_updated() { _mission_result_updated = true; }
 
@@ -145,7 +152,14 @@ public:
 	int		get_offboard_mission_sub() { return _offboard_mission_sub; }
 	Geofence&	get_geofence() { return _geofence; }
 	bool		get_can_loiter_at_sp() { return _can_loiter_at_sp; }
+	bool		mode_inputs_updated() { return _mode_inputs_updated; }
 	float		get_loiter_radius() { return _param_loiter_radius.get(); }
+	TerrainCache&	get_terrain() { return _terrain; }
+
+	/**
+	 * Get the minimum height above the terrain, 0 if the terrain is not used
+	 */
+	float		get_terrain_clearance() { return _param_terrain_clearance.get(); }
 
 	/**
 	 * Get the acceptance radius
@@ -217,6 +231,8 @@ private:
 
 	bool		_inside_fence;			/**< vehicle is inside fence */
 
+	TerrainCache	_terrain;			/**< terrain heights around the vehicle */
+
 	NavigatorMode	*_navigation_mode;		/**< abstract pointer to current navigation mode class */
 	Mission		_mission;			/**< class that handles the missions */
 	Loiter		_loiter;			/**< class that handles loiter */
@@ -234,11 +250,14 @@ private:
 	bool		_pos_sp_triplet_updated;		/**< flags if position SP triplet needs to be published */
 	bool 		_pos_sp_triplet_published_invalid_once;	/**< flags if position SP triplet has been published once to UORB */
 	bool		_mission_result_updated;		/**< flags if mission result has seen an update */
+	bool		_mode_inputs_updated;			/**< flags if the inactive modes have to be updated this cycle */
+	bool		_mode_inputs_pending;			/**< flags an input change for the next update of the modes */
 
 	control::BlockParamFloat _param_loiter_radius;	/**< loiter radius for fixedwing */
 	control::BlockParamFloat _param_acceptance_radius;	/**< acceptance for takeoff */
 	control::BlockParamInt _param_datalinkloss_obc;	/**< if true: obc mode on data link loss enabled */
 	control::BlockParamInt _param_rcloss_obc;	/**< if true: obc mode on rc loss enabled */
+	control::BlockParamFloat _param_terrain_clearance;	/**< minimum height above the terrain */
 	/**
 	 * Retrieve global position
 	 */
@@ -55,6 +55,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <math.h>
+#include <float.h>
 #include <poll.h>
 #include <time.h>
 #include <sys/ioctl.h>
@@ -90,6 +91,7 @@
 extern "C" __EXPORT int navigator_main(int argc, char *argv[]);
 
 #define GEOFENCE_CHECK_INTERVAL 200000
+#define TERRAIN_PREFETCH_INTERVAL 500000
 
 namespace navigator
 {
@@ -133,6 +135,7 @@ Navigator::Navigator() :
 	_geofence{},
 	_geofence_violation_warning_sent(false),
 	_inside_fence(true),
+	_terrain(),
 	_navigation_mode(nullptr),
 	_mission(this, "MIS"),
 	_loiter(this, "LOI"),
@@ -145,10 +148,13 @@ Navigator::Navigator() :
 	_pos_sp_triplet_updated(false),
 	_pos_sp_triplet_published_invalid_once(false),
 	_mission_result_updated(false),
+	_mode_inputs_updated(false),
+	_mode_inputs_pending(true),
 	_param_loiter_radius(this, "LOITER_RAD"),
 	_param_acceptance_radius(this, "ACC_RAD"),
 	_param_datalinkloss_obc(this, "DLL_OBC"),
-	_param_rcloss_obc(this, "RCL_OBC")
+	_param_rcloss_obc(this, "RCL_OBC"),
+	_param_terrain_clearance(this, "TERR_CLR")
 {
 	/* Create a list of our possible navigation types */
 	_navigation_mode_array[0] = &_mission;
@@ -373,6 +379,7 @@ Navigator::task_main()
 		if (fds[5].revents & POLLIN) {
 			params_update();
 			updateParams();
+			_mode_inputs_pending = true;
 		}
 
 		/* vehicle control mode updated */
@@ -383,6 +390,7 @@ Navigator::task_main()
 		/* vehicle status updated */
 		if (fds[3].revents & POLLIN) {
 			vehicle_status_update();
+			_mode_inputs_pending = true;
 		}
 
 		/* navigation capabilities updated */
@@ -393,6 +401,7 @@ Navigator::task_main()
 		/* home position updated */
 		if (fds[1].revents & POLLIN) {
 			home_position_update();
+			_mode_inputs_pending = true;
 		}
 
 		/* global position updated */
@@ -428,6 +437,14 @@ Navigator::task_main()
 			}
 		}
 
+		/* load the terrain around the vehicle ahead of the lookups, one tile at a time */
+		static hrt_abstime last_terrain_prefetch = 0;
+		if (get_terrain_clearance() > FLT_EPSILON && _global_pos.timestamp > 0 &&
+		    hrt_elapsed_time(&last_terrain_prefetch) > TERRAIN_PREFETCH_INTERVAL) {
+			_terrain.prefetch(_global_pos.lat, _global_pos.lon);
+			last_terrain_prefetch = hrt_absolute_time();
+		}
+
 		/* Do stuff according to navigation state set by commander */
 		switch (_vstatus.nav_state) {
 			case vehicle_status_s::NAVIGATION_STATE_MANUAL:
@@ -438,7 +455,7 @@ Navigator::task_main()
 			case vehicle_status_s::NAVIGATION_STATE_TERMINATION:
 			case vehicle_status_s::NAVIGATION_STATE_OFFBOARD:
 				_navigation_mode = nullptr;
-				_can_loiter_at_sp = false;
+				set_can_loiter_at_sp(false);
 				break;
 			case vehicle_status_s::NAVIGATION_STATE_AUTO_MISSION:
 				_pos_sp_triplet_published_invalid_once = false;
@@ -480,10 +497,22 @@ Navigator::task_main()
 				break;
 			default:
 				_navigation_mode = nullptr;
-				_can_loiter_at_sp = false;
+				set_can_loiter_at_sp(false);
 				break;
 		}
 
+		/* the missions are copied by the mission mode, checking does not consume the update */
+		bool mission_updated = false;
+		orb_check(_onboard_mission_sub, &mission_updated);
+
+		if (!mission_updated) {
+			orb_check(_offboard_mission_sub, &mission_updated);
+		}
+
+		/* inactive modes only need to run again if one of their inputs changed */
+		_mode_inputs_updated = _mode_inputs_pending || mission_updated;
+		_mode_inputs_pending = false;
+
 		/* iterate through navigation modes and set active/inactive for each */
 		for(unsigned int i = 0; i < NAVIGATOR_MODE_ARRAY_SIZE; i++) {
 			_navigation_mode_array[i]->run(_navigation_mode == _navigation_mode_array[i]);
@@ -562,6 +591,10 @@ Navigator::status()
 	} else {
 		warnx("Geofence not set (no /etc/geofence.txt on microsd) or not valid");
 	}
+
+	if (get_terrain_clearance() > FLT_EPSILON) {
+		_terrain.print_status();
+	}
 }
 
 void
@@ -74,8 +74,8 @@ NavigatorMode::run(bool active)
 			on_active();
 		}
 
-	} else {
-		/* periodic updates when inactive */
+	} else if (!_first_run || _navigator->mode_inputs_updated()) {
+		/* update when deactivated and on new inputs while inactive */
 		_first_run = true;
 		on_inactive();
 	}
@@ -69,7 +69,8 @@ public:
 	void run(bool active);
 
 	/**
-	 * This function is called while the mode is inactive
+	 * This function is called when the mode becomes inactive and, while it
+	 * stays inactive, only when the inputs of the inactive modes changed
 	 */
 	virtual void on_inactive();
 
@@ -90,6 +90,20 @@ PARAM_DEFINE_INT32(NAV_DLL_OBC, 0);
  */
 PARAM_DEFINE_INT32(NAV_RCL_OBC, 0);
 
+/**
+ * Terrain clearance
+ *
+ * Minimum height above the terrain of the RTL return altitude and of the
+ * mission waypoints. The terrain is read from the SRTM height files in
+ * /fs/microsd/terrain. Set to 0 to disable the terrain checks.
+ *
+ * @unit meter
+ * @min 0
+ * @max 1000
+ * @group Mission
+ */
+PARAM_DEFINE_FLOAT(NAV_TERR_CLR, 0.0f);
+
 /**
  * Airfield home Lat
  *
@@ -40,11 +40,13 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <float.h>
 #include <fcntl.h>
 
 #include <mavlink/mavlink_log.h>
 #include <systemlib/err.h>
 #include <geo/geo.h>
+#include <mathlib/mathlib.h>
 
 #include <uORB/uORB.h>
 #include <navigator/navigation.h>
@@ -92,8 +94,7 @@ RTL::on_activation()
 			mavlink_log_critical(_navigator->get_mavlink_fd(), "no RTL when landed");
 
 		/* if lower than return altitude, climb up first */
-		} else if (_navigator->get_global_position()->alt < _navigator->get_home_position()->alt
-			   + _param_return_alt.get()) {
+		} else if (_navigator->get_global_position()->alt < get_return_alt()) {
 			_rtl_state = RTL_STATE_CLIMB;
 
 		/* otherwise go straight to return */
@@ -118,6 +119,24 @@ RTL::on_active()
 	}
 }
 
+float
+RTL::get_return_alt()
+{
+	float return_alt = _navigator->get_home_position()->alt + _param_return_alt.get();
+	float clearance = _navigator->get_terrain_clearance();
+	float terrain_alt;
+
+	if (clearance > FLT_EPSILON &&
+	    _navigator->get_terrain().get_max_height_on_path(_navigator->get_global_position()->lat,
+			    _navigator->get_global_position()->lon,
+			    _navigator->get_home_position()->lat,
+			    _navigator->get_home_position()->lon, terrain_alt)) {
+		return_alt = math::max(return_alt, terrain_alt + clearance);
+	}
+
+	return return_alt;
+}
+
 void
 RTL::set_rtl_item()
 {
@@ -131,7 +150,7 @@ RTL::set_rtl_item()
 
 	switch (_rtl_state) {
 	case RTL_STATE_CLIMB: {
-		float climb_alt = _navigator->get_home_position()->alt + _param_return_alt.get();
+		float climb_alt = get_return_alt();
 
 		_mission_item.lat = _navigator->get_global_position()->lat;
 		_mission_item.lon = _navigator->get_global_position()->lon;
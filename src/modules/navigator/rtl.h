@@ -77,6 +77,11 @@ private:
 	 */
 	void		advance_rtl();
 
+	/**
+	 * Get the altitude to return at, above home and, if enabled, above the terrain on the way home
+	 */
+	float		get_return_alt();
+
 	enum RTLState {
 		RTL_STATE_NONE = 0,
 		RTL_STATE_CLIMB,
@@ -0,0 +1,329 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file terrain_cache.cpp
+ *
+ * Tiled terrain height cache.
+ */
+
+#include "terrain_cache.h"
+
+#include <geo/geo.h>
+#include <systemlib/err.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* height of the SRTM voids, no data */
+#define TERRAIN_VOID	-32768
+
+/* margin of a tile in cells, covers the rounding of the tile origin */
+#define TILE_MARGIN	1e-6
+
+/* spacing of the samples along a path, about the spacing of SRTM3 */
+#define TERRAIN_PATH_STEP	90.0f
+
+TerrainCache::TerrainCache(const char *directory) :
+	_directory(directory),
+	_tiles(nullptr),
+	_lookups(0),
+	_file(nullptr),
+	_file_lat(0),
+	_file_lon(0),
+	_file_samples(0),
+	_missing_valid(false),
+	_missing_lat(0),
+	_missing_lon(0),
+	_loads(0),
+	_load_errors(0)
+{
+}
+
+TerrainCache::~TerrainCache()
+{
+	if (_file != nullptr) {
+		fclose(_file);
+	}
+
+	delete[] _tiles;
+}
+
+bool
+TerrainCache::get_height(double lat, double lon, float &height)
+{
+	double x, y;
+	Tile *tile = find_tile(lat, lon, x, y);
+
+	if (tile == nullptr) {
+		if (load_tile(lat, lon) == nullptr) {
+			return false;
+		}
+
+		tile = find_tile(lat, lon, x, y);
+
+		if (tile == nullptr) {
+			return false;
+		}
+	}
+
+	tile->last_used = ++_lookups;
+
+	/* the last cell also holds the far edge of the tile */
+	unsigned ix = ((unsigned)x < TILE_CELLS) ? (unsigned)x : TILE_CELLS - 1;
+	unsigned iy = ((unsigned)y < TILE_CELLS) ? (unsigned)y : TILE_CELLS - 1;
+	float fx = (float)(x - ix);
+	float fy = (float)(y - iy);
+
+	int h00 = tile->height[iy][ix];
+	int h01 = tile->height[iy][ix + 1];
+	int h10 = tile->height[iy + 1][ix];
+	int h11 = tile->height[iy + 1][ix + 1];
+
+	if (h00 == TERRAIN_VOID || h01 == TERRAIN_VOID || h10 == TERRAIN_VOID || h11 == TERRAIN_VOID) {
+		return false;
+	}
+
+	float north = h00 + (h01 - h00) * fx;
+	float south = h10 + (h11 - h10) * fx;
+	height = north + (south - north) * fy;
+
+	return true;
+}
+
+bool
+TerrainCache::get_max_height_on_path(double lat_start, double lon_start, double lat_end, double lon_end,
+				     float &max_height)
+{
+	float distance = get_distance_to_next_waypoint(lat_start, lon_start, lat_end, lon_end);
+	unsigned samples = (unsigned)(distance / TERRAIN_PATH_STEP) + 2;
+
+	if (samples > TERRAIN_PATH_SAMPLES) {
+		samples = TERRAIN_PATH_SAMPLES;
+	}
+
+
+	for (unsigned i = 0; i < samples; i++) {
+		double t = (double)i / (samples - 1);
+		float height;
+
+		if (!get_height(lat_start + (lat_end - lat_start) * t, lon_start + (lon_end - lon_start) * t, height)) {
+			return false;
+		}
+
+		if (i == 0 || height > max_height) {
+			max_height = height;
+		}
+	}
+
+	return true;
+}
+
+void
+TerrainCache::prefetch(double lat, double lon)
+{
+	double x, y;
+	Tile *tile = find_tile(lat, lon, x, y);
+
+	if (tile == nullptr) {
+		load_tile(lat, lon);
+		return;
+	}
+
+	/* the neighbours of the tile the vehicle is in */
+	double span = TILE_CELLS * tile->spacing;
+
+	for (int dy = -1; dy <= 1; dy++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			double lat_n = lat + dy * span;
+			double lon_n = lon + dx * span;
+
+			if ((dx != 0 || dy != 0) && find_tile(lat_n, lon_n, x, y) == nullptr) {
+				load_tile(lat_n, lon_n);
+				return;
+			}
+		}
+	}
+}
+
+void
+TerrainCache::print_status()
+{
+	unsigned cached = 0;
+
+	for (unsigned i = 0; _tiles != nullptr && i < CACHE_TILES; i++) {
+		if (_tiles[i].valid) {
+			cached++;
+		}
+	}
+
+	warnx("terrain: %u/%u tiles cached, %u loads, %u errors", cached, CACHE_TILES, _loads, _load_errors);
+}
+
+TerrainCache::Tile *
+TerrainCache::find_tile(double lat, double lon, double &x, double &y)
+{
+	for (unsigned i = 0; _tiles != nullptr && i < CACHE_TILES; i++) {
+		Tile *tile = &_tiles[i];
+
+		if (!tile->valid) {
+			continue;
+		}
+
+		x = (lon - tile->lon_west) / tile->spacing;
+		y = (tile->lat_north - lat) / tile->spacing;
+
+		/* the edges of the tile, with a margin for the rounding of the tile origin */
+		if (x > -TILE_MARGIN && x < TILE_CELLS + TILE_MARGIN && y > -TILE_MARGIN && y < TILE_CELLS + TILE_MARGIN) {
+			x = (x < 0.0) ? 0.0 : ((x > TILE_CELLS) ? TILE_CELLS : x);
+			y = (y < 0.0) ? 0.0 : ((y > TILE_CELLS) ? TILE_CELLS : y);
+			return tile;
+		}
+	}
+
+	return nullptr;
+}
+
+TerrainCache::Tile *
+TerrainCache::load_tile(double lat, double lon)
+{
+	int square_lat = (int)floor(lat);
+	int square_lon = (int)floor(lon);
+
+	if (!open_square(square_lat, square_lon)) {
+		return nullptr;
+	}
+
+	if (_tiles == nullptr) {
+		_tiles = new Tile[CACHE_TILES];
+
+		if (_tiles == nullptr) {
+			return nullptr;
+		}
+
+		for (unsigned i = 0; i < CACHE_TILES; i++) {
+			_tiles[i].valid = false;
+		}
+	}
+
+	/* replace an empty or the least recently used tile */
+	Tile *tile = &_tiles[0];
+
+	for (unsigned i = 1; i < CACHE_TILES && tile->valid; i++) {
+		if (!_tiles[i].valid || _tiles[i].last_used < tile->last_used) {
+			tile = &_tiles[i];
+		}
+	}
+
+	/* the cell containing the position, the rows start in the north */
+	const unsigned cells = _file_samples - 1;
+	unsigned col = (unsigned)((lon - square_lon) * cells);
+	unsigned row = (unsigned)((square_lat + 1 - lat) * cells);
+	col = (col < cells) ? col - col % TILE_CELLS : cells - TILE_CELLS;
+	row = (row < cells) ? row - row % TILE_CELLS : cells - TILE_CELLS;
+
+	tile->valid = false;
+	tile->spacing = 1.0 / cells;
+	tile->lat_north = square_lat + 1 - row * tile->spacing;
+	tile->lon_west = square_lon + col * tile->spacing;
+	tile->last_used = ++_lookups;
+
+	_loads++;
+
+	for (unsigned r = 0; r < TILE_SAMPLES; r++) {
+		uint8_t buf[TILE_SAMPLES * 2];
+
+		if (fseek(_file, ((row + r) * _file_samples + col) * 2, SEEK_SET) != 0 ||
+		    fread(buf, sizeof(buf), 1, _file) != 1) {
+			_load_errors++;
+			return nullptr;
+		}
+
+		for (unsigned c = 0; c < TILE_SAMPLES; c++) {
+			tile->height[r][c] = (int16_t)((buf[2 * c] << 8) | buf[2 * c + 1]);
+		}
+	}
+
+	tile->valid = true;
+
+	return tile;
+}
+
+bool
+TerrainCache::open_square(int lat, int lon)
+{
+	if (_file != nullptr && lat == _file_lat && lon == _file_lon) {
+		return true;
+	}
+
+	if (_missing_valid && lat == _missing_lat && lon == _missing_lon) {
+		return false;
+	}
+
+	if (_file != nullptr) {
+		fclose(_file);
+		_file = nullptr;
+	}
+
+	char path[64];
+	snprintf(path, sizeof(path), "%s/%c%02d%c%03d.hgt", _directory,
+		 (lat < 0) ? 'S' : 'N', abs(lat), (lon < 0) ? 'W' : 'E', abs(lon));
+
+	_file = fopen(path, "r");
+
+	if (_file != nullptr && fseek(_file, 0, SEEK_END) == 0) {
+		/* SRTM1 and SRTM3 files only differ in the number of samples */
+		long size = ftell(_file);
+		unsigned samples = (unsigned)(sqrtf(size / 2) + 0.5f);
+
+		if ((long)(samples * samples * 2) == size && samples > TILE_SAMPLES && (samples - 1) % TILE_CELLS == 0) {
+			_file_lat = lat;
+			_file_lon = lon;
+			_file_samples = samples;
+			return true;
+		}
+
+		warnx("terrain: %s has an unsupported size", path);
+	}
+
+	if (_file != nullptr) {
+		fclose(_file);
+		_file = nullptr;
+	}
+
+	/* do not try to open it again for every lookup */
+	_missing_valid = true;
+	_missing_lat = lat;
+	_missing_lon = lon;
+
+	return false;
+}
@@ -0,0 +1,147 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file terrain_cache.h
+ *
+ * Cache of terrain heights around the vehicle, read in small tiles from
+ * SRTM height files on the SD card.
+ */
+
+#ifndef TERRAIN_CACHE_H_
+#define TERRAIN_CACHE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <px4_defines.h>
+
+#define TERRAIN_DIRECTORY PX4_ROOTFSDIR"/fs/microsd/terrain"
+
+/**
+ * Terrain heights from the SRTM .hgt files (N47E008.hgt covers 47..48 N,
+ * 8..9 E, 1201 or 3601 rows of big endian heights in meters AMSL from the
+ * north). The files share their edges, the northern and eastern ones are
+ * looked up in the next squares.
+ *
+ * A file is never loaded as a whole: the cache keeps a few tiles of 16x16
+ * cells, read on demand and evicted least recently used. The tiles overlap
+ * by one sample, so a bilinear lookup always finds its four samples in a
+ * single tile.
+ */
+class TerrainCache
+{
+public:
+	TerrainCache(const char *directory = TERRAIN_DIRECTORY);
+	~TerrainCache();
+
+	/**
+	 * Get the terrain height at a position, loads the tile on a miss
+	 *
+	 * @param height	bilinear interpolated terrain height in meters AMSL
+	 * @return		false if there is no terrain data for the position
+	 */
+	bool		get_height(double lat, double lon, float &height);
+
+	/**
+	 * Get the highest terrain along a straight path
+	 *
+	 * The path is sampled at about the spacing of the terrain data, with
+	 * at most TERRAIN_PATH_SAMPLES samples.
+	 *
+	 * @return		false if the terrain is not known along the whole path
+	 */
+	bool		get_max_height_on_path(double lat_start, double lon_start, double lat_end, double lon_end,
+					       float &max_height);
+
+	/**
+	 * Load one missing tile of the ones at and around a position
+	 *
+	 * Meant to be called periodically with the vehicle position, so the
+	 * tiles are loaded ahead of the lookups, one small read at a time.
+	 */
+	void		prefetch(double lat, double lon);
+
+	void		print_status();
+
+	static const unsigned TILE_CELLS = 16;
+	static const unsigned TILE_SAMPLES = TILE_CELLS + 1;
+	static const unsigned CACHE_TILES = 8;
+	static const unsigned TERRAIN_PATH_SAMPLES = 64;
+
+private:
+	struct Tile {
+		double		lat_north;	/**< latitude of the first row */
+		double		lon_west;	/**< longitude of the first column */
+		double		spacing;	/**< sample spacing in degrees */
+		uint32_t	last_used;
+		bool		valid;
+		int16_t		height[TILE_SAMPLES][TILE_SAMPLES];
+	};
+
+	const char	*_directory;
+	Tile		*_tiles;		/**< allocated on first use */
+	uint32_t	_lookups;
+
+	/* the height file of the last square read from */
+	FILE		*_file;
+	int		_file_lat;
+	int		_file_lon;
+	unsigned	_file_samples;
+
+	/* the last square without a usable height file, is not retried */
+	bool		_missing_valid;
+	int		_missing_lat;
+	int		_missing_lon;
+
+	unsigned	_loads;
+	unsigned	_load_errors;
+
+	/**
+	 * Find the cached tile containing a position and the position in cells in it
+	 */
+	Tile		*find_tile(double lat, double lon, double &x, double &y);
+
+	/**
+	 * Read the tile containing a position from the SD card into the least recently used slot
+	 */
+	Tile		*load_tile(double lat, double lon);
+
+	bool		open_square(int lat, int lon);
+
+	/* this class has ptr data members, so it should not be copied,
+	 * consequently the copy constructors are private.
+	 */
+	TerrainCache(const TerrainCache &);
+	TerrainCache operator=(const TerrainCache &);
+};
+
+#endif /* TERRAIN_CACHE_H_ */
@@ -78,12 +78,26 @@
 
 #define MIN_VALID_W 0.00001f
 #define PUB_INTERVAL 10000	// limit publish rate to 100 Hz
+#define PREDICT_INTERVAL 4	// limit prediction rate to 250 Hz, in ms
+#define SLOW_TOPICS_INTERVAL 100000	// check rarely changing topics at 10 Hz
 #define EST_BUF_SIZE 250000 / PUB_INTERVAL		// buffer size is 0.5s
 
 static bool thread_should_exit = false; /**< Deamon exit flag */
 static bool thread_running = false; /**< Deamon status flag */
 static int position_estimator_inav_task; /**< Handle of deamon task / thread */
 static bool inav_verbose_mode = false;
+static char inav_snapshot_path[64] = "";	/**< Initialization snapshot file, empty if not used */
+
+/**
+ * Initialization state saved once the estimator is initialized and restored on the next
+ * start, so a simulator run at the same place skips the baro averaging and the GPS wait.
+ */
+struct inav_snapshot_s {
+	uint32_t magic;
+	float baro_offset;
+};
+
+#define INAV_SNAPSHOT_MAGIC 0x494e5631
 
 static const hrt_abstime vision_topic_timeout = 500000;	// Vision topic timeout = 0.5s
 static const hrt_abstime mocap_topic_timeout = 500000;		// Mocap topic timeout = 0.5s
@@ -100,6 +114,10 @@ int position_estimator_inav_thread_main(int argc, char *argv[]);
 
 static void usage(const char *reason);
 
+static bool snapshot_read(float *baro_offset);
+
+static void snapshot_write(float baro_offset);
+
 static inline int min(int val1, int val2)
 {
 	return (val1 < val2) ? val1 : val2;
@@ -119,10 +137,47 @@ static void usage(const char *reason)
 		PX4_INFO("%s\n", reason);
 	}
 
-	PX4_INFO("usage: position_estimator_inav {start|stop|status} [-v]\n\n");
+	PX4_INFO("usage: position_estimator_inav {start|stop|status} [-v] [-s <snapshot file>]\n\n");
 	return;
 }
 
+static bool snapshot_read(float *baro_offset)
+{
+	struct inav_snapshot_s snapshot;
+	int fd = open(inav_snapshot_path, O_RDONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	bool valid = read(fd, &snapshot, sizeof(snapshot)) == sizeof(snapshot) &&
+		     snapshot.magic == INAV_SNAPSHOT_MAGIC && PX4_ISFINITE(snapshot.baro_offset);
+	close(fd);
+
+	if (valid) {
+		*baro_offset = snapshot.baro_offset;
+	}
+
+	return valid;
+}
+
+static void snapshot_write(float baro_offset)
+{
+	struct inav_snapshot_s snapshot = { .magic = INAV_SNAPSHOT_MAGIC, .baro_offset = baro_offset };
+	int fd = open(inav_snapshot_path, O_WRONLY | O_CREAT | O_TRUNC, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		warnx("could not write snapshot %s", inav_snapshot_path);
+		return;
+	}
+
+	if (write(fd, &snapshot, sizeof(snapshot)) != sizeof(snapshot)) {
+		warnx("could not write snapshot %s", inav_snapshot_path);
+	}
+
+	close(fd);
+}
+
 /**
  * The position_estimator_inav_thread only briefly exists to start
  * the background job. The stack size assigned in the
@@ -145,9 +200,16 @@ int position_estimator_inav_main(int argc, char *argv[])
 		}
 
 		inav_verbose_mode = false;
+		inav_snapshot_path[0] = '\0';
 
-		if ((argc > 2) && (!strcmp(argv[2], "-v"))) {
-			inav_verbose_mode = true;
+		for (int i = 2; i < argc; i++) {
+			if (!strcmp(argv[i], "-v")) {
+				inav_verbose_mode = true;
+
+			} else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+				strncpy(inav_snapshot_path, argv[++i], sizeof(inav_snapshot_path) - 1);
+				inav_snapshot_path[sizeof(inav_snapshot_path) - 1] = '\0';
+			}
 		}
 
 		thread_should_exit = false;
@@ -283,6 +345,7 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 
 	hrt_abstime updates_counter_start = hrt_absolute_time();
 	hrt_abstime pub_last = hrt_absolute_time();
+	hrt_abstime slow_topics_last = 0;
 
 	hrt_abstime t_prev = 0;
 
@@ -383,8 +446,15 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 		{ .fd = sensor_combined_sub, .events = POLLIN },
 	};
 
-	/* wait for initial baro value */
-	bool wait_baro = true;
+	/* wait for initial baro value, unless a snapshot of the last initialization is restored */
+	bool snapshot_restored = inav_snapshot_path[0] != '\0' && snapshot_read(&baro_offset);
+	bool wait_baro = !snapshot_restored;
+
+	if (snapshot_restored) {
+		warnx("baro offset: %d m (snapshot)", (int)baro_offset);
+		local_pos.z_valid = true;
+		local_pos.v_z_valid = true;
+	}
 
 	thread_running = true;
 
@@ -427,6 +497,9 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 		{ .fd = vehicle_attitude_sub, .events = POLLIN },
 	};
 
+	/* the filter steps on attitude updates, don't follow a faster attitude estimator */
+	orb_set_interval(vehicle_attitude_sub, PREDICT_INTERVAL);
+
 	while (!thread_should_exit) {
 		int ret = px4_poll(fds, 1, 20); // wait maximal 20 ms = 50 Hz minimum rate
 		hrt_abstime t = hrt_absolute_time();
@@ -445,27 +518,34 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 
 			bool updated;
 
-			/* parameter update */
-			orb_check(parameter_update_sub, &updated);
+			/* topics which rarely change are not checked on every step */
+			bool check_slow_topics = (t > slow_topics_last + SLOW_TOPICS_INTERVAL);
 
-			if (updated) {
-				struct parameter_update_s update;
-				orb_copy(ORB_ID(parameter_update), parameter_update_sub, &update);
-				inav_parameters_update(&pos_inav_param_handles, &params);
-			}
+			if (check_slow_topics) {
+				slow_topics_last = t;
 
-			/* actuator */
-			orb_check(actuator_sub, &updated);
+				/* parameter update */
+				orb_check(parameter_update_sub, &updated);
 
-			if (updated) {
-				orb_copy(ORB_ID_VEHICLE_ATTITUDE_CONTROLS, actuator_sub, &actuator);
-			}
+				if (updated) {
+					struct parameter_update_s update;
+					orb_copy(ORB_ID(parameter_update), parameter_update_sub, &update);
+					inav_parameters_update(&pos_inav_param_handles, &params);
+				}
 
-			/* armed */
-			orb_check(armed_sub, &updated);
+				/* actuator */
+				orb_check(actuator_sub, &updated);
 
-			if (updated) {
-				orb_copy(ORB_ID(actuator_armed), armed_sub, &armed);
+				if (updated) {
+					orb_copy(ORB_ID_VEHICLE_ATTITUDE_CONTROLS, actuator_sub, &actuator);
+				}
+
+				/* armed */
+				orb_check(armed_sub, &updated);
+
+				if (updated) {
+					orb_copy(ORB_ID(actuator_armed), armed_sub, &armed);
+				}
 			}
 
 			/* sensor combined */
@@ -618,41 +698,43 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 			}
 
 			/* home position */
-			orb_check(home_position_sub, &updated);
+			if (check_slow_topics) {
+				orb_check(home_position_sub, &updated);
 
-			if (updated) {
-				orb_copy(ORB_ID(home_position), home_position_sub, &home);
+				if (updated) {
+					orb_copy(ORB_ID(home_position), home_position_sub, &home);
 
-				if (home.timestamp != home_timestamp) {
-					home_timestamp = home.timestamp;
+					if (home.timestamp != home_timestamp) {
+						home_timestamp = home.timestamp;
 
-					double est_lat, est_lon;
-					float est_alt;
+						double est_lat, est_lon;
+						float est_alt;
 
-					if (ref_inited) {
-						/* calculate current estimated position in global frame */
-						est_alt = local_pos.ref_alt - local_pos.z;
-						map_projection_reproject(&ref, local_pos.x, local_pos.y, &est_lat, &est_lon);
-					}
+						if (ref_inited) {
+							/* calculate current estimated position in global frame */
+							est_alt = local_pos.ref_alt - local_pos.z;
+							map_projection_reproject(&ref, local_pos.x, local_pos.y, &est_lat, &est_lon);
+						}
 
-					/* update reference */
-					map_projection_init(&ref, home.lat, home.lon);
+						/* update reference */
+						map_projection_init(&ref, home.lat, home.lon);
 
-					/* update baro offset */
-					baro_offset += home.alt - local_pos.ref_alt;
+						/* update baro offset */
+						baro_offset += home.alt - local_pos.ref_alt;
 
-					local_pos.ref_lat = home.lat;
-					local_pos.ref_lon = home.lon;
-					local_pos.ref_alt = home.alt;
-					local_pos.ref_timestamp = home.timestamp;
+						local_pos.ref_lat = home.lat;
+						local_pos.ref_lon = home.lon;
+						local_pos.ref_alt = home.alt;
+						local_pos.ref_timestamp = home.timestamp;
 
-					if (ref_inited) {
-						/* reproject position estimate with new reference */
-						map_projection_project(&ref, est_lat, est_lon, &x_est[0], &y_est[0]);
-						z_est[0] = -(est_alt - local_pos.ref_alt);
-					}
+						if (ref_inited) {
+							/* reproject position estimate with new reference */
+							map_projection_project(&ref, est_lat, est_lon, &x_est[0], &y_est[0]);
+							z_est[0] = -(est_alt - local_pos.ref_alt);
+						}
 
-					ref_inited = true;
+						ref_inited = true;
+					}
 				}
 			}
 
@@ -785,7 +867,7 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 						if (ref_init_start == 0) {
 							ref_init_start = t;
 
-						} else if (t > ref_init_start + ref_init_delay) {
+						} else if (snapshot_restored || t > ref_init_start + ref_init_delay) {
 							ref_inited = true;
 
 							/* set position estimate to (0, 0, 0), use GPS velocity for XY */
@@ -804,13 +886,17 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 							// XXX replace this print
 							warnx("init ref: lat=%.7f, lon=%.7f, alt=%8.4f", (double)lat, (double)lon, (double)alt);
 							mavlink_log_info(mavlink_fd, "[inav] init ref: %.7f, %.7f, %8.4f", (double)lat, (double)lon, (double)alt);
+
+							if (inav_snapshot_path[0] != '\0' && !snapshot_restored) {
+								snapshot_write(baro_offset);
+							}
 						}
 					}
 
 					if (ref_inited) {
 						/* project GPS lat lon to plane */
 						float gps_proj[2];
-						map_projection_project(&ref, lat, lon, &(gps_proj[0]), &(gps_proj[1]));
+						map_projection_project_fast(&ref, lat, lon, &(gps_proj[0]), &(gps_proj[1]));
 
 						/* reset position estimate when GPS becomes good */
 						if (reset_est) {
@@ -972,16 +1058,18 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 			accel_bias_corr[2] -= corr_gps[2][1] * w_z_gps_v;
 		}
 
-		/* transform error vector from NED frame to body frame */
-		for (int i = 0; i < 3; i++) {
-			float c = 0.0f;
+		/* transform error vector from NED frame to body frame, only needed while there is a GPS correction */
+		if (use_gps_xy || use_gps_z) {
+			for (int i = 0; i < 3; i++) {
+				float c = 0.0f;
 
-			for (int j = 0; j < 3; j++) {
-				c += R_gps[j][i] * accel_bias_corr[j];
-			}
+				for (int j = 0; j < 3; j++) {
+					c += R_gps[j][i] * accel_bias_corr[j];
+				}
 
-			if (isfinite(c)) {
-				acc_bias[i] += c * params.w_acc_bias * dt;
+				if (isfinite(c)) {
+					acc_bias[i] += c * params.w_acc_bias * dt;
+				}
 			}
 		}
 
@@ -1012,16 +1100,18 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 			accel_bias_corr[2] -= corr_mocap[2][0] * w_mocap_p * w_mocap_p;
 		}
 
-		/* transform error vector from NED frame to body frame */
-		for (int i = 0; i < 3; i++) {
-			float c = 0.0f;
+		/* transform error vector from NED frame to body frame, only needed while there is a MOCAP correction */
+		if (use_mocap) {
+			for (int i = 0; i < 3; i++) {
+				float c = 0.0f;
 
-			for (int j = 0; j < 3; j++) {
-				c += PX4_R(att.R, j, i) * accel_bias_corr[j];
-			}
+				for (int j = 0; j < 3; j++) {
+					c += PX4_R(att.R, j, i) * accel_bias_corr[j];
+				}
 
-			if (isfinite(c)) {
-				acc_bias[i] += c * params.w_acc_bias * dt;
+				if (isfinite(c)) {
+					acc_bias[i] += c * params.w_acc_bias * dt;
+				}
 			}
 		}
 
@@ -1241,7 +1331,7 @@ int position_estimator_inav_thread_main(int argc, char *argv[])
 				global_pos.time_utc_usec = gps.time_utc_usec;
 
 				double est_lat, est_lon;
-				map_projection_reproject(&ref, local_pos.x, local_pos.y, &est_lat, &est_lon);
+				map_projection_reproject_fast(&ref, local_pos.x, local_pos.y, &est_lat, &est_lon);
 
 				global_pos.lat = est_lat;
 				global_pos.lon = est_lon;
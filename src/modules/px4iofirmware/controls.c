@@ -158,7 +158,7 @@ controls_init(void)
 	_dsm_fd = dsm_init("/dev/ttyS0");
 
 	/* S.bus input (USART3) */
-	sbus_init("/dev/ttyS2");
+	sbus_init();
 
 	/* default to a 1:1 input map, all enabled */
 	for (unsigned i = 0; i < PX4IO_RC_INPUT_CHANNELS; i++) {
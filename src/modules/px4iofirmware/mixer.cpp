@@ -62,7 +62,6 @@ extern "C" {
  * Maximum interval in us before FMU signal is considered lost
  */
 #define FMU_INPUT_DROP_LIMIT_US		500000
-#define NAN_VALUE	(0.0f/0.0f)
 
 /* current servo arm/disarm state */
 static bool mixer_servos_armed = false;
@@ -70,6 +69,7 @@ static bool should_arm = false;
 static bool should_arm_nothrottle = false;
 static bool should_always_enable_pwm = false;
 static volatile bool in_mixer = false;
+static uint64_t oneshot_fmu_data_time = 0;
 
 /* selected control values and count for mixing */
 enum mixer_source {
@@ -86,6 +86,11 @@ static int	mixer_callback(uintptr_t handle,
 			       uint8_t control_index,
 			       float &control);
 
+static int	mixer_callback_fixed(uintptr_t handle,
+				     uint8_t control_group,
+				     uint8_t control_index,
+				     int32_t &control);
+
 static MixerGroup mixer_group(mixer_callback, 0);
 
 /* Set the failsafe values of all mixed channels (based on zero throttle, controls centered) */
@@ -233,28 +238,34 @@ mixer_tick(void)
 
 	} else if (source != MIX_NONE && (r_status_flags & PX4IO_P_STATUS_FLAGS_MIXER_OK)) {
 
+		int32_t	outputs_fixed[PX4IO_SERVO_COUNT];
 		float	outputs[PX4IO_SERVO_COUNT];
 		unsigned mixed;
 
-		/* mix */
+		/* mix, in fixed point as there is no FPU */
 
 		/* poor mans mutex */
 		in_mixer = true;
-		mixed = mixer_group.mix(&outputs[0], PX4IO_SERVO_COUNT, &r_mixer_limits);
+		mixed = mixer_group.mix_fixed(&outputs_fixed[0], PX4IO_SERVO_COUNT, &r_mixer_limits, mixer_callback_fixed);
 		in_mixer = false;
 
+		for (unsigned i = 0; i < mixed; i++) {
+			outputs[i] = Mixer::fixed_to_float(outputs_fixed[i]);
+		}
+
 		/* the pwm limit call takes care of out of band errors */
 		pwm_limit_calc(should_arm, should_arm_nothrottle, mixed, r_setup_pwm_reverse, r_page_servo_disarmed, r_page_servo_control_min, r_page_servo_control_max, outputs, r_page_servos, &pwm_limit);
 
 		/* clamp unused outputs to zero */
 		for (unsigned i = mixed; i < PX4IO_SERVO_COUNT; i++) {
 			r_page_servos[i] = 0;
-			outputs[i] = 0.0f;
+			outputs_fixed[i] = 0;
 		}
 
-		/* store normalized outputs */
+		/* store normalized outputs, already in register units */
 		for (unsigned i = 0; i < PX4IO_SERVO_COUNT; i++) {
-			r_page_actuators[i] = FLOAT_TO_REG(outputs[i]);
+			int32_t output = (outputs_fixed[i] == MIXER_FIXED_INVALID) ? 0 : outputs_fixed[i];
+			r_page_actuators[i] = SIGNED_TO_REG((int16_t)output);
 		}
 	}
 
@@ -310,6 +321,15 @@ mixer_tick(void)
 			sbus2_output(r_page_servo_disarmed, PX4IO_SERVO_COUNT);
 		}
 	}
+
+	/*
+	 * Oneshot outputs pulse once for each new set of FMU controls. Without
+	 * FMU input their timers keep running at the fallback rate.
+	 */
+	if (mixer_servos_armed && (system_state.fmu_data_received_time != oneshot_fmu_data_time)) {
+		oneshot_fmu_data_time = system_state.fmu_data_received_time;
+		up_pwm_update();
+	}
 }
 
 static int
@@ -317,6 +337,19 @@ mixer_callback(uintptr_t handle,
 	       uint8_t control_group,
 	       uint8_t control_index,
 	       float &control)
+{
+	int32_t value;
+	int ret = mixer_callback_fixed(handle, control_group, control_index, value);
+
+	control = Mixer::fixed_to_float(value);
+	return ret;
+}
+
+static int
+mixer_callback_fixed(uintptr_t handle,
+		     uint8_t control_group,
+		     uint8_t control_index,
+		     int32_t &control)
 {
 	if (control_group >= PX4IO_CONTROL_GROUPS) {
 		return -1;
@@ -325,14 +358,14 @@ mixer_callback(uintptr_t handle,
 	switch (source) {
 	case MIX_FMU:
 		if (control_index < PX4IO_CONTROL_CHANNELS && control_group < PX4IO_CONTROL_GROUPS ) {
-			control = REG_TO_FLOAT(r_page_controls[CONTROL_PAGE_INDEX(control_group, control_index)]);
+			control = REG_TO_SIGNED(r_page_controls[CONTROL_PAGE_INDEX(control_group, control_index)]);
 			break;
 		}
 		return -1;
 
 	case MIX_OVERRIDE:
 		if (r_page_rc_input[PX4IO_P_RC_VALID] & (1 << CONTROL_PAGE_INDEX(control_group, control_index))) {
-			control = REG_TO_FLOAT(r_page_rc_input[PX4IO_P_RC_BASE + control_index]);
+			control = REG_TO_SIGNED(r_page_rc_input[PX4IO_P_RC_BASE + control_index]);
 			break;
 		}
 		return -1;
@@ -340,17 +373,17 @@ mixer_callback(uintptr_t handle,
 	case MIX_OVERRIDE_FMU_OK:
 		/* FMU is ok but we are in override mode, use direct rc control for the available rc channels. The remaining channels are still controlled by the fmu */
 		if (r_page_rc_input[PX4IO_P_RC_VALID] & (1 << CONTROL_PAGE_INDEX(control_group, control_index))) {
-			control = REG_TO_FLOAT(r_page_rc_input[PX4IO_P_RC_BASE + control_index]);
+			control = REG_TO_SIGNED(r_page_rc_input[PX4IO_P_RC_BASE + control_index]);
 			break;
 		} else if (control_index < PX4IO_CONTROL_CHANNELS && control_group < PX4IO_CONTROL_GROUPS) {
-			control = REG_TO_FLOAT(r_page_controls[CONTROL_PAGE_INDEX(control_group, control_index)]);
+			control = REG_TO_SIGNED(r_page_controls[CONTROL_PAGE_INDEX(control_group, control_index)]);
 			break;
 		}
 		return -1;
 
 	case MIX_FAILSAFE:
 	case MIX_NONE:
-		control = 0.0f;
+		control = 0;
 		return -1;
 	}
 
@@ -358,23 +391,23 @@ mixer_callback(uintptr_t handle,
 	if (source == MIX_OVERRIDE || source == MIX_OVERRIDE_FMU_OK) {
 		if (control_group == actuator_controls_s::GROUP_INDEX_ATTITUDE &&
 			control_index == actuator_controls_s::INDEX_ROLL) {
-			control += REG_TO_FLOAT(r_setup_trim_roll);
+			control += REG_TO_SIGNED(r_setup_trim_roll);
 
 		} else if (control_group == actuator_controls_s::GROUP_INDEX_ATTITUDE &&
 			control_index == actuator_controls_s::INDEX_PITCH) {
-			control += REG_TO_FLOAT(r_setup_trim_pitch);
+			control += REG_TO_SIGNED(r_setup_trim_pitch);
 
 		} else if (control_group == actuator_controls_s::GROUP_INDEX_ATTITUDE &&
 			control_index == actuator_controls_s::INDEX_YAW) {
-			control += REG_TO_FLOAT(r_setup_trim_yaw);
+			control += REG_TO_SIGNED(r_setup_trim_yaw);
 		}
 	}
 
 	/* limit output */
-	if (control > 1.0f) {
-		control = 1.0f;
-	} else if (control < -1.0f) {
-		control = -1.0f;
+	if (control > MIXER_FIXED_ONE) {
+		control = MIXER_FIXED_ONE;
+	} else if (control < -MIXER_FIXED_ONE) {
+		control = -MIXER_FIXED_ONE;
 	}
 
 	/* motor spinup phase - lock throttle to zero */
@@ -384,7 +417,7 @@ mixer_callback(uintptr_t handle,
 			/* limit the throttle output to zero during motor spinup,
 			 * as the motors cannot follow any demand yet
 			 */
-			control = 0.0f;
+			control = 0;
 		}
 	}
 
@@ -393,7 +426,7 @@ mixer_callback(uintptr_t handle,
 		if (control_group == actuator_controls_s::GROUP_INDEX_ATTITUDE &&
 			control_index == actuator_controls_s::INDEX_THROTTLE) {
 			/* mark the throttle as invalid */
-			control = NAN_VALUE;
+			control = MIXER_FIXED_INVALID;
 		}
 	}
 
@@ -406,11 +439,11 @@ mixer_callback(uintptr_t handle,
  * not loaded faithfully.
  */
 
-static char mixer_text[256];		/* large enough for one mixer */
-static unsigned mixer_text_length = 0;
+static uint8_t mixer_data[128];		/* large enough for one precompiled mixer */
+static unsigned mixer_data_length = 0;
 
 int
-mixer_handle_text(const void *buffer, size_t length)
+mixer_handle_binary(const void *buffer, size_t length)
 {
 	/* do not allow a mixer change while safety off and FMU armed */
 	if ((r_status_flags & PX4IO_P_STATUS_FLAGS_SAFETY_OFF) &&
@@ -428,13 +461,13 @@ mixer_handle_text(const void *buffer, size_t length)
 
 	px4io_mixdata	*msg = (px4io_mixdata *)buffer;
 
-	isr_debug(2, "mix txt %u", length);
+	isr_debug(2, "mix bin %u", length);
 
 	if (length < sizeof(px4io_mixdata)) {
 		return 0;
 	}
 
-	unsigned text_length = length - sizeof(px4io_mixdata);
+	unsigned data_length = length - sizeof(px4io_mixdata);
 
 	switch (msg->action) {
 	case F2I_MIXER_ACTION_RESET:
@@ -442,30 +475,29 @@ mixer_handle_text(const void *buffer, size_t length)
 
 		/* THEN actually delete it */
 		mixer_group.reset();
-		mixer_text_length = 0;
+		mixer_data_length = 0;
 
 		/* FALLTHROUGH */
 	case F2I_MIXER_ACTION_APPEND:
 		isr_debug(2, "append %d", length);
 
 		/* check for overflow - this would be really fatal */
-		if ((mixer_text_length + text_length + 1) > sizeof(mixer_text)) {
+		if ((mixer_data_length + data_length) > sizeof(mixer_data)) {
 			r_status_flags &= ~PX4IO_P_STATUS_FLAGS_MIXER_OK;
 			return 0;
 		}
 
-		/* append mixer text and nul-terminate, guard against overflow */
-		memcpy(&mixer_text[mixer_text_length], msg->text, text_length);
-		mixer_text_length += text_length;
-		mixer_text[mixer_text_length] = '\0';
-		isr_debug(2, "buflen %u", mixer_text_length);
+		/* append the mixer data, guarded against overflow above */
+		memcpy(&mixer_data[mixer_data_length], msg->data, data_length);
+		mixer_data_length += data_length;
+		isr_debug(2, "buflen %u", mixer_data_length);
 
-		/* process the text buffer, adding new mixers as their descriptions can be parsed */
-		unsigned resid = mixer_text_length;
-		mixer_group.load_from_buf(&mixer_text[0], resid);
+		/* process the buffer, adding new mixers as their records are complete */
+		unsigned resid = mixer_data_length;
+		mixer_group.load_from_binary(&mixer_data[0], resid);
 
-		/* if anything was parsed */
-		if (resid != mixer_text_length) {
+		/* if anything was consumed */
+		if (resid != mixer_data_length) {
 
 			/* only set mixer ok if no residual is left over */
 			if (resid == 0) {
@@ -475,14 +507,14 @@ mixer_handle_text(const void *buffer, size_t length)
 				r_status_flags &= ~PX4IO_P_STATUS_FLAGS_MIXER_OK;
 			}
 
-			isr_debug(2, "used %u", mixer_text_length - resid);
+			isr_debug(2, "used %u", mixer_data_length - resid);
 
-			/* copy any leftover text to the base of the buffer for re-use */
+			/* copy any leftover data to the base of the buffer for re-use */
 			if (resid > 0) {
-				memcpy(&mixer_text[0], &mixer_text[mixer_text_length - resid], resid);
+				memmove(&mixer_data[0], &mixer_data[mixer_data_length - resid], resid);
 			}
 
-			mixer_text_length = resid;
+			mixer_data_length = resid;
 
 			/* update failsafe values */
 			mixer_set_failsafe();
@@ -25,6 +25,9 @@ SRCS		+= serial.c \
 		   ../systemlib/hx_stream.c
 endif
 
+# the IO has no FPU, mix in fixed point
+EXTRACXXFLAGS	= -DMIXER_FIXED_POINT
+
 SELF_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
 include $(SELF_DIR)../systemlib/mixer/multi_tables.mk
 	
\ No newline at end of file
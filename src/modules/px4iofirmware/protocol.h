@@ -76,7 +76,7 @@
 #define REG_TO_FLOAT(_reg)	((float)REG_TO_SIGNED(_reg) / 10000.0f)
 #define FLOAT_TO_REG(_float)	SIGNED_TO_REG((int16_t)((_float) * 10000.0f))
 
-#define PX4IO_PROTOCOL_VERSION		4
+#define PX4IO_PROTOCOL_VERSION		8
 
 /* maximum allowable sizes on this protocol version */
 #define PX4IO_PROTOCOL_MAX_CONTROL_COUNT	8	/**< The protocol does not support more than set here, individual units might support less - see PX4IO_P_CONFIG_CONTROL_COUNT */
@@ -172,6 +172,16 @@
 #define PX4IO_PAGE_PWM_INFO		7
 #define PX4IO_RATE_MAP_BASE			0	/* 0..CONFIG_ACTUATOR_COUNT bitmaps of PWM rate groups */
 
+/* status, servo outputs and raw R/C input gathered for the periodic poll, read in one transfer */
+#define PX4IO_PAGE_POLL			8
+#define PX4IO_P_POLL_STATUS			0	/* PX4IO_P_STATUS_FLAGS .. PX4IO_P_STATUS_MIXER of the status page */
+#define PX4IO_P_POLL_STATUS_COUNT		(PX4IO_P_STATUS_MIXER - PX4IO_P_STATUS_FLAGS + 1)
+#define PX4IO_P_POLL_SERVOS			(PX4IO_P_POLL_STATUS + PX4IO_P_POLL_STATUS_COUNT)	/* servo page */
+#define PX4IO_P_POLL_SERVO_COUNT		PX4IO_PROTOCOL_MAX_CONTROL_COUNT
+#define PX4IO_P_POLL_RAW_RC			(PX4IO_P_POLL_SERVOS + PX4IO_P_POLL_SERVO_COUNT)	/* raw R/C input page */
+#define PX4IO_P_POLL_RAW_RC_COUNT		(PX4IO_P_RAW_RC_BASE + 9)	/* prolog and the first 9 channels */
+#define PX4IO_P_POLL_COUNT			(PX4IO_P_POLL_RAW_RC + PX4IO_P_POLL_RAW_RC_COUNT)
+
 /* setup page */
 #define PX4IO_PAGE_SETUP		50
 #define PX4IO_P_SETUP_FEATURES			0
@@ -194,8 +204,8 @@
 #define PX4IO_P_SETUP_ARMING_OVERRIDE_IMMEDIATE	(1 << 10) /* If set then on FMU failure override is immediate. Othewise it waits for the mode switch to go past the override thrshold */
 
 #define PX4IO_P_SETUP_PWM_RATES			2	/* bitmask, 0 = low rate, 1 = high rate */
-#define PX4IO_P_SETUP_PWM_DEFAULTRATE		3	/* 'low' PWM frame output rate in Hz */
-#define PX4IO_P_SETUP_PWM_ALTRATE		4	/* 'high' PWM frame output rate in Hz */
+#define PX4IO_P_SETUP_PWM_DEFAULTRATE		3	/* 'low' PWM frame output rate in Hz, 0 for oneshot */
+#define PX4IO_P_SETUP_PWM_ALTRATE		4	/* 'high' PWM frame output rate in Hz, 0 for oneshot */
 
 #if defined(CONFIG_ARCH_BOARD_PX4IO_V1) || defined(CONFIG_ARCH_BOARD_PX4FMU_V1)
 #define PX4IO_P_SETUP_RELAYS			5	/* bitmask of relay/switch outputs, 0 = off, 1 = on */
@@ -237,6 +247,7 @@ enum {							/* DSM bind states */
 #define PX4IO_P_SETUP_TRIM_ROLL			16	/**< Roll trim, in actuator units */
 #define PX4IO_P_SETUP_TRIM_PITCH		17	/**< Pitch trim, in actuator units */
 #define PX4IO_P_SETUP_TRIM_YAW			18	/**< Yaw trim, in actuator units */
+#define PX4IO_P_SETUP_PWM_ONESHOT_PROTOCOL	19	/**< PWM_ONESHOT_PROTOCOL_* of the oneshot rate groups */
 
 /* autopilot control values, -10000..10000 */
 #define PX4IO_PAGE_CONTROLS			51	/**< actuator control groups, one after the other, 8 wide */
@@ -293,8 +304,9 @@ enum {							/* DSM bind states */
 /**
  * As-needed mixer data upload.
  *
- * This message adds text to the mixer text buffer; the text
- * buffer is drained as the definitions are consumed.
+ * This message adds precompiled mixers (see MixerGroup::load_from_binary)
+ * to the mixer buffer; the buffer is drained as the mixers are consumed.
+ * Zero bytes pad the message to an even length.
  */
 #pragma pack(push, 1)
 struct px4io_mixdata {
@@ -305,7 +317,7 @@ struct px4io_mixdata {
 #define F2I_MIXER_ACTION_RESET			0
 #define F2I_MIXER_ACTION_APPEND			1
 
-	char		text[0];	/* actual text size may vary */
+	uint8_t		data[0];	/* actual data size may vary */
 };
 #pragma pack(pop)
 
@@ -338,6 +350,10 @@ struct IOPacket {
 #define PKT_CODE(_p)	((_p).count_code & PKT_CODE_MASK)
 #define PKT_SIZE(_p)	((size_t)((uint8_t *)&((_p).regs[PKT_COUNT(_p)]) - ((uint8_t *)&(_p))))
 
+/* read requests are only the header, their count is the number of registers to read */
+#define PKT_REQUEST_COUNT(_p)	((PKT_CODE(_p) == PKT_CODE_READ) ? 0 : PKT_COUNT(_p))
+#define PKT_REQUEST_SIZE(_p)	((size_t)((uint8_t *)&((_p).regs[PKT_REQUEST_COUNT(_p)]) - ((uint8_t *)&(_p))))
+
 static const uint8_t crc8_tab[256] __attribute__((unused)) =
 {
 	0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
@@ -387,3 +403,17 @@ crc_packet(struct IOPacket *pkt)
 
 	return c;
 }
+
+static uint8_t crc_request(struct IOPacket *pkt) __attribute__((unused));
+static uint8_t
+crc_request(struct IOPacket *pkt)
+{
+	uint8_t *end = (uint8_t *)pkt + PKT_REQUEST_SIZE(*pkt);
+	uint8_t *p = (uint8_t *)pkt;
+	uint8_t c = 0;
+
+	while (p < end)
+		c = crc8_tab[c ^ *(p++)];
+
+	return c;
+}
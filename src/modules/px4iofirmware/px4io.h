@@ -116,6 +116,7 @@ extern uint16_t			r_page_servo_disarmed[];	/* PX4IO_PAGE_DISARMED_PWM */
 #define r_setup_trim_roll	r_page_setup[PX4IO_P_SETUP_TRIM_ROLL]
 #define r_setup_trim_pitch	r_page_setup[PX4IO_P_SETUP_TRIM_PITCH]
 #define r_setup_trim_yaw	r_page_setup[PX4IO_P_SETUP_TRIM_YAW]
+#define r_setup_pwm_oneshot_protocol	r_page_setup[PX4IO_P_SETUP_PWM_ONESHOT_PROTOCOL]
 
 #define r_control_values	(&r_page_controls[0])
 
@@ -189,7 +190,7 @@ extern pwm_limit_t pwm_limit;
  * Mixer
  */
 extern void	mixer_tick(void);
-extern int	mixer_handle_text(const void *buffer, size_t length);
+extern int	mixer_handle_binary(const void *buffer, size_t length);
 
 /**
  * Safety switch/LED.
@@ -225,7 +226,7 @@ extern void	controls_tick(void);
 extern int	dsm_init(const char *device);
 extern bool	dsm_input(uint16_t *values, uint16_t *num_values, uint8_t *n_bytes, uint8_t **bytes);
 extern void	dsm_bind(uint16_t cmd, int pulses);
-extern int	sbus_init(const char *device);
+extern int	sbus_init(void);
 extern bool	sbus_input(uint16_t *values, uint16_t *num_values, bool *sbus_failsafe, bool *sbus_frame_drop,
 			   uint16_t max_channels);
 extern void	sbus1_output(uint16_t *values, uint16_t num_values);
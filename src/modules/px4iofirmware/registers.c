@@ -53,6 +53,7 @@
 
 static int	registers_set_one(uint8_t page, uint8_t offset, uint16_t value);
 static void	pwm_configure_rates(uint16_t map, uint16_t defaultrate, uint16_t altrate);
+static void	registers_update_status(void);
 
 /**
  * PAGE 0
@@ -176,7 +177,8 @@ volatile uint16_t	r_page_setup[] =
 	[PX4IO_P_SETUP_PWM_REVERSE] = 0,
 	[PX4IO_P_SETUP_TRIM_ROLL] = 0,
 	[PX4IO_P_SETUP_TRIM_PITCH] = 0,
-	[PX4IO_P_SETUP_TRIM_YAW] = 0
+	[PX4IO_P_SETUP_TRIM_YAW] = 0,
+	[PX4IO_P_SETUP_PWM_ONESHOT_PROTOCOL] = PWM_ONESHOT_PROTOCOL_125
 };
 
 #ifdef CONFIG_ARCH_BOARD_PX4IO_V2
@@ -410,13 +412,13 @@ registers_set(uint8_t page, uint8_t offset, const uint16_t *values, unsigned num
 		}
 		break;
 
-		/* handle text going to the mixer parser */
+		/* handle precompiled mixers going to the mixer loader */
 	case PX4IO_PAGE_MIXERLOAD:
 		/* do not change the mixer if FMU is armed and IO's safety is off
 		 * this state defines an active system. This check is done in the
-		 * text handling function.
+		 * mixer handling function.
 		 */
-		return mixer_handle_text(values, num_values * sizeof(*values));
+		return mixer_handle_binary(values, num_values * sizeof(*values));
 
 	default:
 		/* avoid offset wrap */
@@ -548,7 +550,8 @@ registers_set_one(uint8_t page, uint8_t offset, uint16_t value)
 			break;
 
 		case PX4IO_P_SETUP_PWM_DEFAULTRATE:
-			if (value < 25) {
+			/* PWM_RATE_ONESHOT is 0 and passes */
+			if (value != PWM_RATE_ONESHOT && value < 25) {
 				value = 25;
 			}
 			if (value > 400) {
@@ -558,7 +561,8 @@ registers_set_one(uint8_t page, uint8_t offset, uint16_t value)
 			break;
 
 		case PX4IO_P_SETUP_PWM_ALTRATE:
-			if (value < 25) {
+			/* PWM_RATE_ONESHOT is 0 and passes */
+			if (value != PWM_RATE_ONESHOT && value < 25) {
 				value = 25;
 			}
 			if (value > 400) {
@@ -636,6 +640,14 @@ registers_set_one(uint8_t page, uint8_t offset, uint16_t value)
 			r_page_setup[offset] = value;
 			break;
 
+		case PX4IO_P_SETUP_PWM_ONESHOT_PROTOCOL:
+			if (up_pwm_servo_set_oneshot_protocol(value) != OK) {
+				r_status_alarms |= PX4IO_P_STATUS_ALARMS_PWM_ERROR;
+				break;
+			}
+			r_setup_pwm_oneshot_protocol = value;
+			break;
+
 		default:
 			return -1;
 		}
@@ -741,103 +753,125 @@ registers_set_one(uint8_t page, uint8_t offset, uint16_t value)
 	return 0;
 }
 
-uint8_t last_page;
-uint8_t last_offset;
-
-int
-registers_get(uint8_t page, uint8_t offset, uint16_t **values, unsigned *num_values)
+/*
+ * Update the status registers that are sampled at read time.
+ */
+static void
+registers_update_status(void)
 {
-#define SELECT_PAGE(_page_name)							\
-	do {									\
-		*values = (uint16_t *)&_page_name[0];				\
-		*num_values = sizeof(_page_name) / sizeof(_page_name[0]);	\
-	} while(0)
-
-	switch (page) {
-
-	/*
-	 * Handle pages that are updated dynamically at read time.
-	 */
-	case PX4IO_PAGE_STATUS:
-		/* PX4IO_P_STATUS_FREEMEM */
-		{
-			struct mallinfo minfo = mallinfo();
-			r_page_status[PX4IO_P_STATUS_FREEMEM] = minfo.fordblks;
-		}
+	/* PX4IO_P_STATUS_FREEMEM */
+	{
+		struct mallinfo minfo = mallinfo();
+		r_page_status[PX4IO_P_STATUS_FREEMEM] = minfo.fordblks;
+	}
 
-		/* XXX PX4IO_P_STATUS_CPULOAD */
+	/* XXX PX4IO_P_STATUS_CPULOAD */
 
-		/* PX4IO_P_STATUS_FLAGS maintained externally */
+	/* PX4IO_P_STATUS_FLAGS maintained externally */
 
-		/* PX4IO_P_STATUS_ALARMS maintained externally */
+	/* PX4IO_P_STATUS_ALARMS maintained externally */
 
 #ifdef ADC_VBATT
-		/* PX4IO_P_STATUS_VBATT */
-		{
-			/*
-			 * Coefficients here derived by measurement of the 5-16V
-			 * range on one unit, validated on sample points of another unit
-			 *
-			 * Data in Tools/tests-host/data folder.
-			 *
-			 * measured slope = 0.004585267878277 (int: 4585)
-			 * nominal theoretic slope: 0.00459340659 (int: 4593)
-			 * intercept = 0.016646394188076 (int: 16646)
-			 * nominal theoretic intercept: 0.00 (int: 0)
-			 *
-			 */
-			unsigned counts = adc_measure(ADC_VBATT);
-			if (counts != 0xffff) {
-				unsigned mV = (166460 + (counts * 45934)) / 10000;
-				unsigned corrected = (mV * r_page_setup[PX4IO_P_SETUP_VBATT_SCALE]) / 10000;
+	/* PX4IO_P_STATUS_VBATT */
+	{
+		/*
+		 * Coefficients here derived by measurement of the 5-16V
+		 * range on one unit, validated on sample points of another unit
+		 *
+		 * Data in Tools/tests-host/data folder.
+		 *
+		 * measured slope = 0.004585267878277 (int: 4585)
+		 * nominal theoretic slope: 0.00459340659 (int: 4593)
+		 * intercept = 0.016646394188076 (int: 16646)
+		 * nominal theoretic intercept: 0.00 (int: 0)
+		 *
+		 */
+		unsigned counts = adc_measure(ADC_VBATT);
+		if (counts != 0xffff) {
+			unsigned mV = (166460 + (counts * 45934)) / 10000;
+			unsigned corrected = (mV * r_page_setup[PX4IO_P_SETUP_VBATT_SCALE]) / 10000;
 
-				r_page_status[PX4IO_P_STATUS_VBATT] = corrected;
-			}
+			r_page_status[PX4IO_P_STATUS_VBATT] = corrected;
 		}
+	}
 #endif
 #ifdef ADC_IBATT
-		/* PX4IO_P_STATUS_IBATT */
-		{
-			/*
-			  note that we have no idea what sort of
-			  current sensor is attached, so we just
-			  return the raw 12 bit ADC value and let the
-			  FMU sort it out, with user selectable
-			  configuration for their sensor
-			 */
-			unsigned counts = adc_measure(ADC_IBATT);
-			if (counts != 0xffff) {
-				r_page_status[PX4IO_P_STATUS_IBATT] = counts;
-			}
+	/* PX4IO_P_STATUS_IBATT */
+	{
+		/*
+		  note that we have no idea what sort of
+		  current sensor is attached, so we just
+		  return the raw 12 bit ADC value and let the
+		  FMU sort it out, with user selectable
+		  configuration for their sensor
+		 */
+		unsigned counts = adc_measure(ADC_IBATT);
+		if (counts != 0xffff) {
+			r_page_status[PX4IO_P_STATUS_IBATT] = counts;
 		}
+	}
 #endif
 #ifdef ADC_VSERVO
-		/* PX4IO_P_STATUS_VSERVO */
-		{
-			unsigned counts = adc_measure(ADC_VSERVO);
-			if (counts != 0xffff) {
-				// use 3:1 scaling on 3.3V ADC input
-				unsigned mV = counts * 9900 / 4096;
-				r_page_status[PX4IO_P_STATUS_VSERVO] = mV;
-			}
+	/* PX4IO_P_STATUS_VSERVO */
+	{
+		unsigned counts = adc_measure(ADC_VSERVO);
+		if (counts != 0xffff) {
+			// use 3:1 scaling on 3.3V ADC input
+			unsigned mV = counts * 9900 / 4096;
+			r_page_status[PX4IO_P_STATUS_VSERVO] = mV;
 		}
+	}
 #endif
 #ifdef ADC_RSSI
-		/* PX4IO_P_STATUS_VRSSI */
-		{
-			unsigned counts = adc_measure(ADC_RSSI);
-			if (counts != 0xffff) {
-				// use 1:1 scaling on 3.3V ADC input
-				unsigned mV = counts * 3300 / 4096;
-				r_page_status[PX4IO_P_STATUS_VRSSI] = mV;
-			}
+	/* PX4IO_P_STATUS_VRSSI */
+	{
+		unsigned counts = adc_measure(ADC_RSSI);
+		if (counts != 0xffff) {
+			// use 1:1 scaling on 3.3V ADC input
+			unsigned mV = counts * 3300 / 4096;
+			r_page_status[PX4IO_P_STATUS_VRSSI] = mV;
 		}
+	}
 #endif
-		/* XXX PX4IO_P_STATUS_PRSSI */
+	/* XXX PX4IO_P_STATUS_PRSSI */
+}
+
+uint8_t last_page;
+uint8_t last_offset;
 
+int
+registers_get(uint8_t page, uint8_t offset, uint16_t **values, unsigned *num_values)
+{
+#define SELECT_PAGE(_page_name)							\
+	do {									\
+		*values = (uint16_t *)&_page_name[0];				\
+		*num_values = sizeof(_page_name) / sizeof(_page_name[0]);	\
+	} while(0)
+
+	switch (page) {
+
+	/*
+	 * Handle pages that are updated dynamically at read time.
+	 */
+	case PX4IO_PAGE_STATUS:
+		registers_update_status();
 		SELECT_PAGE(r_page_status);
 		break;
 
+	case PX4IO_PAGE_POLL:
+		/* one snapshot of everything the FMU polls periodically */
+		registers_update_status();
+		memset(r_page_scratch, 0, sizeof(r_page_scratch));
+		memcpy(&r_page_scratch[PX4IO_P_POLL_STATUS], &r_page_status[PX4IO_P_STATUS_FLAGS],
+		       PX4IO_P_POLL_STATUS_COUNT * sizeof(uint16_t));
+		memcpy(&r_page_scratch[PX4IO_P_POLL_SERVOS], &r_page_servos[0],
+		       ((PX4IO_SERVO_COUNT < PX4IO_P_POLL_SERVO_COUNT) ? PX4IO_SERVO_COUNT : PX4IO_P_POLL_SERVO_COUNT) * sizeof(uint16_t));
+		memcpy(&r_page_scratch[PX4IO_P_POLL_RAW_RC], &r_page_raw_rc_input[PX4IO_P_RAW_RC_COUNT],
+		       PX4IO_P_POLL_RAW_RC_COUNT * sizeof(uint16_t));
+		*values = &r_page_scratch[0];
+		*num_values = PX4IO_P_POLL_COUNT;
+		break;
+
 	case PX4IO_PAGE_RAW_ADC_INPUT:
 		memset(r_page_scratch, 0, sizeof(r_page_scratch));
 #ifdef ADC_VBATT
@@ -959,10 +993,10 @@ pwm_configure_rates(uint16_t map, uint16_t defaultrate, uint16_t altrate)
 			} else {
 				/* set it - errors here are unexpected */
 				if (alt != 0) {
-					if (up_pwm_servo_set_rate_group_update(group, r_setup_pwm_altrate) != OK)
+					if (up_pwm_servo_set_rate_group_update(group, altrate) != OK)
 						r_status_alarms |= PX4IO_P_STATUS_ALARMS_PWM_ERROR;
 				} else {
-					if (up_pwm_servo_set_rate_group_update(group, r_setup_pwm_defaultrate) != OK)
+					if (up_pwm_servo_set_rate_group_update(group, defaultrate) != OK)
 						r_status_alarms |= PX4IO_P_STATUS_ALARMS_PWM_ERROR;
 				}
 			}
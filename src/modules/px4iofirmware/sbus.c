@@ -39,9 +39,16 @@
 
 #include <px4_config.h>
 
-#include <fcntl.h>
-#include <unistd.h>
-#include <termios.h>
+#include <string.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <arch/board/board.h>
+
+#include <chip.h>
+#include <up_internal.h>
+#include <up_arch.h>
+#include <stm32.h>
 
 #include <systemlib/ppm_decode.h>
 
@@ -58,6 +65,7 @@
 #define SBUS_FAILSAFE_BIT	3
 #define SBUS_FRAMELOST_BIT	2
 #define SBUS1_FRAME_DELAY	14000
+#define SBUS_BITRATE		100000
 
 /*
   Measured values with Futaba FX-30/R6108SB:
@@ -77,48 +85,154 @@
 #define SBUS_SCALE_FACTOR ((SBUS_TARGET_MAX - SBUS_TARGET_MIN) / (SBUS_RANGE_MAX - SBUS_RANGE_MIN))
 #define SBUS_SCALE_OFFSET (int)(SBUS_TARGET_MIN - (SBUS_SCALE_FACTOR * SBUS_RANGE_MIN + 0.5f))
 
-static int sbus_fd = -1;
+/* serial register accessors */
+#define REG(_x)		(*(volatile uint32_t *)(PX4IO_SBUS_SERIAL_BASE + _x))
+#define rSR		REG(STM32_USART_SR_OFFSET)
+#define rDR		REG(STM32_USART_DR_OFFSET)
+#define rBRR		REG(STM32_USART_BRR_OFFSET)
+#define rCR1		REG(STM32_USART_CR1_OFFSET)
+#define rCR2		REG(STM32_USART_CR2_OFFSET)
+#define rCR3		REG(STM32_USART_CR3_OFFSET)
 
-static hrt_abstime last_rx_time;
 static hrt_abstime last_frame_time;
 static hrt_abstime last_txframe_time = 0;
 
+/* frame handed to the decoder */
 static uint8_t	frame[SBUS_FRAME_SIZE];
 
-static unsigned partial_frame_count;
+/*
+ * The interrupt assembles the bytes between two idle lines and hands them
+ * over as a frame if there are exactly SBUS_FRAME_SIZE of them.
+ */
+static uint8_t	rx_buf[SBUS_FRAME_SIZE];
+static unsigned	rx_count;
+static bool	rx_error;
+static uint8_t	rx_frame[SBUS_FRAME_SIZE];
+static hrt_abstime rx_frame_time;
+static volatile bool rx_frame_ready;
+
+static uint8_t	tx_frame[SBUS_FRAME_SIZE];
+static const uint8_t *tx_next;
+static volatile unsigned tx_remaining;
 
 unsigned sbus_frame_drops;
 
+static int	sbus_interrupt(int irq, void *context);
+static void	sbus_send(const uint8_t *data, unsigned count);
+
 static bool sbus_decode(hrt_abstime frame_time, uint16_t *values, uint16_t *num_values, bool *sbus_failsafe,
 			bool *sbus_frame_drop, uint16_t max_channels);
 
 int
-sbus_init(const char *device)
+sbus_init(void)
+{
+	/* configure pins for serial use */
+	stm32_configgpio(PX4IO_SBUS_SERIAL_TX_GPIO);
+	stm32_configgpio(PX4IO_SBUS_SERIAL_RX_GPIO);
+
+	/* reset and configure the UART */
+	rCR1 = 0;
+	rCR2 = 0;
+	rCR3 = 0;
+
+	/* clear status/errors */
+	(void)rSR;
+	(void)rDR;
+
+	/* 100000bps */
+	uint32_t usartdiv32 = PX4IO_SBUS_SERIAL_CLOCK / (SBUS_BITRATE / 2);
+	uint32_t mantissa = usartdiv32 >> 5;
+	uint32_t fraction = (usartdiv32 - (mantissa << 5) + 1) >> 1;
+	rBRR = (mantissa << USART_BRR_MANT_SHIFT) | (fraction << USART_BRR_FRAC_SHIFT);
+
+	/* initialise the decoder */
+	rx_count = 0;
+	rx_error = false;
+	rx_frame_ready = false;
+	tx_remaining = 0;
+
+	/* connect our interrupt */
+	irq_attach(PX4IO_SBUS_SERIAL_VECTOR, sbus_interrupt);
+	up_enable_irq(PX4IO_SBUS_SERIAL_VECTOR);
+
+	/* even parity (9 bit words including the parity bit), two stop bits, receive and idle interrupts */
+	rCR2 = USART_CR2_STOP2;
+	rCR3 = USART_CR3_EIE;
+	rCR1 = USART_CR1_RE | USART_CR1_TE | USART_CR1_UE | USART_CR1_M | USART_CR1_PCE |
+	       USART_CR1_RXNEIE | USART_CR1_IDLEIE | USART_CR1_PEIE;
+
+	debug("S.Bus: ready");
+
+	return OK;
+}
+
+static int
+sbus_interrupt(int irq, void *context)
 {
-	if (sbus_fd < 0) {
-		sbus_fd = open(device, O_RDWR | O_NONBLOCK);
+	uint32_t sr = rSR;	/* get UART status register */
+
+	if (sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE | USART_SR_PE)) {
+		/* a byte of this frame is lost or damaged, drop it at the next idle line */
+		(void)rDR;
+		rx_error = true;
+
+	} else if (sr & USART_SR_RXNE) {
+		uint8_t c = rDR;
+
+		if (rx_count < SBUS_FRAME_SIZE) {
+			rx_buf[rx_count] = c;
+		}
+
+		rx_count++;
 	}
 
-	if (sbus_fd >= 0) {
-		struct termios t;
+	if (sr & USART_SR_IDLE) {
+		/* the SR read above and a DR read clear the idle flag */
+		(void)rDR;
 
-		/* 100000bps, even parity, two stop bits */
-		tcgetattr(sbus_fd, &t);
-		cfsetspeed(&t, 100000);
-		t.c_cflag |= (CSTOPB | PARENB);
-		tcsetattr(sbus_fd, TCSANOW, &t);
+		/*
+		 * The line going idle marks the end of a frame, frames are 7ms
+		 * apart and take ~3ms to transmit.
+		 */
+		if (rx_count == SBUS_FRAME_SIZE && !rx_error) {
+			memcpy(rx_frame, rx_buf, sizeof(rx_frame));
+			rx_frame_time = hrt_absolute_time();
+			rx_frame_ready = true;
 
-		/* initialise the decoder */
-		partial_frame_count = 0;
-		last_rx_time = hrt_absolute_time();
+		} else if (rx_count > 0) {
+			sbus_frame_drops++;
+		}
 
-		debug("S.Bus: ready");
+		rx_count = 0;
+		rx_error = false;
+	}
 
-	} else {
-		debug("S.Bus: open failed");
+	if ((sr & USART_SR_TXE) && (rCR1 & USART_CR1_TXEIE)) {
+		if (tx_remaining > 0) {
+			rDR = *tx_next++;
+			tx_remaining--;
+
+		} else {
+			rCR1 &= ~USART_CR1_TXEIE;
+		}
 	}
 
-	return sbus_fd;
+	return 0;
+}
+
+static void
+sbus_send(const uint8_t *data, unsigned count)
+{
+	/* don't interrupt a frame still being sent */
+	if (tx_remaining > 0) {
+		return;
+	}
+
+	irqstate_t flags = irqsave();
+	tx_next = data;
+	tx_remaining = count;
+	rCR1 |= USART_CR1_TXEIE;
+	irqrestore(flags);
 }
 
 void
@@ -131,9 +245,13 @@ sbus1_output(uint16_t *values, uint16_t num_values)
 
 	now = hrt_absolute_time();
 
-	if ((now - last_txframe_time) > SBUS1_FRAME_DELAY) {
+	/* the previous frame must be sent before the buffer is refilled */
+	if ((now - last_txframe_time) > SBUS1_FRAME_DELAY && tx_remaining == 0) {
 		last_txframe_time = now;
-		uint8_t	oframe[SBUS_FRAME_SIZE] = { 0x0f };
+		uint8_t	*oframe = tx_frame;
+
+		memset(tx_frame, 0, sizeof(tx_frame));
+		oframe[0] = 0x0f;
 
 		/* 16 is sbus number of servos/channels minus 2 single bit channels.
 		* currently ignoring single bit channels.  */
@@ -157,115 +275,38 @@ sbus1_output(uint16_t *values, uint16_t num_values)
 			offset += 11;
 		}
 
-		write(sbus_fd, oframe, SBUS_FRAME_SIZE);
+		sbus_send(oframe, SBUS_FRAME_SIZE);
 	}
 }
 void
 sbus2_output(uint16_t *values, uint16_t num_values)
 {
-	char b = 'B';
-	write(sbus_fd, &b, 1);
+	static const uint8_t b = 'B';
+	sbus_send(&b, 1);
 }
 
 bool
 sbus_input(uint16_t *values, uint16_t *num_values, bool *sbus_failsafe, bool *sbus_frame_drop, uint16_t max_channels)
 {
-	ssize_t		ret;
-	hrt_abstime	now;
-
 	/*
-	 * The S.bus protocol doesn't provide reliable framing,
-	 * so we detect frame boundaries by the inter-frame delay.
-	 *
-	 * The minimum frame spacing is 7ms; with 25 bytes at 100000bps
-	 * frame transmission time is ~2ms.
-	 *
-	 * We expect to only be called when bytes arrive for processing,
-	 * and if an interval of more than 3ms passes between calls,
-	 * the first byte we read will be the first byte of a frame.
-	 *
-	 * In the case where byte(s) are dropped from a frame, this also
-	 * provides a degree of protection. Of course, it would be better
-	 * if we didn't drop bytes...
+	 * Frames are assembled by the interrupt, so each complete frame is
+	 * decoded exactly once with the time its reception ended.
 	 */
-	now = hrt_absolute_time();
-
-	if ((now - last_rx_time) > 3000) {
-		if (partial_frame_count > 0) {
-			sbus_frame_drops++;
-			partial_frame_count = 0;
-		}
-	}
-
-	/*
-	 * Fetch bytes, but no more than we would need to complete
-	 * the current frame.
-	 */
-	ret = read(sbus_fd, &frame[partial_frame_count], SBUS_FRAME_SIZE - partial_frame_count);
-
-	/* if the read failed for any reason, just give up here */
-	if (ret < 1) {
+	if (!rx_frame_ready) {
 		return false;
 	}
 
-	last_rx_time = now;
+	hrt_abstime frame_time;
 
-	/*
-	 * Add bytes to the current frame
-	 */
-	partial_frame_count += ret;
+	irqstate_t flags = irqsave();
+	memcpy(frame, rx_frame, sizeof(frame));
+	frame_time = rx_frame_time;
+	rx_frame_ready = false;
+	irqrestore(flags);
 
-	/*
-	 * If we don't have a full frame, return
-	 */
-	if (partial_frame_count < SBUS_FRAME_SIZE) {
-		return false;
-	}
-
-	/*
-	 * Great, it looks like we might have a frame.  Go ahead and
-	 * decode it.
-	 */
-	partial_frame_count = 0;
-	return sbus_decode(now, values, num_values, sbus_failsafe, sbus_frame_drop, max_channels);
+	return sbus_decode(frame_time, values, num_values, sbus_failsafe, sbus_frame_drop, max_channels);
 }
 
-/*
- * S.bus decoder matrix.
- *
- * Each channel value can come from up to 3 input bytes. Each row in the
- * matrix describes up to three bytes, and each entry gives:
- *
- * - byte offset in the data portion of the frame
- * - right shift applied to the data byte
- * - mask for the data byte
- * - left shift applied to the result into the channel value
- */
-struct sbus_bit_pick {
-	uint8_t byte;
-	uint8_t rshift;
-	uint8_t mask;
-	uint8_t lshift;
-};
-static const struct sbus_bit_pick sbus_decoder[SBUS_INPUT_CHANNELS][3] = {
-	/*  0 */ { { 0, 0, 0xff, 0}, { 1, 0, 0x07, 8}, { 0, 0, 0x00,  0} },
-	/*  1 */ { { 1, 3, 0x1f, 0}, { 2, 0, 0x3f, 5}, { 0, 0, 0x00,  0} },
-	/*  2 */ { { 2, 6, 0x03, 0}, { 3, 0, 0xff, 2}, { 4, 0, 0x01, 10} },
-	/*  3 */ { { 4, 1, 0x7f, 0}, { 5, 0, 0x0f, 7}, { 0, 0, 0x00,  0} },
-	/*  4 */ { { 5, 4, 0x0f, 0}, { 6, 0, 0x7f, 4}, { 0, 0, 0x00,  0} },
-	/*  5 */ { { 6, 7, 0x01, 0}, { 7, 0, 0xff, 1}, { 8, 0, 0x03,  9} },
-	/*  6 */ { { 8, 2, 0x3f, 0}, { 9, 0, 0x1f, 6}, { 0, 0, 0x00,  0} },
-	/*  7 */ { { 9, 5, 0x07, 0}, {10, 0, 0xff, 3}, { 0, 0, 0x00,  0} },
-	/*  8 */ { {11, 0, 0xff, 0}, {12, 0, 0x07, 8}, { 0, 0, 0x00,  0} },
-	/*  9 */ { {12, 3, 0x1f, 0}, {13, 0, 0x3f, 5}, { 0, 0, 0x00,  0} },
-	/* 10 */ { {13, 6, 0x03, 0}, {14, 0, 0xff, 2}, {15, 0, 0x01, 10} },
-	/* 11 */ { {15, 1, 0x7f, 0}, {16, 0, 0x0f, 7}, { 0, 0, 0x00,  0} },
-	/* 12 */ { {16, 4, 0x0f, 0}, {17, 0, 0x7f, 4}, { 0, 0, 0x00,  0} },
-	/* 13 */ { {17, 7, 0x01, 0}, {18, 0, 0xff, 1}, {19, 0, 0x03,  9} },
-	/* 14 */ { {19, 2, 0x3f, 0}, {20, 0, 0x1f, 6}, { 0, 0, 0x00,  0} },
-	/* 15 */ { {20, 5, 0x07, 0}, {21, 0, 0xff, 3}, { 0, 0, 0x00,  0} }
-};
-
 static bool
 sbus_decode(hrt_abstime frame_time, uint16_t *values, uint16_t *num_values, bool *sbus_failsafe, bool *sbus_frame_drop,
 	    uint16_t max_values)
@@ -308,26 +349,27 @@ sbus_decode(hrt_abstime frame_time, uint16_t *values, uint16_t *num_values, bool
 	unsigned chancount = (max_values > SBUS_INPUT_CHANNELS) ?
 			     SBUS_INPUT_CHANNELS : max_values;
 
-	/* use the decoder matrix to extract channel data */
-	for (unsigned channel = 0; channel < chancount; channel++) {
-		unsigned value = 0;
-
-		for (unsigned pick = 0; pick < 3; pick++) {
-			const struct sbus_bit_pick *decode = &sbus_decoder[channel][pick];
-
-			if (decode->mask != 0) {
-				unsigned piece = frame[1 + decode->byte];
-				piece >>= decode->rshift;
-				piece &= decode->mask;
-				piece <<= decode->lshift;
-
-				value |= piece;
-			}
-		}
-
+	/*
+	 * Unpack the 11 bit channels, LSB first. Every 11 data bytes hold
+	 * 8 channels in the same layout.
+	 */
+	uint16_t raw[SBUS_INPUT_CHANNELS];
+	const uint8_t *data = &frame[1];
+
+	for (unsigned i = 0; i < SBUS_INPUT_CHANNELS; i += 8, data += 11) {
+		raw[i + 0] = (data[0] | data[1] << 8) & 0x07ff;
+		raw[i + 1] = (data[1] >> 3 | data[2] << 5) & 0x07ff;
+		raw[i + 2] = (data[2] >> 6 | data[3] << 2 | data[4] << 10) & 0x07ff;
+		raw[i + 3] = (data[4] >> 1 | data[5] << 7) & 0x07ff;
+		raw[i + 4] = (data[5] >> 4 | data[6] << 4) & 0x07ff;
+		raw[i + 5] = (data[6] >> 7 | data[7] << 1 | data[8] << 9) & 0x07ff;
+		raw[i + 6] = (data[8] >> 2 | data[9] << 6) & 0x07ff;
+		raw[i + 7] = (data[9] >> 5 | data[10] << 3) & 0x07ff;
+	}
 
+	for (unsigned channel = 0; channel < chancount; channel++) {
 		/* convert 0-2048 values to 1000-2000 ppm encoding in a not too sloppy fashion */
-		values[channel] = (uint16_t)(value * SBUS_SCALE_FACTOR + .5f) + SBUS_SCALE_OFFSET;
+		values[channel] = (uint16_t)(raw[channel] * SBUS_SCALE_FACTOR + .5f) + SBUS_SCALE_OFFSET;
 	}
 
 	/* decode switch channels if data fields are wide enough */
@@ -150,10 +150,10 @@ interface_init(void)
 static void
 rx_handle_packet(void)
 {
-	/* check packet CRC */
+	/* check request CRC */
 	uint8_t crc = dma_packet.crc;
 	dma_packet.crc = 0;
-	if (crc != crc_packet(&dma_packet)) {
+	if (crc != crc_request(&dma_packet)) {
 		perf_count(pc_crcerr);
 
 		/* send a CRC error reply */
@@ -288,7 +288,7 @@ serial_interrupt(int irq, void *context)
 		 * we have something that looks like a packet.
 		 */
 		unsigned length = sizeof(dma_packet) - stm32_dmaresidual(rx_dma);
-		if ((length < 1) || (length < PKT_SIZE(dma_packet))) {
+		if ((length < 1) || (length < PKT_REQUEST_SIZE(dma_packet))) {
 
 			/* it was too short - possibly truncated */
 			perf_count(pc_badidle);
@@ -50,6 +50,7 @@ int logbuffer_init(struct logbuffer_s *lb, int size)
 	lb->size  = size;
 	lb->write_ptr = 0;
 	lb->read_ptr = 0;
+	logbuffer_reset_stats(lb);
 	lb->data = malloc(lb->size);
 	return (lb->data == 0) ? PX4_ERROR : PX4_OK;
 }
@@ -73,7 +74,8 @@ int logbuffer_is_empty(struct logbuffer_s *lb)
 bool logbuffer_write(struct logbuffer_s *lb, void *ptr, int size)
 {
 	// bytes available to write
-	int available = lb->read_ptr - lb->write_ptr - 1;
+	int write_ptr = lb->write_ptr;
+	int available = lb->read_ptr - write_ptr - 1;
 
 	if (available < 0) {
 		available += lb->size;
@@ -81,16 +83,17 @@ bool logbuffer_write(struct logbuffer_s *lb, void *ptr, int size)
 
 	if (size > available) {
 		// buffer overflow
+		lb->dropped_bytes += size;
 		return false;
 	}
 
 	char *c = (char *) ptr;
-	int n = lb->size - lb->write_ptr;	// bytes to end of the buffer
+	int n = lb->size - write_ptr;	// bytes to end of the buffer
 
 	if (n < size) {
 		// message goes over end of the buffer
-		memcpy(&(lb->data[lb->write_ptr]), c, n);
-		lb->write_ptr = 0;
+		memcpy(&(lb->data[write_ptr]), c, n);
+		write_ptr = 0;
 
 	} else {
 		n = 0;
@@ -98,20 +101,34 @@ bool logbuffer_write(struct logbuffer_s *lb, void *ptr, int size)
 
 	// now: n = bytes already written
 	int p = size - n;	// number of bytes to write
-	memcpy(&(lb->data[lb->write_ptr]), &(c[n]), p);
-	lb->write_ptr = (lb->write_ptr + p) % lb->size;
+	memcpy(&(lb->data[write_ptr]), &(c[n]), p);
+
+	// publish the data before the pointer, the reader may look at it any time
+	__sync_synchronize();
+	lb->write_ptr = (write_ptr + p) % lb->size;
+
+	int count = logbuffer_count(lb);
+
+	if (count > lb->high_water) {
+		lb->high_water = count;
+	}
+
 	return true;
 }
 
 int logbuffer_get_ptr(struct logbuffer_s *lb, void **ptr, bool *is_part)
 {
 	// bytes available to read
-	int available = lb->write_ptr - lb->read_ptr;
+	int write_ptr = lb->write_ptr;
+	int available = write_ptr - lb->read_ptr;
 
 	if (available == 0) {
 		return 0;	// buffer is empty
 	}
 
+	// don't read data older than the write pointer we just saw
+	__sync_synchronize();
+
 	int n = 0;
 
 	if (available > 0) {
@@ -122,7 +139,7 @@ int logbuffer_get_ptr(struct logbuffer_s *lb, void **ptr, bool *is_part)
 	} else {
 		// read pointer is after write pointer, read bytes from read_ptr to end of the buffer
 		n = lb->size - lb->read_ptr;
-		*is_part = lb->write_ptr > 0;
+		*is_part = write_ptr > 0;
 	}
 
 	*ptr = &(lb->data[lb->read_ptr]);
@@ -131,5 +148,13 @@ int logbuffer_get_ptr(struct logbuffer_s *lb, void **ptr, bool *is_part)
 
 void logbuffer_mark_read(struct logbuffer_s *lb, int n)
 {
+	// done with the data before the writer may reuse it
+	__sync_synchronize();
 	lb->read_ptr = (lb->read_ptr + n) % lb->size;
 }
+
+void logbuffer_reset_stats(struct logbuffer_s *lb)
+{
+	lb->high_water = 0;
+	lb->dropped_bytes = 0;
+}
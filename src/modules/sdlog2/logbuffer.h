@@ -45,12 +45,23 @@
 
 #include <stdbool.h>
 
+/**
+ * Single producer, single consumer ring buffer.
+ *
+ * The logging loop is the only writer and the logwriter thread the only
+ * reader, so no lock is needed: each side only advances its own pointer,
+ * after the data it covers has been copied.
+ */
 struct logbuffer_s {
 	// pointers and size are in bytes
-	int write_ptr;
-	int read_ptr;
+	volatile int write_ptr;
+	volatile int read_ptr;
 	int size;
 	char *data;
+
+	// statistics, maintained by the writer
+	int high_water;			///< maximum number of bytes buffered
+	unsigned long dropped_bytes;	///< bytes of messages that did not fit
 };
 
 int logbuffer_init(struct logbuffer_s *lb, int size);
@@ -65,4 +76,6 @@ int logbuffer_get_ptr(struct logbuffer_s *lb, void **ptr, bool *is_part);
 
 void logbuffer_mark_read(struct logbuffer_s *lb, int n);
 
+void logbuffer_reset_stats(struct logbuffer_s *lb);
+
 #endif
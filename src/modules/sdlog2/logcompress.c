@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file logcompress.c
+ *
+ * Greedy single-probe LZ77 compressor emitting the LZ4 block format. It
+ * trades ratio for speed and a small footprint, the logged structs are
+ * repetitive enough for it to pay off.
+ */
+
+#include <string.h>
+
+#include "logcompress.h"
+
+#define HASH_BITS	10
+#define MIN_MATCH	4
+#define LAST_LITERALS	5	// LZ4: the last 5 bytes are always literals
+#define MF_LIMIT	12	// LZ4: the last match starts at least 12 bytes before the end
+
+static uint16_t match_table[1 << HASH_BITS];
+
+static inline uint32_t read32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline unsigned hash32(uint32_t v)
+{
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint8_t *put_length(uint8_t *op, int len)
+{
+	while (len >= 255) {
+		*op++ = 255;
+		len -= 255;
+	}
+
+	*op++ = len;
+	return op;
+}
+
+/**
+ * Emit one sequence: literals, then a match unless match_len is 0.
+ * @return end of output, or NULL if dst is too small
+ */
+static uint8_t *put_sequence(uint8_t *op, const uint8_t *oend, const uint8_t *literals, int lit_len,
+			     int offset, int match_len)
+{
+	int ml = match_len - MIN_MATCH;
+
+	// token, length bytes, literals, offset
+	if (op + 1 + lit_len / 255 + 1 + lit_len + 2 + ((match_len > 0) ? (ml / 255 + 1) : 0) > oend) {
+		return NULL;
+	}
+
+	uint8_t *token = op++;
+	*token = ((lit_len < 15) ? lit_len : 15) << 4;
+
+	if (lit_len >= 15) {
+		op = put_length(op, lit_len - 15);
+	}
+
+	memcpy(op, literals, lit_len);
+	op += lit_len;
+
+	if (match_len > 0) {
+		*op++ = offset & 0xff;
+		*op++ = offset >> 8;
+		*token |= (ml < 15) ? ml : 15;
+
+		if (ml >= 15) {
+			op = put_length(op, ml - 15);
+		}
+	}
+
+	return op;
+}
+
+int logcompress_block(const uint8_t *src, int src_len, uint8_t *dst, int dst_max)
+{
+	const uint8_t *oend = dst + dst_max;
+	uint8_t *op = dst;
+	int anchor = 0;
+	int ip = 0;
+
+	memset(match_table, 0, sizeof(match_table));
+
+	while (ip < src_len - MF_LIMIT) {
+		uint32_t seq = read32(&src[ip]);
+		unsigned h = hash32(seq);
+		int ref = match_table[h];
+		match_table[h] = ip;
+
+		if (ref >= ip || read32(&src[ref]) != seq) {
+			ip++;
+			continue;
+		}
+
+		int len = MIN_MATCH;
+
+		while (ip + len < src_len - LAST_LITERALS && src[ref + len] == src[ip + len]) {
+			len++;
+		}
+
+		op = put_sequence(op, oend, &src[anchor], ip - anchor, ip - ref, len);
+
+		if (op == NULL) {
+			return -1;
+		}
+
+		ip += len;
+		anchor = ip;
+	}
+
+	op = put_sequence(op, oend, &src[anchor], src_len - anchor, 0, 0);
+
+	return (op == NULL) ? -1 : (int)(op - dst);
+}
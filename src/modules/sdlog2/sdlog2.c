@@ -49,6 +49,7 @@
 #include <sys/stat.h>
 #include <sys/prctl.h>
 #include <sys/statfs.h>
+#include <dirent.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <unistd.h>
@@ -101,17 +102,25 @@
 #include <uORB/topics/vtol_vehicle_status.h>
 #include <uORB/topics/time_offset.h>
 #include <uORB/topics/mc_att_ctrl_status.h>
+#include <uORB/topics/perf_histogram.h>
+#include <uORB/topics/cpuload.h>
+#include <uORB/topics/task_stats.h>
+#include <uORB/topics/perf_stats.h>
+#include <uORB/topics/gps_dump.h>
+#include <uORB/topics/log_stream.h>
 
 #include <systemlib/systemlib.h>
 #include <systemlib/param/param.h>
 #include <systemlib/perf_counter.h>
 #include <systemlib/git_version.h>
 #include <systemlib/printload.h>
+#include <systemlib/boot_timing.h>
 #include <version/version.h>
 
 #include <mavlink/mavlink_log.h>
 
 #include "logbuffer.h"
+#include "logcompress.h"
 #include "sdlog2_format.h"
 #include "sdlog2_messages.h"
 
@@ -160,7 +169,56 @@ PARAM_DEFINE_INT32(SDLOG_EXT, -1);
  */
 PARAM_DEFINE_INT32(SDLOG_GPSTIME, 1);
 
+/**
+ * Compress the log.
+ *
+ * A value of -1 indicates the commandline argument
+ * should be obeyed. A value of 0 writes plain logs,
+ * a value of 1 compresses everything after the header
+ * in blocks (needs a decoder with ZBLK support). This
+ * parameter is only read out before logging starts
+ * (which commonly is before arming).
+ *
+ * @min -1
+ * @max  1
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_COMPRESS, -1);
+
+/**
+ * Preallocate the log file.
+ *
+ * Size in MiB allocated for a log file when it is opened,
+ * 0 disables it. The log is then written without synchronous
+ * IO in large aligned chunks and flushed once per second,
+ * and truncated to the logged size when it is closed. On
+ * file systems without truncation (NuttX FAT) nothing is
+ * allocated, only the writes change. This parameter is only
+ * read out before logging starts.
+ *
+ * @min 0
+ * @max 4096
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_PREALLOC, 0);
+
+/**
+ * Free space kept on the MicroSD by deleting old sessions.
+ *
+ * When less than this many MiB are free, the oldest numbered
+ * session directories (sessXXX) are deleted while logging is
+ * stopped, at startup and after each log. 0 disables it and
+ * never deletes logs. Sessions named by date (-t) and the
+ * current session are never deleted.
+ *
+ * @min 0
+ * @max 4096
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_ROTATE_MB, 0);
+
 #define LOGBUFFER_WRITE_AND_COUNT(_msg) if (logbuffer_write(&lb, &log_msg, LOG_PACKET_SIZE(_msg))) { \
+		log_index_add(log_msg.msg_type, LOG_PACKET_SIZE(_msg)); \
 		log_msgs_written++; \
 	} else { \
 		log_msgs_skipped++; \
@@ -175,23 +233,45 @@ static bool logwriter_should_exit = false;	/**< Logwriter thread exit flag */
 static const unsigned MAX_NO_LOGFOLDER = 999;	/**< Maximum number of log dirs */
 static const unsigned MAX_NO_LOGFILE = 999;		/**< Maximum number of log files */
 static const int LOG_BUFFER_SIZE_DEFAULT = 8192;
-static const int MAX_WRITE_CHUNK = 512;
-static const int MIN_BYTES_TO_WRITE = 512;
+static const int LOG_WRITE_BATCH = 4096;	/**< bytes per write, a multiple of the SD card sector size */
+static const hrt_abstime LOG_FSYNC_INTERVAL = 1000000;	/**< flush interval of preallocated logs */
+static const unsigned LOG_ROTATE_MAX_DIRS = 10;	/**< sessions deleted at most per rotation */
+static const hrt_abstime LOG_INDEX_INTERVAL = 1000000;	/**< initial time between log index entries */
 
 static bool _extended_logging = false;
 static bool _gpstime_only = false;
+static bool _compress = false;
+static bool _stream = false;
+static int32_t _prealloc_mb = 0;
+static int32_t _rotate_mb = 0;
+
+/* log_stream messages buffered for MAVLink, more than one write batch */
+#define LOG_STREAM_QUEUE_SIZE	20
+static orb_advert_t log_stream_pub = NULL;
+static uint16_t log_stream_id = 0;
 
 #define MOUNTPOINT PX4_ROOTFSDIR"/fs/microsd"
 static const char *mountpoint = MOUNTPOINT;
 static const char *log_root = MOUNTPOINT "/log";
+static const char *log_dir_index_path = MOUNTPOINT "/log/next_sess.txt";	/**< number of the next sessXXX dir */
+static const char *log_profile_default = MOUNTPOINT "/etc/logging/topics.txt";
 static int mavlink_fd = -1;
 struct logbuffer_s lb;
 
-/* mutex / condition to synchronize threads */
+/* mutex / condition to wake up the writer thread, the buffer itself is lock-free */
 static pthread_mutex_t logbuffer_mutex;
 static pthread_cond_t logbuffer_cond;
 
 static char log_dir[32];
+static unsigned log_file_number = 1;	/**< first candidate for the next logXXX file in log_dir */
+
+/* sparse index of the logged data, appended to plain logs when they are closed */
+#define LOG_INDEX_SIZE	128
+static struct log_LIDX_s log_index[LOG_INDEX_SIZE];	/**< offsets in the logged data, not yet in the file */
+static unsigned log_index_count = 0;
+static hrt_abstime log_index_interval = LOG_INDEX_INTERVAL;
+static uint32_t log_index_type_offset[256];	/**< first offset per message type, UINT32_MAX if none */
+static uint32_t log_data_offset = 0;		/**< bytes put into the log buffer since the start */
 
 /* statistics counters */
 static uint64_t start_time = 0;
@@ -220,6 +300,29 @@ static pthread_attr_t logwriter_attr;
 
 static perf_counter_t perf_write;
 
+/**
+ * Logging profile: per-topic rate limits, read from a text file with one
+ * "<topic name> <rate in Hz>" pair per line. uORB does the subsampling via
+ * orb_set_interval(), so skipped updates are never copied nor serialized.
+ * A rate of 0 disables the topic. Topics not listed are logged at the
+ * main loop rate, which also caps the listed rates.
+ */
+#define LOG_PROFILE_MAX_TOPICS	32
+
+struct log_profile_entry_s {
+	char topic[32];
+	float rate;
+};
+
+/** subscription handle of a topic disabled by the profile */
+#define LOG_TOPIC_DISABLED	-2
+
+static struct log_profile_entry_s log_profile[LOG_PROFILE_MAX_TOPICS];
+static unsigned log_profile_count = 0;
+
+static void log_profile_load(const char *path);
+static const struct log_profile_entry_s *log_profile_find(const char *topic);
+
 /**
  * Log buffer writing thread. Open and close file here.
  */
@@ -263,6 +366,13 @@ static void sdlog2_stop_log(void);
  */
 static int write_formats(int fd);
 
+/**
+ * Write a block of log data as ZBLK message, compressed into zbuf.
+ *
+ * @return number of bytes written to the file, or -1 on error
+ */
+static int write_compressed(int fd, uint8_t *zbuf, const void *data, int len);
+
 /**
  * Write version message to log file.
  */
@@ -273,6 +383,18 @@ static int write_version(int fd);
  */
 static int write_parameters(int fd);
 
+/**
+ * Write boot phase timing to the first log file after boot.
+ */
+static int write_boot_timing(int fd);
+
+/**
+ * Publish data just written to the log file as log_stream messages.
+ *
+ * @param offset		File offset of the data.
+ */
+static void publish_log_stream(unsigned long offset, const void *data, int len);
+
 static bool file_exist(const char *filename);
 
 static int file_copy(const char *file_old, const char *file_new);
@@ -282,6 +404,41 @@ static int file_copy(const char *file_old, const char *file_new);
  */
 static int check_free_space(void);
 
+/**
+ * Account for a message put into the log buffer in the log index
+ */
+static void log_index_add(uint8_t msg_type, unsigned size);
+
+/**
+ * Add a log index entry at the current offset if one is due at time t
+ */
+static void log_index_time(hrt_abstime t);
+
+/**
+ * Write the log index, with the data starting at data_start in the file
+ */
+static int write_log_index(int fd, uint32_t data_start);
+
+/**
+ * Read the number of the next session dir, 1 if unknown
+ */
+static unsigned log_dir_index_load(void);
+
+/**
+ * Persist the number of the next session dir
+ */
+static void log_dir_index_store(unsigned dir_number);
+
+/**
+ * Delete the oldest session dirs while the free space is below SDLOG_ROTATE_MB
+ */
+static void log_dir_rotate(void);
+
+/**
+ * Delete a session dir and the files in it
+ */
+static int remove_log_dir(const char *dir);
+
 static void handle_command(struct vehicle_command_s *cmd);
 
 static void handle_status(struct vehicle_status_s *cmd);
@@ -301,6 +458,13 @@ static bool get_log_time_utc_tt(struct tm *tt, bool boot_time);
  */
 static int open_log_file(void);
 
+/**
+ * Allocate the log file ahead of the writes.
+ *
+ * @return		bytes allocated, 0 if the file grows as it is written.
+ */
+static off_t preallocate_log_file(int fd);
+
 static int open_perf_file(const char* str);
 
 static void
@@ -310,13 +474,16 @@ sdlog2_usage(const char *reason)
 		fprintf(stderr, "%s\n", reason);
 	}
 
-	warnx("usage: sdlog2 {start|stop|status|on|off} [-r <log rate>] [-b <buffer size>] -e -a -t -x\n"
+	warnx("usage: sdlog2 {start|stop|status|on|off} [-r <log rate>] [-b <buffer size>] [-p <profile>] -e -a -t -x -z -s\n"
 		 "\t-r\tLog rate in Hz, 0 means unlimited rate\n"
-		 "\t-b\tLog buffer size in KiB, default is 8\n"
+		 "\t-b\tLog buffer size in KiB, rounded up to 4 KiB write batches, default is 8\n"
+		 "\t-p\tLogging profile with per-topic rates, default is " MOUNTPOINT "/etc/logging/topics.txt\n"
 		 "\t-e\tEnable logging by default (if not, can be started by command)\n"
 		 "\t-a\tLog only when armed (can be still overriden by command)\n"
 		 "\t-t\tUse date/time for naming log directories and files\n"
-		 "\t-x\tExtended logging");
+		 "\t-x\tExtended logging\n"
+		 "\t-z\tCompress the log data\n"
+		 "\t-s\tStream the log data after the header to MAVLink as it is written");
 }
 
 /**
@@ -436,12 +603,14 @@ bool get_log_time_utc_tt(struct tm *tt, bool boot_time) {
 int create_log_dir()
 {
 	/* create dir on sdcard if needed */
-	uint16_t dir_number = 1; // start with dir sess001
 	int mkdir_ret;
 
 	struct tm tt;
 	bool time_ok = get_log_time_utc_tt(&tt, true);
 
+	/* a new dir has no log files yet */
+	log_file_number = 1;
+
 	if (log_name_timestamp && time_ok) {
 		int n = snprintf(log_dir, sizeof(log_dir), "%s/", log_root);
 		strftime(log_dir + n, sizeof(log_dir) - n, "%Y-%m-%d", &tt);
@@ -453,8 +622,12 @@ int create_log_dir()
 		}
 
 	} else {
-		/* look for the next dir that does not exist */
-		while (dir_number <= MAX_NO_LOGFOLDER) {
+		/* start at the persisted index, the dir after the last one created */
+		unsigned dir_number = log_dir_index_load();
+		unsigned tries = 0;
+
+		/* look for the next dir that does not exist, wrapping around after MAX_NO_LOGFOLDER */
+		while (tries < MAX_NO_LOGFOLDER) {
 			/* format log dir: e.g. /fs/microsd/sess001 */
 			sprintf(log_dir, "%s/sess%03u", log_root, dir_number);
 			mkdir_ret = mkdir(log_dir, S_IRWXU | S_IRWXG | S_IRWXO);
@@ -469,15 +642,17 @@ int create_log_dir()
 			}
 
 			/* dir exists already */
-			dir_number++;
-			continue;
+			dir_number = (dir_number % MAX_NO_LOGFOLDER) + 1;
+			tries++;
 		}
 
-		if (dir_number >= MAX_NO_LOGFOLDER) {
+		if (tries >= MAX_NO_LOGFOLDER) {
 			/* we should not end up here, either we have more than MAX_NO_LOGFOLDER on the SD card, or another problem */
 			warnx("all %d possible dirs exist already", MAX_NO_LOGFOLDER);
 			return -1;
 		}
+
+		log_dir_index_store((dir_number % MAX_NO_LOGFOLDER) + 1);
 	}
 
 	/* print logging path, important to find log file later */
@@ -500,7 +675,8 @@ int open_log_file()
 		snprintf(log_file_path, sizeof(log_file_path), "%s/%s", log_dir, log_file_name);
 
 	} else {
-		uint16_t file_number = 1; // start with file log001
+		/* continue after the last file opened in this dir */
+		unsigned file_number = log_file_number;
 
 		/* look for the next file that does not exist */
 		while (file_number <= MAX_NO_LOGFILE) {
@@ -520,12 +696,17 @@ int open_log_file()
 			mavlink_and_console_log_critical(mavlink_fd, "[sdlog2] ERR: max files %d", MAX_NO_LOGFILE);
 			return -1;
 		}
+
+		log_file_number = file_number + 1;
 	}
 
+	/* preallocated logs are flushed periodically instead of on every write */
+	int flags = O_CREAT | O_WRONLY | ((_prealloc_mb > 0) ? 0 : O_DSYNC);
+
 #ifdef __PX4_NUTTX
-	int fd = open(log_file_path, O_CREAT | O_WRONLY | O_DSYNC);
+	int fd = open(log_file_path, flags);
 #else
-	int fd = open(log_file_path, O_CREAT | O_WRONLY | O_DSYNC, PX4_O_MODE_666);
+	int fd = open(log_file_path, flags, PX4_O_MODE_666);
 #endif
 
 	if (fd < 0) {
@@ -538,6 +719,27 @@ int open_log_file()
 	return fd;
 }
 
+off_t preallocate_log_file(int fd)
+{
+	if (_prealloc_mb <= 0) {
+		return 0;
+	}
+
+#ifdef __PX4_LINUX
+	off_t size = (off_t)_prealloc_mb * 1024 * 1024;
+
+	if (posix_fallocate(fd, 0, size) != 0) {
+		warnx("log file preallocation failed");
+		return 0;
+	}
+
+	return size;
+#else
+	/* the file could not be truncated to the logged size when it is closed */
+	return 0;
+#endif
+}
+
 int open_perf_file(const char* str)
 {
 	/* string to hold the path to the log */
@@ -601,90 +803,118 @@ static void *logwriter_thread(void *arg)
 
 	struct logbuffer_s *logbuf = (struct logbuffer_s *)arg;
 
-	/* write log messages formats, version and parameters */
+	off_t prealloc_size = preallocate_log_file(log_fd);
+	hrt_abstime last_fsync = hrt_absolute_time();
+
+	log_stream_id++;
+
+	/* write log messages formats, version, parameters and boot timing */
 	log_bytes_written += write_formats(log_fd);
 
 	log_bytes_written += write_version(log_fd);
 
 	log_bytes_written += write_parameters(log_fd);
 
+	log_bytes_written += write_boot_timing(log_fd);
+
+	/* the offsets in the index are relative to the data after the header */
+	uint32_t data_start = log_bytes_written;
+
 	fsync(log_fd);
 
-	int poll_count = 0;
+	/* output buffer for one compressed batch and its ZBLK header */
+	uint8_t *zbuf = NULL;
 
-	void *read_ptr;
+	if (_compress) {
+		zbuf = malloc(LOG_PACKET_SIZE(ZBLK) + LOG_WRITE_BATCH);
+
+		if (zbuf == NULL) {
+			warnx("no memory for compression, writing plain log");
+		}
+	}
 
-	int n = 0;
+	int poll_count = 0;
 
-	bool should_wait = false;
+	void *read_ptr;
 
 	bool is_part = false;
 
+	bool write_error = false;
+
 	while (true) {
-		/* make sure threads are synchronized */
+		/* sleep until a full batch is buffered, or whatever is left when stopping */
 		pthread_mutex_lock(&logbuffer_mutex);
 
-		/* update read pointer if needed */
-		if (n > 0) {
-			logbuffer_mark_read(&lb, n);
-		}
-
-		/* only wait if no data is available to process */
-		if (should_wait && !logwriter_should_exit) {
-			/* blocking wait for new data at this line */
+		while (logbuffer_count(logbuf) < LOG_WRITE_BATCH && !logwriter_should_exit && !main_thread_should_exit) {
 			pthread_cond_wait(&logbuffer_cond, &logbuffer_mutex);
 		}
 
-		/* only get pointer to thread-safe data, do heavy I/O a few lines down */
-		int available = logbuffer_get_ptr(logbuf, &read_ptr, &is_part);
-
-		/* continue */
 		pthread_mutex_unlock(&logbuffer_mutex);
 
+		/* this thread is the only reader, the buffer needs no lock to be drained */
+		int available = logbuffer_get_ptr(logbuf, &read_ptr, &is_part);
+
 		if (available > 0) {
 
 			/* do heavy IO here */
-			if (available > MAX_WRITE_CHUNK) {
-				n = MAX_WRITE_CHUNK;
+			int n = MIN(available, LOG_WRITE_BATCH);
 
-			} else {
-				n = available;
+			if (_prealloc_mb > 0 && zbuf == NULL && available >= LOG_WRITE_BATCH) {
+				/* write all whole batches, ending on a batch boundary of the file */
+				n = available - (int)((log_bytes_written + available) % LOG_WRITE_BATCH);
 			}
 
+			int written;
+
 			perf_begin(perf_write);
-			n = write(log_fd, read_ptr, n);
-			perf_end(perf_write);
 
-			should_wait = (n == available) && !is_part;
+			if (zbuf != NULL) {
+				/* the whole batch is consumed, even if it compresses to little */
+				written = write_compressed(log_fd, zbuf, read_ptr, n);
+
+			} else {
+				written = n = write(log_fd, read_ptr, n);
+			}
 
-			if (n < 0) {
+			perf_end(perf_write);
+
+			if (written < 0) {
 				main_thread_should_exit = true;
+				write_error = true;
 				warn("error writing log file");
 				break;
 			}
 
-			if (n > 0) {
-				log_bytes_written += n;
+			/* before the buffer space is released, the data is what went to the file */
+			if (_stream) {
+				publish_log_stream(log_bytes_written, (zbuf != NULL) ? (void *)zbuf : read_ptr, written);
 			}
 
-		} else {
-			n = 0;
+			logbuffer_mark_read(logbuf, n);
+			log_bytes_written += written;
 
+		} else {
 			/* exit only with empty buffer */
 			if (main_thread_should_exit || logwriter_should_exit) {
 				break;
 			}
-
-			should_wait = true;
 		}
 
-		if (++poll_count == 10) {
+		if (_prealloc_mb > 0) {
+			if (hrt_elapsed_time(&last_fsync) > LOG_FSYNC_INTERVAL) {
+				fsync(log_fd);
+				last_fsync = hrt_absolute_time();
+			}
+
+		} else if (++poll_count == 10) {
 			fsync(log_fd);
 			poll_count = 0;
 
 		}
 
-		if (log_bytes_written - last_checked_bytes_written > 20*1024*1024) {
+		/* the preallocated part of the file is already accounted for */
+		if ((off_t)log_bytes_written > prealloc_size &&
+		    log_bytes_written - last_checked_bytes_written > 20*1024*1024) {
 			/* check if space is available, if not stop everything */
 			if (check_free_space() != OK) {
 				logwriter_should_exit = true;
@@ -694,9 +924,25 @@ static void *logwriter_thread(void *arg)
 		}
 	}
 
+	/* compressed data can not be seeked into, it is not indexed */
+	if (!write_error && zbuf == NULL) {
+		log_bytes_written += write_log_index(log_fd, data_start);
+	}
+
+#ifdef __PX4_LINUX
+
+	/* drop the unused rest of the preallocation */
+	if (prealloc_size > 0 && ftruncate(log_fd, lseek(log_fd, 0, SEEK_CUR)) != 0) {
+		warn("truncating log file");
+	}
+
+#endif
+
 	fsync(log_fd);
 	close(log_fd);
 
+	free(zbuf);
+
 	return NULL;
 }
 
@@ -714,9 +960,14 @@ void sdlog2_start_log()
 
 	/* initialize statistics counter */
 	log_bytes_written = 0;
+	log_data_offset = 0;
+	log_index_count = 0;
+	log_index_interval = LOG_INDEX_INTERVAL;
+	memset(log_index_type_offset, 0xff, sizeof(log_index_type_offset));
 	start_time = hrt_absolute_time();
 	log_msgs_written = 0;
 	log_msgs_skipped = 0;
+	logbuffer_reset_stats(&lb);
 
 	/* initialize log buffer emptying thread */
 	pthread_attr_init(&logwriter_attr);
@@ -801,6 +1052,9 @@ void sdlog2_stop_log()
 	mavlink_and_console_log_info(mavlink_fd, "[sdlog2] logging stopped");
 
 	sdlog2_status();
+
+	/* the card is idle until the next log, clean up old sessions now */
+	log_dir_rotate();
 }
 
 int write_formats(int fd)
@@ -821,6 +1075,124 @@ int write_formats(int fd)
 		written += write(fd, &log_msg_format, sizeof(log_msg_format));
 	}
 
+	/* the presence of this format tells decoders the data after the header is compressed */
+	if (_compress) {
+		const struct log_format_s zblk_format = LOG_FORMAT(ZBLK, "HH", "Comp,Raw");
+		log_msg_format.body = zblk_format;
+		written += write(fd, &log_msg_format, sizeof(log_msg_format));
+	}
+
+	return written;
+}
+
+int write_compressed(int fd, uint8_t *zbuf, const void *data, int len)
+{
+	struct {
+		LOG_PACKET_HEADER;
+		struct log_ZBLK_s body;
+	} __attribute__((packed)) *zblk = (void *)zbuf;
+	uint8_t *payload = zbuf + sizeof(*zblk);
+
+	/* keep the data as it is if compression does not make it smaller */
+	int comp_len = logcompress_block(data, len, payload, len - 1);
+
+	if (comp_len < 0) {
+		memcpy(payload, data, len);
+		comp_len = len;
+	}
+
+	zblk->head1 = HEAD_BYTE1;
+	zblk->head2 = HEAD_BYTE2;
+	zblk->msg_type = LOG_ZBLK_MSG;
+	zblk->body.comp_len = comp_len;
+	zblk->body.raw_len = len;
+
+	int total = sizeof(*zblk) + comp_len;
+	return (write(fd, zbuf, total) == total) ? total : -1;
+}
+
+void log_index_add(uint8_t msg_type, unsigned size)
+{
+	if (log_index_type_offset[msg_type] == UINT32_MAX) {
+		log_index_type_offset[msg_type] = log_data_offset;
+	}
+
+	log_data_offset += size;
+}
+
+void log_index_time(hrt_abstime t)
+{
+	if (log_index_count > 0 && t < log_index[log_index_count - 1].t + log_index_interval) {
+		return;
+	}
+
+	if (log_index_count == LOG_INDEX_SIZE) {
+		/* full, keep every other entry and halve the rate for a bounded index of any log length */
+		for (unsigned i = 0; i < LOG_INDEX_SIZE / 2; i++) {
+			log_index[i] = log_index[2 * i];
+		}
+
+		log_index_count = LOG_INDEX_SIZE / 2;
+		log_index_interval *= 2;
+
+		if (t < log_index[log_index_count - 1].t + log_index_interval) {
+			return;
+		}
+	}
+
+	log_index[log_index_count].t = t;
+	log_index[log_index_count].offset = log_data_offset;
+	log_index_count++;
+}
+
+int write_log_index(int fd, uint32_t data_start)
+{
+	struct {
+		LOG_PACKET_HEADER;
+		struct log_LIDX_s body;
+	} log_msg_LIDX = {
+		LOG_PACKET_HEADER_INIT(LOG_LIDX_MSG),
+	};
+
+	struct {
+		LOG_PACKET_HEADER;
+		struct log_LTYP_s body;
+	} log_msg_LTYP = {
+		LOG_PACKET_HEADER_INIT(LOG_LTYP_MSG),
+	};
+
+	struct {
+		LOG_PACKET_HEADER;
+		struct log_LEND_s body;
+	} log_msg_LEND = {
+		LOG_PACKET_HEADER_INIT(LOG_LEND_MSG),
+	};
+
+	/* the index follows the data directly */
+	log_msg_LEND.body.offset = data_start + log_data_offset;
+	log_msg_LEND.body.time_entries = log_index_count;
+	log_msg_LEND.body.type_entries = 0;
+
+	int written = 0;
+
+	for (unsigned i = 0; i < log_index_count; i++) {
+		log_msg_LIDX.body.t = log_index[i].t;
+		log_msg_LIDX.body.offset = data_start + log_index[i].offset;
+		written += write(fd, &log_msg_LIDX, sizeof(log_msg_LIDX));
+	}
+
+	for (unsigned type = 0; type < sizeof(log_index_type_offset) / sizeof(log_index_type_offset[0]); type++) {
+		if (log_index_type_offset[type] != UINT32_MAX) {
+			log_msg_LTYP.body.type = type;
+			log_msg_LTYP.body.offset = data_start + log_index_type_offset[type];
+			written += write(fd, &log_msg_LTYP, sizeof(log_msg_LTYP));
+			log_msg_LEND.body.type_entries++;
+		}
+	}
+
+	/* fixed size and last, readers find the index from the end of the file */
+	written += write(fd, &log_msg_LEND, sizeof(log_msg_LEND));
+
 	return written;
 }
 
@@ -881,20 +1253,142 @@ int write_parameters(int fd)
 	return written;
 }
 
+int write_boot_timing(int fd)
+{
+	static bool boot_timing_written = false;
+
+	if (boot_timing_written) {
+		return 0;
+	}
+
+	boot_timing_written = true;
+
+	/* construct boot phase message */
+	struct {
+		LOG_PACKET_HEADER;
+		struct log_BOOT_s body;
+	} log_msg_BOOT = {
+		LOG_PACKET_HEADER_INIT(LOG_BOOT_MSG),
+	};
+
+	int written = 0;
+	unsigned count = boot_timing_count();
+
+	for (unsigned i = 0; i < count; i++) {
+		const char *name;
+		uint64_t time;
+
+		if (boot_timing_get(i, &name, &time) != 0) {
+			break;
+		}
+
+		/* fill boot phase message and write it */
+		strncpy(log_msg_BOOT.body.name, name, sizeof(log_msg_BOOT.body.name));
+		log_msg_BOOT.body.t = time;
+		written += write(fd, &log_msg_BOOT, sizeof(log_msg_BOOT));
+	}
+
+	return written;
+}
+
+void publish_log_stream(unsigned long offset, const void *data, int len)
+{
+	struct log_stream_s msg;
+	const uint8_t *p = (const uint8_t *)data;
+
+	msg.log_id = log_stream_id;
+
+	while (len > 0) {
+		msg.offset = offset;
+		msg.len = MIN(len, (int)sizeof(msg.data));
+		memcpy(msg.data, p, msg.len);
+
+		if (log_stream_pub == NULL) {
+			log_stream_pub = orb_advertise_queue(ORB_ID(log_stream), &msg, LOG_STREAM_QUEUE_SIZE);
+
+		} else {
+			orb_publish(ORB_ID(log_stream), log_stream_pub, &msg);
+		}
+
+		offset += msg.len;
+		p += msg.len;
+		len -= msg.len;
+	}
+}
+
 bool copy_if_updated(orb_id_t topic, int *handle, void *buffer)
 {
 	return copy_if_updated_multi(topic, 0, handle, buffer);
 }
 
+void log_profile_load(const char *path)
+{
+	log_profile_count = 0;
+
+	FILE *fp = fopen(path, "r");
+
+	if (fp == NULL) {
+		/* no profile is fine, everything is logged at the main loop rate */
+		return;
+	}
+
+	char line[64];
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		struct log_profile_entry_s entry;
+
+		if (line[0] == '#' || sscanf(line, "%31s %f", entry.topic, &entry.rate) != 2) {
+			continue;
+		}
+
+		if (log_profile_count >= LOG_PROFILE_MAX_TOPICS) {
+			warnx("logging profile: only %u topics supported", LOG_PROFILE_MAX_TOPICS);
+			break;
+		}
+
+		log_profile[log_profile_count++] = entry;
+	}
+
+	fclose(fp);
+
+	warnx("logging profile: %u topics from %s", log_profile_count, path);
+}
+
+const struct log_profile_entry_s *log_profile_find(const char *topic)
+{
+	for (unsigned i = 0; i < log_profile_count; i++) {
+		if (strcmp(log_profile[i].topic, topic) == 0) {
+			return &log_profile[i];
+		}
+	}
+
+	return NULL;
+}
+
 bool copy_if_updated_multi(orb_id_t topic, int multi_instance, int *handle, void *buffer)
 {
 	bool updated = false;
 
+	if (*handle == LOG_TOPIC_DISABLED) {
+		return false;
+	}
+
 	if (*handle < 0) {
 		if (OK == orb_exists(topic, multi_instance)) {
+			const struct log_profile_entry_s *profile = log_profile_find(topic->o_name);
+
+			if (profile != NULL && profile->rate <= 0.0f) {
+				*handle = LOG_TOPIC_DISABLED;
+				return false;
+			}
+
 			*handle = orb_subscribe(topic);
 			/* copy first data */
 			if (*handle >= 0) {
+				if (profile != NULL) {
+					orb_set_interval(*handle, (unsigned)(1000.0f / profile->rate));
+				}
+
 				orb_copy(topic, *handle, buffer);
 				updated = true;
 			}
@@ -921,6 +1415,7 @@ int sdlog2_thread_main(int argc, char *argv[])
 	/* delay = 1 / rate (rate defined by -r option), default log rate: 50 Hz */
 	useconds_t sleep_delay = 20000;
 	int log_buffer_size = LOG_BUFFER_SIZE_DEFAULT;
+	const char *log_profile_path = log_profile_default;
 	logging_enabled = false;
 	/* enable logging on start (-e option) */
 	bool log_on_start = false;
@@ -941,7 +1436,7 @@ int sdlog2_thread_main(int argc, char *argv[])
 
 	int myoptind = 1;
 	const char *myoptarg = NULL;
-	while ((ch = px4_getopt(argc, argv, "r:b:eatx", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "r:b:p:eatxzs", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'r': {
 				unsigned long r = strtoul(myoptarg, NULL, 10);
@@ -962,9 +1457,20 @@ int sdlog2_thread_main(int argc, char *argv[])
 				}
 
 				log_buffer_size = 1024 * s;
+
+				/* whole write batches, so writes don't get split at the end of the buffer */
+				log_buffer_size = (log_buffer_size + LOG_WRITE_BATCH - 1) / LOG_WRITE_BATCH * LOG_WRITE_BATCH;
+
+				if (log_buffer_size < 2 * LOG_WRITE_BATCH) {
+					log_buffer_size = 2 * LOG_WRITE_BATCH;
+				}
 			}
 			break;
 
+		case 'p':
+			log_profile_path = myoptarg;
+			break;
+
 		case 'e':
 			log_on_start = true;
 			break;
@@ -981,6 +1487,14 @@ int sdlog2_thread_main(int argc, char *argv[])
 			_extended_logging = true;
 			break;
 
+		case 'z':
+			_compress = true;
+			break;
+
+		case 's':
+			_stream = true;
+			break;
+
 		case '?':
 			if (optopt == 'c') {
 				warnx("option -%c requires an argument", optopt);
@@ -1045,6 +1559,34 @@ int sdlog2_thread_main(int argc, char *argv[])
 
 	}
 
+	param_t log_compress_ph = param_find("SDLOG_COMPRESS");
+
+	if (log_compress_ph != PARAM_INVALID) {
+
+		int32_t param_log_compress;
+		param_get(log_compress_ph, &param_log_compress);
+
+		if (param_log_compress > 0) {
+			_compress = true;
+		} else if (param_log_compress == 0) {
+			_compress = false;
+		}
+		/* any other value means to ignore the parameter, so no else case */
+
+	}
+
+	param_t log_prealloc_ph = param_find("SDLOG_PREALLOC");
+
+	if (log_prealloc_ph != PARAM_INVALID) {
+		param_get(log_prealloc_ph, &_prealloc_mb);
+	}
+
+	param_t log_rotate_ph = param_find("SDLOG_ROTATE_MB");
+
+	if (log_rotate_ph != PARAM_INVALID) {
+		param_get(log_rotate_ph, &_rotate_mb);
+	}
+
 	param_t log_gpstime_ph = param_find("SDLOG_GPSTIME");
 
 	if (log_gpstime_ph != PARAM_INVALID) {
@@ -1061,6 +1603,8 @@ int sdlog2_thread_main(int argc, char *argv[])
 
 	}
 
+	/* make room for new sessions before the first one starts */
+	log_dir_rotate();
 
 	if (check_free_space() != OK) {
 		warnx("ERR: MicroSD almost full");
@@ -1076,6 +1620,9 @@ int sdlog2_thread_main(int argc, char *argv[])
 		return 1;
 	}
 
+	/* per-topic rates */
+	log_profile_load(log_profile_path);
+
 	/* copy conversion scripts */
 	const char *converter_in = "/etc/logging/conv.zip";
 	char *converter_out = malloc(64);
@@ -1138,6 +1685,11 @@ int sdlog2_thread_main(int argc, char *argv[])
 		struct vtol_vehicle_status_s vtol_status;
 		struct time_offset_s time_offset;
 		struct mc_att_ctrl_status_s mc_att_ctrl_status;
+		struct perf_histogram_s perf_histogram;
+		struct cpuload_s cpuload;
+		struct task_stats_s task_stats;
+		struct perf_stats_s perf_stats;
+		struct gps_dump_s gps_dump;
 	} buf;
 
 	memset(&buf, 0, sizeof(buf));
@@ -1186,6 +1738,11 @@ int sdlog2_thread_main(int argc, char *argv[])
 			struct log_ENCD_s log_ENCD;
 			struct log_TSYN_s log_TSYN;
 			struct log_MACS_s log_MACS;
+			struct log_PRFH_s log_PRFH;
+			struct log_LOAD_s log_LOAD;
+			struct log_TSTA_s log_TSTA;
+			struct log_PRFS_s log_PRFS;
+			struct log_GPSR_s log_GPSR;
 		} body;
 	} log_msg = {
 		LOG_PACKET_HEADER_INIT(0)
@@ -1228,6 +1785,11 @@ int sdlog2_thread_main(int argc, char *argv[])
 		int encoders_sub;
 		int tsync_sub;
 		int mc_att_ctrl_status_sub;
+		int perf_histogram_sub;
+		int cpuload_sub;
+		int task_stats_sub;
+		int perf_stats_sub;
+		int gps_dump_sub;
 	} subs;
 
 	subs.cmd_sub = -1;
@@ -1262,6 +1824,11 @@ int sdlog2_thread_main(int argc, char *argv[])
 	subs.tsync_sub = -1;
 	subs.mc_att_ctrl_status_sub = -1;
 	subs.encoders_sub = -1;
+	subs.perf_histogram_sub = -1;
+	subs.cpuload_sub = -1;
+	subs.task_stats_sub = -1;
+	subs.perf_stats_sub = -1;
+	subs.gps_dump_sub = -1;
 
 	/* add new topics HERE */
 
@@ -1340,11 +1907,10 @@ int sdlog2_thread_main(int argc, char *argv[])
 			continue;
 		}
 
-		pthread_mutex_lock(&logbuffer_mutex);
-
 		/* write time stamp message */
 		log_msg.msg_type = LOG_TIME_MSG;
 		log_msg.body.log_TIME.t = hrt_absolute_time();
+		log_index_time(log_msg.body.log_TIME.t);
 		LOGBUFFER_WRITE_AND_COUNT(TIME);
 
 		/* --- VEHICLE STATUS --- */
@@ -1905,14 +2471,63 @@ int sdlog2_thread_main(int argc, char *argv[])
 			LOGBUFFER_WRITE_AND_COUNT(MACS);
 		}
 
-		/* signal the other thread new data, but not yet unlock */
-		if (logbuffer_count(&lb) > MIN_BYTES_TO_WRITE) {
-			/* only request write if several packets can be written at once */
+		/* --- PERF COUNTER HISTOGRAM --- */
+		if (copy_if_updated(ORB_ID(perf_histogram), &subs.perf_histogram_sub, &buf.perf_histogram)) {
+			log_msg.msg_type = LOG_PRFH_MSG;
+			memcpy(log_msg.body.log_PRFH.name, buf.perf_histogram.name, sizeof(log_msg.body.log_PRFH.name));
+			log_msg.body.log_PRFH.count = buf.perf_histogram.event_count;
+			log_msg.body.log_PRFH.p50 = buf.perf_histogram.p50;
+			log_msg.body.log_PRFH.p99 = buf.perf_histogram.p99;
+			log_msg.body.log_PRFH.p999 = buf.perf_histogram.p999;
+			log_msg.body.log_PRFH.max = buf.perf_histogram.max;
+			LOGBUFFER_WRITE_AND_COUNT(PRFH);
+		}
+
+		/* --- CPU LOAD --- */
+		if (copy_if_updated(ORB_ID(cpuload), &subs.cpuload_sub, &buf.cpuload)) {
+			log_msg.msg_type = LOG_LOAD_MSG;
+			log_msg.body.log_LOAD.load = buf.cpuload.load;
+			log_msg.body.log_LOAD.task_count = buf.cpuload.task_count;
+			LOGBUFFER_WRITE_AND_COUNT(LOAD);
+		}
+
+		/* --- TASK STATISTICS --- */
+		if (copy_if_updated(ORB_ID(task_stats), &subs.task_stats_sub, &buf.task_stats)) {
+			log_msg.msg_type = LOG_TSTA_MSG;
+			memcpy(log_msg.body.log_TSTA.name, buf.task_stats.name, sizeof(log_msg.body.log_TSTA.name));
+			log_msg.body.log_TSTA.pid = buf.task_stats.pid;
+			log_msg.body.log_TSTA.load = buf.task_stats.load;
+			log_msg.body.log_TSTA.stack_used = buf.task_stats.stack_used;
+			log_msg.body.log_TSTA.stack_size = buf.task_stats.stack_size;
+			log_msg.body.log_TSTA.priority = buf.task_stats.priority;
+			LOGBUFFER_WRITE_AND_COUNT(TSTA);
+		}
+
+		/* --- PERF COUNTER STATISTICS --- */
+		if (copy_if_updated(ORB_ID(perf_stats), &subs.perf_stats_sub, &buf.perf_stats)) {
+			log_msg.msg_type = LOG_PRFS_MSG;
+			memcpy(log_msg.body.log_PRFS.name, buf.perf_stats.name, sizeof(log_msg.body.log_PRFS.name));
+			log_msg.body.log_PRFS.rank = buf.perf_stats.rank;
+			log_msg.body.log_PRFS.event_count = buf.perf_stats.event_count;
+			log_msg.body.log_PRFS.elapsed = buf.perf_stats.elapsed;
+			LOGBUFFER_WRITE_AND_COUNT(PRFS);
+		}
+
+		/* --- RAW GPS RECEIVER DATA --- */
+		/* the driver queues the raw stream, drain everything received since the last iteration */
+		while (copy_if_updated(ORB_ID(gps_dump), &subs.gps_dump_sub, &buf.gps_dump)) {
+			log_msg.msg_type = LOG_GPSR_MSG;
+			log_msg.body.log_GPSR.len = buf.gps_dump.len;
+			memcpy(log_msg.body.log_GPSR.data, buf.gps_dump.data, sizeof(log_msg.body.log_GPSR.data));
+			LOGBUFFER_WRITE_AND_COUNT(GPSR);
+		}
+
+		/* wake up the writer once a full batch can be written */
+		if (logbuffer_count(&lb) >= LOG_WRITE_BATCH) {
+			pthread_mutex_lock(&logbuffer_mutex);
 			pthread_cond_signal(&logbuffer_cond);
+			pthread_mutex_unlock(&logbuffer_mutex);
 		}
-
-		/* unlock, now the writer thread may run */
-		pthread_mutex_unlock(&logbuffer_mutex);
 	}
 
 	if (logging_enabled) {
@@ -1932,6 +2547,8 @@ int sdlog2_thread_main(int argc, char *argv[])
 void sdlog2_status()
 {
 	warnx("extended logging: %s", (_extended_logging) ? "ON" : "OFF");
+	warnx("compression: %s", (_compress) ? "ON" : "OFF");
+	warnx("logging profile: %u topics", log_profile_count);
 	warnx("time: gps: %u seconds", (unsigned)gps_time_sec);
 	if (!logging_enabled) {
 		warnx("not logging");
@@ -1942,6 +2559,8 @@ void sdlog2_status()
 		float seconds = ((float)(hrt_absolute_time() - start_time)) / 1000000.0f;
 
 		warnx("wrote %lu msgs, %4.2f MiB (average %5.3f KiB/s), skipped %lu msgs", log_msgs_written, (double)mebibytes, (double)(kibibytes / seconds), log_msgs_skipped);
+		warnx("buffer: %i bytes, high-water %i bytes (%i%%), dropped %lu bytes", lb.size, lb.high_water,
+		      lb.size > 0 ? (100 * lb.high_water / lb.size) : 0, lb.dropped_bytes);
 		mavlink_log_info(mavlink_fd, "[sdlog2] wrote %lu msgs, skipped %lu msgs", log_msgs_written, log_msgs_skipped);
 	}
 }
@@ -2024,6 +2643,138 @@ int check_free_space()
 	return PX4_OK;
 }
 
+unsigned log_dir_index_load()
+{
+	char buf[8] = "";
+	unsigned dir_number = 0;
+
+	int fd = open(log_dir_index_path, O_RDONLY);
+
+	if (fd >= 0) {
+		if (read(fd, buf, sizeof(buf) - 1) > 0) {
+			dir_number = strtoul(buf, NULL, 10);
+		}
+
+		close(fd);
+	}
+
+	if (dir_number < 1 || dir_number > MAX_NO_LOGFOLDER) {
+		/* no (valid) index yet, search from the first dir */
+		dir_number = 1;
+	}
+
+	return dir_number;
+}
+
+void log_dir_index_store(unsigned dir_number)
+{
+#ifdef __PX4_NUTTX
+	int fd = open(log_dir_index_path, O_CREAT | O_WRONLY | O_TRUNC);
+#else
+	int fd = open(log_dir_index_path, O_CREAT | O_WRONLY | O_TRUNC, PX4_O_MODE_666);
+#endif
+
+	if (fd < 0) {
+		warn("failed storing dir index: %s", log_dir_index_path);
+		return;
+	}
+
+	dprintf(fd, "%u\n", dir_number);
+	close(fd);
+}
+
+int remove_log_dir(const char *dir)
+{
+	char path[64];
+	DIR *d = opendir(dir);
+
+	if (d == NULL) {
+		return PX4_ERROR;
+	}
+
+	struct dirent *entry;
+
+	while ((entry = readdir(d)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+			continue;
+		}
+
+		snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+		unlink(path);
+	}
+
+	closedir(d);
+
+	return rmdir(dir);
+}
+
+void log_dir_rotate()
+{
+	if (_rotate_mb <= 0) {
+		return;
+	}
+
+	/* the dir following the last created one is the oldest */
+	unsigned next = log_dir_index_load();
+
+	for (unsigned removed = 0; removed < LOG_ROTATE_MAX_DIRS; removed++) {
+		FAR struct statfs statfs_buf;
+
+		if (statfs(mountpoint, &statfs_buf) != OK ||
+		    statfs_buf.f_bavail >= (px4_statfs_buf_f_bavail_t)((uint64_t)_rotate_mb * 1024 * 1024 / statfs_buf.f_bsize)) {
+			return;
+		}
+
+		/* one pass over the log root instead of probing every possible name */
+		DIR *d = opendir(log_root);
+
+		if (d == NULL) {
+			return;
+		}
+
+		char oldest[32] = "";
+		unsigned oldest_age = MAX_NO_LOGFOLDER;
+		struct dirent *entry;
+
+		while ((entry = readdir(d)) != NULL) {
+			unsigned dir_number;
+			char candidate[32];
+
+			if (sscanf(entry->d_name, "sess%3u", &dir_number) != 1 ||
+			    dir_number < 1 || dir_number > MAX_NO_LOGFOLDER) {
+				continue;
+			}
+
+			snprintf(candidate, sizeof(candidate), "%s/%s", log_root, entry->d_name);
+
+			/* never remove the session just written */
+			if (strcmp(candidate, log_dir) == 0) {
+				continue;
+			}
+
+			unsigned age = (dir_number + MAX_NO_LOGFOLDER - next) % MAX_NO_LOGFOLDER;
+
+			if (age < oldest_age) {
+				oldest_age = age;
+				strncpy(oldest, candidate, sizeof(oldest) - 1);
+			}
+		}
+
+		closedir(d);
+
+		if (oldest[0] == '\0') {
+			return;
+		}
+
+		if (remove_log_dir(oldest) != OK) {
+			warn("failed removing: %s", oldest);
+			return;
+		}
+
+		mavlink_and_console_log_info(mavlink_fd, "[sdlog2] removed old log dir: %s", oldest);
+	}
+}
+
 void handle_command(struct vehicle_command_s *cmd)
 {
 	int param;
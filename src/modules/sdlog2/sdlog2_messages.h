@@ -479,6 +479,51 @@ struct log_MACS_s {
 
 /* WARNING: ID 46 is already in use for ATTC1 */
 
+/* --- PRFH - PERF COUNTER HISTOGRAM --- */
+#define LOG_PRFH_MSG 47
+struct log_PRFH_s {
+	char name[16];
+	uint64_t count;
+	uint32_t p50;
+	uint32_t p99;
+	uint32_t p999;
+	uint32_t max;
+};
+
+/* --- LOAD - CPU LOAD --- */
+#define LOG_LOAD_MSG 48
+struct log_LOAD_s {
+	float load;
+	uint16_t task_count;
+};
+
+/* --- TSTA - TASK STATISTICS --- */
+#define LOG_TSTA_MSG 49
+struct log_TSTA_s {
+	char name[16];
+	int32_t pid;
+	float load;
+	uint32_t stack_used;
+	uint32_t stack_size;
+	uint8_t priority;
+};
+
+/* --- PRFS - PERF COUNTER STATISTICS --- */
+#define LOG_PRFS_MSG 50
+struct log_PRFS_s {
+	char name[16];
+	uint8_t rank;
+	uint32_t event_count;
+	uint32_t elapsed;
+};
+
+/* --- GPSR - RAW GPS RECEIVER DATA --- */
+#define LOG_GPSR_MSG 51
+struct log_GPSR_s {
+	uint8_t len;
+	uint8_t data[64];
+};
+
 /********** SYSTEM MESSAGES, ID > 0x80 **********/
 
 /* --- TIME - TIME STAMP --- */
@@ -501,6 +546,48 @@ struct log_PARM_s {
 	float value;
 };
 
+/* --- ZBLK - COMPRESSED BLOCK --- */
+/* followed by comp_len bytes of LZ4 block data, or raw data if comp_len == raw_len;
+ * only written if compression is enabled, see write_formats() */
+#define LOG_ZBLK_MSG 132
+struct log_ZBLK_s {
+	uint16_t comp_len;
+	uint16_t raw_len;
+};
+
+/* --- BOOT - BOOT PHASE TIMING --- */
+/* only in the first log file after boot, see systemlib/boot_timing.h */
+#define LOG_BOOT_MSG 133
+struct log_BOOT_s {
+	char name[16];
+	uint64_t t;
+};
+
+/* --- LIDX - LOG INDEX, TIME --- */
+/* written at the end of the log: file offset of a TIME message, sparse in time */
+#define LOG_LIDX_MSG 134
+struct log_LIDX_s {
+	uint64_t t;
+	uint32_t offset;
+};
+
+/* --- LTYP - LOG INDEX, MESSAGE TYPE --- */
+/* written at the end of the log: file offset of the first message of a type */
+#define LOG_LTYP_MSG 135
+struct log_LTYP_s {
+	uint8_t type;
+	uint32_t offset;
+};
+
+/* --- LEND - LOG INDEX, END --- */
+/* always the last message of an indexed log, offset of its first LIDX message */
+#define LOG_LEND_MSG 136
+struct log_LEND_s {
+	uint32_t offset;
+	uint16_t time_entries;
+	uint16_t type_entries;
+};
+
 #pragma pack(pop)
 /* construct list of all message formats */
 static const struct log_format_s log_formats[] = {
@@ -550,12 +637,21 @@ static const struct log_format_s log_formats[] = {
 	LOG_FORMAT(ENCD, "qfqf",	"cnt0,vel0,cnt1,vel1"),
 	LOG_FORMAT(TSYN, "Q", 		"TimeOffset"),
 	LOG_FORMAT(MACS, "fff", "RRint,PRint,YRint"),
+	LOG_FORMAT(PRFH, "NQIIII", "Name,Count,P50,P99,P999,Max"),
+	LOG_FORMAT(LOAD, "fH", "Load,Tasks"),
+	LOG_FORMAT(TSTA, "NifIIB", "Name,PID,Load,StackUsed,StackSize,Prio"),
+	LOG_FORMAT(PRFS, "NBII", "Name,Rank,Events,Elapsed"),
+	LOG_FORMAT(GPSR, "BZ", "Len,Data"),
 
 	/* system-level messages, ID >= 0x80 */
 	/* FMT: don't write format of format message, it's useless */
 	LOG_FORMAT(TIME, "Q", "StartTime"),
 	LOG_FORMAT(VER, "NZ", "Arch,FwGit"),
-	LOG_FORMAT(PARM, "Nf", "Name,Value")
+	LOG_FORMAT(PARM, "Nf", "Name,Value"),
+	LOG_FORMAT(BOOT, "NQ", "Name,Time"),
+	LOG_FORMAT(LIDX, "QI", "Time,Offset"),
+	LOG_FORMAT(LTYP, "BI", "Type,Offset"),
+	LOG_FORMAT(LEND, "IHH", "Offset,NTime,NType")
 };
 
 static const unsigned log_formats_num = sizeof(log_formats) / sizeof(log_formats[0]);
@@ -12,10 +12,12 @@ public:
 		th2v(this, "TH2V"),
 		q2v(this, "Q2V"),
 		_attPoll(),
-		_timeStamp(0)
+		_timeStamp(0),
+		_blocks()
 	{
 		_attPoll.fd = _att.getHandle();
 		_attPoll.events = POLLIN;
+		flatten(_blocks, sizeof(_blocks) / sizeof(_blocks[0]));
 	}
 	void update();
 private:
@@ -24,5 +26,6 @@ private:
 	BlockP q2v;
 	struct pollfd _attPoll;
 	uint64_t _timeStamp;
+	Block *_blocks[16];	// flat update schedule of the block tree
 };
 
@@ -618,6 +618,21 @@ PARAM_DEFINE_FLOAT(SENS_DPRES_ANSC, 0);
  */
 PARAM_DEFINE_FLOAT(SENS_BARO_QNH, 1013.25f);
 
+/**
+ * IMU integration interval
+ *
+ * Minimum interval between two sensor_combined publications. The delta
+ * angles and delta velocities of all gyro and accel reports within the
+ * interval are summed up, so estimators running at the lower rate do
+ * not miss any motion. Set to zero to publish on every gyro update.
+ *
+ * @min 0
+ * @max 20000
+ * @unit us
+ * @group Sensor Calibration
+ */
+PARAM_DEFINE_INT32(SENS_IMU_INT, 0);
+
 
 /**
  * Board rotation
@@ -131,6 +131,14 @@
 
 #define SENSOR_COUNT_MAX		3
 
+/* bits of the update mask, set for every sensor class with new data in a loop iteration */
+#define SENSOR_UPDATE_GYRO		(1 << 0)
+#define SENSOR_UPDATE_ACCEL		(1 << 1)
+#define SENSOR_UPDATE_MAG		(1 << 2)
+#define SENSOR_UPDATE_BARO		(1 << 3)
+
+#define HOUSEKEEPING_INTERVAL		20000	/**< interval in us for checking topics that do not feed sensor_combined */
+
 /* oddly, ERROR is not defined for c++ */
 #ifdef ERROR
 # undef ERROR
@@ -168,6 +176,8 @@ public:
 
 private:
 	static const unsigned _rc_max_chan_count = input_rc_s::RC_INPUT_MAX_CHANNELS;	/**< maximum number of r/c channels we handle */
+	static constexpr float _manual_change_threshold = 0.002f;	/**< stick change that warrants a manual control update, ~1 us of PWM */
+	static const hrt_abstime _manual_publish_interval = 100000;	/**< publish manual control at least this often, us */
 
 	/**
 	 * Get and limit value for specified RC function. Returns NAN if not mapped.
@@ -180,6 +190,13 @@ private:
 	switch_pos_t	get_rc_sw3pos_position(uint8_t func, float on_th, bool on_inv, float mid_th, bool mid_inv);
 	switch_pos_t	get_rc_sw2pos_position(uint8_t func, float on_th, bool on_inv);
 
+	/**
+	 * Check if a manual control setpoint differs from the last published one
+	 * by more than the change threshold on any axis, or in any switch.
+	 */
+	bool		manual_control_changed(const struct manual_control_setpoint_s &manual,
+					       const struct manual_control_setpoint_s &last);
+
 	/**
 	 * Update paramters from RC channels if the functionality is activated and the
 	 * input has changed since the last update
@@ -199,6 +216,8 @@ private:
 
 	bool 		_task_should_exit;		/**< if true, sensor task should exit */
 	int 		_sensors_task;			/**< task handle for sensor task */
+	hrt_abstime	_last_housekeeping;		/**< last time we checked the topics not feeding sensor_combined */
+	hrt_abstime	_last_combined;			/**< last time sensor_combined was published */
 
 	bool		_hil_enabled;			/**< if true, HIL is active */
 	bool		_publishing;			/**< if true, we are publishing sensor data */
@@ -231,6 +250,7 @@ private:
 	perf_counter_t	_loop_perf;			/**< loop performance counter */
 
 	struct rc_channels_s _rc;			/**< r/c channel data */
+	struct manual_control_setpoint_s _manual;	/**< last published manual control setpoint */
 	struct battery_status_s _battery_status;	/**< battery status */
 	struct baro_report _barometer;			/**< barometer data */
 	struct differential_pressure_s _diff_pres;
@@ -240,9 +260,11 @@ private:
 
 	math::Matrix<3, 3>	_board_rotation;	/**< rotation matrix for the orientation that the board is mounted */
 	math::Matrix<3, 3>	_mag_rotation[3];	/**< rotation matrix for the orientation that the external mag0 is mounted */
+	uint32_t		_cal_change_seq;	/**< parameter change sequence the calibrations were applied at */
 
 	uint64_t _battery_discharged;			/**< battery discharged current in mA*ms */
 	hrt_abstime _battery_current_timestamp;		/**< timestamp of last battery current reading */
+	uint64_t _battery_current_integral;		/**< ADC integral of the current channel at the last reading */
 
 	struct {
 		float min[_rc_max_chan_count];
@@ -252,6 +274,12 @@ private:
 		float dz[_rc_max_chan_count];
 		float scaling_factor[_rc_max_chan_count];
 
+		/* per channel coefficients of the scaling in rc_poll(), derived from the above */
+		float offset_hi[_rc_max_chan_count];	/**< trim + dead zone */
+		float slope_hi[_rc_max_chan_count];	/**< rev / (max - trim - dead zone) */
+		float offset_lo[_rc_max_chan_count];	/**< trim - dead zone */
+		float slope_lo[_rc_max_chan_count];	/**< rev / (trim - min - dead zone) */
+
 		float diff_pres_offset_pa;
 		float diff_pres_analog_scale;
 
@@ -304,6 +332,8 @@ private:
 
 		float baro_qnh;
 
+		int32_t imu_integration_interval;
+
 	}		_parameters;			/**< local copies of interesting parameters */
 
 	struct {
@@ -362,6 +392,8 @@ private:
 
 		param_t baro_qnh;
 
+		param_t imu_integration_interval;
+
 	}		_parameter_handles;		/**< handles for interesting parameters */
 
 
@@ -403,32 +435,36 @@ private:
 	 *
 	 * @param raw			Combined sensor data structure into which
 	 *				data should be returned.
+	 * @return			true if any instance had new data.
 	 */
-	void		accel_poll(struct sensor_combined_s &raw);
+	bool		accel_poll(struct sensor_combined_s &raw);
 
 	/**
 	 * Poll the gyro for updated data.
 	 *
 	 * @param raw			Combined sensor data structure into which
 	 *				data should be returned.
+	 * @return			true if any instance had new data.
 	 */
-	void		gyro_poll(struct sensor_combined_s &raw);
+	bool		gyro_poll(struct sensor_combined_s &raw);
 
 	/**
 	 * Poll the magnetometer for updated data.
 	 *
 	 * @param raw			Combined sensor data structure into which
 	 *				data should be returned.
+	 * @return			true if any instance had new data.
 	 */
-	void		mag_poll(struct sensor_combined_s &raw);
+	bool		mag_poll(struct sensor_combined_s &raw);
 
 	/**
 	 * Poll the barometer for updated data.
 	 *
 	 * @param raw			Combined sensor data structure into which
 	 *				data should be returned.
+	 * @return			true if any instance had new data.
 	 */
-	void		baro_poll(struct sensor_combined_s &raw);
+	bool		baro_poll(struct sensor_combined_s &raw);
 
 	/**
 	 * Poll the differential pressure sensor for updated data.
@@ -438,6 +474,15 @@ private:
 	 */
 	void		diff_pres_poll(struct sensor_combined_s &raw);
 
+	/**
+	 * Clear the delta angles and delta velocities accumulated since the
+	 * last publication.
+	 *
+	 * @param raw			Combined sensor data structure holding
+	 *				the integrals.
+	 */
+	void		integrals_reset(struct sensor_combined_s &raw);
+
 	/**
 	 * Check for changes in vehicle control mode.
 	 */
@@ -448,6 +493,14 @@ private:
 	 */
 	void 		parameter_update_poll(bool forced = false);
 
+	/**
+	 * Check whether any calibration parameter of a sensor type changed.
+	 *
+	 * @param sensor	The sensor part of the names, e.g. "GYRO" for CAL_GYRO0_XOFF.
+	 * @param change_seq	The parameter change sequence the calibration was applied at.
+	 */
+	bool		calibration_changed(const char *sensor, uint32_t change_seq);
+
 	/**
 	 * Check for changes in rc_parameter_map
 	 */
@@ -484,6 +537,8 @@ Sensors::Sensors() :
 
 	_task_should_exit(true),
 	_sensors_task(-1),
+	_last_housekeeping(0),
+	_last_combined(0),
 	_hil_enabled(false),
 	_publishing(true),
 	_armed(false),
@@ -518,9 +573,11 @@ Sensors::Sensors() :
 	_param_rc_values{},
 	_board_rotation{},
 	_mag_rotation{},
+	_cal_change_seq(0),
 
 	_battery_discharged(0),
-	_battery_current_timestamp(0)
+	_battery_current_timestamp(0),
+	_battery_current_integral(0)
 {
 	/* initialize subscriptions */
 	for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
@@ -531,6 +588,7 @@ Sensors::Sensors() :
 	}
 
 	memset(&_rc, 0, sizeof(_rc));
+	memset(&_manual, 0, sizeof(_manual));
 	memset(&_diff_pres, 0, sizeof(_diff_pres));
 	memset(&_rc_parameter_map, 0, sizeof(_rc_parameter_map));
 
@@ -621,6 +679,9 @@ Sensors::Sensors() :
 	/* Barometer QNH */
 	_parameter_handles.baro_qnh = param_find("SENS_BARO_QNH");
 
+	/* IMU integration interval */
+	_parameter_handles.imu_integration_interval = param_find("SENS_IMU_INT");
+
 	// These are parameters for which QGroundControl always expects to be returned in a list request.
 	// We do a param_find here to force them into the list.
 	(void)param_find("RC_CHAN_CNT");
@@ -702,6 +763,26 @@ Sensors::parameters_update()
 		} else {
 			_parameters.scaling_factor[i] = tmpScaleFactor;
 		}
+
+		/*
+		 * Split the scaling around the trim point into two linear pieces, so
+		 * rc_poll() needs no branches. A piece that cannot be reached once the
+		 * input is constrained to min/max gets a zero slope.
+		 */
+		float dz = (_parameters.dz[i] > 0.0f) ? _parameters.dz[i] : 0.0f;
+		float range_hi = _parameters.max[i] - _parameters.trim[i] - dz;
+		float range_lo = _parameters.trim[i] - _parameters.min[i] - dz;
+
+		_parameters.offset_hi[i] = _parameters.trim[i] + dz;
+		_parameters.slope_hi[i] = (range_hi > 0.0f) ? _parameters.rev[i] / range_hi : 0.0f;
+		_parameters.offset_lo[i] = _parameters.trim[i] - dz;
+		_parameters.slope_lo[i] = (range_lo > 0.0f) ? _parameters.rev[i] / range_lo : 0.0f;
+
+		/* handle any parameter-induced blowups */
+		if (!PX4_ISFINITE(_parameters.slope_hi[i]) || !PX4_ISFINITE(_parameters.slope_lo[i])) {
+			_parameters.slope_hi[i] = 0.0f;
+			_parameters.slope_lo[i] = 0.0f;
+		}
 	}
 
 	/* handle wrong values */
@@ -865,6 +946,12 @@ Sensors::parameters_update()
 
 	_board_rotation = board_rotation_offset * _board_rotation;
 
+	param_get(_parameter_handles.imu_integration_interval, &(_parameters.imu_integration_interval));
+
+	if (_parameters.imu_integration_interval < 0) {
+		_parameters.imu_integration_interval = 0;
+	}
+
 	/* update barometer qnh setting */
 	param_get(_parameter_handles.baro_qnh, &(_parameters.baro_qnh));
 	int	barofd;
@@ -1013,14 +1100,18 @@ Sensors::adc_init()
 	return OK;
 }
 
-void
+bool
 Sensors::accel_poll(struct sensor_combined_s &raw)
 {
+	bool updated = false;
+
 	for (unsigned i = 0; i < _accel_count; i++) {
 		bool accel_updated;
 		orb_check(_accel_sub[i], &accel_updated);
 
-		if (accel_updated) {
+		/* the driver queues its reports, take all of them so the latest values are current */
+		while (accel_updated) {
+			updated = true;
 			struct accel_report	accel_report;
 
 			orb_copy(ORB_ID(sensor_accel), _accel_sub[i], &accel_report);
@@ -1035,11 +1126,12 @@ Sensors::accel_poll(struct sensor_combined_s &raw)
 			math::Vector<3> vect_int(accel_report.x_integral, accel_report.y_integral, accel_report.z_integral);
 			vect_int = _board_rotation * vect_int;
 
-			raw.accelerometer_integral_m_s[i * 3 + 0] = vect_int(0);
-			raw.accelerometer_integral_m_s[i * 3 + 1] = vect_int(1);
-			raw.accelerometer_integral_m_s[i * 3 + 2] = vect_int(2);
+			/* accumulate until the next publication, reports seen in between are not lost */
+			raw.accelerometer_integral_m_s[i * 3 + 0] += vect_int(0);
+			raw.accelerometer_integral_m_s[i * 3 + 1] += vect_int(1);
+			raw.accelerometer_integral_m_s[i * 3 + 2] += vect_int(2);
 
-			raw.accelerometer_integral_dt[i] = accel_report.integral_dt;
+			raw.accelerometer_integral_dt[i] += accel_report.integral_dt;
 
 			raw.accelerometer_raw[i * 3 + 0] = accel_report.x_raw;
 			raw.accelerometer_raw[i * 3 + 1] = accel_report.y_raw;
@@ -1048,18 +1140,26 @@ Sensors::accel_poll(struct sensor_combined_s &raw)
 			raw.accelerometer_timestamp[i] = accel_report.timestamp;
 			raw.accelerometer_errcount[i] = accel_report.error_count;
 			raw.accelerometer_temp[i] = accel_report.temperature;
+
+			orb_check(_accel_sub[i], &accel_updated);
 		}
 	}
+
+	return updated;
 }
 
-void
+bool
 Sensors::gyro_poll(struct sensor_combined_s &raw)
 {
+	bool updated = false;
+
 	for (unsigned i = 0; i < _gyro_count; i++) {
 		bool gyro_updated;
 		orb_check(_gyro_sub[i], &gyro_updated);
 
-		if (gyro_updated) {
+		/* the driver queues its reports, take all of them so the latest values are current */
+		while (gyro_updated) {
+			updated = true;
 			struct gyro_report	gyro_report;
 
 			orb_copy(ORB_ID(sensor_gyro), _gyro_sub[i], &gyro_report);
@@ -1074,11 +1174,12 @@ Sensors::gyro_poll(struct sensor_combined_s &raw)
 			math::Vector<3> vect_int(gyro_report.x_integral, gyro_report.y_integral, gyro_report.z_integral);
 			vect_int = _board_rotation * vect_int;
 
-			raw.gyro_integral_rad[i * 3 + 0] = vect_int(0);
-			raw.gyro_integral_rad[i * 3 + 1] = vect_int(1);
-			raw.gyro_integral_rad[i * 3 + 2] = vect_int(2);
+			/* accumulate until the next publication, reports seen in between are not lost */
+			raw.gyro_integral_rad[i * 3 + 0] += vect_int(0);
+			raw.gyro_integral_rad[i * 3 + 1] += vect_int(1);
+			raw.gyro_integral_rad[i * 3 + 2] += vect_int(2);
 
-			raw.gyro_integral_dt[i] = gyro_report.integral_dt;
+			raw.gyro_integral_dt[i] += gyro_report.integral_dt;
 
 			raw.gyro_raw[i * 3 + 0] = gyro_report.x_raw;
 			raw.gyro_raw[i * 3 + 1] = gyro_report.y_raw;
@@ -1090,18 +1191,25 @@ Sensors::gyro_poll(struct sensor_combined_s &raw)
 			}
 			raw.gyro_errcount[i] = gyro_report.error_count;
 			raw.gyro_temp[i] = gyro_report.temperature;
+
+			orb_check(_gyro_sub[i], &gyro_updated);
 		}
 	}
+
+	return updated;
 }
 
-void
+bool
 Sensors::mag_poll(struct sensor_combined_s &raw)
 {
+	bool updated = false;
+
 	for (unsigned i = 0; i < _mag_count; i++) {
 		bool mag_updated;
 		orb_check(_mag_sub[i], &mag_updated);
 
 		if (mag_updated) {
+			updated = true;
 			struct mag_report	mag_report;
 
 			orb_copy(ORB_ID(sensor_mag), _mag_sub[i], &mag_report);
@@ -1123,16 +1231,21 @@ Sensors::mag_poll(struct sensor_combined_s &raw)
 			raw.magnetometer_temp[i] = mag_report.temperature;
 		}
 	}
+
+	return updated;
 }
 
-void
+bool
 Sensors::baro_poll(struct sensor_combined_s &raw)
 {
+	bool updated = false;
+
 	for (unsigned i = 0; i < _baro_count; i++) {
 		bool baro_updated;
 		orb_check(_baro_sub[i], &baro_updated);
 
 		if (baro_updated) {
+			updated = true;
 
 			orb_copy(ORB_ID(sensor_baro), _baro_sub[i], &_barometer);
 
@@ -1143,6 +1256,17 @@ Sensors::baro_poll(struct sensor_combined_s &raw)
 			raw.baro_timestamp[i] = _barometer.timestamp;
 		}
 	}
+
+	return updated;
+}
+
+void
+Sensors::integrals_reset(struct sensor_combined_s &raw)
+{
+	memset(&raw.gyro_integral_rad[0], 0, sizeof(raw.gyro_integral_rad));
+	memset(&raw.gyro_integral_dt[0], 0, sizeof(raw.gyro_integral_dt));
+	memset(&raw.accelerometer_integral_m_s[0], 0, sizeof(raw.accelerometer_integral_m_s));
+	memset(&raw.accelerometer_integral_dt[0], 0, sizeof(raw.accelerometer_integral_dt));
 }
 
 void
@@ -1227,6 +1351,13 @@ Sensors::parameter_update_poll(bool forced)
 		struct parameter_update_s update;
 		orb_copy(ORB_ID(parameter_update), _params_sub, &update);
 
+		/*
+		 * Only reopen the sensors and push their calibration if it changed since
+		 * it was applied last, any parameter change would otherwise do so.
+		 */
+		uint32_t change_seq = forced ? 0 : _cal_change_seq;
+		_cal_change_seq = param_get_change_seq();
+
 		/* update parameters */
 		parameters_update();
 
@@ -1238,276 +1369,295 @@ Sensors::parameter_update_poll(bool forced)
 		unsigned gyro_count = 0;
 		unsigned accel_count = 0;
 
-		/* run through all gyro sensors */
-		for (unsigned s = 0; s < SENSOR_COUNT_MAX; s++) {
+		/* run through all gyro sensors, unless their calibration is unchanged */
+		if (calibration_changed("GYRO", change_seq)) {
+			for (unsigned s = 0; s < SENSOR_COUNT_MAX; s++) {
 
-			res = ERROR;
-			(void)sprintf(str, "%s%u", GYRO_BASE_DEVICE_PATH, s);
+				res = ERROR;
+				(void)sprintf(str, "%s%u", GYRO_BASE_DEVICE_PATH, s);
 
-			int fd = px4_open(str, 0);
+				int fd = px4_open(str, 0);
 
-			if (fd < 0) {
-				continue;
-			}
-
-			bool config_ok = false;
-
-			/* run through all stored calibrations */ 
-			for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
-				/* initially status is ok per config */
-				failed = false;
-
-				(void)sprintf(str, "CAL_GYRO%u_ID", i);
-				int device_id;
-				failed = failed || (OK != param_get(param_find(str), &device_id));
-
-				if (failed) {
-					px4_close(fd);
+				if (fd < 0) {
 					continue;
 				}
 
-				/* if the calibration is for this device, apply it */
-				if (device_id == px4_ioctl(fd, DEVIOCGDEVICEID, 0)) {
-					struct gyro_scale gscale = {};
-					(void)sprintf(str, "CAL_GYRO%u_XOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.x_offset));
-					(void)sprintf(str, "CAL_GYRO%u_YOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.y_offset));
-					(void)sprintf(str, "CAL_GYRO%u_ZOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.z_offset));
-					(void)sprintf(str, "CAL_GYRO%u_XSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.x_scale));
-					(void)sprintf(str, "CAL_GYRO%u_YSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.y_scale));
-					(void)sprintf(str, "CAL_GYRO%u_ZSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.z_scale));
+				bool config_ok = false;
+
+				/* run through all stored calibrations */ 
+				for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
+					/* initially status is ok per config */
+					failed = false;
+
+					(void)sprintf(str, "CAL_GYRO%u_ID", i);
+					int device_id;
+					failed = failed || (OK != param_get(param_find(str), &device_id));
 
 					if (failed) {
-						warnx(CAL_ERROR_APPLY_CAL_MSG, "gyro", i);
-					} else {
-						/* apply new scaling and offsets */
-						res = px4_ioctl(fd, GYROIOCSSCALE, (long unsigned int)&gscale);
-						if (res) {
+						px4_close(fd);
+						continue;
+					}
+
+					/* if the calibration is for this device, apply it */
+					if (device_id == px4_ioctl(fd, DEVIOCGDEVICEID, 0)) {
+						struct gyro_scale gscale = {};
+						(void)sprintf(str, "CAL_GYRO%u_XOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.x_offset));
+						(void)sprintf(str, "CAL_GYRO%u_YOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.y_offset));
+						(void)sprintf(str, "CAL_GYRO%u_ZOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.z_offset));
+						(void)sprintf(str, "CAL_GYRO%u_XSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.x_scale));
+						(void)sprintf(str, "CAL_GYRO%u_YSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.y_scale));
+						(void)sprintf(str, "CAL_GYRO%u_ZSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.z_scale));
+
+						if (failed) {
 							warnx(CAL_ERROR_APPLY_CAL_MSG, "gyro", i);
 						} else {
-							config_ok = true;
+							/* apply new scaling and offsets */
+							res = px4_ioctl(fd, GYROIOCSSCALE, (long unsigned int)&gscale);
+							if (res) {
+								warnx(CAL_ERROR_APPLY_CAL_MSG, "gyro", i);
+							} else {
+								config_ok = true;
+							}
 						}
+						break;
 					}
-					break;
 				}
-			}
 
-			if (config_ok) {
-				gyro_count++;
-			}
+				if (config_ok) {
+					gyro_count++;
+				}
 
-			px4_close(fd);
+				px4_close(fd);
+			}
 		}
 
 		/* run through all accel sensors */
-		for (unsigned s = 0; s < SENSOR_COUNT_MAX; s++) {
-
-			res = ERROR;
-			(void)sprintf(str, "%s%u", ACCEL_BASE_DEVICE_PATH, s);
-
-			int fd = px4_open(str, 0);
-
-			if (fd < 0) {
-				continue;
-			}
+		if (calibration_changed("ACC", change_seq)) {
+			for (unsigned s = 0; s < SENSOR_COUNT_MAX; s++) {
 
-			bool config_ok = false;
+				res = ERROR;
+				(void)sprintf(str, "%s%u", ACCEL_BASE_DEVICE_PATH, s);
 
-			/* run through all stored calibrations */ 
-			for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
-				/* initially status is ok per config */
-				failed = false;
+				int fd = px4_open(str, 0);
 
-				(void)sprintf(str, "CAL_ACC%u_ID", i);
-				int device_id;
-				failed = failed || (OK != param_get(param_find(str), &device_id));
-
-				if (failed) {
-					px4_close(fd);
+				if (fd < 0) {
 					continue;
 				}
 
-				/* if the calibration is for this device, apply it */
-				if (device_id == px4_ioctl(fd, DEVIOCGDEVICEID, 0)) {
-					struct accel_scale gscale = {};
-					(void)sprintf(str, "CAL_ACC%u_XOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.x_offset));
-					(void)sprintf(str, "CAL_ACC%u_YOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.y_offset));
-					(void)sprintf(str, "CAL_ACC%u_ZOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.z_offset));
-					(void)sprintf(str, "CAL_ACC%u_XSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.x_scale));
-					(void)sprintf(str, "CAL_ACC%u_YSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.y_scale));
-					(void)sprintf(str, "CAL_ACC%u_ZSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.z_scale));
+				bool config_ok = false;
+
+				/* run through all stored calibrations */ 
+				for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
+					/* initially status is ok per config */
+					failed = false;
+
+					(void)sprintf(str, "CAL_ACC%u_ID", i);
+					int device_id;
+					failed = failed || (OK != param_get(param_find(str), &device_id));
 
 					if (failed) {
-						warnx(CAL_ERROR_APPLY_CAL_MSG, "accel", i);
-					} else {
-						/* apply new scaling and offsets */
-						res = px4_ioctl(fd, ACCELIOCSSCALE, (long unsigned int)&gscale);
-						if (res) {
+						px4_close(fd);
+						continue;
+					}
+
+					/* if the calibration is for this device, apply it */
+					if (device_id == px4_ioctl(fd, DEVIOCGDEVICEID, 0)) {
+						struct accel_scale gscale = {};
+						(void)sprintf(str, "CAL_ACC%u_XOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.x_offset));
+						(void)sprintf(str, "CAL_ACC%u_YOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.y_offset));
+						(void)sprintf(str, "CAL_ACC%u_ZOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.z_offset));
+						(void)sprintf(str, "CAL_ACC%u_XSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.x_scale));
+						(void)sprintf(str, "CAL_ACC%u_YSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.y_scale));
+						(void)sprintf(str, "CAL_ACC%u_ZSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.z_scale));
+
+						if (failed) {
 							warnx(CAL_ERROR_APPLY_CAL_MSG, "accel", i);
 						} else {
-							config_ok = true;
+							/* apply new scaling and offsets */
+							res = px4_ioctl(fd, ACCELIOCSSCALE, (long unsigned int)&gscale);
+							if (res) {
+								warnx(CAL_ERROR_APPLY_CAL_MSG, "accel", i);
+							} else {
+								config_ok = true;
+							}
 						}
+						break;
 					}
-					break;
 				}
-			}
 
-			if (config_ok) {
-				accel_count++;
-			}
+				if (config_ok) {
+					accel_count++;
+				}
 
-			px4_close(fd);
+				px4_close(fd);
+			}
 		}
 
-		/* run through all mag sensors */
-		for (unsigned s = 0; s < SENSOR_COUNT_MAX; s++) {
+		/* run through all mag sensors, their rotation also depends on the board rotation */
+		if (calibration_changed("MAG", change_seq) ||
+		    param_changed_since(_parameter_handles.board_rotation, change_seq) ||
+		    param_changed_since(_parameter_handles.board_offset[0], change_seq) ||
+		    param_changed_since(_parameter_handles.board_offset[1], change_seq) ||
+		    param_changed_since(_parameter_handles.board_offset[2], change_seq) ||
+		    param_changed_since(param_find("SENS_EXT_MAG_ROT"), change_seq)) {
+			for (unsigned s = 0; s < SENSOR_COUNT_MAX; s++) {
+
+				/* set a valid default rotation (same as board).
+				 * if the mag is configured, this might be replaced
+				 * in the section below.
+				 */
+				_mag_rotation[s] = _board_rotation;
 
-			/* set a valid default rotation (same as board).
-			 * if the mag is configured, this might be replaced
-			 * in the section below.
-			 */
-			_mag_rotation[s] = _board_rotation;
+				res = ERROR;
+				(void)sprintf(str, "%s%u", MAG_BASE_DEVICE_PATH, s);
 
-			res = ERROR;
-			(void)sprintf(str, "%s%u", MAG_BASE_DEVICE_PATH, s);
+				int fd = px4_open(str, 0);
 
-			int fd = px4_open(str, 0);
+				if (fd < 0) {
+					/* the driver is not running, abort */
+					continue;
+				}
 
-			if (fd < 0) {
-				/* the driver is not running, abort */
-				continue;
-			}
+				bool config_ok = false;
 
-			bool config_ok = false;
+				/* run through all stored calibrations */ 
+				for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
+					/* initially status is ok per config */
+					failed = false;
 
-			/* run through all stored calibrations */ 
-			for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
-				/* initially status is ok per config */
-				failed = false;
+					(void)sprintf(str, "CAL_MAG%u_ID", i);
+					int device_id;
+					failed = failed || (OK != param_get(param_find(str), &device_id));
 
-				(void)sprintf(str, "CAL_MAG%u_ID", i);
-				int device_id;
-				failed = failed || (OK != param_get(param_find(str), &device_id));
+					if (failed) {
+						px4_close(fd);
+						continue;
+					}
 
-				if (failed) {
-					px4_close(fd);
-					continue;
-				}
+					/* if the calibration is for this device, apply it */
+					if (device_id == px4_ioctl(fd, DEVIOCGDEVICEID, 0)) {
+						struct mag_scale gscale = {};
+						(void)sprintf(str, "CAL_MAG%u_XOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.x_offset));
+						(void)sprintf(str, "CAL_MAG%u_YOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.y_offset));
+						(void)sprintf(str, "CAL_MAG%u_ZOFF", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.z_offset));
+						(void)sprintf(str, "CAL_MAG%u_XSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.x_scale));
+						(void)sprintf(str, "CAL_MAG%u_YSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.y_scale));
+						(void)sprintf(str, "CAL_MAG%u_ZSCALE", i);
+						failed = failed || (OK != param_get(param_find(str), &gscale.z_scale));
+
+						(void)sprintf(str, "CAL_MAG%u_ROT", i);
+
+						if (px4_ioctl(fd, MAGIOCGEXTERNAL, 0) <= 0) {
+							/* mag is internal */
+							_mag_rotation[s] = _board_rotation;
+							/* reset param to -1 to indicate internal mag */
+							int32_t mag_rot = 0;
+							param_get(param_find(str), &mag_rot);
+
+							if (mag_rot != MAG_ROT_VAL_INTERNAL) {
+								/* only on a change, a set marks the calibration as changed */
+								int32_t minus_one = MAG_ROT_VAL_INTERNAL;
+								param_set_no_notification(param_find(str), &minus_one);
+							}
+						} else {
 
-				/* if the calibration is for this device, apply it */
-				if (device_id == px4_ioctl(fd, DEVIOCGDEVICEID, 0)) {
-					struct mag_scale gscale = {};
-					(void)sprintf(str, "CAL_MAG%u_XOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.x_offset));
-					(void)sprintf(str, "CAL_MAG%u_YOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.y_offset));
-					(void)sprintf(str, "CAL_MAG%u_ZOFF", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.z_offset));
-					(void)sprintf(str, "CAL_MAG%u_XSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.x_scale));
-					(void)sprintf(str, "CAL_MAG%u_YSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.y_scale));
-					(void)sprintf(str, "CAL_MAG%u_ZSCALE", i);
-					failed = failed || (OK != param_get(param_find(str), &gscale.z_scale));
-
-					(void)sprintf(str, "CAL_MAG%u_ROT", i);
-
-					if (px4_ioctl(fd, MAGIOCGEXTERNAL, 0) <= 0) {
-						/* mag is internal */
-						_mag_rotation[s] = _board_rotation;
-						/* reset param to -1 to indicate internal mag */
-						int32_t minus_one = MAG_ROT_VAL_INTERNAL;
-						param_set_no_notification(param_find(str), &minus_one);
-					} else {
+							int32_t mag_rot;
+							param_get(param_find(str), &mag_rot);
 
-						int32_t mag_rot;
-						param_get(param_find(str), &mag_rot);
+							/* check if this mag is still set as internal */
+							if (mag_rot < 0) {
+								/* it was marked as internal, change to external with no rotation */
+								mag_rot = 0;
+								param_set_no_notification(param_find(str), &mag_rot);
+							}
 
-						/* check if this mag is still set as internal */
-						if (mag_rot < 0) {
-							/* it was marked as internal, change to external with no rotation */
-							mag_rot = 0;
-							param_set_no_notification(param_find(str), &mag_rot);
-						}
+							/* handling of old setups, will be removed later (noted Feb 2015) */
+							int32_t deprecated_mag_rot = 0;
+							param_get(param_find("SENS_EXT_MAG_ROT"), &deprecated_mag_rot);
+
+							/*
+							 * If the deprecated parameter is non-default (is != 0),
+							 * and the new parameter is default (is == 0), then this board
+							 * was configured already and we need to copy the old value
+							 * to the new parameter.
+							 * The < 0 case is special: It means that this param slot was
+							 * used previously by an internal sensor, but the the call above
+							 * proved that it is currently occupied by an external sensor.
+							 * In that case we consider the orientation to be default as well.
+							 */
+							if ((deprecated_mag_rot != 0) && (mag_rot <= 0)) {
+								mag_rot = deprecated_mag_rot;
+								param_set_no_notification(param_find(str), &mag_rot);
+								/* clear the old param, not supported in GUI anyway */
+								deprecated_mag_rot = 0;
+								param_set_no_notification(param_find("SENS_EXT_MAG_ROT"), &deprecated_mag_rot);
+							}
 
-						/* handling of old setups, will be removed later (noted Feb 2015) */
-						int32_t deprecated_mag_rot = 0;
-						param_get(param_find("SENS_EXT_MAG_ROT"), &deprecated_mag_rot);
-
-						/*
-						 * If the deprecated parameter is non-default (is != 0),
-						 * and the new parameter is default (is == 0), then this board
-						 * was configured already and we need to copy the old value
-						 * to the new parameter.
-						 * The < 0 case is special: It means that this param slot was
-						 * used previously by an internal sensor, but the the call above
-						 * proved that it is currently occupied by an external sensor.
-						 * In that case we consider the orientation to be default as well.
-						 */
-						if ((deprecated_mag_rot != 0) && (mag_rot <= 0)) {
-							mag_rot = deprecated_mag_rot;
-							param_set_no_notification(param_find(str), &mag_rot);
-							/* clear the old param, not supported in GUI anyway */
-							deprecated_mag_rot = 0;
-							param_set_no_notification(param_find("SENS_EXT_MAG_ROT"), &deprecated_mag_rot);
-						}
+							/* handling of transition from internal to external */
+							if (mag_rot < 0) {
+								mag_rot = 0;
+							}
 
-						/* handling of transition from internal to external */
-						if (mag_rot < 0) {
-							mag_rot = 0;
+							get_rot_matrix((enum Rotation)mag_rot, &_mag_rotation[s]);
 						}
 
-						get_rot_matrix((enum Rotation)mag_rot, &_mag_rotation[s]);
-					}
-
-					if (failed) {
-						warnx(CAL_ERROR_APPLY_CAL_MSG, "mag", i);
-					} else {
-						/* apply new scaling and offsets */
-						res = px4_ioctl(fd, MAGIOCSSCALE, (long unsigned int)&gscale);
-						if (res) {
+						if (failed) {
 							warnx(CAL_ERROR_APPLY_CAL_MSG, "mag", i);
 						} else {
-							config_ok = true;
+							/* apply new scaling and offsets */
+							res = px4_ioctl(fd, MAGIOCSSCALE, (long unsigned int)&gscale);
+							if (res) {
+								warnx(CAL_ERROR_APPLY_CAL_MSG, "mag", i);
+							} else {
+								config_ok = true;
+							}
 						}
+						break;
 					}
-					break;
 				}
-			}
 
-			if (config_ok) {
-				mag_count++;
-			}
+				if (config_ok) {
+					mag_count++;
+				}
 
-			px4_close(fd);
+				px4_close(fd);
+			}
 		}
 
-		int fd = px4_open(AIRSPEED0_DEVICE_PATH, 0);
+		if (param_changed_since(_parameter_handles.diff_pres_offset_pa, change_seq)) {
+			int fd = px4_open(AIRSPEED0_DEVICE_PATH, 0);
 
-		/* this sensor is optional, abort without error */
+			/* this sensor is optional, abort without error */
 
-		if (fd >= 0) {
-			struct airspeed_scale airscale = {
-				_parameters.diff_pres_offset_pa,
-				1.0f,
-			};
+			if (fd >= 0) {
+				struct airspeed_scale airscale = {
+					_parameters.diff_pres_offset_pa,
+					1.0f,
+				};
 
-			if (OK != px4_ioctl(fd, AIRSPEEDIOCSSCALE, (long unsigned int)&airscale)) {
-				warn("WARNING: failed to set scale / offsets for airspeed sensor");
-			}
+				if (OK != px4_ioctl(fd, AIRSPEEDIOCSSCALE, (long unsigned int)&airscale)) {
+					warn("WARNING: failed to set scale / offsets for airspeed sensor");
+				}
 
-			px4_close(fd);
+				px4_close(fd);
+			}
 		}
 
 		/* do not output this for now, as its covered in preflight checks */
@@ -1515,6 +1665,27 @@ Sensors::parameter_update_poll(bool forced)
 	}
 }
 
+bool
+Sensors::calibration_changed(const char *sensor, uint32_t change_seq)
+{
+	static const char *const suffixes[] = {"ID", "XOFF", "YOFF", "ZOFF", "XSCALE", "YSCALE", "ZSCALE", "ROT"};
+	char str[30];
+
+	for (unsigned i = 0; i < SENSOR_COUNT_MAX; i++) {
+		for (unsigned k = 0; k < sizeof(suffixes) / sizeof(suffixes[0]); k++) {
+			(void)sprintf(str, "CAL_%s%u_%s", sensor, i, suffixes[k]);
+			param_t param = param_find_no_notification(str);
+
+			/* not every sensor type has every parameter */
+			if (param != PARAM_INVALID && param_changed_since(param, change_seq)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 void
 Sensors::rc_parameter_map_poll(bool forced)
 {
@@ -1575,6 +1746,14 @@ Sensors::adc_poll(struct sensor_combined_s &raw)
 		/* read all channels available */
 		int ret = px4_read(_fd_adc, &buf_adc, sizeof(buf_adc));
 
+		/*
+		 * Prefer the driver's integral of the current channel, which covers
+		 * every sample instead of one reading per call.
+		 */
+		struct adc_integral_s current_integral;
+		current_integral.channel = ADC_BATTERY_CURRENT_CHANNEL;
+		bool have_integral = (px4_ioctl(_fd_adc, ADCIOCGINTEGRAL, (unsigned long)&current_integral) == OK);
+
 		if (ret >= (int)sizeof(buf_adc[0])) {
 
 			/* Read add channels we got */
@@ -1623,7 +1802,14 @@ Sensors::adc_poll(struct sensor_combined_s &raw)
 									_battery_status.discharged_mah = 0.0f;
 								}
 
-								_battery_discharged += current * (t - _battery_current_timestamp);
+								if (have_integral) {
+									_battery_discharged += (current_integral.integral - _battery_current_integral) *
+											       _parameters.battery_current_scaling;
+
+								} else {
+									_battery_discharged += current * (t - _battery_current_timestamp);
+								}
+
 								_battery_status.discharged_mah = ((float) _battery_discharged) / 3600000.0f;
 							}
 						}
@@ -1631,6 +1817,10 @@ Sensors::adc_poll(struct sensor_combined_s &raw)
 
 					_battery_current_timestamp = t;
 
+					if (have_integral) {
+						_battery_current_integral = current_integral.integral;
+					}
+
 				} else if (ADC_AIRSPEED_VOLTAGE_CHANNEL == buf_adc[i].am_channel) {
 
 					/* calculate airspeed, raw is the difference from */
@@ -1761,6 +1951,30 @@ Sensors::set_params_from_rc()
 	}
 }
 
+bool
+Sensors::manual_control_changed(const struct manual_control_setpoint_s &manual,
+				const struct manual_control_setpoint_s &last)
+{
+	const float axes[][2] = {
+		{manual.x, last.x}, {manual.y, last.y}, {manual.z, last.z}, {manual.r, last.r},
+		{manual.flaps, last.flaps}, {manual.aux1, last.aux1}, {manual.aux2, last.aux2},
+		{manual.aux3, last.aux3}, {manual.aux4, last.aux4}, {manual.aux5, last.aux5}
+	};
+
+	for (unsigned i = 0; i < sizeof(axes) / sizeof(axes[0]); i++) {
+		if (fabsf(axes[i][0] - axes[i][1]) > _manual_change_threshold) {
+			return true;
+		}
+	}
+
+	return manual.mode_switch != last.mode_switch ||
+	       manual.posctl_switch != last.posctl_switch ||
+	       manual.return_switch != last.return_switch ||
+	       manual.loiter_switch != last.loiter_switch ||
+	       manual.acro_switch != last.acro_switch ||
+	       manual.offboard_switch != last.offboard_switch;
+}
+
 void
 Sensors::rc_poll()
 {
@@ -1808,55 +2022,23 @@ Sensors::rc_poll()
 			channel_limit = _rc_max_chan_count;
 		}
 
-		/* read out and scale values from raw message even if signal is invalid */
+		/*
+		 * Read out and scale values from raw message even if signal is invalid.
+		 *
+		 * 1) Constrain to min/max values, as later processing depends on bounds.
+		 *
+		 * 2) Scale around the mid point differently for lower and upper range,
+		 * as they don't share the same endpoints and slope. Above the dead zone
+		 * only the upper piece is non-zero, below it only the lower one and in
+		 * the dead zone both are zero. The pieces and the reverse factor were
+		 * folded into per channel coefficients by parameters_update(), so the
+		 * loop has no branches and the compiler can vectorize it.
+		 */
 		for (unsigned int i = 0; i < channel_limit; i++) {
+			float value = fminf(fmaxf((float)rc_input.values[i], _parameters.min[i]), _parameters.max[i]);
 
-			/*
-			 * 1) Constrain to min/max values, as later processing depends on bounds.
-			 */
-			if (rc_input.values[i] < _parameters.min[i]) {
-				rc_input.values[i] = _parameters.min[i];
-			}
-
-			if (rc_input.values[i] > _parameters.max[i]) {
-				rc_input.values[i] = _parameters.max[i];
-			}
-
-			/*
-			 * 2) Scale around the mid point differently for lower and upper range.
-			 *
-			 * This is necessary as they don't share the same endpoints and slope.
-			 *
-			 * First normalize to 0..1 range with correct sign (below or above center),
-			 * the total range is 2 (-1..1).
-			 * If center (trim) == min, scale to 0..1, if center (trim) == max,
-			 * scale to -1..0.
-			 *
-			 * As the min and max bounds were enforced in step 1), division by zero
-			 * cannot occur, as for the case of center == min or center == max the if
-			 * statement is mutually exclusive with the arithmetic NaN case.
-			 *
-			 * DO NOT REMOVE OR ALTER STEP 1!
-			 */
-			if (rc_input.values[i] > (_parameters.trim[i] + _parameters.dz[i])) {
-				_rc.channels[i] = (rc_input.values[i] - _parameters.trim[i] - _parameters.dz[i]) / (float)(
-							  _parameters.max[i] - _parameters.trim[i] - _parameters.dz[i]);
-
-			} else if (rc_input.values[i] < (_parameters.trim[i] - _parameters.dz[i])) {
-				_rc.channels[i] = (rc_input.values[i] - _parameters.trim[i] + _parameters.dz[i]) / (float)(
-							  _parameters.trim[i] - _parameters.min[i] - _parameters.dz[i]);
-
-			} else {
-				/* in the configured dead zone, output zero */
-				_rc.channels[i] = 0.0f;
-			}
-
-			_rc.channels[i] *= _parameters.rev[i];
-
-			/* handle any parameter-induced blowups */
-			if (!PX4_ISFINITE(_rc.channels[i])) {
-				_rc.channels[i] = 0.0f;
-			}
+			_rc.channels[i] = fmaxf(value - _parameters.offset_hi[i], 0.0f) * _parameters.slope_hi[i]
+					  + fminf(value - _parameters.offset_lo[i], 0.0f) * _parameters.slope_lo[i];
 		}
 
 		_rc.channel_count = rc_input.channel_count;
@@ -1899,6 +2081,19 @@ Sensors::rc_poll()
 			manual.acro_switch = get_rc_sw2pos_position (rc_channels_s::RC_CHANNELS_FUNCTION_ACRO, _parameters.rc_acro_th, _parameters.rc_acro_inv);
 			manual.offboard_switch = get_rc_sw2pos_position (rc_channels_s::RC_CHANNELS_FUNCTION_OFFBOARD, _parameters.rc_offboard_th, _parameters.rc_offboard_inv);
 
+			/*
+			 * Skip the update if neither a stick moved noticeably nor a switch
+			 * changed. Publish at a minimum rate regardless, the commander
+			 * detects RC loss from the age of the timestamp.
+			 */
+			if (_manual_control_pub != nullptr &&
+			    manual.timestamp - _manual.timestamp < _manual_publish_interval &&
+			    !manual_control_changed(manual, _manual)) {
+				return;
+			}
+
+			_manual = manual;
+
 			/* publish manual_control_setpoint topic */
 			if (_manual_control_pub != nullptr) {
 				orb_publish(ORB_ID(manual_control_setpoint), _manual_control_pub, &manual);
@@ -2056,6 +2251,7 @@ Sensors::task_main()
 
 	/* advertise the sensor_combined topic and make the initial publication */
 	_sensor_pub = orb_advertise(ORB_ID(sensor_combined), &raw);
+	integrals_reset(raw);
 
 	/* wakeup source(s) */
 	px4_pollfd_struct_t fds[1];
@@ -2083,30 +2279,46 @@ Sensors::task_main()
 
 		perf_begin(_loop_perf);
 
-		/* check vehicle status for changes to publication state */
-		vehicle_control_mode_poll();
+		/* the timestamp of the raw struct is updated by the gyro_poll() method */
+		/* copy most recent sensor data, only topics with new data are copied */
+		unsigned updated = 0;
 
-		/* keep adding sensors as long as we are not armed */
-		if (!_armed) {
-			_gyro_count = init_sensor_class(ORB_ID(sensor_gyro), &_gyro_sub[0],
-				&raw.gyro_priority[0], &raw.gyro_errcount[0]);
+		if (gyro_poll(raw)) {
+			updated |= SENSOR_UPDATE_GYRO;
+		}
 
-			_mag_count = init_sensor_class(ORB_ID(sensor_mag), &_mag_sub[0],
-				&raw.magnetometer_priority[0], &raw.magnetometer_errcount[0]);
+		if (accel_poll(raw)) {
+			updated |= SENSOR_UPDATE_ACCEL;
+		}
 
-			_accel_count = init_sensor_class(ORB_ID(sensor_accel), &_accel_sub[0],
-				&raw.accelerometer_priority[0], &raw.accelerometer_errcount[0]);
+		if (mag_poll(raw)) {
+			updated |= SENSOR_UPDATE_MAG;
+		}
 
-			_baro_count = init_sensor_class(ORB_ID(sensor_baro), &_baro_sub[0],
-				&raw.baro_priority[0], &raw.baro_errcount[0]);
+		if (baro_poll(raw)) {
+			updated |= SENSOR_UPDATE_BARO;
 		}
 
-		/* the timestamp of the raw struct is updated by the gyro_poll() method */
-		/* copy most recent sensor data */
-		gyro_poll(raw);
-		accel_poll(raw);
-		mag_poll(raw);
-		baro_poll(raw);
+		/* the differential pressure goes out with the sample set it arrived with */
+		diff_pres_poll(raw);
+
+		/*
+		 * Inform other processes that new data is available to copy. This is done
+		 * right away so the estimators do not wait on the slower sensors below, a poll
+		 * timeout without new data does not republish the previous set. With an
+		 * integration interval set the delta angles and velocities of all reports
+		 * in that interval go out together in one publication.
+		 */
+		if (updated != 0 &&
+		    hrt_elapsed_time(&_last_combined) >= (hrt_abstime)_parameters.imu_integration_interval) {
+
+			if (_publishing && raw.timestamp > 0) {
+				orb_publish(ORB_ID(sensor_combined), _sensor_pub, &raw);
+			}
+
+			_last_combined = hrt_absolute_time();
+			integrals_reset(raw);
+		}
 
 		/* work out if main gyro timed out and fail over to alternate gyro */
 		if (hrt_elapsed_time(&raw.gyro_timestamp[0]) > 20 * 1000) {
@@ -2122,18 +2334,34 @@ Sensors::task_main()
 		/* check battery voltage */
 		adc_poll(raw);
 
-		diff_pres_poll(raw);
+		/* topics not feeding sensor_combined do not need to be checked at gyro rate */
+		if (hrt_elapsed_time(&_last_housekeeping) >= HOUSEKEEPING_INTERVAL) {
+			_last_housekeeping = hrt_absolute_time();
 
-		/* Inform other processes that new data is available to copy */
-		if (_publishing && raw.timestamp > 0) {
-			orb_publish(ORB_ID(sensor_combined), _sensor_pub, &raw);
-		}
+			/* check vehicle status for changes to publication state */
+			vehicle_control_mode_poll();
+
+			/* keep adding sensors as long as we are not armed */
+			if (!_armed) {
+				_gyro_count = init_sensor_class(ORB_ID(sensor_gyro), &_gyro_sub[0],
+					&raw.gyro_priority[0], &raw.gyro_errcount[0]);
 
-		/* check parameters for updates */
-		parameter_update_poll();
+				_mag_count = init_sensor_class(ORB_ID(sensor_mag), &_mag_sub[0],
+					&raw.magnetometer_priority[0], &raw.magnetometer_errcount[0]);
 
-		/* check rc parameter map for updates */
-		rc_parameter_map_poll();
+				_accel_count = init_sensor_class(ORB_ID(sensor_accel), &_accel_sub[0],
+					&raw.accelerometer_priority[0], &raw.accelerometer_errcount[0]);
+
+				_baro_count = init_sensor_class(ORB_ID(sensor_baro), &_baro_sub[0],
+					&raw.baro_priority[0], &raw.baro_errcount[0]);
+			}
+
+			/* check parameters for updates */
+			parameter_update_poll();
+
+			/* check rc parameter map for updates */
+			rc_parameter_map_poll();
+		}
 
 		/* Look for new r/c input data */
 		rc_poll();
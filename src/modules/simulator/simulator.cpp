@@ -122,6 +122,10 @@ int Simulator::start(int argc, char *argv[])
 	if (_instance) {
 		PX4_INFO("Simulator started");
 		drv_led_start();
+#ifndef __PX4_QURT
+		_instance->_lockstep = (argc > 3 && strcmp(argv[3], "-l") == 0);
+#endif
+		_instance->_publish = (argv[2][1] == 'p');
 		if (argv[2][1] == 's') {
 			_instance->initializeSensorData();
 #ifndef __PX4_QURT
@@ -143,9 +147,10 @@ int Simulator::start(int argc, char *argv[])
 
 static void usage()
 {
-	PX4_WARN("Usage: simulator {start -[sc] |stop}");
+	PX4_WARN("Usage: simulator {start -[sp] [-l] |stop}");
 	PX4_WARN("Simulate raw sensors:     simulator start -s");
-	PX4_WARN("Publish sensors combined: simulator start -p");
+	PX4_WARN("Publish sensor topics:    simulator start -p");
+	PX4_WARN("Lockstep with sim time:   simulator start -s -l");
 }
 
 __BEGIN_DECLS
@@ -157,7 +162,7 @@ extern "C" {
 int simulator_main(int argc, char *argv[])
 {
 	int ret = 0;
-	if (argc == 3 && strcmp(argv[1], "start") == 0) {
+	if ((argc == 3 || (argc == 4 && strcmp(argv[3], "-l") == 0)) && strcmp(argv[1], "start") == 0) {
 		if (strcmp(argv[2], "-s") == 0 || strcmp(argv[2], "-p") == 0) {
 			if (g_sim_task >= 0) {
 				warnx("Simulator already started");
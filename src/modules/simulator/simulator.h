@@ -209,6 +209,12 @@ public:
 
 	bool isInitialized() { return _initialized; }
 
+	/**
+	 * True if the sensor topics are published by the simulator directly,
+	 * the simulated sensor drivers then only provide their device nodes.
+	 */
+	bool publishesSensors() { return _publish; }
+
 private:
 	Simulator() :
 	_accel(1),
@@ -221,10 +227,20 @@ private:
 	_baro_pub(nullptr),
 	_gyro_pub(nullptr),
 	_mag_pub(nullptr),
-	_initialized(false)
+	_accel_orb_class_instance(-1),
+	_gyro_orb_class_instance(-1),
+	_mag_orb_class_instance(-1),
+	_baro_orb_class_instance(-1),
+	_last_imu_timestamp(0),
+	_sensor_time_offset(0),
+	_initialized(false),
+	_publish(false)
 #ifndef __PX4_QURT
 	,
 	_rc_channels_pub(nullptr),
+	_lockstep(false),
+	_sim_time_start(0),
+	_hrt_time_start(0),
 	_actuator_outputs_sub(-1),
 	_vehicle_attitude_sub(-1),
 	_manual_sub(-1),
@@ -256,15 +272,32 @@ private:
 	orb_advert_t _gyro_pub;
 	orb_advert_t _mag_pub;
 
+	int _accel_orb_class_instance;
+	int _gyro_orb_class_instance;
+	int _mag_orb_class_instance;
+	int _baro_orb_class_instance;
+
+	// sample time of the last published IMU reports, and the offset from
+	// the simulation time to the system time it is derived from
+	hrt_abstime _last_imu_timestamp;
+	int64_t _sensor_time_offset;
+
 	bool _initialized;
+	bool _publish;
 
 	// class methods
 	int publish_sensor_topics(mavlink_hil_sensor_t *imu);
+	hrt_abstime sensor_timestamp(uint64_t sim_time_usec);
 
 #ifndef __PX4_QURT
 	// uORB publisher handlers
 	orb_advert_t _rc_channels_pub;
 
+	// lockstep mode, the system time follows the HIL_SENSOR timestamps
+	bool _lockstep;
+	uint64_t _sim_time_start;
+	hrt_abstime _hrt_time_start;
+
 	// uORB subscription handlers
 	int _actuator_outputs_sub;
 	int _vehicle_attitude_sub;
@@ -287,6 +320,7 @@ private:
 	void send_mavlink_message(const uint8_t msgid, const void *msg, uint8_t component_ID);
 	void update_sensors(mavlink_hil_sensor_t *imu);
 	void update_gps(mavlink_hil_gps_t *gps_sim);
+	void update_lockstep_time(uint64_t sim_time_usec);
 	static void *sending_trampoline(void *);
 	void send();
 #endif
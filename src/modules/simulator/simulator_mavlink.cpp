@@ -33,6 +33,7 @@
 #include <termios.h>
 #include <px4_log.h>
 #include <px4_time.h>
+#include <px4_middleware.h>
 #include "simulator.h"
 #include "errno.h"
 #include <geo/geo.h>
@@ -50,6 +51,9 @@ extern "C" __EXPORT hrt_abstime hrt_reset(void);
 #define DENSITY 1.2041f
 #define GRAVITY 9.81f
 
+#define SENSOR_TIME_MAX_LAG	20000	// us a sample time may fall behind the system time
+#define SENSOR_INTEGRAL_MAX_DT	100000	// us, longer gaps are not integrated
+
 static const uint8_t mavlink_message_lengths[256] = MAVLINK_MESSAGE_LENGTHS;
 static const uint8_t mavlink_message_crcs[256] = MAVLINK_MESSAGE_CRCS;
 static const float mg2ms2 = CONSTANTS_ONE_G / 1000.0f;
@@ -160,6 +164,17 @@ static void fill_rc_input_msg(struct rc_input_values *rc, mavlink_rc_channels_t
 
 void Simulator::update_sensors(mavlink_hil_sensor_t *imu) {
 	// write sensor data to memory so that drivers can copy data from there
+	RawAirspeedData airspeed;
+	airspeed.temperature = imu->temperature;
+	airspeed.diff_pressure = imu->diff_pressure;
+
+	write_airspeed_data((void *)&airspeed);
+
+	// the IMU and baro topics are already published, no driver copies them
+	if (_publish) {
+		return;
+	}
+
 	RawMPUData mpu;
 	mpu.accel_x = imu->xacc;
 	mpu.accel_y = imu->yacc;
@@ -192,12 +207,6 @@ void Simulator::update_sensors(mavlink_hil_sensor_t *imu) {
 	baro.temperature = imu->temperature;
 
 	write_baro_data((void *)&baro);
-
-	RawAirspeedData airspeed;
-	airspeed.temperature = imu->temperature;
-	airspeed.diff_pressure = imu->diff_pressure;
-
-	write_airspeed_data((void *)&airspeed);
 }
 
 void Simulator::update_gps(mavlink_hil_gps_t *gps_sim) {
@@ -218,11 +227,26 @@ void Simulator::update_gps(mavlink_hil_gps_t *gps_sim) {
 	write_gps_data((void *)&gps);
 }
 
+void Simulator::update_lockstep_time(uint64_t sim_time_usec) {
+	// anchor the simulation time to the system time on the first sample
+	if (_sim_time_start == 0) {
+		_sim_time_start = sim_time_usec;
+		_hrt_time_start = hrt_absolute_time();
+	}
+
+	if (sim_time_usec > _sim_time_start) {
+		hrt_lockstep_set_time(_hrt_time_start + (sim_time_usec - _sim_time_start));
+	}
+}
+
 void Simulator::handle_message(mavlink_message_t *msg, bool publish) {
 	switch(msg->msgid) {
 	case MAVLINK_MSG_ID_HIL_SENSOR:
 		mavlink_hil_sensor_t imu;
 		mavlink_msg_hil_sensor_decode(msg, &imu);
+		if (_lockstep) {
+			update_lockstep_time(imu.time_usec);
+		}
 		if (publish) {
 			publish_sensor_topics(&imu);
 		}
@@ -364,7 +388,7 @@ void Simulator::pollForMAVLinkMessages(bool publish)
 {
 	// udp socket data
 	struct sockaddr_in _myaddr;
-	const int _port = UDP_PORT;
+	const int _port = px4::instance_port(UDP_PORT);
 
 	// try to setup udp socket for communcation with simulator
 	memset((char *)&_myaddr, 0, sizeof(_myaddr));
@@ -414,11 +438,13 @@ void Simulator::pollForMAVLinkMessages(bool publish)
 
 	char serial_buf[1024];
 
-	struct pollfd fds[2];
+	struct pollfd fds[3];
 	fds[0].fd = _fd;
 	fds[0].events = POLLIN;
 	fds[1].fd = serial_fd;
 	fds[1].events = POLLIN;
+	fds[2].fd = -1;
+	fds[2].events = POLLIN;
 
 	int len = 0;
 
@@ -434,6 +460,12 @@ void Simulator::pollForMAVLinkMessages(bool publish)
 	// reset system time
 	(void)hrt_reset();
 
+	if (_lockstep) {
+		// from now on the time only advances with the sensor data of the simulator
+		hrt_lockstep_enable();
+		PX4_WARN("Lockstep enabled, system time follows the simulator");
+	}
+
 	if (fds[0].revents & POLLIN) {
 		len = recvfrom(_fd, _buf, sizeof(_buf), 0, (struct sockaddr *)&_srcaddr, &_addrlen);
 		PX4_WARN("Sending initial controls message to jMAVSim.");
@@ -444,8 +476,14 @@ void Simulator::pollForMAVLinkMessages(bool publish)
 	_actuator_outputs_sub = orb_subscribe_multi(ORB_ID(actuator_outputs), 0);
 	_vehicle_status_sub = orb_subscribe(ORB_ID(vehicle_status));
 
-	// got data from simulator, now activate the sending thread
-	pthread_create(&sender_thread, &sender_thread_attr, Simulator::sending_trampoline, NULL);
+	// wait for the actuator outputs in this thread if the topic can be
+	// polled together with the sockets, else activate the sending thread
+	fds[2].fd = px4_event_fd(_actuator_outputs_sub);
+
+	if (fds[2].fd < 0) {
+		pthread_create(&sender_thread, &sender_thread_attr, Simulator::sending_trampoline, NULL);
+	}
+
 	pthread_attr_destroy(&sender_thread_attr);
 
 	// wait for new mavlink messages to arrive
@@ -482,6 +520,14 @@ void Simulator::pollForMAVLinkMessages(bool publish)
 			}
 		}
 
+		// got new actuator outputs
+		if (fds[2].revents & POLLIN) {
+			uint64_t events;
+			(void)::read(fds[2].fd, &events, sizeof(events));
+			poll_topics();
+			send_controls();
+		}
+
 		// got data from PIXHAWK
 		if (fds[1].revents & POLLIN) {
 			len = ::read(serial_fd, serial_buf, sizeof(serial_buf));
@@ -603,44 +649,66 @@ int openUart(const char *uart_name, int baud)
 	return uart_fd;
 }
 
+hrt_abstime Simulator::sensor_timestamp(uint64_t sim_time_usec) {
+	hrt_abstime now = hrt_absolute_time();
+
+	// in lockstep the system time already is the simulation time of this sample
+	if (_lockstep) {
+		return now;
+	}
+
+	// otherwise follow the simulation clock, which does not see the receive jitter,
+	// and re-anchor it to the system time if it runs ahead or falls behind too far
+	hrt_abstime timestamp = (hrt_abstime)((int64_t)sim_time_usec + _sensor_time_offset);
+
+	if (_sensor_time_offset == 0 || timestamp > now || now - timestamp > SENSOR_TIME_MAX_LAG) {
+		_sensor_time_offset = (int64_t)now - (int64_t)sim_time_usec;
+		timestamp = now;
+	}
+
+	return timestamp;
+}
+
 int Simulator::publish_sensor_topics(mavlink_hil_sensor_t *imu) {
+	hrt_abstime timestamp = sensor_timestamp(imu->time_usec);
+
+	if ((imu->fields_updated & 0x1FFF) != 0x1FFF) {
+		PX4_DEBUG("All sensor fields in mavlink HIL_SENSOR packet not updated.  Got %08x", imu->fields_updated);
+	}
+
+	// integrate over the time since the previous sample, as the drivers do
+	uint64_t integral_dt = 0;
+
+	if (_last_imu_timestamp != 0 && timestamp > _last_imu_timestamp &&
+	    timestamp - _last_imu_timestamp < SENSOR_INTEGRAL_MAX_DT) {
+		integral_dt = timestamp - _last_imu_timestamp;
+	}
 
+	_last_imu_timestamp = timestamp;
+	float dt = integral_dt / 1e6f;
 
-        //uint64_t timestamp = imu->time_usec;
-        uint64_t timestamp = hrt_absolute_time();
-
-        if((imu->fields_updated & 0x1FFF)!=0x1FFF) {
-	   	        PX4_DEBUG("All sensor fields in mavlink HIL_SENSOR packet not updated.  Got %08x",imu->fields_updated);
-        }
-	/*
-	  static int count=0;
-	  static uint64_t last_timestamp=0;
-	  count++;
-	  if (!(count % 200)) {
-		PX4_WARN("TIME : %lu,   dt: %lu",
-			 (unsigned long) timestamp,(unsigned long) timestamp - (unsigned long) last_timestamp);
-		PX4_WARN("IMU  : %f %f %f",imu->xgyro,imu->ygyro,imu->zgyro);
-		PX4_WARN("ACCEL: %f %f %f",imu->xacc,imu->yacc,imu->zacc);
-		PX4_WARN("MAG  : %f %f %f",imu->xmag,imu->ymag,imu->zmag);
-		PX4_WARN("BARO : %f %f %f",imu->abs_pressure,imu->pressure_alt,imu->temperature);
-	}
-	last_timestamp = timestamp;
-	*/
 	/* gyro */
 	{
 		struct gyro_report gyro;
 		memset(&gyro, 0, sizeof(gyro));
 
 		gyro.timestamp = timestamp;
+		gyro.integral_dt = integral_dt;
 		gyro.x_raw = imu->xgyro * 1000.0f;
 		gyro.y_raw = imu->ygyro * 1000.0f;
 		gyro.z_raw = imu->zgyro * 1000.0f;
 		gyro.x = imu->xgyro;
 		gyro.y = imu->ygyro;
 		gyro.z = imu->zgyro;
+		gyro.x_integral = imu->xgyro * dt;
+		gyro.y_integral = imu->ygyro * dt;
+		gyro.z_integral = imu->zgyro * dt;
+		gyro.temperature = imu->temperature;
+		gyro.scaling = 1.0f;
 
 		if (_gyro_pub == nullptr) {
-			_gyro_pub = orb_advertise(ORB_ID(sensor_gyro), &gyro);
+			_gyro_pub = orb_advertise_multi_queue(ORB_ID(sensor_gyro), &gyro, &_gyro_orb_class_instance,
+							      ORB_PRIO_HIGH, SENSOR_ORB_QUEUE_SIZE);
 
 		} else {
 			orb_publish(ORB_ID(sensor_gyro), _gyro_pub, &gyro);
@@ -653,15 +721,22 @@ int Simulator::publish_sensor_topics(mavlink_hil_sensor_t *imu) {
 		memset(&accel, 0, sizeof(accel));
 
 		accel.timestamp = timestamp;
+		accel.integral_dt = integral_dt;
 		accel.x_raw = imu->xacc / mg2ms2;
 		accel.y_raw = imu->yacc / mg2ms2;
 		accel.z_raw = imu->zacc / mg2ms2;
 		accel.x = imu->xacc;
 		accel.y = imu->yacc;
 		accel.z = imu->zacc;
+		accel.x_integral = imu->xacc * dt;
+		accel.y_integral = imu->yacc * dt;
+		accel.z_integral = imu->zacc * dt;
+		accel.temperature = imu->temperature;
+		accel.scaling = 1.0f;
 
 		if (_accel_pub == nullptr) {
-			_accel_pub = orb_advertise(ORB_ID(sensor_accel), &accel);
+			_accel_pub = orb_advertise_multi_queue(ORB_ID(sensor_accel), &accel, &_accel_orb_class_instance,
+							       ORB_PRIO_HIGH, SENSOR_ORB_QUEUE_SIZE);
 
 		} else {
 			orb_publish(ORB_ID(sensor_accel), _accel_pub, &accel);
@@ -680,10 +755,11 @@ int Simulator::publish_sensor_topics(mavlink_hil_sensor_t *imu) {
 		mag.x = imu->xmag;
 		mag.y = imu->ymag;
 		mag.z = imu->zmag;
+		mag.temperature = imu->temperature;
+		mag.scaling = 1.0f;
 
 		if (_mag_pub == nullptr) {
-			/* publish to the first mag topic */
-			_mag_pub = orb_advertise(ORB_ID(sensor_mag), &mag);
+			_mag_pub = orb_advertise_multi(ORB_ID(sensor_mag), &mag, &_mag_orb_class_instance, ORB_PRIO_LOW);
 
 		} else {
 			orb_publish(ORB_ID(sensor_mag), _mag_pub, &mag);
@@ -701,12 +777,12 @@ int Simulator::publish_sensor_topics(mavlink_hil_sensor_t *imu) {
 		baro.temperature = imu->temperature;
 
 		if (_baro_pub == nullptr) {
-			_baro_pub = orb_advertise(ORB_ID(sensor_baro), &baro);
+			_baro_pub = orb_advertise_multi(ORB_ID(sensor_baro), &baro, &_baro_orb_class_instance, ORB_PRIO_DEFAULT);
 
 		} else {
 			orb_publish(ORB_ID(sensor_baro), _baro_pub, &baro);
 		}
 	}
 
-        return OK;
+	return OK;
 }
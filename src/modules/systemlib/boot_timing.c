@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file boot_timing.c
+ *
+ * Boot phase timestamps, see boot_timing.h.
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <drivers/drv_hrt.h>
+
+#include "boot_timing.h"
+
+struct boot_timing_s {
+	hrt_abstime	time;
+	char		name[BOOT_TIMING_NAME_LEN];
+};
+
+static struct boot_timing_s boot_timings[BOOT_TIMING_MAX];
+
+/* slots are reserved atomically, the count is published once a slot is filled */
+static volatile unsigned boot_timing_reserved = 0;
+static volatile unsigned boot_timing_used = 0;
+
+int
+boot_timing_mark(const char *name)
+{
+	hrt_abstime now = hrt_absolute_time();
+	unsigned index = __sync_fetch_and_add(&boot_timing_reserved, 1);
+
+	if (index >= BOOT_TIMING_MAX) {
+		boot_timing_reserved = BOOT_TIMING_MAX;
+		return -1;
+	}
+
+	boot_timings[index].time = now;
+	strncpy(boot_timings[index].name, name, BOOT_TIMING_NAME_LEN - 1);
+	boot_timings[index].name[BOOT_TIMING_NAME_LEN - 1] = '\0';
+
+	__sync_synchronize();
+
+	/* concurrent marks may publish out of order, only ever grow the count */
+	if (index + 1 > boot_timing_used) {
+		boot_timing_used = index + 1;
+	}
+
+	return 0;
+}
+
+unsigned
+boot_timing_count(void)
+{
+	return boot_timing_used;
+}
+
+int
+boot_timing_get(unsigned index, const char **name, uint64_t *time)
+{
+	if (index >= boot_timing_used) {
+		return -1;
+	}
+
+	*name = boot_timings[index].name;
+	*time = boot_timings[index].time;
+	return 0;
+}
+
+void
+boot_timing_print(void)
+{
+	unsigned count = boot_timing_count();
+	hrt_abstime previous = 0;
+
+	printf("     since boot     delta  phase\n");
+
+	for (unsigned i = 0; i < count; i++) {
+		const char *name;
+		uint64_t time;
+
+		if (boot_timing_get(i, &name, &time) != 0) {
+			break;
+		}
+
+		printf("%12.3f ms %6.0f ms  %s\n", (double)time / 1e3, (double)(time - previous) / 1e3, name);
+		previous = time;
+	}
+
+	if (count >= BOOT_TIMING_MAX) {
+		printf("table full, later phases dropped\n");
+	}
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file boot_timing.h
+ *
+ * Table of named boot phase timestamps, from the first line of the startup
+ * script until the system is ready.
+ *
+ * Phases are marked from the startup scripts with the boot_timing command
+ * and from code with boot_timing_mark(). The table is printed by the
+ * boot_timing command and written to the first sdlog2 log file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <px4_defines.h>
+
+/**
+ * Number of phases recorded, later marks are dropped.
+ */
+#define BOOT_TIMING_MAX		32
+#define BOOT_TIMING_NAME_LEN	16
+
+__BEGIN_DECLS
+
+/**
+ * Record the current time for a boot phase.
+ *
+ * @param name			The phase name, truncated to BOOT_TIMING_NAME_LEN - 1 characters.
+ * @return			0 on success, -1 if the table is full.
+ */
+__EXPORT extern int boot_timing_mark(const char *name);
+
+/**
+ * Number of phases recorded so far.
+ */
+__EXPORT extern unsigned boot_timing_count(void);
+
+/**
+ * Get a recorded phase.
+ *
+ * @param index			The phase, in the order they were marked.
+ * @param name			Set to the phase name.
+ * @param time			Set to the absolute time of the mark.
+ * @return			0 on success, -1 if index is out of range.
+ */
+__EXPORT extern int boot_timing_get(unsigned index, const char **name, uint64_t *time);
+
+/**
+ * Print the phases with their time since boot and the previous phase.
+ */
+__EXPORT extern void boot_timing_print(void);
+
+__END_DECLS
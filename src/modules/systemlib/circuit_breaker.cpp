@@ -43,9 +43,12 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <px4_defines.h>
 #include <systemlib/circuit_breaker.h>
 
+#ifdef __PX4_ROS
+
 bool circuit_breaker_enabled(const char *breaker, int32_t magic)
 {
 	int32_t val;
@@ -54,3 +57,92 @@ bool circuit_breaker_enabled(const char *breaker, int32_t magic)
 	return (val == magic);
 }
 
+#else
+
+#include <systemlib/param/param.h>
+
+namespace
+{
+
+/*
+ * The values read last, valid as long as the parameter change sequence
+ * has not moved on, so the checks in the loops of the callers are a few
+ * memory reads. There is one slot for every breaker of the header.
+ */
+struct breaker_cache_s {
+	const char *volatile name;
+	param_t param;
+	volatile uint32_t seq;		/**< change sequence the value was read at, zero while written */
+	volatile int32_t val;
+	volatile int busy;		/**< owned by the task filling the slot */
+};
+
+breaker_cache_s cache[8];
+
+int32_t read_breaker(param_t param)
+{
+	int32_t val = 0;
+	(void)param_get(param, &val);
+	return val;
+}
+
+} // anonymous namespace
+
+bool circuit_breaker_enabled(const char *breaker, int32_t magic)
+{
+	const uint32_t seq = param_get_change_seq();
+	breaker_cache_s *slot = nullptr;
+
+	for (unsigned i = 0; i < sizeof(cache) / sizeof(cache[0]); i++) {
+		const char *name = cache[i].name;
+
+		if (name == nullptr || strcmp(name, breaker) == 0) {
+			slot = &cache[i];
+			break;
+		}
+	}
+
+	if (slot != nullptr && slot->name != nullptr) {
+		uint32_t seq_before = slot->seq;
+		__sync_synchronize();
+		int32_t val = slot->val;
+		__sync_synchronize();
+
+		if (seq_before == seq && slot->seq == seq) {
+			return (val == magic);
+		}
+	}
+
+	/* a task is filling the slot, or all are taken: read the parameter directly */
+	if (slot == nullptr || __sync_lock_test_and_set(&slot->busy, 1) != 0) {
+		return (read_breaker(param_find(breaker)) == magic);
+	}
+
+	if (slot->name != nullptr && strcmp(slot->name, breaker) != 0) {
+		/* another breaker took the free slot in the meantime */
+		__sync_lock_release(&slot->busy);
+		return (read_breaker(param_find(breaker)) == magic);
+	}
+
+	if (slot->name == nullptr) {
+		slot->param = param_find(breaker);
+	}
+
+	slot->seq = 0;
+	__sync_synchronize();
+	int32_t val = read_breaker(slot->param);
+	slot->val = val;
+	__sync_synchronize();
+	slot->seq = seq;
+
+	if (slot->name == nullptr) {
+		/* publish the slot only once it holds a value */
+		slot->name = breaker;
+	}
+
+	__sync_lock_release(&slot->busy);
+
+	return (val == magic);
+}
+
+#endif
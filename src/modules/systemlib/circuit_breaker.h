@@ -61,6 +61,15 @@
 
 __BEGIN_DECLS
 
+/**
+ * Test whether a circuit breaker is set to its key.
+ *
+ * The value is cached until the next parameter change, so this may be
+ * called in loops.
+ *
+ * @param breaker	Name of the breaker parameter, kept by the cache: pass a string literal.
+ * @param magic		The key of the breaker.
+ */
 extern "C" __EXPORT bool circuit_breaker_enabled(const char *breaker, int32_t magic);
 
 __END_DECLS
@@ -58,6 +58,7 @@
 #include <drivers/drv_hrt.h>
 
 #include "cpuload.h"
+#include "trace.h"
 
 #ifdef CONFIG_SCHED_INSTRUMENTATION
 
@@ -141,6 +142,8 @@ void sched_note_switch(FAR struct tcb_s *pFromTcb, FAR struct tcb_s *pToTcb)
 {
 	uint64_t new_time = hrt_absolute_time();
 
+	TRACE_SWITCH_TO(pToTcb, pToTcb->name);
+
 	/* Kind of inefficient: find both tasks and update times */
 	uint8_t both_found = 0;
 
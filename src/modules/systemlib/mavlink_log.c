@@ -127,3 +127,121 @@ __EXPORT void mavlink_vasprintf(int _fd, int severity, const char *fmt, ...)
 	va_end(ap);
 	px4_ioctl(_fd, severity, (unsigned long)&text[0]);
 }
+
+/* burst and interval of the rate limit of each severity class */
+static const struct {
+	unsigned burst;
+	unsigned interval;
+} logring_limits[MAVLINK_LOGRING_CLASSES] = {
+	{ 10, 100000 },	/* emergency, alert, critical */
+	{ 5, 250000 },	/* error, warning */
+	{ 3, 500000 },	/* notice, info, debug */
+};
+
+static unsigned logring_class(unsigned char severity)
+{
+	if (severity <= 2) {
+		return 0;
+
+	} else if (severity <= 4) {
+		return 1;
+
+	} else {
+		return 2;
+	}
+}
+
+static int logring_take_token(struct mavlink_logring *lr, unsigned cls, uint64_t now)
+{
+	uint64_t elapsed = now - lr->refill_time[cls];
+	unsigned refill = elapsed / logring_limits[cls].interval;
+
+	if (refill >= lr->used[cls]) {
+		lr->used[cls] = 0;
+		lr->refill_time[cls] = now;
+
+	} else {
+		lr->used[cls] -= refill;
+		lr->refill_time[cls] += (uint64_t)refill * logring_limits[cls].interval;
+	}
+
+	if (lr->used[cls] >= logring_limits[cls].burst) {
+		return 1;
+	}
+
+	lr->used[cls]++;
+	return 0;
+}
+
+__EXPORT int mavlink_logring_write(struct mavlink_logring *lr, const struct mavlink_logmessage *elem, uint64_t now)
+{
+	int repeat = (lr->head > 0 && elem->severity == lr->last.severity &&
+		      strncmp(elem->text, lr->last.text, sizeof(elem->text)) == 0);
+
+	if (repeat && now - lr->last_time < MAVLINK_LOGRING_REPEAT_INTERVAL) {
+		lr->repeats++;
+		return 1;
+	}
+
+	if (logring_take_token(lr, logring_class(elem->severity), now)) {
+		lr->dropped++;
+		return 1;
+	}
+
+	struct mavlink_logmessage *slot = &lr->elems[lr->head % MAVLINK_LOGRING_SIZE];
+	memcpy(slot, elem, sizeof(*slot));
+	slot->text[sizeof(slot->text) - 1] = '\0';
+
+	if (repeat && lr->repeats > 0) {
+		/* tell how many copies were dropped, shortening the text if needed */
+		char suffix[16];
+		int suffix_len = snprintf(suffix, sizeof(suffix), " (x%u)", lr->repeats + 1);
+		size_t len = strlen(slot->text);
+
+		if (len + suffix_len > sizeof(slot->text) - 1) {
+			len = sizeof(slot->text) - 1 - suffix_len;
+		}
+
+		memcpy(&slot->text[len], suffix, suffix_len + 1);
+	}
+
+	memcpy(&lr->last, elem, sizeof(lr->last));
+	lr->last_time = now;
+	lr->repeats = 0;
+
+	/* the message has to be complete before readers see it */
+	__sync_synchronize();
+	lr->head++;
+
+	return 0;
+}
+
+__EXPORT int mavlink_logring_read(struct mavlink_logring *lr, unsigned *seq, struct mavlink_logmessage *elem)
+{
+	for (;;) {
+		unsigned head = lr->head;
+
+		if (*seq == head) {
+			return 1;
+		}
+
+		/* skip the oldest slot, it is the next one the writer rewrites */
+		if (head - *seq >= MAVLINK_LOGRING_SIZE) {
+			*seq = head - MAVLINK_LOGRING_SIZE + 1;
+		}
+
+		memcpy(elem, &lr->elems[*seq % MAVLINK_LOGRING_SIZE], sizeof(*elem));
+		__sync_synchronize();
+
+		/* retry if the writer overtook the reader during the copy */
+		if (lr->head - *seq < MAVLINK_LOGRING_SIZE) {
+			(*seq)++;
+			return 0;
+		}
+	}
+}
+
+__EXPORT int mavlink_logring_is_empty(struct mavlink_logring *lr, unsigned seq)
+{
+	return seq == lr->head;
+}
@@ -38,6 +38,7 @@
  */
 
 #include <px4_config.h>
+#include <px4_defines.h>
 
 #include <sys/types.h>
 #include <stdint.h>
@@ -95,6 +96,74 @@ Mixer::scale(const mixer_scaler_s &scaler, float input)
 	return output;
 }
 
+#ifdef MIXER_FIXED_POINT
+unsigned
+Mixer::mix_fixed(int32_t *outputs, unsigned space, uint16_t *status_reg, ControlCallbackFixed control_cb)
+{
+	/* mix in float in place, then convert each output */
+	unsigned mixed = mix(reinterpret_cast<float *>(outputs), space, status_reg);
+
+	for (unsigned i = 0; i < mixed; i++) {
+		float value;
+		memcpy(&value, &outputs[i], sizeof(value));
+		outputs[i] = float_to_fixed(value);
+	}
+
+	return mixed;
+}
+
+int32_t
+Mixer::float_to_fixed(float value)
+{
+	if (!PX4_ISFINITE(value)) {
+		return MIXER_FIXED_INVALID;
+	}
+
+	return (int32_t)(value * MIXER_FIXED_ONE + ((value < 0.0f) ? -0.5f : 0.5f));
+}
+
+float
+Mixer::fixed_to_float(int32_t value)
+{
+	if (value == MIXER_FIXED_INVALID) {
+		return NAN;
+	}
+
+	return value / (float)MIXER_FIXED_ONE;
+}
+
+int32_t
+Mixer::scale_fixed(const mixer_scaler_fixed_s &scaler, int32_t input)
+{
+	int32_t scale = (input < 0) ? scaler.negative_scale : scaler.positive_scale;
+
+	/* rounded Q15 product, a single long multiply on Cortex-M */
+	int32_t output = (int32_t)(((int64_t)input * scale + (1 << (MIXER_FIXED_SCALE_SHIFT - 1))) >> MIXER_FIXED_SCALE_SHIFT)
+			 + scaler.offset;
+
+	if (output > scaler.max_output) {
+		output = scaler.max_output;
+
+	} else if (output < scaler.min_output) {
+		output = scaler.min_output;
+	}
+
+	return output;
+}
+
+void
+Mixer::scaler_to_fixed(const mixer_scaler_s &scaler, mixer_scaler_fixed_s &fixed)
+{
+	const float q15 = (float)(1 << MIXER_FIXED_SCALE_SHIFT);
+
+	fixed.negative_scale = (int32_t)(scaler.negative_scale * q15 + ((scaler.negative_scale < 0.0f) ? -0.5f : 0.5f));
+	fixed.positive_scale = (int32_t)(scaler.positive_scale * q15 + ((scaler.positive_scale < 0.0f) ? -0.5f : 0.5f));
+	fixed.offset = float_to_fixed(scaler.offset);
+	fixed.min_output = float_to_fixed(scaler.min_output);
+	fixed.max_output = float_to_fixed(scaler.max_output);
+}
+#endif
+
 int
 Mixer::scale_check(struct mixer_scaler_s &scaler)
 {
@@ -151,6 +220,24 @@ Mixer::skipline(const char *buf, unsigned &buflen)
 	return nullptr;
 }
 
+float
+Mixer::read_scale(const uint8_t *buf)
+{
+	return (int16_t)(buf[0] | (buf[1] << 8)) / 10000.0f;
+}
+
+const uint8_t *
+Mixer::read_scaler(const uint8_t *buf, mixer_scaler_s &scaler)
+{
+	scaler.negative_scale	= read_scale(&buf[0]);
+	scaler.positive_scale	= read_scale(&buf[2]);
+	scaler.offset		= read_scale(&buf[4]);
+	scaler.min_output	= read_scale(&buf[6]);
+	scaler.max_output	= read_scale(&buf[8]);
+
+	return buf + MIXER_BINARY_SCALER_SIZE;
+}
+
 /****************************************************************************/
 
 NullMixer::NullMixer() :
@@ -204,3 +291,19 @@ NullMixer::from_text(const char *buf, unsigned &buflen)
 
 	return nm;
 }
+
+NullMixer *
+NullMixer::from_binary(const uint8_t *buf, unsigned &buflen)
+{
+	if ((buflen < 1) || (buf[0] != 'Z')) {
+		return nullptr;
+	}
+
+	NullMixer *nm = new NullMixer;
+
+	if (nm != nullptr) {
+		buflen -= 1;
+	}
+
+	return nm;
+}
@@ -135,6 +135,27 @@
 
 #include "mixer_load.h"
 
+#ifdef MIXER_FIXED_POINT
+/*
+ * Fixed point mixing, for targets without an FPU (px4io).
+ *
+ * Control and output values are integers in 1/10000 units, the same as
+ * the IO registers and the precompiled mixers; scales are Q15.
+ */
+#define MIXER_FIXED_ONE		10000
+#define MIXER_FIXED_INVALID	INT32_MIN	/**< counterpart of a NaN control or output */
+#define MIXER_FIXED_SCALE_SHIFT	15
+
+/** fixed point version of mixer_scaler_s */
+struct mixer_scaler_fixed_s {
+	int32_t			negative_scale;
+	int32_t			positive_scale;
+	int32_t			offset;
+	int32_t			min_output;
+	int32_t			max_output;
+};
+#endif
+
 /**
  * Abstract class defining a mixer mixing zero or more inputs to
  * one or more outputs.
@@ -176,6 +197,38 @@ public:
 	 */
 	virtual unsigned		mix(float *outputs, unsigned space, uint16_t *status_reg) = 0;
 
+#ifdef MIXER_FIXED_POINT
+	/**
+	 * Fetch a fixed point control value, see ControlCallback.
+	 *
+	 * The control is in 1/10000 units, or MIXER_FIXED_INVALID.
+	 */
+	typedef int	(* ControlCallbackFixed)(uintptr_t handle,
+			uint8_t control_group,
+			uint8_t control_index,
+			int32_t &control);
+
+	/**
+	 * Perform the mixing function in fixed point.
+	 *
+	 * Mixers without a fixed point implementation mix in float and
+	 * convert their outputs.
+	 *
+	 * @param outputs		Array into which mixed output(s) in 1/10000 units should be placed.
+	 * @param space			The number of available entries in the output array;
+	 * @param control_cb		Callback fetching the controls, passed the handle of the mixer.
+	 * @return			The number of entries in the output array that were populated.
+	 */
+	virtual unsigned		mix_fixed(int32_t *outputs, unsigned space, uint16_t *status_reg,
+			ControlCallbackFixed control_cb);
+
+	/**
+	 * Convert between float and fixed point values, NaN being MIXER_FIXED_INVALID.
+	 */
+	static int32_t			float_to_fixed(float value);
+	static float			fixed_to_float(int32_t value);
+#endif
+
 	/**
 	 * Analyses the mix configuration and updates a bitmask of groups
 	 * that are required.
@@ -215,6 +268,22 @@ protected:
 	 */
 	static int			scale_check(struct mixer_scaler_s &scaler);
 
+#ifdef MIXER_FIXED_POINT
+	/**
+	 * Fixed point version of scale().
+	 *
+	 * @param scaler		The scaler configuration, see scaler_to_fixed().
+	 * @param input			The value to be scaled, in 1/10000 units.
+	 * @return			The scaled value, in 1/10000 units.
+	 */
+	static int32_t			scale_fixed(const mixer_scaler_fixed_s &scaler, int32_t input);
+
+	/**
+	 * Precompute the fixed point version of a scaler.
+	 */
+	static void			scaler_to_fixed(const mixer_scaler_s &scaler, mixer_scaler_fixed_s &fixed);
+#endif
+
 	/**
 	 * Find a tag
 	 *
@@ -233,6 +302,23 @@ protected:
 	 */
 	static const char 		*skipline(const char *buf, unsigned &buflen);
 
+	/**
+	 * Read a scale of a precompiled mixer.
+	 *
+	 * @param buf			Little endian int16 in units of 1/10000.
+	 * @return			The scale.
+	 */
+	static float			read_scale(const uint8_t *buf);
+
+	/**
+	 * Read a scaler of a precompiled mixer.
+	 *
+	 * @param buf			MIXER_BINARY_SCALER_SIZE bytes holding the scaler.
+	 * @param scaler		The scaler read.
+	 * @return			Pointer past the scaler.
+	 */
+	static const uint8_t		*read_scaler(const uint8_t *buf, mixer_scaler_s &scaler);
+
 private:
 
 	/* do not allow to copy due to prt data members */
@@ -251,6 +337,10 @@ public:
 	~MixerGroup();
 
 	virtual unsigned		mix(float *outputs, unsigned space, uint16_t *status_reg);
+#ifdef MIXER_FIXED_POINT
+	virtual unsigned		mix_fixed(int32_t *outputs, unsigned space, uint16_t *status_reg,
+			ControlCallbackFixed control_cb);
+#endif
 	virtual void			groups_required(uint32_t &groups);
 
 	/**
@@ -312,6 +402,31 @@ public:
 	 */
 	int				load_from_buf(const char *buf, unsigned &buflen);
 
+	/**
+	 * Adds mixers to the group from precompiled mixers in a buffer.
+	 *
+	 * The binary format mirrors the text description, without any
+	 * parsing at load. Each mixer is a record starting with the letter
+	 * of its text tag, scales are little endian int16 in 1/10000 units
+	 * and a scaler is <-ve scale> <+ve scale> <offset> <lower limit>
+	 * <upper limit>. Zero bytes between records are skipped.
+	 *
+	 *   'Z'
+	 *   'M' <uint8 control count> <output scaler>
+	 *       <control count> x (<uint8 group> <uint8 index> <scaler>)
+	 *   'R' <geometry name, nul terminated> <roll> <pitch> <yaw> <deadband>
+	 *
+	 * Precompiled mixers are produced at build time by
+	 * Tools/px_mixer_compile.py, or at runtime by mixer_text_to_binary().
+	 *
+	 * @param buf			The precompiled mixers.
+	 * @param buflen		The length of the buffer, updated to reflect
+	 *				bytes as they are consumed. A partial record
+	 *				at the end of the buffer is left unconsumed.
+	 * @return			Zero on successful load, nonzero otherwise.
+	 */
+	int				load_from_binary(const uint8_t *buf, unsigned &buflen);
+
 private:
 	Mixer				*_first;	/**< linked list of mixers */
 
@@ -346,6 +461,17 @@ public:
 	 */
 	static NullMixer		*from_text(const char *buf, unsigned &buflen);
 
+	/**
+	 * Create a NullMixer from a precompiled record.
+	 *
+	 * @param buf			The record, see MixerGroup::load_from_binary().
+	 * @param buflen		Length of the buffer, adjusted to reflect
+	 *				the bytes consumed.
+	 * @return			A new NullMixer instance, or nullptr if the
+	 *				record is incomplete.
+	 */
+	static NullMixer		*from_binary(const uint8_t *buf, unsigned &buflen);
+
 	virtual unsigned		mix(float *outputs, unsigned space, uint16_t *status_reg);
 	virtual void			groups_required(uint32_t &groups);
 };
@@ -391,6 +517,23 @@ public:
 			const char *buf,
 			unsigned &buflen);
 
+	/**
+	 * Create a SimpleMixer from a precompiled record.
+	 *
+	 * @param control_cb		The callback to invoke when fetching a
+	 *				control value.
+	 * @param cb_handle		Handle passed to the control callback.
+	 * @param buf			The record, see MixerGroup::load_from_binary().
+	 * @param buflen		Length of the buffer, adjusted to reflect
+	 *				the bytes consumed.
+	 * @return			A new SimpleMixer instance, or nullptr
+	 *				if the record is incomplete.
+	 */
+	static SimpleMixer		*from_binary(Mixer::ControlCallback control_cb,
+			uintptr_t cb_handle,
+			const uint8_t *buf,
+			unsigned &buflen);
+
 	/**
 	 * Factory method for PWM/PPM input to internal float representation.
 	 *
@@ -412,6 +555,10 @@ public:
 			uint16_t max);
 
 	virtual unsigned		mix(float *outputs, unsigned space, uint16_t *status_reg);
+#ifdef MIXER_FIXED_POINT
+	virtual unsigned		mix_fixed(int32_t *outputs, unsigned space, uint16_t *status_reg,
+			ControlCallbackFixed control_cb);
+#endif
 	virtual void			groups_required(uint32_t &groups);
 
 	/**
@@ -428,6 +575,10 @@ protected:
 
 private:
 	mixer_simple_s			*_info;
+#ifdef MIXER_FIXED_POINT
+	/** output scaler followed by the control scalers, precomputed from _info */
+	mixer_scaler_fixed_s		*_fixed;
+#endif
 
 	static int			parse_output_scaler(const char *buf, unsigned &buflen, mixer_scaler_s &scaler);
 	static int			parse_control_scaler(const char *buf,
@@ -469,6 +620,14 @@ public:
 		float	out_scale;	/**< scales total out for this rotor */
 	};
 
+	/**
+	 * Mix of limited roll, pitch, yaw and thrust for one geometry.
+	 */
+	typedef unsigned(*MixFunction)(float roll, float pitch, float yaw, float thrust, float idle_speed,
+				       float *outputs, uint16_t *status_reg);
+
+	static const unsigned		max_rotor_count = 8;	/**< largest geometry in multi_tables */
+
 	/**
 	 * Constructor.
 	 *
@@ -515,6 +674,24 @@ public:
 			const char *buf,
 			unsigned &buflen);
 
+	/**
+	 * Create a MultirotorMixer from a precompiled record.
+	 *
+	 * @param control_cb		The callback to invoke when fetching a
+	 *				control value.
+	 * @param cb_handle		Handle passed to the control callback.
+	 * @param buf			The record, see MixerGroup::load_from_binary().
+	 * @param buflen		Length of the buffer, adjusted to reflect
+	 *				the bytes consumed.
+	 * @return			A new MultirotorMixer instance, or nullptr
+	 *				if the record is incomplete or the geometry
+	 *				is unknown.
+	 */
+	static MultirotorMixer		*from_binary(Mixer::ControlCallback control_cb,
+			uintptr_t cb_handle,
+			const uint8_t *buf,
+			unsigned &buflen);
+
 	virtual unsigned		mix(float *outputs, unsigned space, uint16_t *status_reg);
 	virtual void			groups_required(uint32_t &groups);
 
@@ -529,6 +706,7 @@ private:
 
 	unsigned			_rotor_count;
 	const Rotor			*_rotors;
+	MixFunction			_mix_fixed;	/**< mix specialized for the geometry, nullptr for the generic mix */
 
 	/* do not allow to copy due to ptr data members */
 	MultirotorMixer(const MultirotorMixer &);
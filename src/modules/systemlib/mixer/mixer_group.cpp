@@ -112,6 +112,22 @@ MixerGroup::mix(float *outputs, unsigned space, uint16_t *status_reg)
 	return index;
 }
 
+#ifdef MIXER_FIXED_POINT
+unsigned
+MixerGroup::mix_fixed(int32_t *outputs, unsigned space, uint16_t *status_reg, ControlCallbackFixed control_cb)
+{
+	Mixer	*mixer = _first;
+	unsigned index = 0;
+
+	while ((mixer != nullptr) && (index < space)) {
+		index += mixer->mix_fixed(outputs + index, space - index, status_reg, control_cb);
+		mixer = mixer->_next;
+	}
+
+	return index;
+}
+#endif
+
 unsigned
 MixerGroup::count()
 {
@@ -200,3 +216,50 @@ MixerGroup::load_from_buf(const char *buf, unsigned &buflen)
 	/* nothing more in the buffer for us now */
 	return ret;
 }
+
+int
+MixerGroup::load_from_binary(const uint8_t *buf, unsigned &buflen)
+{
+	int ret = -1;
+	const uint8_t *end = buf + buflen;
+
+	while (buflen > 0) {
+		Mixer *m = nullptr;
+		const uint8_t *p = end - buflen;
+		unsigned resid = buflen;
+
+		switch (*p) {
+		case '\0':
+			/* padding between records */
+			buflen--;
+			continue;
+
+		case 'Z':
+			m = NullMixer::from_binary(p, resid);
+			break;
+
+		case 'M':
+			m = SimpleMixer::from_binary(_control_cb, _cb_handle, p, resid);
+			break;
+
+		case 'R':
+			m = MultirotorMixer::from_binary(_control_cb, _cb_handle, p, resid);
+			break;
+
+		default:
+			debug("unknown precompiled mixer 0x%02x", *p);
+			break;
+		}
+
+		if (m == nullptr) {
+			/* incomplete or bad record, leave it in the buffer */
+			break;
+		}
+
+		add_mixer(m);
+		ret = 0;
+		buflen = resid;
+	}
+
+	return ret;
+}
@@ -41,6 +41,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <systemlib/err.h>
 
 #include "mixer_load.h"
@@ -113,3 +115,143 @@ int load_mixer_file(const char *fname, char *buf, unsigned maxlen)
 	return 0;
 }
 
+
+/**
+ * Append a scale in 1/10000 units to a precompiled mixer.
+ */
+static int put_scale(uint8_t **p, const uint8_t *end, int value)
+{
+	if ((*p + 2 > end) || (value < INT16_MIN) || (value > INT16_MAX)) {
+		return -1;
+	}
+
+	(*p)[0] = (uint8_t)(value & 0xff);
+	(*p)[1] = (uint8_t)((value >> 8) & 0xff);
+	*p += 2;
+	return 0;
+}
+
+int mixer_text_to_binary(const char *text, unsigned textlen, uint8_t *buf, unsigned buflen)
+{
+	const char	*text_end = text + textlen;
+	uint8_t		*p = buf;
+	const uint8_t	*end = buf + buflen;
+	unsigned	scalers_left = 0;	/* scaler lines still expected by the current simple mixer */
+	bool		output_next = false;	/* the output scaler of a simple mixer comes first */
+	char		line[120];
+
+	while (text < text_end && *text != '\0') {
+		/* copy out one line, so that sscanf stops at its end */
+		const char *nl = memchr(text, '\n', text_end - text);
+		size_t len = (nl != NULL) ? (size_t)(nl - text) : (size_t)(text_end - text);
+
+		if (len >= sizeof(line)) {
+			return -1;
+		}
+
+		memcpy(line, text, len);
+		line[len] = '\0';
+		text += len + 1;
+
+		int s[5];
+		unsigned u[2];
+		char geomname[8];
+
+		if ((len < 2) || !isupper(line[0]) || (line[1] != ':')) {
+			/* not a mixer definition line */
+			continue;
+		}
+
+		if (scalers_left > 0 && line[0] != 'O' && line[0] != 'S') {
+			/* simple mixer ended early */
+			return -1;
+		}
+
+		switch (line[0]) {
+		case 'Z':
+			if (p + 1 > end) {
+				return -1;
+			}
+
+			*p++ = 'Z';
+			break;
+
+		case 'M':
+			if ((sscanf(line, "M: %u", &u[0]) != 1) || (u[0] > UINT8_MAX) || (p + 2 > end)) {
+				return -1;
+			}
+
+			*p++ = 'M';
+			*p++ = (uint8_t)u[0];
+			/* the output scaler and one scaler per control follow */
+			scalers_left = u[0] + 1;
+			output_next = true;
+			break;
+
+		case 'O':
+		case 'S':
+			if ((scalers_left == 0) || (output_next != (line[0] == 'O'))) {
+				return -1;
+			}
+
+			output_next = false;
+
+			if (line[0] == 'O') {
+				if (sscanf(line, "O: %d %d %d %d %d", &s[0], &s[1], &s[2], &s[3], &s[4]) != 5) {
+					return -1;
+				}
+
+			} else {
+				if ((sscanf(line, "S: %u %u %d %d %d %d %d", &u[0], &u[1], &s[0], &s[1], &s[2], &s[3], &s[4]) != 7) ||
+				    (u[0] > UINT8_MAX) || (u[1] > UINT8_MAX) || (p + 2 > end)) {
+					return -1;
+				}
+
+				*p++ = (uint8_t)u[0];
+				*p++ = (uint8_t)u[1];
+			}
+
+			for (unsigned i = 0; i < 5; i++) {
+				if (put_scale(&p, end, s[i])) {
+					return -1;
+				}
+			}
+
+			scalers_left--;
+			break;
+
+		case 'R':
+			if (sscanf(line, "R: %7s %d %d %d %d", geomname, &s[0], &s[1], &s[2], &s[3]) != 5) {
+				return -1;
+			}
+
+			len = strlen(geomname) + 1;
+
+			if (p + 1 + len > end) {
+				return -1;
+			}
+
+			*p++ = 'R';
+			memcpy(p, geomname, len);
+			p += len;
+
+			for (unsigned i = 0; i < 4; i++) {
+				if (put_scale(&p, end, s[i])) {
+					return -1;
+				}
+			}
+
+			break;
+
+		default:
+			/* unknown mixer types are skipped, like by the text parser */
+			break;
+		}
+	}
+
+	if (scalers_left > 0) {
+		return -1;
+	}
+
+	return p - buf;
+}
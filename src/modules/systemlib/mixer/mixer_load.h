@@ -46,6 +46,22 @@ __BEGIN_DECLS
 
 __EXPORT int load_mixer_file(const char *fname, char *buf, unsigned maxlen);
 
+/** size of a scaler in a precompiled mixer: five int16 in units of 1/10000 */
+#define MIXER_BINARY_SCALER_SIZE	10
+
+/**
+ * Precompile a mixer text description to the binary format
+ * read by MixerGroup::load_from_binary().
+ *
+ * @param text		The mixer text, as read by load_mixer_file().
+ * @param textlen	Length of the text in bytes.
+ * @param buf		Buffer for the precompiled mixers.
+ * @param buflen	Size of the buffer.
+ * @return		Number of bytes written to buf, or -1 if the text
+ *			is malformed or does not fit.
+ */
+__EXPORT int mixer_text_to_binary(const char *text, unsigned textlen, uint8_t *buf, unsigned buflen);
+
 __END_DECLS
 
 #endif
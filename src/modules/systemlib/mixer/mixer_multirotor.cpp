@@ -52,10 +52,18 @@
 
 #include <px4iofirmware/protocol.h>
 
-#include "mixer.h"
+/* the DSP library is linked on all boards with an FPU (Cortex-M4F) */
+#if defined(CONFIG_ARCH_FPU)
+#define MIXER_USE_CMSIS
+#include <mathlib/CMSIS/Include/arm_math.h>
+#endif
 
-// This file is generated by the multi_tables script which is invoked during the build process
-#include "mixer_multirotor.generated.h"
+/* px4io is short on flash and uses the generic mix for all geometries */
+#if !defined(CONFIG_ARCH_BOARD_PX4IO_V1) && !defined(CONFIG_ARCH_BOARD_PX4IO_V2)
+#define MIXER_MULTIROTOR_SPECIALIZED
+#endif
+
+#include "mixer.h"
 
 #define debug(fmt, args...)	do { } while(0)
 //#define debug(fmt, args...)	do { printf("[mixer] " fmt "\n", ##args); } while(0)
@@ -75,133 +83,91 @@ float constrain(float val, float min, float max)
 	return (val < min) ? min : ((val > max) ? max : val);
 }
 
-} // anonymous namespace
-
-MultirotorMixer::MultirotorMixer(ControlCallback control_cb,
-				 uintptr_t cb_handle,
-				 MultirotorGeometry geometry,
-				 float roll_scale,
-				 float pitch_scale,
-				 float yaw_scale,
-				 float idle_speed) :
-	Mixer(control_cb, cb_handle),
-	_roll_scale(roll_scale),
-	_pitch_scale(pitch_scale),
-	_yaw_scale(yaw_scale),
-	_idle_speed(-1.0f + idle_speed * 2.0f),	/* shift to output range here to avoid runtime calculation */
-	_limits_pub(),
-	_rotor_count(_config_rotor_count[(MultirotorGeometryUnderlyingType)geometry]),
-	_rotors(_config_index[(MultirotorGeometryUnderlyingType)geometry])
-{
-}
-
-MultirotorMixer::~MultirotorMixer()
-{
-}
-
-MultirotorMixer *
-MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf, unsigned &buflen)
-{
-	MultirotorGeometry geometry;
-	char geomname[8];
-	int s[4];
-	int used;
-
-	/* enforce that the mixer ends with space or a new line */
-	for (int i = buflen - 1; i >= 0; i--) {
-		if (buf[i] == '\0') {
-			continue;
-		}
-
-		/* require a space or newline at the end of the buffer, fail on printable chars */
-		if (buf[i] == ' ' || buf[i] == '\n' || buf[i] == '\r') {
-			/* found a line ending or space, so no split symbols / numbers. good. */
-			break;
+/* the rotor table doubles as a row-major matrix with one row per rotor */
+static_assert(sizeof(MultirotorMixer::Rotor) == 4 * sizeof(float), "rotor table is not a plain float matrix");
 
-		} else {
-			debug("simple parser rejected: No newline / space at end of buf. (#%d/%d: 0x%02x)", i, buflen - 1, buf[i]);
-			return nullptr;
-		}
+/**
+ * Rotor table of a geometry chosen at runtime, used by the generic mix.
+ */
+struct RotorTable {
+	const MultirotorMixer::Rotor *rotors;
+	unsigned count;
 
-	}
+	unsigned size() const { return count; }
+	const MultirotorMixer::Rotor &operator[](unsigned i) const { return rotors[i]; }
+};
 
-	if (sscanf(buf, "R: %s %d %d %d %d%n", geomname, &s[0], &s[1], &s[2], &s[3], &used) != 5) {
-		debug("multirotor parse failed on '%s'", buf);
-		return nullptr;
-	}
+/**
+ * Rotor table of a geometry fixed at compile time. Loops over it are
+ * unrolled and the scales become constants.
+ */
+template <unsigned N, const MultirotorMixer::Rotor *R>
+struct FixedRotorTable {
+	constexpr unsigned size() const { return N; }
+	const MultirotorMixer::Rotor &operator[](unsigned i) const { return R[i]; }
+};
 
-	if (used > (int)buflen) {
-		debug("OVERFLOW: multirotor spec used %d of %u", used, buflen);
-		return nullptr;
+/**
+ * Multiply the rotor table with the vector (roll, pitch, yaw, out_scale).
+ */
+template <class Table>
+void mix_matrix(const Table &rotors, const float controls[4], float *out)
+{
+	for (unsigned i = 0; i < rotors.size(); i++) {
+		out[i] = rotors[i].roll_scale * controls[0] +
+			 rotors[i].pitch_scale * controls[1] +
+			 rotors[i].yaw_scale * controls[2] +
+			 rotors[i].out_scale * controls[3];
 	}
+}
 
-	buf = skipline(buf, buflen);
-
-	if (buf == nullptr) {
-		debug("no line ending, line is incomplete");
-		return nullptr;
+/**
+ * Add offset to all outputs and limit them to min...max.
+ */
+template <class Table>
+void offset_constrain(const Table &rotors, float *out, float offset, float min, float max)
+{
+	for (unsigned i = 0; i < rotors.size(); i++) {
+		out[i] = constrain(out[i] + offset, min, max);
 	}
+}
 
-	debug("remaining in buf: %d, first char: %c", buflen, buf[0]);
-
-	if (!strcmp(geomname, "4+")) {
-		geometry = MultirotorGeometry::QUAD_PLUS;
-
-	} else if (!strcmp(geomname, "4x")) {
-		geometry = MultirotorGeometry::QUAD_X;
-
-	} else if (!strcmp(geomname, "4v")) {
-		geometry = MultirotorGeometry::QUAD_V;
-
-	} else if (!strcmp(geomname, "4w")) {
-		geometry = MultirotorGeometry::QUAD_WIDE;
-
-	} else if (!strcmp(geomname, "4dc")) {
-		geometry = MultirotorGeometry::QUAD_DEADCAT;
-
-	} else if (!strcmp(geomname, "6+")) {
-		geometry = MultirotorGeometry::HEX_PLUS;
-
-	} else if (!strcmp(geomname, "6x")) {
-		geometry = MultirotorGeometry::HEX_X;
-
-	} else if (!strcmp(geomname, "6c")) {
-		geometry = MultirotorGeometry::HEX_COX;
-
-	} else if (!strcmp(geomname, "8+")) {
-		geometry = MultirotorGeometry::OCTA_PLUS;
-
-	} else if (!strcmp(geomname, "8x")) {
-		geometry = MultirotorGeometry::OCTA_X;
-
-	} else if (!strcmp(geomname, "8c")) {
-		geometry = MultirotorGeometry::OCTA_COX;
+#ifdef MIXER_USE_CMSIS
 
-	} else if (!strcmp(geomname, "2-")) {
-		geometry = MultirotorGeometry::TWIN_ENGINE;
+void mix_matrix(const RotorTable &rotors, const float controls[4], float *out)
+{
+	arm_matrix_instance_f32 table;
+	arm_matrix_instance_f32 in;
+	arm_matrix_instance_f32 res;
+
+	arm_mat_init_f32(&table, rotors.count, 4, (float32_t *)rotors.rotors);
+	arm_mat_init_f32(&in, 4, 1, (float32_t *)controls);
+	arm_mat_init_f32(&res, rotors.count, 1, out);
+	arm_mat_mult_f32(&table, &in, &res);
+}
 
-	} else if (!strcmp(geomname, "3y")) {
-		geometry = MultirotorGeometry::TRI_Y;
+void offset_constrain(const RotorTable &rotors, float *out, float offset, float min, float max)
+{
+	arm_offset_f32(out, offset, out, rotors.count);
 
-	} else {
-		debug("unrecognised geometry '%s'", geomname);
-		return nullptr;
+	for (unsigned i = 0; i < rotors.count; i++) {
+		out[i] = constrain(out[i], min, max);
 	}
-
-	debug("adding multirotor mixer '%s'", geomname);
-
-	return new MultirotorMixer(
-		       control_cb,
-		       cb_handle,
-		       geometry,
-		       s[0] / 10000.0f,
-		       s[1] / 10000.0f,
-		       s[2] / 10000.0f,
-		       s[3] / 10000.0f);
 }
 
-unsigned
-MultirotorMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
+#endif
+
+/**
+ * Mix roll, pitch, yaw and thrust to the rotors of the table.
+ *
+ * The controls are already scaled and limited, the outputs are in the
+ * range idle_speed...1.
+ *
+ * @return		The number of outputs written.
+ */
+template <class Table>
+unsigned mix_rotors(const Table &rotors, float roll, float pitch, float yaw, float thrust, float idle_speed,
+		    float *outputs, uint16_t *status_reg)
 {
 	/* Summary of mixing strategy:
 	1) mix roll, pitch and thrust without yaw.
@@ -214,10 +180,6 @@ MultirotorMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
 	4) scale all outputs to range [idle_speed,1]
 	*/
 
-	float		roll    = constrain(get_control(0, 0) * _roll_scale, -1.0f, 1.0f);
-	float		pitch   = constrain(get_control(0, 1) * _pitch_scale, -1.0f, 1.0f);
-	float		yaw     = constrain(get_control(0, 2) * _yaw_scale, -1.0f, 1.0f);
-	float		thrust  = constrain(get_control(0, 3), 0.0f, 1.0f);
 	float		min_out = 0.0f;
 	float		max_out = 0.0f;
 
@@ -230,13 +192,14 @@ MultirotorMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
 	float thrust_increase_factor = 1.5f;
 	float thrust_decrease_factor = 0.6f;
 
-	/* perform initial mix pass yielding unbounded outputs, ignore yaw */
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		float out = roll * _rotors[i].roll_scale +
-			    pitch * _rotors[i].pitch_scale +
-			    thrust;
+	/* roll and pitch part of every output, used by all passes below */
+	float roll_pitch[MultirotorMixer::max_rotor_count];
+	const float roll_pitch_controls[4] = { roll, pitch, 0.0f, 0.0f };
+	mix_matrix(rotors, roll_pitch_controls, roll_pitch);
 
-		out *= _rotors[i].out_scale;
+	/* perform initial mix pass yielding unbounded outputs, ignore yaw */
+	for (unsigned i = 0; i < rotors.size(); i++) {
+		float out = (roll_pitch[i] + thrust) * rotors[i].out_scale;
 
 		/* calculate min and max output values */
 		if (out < min_out) {
@@ -246,8 +209,6 @@ MultirotorMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
 		if (out > max_out) {
 			max_out = out;
 		}
-
-		outputs[i] = out;
 	}
 
 	float boost = 0.0f;				// value added to demanded thrust (can also be negative)
@@ -305,18 +266,16 @@ MultirotorMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
 	}
 
 	// mix again but now with thrust boost, scale roll/pitch and also add yaw
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		float out = (roll * _rotors[i].roll_scale +
-			     pitch * _rotors[i].pitch_scale) * roll_pitch_scale +
-			    yaw * _rotors[i].yaw_scale +
+	for (unsigned i = 0; i < rotors.size(); i++) {
+		float out = roll_pitch[i] * roll_pitch_scale +
+			    yaw * rotors[i].yaw_scale +
 			    thrust + boost;
 
-		out *= _rotors[i].out_scale;
+		out *= rotors[i].out_scale;
 
 		// scale yaw if it violates limits. inform about yaw limit reached
 		if (out < 0.0f) {
-			yaw = -((roll * _rotors[i].roll_scale + pitch * _rotors[i].pitch_scale) *
-				roll_pitch_scale + thrust + boost) / _rotors[i].yaw_scale;
+			yaw = -(roll_pitch[i] * roll_pitch_scale + thrust + boost) / rotors[i].yaw_scale;
 
 			if (status_reg != NULL) {
 				(*status_reg) |= PX4IO_P_STATUS_MIXER_YAW_LIMIT;
@@ -326,8 +285,7 @@ MultirotorMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
 			// allow to reduce thrust to get some yaw response
 			float thrust_reduction = fminf(0.15f, out - 1.0f);
 			thrust -= thrust_reduction;
-			yaw = (1.0f - ((roll * _rotors[i].roll_scale + pitch * _rotors[i].pitch_scale) *
-				       roll_pitch_scale + thrust + boost)) / _rotors[i].yaw_scale;
+			yaw = (1.0f - (roll_pitch[i] * roll_pitch_scale + thrust + boost)) / rotors[i].yaw_scale;
 
 			if (status_reg != NULL) {
 				(*status_reg) |= PX4IO_P_STATUS_MIXER_YAW_LIMIT;
@@ -335,17 +293,245 @@ MultirotorMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
 		}
 	}
 
-	/* add yaw and scale outputs to range idle_speed...1 */
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] = (roll * _rotors[i].roll_scale +
-			      pitch * _rotors[i].pitch_scale) * roll_pitch_scale +
-			     yaw * _rotors[i].yaw_scale +
-			     thrust + boost;
+	/* add yaw and scale outputs to range idle_speed...1, folding the scaling into the mix */
+	float idle_scale = 1.0f - idle_speed;
+	const float controls[4] = { roll * roll_pitch_scale * idle_scale,
+				    pitch * roll_pitch_scale * idle_scale,
+				    yaw * idle_scale,
+				    0.0f
+				  };
+	mix_matrix(rotors, controls, outputs);
+	offset_constrain(rotors, outputs, idle_speed + (thrust + boost) * idle_scale, idle_speed, 1.0f);
+
+	return rotors.size();
+}
+
+#ifdef MIXER_MULTIROTOR_SPECIALIZED
+
+/**
+ * Mix for one geometry, instantiated per geometry by multi_tables.
+ */
+template <unsigned N, const MultirotorMixer::Rotor *R>
+unsigned mix_fixed(float roll, float pitch, float yaw, float thrust, float idle_speed,
+		   float *outputs, uint16_t *status_reg)
+{
+	return mix_rotors(FixedRotorTable<N, R>(), roll, pitch, yaw, thrust, idle_speed, outputs, status_reg);
+}
+
+#endif
+} // anonymous namespace
+
+// This file is generated by the multi_tables script which is invoked during the build process
+#include "mixer_multirotor.generated.h"
+
+namespace
+{
+
+/**
+ * Look up the geometry of a mixer description.
+ */
+bool geometry_from_name(const char *name, MultirotorGeometry &geometry)
+{
+	if (!strcmp(name, "4+")) {
+		geometry = MultirotorGeometry::QUAD_PLUS;
+
+	} else if (!strcmp(name, "4x")) {
+		geometry = MultirotorGeometry::QUAD_X;
+
+	} else if (!strcmp(name, "4v")) {
+		geometry = MultirotorGeometry::QUAD_V;
+
+	} else if (!strcmp(name, "4w")) {
+		geometry = MultirotorGeometry::QUAD_WIDE;
+
+	} else if (!strcmp(name, "4dc")) {
+		geometry = MultirotorGeometry::QUAD_DEADCAT;
+
+	} else if (!strcmp(name, "6+")) {
+		geometry = MultirotorGeometry::HEX_PLUS;
+
+	} else if (!strcmp(name, "6x")) {
+		geometry = MultirotorGeometry::HEX_X;
+
+	} else if (!strcmp(name, "6c")) {
+		geometry = MultirotorGeometry::HEX_COX;
+
+	} else if (!strcmp(name, "8+")) {
+		geometry = MultirotorGeometry::OCTA_PLUS;
+
+	} else if (!strcmp(name, "8x")) {
+		geometry = MultirotorGeometry::OCTA_X;
+
+	} else if (!strcmp(name, "8c")) {
+		geometry = MultirotorGeometry::OCTA_COX;
+
+	} else if (!strcmp(name, "2-")) {
+		geometry = MultirotorGeometry::TWIN_ENGINE;
+
+	} else if (!strcmp(name, "3y")) {
+		geometry = MultirotorGeometry::TRI_Y;
+
+	} else {
+		return false;
+	}
+
+	return true;
+
+}
+
+} // anonymous namespace
+
+MultirotorMixer::MultirotorMixer(ControlCallback control_cb,
+				 uintptr_t cb_handle,
+				 MultirotorGeometry geometry,
+				 float roll_scale,
+				 float pitch_scale,
+				 float yaw_scale,
+				 float idle_speed) :
+	Mixer(control_cb, cb_handle),
+	_roll_scale(roll_scale),
+	_pitch_scale(pitch_scale),
+	_yaw_scale(yaw_scale),
+	_idle_speed(-1.0f + idle_speed * 2.0f),	/* shift to output range here to avoid runtime calculation */
+	_limits_pub(),
+	_rotor_count(_config_rotor_count[(MultirotorGeometryUnderlyingType)geometry]),
+	_rotors(_config_index[(MultirotorGeometryUnderlyingType)geometry]),
+#ifdef MIXER_MULTIROTOR_SPECIALIZED
+	_mix_fixed(_config_mix[(MultirotorGeometryUnderlyingType)geometry])
+#else
+	_mix_fixed(nullptr)
+#endif
+{
+}
+
+MultirotorMixer::~MultirotorMixer()
+{
+}
+
+MultirotorMixer *
+MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf, unsigned &buflen)
+{
+	MultirotorGeometry geometry;
+	char geomname[8];
+	int s[4];
+	int used;
+
+	/* enforce that the mixer ends with space or a new line */
+	for (int i = buflen - 1; i >= 0; i--) {
+		if (buf[i] == '\0') {
+			continue;
+		}
+
+		/* require a space or newline at the end of the buffer, fail on printable chars */
+		if (buf[i] == ' ' || buf[i] == '\n' || buf[i] == '\r') {
+			/* found a line ending or space, so no split symbols / numbers. good. */
+			break;
+
+		} else {
+			debug("simple parser rejected: No newline / space at end of buf. (#%d/%d: 0x%02x)", i, buflen - 1, buf[i]);
+			return nullptr;
+		}
+
+	}
+
+	if (sscanf(buf, "R: %s %d %d %d %d%n", geomname, &s[0], &s[1], &s[2], &s[3], &used) != 5) {
+		debug("multirotor parse failed on '%s'", buf);
+		return nullptr;
+	}
+
+	if (used > (int)buflen) {
+		debug("OVERFLOW: multirotor spec used %d of %u", used, buflen);
+		return nullptr;
+	}
+
+	buf = skipline(buf, buflen);
+
+	if (buf == nullptr) {
+		debug("no line ending, line is incomplete");
+		return nullptr;
+	}
+
+	debug("remaining in buf: %d, first char: %c", buflen, buf[0]);
+
+	if (!geometry_from_name(geomname, geometry)) {
+		debug("unrecognised geometry '%s'", geomname);
+		return nullptr;
+	}
+
+	debug("adding multirotor mixer '%s'", geomname);
+
+	return new MultirotorMixer(
+		       control_cb,
+		       cb_handle,
+		       geometry,
+		       s[0] / 10000.0f,
+		       s[1] / 10000.0f,
+		       s[2] / 10000.0f,
+		       s[3] / 10000.0f);
+}
+
+MultirotorMixer *
+MultirotorMixer::from_binary(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const uint8_t *buf,
+			     unsigned &buflen)
+{
+	if ((buflen < 2) || (buf[0] != 'R')) {
+		return nullptr;
+	}
+
+	/* the geometry name is at most 7 characters, like in the text description */
+	const char *name = (const char *)&buf[1];
+	const char *name_end = (const char *)memchr(name, '\0', (buflen - 1 < 8) ? buflen - 1 : 8);
+
+	if (name_end == nullptr) {
+		debug("multirotor record incomplete");
+		return nullptr;
+	}
+
+	const uint8_t *s = (const uint8_t *)name_end + 1;
+	unsigned size = (s - buf) + 4 * 2;
+
+	if (buflen < size) {
+		debug("multirotor record incomplete, %u of %u", buflen, size);
+		return nullptr;
+	}
+
+	MultirotorGeometry geometry;
+
+	if (!geometry_from_name(name, geometry)) {
+		debug("unrecognised geometry '%s'", name);
+		return nullptr;
+	}
+
+	MultirotorMixer *mixer = new MultirotorMixer(
+		control_cb,
+		cb_handle,
+		geometry,
+		read_scale(&s[0]),
+		read_scale(&s[2]),
+		read_scale(&s[4]),
+		read_scale(&s[6]));
+
+	if (mixer != nullptr) {
+		buflen -= size;
+	}
+
+	return mixer;
+}
+
+unsigned
+MultirotorMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
+{
+	float		roll    = constrain(get_control(0, 0) * _roll_scale, -1.0f, 1.0f);
+	float		pitch   = constrain(get_control(0, 1) * _pitch_scale, -1.0f, 1.0f);
+	float		yaw     = constrain(get_control(0, 2) * _yaw_scale, -1.0f, 1.0f);
+	float		thrust  = constrain(get_control(0, 3), 0.0f, 1.0f);
 
-		outputs[i] = constrain(_idle_speed + (outputs[i] * (1.0f - _idle_speed)), _idle_speed, 1.0f);
+	if (_mix_fixed != nullptr) {
+		return _mix_fixed(roll, pitch, yaw, thrust, _idle_speed, outputs, status_reg);
 	}
 
-	return _rotor_count;
+	const RotorTable rotors = { _rotors, _rotor_count };
+	return mix_rotors(rotors, roll, pitch, yaw, thrust, _idle_speed, outputs, status_reg);
 }
 
 void
@@ -62,7 +62,26 @@ SimpleMixer::SimpleMixer(ControlCallback control_cb,
 			 mixer_simple_s *mixinfo) :
 	Mixer(control_cb, cb_handle),
 	_info(mixinfo)
+#ifdef MIXER_FIXED_POINT
+	, _fixed(nullptr)
+#endif
 {
+#ifdef MIXER_FIXED_POINT
+
+	/* without the memory mix_fixed() falls back to float */
+	if (_info != nullptr) {
+		_fixed = (mixer_scaler_fixed_s *)malloc((_info->control_count + 1) * sizeof(mixer_scaler_fixed_s));
+	}
+
+	if (_fixed != nullptr) {
+		scaler_to_fixed(_info->output_scaler, _fixed[0]);
+
+		for (unsigned i = 0; i < _info->control_count; i++) {
+			scaler_to_fixed(_info->controls[i].scaler, _fixed[i + 1]);
+		}
+	}
+
+#endif
 }
 
 SimpleMixer::~SimpleMixer()
@@ -70,6 +89,14 @@ SimpleMixer::~SimpleMixer()
 	if (_info != nullptr) {
 		free(_info);
 	}
+
+#ifdef MIXER_FIXED_POINT
+
+	if (_fixed != nullptr) {
+		free(_fixed);
+	}
+
+#endif
 }
 
 int
@@ -212,6 +239,50 @@ out:
 	return sm;
 }
 
+SimpleMixer *
+SimpleMixer::from_binary(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const uint8_t *buf, unsigned &buflen)
+{
+	if ((buflen < 2) || (buf[0] != 'M')) {
+		return nullptr;
+	}
+
+	unsigned inputs = buf[1];
+	unsigned size = 2 + MIXER_BINARY_SCALER_SIZE + inputs * (2 + MIXER_BINARY_SCALER_SIZE);
+
+	if (buflen < size) {
+		debug("simple mixer record incomplete, %u of %u", buflen, size);
+		return nullptr;
+	}
+
+	mixer_simple_s *mixinfo = (mixer_simple_s *)malloc(MIXER_SIMPLE_SIZE(inputs));
+
+	if (mixinfo == nullptr) {
+		debug("could not allocate memory for mixer info");
+		return nullptr;
+	}
+
+	mixinfo->control_count = inputs;
+	const uint8_t *p = read_scaler(&buf[2], mixinfo->output_scaler);
+
+	for (unsigned i = 0; i < inputs; i++) {
+		mixinfo->controls[i].control_group = p[0];
+		mixinfo->controls[i].control_index = p[1];
+		p = read_scaler(&p[2], mixinfo->controls[i].scaler);
+	}
+
+	SimpleMixer *sm = new SimpleMixer(control_cb, cb_handle, mixinfo);
+
+	if (sm != nullptr) {
+		buflen -= size;
+
+	} else {
+		debug("could not allocate memory for mixer");
+		free(mixinfo);
+	}
+
+	return sm;
+}
+
 SimpleMixer *
 SimpleMixer::pwm_input(Mixer::ControlCallback control_cb, uintptr_t cb_handle, unsigned input, uint16_t min,
 		       uint16_t mid, uint16_t max)
@@ -302,6 +373,47 @@ SimpleMixer::mix(float *outputs, unsigned space, uint16_t *status_reg)
 	return 1;
 }
 
+#ifdef MIXER_FIXED_POINT
+unsigned
+SimpleMixer::mix_fixed(int32_t *outputs, unsigned space, uint16_t *status_reg, ControlCallbackFixed control_cb)
+{
+	int32_t		sum = 0;
+	bool		valid = true;
+
+	if (_info == nullptr) {
+		return 0;
+	}
+
+	if (space < 1) {
+		return 0;
+	}
+
+	if (_fixed == nullptr) {
+		return Mixer::mix_fixed(outputs, space, status_reg, control_cb);
+	}
+
+	for (unsigned i = 0; i < _info->control_count; i++) {
+		int32_t input = 0;
+
+		control_cb(_cb_handle,
+			   _info->controls[i].control_group,
+			   _info->controls[i].control_index,
+			   input);
+
+		/* an invalid control invalidates the output, as a NaN does in float */
+		if (input == MIXER_FIXED_INVALID) {
+			valid = false;
+
+		} else {
+			sum += scale_fixed(_fixed[i + 1], input);
+		}
+	}
+
+	*outputs = valid ? scale_fixed(_fixed[0], sum) : MIXER_FIXED_INVALID;
+	return 1;
+}
+#endif
+
 void
 SimpleMixer::groups_required(uint32_t &groups)
 {
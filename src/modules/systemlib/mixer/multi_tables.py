@@ -207,12 +207,21 @@ def printScaleTablesCounts():
 
 
 
+def printMixFunctions():
+    print("#ifdef MIXER_MULTIROTOR_SPECIALIZED")
+    print("const MultirotorMixer::MixFunction _config_mix[] = {")
+    for table in tables:
+        print("\t&mix_fixed<{}, _config_{}>,".format(len(table), variableName(table)))
+    print("};")
+    print("#endif\n")
+
 printEnum()
 
 print("namespace {")
 printScaleTables()
 printScaleTablesIndex()
 printScaleTablesCounts()
+printMixFunctions()
 
 print("} // anonymous namespace\n")
 print("#endif /* _MIXER_MULTI_TABLES */")
@@ -37,6 +37,8 @@
 
 SRCS		 = \
 		   perf_counter.c \
+		   trace.c \
+		   boot_timing.c \
 		   param/param.c \
 		   conversions.c \
 		   cpuload.c \
@@ -44,6 +44,7 @@
 //#include <debug.h>
 #include <px4_defines.h>
 #include <px4_posix.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -52,10 +53,14 @@
 #include <systemlib/err.h>
 #include <errno.h>
 #include <semaphore.h>
+#include <crc32.h>
 
 #include <sys/stat.h>
 
 #include <drivers/drv_hrt.h>
+#ifndef _UNIT_TEST
+#include <px4_workqueue.h>
+#endif
 
 #include "systemlib/param/param.h"
 #include "systemlib/uthash/utarray.h"
@@ -76,6 +81,13 @@
 #else
 #define PARAM_OPEN	open
 #define PARAM_CLOSE	close
+/* the parameter files on QuRT can't seek, they are always rewritten completely */
+#define PARAM_JOURNAL
+#endif
+
+#if defined(__PX4_QURT) || defined(__PX4_POSIX)
+/* flat value table for lock-free reads, too large for the RAM of the NuttX boards */
+#define PARAM_VIEW
 #endif
 
 /**
@@ -100,6 +112,9 @@ struct param_wbuf_s {
 	param_t			param;
 	union param_value_u	val;
 	bool			unsaved;
+	uint32_t		change_seq;	/**< param_change_seq at the last change */
+	uint16_t		slot;		/**< 1 + index of its slot in the journal, 0 if none */
+	uint16_t		slot_generation; /**< generation of the newest copy in the slot */
 };
 
 
@@ -139,10 +154,36 @@ ORB_DEFINE(parameter_update, struct parameter_update_s);
 /** parameter update topic handle */
 static orb_advert_t param_topic = NULL;
 
+/** sequence number of the latest parameter change, starts at 1 so 0 can mean "never read" */
+static volatile uint32_t param_change_seq = 1;
+
+/** sequence number of the latest reset; a reset drops the per-parameter sequence numbers */
+static volatile uint32_t param_reset_seq = 0;
+
+/**
+ * Minimum interval between parameter_update publications. Changes within
+ * the window are coalesced into one trailing notification, so a GCS
+ * pushing hundreds of parameters does not make every module reload its
+ * parameters hundreds of times.
+ */
+#define PARAM_NOTIFY_INTERVAL_US	100000
+
+#ifndef _UNIT_TEST
+static struct work_s param_notify_work;
+static volatile bool param_notify_pending = false;
+static hrt_abstime param_notify_last = 0;
+#endif
+
 static void param_set_used_internal(param_t param);
 
+static const void *param_get_value_ptr(param_t param);
+
 static param_t param_find_internal(const char *name, bool notification);
 
+static int param_export_internal(bson_encoder_t encoder, bool only_unsaved);
+
+static int param_import_internal(int fd, bool mark_saved);
+
 /** lock the parameter store */
 static void
 param_lock(void)
@@ -200,42 +241,72 @@ param_compare_values(const void *a, const void *b)
 }
 
 /**
- * Locate the modified parameter structure for a parameter, if it exists.
+ * Locate the position of a parameter in the sorted modified parameters.
  *
  * @param param			The parameter being searched.
+ * @param index			Set to the index of the parameter, or where it
+ *				has to be inserted to keep the array sorted.
  * @return			The structure holding the modified value, or
  *				NULL if the parameter has not been modified.
  */
 static struct param_wbuf_s *
-param_find_changed(param_t param)
+param_find_changed_index(param_t param, unsigned *index)
 {
-	struct param_wbuf_s	*s = NULL;
+	unsigned low = 0;
 
 	param_assert_locked();
 
 	if (param_values != NULL) {
-#if 0	/* utarray_find requires bsearch, not available */
-		struct param_wbuf_s key;
-		key.param = param;
-		s = utarray_find(param_values, &key, param_compare_values);
-#else
+		/* lower bound bisection, utarray_find requires bsearch which is not available */
+		unsigned high = utarray_len(param_values);
 
-		while ((s = (struct param_wbuf_s *)utarray_next(param_values, s)) != NULL) {
-			if (s->param == param) {
-				break;
+		while (low < high) {
+			unsigned mid = (low + high) / 2;
+
+			if (((struct param_wbuf_s *)utarray_eltptr(param_values, mid))->param < param) {
+				low = mid + 1;
+
+			} else {
+				high = mid;
 			}
 		}
 
-#endif
+		if (low < utarray_len(param_values)) {
+			struct param_wbuf_s *s = (struct param_wbuf_s *)utarray_eltptr(param_values, low);
+
+			if (s->param == param) {
+				*index = low;
+				return s;
+			}
+		}
 	}
 
-	return s;
+	*index = low;
+	return NULL;
+}
+
+/**
+ * Locate the modified parameter structure for a parameter, if it exists.
+ *
+ * @param param			The parameter being searched.
+ * @return			The structure holding the modified value, or
+ *				NULL if the parameter has not been modified.
+ */
+static struct param_wbuf_s *
+param_find_changed(param_t param)
+{
+	unsigned index;
+
+	return param_find_changed_index(param, &index);
 }
 
 static void
-param_notify_changes(void)
+param_publish_changes(void)
 {
-	struct parameter_update_s pup = { .timestamp = hrt_absolute_time() };
+	struct parameter_update_s pup = {
+		.timestamp = hrt_absolute_time(),
+		.change_seq = param_change_seq
+	};
 
 	/*
 	 * If we don't have a handle to our topic, create one now; otherwise
@@ -249,25 +320,172 @@ param_notify_changes(void)
 	}
 }
 
+#ifndef _UNIT_TEST
+static void
+param_notify_worker(void *arg)
+{
+	param_notify_last = hrt_absolute_time();
+	param_notify_pending = false;
+	param_publish_changes();
+}
+#endif
+
+static void
+param_notify_changes(void)
+{
+#ifdef _UNIT_TEST
+	param_publish_changes();
+#else
+
+	/* a trailing notification is queued already, it will carry the latest sequence */
+	if (!__sync_bool_compare_and_swap(&param_notify_pending, false, true)) {
+		return;
+	}
+
+	hrt_abstime elapsed = hrt_elapsed_time(&param_notify_last);
+
+	if (elapsed >= PARAM_NOTIFY_INTERVAL_US) {
+		/* first change after a quiet period, tell everyone right away */
+		param_notify_last = hrt_absolute_time();
+		param_notify_pending = false;
+		param_publish_changes();
+
+	} else {
+		work_queue(LPWORK, &param_notify_work, param_notify_worker, NULL,
+			   USEC2TICK(PARAM_NOTIFY_INTERVAL_US - elapsed));
+	}
+
+#endif
+}
+
+uint32_t
+param_get_change_seq(void)
+{
+	return param_change_seq;
+}
+
+bool
+param_changed_since(param_t param, uint32_t change_seq)
+{
+	if (change_seq == 0 || change_seq < param_reset_seq) {
+		return true;
+	}
+
+	param_lock();
+
+	struct param_wbuf_s *s = param_find_changed(param);
+	bool changed = (s != NULL) && (s->change_seq > change_seq);
+
+	param_unlock();
+
+	return changed;
+}
+
+uint32_t
+param_hash_check(void)
+{
+	uint32_t param_hash = 0;
+
+	param_lock();
+
+	/* CRC32 over the name and value of every used parameter */
+	for (param_t param = 0; handle_in_range(param); param++) {
+		if (!param_used(param)) {
+			continue;
+		}
+
+		const char *name = param_name(param);
+		const void *val = param_get_value_ptr(param);
+
+		if (val == NULL) {
+			continue;
+		}
+
+		param_hash = crc32part((const uint8_t *)name, strlen(name), param_hash);
+		param_hash = crc32part((const uint8_t *)val, param_size(param), param_hash);
+	}
+
+	param_unlock();
+
+	return param_hash;
+}
+
+/**
+ * Test whether the static parameter table is sorted by name.
+ *
+ * The linker scripts sort the per-parameter __param.<name> sections, so
+ * this normally holds and param_find() can bisect. The result is
+ * remembered for the table it was computed for.
+ *
+ * @return			True if the names are in strictly ascending order.
+ */
+static bool
+param_info_sorted(void)
+{
+	static const struct param_info_s *checked_base = NULL;
+	static unsigned checked_count = 0;
+	static bool sorted = false;
+
+	if (checked_base != param_info_base || checked_count != param_info_count) {
+		bool result = true;
+
+		for (unsigned i = 1; i < param_info_count; i++) {
+			if (strcmp(param_info_base[i - 1].name, param_info_base[i].name) >= 0) {
+				result = false;
+				break;
+			}
+		}
+
+		sorted = result;
+		checked_count = param_info_count;
+		checked_base = param_info_base;
+	}
+
+	return sorted;
+}
+
 param_t
 param_find_internal(const char *name, bool notification)
 {
-	param_t param;
+	param_t param = PARAM_INVALID;
+	int count = get_param_info_count();
 
-	/* perform a linear search of the known parameters */
+	if (param_info_sorted()) {
+		/* bisect the sorted table, bsearch is not available on all targets */
+		int low = 0;
+		int high = count - 1;
 
-	for (param = 0; handle_in_range(param); param++) {
-		if (!strcmp(param_info_base[param].name, name)) {
-			if (notification) {
-				param_set_used_internal(param);
+		while (low <= high) {
+			int mid = (low + high) / 2;
+			int cmp = strcmp(param_info_base[mid].name, name);
+
+			if (cmp == 0) {
+				param = mid;
+				break;
+
+			} else if (cmp < 0) {
+				low = mid + 1;
+
+			} else {
+				high = mid - 1;
 			}
+		}
 
-			return param;
+	} else {
+		/* perform a linear search of the known parameters */
+		for (int i = 0; i < count; i++) {
+			if (!strcmp(param_info_base[i].name, name)) {
+				param = i;
+				break;
+			}
 		}
 	}
 
-	/* not found */
-	return PARAM_INVALID;
+	if (param != PARAM_INVALID && notification) {
+		param_set_used_internal(param);
+	}
+
+	return param;
 }
 
 param_t
@@ -434,6 +652,147 @@ param_size(param_t param)
 	return 0;
 }
 
+#ifdef PARAM_VIEW
+/**
+ * Current value of every parameter indexed by param_t, so reading a scalar
+ * parameter is a plain memory read instead of a search of param_values.
+ *
+ * Writers make the generation odd while they update values, readers retry
+ * until they saw the same even generation before and after reading. The
+ * view does not point into param_values, so it could be placed in memory
+ * shared with another processor.
+ */
+struct param_view_s {
+	volatile uint32_t		generation;
+	const struct param_info_s	*base;		/**< parameter table the view was built for */
+	unsigned			count;
+	union param_value_u		values[];
+};
+
+static struct param_view_s *volatile param_view = NULL;
+
+static void
+param_view_begin(struct param_view_s *view)
+{
+	view->generation++;
+	__sync_synchronize();
+}
+
+static void
+param_view_end(struct param_view_s *view)
+{
+	__sync_synchronize();
+	view->generation++;
+}
+
+static void
+param_view_fill(struct param_view_s *view, param_t param)
+{
+	struct param_wbuf_s *s = param_find_changed(param);
+
+	view->values[param] = (s != NULL) ? s->val : param_info_base[param].val;
+}
+
+/**
+ * Copy all current values into the view, allocating it on first use or
+ * when the parameter table changed.
+ */
+static void
+param_view_rebuild(void)
+{
+	struct param_view_s *view = param_view;
+	unsigned count = get_param_info_count();
+
+	param_assert_locked();
+
+	if (view == NULL || view->base != param_info_base || view->count != count) {
+		/*
+		 * The previous view is not freed: param_view_get() reads it
+		 * without the lock and may still hold the pointer. The table
+		 * is fixed at link time, so this normally runs only once.
+		 */
+		view = malloc(sizeof(struct param_view_s) + count * sizeof(union param_value_u));
+
+		if (view == NULL) {
+			/* readers fall back to param_values */
+			param_view = NULL;
+			return;
+		}
+
+		view->generation = 0;
+		view->base = param_info_base;
+		view->count = count;
+
+		for (param_t param = 0; param < count; param++) {
+			param_view_fill(view, param);
+		}
+
+		__sync_synchronize();
+		param_view = view;
+		return;
+	}
+
+	param_view_begin(view);
+
+	for (param_t param = 0; param < count; param++) {
+		param_view_fill(view, param);
+	}
+
+	param_view_end(view);
+}
+
+/**
+ * Copy the current value of one parameter into the view.
+ */
+static void
+param_view_update(param_t param)
+{
+	struct param_view_s *view = param_view;
+
+	if (view == NULL || view->base != param_info_base || param >= view->count) {
+		param_view_rebuild();
+		return;
+	}
+
+	param_view_begin(view);
+	param_view_fill(view, param);
+	param_view_end(view);
+}
+
+/**
+ * Read a scalar parameter from the view.
+ *
+ * @return			True if the value was read, false if there is no
+ *				view for the current parameter table.
+ */
+static bool
+param_view_get(param_t param, void *val)
+{
+	struct param_view_s *view = param_view;
+
+	if (view == NULL || view->base != param_info_base || param >= view->count) {
+		return false;
+	}
+
+	uint32_t generation;
+	union param_value_u v;
+
+	do {
+		generation = view->generation;
+		__sync_synchronize();
+		v = view->values[param];
+		__sync_synchronize();
+
+	} while ((generation & 1) || generation != view->generation);
+
+	memcpy(val, &v, param_size(param));
+	return true;
+}
+#else
+#define param_view_rebuild()
+#define param_view_update(param)
+#endif
+
 /**
  * Obtain a pointer to the storage allocated for a parameter.
  *
@@ -480,6 +839,16 @@ param_get(param_t param, void *val)
 {
 	int result = -1;
 
+#ifdef PARAM_VIEW
+
+	if (val != NULL && handle_in_range(param) &&
+	    (param_type(param) == PARAM_TYPE_INT32 || param_type(param) == PARAM_TYPE_FLOAT) &&
+	    param_view_get(param, val)) {
+		return 0;
+	}
+
+#endif
+
 	param_lock();
 
 	const void *v = param_get_value_ptr(param);
@@ -513,7 +882,8 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 
 	if (handle_in_range(param)) {
 
-		struct param_wbuf_s *s = param_find_changed(param);
+		unsigned index;
+		struct param_wbuf_s *s = param_find_changed_index(param, &index);
 
 		if (s == NULL) {
 
@@ -524,12 +894,9 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 				.unsaved = false
 			};
 
-			/* add it to the array and sort */
-			utarray_push_back(param_values, &buf);
-			utarray_sort(param_values, param_compare_values);
-
-			/* find it after sorting */
-			s = param_find_changed(param);
+			/* insert it where it keeps the array sorted */
+			utarray_insert(param_values, &buf, index);
+			s = (struct param_wbuf_s *)utarray_eltptr(param_values, index);
 		}
 
 		/* update the changed value */
@@ -561,6 +928,8 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 		}
 
 		s->unsaved = !mark_saved;
+		s->change_seq = ++param_change_seq;
+		param_view_update(param);
 		params_changed = true;
 		result = 0;
 	}
@@ -633,6 +1002,8 @@ param_reset(param_t param)
 		if (s != NULL) {
 			int pos = utarray_eltidx(param_values, s);
 			utarray_erase(param_values, pos, 1);
+			param_reset_seq = ++param_change_seq;
+			param_view_update(param);
 		}
 
 		param_found = true;
@@ -658,6 +1029,8 @@ param_reset_all(void)
 
 	/* mark as reset / deleted */
 	param_values = NULL;
+	param_reset_seq = ++param_change_seq;
+	param_view_rebuild();
 
 	param_unlock();
 
@@ -699,6 +1072,71 @@ param_reset_excludes(const char *excludes[], int num_excludes)
 static const char *param_default_file = PX4_ROOTFSDIR"/eeprom/parameters";
 static char *param_user_file = NULL;
 
+#ifdef PARAM_JOURNAL
+/*
+ * The default file holds one BSON document with all modified parameters,
+ * followed by a journal of fixed size slots, terminated by a word that is
+ * not the slot magic. A parameter saved since the last full save owns a
+ * slot, and saving it again only rewrites that slot in place, so the file
+ * only grows with the number of distinct parameters changed.
+ *
+ * A slot holds two copies of the value, written in turn with an increasing
+ * generation: a write torn by a power loss leaves the previous copy intact,
+ * loading takes the newest copy with a valid checksum. Once the journal is
+ * full, or if a parameter was reset, the whole file is rewritten (compacted).
+ */
+#define PARAM_JOURNAL_MAGIC	0x4c4e4a50	/* "PJNL", BSON record of the earlier journal format */
+#define PARAM_SLOT_MAGIC	0x544c5350	/* "PSLT" */
+#define PARAM_JOURNAL_MAX_SIZE	2048
+
+struct param_slot_copy_s {
+	uint16_t		generation;
+	uint8_t			type;
+	uint8_t			reserved;
+	char			name[16];	/**< not terminated if 16 characters long */
+	union {
+		int32_t		i;
+		float		f;
+	} val;
+	uint32_t		crc;		/**< of the fields above */
+};
+
+struct param_slot_s {
+	uint32_t		magic;
+	struct param_slot_copy_s copy[2];	/**< generation & 1 selects the copy */
+};
+
+static off_t param_journal_start = 0;		/**< offset of the first slot */
+static off_t param_journal_end = 0;		/**< offset of the terminator, 0 if unknown */
+static uint32_t param_journal_reset_seq = 0;	/**< param_reset_seq when the file was last in sync */
+
+static uint32_t
+param_slot_crc(const struct param_slot_copy_s *copy)
+{
+	return crc32part((const uint8_t *)copy, offsetof(struct param_slot_copy_s, crc), PARAM_SLOT_MAGIC);
+}
+
+/**
+ * Forget the journal slots of all modified parameters, after a full save.
+ */
+static void
+param_journal_clear_slots(void)
+{
+	struct param_wbuf_s *s = NULL;
+
+	param_lock();
+
+	if (param_values != NULL) {
+		while ((s = (struct param_wbuf_s *)utarray_next(param_values, s)) != NULL) {
+			s->slot = 0;
+			s->slot_generation = 0;
+		}
+	}
+
+	param_unlock();
+}
+#endif
+
 int
 param_set_default_file(const char *filename)
 {
@@ -711,6 +1149,11 @@ param_set_default_file(const char *filename)
 		param_user_file = strdup(filename);
 	}
 
+#ifdef PARAM_JOURNAL
+	/* nothing known about the new file, the next save rewrites it */
+	param_journal_end = 0;
+#endif
+
 	return 0;
 }
 
@@ -720,14 +1163,12 @@ param_get_default_file(void)
 	return (param_user_file != NULL) ? param_user_file : param_default_file;
 }
 
-int
-param_save_default(void)
+static int
+param_save_full(const char *filename)
 {
 	int res;
 	int fd;
 
-	const char *filename = param_get_default_file();
-
 	/* write parameters to temp file */
 	fd = PARAM_OPEN(filename, O_WRONLY | O_CREAT, PX4_O_MODE_666);
 
@@ -742,31 +1183,318 @@ param_save_default(void)
 		warnx("failed to write parameters to file: %s", filename);
 	}
 
+#ifdef PARAM_JOURNAL
+	param_journal_end = 0;
+	param_journal_clear_slots();
+
+	if (res == OK) {
+		/* start an empty journal, records of an older one may still follow */
+		const int32_t terminator = 0;
+		off_t end = lseek(fd, 0, SEEK_CUR);
+
+		if (end > 0 && write(fd, &terminator, sizeof(terminator)) == sizeof(terminator)) {
+			param_journal_start = end;
+			param_journal_end = end;
+			param_journal_reset_seq = param_reset_seq;
+		}
+	}
+
+#endif
+
 	PARAM_CLOSE(fd);
 
 	return res;
 }
 
-/**
- * @return 0 on success, 1 if all params have not yet been stored, -1 if device open failed, -2 if writing parameters failed
- */
-int
-param_load_default(void)
+#ifdef PARAM_JOURNAL
+static int
+param_journal_append(const char *filename)
 {
-	warnx("param_load_default\n");
-	int fd_load = PARAM_OPEN(param_get_default_file(), O_RDONLY);
+	struct param_wbuf_s *s = NULL;
+	unsigned new_slots = 0;
+	bool changed = false;
+	int fd = -1;
+	int result = ERROR;
 
-	if (fd_load < 0) {
-		/* no parameter file is OK, otherwise this is an error */
-		if (errno != ENOENT) {
-			warn("open '%s' for reading failed", param_get_default_file());
-			return -1;
-		}
+	param_lock();
+
+	if (param_values == NULL) {
+		result = OK;
+		goto out;
+	}
+
+	/* only plain values fit a slot, and the new slots must fit the journal */
+	while ((s = (struct param_wbuf_s *)utarray_next(param_values, s)) != NULL) {
+		if (!s->unsaved) {
+			continue;
+		}
+
+		param_type_t type = param_type(s->param);
+
+		if (type != PARAM_TYPE_INT32 && type != PARAM_TYPE_FLOAT) {
+			goto out;
+		}
+
+		if (s->slot == 0) {
+			new_slots++;
+		}
+
+		changed = true;
+	}
+
+	if (!changed) {
+		/* nothing changed since the last save */
+		result = OK;
+		goto out;
+	}
+
+	if ((param_journal_end - param_journal_start) + (off_t)(new_slots * sizeof(struct param_slot_s)) >
+	    PARAM_JOURNAL_MAX_SIZE) {
+		goto out;
+	}
+
+	fd = PARAM_OPEN(filename, O_WRONLY);
+
+	if (fd < 0) {
+		goto out;
+	}
+
+	while ((s = (struct param_wbuf_s *)utarray_next(param_values, s)) != NULL) {
+		if (!s->unsaved) {
+			continue;
+		}
+
+		struct param_slot_copy_s copy;
+		memset(&copy, 0, sizeof(copy));
+		copy.generation = (s->slot != 0) ? s->slot_generation + 1 : 0;
+		copy.type = param_type(s->param);
+		strncpy(copy.name, param_name(s->param), sizeof(copy.name));
+
+		if (copy.type == PARAM_TYPE_INT32) {
+			copy.val.i = s->val.i;
+
+		} else {
+			copy.val.f = s->val.f;
+		}
+
+		copy.crc = param_slot_crc(&copy);
+
+		if (s->slot != 0) {
+			/* overwrite the older copy of its slot, a single small write */
+			off_t offset = param_journal_start + (s->slot - 1) * sizeof(struct param_slot_s) +
+				       offsetof(struct param_slot_s, copy) + (copy.generation & 1) * sizeof(copy);
+
+			if (lseek(fd, offset, SEEK_SET) != offset ||
+			    write(fd, &copy, sizeof(copy)) != sizeof(copy)) {
+				goto out;
+			}
+
+		} else {
+			/* new slot and the new terminator go out in a single write */
+			struct {
+				struct param_slot_s slot;
+				int32_t terminator;
+			} record;
+
+			memset(&record, 0, sizeof(record));
+			record.slot.magic = PARAM_SLOT_MAGIC;
+			record.slot.copy[0] = copy;
+
+			if (lseek(fd, param_journal_end, SEEK_SET) != param_journal_end ||
+			    write(fd, &record, sizeof(record)) != sizeof(record)) {
+				goto out;
+			}
+
+			param_journal_end += sizeof(struct param_slot_s);
+			s->slot = (param_journal_end - param_journal_start) / sizeof(struct param_slot_s);
+		}
+
+		s->slot_generation = copy.generation;
+		s->unsaved = false;
+	}
+
+	fsync(fd);
+	result = OK;
+
+out:
+
+	if (fd >= 0) {
+		PARAM_CLOSE(fd);
+	}
+
+	param_unlock();
+
+	return result;
+}
+
+/**
+ * Apply the slot at the current file position, after its magic.
+ *
+ * @return			0 on success (also for unknown parameters), -1 on a damaged slot.
+ */
+static int
+param_journal_apply_slot(int fd, uint16_t slot)
+{
+	struct param_slot_copy_s copy[2];
+
+	if (read(fd, &copy[0], sizeof(copy)) != sizeof(copy)) {
+		return -1;
+	}
+
+	bool valid0 = (copy[0].crc == param_slot_crc(&copy[0]));
+	bool valid1 = (copy[1].crc == param_slot_crc(&copy[1]));
+
+	if (!valid0 && !valid1) {
+		return -1;
+	}
+
+	/* the newest valid copy, the generation may wrap */
+	const struct param_slot_copy_s *c = &copy[0];
+
+	if (valid1 && (!valid0 || (int16_t)(copy[1].generation - copy[0].generation) > 0)) {
+		c = &copy[1];
+	}
+
+	char name[sizeof(c->name) + 1];
+	memcpy(name, c->name, sizeof(c->name));
+	name[sizeof(c->name)] = '\0';
+
+	param_t param = param_find_no_notification(name);
+
+	if (param == PARAM_INVALID || param_type(param) != c->type) {
+		debug("ignoring slot of '%s'", name);
+		return 0;
+	}
+
+	if (param_set_internal(param, &c->val, true, false) != 0) {
+		return -1;
+	}
+
+	param_lock();
+	struct param_wbuf_s *s = param_find_changed(param);
+
+	if (s != NULL) {
+		s->slot = slot;
+		s->slot_generation = c->generation;
+	}
+
+	param_unlock();
+
+	return 0;
+}
+
+static void
+param_journal_replay(int fd)
+{
+	off_t start = lseek(fd, 0, SEEK_CUR);
+	off_t end = start;
+	bool legacy = false;
+	uint16_t slot = 0;
+
+	param_journal_end = 0;
+
+	if (start <= 0) {
+		return;
+	}
+
+	for (;;) {
+		int32_t magic;
+
+		if (read(fd, &magic, sizeof(magic)) != sizeof(magic)) {
+			break;
+		}
+
+		if (magic == PARAM_SLOT_MAGIC && !legacy) {
+			if (param_journal_apply_slot(fd, ++slot) != 0) {
+				/* torn slot, e.g. power loss while it was added: the next save rewrites the file */
+				warnx("parameter journal damaged at offset %ld", (long)end);
+				goto out;
+			}
+
+		} else if (magic == PARAM_JOURNAL_MAGIC && slot == 0) {
+			/* BSON records of the earlier format are loaded, the next save converts the file */
+			if (param_import_internal(fd, true) != 0) {
+				warnx("parameter journal damaged at offset %ld", (long)end);
+				goto out;
+			}
+
+			legacy = true;
+
+		} else {
+			break;
+		}
+
+		end = lseek(fd, 0, SEEK_CUR);
+
+		if (end < 0) {
+			goto out;
+		}
+	}
+
+	if (!legacy) {
+		param_journal_start = start;
+		param_journal_end = end;
+		param_journal_reset_seq = param_reset_seq;
+	}
+
+out:
+
+	if (slot > 0) {
+		param_notify_changes();
+	}
+}
+#endif
+
+int
+param_save_default(void)
+{
+	const char *filename = param_get_default_file();
+
+#ifdef PARAM_JOURNAL
+
+	/* a few changed values only need a small record at the end of the file */
+	if (param_journal_end > 0 &&
+	    param_journal_reset_seq == param_reset_seq &&
+	    (param_journal_end - param_journal_start) < PARAM_JOURNAL_MAX_SIZE) {
+
+		if (param_journal_append(filename) == OK) {
+			return OK;
+		}
+
+		warnx("appending to %s failed, rewriting it", filename);
+	}
+
+#endif
+
+	return param_save_full(filename);
+}
+
+int
+param_load_default(void)
+{
+	warnx("param_load_default\n");
+	int fd_load = PARAM_OPEN(param_get_default_file(), O_RDONLY);
+
+	if (fd_load < 0) {
+		/* no parameter file is OK, otherwise this is an error */
+		if (errno != ENOENT) {
+			warn("open '%s' for reading failed", param_get_default_file());
+			return -1;
+		}
 
 		return 1;
 	}
 
 	int result = param_load(fd_load);
+
+#ifdef PARAM_JOURNAL
+
+	if (result == 0) {
+		param_journal_replay(fd_load);
+	}
+
+#endif
+
 	PARAM_CLOSE(fd_load);
 
 	if (result != 0) {
@@ -777,17 +1505,22 @@ param_load_default(void)
 	return 0;
 }
 
-int
-param_export(int fd, bool only_unsaved)
+/**
+ * Append the modified parameters to a BSON document.
+ *
+ * @param encoder		Encoder of the document, not finalised here.
+ * @param only_unsaved		Only append parameters changed since the last save.
+ * @return			The number of parameters appended, or -1 on error.
+ */
+static int
+param_export_internal(bson_encoder_t encoder, bool only_unsaved)
 {
 	struct param_wbuf_s *s = NULL;
-	struct bson_encoder_s encoder;
 	int	result = -1;
+	int	count = 0;
 
 	param_lock();
 
-	bson_encoder_init_file(&encoder, fd);
-
 	/* no modified parameters -> we are done */
 	if (param_values == NULL) {
 		result = 0;
@@ -816,7 +1549,7 @@ param_export(int fd, bool only_unsaved)
 		case PARAM_TYPE_INT32:
 			param_get(s->param, &i);
 
-			if (bson_encoder_append_int(&encoder, param_name(s->param), i)) {
+			if (bson_encoder_append_int(encoder, param_name(s->param), i)) {
 				debug("BSON append failed for '%s'", param_name(s->param));
 				goto out;
 			}
@@ -826,7 +1559,7 @@ param_export(int fd, bool only_unsaved)
 		case PARAM_TYPE_FLOAT:
 			param_get(s->param, &f);
 
-			if (bson_encoder_append_double(&encoder, param_name(s->param), f)) {
+			if (bson_encoder_append_double(encoder, param_name(s->param), f)) {
 				debug("BSON append failed for '%s'", param_name(s->param));
 				goto out;
 			}
@@ -834,7 +1567,7 @@ param_export(int fd, bool only_unsaved)
 			break;
 
 		case PARAM_TYPE_STRUCT ... PARAM_TYPE_STRUCT_MAX:
-			if (bson_encoder_append_binary(&encoder,
+			if (bson_encoder_append_binary(encoder,
 						       param_name(s->param),
 						       BSON_BIN_BINARY,
 						       param_size(s->param),
@@ -849,24 +1582,162 @@ param_export(int fd, bool only_unsaved)
 			debug("unrecognized parameter type");
 			goto out;
 		}
+
+		count++;
 	}
 
-	result = 0;
+	result = count;
 
 out:
 	param_unlock();
 
-	if (result == 0) {
-		result = bson_encoder_fini(&encoder);
+	return result;
+}
+
+int
+param_export(int fd, bool only_unsaved)
+{
+	struct bson_encoder_s encoder;
+
+	bson_encoder_init_file(&encoder, fd);
+
+	int result = param_export_internal(&encoder, only_unsaved);
+
+	if (result < 0) {
+		return result;
 	}
 
-	return result;
+	return bson_encoder_fini(&encoder);
 }
 
 struct param_import_state {
 	bool mark_saved;
+	UT_array *values;	/**< decoded values, merged into param_values once the document is read */
 };
 
+/**
+ * Order decoded values by parameter, several values of one parameter in
+ * the order they were decoded (kept in change_seq until the merge).
+ */
+static int
+param_compare_import(const void *a, const void *b)
+{
+	int result = param_compare_values(a, b);
+
+	if (result == 0) {
+		uint32_t seq_a = ((const struct param_wbuf_s *)a)->change_seq;
+		uint32_t seq_b = ((const struct param_wbuf_s *)b)->change_seq;
+		result = (seq_a < seq_b) ? -1 : ((seq_a > seq_b) ? 1 : 0);
+	}
+
+	return result;
+}
+
+/**
+ * Free the storage of a modified struct parameter.
+ */
+static void
+param_free_value(struct param_wbuf_s *s)
+{
+	param_type_t type = param_type(s->param);
+
+	if (type >= PARAM_TYPE_STRUCT && type <= PARAM_TYPE_STRUCT_MAX && s->val.p != NULL) {
+		free(s->val.p);
+		s->val.p = NULL;
+	}
+}
+
+/**
+ * Merge decoded values into the modified parameters.
+ *
+ * The values are sorted once and merged with the sorted param_values in a
+ * single pass, instead of sorting param_values for every new parameter.
+ *
+ * @param values		The decoded values, sorted here; their storage moves to param_values.
+ * @param mark_saved		Mark the merged values as saved.
+ * @return			The number of values merged, or -1 on error.
+ */
+static int
+param_merge_values(UT_array *values, bool mark_saved)
+{
+	unsigned count = utarray_len(values);
+	int result = -1;
+
+	if (count == 0) {
+		return 0;
+	}
+
+	utarray_sort(values, param_compare_import);
+
+	param_lock();
+
+	unsigned existing = (param_values != NULL) ? utarray_len(param_values) : 0;
+	UT_array *merged;
+
+	utarray_new(merged, &param_icd);
+
+	if (merged == NULL) {
+		debug("failed to allocate modified values array");
+		goto out;
+	}
+
+	utarray_reserve(merged, existing + count);
+
+	unsigned e = 0;
+	unsigned i = 0;
+
+	while (e < existing || i < count) {
+		struct param_wbuf_s *old = (e < existing) ? (struct param_wbuf_s *)utarray_eltptr(param_values, e) : NULL;
+		struct param_wbuf_s *imp = (i < count) ? (struct param_wbuf_s *)utarray_eltptr(values, i) : NULL;
+
+		if (imp == NULL || (old != NULL && old->param < imp->param)) {
+			utarray_push_back(merged, old);
+			e++;
+			continue;
+		}
+
+		i++;
+
+		/* of several values for one parameter the last one decoded wins */
+		if (i < count && ((struct param_wbuf_s *)utarray_eltptr(values, i))->param == imp->param) {
+			param_free_value(imp);
+			continue;
+		}
+
+		if (old != NULL && old->param == imp->param) {
+			/* the value stays in its journal slot */
+			imp->slot = old->slot;
+			imp->slot_generation = old->slot_generation;
+			param_free_value(old);
+			e++;
+		}
+
+		imp->unsaved = !mark_saved;
+		imp->change_seq = ++param_change_seq;
+		utarray_push_back(merged, imp);
+	}
+
+	if (param_values != NULL) {
+		utarray_free(param_values);
+	}
+
+	param_values = merged;
+	param_view_rebuild();
+	result = count;
+
+	/* the storage belongs to param_values now */
+	utarray_clear(values);
+
+out:
+	param_unlock();
+
+	if (result > 0) {
+		param_notify_changes();
+	}
+
+	return result;
+}
+
 static int
 param_import_callback(bson_decoder_t decoder, void *private, bson_node_t node)
 {
@@ -953,16 +1824,31 @@ param_import_callback(bson_decoder_t decoder, void *private, bson_node_t node)
 		goto out;
 	}
 
-	if (param_set_internal(param, v, state->mark_saved, true)) {
-		debug("error setting value for '%s'", node->name);
-		goto out;
-	}
+	/* collect the value, param_merge_values() applies them all at once */
+	struct param_wbuf_s buf = {
+		.param = param,
+		.unsaved = false,
+		.change_seq = utarray_len(state->values)
+	};
 
-	if (tmp != NULL) {
-		free(tmp);
+	switch (param_type(param)) {
+	case PARAM_TYPE_INT32:
+		buf.val.i = *(int32_t *)v;
+		break;
+
+	case PARAM_TYPE_FLOAT:
+		buf.val.f = *(float *)v;
+		break;
+
+	default:
+		/* the storage moves into the decoded value */
+		buf.val.p = tmp;
 		tmp = NULL;
+		break;
 	}
 
+	utarray_push_back(state->values, &buf);
+
 	/* don't return zero, that means EOF */
 	result = 1;
 
@@ -982,20 +1868,38 @@ param_import_internal(int fd, bool mark_saved)
 	int result = -1;
 	struct param_import_state state;
 
+	state.mark_saved = mark_saved;
+	utarray_new(state.values, &param_icd);
+
+	if (state.values == NULL) {
+		debug("failed to allocate decoded values array");
+		return -1;
+	}
+
 	if (bson_decoder_init_file(&decoder, fd, param_import_callback, &state)) {
 		debug("decoder init failed");
 		goto out;
 	}
 
-	state.mark_saved = mark_saved;
-
 	do {
 		result = bson_decoder_next(&decoder);
 
 	} while (result > 0);
 
+	/* like setting them one by one, the values decoded before an error are kept */
+	if (param_merge_values(state.values, mark_saved) < 0) {
+		result = -1;
+	}
+
 out:
 
+	/* values left over after a failed merge */
+	for (unsigned i = 0; i < utarray_len(state.values); i++) {
+		param_free_value((struct param_wbuf_s *)utarray_eltptr(state.values, i));
+	}
+
+	utarray_free(state.values);
+
 	if (result < 0) {
 		debug("BSON error decoding parameters");
 	}
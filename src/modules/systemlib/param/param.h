@@ -221,6 +221,39 @@ __EXPORT int		param_set(param_t param, const void *val);
  */
 __EXPORT int		param_set_no_notification(param_t param, const void *val);
 
+/**
+ * Obtain the sequence number of the latest parameter change.
+ *
+ * Every set or reset advances the sequence; parameter_update carries the
+ * value at the time it was published. Take the sequence before reading a
+ * parameter and pass it to param_changed_since() later.
+ *
+ * @return		The sequence number, never zero.
+ */
+__EXPORT uint32_t	param_get_change_seq(void);
+
+/**
+ * Test whether a parameter may have changed after a given sequence number.
+ *
+ * This errs on the side of reporting a change, e.g. after any reset.
+ *
+ * @param param		A handle returned by param_find or passed by param_foreach.
+ * @param change_seq	A value returned by param_get_change_seq(), or zero if the
+ *			parameter was never read.
+ * @return		True if the parameter needs to be read again.
+ */
+__EXPORT bool		param_changed_since(param_t param, uint32_t change_seq);
+
+/**
+ * Compute a hash over the names and current values of all used parameters.
+ *
+ * A ground station that cached the parameter list can compare this against
+ * the hash of its copy instead of downloading the list again.
+ *
+ * @return		CRC32 over the used parameters, in index order.
+ */
+__EXPORT uint32_t	param_hash_check(void);
+
 /**
  * Reset a parameter to its default value.
  *
@@ -338,7 +371,9 @@ __EXPORT int 		param_load_default(void);
  *
  * Note that these structures are not known by name; they are
  * collected into a section that is iterated by the parameter
- * code.
+ * code. Each parameter gets its own __param.<name> input section
+ * so the linker scripts can sort the table by name, which lets
+ * param_find() use a binary search.
  *
  * Note that these macros cannot be used in C++ code due to
  * their use of designated initializers.  They should probably
@@ -348,7 +383,7 @@ __EXPORT int 		param_load_default(void);
 /** define an int32 parameter */
 #define PARAM_DEFINE_INT32(_name, _default)		\
 	static const					\
-	__attribute__((used, section("__param")))	\
+	__attribute__((used, section("__param." #_name))) \
 	struct param_info_s __param__##_name = {	\
 		#_name,					\
 		PARAM_TYPE_INT32,			\
@@ -358,7 +393,7 @@ __EXPORT int 		param_load_default(void);
 /** define a float parameter */
 #define PARAM_DEFINE_FLOAT(_name, _default)		\
 	static const					\
-	__attribute__((used, section("__param")))	\
+	__attribute__((used, section("__param." #_name))) \
 	struct param_info_s __param__##_name = {	\
 		#_name,					\
 		PARAM_TYPE_FLOAT,			\
@@ -368,7 +403,7 @@ __EXPORT int 		param_load_default(void);
 /** define a parameter that points to a structure */
 #define PARAM_DEFINE_STRUCT(_name, _default)		\
 	static const					\
-	__attribute__((used, section("__param")))	\
+	__attribute__((used, section("__param." #_name))) \
 	struct param_info_s __param__##_name = {	\
 		#_name,					\
 		PARAM_TYPE_STRUCT + sizeof(_default),	\
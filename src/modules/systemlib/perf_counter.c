@@ -49,13 +49,37 @@
 #define dprintf(...)
 #endif
 
+#ifdef __PX4_POSIX
+/* counters are shared by threads running on several cores */
+#define perf_atomic_add(ptr, val)	__atomic_add_fetch((ptr), (val), __ATOMIC_RELAXED)
+#define perf_atomic_exchange(ptr, val)	__atomic_exchange_n((ptr), (val), __ATOMIC_RELAXED)
+#define perf_atomic_cas(ptr, old, val)	__atomic_compare_exchange_n((ptr), (old), (val), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#else
+/* single core, plain updates as before */
+#define perf_atomic_add(ptr, val)	(*(ptr) += (val))
+#define perf_atomic_exchange(ptr, val)	({ __typeof__(*(ptr)) _prev = *(ptr); *(ptr) = (val); _prev; })
+#define perf_atomic_cas(ptr, old, val)	(*(ptr) = (val), true)
+#endif
+
 /**
  * Header common to all counters.
  */
 struct perf_ctr_header {
-	sq_entry_t		link;	/**< list linkage */
-	enum perf_counter_type	type;	/**< counter type */
-	const char		*name;	/**< counter name */
+	sq_entry_t		link;		/**< list linkage */
+	struct perf_ctr_header	*hash_next;	/**< next counter in the same name hash bucket */
+	enum perf_counter_type	type;		/**< counter type */
+	const char		*name;		/**< counter name */
+};
+
+/**
+ * Running mean and variance, packed so they can be updated with one compare-and-swap.
+ */
+union perf_moments {
+	struct {
+		float		mean;
+		float		M2;
+	};
+	uint64_t		bits;
 };
 
 /**
@@ -77,8 +101,9 @@ struct perf_ctr_elapsed {
 	uint64_t		time_total;
 	uint64_t		time_least;
 	uint64_t		time_most;
-	float			mean;
-	float			M2;
+	union perf_moments	moments;
+	uint64_t		events_reported;	/**< event_count at the last perf_top_elapsed() */
+	uint64_t		time_reported;		/**< time_total at the last perf_top_elapsed() */
 };
 
 /**
@@ -92,8 +117,35 @@ struct perf_ctr_interval {
 	uint64_t		time_last;
 	uint64_t		time_least;
 	uint64_t		time_most;
-	float			mean;
-	float			M2;
+	union perf_moments	moments;
+};
+
+/**
+ * PC_LATENCY counter.
+ *
+ * Starts with a PC_ELAPSED counter so that all elapsed operations apply.
+ */
+struct perf_ctr_latency {
+	struct perf_ctr_elapsed	elapsed;
+	uint32_t		bucket_count[];
+};
+
+/**
+ * Upper bounds of the PC_LATENCY histogram buckets, in microseconds.
+ */
+static const uint16_t perf_latency_buckets[] = { 500, 1000, 2000, 3000, 4000, 5000, 7500, 10000, 20000 };
+#define PERF_LATENCY_BUCKET_COUNT	(sizeof(perf_latency_buckets) / sizeof(perf_latency_buckets[0]))
+
+/**
+ * PC_HISTOGRAM counter.
+ *
+ * Starts with a PC_ELAPSED counter so that all elapsed operations apply.
+ * Bucket 0 counts events of 0us, bucket i events of [2^(i-1), 2^i) us and
+ * the last bucket everything longer.
+ */
+struct perf_ctr_histogram {
+	struct perf_ctr_elapsed	elapsed;
+	uint32_t		bucket_count[PERF_HISTOGRAM_BUCKETS];
 };
 
 /**
@@ -101,6 +153,118 @@ struct perf_ctr_interval {
  */
 static sq_queue_t	perf_counters;
 
+/**
+ * Counters by name hash, for perf_alloc_once().
+ */
+#define PERF_HASH_BUCKETS	32
+static perf_counter_t	perf_hash[PERF_HASH_BUCKETS];
+
+static unsigned
+perf_name_hash(const char *name)
+{
+	/* FNV-1a */
+	uint32_t hash = 2166136261u;
+
+	while (*name != '\0') {
+		hash = (hash ^ (uint8_t)*name++) * 16777619u;
+	}
+
+	return hash % PERF_HASH_BUCKETS;
+}
+
+/**
+ * Knuth/Welford recursive mean and variance (via Wikipedia), count includes
+ * the new sample.
+ */
+static void
+perf_moments_update(union perf_moments *moments, float sample, uint64_t count)
+{
+	union perf_moments prev, next;
+
+	prev.bits = moments->bits;
+
+	do {
+		float delta = sample - prev.mean;
+		next.mean = prev.mean + delta / count;
+		next.M2 = prev.M2 + delta * (sample - next.mean);
+	} while (!perf_atomic_cas(&moments->bits, &prev.bits, next.bits));
+}
+
+/**
+ * Lower *least to value, a *least of 0 is not set yet.
+ */
+static void
+perf_least_update(uint64_t *least, uint64_t value)
+{
+	uint64_t prev = *least;
+
+	while ((prev == 0 || prev > value) && !perf_atomic_cas(least, &prev, value)) {
+	}
+}
+
+static void
+perf_most_update(uint64_t *most, uint64_t value)
+{
+	uint64_t prev = *most;
+
+	while (prev < value && !perf_atomic_cas(most, &prev, value)) {
+	}
+}
+
+static unsigned
+perf_histogram_bucket(uint64_t value)
+{
+	unsigned bucket = 0;
+
+	while (value != 0 && bucket < PERF_HISTOGRAM_BUCKETS - 1) {
+		value >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+/**
+ * Estimate the value below which the given fraction of the events fall,
+ * interpolating within the bucket.
+ */
+static uint64_t
+perf_histogram_percentile(struct perf_ctr_histogram *pch, float fraction)
+{
+	uint32_t counts[PERF_HISTOGRAM_BUCKETS];
+	uint64_t total = 0;
+
+	for (unsigned i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+		counts[i] = pch->bucket_count[i];
+		total += counts[i];
+	}
+
+	if (total == 0) {
+		return 0;
+	}
+
+	float rank = fraction * total;
+	uint64_t below = 0;
+
+	for (unsigned i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+		if (below + counts[i] >= rank && counts[i] != 0) {
+			uint64_t lower = (i == 0) ? 0 : (1ULL << (i - 1));
+			uint64_t upper = (i == 0) ? 0 : (1ULL << i);
+			uint64_t value = lower + (uint64_t)((upper - lower) * ((rank - below) / counts[i]));
+
+			/* the last bucket is open, and nothing is above the worst case */
+			if (i == PERF_HISTOGRAM_BUCKETS - 1 || value > pch->elapsed.time_most) {
+				value = pch->elapsed.time_most;
+			}
+
+			return value;
+		}
+
+		below += counts[i];
+	}
+
+	return pch->elapsed.time_most;
+}
 
 perf_counter_t
 perf_alloc(enum perf_counter_type type, const char *name)
@@ -121,14 +285,27 @@ perf_alloc(enum perf_counter_type type, const char *name)
 
 		break;
 
+	case PC_LATENCY:
+		/* one extra bucket for everything beyond the last bound */
+		ctr = (perf_counter_t)calloc(sizeof(struct perf_ctr_latency) + (PERF_LATENCY_BUCKET_COUNT + 1) * sizeof(uint32_t), 1);
+		break;
+
+	case PC_HISTOGRAM:
+		ctr = (perf_counter_t)calloc(sizeof(struct perf_ctr_histogram), 1);
+		break;
+
 	default:
 		break;
 	}
 
 	if (ctr != NULL) {
+		unsigned hash = perf_name_hash(name);
+
 		ctr->type = type;
 		ctr->name = name;
 		sq_addfirst(&ctr->link, &perf_counters);
+		ctr->hash_next = perf_hash[hash];
+		perf_hash[hash] = ctr;
 	}
 
 	return ctr;
@@ -137,7 +314,7 @@ perf_alloc(enum perf_counter_type type, const char *name)
 perf_counter_t
 perf_alloc_once(enum perf_counter_type type, const char *name)
 {
-	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+	perf_counter_t handle = perf_hash[perf_name_hash(name)];
 
 	while (handle != NULL) {
 		if (!strcmp(handle->name, name)) {
@@ -151,7 +328,7 @@ perf_alloc_once(enum perf_counter_type type, const char *name)
 			}
 		}
 
-		handle = (perf_counter_t)sq_next(&handle->link);
+		handle = handle->hash_next;
 	}
 
 	/* if the execution reaches here, no existing counter of that name was found */
@@ -165,6 +342,16 @@ perf_free(perf_counter_t handle)
 		return;
 	}
 
+	perf_counter_t *prev = &perf_hash[perf_name_hash(handle->name)];
+
+	while (*prev != NULL && *prev != handle) {
+		prev = &(*prev)->hash_next;
+	}
+
+	if (*prev == handle) {
+		*prev = handle->hash_next;
+	}
+
 	sq_rem(&handle->link, &perf_counters);
 	free(handle);
 }
@@ -178,48 +365,28 @@ perf_count(perf_counter_t handle)
 
 	switch (handle->type) {
 	case PC_COUNT:
-		((struct perf_ctr_count *)handle)->event_count++;
+		perf_atomic_add(&((struct perf_ctr_count *)handle)->event_count, 1);
 		break;
 
 	case PC_INTERVAL: {
 			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
 			hrt_abstime now = hrt_absolute_time();
+			hrt_abstime last = perf_atomic_exchange(&pci->time_last, now);
+			uint64_t count = perf_atomic_add(&pci->event_count, 1);
 
-			switch (pci->event_count) {
-			case 0:
+			if (count == 1) {
 				pci->time_first = now;
-				break;
-
-			case 1:
-				pci->time_least = now - pci->time_last;
-				pci->time_most = now - pci->time_last;
-				pci->mean = pci->time_least / 1e6f;
-				pci->M2 = 0;
-				break;
 
-			default: {
-					hrt_abstime interval = now - pci->time_last;
-
-					if (interval < pci->time_least) {
-						pci->time_least = interval;
-					}
+			} else {
+				hrt_abstime interval = now - last;
 
-					if (interval > pci->time_most) {
-						pci->time_most = interval;
-					}
+				perf_least_update(&pci->time_least, interval);
+				perf_most_update(&pci->time_most, interval);
 
-					// maintain mean and variance of interval in seconds
-					// Knuth/Welford recursive mean and variance of update intervals (via Wikipedia)
-					float dt = interval / 1e6f;
-					float delta_intvl = dt - pci->mean;
-					pci->mean += delta_intvl / pci->event_count;
-					pci->M2 += delta_intvl * (dt - pci->mean);
-					break;
-				}
+				// maintain mean and variance of interval in seconds
+				perf_moments_update(&pci->moments, interval / 1e6f, count - 1);
 			}
 
-			pci->time_last = now;
-			pci->event_count++;
 			break;
 		}
 
@@ -237,6 +404,8 @@ perf_begin(perf_counter_t handle)
 
 	switch (handle->type) {
 	case PC_ELAPSED:
+	case PC_LATENCY:
+	case PC_HISTOGRAM:
 		((struct perf_ctr_elapsed *)handle)->time_start = hrt_absolute_time();
 		break;
 
@@ -253,37 +422,14 @@ perf_end(perf_counter_t handle)
 	}
 
 	switch (handle->type) {
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_LATENCY:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
+			uint64_t time_start = perf_atomic_exchange(&pce->time_start, 0);
 
-			if (pce->time_start != 0) {
-				int64_t elapsed = hrt_absolute_time() - pce->time_start;
-
-				if (elapsed < 0) {
-					pce->event_overruns++;
-
-				} else {
-
-					pce->event_count++;
-					pce->time_total += elapsed;
-
-					if ((pce->time_least > (uint64_t)elapsed) || (pce->time_least == 0)) {
-						pce->time_least = elapsed;
-					}
-
-					if (pce->time_most < (uint64_t)elapsed) {
-						pce->time_most = elapsed;
-					}
-
-					// maintain mean and variance of the elapsed time in seconds
-					// Knuth/Welford recursive mean and variance of update intervals (via Wikipedia)
-					float dt = elapsed / 1e6f;
-					float delta_intvl = dt - pce->mean;
-					pce->mean += delta_intvl / pce->event_count;
-					pce->M2 += delta_intvl * (dt - pce->mean);
-
-					pce->time_start = 0;
-				}
+			if (time_start != 0) {
+				perf_set(handle, hrt_absolute_time() - time_start);
 			}
 		}
 		break;
@@ -303,34 +449,40 @@ perf_set(perf_counter_t handle, int64_t elapsed)
 	}
 
 	switch (handle->type) {
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_LATENCY:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 
 			if (elapsed < 0) {
-				pce->event_overruns++;
-
-			} else {
+				perf_atomic_add(&pce->event_overruns, 1);
+				break;
+			}
 
-				pce->event_count++;
-				pce->time_total += elapsed;
+			if (handle->type == PC_LATENCY) {
+				struct perf_ctr_latency *pcl = (struct perf_ctr_latency *)handle;
+				unsigned bucket = 0;
 
-				if ((pce->time_least > (uint64_t)elapsed) || (pce->time_least == 0)) {
-					pce->time_least = elapsed;
+				while (bucket < PERF_LATENCY_BUCKET_COUNT && elapsed > perf_latency_buckets[bucket]) {
+					bucket++;
 				}
 
-				if (pce->time_most < (uint64_t)elapsed) {
-					pce->time_most = elapsed;
-				}
+				perf_atomic_add(&pcl->bucket_count[bucket], 1);
 
-				// maintain mean and variance of the elapsed time in seconds
-				// Knuth/Welford recursive mean and variance of update intervals (via Wikipedia)
-				float dt = elapsed / 1e6f;
-				float delta_intvl = dt - pce->mean;
-				pce->mean += delta_intvl / pce->event_count;
-				pce->M2 += delta_intvl * (dt - pce->mean);
+			} else if (handle->type == PC_HISTOGRAM) {
+				struct perf_ctr_histogram *pch = (struct perf_ctr_histogram *)handle;
 
-				pce->time_start = 0;
+				perf_atomic_add(&pch->bucket_count[perf_histogram_bucket(elapsed)], 1);
 			}
+
+			uint64_t count = perf_atomic_add(&pce->event_count, 1);
+
+			perf_atomic_add(&pce->time_total, elapsed);
+			perf_least_update(&pce->time_least, elapsed);
+			perf_most_update(&pce->time_most, elapsed);
+
+			// maintain mean and variance of the elapsed time in seconds
+			perf_moments_update(&pce->moments, elapsed / 1e6f, count);
 		}
 		break;
 
@@ -347,7 +499,9 @@ perf_cancel(perf_counter_t handle)
 	}
 
 	switch (handle->type) {
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_LATENCY:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 
 			pce->time_start = 0;
@@ -359,8 +513,6 @@ perf_cancel(perf_counter_t handle)
 	}
 }
 
-
-
 void
 perf_reset(perf_counter_t handle)
 {
@@ -373,13 +525,26 @@ perf_reset(perf_counter_t handle)
 		((struct perf_ctr_count *)handle)->event_count = 0;
 		break;
 
-	case PC_ELAPSED: {
+	case PC_LATENCY:
+		memset(((struct perf_ctr_latency *)handle)->bucket_count, 0, (PERF_LATENCY_BUCKET_COUNT + 1) * sizeof(uint32_t));
+
+	/* FALLTHROUGH */
+	case PC_ELAPSED:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 			pce->event_count = 0;
 			pce->time_start = 0;
 			pce->time_total = 0;
 			pce->time_least = 0;
 			pce->time_most = 0;
+			pce->moments.bits = 0;
+			pce->events_reported = 0;
+			pce->time_reported = 0;
+
+			if (handle->type == PC_HISTOGRAM) {
+				memset(((struct perf_ctr_histogram *)handle)->bucket_count, 0, sizeof(uint32_t) * PERF_HISTOGRAM_BUCKETS);
+			}
+
 			break;
 		}
 
@@ -391,8 +556,12 @@ perf_reset(perf_counter_t handle)
 			pci->time_last = 0;
 			pci->time_least = 0;
 			pci->time_most = 0;
+			pci->moments.bits = 0;
 			break;
 		}
+
+	default:
+		break;
 	}
 }
 
@@ -416,9 +585,11 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 			(unsigned long long)((struct perf_ctr_count *)handle)->event_count);
 		break;
 
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_LATENCY:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
-			float rms = sqrtf(pce->M2 / (pce->event_count - 1));
+			float rms = sqrtf(pce->moments.M2 / (pce->event_count - 1));
 			dprintf(fd, "%s: %llu events, %llu overruns, %lluus elapsed, %lluus avg, min %lluus max %lluus %5.3fus rms\n",
 				handle->name,
 				(unsigned long long)pce->event_count,
@@ -428,12 +599,23 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 				(unsigned long long)pce->time_least,
 				(unsigned long long)pce->time_most,
 				(double)(1e6f * rms));
+
+			if (handle->type == PC_HISTOGRAM) {
+				struct perf_ctr_histogram *pch = (struct perf_ctr_histogram *)handle;
+
+				dprintf(fd, "%s: p50 %lluus p99 %lluus p99.9 %lluus\n",
+					handle->name,
+					(unsigned long long)perf_histogram_percentile(pch, 0.5f),
+					(unsigned long long)perf_histogram_percentile(pch, 0.99f),
+					(unsigned long long)perf_histogram_percentile(pch, 0.999f));
+			}
+
 			break;
 		}
 
 	case PC_INTERVAL: {
 			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
-			float rms = sqrtf(pci->M2 / (pci->event_count - 1));
+			float rms = sqrtf(pci->moments.M2 / (pci->event_count - 1));
 
 			dprintf(fd, "%s: %llu events, %lluus avg, min %lluus max %lluus %5.3fus rms\n",
 				handle->name,
@@ -461,7 +643,9 @@ perf_event_count(perf_counter_t handle)
 	case PC_COUNT:
 		return ((struct perf_ctr_count *)handle)->event_count;
 
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_LATENCY:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 			return pce->event_count;
 		}
@@ -478,6 +662,72 @@ perf_event_count(perf_counter_t handle)
 	return 0;
 }
 
+int
+perf_histogram_report(unsigned index, struct perf_histogram_report_s *report)
+{
+	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+
+	while (handle != NULL) {
+		if (handle->type == PC_HISTOGRAM && index-- == 0) {
+			struct perf_ctr_histogram *pch = (struct perf_ctr_histogram *)handle;
+
+			report->name = handle->name;
+			report->event_count = pch->elapsed.event_count;
+			report->p50 = perf_histogram_percentile(pch, 0.5f);
+			report->p99 = perf_histogram_percentile(pch, 0.99f);
+			report->p999 = perf_histogram_percentile(pch, 0.999f);
+			report->max = pch->elapsed.time_most;
+			memcpy(report->bucket_count, pch->bucket_count, sizeof(report->bucket_count));
+			return 0;
+		}
+
+		handle = (perf_counter_t)sq_next(&handle->link);
+	}
+
+	return -1;
+}
+
+unsigned
+perf_top_elapsed(struct perf_top_s *top, unsigned max)
+{
+	unsigned count = 0;
+	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+
+	while (handle != NULL) {
+		if (handle->type == PC_ELAPSED || handle->type == PC_LATENCY || handle->type == PC_HISTOGRAM) {
+			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
+			struct perf_top_s entry;
+			uint64_t events = pce->event_count;
+			uint64_t total = pce->time_total;
+
+			entry.name = handle->name;
+			entry.event_count = events - pce->events_reported;
+			entry.elapsed = total - pce->time_reported;
+			pce->events_reported = events;
+			pce->time_reported = total;
+
+			/* insert sorted, dropping the entry that took the least time if full */
+			unsigned i = (count < max) ? count++ : max;
+
+			while (i > 0 && top[i - 1].elapsed < entry.elapsed) {
+				if (i < max) {
+					top[i] = top[i - 1];
+				}
+
+				i--;
+			}
+
+			if (i < max) {
+				top[i] = entry;
+			}
+		}
+
+		handle = (perf_counter_t)sq_next(&handle->link);
+	}
+
+	return count;
+}
+
 void
 perf_print_all(int fd)
 {
@@ -504,6 +754,45 @@ perf_print_latency(int fd)
 
 	// print the overflow bucket value
 	dprintf(fd, " >%4i : %i\n", latency_buckets[latency_bucket_count - 1], latency_counters[latency_bucket_count]);
+
+	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+
+	while (handle != NULL) {
+		if (handle->type == PC_LATENCY) {
+			struct perf_ctr_latency *pcl = (struct perf_ctr_latency *)handle;
+
+			dprintf(fd, "\n%s\nbucket : events\n", handle->name);
+
+			for (unsigned i = 0; i < PERF_LATENCY_BUCKET_COUNT; i++) {
+				dprintf(fd, " %5u : %lu\n", perf_latency_buckets[i], (unsigned long)pcl->bucket_count[i]);
+			}
+
+			dprintf(fd, ">%5u : %lu\n", perf_latency_buckets[PERF_LATENCY_BUCKET_COUNT - 1],
+				(unsigned long)pcl->bucket_count[PERF_LATENCY_BUCKET_COUNT]);
+
+		} else if (handle->type == PC_HISTOGRAM) {
+			struct perf_ctr_histogram *pch = (struct perf_ctr_histogram *)handle;
+
+			dprintf(fd, "\n%s\nbucket : events\n", handle->name);
+
+			/* bucket i ends at 2^i us, empty ones are left out */
+			for (unsigned i = 0; i < PERF_HISTOGRAM_BUCKETS - 1; i++) {
+				if (pch->bucket_count[i] != 0) {
+					dprintf(fd, " <%7lu : %lu\n", (i == 0) ? 1UL : 1UL << i, (unsigned long)pch->bucket_count[i]);
+				}
+			}
+
+			dprintf(fd, ">=%7lu : %lu\n", 1UL << (PERF_HISTOGRAM_BUCKETS - 2),
+				(unsigned long)pch->bucket_count[PERF_HISTOGRAM_BUCKETS - 1]);
+
+			dprintf(fd, "p50 %lluus p99 %lluus p99.9 %lluus\n",
+				(unsigned long long)perf_histogram_percentile(pch, 0.5f),
+				(unsigned long long)perf_histogram_percentile(pch, 0.99f),
+				(unsigned long long)perf_histogram_percentile(pch, 0.999f));
+		}
+
+		handle = (perf_counter_t)sq_next(&handle->link);
+	}
 }
 
 void
@@ -48,7 +48,36 @@
 enum perf_counter_type {
 	PC_COUNT,		/**< count the number of times an event occurs */
 	PC_ELAPSED,		/**< measure the time elapsed performing an event */
-	PC_INTERVAL		/**< measure the interval between instances of an event */
+	PC_INTERVAL,		/**< measure the interval between instances of an event */
+	PC_LATENCY,		/**< like PC_ELAPSED, plus a histogram for perf latency */
+	PC_HISTOGRAM		/**< like PC_ELAPSED, plus a log2 histogram for percentiles */
+};
+
+/**
+ * Number of PC_HISTOGRAM buckets, the last one holds everything from 2^(PERF_HISTOGRAM_BUCKETS - 2) us.
+ */
+#define PERF_HISTOGRAM_BUCKETS	24
+
+/**
+ * Summary of a PC_HISTOGRAM counter, see perf_histogram_report().
+ */
+struct perf_histogram_report_s {
+	const char	*name;
+	uint64_t	event_count;
+	uint64_t	p50;		/**< median in us */
+	uint64_t	p99;		/**< 99th percentile in us */
+	uint64_t	p999;		/**< 99.9th percentile in us */
+	uint64_t	max;		/**< worst case in us */
+	uint32_t	bucket_count[PERF_HISTOGRAM_BUCKETS];
+};
+
+/**
+ * Time spent in a counter, see perf_top_elapsed().
+ */
+struct perf_top_s {
+	const char	*name;
+	uint64_t	event_count;	/**< events since the previous perf_top_elapsed() */
+	uint64_t	elapsed;	/**< time in us spent since the previous perf_top_elapsed() */
 };
 
 struct perf_ctr_header;
@@ -166,12 +195,32 @@ __EXPORT extern void		perf_print_counter_fd(int fd, perf_counter_t handle);
 __EXPORT extern void		perf_print_all(int fd);
 
 /**
- * Print hrt latency counters.
+ * Print hrt latency counters and the histograms of all PC_LATENCY and PC_HISTOGRAM counters.
  *
  * @param fd			File descriptor to print to - e.g. 0 for stdout
  */
 __EXPORT extern void		perf_print_latency(int fd);
 
+/**
+ * Summarise a PC_HISTOGRAM counter.
+ *
+ * @param index			Index of the counter among all PC_HISTOGRAM counters.
+ * @param report		The summary, valid if 0 is returned.
+ * @return			0 on success, -1 if there are not that many PC_HISTOGRAM counters.
+ */
+__EXPORT extern int		perf_histogram_report(unsigned index, struct perf_histogram_report_s *report);
+
+/**
+ * Find the PC_ELAPSED, PC_LATENCY and PC_HISTOGRAM counters that spent the most time since the previous call.
+ *
+ * Meant for a single caller that reports periodically, such as load_mon.
+ *
+ * @param top			Filled with the counters, the one that took the most time first.
+ * @param max			Length of top.
+ * @return			Number of entries filled in.
+ */
+__EXPORT extern unsigned	perf_top_elapsed(struct perf_top_s *top, unsigned max);
+
 /**
  * Reset all of the performance counters.
  */
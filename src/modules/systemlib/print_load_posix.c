@@ -72,3 +72,7 @@ void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 {
 }
 
+
+void print_stack_usage(int fd)
+{
+}
@@ -50,6 +50,15 @@ extern struct system_load_s system_load;
 
 #define CL "\033[K" // clear line
 
+#ifdef CONFIG_STM32_CCMDATARAM
+/* the core coupled memory of the STM32F4, only reachable by the CPU */
+#define CCM_BASE	0x10000000
+#define CCM_SIZE	(64 * 1024)
+#endif
+
+/* a stack with less than this fraction of it left untouched is flagged */
+#define STACK_WARN_FREE_DIV	8
+
 void init_print_load_s(uint64_t t, struct print_load_s *s)
 {
 
@@ -113,6 +122,80 @@ tstate_name(const tstate_t s)
 	}
 }
 
+/**
+ * Return the size of a task stack and the bytes never touched, which NuttX
+ * fills with 0xff on creation.
+ */
+static unsigned
+stack_usage(FAR struct tcb_s *tcb, unsigned *stack_free)
+{
+	unsigned stack_size = (uintptr_t)tcb->adj_stack_ptr - (uintptr_t)tcb->stack_alloc_ptr;
+	uint8_t *stack_sweeper = (uint8_t *)tcb->stack_alloc_ptr;
+
+	*stack_free = 0;
+
+	while (*stack_free < stack_size) {
+		if (*stack_sweeper++ != 0xff) {
+			break;
+		}
+
+		(*stack_free)++;
+	}
+
+	return stack_size;
+}
+
+void print_stack_usage(int fd)
+{
+	unsigned total_size = 0;
+	unsigned total_used = 0;
+	unsigned ccm_size = 0;
+
+	dprintf(fd, "%4s %*-s %6s %6s %6s %5s %-4s\n",
+		"PID",
+		CONFIG_TASK_NAME_SIZE, "COMMAND",
+		"STACK",
+		"USED",
+		"FREE",
+		"USED%",
+		"MEM");
+
+	for (int i = 0; i < CONFIG_MAX_TASKS; i++) {
+		if (!system_load.tasks[i].valid) {
+			continue;
+		}
+
+		FAR struct tcb_s *tcb = system_load.tasks[i].tcb;
+		unsigned stack_free;
+		unsigned stack_size = stack_usage(tcb, &stack_free);
+		const char *mem = "sram";
+
+#ifdef CCM_BASE
+
+		if ((uintptr_t)tcb->stack_alloc_ptr >= CCM_BASE && (uintptr_t)tcb->stack_alloc_ptr < CCM_BASE + CCM_SIZE) {
+			mem = "ccm";
+			ccm_size += stack_size;
+		}
+
+#endif
+
+		dprintf(fd, "%4d %*-s %6u %6u %6u %4u%% %-4s%s\n",
+			tcb->pid,
+			CONFIG_TASK_NAME_SIZE, tcb->name,
+			stack_size,
+			stack_size - stack_free,
+			stack_free,
+			(stack_size > 0) ? (100 * (stack_size - stack_free)) / stack_size : 0,
+			mem,
+			(stack_free < stack_size / STACK_WARN_FREE_DIV) ? " LOW" : "");
+
+		total_size += stack_size;
+		total_used += stack_size - stack_free;
+	}
+
+	dprintf(fd, "Stacks: %u bytes allocated, %u used, %u in CCM\n", total_size, total_used, ccm_size);
+}
+
 void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 {
 	print_state->new_time = t;
@@ -238,18 +321,8 @@ void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 				       );
 			}
 
-			unsigned stack_size = (uintptr_t)system_load.tasks[i].tcb->adj_stack_ptr -
-					      (uintptr_t)system_load.tasks[i].tcb->stack_alloc_ptr;
-			unsigned stack_free = 0;
-			uint8_t *stack_sweeper = (uint8_t *)system_load.tasks[i].tcb->stack_alloc_ptr;
-
-			while (stack_free < stack_size) {
-				if (*stack_sweeper++ != 0xff) {
-					break;
-				}
-
-				stack_free++;
-			}
+			unsigned stack_free;
+			unsigned stack_size = stack_usage(system_load.tasks[i].tcb, &stack_free);
 
 			dprintf(fd, "%s%4d %*-s %8lld %2d.%03d %5u/%5u %3u (%3u) ",
 				clear_line,
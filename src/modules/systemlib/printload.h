@@ -67,4 +67,9 @@ __EXPORT void init_print_load_s(uint64_t t, struct print_load_s *s);
 
 __EXPORT void print_load(uint64_t t, int fd, struct print_load_s *print_state);
 
+/**
+ * Print the size and high-water mark of every task stack.
+ */
+__EXPORT void print_stack_usage(int fd);
+
 __END_DECLS
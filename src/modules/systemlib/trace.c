@@ -0,0 +1,287 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file trace.c
+ *
+ * Trace event ring buffer, see trace.h.
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+
+#include "trace.h"
+
+#ifdef CONFIG_TRACE
+
+#ifdef __PX4_NUTTX
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+#else
+#include <pthread.h>
+
+const char *getprogname(void);
+#endif
+
+#define TRACE_NAME_NONE		0xffff
+
+static struct trace_event_s	trace_events[CONFIG_TRACE_EVENTS];
+static struct trace_name_s	trace_names[TRACE_NAMES];	/**< open addressing by key, key 0 is free */
+static uint32_t			trace_next;			/**< events recorded since the start */
+static volatile bool		trace_running;
+
+#ifdef __PX4_NUTTX
+
+/* name of the interrupt context, where the HRT callouts run */
+static const char		trace_irq_name[] = "irq";
+
+/* the whole event is recorded with interrupts disabled, the scheduler hook runs that way anyway */
+#define trace_lock()			irqstate_t _trace_flags = irqsave()
+#define trace_unlock()			irqrestore(_trace_flags)
+#define trace_claim_slot(next)		((*(next))++)
+#define trace_claim_key(ptr, old, val)	(*(ptr) = (val), true)
+
+#else
+
+#define trace_lock()
+#define trace_unlock()
+#define trace_claim_slot(next)		__atomic_fetch_add((next), 1, __ATOMIC_RELAXED)
+#define trace_claim_key(ptr, old, val)	__atomic_compare_exchange_n((ptr), (old), (val), false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+
+#endif
+
+/**
+ * Find the name table index of key, adding it the first time it is seen.
+ *
+ * A NULL name with task set stores the name of the calling task.
+ */
+static uint16_t
+trace_intern(const void *key, const char *name, bool task)
+{
+	uint64_t k = (uintptr_t)key;
+	unsigned i = (unsigned)((k >> 3) ^ (k >> 11)) & (TRACE_NAMES - 1);
+
+	for (unsigned n = 0; n < TRACE_NAMES; n++, i = (i + 1) & (TRACE_NAMES - 1)) {
+		uint64_t current = trace_names[i].key;
+
+		if (current == k) {
+			return i;
+		}
+
+		if (current == 0) {
+			if (trace_claim_key(&trace_names[i].key, &current, k)) {
+				if (name == NULL && task) {
+#ifdef __PX4_NUTTX
+					name = up_interrupt_context() ? trace_irq_name : sched_self()->name;
+#else
+					name = getprogname();
+#endif
+				}
+
+				if (name != NULL) {
+					strncpy(trace_names[i].name, name, TRACE_NAME_LEN - 1);
+				}
+
+				return i;
+			}
+
+			/* another task claimed the entry first */
+			if (current == k) {
+				return i;
+			}
+		}
+	}
+
+	return TRACE_NAME_NONE;
+}
+
+static uint16_t
+trace_current_task(void)
+{
+#ifdef __PX4_NUTTX
+
+	if (up_interrupt_context()) {
+		return trace_intern(trace_irq_name, trace_irq_name, false);
+	}
+
+	return trace_intern(sched_self(), NULL, true);
+#else
+	return trace_intern((const void *)pthread_self(), NULL, true);
+#endif
+}
+
+static void
+trace_record(enum trace_type type, uint16_t task, uint16_t name)
+{
+	struct trace_event_s *event = &trace_events[trace_claim_slot(&trace_next) % CONFIG_TRACE_EVENTS];
+
+	event->time = hrt_absolute_time();
+	event->task = task;
+	event->name = name;
+	event->type = type;
+}
+
+void
+trace_event(enum trace_type type, const void *key, const char *name)
+{
+	if (!trace_running) {
+		return;
+	}
+
+	trace_lock();
+	trace_record(type, trace_current_task(), trace_intern(key, name, false));
+	trace_unlock();
+}
+
+void
+trace_switch(const void *key, const char *name)
+{
+	if (!trace_running) {
+		return;
+	}
+
+	trace_lock();
+	trace_record(TRACE_SWITCH, trace_intern(key, name, false), TRACE_NAME_NONE);
+	trace_unlock();
+}
+
+int
+trace_enable(bool enable)
+{
+	if (enable && !trace_running) {
+		memset(trace_names, 0, sizeof(trace_names));
+		trace_next = 0;
+	}
+
+	trace_running = enable;
+	return 0;
+}
+
+bool
+trace_enabled(void)
+{
+	return trace_running;
+}
+
+static int
+trace_write(int fd, const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)buf;
+
+	while (len > 0) {
+		ssize_t ret = write(fd, p, len);
+
+		if (ret < 0) {
+			return -errno;
+		}
+
+		p += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+int
+trace_dump(int fd)
+{
+	uint32_t next = trace_next;
+	uint32_t count = (next < CONFIG_TRACE_EVENTS) ? next : CONFIG_TRACE_EVENTS;
+	uint32_t first = (next < CONFIG_TRACE_EVENTS) ? 0 : next % CONFIG_TRACE_EVENTS;
+
+	struct trace_header_s header;
+	header.magic = TRACE_MAGIC;
+	header.version = TRACE_VERSION;
+	header.event_size = sizeof(struct trace_event_s);
+	header.event_count = count;
+	header.name_count = TRACE_NAMES;
+
+	int ret = trace_write(fd, &header, sizeof(header));
+
+	if (ret == 0) {
+		ret = trace_write(fd, trace_names, sizeof(trace_names));
+	}
+
+	/* oldest events first, the ring may have wrapped */
+	if (ret == 0) {
+		ret = trace_write(fd, &trace_events[first], (count - first) * sizeof(struct trace_event_s));
+	}
+
+	if (ret == 0 && first > 0) {
+		ret = trace_write(fd, &trace_events[0], first * sizeof(struct trace_event_s));
+	}
+
+	return (ret < 0) ? ret : (int)count;
+}
+
+#else
+
+void
+trace_event(enum trace_type type, const void *key, const char *name)
+{
+}
+
+void
+trace_switch(const void *key, const char *name)
+{
+}
+
+int
+trace_enable(bool enable)
+{
+	return -ENOSYS;
+}
+
+bool
+trace_enabled(void)
+{
+	return false;
+}
+
+int
+trace_dump(int fd)
+{
+	return -ENOSYS;
+}
+
+#endif /* CONFIG_TRACE */
@@ -0,0 +1,173 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file trace.h
+ *
+ * Ring buffer of binary trace events: task switches, uORB publications,
+ * poll notifications and HRT callouts.
+ *
+ * Build with EXTRADEFINES=-DCONFIG_TRACE to record events, otherwise the
+ * TRACE_*() macros compile to nothing. Dump the buffer with the trace
+ * command and convert it with Tools/trace_to_chrome.py.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <px4_defines.h>
+
+/**
+ * Number of events in the ring buffer.
+ */
+#ifndef CONFIG_TRACE_EVENTS
+#ifdef __PX4_NUTTX
+#define CONFIG_TRACE_EVENTS	512
+#else
+#define CONFIG_TRACE_EVENTS	16384
+#endif
+#endif
+
+/**
+ * Number of task, topic and callout names, a power of two.
+ */
+#define TRACE_NAMES		128
+#define TRACE_NAME_LEN		16
+
+#define TRACE_MAGIC		0x54345850	/**< "PX4T" */
+#define TRACE_VERSION		1
+
+/**
+ * Event types.
+ */
+enum trace_type {
+	TRACE_SWITCH = 1,	/**< task starts running */
+	TRACE_PUBLISH,		/**< task publishes name */
+	TRACE_NOTIFY,		/**< task wakes a poller of name */
+	TRACE_CALLOUT_BEGIN,	/**< HRT callout name starts */
+	TRACE_CALLOUT_END	/**< HRT callout name returns */
+};
+
+/**
+ * Recorded event, task and name are indices into the name table.
+ */
+struct trace_event_s {
+	uint64_t	time;
+	uint16_t	task;
+	uint16_t	name;
+	uint8_t		type;
+	uint8_t		_padding[3];
+};
+
+/**
+ * Name table entry in a dump, a key without a name is shown as an address.
+ */
+struct trace_name_s {
+	uint64_t	key;
+	char		name[TRACE_NAME_LEN];
+};
+
+/**
+ * Header of a dump, followed by name_count names and event_count events
+ * in the order they were recorded.
+ */
+struct trace_header_s {
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	event_size;
+	uint32_t	event_count;
+	uint32_t	name_count;
+};
+
+__BEGIN_DECLS
+
+#ifdef CONFIG_TRACE
+
+#define TRACE_SWITCH_TO(key, name)	trace_switch((key), (name))
+#define TRACE_PUBLISH_TOPIC(meta)	trace_event(TRACE_PUBLISH, (meta), (meta)->o_name)
+#define TRACE_NOTIFY_TOPIC(meta)	trace_event(TRACE_NOTIFY, (meta), (meta)->o_name)
+#define TRACE_CALLOUT_BEGIN(callout)	trace_event(TRACE_CALLOUT_BEGIN, (const void *)(callout), NULL)
+#define TRACE_CALLOUT_END(callout)	trace_event(TRACE_CALLOUT_END, (const void *)(callout), NULL)
+
+#else
+
+#define TRACE_SWITCH_TO(key, name)
+#define TRACE_PUBLISH_TOPIC(meta)
+#define TRACE_NOTIFY_TOPIC(meta)
+#define TRACE_CALLOUT_BEGIN(callout)
+#define TRACE_CALLOUT_END(callout)
+
+#endif
+
+/**
+ * Record an event of the calling task, does nothing while stopped.
+ *
+ * @param type			The event type.
+ * @param key			Identifies the name, usually its address.
+ * @param name			The name stored the first time key is seen, may be NULL.
+ */
+__EXPORT extern void	trace_event(enum trace_type type, const void *key, const char *name);
+
+/**
+ * Record a task switch, for the scheduler.
+ *
+ * @param key			Identifies the task that starts running.
+ * @param name			Its name.
+ */
+__EXPORT extern void	trace_switch(const void *key, const char *name);
+
+/**
+ * Start or stop recording, starting clears the buffer.
+ *
+ * @return			0 on success, -ENOSYS if built without CONFIG_TRACE.
+ */
+__EXPORT extern int	trace_enable(bool enable);
+
+/**
+ * Check if recording is enabled.
+ */
+__EXPORT extern bool	trace_enabled(void);
+
+/**
+ * Write the buffer to a file, see struct trace_header_s.
+ *
+ * Stop recording first, events recorded during the dump may be torn.
+ *
+ * @param fd			File to write to.
+ * @return			Number of events written, or a negated errno.
+ */
+__EXPORT extern int	trace_dump(int fd);
+
+__END_DECLS
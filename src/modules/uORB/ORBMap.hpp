@@ -31,11 +31,13 @@
  *
  ****************************************************************************/
 
+
 #pragma once
 
 #include <string.h>
-#include <stdlib.h>
+#include <stdint.h>
 
+struct orb_metadata;
 
 namespace uORB
 {
@@ -43,104 +45,168 @@ class DeviceNode;
 class ORBMap;
 }
 
+/**
+ * Fixed-size map of the topic nodes.
+ *
+ * Nodes are indexed twice with open addressing: by node path (used by the
+ * remote / muorb paths) and by topic metadata and instance (used by
+ * orb_exists() and friends, which then skip building the path entirely).
+ * The storage is allocated once with the map, so inserting does not touch
+ * the heap.
+ *
+ * Entries are never removed, just like the nodes they point to. Lookups are
+ * lock-free and may run concurrently with one inserter (the DeviceMaster
+ * serializes inserts): an entry is completely written before its index is
+ * published.
+ */
 class uORB::ORBMap
 {
 public:
+#ifdef __PX4_NUTTX
+	static const unsigned max_entries = 128;
+#else
+	static const unsigned max_entries = 255;
+#endif
+
+	/* index tables are kept at most half full for short probe sequences, size must be a power of two */
+	static const unsigned index_size = (max_entries <= 128) ? 256 : 512;
+
 	struct Node {
-		struct Node *next;
 		const char *node_name;
+		const struct orb_metadata *meta;
+		int instance;
 		uORB::DeviceNode *node;
 	};
 
 	ORBMap() :
-		_top(nullptr),
-		_end(nullptr)
-	{ }
-	~ORBMap()
+		_count(0),
+		_overflow(false)
 	{
-		while (_top != nullptr) {
-			unlinkNext(_top);
-
-			if (_top->next == nullptr) {
-				free((void *)_top->node_name);
-				free(_top);
-				_top = nullptr;
-				_end = nullptr;
-			}
-		}
+		memset((void *)_by_name, 0, sizeof(_by_name));
+		memset((void *)_by_meta, 0, sizeof(_by_meta));
 	}
-	void insert(const char *node_name, uORB::DeviceNode *node)
+
+	/**
+	 * Add a node to the map.
+	 *
+	 * @param node_name	Path of the node. It is not copied, so it must stay
+	 *			valid as long as the map (the node's own device path).
+	 * @param meta		Topic metadata, or nullptr to index by path only.
+	 * @param instance	Topic instance.
+	 * @param node		The node.
+	 * @return		false if the map is full or the path is already present.
+	 */
+	bool insert(const char *node_name, const struct orb_metadata *meta, int instance, uORB::DeviceNode *node)
 	{
-		Node **p;
+		if (_count >= max_entries) {
+			_overflow = true;
+			return false;
+		}
 
-		if (_top == nullptr) {
-			p = &_top;
+		unsigned name_slot = hash_name(node_name);
 
-		} else {
-			p = &_end->next;
+		while (_by_name[name_slot] != 0) {
+			if (strcmp(_nodes[_by_name[name_slot] - 1].node_name, node_name) == 0) {
+				return false;
+			}
+
+			name_slot = (name_slot + 1) & (index_size - 1);
 		}
 
-		*p = (Node *)malloc(sizeof(Node));
+		Node *n = &_nodes[_count];
+		n->node_name = node_name;
+		n->meta = meta;
+		n->instance = instance;
+		n->node = node;
+		_count++;
+
+		/* the entry must be visible before any lookup can reach it */
+		__sync_synchronize();
 
-		if (_end) {
-			_end = _end->next;
+		_by_name[name_slot] = _count;
 
-		} else {
-			_end = _top;
+		if (meta != nullptr) {
+			unsigned meta_slot = hash_meta(meta, instance);
+
+			while (_by_meta[meta_slot] != 0) {
+				meta_slot = (meta_slot + 1) & (index_size - 1);
+			}
+
+			_by_meta[meta_slot] = _count;
 		}
 
-		_end->next = nullptr;
-		_end->node_name = strdup(node_name);
-		_end->node = node;
+		return true;
 	}
 
 	bool find(const char *node_name)
 	{
-		Node *p = _top;
+		return get(node_name) != nullptr;
+	}
 
-		while (p) {
-			if (strcmp(p->node_name, node_name) == 0) {
-				return true;
-			}
+	uORB::DeviceNode *get(const char *node_name)
+	{
+		for (unsigned slot = hash_name(node_name); _by_name[slot] != 0; slot = (slot + 1) & (index_size - 1)) {
+			const Node *n = &_nodes[_by_name[slot] - 1];
 
-			p = p->next;
+			if (strcmp(n->node_name, node_name) == 0) {
+				return n->node;
+			}
 		}
 
-		return false;
+		return nullptr;
 	}
 
-	uORB::DeviceNode *get(const char *node_name)
+	uORB::DeviceNode *get(const struct orb_metadata *meta, int instance)
 	{
-		Node *p = _top;
+		for (unsigned slot = hash_meta(meta, instance); _by_meta[slot] != 0; slot = (slot + 1) & (index_size - 1)) {
+			const Node *n = &_nodes[_by_meta[slot] - 1];
 
-		while (p) {
-			if (strcmp(p->node_name, node_name) == 0) {
-				return p->node;
+			if (n->meta == meta && n->instance == instance) {
+				return n->node;
 			}
-
-			p = p->next;
 		}
 
 		return nullptr;
 	}
 
-	void unlinkNext(Node *a)
-	{
-		Node *b = a->next;
+	/**
+	 * Number of entries, for iterating with entry(). Entries only ever get
+	 * appended, so the ones below a count taken once stay valid.
+	 */
+	unsigned size() const { return _count; }
 
-		if (b != nullptr) {
-			if (_end == b) {
-				_end = a;
-			}
+	const Node &entry(unsigned i) const { return _nodes[i]; }
 
-			a->next = b->next;
-			free((void *)b->node_name);
-			free(b);
+	/**
+	 * True once an insert was refused because the map is full. Until then a
+	 * failed lookup means the node really does not exist.
+	 */
+	bool overflow() const { return _overflow; }
+
+private:
+	static unsigned hash_name(const char *node_name)
+	{
+		/* FNV-1a */
+		uint32_t h = 2166136261u;
+
+		while (*node_name) {
+			h ^= (uint8_t)*node_name++;
+			h *= 16777619u;
 		}
+
+		return h & (index_size - 1);
 	}
 
-private:
-	Node *_top;
-	Node *_end;
-};
+	static unsigned hash_meta(const struct orb_metadata *meta, int instance)
+	{
+		uint32_t h = (uint32_t)((uintptr_t)meta >> 2) ^ ((uint32_t)instance * 0x9e3779b9u);
+		h *= 2654435761u;
+		return (h >> 16 ^ h) & (index_size - 1);
+	}
 
+	Node		_nodes[max_entries];
+	volatile uint8_t _by_name[index_size];	///< index into _nodes + 1, 0 if empty
+	volatile uint8_t _by_meta[index_size];
+	unsigned	_count;
+	bool		_overflow;
+};
@@ -91,6 +91,33 @@ public:
 		}
 	}
 
+	/**
+	 * Borrow the topic data without copying it.
+	 *
+	 * The returned pointer is only valid until release() is called.
+	 * @return read-only pointer to the topic data, nullptr if the
+	 * 	topic has not been published yet.
+	 */
+	const void *borrow() {
+		const void *data = nullptr;
+
+		if (orb_borrow(_meta, _handle, &data)) {
+			return nullptr;
+		}
+
+		return data;
+	}
+
+	/**
+	 * Return data obtained with borrow().
+	 *
+	 * @return true if the borrowed data stayed consistent, false if it
+	 * 	was overwritten meanwhile and must be discarded.
+	 */
+	bool release() {
+		return !orb_release(_meta, _handle);
+	}
+
 	/**
 	 * Deconstructor
 	 */
@@ -194,6 +221,15 @@ public:
 		SubscriptionBase::update(getDataVoidPtr());
 	}
 
+	/**
+	 * Borrow the topic data without copying it into the embedded struct.
+	 *
+	 * @see SubscriptionBase::borrow()
+	 */
+	const T *borrow() {
+		return (const T *)SubscriptionBase::borrow();
+	}
+
 	/*
 	 * XXX
 	 * This function gets the T struct, assuming
@@ -58,6 +58,8 @@ endif
 
 SRCS	+= 		  objects_common.cpp \
 			  uORBUtils.cpp \
+			  uORBMemPool.cpp \
+			  uORBDelta.cpp \
 			  uORB.cpp \
 			  uORBMain.cpp \
 			  Publication.cpp \
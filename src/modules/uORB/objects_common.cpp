@@ -46,220 +46,241 @@
 #include <drivers/drv_orb_dev.h>
 
 #include "topics/sensor_mag.h"
-ORB_DEFINE(sensor_mag, struct sensor_mag_s);
+ORB_DEFINE_FIELDS(sensor_mag, sensor_mag);
 
 #include "topics/sensor_accel.h"
-ORB_DEFINE(sensor_accel, struct sensor_accel_s);
+ORB_DEFINE_FIELDS(sensor_accel, sensor_accel);
 
 #include "topics/sensor_gyro.h"
-ORB_DEFINE(sensor_gyro, struct sensor_gyro_s);
+ORB_DEFINE_FIELDS(sensor_gyro, sensor_gyro);
 
 #include "topics/sensor_baro.h"
-ORB_DEFINE(sensor_baro, struct sensor_baro_s);
+ORB_DEFINE_FIELDS(sensor_baro, sensor_baro);
 
 #include "topics/output_pwm.h"
-ORB_DEFINE(output_pwm, struct output_pwm_s);
+ORB_DEFINE_FIELDS(output_pwm, output_pwm);
 
 #include "topics/input_rc.h"
-ORB_DEFINE(input_rc, struct input_rc_s);
+ORB_DEFINE_FIELDS(input_rc, input_rc);
 
 #include "topics/pwm_input.h"
-ORB_DEFINE(pwm_input, struct pwm_input_s);
+ORB_DEFINE_FIELDS(pwm_input, pwm_input);
 
 #include "topics/vehicle_attitude.h"
-ORB_DEFINE(vehicle_attitude, struct vehicle_attitude_s);
+ORB_DEFINE_FIELDS(vehicle_attitude, vehicle_attitude);
 
 #include "topics/sensor_combined.h"
-ORB_DEFINE(sensor_combined, struct sensor_combined_s);
+ORB_DEFINE_FIELDS(sensor_combined, sensor_combined);
 
 #include "topics/hil_sensor.h"
-ORB_DEFINE(hil_sensor, struct hil_sensor_s);
+ORB_DEFINE_FIELDS(hil_sensor, hil_sensor);
 
 #include "topics/vehicle_gps_position.h"
-ORB_DEFINE(vehicle_gps_position, struct vehicle_gps_position_s);
+ORB_DEFINE_FIELDS(vehicle_gps_position, vehicle_gps_position);
 
 #include "topics/vehicle_land_detected.h"
-ORB_DEFINE(vehicle_land_detected, struct vehicle_land_detected_s);
+ORB_DEFINE_FIELDS(vehicle_land_detected, vehicle_land_detected);
 
 #include "topics/satellite_info.h"
-ORB_DEFINE(satellite_info, struct satellite_info_s);
+ORB_DEFINE_FIELDS(satellite_info, satellite_info);
+
+#include "topics/gps_dump.h"
+ORB_DEFINE_FIELDS(gps_dump, gps_dump);
+
+#include "topics/log_stream.h"
+ORB_DEFINE_FIELDS(log_stream, log_stream);
 
 #include "topics/home_position.h"
-ORB_DEFINE(home_position, struct home_position_s);
+ORB_DEFINE_FIELDS(home_position, home_position);
 
 #include "topics/vehicle_status.h"
-ORB_DEFINE(vehicle_status, struct vehicle_status_s);
+ORB_DEFINE_FIELDS(vehicle_status, vehicle_status);
 
 #include "topics/vtol_vehicle_status.h"
-ORB_DEFINE(vtol_vehicle_status, struct vtol_vehicle_status_s);
+ORB_DEFINE_FIELDS(vtol_vehicle_status, vtol_vehicle_status);
 
 #include "topics/safety.h"
-ORB_DEFINE(safety, struct safety_s);
+ORB_DEFINE_FIELDS(safety, safety);
 
 #include "topics/battery_status.h"
-ORB_DEFINE(battery_status, struct battery_status_s);
+ORB_DEFINE_FIELDS(battery_status, battery_status);
 
 #include "topics/servorail_status.h"
-ORB_DEFINE(servorail_status, struct servorail_status_s);
+ORB_DEFINE_FIELDS(servorail_status, servorail_status);
 
 #include "topics/system_power.h"
-ORB_DEFINE(system_power, struct system_power_s);
+ORB_DEFINE_FIELDS(system_power, system_power);
 
 #include "topics/vehicle_global_position.h"
-ORB_DEFINE(vehicle_global_position, struct vehicle_global_position_s);
+ORB_DEFINE_FIELDS(vehicle_global_position, vehicle_global_position);
 
 #include "topics/vehicle_local_position.h"
-ORB_DEFINE(vehicle_local_position, struct vehicle_local_position_s);
+ORB_DEFINE_FIELDS(vehicle_local_position, vehicle_local_position);
 
 #include "topics/att_pos_mocap.h"
-ORB_DEFINE(att_pos_mocap, struct att_pos_mocap_s);
+ORB_DEFINE_FIELDS(att_pos_mocap, att_pos_mocap);
 
 #include "topics/vehicle_rates_setpoint.h"
-ORB_DEFINE(vehicle_rates_setpoint, struct vehicle_rates_setpoint_s);
+ORB_DEFINE_FIELDS(vehicle_rates_setpoint, vehicle_rates_setpoint);
 #include "topics/mc_virtual_rates_setpoint.h"
-ORB_DEFINE(mc_virtual_rates_setpoint, struct mc_virtual_rates_setpoint_s);
+ORB_DEFINE_FIELDS(mc_virtual_rates_setpoint, mc_virtual_rates_setpoint);
 #include "topics/fw_virtual_rates_setpoint.h"
-ORB_DEFINE(fw_virtual_rates_setpoint, struct fw_virtual_rates_setpoint_s);
+ORB_DEFINE_FIELDS(fw_virtual_rates_setpoint, fw_virtual_rates_setpoint);
 
 #include "topics/rc_channels.h"
-ORB_DEFINE(rc_channels, struct rc_channels_s);
+ORB_DEFINE_FIELDS(rc_channels, rc_channels);
 
 #include "topics/vehicle_command.h"
-ORB_DEFINE(vehicle_command, struct vehicle_command_s);
+ORB_DEFINE_FIELDS(vehicle_command, vehicle_command);
+
+#include "topics/vehicle_command_ack.h"
+ORB_DEFINE_FIELDS(vehicle_command_ack, vehicle_command_ack);
 
 #include "topics/vehicle_control_mode.h"
-ORB_DEFINE(vehicle_control_mode, struct vehicle_control_mode_s);
+ORB_DEFINE_FIELDS(vehicle_control_mode, vehicle_control_mode);
 
 #include "topics/vehicle_local_position_setpoint.h"
-ORB_DEFINE(vehicle_local_position_setpoint, struct vehicle_local_position_setpoint_s);
+ORB_DEFINE_FIELDS(vehicle_local_position_setpoint, vehicle_local_position_setpoint);
 
 #include "topics/position_setpoint_triplet.h"
-ORB_DEFINE(position_setpoint_triplet, struct position_setpoint_triplet_s);
+ORB_DEFINE_FIELDS(position_setpoint_triplet, position_setpoint_triplet);
 
 #include "topics/vehicle_global_velocity_setpoint.h"
-ORB_DEFINE(vehicle_global_velocity_setpoint, struct vehicle_global_velocity_setpoint_s);
+ORB_DEFINE_FIELDS(vehicle_global_velocity_setpoint, vehicle_global_velocity_setpoint);
 
 #include "topics/mission.h"
-ORB_DEFINE(mission, struct mission_s);
+ORB_DEFINE_FIELDS(mission, mission);
 // XXX onboard and offboard mission are still declared here until this is
 // generator supported
 #include <navigator/navigation.h>
-ORB_DEFINE(offboard_mission, struct mission_s);
-ORB_DEFINE(onboard_mission, struct mission_s);
+ORB_DEFINE_FIELDS(offboard_mission, mission);
+ORB_DEFINE_FIELDS(onboard_mission, mission);
 
 #include "topics/mission_result.h"
-ORB_DEFINE(mission_result, struct mission_result_s);
+ORB_DEFINE_FIELDS(mission_result, mission_result);
 
 #include "topics/geofence_result.h"
-ORB_DEFINE(geofence_result, struct geofence_result_s);
+ORB_DEFINE_FIELDS(geofence_result, geofence_result);
 
 #include "topics/fence.h"
-ORB_DEFINE(fence, struct fence_s);
+ORB_DEFINE_FIELDS(fence, fence);
 
 #include "topics/fence_vertex.h"
-ORB_DEFINE(fence_vertex, struct fence_vertex_s);
+ORB_DEFINE_FIELDS(fence_vertex, fence_vertex);
 
 #include "topics/vehicle_attitude_setpoint.h"
-ORB_DEFINE(vehicle_attitude_setpoint, struct vehicle_attitude_setpoint_s);
-ORB_DEFINE(mc_virtual_attitude_setpoint, struct vehicle_attitude_setpoint_s);
-ORB_DEFINE(fw_virtual_attitude_setpoint, struct vehicle_attitude_setpoint_s);
+ORB_DEFINE_FIELDS(vehicle_attitude_setpoint, vehicle_attitude_setpoint);
+ORB_DEFINE_FIELDS(mc_virtual_attitude_setpoint, vehicle_attitude_setpoint);
+ORB_DEFINE_FIELDS(fw_virtual_attitude_setpoint, vehicle_attitude_setpoint);
 
 #include "topics/manual_control_setpoint.h"
-ORB_DEFINE(manual_control_setpoint, struct manual_control_setpoint_s);
+ORB_DEFINE_FIELDS(manual_control_setpoint, manual_control_setpoint);
 
 #include "topics/offboard_control_mode.h"
-ORB_DEFINE(offboard_control_mode, struct offboard_control_mode_s);
+ORB_DEFINE_FIELDS(offboard_control_mode, offboard_control_mode);
 
 #include "topics/optical_flow.h"
-ORB_DEFINE(optical_flow, struct optical_flow_s);
+ORB_DEFINE_FIELDS(optical_flow, optical_flow);
 
 #include "topics/filtered_bottom_flow.h"
-ORB_DEFINE(filtered_bottom_flow, struct filtered_bottom_flow_s);
+ORB_DEFINE_FIELDS(filtered_bottom_flow, filtered_bottom_flow);
 
 #include "topics/airspeed.h"
-ORB_DEFINE(airspeed, struct airspeed_s);
+ORB_DEFINE_FIELDS(airspeed, airspeed);
 
 #include "topics/differential_pressure.h"
-ORB_DEFINE(differential_pressure, struct differential_pressure_s);
+ORB_DEFINE_FIELDS(differential_pressure, differential_pressure);
 
 #include "topics/subsystem_info.h"
-ORB_DEFINE(subsystem_info, struct subsystem_info_s);
+ORB_DEFINE_FIELDS(subsystem_info, subsystem_info);
 
 /* actuator controls, as requested by controller */
 #include "topics/actuator_controls.h"
 #include "topics/actuator_controls_0.h"
-ORB_DEFINE(actuator_controls_0, struct actuator_controls_0_s);
+ORB_DEFINE_FIELDS(actuator_controls_0, actuator_controls_0);
 #include "topics/actuator_controls_1.h"
-ORB_DEFINE(actuator_controls_1, struct actuator_controls_1_s);
+ORB_DEFINE_FIELDS(actuator_controls_1, actuator_controls_1);
 #include "topics/actuator_controls_2.h"
-ORB_DEFINE(actuator_controls_2, struct actuator_controls_2_s);
+ORB_DEFINE_FIELDS(actuator_controls_2, actuator_controls_2);
 #include "topics/actuator_controls_3.h"
-ORB_DEFINE(actuator_controls_3, struct actuator_controls_3_s);
+ORB_DEFINE_FIELDS(actuator_controls_3, actuator_controls_3);
 //Virtual control groups, used for VTOL operation
 #include "topics/actuator_controls_virtual_mc.h"
-ORB_DEFINE(actuator_controls_virtual_mc, struct actuator_controls_virtual_mc_s);
+ORB_DEFINE_FIELDS(actuator_controls_virtual_mc, actuator_controls_virtual_mc);
 #include "topics/actuator_controls_virtual_fw.h"
-ORB_DEFINE(actuator_controls_virtual_fw, struct actuator_controls_virtual_fw_s);
+ORB_DEFINE_FIELDS(actuator_controls_virtual_fw, actuator_controls_virtual_fw);
 
 #include "topics/actuator_armed.h"
-ORB_DEFINE(actuator_armed, struct actuator_armed_s);
+ORB_DEFINE_FIELDS(actuator_armed, actuator_armed);
 
 #include "topics/actuator_outputs.h"
-ORB_DEFINE(actuator_outputs, struct actuator_outputs_s);
+ORB_DEFINE_FIELDS(actuator_outputs, actuator_outputs);
 
 #include "topics/actuator_direct.h"
-ORB_DEFINE(actuator_direct, struct actuator_direct_s);
+ORB_DEFINE_FIELDS(actuator_direct, actuator_direct);
 
 #include "topics/multirotor_motor_limits.h"
-ORB_DEFINE(multirotor_motor_limits, struct multirotor_motor_limits_s);
+ORB_DEFINE_FIELDS(multirotor_motor_limits, multirotor_motor_limits);
 
 #include "topics/telemetry_status.h"
-ORB_DEFINE(telemetry_status, struct telemetry_status_s);
+ORB_DEFINE_FIELDS(telemetry_status, telemetry_status);
 
 #include "topics/test_motor.h"
-ORB_DEFINE(test_motor, struct test_motor_s);
+ORB_DEFINE_FIELDS(test_motor, test_motor);
 
 #include "topics/debug_key_value.h"
-ORB_DEFINE(debug_key_value, struct debug_key_value_s);
+ORB_DEFINE_FIELDS(debug_key_value, debug_key_value);
 
 #include "topics/navigation_capabilities.h"
-ORB_DEFINE(navigation_capabilities, struct navigation_capabilities_s);
+ORB_DEFINE_FIELDS(navigation_capabilities, navigation_capabilities);
 
 #include "topics/esc_status.h"
-ORB_DEFINE(esc_status, struct esc_status_s);
+ORB_DEFINE_FIELDS(esc_status, esc_status);
 
 #include "topics/esc_report.h"
-ORB_DEFINE(esc_report, struct esc_report_s);
+ORB_DEFINE_FIELDS(esc_report, esc_report);
 
 #include "topics/encoders.h"
-ORB_DEFINE(encoders, struct encoders_s);
+ORB_DEFINE_FIELDS(encoders, encoders);
 
 #include "topics/estimator_status.h"
-ORB_DEFINE(estimator_status, struct estimator_status_s);
+ORB_DEFINE_FIELDS(estimator_status, estimator_status);
 
 #include "topics/vision_position_estimate.h"
-ORB_DEFINE(vision_position_estimate, struct vision_position_estimate_s);
+ORB_DEFINE_FIELDS(vision_position_estimate, vision_position_estimate);
 
 #include "topics/vehicle_force_setpoint.h"
-ORB_DEFINE(vehicle_force_setpoint, struct vehicle_force_setpoint_s);
+ORB_DEFINE_FIELDS(vehicle_force_setpoint, vehicle_force_setpoint);
 
 #include "topics/tecs_status.h"
-ORB_DEFINE(tecs_status, struct tecs_status_s);
+ORB_DEFINE_FIELDS(tecs_status, tecs_status);
 
 #include "topics/wind_estimate.h"
-ORB_DEFINE(wind_estimate, struct wind_estimate_s);
+ORB_DEFINE_FIELDS(wind_estimate, wind_estimate);
 
 #include "topics/rc_parameter_map.h"
-ORB_DEFINE(rc_parameter_map, struct rc_parameter_map_s);
+ORB_DEFINE_FIELDS(rc_parameter_map, rc_parameter_map);
 
 #include "topics/time_offset.h"
-ORB_DEFINE(time_offset, struct time_offset_s);
+ORB_DEFINE_FIELDS(time_offset, time_offset);
 
 #include "topics/mc_att_ctrl_status.h"
-ORB_DEFINE(mc_att_ctrl_status, struct mc_att_ctrl_status_s);
+ORB_DEFINE_FIELDS(mc_att_ctrl_status, mc_att_ctrl_status);
 
 #include "topics/distance_sensor.h"
-ORB_DEFINE(distance_sensor, struct distance_sensor_s);
+ORB_DEFINE_FIELDS(distance_sensor, distance_sensor);
 
 #include "topics/camera_trigger.h"
-ORB_DEFINE(camera_trigger, struct camera_trigger_s);
+ORB_DEFINE_FIELDS(camera_trigger, camera_trigger);
+
+#include "topics/perf_histogram.h"
+ORB_DEFINE_FIELDS(perf_histogram, perf_histogram);
+
+#include "topics/cpuload.h"
+ORB_DEFINE_FIELDS(cpuload, cpuload);
+
+#include "topics/task_stats.h"
+ORB_DEFINE_FIELDS(task_stats, task_stats);
+
+#include "topics/perf_stats.h"
+ORB_DEFINE_FIELDS(perf_stats, perf_stats);
@@ -39,6 +39,7 @@
 #include "uORB.h"
 #include "uORBManager.hpp"
 #include "uORBCommon.hpp"
+#include <string.h>
 
 /**
  * Advertise as the publisher of a topic.
@@ -97,6 +98,45 @@ orb_advert_t orb_advertise_multi(const struct orb_metadata *meta, const void *da
 }
 
 
+/**
+ * Advertise as the publisher of a topic, with a queue of past samples.
+ *
+ * @see orb_advertise()
+ *
+ * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+ *      for the topic.
+ * @param data    A pointer to the initial data to be published.
+ * @param queue_size  Maximum number of buffered elements.
+ * @return    nullptr on error, otherwise returns a handle
+ *      that can be used to publish to the topic.
+ */
+orb_advert_t orb_advertise_queue(const struct orb_metadata *meta, const void *data, unsigned int queue_size)
+{
+	return uORB::Manager::get_instance()->orb_advertise(meta, data, queue_size);
+}
+
+/**
+ * Advertise as the publisher of a multi-instance topic, with a queue of past samples.
+ *
+ * @see orb_advertise_multi()
+ *
+ * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+ *      for the topic.
+ * @param data    A pointer to the initial data to be published.
+ * @param instance  Pointer to an integer which will yield the instance ID (0-based)
+ *      of the publication.
+ * @param priority  The priority of the instance.
+ * @param queue_size  Maximum number of buffered elements.
+ * @return    nullptr on error, otherwise returns a handle
+ *      that can be used to publish to the topic.
+ */
+orb_advert_t orb_advertise_multi_queue(const struct orb_metadata *meta, const void *data, int *instance,
+				       int priority, unsigned int queue_size)
+{
+	return uORB::Manager::get_instance()->orb_advertise_multi(meta, data, instance, priority, queue_size);
+}
+
+
 /**
  * Publish new data to a topic.
  *
@@ -212,6 +252,36 @@ int  orb_copy(const struct orb_metadata *meta, int handle, void *buffer)
 	return uORB::Manager::get_instance()->orb_copy(meta, handle, buffer);
 }
 
+/**
+ * Borrow the topic data without copying it.
+ *
+ * @see orb_copy()
+ *
+ * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+ *      for the topic.
+ * @param handle  A handle returned from orb_subscribe.
+ * @param buffer  Returns the pointer to the borrowed data.
+ * @return    OK on success, ERROR otherwise with errno set accordingly.
+ */
+int  orb_borrow(const struct orb_metadata *meta, int handle, const void **buffer)
+{
+	return uORB::Manager::get_instance()->orb_borrow(meta, handle, buffer);
+}
+
+/**
+ * Return data borrowed with orb_borrow().
+ *
+ * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+ *      for the topic.
+ * @param handle  A handle returned from orb_subscribe.
+ * @return    OK if the borrowed data stayed consistent, ERROR otherwise
+ *      with errno set accordingly.
+ */
+int  orb_release(const struct orb_metadata *meta, int handle)
+{
+	return uORB::Manager::get_instance()->orb_release(meta, handle);
+}
+
 /**
  * Check whether a topic has been published to since the last orb_copy.
  *
@@ -295,10 +365,11 @@ int  orb_priority(int handle, int32_t *priority)
  * If this interval is set, the subscriber will not see more than one update
  * within the period.
  *
- * Specifically, the first time an update is reported to the subscriber a timer
- * is started. The update will continue to be reported via poll and orb_check, but
- * once fetched via orb_copy another update will not be reported until the timer
- * expires.
+ * Specifically, after the subscriber has fetched an update via orb_copy, the
+ * next one is not reported via poll and orb_check until the interval has passed.
+ * A poll that is already waiting for an update held back this way returns when
+ * the interval expires. On a queued topic the subscriber gets the latest element and
+ * skips the older ones.
  *
  * This feature can be used to pace a subscriber that is watching a topic that
  * would otherwise update too quickly.
@@ -312,3 +383,118 @@ int  orb_set_interval(int handle, unsigned interval)
 	return uORB::Manager::get_instance()->orb_set_interval(handle, interval);
 }
 
+/**
+ * Queue work on a work queue each time the topic is published.
+ *
+ * @param handle  A handle returned from orb_subscribe.
+ * @param qid     The work queue, e.g. HPWORK or LPWORK.
+ * @param work    The work to queue.
+ * @param worker  Called on the work queue after publications.
+ * @param arg     Passed to worker.
+ * @return    OK on success, ERROR otherwise with errno set accordingly.
+ */
+int  orb_register_work_callback(int handle, int qid, struct work_s *work, void (*worker)(void *arg), void *arg)
+{
+	return uORB::Manager::get_instance()->orb_register_work_callback(handle, qid, work, worker, arg);
+}
+
+/**
+ * Stop queueing the work registered with orb_register_work_callback().
+ *
+ * @param handle  A handle returned from orb_subscribe.
+ * @return    OK on success, ERROR otherwise with errno set accordingly.
+ */
+int  orb_unregister_work_callback(int handle)
+{
+	return uORB::Manager::get_instance()->orb_unregister_work_callback(handle);
+}
+
+size_t orb_field_size(uint8_t type)
+{
+	switch (type) {
+	case ORB_FIELD_INT8:
+	case ORB_FIELD_UINT8:
+	case ORB_FIELD_BOOL:
+	case ORB_FIELD_CHAR:
+		return 1;
+
+	case ORB_FIELD_INT16:
+	case ORB_FIELD_UINT16:
+		return 2;
+
+	case ORB_FIELD_INT32:
+	case ORB_FIELD_UINT32:
+	case ORB_FIELD_FLOAT:
+		return 4;
+
+	case ORB_FIELD_INT64:
+	case ORB_FIELD_UINT64:
+	case ORB_FIELD_DOUBLE:
+		return 8;
+
+	default:
+		return 0;
+	}
+}
+
+size_t orb_packed_size(const struct orb_metadata *meta)
+{
+	if (meta->o_fields == nullptr) {
+		return meta->o_size;
+	}
+
+	size_t size = 0;
+
+	for (unsigned i = 0; i < meta->o_num_fields; i++) {
+		size += orb_field_size(meta->o_fields[i].type) * meta->o_fields[i].count;
+	}
+
+	return size;
+}
+
+/**
+ * Copy between a topic structure and its packed representation, one memcpy
+ * per run of fields that are contiguous in the structure.
+ */
+static size_t orb_copy_runs(const struct orb_metadata *meta, uint8_t *data, uint8_t *packed, bool pack)
+{
+	if (meta->o_fields == nullptr) {
+		memcpy(pack ? packed : data, pack ? data : packed, meta->o_size);
+		return meta->o_size;
+	}
+
+	size_t packed_offset = 0;
+	unsigned i = 0;
+
+	while (i < meta->o_num_fields) {
+		const size_t start = meta->o_fields[i].offset;
+		size_t end = start;
+
+		/* extend the run as long as the next field follows without padding */
+		while (i < meta->o_num_fields && meta->o_fields[i].offset == end) {
+			end += orb_field_size(meta->o_fields[i].type) * meta->o_fields[i].count;
+			i++;
+		}
+
+		if (pack) {
+			memcpy(packed + packed_offset, data + start, end - start);
+
+		} else {
+			memcpy(data + start, packed + packed_offset, end - start);
+		}
+
+		packed_offset += end - start;
+	}
+
+	return packed_offset;
+}
+
+size_t orb_pack(const struct orb_metadata *meta, const void *data, void *buffer)
+{
+	return orb_copy_runs(meta, (uint8_t *)data, (uint8_t *)buffer, true);
+}
+
+size_t orb_unpack(const struct orb_metadata *meta, const void *buffer, void *data)
+{
+	return orb_copy_runs(meta, (uint8_t *)data, (uint8_t *)buffer, false);
+}
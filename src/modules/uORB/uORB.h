@@ -40,18 +40,61 @@
  */
 
 #include <sys/types.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
 // Hack until everything is using this header
 #include <systemlib/visibility.h>
 
+/**
+ * Field types of the topic layout descriptors.
+ */
+enum orb_field_type {
+	ORB_FIELD_INT8 = 0,
+	ORB_FIELD_INT16,
+	ORB_FIELD_INT32,
+	ORB_FIELD_INT64,
+	ORB_FIELD_UINT8,
+	ORB_FIELD_UINT16,
+	ORB_FIELD_UINT32,
+	ORB_FIELD_UINT64,
+	ORB_FIELD_FLOAT,
+	ORB_FIELD_DOUBLE,
+	ORB_FIELD_BOOL,
+	ORB_FIELD_CHAR
+};
+
+/**
+ * Layout of one field of a topic structure.
+ *
+ * Fields of embedded message types are flattened into their members, so
+ * every field has a builtin type: the 'lat' of 'current' in
+ * position_setpoint_triplet is 'current.lat', the members of the first
+ * element of an embedded array are 'esc[0].esc_rpm' and so on.
+ */
+struct orb_field {
+	const char *name;		/**< field name */
+	uint16_t offset;		/**< offset in the structure */
+	uint16_t count;			/**< array length, 1 for a scalar */
+	uint8_t type;			/**< enum orb_field_type */
+};
+
+/**
+ * Layout descriptor entry of a field of a generated topic structure, used
+ * by the ORB_FIELDS_<msg> macros of the generated topic headers.
+ */
+#define ORB_FIELD(_struct, _field, _type, _count)	\
+	{ #_field, offsetof(_struct, _field), _count, _type }
+
 /**
  * Object metadata.
  */
 struct orb_metadata {
 	const char *o_name;		/**< unique object name */
 	const size_t o_size;		/**< object size */
+	const struct orb_field *o_fields;	/**< field layout, in structure order, or NULL */
+	const unsigned o_num_fields;	/**< number of entries in o_fields */
 };
 
 typedef const struct orb_metadata *orb_id_t;
@@ -120,7 +163,27 @@ enum ORB_PRIO {
 #define ORB_DEFINE(_name, _struct)			\
 	const struct orb_metadata __orb_##_name = {	\
 		#_name,					\
-		sizeof(_struct)				\
+		sizeof(_struct),			\
+		NULL,					\
+		0					\
+	}; struct hack
+
+/**
+ * Define the uORB metadata for a topic generated from a .msg file, with
+ * the field layout descriptor of the message.
+ *
+ * @param _name		The name of the topic.
+ * @param _msg		The name of the message, the topic provides struct _msg##_s.
+ */
+#define ORB_DEFINE_FIELDS(_name, _msg)				\
+	static const struct orb_field __orb_##_name##_fields[] = {	\
+		ORB_FIELDS_##_msg					\
+	};							\
+	const struct orb_metadata __orb_##_name = {		\
+		#_name,						\
+		sizeof(struct _msg##_s),			\
+		__orb_##_name##_fields,				\
+		sizeof(__orb_##_name##_fields) / sizeof(__orb_##_name##_fields[0])	\
 	}; struct hack
 
 __BEGIN_DECLS
@@ -188,6 +251,50 @@ extern orb_advert_t orb_advertise_multi(const struct orb_metadata *meta, const v
 					int priority) __EXPORT;
 
 
+/**
+ * Advertise as the publisher of a topic, with a queue of past samples.
+ *
+ * This is the same as orb_advertise(), but the topic node keeps the last
+ * queue_size publications. A subscriber that reads slower than the publisher
+ * publishes will get every queued sample in order on subsequent orb_copy()
+ * calls instead of only the latest one. If a subscriber falls behind by more
+ * than queue_size samples, the oldest ones are lost.
+ *
+ * The queue size can only be set by the first advertiser, before any data
+ * has been published to the topic.
+ *
+ * @param meta		The uORB metadata (usually from the ORB_ID() macro)
+ *			for the topic.
+ * @param data		A pointer to the initial data to be published.
+ *			For topics updated by interrupt handlers, the advertisement
+ *			must be performed from non-interrupt context.
+ * @param queue_size	Maximum number of buffered elements. A value of 1 is
+ *			equivalent to orb_advertise().
+ * @return		nullptr on error, otherwise returns a handle
+ *			that can be used to publish to the topic.
+ */
+extern orb_advert_t orb_advertise_queue(const struct orb_metadata *meta, const void *data,
+					unsigned int queue_size) __EXPORT;
+
+/**
+ * Advertise as the publisher of a multi-instance topic, with a queue of past samples.
+ *
+ * @see orb_advertise_multi() and orb_advertise_queue()
+ *
+ * @param meta		The uORB metadata (usually from the ORB_ID() macro)
+ *			for the topic.
+ * @param data		A pointer to the initial data to be published.
+ * @param instance	Pointer to an integer which will yield the instance ID (0-based,
+ *			limited by ORB_MULTI_MAX_INSTANCES) of the publication.
+ * @param priority	The priority of the instance.
+ * @param queue_size	Maximum number of buffered elements.
+ * @return		nullptr on error, otherwise returns a handle
+ *			that can be used to publish to the topic.
+ */
+extern orb_advert_t orb_advertise_multi_queue(const struct orb_metadata *meta, const void *data, int *instance,
+		int priority, unsigned int queue_size) __EXPORT;
+
+
 /**
  * Publish new data to a topic.
  *
@@ -289,6 +396,39 @@ extern int	orb_unsubscribe(int handle) __EXPORT;
  */
 extern int	orb_copy(const struct orb_metadata *meta, int handle, void *buffer) __EXPORT;
 
+/**
+ * Borrow the topic data without copying it.
+ *
+ * This behaves like orb_copy(), i.e. it resets the updated flag of the
+ * handle, but instead of copying the data into a caller buffer it returns a
+ * read-only pointer into the topic node. It is intended for large topics that
+ * the caller only needs to inspect.
+ *
+ * The pointer is only valid until orb_release() is called on the same
+ * handle. A publication might overwrite the data while it is borrowed, so
+ * the result of anything derived from the data must be discarded if
+ * orb_release() fails. No more than one borrow per handle can be outstanding.
+ *
+ * @param meta		The uORB metadata (usually from the ORB_ID() macro)
+ *			for the topic.
+ * @param handle	A handle returned from orb_subscribe.
+ * @param buffer	Returns the pointer to the borrowed data.
+ * @return		OK on success, ERROR otherwise with errno set accordingly.
+ */
+extern int	orb_borrow(const struct orb_metadata *meta, int handle, const void **buffer) __EXPORT;
+
+/**
+ * Return data borrowed with orb_borrow().
+ *
+ * @param meta		The uORB metadata (usually from the ORB_ID() macro)
+ *			for the topic.
+ * @param handle	A handle returned from orb_subscribe.
+ * @return		OK if the borrowed data stayed consistent for the whole
+ *			borrow, ERROR with errno set to EAGAIN if it was overwritten
+ *			by a publisher in the meantime.
+ */
+extern int	orb_release(const struct orb_metadata *meta, int handle) __EXPORT;
+
 /**
  * Check whether a topic has been published to since the last orb_copy.
  *
@@ -354,10 +494,11 @@ extern int	orb_priority(int handle, int32_t *priority) __EXPORT;
  * If this interval is set, the subscriber will not see more than one update
  * within the period.
  *
- * Specifically, the first time an update is reported to the subscriber a timer
- * is started. The update will continue to be reported via poll and orb_check, but
- * once fetched via orb_copy another update will not be reported until the timer
- * expires.
+ * Specifically, after the subscriber has fetched an update via orb_copy, the
+ * next one is not reported via poll and orb_check until the interval has passed.
+ * A poll that is already waiting for an update held back this way returns when
+ * the interval expires. On a queued topic the subscriber gets the latest element and
+ * skips the older ones.
  *
  * This feature can be used to pace a subscriber that is watching a topic that
  * would otherwise update too quickly.
@@ -368,6 +509,80 @@ extern int	orb_priority(int handle, int32_t *priority) __EXPORT;
  */
 extern int	orb_set_interval(int handle, unsigned interval) __EXPORT;
 
+struct work_s;
+
+/**
+ * Queue work on a work queue each time the topic is published.
+ *
+ * This lets a module consume a topic without a task of its own that waits in
+ * poll(). The worker is expected to orb_copy() the topic from the handle, and
+ * runs on the work queue thread, so it must not block.
+ *
+ * The work is only queued if it is not pending already, so one run of the
+ * worker may have to handle several publications, use orb_check() to loop over
+ * them for queued topics. The work must not be queued by anyone else and
+ * needs to stay valid until the callback is unregistered or the handle
+ * unsubscribed, which both cancel it. The interval of the handle is not
+ * applied.
+ *
+ * @param handle	A handle returned from orb_subscribe, at most one callback per handle.
+ * @param qid		The work queue, e.g. HPWORK or LPWORK.
+ * @param work		The work to queue, zero it before registering.
+ * @param worker	Called on the work queue after publications.
+ * @param arg		Passed to worker.
+ * @return		OK on success, ERROR otherwise with errno set accordingly.
+ */
+extern int	orb_register_work_callback(int handle, int qid, struct work_s *work, void (*worker)(void *arg),
+		void *arg) __EXPORT;
+
+/**
+ * Stop queueing the work registered with orb_register_work_callback().
+ *
+ * @param handle	A handle returned from orb_subscribe.
+ * @return		OK on success, ERROR otherwise with errno set accordingly.
+ */
+extern int	orb_unregister_work_callback(int handle) __EXPORT;
+
+/**
+ * Size of a topic in the packed representation: its fields back to back,
+ * in structure order and without padding.
+ *
+ * @param meta		The uORB metadata (usually from the ORB_ID() macro)
+ *			for the topic.
+ * @return		The packed size, or the structure size if the topic
+ *			has no field layout descriptor.
+ */
+extern size_t	orb_packed_size(const struct orb_metadata *meta) __EXPORT;
+
+/**
+ * Pack a topic structure, removing the padding between its fields.
+ *
+ * Runs of fields without padding in between are copied with a single
+ * memcpy. Topics without a field layout descriptor are copied as is.
+ *
+ * @param meta		The uORB metadata for the topic.
+ * @param data		The topic structure.
+ * @param buffer	Buffer of at least orb_packed_size() bytes.
+ * @return		The number of bytes written to buffer.
+ */
+extern size_t	orb_pack(const struct orb_metadata *meta, const void *data, void *buffer) __EXPORT;
+
+/**
+ * Unpack a topic structure packed by orb_pack(). The padding of the
+ * structure is left untouched.
+ *
+ * @param meta		The uORB metadata for the topic.
+ * @param buffer	The packed data.
+ * @param data		The topic structure to fill in.
+ * @return		The number of bytes consumed from buffer.
+ */
+extern size_t	orb_unpack(const struct orb_metadata *meta, const void *buffer, void *data) __EXPORT;
+
+/**
+ * Size of one element of a field type.
+ */
+extern size_t	orb_field_size(uint8_t type) __EXPORT;
+
 __END_DECLS
 
 /* Diverse uORB header defines */ //XXX: move to better location
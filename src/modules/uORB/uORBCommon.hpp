@@ -45,6 +45,12 @@ namespace uORB
 {
 static const unsigned orb_maxpath = 64;
 
+/** upper bound for the number of queued elements of a topic, see orb_advertise_queue() */
+static const unsigned orb_max_queue_size = 32;
+
+/** number of lock-free copy attempts of a subscriber before it locks out publishers */
+static const unsigned orb_max_read_attempts = 3;
+
 #ifdef ERROR
 # undef ERROR
 #endif
@@ -0,0 +1,196 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "uORBDelta.hpp"
+#include <string.h>
+
+/* an unchanged gap shorter than a run header is cheaper to send than a new run */
+static const int32_t RUN_HEADER_LEN = 3;
+static const int32_t MAX_RUN_LEN = 255;
+
+uORB::DeltaEncoder::DeltaEncoder() :
+	_key(nullptr),
+	_length(0),
+	_key_id(0),
+	_deltas(0)
+{
+}
+
+uORB::DeltaEncoder::~DeltaEncoder()
+{
+	delete[] _key;
+}
+
+int32_t uORB::DeltaEncoder::encode_key(const uint8_t *data, int32_t length, uint8_t *out)
+{
+	if (_key == nullptr || _length != length) {
+		delete[] _key;
+		_key = new uint8_t[length];
+		_length = length;
+
+		if (_key == nullptr) {
+			_length = 0;
+			return -1;
+		}
+	}
+
+	memcpy(_key, data, length);
+	_key_id++;
+	_deltas = 0;
+
+	out[0] = 'K';
+	out[1] = _key_id;
+	memcpy(&out[HEADER_LEN], data, length);
+
+	return length + HEADER_LEN;
+}
+
+int32_t uORB::DeltaEncoder::encode(const uint8_t *data, int32_t length, uint8_t *out)
+{
+	if (_key == nullptr || _length != length || _deltas >= KEY_INTERVAL) {
+		return encode_key(data, length, out);
+	}
+
+	/* a delta is only worth it if it is at most half the size of the topic */
+	const int32_t limit = HEADER_LEN + length / 2;
+	int32_t len = HEADER_LEN;
+	int32_t i = 0;
+
+	while (i < length) {
+		if (data[i] == _key[i]) {
+			i++;
+			continue;
+		}
+
+		/* extend the run over changed bytes and over gaps too short for a new run */
+		int32_t start = i;
+		int32_t end = i + 1;
+
+		for (int32_t j = end; j < length && j - start < MAX_RUN_LEN && j - end < RUN_HEADER_LEN; j++) {
+			if (data[j] != _key[j]) {
+				end = j + 1;
+			}
+		}
+
+		if (len + RUN_HEADER_LEN + (end - start) > limit) {
+			return encode_key(data, length, out);
+		}
+
+		out[len] = start & 0xff;
+		out[len + 1] = start >> 8;
+		out[len + 2] = end - start;
+		memcpy(&out[len + RUN_HEADER_LEN], &data[start], end - start);
+		len += RUN_HEADER_LEN + (end - start);
+		i = end;
+	}
+
+	out[0] = 'D';
+	out[1] = _key_id;
+	_deltas++;
+
+	return len;
+}
+
+uORB::DeltaDecoder::DeltaDecoder() :
+	_key(nullptr),
+	_data(nullptr),
+	_length(0),
+	_key_id(0)
+{
+}
+
+uORB::DeltaDecoder::~DeltaDecoder()
+{
+	delete[] _key;
+	delete[] _data;
+}
+
+int32_t uORB::DeltaDecoder::decode(const uint8_t *in, int32_t in_length, const uint8_t **data)
+{
+	if (in_length < DeltaEncoder::HEADER_LEN) {
+		return -1;
+	}
+
+	if (in[0] == 'K') {
+		int32_t length = in_length - DeltaEncoder::HEADER_LEN;
+
+		if (_key == nullptr || _length != length) {
+			delete[] _key;
+			delete[] _data;
+			_key = new uint8_t[length];
+			_data = new uint8_t[length];
+			_length = length;
+
+			if (_key == nullptr || _data == nullptr) {
+				delete[] _key;
+				delete[] _data;
+				_key = nullptr;
+				_data = nullptr;
+				_length = 0;
+				return -1;
+			}
+		}
+
+		memcpy(_key, &in[DeltaEncoder::HEADER_LEN], length);
+		_key_id = in[1];
+		*data = _key;
+		return length;
+	}
+
+	if (in[0] != 'D' || _key == nullptr || in[1] != _key_id) {
+		return -1;
+	}
+
+	memcpy(_data, _key, _length);
+
+	int32_t i = DeltaEncoder::HEADER_LEN;
+
+	while (i + RUN_HEADER_LEN <= in_length) {
+		int32_t offset = in[i] | (in[i + 1] << 8);
+		int32_t len = in[i + 2];
+
+		if (i + RUN_HEADER_LEN + len > in_length || offset + len > _length) {
+			return -1;
+		}
+
+		memcpy(&_data[offset], &in[i + RUN_HEADER_LEN], len);
+		i += RUN_HEADER_LEN + len;
+	}
+
+	if (i != in_length) {
+		return -1;
+	}
+
+	*data = _data;
+	return _length;
+}
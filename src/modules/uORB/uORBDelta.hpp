@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef _uORBDelta_hpp_
+#define _uORBDelta_hpp_
+
+#include <stdint.h>
+
+namespace uORB
+{
+class DeltaEncoder;
+class DeltaDecoder;
+}
+
+/**
+ * Delta encoding of the updates of one topic for the uORB channels.
+ *
+ * Every encoded message is either a keyframe carrying the whole topic or a
+ * delta carrying only the byte ranges that differ from the last keyframe.
+ * As deltas never depend on each other, a channel may drop or reorder
+ * messages: a lost delta only loses that update, deltas to a lost keyframe
+ * are discarded by the decoder until the next keyframe. Keyframes are sent
+ * periodically, and whenever a delta would not be much smaller.
+ *
+ * Message format:
+ *   uint8 type ('K' or 'D'), uint8 keyframe id, then
+ *   K: the topic data
+ *   D: runs of uint16 offset (little endian), uint8 length, data
+ */
+class uORB::DeltaEncoder
+{
+public:
+	static const int32_t HEADER_LEN = 2;
+
+	DeltaEncoder();
+	~DeltaEncoder();
+
+	/**
+	 * Largest message encoding a topic of the given size.
+	 */
+	static int32_t max_encoded_size(int32_t length) { return length + HEADER_LEN; }
+
+	/**
+	 * Encode an update of the topic.
+	 *
+	 * @param data		The topic data.
+	 * @param length	Size of the topic data, at most 65535 bytes.
+	 * @param out		Buffer of max_encoded_size(length) bytes.
+	 * @return		The length of the message, or -1 if out of memory.
+	 */
+	int32_t encode(const uint8_t *data, int32_t length, uint8_t *out);
+
+private:
+	/* a keyframe is sent at least after this many deltas */
+	static const unsigned KEY_INTERVAL = 50;
+
+	uint8_t *_key;
+	int32_t _length;
+	uint8_t _key_id;
+	unsigned _deltas;
+
+	int32_t encode_key(const uint8_t *data, int32_t length, uint8_t *out);
+
+	DeltaEncoder(const DeltaEncoder &);
+	DeltaEncoder &operator=(const DeltaEncoder &);
+};
+
+class uORB::DeltaDecoder
+{
+public:
+	DeltaDecoder();
+	~DeltaDecoder();
+
+	/**
+	 * Decode a message of DeltaEncoder::encode().
+	 *
+	 * @param in		The message.
+	 * @param in_length	Length of the message.
+	 * @param data		Returns the topic data, valid until the next call.
+	 * @return		The size of the topic data, or -1 if the message is
+	 *			malformed or a delta to a keyframe not received.
+	 */
+	int32_t decode(const uint8_t *in, int32_t in_length, const uint8_t **data);
+
+private:
+	uint8_t *_key;
+	uint8_t *_data;
+	int32_t _length;
+	uint8_t _key_id;
+
+	DeltaDecoder(const DeltaDecoder &);
+	DeltaDecoder &operator=(const DeltaDecoder &);
+};
+
+#endif // _uORBDelta_hpp_
@@ -41,6 +41,9 @@
 #include "uORBUtils.hpp"
 #include "uORBManager.hpp"
 #include "uORBCommunicator.hpp"
+#include "uORBMemPool.hpp"
+#include <systemlib/trace.h>
+#include <px4_workqueue.h>
 #include <stdlib.h>
 
 uORB::ORBMap uORB::DeviceMaster::_node_map;
@@ -56,12 +59,19 @@ uORB::DeviceNode::DeviceNode
 	_meta(meta),
 	_data(nullptr),
 	_last_update(0),
+	_publish_interval(0),
 	_generation(0),
+	_write_generation(0),
 	_publisher(0),
 	_priority(priority),
 	_published(false),
+	_queue_size(1),
+	_lost_messages(0),
 	_IsRemoteSubscriberPresent(false),
-	_subscriber_count(0)
+	_subscriber_count(0),
+	_callbacks(nullptr),
+	_update_call{},
+	_update_deadline(0)
 {
 	// enable debug() calls
 	_debug_enabled = true;
@@ -69,8 +79,10 @@ uORB::DeviceNode::DeviceNode
 
 uORB::DeviceNode::~DeviceNode()
 {
+	hrt_cancel(&_update_call);
+
 	if (_data != nullptr) {
-		delete[] _data;
+		MemPool::instance().free(_data, _meta->o_size * _queue_size);
 	}
 
 }
@@ -113,7 +125,7 @@ uORB::DeviceNode::open(struct file *filp)
 	if (filp->f_oflags == O_RDONLY) {
 
 		/* allocate subscriber data */
-		SubscriberData *sd = new SubscriberData;
+		SubscriberData *sd = (SubscriberData *)MemPool::instance().alloc(sizeof(SubscriberData));
 
 		if (nullptr == sd) {
 			return -ENOMEM;
@@ -134,7 +146,7 @@ uORB::DeviceNode::open(struct file *filp)
 		add_internal_subscriber();
 
 		if (ret != OK) {
-			delete sd;
+			MemPool::instance().free(sd, sizeof(*sd));
 		}
 
 		return ret;
@@ -155,9 +167,9 @@ uORB::DeviceNode::close(struct file *filp)
 		SubscriberData *sd = filp_to_sd(filp);
 
 		if (sd != nullptr) {
-			hrt_cancel(&sd->update_call);
+			unregister_callback(sd);
 			remove_internal_subscriber();
-			delete sd;
+			MemPool::instance().free(sd, sizeof(*sd));
 			sd = nullptr;
 		}
 	}
@@ -181,28 +193,40 @@ uORB::DeviceNode::read(struct file *filp, char *buffer, size_t buflen)
 	}
 
 	/*
-	 * Perform an atomic copy & state update
+	 * Copy the data without locking and retry if a publisher overwrote the
+	 * slot meanwhile. After a few failed attempts, fall back to copying with
+	 * publishers locked out to guarantee progress.
 	 */
-	irqstate_t flags = irqsave();
+	const unsigned cursor = sd->generation;
+	unsigned attempts = 0;
 
-	/* if the caller doesn't want the data, don't give it to them */
-	if (nullptr != buffer) {
-		memcpy(buffer, _data, _meta->o_size);
-	}
+	for (;;) {
+		unsigned generation;
+		const uint8_t *src = advance_subscriber(sd, &generation);
 
-	/* track the last generation that the file has seen */
-	sd->generation = _generation;
+		/* if the caller doesn't want the data, don't give it to them */
+		if (nullptr == buffer) {
+			break;
+		}
 
-	/* set priority */
-	sd->priority = _priority;
+		memcpy(buffer, src, _meta->o_size);
+		__sync_synchronize();
 
-	/*
-	 * Clear the flag that indicates that an update has been reported, as
-	 * we have just collected it.
-	 */
-	sd->update_reported = false;
+		if (slot_intact(generation)) {
+			break;
+		}
 
-	irqrestore(flags);
+		/* torn read: rewind the subscriber and try again with the latest data */
+		sd->generation = cursor;
+
+		if (++attempts >= orb_max_read_attempts) {
+			irqstate_t flags = irqsave();
+			src = advance_subscriber(sd, &generation);
+			memcpy(buffer, src, _meta->o_size);
+			irqrestore(flags);
+			break;
+		}
+	}
 
 	return _meta->o_size;
 }
@@ -226,7 +250,7 @@ uORB::DeviceNode::write(struct file *filp, const char *buffer, size_t buflen)
 
 			/* re-check size */
 			if (nullptr == _data) {
-				_data = new uint8_t[_meta->o_size];
+				_data = (uint8_t *)MemPool::instance().alloc(_meta->o_size * _queue_size);
 			}
 
 			unlock();
@@ -243,18 +267,44 @@ uORB::DeviceNode::write(struct file *filp, const char *buffer, size_t buflen)
 		return -EIO;
 	}
 
-	/* Perform an atomic copy. */
+	/*
+	 * Perform an atomic copy. Interrupts are only disabled to serialize
+	 * publishers (writes are legal from interrupt context), subscribers copy
+	 * without disabling them and detect a torn read via slot_intact().
+	 */
 	irqstate_t flags = irqsave();
-	memcpy(_data, buffer, _meta->o_size);
-	irqrestore(flags);
+
+	const unsigned generation = _generation;
+
+	/* announce the write, so readers of the slot being replaced retry */
+	_write_generation = generation + 1;
+	__sync_synchronize();
+
+	memcpy(_data + (_meta->o_size * (generation % _queue_size)), buffer, _meta->o_size);
 
 	/* update the timestamp and generation count */
-	_last_update = hrt_absolute_time();
-	_generation++;
+	const hrt_abstime now = hrt_absolute_time();
+
+	if (_last_update != 0) {
+		_publish_interval = now - _last_update;
+	}
+
+	_last_update = now;
+	__sync_synchronize();
+	/* wrap-around happens after ~49 days, assuming a publisher rate of 1 kHz */
+	_generation = generation + 1;
+
+	irqrestore(flags);
+
+	TRACE_PUBLISH_TOPIC(_meta);
 
 	/* notify any poll waiters */
 	poll_notify(POLLIN);
 
+	if (_callbacks != nullptr) {
+		queue_callbacks();
+	}
+
 	_published = true;
 
 	return _meta->o_size;
@@ -286,6 +336,51 @@ uORB::DeviceNode::ioctl(struct file *filp, int cmd, unsigned long arg)
 		*(int *)arg = sd->priority;
 		return OK;
 
+	case ORBIOCSETQUEUESIZE:
+		return update_queue_size(arg);
+
+	case ORBIOCBORROW: {
+			/* nothing published yet, nothing to borrow */
+			if (_data == nullptr) {
+				return -EIO;
+			}
+
+			/* only one outstanding borrow per subscriber */
+			if (sd->borrowed) {
+				return -EBUSY;
+			}
+
+			*(const void **)arg = advance_subscriber(sd, &sd->borrowed_generation);
+			sd->borrowed = true;
+
+			return OK;
+		}
+
+	case ORBIOCRELEASE: {
+			if (!sd->borrowed) {
+				return -EINVAL;
+			}
+
+			/*
+			 * The borrowed slot is only overwritten once the publisher has
+			 * wrapped around the whole queue. A write that is still in
+			 * progress is accounted for, as it announces itself before
+			 * touching the slot.
+			 */
+			__sync_synchronize();
+			bool valid = slot_intact(sd->borrowed_generation);
+			sd->borrowed = false;
+
+			return valid ? OK : -EAGAIN;
+		}
+
+	case ORBIOCREGCALLBACK:
+		return register_callback(sd, (const struct orb_work_callback *)arg);
+
+	case ORBIOCUNREGCALLBACK:
+		unregister_callback(sd);
+		return OK;
+
 	default:
 		/* give it to the superclass */
 		return CDev::ioctl(filp, cmd, arg);
@@ -349,6 +444,8 @@ uORB::DeviceNode::poll_state(struct file *filp)
 		return POLLIN;
 	}
 
+	defer_update(sd);
+
 	return 0;
 }
 
@@ -361,105 +458,192 @@ uORB::DeviceNode::poll_notify_one(struct pollfd *fds, pollevent_t events)
 	 * If the topic looks updated to the subscriber, go ahead and notify them.
 	 */
 	if (appears_updated(sd)) {
+		TRACE_NOTIFY_TOPIC(_meta);
 		CDev::poll_notify_one(fds, events);
+
+	} else {
+		defer_update(sd);
 	}
 }
 
-bool
-uORB::DeviceNode::appears_updated(SubscriberData *sd)
+void
+uORB::DeviceNode::defer_update(SubscriberData *sd)
 {
-	/* assume it doesn't look updated */
-	bool ret = false;
+	if (sd->update_interval == 0 || sd->generation == _generation) {
+		return;
+	}
 
-	/* avoid racing between interrupt and non-interrupt context calls */
-	irqstate_t state = irqsave();
+	hrt_abstime deadline = sd->last_read + sd->update_interval;
 
-	/* check if this topic has been published yet, if not bail out */
-	if (_data == nullptr) {
-		ret = false;
-		goto out;
+	if (_update_deadline == 0 || deadline < _update_deadline) {
+		_update_deadline = deadline;
+		hrt_call_at(&_update_call, deadline, &uORB::DeviceNode::update_deferred_trampoline, (void *)this);
 	}
+}
+
+void
+uORB::DeviceNode::update_deferred_trampoline(void *arg)
+{
+	uORB::DeviceNode *node = (uORB::DeviceNode *)arg;
 
 	/*
-	 * If the subscriber's generation count matches the update generation
-	 * count, there has been no update from their perspective; if they
-	 * don't match then we might have a visible update.
+	 * Instigate a poll notification; any subscribers whose intervals have
+	 * expired will be woken, the others schedule the next deadline.
 	 */
-	while (sd->generation != _generation) {
+	node->_update_deadline = 0;
+	node->poll_notify(POLLIN);
+}
 
-		/*
-		 * Handle non-rate-limited subscribers.
-		 */
-		if (sd->update_interval == 0) {
-			ret = true;
+int
+uORB::DeviceNode::register_callback(SubscriberData *sd, const struct orb_work_callback *callback)
+{
+	/* only subscribers can register */
+	if (sd == nullptr) {
+		return -EINVAL;
+	}
+
+	irqstate_t flags = irqsave();
+
+	if (sd->callback.work != nullptr) {
+		irqrestore(flags);
+		return -EBUSY;
+	}
+
+	sd->callback = *callback;
+	sd->next_callback = _callbacks;
+	_callbacks = sd;
+
+	irqrestore(flags);
+
+	return OK;
+}
+
+void
+uORB::DeviceNode::unregister_callback(SubscriberData *sd)
+{
+	if (sd == nullptr) {
+		return;
+	}
+
+	irqstate_t flags = irqsave();
+
+	struct orb_work_callback callback = sd->callback;
+
+	for (SubscriberData **entry = &_callbacks; *entry != nullptr; entry = &(*entry)->next_callback) {
+		if (*entry == sd) {
+			*entry = sd->next_callback;
 			break;
 		}
+	}
 
-		/*
-		 * If we have previously told the subscriber that there is data,
-		 * and they have not yet collected it, continue to tell them
-		 * that there has been an update.  This mimics the non-rate-limited
-		 * behaviour where checking / polling continues to report an update
-		 * until the topic is read.
-		 */
-		if (sd->update_reported) {
-			ret = true;
-			break;
+	sd->callback.work = nullptr;
+	sd->next_callback = nullptr;
+
+	irqrestore(flags);
+
+	/* no publication can queue it any more */
+	if (callback.work != nullptr) {
+		work_cancel(callback.qid, callback.work);
+	}
+}
+
+void
+uORB::DeviceNode::queue_callbacks()
+{
+	irqstate_t flags = irqsave();
+
+	for (SubscriberData *sd = _callbacks; sd != nullptr; sd = sd->next_callback) {
+		/* work that is still pending will see this publication as well */
+		if (sd->callback.work->worker == nullptr) {
+			work_queue(sd->callback.qid, sd->callback.work, sd->callback.worker, sd->callback.arg, 0);
 		}
+	}
 
-		/*
-		 * If the interval timer is still running, the topic should not
-		 * appear updated, even though at this point we know that it has.
-		 * We have previously been through here, so the subscriber
-		 * must have collected the update we reported, otherwise
-		 * update_reported would still be true.
-		 */
-		if (!hrt_called(&sd->update_call)) {
-			break;
+	irqrestore(flags);
+}
+
+const uint8_t *
+uORB::DeviceNode::advance_subscriber(SubscriberData *sd, unsigned *read_generation)
+{
+	/* take a snapshot, publishers may update the generation concurrently */
+	const unsigned generation = _generation;
+	__sync_synchronize();
+
+	if (generation > sd->generation + _queue_size) {
+		/* Reader is too far behind: some messages are lost */
+		if (sd->update_interval == 0) {
+			/* a rate-limited subscriber skips them on purpose */
+			const unsigned lost = generation - _queue_size - sd->generation;
+			sd->lost += lost;
+			__sync_fetch_and_add(&_lost_messages, lost);
 		}
 
-		/*
-		 * Make sure that we don't consider the topic to be updated again
-		 * until the interval has passed once more by restarting the interval
-		 * timer and thereby re-scheduling a poll notification at that time.
-		 */
-		hrt_call_after(&sd->update_call,
-			       sd->update_interval,
-			       &uORB::DeviceNode::update_deferred_trampoline,
-			       (void *)this);
+		sd->generation = generation - _queue_size;
+	}
 
-		/*
-		 * Remember that we have told the subscriber that there is data.
+	if (sd->update_interval != 0 && generation > sd->generation) {
+		/* A rate-limited subscriber gets the latest message, skipping the queued ones */
+		sd->generation = generation - 1;
+	}
+
+	if (generation == sd->generation && sd->generation > 0) {
+		/* The subscriber already read the latest message, but nothing new was published yet.
+		 * Return the previous message
 		 */
-		sd->update_reported = true;
-		ret = true;
+		--sd->generation;
+	}
+
+	*read_generation = sd->generation;
 
-		break;
+	/* advance the subscriber to the next queued generation */
+	if (sd->generation < generation) {
+		++sd->generation;
 	}
 
-out:
-	irqrestore(state);
+	/* set priority */
+	sd->priority = _priority;
 
-	/* consider it updated */
-	return ret;
+	/* the interval of a rate-limited subscriber restarts with each read */
+	if (sd->update_interval != 0) {
+		sd->last_read = hrt_absolute_time();
+	}
+
+	return _data + (_meta->o_size * (*read_generation % _queue_size));
 }
 
-void
-uORB::DeviceNode::update_deferred()
+bool
+uORB::DeviceNode::appears_updated(SubscriberData *sd)
 {
+	/* assume it doesn't look updated */
+	bool ret = false;
+
+	/* avoid racing between interrupt and non-interrupt context calls */
+	irqstate_t state = irqsave();
+
+	/* check if this topic has been published yet, if not bail out */
+	if (_data == nullptr) {
+		ret = false;
+		goto out;
+	}
+
 	/*
-	 * Instigate a poll notification; any subscribers whose intervals have
-	 * expired will be woken.
+	 * If the subscriber's generation count matches the update generation
+	 * count, there has been no update from their perspective; if they
+	 * don't match then we might have a visible update.
+	 *
+	 * A rate-limited subscriber only sees the update once the interval
+	 * since its last read has passed. A poll waiting meanwhile is woken by
+	 * the shared timer of defer_update() when the interval expires.
 	 */
-	poll_notify(POLLIN);
-}
+	if (sd->generation != _generation) {
+		ret = (sd->update_interval == 0 || hrt_elapsed_time(&sd->last_read) >= sd->update_interval);
+	}
 
-void
-uORB::DeviceNode::update_deferred_trampoline(void *arg)
-{
-	uORB::DeviceNode *node = (uORB::DeviceNode *)arg;
+out:
+	irqrestore(state);
 
-	node->update_deferred();
+	/* consider it updated */
+	return ret;
 }
 
 //-----------------------------------------------------------------------------
@@ -470,7 +654,7 @@ void uORB::DeviceNode::add_internal_subscriber()
 	uORBCommunicator::IChannel *ch = uORB::Manager::get_instance()->get_uorb_communicator();
 
 	if (ch != nullptr && _subscriber_count > 0) {
-		ch->add_subscription(_meta->o_name, 1);
+		ch->add_subscription(_meta->o_name, 0);
 	}
 }
 
@@ -494,6 +678,23 @@ bool uORB::DeviceNode::is_published()
 	return _published;
 }
 
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int uORB::DeviceNode::update_queue_size(unsigned int queue_size)
+{
+	if (_queue_size == queue_size) {
+		return OK;
+	}
+
+	/* queue size is not allowed to be changed after the first publication, nor to shrink */
+	if (_data != nullptr || _queue_size > queue_size || queue_size > orb_max_queue_size) {
+		return ERROR;
+	}
+
+	_queue_size = queue_size;
+	return OK;
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 int16_t uORB::DeviceNode::process_add_subscription(int32_t rateInHz)
@@ -650,8 +851,12 @@ uORB::DeviceMaster::ioctl(struct file *filp, int cmd, unsigned long arg)
 					free((void *)devpath);
 
 				} else {
-					// add to the node map;.
-					_node_map.insert(nodepath, node);
+					/* add to the node map, the node keeps devpath for its lifetime. The param
+					 * flavor is indexed by path only, its metadata would alias the pubsub one. */
+					if (!_node_map.insert(devpath, (_flavor == PUBSUB) ? meta : nullptr,
+							      (adv->instance != nullptr) ? *(adv->instance) : 0, node)) {
+						warnx("node map full, %s only reachable by path", devpath);
+					}
 				}
 
 				group_tries++;
@@ -676,12 +881,10 @@ uORB::DeviceMaster::ioctl(struct file *filp, int cmd, unsigned long arg)
 
 uORB::DeviceNode *uORB::DeviceMaster::GetDeviceNode(const char *nodepath)
 {
-	uORB::DeviceNode *rc = nullptr;
-
-	if (_node_map.find(nodepath)) {
-		rc = _node_map.get(nodepath);
-	}
-
-	return rc;
+	return _node_map.get(nodepath);
 }
 
+uORB::DeviceNode *uORB::DeviceMaster::GetDeviceNode(const struct orb_metadata *meta, int instance)
+{
+	return _node_map.get(meta, instance);
+}
@@ -166,6 +166,41 @@ public:
 	 * and publish to this node or if another node should be tried. */
 	bool is_published();
 
+	/**
+	 * Try to change the size of the queue. This can only be done as long as nobody published yet.
+	 * This is the case, for example when orb_subscribe was called before an orb_advertise.
+	 * The queue size can only be increased.
+	 * @param queue_size new size of the queue
+	 * @return PX4_OK if queue size successfully set
+	 */
+	int update_queue_size(unsigned int queue_size);
+
+	/**
+	 * Get the size of the queue of this topic.
+	 */
+	unsigned int get_queue_size() const { return _queue_size; }
+
+	/**
+	 * Number of publications so far.
+	 */
+	unsigned published_message_count() const { return _generation; }
+
+	/**
+	 * Number of messages the subscribers missed because they fell behind
+	 * by more than the queue size, summed over all subscribers.
+	 */
+	unsigned lost_message_count() const { return _lost_messages; }
+
+	/**
+	 * Time between the last two publications, 0 until published twice.
+	 */
+	hrt_abstime publish_interval() const { return _publish_interval; }
+
+	/**
+	 * Number of local subscribers.
+	 */
+	int32_t subscriber_count() const { return _subscriber_count; }
+
 protected:
 	virtual pollevent_t poll_state(struct file *filp);
 	virtual void poll_notify_one(struct pollfd *fds, pollevent_t events);
@@ -174,19 +209,28 @@ private:
 	struct SubscriberData {
 		unsigned  generation; /**< last generation the subscriber has seen */
 		unsigned  update_interval; /**< if nonzero minimum interval between updates */
-		struct hrt_call update_call;  /**< deferred wakeup call if update_period is nonzero */
+		hrt_abstime last_read; /**< time of the last read, the interval starts from there */
 		void    *poll_priv; /**< saved copy of fds->f_priv while poll is active */
-		bool    update_reported; /**< true if we have reported the update via poll/check */
 		int   priority; /**< priority of publisher */
+		bool    borrowed; /**< true while the subscriber holds a pointer from ORBIOCBORROW */
+		unsigned  borrowed_generation; /**< generation of the borrowed data */
+		struct orb_work_callback callback; /**< work queued on publications, if callback.work is set */
+		SubscriberData *next_callback; /**< next subscriber in _callbacks */
+		unsigned  lost; /**< messages missed by falling behind the queue */
 	};
 
 	const struct orb_metadata *_meta; /**< object metadata information */
 	uint8_t     *_data;   /**< allocated object buffer */
 	hrt_abstime   _last_update; /**< time the object was last updated */
+	hrt_abstime   _publish_interval; /**< time between the last two updates */
 	volatile unsigned   _generation;  /**< object generation count */
+	volatile unsigned   _write_generation;  /**< generation of the last publication started,
+						  ahead of _generation while a write is in progress */
 	pid_t     _publisher; /**< if nonzero, current publisher */
 	const int   _priority;  /**< priority of topic */
 	bool _published;  /**< has ever data been published */
+	unsigned int _queue_size; /**< maximum number of elements in the queue */
+	volatile unsigned _lost_messages; /**< messages missed by all subscribers */
 
 private: // private class methods.
 
@@ -199,18 +243,74 @@ private: // private class methods.
 	bool    _IsRemoteSubscriberPresent;
 	int32_t _subscriber_count;
 
+	SubscriberData    *_callbacks; /**< subscribers with a work callback */
+
+	struct hrt_call   _update_call; /**< wakes the rate-limited pollers at the end of their interval */
+	volatile hrt_abstime _update_deadline; /**< time _update_call is due, 0 if not scheduled */
+
+	/**
+	 * Set the work callback of a subscriber, see ORBIOCREGCALLBACK.
+	 *
+	 * @param sd    The subscriber.
+	 * @param callback  The work to queue on publications.
+	 * @return    OK, or -EBUSY if the subscriber has a callback already.
+	 */
+	int       register_callback(SubscriberData *sd, const struct orb_work_callback *callback);
+
+	/**
+	 * Remove the work callback of a subscriber and cancel the work, if any.
+	 *
+	 * @param sd    The subscriber.
+	 */
+	void      unregister_callback(SubscriberData *sd);
+
 	/**
-	 * Perform a deferred update for a rate-limited subscriber.
+	 * Queue the work of all subscribers with a callback that is not pending already.
 	 */
-	void      update_deferred();
+	void      queue_callbacks();
 
 	/**
-	 * Bridge from hrt_call to update_deferred
+	 * Schedule a poll notification for a rate-limited subscriber whose
+	 * update is held back by its interval, one timer serves all of them.
 	 *
-	 * void *arg    ORBDevNode pointer for which the deferred update is performed.
+	 * @param sd    The subscriber being polled.
+	 */
+	void      defer_update(SubscriberData *sd);
+
+	/**
+	 * Notify the pollers of the topic once the earliest interval expired,
+	 * the ones still held back schedule the next deadline.
 	 */
 	static void   update_deferred_trampoline(void *arg);
 
+
+	/**
+	 * Advance the read position of a subscriber, as done by read() and
+	 * ORBIOCBORROW. Must only be called once _data is allocated, and from
+	 * the subscriber's own context.
+	 *
+	 * @param sd    The subscriber reading the topic.
+	 * @param read_generation Returns the generation of the element to read.
+	 * @return    Pointer to the queue slot holding the element to read.
+	 */
+	const uint8_t      *advance_subscriber(SubscriberData *sd, unsigned *read_generation);
+
+	/**
+	 * Check whether the queue slot of a generation is still intact, i.e. no
+	 * publication overwriting it has started. This is the reader side of the
+	 * sequence protocol that lets subscribers copy data without locking:
+	 * publishers bump _write_generation before and _generation after writing
+	 * a slot, so a reader that sees this return true after its copy knows the
+	 * copy was not torn.
+	 *
+	 * @param generation  Generation of the element that was read.
+	 * @return    true if the element was not (being) overwritten.
+	 */
+	bool      slot_intact(unsigned generation)
+	{
+		return (_write_generation - generation) <= _queue_size;
+	}
+
 	/**
 	 * Check whether a topic appears updated to a subscriber.
 	 *
@@ -237,6 +337,27 @@ public:
 	virtual ~DeviceMaster();
 
 	static uORB::DeviceNode *GetDeviceNode(const char *node_name);
+
+	/**
+	 * Look up the node of a topic instance without building its path.
+	 *
+	 * @return the node, or nullptr if it was not created through this map.
+	 */
+	static uORB::DeviceNode *GetDeviceNode(const struct orb_metadata *meta, int instance);
+
+	/**
+	 * Whether a failed GetDeviceNode() lookup is conclusive, i.e. every node
+	 * created so far was added to the map.
+	 */
+	static bool NodeMapComplete() { return !_node_map.overflow(); }
+
+	/**
+	 * Number of nodes in the map, for iterating with NodeMapEntry().
+	 */
+	static unsigned NodeMapSize() { return _node_map.size(); }
+
+	static const ORBMap::Node &NodeMapEntry(unsigned i) { return _node_map.entry(i); }
+
 	virtual int   ioctl(struct file *filp, int cmd, unsigned long arg);
 private:
 	Flavor      _flavor;
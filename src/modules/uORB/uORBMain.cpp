@@ -32,9 +32,13 @@
  ****************************************************************************/
 
 #include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <drivers/drv_hrt.h>
 #include "uORBDevices.hpp"
 #include "uORB.h"
 #include "uORBCommon.hpp"
+#include "uORBMemPool.hpp"
 
 #ifndef __PX4_QURT
 #include "uORBTest_UnitTest.hpp"
@@ -45,9 +49,112 @@ extern "C" { __EXPORT int uorb_main(int argc, char *argv[]); }
 static uORB::DeviceMaster *g_dev = nullptr;
 static void usage()
 {
-  warnx("Usage: uorb 'start', 'test', 'latency_test' or 'status'");
+  warnx("Usage: uorb 'start', 'test', 'latency_test', 'perf', 'top [once]' or 'status'");
 }
 
+#ifndef __PX4_QURT
+/**
+ * Sample the publication statistics of every topic and, if print is set,
+ * show them with the rates taken over the time since the previous sample.
+ */
+static void sample_top(bool print, unsigned *last_published, unsigned *last_lost, unsigned &last_count,
+                       hrt_abstime &last_time)
+{
+  const hrt_abstime now = hrt_absolute_time();
+  const float dt = (now - last_time) / 1e6f;
+  const unsigned count = uORB::DeviceMaster::NodeMapSize();
+
+  if (print) {
+    /* clear screen */
+    printf("\033[2J\033[H");
+    printf("%-28s %4s %4s %8s %7s %9s %3s\n", "TOPIC", "INST", "SUBS", "RATE(Hz)", "LOST/s",
+           "INTERVAL", "Q");
+  }
+
+  for (unsigned i = 0; i < count; i++) {
+    const uORB::ORBMap::Node &entry = uORB::DeviceMaster::NodeMapEntry(i);
+
+    const unsigned published = entry.node->published_message_count();
+    const unsigned lost = entry.node->lost_message_count();
+
+    /* a node created since the previous call starts counting now */
+    if (i >= last_count) {
+      last_published[i] = published;
+      last_lost[i] = lost;
+    }
+
+    if (print && entry.meta != nullptr) {
+      printf("%-28s %4d %4d %8.1f %7.1f %9u %3u\n", entry.meta->o_name, entry.instance,
+             (int)entry.node->subscriber_count(), (double)((published - last_published[i]) / dt),
+             (double)((lost - last_lost[i]) / dt), (unsigned)entry.node->publish_interval(),
+             entry.node->get_queue_size());
+    }
+
+    last_published[i] = published;
+    last_lost[i] = lost;
+  }
+
+  if (print && !uORB::DeviceMaster::NodeMapComplete()) {
+    printf("more topics than entries in the node map, some are not shown\n");
+  }
+
+  last_count = count;
+  last_time = now;
+}
+
+static int top(bool once)
+{
+  unsigned *last_published = new unsigned[uORB::ORBMap::max_entries];
+  unsigned *last_lost = new unsigned[uORB::ORBMap::max_entries];
+  unsigned last_count = 0;
+  hrt_abstime last_time = hrt_absolute_time();
+
+  if (last_published == nullptr || last_lost == nullptr) {
+    delete[] last_published;
+    delete[] last_lost;
+    return -ENOMEM;
+  }
+
+  /* take the first sample, the rates are computed against it */
+  sample_top(false, last_published, last_lost, last_count, last_time);
+
+  for (bool quit = false; !quit;) {
+    /* wait 1 s for user input, in steps of 100 ms */
+    for (int k = 0; k < 10 && !quit; k++) {
+      struct pollfd fds;
+      fds.fd = 0; /* stdin */
+      fds.events = POLLIN;
+
+      if (!once && poll(&fds, 1, 0) > 0) {
+        char c;
+        read(0, &c, 1);
+
+        switch (c) {
+        case 0x03: // ctrl-c
+        case 0x1b: // esc
+        case 'c':
+        case 'q':
+          quit = true;
+          break;
+        }
+      }
+
+      usleep(100000);
+    }
+
+    if (!quit) {
+      sample_top(true, last_published, last_lost, last_count, last_time);
+    }
+
+    quit = quit || once;
+  }
+
+  delete[] last_published;
+  delete[] last_lost;
+  return OK;
+}
+#endif
+
 
 int
 uorb_main(int argc, char *argv[])
@@ -78,6 +185,11 @@ uorb_main(int argc, char *argv[])
       return -ENOMEM;
     }
 
+    /* preallocate the topic buffers and subscriber records */
+    if (OK != uORB::MemPool::instance().init()) {
+      warnx("pool preallocation failed");
+    }
+
     if (OK != g_dev->init()) {
       warnx("driver init failed");
       delete g_dev;
@@ -112,6 +224,23 @@ uorb_main(int argc, char *argv[])
       return t.latency_test<struct orb_test>(ORB_ID(orb_test), true);
     }
   }
+
+  /*
+   * Benchmark publish, copy and poll wakeup times.
+   */
+  if (!strcmp(argv[1], "perf"))
+  {
+    uORBTest::UnitTest &t = uORBTest::UnitTest::instance();
+    return t.perf();
+  }
+
+  /*
+   * Show the publication rates and lost messages of the topics, until a key is hit.
+   */
+  if (!strcmp(argv[1], "top"))
+  {
+    return top(argc > 2 && !strcmp(argv[2], "once"));
+  }
 #endif
 
   /*
@@ -119,6 +248,7 @@ uorb_main(int argc, char *argv[])
    */
   if (!strcmp(argv[1], "status"))
   {
+    uORB::MemPool::instance().print_status();
     return OK;
   }
 
@@ -83,13 +83,15 @@ public:
 	 * @param data    A pointer to the initial data to be published.
 	 *      For topics updated by interrupt handlers, the advertisement
 	 *      must be performed from non-interrupt context.
+	 * @param queue_size  Maximum number of buffered elements. If this is 1, no queuing is
+	 *      used.
 	 * @return    nullptr on error, otherwise returns an object pointer
 	 *      that can be used to publish to the topic.
 	 *      If the topic in question is not known (due to an
 	 *      ORB_DEFINE with no corresponding ORB_DECLARE)
 	 *      this function will return nullptr and set errno to ENOENT.
 	 */
-	orb_advert_t orb_advertise(const struct orb_metadata *meta, const void *data);
+	orb_advert_t orb_advertise(const struct orb_metadata *meta, const void *data, unsigned int queue_size = 1);
 
 	/**
 	 * Advertise as the publisher of a topic.
@@ -110,6 +112,8 @@ public:
 	 * @param priority  The priority of the instance. If a subscriber subscribes multiple
 	 *      instances, the priority allows the subscriber to prioritize the best
 	 *      data source as long as its available.
+	 * @param queue_size  Maximum number of buffered elements. If this is 1, no queuing is
+	 *      used.
 	 * @return    ERROR on error, otherwise returns a handle
 	 *      that can be used to publish to the topic.
 	 *      If the topic in question is not known (due to an
@@ -117,7 +121,7 @@ public:
 	 *      this function will return -1 and set errno to ENOENT.
 	 */
 	orb_advert_t orb_advertise_multi(const struct orb_metadata *meta, const void *data, int *instance,
-					 int priority) ;
+					 int priority, unsigned int queue_size = 1) ;
 
 
 	/**
@@ -220,6 +224,31 @@ public:
 	 */
 	int  orb_copy(const struct orb_metadata *meta, int handle, void *buffer) ;
 
+	/**
+	 * Borrow the topic data without copying it.
+	 *
+	 * Like orb_copy(), but hands back a read-only pointer to the data held
+	 * by the topic node. The pointer stays valid until orb_release().
+	 *
+	 * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+	 *      for the topic.
+	 * @param handle  A handle returned from orb_subscribe.
+	 * @param buffer  Returns the pointer to the borrowed data.
+	 * @return    OK on success, ERROR otherwise with errno set accordingly.
+	 */
+	int  orb_borrow(const struct orb_metadata *meta, int handle, const void **buffer) ;
+
+	/**
+	 * Return data borrowed with orb_borrow().
+	 *
+	 * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+	 *      for the topic.
+	 * @param handle  A handle returned from orb_subscribe.
+	 * @return    OK if the borrowed data stayed consistent, ERROR with errno
+	 *      set to EAGAIN if it was overwritten while borrowed.
+	 */
+	int  orb_release(const struct orb_metadata *meta, int handle) ;
+
 	/**
 	 * Check whether a topic has been published to since the last orb_copy.
 	 *
@@ -277,10 +306,11 @@ public:
 	 * If this interval is set, the subscriber will not see more than one update
 	 * within the period.
 	 *
-	 * Specifically, the first time an update is reported to the subscriber a timer
-	 * is started. The update will continue to be reported via poll and orb_check, but
-	 * once fetched via orb_copy another update will not be reported until the timer
-	 * expires.
+	 * Specifically, after the subscriber has fetched an update via orb_copy, the
+	 * next one is not reported via poll and orb_check until the interval has passed.
+	 * A poll that is already waiting for an update held back this way returns when
+	 * the interval expires. On a queued topic the subscriber gets the latest element and
+	 * skips the older ones.
 	 *
 	 * This feature can be used to pace a subscriber that is watching a topic that
 	 * would otherwise update too quickly.
@@ -291,6 +321,29 @@ public:
 	 */
 	int  orb_set_interval(int handle, unsigned interval) ;
 
+	/**
+	 * Queue work on a work queue each time the topic is published.
+	 *
+	 * The work is only queued if it is not pending already. It must stay
+	 * valid until the callback is unregistered or the handle unsubscribed.
+	 *
+	 * @param handle  A handle returned from orb_subscribe, at most one callback per handle.
+	 * @param qid     The work queue, e.g. HPWORK or LPWORK.
+	 * @param work    The work to queue.
+	 * @param worker  Called on the work queue after publications.
+	 * @param arg     Passed to worker.
+	 * @return    OK on success, ERROR otherwise with errno set accordingly.
+	 */
+	int  orb_register_work_callback(int handle, int qid, struct work_s *work, void (*worker)(void *arg), void *arg) ;
+
+	/**
+	 * Stop queueing the work registered with orb_register_work_callback().
+	 *
+	 * @param handle  A handle returned from orb_subscribe.
+	 * @return    OK on success, ERROR otherwise with errno set accordingly.
+	 */
+	int  orb_unregister_work_callback(int handle) ;
+
 	/**
 	 * Method to set the uORBCommunicator::IChannel instance.
 	 * @param comm_channel
@@ -64,6 +64,19 @@ uORB::Manager::Manager()
 
 int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
 {
+	/*
+	 * Nodes are created through the DeviceMaster, which indexes them by
+	 * metadata. Only fall back to the file system if the map overflowed.
+	 */
+	if (uORB::DeviceMaster::GetDeviceNode(meta, instance) != nullptr) {
+		return OK;
+	}
+
+	if (uORB::DeviceMaster::NodeMapComplete()) {
+		errno = ENOENT;
+		return uORB::ERROR;
+	}
+
 	/*
 	 * Generate the path to the node and try to open it.
 	 */
@@ -81,13 +94,13 @@ int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
 	return stat(path, &buffer);
 }
 
-orb_advert_t uORB::Manager::orb_advertise(const struct orb_metadata *meta, const void *data)
+orb_advert_t uORB::Manager::orb_advertise(const struct orb_metadata *meta, const void *data, unsigned int queue_size)
 {
-	return orb_advertise_multi(meta, data, nullptr, ORB_PRIO_DEFAULT);
+	return orb_advertise_multi(meta, data, nullptr, ORB_PRIO_DEFAULT, queue_size);
 }
 
 orb_advert_t uORB::Manager::orb_advertise_multi(const struct orb_metadata *meta, const void *data, int *instance,
-		int priority)
+		int priority, unsigned int queue_size)
 {
 	int result, fd;
 	orb_advert_t advertiser;
@@ -99,6 +112,15 @@ orb_advert_t uORB::Manager::orb_advertise_multi(const struct orb_metadata *meta,
 		return nullptr;
 	}
 
+	/* Set the queue size. This must be done before the first publication; thus it fails if
+	 * this is not the first advertiser.
+	 */
+	result = ioctl(fd, ORBIOCSETQUEUESIZE, (unsigned long)queue_size);
+
+	if (result < 0 && queue_size > 1) {
+		warnx("orb_advertise_multi: failed to set queue size");
+	}
+
 	/* get the advertiser handle and close the node */
 	result = ioctl(fd, ORBIOCGADVERTISER, (unsigned long)&advertiser);
 	close(fd);
@@ -156,6 +178,33 @@ int uORB::Manager::orb_copy(const struct orb_metadata *meta, int handle, void *b
 	return OK;
 }
 
+int uORB::Manager::orb_borrow(const struct orb_metadata *meta, int handle, const void **buffer)
+{
+	if (buffer == nullptr) {
+		errno = EINVAL;
+		return ERROR;
+	}
+
+	int ret = ioctl(handle, ORBIOCBORROW, (unsigned long)(uintptr_t)buffer);
+
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	return OK;
+}
+
+int uORB::Manager::orb_release(const struct orb_metadata *meta, int handle)
+{
+	int ret = ioctl(handle, ORBIOCRELEASE, 0);
+
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	return OK;
+}
+
 int uORB::Manager::orb_check(int handle, bool *updated)
 {
 	return ioctl(handle, ORBIOCUPDATED, (unsigned long)(uintptr_t)updated);
@@ -176,6 +225,40 @@ int uORB::Manager::orb_set_interval(int handle, unsigned interval)
 	return ioctl(handle, ORBIOCSETINTERVAL, interval * 1000);
 }
 
+int uORB::Manager::orb_register_work_callback(int handle, int qid, struct work_s *work, void (*worker)(void *arg),
+		void *arg)
+{
+	if (work == nullptr || worker == nullptr) {
+		errno = EINVAL;
+		return ERROR;
+	}
+
+	struct orb_work_callback callback;
+	callback.qid = qid;
+	callback.work = work;
+	callback.worker = worker;
+	callback.arg = arg;
+
+	int ret = ioctl(handle, ORBIOCREGCALLBACK, (unsigned long)(uintptr_t)&callback);
+
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	return OK;
+}
+
+int uORB::Manager::orb_unregister_work_callback(int handle)
+{
+	int ret = ioctl(handle, ORBIOCUNREGCALLBACK, 0);
+
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	return OK;
+}
+
 
 int uORB::Manager::node_advertise
 (
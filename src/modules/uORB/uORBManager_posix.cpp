@@ -66,6 +66,19 @@ uORB::Manager::Manager()
 
 int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
 {
+	/*
+	 * Nodes are created through the DeviceMaster, which indexes them by
+	 * metadata. Only fall back to the file system if the map overflowed.
+	 */
+	if (uORB::DeviceMaster::GetDeviceNode(meta, instance) != nullptr) {
+		return OK;
+	}
+
+	if (uORB::DeviceMaster::NodeMapComplete()) {
+		errno = ENOENT;
+		return uORB::ERROR;
+	}
+
 	/*
 	 * Generate the path to the node and try to open it.
 	 */
@@ -81,14 +94,14 @@ int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
 	return px4_access(path, F_OK);
 }
 
-orb_advert_t uORB::Manager::orb_advertise(const struct orb_metadata *meta, const void *data)
+orb_advert_t uORB::Manager::orb_advertise(const struct orb_metadata *meta, const void *data, unsigned int queue_size)
 {
 	//warnx("orb_advertise meta = %p", meta);
-	return orb_advertise_multi(meta, data, nullptr, ORB_PRIO_DEFAULT);
+	return orb_advertise_multi(meta, data, nullptr, ORB_PRIO_DEFAULT, queue_size);
 }
 
 orb_advert_t uORB::Manager::orb_advertise_multi(const struct orb_metadata *meta, const void *data, int *instance,
-		int priority)
+		int priority, unsigned int queue_size)
 {
 	int result, fd;
 	orb_advert_t advertiser;
@@ -103,6 +116,15 @@ orb_advert_t uORB::Manager::orb_advertise_multi(const struct orb_metadata *meta,
 		return nullptr;
 	}
 
+	/* Set the queue size. This must be done before the first publication; thus it fails if
+	 * this is not the first advertiser.
+	 */
+	result = px4_ioctl(fd, ORBIOCSETQUEUESIZE, (unsigned long)queue_size);
+
+	if (result < 0 && queue_size > 1) {
+		warnx("orb_advertise_multi: failed to set queue size");
+	}
+
 	/* get the advertiser handle and close the node */
 	result = px4_ioctl(fd, ORBIOCGADVERTISER, (unsigned long)&advertiser);
 	px4_close(fd);
@@ -162,6 +184,33 @@ int uORB::Manager::orb_copy(const struct orb_metadata *meta, int handle, void *b
 	return PX4_OK;
 }
 
+int uORB::Manager::orb_borrow(const struct orb_metadata *meta, int handle, const void **buffer)
+{
+	if (buffer == nullptr) {
+		errno = EINVAL;
+		return ERROR;
+	}
+
+	int ret = px4_ioctl(handle, ORBIOCBORROW, (unsigned long)(uintptr_t)buffer);
+
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	return PX4_OK;
+}
+
+int uORB::Manager::orb_release(const struct orb_metadata *meta, int handle)
+{
+	int ret = px4_ioctl(handle, ORBIOCRELEASE, 0);
+
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	return PX4_OK;
+}
+
 int uORB::Manager::orb_check(int handle, bool *updated)
 {
 	return px4_ioctl(handle, ORBIOCUPDATED, (unsigned long)(uintptr_t)updated);
@@ -182,6 +231,40 @@ int uORB::Manager::orb_set_interval(int handle, unsigned interval)
 	return px4_ioctl(handle, ORBIOCSETINTERVAL, interval * 1000);
 }
 
+int uORB::Manager::orb_register_work_callback(int handle, int qid, struct work_s *work, void (*worker)(void *arg),
+		void *arg)
+{
+	if (work == nullptr || worker == nullptr) {
+		errno = EINVAL;
+		return ERROR;
+	}
+
+	struct orb_work_callback callback;
+	callback.qid = qid;
+	callback.work = work;
+	callback.worker = worker;
+	callback.arg = arg;
+
+	int ret = px4_ioctl(handle, ORBIOCREGCALLBACK, (unsigned long)(uintptr_t)&callback);
+
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	return PX4_OK;
+}
+
+int uORB::Manager::orb_unregister_work_callback(int handle)
+{
+	int ret = px4_ioctl(handle, ORBIOCUNREGCALLBACK, 0);
+
+	if (ret < 0) {
+		return ERROR;
+	}
+
+	return PX4_OK;
+}
+
 
 int uORB::Manager::node_advertise
 (
@@ -0,0 +1,266 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "uORBMemPool.hpp"
+#include <px4_defines.h>
+#include <errno.h>
+#include <stdio.h>
+
+/*
+ * The size classes and how many blocks of each 'uorb start' preallocates.
+ * The counts follow the topics and subscriptions of a typical boot, the
+ * 48 and 64 byte classes hold the subscriber records.
+ */
+static const struct {
+	size_t size;
+	unsigned prealloc;
+} pool_classes[uORB::MemPool::NUM_CLASSES] = {
+	{   16,  8 },
+	{   32, 16 },
+	{   48, 32 },
+	{   64, 32 },
+	{   96, 16 },
+	{  128,  8 },
+	{  192,  4 },
+	{  256,  4 },
+	{  384,  2 },
+	{  512,  2 },
+	{  768,  1 },
+	{ 1024,  1 },
+	{ 1536,  0 },
+	{ 2048,  0 },
+};
+
+/* a class running dry grows by about this many bytes, at least one block */
+static const size_t slab_bytes = 256;
+
+/*
+ * The first slabs come from here, sized for the preallocation above. The
+ * buffers are only ever touched by memcpy, so they can live in CCM.
+ */
+static const size_t arena_bytes = 12 * 1024;
+static uint8_t arena[arena_bytes] __CCM __attribute__((aligned(8)));
+
+uORB::MemPool &uORB::MemPool::instance()
+{
+	static MemPool pool;
+	return pool;
+}
+
+uORB::MemPool::MemPool() :
+	_arena_used(0),
+	_heap_allocs(0),
+	_failures(0)
+{
+	for (unsigned i = 0; i < NUM_CLASSES; i++) {
+		_classes[i].size = pool_classes[i].size;
+		_classes[i].prealloc = pool_classes[i].prealloc;
+		_classes[i].free_list = nullptr;
+		_classes[i].total = 0;
+		_classes[i].in_use = 0;
+		_classes[i].peak = 0;
+		_classes[i].requested = 0;
+	}
+
+	sem_init(&_lock, 0, 1);
+}
+
+int uORB::MemPool::init()
+{
+	int ret = OK;
+
+	sem_wait(&_lock);
+
+	for (unsigned i = 0; i < NUM_CLASSES; i++) {
+		SizeClass &c = _classes[i];
+
+		if (c.total < c.prealloc && grow(c, c.prealloc - c.total) != OK) {
+			ret = -ENOMEM;
+		}
+	}
+
+	sem_post(&_lock);
+
+	return ret;
+}
+
+int uORB::MemPool::size_class(size_t size) const
+{
+	for (unsigned i = 0; i < NUM_CLASSES; i++) {
+		if (size <= _classes[i].size) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+int uORB::MemPool::grow(SizeClass &c, unsigned blocks)
+{
+	size_t bytes = c.size * blocks;
+	uint8_t *slab;
+
+	if (_arena_used + bytes <= arena_bytes) {
+		slab = &arena[_arena_used];
+		_arena_used += bytes;
+
+	} else {
+		slab = new uint8_t[bytes];
+	}
+
+	if (slab == nullptr) {
+		return -ENOMEM;
+	}
+
+	for (unsigned i = 0; i < blocks; i++) {
+		Block *b = (Block *)(slab + i * c.size);
+		b->next = c.free_list;
+		c.free_list = b;
+	}
+
+	c.total += blocks;
+
+	return OK;
+}
+
+void *uORB::MemPool::alloc(size_t size)
+{
+	int i = size_class(size);
+
+	if (i < 0) {
+		void *ptr = new uint8_t[size];
+
+		sem_wait(&_lock);
+
+		if (ptr == nullptr) {
+			_failures++;
+
+		} else {
+			_heap_allocs++;
+		}
+
+		sem_post(&_lock);
+
+		return ptr;
+	}
+
+	SizeClass &c = _classes[i];
+
+	sem_wait(&_lock);
+
+	if (c.free_list == nullptr) {
+		unsigned blocks = slab_bytes / c.size;
+
+		if (grow(c, blocks > 0 ? blocks : 1) != OK) {
+			_failures++;
+			sem_post(&_lock);
+			return nullptr;
+		}
+	}
+
+	Block *b = c.free_list;
+	c.free_list = b->next;
+	c.requested += size;
+
+	if (++c.in_use > c.peak) {
+		c.peak = c.in_use;
+	}
+
+	sem_post(&_lock);
+
+	return b;
+}
+
+void uORB::MemPool::free(void *ptr, size_t size)
+{
+	if (ptr == nullptr) {
+		return;
+	}
+
+	int i = size_class(size);
+
+	if (i < 0) {
+		delete[](uint8_t *)ptr;
+
+		sem_wait(&_lock);
+		_heap_allocs--;
+		sem_post(&_lock);
+		return;
+	}
+
+	SizeClass &c = _classes[i];
+
+	sem_wait(&_lock);
+
+	Block *b = (Block *)ptr;
+	b->next = c.free_list;
+	c.free_list = b;
+	c.in_use--;
+	c.requested -= size;
+
+	sem_post(&_lock);
+}
+
+void uORB::MemPool::print_status()
+{
+	size_t pool_bytes = 0;
+	size_t used_bytes = 0;
+	size_t requested_bytes = 0;
+
+	sem_wait(&_lock);
+
+	printf("size  total  in use  peak  wasted\n");
+
+	for (unsigned i = 0; i < NUM_CLASSES; i++) {
+		const SizeClass &c = _classes[i];
+
+		if (c.total == 0) {
+			continue;
+		}
+
+		printf("%4u  %5u  %6u  %4u  %6u\n", (unsigned)c.size, c.total, c.in_use, c.peak,
+		       (unsigned)(c.in_use * c.size - c.requested));
+
+		pool_bytes += c.total * c.size;
+		used_bytes += c.in_use * c.size;
+		requested_bytes += c.requested;
+	}
+
+	printf("pool %u bytes, %u in use, %u requested (%u%% internal fragmentation)\n",
+	       (unsigned)pool_bytes, (unsigned)used_bytes, (unsigned)requested_bytes,
+	       used_bytes > 0 ? (unsigned)(100 * (used_bytes - requested_bytes) / used_bytes) : 0);
+	printf("arena %u of %u bytes used, %u large blocks on the heap, %u failed allocations\n",
+	       (unsigned)_arena_used, (unsigned)arena_bytes, _heap_allocs, _failures);
+
+	sem_post(&_lock);
+}
@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef _uORBMemPool_hpp_
+#define _uORBMemPool_hpp_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <semaphore.h>
+
+namespace uORB
+{
+class MemPool;
+}
+
+/**
+ * Size-class allocator for the topic buffers and the subscriber records.
+ *
+ * Every request is rounded up to the smallest size class that fits it and
+ * served from that class's free list. Freed blocks go back on the list of
+ * their class and are never returned to the heap, so topics coming and
+ * going do not fragment it. A class which runs dry grows by a slab taken
+ * from a static arena, placed in the core coupled memory on boards with
+ * one, and from the heap once the arena is used up. Requests larger than
+ * the largest class go to the heap directly.
+ */
+class uORB::MemPool
+{
+public:
+	static MemPool &instance();
+
+	/**
+	 * Preallocate the slabs of the size classes, called by 'uorb start'.
+	 *
+	 * @return OK, or -ENOMEM if the heap could not provide them
+	 */
+	int init();
+
+	/**
+	 * Allocate a block of at least size bytes.
+	 *
+	 * @return the block, or nullptr if out of memory
+	 */
+	void *alloc(size_t size);
+
+	/**
+	 * Return a block obtained from alloc().
+	 *
+	 * @param ptr	the block, may be nullptr
+	 * @param size	the size passed to alloc()
+	 */
+	void free(void *ptr, size_t size);
+
+	/**
+	 * Print the usage of every size class and the internal fragmentation.
+	 */
+	void print_status();
+
+	static const unsigned NUM_CLASSES = 14;
+
+private:
+	MemPool();
+	MemPool(const MemPool &);
+	MemPool &operator=(const MemPool &);
+
+	struct Block {
+		Block *next;
+	};
+
+	struct SizeClass {
+		size_t size;		/**< block size */
+		unsigned prealloc;	/**< blocks preallocated by init() */
+		Block *free_list;	/**< blocks available */
+		unsigned total;		/**< blocks owned by the class */
+		unsigned in_use;	/**< blocks handed out */
+		unsigned peak;		/**< highest in_use seen */
+		size_t requested;	/**< bytes asked for by the blocks in use */
+	};
+
+	int size_class(size_t size) const;
+	int grow(SizeClass &c, unsigned blocks);
+
+	SizeClass _classes[NUM_CLASSES];
+	size_t _arena_used;	/**< bytes of the static arena handed to slabs */
+	unsigned _heap_allocs;	/**< requests larger than the largest class */
+	unsigned _failures;	/**< requests which could not be served */
+	sem_t _lock;
+};
+
+#endif // _uORBMemPool_hpp_
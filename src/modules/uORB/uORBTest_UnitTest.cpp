@@ -35,7 +35,9 @@
 #include "uORBCommon.hpp"
 #include <px4_config.h>
 #include <px4_time.h>
+#include <px4_workqueue.h>
 #include <stdio.h>
+#include <string.h>
 
 uORBTest::UnitTest &uORBTest::UnitTest::instance()
 {
@@ -158,6 +160,36 @@ int uORBTest::UnitTest::test()
 		return ret;
 	}
 
+	ret = test_queue();
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	ret = test_borrow();
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	ret = test_callback();
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	ret = test_interval();
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	ret = test_consistency();
+
+	if (ret != OK) {
+		return ret;
+	}
+
 	return OK;
 }
 
@@ -392,6 +424,561 @@ int uORBTest::UnitTest::test_multi_reversed()
 	return test_note("PASS multi-topic reversed");
 }
 
+int uORBTest::UnitTest::test_queue()
+{
+	test_note("try queued topic support");
+
+	struct orb_test_medium t, u;
+	int sfd;
+	orb_advert_t ptopic;
+	bool updated;
+
+	/* subscribe first, so the node exists before the queue size is set */
+	sfd = orb_subscribe(ORB_ID(orb_test_medium_queue));
+
+	if (sfd < 0) {
+		return test_fail("subscribe failed: %d", errno);
+	}
+
+	const int queue_size = 11;
+	t.val = 0;
+	ptopic = orb_advertise_queue(ORB_ID(orb_test_medium_queue), &t, queue_size);
+
+	if (ptopic == nullptr) {
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	orb_check(sfd, &updated);
+
+	if (!updated) {
+		return test_fail("update flag not set");
+	}
+
+	if (PX4_OK != orb_copy(ORB_ID(orb_test_medium_queue), sfd, &u)) {
+		return test_fail("copy(1) failed: %d", errno);
+	}
+
+	if (u.val != t.val) {
+		return test_fail("copy(1) mismatch: %d expected %d", u.val, t.val);
+	}
+
+	orb_check(sfd, &updated);
+
+	if (updated) {
+		return test_fail("spurious updated flag");
+	}
+
+	/* publish fewer elements than the queue can hold, all must be delivered in order */
+	for (int i = 1; i <= 5; ++i) {
+		t.val = i;
+		orb_publish(ORB_ID(orb_test_medium_queue), ptopic, &t);
+	}
+
+	for (int i = 1; i <= 5; ++i) {
+		orb_check(sfd, &updated);
+
+		if (!updated) {
+			return test_fail("update flag not set, element %i", i);
+		}
+
+		orb_copy(ORB_ID(orb_test_medium_queue), sfd, &u);
+
+		if (u.val != i) {
+			return test_fail("queue mismatch: %d expected %d", u.val, i);
+		}
+	}
+
+	orb_check(sfd, &updated);
+
+	if (updated) {
+		return test_fail("spurious updated flag after draining the queue");
+	}
+
+	/* overflow the queue: the oldest elements are dropped */
+	const int overflow = 3;
+
+	for (int i = 0; i < queue_size + overflow; ++i) {
+		t.val = 100 + i;
+		orb_publish(ORB_ID(orb_test_medium_queue), ptopic, &t);
+	}
+
+	for (int i = overflow; i < queue_size + overflow; ++i) {
+		orb_check(sfd, &updated);
+
+		if (!updated) {
+			return test_fail("update flag not set, element %i", i);
+		}
+
+		orb_copy(ORB_ID(orb_test_medium_queue), sfd, &u);
+
+		if (u.val != 100 + i) {
+			return test_fail("queue overflow mismatch: %d expected %d", u.val, 100 + i);
+		}
+	}
+
+	orb_check(sfd, &updated);
+
+	if (updated) {
+		return test_fail("spurious updated flag after overflow");
+	}
+
+	/* copying without an update returns the latest element again */
+	orb_copy(ORB_ID(orb_test_medium_queue), sfd, &u);
+
+	if (u.val != 100 + queue_size + overflow - 1) {
+		return test_fail("re-copy mismatch: %d", u.val);
+	}
+
+	orb_unsubscribe(sfd);
+
+	return test_note("PASS queued topic test");
+}
+
+int uORBTest::UnitTest::test_borrow()
+{
+	test_note("try borrowing topic data");
+
+	struct orb_test_large t;
+	const struct orb_test_large *b;
+	const void *ptr;
+	bool updated;
+
+	memset(&t, 0, sizeof(t));
+	t.val = 1;
+	orb_advert_t ptopic = orb_advertise(ORB_ID(orb_test_large), &t);
+
+	if (ptopic == nullptr) {
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	int sfd = orb_subscribe(ORB_ID(orb_test_large));
+
+	if (sfd < 0) {
+		return test_fail("subscribe failed: %d", errno);
+	}
+
+	t.val = 2;
+	orb_publish(ORB_ID(orb_test_large), ptopic, &t);
+
+	if (PX4_OK != orb_borrow(ORB_ID(orb_test_large), sfd, &ptr)) {
+		return test_fail("borrow(1) failed: %d", errno);
+	}
+
+	b = (const struct orb_test_large *)ptr;
+
+	if (b->val != t.val) {
+		return test_fail("borrow(1) mismatch: %d expected %d", b->val, t.val);
+	}
+
+	/* a second borrow on the same handle must be rejected */
+	if (PX4_OK == orb_borrow(ORB_ID(orb_test_large), sfd, &ptr)) {
+		return test_fail("nested borrow succeeded");
+	}
+
+	if (PX4_OK != orb_release(ORB_ID(orb_test_large), sfd)) {
+		return test_fail("release(1) failed: %d", errno);
+	}
+
+	orb_check(sfd, &updated);
+
+	if (updated) {
+		return test_fail("borrow did not clear the updated flag");
+	}
+
+	/* publishing while the data is borrowed invalidates it */
+	if (PX4_OK != orb_borrow(ORB_ID(orb_test_large), sfd, &ptr)) {
+		return test_fail("borrow(2) failed: %d", errno);
+	}
+
+	t.val = 3;
+	orb_publish(ORB_ID(orb_test_large), ptopic, &t);
+
+	if (PX4_OK == orb_release(ORB_ID(orb_test_large), sfd)) {
+		return test_fail("release(2) did not detect the overwrite");
+	}
+
+	orb_unsubscribe(sfd);
+
+	return test_note("PASS borrow test");
+}
+
+void uORBTest::UnitTest::callback_worker(void *arg)
+{
+	uORBTest::UnitTest *t = (uORBTest::UnitTest *)arg;
+	struct orb_test u;
+	bool updated;
+
+	while (orb_check(t->callback_sub, &updated) == PX4_OK && updated) {
+		orb_copy(ORB_ID(orb_test_callback), t->callback_sub, &u);
+		t->callback_val = u.val;
+		t->callback_count++;
+	}
+}
+
+int uORBTest::UnitTest::test_callback()
+{
+	test_note("try work queue callbacks");
+
+	static struct work_s work;
+	struct orb_test t;
+
+	memset(&work, 0, sizeof(work));
+	t.val = 0;
+	orb_advert_t ptopic = orb_advertise(ORB_ID(orb_test_callback), &t);
+
+	if (ptopic == nullptr) {
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	callback_sub = orb_subscribe(ORB_ID(orb_test_callback));
+	callback_count = 0;
+	callback_val = -1;
+
+	/* the advertised data is not consumed by a publication */
+	orb_copy(ORB_ID(orb_test_callback), callback_sub, &t);
+
+	if (PX4_OK != orb_register_work_callback(callback_sub, LPWORK, &work, callback_worker, this)) {
+		return test_fail("register failed: %d", errno);
+	}
+
+	if (PX4_OK == orb_register_work_callback(callback_sub, LPWORK, &work, callback_worker, this)) {
+		return test_fail("second register succeeded");
+	}
+
+	for (int i = 1; i <= 3; i++) {
+		t.val = i;
+		orb_publish(ORB_ID(orb_test_callback), ptopic, &t);
+
+		for (int wait = 0; wait < 100 && callback_val != i; wait++) {
+			usleep(10000);
+		}
+
+		if (callback_val != i) {
+			return test_fail("callback missed publication %d", i);
+		}
+	}
+
+	if (PX4_OK != orb_unregister_work_callback(callback_sub)) {
+		return test_fail("unregister failed: %d", errno);
+	}
+
+	unsigned count = callback_count;
+	t.val = 4;
+	orb_publish(ORB_ID(orb_test_callback), ptopic, &t);
+	usleep(50000);
+
+	if (callback_count != count) {
+		return test_fail("callback after unregister");
+	}
+
+	orb_unsubscribe(callback_sub);
+
+	return test_note("PASS callback test");
+}
+
+int uORBTest::UnitTest::test_interval()
+{
+	test_note("try rate-limited subscribers");
+
+	struct orb_test t, u;
+	bool updated;
+
+	t.val = 0;
+	orb_advert_t ptopic = orb_advertise_queue(ORB_ID(orb_test_interval), &t, 4);
+
+	if (ptopic == nullptr) {
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	int sfd = orb_subscribe(ORB_ID(orb_test_interval));
+	orb_set_interval(sfd, 20);
+	orb_copy(ORB_ID(orb_test_interval), sfd, &u);
+
+	for (int i = 1; i <= 3; i++) {
+		t.val = i;
+		orb_publish(ORB_ID(orb_test_interval), ptopic, &t);
+	}
+
+	orb_check(sfd, &updated);
+
+	if (updated) {
+		return test_fail("update within the interval");
+	}
+
+	usleep(25000);
+	orb_check(sfd, &updated);
+
+	if (!updated) {
+		return test_fail("missing update after the interval");
+	}
+
+	/* the queued elements in between are skipped */
+	orb_copy(ORB_ID(orb_test_interval), sfd, &u);
+
+	if (u.val != 3) {
+		return test_fail("got %d instead of the latest element", u.val);
+	}
+
+	t.val = 4;
+	orb_publish(ORB_ID(orb_test_interval), ptopic, &t);
+	orb_check(sfd, &updated);
+
+	if (updated) {
+		return test_fail("interval did not restart with the read");
+	}
+
+	orb_unsubscribe(sfd);
+
+	return test_note("PASS interval test");
+}
+
+int uORBTest::UnitTest::consistency_pub_main(void)
+{
+	struct orb_test_large t;
+	memset(&t, 0, sizeof(t));
+
+	orb_advert_t ptopic = orb_advertise(ORB_ID(orb_test_large_concurrent), &t);
+
+	/* every publication carries a uniform pattern, so a torn copy is easy to spot */
+	for (int i = 1; i <= 2000 && ptopic != nullptr; i++) {
+		t.val = i;
+		memset(t.junk, i & 0xff, sizeof(t.junk));
+		orb_publish(ORB_ID(orb_test_large_concurrent), ptopic, &t);
+
+		if (i % 8 == 0) {
+			usleep(100);
+		}
+	}
+
+	consistency_pub_done = true;
+	return 0;
+}
+
+int uORBTest::UnitTest::test_consistency()
+{
+	test_note("try lock-free reads with a concurrent publisher");
+
+	struct orb_test_large u;
+	char *const args[1] = { NULL };
+	unsigned reads = 0;
+
+	int sfd = orb_subscribe(ORB_ID(orb_test_large_concurrent));
+
+	if (sfd < 0) {
+		return test_fail("subscribe failed: %d", errno);
+	}
+
+	consistency_pub_done = false;
+
+	int pub_task = px4_task_spawn_cmd("uorb_consistency",
+					  SCHED_DEFAULT,
+					  SCHED_PRIORITY_DEFAULT,
+					  1500,
+					  (px4_main_t)&uORBTest::UnitTest::consistency_pub_threadEntry,
+					  args);
+
+	if (pub_task < 0) {
+		orb_unsubscribe(sfd);
+		return test_fail("failed launching task");
+	}
+
+	while (!consistency_pub_done) {
+		if (PX4_OK != orb_copy(ORB_ID(orb_test_large_concurrent), sfd, &u)) {
+			usleep(100);
+			continue;
+		}
+
+		for (unsigned i = 0; i < sizeof(u.junk); i++) {
+			if (u.junk[i] != (char)(u.val & 0xff)) {
+				orb_unsubscribe(sfd);
+				return test_fail("torn read: val %d, junk[%u] = %d", u.val, i, (int)u.junk[i]);
+			}
+		}
+
+		reads++;
+	}
+
+	orb_unsubscribe(sfd);
+
+	test_note("%u consistent reads", reads);
+
+	return test_note("PASS consistency test");
+}
+
+int uORBTest::UnitTest::consistency_pub_threadEntry(char *const argv[])
+{
+	uORBTest::UnitTest &t = uORBTest::UnitTest::instance();
+	return t.consistency_pub_main();
+}
+
+int uORBTest::UnitTest::perf()
+{
+	test_note("---------------- PERF ------------------");
+
+	int ret = perf_copy<struct orb_test>(ORB_ID(orb_perf), "small");
+
+	if (ret == OK) {
+		ret = perf_copy<struct orb_test_medium>(ORB_ID(orb_perf_medium), "medium");
+	}
+
+	if (ret == OK) {
+		ret = perf_copy<struct orb_test_large>(ORB_ID(orb_perf_large), "large");
+	}
+
+	if (ret == OK) {
+		ret = perf_subscribers();
+	}
+
+	if (ret == OK) {
+		ret = perf_wakeup();
+	}
+
+	return ret;
+}
+
+int uORBTest::UnitTest::perf_subscribers()
+{
+	const unsigned runs = 1000;
+	const unsigned max_subs = 16;
+	int sfd[max_subs];
+	unsigned subs = 0;
+	struct orb_test_medium t;
+	memset(&t, 0, sizeof(t));
+
+	/* the topic is advertised by perf_copy() already */
+	orb_advert_t ptopic = orb_advertise(ORB_ID(orb_perf_medium), &t);
+
+	if (ptopic == nullptr) {
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	/* every subscriber is notified on publish, so the cost grows with their number */
+	for (unsigned n = 1; n <= max_subs; n *= 4) {
+		while (subs < n) {
+			sfd[subs] = orb_subscribe(ORB_ID(orb_perf_medium));
+
+			if (sfd[subs] < 0) {
+				for (unsigned i = 0; i < subs; i++) {
+					orb_unsubscribe(sfd[i]);
+				}
+
+				return test_fail("subscribe %u failed: %d", subs, errno);
+			}
+
+			subs++;
+		}
+
+		hrt_abstime start = hrt_absolute_time();
+
+		for (unsigned i = 0; i < runs; i++) {
+			t.val = i;
+			orb_publish(ORB_ID(orb_perf_medium), ptopic, &t);
+		}
+
+		test_note("%2u subscribers: publish %.2f us", subs, (double)hrt_elapsed_time(&start) / runs);
+	}
+
+	for (unsigned i = 0; i < subs; i++) {
+		orb_unsubscribe(sfd[i]);
+	}
+
+	return OK;
+}
+
+int uORBTest::UnitTest::perf_pub_main(void)
+{
+	struct orb_test t;
+	memset(&t, 0, sizeof(t));
+
+	orb_advert_t ptopic = orb_advertise(ORB_ID(orb_perf_wakeup), &t);
+
+	/* publish at 1 kHz, the stamp is taken right before the publication */
+	for (int i = 0; i < 1000 && ptopic != nullptr; i++) {
+		usleep(1000);
+		t.val = i;
+		t.time = hrt_absolute_time();
+		orb_publish(ORB_ID(orb_perf_wakeup), ptopic, &t);
+	}
+
+	perf_pub_done = true;
+	return 0;
+}
+
+int uORBTest::UnitTest::perf_wakeup()
+{
+	char *const args[1] = { NULL };
+	struct orb_test t;
+	unsigned wakeups = 0;
+	hrt_abstime latency_min = UINT64_MAX;
+	hrt_abstime latency_max = 0;
+	uint64_t latency_sum = 0;
+
+	int sfd = orb_subscribe(ORB_ID(orb_perf_wakeup));
+
+	if (sfd < 0) {
+		return test_fail("subscribe failed: %d", errno);
+	}
+
+	perf_pub_done = false;
+
+	/* the publisher runs below our priority, so the publication preempts it
+	 * and the measured time is the one from orb_publish() to poll() returning */
+	int pub_task = px4_task_spawn_cmd("uorb_perf",
+					  SCHED_DEFAULT,
+					  SCHED_PRIORITY_DEFAULT - 10,
+					  1500,
+					  (px4_main_t)&uORBTest::UnitTest::perf_pub_threadEntry,
+					  args);
+
+	if (pub_task < 0) {
+		orb_unsubscribe(sfd);
+		return test_fail("failed launching task");
+	}
+
+	px4_pollfd_struct_t fds[1];
+	fds[0].fd = sfd;
+	fds[0].events = POLLIN;
+
+	while (!perf_pub_done) {
+		int pret = px4_poll(&fds[0], 1, 100);
+
+		if (pret <= 0 || !(fds[0].revents & POLLIN)) {
+			continue;
+		}
+
+		hrt_abstime now = hrt_absolute_time();
+		orb_copy(ORB_ID(orb_perf_wakeup), sfd, &t);
+
+		hrt_abstime latency = now - t.time;
+		latency_sum += latency;
+		wakeups++;
+
+		if (latency < latency_min) {
+			latency_min = latency;
+		}
+
+		if (latency > latency_max) {
+			latency_max = latency;
+		}
+	}
+
+	orb_unsubscribe(sfd);
+
+	if (wakeups == 0) {
+		return test_fail("no wakeups");
+	}
+
+	return test_note("poll wakeup: %u samples, min %llu us, mean %.1f us, max %llu us", wakeups,
+			 (unsigned long long)latency_min, (double)latency_sum / wakeups,
+			 (unsigned long long)latency_max);
+}
+
+int uORBTest::UnitTest::perf_pub_threadEntry(char *const argv[])
+{
+	uORBTest::UnitTest &t = uORBTest::UnitTest::instance();
+	return t.perf_pub_main();
+}
+
 int uORBTest::UnitTest::test_fail(const char *fmt, ...)
 {
 	va_list ap;
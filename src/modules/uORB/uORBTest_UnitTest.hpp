@@ -43,6 +43,10 @@ struct orb_test {
 };
 ORB_DEFINE(orb_test, struct orb_test);
 ORB_DEFINE(orb_multitest, struct orb_test);
+ORB_DEFINE(orb_test_callback, struct orb_test);
+ORB_DEFINE(orb_test_interval, struct orb_test);
+ORB_DEFINE(orb_perf, struct orb_test);
+ORB_DEFINE(orb_perf_wakeup, struct orb_test);
 
 struct orb_test_medium {
 	int val;
@@ -50,6 +54,8 @@ struct orb_test_medium {
 	char junk[64];
 };
 ORB_DEFINE(orb_test_medium, struct orb_test_medium);
+ORB_DEFINE(orb_test_medium_queue, struct orb_test_medium);
+ORB_DEFINE(orb_perf_medium, struct orb_test_medium);
 
 struct orb_test_large {
 	int val;
@@ -57,6 +63,8 @@ struct orb_test_large {
 	char junk[512];
 };
 ORB_DEFINE(orb_test_large, struct orb_test_large);
+ORB_DEFINE(orb_test_large_concurrent, struct orb_test_large);
+ORB_DEFINE(orb_perf_large, struct orb_test_large);
 
 
 namespace uORBTest
@@ -74,9 +82,11 @@ public:
 	int test();
 	template<typename S> int latency_test(orb_id_t T, bool print);
 	int info();
+	int perf();
 
 private:
-	UnitTest() : pubsubtest_passed(false), pubsubtest_print(false) {}
+	UnitTest() : pubsubtest_passed(false), pubsubtest_print(false), consistency_pub_done(false),
+		callback_sub(-1), callback_val(0), callback_count(0), perf_pub_done(false) {}
 
 	// Disallow copy
 	UnitTest(const uORBTest::UnitTest &) {};
@@ -90,6 +100,28 @@ private:
 	int test_single();
 	int test_multi();
 	int test_multi_reversed();
+	int test_queue();
+	int test_borrow();
+	int test_callback();
+	int test_interval();
+	int test_consistency();
+
+	static int consistency_pub_threadEntry(char *const argv[]);
+	int consistency_pub_main(void);
+	volatile bool consistency_pub_done;
+
+	static void callback_worker(void *arg);
+	int callback_sub;
+	volatile int callback_val;
+	volatile unsigned callback_count;
+
+	template<typename S> int perf_copy(orb_id_t T, const char *name);
+	int perf_subscribers();
+	int perf_wakeup();
+
+	static int perf_pub_threadEntry(char *const argv[]);
+	int perf_pub_main(void);
+	volatile bool perf_pub_done;
 
 	int test_fail(const char *fmt, ...);
 	int test_note(const char *fmt, ...);
@@ -142,4 +174,46 @@ int uORBTest::UnitTest::latency_test(orb_id_t T, bool print)
 	return pubsubtest_res;
 }
 
+template<typename S>
+int uORBTest::UnitTest::perf_copy(orb_id_t T, const char *name)
+{
+	const unsigned runs = 1000;
+	S t;
+	memset(&t, 0, sizeof(t));
+
+	orb_advert_t ptopic = orb_advertise(T, &t);
+
+	if (ptopic == nullptr) {
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	int sfd = orb_subscribe(T);
+
+	if (sfd < 0) {
+		return test_fail("subscribe failed: %d", errno);
+	}
+
+	hrt_abstime start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < runs; i++) {
+		t.val = i;
+		orb_publish(T, ptopic, &t);
+	}
+
+	hrt_abstime publish_time = hrt_elapsed_time(&start);
+
+	start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < runs; i++) {
+		orb_copy(T, sfd, &t);
+	}
+
+	hrt_abstime copy_time = hrt_elapsed_time(&start);
+
+	orb_unsubscribe(sfd);
+
+	return test_note("%-6s %4u bytes: publish %.2f us, copy %.2f us", name, (unsigned)sizeof(S),
+			 (double)publish_time / runs, (double)copy_time / runs);
+}
+
 #endif // _uORBTest_UnitTest_hpp_
@@ -39,6 +39,7 @@
 
 #include "esc.hpp"
 #include <systemlib/err.h>
+#include <systemlib/param/param.h>
 
 
 #define MOTOR_BIT(x) (1<<(x))
@@ -74,6 +75,8 @@ int UavcanEscController::init()
 		return res;
 	}
 
+	(void)param_get(param_find("UAVCAN_ESC_SAT"), &_sat_power_pct);
+
 	// ESC status will be relayed from UAVCAN bus into ORB at this rate
 	_orb_timer.setCallback(TimerCbBinder(this, &UavcanEscController::orb_pub_timer_cb));
 	_orb_timer.startPeriodic(uavcan::MonotonicDuration::fromMSec(1000 / ESC_STATUS_UPDATE_RATE_HZ));
@@ -180,11 +183,65 @@ void UavcanEscController::esc_status_sub_cb(const uavcan::ReceivedDataStructure<
 		ref.esc_setpoint    = msg.power_rating_pct;
 		ref.esc_rpm         = msg.rpm;
 		ref.esc_errorcount  = msg.error_count;
+
+		/*
+		 * Only the latest report of each ESC is kept, the timer publishes
+		 * them together at a fixed rate however fast the ESCs report.
+		 */
+		_esc_updated_mask |= MOTOR_BIT(msg.esc_index);
+
+		if (_sat_power_pct > 0) {
+			update_motor_limits(msg.esc_index);
+		}
+	}
+}
+
+void UavcanEscController::update_motor_limits(unsigned esc_index)
+{
+	static const unsigned cmd_max = uavcan::equipment::esc::RawCommand::FieldTypes::cmd::RawValueType::max();
+
+	const auto &ref = _esc_status.esc[esc_index];
+	const bool armed = (_armed_mask & MOTOR_BIT(esc_index)) != 0;
+
+	/*
+	 * An ESC is at its upper limit when it runs at the configured share of
+	 * its power rating or is commanded to full scale, and at its lower limit
+	 * when it is commanded to zero or has stopped spinning.
+	 */
+	const bool upper = armed && ((ref.esc_setpoint >= (float)_sat_power_pct) || (ref.esc_setpoint_raw >= cmd_max));
+	const bool lower = armed && ((ref.esc_setpoint_raw == 0) || (ref.esc_rpm == 0));
+
+	const uint8_t upper_mask = upper ? (_upper_limit_mask | MOTOR_BIT(esc_index)) :
+				   (_upper_limit_mask & ~MOTOR_BIT(esc_index));
+	const uint8_t lower_mask = lower ? (_lower_limit_mask | MOTOR_BIT(esc_index)) :
+				   (_lower_limit_mask & ~MOTOR_BIT(esc_index));
+
+	if ((upper_mask == _upper_limit_mask) && (lower_mask == _lower_limit_mask) && (_motor_limits_pub != nullptr)) {
+		return;
+	}
+
+	_upper_limit_mask = upper_mask;
+	_lower_limit_mask = lower_mask;
+
+	_motor_limits.upper_limit = (_upper_limit_mask != 0);
+	_motor_limits.lower_limit = (_lower_limit_mask != 0);
+
+	if (_motor_limits_pub != nullptr) {
+		(void)orb_publish(ORB_ID(multirotor_motor_limits), _motor_limits_pub, &_motor_limits);
+
+	} else {
+		_motor_limits_pub = orb_advertise(ORB_ID(multirotor_motor_limits), &_motor_limits);
 	}
 }
 
 void UavcanEscController::orb_pub_timer_cb(const uavcan::TimerEvent &)
 {
+	if (_esc_updated_mask == 0) {
+		return;
+	}
+
+	_esc_updated_mask = 0;
+
 	_esc_status.counter += 1;
 	_esc_status.esc_connectiontype = esc_status_s::ESC_CONNECTION_TYPE_CAN;
 
@@ -49,6 +49,7 @@
 #include <uavcan/equipment/esc/Status.hpp>
 #include <systemlib/perf_counter.h>
 #include <uORB/topics/esc_status.h>
+#include <uORB/topics/multirotor_motor_limits.h>
 
 
 class UavcanEscController
@@ -75,6 +76,12 @@ private:
 	 */
 	void orb_pub_timer_cb(const uavcan::TimerEvent &event);
 
+	/**
+	 * Derives the motor limits from the telemetry of one ESC and publishes
+	 * them as soon as they change, without waiting for the status timer.
+	 */
+	void update_motor_limits(unsigned esc_index);
+
 
 	static constexpr unsigned MAX_RATE_HZ = 200;			///< XXX make this configurable
 	static constexpr unsigned ESC_STATUS_UPDATE_RATE_HZ = 10;
@@ -89,6 +96,13 @@ private:
 	bool		_armed = false;
 	esc_status_s	_esc_status = {};
 	orb_advert_t	_esc_status_pub = nullptr;
+	uint8_t		_esc_updated_mask = 0;		///< ESCs reported since the last esc_status publication
+
+	int32_t				_sat_power_pct = 0;	///< UAVCAN_ESC_SAT, 0 disables the motor limits
+	uint8_t				_upper_limit_mask = 0;
+	uint8_t				_lower_limit_mask = 0;
+	multirotor_motor_limits_s	_motor_limits = {};
+	orb_advert_t			_motor_limits_pub = nullptr;
 
 	/*
 	 * libuavcan related things
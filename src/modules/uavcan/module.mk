@@ -45,6 +45,7 @@ WFRAME_LARGER_THAN = 1400
 # Main
 SRCS += uavcan_main.cpp              \
 	uavcan_servers.cpp           \
+	uavcan_file_server_backend.cpp \
         uavcan_clock.cpp             \
         uavcan_params.c
 
@@ -42,7 +42,7 @@
 const char *const UavcanMagnetometerBridge::NAME = "mag";
 
 UavcanMagnetometerBridge::UavcanMagnetometerBridge(uavcan::INode &node) :
-	UavcanCDevSensorBridgeBase("uavcan_mag", "/dev/uavcan/mag", MAG_BASE_DEVICE_PATH, ORB_ID(sensor_mag)),
+	UavcanCDevSensorBridgeBase(node, "uavcan_mag", "/dev/uavcan/mag", MAG_BASE_DEVICE_PATH, ORB_ID(sensor_mag)),
 	_sub_mag(node)
 {
 	_device_id.devid_s.devtype = DRV_MAG_DEVTYPE_HMC5883;     // <-- Why?
@@ -153,5 +153,5 @@ void UavcanMagnetometerBridge::mag_sub_cb(const uavcan::ReceivedDataStructure<ua
 	_report.z = (msg.magnetic_field_ga[2] - _scale.z_offset) * _scale.z_scale;
 	unlock();
 
-	publish(msg.getSrcNodeID().get(), &_report);
+	publish(msg.getSrcNodeID().get(), &_report, msg.getMonotonicTimestamp().toUSec());
 }
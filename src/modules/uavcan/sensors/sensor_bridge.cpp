@@ -37,6 +37,9 @@
 
 #include "sensor_bridge.hpp"
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <systemlib/param/param.h>
 
 #include "gnss.hpp"
 #include "mag.hpp"
@@ -55,6 +58,32 @@ void IUavcanSensorBridge::make_all(uavcan::INode &node, List<IUavcanSensorBridge
 /*
  * UavcanCDevSensorBridgeBase
  */
+UavcanCDevSensorBridgeBase::UavcanCDevSensorBridgeBase(uavcan::INode &node, const char *name, const char *devname,
+		const char *class_devname, const orb_id_t orb_topic_sensor,
+		const unsigned max_channels) :
+	device::CDev(name, devname),
+	_max_channels(max_channels),
+	_class_devname(class_devname),
+	_orb_topic(orb_topic_sensor),
+	_channels(new Channel[max_channels]),
+	_pending_reports(new uint8_t[max_channels * orb_topic_sensor->o_size]),
+	_publish_timer(node)
+{
+	_device_id.devid_s.bus_type = DeviceBusType_UAVCAN;
+	_device_id.devid_s.bus = 0;
+
+	int32_t window = 0;
+	(void)param_get(param_find("UAVCAN_SENS_WIN"), &window);
+	_publish_window_ms = (window > 0) ? window : 0;
+
+	_publish_timer.setCallback(TimerCbBinder(this, &UavcanCDevSensorBridgeBase::publish_timer_cb));
+
+	snprintf(_perf_rx_name, sizeof(_perf_rx_name), "%s_rx", name);
+	snprintf(_perf_latency_name, sizeof(_perf_latency_name), "%s_latency", name);
+	_perf_rx = perf_alloc(PC_COUNT, _perf_rx_name);
+	_perf_latency = perf_alloc(PC_LATENCY, _perf_latency_name);
+}
+
 UavcanCDevSensorBridgeBase::~UavcanCDevSensorBridgeBase()
 {
 	for (unsigned i = 0; i < _max_channels; i++) {
@@ -64,9 +93,13 @@ UavcanCDevSensorBridgeBase::~UavcanCDevSensorBridgeBase()
 	}
 
 	delete [] _channels;
+	delete [] _pending_reports;
+
+	perf_free(_perf_rx);
+	perf_free(_perf_latency);
 }
 
-void UavcanCDevSensorBridgeBase::publish(const int node_id, const void *report)
+void UavcanCDevSensorBridgeBase::publish(const int node_id, const void *report, hrt_abstime timestamp_rx)
 {
 	assert(report != nullptr);
 
@@ -133,7 +166,45 @@ void UavcanCDevSensorBridgeBase::publish(const int node_id, const void *report)
 
 	assert(channel != nullptr);
 
-	(void)orb_publish(_orb_topic, channel->orb_advert, report);
+	perf_count(_perf_rx);
+
+	if (_publish_window_ms == 0) {
+		publish_channel(*channel, report, timestamp_rx);
+		return;
+	}
+
+	// Hold back the latest report, the first one of a window starts the timer
+	const unsigned index = channel - _channels;
+	memcpy(&_pending_reports[index * _orb_topic->o_size], report, _orb_topic->o_size);
+
+	if (!channel->pending) {
+		channel->pending = true;
+		channel->timestamp_rx = timestamp_rx;
+	}
+
+	if (!_publish_timer.isRunning()) {
+		_publish_timer.startOneShotWithDelay(uavcan::MonotonicDuration::fromMSec(_publish_window_ms));
+	}
+}
+
+void UavcanCDevSensorBridgeBase::publish_channel(Channel &channel, const void *report, hrt_abstime timestamp_rx)
+{
+	(void)orb_publish(_orb_topic, channel.orb_advert, report);
+
+	if (timestamp_rx != 0) {
+		perf_set(_perf_latency, hrt_elapsed_time(&timestamp_rx));
+	}
+}
+
+void UavcanCDevSensorBridgeBase::publish_timer_cb(const uavcan::TimerEvent &)
+{
+	// Publish all channels of this window back to back
+	for (unsigned i = 0; i < _max_channels; i++) {
+		if (_channels[i].pending) {
+			_channels[i].pending = false;
+			publish_channel(_channels[i], &_pending_reports[i * _orb_topic->o_size], _channels[i].timestamp_rx);
+		}
+	}
 }
 
 unsigned UavcanCDevSensorBridgeBase::get_num_redundant_channels() const
@@ -152,6 +223,7 @@ unsigned UavcanCDevSensorBridgeBase::get_num_redundant_channels() const
 void UavcanCDevSensorBridgeBase::print_status() const
 {
 	printf("devname: %s\n", _class_devname);
+	printf("publication window: %u ms\n", _publish_window_ms);
 
 	for (unsigned i = 0; i < _max_channels; i++) {
 		if (_channels[i].node_id >= 0) {
@@ -41,6 +41,8 @@
 #include <uavcan/uavcan.hpp>
 #include <drivers/device/device.h>
 #include <drivers/drv_orb_dev.h>
+#include <drivers/drv_hrt.h>
+#include <systemlib/perf_counter.h>
 
 /**
  * A sensor bridge class must implement this interface.
@@ -83,6 +85,9 @@ public:
 /**
  * This is the base class for redundant sensors with an independent ORB topic per each redundancy channel.
  * For example, sensor_mag0, sensor_mag1, etc.
+ *
+ * With UAVCAN_SENS_WIN set, the latest report of each channel is held back and all channels
+ * are published together once per window, instead of one publication per received message.
  */
 class UavcanCDevSensorBridgeBase : public IUavcanSensorBridge, public device::CDev
 {
@@ -91,37 +96,46 @@ class UavcanCDevSensorBridgeBase : public IUavcanSensorBridge, public device::CD
 		orb_advert_t orb_advert  = nullptr;
 		int class_instance       = -1;
 		int orb_instance	 = -1;
+		bool pending             = false;	///< a report is held back until the window ends
+		hrt_abstime timestamp_rx = 0;		///< reception time of the held back report
 	};
 
+	typedef uavcan::MethodBinder<UavcanCDevSensorBridgeBase *,
+		void (UavcanCDevSensorBridgeBase::*)(const uavcan::TimerEvent &)> TimerCbBinder;
+
 	const unsigned _max_channels;
 	const char *const _class_devname;
 	const orb_id_t _orb_topic;
 	Channel *const _channels;
+	uint8_t *const _pending_reports;	///< one report of _orb_topic->o_size bytes per channel
 	bool _out_of_channels = false;
 
+	unsigned _publish_window_ms = 0;	///< UAVCAN_SENS_WIN, 0 publishes every report immediately
+	uavcan::TimerEventForwarder<TimerCbBinder> _publish_timer;
+
+	char _perf_rx_name[32];
+	char _perf_latency_name[32];
+	perf_counter_t _perf_rx;		///< received reports
+	perf_counter_t _perf_latency;		///< time from the reception of a report to its publication
+
+	void publish_channel(Channel &channel, const void *report, hrt_abstime timestamp_rx);
+	void publish_timer_cb(const uavcan::TimerEvent &);
+
 protected:
 	static constexpr unsigned DEFAULT_MAX_CHANNELS = 5; // 640 KB ought to be enough for anybody
 
-	UavcanCDevSensorBridgeBase(const char *name, const char *devname, const char *class_devname,
-				   const orb_id_t orb_topic_sensor,
-				   const unsigned max_channels = DEFAULT_MAX_CHANNELS) :
-		device::CDev(name, devname),
-		_max_channels(max_channels),
-		_class_devname(class_devname),
-		_orb_topic(orb_topic_sensor),
-		_channels(new Channel[max_channels])
-	{
-		_device_id.devid_s.bus_type = DeviceBusType_UAVCAN;
-		_device_id.devid_s.bus = 0;
-	}
+	UavcanCDevSensorBridgeBase(uavcan::INode &node, const char *name, const char *devname,
+				   const char *class_devname, const orb_id_t orb_topic_sensor,
+				   const unsigned max_channels = DEFAULT_MAX_CHANNELS);
 
 	/**
 	 * Sends one measurement into appropriate ORB topic.
 	 * New redundancy channels will be registered automatically.
-	 * @param node_id Sensor's Node ID
-	 * @param report  Pointer to ORB message object
+	 * @param node_id      Sensor's Node ID
+	 * @param report       Pointer to ORB message object
+	 * @param timestamp_rx Reception time of the UAVCAN message
 	 */
-	void publish(const int node_id, const void *report);
+	void publish(const int node_id, const void *report, hrt_abstime timestamp_rx);
 
 public:
 	virtual ~UavcanCDevSensorBridgeBase();
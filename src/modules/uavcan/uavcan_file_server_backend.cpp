@@ -0,0 +1,220 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <px4_config.h>
+#include <systemlib/err.h>
+
+#include "uavcan_file_server_backend.hpp"
+
+/**
+ * @file uavcan_file_server_backend.cpp
+ *
+ * File server backend serving the firmware images from RAM windows.
+ */
+
+UavcanFileServerBackend::UavcanFileServerBackend(uavcan::INode &node) :
+	BasicFileSeverBackend(node),
+	TimerBase(node),
+	_windows(nullptr),
+	_access_count(0),
+	_hits(0),
+	_misses(0)
+{
+	for (unsigned i = 0; i < NumPaths; i++) {
+		_path_last_used[i] = 0;
+	}
+}
+
+UavcanFileServerBackend::~UavcanFileServerBackend()
+{
+	release();
+}
+
+bool UavcanFileServerBackend::allocate()
+{
+	if (_windows == nullptr) {
+		_windows = new Window[NumWindows];
+
+		if (_windows == nullptr) {
+			return false;
+		}
+
+		for (unsigned i = 0; i < NumWindows; i++) {
+			_windows[i].valid = false;
+		}
+
+		for (unsigned i = 0; i < NumPaths; i++) {
+			_paths[i].clear();
+			_path_last_used[i] = 0;
+		}
+
+		startPeriodic(uavcan::MonotonicDuration::fromMSec(1000));
+	}
+
+	return true;
+}
+
+void UavcanFileServerBackend::release()
+{
+	TimerBase::stop();
+	delete[] _windows;
+	_windows = nullptr;
+}
+
+void UavcanFileServerBackend::handleTimerEvent(const uavcan::TimerEvent &event)
+{
+	/* no node is reading anymore, the memory is given back until the next update */
+	if ((event.real_time - _last_access).toMSec() > (int64_t)IdleTimeoutMs) {
+		release();
+	}
+}
+
+unsigned UavcanFileServerBackend::get_path_index(const Path &path)
+{
+	unsigned index = 0;
+
+	for (unsigned i = 0; i < NumPaths; i++) {
+		if (_paths[i] == path) {
+			_path_last_used[i] = ++_access_count;
+			return i;
+		}
+
+		if (_path_last_used[i] < _path_last_used[index]) {
+			index = i;
+		}
+	}
+
+	/* forget the windows of the path replaced */
+	for (unsigned i = 0; i < NumWindows; i++) {
+		if (_windows[i].path_index == index) {
+			_windows[i].valid = false;
+		}
+	}
+
+	_paths[index] = path;
+	_path_last_used[index] = ++_access_count;
+	return index;
+}
+
+UavcanFileServerBackend::Window *UavcanFileServerBackend::get_window(const Path &path, unsigned path_index,
+		uavcan::uint64_t offset, uavcan::int16_t &rv)
+{
+	Window *window = &_windows[0];
+
+	for (unsigned i = 0; i < NumWindows; i++) {
+		Window *w = &_windows[i];
+
+		if (w->valid && w->path_index == path_index && w->offset == offset) {
+			w->last_used = ++_access_count;
+			_hits++;
+			return w;
+		}
+
+		if (!w->valid || (window->valid && w->last_used < window->last_used)) {
+			window = w;
+		}
+	}
+
+	/* replace an empty or the least recently used window */
+	_misses++;
+	window->valid = false;
+	window->size = WindowSize;
+
+	rv = BasicFileSeverBackend::read(path, offset, window->data, window->size);
+
+	if (rv != 0) {
+		return nullptr;
+	}
+
+	window->offset = offset;
+	window->path_index = path_index;
+	window->last_used = ++_access_count;
+	window->valid = true;
+	return window;
+}
+
+uavcan::int16_t UavcanFileServerBackend::read(const Path &path, const uavcan::uint64_t offset,
+		uavcan::uint8_t *out_buffer, uavcan::uint16_t &inout_size)
+{
+	if (path.size() == 0 || inout_size == 0 || !allocate()) {
+		return BasicFileSeverBackend::read(path, offset, out_buffer, inout_size);
+	}
+
+	_last_access = node_.getMonotonicTime();
+
+	const unsigned path_index = get_path_index(path);
+	uavcan::uint16_t total = 0;
+
+	/* a chunk can span two windows if the node reads at unaligned offsets */
+	while (total < inout_size) {
+		const uavcan::uint64_t pos = offset + total;
+		const uavcan::uint64_t window_offset = pos - pos % WindowSize;
+		uavcan::int16_t rv = 0;
+
+		Window *window = get_window(path, path_index, window_offset, rv);
+
+		if (window == nullptr) {
+			return rv;
+		}
+
+		const unsigned start = pos - window_offset;
+
+		if (start >= window->size) {
+			/* end of file */
+			break;
+		}
+
+		unsigned n = window->size - start;
+
+		if (n > unsigned(inout_size - total)) {
+			n = inout_size - total;
+		}
+
+		memcpy(&out_buffer[total], &window->data[start], n);
+		total += n;
+
+		if (window->size < WindowSize) {
+			/* the last window of the file */
+			break;
+		}
+	}
+
+	inout_size = total;
+	return 0;
+}
+
+void UavcanFileServerBackend::print_info()
+{
+	printf("Firmware server: %s, %u window hits, %u misses\n",
+	       (_windows != nullptr) ? "serving" : "idle", _hits, _misses);
+}
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <uavcan/node/timer.hpp>
+#include <uavcan_posix/basic_file_server_backend.hpp>
+
+/**
+ * @file uavcan_file_server_backend.hpp
+ *
+ * File server backend serving the firmware images from RAM windows.
+ */
+
+/**
+ * The nodes being updated read their image in uavcan.protocol.file.Read
+ * chunks of 256 bytes. The POSIX backend seeks and reads the SD card for
+ * every chunk of every node, so the nodes updating at the same time wait on
+ * each other's card accesses. This backend reads the image ahead in windows
+ * of WindowSize bytes, kept least recently used for all nodes, so most
+ * chunks are copied from RAM and several nodes reading the same image share
+ * the window reads.
+ *
+ * The windows are allocated on the first read and freed again after
+ * IdleTimeoutMs without reads.
+ */
+class UavcanFileServerBackend : public uavcan_posix::BasicFileSeverBackend, private uavcan::TimerBase
+{
+public:
+	static constexpr unsigned WindowSize = 4 * ReadSize;
+	static constexpr unsigned NumWindows = 8;
+	static constexpr unsigned NumPaths = 2;		///< different images cached at the same time
+	static constexpr unsigned IdleTimeoutMs = 10000;
+
+	UavcanFileServerBackend(uavcan::INode &node);
+	virtual ~UavcanFileServerBackend();
+
+	void print_info();
+
+protected:
+	virtual uavcan::int16_t read(const Path &path, const uavcan::uint64_t offset, uavcan::uint8_t *out_buffer,
+				     uavcan::uint16_t &inout_size);
+
+private:
+	struct Window {
+		uavcan::uint64_t offset;
+		uavcan::uint16_t size;		///< less than WindowSize at the end of the file
+		uavcan::uint8_t path_index;
+		bool valid;
+		uavcan::uint32_t last_used;
+		uavcan::uint8_t data[WindowSize];
+	};
+
+	Window *_windows;
+	Path _paths[NumPaths];
+	uavcan::uint32_t _path_last_used[NumPaths];
+	uavcan::uint32_t _access_count;
+	uavcan::MonotonicTime _last_access;
+
+	unsigned _hits;
+	unsigned _misses;
+
+	bool allocate();
+	void release();
+
+	/**
+	 * Index of the cached path, replacing the least recently used one on a miss
+	 */
+	unsigned get_path_index(const Path &path);
+
+	/**
+	 * Window holding the given aligned offset of a path, read from the file on a miss
+	 */
+	Window *get_window(const Path &path, unsigned path_index, uavcan::uint64_t offset, uavcan::int16_t &rv);
+
+	virtual void handleTimerEvent(const uavcan::TimerEvent &);
+};
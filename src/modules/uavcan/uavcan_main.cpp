@@ -111,6 +111,10 @@ UavcanNode::UavcanNode(uavcan::ICanDriver &can_driver, uavcan::ISystemClock &sys
 	if (_perfcnt_esc_mixer_total_elapsed == nullptr) {
 		errx(1, "uavcan: couldn't allocate _perfcnt_esc_mixer_total_elapsed");
 	}
+
+	if (_perfcnt_esc_control_latency == nullptr) {
+		errx(1, "uavcan: couldn't allocate _perfcnt_esc_control_latency");
+	}
 }
 
 UavcanNode::~UavcanNode()
@@ -157,6 +161,7 @@ UavcanNode::~UavcanNode()
 	perf_free(_perfcnt_node_spin_elapsed);
 	perf_free(_perfcnt_esc_mixer_output_elapsed);
 	perf_free(_perfcnt_esc_mixer_total_elapsed);
+	perf_free(_perfcnt_esc_control_latency);
 	pthread_mutex_destroy(&_node_mutex);
 	sem_destroy(&_server_command_sem);
 
@@ -472,9 +477,9 @@ int UavcanNode::run()
 
 	memset(&_outputs, 0, sizeof(_outputs));
 
-	const int busevent_fd = ::open(uavcan_stm32::BusEvent::DevName, 0);
+	_busevent_fd = ::open(uavcan_stm32::BusEvent::DevName, 0);
 
-	if (busevent_fd < 0) {
+	if (_busevent_fd < 0) {
 		warnx("Failed to open %s", uavcan_stm32::BusEvent::DevName);
 		_task_should_exit = true;
 	}
@@ -487,12 +492,30 @@ int UavcanNode::run()
 	_node.setModeOperational();
 
 	/*
-	 * This event is needed to wake up the thread on CAN bus activity (RX/TX/Error).
-	 * Please note that with such multiplexing it is no longer possible to rely only on
-	 * the value returned from poll() to detect whether actuator control has timed out or not.
-	 * Instead, all ORB events need to be checked individually (see below).
+	 * The node is spun by a thread of lower priority which wakes up on CAN bus activity,
+	 * so that the ESC commands are sent as soon as the actuator controls arrive instead of
+	 * after the frames of the sensor bridges and servers have been processed.
+	 * The node is shared through _node_mutex.
 	 */
-	add_poll_fd(busevent_fd);
+	if (!_task_should_exit) {
+		pthread_attr_t tattr;
+		struct sched_param param;
+
+		pthread_attr_init(&tattr);
+		tattr.stacksize = SpinStackSize;
+		param.sched_priority = SCHED_PRIORITY_SLOW_DRIVER;
+		pthread_attr_setschedparam(&tattr, &param);
+
+		static auto spin_trampoline = [](void *) {return UavcanNode::_instance->spin();};
+
+		if (pthread_create(&_spin_thread, &tattr, static_cast<pthread_startroutine_t>(spin_trampoline), nullptr) != 0) {
+			warnx("spin thread start failed: %d", errno);
+			_task_should_exit = true;
+
+		} else {
+			_spin_thread_started = true;
+		}
+	}
 
 	/*
 	 * setup poll to look for actuator direct input if we are
@@ -539,9 +562,8 @@ int UavcanNode::run()
 
 		(void)pthread_mutex_lock(&_node_mutex);
 
-		node_spin_once();  // Non-blocking
-
 		bool new_output = false;
+		hrt_abstime timestamp_sample = 0;
 
 		// this would be bad...
 		if (poll_ret < 0) {
@@ -557,6 +579,10 @@ int UavcanNode::run()
 					if (_poll_fds[_poll_ids[i]].revents & POLLIN) {
 						controls_updated = true;
 						orb_copy(_control_topics[i], _control_subs[i], &_controls[i]);
+
+						if (_controls[i].timestamp_sample > timestamp_sample) {
+							timestamp_sample = _controls[i].timestamp_sample;
+						}
 					}
 				}
 			}
@@ -628,9 +654,14 @@ int UavcanNode::run()
 
 			// Output to the bus
 			_outputs.timestamp = hrt_absolute_time();
+			_outputs.timestamp_sample = timestamp_sample;
 			perf_begin(_perfcnt_esc_mixer_output_elapsed);
 			_esc_controller.update_outputs(_outputs.output, _outputs.noutputs);
 			perf_end(_perfcnt_esc_mixer_output_elapsed);
+
+			if (timestamp_sample != 0) {
+				perf_set(_perfcnt_esc_control_latency, hrt_elapsed_time(&timestamp_sample));
+			}
 		}
 
 
@@ -660,12 +691,38 @@ int UavcanNode::run()
 		}
 	}
 
+	(void)pthread_mutex_unlock(&_node_mutex);
+
+	if (_spin_thread_started) {
+		pthread_join(_spin_thread, nullptr);
+	}
+
+	(void)pthread_mutex_lock(&_node_mutex);
+
 	teardown();
 	warnx("exiting.");
 
 	exit(0);
 }
 
+pthread_addr_t UavcanNode::spin()
+{
+	pollfd fds[1] = {};
+	fds[0].fd = _busevent_fd;
+	fds[0].events = POLLIN;
+
+	while (!_task_should_exit) {
+		// wake up on bus activity, the timeout keeps the node timers running on a silent bus
+		(void)::poll(fds, 1, PollTimeoutMs);
+
+		(void)pthread_mutex_lock(&_node_mutex);
+		node_spin_once();  // Non-blocking
+		(void)pthread_mutex_unlock(&_node_mutex);
+	}
+
+	return (pthread_addr_t) 0;
+}
+
 int
 UavcanNode::control_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &input)
 {
@@ -938,6 +995,11 @@ int uavcan_main(int argc, char *argv[])
 
 	if (fw && (!std::strcmp(argv[1], "status") || !std::strcmp(argv[1], "info"))) {
 		printf("Firmware Server is %s\n", UavcanServers::instance() ? "Running" : "Stopped");
+
+		if (UavcanServers::instance() != nullptr) {
+			UavcanServers::instance()->print_info();
+		}
+
 		::exit(0);
 	}
 
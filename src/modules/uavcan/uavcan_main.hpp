@@ -60,8 +60,8 @@
 
 #define NUM_ACTUATOR_CONTROL_GROUPS_UAVCAN	4
 
-// we add two to allow for actuator_direct and busevent
-#define UAVCAN_NUM_POLL_FDS (NUM_ACTUATOR_CONTROL_GROUPS_UAVCAN+2)
+// we add one to allow for actuator_direct, the bus events are polled by the spinner thread
+#define UAVCAN_NUM_POLL_FDS (NUM_ACTUATOR_CONTROL_GROUPS_UAVCAN+1)
 /**
  * A UAVCAN node.
  */
@@ -89,6 +89,7 @@ class UavcanNode : public device::CDev
 
 	static constexpr unsigned RxQueueLenPerIface = FramePerMSecond * PollTimeoutMs; // At
 	static constexpr unsigned StackSize          = 1600;
+	static constexpr unsigned SpinStackSize      = 1600;
 
 public:
 	typedef uavcan::Node<MemPoolSize> Node;
@@ -125,6 +126,7 @@ private:
 	int		init(uavcan::NodeID node_id);
 	void		node_spin_once();
 	int		run();
+	pthread_addr_t	spin();
 	int		add_poll_fd(int fd);			///< add a fd to poll list, returning index into _poll_fds[]
 	int             start_fw_server();
 	int             stop_fw_server();
@@ -132,6 +134,9 @@ private:
 
 	int			_task = -1;			///< handle to the OS task
 	bool			_task_should_exit = false;	///< flag to indicate to tear down the CAN driver
+	pthread_t		_spin_thread;			///< thread spinning the node, runs the sensor bridges and servers
+	bool			_spin_thread_started = false;
+	int			_busevent_fd = -1;		///< signalled on CAN bus activity (RX/TX/Error)
 	volatile eServerAction            _fw_server_action;
 	int                      _fw_server_status;
 	int			_armed_sub = -1;		///< uORB subscription of the arming status
@@ -175,4 +180,5 @@ private:
 	perf_counter_t _perfcnt_node_spin_elapsed        = perf_alloc(PC_ELAPSED, "uavcan_node_spin_elapsed");
 	perf_counter_t _perfcnt_esc_mixer_output_elapsed = perf_alloc(PC_ELAPSED, "uavcan_esc_mixer_output_elapsed");
 	perf_counter_t _perfcnt_esc_mixer_total_elapsed  = perf_alloc(PC_ELAPSED, "uavcan_esc_mixer_total_elapsed");
+	perf_counter_t _perfcnt_esc_control_latency      = perf_alloc(PC_LATENCY, "uavcan_esc_control_latency");
 };
@@ -72,5 +72,31 @@ PARAM_DEFINE_INT32(UAVCAN_NODE_ID, 1);
  */
 PARAM_DEFINE_INT32(UAVCAN_BITRATE, 1000000);
 
+/**
+ * UAVCAN sensor publication window.
+ *
+ * Reports of the UAVCAN barometers and magnetometers received within this
+ * window are published together at its end, only the latest report of each
+ * sensor node is kept. 0 publishes every report as soon as it is received.
+ *
+ * @unit ms
+ * @min 0
+ * @max 50
+ * @group UAVCAN
+ */
+PARAM_DEFINE_INT32(UAVCAN_SENS_WIN, 0);
 
-
+/**
+ * UAVCAN ESC saturation threshold.
+ *
+ * Armed ESCs reporting at least this share of their power rating flag the
+ * upper motor limit in multirotor_motor_limits, ESCs commanded to zero or
+ * reporting zero RPM the lower one. 0 leaves the motor limits to the mixer
+ * of the IO driver.
+ *
+ * @unit %
+ * @min 0
+ * @max 100
+ * @group UAVCAN
+ */
+PARAM_DEFINE_INT32(UAVCAN_ESC_SAT, 0);
@@ -264,6 +264,10 @@ int UavcanServers::init()
 		return ret;
 	}
 
+	/* the nodes are served in parallel from the RAM windows, so start them at the fastest rate the
+	 * service timeout allows instead of one per second */
+	_fw_upgrade_trigger.setRequestInterval(uavcan::ServiceClientBase::getDefaultRequestTimeout());
+
 	/*  Start the Node   */
 
 	return OK;
@@ -52,6 +52,7 @@
 # include <uavcan_posix/firmware_version_checker.hpp>
 
 # include "uavcan_virtual_can_driver.hpp"
+# include "uavcan_file_server_backend.hpp"
 
 /**
  * @file uavcan_servers.hpp
@@ -79,14 +80,13 @@ class UavcanServers
 	static constexpr unsigned MaxCanFramesPerTransfer   =  63;
 
 	/**
-	 * This number is based on the worst case max number of frames per interface. With
-	 * MemPoolBlockSize set at 48 this is 6048 Bytes.
+	 * Frames per interface and direction in the lock-free rings between the sub-node and the main node,
+	 * based on the worst case max number of frames per transfer. This is 4.5K per interface.
 	 *
 	 * The servers can be forced to use the primary interface only, this can be achieved simply by passing
 	 * 1 instead of UAVCAN_STM32_NUM_IFACES into the constructor of the virtual CAN driver.
 	 */
-	static constexpr unsigned QueuePoolSize =
-		(NumIfaces * uavcan::MemPoolBlockSize * MaxCanFramesPerTransfer);
+	static constexpr unsigned RingSize = MaxCanFramesPerTransfer + 1;
 
 	static constexpr unsigned StackSize  = 3500;
 	static constexpr unsigned Priority  =  120;
@@ -114,6 +114,8 @@ public:
 
 	void requestCheckAllNodesFirmwareAndUpdate() { _check_fw = true; }
 
+	void print_info() { _fileserver_backend.print_info(); }
+
 private:
 	pthread_t         _subnode_thread;
 	pthread_mutex_t   _subnode_mutex;
@@ -124,7 +126,7 @@ private:
 
 	static UavcanServers	*_instance;            ///< singleton pointer
 
-	typedef VirtualCanDriver<QueuePoolSize> vCanDriver;
+	typedef VirtualCanDriver<RingSize> vCanDriver;
 
 	vCanDriver    _vdriver;
 
@@ -135,7 +137,7 @@ private:
 	uavcan_posix::dynamic_node_id_server::FileStorageBackend _storage_backend;
 	uavcan_posix::FirmwareVersionChecker _fw_version_checker;
 	uavcan::dynamic_node_id_server::CentralizedServer _server_instance;  ///< server singleton pointer
-	uavcan_posix::BasicFileSeverBackend  _fileserver_backend;
+	UavcanFileServerBackend  _fileserver_backend;
 	uavcan::NodeInfoRetriever   _node_info_retriever;
 	uavcan::FirmwareUpdateTrigger   _fw_upgrade_trigger;
 	uavcan::BasicFileServer         _fw_server;
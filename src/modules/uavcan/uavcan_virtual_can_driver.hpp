@@ -91,167 +91,132 @@ public:
 };
 
 /**
- * Generic queue based on the linked list class defined in libuavcan.
+ * Single producer, single consumer ring of frames shared by the main node
+ * thread and the sub-node thread without a lock: only the producer writes
+ * the head and only the consumer writes the tail, so neither thread can
+ * block the other, whatever their priorities.
  * This class does not use heap memory.
  */
-template <typename T>
-class Queue
+template <typename T, unsigned Size>
+class FrameRing
 {
-	struct Item : public uavcan::LinkedListNode<Item> {
-		T payload;
+	static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
 
-		template <typename... Args>
-		Item(Args... args) : payload(args...) { }
-	};
-
-	uavcan::LimitedPoolAllocator allocator_;
-	uavcan::LinkedListRoot<Item> list_;
+	T items_[Size];
+	volatile unsigned head_;    ///< Free running, written by the producer only
+	volatile unsigned tail_;    ///< Free running, written by the consumer only
 
 public:
-	Queue(uavcan::IPoolAllocator &arg_allocator, std::size_t block_allocation_quota) :
-		allocator_(arg_allocator, block_allocation_quota)
-	{
-		uavcan::IsDynamicallyAllocatable<Item>::check();
-	}
+	FrameRing() :
+		head_(0),
+		tail_(0)
+	{ }
 
-	bool isEmpty() const { return list_.isEmpty(); }
+	bool isEmpty() const { return head_ == tail_; }
+	bool isFull() const { return (head_ - tail_) >= Size; }
 
 	/**
-	 * Creates one item in-place at the end of the list.
-	 * Returns true if the item was appended successfully, false if there's not enough memory.
-	 * Complexity is O(N) where N is queue length.
+	 * Producer side. Returns false if the ring is full.
 	 */
-	template <typename... Args>
-	bool tryEmplace(Args... args)
+	bool push(const T &item)
 	{
-		// Allocating memory
-		void *const ptr = allocator_.allocate(sizeof(Item));
-
-		if (ptr == nullptr) {
+		if (isFull()) {
 			return false;
 		}
 
-		// Constructing the new item
-		Item *const item = new(ptr) Item(args...);
-		assert(item != nullptr);
-
-		// Inserting the new item at the end of the list
-		Item *p = list_.get();
-
-		if (p == nullptr) {
-			list_.insert(item);
-
-		} else {
-			while (p->getNextListNode() != nullptr) {
-				p = p->getNextListNode();
-			}
-
-			assert(p->getNextListNode() == nullptr);
-			p->setNextListNode(item);
-			assert(p->getNextListNode()->getNextListNode() == nullptr);
-		}
-
+		items_[head_ % Size] = item;
+		__sync_synchronize();  // the item is written before it is published
+		head_ = head_ + 1;
 		return true;
 	}
 
 	/**
-	 * Accesses the first element.
-	 * Nullptr will be returned if the queue is empty.
-	 * Complexity is O(1).
+	 * Consumer side. Nullptr will be returned if the ring is empty.
 	 */
-	T       *peek()       { return isEmpty() ? nullptr : &list_.get()->payload; }
-	const T *peek() const { return isEmpty() ? nullptr : &list_.get()->payload; }
+	const T *peek() const
+	{
+		if (isEmpty()) {
+			return nullptr;
+		}
+
+		__sync_synchronize();  // the item is read after it was published
+		return &items_[tail_ % Size];
+	}
 
 	/**
-	 * Removes the first element.
-	 * If the queue is empty, nothing will be done and assertion failure will be triggered.
-	 * Complexity is O(1).
+	 * Consumer side, releases the item returned by peek().
 	 */
 	void pop()
 	{
-		Item *const item = list_.get();
-		assert(item != nullptr);
-
-		if (item != nullptr) {
-			list_.remove(item);
-			item->~Item();
-			allocator_.deallocate(item);
-		}
+		assert(!isEmpty());
+		__sync_synchronize();  // the item is read before the slot is given back
+		tail_ = tail_ + 1;
 	}
 };
 
 /**
  * Objects of this class are owned by the sub-node thread.
  * This class does not use heap memory.
+ * @tparam RingSize         Number of frames in each direction, a power of two.
  */
+template <unsigned RingSize>
 class VirtualCanIface : public uavcan::ICanIface,
 	uavcan::Noncopyable
 {
-	/**
-	 * This class re-defines uavcan::RxCanFrame with flags.
-	 * Simple inheritance or composition won't work here, because the 40 byte limit will be exceeded,
-	 * rendering this class unusable with Queue<>.
-	 */
-	struct RxItem: public uavcan::CanFrame {
-		const uavcan::MonotonicTime ts_mono;
-		const uavcan::UtcTime ts_utc;
-		const uavcan::CanIOFlags flags;
-		const uint8_t iface_index;
-
-		RxItem(const uavcan::CanRxFrame &arg_frame, uavcan::CanIOFlags arg_flags) :
-			uavcan::CanFrame(arg_frame),
-			ts_mono(arg_frame.ts_mono),
-			ts_utc(arg_frame.ts_utc),
-			flags(arg_flags),
-			iface_index(arg_frame.iface_index)
-		{
-			// Making sure it will fit into a pool block with a pointer prefix
-			static_assert(sizeof(RxItem) <= (uavcan::MemPoolBlockSize - 8), "Bad coder, no coffee");
-		}
+	struct RxItem {
+		uavcan::CanFrame frame;
+		uavcan::MonotonicTime ts_mono;
+		uavcan::UtcTime ts_utc;
+		uavcan::CanIOFlags flags;
 	};
 
-	pthread_mutex_t &common_driver_mutex_;
+	struct TxItem {
+		uavcan::CanFrame frame;
+		uavcan::MonotonicTime deadline;
+		uavcan::CanIOFlags flags;
+	};
 
-	uavcan::CanTxQueue prioritized_tx_queue_;
-	Queue<RxItem> rx_queue_;
+	FrameRing<TxItem, RingSize> tx_ring_;   ///< Sub-node thread to main node thread
+	FrameRing<RxItem, RingSize> rx_ring_;   ///< Main node thread to sub-node thread
+	unsigned rx_overflows_;
 
 	int16_t send(const uavcan::CanFrame &frame, uavcan::MonotonicTime tx_deadline, uavcan::CanIOFlags flags) override
 	{
-		Lock lock(common_driver_mutex_);
-		prioritized_tx_queue_.push(frame, tx_deadline, uavcan::CanTxQueue::Volatile, flags);
-		return 1;
+		TxItem item;
+		item.frame = frame;
+		item.deadline = tx_deadline;
+		item.flags = flags;
+
+		// If full, the frame stays in the TX queue of the sub-node until select() reports the ring writable
+		return tx_ring_.push(item) ? 1 : 0;
 	}
 
 	int16_t receive(uavcan::CanFrame &out_frame, uavcan::MonotonicTime &out_ts_monotonic,
 			uavcan::UtcTime &out_ts_utc, uavcan::CanIOFlags &out_flags) override
 	{
-		Lock lock(common_driver_mutex_);
+		const RxItem *const item = rx_ring_.peek();
 
-		if (rx_queue_.isEmpty()) {
+		if (item == nullptr) {
 			return 0;
 		}
 
-		const auto item = *rx_queue_.peek();
-		rx_queue_.pop();
+		out_frame = item->frame;
+		out_ts_monotonic = item->ts_mono;
+		out_ts_utc = item->ts_utc;
+		out_flags = item->flags;
 
-		out_frame = item;
-		out_ts_monotonic = item.ts_mono;
-		out_ts_utc = item.ts_utc;
-		out_flags = item.flags;
+		rx_ring_.pop();
 
 		return 1;
 	}
 
 	int16_t configureFilters(const uavcan::CanFilterConfig *, std::uint16_t) override { return -uavcan::ErrDriver; }
 	uint16_t getNumFilters() const override { return 0; }
-	uint64_t getErrorCount() const override { return 0; }
+	uint64_t getErrorCount() const override { return rx_overflows_; }
 
 public:
-	VirtualCanIface(uavcan::IPoolAllocator &allocator, uavcan::ISystemClock &clock,
-			pthread_mutex_t &arg_mutex, unsigned quota_per_queue) :
-		common_driver_mutex_(arg_mutex),
-		prioritized_tx_queue_(allocator, clock, quota_per_queue),
-		rx_queue_(allocator, quota_per_queue)
+	VirtualCanIface() :
+		rx_overflows_(0)
 	{
 	}
 
@@ -260,53 +225,70 @@ public:
 	}
 
 	/**
-	 * Note that RX queue overwrites oldest items when overflowed.
+	 * Note that RX ring drops the new frame when overflowed, only the
+	 * sub-node thread may remove frames.
 	 * Call this from the main thread only.
 	 * No additional locking is required.
 	 */
 	void addRxFrame(const uavcan::CanRxFrame &frame, uavcan::CanIOFlags flags)
 	{
-		Lock lock(common_driver_mutex_);
-
-		if (!rx_queue_.tryEmplace(frame, flags) && !rx_queue_.isEmpty()) {
-			rx_queue_.pop();
-			(void)rx_queue_.tryEmplace(frame, flags);
+		RxItem item;
+		item.frame = frame;
+		item.ts_mono = frame.ts_mono;
+		item.ts_utc = frame.ts_utc;
+		item.flags = flags;
+
+		if (!rx_ring_.push(item)) {
+			rx_overflows_++;
 		}
 	}
 
 	/**
 	 * Call this from the main thread only.
 	 * No additional locking is required.
+	 * Returns true if any frame was taken from the ring.
 	 */
-	void flushTxQueueTo(uavcan::INode &main_node, std::uint8_t iface_index)
+	bool flushTxQueueTo(uavcan::INode &main_node, std::uint8_t iface_index)
 	{
-		Lock lock(common_driver_mutex_);
 		const std::uint8_t iface_mask = static_cast<std::uint8_t>(1U << iface_index);
+		bool flushed = false;
 
-		while (auto e = prioritized_tx_queue_.peek()) {
+		while (const TxItem *const e = tx_ring_.peek()) {
 			UAVCAN_TRACE("VirtualCanIface", "TX injection [iface=0x%02x]: %s",
-				     unsigned(iface_mask), e->toString().c_str());
+				     unsigned(iface_mask), e->frame.toString().c_str());
 
+			// The TX queue of the main node orders the frames by priority and drops the expired ones
 			const int res = main_node.injectTxFrame(e->frame, e->deadline, iface_mask,
-								uavcan::CanTxQueue::Qos(e->qos), e->flags);
+								uavcan::CanTxQueue::Volatile, e->flags);
 
-			prioritized_tx_queue_.remove(e);
+			tx_ring_.pop();
+			flushed = true;
 
 			if (res <= 0) {
 				break;
 			}
 
 		}
+
+		return flushed;
+	}
+
+	/**
+	 * Call this from the sub-node thread only.
+	 * No additional locking is required.
+	 */
+	bool hasDataInRxQueue() const
+	{
+		return !rx_ring_.isEmpty();
 	}
 
 	/**
 	 * Call this from the sub-node thread only.
 	 * No additional locking is required.
 	 */
-	bool hasDataInRxQueue()
+	bool hasSpaceInTxQueue() const
 	{
-		Lock lock(common_driver_mutex_);
-		return !rx_queue_.isEmpty();
+		return !tx_ring_.isFull();
 	}
 };
 
@@ -329,11 +311,10 @@ public:
 /**
  * Objects of this class are owned by the sub-node thread.
  * This class does not use heap memory.
- * @tparam SharedMemoryPoolSize         Amount of memory, in bytes, that will be statically allocated for the
- *                                      memory pool that will be shared across all interfaces for RX/TX queues.
- *                                      Typically this value should be no less than 4K per interface.
+ * @tparam RingSize         Number of frames that will be statically allocated per interface and direction,
+ *                          a power of two. Frames the TX ring can't take stay in the sub-node TX queue.
  */
-template <unsigned SharedMemoryPoolSize>
+template <unsigned RingSize>
 class VirtualCanDriver : public uavcan::ICanDriver,
 	public uavcan::IRxFrameListener,
 	public ITxQueueInjector,
@@ -377,76 +358,84 @@ class VirtualCanDriver : public uavcan::ICanDriver,
 				auto abstime = ::timespec();
 
 				if (clock_gettime(CLOCK_REALTIME, &abstime) >= 0) {
-					abstime.tv_nsec += duration.toUSec() * 1000;
-
-					if (abstime.tv_nsec >= NsPerSec) {
-						abstime.tv_sec++;
-						abstime.tv_nsec -= NsPerSec;
-					}
+					const uint64_t nsec = abstime.tv_nsec + duration.toUSec() * 1000;
+					abstime.tv_sec += nsec / NsPerSec;
+					abstime.tv_nsec = nsec % NsPerSec;
 
 					(void)sem_timedwait(&sem, &abstime);
 				}
 			}
 		}
 
+		/**
+		 * Wakes up the waiting thread, at most one pending post is kept so
+		 * a burst of frames costs one wakeup.
+		 */
 		void signal()
 		{
 			int count;
 			int rv = sem_getvalue(&sem, &count);
 
-			if (rv > 0 && count <= 0) {
+			if (rv == 0 && count <= 0) {
 				sem_post(&sem);
 			}
 		}
 	};
 
+	typedef VirtualCanIface<RingSize> Iface;
+
 	Event event_;               ///< Used to unblock the select() call when IO happens.
-	pthread_mutex_t driver_mutex_;    ///< Shared across all ifaces
-	uavcan::PoolAllocator<SharedMemoryPoolSize, uavcan::MemPoolBlockSize> allocator_;   ///< Shared across all ifaces
-	uavcan::LazyConstructor<VirtualCanIface> ifaces_[uavcan::MaxCanIfaces];
+	uavcan::LazyConstructor<Iface> ifaces_[uavcan::MaxCanIfaces];
 	const unsigned num_ifaces_;
 	uavcan::ISystemClock &clock_;
 
 	uavcan::ICanIface *getIface(uint8_t iface_index) override
 	{
-		return (iface_index < num_ifaces_) ? ifaces_[iface_index].operator VirtualCanIface * () : nullptr;
+		return (iface_index < num_ifaces_) ? ifaces_[iface_index].operator Iface * () : nullptr;
 	}
 
 	uint8_t getNumIfaces() const override { return num_ifaces_; }
 
 	/**
-	 * This and other methods of ICanDriver will be invoked by the sub-node thread.
+	 * Ready masks of the rings, restricted to the requested ones.
 	 */
-	int16_t select(uavcan::CanSelectMasks &inout_masks,
-		       const uavcan::CanFrame * (&)[uavcan::MaxCanIfaces],
-		       uavcan::MonotonicTime blocking_deadline) override
+	uavcan::CanSelectMasks getReadyMasks(const uavcan::CanSelectMasks &requested)
 	{
-		bool need_block = (inout_masks.write == 0);    // Write queue is infinite
+		uavcan::CanSelectMasks ready;
 
-		for (unsigned i = 0; need_block && (i < num_ifaces_); i++) {
-			const bool need_read = inout_masks.read & (1U << i);
+		for (unsigned i = 0; i < num_ifaces_; i++) {
+			const std::uint8_t iface_mask = 1U << i;
 
-			if (need_read && ifaces_[i]->hasDataInRxQueue()) {
-				need_block = false;
+			if ((requested.write & iface_mask) && ifaces_[i]->hasSpaceInTxQueue()) {
+				ready.write |= iface_mask;
 			}
-		}
 
-		if (need_block) {
-			event_.waitFor(blocking_deadline - clock_.getMonotonic());
+			if ((requested.read & iface_mask) && ifaces_[i]->hasDataInRxQueue()) {
+				ready.read |= iface_mask;
+			}
 		}
 
-		inout_masks = uavcan::CanSelectMasks();
+		return ready;
+	}
 
-		for (unsigned i = 0; i < num_ifaces_; i++) {
-			const std::uint8_t iface_mask = 1U << i;
-			inout_masks.write |= iface_mask;           // Always ready to write
+	/**
+	 * This and other methods of ICanDriver will be invoked by the sub-node thread.
+	 */
+	int16_t select(uavcan::CanSelectMasks &inout_masks,
+		       const uavcan::CanFrame * (&)[uavcan::MaxCanIfaces],
+		       uavcan::MonotonicTime blocking_deadline) override
+	{
+		uavcan::CanSelectMasks ready = getReadyMasks(inout_masks);
 
-			if (ifaces_[i]->hasDataInRxQueue()) {
-				inout_masks.read |= iface_mask;
-			}
+		if (ready.read == 0 && ready.write == 0) {
+			// Woken up by a received frame or by the main node emptying a TX ring
+			event_.waitFor(blocking_deadline - clock_.getMonotonic());
+			ready = getReadyMasks(inout_masks);
 		}
 
-		return num_ifaces_;       // We're always ready to write, hence > 0.
+		inout_masks = ready;
+
+		return num_ifaces_;
 	}
 
 	/**
@@ -468,11 +457,16 @@ class VirtualCanDriver : public uavcan::ICanDriver,
 	 */
 	void injectTxFramesInto(uavcan::INode &main_node) override
 	{
+		bool flushed = false;
+
 		for (unsigned i = 0; i < num_ifaces_; i++) {
-			ifaces_[i]->flushTxQueueTo(main_node, i);
+			flushed = ifaces_[i]->flushTxQueueTo(main_node, i) || flushed;
 		}
 
-		event_.signal();
+		// The sub-node may be waiting for space in a TX ring
+		if (flushed) {
+			event_.signal();
+		}
 	}
 
 public:
@@ -480,26 +474,19 @@ public:
 		num_ifaces_(arg_num_ifaces),
 		clock_(system_clock)
 	{
-		Lock::init(driver_mutex_);
 		event_.init();
 
 		assert(num_ifaces_ > 0 && num_ifaces_ <= uavcan::MaxCanIfaces);
 
-		const unsigned quota_per_iface = allocator_.getNumBlocks() / num_ifaces_;
-		const unsigned quota_per_queue = quota_per_iface;             // 2x overcommit
-
-		UAVCAN_TRACE("VirtualCanDriver", "Total blocks: %u, quota per queue: %u",
-			     unsigned(allocator_.getNumBlocks()), unsigned(quota_per_queue));
+		UAVCAN_TRACE("VirtualCanDriver", "Frames per ring: %u", RingSize);
 
 		for (unsigned i = 0; i < num_ifaces_; i++) {
-			ifaces_[i].template construct<uavcan::IPoolAllocator &, uavcan::ISystemClock &,
-				pthread_mutex_t &, unsigned>(allocator_, clock_, driver_mutex_, quota_per_queue);
+			ifaces_[i].construct();
 		}
 	}
 
 	~VirtualCanDriver()
 	{
-		Lock::deinit(driver_mutex_);
 		event_.deinit();
 	}
 
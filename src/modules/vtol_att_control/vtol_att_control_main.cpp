@@ -114,6 +114,7 @@ VtolAttitudeControl::VtolAttitudeControl() :
 	_params_handles.arsp_lp_gain = param_find("VT_ARSP_LP_GAIN");
 	_params_handles.vtol_type = param_find("VT_TYPE");
 	_params_handles.elevons_mc_lock = param_find("VT_ELEV_MC_LOCK");
+	_params_handles.ctrl_suspend = param_find("VT_CTRL_SUSPEND");
 
 	/* fetch initial parameter values */
 	parameters_update();
@@ -409,6 +410,10 @@ VtolAttitudeControl::parameters_update()
 	param_get(_params_handles.elevons_mc_lock, &l);
 	_params.elevons_mc_lock = l;
 
+	/* vtol suspend the inactive attitude controller */
+	param_get(_params_handles.ctrl_suspend, &l);
+	_params.ctrl_suspend = l;
+
 	return OK;
 }
 
@@ -549,6 +554,13 @@ void VtolAttitudeControl::task_main()
 			// vehicle is in rotary wing mode
 			_vtol_vehicle_status.vtol_in_rw_mode = true;
 			_vtol_vehicle_status.vtol_in_trans_mode = false;
+			_vtol_vehicle_status.mc_ctrl_suspended = false;
+			_vtol_vehicle_status.fw_ctrl_suspended = (_params.ctrl_suspend == 1);
+
+			// a suspended fw controller does not publish, do not keep its last output
+			if (_vtol_vehicle_status.fw_ctrl_suspended) {
+				memset(&_actuators_fw_in.control, 0, sizeof(_actuators_fw_in.control));
+			}
 
 			// got data from mc attitude controller
 			if (fds[0].revents & POLLIN) {
@@ -563,6 +575,13 @@ void VtolAttitudeControl::task_main()
 			// vehicle is in fw mode
 			_vtol_vehicle_status.vtol_in_rw_mode = false;
 			_vtol_vehicle_status.vtol_in_trans_mode = false;
+			_vtol_vehicle_status.mc_ctrl_suspended = (_params.ctrl_suspend == 1);
+			_vtol_vehicle_status.fw_ctrl_suspended = false;
+
+			// a suspended mc controller does not publish, do not keep its last output
+			if (_vtol_vehicle_status.mc_ctrl_suspended) {
+				memset(&_actuators_mc_in.control, 0, sizeof(_actuators_mc_in.control));
+			}
 
 			// got data from fw attitude controller
 			if (fds[1].revents & POLLIN) {
@@ -577,6 +596,8 @@ void VtolAttitudeControl::task_main()
 		} else if (_vtol_type->get_mode() == TRANSITION) {
 			// vehicle is doing a transition
 			_vtol_vehicle_status.vtol_in_trans_mode = true;
+			_vtol_vehicle_status.mc_ctrl_suspended = false;
+			_vtol_vehicle_status.fw_ctrl_suspended = false;
 
 			bool got_new_data = false;
 
@@ -598,11 +619,21 @@ void VtolAttitudeControl::task_main()
 
 		} else if (_vtol_type->get_mode() == EXTERNAL) {
 			// we are using external module to generate attitude/thrust setpoint
+			_vtol_vehicle_status.mc_ctrl_suspended = false;
+			_vtol_vehicle_status.fw_ctrl_suspended = false;
 			_vtol_type->update_external_state();
 		}
 
 		_vtol_type->fill_actuator_outputs();
 
+		/* pass the sample time of the newest controller input on to the output drivers */
+		hrt_abstime timestamp_sample = _actuators_mc_in.timestamp_sample > _actuators_fw_in.timestamp_sample ?
+					       _actuators_mc_in.timestamp_sample : _actuators_fw_in.timestamp_sample;
+		_actuators_out_0.timestamp = hrt_absolute_time();
+		_actuators_out_0.timestamp_sample = timestamp_sample;
+		_actuators_out_1.timestamp = _actuators_out_0.timestamp;
+		_actuators_out_1.timestamp_sample = timestamp_sample;
+
 		/* Only publish if the proper mode(s) are enabled */
 		if (_v_control_mode.flag_control_attitude_enabled ||
 		    _v_control_mode.flag_control_rates_enabled ||
@@ -182,6 +182,7 @@ private:
 		param_t arsp_lp_gain;
 		param_t vtol_type;
 		param_t elevons_mc_lock;
+		param_t ctrl_suspend;
 	} _params_handles;
 
 	/* for multicopters it is usual to have a non-zero idle speed of the engines
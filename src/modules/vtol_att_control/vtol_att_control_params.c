@@ -162,6 +162,19 @@ PARAM_DEFINE_INT32(VT_TYPE, 0);
  */
 PARAM_DEFINE_INT32(VT_ELEV_MC_LOCK, 0);
 
+/**
+ * Suspend the inactive attitude controller
+ *
+ * If set to 1 the fixed wing attitude controller is suspended in multicopter
+ * mode and the multicopter attitude controller in fixed wing mode. Both run
+ * during transitions.
+ *
+ * @min 0
+ * @max 1
+ * @group VTOL Attitude Control
+ */
+PARAM_DEFINE_INT32(VT_CTRL_SUSPEND, 0);
+
 /**
  * Duration of a front transition
  *
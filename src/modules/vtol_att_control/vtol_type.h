@@ -56,6 +56,7 @@ struct Params {
 	float arsp_lp_gain;			// total airspeed estimate low pass gain
 	int vtol_type;
 	int elevons_mc_lock;		// lock elevons in multicopter mode
+	int ctrl_suspend;			// suspend the inactive attitude controller outside transitions
 };
 
 enum mode {
@@ -417,6 +417,9 @@ ACCELSIM::ACCELSIM(const char* path, enum Rotation rotation) :
 	_mag_scale.y_scale = 1.0f;
 	_mag_scale.z_offset = 0.0f;
 	_mag_scale.z_scale = 1.0f;
+
+	memset(&_accel_call, 0, sizeof(_accel_call));
+	memset(&_mag_call, 0, sizeof(_mag_call));
 }
 
 ACCELSIM::~ACCELSIM()
@@ -474,6 +477,14 @@ ACCELSIM::init()
 		goto out;
 	}
 
+	_accel_class_instance = register_class_devname(ACCEL_BASE_DEVICE_PATH);
+
+	/* the simulator publishes the sensor topics itself, only provide the device nodes */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensors()) {
+		_pub_blocked = true;
+		goto out;
+	}
+
 	/* fill report structures */
 	measure();
 
@@ -489,16 +500,13 @@ ACCELSIM::init()
 		PX4_WARN("ADVERT ERR");
 	}
 
-
-	_accel_class_instance = register_class_devname(ACCEL_BASE_DEVICE_PATH);
-
 	/* advertise sensor topic, measure manually to initialize valid report */
 	struct accel_report arp;
 	_accel_reports->get(&arp);
 
 	/* measurement will have generated a report, publish */
-	_accel_topic = orb_advertise_multi(ORB_ID(sensor_accel), &arp,
-		&_accel_orb_class_instance, ORB_PRIO_DEFAULT);
+	_accel_topic = orb_advertise_multi_queue(ORB_ID(sensor_accel), &arp,
+		&_accel_orb_class_instance, ORB_PRIO_DEFAULT, SENSOR_ORB_QUEUE_SIZE);
 
 	if (_accel_topic == nullptr) {
 		PX4_WARN("ADVERT ERR");
@@ -957,6 +965,11 @@ ACCELSIM::start()
 	_accel_reports->flush();
 	_mag_reports->flush();
 
+	/* nothing to poll if the simulator publishes the sensor topics */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensors()) {
+		return;
+	}
+
 	/* start polling at the specified rate */
 	//PX4_INFO("ACCELSIM::start accel %u", _call_accel_interval);
 	hrt_call_every(&_accel_call, 1000, _call_accel_interval, (hrt_callout)&ACCELSIM::measure_trampoline, this);
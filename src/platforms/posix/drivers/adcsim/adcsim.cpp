@@ -115,6 +115,8 @@ ADCSIM::ADCSIM(uint32_t channels) :
 	_channel_count(0),
 	_samples(nullptr)
 {
+	memset(&_call, 0, sizeof(_call));
+
 	//_debug_enabled = true;
 
 	/* always enable the temperature sensor */
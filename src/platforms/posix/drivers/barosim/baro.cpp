@@ -66,6 +66,8 @@
 #include <systemlib/perf_counter.h>
 #include <systemlib/err.h>
 
+#include <simulator/simulator.h>
+
 #include "barosim.h"
 
 enum BAROSIM_BUS {
@@ -275,6 +277,13 @@ BAROSIM::init()
 	_measure_phase = 0;
 	_reports->flush();
 
+	/* the simulator publishes the sensor topics itself, only provide the device nodes */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensors()) {
+		_pub_blocked = true;
+		ret = OK;
+		goto out;
+	}
+
 	_baro_topic = orb_advertise_multi(ORB_ID(sensor_baro), &brp,
 				&_orb_class_instance, (is_external()) ? ORB_PRIO_HIGH : ORB_PRIO_DEFAULT);
 
@@ -514,6 +523,11 @@ BAROSIM::start_cycle()
 	_measure_phase = 0;
 	_reports->flush();
 
+	/* nothing to poll if the simulator publishes the sensor topics */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensors()) {
+		return;
+	}
+
 	/* schedule a cycle to start things */
 	work_queue(HPWORK, &_work, (worker_t)&BAROSIM::cycle_trampoline, this, 1);
 }
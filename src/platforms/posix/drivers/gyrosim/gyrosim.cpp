@@ -346,7 +346,7 @@ GYROSIM::GYROSIM(const char *path_accel, const char *path_gyro, enum Rotation ro
 	_good_transfers(perf_alloc(PC_COUNT, "gyrosim_good_transfers")),
 	_reset_retries(perf_alloc(PC_COUNT, "gyrosim_reset_retries")),
 	_system_latency_perf(perf_alloc_once(PC_ELAPSED, "sys_latency")),
-	_controller_latency_perf(perf_alloc_once(PC_ELAPSED, "ctrl_latency")),
+	_controller_latency_perf(perf_alloc_once(PC_HISTOGRAM, "ctrl_latency")),
 	_rotation(rotation),
 	_last_temperature(0)
 {
@@ -463,6 +463,12 @@ GYROSIM::init()
 
 	_accel_class_instance = register_class_devname(ACCEL_BASE_DEVICE_PATH);
 
+	/* the simulator publishes the sensor topics itself, only provide the device nodes */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensors()) {
+		_pub_blocked = true;
+		goto out;
+	}
+
 	measure();
 
 	/* advertise sensor topic, measure manually to initialize valid report */
@@ -470,8 +476,8 @@ GYROSIM::init()
 	_accel_reports->get(&arp);
 
 	/* measurement will have generated a report, publish */
-	_accel_topic = orb_advertise_multi(ORB_ID(sensor_accel), &arp,
-		&_accel_orb_class_instance, ORB_PRIO_HIGH);
+	_accel_topic = orb_advertise_multi_queue(ORB_ID(sensor_accel), &arp,
+		&_accel_orb_class_instance, ORB_PRIO_HIGH, SENSOR_ORB_QUEUE_SIZE);
 
 	if (_accel_topic == nullptr) {
 		PX4_WARN("ADVERT FAIL");
@@ -485,8 +491,8 @@ GYROSIM::init()
 	struct gyro_report grp;
 	_gyro_reports->get(&grp);
 
-	_gyro->_gyro_topic = orb_advertise_multi(ORB_ID(sensor_gyro), &grp,
-		&_gyro->_gyro_orb_class_instance, ORB_PRIO_HIGH);
+	_gyro->_gyro_topic = orb_advertise_multi_queue(ORB_ID(sensor_gyro), &grp,
+		&_gyro->_gyro_orb_class_instance, ORB_PRIO_HIGH, SENSOR_ORB_QUEUE_SIZE);
 
 	if (_gyro->_gyro_topic == nullptr) {
 		PX4_WARN("ADVERT FAIL");
@@ -975,6 +981,11 @@ GYROSIM::start()
 	_accel_reports->flush();
 	_gyro_reports->flush();
 
+	/* nothing to poll if the simulator publishes the sensor topics */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensors()) {
+		return;
+	}
+
 	/* start polling at the specified rate */
 	if (_call_interval > 0) {
 		hrt_call_every(&_call, _call_interval, _call_interval, (hrt_callout)&GYROSIM::measure_trampoline, this);
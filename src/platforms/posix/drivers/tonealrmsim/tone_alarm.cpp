@@ -213,6 +213,8 @@ ToneAlarm::ToneAlarm() :
 	_tune(nullptr),
 	_next(nullptr)
 {
+	memset(&_note_call, 0, sizeof(_note_call));
+
 	// enable debug() calls
 	//_debug_enabled = true;
 	_default_tunes[TONE_STARTUP_TUNE] = "MFT240L8 O4aO5dc O4aO5dc O4aO5dc L16dcdcdcdc";		// startup tune
@@ -105,10 +105,12 @@ static void run_cmd(const vector<string> &appargs)
 static void usage()
 {
 
-	cout << "./mainapp [-d] [startup_config] -h" << std::endl;
+	cout << "./mainapp [-d] [-i <instance>] [startup_config] -h" << std::endl;
 	cout << "   -d            - Optional flag to run the app in daemon mode and does not take listen for user input." <<
 	     std::endl;
 	cout << "                   This is needed if mainapp is intended to be run as a upstart job on linux" << std::endl;
+	cout << "   -i <instance> - Instance number when several apps run on one host, offsets the UDP ports" << std::endl;
+	cout << "                   by " << px4::kInstancePortStride << " per instance. Run every instance in its own directory." << std::endl;
 	cout << "<startup_config> - config file for starting/stopping px4 modules" << std::endl;
 	cout << "   -h            - help/usage information" << std::endl;
 }
@@ -137,6 +139,9 @@ int main(int argc, char **argv)
 			if (strcmp(argv[index], "-d") == 0) {
 				daemon_mode = true;
 
+			} else if (strcmp(argv[index], "-i") == 0 && index + 1 < argc) {
+				px4::set_instance(strtoul(argv[++index], nullptr, 10));
+
 			} else if (strcmp(argv[index], "-h") == 0) {
 				usage();
 				return 0;
@@ -38,14 +38,22 @@
  */
 
 #include <px4_workqueue.h>
+#include <px4_tasks.h>
 #include <drivers/drv_hrt.h>
+#include <drivers/hrt_callout_heap.h>
+#include <systemlib/trace.h>
 #include <semaphore.h>
+#include <pthread.h>
 #include <time.h>
+#include <unistd.h>
 #include <string.h>
 #include <inttypes.h>
-#include "hrt_work.h"
 
-static struct sq_queue_s	callout_queue;
+#ifdef __PX4_LINUX
+#include <sys/prctl.h>
+#endif
+
+static struct hrt_callout_heap	callout_queue;
 
 /* latency histogram */
 #define LATENCY_BUCKET_COUNT 8
@@ -60,12 +68,32 @@ static void		hrt_call_reschedule(void);
 #define HRT_INTERVAL_MAX	50000000
 
 static sem_t 	_hrt_lock;
-static struct work_s	_hrt_work;
 static hrt_abstime px4_timestart = 0;
 
+/* lockstep mode, time only advances through hrt_lockstep_set_time() */
+static bool		_lockstep = false;
+static hrt_abstime	_lockstep_time = 0;
+
+/* timer thread, stands in for the compare interrupt of the hardware timer */
+static hrt_abstime	_timer_deadline = HRT_INTERVAL_MAX;
+static pthread_cond_t	_timer_cond;
+
+/* hrt_sleep_until() callers */
+static pthread_cond_t	_sleep_cond;
+
+/* protects the lockstep time, the timer deadline and the wakeup counters */
+static pthread_mutex_t	_time_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t	_cond_once = PTHREAD_ONCE_INIT;
+
 static void
 hrt_call_invoke(void);
 
+static void
+hrt_latency_update(hrt_abstime latency);
+
+static void
+hrt_tim_isr(void *p);
+
 __EXPORT hrt_abstime hrt_reset(void);
 
 static void hrt_lock(void)
@@ -121,6 +149,10 @@ hrt_abstime hrt_absolute_time(void)
 {
 	struct timespec ts;
 
+	if (_lockstep) {
+		return __atomic_load_n(&_lockstep_time, __ATOMIC_ACQUIRE);
+	}
+
 	if (!px4_timestart) {
 		clock_gettime(CLOCK_MONOTONIC, &ts);
 		px4_timestart = ts_to_abstime(&ts);
@@ -136,6 +168,123 @@ __EXPORT hrt_abstime hrt_reset(void)
 	return hrt_absolute_time();
 }
 
+/*
+ * Stop the clock at the current time, from now on it is advanced by
+ * hrt_lockstep_set_time() only.
+ */
+void	hrt_lockstep_enable(void)
+{
+	pthread_mutex_lock(&_time_mutex);
+
+	if (!_lockstep) {
+		__atomic_store_n(&_lockstep_time, hrt_absolute_time(), __ATOMIC_RELEASE);
+		_lockstep = true;
+	}
+
+	pthread_mutex_unlock(&_time_mutex);
+}
+
+bool	hrt_lockstep_active(void)
+{
+	return _lockstep;
+}
+
+/*
+ * Advance the lockstep clock and wake up everything sleeping on it.
+ */
+void	hrt_lockstep_set_time(hrt_abstime time)
+{
+	pthread_mutex_lock(&_time_mutex);
+
+	/* never run backwards */
+	if (_lockstep && time > _lockstep_time) {
+		__atomic_store_n(&_lockstep_time, time, __ATOMIC_RELEASE);
+		pthread_cond_broadcast(&_sleep_cond);
+		pthread_cond_signal(&_timer_cond);
+	}
+
+	pthread_mutex_unlock(&_time_mutex);
+}
+
+/*
+ * Wait on cond until the HRT time reaches deadline, or until signalled.
+ *
+ * Must be called with _time_mutex held and not in lockstep mode.
+ */
+static void
+hrt_cond_wait_until(pthread_cond_t *cond, hrt_abstime deadline)
+{
+#ifdef __PX4_DARWIN
+	/* no monotonic condition clock, wait relative to now */
+	hrt_abstime now = hrt_absolute_time();
+	struct timespec ts;
+
+	if (deadline <= now) {
+		return;
+	}
+
+	hrt_abstime delay = deadline - now;
+	ts.tv_sec = delay / 1000000;
+	ts.tv_nsec = (delay % 1000000) * 1000;
+	pthread_cond_timedwait_relative_np(cond, &_time_mutex, &ts);
+#else
+	/* HRT time is CLOCK_MONOTONIC shifted by the start time */
+	hrt_abstime abstime = deadline + px4_timestart;
+	struct timespec ts;
+
+	ts.tv_sec = abstime / 1000000;
+	ts.tv_nsec = (abstime % 1000000) * 1000;
+	pthread_cond_timedwait(cond, &_time_mutex, &ts);
+#endif
+}
+
+static void
+hrt_cond_init(void)
+{
+	pthread_condattr_t attr;
+
+	pthread_condattr_init(&attr);
+#ifndef __PX4_DARWIN
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+	pthread_cond_init(&_timer_cond, &attr);
+	pthread_cond_init(&_sleep_cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+/*
+ * Sleep until deadline in HRT time or until woken with hrt_wakeup().
+ */
+void	hrt_sleep_until(hrt_abstime deadline, volatile unsigned *wakeups, unsigned seen)
+{
+	pthread_once(&_cond_once, hrt_cond_init);
+	pthread_mutex_lock(&_time_mutex);
+
+	while (*wakeups == seen && (deadline == 0 || hrt_absolute_time() < deadline)) {
+		if (deadline == 0 || _lockstep) {
+			/* in lockstep hrt_lockstep_set_time() wakes us up as well */
+			pthread_cond_wait(&_sleep_cond, &_time_mutex);
+
+		} else {
+			hrt_cond_wait_until(&_sleep_cond, deadline);
+		}
+	}
+
+	pthread_mutex_unlock(&_time_mutex);
+}
+
+/*
+ * Wake up the hrt_sleep_until() callers waiting on wakeups.
+ */
+void	hrt_wakeup(volatile unsigned *wakeups)
+{
+	pthread_once(&_cond_once, hrt_cond_init);
+	pthread_mutex_lock(&_time_mutex);
+	(*wakeups)++;
+	pthread_cond_broadcast(&_sleep_cond);
+	pthread_mutex_unlock(&_time_mutex);
+}
+
 /*
  * Convert a timespec to absolute time.
  */
@@ -191,7 +340,7 @@ bool	hrt_called(struct hrt_call *entry)
 void	hrt_cancel(struct hrt_call *entry)
 {
 	hrt_lock();
-	sq_rem(&entry->link, &callout_queue);
+	hrt_callout_heap_remove(&callout_queue, entry);
 	entry->deadline = 0;
 
 	/* if this is a periodic call being removed by the callout, prevent it from
@@ -222,44 +371,82 @@ void	hrt_call_delay(struct hrt_call *entry, hrt_abstime delay)
 	entry->deadline = hrt_absolute_time() + delay;
 }
 
+/*
+ * Timer thread, sleeps until the next deadline with an absolute timeout and
+ * runs the callouts from there like the timer interrupt does on hardware.
+ */
+static int
+hrt_timer_thread(int argc, char *argv[])
+{
+#ifdef __PX4_LINUX
+	/* the default slack would delay every wakeup by up to 50 us */
+	prctl(PR_SET_TIMERSLACK, 1UL);
+#endif
+
+	pthread_mutex_lock(&_time_mutex);
+
+	for (;;) {
+		hrt_abstime deadline = _timer_deadline;
+		hrt_abstime now = hrt_absolute_time();
+
+		if (now < deadline) {
+			if (_lockstep) {
+				/* signalled by hrt_lockstep_set_time() and hrt_call_reschedule() */
+				pthread_cond_wait(&_timer_cond, &_time_mutex);
+
+			} else {
+				hrt_cond_wait_until(&_timer_cond, deadline);
+			}
+
+			continue;
+		}
+
+		/* the callouts set the next deadline when they reschedule */
+		_timer_deadline = now + HRT_INTERVAL_MAX;
+		pthread_mutex_unlock(&_time_mutex);
+
+		/* lateness in lockstep is only the simulation step */
+		if (!_lockstep) {
+			hrt_latency_update(now - deadline);
+		}
+
+		hrt_tim_isr(NULL);
+
+		pthread_mutex_lock(&_time_mutex);
+	}
+
+	return 0;
+}
+
 /*
  * Initialise the HRT.
  */
 void	hrt_init(void)
 {
 	//printf("hrt_init\n");
-	sq_init(&callout_queue);
+	hrt_callout_heap_init(&callout_queue);
 	sem_init(&_hrt_lock, 0, 1);
-	memset(&_hrt_work, 0, sizeof(_hrt_work));
+	pthread_once(&_cond_once, hrt_cond_init);
+
+	px4_task_spawn_cmd("hrt_timer",
+			   SCHED_DEFAULT,
+			   SCHED_PRIORITY_MAX,
+			   2000,
+			   hrt_timer_thread,
+			   (char *const *)NULL);
 }
 
 static void
 hrt_call_enter(struct hrt_call *entry)
 {
-	struct hrt_call	*call, *next;
+	struct hrt_call	*call = hrt_callout_heap_peek(&callout_queue);
 
-	//PX4_INFO("hrt_call_enter");
-	call = (struct hrt_call *)sq_peek(&callout_queue);
+	hrt_callout_heap_insert(&callout_queue, entry);
 
 	if ((call == NULL) || (entry->deadline < call->deadline)) {
-		sq_addfirst(&entry->link, &callout_queue);
-		//if (call != NULL) PX4_INFO("call enter at head, reschedule (%lu %lu)", entry->deadline, call->deadline);
 		/* we changed the next deadline, reschedule the timer event */
 		hrt_call_reschedule();
-
-	} else {
-		do {
-			next = (struct hrt_call *)sq_next(&call->link);
-
-			if ((next == NULL) || (entry->deadline < next->deadline)) {
-				//lldbg("call enter after head\n");
-				sq_addafter(&call->link, &entry->link, &callout_queue);
-				break;
-			}
-		} while ((call = next) != NULL);
 	}
-
-	//PX4_INFO("scheduled");
 }
 
 /**
@@ -293,7 +480,7 @@ hrt_call_reschedule()
 {
 	hrt_abstime	now = hrt_absolute_time();
 	hrt_abstime	delay = HRT_INTERVAL_MAX;
-	struct hrt_call	*next = (struct hrt_call *)sq_peek(&callout_queue);
+	struct hrt_call	*next = hrt_callout_heap_peek(&callout_queue);
 	hrt_abstime	deadline = now + HRT_INTERVAL_MAX;
 
 	//PX4_INFO("hrt_call_reschedule");
@@ -323,13 +510,28 @@ hrt_call_reschedule()
 		}
 	}
 
-	// There is no timer ISR, so simulate one by putting an event on the
-	// high priority work queue
+	// There is no timer ISR, hand the new expiry to the timer thread
+	pthread_mutex_lock(&_time_mutex);
+	_timer_deadline = now + delay;
+	pthread_cond_signal(&_timer_cond);
+	pthread_mutex_unlock(&_time_mutex);
+}
+
+static void
+hrt_latency_update(hrt_abstime latency)
+{
+	unsigned	index;
 
-	// Remove the existing expiry and update with the new expiry
-	hrt_work_cancel(&_hrt_work);
+	/* bounded buckets */
+	for (index = 0; index < LATENCY_BUCKET_COUNT; index++) {
+		if (latency <= latency_buckets[index]) {
+			latency_counters[index]++;
+			return;
+		}
+	}
 
-	hrt_work_queue(&_hrt_work, (worker_t)&hrt_tim_isr, NULL, delay);
+	/* catch-all at the end */
+	latency_counters[index]++;
 }
 
 static void
@@ -340,15 +542,8 @@ hrt_call_internal(struct hrt_call *entry, hrt_abstime deadline, hrt_abstime inte
 
 	//PX4_INFO("hrt_call_internal after lock");
 	/* if the entry is currently queued, remove it */
-	/* note that we are using a potentially uninitialised
-	   entry->link here, but it is safe as sq_rem() doesn't
-	   dereference the passed node unless it is found in the
-	   list. So we potentially waste a bit of time searching the
-	   queue for the uninitialised entry->link but we don't do
-	   anything actually unsafe.
-	*/
 	if (entry->deadline != 0) {
-		sq_rem(&entry->link, &callout_queue);
+		hrt_callout_heap_remove(&callout_queue, entry);
 	}
 
 #if 0
@@ -426,7 +621,7 @@ hrt_call_invoke(void)
 		/* get the current time */
 		hrt_abstime now = hrt_absolute_time();
 
-		call = (struct hrt_call *)sq_peek(&callout_queue);
+		call = hrt_callout_heap_peek(&callout_queue);
 
 		if (call == NULL) {
 			break;
@@ -436,7 +631,7 @@ hrt_call_invoke(void)
 			break;
 		}
 
-		sq_rem(&call->link, &callout_queue);
+		hrt_callout_heap_remove(&callout_queue, call);
 		//PX4_INFO("call pop");
 
 		/* save the intended deadline for periodic calls */
@@ -451,7 +646,9 @@ hrt_call_invoke(void)
 			hrt_unlock();
 
 			//PX4_INFO("call %p: %p(%p)", call, call->callout, call->arg);
+			TRACE_CALLOUT_BEGIN(call->callout);
 			call->callout(call->arg);
+			TRACE_CALLOUT_END(call->callout);
 
 			hrt_lock();
 		}
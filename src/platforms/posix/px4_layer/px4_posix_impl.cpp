@@ -83,5 +83,17 @@ uint64_t get_time_micros()
 	return hrt_absolute_time();
 }
 
+static unsigned _instance = 0;
+
+unsigned get_instance()
+{
+	return _instance;
+}
+
+void set_instance(unsigned instance)
+{
+	_instance = instance;
+}
+
 }
 
@@ -73,6 +73,43 @@ struct task_entry
 
 static task_entry taskmap[PX4_MAX_TASKS];
 
+// CPUs set with px4_task_set_affinity(), by task name
+struct affinity_entry
+{
+	std::string name;
+	int cpu;
+	affinity_entry() : cpu(-1) {}
+};
+
+static affinity_entry affinitymap[PX4_MAX_TASKS];
+
+static int task_affinity(const char *name)
+{
+	for (int i=0; i<PX4_MAX_TASKS; ++i) {
+		if (affinitymap[i].cpu >= 0 && affinitymap[i].name == name) {
+			return affinitymap[i].cpu;
+		}
+	}
+	return -1;
+}
+
+#ifdef __PX4_LINUX
+static void cpu_set_for(int cpu, cpu_set_t *set)
+{
+	CPU_ZERO(set);
+
+	if (cpu < 0) {
+		// unpinned, any CPU
+		for (int i=0; i<CPU_SETSIZE; ++i) {
+			CPU_SET(i, set);
+		}
+	}
+	else {
+		CPU_SET(cpu, set);
+	}
+}
+#endif
+
 typedef struct 
 {
 	px4_main_t entry;
@@ -169,6 +206,19 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 		return (rv < 0) ? rv : -rv;
 	}
 
+#ifdef __PX4_LINUX
+	int cpu = task_affinity(name);
+	if (cpu >= 0) {
+		cpu_set_t cpus;
+		cpu_set_for(cpu, &cpus);
+
+		rv = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+		if (rv != 0) {
+			PX4_WARN("px4_task_spawn_cmd: failed to set affinity of %s to CPU %d", name, cpu);
+		}
+	}
+#endif
+
         rv = pthread_create (&task, &attr, &entry_adapter, (void *) taskdata);
 	if (rv != 0) {
 
@@ -271,7 +321,13 @@ void px4_show_tasks()
 	for (idx=0; idx < PX4_MAX_TASKS; idx++)
 	{
 		if (taskmap[idx].isused) {
-			PX4_INFO("   %-10s %lu", taskmap[idx].name.c_str(), taskmap[idx].pid);
+			int cpu = task_affinity(taskmap[idx].name.c_str());
+			if (cpu >= 0) {
+				PX4_INFO("   %-10s %lu cpu %d", taskmap[idx].name.c_str(), taskmap[idx].pid, cpu);
+			}
+			else {
+				PX4_INFO("   %-10s %lu", taskmap[idx].name.c_str(), taskmap[idx].pid);
+			}
 			count++;
 		}
 	}
@@ -291,6 +347,90 @@ bool px4_task_is_running(const char *taskname)
 	}
 	return false;
 }
+
+int px4_task_set_affinity(const char *taskname, int cpu)
+{
+#ifdef __PX4_LINUX
+	int idx;
+	int free_idx = -1;
+
+	if (cpu >= CPU_SETSIZE) {
+		return -EINVAL;
+	}
+	if (cpu < 0) {
+		cpu = -1;
+	}
+
+	for (idx=0; idx < PX4_MAX_TASKS; idx++) {
+		if (affinitymap[idx].cpu >= 0 && affinitymap[idx].name == taskname) {
+			break;
+		}
+		if (affinitymap[idx].cpu < 0 && free_idx < 0) {
+			free_idx = idx;
+		}
+	}
+	if (idx >= PX4_MAX_TASKS) {
+		if (cpu < 0) {
+			idx = -1;
+		}
+		else if (free_idx < 0) {
+			return -ENOSPC;
+		}
+		else {
+			idx = free_idx;
+			affinitymap[idx].name = taskname;
+		}
+	}
+	if (idx >= 0) {
+		affinitymap[idx].cpu = cpu;
+	}
+
+	// Move the task if it is already running
+	cpu_set_t cpus;
+	cpu_set_for(cpu, &cpus);
+
+	for (idx=0; idx < PX4_MAX_TASKS; idx++) {
+		if (taskmap[idx].isused && taskmap[idx].name == taskname) {
+			int rv = pthread_setaffinity_np(taskmap[idx].pid, sizeof(cpus), &cpus);
+			if (rv != 0) {
+				return -rv;
+			}
+		}
+	}
+
+	return 0;
+#else
+	return -ENOSYS;
+#endif
+}
+
+int px4_task_runtime(int index, char *name, size_t namelen, uint64_t *runtime)
+{
+	if (index < 0 || index >= PX4_MAX_TASKS) {
+		return -EINVAL;
+	}
+	if (!taskmap[index].isused) {
+		return -ENOENT;
+	}
+
+	strncpy(name, taskmap[index].name.c_str(), namelen);
+	*runtime = 0;
+
+#ifdef __PX4_LINUX
+	clockid_t clock;
+	struct timespec ts;
+
+	if (pthread_getcpuclockid(taskmap[index].pid, &clock) != 0 || clock_gettime(clock, &ts) != 0) {
+		return -ENOENT;
+	}
+
+	*runtime = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+	return 0;
+#else
+	return -ENOSYS;
+#endif
+}
+
 __BEGIN_DECLS
 
 unsigned long px4_getpid()
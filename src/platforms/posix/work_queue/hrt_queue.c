@@ -123,9 +123,8 @@ int hrt_work_queue(struct work_s *work, worker_t worker, void *arg, uint32_t del
 	dq_addlast((dq_entry_t *)work, &wqueue->q);
 #ifdef __PX4_QURT
 	px4_task_kill(wqueue->pid, SIGALRM);      /* Wake up the worker thread */
-#else
-	px4_task_kill(wqueue->pid, SIGCONT);      /* Wake up the worker thread */
 #endif
+	hrt_wakeup(&wqueue->wakeups);             /* Wake up the worker thread */
 
 	hrt_work_unlock();
 	return PX4_OK;
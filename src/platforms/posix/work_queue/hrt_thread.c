@@ -114,16 +114,22 @@ static void hrt_work_process()
 	volatile struct work_s *work;
 	worker_t  worker;
 	void *arg;
-	uint64_t elapsed;
-	uint32_t remaining;
-	uint32_t next;
+	hrt_abstime due;
+	hrt_abstime next;
+	unsigned wakeups;
+
+	/* Take the wakeup count before looking at the queue, work queued
+	 * after this point ends the sleep below right away.
+	 */
+
+	wakeups = __atomic_load_n(&wqueue->wakeups, __ATOMIC_ACQUIRE);
 
 	/* Then process queued work.  We need to keep interrupts disabled while
 	 * we process items in the work list.
 	 */
 
-	/* Default to sleeping for 1 sec */
-	next  = 1000000;
+	/* Default to sleeping until new work is queued */
+	next  = 0;
 
 	hrt_work_lock();
 
@@ -136,10 +142,10 @@ static void hrt_work_process()
 		 * zero.  Therefore a delay of zero will always execute immediately.
 		 */
 
-		elapsed = hrt_absolute_time() - work->qtime;
+		due = work->qtime + work->delay;
 
-		//PX4_INFO("hrt work_process: in usec elapsed=%lu delay=%u work=%p", elapsed, work->delay, work);
-		if (elapsed >= work->delay) {
+		//PX4_INFO("hrt work_process: due=%lu delay=%u work=%p", due, work->delay, work);
+		if (hrt_absolute_time() >= due) {
 			/* Remove the ready-to-execute work from the list */
 
 			(void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
@@ -182,14 +188,10 @@ static void hrt_work_process()
 			 * scheduled wakeup interval?
 			 */
 
-			/* Here: elapsed < work->delay */
-			remaining = work->delay - elapsed;
-
-			//PX4_INFO("remaining=%u delay=%u elapsed=%lu", remaining, work->delay, elapsed);
-			if (remaining < next) {
+			if (next == 0 || due < next) {
 				/* Yes.. Then schedule to wake up when the work is ready */
 
-				next = remaining;
+				next = due;
 			}
 
 			/* Then try the next in the list. */
@@ -200,13 +202,12 @@ static void hrt_work_process()
 	}
 
 	/* Wait awhile to check the work list.  We will wait here until either
-	 * the time elapses or until we are awakened by a signal.
+	 * the time elapses or until new work is queued.
 	 */
 	hrt_work_unlock();
 
-	/* might sleep less if a signal received and new item was queued */
-	//PX4_INFO("Sleeping for %u usec", next);
-	usleep(next);
+	//PX4_INFO("Sleeping until %lu", next);
+	hrt_sleep_until(next, &wqueue->wakeups, wakeups);
 }
 
 /****************************************************************************
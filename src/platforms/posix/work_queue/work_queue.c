@@ -46,6 +46,7 @@
 #include <stdio.h>
 #include <semaphore.h>
 #include <px4_workqueue.h>
+#include <drivers/drv_hrt.h>
 #include "work_lock.h"
 
 #ifdef CONFIG_SCHED_WORKQUEUE
@@ -121,14 +122,13 @@ int work_queue(int qid, struct work_s *work, worker_t worker, void *arg, uint32_
 	 */
 
 	work_lock(qid);
-	work->qtime  = clock_systimer(); /* Time work queued */
+	work->qtime  = hrt_absolute_time(); /* Time work queued */
 
 	dq_addlast((dq_entry_t *)work, &wqueue->q);
 #ifdef __PX4_QURT
 	px4_task_kill(wqueue->pid, SIGALRM);      /* Wake up the worker thread */
-#else
-	px4_task_kill(wqueue->pid, SIGCONT);      /* Wake up the worker thread */
 #endif
+	hrt_wakeup(&wqueue->wakeups);             /* Wake up the worker thread */
 
 	work_unlock(qid);
 	return PX4_OK;
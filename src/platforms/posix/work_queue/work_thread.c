@@ -42,6 +42,7 @@
 #include <px4_time.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <queue.h>
 #include <px4_workqueue.h>
@@ -93,15 +94,22 @@ static void work_process(struct wqueue_s *wqueue, int lock_id)
 	volatile struct work_s *work;
 	worker_t  worker;
 	void *arg;
-	uint64_t elapsed;
-	uint32_t remaining;
-	uint32_t next;
+	hrt_abstime due;
+	hrt_abstime next;
+	unsigned wakeups;
+
+	/* Take the wakeup count before looking at the queue, work queued
+	 * after this point ends the sleep below right away.
+	 */
+
+	wakeups = __atomic_load_n(&wqueue->wakeups, __ATOMIC_ACQUIRE);
 
 	/* Then process queued work.  We need to keep interrupts disabled while
 	 * we process items in the work list.
 	 */
 
-	next  = CONFIG_SCHED_WORKPERIOD;
+	/* Default to sleeping until new work is queued */
+	next  = 0;
 
 	work_lock(lock_id);
 
@@ -114,10 +122,10 @@ static void work_process(struct wqueue_s *wqueue, int lock_id)
 		 * zero.  Therefore a delay of zero will always execute immediately.
 		 */
 
-		elapsed = USEC2TICK(clock_systimer() - work->qtime);
+		due = work->qtime + (hrt_abstime)work->delay * USEC_PER_TICK;
 
-		//printf("work_process: in ticks elapsed=%lu delay=%u\n", elapsed, work->delay);
-		if (elapsed >= work->delay) {
+		//printf("work_process: due=%llu delay=%u\n", due, work->delay);
+		if (hrt_absolute_time() >= due) {
 			/* Remove the ready-to-execute work from the list */
 
 			(void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
@@ -159,13 +167,10 @@ static void work_process(struct wqueue_s *wqueue, int lock_id)
 			 * scheduled wakeup interval?
 			 */
 
-			/* Here: elapsed < work->delay */
-			remaining = USEC_PER_TICK * (work->delay - elapsed);
-
-			if (remaining < next) {
+			if (next == 0 || due < next) {
 				/* Yes.. Then schedule to wake up when the work is ready */
 
-				next = remaining;
+				next = due;
 			}
 
 			/* Then try the next in the list. */
@@ -175,11 +180,11 @@ static void work_process(struct wqueue_s *wqueue, int lock_id)
 	}
 
 	/* Wait awhile to check the work list.  We will wait here until either
-	 * the time elapses or until we are awakened by a signal.
+	 * the time elapses or until new work is queued.
 	 */
 	work_unlock(lock_id);
 
-	usleep(next);
+	hrt_sleep_until(next, &wqueue->wakeups, wakeups);
 }
 
 /****************************************************************************
@@ -187,11 +192,11 @@ static void work_process(struct wqueue_s *wqueue, int lock_id)
  ****************************************************************************/
 void work_queues_init(void)
 {
-	sem_init(&_work_lock[HPWORK], 0, 1);
-	sem_init(&_work_lock[LPWORK], 0, 1);
-#ifdef CONFIG_SCHED_USRWORK
-	sem_init(&_work_lock[USRWORK], 0, 1);
-#endif
+	int qid;
+
+	for (qid = 0; qid < NWORKERS; qid++) {
+		sem_init(&_work_lock[qid], 0, 1);
+	}
 
 	// Create high priority worker thread
 	g_work[HPWORK].pid = px4_task_spawn_cmd("wkr_high",
@@ -209,6 +214,22 @@ void work_queues_init(void)
 						work_lpthread,
 						(char *const *)NULL);
 
+	// Create the bus worker threads, at the priority of the high priority one
+	for (qid = LPWORK + 1; qid < NWORKERS; qid++) {
+		char name[16];
+		char arg[8];
+		char *const argv[] = { arg, NULL };
+
+		snprintf(name, sizeof(name), "wkr_bus%d", qid - (LPWORK + 1));
+		snprintf(arg, sizeof(arg), "%d", qid);
+
+		g_work[qid].pid = px4_task_spawn_cmd(name,
+						     SCHED_DEFAULT,
+						     SCHED_PRIORITY_MAX - 1,
+						     2000,
+						     work_busthread,
+						     argv);
+	}
 }
 
 /****************************************************************************
@@ -318,6 +339,31 @@ int work_usrthread(int argc, char *argv[])
 
 #endif /* CONFIG_SCHED_USRWORK */
 
+/****************************************************************************
+ * Name: work_busthread
+ *
+ * Description:
+ *   The worker thread of a bus work queue, see BUSWORK().
+ *
+ * Input parameters:
+ *   argc, argv - argv[argc - 1] is the work queue ID
+ *
+ * Returned Value:
+ *   Does not return
+ *
+ ****************************************************************************/
+
+int work_busthread(int argc, char *argv[])
+{
+	int qid = atoi(argv[argc - 1]);
+
+	for (;;) {
+		work_process(&g_work[qid], qid);
+	}
+
+	return PX4_OK; /* To keep some compilers happy */
+}
+
 uint32_t clock_systimer()
 {
 	//printf("clock_systimer: %0lx\n", hrt_absolute_time());
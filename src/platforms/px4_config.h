@@ -54,6 +54,15 @@
 /** time in ms between checks for work in work queues **/
 #define CONFIG_SCHED_WORKPERIOD 50000
 
+/** number of work queues for bus drivers in addition to HPWORK and LPWORK, see BUSWORK() **/
+#ifndef CONFIG_SCHED_BUSWORK
+#ifdef __PX4_QURT
+#define CONFIG_SCHED_BUSWORK 0
+#else
+#define CONFIG_SCHED_BUSWORK 2
+#endif
+#endif
+
 #define CONFIG_SCHED_INSTRUMENTATION 1
 #define CONFIG_MAX_TASKS 32
 
@@ -107,6 +107,19 @@ typedef param_t px4_param_t;
 
 #define PX4_ISFINITE(x) isfinite(x)
 
+/*
+ * Place data in the core coupled memory of the STM32F4 on boards whose
+ * linker script has a .ccm section. The CPU reaches it without sharing
+ * the bus matrix with DMA, but DMA cannot reach it at all, so it is only
+ * for data the CPU alone touches. The section is not loaded, the board
+ * init zeroes it, so the data must not have a non-zero initializer.
+ */
+#include <px4_config.h>
+#if defined(CONFIG_ARCH_BOARD_PX4FMU_V2)
+#define PX4_HAVE_CCM 1
+#define __CCM __attribute__((section(".ccm")))
+#endif
+
 // mode for open with O_CREAT
 #define PX4_O_MODE_777 0777
 #define PX4_O_MODE_666 0666
@@ -244,6 +257,11 @@ __END_DECLS
  *Defines for all platforms
  */
 
+/* without a CCM section the data stays in main memory */
+#ifndef __CCM
+#define __CCM
+#endif
+
 /* wrapper for 2d matrices */
 #define PX4_ARRAY2D(_array, _ncols, _x, _y) (_array[_x * _ncols + _y])
 
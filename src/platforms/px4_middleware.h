@@ -49,6 +49,25 @@ __EXPORT void init(int argc, char *argv[], const char *process_name);
 
 __EXPORT uint64_t get_time_micros();
 
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+/**
+ * UDP ports are offset by this per instance, so the ports of one instance never match another's
+ */
+static const unsigned kInstancePortStride = 10;
+
+/**
+ * Instance number of this process when several run on one host (mainapp -i), 0 by default
+ */
+__EXPORT unsigned get_instance();
+
+__EXPORT void set_instance(unsigned instance);
+
+/**
+ * Port of this instance for a port given for instance 0
+ */
+inline unsigned instance_port(unsigned port) { return port + get_instance() * kInstancePortStride; }
+#endif
+
 #if defined(__PX4_ROS)
 /**
  * Returns true if the app/task should continue to run
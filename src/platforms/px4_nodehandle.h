@@ -197,7 +197,7 @@ public:
 	Subscriber<T> *subscribe(void(*fp)(const T &),  unsigned interval)
 	{
 		(void)interval;
-		SubscriberUORBCallback<T> *sub_px4 = new SubscriberUORBCallback<T>(interval, std::bind(fp, std::placeholders::_1));
+		SubscriberUORBCallback<T, void> *sub_px4 = new SubscriberUORBCallback<T, void>(interval, fp);
 		update_sub_min_interval(interval, sub_px4);
 		_subs.add((SubscriberNode *)sub_px4);
 		return (Subscriber<T> *)sub_px4;
@@ -212,7 +212,7 @@ public:
 	Subscriber<T> *subscribe(void(C::*fp)(const T &), C *obj, unsigned interval)
 	{
 		(void)interval;
-		SubscriberUORBCallback<T> *sub_px4 = new SubscriberUORBCallback<T>(interval, std::bind(fp, obj, std::placeholders::_1));
+		SubscriberUORBCallback<T, C> *sub_px4 = new SubscriberUORBCallback<T, C>(interval, fp, obj);
 		update_sub_min_interval(interval, sub_px4);
 		_subs.add((SubscriberNode *)sub_px4);
 		return (Subscriber<T> *)sub_px4;
@@ -70,6 +70,9 @@ typedef struct pollfd px4_pollfd_struct_t;
 #define px4_access 	_GLOBAL access
 #define px4_getpid 	_GLOBAL getpid
 
+/* NuttX descriptors can be polled together with sockets and serial ports already */
+#define px4_event_fd(fd)	(fd)
+
 #elif defined(__PX4_POSIX)
 
 #define  PX4_F_RDONLY O_RDONLY
@@ -101,6 +104,14 @@ __EXPORT int		px4_fsync(int fd);
 __EXPORT int		px4_access(const char *pathname, int mode);
 __EXPORT unsigned long	px4_getpid(void);
 
+/**
+ * Get a real file descriptor that becomes readable when the virtual
+ * file fd has new data, to wait for it in ::poll() together with sockets
+ * and serial ports. It has to be read (8 bytes) to clear it, and is
+ * closed by px4_close(fd). Linux only, -1 with px4_errno set elsewhere.
+ */
+__EXPORT int		px4_event_fd(int fd);
+
 __END_DECLS
 #else
 #error "No TARGET OS Provided"
@@ -40,6 +40,7 @@
 #if defined(__PX4_ROS)
 /* includes when building for ros */
 #include "ros/ros.h"
+#include <boost/make_shared.hpp>
 #else
 /* includes when building for NuttX */
 #include <uORB/Publication.hpp>
@@ -71,22 +72,35 @@ public:
 	Publisher() {};
 	~Publisher() {};
 
+#if defined(__PX4_ROS)
 	virtual int publish(const T &msg)  = 0;
+#else
+	/* uORB is the only implementation here, so the call is bound at compile time */
+	int publish(const T &msg);
+#endif
 };
 
 #if defined(__PX4_ROS)
+/**
+ * Publisher for ROS, the messages are published as shared pointers: roscpp
+ * hands the pointer to the subscribers of the same process without
+ * serializing, and serializes only for the subscribers of other processes.
+ */
 template <typename T>
 class PublisherROS :
 	public Publisher<T>
 {
 public:
+	/** Native ROS message type wrapped by T */
+	typedef typename std::remove_reference<decltype(((T*)nullptr)->data())>::type ros_msg_t;
+
 	/**
 	 * Construct Publisher by providing a ros::Publisher
 	 * @param ros_pub the ros publisher which will be used to perform the publications
 	 */
 	PublisherROS(ros::NodeHandle *rnh) :
 		Publisher<T>(),
-		_ros_pub(rnh->advertise<typename std::remove_reference<decltype(((T*)nullptr)->data())>::type &>(T::handle(), kQueueSizeDefault))
+		_ros_pub(rnh->advertise<ros_msg_t>(T::handle(), kQueueSizeDefault))
 	{}
 
 	~PublisherROS() {};
@@ -96,7 +110,9 @@ public:
 	 */
 	int publish(const T &msg)
 	{
-		_ros_pub.publish(msg.data());
+		/* a new message every time, the subscribers may still hold the previous one */
+		boost::shared_ptr<ros_msg_t> ros_msg = boost::make_shared<ros_msg_t>(msg.data());
+		_ros_pub.publish(ros_msg);
 		return 0;
 	}
 protected:
@@ -133,19 +149,17 @@ public:
 	PublisherUORB() :
 		Publisher<T>(),
 		PublisherNode(),
-		_uorb_pub(new uORB::PublicationBase(T::handle()))
+		_uorb_pub(T::handle())
 	{}
 
-	~PublisherUORB() {
-		delete _uorb_pub;
-	};
+	~PublisherUORB() {};
 
 	/** Publishes msg
 	 * @param msg	    the message which is published to the topic
 	 */
 	int publish(const T &msg)
 	{
-		_uorb_pub->update((void *)&(msg.data()));
+		_uorb_pub.update((void *)&(msg.data()));
 		return 0;
 	}
 
@@ -154,8 +168,14 @@ public:
 	 */
 	void update() {} ;
 private:
-	uORB::PublicationBase * _uorb_pub;	/**< Handle to the publisher */
+	uORB::PublicationBase _uorb_pub;	/**< Handle to the publisher */
 
 };
+
+template <typename T>
+int Publisher<T>::publish(const T &msg)
+{
+	return static_cast<PublisherUORB<T> *>(this)->publish(msg);
+}
 #endif
 }
@@ -84,12 +84,12 @@ public:
 	/**
 	 * Get the last message value
 	 */
-	virtual T& get() {return _msg_current;}
+	T& get() {return _msg_current;}
 
 	/**
 	 * Get the last native message value
 	 */
-	virtual decltype(((T*)nullptr)->data()) data()
+	decltype(((T*)nullptr)->data()) data()
 	{
 		return _msg_current.data();
 	}
@@ -107,6 +107,9 @@ class SubscriberROS :
 	public Subscriber<T>
 {
 public:
+	/** Native ROS message type wrapped by T */
+	typedef typename std::remove_reference<decltype(((T*)nullptr)->data())>::type ros_msg_t;
+
 	/**
 	 * Construct Subscriber without a callback function
 	 */
@@ -131,12 +134,13 @@ protected:
 
 	/**
 	 * Called on topic update, saves the current message and then calls the provided callback function
-	 * needs to use the native type as it is called by ROS
+	 * needs to use the native type as it is called by ROS. Taking the message as a shared pointer
+	 * lets roscpp pass the messages of publishers in the same process without serialization.
 	 */
-	void callback(const typename std::remove_reference<decltype(((T*)nullptr)->data())>::type &msg)
+	void callback(const typename ros_msg_t::ConstPtr &msg)
 	{
 		/* Store data */
-		this->_msg_current.data() = msg;
+		this->_msg_current.data() = *msg;
 
 		/* Call callback */
 		if (_cbf != NULL) {
@@ -192,12 +196,10 @@ public:
 	 */
 	SubscriberUORB(unsigned interval) :
 		SubscriberNode(interval),
-		_uorb_sub(new uORB::SubscriptionBase(T::handle(), interval))
+		_uorb_sub(T::handle(), interval)
 	{}
 
-	virtual ~SubscriberUORB() {
-		delete _uorb_sub;
-	};
+	virtual ~SubscriberUORB() {};
 
 	/**
 	 * Update Subscription
@@ -205,23 +207,28 @@ public:
 	 */
 	virtual void update()
 	{
-		if (!_uorb_sub->updated()) {
-			/* Topic not updated, do not call callback */
-			return;
-		}
-
-		_uorb_sub->update(get_void_ptr());
+		copy();
 	};
 
 	/* Accessors*/
-	int getUORBHandle() { return _uorb_sub->getHandle(); }
+	int getUORBHandle() { return _uorb_sub.getHandle(); }
 
 protected:
-	uORB::SubscriptionBase * _uorb_sub;	/**< Handle to the subscription */
+	uORB::SubscriptionBase _uorb_sub;	/**< Handle to the subscription */
 
-	typename std::remove_reference<decltype(((T*)nullptr)->data())>::type getUORBData()
+	/**
+	 * Copy the topic into the last message value if it was updated
+	 * @return true if a new message was copied
+	 */
+	bool copy()
 	{
-		return (typename std::remove_reference<decltype(((T*)nullptr)->data())>::type)*_uorb_sub;
+		if (!_uorb_sub.updated()) {
+			/* Topic not updated, do not call callback */
+			return false;
+		}
+
+		orb_copy(_uorb_sub.getMeta(), _uorb_sub.getHandle(), get_void_ptr());
+		return true;
 	}
 
 	/**
@@ -231,21 +238,25 @@ protected:
 
 };
 
-//XXX reduce to one class with overloaded constructor?
-template<typename T>
+/**
+ * Subscriber with a callback to a class method, the method and the class
+ * are bound in the type so the callback is a direct call
+ */
+template<typename T, typename C>
 class __EXPORT SubscriberUORBCallback :
 	public SubscriberUORB<T>
 {
 public:
 	/**
 	 * Construct SubscriberUORBCallback by providing orb meta data
-	 * @param cbf		Callback, executed on receiving a new message
+	 * @param fp		Callback, executed on receiving a new message
+	 * @param obj		Instance the callback is called on
 	 * @param interval	Minimal interval between calls to callback
 	 */
-	SubscriberUORBCallback(unsigned interval,
-			       std::function<void(const T &)> cbf) :
+	SubscriberUORBCallback(unsigned interval, void(C::*fp)(const T &), C *obj) :
 		SubscriberUORB<T>(interval),
-		_cbf(cbf)
+		_fp(fp),
+		_obj(obj)
 	{}
 
 	virtual ~SubscriberUORBCallback() {};
@@ -257,27 +268,52 @@ public:
 	 */
 	virtual void update()
 	{
-		if (!this->_uorb_sub->updated()) {
-			/* Topic not updated, do not call callback */
-			return;
+		if (this->copy() && _fp != nullptr) {
+			/* Call callback which performs actions based on this data */
+			(_obj->*_fp)(this->_msg_current);
 		}
+	};
 
-		/* get latest data */
-		this->_uorb_sub->update(this->get_void_ptr());
-
+protected:
+	void (C::*_fp)(const T &);		/**< Callback that the user provided on the subscription */
+	C *_obj;				/**< Instance the callback is called on */
+};
 
-		/* Check if there is a callback */
-		if (_cbf == nullptr) {
-			return;
-		}
+/**
+ * Subscriber with a callback to a function
+ */
+template<typename T>
+class __EXPORT SubscriberUORBCallback<T, void> :
+	public SubscriberUORB<T>
+{
+public:
+	/**
+	 * Construct SubscriberUORBCallback by providing orb meta data
+	 * @param fp		Callback, executed on receiving a new message
+	 * @param interval	Minimal interval between calls to callback
+	 */
+	SubscriberUORBCallback(unsigned interval, void(*fp)(const T &)) :
+		SubscriberUORB<T>(interval),
+		_fp(fp)
+	{}
 
-		/* Call callback which performs actions based on this data */
-		_cbf(Subscriber<T>::get());
+	virtual ~SubscriberUORBCallback() {};
 
+	/**
+	 * Update Subscription
+	 * Invoked by the list traversal in NodeHandle::spinOnce
+	 * If new data is available the callback is called
+	 */
+	virtual void update()
+	{
+		if (this->copy() && _fp != nullptr) {
+			/* Call callback which performs actions based on this data */
+			_fp(this->_msg_current);
+		}
 	};
 
 protected:
-	std::function<void(const T &)> _cbf;	/**< Callback that the user provided on the subscription */
+	void (*_fp)(const T &);			/**< Callback that the user provided on the subscription */
 };
 #endif
 
@@ -41,6 +41,8 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __PX4_ROS
 
@@ -120,5 +122,13 @@ __EXPORT void px4_show_tasks(void);
 /** See if a task is running **/
 __EXPORT bool px4_task_is_running(const char *taskname);
 
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+/** Pin a task to a CPU, now if it is running and whenever it is started, cpu -1 unpins it **/
+__EXPORT int px4_task_set_affinity(const char *taskname, int cpu);
+
+/** Get the name and the CPU time in us of the task in slot index, -ENOENT for a free slot and -EINVAL past the last one **/
+__EXPORT int px4_task_runtime(int index, char *name, size_t namelen, uint64_t *runtime);
+#endif
+
 __END_DECLS
 
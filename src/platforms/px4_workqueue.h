@@ -41,11 +41,15 @@
 #include <nuttx/arch.h>
 #include <nuttx/wqueue.h>
 #include <nuttx/clock.h>
+
+/* NuttX has no bus work queues, bus drivers share HPWORK */
+#define BUSWORK(bus) HPWORK
 #elif defined(__PX4_POSIX)
 
 #include <stdint.h>
 #include <queue.h>
 #include <px4_platform_types.h>
+#include <px4_config.h>
 
 #ifdef __PX4_QURT
    #include <dspal_types.h>
@@ -55,12 +59,23 @@ __BEGIN_DECLS
 
 #define HPWORK 0
 #define LPWORK 1
-#define NWORKERS 2
+#define NWORKERS (2 + CONFIG_SCHED_BUSWORK)
+
+/* The work queue for the drivers on a bus, so that a slow bus does not
+ * hold up the drivers on the other buses. Falls back to HPWORK if there
+ * are no bus work queues.
+ */
+#if CONFIG_SCHED_BUSWORK > 0
+#define BUSWORK(bus) (2 + (int)((unsigned)(bus) % CONFIG_SCHED_BUSWORK))
+#else
+#define BUSWORK(bus) HPWORK
+#endif
 
 struct wqueue_s
 {
   pid_t             pid; /* The task ID of the worker thread */
   struct dq_queue_s q;   /* The queue of pending work */
+  volatile unsigned wakeups; /* Counts hrt_wakeup() calls for new work */
 };
 
 extern struct wqueue_s g_work[NWORKERS];
@@ -141,6 +156,7 @@ uint32_t clock_systimer(void);
 
 int work_hpthread(int argc, char *argv[]);
 int work_lpthread(int argc, char *argv[]);
+int work_busthread(int argc, char *argv[]);
 
 __END_DECLS
 
@@ -37,14 +37,17 @@
  * High-resolution timer with callouts and timekeeping.
  */
 
+#include <px4_config.h>
 #include <px4_workqueue.h>
 #include <drivers/drv_hrt.h>
+#include <drivers/hrt_callout_heap.h>
 #include <semaphore.h>
 #include <time.h>
 #include <string.h>
 #include <stdio.h>
+#include <unistd.h>
 
-static struct sq_queue_s	callout_queue;
+static struct hrt_callout_heap	callout_queue;
 
 /* latency histogram */
 #define LATENCY_BUCKET_COUNT 8
@@ -86,6 +89,36 @@ hrt_abstime hrt_absolute_time(void)
 	return ts_to_abstime(&ts);
 }
 
+/*
+ * Sleep until deadline or until woken, there is no lockstep mode on QuRT.
+ *
+ * The wakeup is a signal that interrupts usleep(), it is lost when it comes
+ * in before the sleep, so never sleep for longer than the work period.
+ */
+void	hrt_sleep_until(hrt_abstime deadline, volatile unsigned *wakeups, unsigned seen)
+{
+	hrt_abstime now = hrt_absolute_time();
+	hrt_abstime usec = CONFIG_SCHED_WORKPERIOD;
+
+	if (*wakeups != seen || (deadline != 0 && deadline <= now)) {
+		return;
+	}
+
+	if (deadline != 0 && deadline - now < usec) {
+		usec = deadline - now;
+	}
+
+	usleep(usec);
+}
+
+/*
+ * The caller signals the worker thread, only count the wakeup.
+ */
+void	hrt_wakeup(volatile unsigned *wakeups)
+{
+	(*wakeups)++;
+}
+
 /*
  * Convert a timespec to absolute time.
  */
@@ -141,7 +174,7 @@ bool	hrt_called(struct hrt_call *entry)
 void	hrt_cancel(struct hrt_call *entry)
 {
 	hrt_lock();
-	sq_rem(&entry->link, &callout_queue);
+	hrt_callout_heap_remove(&callout_queue, entry);
 	entry->deadline = 0;
 
 	/* if this is a periodic call being removed by the callout, prevent it from
@@ -178,7 +211,7 @@ void	hrt_call_delay(struct hrt_call *entry, hrt_abstime delay)
 void	hrt_init(void)
 {
 	//printf("hrt_init\n");
-	sq_init(&callout_queue);
+	hrt_callout_heap_init(&callout_queue);
 	sem_init(&_hrt_lock, 0, 1);
 	memset(&_hrt_work, 0, sizeof(_hrt_work));
 }
@@ -186,30 +219,14 @@ void	hrt_init(void)
 static void
 hrt_call_enter(struct hrt_call *entry)
 {
-	struct hrt_call	*call, *next;
+	struct hrt_call	*call = hrt_callout_heap_peek(&callout_queue);
 
-	//printf("hrt_call_enter\n");
-	call = (struct hrt_call *)sq_peek(&callout_queue);
+	hrt_callout_heap_insert(&callout_queue, entry);
 
 	if ((call == NULL) || (entry->deadline < call->deadline)) {
-		sq_addfirst(&entry->link, &callout_queue);
-		//lldbg("call enter at head, reschedule\n");
 		/* we changed the next deadline, reschedule the timer event */
 		hrt_call_reschedule();
-
-	} else {
-		do {
-			next = (struct hrt_call *)sq_next(&call->link);
-
-			if ((next == NULL) || (entry->deadline < next->deadline)) {
-				//lldbg("call enter after head\n");
-				sq_addafter(&call->link, &entry->link, &callout_queue);
-				break;
-			}
-		} while ((call = next) != NULL);
 	}
-
-	//lldbg("scheduled\n");
 }
 
 /**
@@ -242,7 +259,7 @@ static void
 hrt_call_reschedule()
 {
 	hrt_abstime	now = hrt_absolute_time();
-	struct hrt_call	*next = (struct hrt_call *)sq_peek(&callout_queue);
+	struct hrt_call	*next = hrt_callout_heap_peek(&callout_queue);
 	hrt_abstime	deadline = now + HRT_INTERVAL_MAX;
 	uint32_t	ticks = USEC2TICK(HRT_INTERVAL_MAX);
 
@@ -286,15 +303,8 @@ hrt_call_internal(struct hrt_call *entry, hrt_abstime deadline, hrt_abstime inte
 	hrt_lock();
 	//printf("hrt_call_internal after lock\n");
 	/* if the entry is currently queued, remove it */
-	/* note that we are using a potentially uninitialised
-	   entry->link here, but it is safe as sq_rem() doesn't
-	   dereference the passed node unless it is found in the
-	   list. So we potentially waste a bit of time searching the
-	   queue for the uninitialised entry->link but we don't do
-	   anything actually unsafe.
-	*/
 	if (entry->deadline != 0)
-		sq_rem(&entry->link, &callout_queue);
+		hrt_callout_heap_remove(&callout_queue, entry);
 
 	entry->deadline = deadline;
 	entry->period = interval;
@@ -362,7 +372,7 @@ hrt_call_invoke(void)
 		/* get the current time */
 		hrt_abstime now = hrt_absolute_time();
 
-		call = (struct hrt_call *)sq_peek(&callout_queue);
+		call = hrt_callout_heap_peek(&callout_queue);
 
 		if (call == NULL)
 			break;
@@ -370,7 +380,7 @@ hrt_call_invoke(void)
 		if (call->deadline > now)
 			break;
 
-		sq_rem(&call->link, &callout_queue);
+		hrt_callout_heap_remove(&callout_queue, call);
 		//lldbg("call pop\n");
 
 		/* save the intended deadline for periodic calls */
@@ -60,6 +60,7 @@ extern "C" __EXPORT int mixer_main(int argc, char *argv[]);
 
 static void	usage(const char *reason);
 static int	load(const char *devname, const char *fname);
+static int	load_binary(int dev, const char *fname, uint8_t *buf, unsigned maxlen);
 
 int
 mixer_main(int argc, char *argv[])
@@ -122,6 +123,11 @@ load(const char *devname, const char *fname)
 		return 1;
 	}
 
+	/* prefer the mixer precompiled at build time, if the device takes it */
+	if (load_binary(dev, fname, (uint8_t *)&buf[0], sizeof(buf)) == 0) {
+		return 0;
+	}
+
 	if (load_mixer_file(fname, &buf[0], sizeof(buf)) < 0) {
 		warnx("can't load mixer: %s", fname);
 		return 1;
@@ -137,3 +143,38 @@ load(const char *devname, const char *fname)
 
 	return 0;
 }
+
+static int
+load_binary(int dev, const char *fname, uint8_t *buf, unsigned maxlen)
+{
+	char binname[64];
+
+	/* <name>.mix is precompiled to <name>.mixb */
+	if (snprintf(binname, sizeof(binname), "%sb", fname) >= (int)sizeof(binname)) {
+		return -1;
+	}
+
+	FILE *fp = fopen(binname, "r");
+
+	if (fp == NULL) {
+		return -1;
+	}
+
+	size_t len = fread(buf, 1, maxlen, fp);
+	bool complete = (feof(fp) != 0);
+	fclose(fp);
+
+	if (len == 0 || !complete) {
+		return -1;
+	}
+
+	mixer_binary_s bin = { buf, (unsigned)len };
+
+	if (px4_ioctl(dev, MIXERIOCLOADBIN, (unsigned long)&bin) < 0) {
+		/* not supported by the device, drop anything loaded and fall back to the text */
+		px4_ioctl(dev, MIXERIOCRESET, 0);
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,262 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file parallel_start.c
+ *
+ * Runs groups of commands concurrently, each group in order. This is
+ * meant to overlap the bus probing of drivers that do not share a bus
+ * (or a device class whose instance order matters) at boot:
+ *
+ *   parallel_start "ms5611 start" "adc start" "hmc5883 -X start; hmc5883 -I start"
+ *
+ * Every command is run to completion as from nsh, and its result and
+ * duration are reported.
+ */
+
+#include <px4_config.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/wait.h>
+
+#include <apps/builtin.h>
+#include <drivers/drv_hrt.h>
+#include <systemlib/err.h>
+
+#define MAX_GROUPS	8
+#define MAX_COMMANDS	8
+#define MAX_ARGS	10
+
+struct start_command {
+	char		*argv[MAX_ARGS + 1];
+	int		result;
+	hrt_abstime	elapsed;
+};
+
+struct start_group {
+	pthread_t		thread;
+	bool			threaded;
+	char			*line;
+	unsigned		count;
+	struct start_command	commands[MAX_COMMANDS];
+};
+
+__EXPORT int parallel_start_main(int argc, char *argv[]);
+
+/**
+ * Split a group into its ';' separated commands and their arguments.
+ */
+static int
+parse_group(struct start_group *group, const char *text)
+{
+	char *save_cmd;
+	char *cmd;
+
+	group->line = strdup(text);
+	group->count = 0;
+
+	if (group->line == NULL) {
+		return -ENOMEM;
+	}
+
+	for (cmd = strtok_r(group->line, ";", &save_cmd); cmd != NULL; cmd = strtok_r(NULL, ";", &save_cmd)) {
+		struct start_command *command = &group->commands[group->count];
+		unsigned argc = 0;
+		char *save_arg;
+		char *arg;
+
+		for (arg = strtok_r(cmd, " \t", &save_arg); arg != NULL; arg = strtok_r(NULL, " \t", &save_arg)) {
+			if (argc == MAX_ARGS) {
+				return -E2BIG;
+			}
+
+			command->argv[argc++] = arg;
+		}
+
+		/* skip empty commands, e.g. from a trailing ';' */
+		if (argc == 0) {
+			continue;
+		}
+
+		if (group->count == MAX_COMMANDS) {
+			return -E2BIG;
+		}
+
+		command->argv[argc] = NULL;
+		command->result = -1;
+		command->elapsed = 0;
+		group->count++;
+	}
+
+	return 0;
+}
+
+/**
+ * Run a builtin command to completion, as nsh does.
+ *
+ * @return		Zero if the command succeeded.
+ */
+static int
+run_command(char *const argv[])
+{
+	int status = 0;
+
+	/* keep the command from running (and exiting) before it is waited for */
+	sched_lock();
+
+	int pid = exec_builtin(argv[0], argv, NULL, 0);
+
+	if (pid < 0) {
+		sched_unlock();
+		return -1;
+	}
+
+	int ret = waitpid(pid, &status, 0);
+	sched_unlock();
+
+	if (ret < 0) {
+		/* the command already exited, nsh assumes success as well */
+		return (errno == ECHILD) ? 0 : -1;
+	}
+
+	return (status == 0) ? 0 : 1;
+}
+
+static void *
+run_group(void *arg)
+{
+	struct start_group *group = (struct start_group *)arg;
+
+	for (unsigned i = 0; i < group->count; i++) {
+		struct start_command *command = &group->commands[i];
+		hrt_abstime start = hrt_absolute_time();
+
+		command->result = run_command(command->argv);
+		command->elapsed = hrt_elapsed_time(&start);
+	}
+
+	return NULL;
+}
+
+static void
+usage(void)
+{
+	errx(1, "usage: parallel_start \"<command> [args]; ...\" ...\n"
+	     "\tthe quoted groups run concurrently, the commands of a group in order");
+}
+
+int
+parallel_start_main(int argc, char *argv[])
+{
+	struct start_group groups[MAX_GROUPS];
+	unsigned group_count = argc - 1;
+	int ret = 0;
+
+	if (argc < 2) {
+		usage();
+	}
+
+	if (group_count > MAX_GROUPS) {
+		errx(1, "at most %d groups", MAX_GROUPS);
+	}
+
+	memset(groups, 0, sizeof(groups));
+
+	for (unsigned i = 0; i < group_count; i++) {
+		if (parse_group(&groups[i], argv[i + 1]) != 0) {
+			warnx("bad group: %s", argv[i + 1]);
+			ret = 1;
+			goto out;
+		}
+	}
+
+	hrt_abstime start = hrt_absolute_time();
+
+	/* the first group runs here, the others in threads of their own */
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, 1500);
+
+	for (unsigned i = 1; i < group_count; i++) {
+		groups[i].threaded = (pthread_create(&groups[i].thread, &attr, run_group, &groups[i]) == 0);
+
+		if (!groups[i].threaded) {
+			/* no thread, run it in order */
+			run_group(&groups[i]);
+		}
+	}
+
+	run_group(&groups[0]);
+
+	for (unsigned i = 1; i < group_count; i++) {
+		if (groups[i].threaded) {
+			pthread_join(groups[i].thread, NULL);
+		}
+	}
+
+	pthread_attr_destroy(&attr);
+
+	/* report in the order given */
+	for (unsigned i = 0; i < group_count; i++) {
+		for (unsigned j = 0; j < groups[i].count; j++) {
+			struct start_command *command = &groups[i].commands[j];
+
+			printf("%5u ms %-6s", (unsigned)(command->elapsed / 1000), (command->result == 0) ? "OK" : "FAILED");
+
+			for (unsigned k = 0; command->argv[k] != NULL; k++) {
+				printf(" %s", command->argv[k]);
+			}
+
+			printf("\n");
+
+			if (command->result != 0) {
+				ret = 1;
+			}
+		}
+	}
+
+	printf("parallel_start: %u ms total\n", (unsigned)(hrt_elapsed_time(&start) / 1000));
+
+out:
+
+	for (unsigned i = 0; i < group_count; i++) {
+		free(groups[i].line);
+	}
+
+	return ret;
+}
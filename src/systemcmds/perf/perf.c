@@ -37,10 +37,18 @@
 
 
 #include <px4_config.h>
+#include <px4_defines.h>
+#include <px4_workqueue.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
 
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/perf_histogram.h>
+
 #include "systemlib/perf_counter.h"
 
 
@@ -52,6 +60,56 @@
  * Private Data
  ****************************************************************************/
 
+static struct work_s	publish_work;
+static orb_advert_t	publish_pub;
+static unsigned		publish_index;
+static uint32_t		publish_interval;	/**< between two counters, in ticks */
+static bool		publish_running;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/*
+ * Publish the next PC_HISTOGRAM counter, so that all of them are logged in turn.
+ */
+static void publish_cycle(void *arg)
+{
+	struct perf_histogram_report_s report;
+
+	if (perf_histogram_report(publish_index, &report) != 0) {
+		/* past the last counter, start over */
+		publish_index = 0;
+	}
+
+	if (perf_histogram_report(publish_index, &report) == 0) {
+		struct perf_histogram_s hist;
+
+		memset(&hist, 0, sizeof(hist));
+		hist.timestamp = hrt_absolute_time();
+		strncpy(hist.name, report.name, sizeof(hist.name));
+		hist.event_count = report.event_count;
+		hist.p50 = report.p50;
+		hist.p99 = report.p99;
+		hist.p999 = report.p999;
+		hist.max = report.max;
+		memcpy(hist.bucket_count, report.bucket_count, sizeof(hist.bucket_count));
+
+		if (publish_pub == NULL) {
+			publish_pub = orb_advertise(ORB_ID(perf_histogram), &hist);
+
+		} else {
+			orb_publish(ORB_ID(perf_histogram), publish_pub, &hist);
+		}
+
+		publish_index++;
+	}
+
+	if (publish_running) {
+		work_queue(LPWORK, &publish_work, publish_cycle, NULL, publish_interval);
+	}
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -73,9 +131,33 @@ int perf_main(int argc, char *argv[])
 			perf_print_latency(0 /* stdout */);
 			fflush(stdout);
 			return 0;
+
+		} else if (strcmp(argv[1], "publish") == 0) {
+			if (argc > 2 && strcmp(argv[2], "stop") == 0) {
+				publish_running = false;
+				work_cancel(LPWORK, &publish_work);
+				return 0;
+			}
+
+			/* counters per second */
+			int rate = (argc > 2) ? atoi(argv[2]) : 10;
+
+			if (rate <= 0) {
+				printf("perf publish: rate must be positive\n");
+				return -1;
+			}
+
+			publish_interval = USEC2TICK(1000000 / rate);
+
+			if (!publish_running) {
+				publish_running = true;
+				work_queue(LPWORK, &publish_work, publish_cycle, NULL, 0);
+			}
+
+			return 0;
 		}
 
-		printf("Usage: perf [reset | latency]\n");
+		printf("Usage: perf [reset | latency | publish [<counters per second> | stop]]\n");
 		return -1;
 	}
 
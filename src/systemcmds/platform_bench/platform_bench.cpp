@@ -0,0 +1,377 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file platform_bench.cpp
+ *
+ * Latency of the platform layer primitives the flight code is built on,
+ * measured the same way on NuttX, POSIX and QuRT so the numbers of the
+ * targets can be compared. Every benchmark reports the min, the median and
+ * the max over the samples in us, one JSON object per line:
+ *
+ *   platform_bench [samples]
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+#include <px4_posix.h>
+#include <px4_tasks.h>
+#include <px4_workqueue.h>
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+
+#include <errno.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__PX4_QURT)
+#  define BENCH_PLATFORM	"qurt"
+#elif defined(__PX4_POSIX)
+#  define BENCH_PLATFORM	"posix"
+#else
+#  define BENCH_PLATFORM	"nuttx"
+#endif
+
+/* the helper tasks run above the command, so a wakeup is a context switch */
+#define BENCH_HELPER_PRIORITY	(SCHED_PRIORITY_MAX - 10)
+#define BENCH_HELPER_STACK	1200
+
+/* the HRT callouts are scheduled this far ahead */
+#define BENCH_CALLOUT_DELAY	1000
+
+#define BENCH_SAMPLES_MAX	200
+
+struct platform_bench_s {
+	unsigned seq;
+	hrt_abstime time;
+};
+
+ORB_DEFINE(platform_bench_ping, struct platform_bench_s);
+ORB_DEFINE(platform_bench_pong, struct platform_bench_s);
+
+extern "C" __EXPORT int platform_bench_main(int argc, char *argv[]);
+
+namespace
+{
+
+int32_t samples[BENCH_SAMPLES_MAX];
+unsigned sample_count;
+
+sem_t wake_sem;
+sem_t ack_sem;
+
+/* set by the task, callout or work item being measured */
+volatile hrt_abstime wake_time;
+volatile bool helper_exit;
+
+struct hrt_call callout;
+struct work_s work;
+
+void wait_sem(sem_t *sem)
+{
+	while (sem_wait(sem) != 0 && errno == EINTR) {
+	}
+}
+
+int compare_samples(const void *a, const void *b)
+{
+	int32_t sa = *(const int32_t *)a;
+	int32_t sb = *(const int32_t *)b;
+
+	return (sa > sb) - (sa < sb);
+}
+
+void report(const char *name, unsigned missed = 0)
+{
+	if (sample_count == 0) {
+		printf("{\"name\": \"%s\", \"platform\": \"%s\", \"samples\": 0}\n", name, BENCH_PLATFORM);
+		return;
+	}
+
+	qsort(samples, sample_count, sizeof(samples[0]), compare_samples);
+
+	printf("{\"name\": \"%s\", \"platform\": \"%s\", \"samples\": %u, \"missed\": %u, "
+	       "\"us_min\": %d, \"us_median\": %d, \"us_max\": %d}\n",
+	       name, BENCH_PLATFORM, sample_count, missed,
+	       (int)samples[0], (int)samples[sample_count / 2], (int)samples[sample_count - 1]);
+}
+
+/*
+ * task spawn: from px4_task_spawn_cmd() to the entry point running
+ */
+int spawn_entry(int argc, char *argv[])
+{
+	wake_time = hrt_absolute_time();
+	sem_post(&ack_sem);
+	return 0;
+}
+
+void bench_task_spawn(unsigned count)
+{
+	sample_count = 0;
+
+	for (unsigned i = 0; i < count; i++) {
+		hrt_abstime start = hrt_absolute_time();
+
+		if (px4_task_spawn_cmd("bench_spawn", SCHED_DEFAULT, BENCH_HELPER_PRIORITY, BENCH_HELPER_STACK,
+				       spawn_entry, nullptr) < 0) {
+			break;
+		}
+
+		wait_sem(&ack_sem);
+		samples[sample_count++] = wake_time - start;
+
+		/* let the task exit and release its stack before the next spawn */
+		usleep(2000);
+	}
+
+	report("task_spawn", count - sample_count);
+}
+
+/*
+ * semaphore wake: from sem_post() to the waiting task running
+ */
+int sem_entry(int argc, char *argv[])
+{
+	while (true) {
+		wait_sem(&wake_sem);
+		wake_time = hrt_absolute_time();
+
+		if (helper_exit) {
+			break;
+		}
+
+		sem_post(&ack_sem);
+	}
+
+	return 0;
+}
+
+void bench_sem_wake(unsigned count)
+{
+	sample_count = 0;
+	helper_exit = false;
+
+	if (px4_task_spawn_cmd("bench_sem", SCHED_DEFAULT, BENCH_HELPER_PRIORITY, BENCH_HELPER_STACK,
+			       sem_entry, nullptr) < 0) {
+		report("sem_wake", count);
+		return;
+	}
+
+	/* the helper blocks on the semaphore long before the first post */
+	usleep(10000);
+
+	for (unsigned i = 0; i < count; i++) {
+		hrt_abstime start = hrt_absolute_time();
+		sem_post(&wake_sem);
+		wait_sem(&ack_sem);
+		samples[sample_count++] = wake_time - start;
+	}
+
+	helper_exit = true;
+	sem_post(&wake_sem);
+	usleep(2000);
+
+	report("sem_wake");
+}
+
+/*
+ * HRT callout jitter: how late a callout fires after its deadline
+ */
+void callout_entry(void *arg)
+{
+	wake_time = hrt_absolute_time();
+	sem_post(&ack_sem);
+}
+
+void bench_hrt_callout(unsigned count)
+{
+	sample_count = 0;
+	memset(&callout, 0, sizeof(callout));
+
+	for (unsigned i = 0; i < count; i++) {
+		hrt_abstime deadline = hrt_absolute_time() + BENCH_CALLOUT_DELAY;
+		hrt_call_at(&callout, deadline, callout_entry, nullptr);
+		wait_sem(&ack_sem);
+		samples[sample_count++] = (int64_t)(wake_time - deadline);
+	}
+
+	hrt_cancel(&callout);
+
+	report("hrt_callout_jitter");
+}
+
+/*
+ * work queue dispatch: from work_queue() to the HPWORK item running
+ */
+void work_entry(void *arg)
+{
+	wake_time = hrt_absolute_time();
+	sem_post(&ack_sem);
+}
+
+void bench_work_queue(unsigned count)
+{
+	sample_count = 0;
+	memset(&work, 0, sizeof(work));
+
+	for (unsigned i = 0; i < count; i++) {
+		hrt_abstime start = hrt_absolute_time();
+		work_queue(HPWORK, &work, (worker_t)&work_entry, nullptr, 0);
+		wait_sem(&ack_sem);
+		samples[sample_count++] = wake_time - start;
+	}
+
+	report("work_queue_dispatch");
+}
+
+/*
+ * uORB round trip: a ping published here, copied and published back by the
+ * helper task, until the pong is copied here
+ */
+int echo_entry(int argc, char *argv[])
+{
+	int ping_sub = orb_subscribe(ORB_ID(platform_bench_ping));
+	struct platform_bench_s msg = {};
+	orb_advert_t pong_pub = orb_advertise(ORB_ID(platform_bench_pong), &msg);
+
+	sem_post(&ack_sem);
+
+	px4_pollfd_struct_t fds[1];
+	fds[0].fd = ping_sub;
+	fds[0].events = POLLIN;
+
+	while (!helper_exit) {
+		if (px4_poll(fds, 1, 100) > 0) {
+			orb_copy(ORB_ID(platform_bench_ping), ping_sub, &msg);
+			orb_publish(ORB_ID(platform_bench_pong), pong_pub, &msg);
+		}
+	}
+
+	orb_unsubscribe(ping_sub);
+	sem_post(&ack_sem);
+	return 0;
+}
+
+void bench_uorb_round_trip(unsigned count)
+{
+	sample_count = 0;
+	helper_exit = false;
+
+	struct platform_bench_s msg = {};
+	orb_advert_t ping_pub = orb_advertise(ORB_ID(platform_bench_ping), &msg);
+	int pong_sub = orb_subscribe(ORB_ID(platform_bench_pong));
+
+	if (px4_task_spawn_cmd("bench_echo", SCHED_DEFAULT, BENCH_HELPER_PRIORITY, BENCH_HELPER_STACK,
+			       echo_entry, nullptr) < 0) {
+		orb_unsubscribe(pong_sub);
+		report("uorb_round_trip", count);
+		return;
+	}
+
+	wait_sem(&ack_sem);
+
+	/* the initial advertisement of the pong is not an answer */
+	bool updated = false;
+	orb_check(pong_sub, &updated);
+
+	if (updated) {
+		orb_copy(ORB_ID(platform_bench_pong), pong_sub, &msg);
+	}
+
+	px4_pollfd_struct_t fds[1];
+	fds[0].fd = pong_sub;
+	fds[0].events = POLLIN;
+
+	unsigned missed = 0;
+
+	for (unsigned i = 1; i <= count; i++) {
+		msg.seq = i;
+		msg.time = hrt_absolute_time();
+		orb_publish(ORB_ID(platform_bench_ping), ping_pub, &msg);
+
+		struct platform_bench_s pong = {};
+
+		/* a stale pong of a missed ping is skipped */
+		while (pong.seq != i && px4_poll(fds, 1, 100) > 0) {
+			orb_copy(ORB_ID(platform_bench_pong), pong_sub, &pong);
+		}
+
+		if (pong.seq == i) {
+			samples[sample_count++] = hrt_absolute_time() - pong.time;
+
+		} else {
+			missed++;
+		}
+	}
+
+	helper_exit = true;
+	wait_sem(&ack_sem);
+	orb_unsubscribe(pong_sub);
+
+	report("uorb_round_trip", missed);
+}
+
+} // anonymous namespace
+
+int platform_bench_main(int argc, char *argv[])
+{
+	unsigned count = 100;
+
+	if (argc > 1) {
+		count = strtoul(argv[1], nullptr, 10);
+
+		if (count == 0 || count > BENCH_SAMPLES_MAX) {
+			printf("Usage: platform_bench [samples, 1..%u]\n", BENCH_SAMPLES_MAX);
+			return 1;
+		}
+	}
+
+	sem_init(&wake_sem, 0, 0);
+	sem_init(&ack_sem, 0, 0);
+
+	bench_task_spawn(count);
+	bench_sem_wake(count);
+	bench_hrt_callout(count);
+	bench_work_queue(count);
+	bench_uorb_round_trip(count);
+
+	sem_destroy(&wake_sem);
+	sem_destroy(&ack_sem);
+
+	return 0;
+}
@@ -75,7 +75,7 @@ usage(const char *reason)
 
 	errx(1,
 	     "usage:\n"
-	     "pwm arm|disarm|rate|failsafe|disarmed|min|max|test|info  ...\n"
+	     "pwm arm|disarm|rate|oneshot|failsafe|disarmed|min|max|test|info  ...\n"
 	     "\n"
 	     "arm\t\t\t\tArm output\n"
 	     "disarm\t\t\t\tDisarm output\n"
@@ -84,7 +84,10 @@ usage(const char *reason)
 	     "\t[-g <channel group>]\t(e.g. 0,1,2)\n"
 	     "\t[-m <channel mask> ]\t(e.g. 0xF)\n"
 	     "\t[-a]\t\t\tConfigure all outputs\n"
-	     "\t-r <alt_rate>\t\tPWM rate (50 to 400 Hz)\n"
+	     "\t-r <alt_rate>\t\tPWM rate (50 to 400 Hz, 0 for oneshot)\n"
+	     "\n"
+	     "oneshot ...\t\t\tSelect the protocol of rate 0 outputs\n"
+	     "\t-o <protocol>\t\t125, 42 or multishot\n"
 	     "\n"
 	     "failsafe ...\t\t\tFailsafe PWM\n"
 	     "disarmed ...\t\t\tDisarmed PWM\n"
@@ -113,7 +116,7 @@ int
 pwm_main(int argc, char *argv[])
 {
 	const char *dev = PWM_OUTPUT0_DEVICE_PATH;
-	unsigned alt_rate = 0;
+	int alt_rate = -1;
 	uint32_t alt_channel_groups = 0;
 	bool alt_channels_set = false;
 	bool print_verbose = false;
@@ -125,12 +128,13 @@ pwm_main(int argc, char *argv[])
 	unsigned long channels;
 	unsigned single_ch = 0;
 	unsigned pwm_value = 0;
+	int oneshot_protocol = -1;
 
 	if (argc < 2) {
 		usage(NULL);
 	}
 
-	while ((ch = getopt(argc - 1, &argv[1], "d:vc:g:m:ap:r:")) != EOF) {
+	while ((ch = getopt(argc - 1, &argv[1], "d:vc:g:m:ap:r:o:")) != EOF) {
 		switch (ch) {
 
 		case 'd':
@@ -232,6 +236,22 @@ pwm_main(int argc, char *argv[])
 
 			break;
 
+		case 'o':
+			if (!strcmp(optarg, "125")) {
+				oneshot_protocol = PWM_ONESHOT_PROTOCOL_125;
+
+			} else if (!strcmp(optarg, "42")) {
+				oneshot_protocol = PWM_ONESHOT_PROTOCOL_42;
+
+			} else if (!strcmp(optarg, "multishot")) {
+				oneshot_protocol = PWM_ONESHOT_PROTOCOL_MULTISHOT;
+
+			} else {
+				usage("BAD protocol");
+			}
+
+			break;
+
 		default:
 			break;
 		}
@@ -300,10 +320,24 @@ pwm_main(int argc, char *argv[])
 
 		exit(0);
 
+	} else if (!strcmp(argv[1], "oneshot")) {
+
+		if (oneshot_protocol < 0) {
+			usage("no protocol specified");
+		}
+
+		ret = ioctl(fd, PWM_SERVO_SET_ONESHOT_PROTOCOL, oneshot_protocol);
+
+		if (ret != OK) {
+			err(1, "PWM_SERVO_SET_ONESHOT_PROTOCOL");
+		}
+
+		exit(0);
+
 	} else if (!strcmp(argv[1], "rate")) {
 
 		/* change alternate PWM rate */
-		if (alt_rate > 0) {
+		if (alt_rate >= 0) {
 			ret = ioctl(fd, PWM_SERVO_SET_UPDATE_RATE, alt_rate);
 
 			if (ret != OK) {
@@ -753,6 +787,17 @@ pwm_main(int argc, char *argv[])
 			err(1, "PWM_SERVO_GET_SELECT_UPDATE_RATE");
 		}
 
+		uint32_t info_oneshot_protocol;
+
+		ret = ioctl(fd, PWM_SERVO_GET_ONESHOT_PROTOCOL, (unsigned long)&info_oneshot_protocol);
+
+		if (ret == OK) {
+			static const char *const protocol_names[] = { "oneshot125", "oneshot42", "multishot" };
+
+			printf("oneshot protocol: %s\n", (info_oneshot_protocol <= PWM_ONESHOT_PROTOCOL_MULTISHOT) ?
+			       protocol_names[info_oneshot_protocol] : "unknown");
+		}
+
 		struct pwm_output_values failsafe_pwm;
 
 		struct pwm_output_values disarmed_pwm;
@@ -794,11 +839,14 @@ pwm_main(int argc, char *argv[])
 			if (ret == OK) {
 				printf("channel %u: %u us", i + 1, spos);
 
-				if (info_alt_rate_mask & (1 << i)) {
-					printf(" (alternative rate: %d Hz", info_alt_rate);
+				bool alt = (info_alt_rate_mask & (1 << i));
+				uint32_t rate = alt ? info_alt_rate : info_default_rate;
+
+				if (rate == PWM_RATE_ONESHOT) {
+					printf(" (%s rate: oneshot", alt ? "alternative" : "default");
 
 				} else {
-					printf(" (default rate: %d Hz", info_default_rate);
+					printf(" (%s rate: %u Hz", alt ? "alternative" : "default", (unsigned)rate);
 				}
 
 
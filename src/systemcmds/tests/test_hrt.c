@@ -61,6 +61,9 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#define CALLOUT_COUNT	64
+#define CALLOUT_ROUNDS	100
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -73,6 +76,11 @@
  * Private Data
  ****************************************************************************/
 
+static struct hrt_call callouts[CALLOUT_COUNT];
+static volatile unsigned callout_hits;
+static volatile hrt_abstime callout_first;
+static volatile hrt_abstime callout_last;
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -81,6 +89,79 @@
  * Private Functions
  ****************************************************************************/
 
+static void callout_hit(void *arg)
+{
+	hrt_abstime now = hrt_absolute_time();
+
+	if (callout_hits++ == 0) {
+		callout_first = now;
+	}
+
+	callout_last = now;
+}
+
+/*
+ * Time entering, cancelling and invoking CALLOUT_COUNT concurrent callouts.
+ */
+static int test_hrt_callouts(void)
+{
+	hrt_abstime start, enter_time = 0, cancel_time = 0;
+	unsigned i, round;
+
+	for (i = 0; i < CALLOUT_COUNT; i++) {
+		hrt_call_init(&callouts[i]);
+	}
+
+	for (round = 0; round < CALLOUT_ROUNDS; round++) {
+		/* far enough out to not fire, in scrambled deadline order */
+		hrt_abstime base = hrt_absolute_time() + 1000000;
+
+		start = hrt_absolute_time();
+
+		for (i = 0; i < CALLOUT_COUNT; i++) {
+			hrt_call_at(&callouts[i], base + ((i * 37) % CALLOUT_COUNT) * 1000, callout_hit, NULL);
+		}
+
+		enter_time += hrt_absolute_time() - start;
+		start = hrt_absolute_time();
+
+		for (i = 0; i < CALLOUT_COUNT; i++) {
+			hrt_cancel(&callouts[(i * 11) % CALLOUT_COUNT]);
+		}
+
+		cancel_time += hrt_absolute_time() - start;
+	}
+
+	/* all due at once, the spread between the first and the last call is the invoke cost */
+	callout_hits = 0;
+	hrt_abstime deadline = hrt_absolute_time() + 20000;
+
+	for (i = 0; i < CALLOUT_COUNT; i++) {
+		hrt_call_at(&callouts[i], deadline, callout_hit, NULL);
+	}
+
+	for (i = 0; i < 100 && callout_hits < CALLOUT_COUNT; i++) {
+		usleep(10000);
+	}
+
+	if (callout_hits != CALLOUT_COUNT) {
+		for (i = 0; i < CALLOUT_COUNT; i++) {
+			hrt_cancel(&callouts[i]);
+		}
+
+		printf("callouts: only %u of %u invoked\n", callout_hits, CALLOUT_COUNT);
+		return 1;
+	}
+
+	printf("callouts (%u concurrent): enter %.2f us, cancel %.2f us, invoke %.2f us per call\n",
+	       CALLOUT_COUNT,
+	       (double)enter_time / (CALLOUT_ROUNDS * CALLOUT_COUNT),
+	       (double)cancel_time / (CALLOUT_ROUNDS * CALLOUT_COUNT),
+	       (double)(callout_last - callout_first) / (CALLOUT_COUNT - 1));
+	fflush(stdout);
+
+	return 0;
+}
 
 /****************************************************************************
  * Public Functions
@@ -188,6 +269,8 @@ int test_hrt(int argc, char *argv[])
 	int i;
 	struct timeval tv1, tv2;
 
+	hrt_call_init(&call);
+
 	printf("start-time (hrt, sec/usec), end-time (hrt, sec/usec), microseconds per half second\n");
 
 	for (i = 0; i < 10; i++) {
@@ -218,5 +301,5 @@ int test_hrt(int argc, char *argv[])
 		fflush(stdout);
 	}
 
-	return 0;
+	return test_hrt_callouts();
 }
@@ -144,6 +144,69 @@ int test_mathlib(int argc, char *argv[])
 		TEST_OP("Matrix<3, 3> * Vector<3>", m1 * v1);
 		TEST_OP("Matrix<3, 3> + Matrix<3, 3>", m1 + m2);
 		TEST_OP("Matrix<3, 3> * Matrix<3, 3>", m1 * m2);
+		TEST_OP("Matrix<3, 3> = Matrix<3, 3>.transposed()", m2 = m1.transposed());
+		TEST_OP("Matrix<3, 3>.transposed() * Matrix<3, 3>", m1.transposed() * m2);
+		TEST_OP("Matrix<3, 3> * Matrix<3, 3>.transposed()", m1 * m2.transposed());
+		TEST_OP("Matrix<3, 3>.transposed() * Vector<3>", m1.transposed() * v1);
+	}
+
+	{
+		PX4_INFO("Transposed matrix operations test");
+		// the lazily transposed products must match the ones of an explicit transpose
+
+		Matrix<3, 3> R;
+		Matrix<3, 3> R_sp;
+		R.from_euler(0.3f, -0.2f, 1.1f);
+		R_sp.from_euler(-0.5f, 0.1f, 0.4f);
+
+		Matrix<3, 3> R_t;
+		Matrix<3, 3> R_sp_t;
+
+		for (unsigned i = 0; i < 3; i++) {
+			for (unsigned j = 0; j < 3; j++) {
+				R_t.data[i][j] = R.data[j][i];
+				R_sp_t.data[i][j] = R_sp.data[j][i];
+			}
+		}
+
+		Matrix<3, 3> R_t_conv = R.transposed();
+
+		if (R_t_conv != R_t) {
+			PX4_ERR("Matrix<3, 3>.transposed() failed!");
+			rc = 1;
+		}
+
+		Matrix<3, 3> products[3] = {R.transposed() * R_sp, R * R_sp.transposed(), R.transposed() * R_sp.transposed()};
+		Matrix<3, 3> expected[3] = {R_t * R_sp, R * R_sp_t, R_t * R_sp_t};
+
+		for (unsigned k = 0; k < 3; k++) {
+			for (unsigned i = 0; i < 3; i++) {
+				for (unsigned j = 0; j < 3; j++) {
+					if (fabsf(products[k].data[i][j] - expected[k].data[i][j]) > 0.00001f) {
+						PX4_ERR("Transposed Matrix<3, 3> product %u failed!", k);
+						rc = 1;
+					}
+				}
+			}
+		}
+
+		Vector<3> v(1.0f, 2.0f, 3.0f);
+
+		if ((R.transposed() * v - R_t * v).length() > 0.00001f) {
+			PX4_ERR("Matrix<3, 3>.transposed() * Vector<3> failed!");
+			rc = 1;
+		}
+
+		float data[2][3] = {{1, 2, 3}, {4, 5, 6}};
+		float data_mt[2][2] = {{14, 32}, {32, 77}};
+		Matrix<2, 3> m(data);
+		Matrix<2, 2> mt(data_mt);
+
+		if (m * m.transposed() != mt) {
+			PX4_ERR("Matrix<2, 3> * Matrix<2, 3>.transposed() failed!");
+			(m * m.transposed()).print();
+			rc = 1;
+		}
 	}
 
 	{
@@ -359,5 +422,45 @@ int test_mathlib(int argc, char *argv[])
 			}
 		}
 	}
+
+	{
+		// test the in place integration and normalization against the generic versions
+		Vector<3> rates = {0.5f, -1.2f, 2.0f};
+		Quaternion q;
+		Quaternion q_ref;
+		float dt = 0.004f;
+		float tol = 0.00001f;
+
+		PX4_INFO("Quaternion integration method test.");
+
+		q.from_euler(0.3f, 0.2f, 0.1f);
+		q_ref = q;
+
+		for (unsigned n = 0; n < 1000; n++) {
+			q.integrate(rates, dt);
+			q.normalize_fast();
+			q_ref += q_ref.derivative(rates) * dt;
+			q_ref.normalize();
+		}
+
+		for (unsigned i = 0; i < 4; i++) {
+			if (fabsf(q.data[i] - q_ref.data[i]) > tol) {
+				PX4_WARN("Quaternion method 'integrate' or 'normalize_fast' outside tolerance");
+				rc = 1;
+			}
+		}
+
+		Quaternion q_large = {2.0f, 0.0f, 0.0f, 0.0f};
+		q_large.normalize_fast();
+
+		if (fabsf(q_large.length() - 1.0f) > tol) {
+			PX4_WARN("Quaternion method 'normalize_fast' outside tolerance");
+			rc = 1;
+		}
+
+		TEST_OP("Quaternion += derivative() * dt, normalize()", q_ref += q_ref.derivative(rates) * dt; q_ref.normalize());
+		TEST_OP("Quaternion integrate(), normalize_fast()", q.integrate(rates, dt); q.normalize_fast());
+	}
+
 	return rc;
 }
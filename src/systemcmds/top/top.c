@@ -64,6 +64,11 @@ top_main(int argc, char *argv[])
 	struct print_load_s load;
 	init_print_load_s(curr_time, &load);
 
+	if (argc > 1 && !strcmp(argv[1], "stack")) {
+		print_stack_usage(1);
+		return 0;
+	}
+
 	/* clear screen */
 	dprintf(1, "\033[2J\n");
 
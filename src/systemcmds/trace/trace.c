@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file trace.c
+ *
+ * Start, stop and dump the trace event ring buffer, see systemlib/trace.h.
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "systemlib/trace.h"
+
+static const char *default_dump_path = PX4_ROOTFSDIR"/fs/microsd/trace.bin";
+
+__EXPORT int trace_main(int argc, char *argv[]);
+
+int trace_main(int argc, char *argv[])
+{
+	if (argc > 1) {
+		if (strcmp(argv[1], "start") == 0 || strcmp(argv[1], "stop") == 0) {
+			if (trace_enable(strcmp(argv[1], "start") == 0) != 0) {
+				printf("trace: not supported, build with CONFIG_TRACE\n");
+				return -1;
+			}
+
+			return 0;
+
+		} else if (strcmp(argv[1], "status") == 0) {
+			printf("trace: %s, %u events\n", trace_enabled() ? "running" : "stopped", CONFIG_TRACE_EVENTS);
+			return 0;
+
+		} else if (strcmp(argv[1], "dump") == 0) {
+			const char *path = (argc > 2) ? argv[2] : default_dump_path;
+			int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+			if (fd < 0) {
+				printf("trace: can't open %s\n", path);
+				return -1;
+			}
+
+			/* stop recording, so that the events do not change underneath */
+			trace_enable(false);
+			int ret = trace_dump(fd);
+			close(fd);
+
+			if (ret < 0) {
+				printf("trace: dump failed (%d)\n", ret);
+				return -1;
+			}
+
+			printf("trace: %d events written to %s\n", ret, path);
+			return 0;
+		}
+	}
+
+	printf("Usage: trace [start | stop | status | dump [<file>]]\n");
+	return -1;
+}
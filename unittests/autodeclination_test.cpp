@@ -16,3 +16,32 @@ TEST(AutoDeclinationTest, AutoDeclination)
 {
 	ASSERT_NEAR(get_mag_declination(47.0, 8.0), 0.6, 0.5) << "declination differs more than 1 degree";
 }
+
+TEST(AutoDeclinationTest, CellCache)
+{
+	/* repeated calls within a cell and calls alternating between cells agree */
+	float zurich = get_mag_declination(47.0, 8.0);
+	float sydney = get_mag_declination(-33.9, 151.2);
+	EXPECT_EQ(zurich, get_mag_declination(47.0, 8.0));
+	EXPECT_EQ(sydney, get_mag_declination(-33.9, 151.2));
+	EXPECT_EQ(zurich, get_mag_declination(47.0, 8.0));
+	ASSERT_NEAR(sydney, 12.5, 1.5) << "declination differs more than 1.5 degrees";
+
+	/* continuous across cell borders, including negative coordinates */
+	const float border[][2] = {{40.0f, 5.0f}, {-10.0f, -20.0f}, {0.0f, 0.0f}, {-30.0f, 120.0f}};
+
+	for (unsigned i = 0; i < sizeof(border) / sizeof(border[0]); i++) {
+		float lat = border[i][0];
+		float lon = border[i][1];
+		float center = get_mag_declination(lat, lon);
+		EXPECT_NEAR(center, get_mag_declination(lat - 0.001f, lon), 0.01f);
+		EXPECT_NEAR(center, get_mag_declination(lat, lon - 0.001f), 0.01f);
+		EXPECT_NEAR(center, get_mag_declination(lat + 0.001f, lon + 0.001f), 0.01f);
+	}
+
+	/* the table bounds are held, outside the valid range zero is returned */
+	EXPECT_EQ(get_mag_declination(-60.0, 30.0), get_mag_declination(-80.0, 30.0));
+	EXPECT_EQ(get_mag_declination(60.0, 180.0), get_mag_declination(89.0, 180.0));
+	EXPECT_EQ(0.0f, get_mag_declination(91.0, 0.0));
+	EXPECT_EQ(0.0f, get_mag_declination(0.0, -181.0));
+}
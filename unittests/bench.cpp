@@ -0,0 +1,434 @@
+/*
+ * Host benchmarks of the flight code kernels.
+ *
+ * Every benchmark runs a fixed number of iterations per repetition, so the
+ * work done is the same from commit to commit, and reports the fastest and
+ * the median repetition in ns per iteration as JSON, by default on stdout:
+ *
+ *   bench [output.json]
+ */
+
+#include <drivers/drv_hrt.h>
+#include <lib/geo/geo.h>
+#include <mathlib/mathlib.h>
+#include <mathlib/math/GaussNoise.hpp>
+#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <modules/attitude_estimator_ekf/attitude_ekf.h>
+#include <modules/ekf_att_pos_estimator/estimator_22states.h>
+#include <rc/st24.h>
+#include <rc/sumd.h>
+#include <systemlib/mixer/mixer.h>
+#include <systemlib/param/param.h>
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+#include <modules/attitude_estimator_ekf/codegen/AttitudeEKF.h>
+}
+
+/* the estimator takes its time base from the application */
+static uint64_t fake_time_us;
+
+uint32_t millis()
+{
+	return fake_time_us / 1000;
+}
+
+uint64_t getMicros()
+{
+	return fake_time_us;
+}
+
+/* the parameters are provided by the application in unit test builds */
+struct param_info_s	param_array[256];
+struct param_info_s	*param_info_base;
+struct param_info_s	*param_info_limit;
+
+namespace
+{
+
+const unsigned repetitions = 7;
+
+/* keeps the compiler from dropping the results of the benchmarked code */
+volatile float sink;
+
+FILE *out;
+bool first_result = true;
+
+template<typename F>
+void bench(const char *name, unsigned iterations, F &&kernel)
+{
+	double ns_per_iter[repetitions];
+
+	/* warm up the caches and the branch predictor */
+	for (unsigned i = 0; i < iterations / 10; i++) {
+		kernel(i);
+	}
+
+	for (unsigned r = 0; r < repetitions; r++) {
+		hrt_abstime start = hrt_absolute_time();
+
+		for (unsigned i = 0; i < iterations; i++) {
+			kernel(i);
+		}
+
+		ns_per_iter[r] = (hrt_absolute_time() - start) * 1000.0 / iterations;
+	}
+
+	std::sort(&ns_per_iter[0], &ns_per_iter[repetitions]);
+
+	fprintf(out, "%s\n    {\"name\": \"%s\", \"iterations\": %u, \"repetitions\": %u, "
+		"\"ns_per_iter_min\": %.1f, \"ns_per_iter_median\": %.1f}",
+		first_result ? "" : ",", name, iterations, repetitions,
+		ns_per_iter[0], ns_per_iter[repetitions / 2]);
+	first_result = false;
+}
+
+float controls[8];
+
+int mixer_control(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &control)
+{
+	control = controls[control_index];
+	return 0;
+}
+
+int mixer_control_fixed(uintptr_t handle, uint8_t control_group, uint8_t control_index, int32_t &control)
+{
+	control = Mixer::float_to_fixed(controls[control_index]);
+	return 0;
+}
+
+void bench_mixer()
+{
+	/* the quad wide main mixer plus the gimbal passthrough of quad_w.main.mix */
+	char buf[] =
+		"R: 4w 10000 10000 10000 0\n"
+		"M: 1\n"
+		"O:      10000  10000      0 -10000  10000\n"
+		"S: 0 4  10000  10000      0 -10000  10000\n"
+		"M: 1\n"
+		"O:      10000  10000      0 -10000  10000\n"
+		"S: 0 5  10000  10000      0 -10000  10000\n"
+		"M: 1\n"
+		"O:      10000  10000      0 -10000  10000\n"
+		"S: 0 6  10000  10000      0 -10000  10000\n"
+		"M: 1\n"
+		"O:      10000  10000      0 -10000  10000\n"
+		"S: 0 7  10000  10000      0 -10000  10000\n";
+	unsigned buflen = strlen(buf);
+
+	MixerGroup group(mixer_control, 0);
+	group.load_from_buf(buf, buflen);
+
+	float outputs[8];
+
+	bench("mixer_group_mix_quad_w", 100000, [&](unsigned i) {
+		controls[0] = 0.1f * sinf(i * 0.01f);
+		controls[1] = 0.1f * cosf(i * 0.01f);
+		controls[2] = 0.05f;
+		controls[3] = 0.5f;
+		group.mix(outputs, 8, nullptr);
+		sink = outputs[0];
+	});
+
+	/* the same mix as px4io runs it */
+	int32_t fixed_outputs[8];
+
+	bench("mixer_group_mix_fixed_quad_w", 100000, [&](unsigned i) {
+		controls[0] = 0.1f * sinf(i * 0.01f);
+		controls[1] = 0.1f * cosf(i * 0.01f);
+		controls[2] = 0.05f;
+		controls[3] = 0.5f;
+		group.mix_fixed(fixed_outputs, 8, nullptr, mixer_control_fixed);
+		sink = fixed_outputs[0];
+	});
+}
+
+void bench_matrix()
+{
+	math::Matrix<3, 3> R;
+	math::Matrix<3, 3> R_sp;
+	math::Vector<3> v(0.1f, 0.2f, 0.3f);
+	R.from_euler(0.1f, 0.2f, 0.3f);
+	R_sp.from_euler(0.2f, -0.1f, 0.5f);
+
+	/* every kernel takes an input depending on the iteration, so none is hoisted out of the loop */
+	bench("matrix3_mul_matrix3", 1000000, [&](unsigned i) {
+		R_sp(0, 0) = i * 1e-6f;
+		math::Matrix<3, 3> res = R * R_sp;
+		sink = res(0, 0);
+	});
+
+	bench("matrix3_transposed_mul_matrix3", 1000000, [&](unsigned i) {
+		R_sp(0, 0) = i * 1e-6f;
+		math::Matrix<3, 3> res = R.transposed() * R_sp;
+		sink = res(0, 0);
+	});
+
+	bench("matrix3_mul_vector3", 1000000, [&](unsigned i) {
+		v(0) = i * 1e-6f;
+		math::Vector<3> res = R * v;
+		sink = res(0);
+	});
+
+	bench("matrix3_inversed", 200000, [&](unsigned i) {
+		R(2, 2) = 1.0f + i * 1e-7f;
+		math::Matrix<3, 3> res = R.inversed();
+		sink = res(0, 0);
+	});
+
+	R.from_euler(0.1f, 0.2f, 0.3f);
+
+	bench("quaternion_from_dcm", 1000000, [&](unsigned i) {
+		R(0, 0) = 0.9f + i * 1e-8f;
+		math::Quaternion q;
+		q.from_dcm(R);
+		sink = q(0);
+	});
+}
+
+void bench_filter()
+{
+	math::LowPassFilter2p lpf(1000.0f, 30.0f);
+
+	bench("lowpass_filter_2p_apply", 1000000, [&](unsigned i) {
+		sink = lpf.apply((i & 1) ? 1.0f : -1.0f);
+	});
+}
+
+void bench_noise()
+{
+	math::GaussNoise noise(1234);
+	float samples[3];
+
+	/* the noise of one 3 axis sensor sample */
+	bench("gauss_noise_fill_3", 1000000, [&](unsigned i) {
+		noise.fill(samples, 3, 0.0f, 0.01f);
+		sink = samples[0];
+	});
+
+	bench("gauss_noise_next", 1000000, [&](unsigned i) {
+		sink = noise.next();
+	});
+}
+
+void bench_geo()
+{
+	struct map_projection_reference_s ref;
+	map_projection_init(&ref, 47.3977, 8.5456);
+
+	bench("map_projection_project", 1000000, [&](unsigned i) {
+		float x, y;
+		map_projection_project(&ref, 47.3977 + i * 1e-9, 8.5456, &x, &y);
+		sink = x;
+	});
+
+	bench("map_projection_reproject", 1000000, [&](unsigned i) {
+		double lat, lon;
+		map_projection_reproject(&ref, 10.0f + i * 1e-6f, 20.0f, &lat, &lon);
+		sink = lat;
+	});
+
+	bench("map_projection_project_fast", 1000000, [&](unsigned i) {
+		float x, y;
+		map_projection_project_fast(&ref, 47.3977 + i * 1e-9, 8.5456, &x, &y);
+		sink = x;
+	});
+
+	bench("map_projection_reproject_fast", 1000000, [&](unsigned i) {
+		double lat, lon;
+		map_projection_reproject_fast(&ref, 10.0f + i * 1e-6f, 20.0f, &lat, &lon);
+		sink = lat;
+	});
+
+	bench("get_distance_to_next_waypoint", 1000000, [&](unsigned i) {
+		sink = get_distance_to_next_waypoint(47.3977, 8.5456, 47.3977 + i * 1e-9, 8.5466);
+	});
+
+	bench("get_bearing_to_next_waypoint", 1000000, [&](unsigned i) {
+		sink = get_bearing_to_next_waypoint(47.3977, 8.5456, 47.3977 + i * 1e-9, 8.5466);
+	});
+}
+
+void bench_ekf()
+{
+	AttPosEKF *ekf = new AttPosEKF();
+
+	float vel[3] = {0.0f, 0.0f, 0.0f};
+	ekf->useCompass = true;
+	ekf->useAirspeed = true;
+	ekf->setIsFixedWing(true);
+	ekf->dtIMU = 0.004f;
+	ekf->magData = Vector3f(0.2f, 0.05f, 0.4f);
+	ekf->InitialiseFilter(vel, 0.8, 0.15, 400.0f, 0.05f);
+	ekf->setOnGround(false);
+
+	const float dt = 0.004f;
+
+	/* a gentle constant manoeuvre, so the state stays bounded however long it runs */
+	ekf->dAngIMU = Vector3f(dt * 0.01f, dt * 0.02f, dt * 0.01f);
+	ekf->dVelIMU = Vector3f(0.0f, 0.0f, dt * -9.81f);
+	ekf->angRate = ekf->dAngIMU / dt;
+	ekf->accel = ekf->dVelIMU / dt;
+
+	bench("ekf_strapdown", 100000, [&](unsigned i) {
+		fake_time_us += dt * 1e6f;
+		ekf->UpdateStrapdownEquationsNED();
+		ekf->StoreStates(millis());
+		sink = ekf->states[0];
+	});
+
+	bench("ekf_covariance_prediction", 5000, [&](unsigned i) {
+		ekf->summedDelAng = ekf->correctedDelAng;
+		ekf->summedDelVel = ekf->dVelIMU;
+		ekf->CovariancePrediction(dt);
+		sink = ekf->P[0][0];
+	});
+
+	bench("ekf_fuse_velpos", 5000, [&](unsigned i) {
+		ekf->velNED[0] = 0.0f;
+		ekf->velNED[1] = 0.0f;
+		ekf->velNED[2] = 0.0f;
+		ekf->posNE[0] = 0.0f;
+		ekf->posNE[1] = 0.0f;
+		ekf->hgtMea = 0.0f;
+		ekf->fuseVelData = true;
+		ekf->fusePosData = true;
+		ekf->fuseHgtData = true;
+		ekf->RecallStates(ekf->statesAtVelTime, millis());
+		ekf->RecallStates(ekf->statesAtPosTime, millis());
+		ekf->RecallStates(ekf->statesAtHgtTime, millis());
+		ekf->FuseVelposNED();
+		sink = ekf->states[4];
+	});
+
+	/* the three axes of one mag sample */
+	bench("ekf_fuse_magnetometer", 5000, [&](unsigned i) {
+		ekf->fuseMagData = true;
+		ekf->RecallStates(ekf->statesAtMagMeasTime, millis());
+		ekf->magstate.obsIndex = 0;
+		ekf->FuseMagnetometer();
+		ekf->FuseMagnetometer();
+		ekf->FuseMagnetometer();
+		sink = ekf->states[0];
+	});
+
+	bench("ekf_fuse_airspeed", 5000, [&](unsigned i) {
+		ekf->VtasMeas = 20.0f;
+		ekf->fuseVtasData = true;
+		ekf->RecallStates(ekf->statesAtVtasMeasTime, millis());
+		ekf->FuseAirspeed();
+		sink = ekf->states[4];
+	});
+
+	delete ekf;
+}
+
+void bench_attitude_ekf()
+{
+	const float J[9] = {0.0018f, 0.0f, 0.0f, 0.0f, 0.0018f, 0.0f, 0.0f, 0.0f, 0.0037f};
+	const uint8_t zFlag[3] = {1, 1, 1};
+	float z[9] = {0.01f, -0.02f, 0.01f, 0.1f, -0.2f, -9.8f, 0.2f, 0.0f, 0.4f};
+	float x[12], P[144], R[9], euler[3], debug[4];
+
+	/* the generated code it replaces, for comparison */
+	AttitudeEKF_initialize();
+
+	bench("attitude_ekf_codegen", 20000, [&](unsigned i) {
+		z[0] = 0.01f * sinf(i * 0.01f);
+		AttitudeEKF(0, 0, zFlag, 0.004f, z, 1e-4f, 0.08f, 0.009f, 0.005f, 0.0008f, 10000.0f, 100.0f, J,
+			    x, P, R, euler, debug);
+		sink = euler[0];
+	});
+
+	attitude_ekf::initialize();
+
+	bench("attitude_ekf_update", 20000, [&](unsigned i) {
+		z[0] = 0.01f * sinf(i * 0.01f);
+		attitude_ekf::update(0, 0, zFlag, 0.004f, z, 1e-4f, 0.08f, 0.009f, 0.005f, 0.0008f, 10000.0f, 100.0f, J,
+				     x, P, R, euler, debug);
+		sink = euler[0];
+	});
+}
+
+void bench_param()
+{
+	/* a table of the size of a full build, param_find() bisects the sorted names */
+	const unsigned count = sizeof(param_array) / sizeof(param_array[0]);
+	static char names[count][17];
+
+	for (unsigned i = 0; i < count; i++) {
+		snprintf(names[i], sizeof(names[i]), "BENCH_%03u", i);
+		param_array[i].name = names[i];
+		param_array[i].type = PARAM_TYPE_INT32;
+		param_array[i].val.i = i;
+	}
+
+	param_info_base = &param_array[0];
+	param_info_limit = &param_array[count];
+
+	bench("param_find", 1000000, [&](unsigned i) {
+		sink = param_find(names[(i * 97) % count]);
+	});
+}
+
+void bench_rc()
+{
+	uint8_t buf[255];
+
+	for (unsigned i = 0; i < sizeof(buf); i++) {
+		buf[i] = (uint8_t)(i * 37 + 11);
+	}
+
+	/* the longest frame the length field allows */
+	bench("st24_common_crc8_255", 20000, [&](unsigned i) {
+		buf[0] = i;
+		sink = st24_common_crc8(buf, sizeof(buf));
+	});
+
+	uint16_t crc = 0;
+
+	bench("sumd_crc16_byte", 1000000, [&](unsigned i) {
+		crc = sumd_crc16(crc, i);
+		sink = crc;
+	});
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+	out = stdout;
+
+	if (argc > 1) {
+		out = fopen(argv[1], "w");
+
+		if (out == nullptr) {
+			fprintf(stderr, "could not open %s\n", argv[1]);
+			return 1;
+		}
+	}
+
+	fprintf(out, "{\n  \"benchmarks\": [");
+
+	bench_mixer();
+	bench_matrix();
+	bench_filter();
+	bench_noise();
+	bench_geo();
+	bench_ekf();
+	bench_attitude_ekf();
+	bench_param();
+	bench_rc();
+
+	fprintf(out, "\n  ]\n}\n");
+
+	if (out != stdout) {
+		fclose(out);
+	}
+
+	return 0;
+}
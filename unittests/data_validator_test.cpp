@@ -0,0 +1,77 @@
+#include <stdint.h>
+
+#include <ecl/validation/data_validator_group.h>
+
+#include "gtest/gtest.h"
+
+TEST(DataValidatorGroupTest, Failover)
+{
+	DataValidatorGroup group(3);
+	group.set_timeout(20000);
+
+	uint64_t timestamp[3] = {};
+	float val[9] = {};
+	uint32_t error_count[3] = {0, 0, 0};
+	uint32_t priority[3] = {100, 50, 50};
+	int best = -1;
+
+	for (unsigned k = 1; k <= 50; k++) {
+		for (unsigned i = 0; i < 3; i++) {
+			timestamp[i] = k * 1000;
+
+			for (unsigned j = 0; j < 3; j++) {
+				val[i * 3 + j] = 0.01f * (k % 7) + i;
+			}
+		}
+
+		group.put_all(3, timestamp, val, error_count, priority);
+	}
+
+	float *best_val = group.get_best(50000, &best);
+	ASSERT_TRUE(best_val != NULL);
+	EXPECT_EQ(0, best);
+	EXPECT_FLOAT_EQ(val[0], best_val[0]);
+	EXPECT_EQ(0u, group.failover_count());
+	EXPECT_GT(group.get_vibration_factor(50000), 0.0f);
+
+	/* the first sensor stops updating, the group has to fail over */
+	for (unsigned k = 51; k <= 100; k++) {
+		for (unsigned i = 1; i < 3; i++) {
+			timestamp[i] = k * 1000;
+
+			for (unsigned j = 0; j < 3; j++) {
+				val[i * 3 + j] = 0.01f * (k % 7) + i;
+			}
+		}
+
+		group.put_all(3, timestamp, val, error_count, priority);
+	}
+
+	best_val = group.get_best(100000, &best);
+	ASSERT_TRUE(best_val != NULL);
+	EXPECT_EQ(1, best);
+	EXPECT_FLOAT_EQ(val[3], best_val[0]);
+	EXPECT_EQ(1u, group.failover_count());
+}
+
+TEST(DataValidatorGroupTest, StuckValue)
+{
+	DataValidatorGroup group(2);
+
+	float val[3] = {1.0f, 2.0f, 3.0f};
+	float moving[3];
+	int best = -1;
+
+	for (unsigned k = 1; k <= 200; k++) {
+		for (unsigned j = 0; j < 3; j++) {
+			moving[j] = val[j] + 0.01f * (k % 5);
+		}
+
+		/* sensor 0 is preferred but keeps reporting the same value */
+		group.put(0, k * 1000, val, 0, 100);
+		group.put(1, k * 1000, moving, 0, 50);
+	}
+
+	(void)group.get_best(200000, &best);
+	EXPECT_EQ(1, best);
+}
@@ -0,0 +1,133 @@
+#include <math.h>
+#include <stdint.h>
+
+#include <modules/ekf_att_pos_estimator/estimator_22states.h>
+
+#include "gtest/gtest.h"
+
+/* the estimator takes its time base from the application */
+static uint64_t fake_time_us;
+
+uint32_t millis()
+{
+	return fake_time_us / 1000;
+}
+
+uint64_t getMicros()
+{
+	return fake_time_us;
+}
+
+static void check_covariance(const AttPosEKF &ekf)
+{
+	for (unsigned i = 0; i < EKF_STATE_ESTIMATES; i++) {
+		ASSERT_TRUE(isfinite(ekf.P[i][i]));
+		ASSERT_GE(ekf.P[i][i], 0.0f);
+
+		for (unsigned j = 0; j < i; j++) {
+			ASSERT_TRUE(isfinite(ekf.P[i][j]));
+			ASSERT_EQ(ekf.P[i][j], ekf.P[j][i]);
+		}
+	}
+}
+
+TEST(EKFCovarianceTest, SyntheticFlight)
+{
+	AttPosEKF *ekf = new AttPosEKF();
+
+	float vel[3] = {0.0f, 0.0f, 0.0f};
+	ekf->useCompass = true;
+	ekf->useAirspeed = true;
+	ekf->setIsFixedWing(true);
+	ekf->dtIMU = 0.004f;
+	ekf->magData = Vector3f(0.2f, 0.05f, 0.4f);
+	ekf->InitialiseFilter(vel, 0.8, 0.15, 400.0f, 0.05f);
+
+	const float dt = 0.004f;
+	float covariance_dt = 0.0f;
+	unsigned predictions = 0;
+	const unsigned steps = 20000;
+
+	for (unsigned k = 0; k < steps; k++) {
+		float t = k * dt;
+		fake_time_us += dt * 1e6f;
+
+		/* gentle manoeuvres, the wind and mag states are inhibited on every other leg */
+		ekf->setOnGround((k / 5000) % 2 == 1);
+		ekf->dtIMU = dt;
+		ekf->dAngIMU = Vector3f(dt * 0.3f * sinf(t), dt * 0.2f * cosf(0.7f * t), dt * 0.1f);
+		ekf->dVelIMU = Vector3f(dt * 0.5f * sinf(0.3f * t), dt * 0.3f, dt * -9.81f);
+		ekf->angRate = ekf->dAngIMU / dt;
+		ekf->accel = ekf->dVelIMU / dt;
+
+		ekf->UpdateStrapdownEquationsNED();
+		ekf->StoreStates(millis());
+		ekf->summedDelAng = ekf->summedDelAng + ekf->correctedDelAng;
+		ekf->summedDelVel = ekf->summedDelVel + ekf->dVelIMU;
+		covariance_dt += dt;
+
+		if (covariance_dt >= (ekf->covTimeStepMax - dt) || ekf->summedDelAng.length() > ekf->covDelAngMax) {
+			ekf->CovariancePrediction(covariance_dt);
+			predictions++;
+
+			ekf->summedDelAng.zero();
+			ekf->summedDelVel.zero();
+			covariance_dt = 0.0f;
+
+			check_covariance(*ekf);
+		}
+
+		if (k % 50 == 0) {
+			ekf->velNED[0] = 0.1f * sinf(0.1f * t);
+			ekf->velNED[1] = 0.2f;
+			ekf->velNED[2] = 0.0f;
+			ekf->posNE[0] = 0.5f * sinf(0.05f * t);
+			ekf->posNE[1] = 0.2f * t;
+			ekf->fuseVelData = true;
+			ekf->fusePosData = true;
+			ekf->RecallStates(ekf->statesAtVelTime, millis() - 200);
+			ekf->RecallStates(ekf->statesAtPosTime, millis() - 200);
+			ekf->FuseVelposNED();
+			ekf->fuseVelData = false;
+			ekf->fusePosData = false;
+		}
+
+		if (k % 12 == 0) {
+			ekf->hgtMea = 0.1f * sinf(t);
+			ekf->fuseHgtData = true;
+			ekf->RecallStates(ekf->statesAtHgtTime, millis() - 20);
+			ekf->FuseVelposNED();
+			ekf->fuseHgtData = false;
+		}
+
+		if (k % 10 == 0) {
+			ekf->magData = Vector3f(0.2f + 0.01f * sinf(t), 0.05f, 0.4f);
+			ekf->fuseMagData = true;
+			ekf->RecallStates(ekf->statesAtMagMeasTime, millis() - 50);
+			ekf->magstate.obsIndex = 0;
+			ekf->FuseMagnetometer();
+			ekf->FuseMagnetometer();
+			ekf->FuseMagnetometer();
+			ekf->fuseMagData = false;
+		}
+
+		if (k % 25 == 0) {
+			ekf->VtasMeas = 12.0f + sinf(0.2f * t);
+			ekf->fuseVtasData = true;
+			ekf->RecallStates(ekf->statesAtVtasMeasTime, millis() - 100);
+			ekf->FuseAirspeed();
+			ekf->fuseVtasData = false;
+		}
+	}
+
+	check_covariance(*ekf);
+
+	/* the attitude must still be a unit quaternion */
+	float q_norm = sqrtf(ekf->states[0] * ekf->states[0] + ekf->states[1] * ekf->states[1] +
+			     ekf->states[2] * ekf->states[2] + ekf->states[3] * ekf->states[3]);
+	EXPECT_NEAR(1.0f, q_norm, 1e-4f);
+
+	ASSERT_GT(predictions, 0u);
+
+	delete ekf;
+}
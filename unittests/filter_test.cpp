@@ -0,0 +1,86 @@
+#include <math.h>
+
+#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/BiquadFilterBank.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(BiquadFilterBankTest, MatchesLowPassFilter2p)
+{
+	math::LowPassFilter2p reference[3] = {
+		math::LowPassFilter2p(1000.0f, 30.0f),
+		math::LowPassFilter2p(1000.0f, 30.0f),
+		math::LowPassFilter2p(1000.0f, 30.0f)
+	};
+	math::BiquadFilterBank<3> bank(1000.0f, 30.0f);
+
+	for (unsigned k = 0; k < 500; k++) {
+		float sample[3] = {sinf(k * 0.05f), 9.81f + 0.1f * (k % 13), -2.0f * cosf(k * 0.3f)};
+		float expected[3];
+
+		for (unsigned i = 0; i < 3; i++) {
+			expected[i] = reference[i].apply(sample[i]);
+		}
+
+		bank.apply(sample);
+
+		for (unsigned i = 0; i < 3; i++) {
+			EXPECT_FLOAT_EQ(expected[i], sample[i]);
+		}
+	}
+
+	/* a cutoff of 0 passes the samples through */
+	bank.set_cutoff_frequency(1000.0f, 0.0f);
+	float sample[3] = {1.0f, 2.0f, 3.0f};
+	bank.apply(sample);
+	EXPECT_EQ(1.0f, sample[0]);
+	EXPECT_EQ(2.0f, sample[1]);
+	EXPECT_EQ(3.0f, sample[2]);
+}
+
+TEST(BiquadFilterBankTest, Reset)
+{
+	math::BiquadFilterBank<2> bank(1000.0f, 30.0f);
+	bank.set_notch_frequency(80.0f, 20.0f);
+
+	float sample[2] = {9.81f, -1.0f};
+	bank.reset(sample);
+	EXPECT_NEAR(9.81f, sample[0], 1e-4f);
+	EXPECT_NEAR(-1.0f, sample[1], 1e-4f);
+
+	/* the output stays put for a constant input */
+	for (unsigned k = 0; k < 100; k++) {
+		sample[0] = 9.81f;
+		sample[1] = -1.0f;
+		bank.apply(sample);
+		EXPECT_NEAR(9.81f, sample[0], 1e-4f);
+		EXPECT_NEAR(-1.0f, sample[1], 1e-4f);
+	}
+}
+
+TEST(BiquadFilterBankTest, Notch)
+{
+	const float sample_freq = 1000.0f;
+	const float notch_freq = 80.0f;
+	math::BiquadFilterBank<2> bank(sample_freq, 0.0f);
+	bank.set_notch_frequency(notch_freq, 20.0f);
+
+	/* channel 0 at the notch frequency, channel 1 a decade below */
+	float amplitude[2] = {};
+
+	for (unsigned k = 0; k < 2000; k++) {
+		float t = k / sample_freq;
+		float sample[2] = {sinf(2.0f * M_PI_F * notch_freq * t), sinf(2.0f * M_PI_F * notch_freq * 0.1f * t)};
+		bank.apply(sample);
+
+		/* skip the transient */
+		if (k > 1000) {
+			for (unsigned i = 0; i < 2; i++) {
+				amplitude[i] = fmaxf(amplitude[i], fabsf(sample[i]));
+			}
+		}
+	}
+
+	EXPECT_LT(amplitude[0], 0.01f);
+	EXPECT_GT(amplitude[1], 0.95f);
+}
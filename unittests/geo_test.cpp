@@ -0,0 +1,125 @@
+#include <math.h>
+
+#include <geo/geo.h>
+
+#include "gtest/gtest.h"
+
+/* references from the equator to the fallback latitude */
+static const double reference_lat[] = {0.0, -33.9, 47.4, 65.0, 74.0};
+static const float test_distance[] = {10.0f, 100.0f, 1000.0f, 4999.0f};
+static const float fast_max_error = 0.01f;
+
+TEST(GeoTest, ProjectFastAccuracy)
+{
+	struct map_projection_reference_s ref;
+
+	for (unsigned i = 0; i < sizeof(reference_lat) / sizeof(reference_lat[0]); i++) {
+		ASSERT_EQ(0, map_projection_init_timestamped(&ref, reference_lat[i], 8.5, 1));
+
+		for (unsigned j = 0; j < sizeof(test_distance) / sizeof(test_distance[0]); j++) {
+			float max_project = 0.0f;
+			float max_reproject = 0.0f;
+
+			for (unsigned k = 0; k < 36; k++) {
+				float bearing = k * 10.0f * M_DEG_TO_RAD_F;
+				float x = test_distance[j] * cosf(bearing);
+				float y = test_distance[j] * sinf(bearing);
+
+				/* the exact projection is the ground truth */
+				double lat, lon;
+				ASSERT_EQ(0, map_projection_reproject(&ref, x, y, &lat, &lon));
+
+				float x_fast, y_fast;
+				ASSERT_EQ(0, map_projection_project_fast(&ref, lat, lon, &x_fast, &y_fast));
+				max_project = fmaxf(max_project, sqrtf((x_fast - x) * (x_fast - x) + (y_fast - y) * (y_fast - y)));
+
+				double lat_fast, lon_fast;
+				ASSERT_EQ(0, map_projection_reproject_fast(&ref, x, y, &lat_fast, &lon_fast));
+				float x_back, y_back;
+				ASSERT_EQ(0, map_projection_project(&ref, lat_fast, lon_fast, &x_back, &y_back));
+				max_reproject = fmaxf(max_reproject, sqrtf((x_back - x) * (x_back - x) + (y_back - y) * (y_back - y)));
+			}
+
+			EXPECT_LT(max_project, fast_max_error) << "lat " << reference_lat[i] << " dist " << test_distance[j];
+			EXPECT_LT(max_reproject, fast_max_error) << "lat " << reference_lat[i] << " dist " << test_distance[j];
+		}
+	}
+}
+
+TEST(GeoTest, ProjectFastFallback)
+{
+	struct map_projection_reference_s ref = {};
+	float x, y, x_fast, y_fast;
+
+	EXPECT_EQ(-1, map_projection_project_fast(&ref, 0.0, 0.0, &x, &y));
+
+	/* out of range or close to the pole the exact projection is used */
+	ASSERT_EQ(0, map_projection_init_timestamped(&ref, 47.4, 8.5, 1));
+	ASSERT_EQ(0, map_projection_project(&ref, 47.6, 8.5, &x, &y));
+	ASSERT_EQ(0, map_projection_project_fast(&ref, 47.6, 8.5, &x_fast, &y_fast));
+	EXPECT_EQ(x, x_fast);
+	EXPECT_EQ(y, y_fast);
+
+	ASSERT_EQ(0, map_projection_init_timestamped(&ref, 85.0, 8.5, 1));
+	ASSERT_EQ(0, map_projection_project(&ref, 85.001, 8.501, &x, &y));
+	ASSERT_EQ(0, map_projection_project_fast(&ref, 85.001, 8.501, &x_fast, &y_fast));
+	EXPECT_EQ(x, x_fast);
+	EXPECT_EQ(y, y_fast);
+}
+
+/* double precision references for the waypoint geometry */
+static double haversine_distance(double lat_now, double lon_now, double lat_next, double lon_next)
+{
+	double d_lat = (lat_next - lat_now) * M_DEG_TO_RAD;
+	double d_lon = (lon_next - lon_now) * M_DEG_TO_RAD;
+	double a = sin(d_lat / 2.0) * sin(d_lat / 2.0) + sin(d_lon / 2.0) * sin(d_lon / 2.0) * cos(lat_now * M_DEG_TO_RAD) *
+		   cos(lat_next * M_DEG_TO_RAD);
+	return CONSTANTS_RADIUS_OF_EARTH * 2.0 * atan2(sqrt(a), sqrt(1.0 - a));
+}
+
+static double initial_bearing(double lat_now, double lon_now, double lat_next, double lon_next)
+{
+	double lat_now_rad = lat_now * M_DEG_TO_RAD;
+	double lat_next_rad = lat_next * M_DEG_TO_RAD;
+	double d_lon = (lon_next - lon_now) * M_DEG_TO_RAD;
+	return atan2(sin(d_lon) * cos(lat_next_rad),
+		     cos(lat_now_rad) * sin(lat_next_rad) - sin(lat_now_rad) * cos(lat_next_rad) * cos(d_lon));
+}
+
+TEST(GeoTest, WaypointFastAccuracy)
+{
+	struct map_projection_reference_s ref;
+
+	for (unsigned i = 0; i < sizeof(reference_lat) / sizeof(reference_lat[0]); i++) {
+		ASSERT_EQ(0, map_projection_init_timestamped(&ref, reference_lat[i], 8.5, 1));
+
+		for (unsigned j = 0; j < sizeof(test_distance) / sizeof(test_distance[0]); j++) {
+			float max_distance = 0.0f;
+			float max_bearing = 0.0f;
+
+			for (unsigned k = 0; k < 36; k++) {
+				float bearing = k * 10.0f * M_DEG_TO_RAD_F;
+				double lat, lon;
+				ASSERT_EQ(0, map_projection_reproject(&ref, test_distance[j] * cosf(bearing), test_distance[j] * sinf(bearing),
+								      &lat, &lon));
+
+				double distance = haversine_distance(reference_lat[i], 8.5, lat, lon);
+				float distance_err = fabsf(get_distance_to_next_waypoint(reference_lat[i], 8.5, lat, lon) - (float)distance);
+				float bearing_err = fabsf(_wrap_pi(get_bearing_to_next_waypoint(reference_lat[i], 8.5, lat, lon) -
+								   (float)initial_bearing(reference_lat[i], 8.5, lat, lon)));
+
+				max_distance = fmaxf(max_distance, distance_err);
+				/* express the bearing error as the lateral offset at the waypoint */
+				max_bearing = fmaxf(max_bearing, bearing_err * (float)distance);
+			}
+
+			EXPECT_LT(max_distance, fast_max_error) << "lat " << reference_lat[i] << " dist " << test_distance[j];
+			EXPECT_LT(max_bearing, fast_max_error) << "lat " << reference_lat[i] << " dist " << test_distance[j];
+		}
+	}
+
+	/* far away and polar waypoints use the exact formulas */
+	EXPECT_NEAR(haversine_distance(47.4, 8.5, 48.4, 9.5), get_distance_to_next_waypoint(47.4, 8.5, 48.4, 9.5), 0.1);
+	EXPECT_NEAR(initial_bearing(47.4, 8.5, 48.4, 9.5), get_bearing_to_next_waypoint(47.4, 8.5, 48.4, 9.5), 1e-5);
+	EXPECT_NEAR(haversine_distance(85.0, 8.5, 85.001, 8.6), get_distance_to_next_waypoint(85.0, 8.5, 85.001, 8.6), 0.01);
+}
@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <drivers/drv_hrt.h>
+#include <drivers/hrt_callout_heap.h>
+
+#include "gtest/gtest.h"
+
+static const unsigned CALLOUT_COUNT = 64;
+
+class HrtCalloutHeapTest : public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		memset(_calls, 0, sizeof(_calls));
+		memset(_queued, 0, sizeof(_queued));
+		hrt_callout_heap_init(&_heap);
+		srand(42);
+	}
+
+	/* earliest deadline among the records the test believes are queued */
+	hrt_abstime earliest()
+	{
+		hrt_abstime t = 0;
+
+		for (unsigned i = 0; i < CALLOUT_COUNT; i++) {
+			if (_queued[i] && (t == 0 || _calls[i].deadline < t)) {
+				t = _calls[i].deadline;
+			}
+		}
+
+		return t;
+	}
+
+	struct hrt_callout_heap _heap;
+	struct hrt_call _calls[CALLOUT_COUNT];
+	bool _queued[CALLOUT_COUNT];
+};
+
+TEST_F(HrtCalloutHeapTest, PopsInDeadlineOrder)
+{
+	for (unsigned i = 0; i < CALLOUT_COUNT; i++) {
+		_calls[i].deadline = 1 + (i * 37) % CALLOUT_COUNT;
+		hrt_callout_heap_insert(&_heap, &_calls[i]);
+	}
+
+	hrt_abstime last = 0;
+
+	for (unsigned i = 0; i < CALLOUT_COUNT; i++) {
+		struct hrt_call *call = hrt_callout_heap_peek(&_heap);
+		ASSERT_TRUE(call != NULL);
+		EXPECT_GE(call->deadline, last);
+		last = call->deadline;
+		hrt_callout_heap_remove(&_heap, call);
+		EXPECT_FALSE(hrt_callout_heap_contains(&_heap, call));
+	}
+
+	EXPECT_TRUE(hrt_callout_heap_peek(&_heap) == NULL);
+}
+
+TEST_F(HrtCalloutHeapTest, RandomInsertCancelPop)
+{
+	for (unsigned step = 0; step < 20000; step++) {
+		unsigned i = rand() % CALLOUT_COUNT;
+		int op = rand() % 3;
+
+		if (op == 0) {
+			/* (re-)enter, like hrt_call_internal() */
+			hrt_callout_heap_remove(&_heap, &_calls[i]);
+			_calls[i].deadline = 1 + rand() % 1000;
+			hrt_callout_heap_insert(&_heap, &_calls[i]);
+			_queued[i] = true;
+
+		} else if (op == 1) {
+			/* cancel, also of records that are not queued */
+			hrt_callout_heap_remove(&_heap, &_calls[i]);
+			_queued[i] = false;
+
+		} else {
+			struct hrt_call *call = hrt_callout_heap_peek(&_heap);
+
+			if (call == NULL) {
+				EXPECT_EQ(earliest(), 0u);
+				continue;
+			}
+
+			EXPECT_EQ(call->deadline, earliest());
+			hrt_callout_heap_remove(&_heap, call);
+			_queued[call - _calls] = false;
+		}
+
+		for (unsigned j = 0; j < CALLOUT_COUNT; j++) {
+			ASSERT_EQ(hrt_callout_heap_contains(&_heap, &_calls[j]), _queued[j]);
+		}
+
+		struct hrt_call *call = hrt_callout_heap_peek(&_heap);
+		ASSERT_EQ(call ? call->deadline : 0, earliest());
+	}
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <mavlink/mavlink_log.h>
+
+#include "gtest/gtest.h"
+
+static struct mavlink_logmessage message(unsigned char severity, const char *text)
+{
+	struct mavlink_logmessage msg;
+	memset(&msg, 0, sizeof(msg));
+	strncpy(msg.text, text, sizeof(msg.text) - 1);
+	msg.severity = severity;
+	return msg;
+}
+
+TEST(LogRingTest, ReadersKeepTheirOwnCursor)
+{
+	struct mavlink_logring lr = {};
+	struct mavlink_logmessage msg = message(6, "first");
+	struct mavlink_logmessage out;
+	unsigned a = 0;
+	unsigned b = 0;
+
+	ASSERT_EQ(0, mavlink_logring_write(&lr, &msg, 0));
+	msg = message(6, "second");
+	ASSERT_EQ(0, mavlink_logring_write(&lr, &msg, 0));
+
+	ASSERT_EQ(0, mavlink_logring_read(&lr, &a, &out));
+	EXPECT_STREQ("first", out.text);
+	ASSERT_EQ(0, mavlink_logring_read(&lr, &a, &out));
+	EXPECT_STREQ("second", out.text);
+	EXPECT_EQ(1, mavlink_logring_read(&lr, &a, &out));
+	EXPECT_TRUE(mavlink_logring_is_empty(&lr, a));
+
+	/* the second reader still sees both */
+	EXPECT_FALSE(mavlink_logring_is_empty(&lr, b));
+	ASSERT_EQ(0, mavlink_logring_read(&lr, &b, &out));
+	EXPECT_STREQ("first", out.text);
+}
+
+TEST(LogRingTest, RepeatsAreCounted)
+{
+	struct mavlink_logring lr = {};
+	struct mavlink_logmessage msg = message(2, "no gps");
+	struct mavlink_logmessage out;
+	unsigned seq = 0;
+
+	EXPECT_EQ(0, mavlink_logring_write(&lr, &msg, 0));
+
+	for (unsigned i = 1; i <= 4; i++) {
+		EXPECT_EQ(1, mavlink_logring_write(&lr, &msg, i * 100000));
+	}
+
+	/* after the repeat interval the next copy goes through with the count */
+	EXPECT_EQ(0, mavlink_logring_write(&lr, &msg, MAVLINK_LOGRING_REPEAT_INTERVAL + 100000));
+
+	ASSERT_EQ(0, mavlink_logring_read(&lr, &seq, &out));
+	EXPECT_STREQ("no gps", out.text);
+	ASSERT_EQ(0, mavlink_logring_read(&lr, &seq, &out));
+	EXPECT_STREQ("no gps (x5)", out.text);
+	EXPECT_EQ(1, mavlink_logring_read(&lr, &seq, &out));
+}
+
+TEST(LogRingTest, RateLimitedPerSeverity)
+{
+	struct mavlink_logring lr = {};
+	char text[16];
+	unsigned passed_info = 0;
+	unsigned passed_critical = 0;
+
+	/* a burst at one instant */
+	for (unsigned i = 0; i < 20; i++) {
+		snprintf(text, sizeof(text), "info %u", i);
+		struct mavlink_logmessage msg = message(6, text);
+		passed_info += (mavlink_logring_write(&lr, &msg, 1000) == 0);
+
+		snprintf(text, sizeof(text), "critical %u", i);
+		msg = message(2, text);
+		passed_critical += (mavlink_logring_write(&lr, &msg, 1000) == 0);
+	}
+
+	EXPECT_EQ(3u, passed_info);
+	EXPECT_EQ(10u, passed_critical);
+	EXPECT_EQ(27u, lr.dropped);
+
+	/* one more info message per half second */
+	struct mavlink_logmessage msg = message(6, "later");
+	EXPECT_EQ(0, mavlink_logring_write(&lr, &msg, 501000));
+	msg = message(6, "too soon");
+	EXPECT_EQ(1, mavlink_logring_write(&lr, &msg, 502000));
+}
+
+TEST(LogRingTest, OvertakenReaderSkipsToOldest)
+{
+	struct mavlink_logring lr = {};
+	struct mavlink_logmessage out;
+	char text[16];
+	unsigned seq = 0;
+
+	for (unsigned i = 0; i < 2 * MAVLINK_LOGRING_SIZE; i++) {
+		snprintf(text, sizeof(text), "msg %u", i);
+		struct mavlink_logmessage msg = message(2, text);
+		/* far enough apart to pass the rate limit */
+		ASSERT_EQ(0, mavlink_logring_write(&lr, &msg, (uint64_t)i * 1000000));
+	}
+
+	unsigned count = 0;
+
+	ASSERT_EQ(0, mavlink_logring_read(&lr, &seq, &out));
+	snprintf(text, sizeof(text), "msg %u", MAVLINK_LOGRING_SIZE + 1);
+	EXPECT_STREQ(text, out.text);
+	count++;
+
+	while (mavlink_logring_read(&lr, &seq, &out) == 0) {
+		count++;
+	}
+
+	EXPECT_EQ(MAVLINK_LOGRING_SIZE - 1u, count);
+	snprintf(text, sizeof(text), "msg %u", 2 * MAVLINK_LOGRING_SIZE - 1);
+	EXPECT_STREQ(text, out.text);
+}
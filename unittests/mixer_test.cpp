@@ -10,3 +10,283 @@ TEST(MixerTest, Mixer)
 	char *args[] = {"empty", "../ROMFS/px4fmu_common/mixers/IO_pass.mix", "../ROMFS/px4fmu_common/mixers/quad_w.main.mix"};
 	ASSERT_EQ(test_mixer(3, args), 0) << "IO_pass.mix failed";
 }
+
+#include <dirent.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the rotor tables of all geometries, as used by the mixer
+#include <systemlib/mixer/mixer_multirotor.generated.h>
+
+namespace
+{
+
+// mixer files index up to 8 controls per group
+float controls[8];
+
+int mixer_control(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &control)
+{
+	control = controls[control_index];
+	return 0;
+}
+
+int mixer_control_fixed(uintptr_t handle, uint8_t control_group, uint8_t control_index, int32_t &control)
+{
+	control = Mixer::float_to_fixed(controls[control_index]);
+	return 0;
+}
+
+float limit(float val, float min, float max)
+{
+	return (val < min) ? min : ((val > max) ? max : val);
+}
+
+// scalar multirotor mix as it was before the matrix formulation, for comparison
+void reference_mix(const MultirotorMixer::Rotor *rotors, unsigned rotor_count, float idle_speed, float *outputs)
+{
+	float roll = limit(controls[0], -1.0f, 1.0f);
+	float pitch = limit(controls[1], -1.0f, 1.0f);
+	float yaw = limit(controls[2], -1.0f, 1.0f);
+	float thrust = limit(controls[3], 0.0f, 1.0f);
+	float min_out = 0.0f;
+	float max_out = 0.0f;
+
+	for (unsigned i = 0; i < rotor_count; i++) {
+		float out = (roll * rotors[i].roll_scale + pitch * rotors[i].pitch_scale + thrust) * rotors[i].out_scale;
+		min_out = fminf(min_out, out);
+		max_out = fmaxf(max_out, out);
+	}
+
+	float boost = 0.0f;
+	float roll_pitch_scale = 1.0f;
+
+	if (min_out < 0.0f && max_out < 1.0f && -min_out <= 1.0f - max_out) {
+		float max_thrust_diff = thrust * 1.5f - thrust;
+
+		if (max_thrust_diff >= -min_out) {
+			boost = -min_out;
+
+		} else {
+			boost = max_thrust_diff;
+			roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+		}
+
+	} else if (max_out > 1.0f && min_out > 0.0f && min_out >= max_out - 1.0f) {
+		float max_thrust_diff = thrust - 0.6f * thrust;
+
+		if (max_thrust_diff >= max_out - 1.0f) {
+			boost = -(max_out - 1.0f);
+
+		} else {
+			boost = -max_thrust_diff;
+			roll_pitch_scale = (1 - (thrust + boost)) / (max_out - thrust);
+		}
+
+	} else if (min_out < 0.0f && max_out < 1.0f && -min_out > 1.0f - max_out) {
+		boost = limit(-min_out - (1.0f - max_out) / 2.0f, 0.0f, thrust * 1.5f - thrust);
+		roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+
+	} else if (max_out > 1.0f && min_out > 0.0f && min_out < max_out - 1.0f) {
+		boost = limit(-(max_out - 1.0f - min_out) / 2.0f, -(thrust - 0.6f * thrust), 0.0f);
+		roll_pitch_scale = (1 - (thrust + boost)) / (max_out - thrust);
+
+	} else if (min_out < 0.0f && max_out > 1.0f) {
+		boost = limit(-(max_out - 1.0f + min_out) / 2.0f, 0.6f * thrust - thrust, 1.5f * thrust - thrust);
+		roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+	}
+
+	for (unsigned i = 0; i < rotor_count; i++) {
+		float rp = roll * rotors[i].roll_scale + pitch * rotors[i].pitch_scale;
+		float out = (rp * roll_pitch_scale + yaw * rotors[i].yaw_scale + thrust + boost) * rotors[i].out_scale;
+
+		if (out < 0.0f) {
+			yaw = -(rp * roll_pitch_scale + thrust + boost) / rotors[i].yaw_scale;
+
+		} else if (out > 1.0f) {
+			thrust -= fminf(0.15f, out - 1.0f);
+			yaw = (1.0f - (rp * roll_pitch_scale + thrust + boost)) / rotors[i].yaw_scale;
+		}
+	}
+
+	for (unsigned i = 0; i < rotor_count; i++) {
+		float out = (roll * rotors[i].roll_scale + pitch * rotors[i].pitch_scale) * roll_pitch_scale +
+			    yaw * rotors[i].yaw_scale + thrust + boost;
+		outputs[i] = limit(idle_speed + out * (1.0f - idle_speed), idle_speed, 1.0f);
+	}
+}
+
+float random_control(float min, float max)
+{
+	return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+} // anonymous namespace
+
+TEST(MixerTest, MultirotorMix)
+{
+	const float idle_speed = 0.1f;
+	const unsigned iterations = 20000;
+
+	srand(42);
+
+	for (unsigned g = 0; g < (unsigned)MultirotorGeometry::MAX_GEOMETRY; g++) {
+		MultirotorMixer mixer(mixer_control, 0, (MultirotorGeometry)g, 1.0f, 1.0f, 1.0f, idle_speed);
+		const unsigned rotor_count = _config_rotor_count[g];
+		float outputs[8];
+		float expected[8];
+
+		for (unsigned n = 0; n < iterations; n++) {
+			controls[0] = random_control(-1.2f, 1.2f);
+			controls[1] = random_control(-1.2f, 1.2f);
+			controls[2] = random_control(-1.2f, 1.2f);
+			controls[3] = random_control(-0.1f, 1.1f);
+
+			ASSERT_EQ(mixer.mix(outputs, 8, nullptr), rotor_count);
+
+			// the mixer works in the -1..1 output range
+			reference_mix(_config_index[g], rotor_count, -1.0f + idle_speed * 2.0f, expected);
+
+			for (unsigned i = 0; i < rotor_count; i++) {
+				// rotors without yaw authority (twin engine) can end up with nan, both ways alike
+				if (isnan(expected[i])) {
+					ASSERT_TRUE(isnan(outputs[i])) << "geometry " << g << " rotor " << i;
+
+				} else {
+					ASSERT_NEAR(outputs[i], expected[i], 1e-4f) << "geometry " << g << " rotor " << i;
+				}
+			}
+		}
+	}
+}
+
+TEST(MixerTest, BinaryMixer)
+{
+	const char *dirname = "../ROMFS/px4fmu_common/mixers";
+	DIR *dir = opendir(dirname);
+	ASSERT_TRUE(dir != nullptr);
+	unsigned files = 0;
+
+	srand(42);
+
+	for (struct dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+		size_t namelen = strlen(entry->d_name);
+
+		if (namelen < 4 || strcmp(&entry->d_name[namelen - 4], ".mix") != 0) {
+			continue;
+		}
+
+		char path[PATH_MAX + sizeof(entry->d_name)];
+		char text[2048];
+		uint8_t bin[2048];
+		ASSERT_LT((unsigned)snprintf(path, sizeof(path), "%s/%s", dirname, entry->d_name), sizeof(path));
+		ASSERT_EQ(load_mixer_file(path, text, sizeof(text)), 0) << path;
+
+		unsigned textlen = strlen(text);
+		int binlen = mixer_text_to_binary(text, textlen, bin, sizeof(bin));
+		ASSERT_GT(binlen, 0) << path;
+		ASSERT_LE((unsigned)binlen, textlen) << path;
+
+		MixerGroup text_group(mixer_control, 0);
+		MixerGroup bin_group(mixer_control, 0);
+		unsigned resid = textlen;
+		text_group.load_from_buf(text, resid);
+		resid = binlen;
+		ASSERT_EQ(bin_group.load_from_binary(bin, resid), 0) << path;
+		ASSERT_EQ(resid, 0u) << path;
+		ASSERT_EQ(bin_group.count(), text_group.count()) << path;
+
+		// both loads mix alike
+		for (unsigned n = 0; n < 100; n++) {
+			for (unsigned i = 0; i < 4; i++) {
+				controls[i] = random_control(-1.0f, 1.0f);
+			}
+
+			float text_outputs[16];
+			float bin_outputs[16];
+			unsigned mixed = text_group.mix(text_outputs, 16, nullptr);
+			ASSERT_EQ(bin_group.mix(bin_outputs, 16, nullptr), mixed) << path;
+
+			for (unsigned i = 0; i < mixed; i++) {
+				if (isnan(text_outputs[i])) {
+					ASSERT_TRUE(isnan(bin_outputs[i])) << path;
+
+				} else {
+					ASSERT_FLOAT_EQ(bin_outputs[i], text_outputs[i]) << path << " output " << i;
+				}
+			}
+		}
+
+		// a truncated buffer leaves the partial record for later
+		resid = binlen - 1;
+		MixerGroup partial_group(mixer_control, 0);
+		partial_group.load_from_binary(bin, resid);
+		ASSERT_GT(resid, 0u) << path;
+
+		files++;
+	}
+
+	closedir(dir);
+	ASSERT_GT(files, 0u);
+}
+
+TEST(MixerTest, FixedPointMix)
+{
+	const char *dirname = "../ROMFS/px4fmu_common/mixers";
+	DIR *dir = opendir(dirname);
+	ASSERT_TRUE(dir != nullptr);
+	unsigned files = 0;
+
+	srand(42);
+
+	for (struct dirent *entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+		size_t namelen = strlen(entry->d_name);
+
+		if (namelen < 4 || strcmp(&entry->d_name[namelen - 4], ".mix") != 0) {
+			continue;
+		}
+
+		char path[PATH_MAX + sizeof(entry->d_name)];
+		char text[2048];
+		ASSERT_LT((unsigned)snprintf(path, sizeof(path), "%s/%s", dirname, entry->d_name), sizeof(path));
+		ASSERT_EQ(load_mixer_file(path, text, sizeof(text)), 0) << path;
+
+		MixerGroup group(mixer_control, 0);
+		unsigned resid = strlen(text);
+		group.load_from_buf(text, resid);
+
+		for (unsigned n = 0; n < 1000; n++) {
+			// controls as they come from the IO registers, throttle sometimes invalid
+			for (unsigned i = 0; i < 8; i++) {
+				controls[i] = roundf(random_control(-1.0f, 1.0f) * MIXER_FIXED_ONE) / MIXER_FIXED_ONE;
+			}
+
+			if (n % 10 == 0) {
+				controls[3] = NAN;
+			}
+
+			float outputs[16];
+			int32_t fixed_outputs[16];
+			unsigned mixed = group.mix(outputs, 16, nullptr);
+			ASSERT_EQ(group.mix_fixed(fixed_outputs, 16, nullptr, mixer_control_fixed), mixed) << path;
+
+			for (unsigned i = 0; i < mixed; i++) {
+				float fixed_output = Mixer::fixed_to_float(fixed_outputs[i]);
+
+				if (isnan(outputs[i])) {
+					ASSERT_TRUE(isnan(fixed_output)) << path << " output " << i;
+
+				} else {
+					// a few LSB of the 1/10000 output registers
+					ASSERT_NEAR(fixed_output, outputs[i], 3e-4f) << path << " output " << i;
+				}
+			}
+		}
+
+		files++;
+	}
+
+	closedir(dir);
+	ASSERT_GT(files, 0u);
+}
@@ -1,5 +1,10 @@
 #include <systemlib/visibility.h>
 #include <systemlib/param/param.h>
+#include <systemlib/circuit_breaker.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 
 #include "gtest/gtest.h"
 
@@ -149,4 +154,316 @@ TEST(ParamTest, ResetAllExcludesWildcard)
 	_assert_parameter_int_value((param_t)1, 4);
 	_assert_parameter_int_value((param_t)2, 50);
 	_assert_parameter_int_value((param_t)3, 50);
-}
\ No newline at end of file
+}
+TEST(ParamTest, ChangedSince)
+{
+	_add_parameters();
+	param_reset_all();
+
+	uint32_t seq = param_get_change_seq();
+	ASSERT_NE(0u, seq);
+	ASSERT_TRUE(param_changed_since((param_t)0, 0)) << "never read parameter must be reported as changed";
+	ASSERT_FALSE(param_changed_since((param_t)0, seq));
+	ASSERT_FALSE(param_changed_since((param_t)1, seq));
+
+	int32_t value = 42;
+	param_set((param_t)1, &value);
+	ASSERT_LT(seq, param_get_change_seq());
+	ASSERT_FALSE(param_changed_since((param_t)0, seq)) << "untouched parameter reported as changed";
+	ASSERT_TRUE(param_changed_since((param_t)1, seq));
+	ASSERT_FALSE(param_changed_since((param_t)1, param_get_change_seq()));
+
+	seq = param_get_change_seq();
+	param_reset((param_t)1);
+	ASSERT_TRUE(param_changed_since((param_t)0, seq)) << "a reset must invalidate all parameters";
+	ASSERT_TRUE(param_changed_since((param_t)1, seq));
+	ASSERT_FALSE(param_changed_since((param_t)1, param_get_change_seq()));
+}
+
+TEST(ParamTest, CircuitBreakerCache)
+{
+	_add_parameters();
+	param_reset_all();
+
+	ASSERT_TRUE(circuit_breaker_enabled("TEST_1", 2));
+	ASSERT_FALSE(circuit_breaker_enabled("TEST_2", 2));
+	ASSERT_TRUE(circuit_breaker_enabled("TEST_1", 2)) << "cached value differs";
+
+	int32_t value = 3;
+	param_set((param_t)0, &value);
+	ASSERT_FALSE(circuit_breaker_enabled("TEST_1", 2)) << "cache not invalidated by a change";
+	ASSERT_TRUE(circuit_breaker_enabled("TEST_1", 3));
+
+	param_reset_all();
+	ASSERT_TRUE(circuit_breaker_enabled("TEST_1", 2)) << "cache not invalidated by a reset";
+	ASSERT_FALSE(circuit_breaker_enabled("TEST_2", 2));
+}
+
+TEST(ParamTest, HashCheck)
+{
+	_add_parameters();
+	param_reset_all();
+	param_find("TEST_1");
+	param_find("TEST_2");
+
+	uint32_t hash = param_hash_check();
+	ASSERT_EQ(hash, param_hash_check());
+
+	int32_t value = 42;
+	param_set((param_t)1, &value);
+	ASSERT_NE(hash, param_hash_check()) << "value change not reflected in the hash";
+
+	value = 4;
+	param_set((param_t)1, &value);
+	ASSERT_EQ(hash, param_hash_check()) << "hash must only depend on names and values";
+
+	value = 42;
+	param_set((param_t)3, &value);
+	ASSERT_EQ(hash, param_hash_check()) << "unused parameter included in the hash";
+}
+
+static off_t _file_size(const char *path)
+{
+	struct stat st;
+	return (stat(path, &st) == 0) ? st.st_size : -1;
+}
+
+TEST(ParamTest, SaveJournal)
+{
+	const char *file = "param_journal_test.bson";
+	unlink(file);
+	param_set_default_file(file);
+
+	_add_parameters();
+	param_reset_all();
+
+	int32_t value = 10;
+	param_set((param_t)0, &value);
+	ASSERT_EQ(0, param_save_default());
+	off_t full_size = _file_size(file);
+	ASSERT_GT(full_size, 0);
+
+	/* single changes are appended as a small slot */
+	value = 20;
+	param_set((param_t)1, &value);
+	ASSERT_EQ(0, param_save_default());
+	off_t journal_size = _file_size(file);
+	ASSERT_GT(journal_size, full_size);
+	ASSERT_LE(journal_size - full_size, 64);
+
+	/* saving it again rewrites its slot in place */
+	value = 21;
+	param_set((param_t)1, &value);
+	ASSERT_EQ(0, param_save_default());
+	ASSERT_EQ(journal_size, _file_size(file));
+
+	value = 20;
+	param_set((param_t)1, &value);
+	ASSERT_EQ(0, param_save_default());
+	ASSERT_EQ(journal_size, _file_size(file));
+
+	value = 11;
+	param_set((param_t)0, &value);
+	ASSERT_EQ(0, param_save_default());
+
+	/* nothing changed, nothing written */
+	ASSERT_EQ(0, param_save_default());
+	off_t replay_size = _file_size(file);
+	ASSERT_GT(replay_size, journal_size);
+
+	param_reset_all();
+	ASSERT_EQ(0, param_load_default());
+	_assert_parameter_int_value((param_t)0, 11);
+	_assert_parameter_int_value((param_t)1, 20);
+	_assert_parameter_int_value((param_t)2, 8);
+
+	/* appending continues after a load */
+	value = 30;
+	param_set((param_t)2, &value);
+	ASSERT_EQ(0, param_save_default());
+	ASSERT_GT(_file_size(file), replay_size);
+
+	/* a reset can't be journaled: the file is rewritten and older records must be ignored */
+	param_reset((param_t)0);
+	ASSERT_EQ(0, param_save_default());
+
+	param_reset_all();
+	ASSERT_EQ(0, param_load_default());
+	_assert_parameter_int_value((param_t)0, 2);
+	_assert_parameter_int_value((param_t)1, 20);
+	_assert_parameter_int_value((param_t)2, 30);
+
+	param_set_default_file(NULL);
+	unlink(file);
+}
+
+TEST(ParamTest, SaveJournalTornSlot)
+{
+	const char *file = "param_journal_torn_test.bson";
+	unlink(file);
+	param_set_default_file(file);
+
+	_add_parameters();
+	param_reset_all();
+
+	int32_t value = 10;
+	param_set((param_t)0, &value);
+	ASSERT_EQ(0, param_save_default());
+	off_t full_size = _file_size(file);
+
+	/* the two copies of the slot of TEST_2 hold 20, then 21 */
+	value = 20;
+	param_set((param_t)1, &value);
+	ASSERT_EQ(0, param_save_default());
+	off_t journal_size = _file_size(file);
+	value = 21;
+	param_set((param_t)1, &value);
+	ASSERT_EQ(0, param_save_default());
+
+	param_reset_all();
+	ASSERT_EQ(0, param_load_default());
+	_assert_parameter_int_value((param_t)0, 10);
+	_assert_parameter_int_value((param_t)1, 21);
+
+	/* damage the second copy, as a power loss while writing it would */
+	off_t slot_size = journal_size - full_size;
+	int fd = open(file, O_WRONLY);
+	ASSERT_GE(fd, 0);
+	const uint8_t garbage[4] = {0xde, 0xad, 0xbe, 0xef};
+	ASSERT_EQ(off_t(full_size + slot_size / 2 + 4), lseek(fd, full_size + slot_size / 2 + 4, SEEK_SET));
+	ASSERT_EQ(ssize_t(sizeof(garbage)), write(fd, garbage, sizeof(garbage)));
+	close(fd);
+
+	/* the older copy is loaded and saving continues in the slot */
+	param_reset_all();
+	ASSERT_EQ(0, param_load_default());
+	_assert_parameter_int_value((param_t)0, 10);
+	_assert_parameter_int_value((param_t)1, 20);
+
+	value = 22;
+	param_set((param_t)1, &value);
+	ASSERT_EQ(0, param_save_default());
+	ASSERT_EQ(journal_size, _file_size(file));
+
+	param_reset_all();
+	ASSERT_EQ(0, param_load_default());
+	_assert_parameter_int_value((param_t)1, 22);
+
+	param_set_default_file(NULL);
+	unlink(file);
+}
+
+/*
+ * Fills a table at the given offset in param_array with generated parameters,
+ * in ascending name order or reversed
+ */
+static char _gen_names[200][16];
+
+void _add_generated_parameters(unsigned offset, unsigned count, bool sorted)
+{
+	for (unsigned i = 0; i < count; i++) {
+		snprintf(_gen_names[i], sizeof(_gen_names[i]), "GEN_%03u", i);
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		unsigned n = sorted ? i : count - 1 - i;
+
+		struct param_info_s p = {
+			_gen_names[n],
+			PARAM_TYPE_INT32
+		};
+		p.val.i = n;
+		param_array[offset + i] = p;
+	}
+
+	param_info_base = (struct param_info_s *) &param_array[offset];
+	param_info_limit = (struct param_info_s *) &param_array[offset + count];
+}
+
+/*
+ * Looks up every generated parameter, fails on the first wrong handle
+ */
+void _find_generated_parameters(unsigned count, bool sorted)
+{
+	for (unsigned i = 0; i < count; i++) {
+		param_t param = param_find_no_notification(_gen_names[i]);
+		param_t expected = sorted ? i : count - 1 - i;
+
+		if (param != expected) {
+			ADD_FAILURE() << "param_find returned " << param << " for " << _gen_names[i];
+			return;
+		}
+	}
+}
+
+TEST(ParamTest, FindSortedAndUnsorted)
+{
+	const unsigned count = sizeof(_gen_names) / sizeof(_gen_names[0]);
+
+	/* the tables must not overlap, param.c remembers per table whether it is sorted */
+	_add_generated_parameters(0, count, true);
+	_find_generated_parameters(count, true);
+	ASSERT_EQ(PARAM_INVALID, param_find_no_notification("GEN_"));
+	ASSERT_EQ(PARAM_INVALID, param_find_no_notification("GEN_999"));
+	ASSERT_EQ(PARAM_INVALID, param_find_no_notification("AAA"));
+
+	/* bisecting the reversed table would miss most names, only the linear scan finds them all */
+	_add_generated_parameters(sizeof(param_array) / sizeof(param_array[0]) - count, count, false);
+	_find_generated_parameters(count, false);
+	ASSERT_EQ(PARAM_INVALID, param_find_no_notification("GEN_999"));
+}
+
+TEST(ParamTest, ImportMerge)
+{
+	const char *file = "param_import_test.bson";
+	const unsigned count = sizeof(_gen_names) / sizeof(_gen_names[0]);
+
+	_add_generated_parameters(0, count, true);
+	param_reset_all();
+
+	/* every other parameter modified, in reverse order */
+	for (int i = count - 1; i >= 0; i -= 2) {
+		int32_t value = 1000 + i;
+		param_set((param_t)i, &value);
+	}
+
+	int fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(0, param_export(fd, false));
+	close(fd);
+
+	/* the import overrides the exported ones and keeps the others */
+	param_reset_all();
+
+	for (unsigned i = 0; i < count; i += 3) {
+		int32_t value = 2000 + i;
+		param_set((param_t)i, &value);
+	}
+
+	fd = open(file, O_RDONLY);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(0, param_import(fd));
+	close(fd);
+
+	for (unsigned i = 0; i < count; i++) {
+		int32_t expected = (i % 2 == 1) ? 1000 + i : ((i % 3 == 0) ? 2000 + i : i);
+		_assert_parameter_int_value((param_t)i, expected);
+	}
+
+	ASSERT_TRUE(param_value_unsaved((param_t)1));
+
+	/* a load replaces everything and marks it saved */
+	fd = open(file, O_RDONLY);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(0, param_load(fd));
+	close(fd);
+
+	for (unsigned i = 0; i < count; i++) {
+		_assert_parameter_int_value((param_t)i, (i % 2 == 1) ? 1000 + i : i);
+	}
+
+	ASSERT_FALSE(param_value_unsaved((param_t)1));
+	ASSERT_TRUE(param_value_is_default((param_t)0));
+
+	unlink(file);
+}
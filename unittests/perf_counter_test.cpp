@@ -0,0 +1,194 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <drivers/drv_hrt.h>
+#include <systemlib/perf_counter.h>
+
+#include "gtest/gtest.h"
+
+static const unsigned THREAD_COUNT = 4;
+static const unsigned THREAD_EVENTS = 100000;
+
+static void *count_thread(void *arg)
+{
+	perf_counter_t handle = (perf_counter_t)arg;
+
+	for (unsigned i = 0; i < THREAD_EVENTS; i++) {
+		perf_count(handle);
+	}
+
+	return NULL;
+}
+
+static void *set_thread(void *arg)
+{
+	perf_counter_t handle = (perf_counter_t)arg;
+
+	for (unsigned i = 0; i < THREAD_EVENTS; i++) {
+		perf_set(handle, i % 1000);
+	}
+
+	return NULL;
+}
+
+static void run_threads(void *(*entry)(void *), perf_counter_t handle)
+{
+	pthread_t threads[THREAD_COUNT];
+
+	for (unsigned i = 0; i < THREAD_COUNT; i++) {
+		ASSERT_EQ(0, pthread_create(&threads[i], NULL, entry, handle));
+	}
+
+	for (unsigned i = 0; i < THREAD_COUNT; i++) {
+		pthread_join(threads[i], NULL);
+	}
+}
+
+TEST(PerfCounterTest, HistogramPercentiles)
+{
+	perf_counter_t handle = perf_alloc(PC_HISTOGRAM, "test_histogram");
+	ASSERT_TRUE(handle != NULL);
+
+	/* 99% of the events at 100us, the rest at 10ms */
+	for (unsigned i = 0; i < 1000; i++) {
+		perf_set(handle, (i % 100 == 0) ? 10000 : 100);
+	}
+
+	struct perf_histogram_report_s report;
+	ASSERT_EQ(0, perf_histogram_report(0, &report));
+	EXPECT_STREQ("test_histogram", report.name);
+	EXPECT_EQ(1000u, report.event_count);
+	EXPECT_EQ(10000u, report.max);
+
+	/* percentiles are resolved to the power of two bucket */
+	EXPECT_GE(report.p50, 64u);
+	EXPECT_LT(report.p50, 128u);
+	EXPECT_GE(report.p99, 64u);
+	EXPECT_LE(report.p99, 128u);
+	EXPECT_GE(report.p999, 8192u);
+	EXPECT_LE(report.p999, 10000u);
+
+	EXPECT_EQ(990u, report.bucket_count[7]);
+	EXPECT_EQ(10u, report.bucket_count[14]);
+
+	EXPECT_EQ(-1, perf_histogram_report(1, &report));
+
+	perf_reset(handle);
+	ASSERT_EQ(0, perf_histogram_report(0, &report));
+	EXPECT_EQ(0u, report.event_count);
+	EXPECT_EQ(0u, report.p50);
+
+	perf_free(handle);
+	EXPECT_EQ(-1, perf_histogram_report(0, &report));
+}
+
+TEST(PerfCounterTest, AllocOnce)
+{
+	perf_counter_t first = perf_alloc_once(PC_COUNT, "test_once");
+	ASSERT_TRUE(first != NULL);
+	EXPECT_EQ(first, perf_alloc_once(PC_COUNT, "test_once"));
+
+	/* same name but different type */
+	EXPECT_TRUE(perf_alloc_once(PC_ELAPSED, "test_once") == NULL);
+
+	/* enough counters to share hash buckets */
+	perf_counter_t others[100];
+	char names[100][16];
+
+	for (unsigned i = 0; i < 100; i++) {
+		snprintf(names[i], sizeof(names[i]), "test_once%u", i);
+		others[i] = perf_alloc_once(PC_COUNT, names[i]);
+		ASSERT_TRUE(others[i] != NULL);
+	}
+
+	for (unsigned i = 0; i < 100; i += 2) {
+		perf_free(others[i]);
+	}
+
+	EXPECT_EQ(first, perf_alloc_once(PC_COUNT, "test_once"));
+
+	for (unsigned i = 1; i < 100; i += 2) {
+		EXPECT_EQ(others[i], perf_alloc_once(PC_COUNT, names[i]));
+		perf_free(others[i]);
+	}
+
+	perf_free(first);
+}
+
+TEST(PerfCounterTest, ConcurrentUpdates)
+{
+	perf_counter_t count = perf_alloc(PC_COUNT, "test_count");
+	run_threads(count_thread, count);
+	EXPECT_EQ((uint64_t)THREAD_COUNT * THREAD_EVENTS, perf_event_count(count));
+	perf_free(count);
+
+	perf_counter_t histogram = perf_alloc(PC_HISTOGRAM, "test_concurrent");
+	run_threads(set_thread, histogram);
+	EXPECT_EQ((uint64_t)THREAD_COUNT * THREAD_EVENTS, perf_event_count(histogram));
+
+	struct perf_histogram_report_s report;
+	ASSERT_EQ(0, perf_histogram_report(0, &report));
+	EXPECT_EQ(999u, report.max);
+
+	uint64_t total = 0;
+
+	for (unsigned i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+		total += report.bucket_count[i];
+	}
+
+	EXPECT_EQ((uint64_t)THREAD_COUNT * THREAD_EVENTS, total);
+	perf_free(histogram);
+}
+
+TEST(PerfCounterTest, TopElapsed)
+{
+	perf_counter_t slow = perf_alloc(PC_ELAPSED, "test_slow");
+	perf_counter_t fast = perf_alloc(PC_HISTOGRAM, "test_fast");
+	perf_counter_t count = perf_alloc(PC_COUNT, "test_ignored");
+
+	perf_set(fast, 10);
+	perf_set(slow, 500);
+	perf_set(slow, 500);
+
+	struct perf_top_s top[4];
+	ASSERT_EQ(2u, perf_top_elapsed(top, 4));
+	EXPECT_STREQ("test_slow", top[0].name);
+	EXPECT_EQ(2u, top[0].event_count);
+	EXPECT_EQ(1000u, top[0].elapsed);
+	EXPECT_STREQ("test_fast", top[1].name);
+	EXPECT_EQ(10u, top[1].elapsed);
+
+	/* only the time since the previous call is reported */
+	perf_set(fast, 2000);
+	ASSERT_EQ(1u, perf_top_elapsed(top, 1));
+	EXPECT_STREQ("test_fast", top[0].name);
+	EXPECT_EQ(1u, top[0].event_count);
+	EXPECT_EQ(2000u, top[0].elapsed);
+
+	perf_free(count);
+	perf_free(fast);
+	perf_free(slow);
+}
+
+TEST(PerfCounterTest, EndWithoutBegin)
+{
+	const enum perf_counter_type types[] = {PC_ELAPSED, PC_LATENCY, PC_HISTOGRAM};
+
+	/* a start at time 0 reads as no start, the POSIX clock begins there with its first use */
+	while (hrt_absolute_time() == 0) {
+	}
+
+	for (unsigned i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+		perf_counter_t handle = perf_alloc(types[i], "test_end");
+		ASSERT_TRUE(handle != NULL);
+
+		/* a second end has no start left to measure from */
+		perf_begin(handle);
+		perf_end(handle);
+		perf_end(handle);
+		EXPECT_EQ(1u, perf_event_count(handle)) << "type " << types[i];
+
+		perf_free(handle);
+	}
+}
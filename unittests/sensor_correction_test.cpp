@@ -0,0 +1,49 @@
+#include <math.h>
+
+#include <conversion/rotation.h>
+#include <conversion/sensor_correction.h>
+
+#include "gtest/gtest.h"
+
+TEST(SensorCorrectionTest, MatchesRotateAndCalibrate)
+{
+	const float range_scale = 9.80665f / 4096.0f;
+	const float offset[3] = {0.12f, -0.34f, 0.56f};
+	const float scale[3] = {1.01f, 0.98f, 1.03f};
+
+	for (int rot = 0; rot < ROTATION_MAX; rot++) {
+		SensorCorrection correction;
+		correction.set((enum Rotation)rot, range_scale, offset, scale);
+
+		for (int k = 0; k < 20; k++) {
+			float x = 4096.0f * sinf(k * 0.7f);
+			float y = -2048.0f + 300.0f * k;
+			float z = 4096.0f * cosf(k * 0.3f);
+
+			float out[3];
+			correction.apply(x, y, z, out);
+
+			/* the two steps of the drivers */
+			rotate_3f((enum Rotation)rot, x, y, z);
+			float expected[3] = {
+				(x * range_scale - offset[0]) * scale[0],
+				(y * range_scale - offset[1]) * scale[1],
+				(z * range_scale - offset[2]) * scale[2]
+			};
+
+			for (int i = 0; i < 3; i++) {
+				EXPECT_NEAR(expected[i], out[i], 1e-4f) << "rotation " << rot << " axis " << i;
+			}
+		}
+	}
+}
+
+TEST(SensorCorrectionTest, DefaultIsIdentity)
+{
+	SensorCorrection correction;
+	float out[3];
+	correction.apply(1.0f, -2.0f, 3.0f, out);
+	EXPECT_EQ(1.0f, out[0]);
+	EXPECT_EQ(-2.0f, out[1]);
+	EXPECT_EQ(3.0f, out[2]);
+}
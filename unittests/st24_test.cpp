@@ -61,3 +61,36 @@ TEST(ST24Test, ST24)
 
 	ASSERT_EQ(EOF, ret);
 }
+
+/* bitwise reference of the CRC8 used by ST24 */
+static uint8_t st24_crc8_reference(const uint8_t *ptr, unsigned len)
+{
+	uint8_t crc = 0;
+
+	while (len--) {
+		for (uint8_t i = 0x80; i != 0; i >>= 1) {
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+
+			if ((*ptr & i) != 0) {
+				crc ^= 0x07;
+			}
+		}
+
+		ptr++;
+	}
+
+	return crc;
+}
+
+TEST(ST24Test, CRC8)
+{
+	uint8_t buf[255];
+
+	for (unsigned i = 0; i < sizeof(buf); i++) {
+		buf[i] = (uint8_t)(i * 37 + 11);
+	}
+
+	for (unsigned len = 0; len <= sizeof(buf); len++) {
+		ASSERT_EQ(st24_crc8_reference(buf, len), st24_common_crc8(buf, len));
+	}
+}
@@ -61,3 +61,24 @@ TEST(SUMDTest, SUMD)
 
 	ASSERT_EQ(EOF, ret);
 }
+
+/* bitwise reference of the CRC16-CCITT used by SUMD */
+static uint16_t sumd_crc16_reference(uint16_t crc, uint8_t value)
+{
+	crc ^= (uint16_t)value << 8;
+
+	for (unsigned i = 0; i < 8; i++) {
+		crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	}
+
+	return crc;
+}
+
+TEST(SUMDTest, CRC16)
+{
+	for (unsigned crc_in = 0; crc_in < 0x10000; crc_in += 0x0101) {
+		for (unsigned value = 0; value < 256; value++) {
+			ASSERT_EQ(sumd_crc16_reference(crc_in, value), sumd_crc16(crc_in, value));
+		}
+	}
+}
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <modules/navigator/terrain_cache.h>
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+const unsigned samples = 1201;
+
+/* the height is linear in the row and the column, so the bilinear lookup is exact */
+int16_t sample_height(unsigned row, unsigned col)
+{
+	if (row == 900 && col == 900) {
+		return -32768;
+	}
+
+	return row + 2 * col;
+}
+
+class TerrainCacheTest : public ::testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		strcpy(dir, "/tmp/terrain_cache_testXXXXXX");
+		ASSERT_TRUE(mkdtemp(dir) != nullptr);
+		snprintf(path, sizeof(path), "%s/N47E008.hgt", dir);
+
+		FILE *f = fopen(path, "wb");
+		ASSERT_TRUE(f != nullptr);
+
+		for (unsigned row = 0; row < samples; row++) {
+			for (unsigned col = 0; col < samples; col++) {
+				int16_t h = sample_height(row, col);
+				uint8_t be[2] = {(uint8_t)((uint16_t)h >> 8), (uint8_t)(h & 0xff)};
+				fwrite(be, sizeof(be), 1, f);
+			}
+		}
+
+		fclose(f);
+	}
+
+	virtual void TearDown()
+	{
+		unlink(path);
+		rmdir(dir);
+	}
+
+	/* the position of a sample of the test file */
+	static double lat(double row) { return 48.0 - row / (samples - 1); }
+	static double lon(double col) { return 8.0 + col / (samples - 1); }
+
+	char dir[64];
+	char path[96];
+};
+
+} // anonymous namespace
+
+TEST_F(TerrainCacheTest, Samples)
+{
+	TerrainCache terrain(dir);
+	float h;
+
+	/* the south west corner, the north and east edges belong to the next squares */
+	ASSERT_TRUE(terrain.get_height(lat(1200), lon(0), h));
+	EXPECT_NEAR(1200.0f, h, 1e-3f);
+
+	ASSERT_TRUE(terrain.get_height(lat(600), lon(300), h));
+	EXPECT_NEAR(1200.0f, h, 1e-3f);
+
+	/* the edges of a tile */
+	ASSERT_TRUE(terrain.get_height(lat(1200), lon(1184), h));
+	EXPECT_NEAR(3568.0f, h, 1e-3f);
+
+	ASSERT_TRUE(terrain.get_height(lat(16), lon(32), h));
+	EXPECT_NEAR(80.0f, h, 1e-3f);
+}
+
+TEST_F(TerrainCacheTest, Bilinear)
+{
+	TerrainCache terrain(dir);
+	float h;
+
+	ASSERT_TRUE(terrain.get_height(lat(600.5), lon(300.25), h));
+	EXPECT_NEAR(1201.0f, h, 1e-2f);
+
+	ASSERT_TRUE(terrain.get_height(lat(15.75), lon(16.5), h));
+	EXPECT_NEAR(48.75f, h, 1e-2f);
+}
+
+TEST_F(TerrainCacheTest, NoData)
+{
+	TerrainCache terrain(dir);
+	float h;
+
+	/* no file for the square */
+	EXPECT_FALSE(terrain.get_height(46.5, 8.5, h));
+	EXPECT_FALSE(terrain.get_height(47.5, 9.5, h));
+
+	/* a void among the four samples */
+	EXPECT_FALSE(terrain.get_height(lat(899.5), lon(899.5), h));
+	EXPECT_TRUE(terrain.get_height(lat(898.5), lon(898.5), h));
+}
+
+TEST_F(TerrainCacheTest, Eviction)
+{
+	TerrainCache terrain(dir);
+	float h;
+
+	/* more tiles than the cache holds, twice, the evicted ones are read again */
+	for (unsigned pass = 0; pass < 2; pass++) {
+		for (unsigned t = 0; t < 3 * TerrainCache::CACHE_TILES; t++) {
+			unsigned row = 8 + 16 * t;
+			unsigned col = 1190 - 16 * t;
+			ASSERT_TRUE(terrain.get_height(lat(row), lon(col), h));
+			EXPECT_NEAR(row + 2.0f * col, h, 1e-2f);
+		}
+	}
+}
+
+TEST_F(TerrainCacheTest, Path)
+{
+	TerrainCache terrain(dir);
+	float h;
+
+	/* the terrain rises to the south east */
+	ASSERT_TRUE(terrain.get_max_height_on_path(lat(100), lon(100), lat(400), lon(500), h));
+	EXPECT_NEAR(1400.0f, h, 1e-2f);
+
+	/* the path leaves the square with terrain data */
+	EXPECT_FALSE(terrain.get_max_height_on_path(lat(100), lon(100), 47.5, 9.5, h));
+}
+
+TEST_F(TerrainCacheTest, Prefetch)
+{
+	TerrainCache terrain(dir);
+	float h;
+
+	/* the tile of the position and its eight neighbours */
+	for (unsigned i = 0; i < 9; i++) {
+		terrain.prefetch(lat(600), lon(600));
+	}
+
+	unlink(path);
+
+	for (int dy = -1; dy <= 1; dy++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			ASSERT_TRUE(terrain.get_height(lat(600 + 16 * dy), lon(600 + 16 * dx), h));
+		}
+	}
+}
@@ -0,0 +1,123 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <mavlink/mavlink_timesync.h>
+
+#include "gtest/gtest.h"
+
+/* simulated companion: remote = (local - offset) * (1 - skew) */
+struct Companion {
+	int64_t offset_ns;
+	double skew;
+
+	uint64_t remote(uint64_t local_ns) const
+	{
+		return (uint64_t)((int64_t)local_ns - offset_ns - (int64_t)(skew * local_ns));
+	}
+};
+
+/* round trip starting at local_ns, answered after up_ns and received down_ns later */
+static bool round_trip(MavlinkTimesync &ts, const Companion &c, uint64_t local_ns, uint64_t up_ns, uint64_t down_ns)
+{
+	return ts.add_sample(local_ns, c.remote(local_ns + up_ns), local_ns + up_ns + down_ns);
+}
+
+TEST(TimesyncTest, Converges)
+{
+	MavlinkTimesync ts;
+	Companion c = { -1440000000000000000LL, 0.0 };
+	uint64_t t = 10000000000ULL;
+
+	/* not used before it converged */
+	EXPECT_TRUE(round_trip(ts, c, t, 500000, 500000));
+	EXPECT_EQ(0u, ts.sync_stamp(c.remote(t) / 1000));
+
+	srand(0);
+
+	for (unsigned i = 0; i < 200; i++) {
+		t += 100000000ULL;
+		uint64_t jitter = rand() % 200000;
+		round_trip(ts, c, t, 500000 + jitter, 500000 + 200000 - jitter);
+	}
+
+	int64_t offset_ns;
+	float skew;
+	uint32_t rtt_us;
+	ASSERT_TRUE(ts.get_estimate(&offset_ns, &skew, &rtt_us));
+	EXPECT_NEAR(c.offset_ns, offset_ns, 100000);
+	EXPECT_NEAR(1200, rtt_us, 50);
+
+	uint64_t local_usec = ts.sync_stamp(c.remote(t) / 1000);
+	EXPECT_NEAR(t / 1000, local_usec, 100);
+}
+
+TEST(TimesyncTest, TracksSkew)
+{
+	MavlinkTimesync ts;
+	Companion c = { 5000000000LL, 20e-6 };
+	uint64_t t = 1000000000ULL;
+
+	for (unsigned i = 0; i < 3000; i++) {
+		t += 100000000ULL;
+		round_trip(ts, c, t, 400000, 400000);
+	}
+
+	int64_t offset_ns;
+	float skew;
+	uint32_t rtt_us;
+	ASSERT_TRUE(ts.get_estimate(&offset_ns, &skew, &rtt_us));
+	EXPECT_NEAR(20e-6, skew, 2e-6);
+
+	/* a free running filter would lag the drift of 2 us per sample */
+	t += 100000000ULL;
+	EXPECT_NEAR(t / 1000, ts.sync_stamp(c.remote(t) / 1000), 50);
+}
+
+TEST(TimesyncTest, RejectsOutliers)
+{
+	MavlinkTimesync ts;
+	Companion c = { 123456789000LL, 0.0 };
+	uint64_t t = 1000000000ULL;
+
+	for (unsigned i = 0; i < 50; i++) {
+		t += 100000000ULL;
+		round_trip(ts, c, t, 300000, 300000);
+	}
+
+	/* one very asymmetric round trip, e.g. a buffered reply */
+	t += 100000000ULL;
+	EXPECT_FALSE(round_trip(ts, c, t, 300000, 20000000));
+
+	/* replies that arrived before the request */
+	EXPECT_FALSE(ts.add_sample(t, c.remote(t), t - 1));
+
+	t += 100000000ULL;
+	EXPECT_NEAR(t / 1000, ts.sync_stamp(c.remote(t) / 1000), 20);
+}
+
+TEST(TimesyncTest, ResetsAfterJump)
+{
+	MavlinkTimesync ts;
+	Companion c = { 123456789000LL, 0.0 };
+	uint64_t t = 1000000000ULL;
+
+	for (unsigned i = 0; i < 50; i++) {
+		t += 100000000ULL;
+		round_trip(ts, c, t, 300000, 300000);
+	}
+
+	/* the companion clock is set by NTP */
+	c.offset_ns -= 2000000000LL;
+
+	for (unsigned i = 0; i < MavlinkTimesync::RESET_COUNT; i++) {
+		t += 100000000ULL;
+		EXPECT_FALSE(round_trip(ts, c, t, 300000, 300000));
+	}
+
+	for (unsigned i = 0; i < MavlinkTimesync::CONVERGE_COUNT; i++) {
+		t += 100000000ULL;
+		EXPECT_TRUE(round_trip(ts, c, t, 300000, 300000));
+	}
+
+	EXPECT_NEAR(t / 1000, ts.sync_stamp(c.remote(t) / 1000), 20);
+}
@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <string.h>
+
+#include "uORBDelta.hpp"
+
+#include "gtest/gtest.h"
+
+struct delta_test_s {
+	uint64_t timestamp;
+	uint8_t state;
+	float values[32];
+};
+
+static int32_t roundtrip(uORB::DeltaEncoder &enc, uORB::DeltaDecoder &dec, const delta_test_s &in, delta_test_s &out)
+{
+	uint8_t buf[sizeof(delta_test_s) + uORB::DeltaEncoder::HEADER_LEN];
+	int32_t len = enc.encode((const uint8_t *)&in, sizeof(in), buf);
+	EXPECT_GT(len, 0);
+
+	const uint8_t *data;
+	EXPECT_EQ((int32_t)sizeof(in), dec.decode(buf, len, &data));
+	memcpy(&out, data, sizeof(out));
+
+	return len;
+}
+
+TEST(UorbDeltaTest, SmallChangesSendDeltas)
+{
+	uORB::DeltaEncoder enc;
+	uORB::DeltaDecoder dec;
+	delta_test_s in, out;
+	memset(&in, 0, sizeof(in));
+
+	/* the first update is a keyframe */
+	EXPECT_EQ((int32_t)sizeof(in) + uORB::DeltaEncoder::HEADER_LEN, roundtrip(enc, dec, in, out));
+	EXPECT_EQ(0, memcmp(&in, &out, sizeof(in)));
+
+	for (int i = 1; i < 20; i++) {
+		in.timestamp += 1000;
+		in.state = i & 3;
+
+		int32_t len = roundtrip(enc, dec, in, out);
+		EXPECT_LT(len, 20);
+		EXPECT_EQ(0, memcmp(&in, &out, sizeof(in)));
+	}
+}
+
+TEST(UorbDeltaTest, LargeChangesSendKeyframes)
+{
+	uORB::DeltaEncoder enc;
+	uORB::DeltaDecoder dec;
+	delta_test_s in, out;
+	memset(&in, 0, sizeof(in));
+	roundtrip(enc, dec, in, out);
+
+	for (unsigned i = 0; i < 32; i++) {
+		in.values[i] = i + 1.5f;
+	}
+
+	EXPECT_EQ((int32_t)sizeof(in) + uORB::DeltaEncoder::HEADER_LEN, roundtrip(enc, dec, in, out));
+	EXPECT_EQ(0, memcmp(&in, &out, sizeof(in)));
+}
+
+TEST(UorbDeltaTest, LostMessages)
+{
+	uORB::DeltaEncoder enc;
+	uORB::DeltaDecoder dec;
+	uint8_t buf[sizeof(delta_test_s) + uORB::DeltaEncoder::HEADER_LEN];
+	const uint8_t *data;
+	delta_test_s in;
+	memset(&in, 0, sizeof(in));
+
+	int32_t len = enc.encode((const uint8_t *)&in, sizeof(in), buf);
+	ASSERT_EQ((int32_t)sizeof(in), dec.decode(buf, len, &data));
+
+	/* a lost delta does not matter to the following ones */
+	in.state = 1;
+	enc.encode((const uint8_t *)&in, sizeof(in), buf);
+	in.timestamp = 5;
+	len = enc.encode((const uint8_t *)&in, sizeof(in), buf);
+	ASSERT_EQ((int32_t)sizeof(in), dec.decode(buf, len, &data));
+	EXPECT_EQ(0, memcmp(&in, data, sizeof(in)));
+
+	/* deltas to a lost keyframe are refused until the next keyframe */
+	for (unsigned i = 0; i < 32; i++) {
+		in.values[i] = i + 1.5f;
+	}
+
+	enc.encode((const uint8_t *)&in, sizeof(in), buf);
+	in.state = 2;
+	len = enc.encode((const uint8_t *)&in, sizeof(in), buf);
+	EXPECT_EQ(-1, dec.decode(buf, len, &data));
+
+	bool recovered = false;
+
+	for (int i = 0; i < 100 && !recovered; i++) {
+		in.timestamp++;
+		len = enc.encode((const uint8_t *)&in, sizeof(in), buf);
+		recovered = dec.decode(buf, len, &data) == (int32_t)sizeof(in);
+	}
+
+	ASSERT_TRUE(recovered);
+	EXPECT_EQ(0, memcmp(&in, data, sizeof(in)));
+}
+
+TEST(UorbDeltaTest, Malformed)
+{
+	uORB::DeltaDecoder dec;
+	const uint8_t *data;
+	const uint8_t delta[] = { 'D', 0, 0, 0, 1, 0xff };
+	const uint8_t key[] = { 'K', 1, 1, 2, 3, 4 };
+	const uint8_t overflow[] = { 'D', 1, 3, 0, 2, 0xff, 0xff };
+
+	EXPECT_EQ(-1, dec.decode(delta, 1, &data));
+	EXPECT_EQ(-1, dec.decode(delta, sizeof(delta), &data));
+	EXPECT_EQ(4, dec.decode(key, sizeof(key), &data));
+	EXPECT_EQ(-1, dec.decode(overflow, sizeof(overflow), &data));
+}
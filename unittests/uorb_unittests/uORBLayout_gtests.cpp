@@ -0,0 +1,139 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2015 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <string.h>
+
+#include <uORB/uORB.h>
+#include <uORB/topics/position_setpoint_triplet.h>
+#include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/vehicle_status.h>
+
+#include "gtest/gtest.h"
+
+struct layout_test_s {
+	uint8_t a;
+	uint32_t b;
+};
+
+ORB_DEFINE(layout_test, struct layout_test_s);
+
+static const struct orb_field *find_field(const struct orb_metadata *meta, const char *name)
+{
+	for (unsigned i = 0; i < meta->o_num_fields; i++) {
+		if (strcmp(meta->o_fields[i].name, name) == 0) {
+			return &meta->o_fields[i];
+		}
+	}
+
+	return NULL;
+}
+
+TEST(UorbLayoutTest, Descriptor)
+{
+	const struct orb_metadata *meta = ORB_ID(sensor_combined);
+	ASSERT_TRUE(meta->o_fields != NULL);
+
+	const struct orb_field *f = find_field(meta, "gyro_rad_s");
+	ASSERT_TRUE(f != NULL);
+	EXPECT_EQ(offsetof(struct sensor_combined_s, gyro_rad_s), f->offset);
+	EXPECT_EQ(ORB_FIELD_FLOAT, f->type);
+	EXPECT_EQ(9, f->count);
+
+	/* the fields are in declaration order, which the struct does not keep, but all lie within it */
+	size_t size = 0;
+
+	for (unsigned i = 0; i < meta->o_num_fields; i++) {
+		const size_t field_size = orb_field_size(meta->o_fields[i].type) * meta->o_fields[i].count;
+		EXPECT_LE(meta->o_fields[i].offset + field_size, meta->o_size);
+		size += field_size;
+	}
+
+	EXPECT_EQ(size, orb_packed_size(meta));
+	EXPECT_LE(size, meta->o_size);
+}
+
+TEST(UorbLayoutTest, NestedFields)
+{
+	const struct orb_metadata *meta = ORB_ID(position_setpoint_triplet);
+
+	const struct orb_field *f = find_field(meta, "current.lat");
+	ASSERT_TRUE(f != NULL);
+	EXPECT_EQ(offsetof(struct position_setpoint_triplet_s, current.lat), f->offset);
+	EXPECT_EQ(ORB_FIELD_DOUBLE, f->type);
+
+	EXPECT_TRUE(find_field(meta, "current") == NULL);
+	EXPECT_TRUE(find_field(meta, "next.yaw_valid") != NULL);
+}
+
+TEST(UorbLayoutTest, PackUnpack)
+{
+	const struct orb_metadata *meta = ORB_ID(vehicle_status);
+
+	struct vehicle_status_s status;
+	memset(&status, 0xa5, sizeof(status));
+	status.counter = 7;
+	status.timestamp = 123456789;
+	status.arming_state = vehicle_status_s::ARMING_STATE_ARMED;
+	status.load = 0.25f;
+	status.errors_count4 = 42;
+
+	uint8_t packed[sizeof(status)];
+	const size_t size = orb_pack(meta, &status, packed);
+	EXPECT_EQ(orb_packed_size(meta), size);
+
+	/* packed data follows the declaration order: the counter, then the timestamp */
+	uint16_t counter;
+	uint64_t timestamp;
+	memcpy(&counter, packed, sizeof(counter));
+	memcpy(&timestamp, packed + sizeof(counter), sizeof(timestamp));
+	EXPECT_EQ(status.counter, counter);
+	EXPECT_EQ(status.timestamp, timestamp);
+
+	struct vehicle_status_s unpacked;
+	memset(&unpacked, 0xa5, sizeof(unpacked));
+	EXPECT_EQ(size, orb_unpack(meta, packed, &unpacked));
+	EXPECT_EQ(0, memcmp(&status, &unpacked, sizeof(status)));
+}
+
+TEST(UorbLayoutTest, NoDescriptor)
+{
+	/* topics defined without a descriptor are copied as a whole */
+	const struct orb_metadata *meta = ORB_ID(layout_test);
+	EXPECT_TRUE(meta->o_fields == NULL);
+	EXPECT_EQ(sizeof(struct layout_test_s), orb_packed_size(meta));
+
+	struct layout_test_s data = { 1, 2 };
+	uint8_t packed[sizeof(data)];
+	EXPECT_EQ(sizeof(data), orb_pack(meta, &data, packed));
+	EXPECT_EQ(0, memcmp(&data, packed, sizeof(data)));
+}